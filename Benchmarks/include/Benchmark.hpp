@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/// @brief Minimal benchmark harness, without any external dependency.
+/// Each case is a function looping over its State:
+///
+///     void MyCase(Benchmark::State& state)
+///     {
+///         // Setup, not timed
+///         while (state.KeepRunning())
+///         {
+///             // Timed code
+///         }
+///     }
+///
+/// The number of iterations is increased until a run lasts at least
+/// the min time. Results are printed and can be saved as JSON, using
+/// the same layout as Google Benchmark so its tools can compare them.
+/// Cases can also report counters (e.g. memory usage), which are
+/// compared with a baseline JSON file to detect regressions.
+namespace Benchmark
+{
+    class State
+    {
+    public:
+        State(const size_t iterations_);
+
+        /// @brief Start the timer on first call, stop it after the last iteration
+        /// @return False once all the iterations have been run
+        bool KeepRunning()
+        {
+            if (current_iteration == 0 && !running)
+            {
+                ResumeTiming();
+            }
+            if (current_iteration == iterations)
+            {
+                PauseTiming();
+                return false;
+            }
+            current_iteration += 1;
+            return true;
+        }
+
+        /// @brief Stop the timer, to exclude some per-iteration setup from the measure
+        void PauseTiming();
+        void ResumeTiming();
+
+        const size_t GetIterations() const;
+
+        /// @brief Number of items processed during the whole run, reported as items/s
+        void SetItemsProcessed(const size_t n);
+        /// @brief Number of bytes processed during the whole run, reported as bytes/s
+        void SetBytesProcessed(const size_t n);
+        /// @brief Report a value measured during the run, a higher value is considered worse
+        /// @param name Name of the counter, saved as a key of the JSON result
+        /// @param value Value of the counter
+        void SetCounter(const std::string& name, const double value);
+
+        const double GetRealTimeSeconds() const;
+        const double GetCpuTimeSeconds() const;
+        const size_t GetItemsProcessed() const;
+        const size_t GetBytesProcessed() const;
+        const std::map<std::string, double>& GetCounters() const;
+
+    private:
+        size_t iterations;
+        size_t current_iteration;
+        bool running;
+
+        std::chrono::steady_clock::time_point real_start;
+        std::clock_t cpu_start;
+        double real_time_s;
+        double cpu_time_s;
+
+        size_t items_processed;
+        size_t bytes_processed;
+        std::map<std::string, double> counters;
+    };
+
+    using Function = std::function<void(State&)>;
+
+    /// @brief Add a case to the list of available benchmarks
+    /// @param name Name of the case, "Group/Case/parameters"
+    /// @param function Function running the case
+    /// @param iterations Fixed number of iterations, 0 to adapt it to the min time
+    void Register(const std::string& name, const Function& function, const size_t iterations = 0);
+
+    struct RunSummary
+    {
+        /// @brief Number of benchmarks run
+        size_t num_run = 0;
+        /// @brief Number of counters higher than in the baseline, above the tolerance
+        size_t num_regressions = 0;
+    };
+
+    /// @brief Run the registered benchmarks
+    /// @param filter Regex, only the benchmarks with a matching name are run
+    /// @param min_time_s Min duration of each measured run
+    /// @param json_path If not empty, save the results in this file
+    /// @param baseline_path If not empty, compare the counters with the ones saved in this JSON file. Timings are not compared
+    /// @param tolerance Max relative increase of a counter compared to the baseline
+    /// @return The number of benchmarks run and regressions found
+    RunSummary Run(const std::string& filter, const double min_time_s, const std::string& json_path,
+        const std::string& baseline_path = "", const double tolerance = 0.1);
+
+    /// @brief Get the names of the registered benchmarks
+    std::vector<std::string> GetNames();
+
+    /// @brief Prevent the compiler from optimizing away a value
+    template<class T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(_MSC_VER)
+        static volatile const void* sink;
+        sink = &value;
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+} // Benchmark
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <botcraft/Game/Vector3.hpp>
+
+namespace Botcraft
+{
+    class World;
+}
+
+/// @brief Canned terrains shared by the benchmarks
+
+/// @brief Get the id of a block from its name, as used by World::SetBlock
+/// @param name Full block name (e.g. minecraft:stone)
+/// @return The block id, -1 if not found
+int GetBlockId(const std::string& name);
+
+/// @brief Create a world of size x size chunks, with a stone floor at y=0
+/// and walls with gaps every 8 blocks, so paths have to go around them.
+/// The snapshot is published, so it can be used directly
+/// @param size Number of chunks on X and Z
+std::shared_ptr<Botcraft::World> CreateTestWorld(const int size);
+
+#if PROTOCOL_VERSION > 756
+/// @brief Encode chunk data as sent in a ClientboundLevelChunkWithLightPacket
+/// @param bits_per_block Bits per block of each section, 0 for single value, > 8 for global palette
+/// @param num_sections Number of sections in the chunk
+/// @return The encoded data
+std::vector<unsigned char> CreateChunkData(const int bits_per_block, const int num_sections);
+#endif
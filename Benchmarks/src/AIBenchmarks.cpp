@@ -0,0 +1,61 @@
+#include <botcraft/AI/Blackboard.hpp>
+
+#include "Benchmark.hpp"
+
+using namespace Botcraft;
+
+static void BlackboardGetString(Benchmark::State& state)
+{
+    Blackboard blackboard;
+    blackboard.Set<int>("Benchmark.value", 42);
+    while (state.KeepRunning())
+    {
+        Benchmark::DoNotOptimize(blackboard.Get<int>("Benchmark.value"));
+    }
+    state.SetItemsProcessed(state.GetIterations());
+}
+
+static void BlackboardGetKey(Benchmark::State& state)
+{
+    static const BlackboardKey<int> key("Benchmark.value");
+    Blackboard blackboard;
+    blackboard.Set(key, 42);
+    while (state.KeepRunning())
+    {
+        Benchmark::DoNotOptimize(blackboard.Get(key));
+    }
+    state.SetItemsProcessed(state.GetIterations());
+}
+
+static void BlackboardSetString(Benchmark::State& state)
+{
+    Blackboard blackboard;
+    int i = 0;
+    while (state.KeepRunning())
+    {
+        blackboard.Set<int>("Benchmark.value", i++);
+    }
+    Benchmark::DoNotOptimize(blackboard.Get<int>("Benchmark.value"));
+    state.SetItemsProcessed(state.GetIterations());
+}
+
+static void BlackboardSetKey(Benchmark::State& state)
+{
+    static const BlackboardKey<int> key("Benchmark.value");
+    Blackboard blackboard;
+    int i = 0;
+    while (state.KeepRunning())
+    {
+        blackboard.Set(key, i++);
+    }
+    Benchmark::DoNotOptimize(blackboard.Get(key));
+    state.SetItemsProcessed(state.GetIterations());
+}
+
+void RegisterAIBenchmarks()
+{
+    Benchmark::Register("Blackboard/Get/string", BlackboardGetString);
+    Benchmark::Register("Blackboard/Get/key", BlackboardGetKey);
+    Benchmark::Register("Blackboard/Set/string", BlackboardSetString);
+    Benchmark::Register("Blackboard/Set/key", BlackboardSetKey);
+}
@@ -0,0 +1,283 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "botcraft/Version.hpp"
+
+namespace Benchmark
+{
+    State::State(const size_t iterations_)
+    {
+        iterations = iterations_;
+        current_iteration = 0;
+        running = false;
+        cpu_start = 0;
+        real_time_s = 0.0;
+        cpu_time_s = 0.0;
+        items_processed = 0;
+        bytes_processed = 0;
+    }
+
+    void State::PauseTiming()
+    {
+        if (!running)
+        {
+            return;
+        }
+        real_time_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start).count();
+        cpu_time_s += static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        running = false;
+    }
+
+    void State::ResumeTiming()
+    {
+        if (running)
+        {
+            return;
+        }
+        running = true;
+        cpu_start = std::clock();
+        real_start = std::chrono::steady_clock::now();
+    }
+
+    const size_t State::GetIterations() const
+    {
+        return iterations;
+    }
+
+    void State::SetItemsProcessed(const size_t n)
+    {
+        items_processed = n;
+    }
+
+    void State::SetBytesProcessed(const size_t n)
+    {
+        bytes_processed = n;
+    }
+
+    void State::SetCounter(const std::string& name, const double value)
+    {
+        counters[name] = value;
+    }
+
+    const double State::GetRealTimeSeconds() const
+    {
+        return real_time_s;
+    }
+
+    const double State::GetCpuTimeSeconds() const
+    {
+        return cpu_time_s;
+    }
+
+    const size_t State::GetItemsProcessed() const
+    {
+        return items_processed;
+    }
+
+    const size_t State::GetBytesProcessed() const
+    {
+        return bytes_processed;
+    }
+
+    const std::map<std::string, double>& State::GetCounters() const
+    {
+        return counters;
+    }
+
+
+    struct RegisteredBenchmark
+    {
+        std::string name;
+        Function function;
+        size_t iterations;
+    };
+
+    // Function local to avoid static initialization order issues
+    static std::vector<RegisteredBenchmark>& GetRegistry()
+    {
+        static std::vector<RegisteredBenchmark> registry;
+        return registry;
+    }
+
+    void Register(const std::string& name, const Function& function, const size_t iterations)
+    {
+        GetRegistry().push_back({ name, function, iterations });
+    }
+
+    std::vector<std::string> GetNames()
+    {
+        std::vector<std::string> output;
+        for (const auto& b : GetRegistry())
+        {
+            output.push_back(b.name);
+        }
+        return output;
+    }
+
+    static const std::string FormatRate(const double rate, const std::string& unit)
+    {
+        static const char* prefixes[] = { "", "k", "M", "G", "T" };
+        double value = rate;
+        size_t prefix = 0;
+        while (value >= 1000.0 && prefix < 4)
+        {
+            value /= 1000.0;
+            prefix += 1;
+        }
+        std::stringstream s;
+        s << std::fixed << std::setprecision(2) << value << prefixes[prefix] << unit;
+        return s.str();
+    }
+
+    RunSummary Run(const std::string& filter, const double min_time_s, const std::string& json_path,
+        const std::string& baseline_path, const double tolerance)
+    {
+        const std::regex filter_regex(filter.empty() ? ".*" : filter);
+
+        // Name --> result saved in the baseline file
+        std::map<std::string, nlohmann::json> baseline;
+        if (!baseline_path.empty())
+        {
+            std::ifstream file(baseline_path);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Can't open baseline file " + baseline_path);
+            }
+            const nlohmann::json content = nlohmann::json::parse(file);
+            for (const nlohmann::json& result : content.at("benchmarks"))
+            {
+                baseline[result.at("name").get<std::string>()] = result;
+            }
+        }
+
+        nlohmann::json output;
+        output["context"]["date"] = std::time(nullptr);
+        output["context"]["num_cpus"] = std::thread::hardware_concurrency();
+        output["context"]["protocol_version"] = protocol_version;
+        output["context"]["game_version"] = game_version;
+#ifdef NDEBUG
+        output["context"]["library_build_type"] = "release";
+#else
+        output["context"]["library_build_type"] = "debug";
+#endif
+        output["benchmarks"] = nlohmann::json::array();
+
+        std::cout << std::left << std::setw(48) << "Benchmark"
+            << std::right << std::setw(14) << "Time (ns)"
+            << std::setw(14) << "CPU (ns)"
+            << std::setw(14) << "Iterations"
+            << "  Rate" << std::endl;
+        std::cout << std::string(100, '-') << std::endl;
+
+        RunSummary summary;
+        for (const auto& b : GetRegistry())
+        {
+            if (!std::regex_search(b.name, filter_regex))
+            {
+                continue;
+            }
+
+            // Increase the number of iterations until the run is long enough
+            size_t iterations = b.iterations > 0 ? b.iterations : 1;
+            State state(iterations);
+            while (true)
+            {
+                state = State(iterations);
+                b.function(state);
+                const double elapsed = state.GetRealTimeSeconds();
+                if (b.iterations > 0 || elapsed >= min_time_s || iterations >= 1000000000)
+                {
+                    break;
+                }
+                // Aim a bit above min time, but don't grow too fast
+                // if the first iterations were too short to be accurate
+                const double multiplier = elapsed <= 0.0 ? 10.0 : std::min(10.0, 1.4 * min_time_s / elapsed);
+                iterations = std::max(iterations + 1, static_cast<size_t>(iterations * multiplier));
+            }
+
+            const double real_ns = 1e9 * state.GetRealTimeSeconds() / iterations;
+            const double cpu_ns = 1e9 * state.GetCpuTimeSeconds() / iterations;
+
+            nlohmann::json result;
+            result["name"] = b.name;
+            result["run_name"] = b.name;
+            result["run_type"] = "iteration";
+            result["iterations"] = iterations;
+            result["real_time"] = real_ns;
+            result["cpu_time"] = cpu_ns;
+            result["time_unit"] = "ns";
+
+            std::string rate;
+            if (state.GetItemsProcessed() > 0 && state.GetRealTimeSeconds() > 0.0)
+            {
+                const double items_per_second = state.GetItemsProcessed() / state.GetRealTimeSeconds();
+                result["items_per_second"] = items_per_second;
+                rate += " " + FormatRate(items_per_second, " items/s");
+            }
+            if (state.GetBytesProcessed() > 0 && state.GetRealTimeSeconds() > 0.0)
+            {
+                const double bytes_per_second = state.GetBytesProcessed() / state.GetRealTimeSeconds();
+                result["bytes_per_second"] = bytes_per_second;
+                rate += " " + FormatRate(bytes_per_second, "B/s");
+            }
+            // Flat keys, as Google Benchmark user counters
+            for (const auto& c : state.GetCounters())
+            {
+                result[c.first] = c.second;
+                rate += " " + c.first + "=" + FormatRate(c.second, "");
+            }
+            output["benchmarks"].push_back(result);
+
+            std::cout << std::left << std::setw(48) << b.name
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(14) << real_ns
+                << std::setw(14) << cpu_ns
+                << std::setw(14) << iterations
+                << " " << rate << std::endl;
+
+            const auto baseline_it = baseline.find(b.name);
+            if (baseline_it != baseline.end())
+            {
+                for (const auto& c : state.GetCounters())
+                {
+                    const auto value_it = baseline_it->second.find(c.first);
+                    if (value_it == baseline_it->second.end() || !value_it->is_number())
+                    {
+                        continue;
+                    }
+                    const double reference = value_it->get<double>();
+                    if (c.second > reference * (1.0 + tolerance))
+                    {
+                        std::cout << "    REGRESSION " << c.first << ": " << reference << " --> " << c.second
+                            << " (+" << std::setprecision(1) << 100.0 * (c.second - reference) / std::max(reference, 1e-9) << "%)" << std::endl;
+                        summary.num_regressions += 1;
+                    }
+                }
+            }
+
+            summary.num_run += 1;
+        }
+
+        if (!json_path.empty())
+        {
+            std::ofstream file(json_path);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Can't open " + json_path + " to save the results");
+            }
+            file << output.dump(4);
+        }
+
+        return summary;
+    }
+} // Benchmark
@@ -0,0 +1,314 @@
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <botcraft/Game/ClientMetrics.hpp>
+#include <botcraft/Game/Entities/EntityManager.hpp>
+#include <botcraft/Game/Entities/entities/Entity.hpp>
+#include <botcraft/Game/ManagersClient.hpp>
+#include <botcraft/Game/World/World.hpp>
+#include <botcraft/Network/FakeServer.hpp>
+
+#include <protocolCraft/Handler.hpp>
+
+#include "Benchmark.hpp"
+#include "TestWorld.hpp"
+
+using namespace Botcraft;
+
+/// @brief Bytes currently allocated on the heap, by all the threads
+/// @return The allocated bytes, 0 if not available on this platform
+static size_t GetHeapBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+/// @brief Difference between two GetHeapBytes values, 0 if not available
+static double HeapDelta(const size_t before, const size_t after)
+{
+    return after > before ? static_cast<double>(after - before) : 0.0;
+}
+
+/// @brief Never destroy a measured object. Deleted sections and entities go
+/// to process-wide pools, and would be reused by the next measures instead
+/// of new allocations. For the same reason, these benchmarks are registered
+/// before the others
+static void KeepAlive(const std::shared_ptr<void>& object)
+{
+    // Never deleted, like the pools
+    static std::vector<std::shared_ptr<void> >* objects = new std::vector<std::shared_ptr<void> >();
+    objects->push_back(object);
+}
+
+/// @brief Load a square of chunks with a synthetic overworld terrain: bedrock,
+/// stone (and deepslate below y=0) with ores, dirt and grass around sea level,
+/// water in the holes. Counters are the heap bytes and the World::GetStats estimation
+static void MemoryWorld(Benchmark::State& state, const int view_distance, const int height, const int min_y)
+{
+    const int bedrock = GetBlockId("minecraft:bedrock");
+    const int stone = GetBlockId("minecraft:stone");
+    const int deepslate = GetBlockId("minecraft:deepslate") == -1 ? stone : GetBlockId("minecraft:deepslate");
+    const int coal = GetBlockId("minecraft:coal_ore");
+    const int iron = GetBlockId("minecraft:iron_ore");
+    const int dirt = GetBlockId("minecraft:dirt");
+    const int grass = GetBlockId("minecraft:grass_block");
+    const int water = GetBlockId("minecraft:water");
+
+    double heap_bytes = 0.0;
+    WorldStats stats;
+    while (state.KeepRunning())
+    {
+        std::mt19937 random_engine(42);
+        const size_t heap_before = GetHeapBytes();
+        {
+            std::shared_ptr<World> world = std::make_shared<World>(false);
+            {
+                std::lock_guard<std::mutex> lock(world->GetMutex());
+#if PROTOCOL_VERSION > 756
+                world->SetDimensionHeight("minecraft:overworld", height);
+                world->SetDimensionMinY("minecraft:overworld", min_y);
+                world->SetCurrentDimension("minecraft:overworld");
+#endif
+                for (int x = -view_distance; x <= view_distance; ++x)
+                {
+                    for (int z = -view_distance; z <= view_distance; ++z)
+                    {
+#if PROTOCOL_VERSION < 719
+                        world->AddChunk(x, z, Dimension::Overworld);
+#else
+                        world->AddChunk(x, z, "minecraft:overworld");
+#endif
+                    }
+                }
+
+                Position pos;
+                for (pos.x = -view_distance * CHUNK_WIDTH; pos.x < (view_distance + 1) * CHUNK_WIDTH; ++pos.x)
+                {
+                    for (pos.z = -view_distance * CHUNK_WIDTH; pos.z < (view_distance + 1) * CHUNK_WIDTH; ++pos.z)
+                    {
+                        const int surface = 62 + static_cast<int>(std::round(4.0 * std::sin(pos.x / 13.0) + 4.0 * std::cos(pos.z / 17.0)));
+                        for (pos.y = min_y; pos.y <= std::max(surface, 62); ++pos.y)
+                        {
+                            int id = stone;
+                            if (pos.y == min_y)
+                            {
+                                id = bedrock;
+                            }
+                            else if (pos.y > surface)
+                            {
+                                id = water;
+                            }
+                            else if (pos.y == surface)
+                            {
+                                id = surface < 62 ? dirt : grass;
+                            }
+                            else if (pos.y > surface - 4)
+                            {
+                                id = dirt;
+                            }
+                            else if (random_engine() % 64 == 0)
+                            {
+                                id = random_engine() % 2 ? coal : iron;
+                            }
+                            else if (pos.y < 0)
+                            {
+                                id = deepslate;
+                            }
+#if PROTOCOL_VERSION < 347
+                            world->SetBlock(pos, id, 0);
+#else
+                            world->SetBlock(pos, id);
+#endif
+                        }
+                    }
+                }
+                world->PublishSnapshot();
+            }
+            heap_bytes = HeapDelta(heap_before, GetHeapBytes());
+            stats = world->GetStats();
+            KeepAlive(world);
+        }
+    }
+
+    state.SetItemsProcessed(state.GetIterations() * stats.num_chunks);
+    if (heap_bytes > 0.0)
+    {
+        state.SetCounter("heap_bytes_per_chunk", heap_bytes / stats.num_chunks);
+        state.SetCounter("heap_bytes_per_section", heap_bytes / stats.num_sections);
+    }
+    state.SetCounter("estimated_bytes_per_chunk", static_cast<double>(stats.memory_bytes) / stats.num_chunks);
+    state.SetCounter("estimated_bytes_per_section", static_cast<double>(stats.sections_memory_bytes) / stats.num_sections);
+}
+
+/// @brief Add mobs to an EntityManager, as if sent by the server.
+/// Counters are the heap bytes and the EntityManager::GetStats estimation
+static void MemoryEntities(Benchmark::State& state, const int num_entities)
+{
+    const std::vector<EntityType> types = {
+        EntityType::Zombie, EntityType::Skeleton, EntityType::Creeper, EntityType::Spider,
+        EntityType::Cow, EntityType::Pig, EntityType::Sheep, EntityType::Chicken
+    };
+
+    double heap_bytes = 0.0;
+    EntityManagerStats stats;
+    while (state.KeepRunning())
+    {
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<double> horizontal(-160.0, 160.0);
+        const size_t heap_before = GetHeapBytes();
+        {
+            std::shared_ptr<EntityManager> entity_manager = std::make_shared<EntityManager>();
+            for (int i = 0; i < num_entities; ++i)
+            {
+#if PROTOCOL_VERSION > 758
+                ProtocolCraft::ClientboundAddEntityPacket msg;
+                msg.SetType(static_cast<char>(types[i % types.size()]));
+#else
+                ProtocolCraft::ClientboundAddMobPacket msg;
+                msg.SetType(static_cast<int>(types[i % types.size()]));
+#endif
+                msg.SetId_(i + 1);
+                msg.SetX(horizontal(random_engine));
+                msg.SetY(64.0);
+                msg.SetZ(horizontal(random_engine));
+                msg.Dispatch(entity_manager.get());
+            }
+            heap_bytes = HeapDelta(heap_before, GetHeapBytes());
+            stats = entity_manager->GetStats();
+            KeepAlive(entity_manager);
+        }
+    }
+
+    state.SetItemsProcessed(state.GetIterations() * num_entities);
+    if (heap_bytes > 0.0)
+    {
+        state.SetCounter("heap_bytes_per_entity", heap_bytes / num_entities);
+    }
+    state.SetCounter("estimated_bytes_per_entity", static_cast<double>(stats.entities_memory_bytes + stats.metadata_memory_bytes) / std::max<size_t>(stats.num_entities, 1));
+}
+
+#if PROTOCOL_VERSION > 758
+/// @brief Connect bots to a FakeServer, and measure the memory used once they
+/// received all the chunks around spawn. The server is started before the first
+/// measure, but the sessions it creates for the bots are included in the results
+static void MemoryManagersClient(Benchmark::State& state, const int num_bots, const bool shared_world)
+{
+    FakeServerConfig server_config;
+    server_config.port = 25599;
+    server_config.view_distance = 4;
+    server_config.num_entities = 32;
+    const size_t expected_chunks = (2 * server_config.view_distance + 1) * (2 * server_config.view_distance + 1);
+
+    double heap_bytes = 0.0;
+    double estimated_bytes = 0.0;
+    while (state.KeepRunning())
+    {
+        FakeServer server(server_config);
+        const size_t heap_before = GetHeapBytes();
+        {
+            std::shared_ptr<World> world = shared_world ? std::make_shared<World>(true) : nullptr;
+            std::vector<std::unique_ptr<ManagersClient> > clients;
+            for (int i = 0; i < num_bots; ++i)
+            {
+                clients.push_back(std::make_unique<ManagersClient>(false));
+                if (world != nullptr)
+                {
+                    clients.back()->SetSharedWorld(world);
+                }
+                clients.back()->Connect("127.0.0.1:" + std::to_string(server_config.port), "BCMemory" + std::to_string(i), "");
+            }
+
+            // Wait for all the bots to be in game with their chunks loaded
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            std::vector<ClientMetrics> metrics;
+            while (true)
+            {
+                metrics.clear();
+                bool ready = true;
+                for (const auto& c : clients)
+                {
+                    metrics.push_back(c->GetMetrics());
+                    ready &= metrics.back().world.num_chunks >= expected_chunks && metrics.back().entities.num_entities > 0;
+                }
+                if (ready)
+                {
+                    break;
+                }
+                if (std::chrono::steady_clock::now() - start > std::chrono::seconds(20))
+                {
+                    throw std::runtime_error("Bots not ready after 20 seconds");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            // Let the last packets be processed
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            heap_bytes = HeapDelta(heap_before, GetHeapBytes());
+
+            estimated_bytes = 0.0;
+            for (size_t i = 0; i < metrics.size(); ++i)
+            {
+                const ClientMetrics& m = metrics[i];
+                estimated_bytes += m.entities.entities_memory_bytes + m.entities.metadata_memory_bytes;
+                // Count a shared world only once
+                if (!m.world_shared || i == 0)
+                {
+                    estimated_bytes += m.world.memory_bytes;
+                }
+            }
+
+            for (const auto& c : clients)
+            {
+                // Disconnect deletes the managers
+                KeepAlive(c->GetWorld());
+                KeepAlive(c->GetEntityManager());
+                c->Disconnect();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.GetIterations() * num_bots);
+    if (heap_bytes > 0.0)
+    {
+        state.SetCounter("heap_bytes_per_bot", heap_bytes / num_bots);
+    }
+    state.SetCounter("estimated_bytes_per_bot", estimated_bytes / num_bots);
+}
+#endif
+
+void RegisterMemoryBenchmarks()
+{
+    // Pre 1.18 and 1.18+ overworld heights
+    std::vector<std::pair<int, int> > heights = { { 256, 0 } };
+#if PROTOCOL_VERSION > 756
+    heights.push_back({ 384, -64 });
+#endif
+    for (const auto& h : heights)
+    {
+        for (const int view_distance : { 2, 6, 10 })
+        {
+            Benchmark::Register("Memory/World/height:" + std::to_string(h.first) + "/view_distance:" + std::to_string(view_distance),
+                [view_distance, h](Benchmark::State& state) { MemoryWorld(state, view_distance, h.first, h.second); }, 1);
+        }
+    }
+    for (const int num_entities : { 100, 1000 })
+    {
+        Benchmark::Register("Memory/EntityManager/entities:" + std::to_string(num_entities),
+            [num_entities](Benchmark::State& state) { MemoryEntities(state, num_entities); }, 1);
+    }
+#if PROTOCOL_VERSION > 758
+    Benchmark::Register("Memory/ManagersClient/bots:4",
+        [](Benchmark::State& state) { MemoryManagersClient(state, 4, false); }, 1);
+    Benchmark::Register("Memory/ManagersClient/bots:4/shared_world",
+        [](Benchmark::State& state) { MemoryManagersClient(state, 4, true); }, 1);
+#endif
+}
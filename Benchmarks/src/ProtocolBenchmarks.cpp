@@ -0,0 +1,245 @@
+#include <random>
+
+#include <protocolCraft/BinaryReadWrite.hpp>
+#include <protocolCraft/Types/NBT/NBT.hpp>
+#if PROTOCOL_VERSION > 756
+#include <protocolCraft/Messages/Play/Clientbound/ClientboundLevelChunkWithLightPacket.hpp>
+#endif
+
+#ifdef USE_COMPRESSION
+#include "botcraft/Network/Compression.hpp"
+#endif
+
+#include "Benchmark.hpp"
+#include "TestWorld.hpp"
+
+using namespace ProtocolCraft;
+
+static void VarIntEncode(Benchmark::State& state)
+{
+    std::mt19937 random_engine(42);
+    std::vector<int> values(1024);
+    for (int& v : values)
+    {
+        // Mix of 1 to 5 bytes values
+        v = static_cast<int>(random_engine() >> (random_engine() % 32));
+    }
+
+    std::vector<unsigned char> buffer;
+    buffer.reserve(values.size() * 5);
+    while (state.KeepRunning())
+    {
+        buffer.clear();
+        for (const int v : values)
+        {
+            WriteData<VarInt>(v, buffer);
+        }
+        Benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.GetIterations() * values.size());
+}
+
+static void VarIntDecode(Benchmark::State& state)
+{
+    std::mt19937 random_engine(42);
+    std::vector<unsigned char> buffer;
+    const size_t num_values = 1024;
+    for (size_t i = 0; i < num_values; ++i)
+    {
+        WriteData<VarInt>(static_cast<int>(random_engine() >> (random_engine() % 32)), buffer);
+    }
+
+    while (state.KeepRunning())
+    {
+        ReadIterator iter = buffer.data();
+        size_t length = buffer.size();
+        for (size_t i = 0; i < num_values; ++i)
+        {
+            Benchmark::DoNotOptimize(ReadData<VarInt>(iter, length));
+        }
+    }
+    state.SetItemsProcessed(state.GetIterations() * num_values);
+    state.SetBytesProcessed(state.GetIterations() * buffer.size());
+}
+
+static void WriteNBTName(const std::string& name, std::vector<unsigned char>& container)
+{
+    WriteData<unsigned short>(static_cast<unsigned short>(name.size()), container);
+    container.insert(container.end(), name.begin(), name.end());
+}
+
+/// @brief Create NBT data looking like a list of block entities
+static std::vector<unsigned char> CreateNBTData(const int num_entries)
+{
+    std::vector<unsigned char> output;
+    WriteData<char>(static_cast<char>(TagType::Compound), output);
+    WriteNBTName("", output);
+
+    WriteData<char>(static_cast<char>(TagType::List), output);
+    WriteNBTName("entries", output);
+    WriteData<char>(static_cast<char>(TagType::Compound), output);
+    WriteData<int>(num_entries, output);
+    for (int i = 0; i < num_entries; ++i)
+    {
+        WriteData<char>(static_cast<char>(TagType::Int), output);
+        WriteNBTName("x", output);
+        WriteData<int>(i, output);
+        WriteData<char>(static_cast<char>(TagType::Double), output);
+        WriteNBTName("y", output);
+        WriteData<double>(i * 0.5, output);
+        WriteData<char>(static_cast<char>(TagType::String), output);
+        WriteNBTName("id", output);
+        WriteNBTName("minecraft:chest", output);
+        WriteData<char>(static_cast<char>(TagType::Byte), output);
+        WriteNBTName("open", output);
+        WriteData<char>(i % 2, output);
+        WriteData<char>(static_cast<char>(TagType::End), output);
+    }
+
+    WriteData<char>(static_cast<char>(TagType::LongArray), output);
+    WriteNBTName("heightmap", output);
+    WriteData<int>(256, output);
+    for (int i = 0; i < 256; ++i)
+    {
+        WriteData<long long int>(i * 0x0101010101LL, output);
+    }
+
+    WriteData<char>(static_cast<char>(TagType::End), output);
+    return output;
+}
+
+static void NBTRead(Benchmark::State& state, const bool build_tree)
+{
+    const std::vector<unsigned char> data = CreateNBTData(512);
+    NBT nbt;
+    while (state.KeepRunning())
+    {
+        ReadIterator iter = data.data();
+        size_t length = data.size();
+        nbt.Read(iter, length);
+        if (build_tree)
+        {
+            Benchmark::DoNotOptimize(nbt.GetRoot());
+        }
+    }
+    state.SetBytesProcessed(state.GetIterations() * data.size());
+}
+
+#if PROTOCOL_VERSION > 756
+/// @brief Read a full chunk packet, with light for all sections, either
+/// in a new instance each time or in the same one, as done with the
+/// NetworkManager message pool
+static void LevelChunkWithLightRead(Benchmark::State& state, const bool reuse_instance)
+{
+    const int num_sections = 24;
+    ClientboundLightUpdatePacketData light_data;
+    std::vector<std::vector<char> > light_updates(num_sections + 2, std::vector<char>(2048, 0x0F));
+    light_data.SetSkyYMask({ (1ULL << (num_sections + 2)) - 1 });
+    light_data.SetBlockYMask({ (1ULL << (num_sections + 2)) - 1 });
+    light_data.SetEmptySkyYMask({ 0 });
+    light_data.SetEmptyBlockYMask({ 0 });
+    light_data.SetSkyUpdates(light_updates);
+    light_data.SetBlockUpdates(light_updates);
+    light_data.SetTrustEdges(true);
+
+    ClientboundLevelChunkPacketData chunk_data;
+    chunk_data.SetBuffer(CreateChunkData(4, num_sections));
+
+    ClientboundLevelChunkWithLightPacket msg;
+    msg.SetX(0);
+    msg.SetZ(0);
+    msg.SetChunkData(chunk_data);
+    msg.SetLightData(light_data);
+    std::vector<unsigned char> data;
+    msg.Write(data);
+
+    std::shared_ptr<ClientboundLevelChunkWithLightPacket> instance = std::make_shared<ClientboundLevelChunkWithLightPacket>();
+    while (state.KeepRunning())
+    {
+        if (reuse_instance)
+        {
+            instance->Reset();
+        }
+        else
+        {
+            instance = std::make_shared<ClientboundLevelChunkWithLightPacket>();
+        }
+        ReadIterator iter = data.data();
+        size_t length = data.size();
+        // Packet id, read by the NetworkManager before creating the message
+        ReadData<VarInt>(iter, length);
+        instance->Read(iter, length);
+        Benchmark::DoNotOptimize(instance->GetChunkData().GetBuffer().data());
+    }
+    state.SetBytesProcessed(state.GetIterations() * data.size());
+}
+#endif
+
+#ifdef USE_COMPRESSION
+/// @brief Get data compressing like real packets
+static std::vector<unsigned char> GetCompressibleData()
+{
+#if PROTOCOL_VERSION > 756
+    return CreateChunkData(4, 24);
+#else
+    std::mt19937 random_engine(42);
+    std::vector<unsigned char> output(64 * 1024);
+    for (unsigned char& c : output)
+    {
+        c = static_cast<unsigned char>(random_engine() % 16);
+    }
+    return output;
+#endif
+}
+
+static void CompressionCompress(Benchmark::State& state, const bool use_fast_backend)
+{
+    const std::vector<unsigned char> data = GetCompressibleData();
+    Botcraft::CompressionContext context(-1, use_fast_backend);
+    std::vector<unsigned char> compressed;
+    while (state.KeepRunning())
+    {
+        compressed.clear();
+        context.Compress(data.data(), data.size(), compressed, false);
+    }
+    state.SetBytesProcessed(state.GetIterations() * data.size());
+}
+
+static void CompressionDecompress(Benchmark::State& state, const bool use_fast_backend)
+{
+    const std::vector<unsigned char> data = GetCompressibleData();
+    // Always decompress the output of zlib, as sent by the server,
+    // so both backends decode exactly the same stream
+    std::vector<unsigned char> compressed;
+    Botcraft::CompressionContext(-1, false).Compress(data.data(), data.size(), compressed, false);
+    Botcraft::CompressionContext context(-1, use_fast_backend);
+    std::vector<unsigned char> decompressed;
+    while (state.KeepRunning())
+    {
+        context.Decompress(compressed.data(), compressed.size(), decompressed, data.size());
+    }
+    state.SetBytesProcessed(state.GetIterations() * data.size());
+}
+#endif
+
+void RegisterProtocolBenchmarks()
+{
+    Benchmark::Register("VarInt/Encode", VarIntEncode);
+    Benchmark::Register("VarInt/Decode", VarIntDecode);
+    Benchmark::Register("NBT/Read", [](Benchmark::State& state) { NBTRead(state, false); });
+    Benchmark::Register("NBT/ReadAndBuildTree", [](Benchmark::State& state) { NBTRead(state, true); });
+#if PROTOCOL_VERSION > 756
+    Benchmark::Register("Packet/Read/LevelChunkWithLight", [](Benchmark::State& state) { LevelChunkWithLightRead(state, false); });
+    Benchmark::Register("Packet/Read/LevelChunkWithLight/reused", [](Benchmark::State& state) { LevelChunkWithLightRead(state, true); });
+#endif
+#ifdef USE_COMPRESSION
+    Benchmark::Register("Compression/Compress", [](Benchmark::State& state) { CompressionCompress(state, true); });
+    Benchmark::Register("Compression/Decompress", [](Benchmark::State& state) { CompressionDecompress(state, true); });
+    // Compare with zlib if the default backend is a faster one
+    if (Botcraft::CompressionContext::HasFastBackend())
+    {
+        Benchmark::Register("Compression/Compress/zlib", [](Benchmark::State& state) { CompressionCompress(state, false); });
+        Benchmark::Register("Compression/Decompress/zlib", [](Benchmark::State& state) { CompressionDecompress(state, false); });
+    }
+#endif
+}
@@ -0,0 +1,157 @@
+#include "TestWorld.hpp"
+
+#include <random>
+
+#include <botcraft/Game/AssetsManager.hpp>
+#include <botcraft/Game/World/Blockstate.hpp>
+#include <botcraft/Game/World/World.hpp>
+
+#include <protocolCraft/BinaryReadWrite.hpp>
+
+using namespace Botcraft;
+
+int GetBlockId(const std::string& name)
+{
+#if PROTOCOL_VERSION < 347
+    for (const auto& b : AssetsManager::getInstance().Blockstates())
+    {
+        for (const auto& m : b.second)
+        {
+            if (m.second->GetName() == name)
+            {
+                return b.first;
+            }
+        }
+    }
+#else
+    for (const auto& b : AssetsManager::getInstance().Blockstates())
+    {
+        if (b.second->GetName() == name)
+        {
+            return b.first;
+        }
+    }
+#endif
+    return -1;
+}
+
+std::shared_ptr<World> CreateTestWorld(const int size)
+{
+    std::shared_ptr<World> world = std::make_shared<World>(false);
+    const int stone = GetBlockId("minecraft:stone");
+
+    std::lock_guard<std::mutex> lock(world->GetMutex());
+#if PROTOCOL_VERSION > 756
+    world->SetDimensionHeight("minecraft:overworld", 384);
+    world->SetDimensionMinY("minecraft:overworld", -64);
+    world->SetCurrentDimension("minecraft:overworld");
+#endif
+    for (int x = 0; x < size; ++x)
+    {
+        for (int z = 0; z < size; ++z)
+        {
+#if PROTOCOL_VERSION < 719
+            world->AddChunk(x, z, Dimension::Overworld);
+#else
+            world->AddChunk(x, z, "minecraft:overworld");
+#endif
+        }
+    }
+
+    const int width = size * CHUNK_WIDTH;
+    for (int x = 0; x < width; ++x)
+    {
+        for (int z = 0; z < width; ++z)
+        {
+            Position pos(x, 0, z);
+#if PROTOCOL_VERSION < 347
+            world->SetBlock(pos, stone, 0);
+#else
+            world->SetBlock(pos, stone);
+#endif
+            // Walls along X every 8 blocks, with one gap at a different place for each wall
+            if (z % 8 == 7 && x % 32 != (z * 5) % 32)
+            {
+                for (int y = 1; y < 3; ++y)
+                {
+                    pos.y = y;
+#if PROTOCOL_VERSION < 347
+                    world->SetBlock(pos, stone, 0);
+#else
+                    world->SetBlock(pos, stone);
+#endif
+                }
+            }
+        }
+    }
+    world->PublishSnapshot();
+
+    return world;
+}
+
+#if PROTOCOL_VERSION > 756
+std::vector<unsigned char> CreateChunkData(const int bits_per_block, const int num_sections)
+{
+    std::vector<int> ids;
+    for (const auto& b : AssetsManager::getInstance().Blockstates())
+    {
+        // Skip the default blockstate (-1), and the ones
+        // without model if the assets are incomplete
+        if (b.first >= 0 && b.second->GetNumModels() > 0)
+        {
+            ids.push_back(b.first);
+        }
+    }
+
+    std::mt19937 random_engine(42);
+    std::vector<unsigned char> output;
+    for (int s = 0; s < num_sections; ++s)
+    {
+        ProtocolCraft::WriteData<short>(4096, output);
+        ProtocolCraft::WriteData<unsigned char>(bits_per_block, output);
+        int max_value = 0;
+        if (bits_per_block == 0)
+        {
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(ids[random_engine() % ids.size()], output);
+        }
+        else if (bits_per_block <= 8)
+        {
+            // Palette with all the possible values
+            max_value = 1 << bits_per_block;
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(max_value, output);
+            for (int i = 0; i < max_value; ++i)
+            {
+                ProtocolCraft::WriteData<ProtocolCraft::VarInt>(ids[random_engine() % ids.size()], output);
+            }
+        }
+
+        if (bits_per_block == 0)
+        {
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(0, output);
+        }
+        else
+        {
+            // Entries don't span across multiple longs
+            const int values_per_long = 64 / bits_per_block;
+            std::vector<unsigned long long int> data_array((4096 + values_per_long - 1) / values_per_long, 0);
+            for (int i = 0; i < 4096; ++i)
+            {
+                const unsigned long long int value = bits_per_block <= 8 ? random_engine() % max_value : ids[random_engine() % ids.size()];
+                data_array[i / values_per_long] |= value << ((i % values_per_long) * bits_per_block);
+            }
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(data_array.size()), output);
+            for (const unsigned long long int l : data_array)
+            {
+                ProtocolCraft::WriteData<unsigned long long int>(l, output);
+            }
+        }
+
+        // Single value biomes
+        ProtocolCraft::WriteData<unsigned char>(0, output);
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(0, output);
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(0, output);
+    }
+
+    return output;
+}
+#endif
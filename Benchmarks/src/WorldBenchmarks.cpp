@@ -0,0 +1,264 @@
+#include <random>
+
+#include <botcraft/AI/Tasks/PathfindingTask.hpp>
+#include <botcraft/Game/Entities/EntityManager.hpp>
+#include <botcraft/Game/Physics/PhysicsManager.hpp>
+#include <botcraft/Game/World/BlockAccessor.hpp>
+#include <botcraft/Game/World/Chunk.hpp>
+#include <botcraft/Game/World/Section.hpp>
+#include <botcraft/Game/World/World.hpp>
+#include <botcraft/Game/World/WorldSnapshot.hpp>
+
+#include "Benchmark.hpp"
+#include "TestWorld.hpp"
+
+using namespace Botcraft;
+
+#if PROTOCOL_VERSION > 756
+static void ChunkLoadChunkData(Benchmark::State& state, const int bits_per_block)
+{
+    const std::vector<unsigned char> data = CreateChunkData(bits_per_block, 24);
+    Chunk chunk(-64, 384);
+    while (state.KeepRunning())
+    {
+        chunk.LoadChunkData(data);
+    }
+    Benchmark::DoNotOptimize(chunk);
+    state.SetBytesProcessed(state.GetIterations() * data.size());
+    state.SetItemsProcessed(state.GetIterations() * 24);
+}
+#endif
+
+static void WorldGetBlockRandom(Benchmark::State& state)
+{
+    std::shared_ptr<World> world = CreateTestWorld(8);
+    std::mt19937 random_engine(42);
+    std::uniform_int_distribution<int> horizontal(0, 8 * CHUNK_WIDTH - 1);
+    std::uniform_int_distribution<int> vertical(0, 3);
+    std::vector<Position> positions(4096);
+    for (Position& p : positions)
+    {
+        p = Position(horizontal(random_engine), vertical(random_engine), horizontal(random_engine));
+    }
+
+    std::lock_guard<std::mutex> lock(world->GetMutex());
+    size_t i = 0;
+    while (state.KeepRunning())
+    {
+        Benchmark::DoNotOptimize(world->GetBlock(positions[i++ & 4095]));
+    }
+    state.SetItemsProcessed(state.GetIterations());
+}
+
+static void WorldGetBlockSequential(Benchmark::State& state)
+{
+    std::shared_ptr<World> world = CreateTestWorld(8);
+    std::lock_guard<std::mutex> lock(world->GetMutex());
+    Position pos(0, 0, 0);
+    while (state.KeepRunning())
+    {
+        Benchmark::DoNotOptimize(world->GetBlock(pos));
+        // y, then z, then x, as in a section scan
+        pos.y += 1;
+        if (pos.y == 4)
+        {
+            pos.y = 0;
+            pos.z += 1;
+            if (pos.z == 8 * CHUNK_WIDTH)
+            {
+                pos.z = 0;
+                pos.x = (pos.x + 1) % (8 * CHUNK_WIDTH);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.GetIterations());
+}
+
+static void SectionGetBlockNeighbours(Benchmark::State& state)
+{
+    // Random blocks from a 16 entries palette, so the indices are bit packed
+    Section section;
+    std::mt19937 random_engine(42);
+    std::uniform_int_distribution<int> block_id(1, 16);
+    for (int i = 0; i < Section::NUM_BLOCKS; ++i)
+    {
+#if PROTOCOL_VERSION < 347
+        section.SetBlock(i, Block(block_id(random_engine), 0));
+#else
+        section.SetBlock(i, Block(block_id(random_engine)));
+#endif
+    }
+
+    // Visit the 6 neighbours of every block inside the section,
+    // like flood fills and pathfinding expansions do
+    constexpr int dy = CHUNK_WIDTH * CHUNK_WIDTH;
+    constexpr int dz = CHUNK_WIDTH;
+    while (state.KeepRunning())
+    {
+        for (int y = 1; y < SECTION_HEIGHT - 1; ++y)
+        {
+            for (int z = 1; z < CHUNK_WIDTH - 1; ++z)
+            {
+                for (int x = 1; x < CHUNK_WIDTH - 1; ++x)
+                {
+                    const int index = y * dy + z * dz + x;
+                    Benchmark::DoNotOptimize(section.GetBlock(index - 1));
+                    Benchmark::DoNotOptimize(section.GetBlock(index + 1));
+                    Benchmark::DoNotOptimize(section.GetBlock(index - dz));
+                    Benchmark::DoNotOptimize(section.GetBlock(index + dz));
+                    Benchmark::DoNotOptimize(section.GetBlock(index - dy));
+                    Benchmark::DoNotOptimize(section.GetBlock(index + dy));
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.GetIterations() * 6 * (SECTION_HEIGHT - 2) * (CHUNK_WIDTH - 2) * (CHUNK_WIDTH - 2));
+}
+
+static void WorldSnapshotGetBlockRandom(Benchmark::State& state)
+{
+    std::shared_ptr<World> world = CreateTestWorld(8);
+    std::mt19937 random_engine(42);
+    std::uniform_int_distribution<int> horizontal(0, 8 * CHUNK_WIDTH - 1);
+    std::uniform_int_distribution<int> vertical(0, 3);
+    std::vector<Position> positions(4096);
+    for (Position& p : positions)
+    {
+        p = Position(horizontal(random_engine), vertical(random_engine), horizontal(random_engine));
+    }
+
+    const WorldSnapshot snapshot = world->GetSnapshot();
+    size_t i = 0;
+    while (state.KeepRunning())
+    {
+        Benchmark::DoNotOptimize(snapshot.GetBlock(positions[i++ & 4095]));
+    }
+    state.SetItemsProcessed(state.GetIterations());
+}
+
+/// @brief Read the 3x3x3 neighbourhood of all the blocks of a 32x4x32 area,
+/// either with one WorldSnapshot::GetBlock per block or with a BlockAccessor
+static void WorldSnapshotGetNeighbourhood(Benchmark::State& state, const bool use_accessor)
+{
+    std::shared_ptr<World> world = CreateTestWorld(4);
+    const WorldSnapshot snapshot = world->GetSnapshot();
+    std::array<const Block*, 27> blocks;
+    while (state.KeepRunning())
+    {
+        BlockAccessor accessor(snapshot, Position(1, 1, 1));
+        for (int x = 1; x < 33; ++x)
+        {
+            for (int z = 1; z < 33; ++z)
+            {
+                for (int y = 1; y < 5; ++y)
+                {
+                    if (use_accessor)
+                    {
+                        accessor.MoveTo(Position(x, y, z));
+                        accessor.GetNeighbourhood(blocks);
+                    }
+                    else
+                    {
+                        int i = 0;
+                        for (int dy = -1; dy < 2; ++dy)
+                        {
+                            for (int dz = -1; dz < 2; ++dz)
+                            {
+                                for (int dx = -1; dx < 2; ++dx)
+                                {
+                                    blocks[i++] = snapshot.GetBlock(Position(x + dx, y + dy, z + dz));
+                                }
+                            }
+                        }
+                    }
+                    Benchmark::DoNotOptimize(blocks);
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.GetIterations() * 32 * 32 * 4 * 27);
+}
+
+static void PathfindingFindPath(Benchmark::State& state, const int distance, const bool cached)
+{
+    std::shared_ptr<World> world = CreateTestWorld(8);
+    const int stone = GetBlockId("minecraft:stone");
+    const Position start(2, 1, 2);
+    const Position end(2 + distance, 1, 2 + distance);
+    // Block above the start, changed to invalidate the cached path
+    const Position invalidate_pos(start.x, 10, start.z);
+    size_t path_length = 0;
+    int i = 0;
+    while (state.KeepRunning())
+    {
+        if (!cached)
+        {
+            state.PauseTiming();
+            {
+                std::lock_guard<std::mutex> lock(world->GetMutex());
+#if PROTOCOL_VERSION < 347
+                world->SetBlock(invalidate_pos, (i++ % 2) * stone, 0);
+#else
+                world->SetBlock(invalidate_pos, (i++ % 2) * stone);
+#endif
+                world->PublishSnapshot();
+            }
+            state.ResumeTiming();
+        }
+        const std::vector<Position> path = FindPath(world, start, end, 0, true);
+        path_length = path.size();
+        Benchmark::DoNotOptimize(path_length);
+    }
+    state.SetItemsProcessed(state.GetIterations() * path_length);
+}
+
+static void PhysicsSimulate(Benchmark::State& state, const int n_ticks)
+{
+    std::shared_ptr<World> world = CreateTestWorld(8);
+    std::shared_ptr<EntityManager> entity_manager = std::make_shared<EntityManager>();
+    PhysicsManager physics_manager(
+#if USE_GUI
+        nullptr,
+#endif
+        entity_manager, world, nullptr);
+
+    PlayerPhysicsState initial_state;
+    initial_state.position = Vector3<double>(4.5, 1.0, 4.5);
+    initial_state.on_ground = true;
+    // Walk diagonally, so the player keeps hitting the walls
+    const std::vector<Vector3<double> > inputs(n_ticks, Vector3<double>(0.1, 0.0, 0.1));
+
+    while (state.KeepRunning())
+    {
+        Benchmark::DoNotOptimize(physics_manager.Simulate(initial_state, inputs, n_ticks));
+    }
+    state.SetItemsProcessed(state.GetIterations() * n_ticks);
+}
+
+void RegisterWorldBenchmarks()
+{
+#if PROTOCOL_VERSION > 756
+    for (const int bits_per_block : { 0, 4, 8, 15 })
+    {
+        Benchmark::Register("Chunk/LoadChunkData/bits_per_block:" + std::to_string(bits_per_block),
+            [bits_per_block](Benchmark::State& state) { ChunkLoadChunkData(state, bits_per_block); });
+    }
+#endif
+    Benchmark::Register("World/GetBlock/random", WorldGetBlockRandom);
+    Benchmark::Register("World/GetBlock/sequential", WorldGetBlockSequential);
+    Benchmark::Register("WorldSnapshot/GetBlock/random", WorldSnapshotGetBlockRandom);
+    Benchmark::Register("Section/GetBlock/neighbours", SectionGetBlockNeighbours);
+    Benchmark::Register("WorldSnapshot/GetBlock/neighbourhood",
+        [](Benchmark::State& state) { WorldSnapshotGetNeighbourhood(state, false); });
+    Benchmark::Register("BlockAccessor/GetNeighbourhood",
+        [](Benchmark::State& state) { WorldSnapshotGetNeighbourhood(state, true); });
+    for (const int distance : { 16, 64, 120 })
+    {
+        Benchmark::Register("Pathfinding/FindPath/distance:" + std::to_string(distance),
+            [distance](Benchmark::State& state) { PathfindingFindPath(state, distance, false); });
+    }
+    Benchmark::Register("Pathfinding/FindPath/distance:120/cached",
+        [](Benchmark::State& state) { PathfindingFindPath(state, 120, true); });
+    Benchmark::Register("Physics/Simulate/ticks:20",
+        [](Benchmark::State& state) { PhysicsSimulate(state, 20); });
+}
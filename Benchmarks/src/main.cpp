@@ -0,0 +1,168 @@
+#include <iostream>
+#include <string>
+
+#include <botcraft/Game/AssetsManager.hpp>
+#include <botcraft/Utilities/Logger.hpp>
+
+#include "Benchmark.hpp"
+
+void RegisterAIBenchmarks();
+void RegisterMemoryBenchmarks();
+void RegisterProtocolBenchmarks();
+void RegisterWorldBenchmarks();
+
+void ShowHelp(const char* argv0)
+{
+    std::cout << "Usage: " << argv0 << " <options>\n"
+        << "Run botcraft micro-benchmarks\n"
+        << "Options:\n"
+        << "\t-h, --help\tShow this help message\n"
+        << "\t--list\t\tList the available benchmarks and exit\n"
+        << "\t--filter\tRegex, only run the benchmarks with a matching name, default: all\n"
+        << "\t--min_time\tMin duration in seconds of each measured run, default: 0.5\n"
+        << "\t--json\t\tSave the results in this file, in Google Benchmark JSON format, default: empty\n"
+        << "\t--baseline\tCompare the counters (e.g. Memory/* bytes) with this previous --json file, fail if one increased, default: empty\n"
+        << "\t--tolerance\tMax relative increase of a counter compared to the baseline, default: 0.05\n"
+        << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // Only log errors, to not disturb the results
+        Botcraft::Logger::GetInstance().SetLogLevel(Botcraft::LogLevel::Error);
+        Botcraft::Logger::GetInstance().SetFilename("");
+        Botcraft::Logger::GetInstance().RegisterThread("main");
+
+        std::string filter = "";
+        double min_time = 0.5;
+        std::string json_path = "";
+        std::string baseline_path = "";
+        double tolerance = 0.05;
+        bool list = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help")
+            {
+                ShowHelp(argv[0]);
+                return 0;
+            }
+            else if (arg == "--list")
+            {
+                list = true;
+            }
+            else if (arg == "--filter")
+            {
+                if (i + 1 < argc)
+                {
+                    filter = argv[++i];
+                }
+                else
+                {
+                    LOG_FATAL("--filter requires an argument");
+                    return 1;
+                }
+            }
+            else if (arg == "--min_time")
+            {
+                if (i + 1 < argc)
+                {
+                    min_time = std::stod(argv[++i]);
+                }
+                else
+                {
+                    LOG_FATAL("--min_time requires an argument");
+                    return 1;
+                }
+            }
+            else if (arg == "--json")
+            {
+                if (i + 1 < argc)
+                {
+                    json_path = argv[++i];
+                }
+                else
+                {
+                    LOG_FATAL("--json requires an argument");
+                    return 1;
+                }
+            }
+            else if (arg == "--baseline")
+            {
+                if (i + 1 < argc)
+                {
+                    baseline_path = argv[++i];
+                }
+                else
+                {
+                    LOG_FATAL("--baseline requires an argument");
+                    return 1;
+                }
+            }
+            else if (arg == "--tolerance")
+            {
+                if (i + 1 < argc)
+                {
+                    tolerance = std::stod(argv[++i]);
+                }
+                else
+                {
+                    LOG_FATAL("--tolerance requires an argument");
+                    return 1;
+                }
+            }
+            else
+            {
+                LOG_FATAL("Unknown option " << arg);
+                return 1;
+            }
+        }
+
+        // First, see KeepAlive in MemoryBenchmarks.cpp
+        RegisterMemoryBenchmarks();
+        RegisterAIBenchmarks();
+        RegisterProtocolBenchmarks();
+        RegisterWorldBenchmarks();
+
+        if (list)
+        {
+            for (const std::string& name : Benchmark::GetNames())
+            {
+                std::cout << name << std::endl;
+            }
+            return 0;
+        }
+
+        // Load the assets before any measure
+        Botcraft::AssetsManager::getInstance();
+
+        const Benchmark::RunSummary summary = Benchmark::Run(filter, min_time, json_path, baseline_path, tolerance);
+        if (summary.num_run == 0)
+        {
+            LOG_ERROR("No benchmark matching " << filter);
+            return 1;
+        }
+        if (summary.num_regressions > 0)
+        {
+            LOG_ERROR(summary.num_regressions << " counter(s) increased by more than " << 100.0 * tolerance << "% compared to " << baseline_path);
+            return 1;
+        }
+
+        return 0;
+    }
+    catch (std::exception& e)
+    {
+        LOG_FATAL("Exception: " << e.what());
+        return 1;
+    }
+    catch (...)
+    {
+        LOG_FATAL("Unknown exception");
+        return 2;
+    }
+
+    return 0;
+}
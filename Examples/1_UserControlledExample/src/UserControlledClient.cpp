@@ -44,6 +44,7 @@ UserControlledClient::UserControlledClient(bool online, bool use_renderer_) : Ma
 
             rendering_manager->SetMouseCallback(std::bind(&UserControlledClient::MouseCallback, this, std::placeholders::_1, std::placeholders::_2));
             rendering_manager->SetKeyboardCallback(std::bind(&UserControlledClient::KeyBoardCallback, this, std::placeholders::_1, std::placeholders::_2));
+            rendering_manager->SetNetworkManager(network_manager);
         }
         physics_manager = std::make_shared<PhysicsManager>(rendering_manager, entity_manager, world, network_manager);
 #else
@@ -234,7 +235,7 @@ void UserControlledClient::CreateTestWorld()
 
             const Block *block = world->GetBlock(pos);
             const Blockstate* previous_blockstate;
-            unsigned char previous_model_id;
+            int previous_model_id;
             if (block != nullptr)
             {
                 previous_blockstate = block->GetBlockstate();
@@ -247,7 +248,7 @@ void UserControlledClient::CreateTestWorld()
 #else
                 previous_blockstate = AssetsManager::getInstance().Blockstates().at(0).get();
 #endif
-                previous_model_id = 0;
+                previous_model_id = -1;
             }
 #if PROTOCOL_VERSION < 347
             world->SetBlock(pos, 18, 0);
@@ -274,7 +275,7 @@ void UserControlledClient::CreateTestWorld()
 #else
                 previous_blockstate = AssetsManager::getInstance().Blockstates().at(0).get();
 #endif
-                previous_model_id = 0;
+                previous_model_id = -1;
             }
 
 #if PROTOCOL_VERSION < 347
@@ -299,6 +300,9 @@ void UserControlledClient::CreateTestWorld()
         }
     }
 #endif
+
+    // Make the test world visible to physics
+    world->PublishSnapshot();
     
     entity_manager->GetLocalPlayer()->SetPosition(Vector3<double>(0.5, 1.0, 0.5));
 }
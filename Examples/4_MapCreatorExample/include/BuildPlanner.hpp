@@ -0,0 +1,83 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <botcraft/Game/Vector3.hpp>
+
+namespace Botcraft
+{
+    class SwarmCoordinator;
+}
+
+/// @brief Split the structure between all the bots so they don't all
+/// search the whole structure and rush to the same blocks.
+/// The structure is cut in vertical tiles. Each bot claims the closest
+/// free one and gets a queue of all the positions in it, bottom layers
+/// first. When a bot runs out of work, it claims a new tile or, once
+/// they are all claimed, steals half of the biggest queue.
+/// With a coordinator, tiles are also claimed across all the processes
+/// of the swarm. Work stealing stays within this process.
+class BuildPlanner
+{
+public:
+    static BuildPlanner& GetInstance();
+
+    /// @brief Set the structure bounds. Reset all tiles and queues if they changed
+    /// @param start_ Min corner of the structure
+    /// @param end_ Max corner of the structure
+    void Init(const Botcraft::Position& start_, const Botcraft::Position& end_);
+
+    /// @brief Get the next position to check for a bot. Claim a new tile or steal work if needed
+    /// @param bot_name Name of the bot
+    /// @param bot_position Current position of the bot, used to claim the closest tile
+    /// @param pos Output position
+    /// @return False if there is nothing left to do for this bot
+    bool Next(const std::string& bot_name, const Botcraft::Position& bot_position, Botcraft::Position& pos);
+
+    /// @brief Put a position that can't be done right now at the back of the bot queue
+    /// @param bot_name Name of the bot
+    /// @param pos Position to retry later
+    void Defer(const std::string& bot_name, const Botcraft::Position& pos);
+
+    /// @brief Number of positions left in a bot queue
+    /// @param bot_name Name of the bot
+    /// @return The size of its queue
+    size_t QueueSize(const std::string& bot_name);
+
+    /// @brief Drop all the positions left in a bot queue, so it moves
+    /// to another tile. They will be checked again by the global search
+    /// @param bot_name Name of the bot
+    void Release(const std::string& bot_name);
+
+    /// @brief Share the tiles with the other processes of a swarm
+    /// @param coordinator_ The coordinator, nullptr to stop sharing
+    void SetCoordinator(const std::shared_ptr<Botcraft::SwarmCoordinator>& coordinator_);
+
+private:
+    BuildPlanner();
+
+    /// @brief Fill the queue of a bot with a new tile or stolen positions. mutex must be locked
+    /// @return False if there is no work left
+    bool Refill(const std::string& bot_name, const Botcraft::Position& bot_position);
+
+private:
+    /// @brief Width (X and Z) of a tile
+    static constexpr int tile_size = 16;
+
+    std::mutex mutex;
+
+    Botcraft::Position start;
+    Botcraft::Position end;
+    bool initialized;
+
+    /// @brief Min corner (y = start.y) of all tiles not claimed yet
+    std::vector<Botcraft::Position> free_tiles;
+    std::map<std::string, std::deque<Botcraft::Position> > queues;
+
+    std::shared_ptr<Botcraft::SwarmCoordinator> coordinator;
+};
@@ -29,7 +29,8 @@ Botcraft::Status GetBlocksAvailableInInventory(Botcraft::BehaviourClient& c);
 /// @return Success if all the items were deposited/the inventory is full, Failure otherwise
 Botcraft::Status SwapChestsInventory(Botcraft::BehaviourClient& c, const std::string& food_name, const bool take_from_chest);
 
-/// @brief Read block list in blackboard at Inventory.block_list and fill in NextTask.action, NextTask.pos, NextTask.face and NextTask.item
+/// @brief Read block list in blackboard at Inventory.block_list and fill in NextTask.action, NextTask.pos, NextTask.face and NextTask.item.
+/// Positions are first taken from the part of the structure assigned to this bot by BuildPlanner
 /// @param c The client performing the action
 /// @return success if a task was found, failure otherwise
 Botcraft::Status FindNextTask(Botcraft::BehaviourClient& c);
@@ -50,9 +51,9 @@ Botcraft::Status CheckCompletion(Botcraft::BehaviourClient& c);
 /// @return Always return success
 Botcraft::Status WarnConsole(Botcraft::BehaviourClient& c, const std::string& msg);
 
-/// @brief Loads a NBT file (unzipped) and store the target structure in the blackboard of the given client
+/// @brief Loads a NBT file and store the target structure in the blackboard of the given client
 /// @param c The client performing the action
-/// @param path The path to the unzipped NBT file
+/// @param path The path to the NBT file, gzip compressed or not
 /// @param offset Starting offset position to build the structure
 /// @param temp_block Minecraft item/block name used as scafholding block in the NBT
 /// @param log_info Whether or not the loading information should be logged
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <botcraft/Game/Vector3.hpp>
+
+namespace Botcraft
+{
+    class Blockstate;
+    class World;
+}
+
+/// @brief Differences between the target structure and the world.
+/// The whole structure is compared once, then only the blocks modified
+/// in the world block changes journal are checked again. The structure
+/// part of a chunk is scanned again only if the chunk has been loaded
+/// or unloaded. If the journal is disabled or overflowed, everything is
+/// compared again
+class StructureDiff
+{
+public:
+    StructureDiff(const Botcraft::Position& start_, const Botcraft::Position& end_,
+        const std::vector<std::vector<std::vector<short> > >& target_, const std::map<short, std::string>& palette_);
+
+    /// @brief Apply the world changes since the last call
+    /// @param world The world the structure is built in, its mutex must NOT be locked
+    /// @param full_rescan If true, compare all the blocks of the structure again
+    void Update(Botcraft::World& world, const bool full_rescan = false);
+
+    /// @brief Positions where a block is expected, but there is air or the chunk is not loaded
+    const std::unordered_set<Botcraft::Position>& GetMissing() const;
+
+    /// @brief Positions with a different block than the expected one, air included
+    const std::unordered_set<Botcraft::Position>& GetWrong() const;
+
+    /// @brief Number of positions matching the target
+    const size_t GetNumDone() const;
+
+    /// @brief Check if a position matches the target
+    /// @param pos World position, inside the structure
+    const bool IsDone(const Botcraft::Position& pos) const;
+
+    /// @brief Check if all the positions match the target
+    const bool IsComplete() const;
+
+private:
+    /// @brief Move a position to the right set
+    /// @param pos World position, inside the structure
+    /// @param blockstate Current blockstate, nullptr if not loaded
+    void UpdatePosition(const Botcraft::Position& pos, const Botcraft::Blockstate* blockstate);
+
+    /// @brief Compare all the blocks of the structure in a chunk column. World mutex must be locked
+    void ScanChunk(Botcraft::World& world, const std::pair<int, int>& chunk);
+
+private:
+    Botcraft::Position start;
+    Botcraft::Position end;
+    std::vector<std::vector<std::vector<short> > > target;
+    std::map<short, std::string> palette;
+
+    std::unordered_set<Botcraft::Position> missing;
+    std::unordered_set<Botcraft::Position> wrong;
+
+    /// @brief All the chunk columns overlapping the structure
+    std::vector<std::pair<int, int> > chunks;
+    /// @brief Blocks version of each chunk during the last update
+    std::vector<unsigned long long> chunk_versions;
+    /// @brief Number of chunk loads/unloads during the last update
+    unsigned long long chunk_events;
+    /// @brief Sequence number of the last journal change applied
+    unsigned long long last_change;
+    bool initialized;
+};
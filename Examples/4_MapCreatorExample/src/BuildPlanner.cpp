@@ -0,0 +1,155 @@
+#include "BuildPlanner.hpp"
+
+#include <algorithm>
+
+#include <botcraft/AI/SwarmCoordinator.hpp>
+
+using namespace Botcraft;
+
+BuildPlanner::BuildPlanner()
+{
+    initialized = false;
+}
+
+BuildPlanner& BuildPlanner::GetInstance()
+{
+    static BuildPlanner instance;
+
+    return instance;
+}
+
+void BuildPlanner::Init(const Position& start_, const Position& end_)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (initialized && start == start_ && end == end_)
+    {
+        return;
+    }
+
+    start = start_;
+    end = end_;
+    queues.clear();
+    free_tiles.clear();
+    for (int x = start.x; x <= end.x; x += tile_size)
+    {
+        for (int z = start.z; z <= end.z; z += tile_size)
+        {
+            free_tiles.push_back(Position(x, start.y, z));
+        }
+    }
+    initialized = true;
+}
+
+bool BuildPlanner::Next(const std::string& bot_name, const Position& bot_position, Position& pos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::deque<Position>& queue = queues[bot_name];
+    if (queue.empty() && !Refill(bot_name, bot_position))
+    {
+        return false;
+    }
+
+    pos = queue.front();
+    queue.pop_front();
+    return true;
+}
+
+void BuildPlanner::Defer(const std::string& bot_name, const Position& pos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    queues[bot_name].push_back(pos);
+}
+
+size_t BuildPlanner::QueueSize(const std::string& bot_name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queues[bot_name].size();
+}
+
+void BuildPlanner::Release(const std::string& bot_name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    queues[bot_name].clear();
+}
+
+void BuildPlanner::SetCoordinator(const std::shared_ptr<SwarmCoordinator>& coordinator_)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    coordinator = coordinator_;
+}
+
+bool BuildPlanner::Refill(const std::string& bot_name, const Position& bot_position)
+{
+    std::deque<Position>& queue = queues[bot_name];
+
+    while (!free_tiles.empty())
+    {
+        // Claim the closest free tile
+        auto closest = std::min_element(free_tiles.begin(), free_tiles.end(),
+            [&bot_position](const Position& a, const Position& b)
+            {
+                const Position center_offset(tile_size / 2, 0, tile_size / 2);
+                const Position a_center(a.x + center_offset.x, bot_position.y, a.z + center_offset.z);
+                const Position b_center(b.x + center_offset.x, bot_position.y, b.z + center_offset.z);
+                return bot_position.SqrDist(a_center) < bot_position.SqrDist(b_center);
+            });
+        const Position tile = *closest;
+        free_tiles.erase(closest);
+
+        // Already claimed by another process, it won't be free again
+        if (coordinator && !coordinator->Claim("build/" + std::to_string(tile.x) + "/" + std::to_string(tile.z)))
+        {
+            continue;
+        }
+
+        std::vector<Position> positions;
+        for (int x = tile.x; x < std::min(tile.x + tile_size, end.x + 1); ++x)
+        {
+            for (int y = start.y; y <= end.y; ++y)
+            {
+                for (int z = tile.z; z < std::min(tile.z + tile_size, end.z + 1); ++z)
+                {
+                    positions.push_back(Position(x, y, z));
+                }
+            }
+        }
+
+        // Bottom layers first, as blocks need support to be placed,
+        // then closest to the bot
+        std::sort(positions.begin(), positions.end(),
+            [&bot_position](const Position& a, const Position& b)
+            {
+                if (a.y != b.y)
+                {
+                    return a.y < b.y;
+                }
+                return bot_position.SqrDist(a) < bot_position.SqrDist(b);
+            });
+
+        queue.assign(positions.begin(), positions.end());
+        return true;
+    }
+
+    // All tiles are claimed, help the bot with the most remaining work
+    auto biggest = queues.end();
+    for (auto it = queues.begin(); it != queues.end(); ++it)
+    {
+        if (it->first != bot_name && (biggest == queues.end() || it->second.size() > biggest->second.size()))
+        {
+            biggest = it;
+        }
+    }
+
+    if (biggest == queues.end() || biggest->second.size() < 2)
+    {
+        return false;
+    }
+
+    // Steal the back half, the other bot will do the front one first
+    std::deque<Position>& other_queue = biggest->second;
+    const size_t half = other_queue.size() / 2;
+    queue.assign(other_queue.end() - half, other_queue.end());
+    other_queue.erase(other_queue.end() - half, other_queue.end());
+
+    return true;
+}
@@ -1,4 +1,6 @@
 #include "MapCreationTasks.hpp"
+#include "BuildPlanner.hpp"
+#include "StructureDiff.hpp"
 
 #include <botcraft/Network/NetworkManager.hpp>
 #include <botcraft/Game/AssetsManager.hpp>
@@ -10,18 +12,43 @@
 #include <botcraft/Game/Inventory/Window.hpp>
 #include <botcraft/AI/Tasks/AllTasks.hpp>
 #include <botcraft/Utilities/Logger.hpp>
-
-#include <protocolCraft/Types/NBT/TagList.hpp>
-#include <protocolCraft/Types/NBT/TagString.hpp>
-#include <protocolCraft/Types/NBT/TagInt.hpp>
+#include <botcraft/Utilities/NBTStreamReader.hpp>
 
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <unordered_set>
 
 using namespace Botcraft;
 using namespace ProtocolCraft;
 
+// Read or written at each task selection, interned once
+static const BlackboardKey<Position> structure_start_key("Structure.start");
+static const BlackboardKey<Position> structure_end_key("Structure.end");
+static const BlackboardKey<std::vector<std::vector<std::vector<short> > > > structure_target_key("Structure.target");
+static const BlackboardKey<std::map<short, std::string> > structure_palette_key("Structure.palette");
+static const BlackboardKey<std::set<std::string> > inventory_block_list_key("Inventory.block_list");
+static const BlackboardKey<std::string> next_task_action_key("NextTask.action");
+static const BlackboardKey<Position> next_task_block_position_key("NextTask.block_position");
+static const BlackboardKey<PlayerDiggingFace> next_task_face_key("NextTask.face");
+static const BlackboardKey<std::string> next_task_item_key("NextTask.item");
+static const BlackboardKey<std::shared_ptr<StructureDiff> > structure_diff_key("Structure.diff");
+
+/// @brief Get the diff between the structure and the world, created on first use and up to date
+/// @param full_rescan If true, compare all the blocks again instead of only the modified ones
+static StructureDiff& GetUpToDateStructureDiff(BehaviourClient& c, const bool full_rescan = false)
+{
+    Blackboard& blackboard = c.GetBlackboard();
+    std::shared_ptr<StructureDiff>& diff = blackboard.GetRef(structure_diff_key, nullptr);
+    if (diff == nullptr)
+    {
+        diff = std::make_shared<StructureDiff>(blackboard.Get(structure_start_key), blackboard.Get(structure_end_key),
+            blackboard.Get(structure_target_key), blackboard.Get(structure_palette_key));
+    }
+    diff->Update(*c.GetWorld(), full_rescan);
+    return *diff;
+}
+
 Status GetAllChestsAround(BehaviourClient& c)
 {
     std::vector<Position> chests_pos;
@@ -31,34 +58,41 @@ Status GetAllChestsAround(BehaviourClient& c)
 
     const Position player_position(local_player->GetX(), local_player->GetY(), local_player->GetZ());
 
-    Position checked_position;
+    // Get the bounds of the loaded area
+    Position min_pos;
+    Position max_pos;
     {
         std::lock_guard<std::mutex> world_guard(world->GetMutex());
-        const Block* block;
-        const std::map<std::pair<int, int>, std::shared_ptr<Chunk> >& all_chunks = world->GetAllChunks();
+        const std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, ChunkCoordinatesHasher>& all_chunks = world->GetAllChunks();
+
+        if (all_chunks.empty())
+        {
+            c.GetBlackboard().Set("World.ChestsPos", chests_pos);
+            return Status::Success;
+        }
 
+        min_pos = Position(all_chunks.begin()->first.first * CHUNK_WIDTH, world->GetMinY(), all_chunks.begin()->first.second * CHUNK_WIDTH);
+        max_pos = min_pos;
         for (auto it = all_chunks.begin(); it != all_chunks.end(); ++it)
         {
-            for (int x = 0; x < CHUNK_WIDTH; ++x)
-            {
-                checked_position.x = it->first.first * CHUNK_WIDTH + x;
-                for (int y = 0; y < world->GetHeight(); ++y)
-                {
-                    checked_position.y = y + world->GetMinY();
-                    for (int z = 0; z < CHUNK_WIDTH; ++z)
-                    {
-                        checked_position.z = it->first.second * CHUNK_WIDTH + z;
-                        block = world->GetBlock(checked_position);
-                        if (block && block->GetBlockstate()->GetName() == "minecraft:chest")
-                        {
-                            chests_pos.push_back(checked_position);
-                        }
-                    }
-                }
-            }
+            min_pos.x = std::min(min_pos.x, it->first.first * CHUNK_WIDTH);
+            min_pos.z = std::min(min_pos.z, it->first.second * CHUNK_WIDTH);
+            max_pos.x = std::max(max_pos.x, it->first.first * CHUNK_WIDTH + CHUNK_WIDTH - 1);
+            max_pos.z = std::max(max_pos.z, it->first.second * CHUNK_WIDTH + CHUNK_WIDTH - 1);
         }
+        max_pos.y = world->GetMinY() + world->GetHeight() - 1;
     }
 
+    world->ForEachBlockInBox(min_pos, max_pos,
+        [&](const Position& pos, const Block&)
+        {
+            chests_pos.push_back(pos);
+        },
+        [](const Blockstate* blockstate)
+        {
+            return blockstate->GetName() == "minecraft:chest";
+        });
+
     c.GetBlackboard().Set("World.ChestsPos", chests_pos);
 
     return Status::Success;
@@ -110,24 +144,24 @@ Status GetSomeFood(BehaviourClient& c, const std::string& food_name)
                 const short first_player_index = container->GetFirstPlayerInventorySlot();
                 player_dst = first_player_index + 9 * 3;
 
-                const std::map<short, Slot>& slots = container->GetSlots();
+                const std::vector<Slot>& slots = container->GetSlots();
 
                 slots_src.reserve(slots.size());
 
-                for (auto it = slots.begin(); it != slots.end(); ++it)
+                for (short slot_index = 0; slot_index < static_cast<short>(slots.size()); ++slot_index)
                 {
                     // Chest is src
-                    if (it->first >= 0
-                        && it->first < first_player_index
-                        && !it->second.IsEmptySlot()
+                    if (slot_index >= 0
+                        && slot_index < first_player_index
+                        && !slots[slot_index].IsEmptySlot()
 #if PROTOCOL_VERSION < 347
-                        && AssetsManager::getInstance().Items().at(it->second.GetBlockID()).at(it->second.GetItemDamage())->GetName() == food_name
+                        && AssetsManager::getInstance().Items().at(slots[slot_index].GetBlockID()).at(slots[slot_index].GetItemDamage())->GetName() == food_name
 #else
-                        && AssetsManager::getInstance().Items().at(it->second.GetItemID())->GetName() == food_name
+                        && AssetsManager::getInstance().Items().at(slots[slot_index].GetItemID())->GetName() == food_name
 #endif
                         )
                     {
-                        slots_src.push_back(it->first);
+                        slots_src.push_back(slot_index);
                     }
                 }
             }
@@ -189,17 +223,17 @@ Status GetBlocksAvailableInInventory(BehaviourClient& c)
 
     std::set<std::string> blocks_in_inventory;
     std::lock_guard<std::mutex> inventory_lock(inventory_manager->GetMutex());
-    const std::map<short, Slot>& slots = inventory_manager->GetPlayerInventory()->GetSlots();
-    for (auto it = slots.begin(); it != slots.end(); ++it)
+    const std::vector<Slot>& slots = inventory_manager->GetPlayerInventory()->GetSlots();
+    for (short slot_index = 0; slot_index < static_cast<short>(slots.size()); ++slot_index)
     {
-        if (it->first >= 9/*Window::INVENTORY_STORAGE_START*/ &&
-            it->first < 45 /*Window::INVENTORY_OFFHAND_INDEX*/ &&
-            !it->second.IsEmptySlot())
+        if (slot_index >= 9/*Window::INVENTORY_STORAGE_START*/ &&
+            slot_index < 45 /*Window::INVENTORY_OFFHAND_INDEX*/ &&
+            !slots[slot_index].IsEmptySlot())
         {
 #if PROTOCOL_VERSION < 347
-            blocks_in_inventory.insert(AssetsManager::getInstance().Items().at(it->second.GetBlockID()).at(it->second.GetItemDamage())->GetName());
+            blocks_in_inventory.insert(AssetsManager::getInstance().Items().at(slots[slot_index].GetBlockID()).at(slots[slot_index].GetItemDamage())->GetName());
 #else
-            blocks_in_inventory.insert(AssetsManager::getInstance().Items().at(it->second.GetItemID())->GetName());
+            blocks_in_inventory.insert(AssetsManager::getInstance().Items().at(slots[slot_index].GetItemID())->GetName());
 #endif
         }
     }
@@ -260,54 +294,54 @@ Status SwapChestsInventory(BehaviourClient& c, const std::string& food_name, con
 
             first_player_index = (static_cast<int>(container->GetType()) + 1) * 9;
 
-            const std::map<short, Slot>& slots = container->GetSlots();
+            const std::vector<Slot>& slots = container->GetSlots();
 
             slots_src.reserve(slots.size());
             slots_dst.reserve(slots.size());
 
-            for (auto it = slots.begin(); it != slots.end(); ++it)
+            for (short slot_index = 0; slot_index < static_cast<short>(slots.size()); ++slot_index)
             {
                 // If take, chest is src
-                if (it->first >= 0
-                    && it->first < first_player_index
+                if (slot_index >= 0
+                    && slot_index < first_player_index
                     && take_from_chest
-                    && !it->second.IsEmptySlot()
+                    && !slots[slot_index].IsEmptySlot()
 #if PROTOCOL_VERSION < 347
-                    && AssetsManager::getInstance().Items().at(it->second.GetBlockID()).at(it->second.GetItemDamage())->GetName() != food_name
+                    && AssetsManager::getInstance().Items().at(slots[slot_index].GetBlockID()).at(slots[slot_index].GetItemDamage())->GetName() != food_name
 #else
-                    && AssetsManager::getInstance().Items().at(it->second.GetItemID())->GetName() != food_name
+                    && AssetsManager::getInstance().Items().at(slots[slot_index].GetItemID())->GetName() != food_name
 #endif
                     )
                 {
-                    slots_src.push_back(it->first);
+                    slots_src.push_back(slot_index);
                 }
                 // If take, player is dst
-                else if (it->first >= first_player_index
+                else if (slot_index >= first_player_index
                     && take_from_chest
-                    && it->second.IsEmptySlot())
+                    && slots[slot_index].IsEmptySlot())
                 {
-                    slots_dst.push_back(it->first);
+                    slots_dst.push_back(slot_index);
                 }
                 // If !take, chest is dst
-                else if (it->first >= 0
-                    && it->first < first_player_index
+                else if (slot_index >= 0
+                    && slot_index < first_player_index
                     && !take_from_chest
-                    && it->second.IsEmptySlot())
+                    && slots[slot_index].IsEmptySlot())
                 {
-                    slots_dst.push_back(it->first);
+                    slots_dst.push_back(slot_index);
                 }
                 // If !take, player is src
-                else if (it->first >= first_player_index
+                else if (slot_index >= first_player_index
                     && !take_from_chest
-                    && !it->second.IsEmptySlot()
+                    && !slots[slot_index].IsEmptySlot()
 #if PROTOCOL_VERSION < 347
-                    && AssetsManager::getInstance().Items().at(it->second.GetBlockID()).at(it->second.GetItemDamage())->GetName() != food_name
+                    && AssetsManager::getInstance().Items().at(slots[slot_index].GetBlockID()).at(slots[slot_index].GetItemDamage())->GetName() != food_name
 #else
-                    && AssetsManager::getInstance().Items().at(it->second.GetItemID())->GetName() != food_name
+                    && AssetsManager::getInstance().Items().at(slots[slot_index].GetItemID())->GetName() != food_name
 #endif
                     )
                 {
-                    slots_src.push_back(it->first);
+                    slots_src.push_back(slot_index);
                 }
             }
         }
@@ -374,218 +408,275 @@ Status SwapChestsInventory(BehaviourClient& c, const std::string& food_name, con
     return Status::Success;
 }
 
-Status FindNextTask(BehaviourClient& c)
+enum class BuildPositionStatus
+{
+    /// @brief Nothing to do there
+    Done,
+    /// @brief Need to place or dig a block, and it's doable right now
+    Actionable,
+    /// @brief Need to place or dig a block, but missing item or support
+    Blocked
+};
+
+/// @brief Check what should be done at one position of the structure
+/// @param item Output item to place, empty if the block should be dug
+/// @param face Output face to place/dig the block
+static BuildPositionStatus CheckBuildPosition(BehaviourClient& c, const Position& pos,
+    const std::vector<std::vector<std::vector<short> > >& target, const std::map<short, std::string>& palette,
+    const std::set<std::string>& available, const Position& start, std::string& item, PlayerDiggingFace& face)
 {
-    Blackboard& blackboard = c.GetBlackboard();
-    std::shared_ptr<EntityManager> entity_manager = c.GetEntityManager();
     std::shared_ptr<World> world = c.GetWorld();
 
-    const Position& start = blackboard.Get<Position>("Structure.start");
-    const Position& end = blackboard.Get<Position>("Structure.end");
-    const std::vector<std::vector<std::vector<short> > >& target = blackboard.Get<std::vector<std::vector<std::vector<short> > > >("Structure.target");
-    const std::map<short, std::string>& palette = blackboard.Get<std::map<short, std::string> >("Structure.palette");
+    static const std::vector<Position> neighbour_offsets({ Position(0, 1, 0), Position(0, -1, 0),
+        Position(0, 0, 1), Position(0, 0, -1),
+        Position(1, 0, 0), Position(-1, 0, 0) });
 
-    const std::set<std::string>& available = blackboard.Get<std::set<std::string> >("Inventory.block_list");
+    // For each candidate, check if
+    // 1) the target is not air
+    // 2) we have the correct block in the inventory
+    // 3) it is currently a free space
+    // 4) it has a block under or next to it so we can put the new block
 
-    std::mt19937 random_engine = std::mt19937(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    // OR
 
-    Position start_pos;
+    // 1) the placed block is not air
+    // 2) it does not match the desired build
+    // 3) it has a free block under or next to it so we can dig it
 
-    start_pos.x = std::min(end.x, std::max(start.x, (int)std::floor(entity_manager->GetLocalPlayer()->GetX())));
-    start_pos.y = std::min(end.y, std::max(start.y, (int)std::floor(entity_manager->GetLocalPlayer()->GetY())));
-    start_pos.z = std::min(end.z, std::max(start.z, (int)std::floor(entity_manager->GetLocalPlayer()->GetZ())));
+    const int target_palette = target[pos.x - start.x][pos.y - start.y][pos.z - start.z];
+    const std::string& target_name = palette.at(target_palette);
+    const Blockstate* blockstate;
+    {
+        std::lock_guard<std::mutex> world_guard(world->GetMutex());
+        const Block* block = world->GetBlock(pos);
 
-    std::unordered_set<Position> explored;
-    std::unordered_set<Position> to_explore;
+        if (!block)
+        {
+#if PROTOCOL_VERSION < 347
+            blockstate = AssetsManager::getInstance().Blockstates().at(0).at(0).get();
+#else
+            blockstate = AssetsManager::getInstance().Blockstates().at(0).get();
+#endif
+        }
+        else
+        {
+            blockstate = block->GetBlockstate();
+        }
+    }
 
-    const std::vector<Position> neighbour_offsets({ Position(0, 1, 0), Position(0, -1, 0),
-        Position(0, 0, 1), Position(0, 0, -1),
-        Position(1, 0, 0), Position(-1, 0, 0) });
+    const bool need_place = target_palette != -1 && blockstate->IsAir();
+    const bool need_dig = (target_palette != -1 && !blockstate->IsAir() && target_name != blockstate->GetName())
+        || (target_palette == -1 && !blockstate->IsAir());
 
-    to_explore.insert(start_pos);
+    if (!need_place && !need_dig)
+    {
+        return BuildPositionStatus::Done;
+    }
 
-    std::vector<Position> pos_candidates;
-    std::vector<std::string> item_candidates;
-    std::vector<PlayerDiggingFace> face_candidates;
+    // Empty space requiring block placement
+    if (need_place && available.find(target_name) == available.end())
+    {
+        return BuildPositionStatus::Blocked;
+    }
 
-    while (!to_explore.empty())
+    for (int i = 0; i < neighbour_offsets.size(); ++i)
     {
-        // For each candidate, check if
-        // 1) the target is not air
-        // 2) we have the correct block in the inventory
-        // 3) it is currently a free space
-        // 4) it has a block under or next to it so we can put the new block
+        std::lock_guard<std::mutex> world_guard(world->GetMutex());
+        const Block* neighbour_block = world->GetBlock(pos + neighbour_offsets[i]);
 
-        // OR
+        if (neighbour_block && !neighbour_block->GetBlockstate()->IsAir())
+        {
+            item = need_place ? target_name : "";
+            face = static_cast<PlayerDiggingFace>(i);
+            return BuildPositionStatus::Actionable;
+        }
+    }
 
-        // 1) the placed block is not air
-        // 2) it does not match the desired build
-        // 3) it has a free block under or next to it so we can dig it
+    return BuildPositionStatus::Blocked;
+}
 
-        for (auto it = to_explore.begin(); it != to_explore.end(); ++it)
-        {
-            const Position pos = *it;
+Status FindNextTask(BehaviourClient& c)
+{
+    Blackboard& blackboard = c.GetBlackboard();
+    std::shared_ptr<EntityManager> entity_manager = c.GetEntityManager();
 
-            const int target_palette = target[pos.x - start.x][pos.y - start.y][pos.z - start.z];
-            const std::string& target_name = palette.at(target_palette);
-            const Blockstate* blockstate;
-            {
-                std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                const Block* block = world->GetBlock(pos);
+    const Position& start = blackboard.Get(structure_start_key);
+    const Position& end = blackboard.Get(structure_end_key);
+    const std::vector<std::vector<std::vector<short> > >& target = blackboard.Get(structure_target_key);
+    const std::map<short, std::string>& palette = blackboard.Get(structure_palette_key);
 
-                if (!block)
-                {
-#if PROTOCOL_VERSION < 347
-                    blockstate = AssetsManager::getInstance().Blockstates().at(0).at(0).get();
-#else
-                    blockstate = AssetsManager::getInstance().Blockstates().at(0).get();
-#endif
-                }
-                else
-                {
-                    blockstate = block->GetBlockstate();
-                }
-            }
+    const std::set<std::string>& available = blackboard.Get(inventory_block_list_key);
 
-            // Empty space requiring block placement
-            if (target_palette != -1
-                && blockstate->IsAir()
-                && available.find(target_name) != available.end())
-            {
-                for (int i = 0; i < neighbour_offsets.size(); ++i)
-                {
-                    std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                    const Block* neighbour_block = world->GetBlock(pos + neighbour_offsets[i]);
+    const StructureDiff& diff = GetUpToDateStructureDiff(c);
 
-                    if (neighbour_block && !neighbour_block->GetBlockstate()->IsAir())
-                    {
-                        pos_candidates.push_back(pos);
-                        item_candidates.push_back(target_name);
-                        face_candidates.push_back((PlayerDiggingFace)i);
-                        break;
-                    }
-                }
+    const Position player_pos(
+        static_cast<int>(std::floor(entity_manager->GetLocalPlayer()->GetX())),
+        static_cast<int>(std::floor(entity_manager->GetLocalPlayer()->GetY())),
+        static_cast<int>(std::floor(entity_manager->GetLocalPlayer()->GetZ())));
+
+    // First try the positions assigned to this bot by the planner
+    BuildPlanner& planner = BuildPlanner::GetInstance();
+    planner.Init(start, end);
+    const std::string& bot_name = c.GetNetworkManager()->GetMyName();
+    size_t deferred = 0;
+    Position planned_pos;
+    while (planner.Next(bot_name, player_pos, planned_pos))
+    {
+        if (diff.IsDone(planned_pos))
+        {
+            deferred = 0;
+            continue;
+        }
+        std::string item;
+        PlayerDiggingFace face;
+        const BuildPositionStatus status = CheckBuildPosition(c, planned_pos, target, palette, available, start, item, face);
+        if (status == BuildPositionStatus::Actionable)
+        {
+            blackboard.Set(next_task_action_key, item.empty() ? "Dig" : "Place");
+            blackboard.Set(next_task_block_position_key, planned_pos);
+            blackboard.Set(next_task_face_key, face);
+            if (!item.empty())
+            {
+                blackboard.Set(next_task_item_key, item);
             }
-            // Wrong block requiring digging
-            else if ((target_palette != -1 && !blockstate->IsAir() && target_name != blockstate->GetName())
-                || (target_palette == -1 && !blockstate->IsAir()))
+            return Status::Success;
+        }
+        if (status == BuildPositionStatus::Blocked)
+        {
+            planner.Defer(bot_name, planned_pos);
+            deferred += 1;
+            // Everything left in the queue is blocked, move on
+            // to another tile, global search will deal with them
+            if (deferred >= planner.QueueSize(bot_name))
             {
-                for (int i = 0; i < neighbour_offsets.size(); ++i)
-                {
-                    std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                    const Block* neighbour_block = world->GetBlock(pos + neighbour_offsets[i]);
-
-                    if (neighbour_block && !neighbour_block->GetBlockstate()->IsAir())
-                    {
-                        pos_candidates.push_back(pos);
-                        item_candidates.push_back("");
-                        face_candidates.push_back((PlayerDiggingFace)i);
-                        break;
-                    }
-                }
+                planner.Release(bot_name);
+                deferred = 0;
             }
         }
+        else
+        {
+            deferred = 0;
+        }
+    }
+
+    // Nothing left in the planner for this bot, search the positions
+    // not done yet for the closest doable ones
+    std::mt19937 random_engine = std::mt19937(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
 
-        // If we have at least one candidate
-        if (pos_candidates.size() > 0)
+    Position start_pos;
+
+    start_pos.x = std::min(end.x, std::max(start.x, player_pos.x));
+    start_pos.y = std::min(end.y, std::max(start.y, player_pos.y));
+    start_pos.z = std::min(end.z, std::max(start.z, player_pos.z));
+
+    std::vector<Position> pos_candidates;
+    std::vector<std::string> item_candidates;
+    std::vector<PlayerDiggingFace> face_candidates;
+    int min_distance = std::numeric_limits<int>::max();
+
+    for (const std::unordered_set<Position>* positions : { &diff.GetMissing(), &diff.GetWrong() })
+    {
+        for (const Position& pos : *positions)
         {
-            // Get the position of all other players
-            std::vector<Vector3<double> > other_player_pos;
+            // Only keep the candidates at the smallest distance
+            const int distance = std::abs(pos.x - start_pos.x) + std::abs(pos.y - start_pos.y) + std::abs(pos.z - start_pos.z);
+            if (distance > min_distance)
             {
-                std::lock_guard<std::mutex> entity_manager_lock(entity_manager->GetMutex());
-                for (auto it = entity_manager->GetEntities().begin(); it != entity_manager->GetEntities().end(); ++it)
-                {
-                    if (it->second->GetType() == EntityType::Player)
-                    {
-                        other_player_pos.push_back(it->second->GetPosition());
-                    }
-                }
+                continue;
             }
 
-            // Get all the candidates that are as far as possible from all 
-            // the other players
-            std::vector<int> max_dist_indices;
-            double max_dist = 0.0;
-            for (int i = 0; i < pos_candidates.size(); ++i)
+            std::string item;
+            PlayerDiggingFace face;
+            if (CheckBuildPosition(c, pos, target, palette, available, start, item, face) != BuildPositionStatus::Actionable)
             {
-                double dist = 0.0;
-                for (int j = 0; j < other_player_pos.size(); ++j)
-                {
-                    dist += std::abs(pos_candidates[i].x - other_player_pos[j].x) +
-                        std::abs(pos_candidates[i].y - other_player_pos[j].y) +
-                        std::abs(pos_candidates[i].z - other_player_pos[j].z);
-
-                    if (dist > max_dist)
-                    {
-                        max_dist_indices.clear();
-                        max_dist = dist;
-                    }
+                continue;
+            }
 
-                    if (dist == max_dist)
-                    {
-                        max_dist_indices.push_back(i);
-                    }
-                }
+            if (distance < min_distance)
+            {
+                min_distance = distance;
+                pos_candidates.clear();
+                item_candidates.clear();
+                face_candidates.clear();
             }
+            pos_candidates.push_back(pos);
+            item_candidates.push_back(item);
+            face_candidates.push_back(face);
+        }
+    }
 
-            // Select one randomly if multiple possibilities
-            int selected_index = max_dist_indices.size() == 1 ? 0 : max_dist_indices[std::uniform_int_distribution<int>(0, max_dist_indices.size() - 1)(random_engine)];
+    if (pos_candidates.empty())
+    {
+        return Status::Failure;
+    }
 
-            blackboard.Set<std::string>("NextTask.action", item_candidates[selected_index].empty() ? "Dig" : "Place");
-            blackboard.Set("NextTask.block_position", pos_candidates[selected_index]);
-            blackboard.Set("NextTask.face", face_candidates[selected_index]);
-            if (!item_candidates[selected_index].empty())
+    // Get the position of all other players
+    std::vector<Vector3<double> > other_player_pos;
+    {
+        std::lock_guard<std::mutex> entity_manager_lock(entity_manager->GetMutex());
+        for (auto it = entity_manager->GetEntities().begin(); it != entity_manager->GetEntities().end(); ++it)
+        {
+            if (it->second->GetType() == EntityType::Player)
             {
-                blackboard.Set("NextTask.item", item_candidates[selected_index]);
+                other_player_pos.push_back(it->second->GetPosition());
             }
-
-            return Status::Success;
         }
+    }
 
-        explored.insert(to_explore.begin(), to_explore.end());
-        std::unordered_set<Position> neighbours;
-        for (auto it = to_explore.begin(); it != to_explore.end(); ++it)
+    // Get all the candidates that are as far as possible from all 
+    // the other players
+    std::vector<int> max_dist_indices;
+    double max_dist = 0.0;
+    for (int i = 0; i < pos_candidates.size(); ++i)
+    {
+        double dist = 0.0;
+        for (int j = 0; j < other_player_pos.size(); ++j)
         {
-            for (int i = 0; i < neighbour_offsets.size(); ++i)
+            dist += std::abs(pos_candidates[i].x - other_player_pos[j].x) +
+                std::abs(pos_candidates[i].y - other_player_pos[j].y) +
+                std::abs(pos_candidates[i].z - other_player_pos[j].z);
+
+            if (dist > max_dist)
             {
-                const Position p = *it + neighbour_offsets[i];
-
-                if (p.x < start.x ||
-                    p.x > end.x ||
-                    p.y < start.y ||
-                    p.y > end.y ||
-                    p.z < start.z ||
-                    p.z > end.z)
-                {
-                    continue;
-                }
+                max_dist_indices.clear();
+                max_dist = dist;
+            }
 
-                if (explored.find(p) == explored.end())
-                {
-                    neighbours.insert(p);
-                }
+            if (dist == max_dist)
+            {
+                max_dist_indices.push_back(i);
             }
         }
-        to_explore = neighbours;
     }
 
-    return Status::Failure;
+    // Select one randomly if multiple possibilities
+    int selected_index = max_dist_indices.size() == 1 ? 0 : max_dist_indices[std::uniform_int_distribution<int>(0, max_dist_indices.size() - 1)(random_engine)];
+
+    blackboard.Set(next_task_action_key, item_candidates[selected_index].empty() ? "Dig" : "Place");
+    blackboard.Set(next_task_block_position_key, pos_candidates[selected_index]);
+    blackboard.Set(next_task_face_key, face_candidates[selected_index]);
+    if (!item_candidates[selected_index].empty())
+    {
+        blackboard.Set(next_task_item_key, item_candidates[selected_index]);
+    }
+
+    return Status::Success;
 }
 
 Status ExecuteNextTask(BehaviourClient& c)
 {
     Blackboard& b = c.GetBlackboard();
 
-    const std::string& action = b.Get<std::string>("NextTask.action");
-    const Position& block_position = b.Get<Position>("NextTask.block_position");
-    const PlayerDiggingFace face = b.Get<PlayerDiggingFace>("NextTask.face");
+    const std::string& action = b.Get(next_task_action_key);
+    const Position& block_position = b.Get(next_task_block_position_key);
+    const PlayerDiggingFace face = b.Get(next_task_face_key);
     if (action == "Dig")
     {
         return Dig(c, block_position, true, face);
     }
     else if (action == "Place")
     {
-        const std::string& item_name = b.Get<std::string>("NextTask.item");
+        const std::string& item_name = b.Get(next_task_item_key);
         return PlaceBlock(c, item_name, block_position, face, true);
     }
 
@@ -596,19 +687,10 @@ Status ExecuteNextTask(BehaviourClient& c)
 Status CheckCompletion(BehaviourClient& c)
 {
     Blackboard& blackboard = c.GetBlackboard();
-    std::shared_ptr<World> world = c.GetWorld();
-
-    Position world_pos;
-    Position target_pos;
-
-    int additional_blocks = 0;
-    int wrong_blocks = 0;
-    int missing_blocks = 0;
 
-    const Position& start = blackboard.Get<Position>("Structure.start");
-    const Position& end = blackboard.Get<Position>("Structure.end");
-    const std::vector<std::vector<std::vector<short> > >& target = blackboard.Get<std::vector<std::vector<std::vector<short> > > >("Structure.target");
-    const std::map<short, std::string>& palette = blackboard.Get<std::map<short, std::string> >("Structure.palette");
+    const Position& start = blackboard.Get(structure_start_key);
+    const std::vector<std::vector<std::vector<short> > >& target = blackboard.Get(structure_target_key);
+    const std::map<short, std::string>& palette = blackboard.Get(structure_palette_key);
 
     const bool log_details = blackboard.Get<bool>("CheckCompletion.log_details", false);
     const bool log_errors = blackboard.Get<bool>("CheckCompletion.log_errors", false);
@@ -619,91 +701,57 @@ Status CheckCompletion(BehaviourClient& c)
     blackboard.Set("CheckCompletion.log_errors", false);
     blackboard.Set("CheckCompletion.full_check", false);
 
-    for (int x = start.x; x <= end.x; ++x)
+    // Only the modified blocks are compared, unless a full check is asked
+    const StructureDiff& diff = GetUpToDateStructureDiff(c, full_check);
+
+    if (!log_details && !log_errors)
     {
-        world_pos.x = x;
-        target_pos.x = x - start.x;
-        for (int y = start.y; y <= end.y; ++y)
-        {
-            world_pos.y = y;
-            target_pos.y = y - start.y;
-            for (int z = start.z; z <= end.z; ++z)
-            {
-                world_pos.z = z;
-                target_pos.z = z - start.z;
+        return diff.IsComplete() ? Status::Success : Status::Failure;
+    }
 
-                const short target_id = target[target_pos.x][target_pos.y][target_pos.z];
-                const Blockstate* blockstate;
-                {
-                    std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                    const Block* block = world->GetBlock(world_pos);
+    int missing_blocks = 0;
+    int wrong_blocks = 0;
+    int additional_blocks = 0;
 
-                    if (!block)
-                    {
-                        if (target_id != -1)
-                        {
-                            if (!full_check)
-                            {
-                                return Status::Failure;
-                            }
-                            missing_blocks++;
-                            if (log_details && missing_blocks < 100) // Don't print more than 100 missing blocks
-                            {
-                                LOG_INFO("Missing " << palette.at(target_id) << " in " << world_pos);
-                            }
-                        }
-                        continue;
-                    }
-                    blockstate = block->GetBlockstate();
-                }
+    for (const Position& world_pos : diff.GetMissing())
+    {
+        missing_blocks++;
+        if (log_details && missing_blocks < 100) // Don't print more than 100 missing blocks
+        {
+            LOG_INFO("Missing " << palette.at(target[world_pos.x - start.x][world_pos.y - start.y][world_pos.z - start.z]) << " in " << world_pos);
+        }
+    }
 
-                if (target_id == -1)
-                {
-                    if (!blockstate->IsAir())
-                    {
-                        if (!full_check)
-                        {
-                            return Status::Failure;
-                        }
-                        additional_blocks++;
-                        if (log_details)
-                        {
-                            LOG_INFO("Additional " << blockstate->GetName() << " in " << world_pos);
-                        }
-                    }
-                }
-                else
-                {
-                    if (blockstate->IsAir())
-                    {
-                        if (!full_check)
-                        {
-                            return Status::Failure;
-                        }
-                        missing_blocks++;
-                        if (log_details)
-                        {
-                            LOG_INFO("Missing " << palette.at(target_id) << " in " << world_pos);
-                        }
-                    }
-                    else
-                    {
-                        const std::string& target_name = palette.at(target_id);
-                        if (blockstate->GetName() != target_name)
-                        {
-                            if (!full_check)
-                            {
-                                return Status::Failure;
-                            }
-                            wrong_blocks++;
-                            if (log_details)
-                            {
-                                LOG_INFO("Wrong " << blockstate->GetName() << " instead of " << target_name << " in " << world_pos);
-                            }
-                        }
-                    }
-                }
-            }
+    std::shared_ptr<World> world = c.GetWorld();
+    for (const Position& world_pos : diff.GetWrong())
+    {
+        const short target_id = target[world_pos.x - start.x][world_pos.y - start.y][world_pos.z - start.z];
+        if (target_id == -1)
+        {
+            additional_blocks++;
+        }
+        else
+        {
+            wrong_blocks++;
+        }
+        if (!log_details)
+        {
+            continue;
+        }
+
+        std::string block_name;
+        {
+            std::lock_guard<std::mutex> world_guard(world->GetMutex());
+            const Block* block = world->GetBlock(world_pos);
+            block_name = block == nullptr ? "nothing" : block->GetBlockstate()->GetName();
+        }
+        if (target_id == -1)
+        {
+            LOG_INFO("Additional " << block_name << " in " << world_pos);
+        }
+        else
+        {
+            LOG_INFO("Wrong " << block_name << " instead of " << palette.at(target_id) << " in " << world_pos);
         }
     }
 
@@ -714,7 +762,7 @@ Status CheckCompletion(BehaviourClient& c)
         LOG_INFO("Additional blocks: " << additional_blocks);
     }
 
-    return (missing_blocks + additional_blocks + wrong_blocks == 0) ? Status::Success : Status::Failure;
+    return diff.IsComplete() ? Status::Success : Status::Failure;
 }
 
 Status WarnConsole(BehaviourClient& c, const std::string& msg)
@@ -723,34 +771,113 @@ Status WarnConsole(BehaviourClient& c, const std::string& msg)
     return Status::Success;
 }
 
-Status LoadNBT(BehaviourClient& c, const std::string& path, const Position& offset, const std::string& temp_block, const bool log_info)
+/// @brief Extract palette and blocks from a structure file while it's read,
+/// without building the whole NBT tree
+class StructureNBTHandler : public NBTStreamHandler
 {
-    std::ifstream infile(path, std::ios_base::binary);
-    infile.unsetf(std::ios::skipws);
+public:
+    struct StructureBlock
+    {
+        int x;
+        int y;
+        int z;
+        short state;
+    };
 
-    infile.seekg(0, std::ios::end);
-    size_t length = infile.tellg();
-    infile.seekg(0, std::ios::beg);
+    virtual void OnCompoundStart(const std::string& name) override
+    {
+        containers.push_back(name);
+        if (IsBlock())
+        {
+            current_block = StructureBlock{ 0, 0, 0, -1 };
+            pos_index = 0;
+        }
+    }
 
-    std::vector<unsigned char> file_content;
-    file_content.reserve(length);
+    virtual void OnCompoundEnd() override
+    {
+        if (IsBlock())
+        {
+            blocks.push_back(current_block);
+        }
+        containers.pop_back();
+    }
 
-    file_content.insert(file_content.begin(),
-        std::istream_iterator<unsigned char>(infile),
-        std::istream_iterator<unsigned char>());
+    virtual void OnListStart(const std::string& name, const TagType elements_type, const int size) override
+    {
+        containers.push_back(name);
+        if (containers.size() == 2 && name == "blocks")
+        {
+            blocks.reserve(size);
+        }
+    }
 
-    infile.close();
+    virtual void OnListEnd() override
+    {
+        containers.pop_back();
+    }
 
-    std::vector<unsigned char>::const_iterator it = file_content.begin();
+    virtual void OnInt(const std::string& name, const int value) override
+    {
+        if (IsBlock() && name == "state")
+        {
+            current_block.state = static_cast<short>(value);
+        }
+        // Element of the pos list of a block
+        else if (containers.size() == 4 && containers[1] == "blocks" && containers[3] == "pos")
+        {
+            switch (pos_index)
+            {
+            case 0:
+                current_block.x = value;
+                break;
+            case 1:
+                current_block.y = value;
+                break;
+            case 2:
+                current_block.z = value;
+                break;
+            default:
+                break;
+            }
+            pos_index++;
+        }
+    }
 
-    NBT loaded_file;
+    virtual void OnString(const std::string& name, const std::string& value) override
+    {
+        if (containers.size() == 3 && containers[1] == "palette" && name == "Name")
+        {
+            palette.push_back(value);
+        }
+    }
+
+    std::vector<std::string> palette;
+    std::vector<StructureBlock> blocks;
+
+private:
+    /// @brief True if we are directly in an element of the blocks list
+    bool IsBlock() const
+    {
+        return containers.size() == 3 && containers[1] == "blocks";
+    }
+
+private:
+    std::vector<std::string> containers;
+    StructureBlock current_block;
+    int pos_index = 0;
+};
+
+Status LoadNBT(BehaviourClient& c, const std::string& path, const Position& offset, const std::string& temp_block, const bool log_info)
+{
+    StructureNBTHandler structure;
     try
     {
-        loaded_file.Read(it, length);
+        NBTStreamReader::ReadFile(path, structure);
     }
-    catch (const std::exception&)
+    catch (const std::exception& e)
     {
-        LOG_ERROR("Error loading NBT file. Make sure the file is uncompressed (you can change the extension to .zip and simply unzip it)");
+        LOG_ERROR("Error loading NBT file: " << e.what());
         return Status::Failure;
     }
 
@@ -759,12 +886,9 @@ Status LoadNBT(BehaviourClient& c, const std::string& path, const Position& offs
     short id_temp_block = -1;
     std::map<short, int> num_blocks_used;
 
-    std::shared_ptr<TagList> palette_tag = std::dynamic_pointer_cast<TagList>(loaded_file.GetTag("palette"));
-
-    for (int i = 0; i < palette_tag->GetValues().size(); ++i)
+    for (int i = 0; i < structure.palette.size(); ++i)
     {
-        std::shared_ptr<TagCompound> compound = std::dynamic_pointer_cast<TagCompound>(palette_tag->GetValues()[i]);
-        const std::string& block_name = std::dynamic_pointer_cast<TagString>(compound->GetValues().at("Name"))->GetValue();
+        const std::string& block_name = structure.palette[i];
         palette[i] = block_name;
         num_blocks_used[i] = 0;
         if (block_name == temp_block)
@@ -775,14 +899,12 @@ Status LoadNBT(BehaviourClient& c, const std::string& path, const Position& offs
 
     Position min(std::numeric_limits<int>().max(), std::numeric_limits<int>().max(), std::numeric_limits<int>().max());
     Position max(std::numeric_limits<int>().min(), std::numeric_limits<int>().min(), std::numeric_limits<int>().min());
-    std::shared_ptr<TagList> blocks_tag = std::dynamic_pointer_cast<TagList>(loaded_file.GetTag("blocks"));
-    for (int i = 0; i < blocks_tag->GetValues().size(); ++i)
+    for (const StructureNBTHandler::StructureBlock& block : structure.blocks)
     {
-        std::shared_ptr<TagCompound> compound = std::dynamic_pointer_cast<TagCompound>(blocks_tag->GetValues()[i]);
-        std::shared_ptr<TagList> pos_list = std::dynamic_pointer_cast<TagList>(compound->GetValues().at("pos"));
-        const int x = std::dynamic_pointer_cast<TagInt>(pos_list->GetValues()[0])->GetValue();
-        const int y = std::dynamic_pointer_cast<TagInt>(pos_list->GetValues()[1])->GetValue();
-        const int z = std::dynamic_pointer_cast<TagInt>(pos_list->GetValues()[2])->GetValue();
+        const int x = block.x;
+        const int y = block.y;
+        const int z = block.z;
+
 
         if (x < min.x)
         {
@@ -823,17 +945,10 @@ Status LoadNBT(BehaviourClient& c, const std::string& path, const Position& offs
     std::vector<std::vector<std::vector<short> > > target(size.x, std::vector<std::vector<short> >(size.y, std::vector<short>(size.z, -1)));
 
     // Read all block to place
-    for (int i = 0; i < blocks_tag->GetValues().size(); ++i)
+    for (const StructureNBTHandler::StructureBlock& block : structure.blocks)
     {
-        std::shared_ptr<TagCompound> compound = std::dynamic_pointer_cast<TagCompound>(blocks_tag->GetValues()[i]);
-        int state = std::dynamic_pointer_cast<TagInt>(compound->GetValues().at("state"))->GetValue();
-        std::shared_ptr<TagList> pos_list = std::dynamic_pointer_cast<TagList>(compound->GetValues().at("pos"));
-        const int x = std::dynamic_pointer_cast<TagInt>(pos_list->GetValues()[0])->GetValue();
-        const int y = std::dynamic_pointer_cast<TagInt>(pos_list->GetValues()[1])->GetValue();
-        const int z = std::dynamic_pointer_cast<TagInt>(pos_list->GetValues()[2])->GetValue();
-
-        target[x - min.x][y - min.y][z - min.z] = state;
-        num_blocks_used[state] += 1;
+        target[block.x - min.x][block.y - min.y][block.z - min.z] = block.state;
+        num_blocks_used[block.state] += 1;
     }
 
     if (id_temp_block == -1)
@@ -962,6 +1077,7 @@ Status LoadNBT(BehaviourClient& c, const std::string& path, const Position& offs
     blackboard.Set("Structure.end", end);
     blackboard.Set("Structure.target", target);
     blackboard.Set("Structure.palette", palette);
+    blackboard.Erase(structure_diff_key);
     blackboard.Set("Structure.loaded", true);
 
     return Status::Success;
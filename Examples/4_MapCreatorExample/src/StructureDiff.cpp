@@ -0,0 +1,161 @@
+#include "StructureDiff.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <botcraft/Game/World/World.hpp>
+#include <botcraft/Game/World/Block.hpp>
+#include <botcraft/Game/World/Blockstate.hpp>
+#include <botcraft/Game/EventNotifier.hpp>
+
+using namespace Botcraft;
+
+StructureDiff::StructureDiff(const Position& start_, const Position& end_,
+    const std::vector<std::vector<std::vector<short> > >& target_, const std::map<short, std::string>& palette_)
+{
+    start = start_;
+    end = end_;
+    target = target_;
+    palette = palette_;
+
+    const int min_chunk_x = static_cast<int>(std::floor(start.x / static_cast<double>(CHUNK_WIDTH)));
+    const int max_chunk_x = static_cast<int>(std::floor(end.x / static_cast<double>(CHUNK_WIDTH)));
+    const int min_chunk_z = static_cast<int>(std::floor(start.z / static_cast<double>(CHUNK_WIDTH)));
+    const int max_chunk_z = static_cast<int>(std::floor(end.z / static_cast<double>(CHUNK_WIDTH)));
+    for (int x = min_chunk_x; x <= max_chunk_x; ++x)
+    {
+        for (int z = min_chunk_z; z <= max_chunk_z; ++z)
+        {
+            chunks.push_back({ x, z });
+        }
+    }
+    chunk_versions = std::vector<unsigned long long>(chunks.size(), 0);
+    chunk_events = 0;
+    last_change = 0;
+    initialized = false;
+}
+
+void StructureDiff::Update(World& world, const bool full_rescan)
+{
+    std::vector<BlockChange> changes;
+    const bool journal_complete = world.GetBlockChanges(last_change, changes);
+    if (!changes.empty())
+    {
+        last_change = changes.back().sequence;
+    }
+
+    std::lock_guard<std::mutex> world_guard(world.GetMutex());
+    // Chunk events are notified with the world locked, so
+    // they match the chunk versions read below
+    const EventNotifier& notifier = world.GetEventNotifier();
+    const unsigned long long current_chunk_events = notifier.GetCount(EventType::ChunkLoaded) + notifier.GetCount(EventType::ChunkUnloaded);
+
+    if (!initialized || full_rescan || !journal_complete)
+    {
+        missing.clear();
+        wrong.clear();
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            ScanChunk(world, chunks[i]);
+            chunk_versions[i] = world.GetChunkBlocksVersion(chunks[i].first, chunks[i].second);
+        }
+        chunk_events = current_chunk_events;
+        initialized = true;
+        return;
+    }
+
+    for (const BlockChange& change : changes)
+    {
+        if (change.pos.x < start.x || change.pos.x > end.x ||
+            change.pos.y < start.y || change.pos.y > end.y ||
+            change.pos.z < start.z || change.pos.z > end.z)
+        {
+            continue;
+        }
+        UpdatePosition(change.pos, change.new_state);
+    }
+
+    // Versions are also bumped by the changes above, only
+    // look at them if some chunks have been (un)loaded
+    const bool chunks_changed = current_chunk_events != chunk_events;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        const unsigned long long version = world.GetChunkBlocksVersion(chunks[i].first, chunks[i].second);
+        if (chunks_changed && version != chunk_versions[i])
+        {
+            ScanChunk(world, chunks[i]);
+        }
+        chunk_versions[i] = version;
+    }
+    chunk_events = current_chunk_events;
+}
+
+const std::unordered_set<Position>& StructureDiff::GetMissing() const
+{
+    return missing;
+}
+
+const std::unordered_set<Position>& StructureDiff::GetWrong() const
+{
+    return wrong;
+}
+
+const size_t StructureDiff::GetNumDone() const
+{
+    const size_t volume = static_cast<size_t>(end.x - start.x + 1) * (end.y - start.y + 1) * (end.z - start.z + 1);
+    return volume - missing.size() - wrong.size();
+}
+
+const bool StructureDiff::IsDone(const Position& pos) const
+{
+    return missing.find(pos) == missing.end() && wrong.find(pos) == wrong.end();
+}
+
+const bool StructureDiff::IsComplete() const
+{
+    return missing.empty() && wrong.empty();
+}
+
+void StructureDiff::UpdatePosition(const Position& pos, const Blockstate* blockstate)
+{
+    missing.erase(pos);
+    wrong.erase(pos);
+
+    const short target_id = target[pos.x - start.x][pos.y - start.y][pos.z - start.z];
+    if (target_id == -1)
+    {
+        if (blockstate != nullptr && !blockstate->IsAir())
+        {
+            wrong.insert(pos);
+        }
+    }
+    else if (blockstate == nullptr || blockstate->IsAir())
+    {
+        missing.insert(pos);
+    }
+    else if (blockstate->GetName() != palette.at(target_id))
+    {
+        wrong.insert(pos);
+    }
+}
+
+void StructureDiff::ScanChunk(World& world, const std::pair<int, int>& chunk)
+{
+    const int min_x = std::max(start.x, chunk.first * CHUNK_WIDTH);
+    const int max_x = std::min(end.x, chunk.first * CHUNK_WIDTH + CHUNK_WIDTH - 1);
+    const int min_z = std::max(start.z, chunk.second * CHUNK_WIDTH);
+    const int max_z = std::min(end.z, chunk.second * CHUNK_WIDTH + CHUNK_WIDTH - 1);
+
+    Position pos;
+    for (pos.x = min_x; pos.x <= max_x; ++pos.x)
+    {
+        for (pos.y = start.y; pos.y <= end.y; ++pos.y)
+        {
+            for (pos.z = min_z; pos.z <= max_z; ++pos.z)
+            {
+                const Block* block = world.GetBlock(pos);
+                UpdatePosition(pos, block == nullptr ? nullptr : block->GetBlockstate());
+            }
+        }
+    }
+}
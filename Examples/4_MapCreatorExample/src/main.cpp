@@ -3,11 +3,13 @@
 
 #include <botcraft/Game/World/World.hpp>
 #include <botcraft/AI/BehaviourTree.hpp>
+#include <botcraft/AI/SwarmCoordinator.hpp>
 #include <botcraft/AI/Tasks/AllTasks.hpp>
 #include <botcraft/AI/SimpleBehaviourClient.hpp>
 #include <botcraft/Utilities/Logger.hpp>
 #include <botcraft/Utilities/SleepUtilities.hpp>
 
+#include "BuildPlanner.hpp"
 #include "CustomBehaviourTree.hpp"
 #include "MapCreationTasks.hpp"
 
@@ -22,6 +24,8 @@ void ShowHelp(const char* argv0)
         << "\t--nbt\tnbt filename to load, default: empty\n"
         << "\t--offset\t3 ints, offset for the first block, default: 0 0 0\n"
         << "\t--tempblock\tname of the scafholding block, default: minecraft:slime_block\n"
+        << "\t--hub\tport to host a swarm hub on, to split the structure with other processes, default: none\n"
+        << "\t--coordinator\taddress of the swarm hub to connect to (host:port), default: none\n"
         << std::endl;
 }
 
@@ -46,6 +50,8 @@ int main(int argc, char* argv[])
         std::string nbt_file = "";
         Botcraft::Position offset(0, 0, 0);
         std::string temp_block = "minecraft:slime_block";
+        int hub_port = -1;
+        std::string hub_address = "";
 
         std::vector<std::string> base_names = { "BotAuFeu", "Botager", "Botiron", "BotEnTouche", "BotDeVin", "BotAuxRoses", "BotronMinet", "Botmobile", "Botman", "Botentiel" };
 
@@ -138,8 +144,49 @@ int main(int argc, char* argv[])
                     return 1;
                 }
             }
+            else if (arg == "--hub")
+            {
+                if (i + 1 < argc)
+                {
+                    hub_port = std::stoi(argv[++i]);
+                }
+                else
+                {
+                    LOG_FATAL("--hub requires an argument");
+                    return 1;
+                }
+            }
+            else if (arg == "--coordinator")
+            {
+                if (i + 1 < argc)
+                {
+                    hub_address = argv[++i];
+                }
+                else
+                {
+                    LOG_FATAL("--coordinator requires an argument");
+                    return 1;
+                }
+            }
         }
 
+        std::shared_ptr<SwarmCoordinator> coordinator;
+        if (hub_port != -1)
+        {
+            coordinator = std::make_shared<SwarmCoordinator>(static_cast<unsigned short>(hub_port));
+        }
+        else if (!hub_address.empty())
+        {
+            const size_t separator = hub_address.rfind(':');
+            if (separator == std::string::npos)
+            {
+                LOG_FATAL("--coordinator requires a host:port address");
+                return 1;
+            }
+            coordinator = std::make_shared<SwarmCoordinator>(hub_address.substr(0, separator), static_cast<unsigned short>(std::stoi(hub_address.substr(separator + 1))));
+        }
+        BuildPlanner::GetInstance().SetCoordinator(coordinator);
+
         auto map_art_detailed_behaviour_tree = GenerateMapArtCreatorTree("minecraft:golden_carrot", nbt_file, offset, temp_block, true);
         auto map_art_behaviour_tree = GenerateMapArtCreatorTree("minecraft:golden_carrot", nbt_file, offset, temp_block, false);
 
@@ -147,6 +194,12 @@ int main(int argc, char* argv[])
         for (int i = 0; i < num_world; i++)
         {
             shared_worlds[i] = std::shared_ptr<Botcraft::World>(new Botcraft::World(true, false));
+            // Used to keep track of the structure completion without comparing it all each time
+            shared_worlds[i]->SetBlockChangesJournalSize(1 << 16);
+            if (coordinator)
+            {
+                coordinator->ShareWorld(shared_worlds[i]);
+            }
         }
         std::vector<std::string> names(num_bot);
         std::vector<std::shared_ptr<SimpleBehaviourClient> > clients(num_bot);
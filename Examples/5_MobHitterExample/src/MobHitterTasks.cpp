@@ -2,6 +2,8 @@
 
 #include <botcraft/Game/Entities/EntityManager.hpp>
 #include <botcraft/Game/Entities/LocalPlayer.hpp>
+#include <botcraft/Game/Entities/entities/Entity.hpp>
+#include <botcraft/Game/World/World.hpp>
 #include <botcraft/Network/NetworkManager.hpp>
 
 using namespace Botcraft;
@@ -23,39 +25,54 @@ Status HitCloseHostiles(BehaviourClient& c)
     }
 
     auto now = std::chrono::steady_clock::now();
+
+    // Iterate on a snapshot so the network thread isn't blocked while hitting
+    const EntitySnapshot entities = entity_manager->GetSnapshot();
+    const std::vector<const EntitySnapshot::EntityState*> close_monsters = entities.QueryRadius(player_pos, 4.0,
+        [](const EntitySnapshot::EntityState& s) { return s.entity->IsMonster(); });
+
+    // Don't try to hit monsters behind walls, all the rays are traced at once
+    std::vector<Vector3<double> > targets;
+    targets.reserve(close_monsters.size());
+    for (const auto& monster : close_monsters)
+    {
+        targets.push_back(monster->position + Vector3<double>(0.0, monster->entity->GetHeight() / 2.0, 0.0));
+    }
+    const std::vector<bool> visible = c.GetWorld()->HasLineOfSight(player_pos + Vector3<double>(0.0, 1.62, 0.0), targets);
+
+    for (size_t i = 0; i < close_monsters.size(); ++i)
     {
-        std::lock_guard<std::mutex> entities_guard(entity_manager->GetMutex());
-        for (auto& it : entity_manager->GetEntities())
+        const EntitySnapshot::EntityState* monster = close_monsters[i];
+        if (!visible[i])
+        {
+            continue;
+        }
+
+        auto time = last_time_hit.find(monster->id);
+        if (time != last_time_hit.end() &&
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - time->second).count() < 500)
         {
-            if (it.second->IsMonster() && (it.second->GetPosition()- player_pos).SqrNorm() < 16.0)
-            {
-                auto time = last_time_hit.find(it.first);
-                if (time != last_time_hit.end() &&
-                    std::chrono::duration_cast<std::chrono::milliseconds>(now - time->second).count() < 500)
-                {
-                    continue;
-                }
-
-                last_time_hit[it.first] = now;
-
-                {
-                    std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
-                    local_player->LookAt(it.second->GetPosition());
-                }
-
-                std::shared_ptr<ServerboundInteractPacket> msg = std::make_shared<ServerboundInteractPacket>();
-                msg->SetAction(1);
-                msg->SetEntityId(it.first);
+            continue;
+        }
+
+        last_time_hit[monster->id] = now;
+
+        {
+            std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
+            local_player->LookAt(monster->position);
+        }
+
+        std::shared_ptr<ServerboundInteractPacket> msg = std::make_shared<ServerboundInteractPacket>();
+        msg->SetAction(1);
+        msg->SetEntityId(monster->id);
 #if PROTOCOL_VERSION > 722
-                msg->SetUsingSecondaryAction(false);
+        msg->SetUsingSecondaryAction(false);
 #endif
-                std::shared_ptr<ServerboundSwingPacket> msg_swing = std::make_shared<ServerboundSwingPacket>();
-                msg_swing->SetHand(0);
+        std::shared_ptr<ServerboundSwingPacket> msg_swing = std::make_shared<ServerboundSwingPacket>();
+        msg_swing->SetHand(0);
 
-                network_manager->Send(msg);
-                network_manager->Send(msg_swing);
-            }
-        }
+        network_manager->Send(msg);
+        network_manager->Send(msg_swing);
     }
 
     return Status::Success;
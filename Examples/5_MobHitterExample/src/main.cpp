@@ -87,7 +87,10 @@ int main(int argc, char* argv[])
         auto mob_hitter_tree = Botcraft::Builder<Botcraft::SimpleBehaviourClient>()
             .sequence()
                 .leaf(HitCloseHostiles)
-                .leaf(CleanLastTimeHit)
+                // Old entries only need to be removed from time to time
+                .cache_for(1000)
+                    .leaf(CleanLastTimeHit)
+                .end()
             .end()
             .build();
 
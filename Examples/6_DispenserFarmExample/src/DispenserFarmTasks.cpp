@@ -16,9 +16,20 @@
 #include <protocolCraft/Types/NBT/TagList.hpp>
 #include <protocolCraft/Types/NBT/TagString.hpp>
 
+#include <unordered_set>
+
 using namespace Botcraft;
 using namespace ProtocolCraft;
 
+// Read by the farming leaves at each iteration, interned once
+static const BlackboardKey<Position> stone_lever_position_key("DispenserFarmBot.stone_lever_position");
+static const BlackboardKey<Position> cactus_position_key("DispenserFarmBot.cactus_position");
+static const BlackboardKey<Position> cactus_standing_position_key("DispenserFarmBot.cactus_standing_position");
+static const BlackboardKey<Position> output_shulker_position_key("DispenserFarmBot.output_shulker_position");
+static const BlackboardKey<Position> stone_shulker_position_key("DispenserFarmBot.stone_shulker_position");
+static const BlackboardKey<Position> note_block_position_key("DispenserFarmBot.note_block_position");
+static const BlackboardKey<std::vector<Position> > stone_positions_key("DispenserFarmBot.stone_positions");
+
 Status InitializeBlocks(BehaviourClient& client, const int radius)
 {
     Blackboard& b = client.GetBlackboard();
@@ -48,102 +59,97 @@ Status InitializeBlocks(BehaviourClient& client, const int radius)
     }
 
     {
+        const std::unordered_set<std::string> searched_blocks = {
+            "minecraft:red_bed", "minecraft:crafting_table", "minecraft:cactus",
+            "minecraft:yellow_concrete", "minecraft:red_shulker_box", "minecraft:white_shulker_box",
+            "minecraft:orange_shulker_box", "minecraft:light_gray_shulker_box", "minecraft:light_gray_concrete",
+            "minecraft:lever", "minecraft:note_block", "minecraft:potatoes", "minecraft:carrots"
+        };
+
         std::shared_ptr<World> world = client.GetWorld();
-        std::lock_guard<std::mutex> lock_world(world->GetMutex());
-        Position current_pos;
-        for (int x = -radius; x < radius + 1; ++x)
-        {
-            current_pos.x = my_pos.x + x;
-            for (int y = std::max(-radius, world->GetMinY()); y < std::min(world->GetMinY() + world->GetHeight(), radius + 1); ++y)
+        world->ForEachBlockInBox(my_pos - Position(radius, radius, radius), my_pos + Position(radius, radius, radius),
+            [&](const Position& current_pos, const Block& block)
             {
-                current_pos.y = my_pos.y + y;
-                for (int z = -radius; z < radius + 1; ++z)
+                const std::string& block_name = block.GetBlockstate()->GetName();
+                if (block_name == "minecraft:red_bed")
                 {
-                    current_pos.z = my_pos.z + z;
-
-                    const Block* block = world->GetBlock(current_pos);
-                    if (!block)
-                    {
-                        continue;
-                    }
-                    const std::string& block_name = block->GetBlockstate()->GetName();
-                    if (block_name == "minecraft:red_bed")
-                    {
-                        bed_position = current_pos;
-                        LOG_INFO("Bed found at: " << current_pos << "!");
-                        despawn_position = current_pos + Position(0, 0, 140);
-                        LOG_INFO("Despawn position found at: " << current_pos + Position(0, 0, 140) << "!");
-                    }
-                    else if (block_name == "minecraft:crafting_table")
-                    {
-                        crafting_table_position = current_pos;
-                        buying_standing_position = current_pos + Position(0, 1, 0);
-                        LOG_INFO("Crafting table found at: " << current_pos << "!");
-                        LOG_INFO("Buying standing found at: " << current_pos + Position(0, 1, 0) << "!");
-                    }
-                    else if (block_name == "minecraft:cactus")
-                    {
-                        cactus_position = current_pos;
-                        LOG_INFO("Cactus found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:yellow_concrete")
-                    {
-                        cactus_standing_position = current_pos + Position(0, 1, 0);
-                        LOG_INFO("Cactus standing found at: " << current_pos + Position(0, 1, 0) << "!");
-                    }
-                    else if (block_name == "minecraft:red_shulker_box")
-                    {
-                        output_shulker_position = current_pos;
-                        LOG_INFO("Output shulker position found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:white_shulker_box")
-                    {
-                        bones_shulker_position = current_pos;
-                        LOG_INFO("Bones shulker position found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:orange_shulker_box")
-                    {
-                        rotten_flesh_shulker_position = current_pos;
-                        LOG_INFO("Rotten flesh shulker position found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:light_gray_shulker_box")
-                    {
-                        stone_shulker_position = current_pos;
-                        LOG_INFO("Stone shulker position found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:light_gray_concrete")
-                    {
-                        stone_standing_position = current_pos + Position(0, 1, 0);
-                        LOG_INFO("Stone standing position found at: " << current_pos + Position(0, 1, 0) << "!");
-                        for (int i = 1; i < 5; ++i)
-                        {
-                            stone_positions.push_back(current_pos + Position(0, 2, i));
-                            LOG_INFO("Stone position found at: " << current_pos + Position(0, 2, i) << "!");
-                        }
-                    }
-                    else if (block_name == "minecraft:lever")
-                    {
-                        stone_lever_position = current_pos;
-                        LOG_INFO("Stone lever position found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:note_block")
-                    {
-                        note_block_position = current_pos;
-                        LOG_INFO("Note block position found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:potatoes")
-                    {
-                        potato_positions.push_back(current_pos);
-                        LOG_INFO("Potatoes found at: " << current_pos << "!");
-                    }
-                    else if (block_name == "minecraft:carrots")
+                    bed_position = current_pos;
+                    LOG_INFO("Bed found at: " << current_pos << "!");
+                    despawn_position = current_pos + Position(0, 0, 140);
+                    LOG_INFO("Despawn position found at: " << current_pos + Position(0, 0, 140) << "!");
+                }
+                else if (block_name == "minecraft:crafting_table")
+                {
+                    crafting_table_position = current_pos;
+                    buying_standing_position = current_pos + Position(0, 1, 0);
+                    LOG_INFO("Crafting table found at: " << current_pos << "!");
+                    LOG_INFO("Buying standing found at: " << current_pos + Position(0, 1, 0) << "!");
+                }
+                else if (block_name == "minecraft:cactus")
+                {
+                    cactus_position = current_pos;
+                    LOG_INFO("Cactus found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:yellow_concrete")
+                {
+                    cactus_standing_position = current_pos + Position(0, 1, 0);
+                    LOG_INFO("Cactus standing found at: " << current_pos + Position(0, 1, 0) << "!");
+                }
+                else if (block_name == "minecraft:red_shulker_box")
+                {
+                    output_shulker_position = current_pos;
+                    LOG_INFO("Output shulker position found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:white_shulker_box")
+                {
+                    bones_shulker_position = current_pos;
+                    LOG_INFO("Bones shulker position found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:orange_shulker_box")
+                {
+                    rotten_flesh_shulker_position = current_pos;
+                    LOG_INFO("Rotten flesh shulker position found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:light_gray_shulker_box")
+                {
+                    stone_shulker_position = current_pos;
+                    LOG_INFO("Stone shulker position found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:light_gray_concrete")
+                {
+                    stone_standing_position = current_pos + Position(0, 1, 0);
+                    LOG_INFO("Stone standing position found at: " << current_pos + Position(0, 1, 0) << "!");
+                    for (int i = 1; i < 5; ++i)
                     {
-                        carrot_positions.push_back(current_pos);
-                        LOG_INFO("Carrots found at: " << current_pos << "!");
+                        stone_positions.push_back(current_pos + Position(0, 2, i));
+                        LOG_INFO("Stone position found at: " << current_pos + Position(0, 2, i) << "!");
                     }
                 }
-            }
-        }
+                else if (block_name == "minecraft:lever")
+                {
+                    stone_lever_position = current_pos;
+                    LOG_INFO("Stone lever position found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:note_block")
+                {
+                    note_block_position = current_pos;
+                    LOG_INFO("Note block position found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:potatoes")
+                {
+                    potato_positions.push_back(current_pos);
+                    LOG_INFO("Potatoes found at: " << current_pos << "!");
+                }
+                else if (block_name == "minecraft:carrots")
+                {
+                    carrot_positions.push_back(current_pos);
+                    LOG_INFO("Carrots found at: " << current_pos << "!");
+                }
+            },
+            [&](const Blockstate* blockstate)
+            {
+                return searched_blocks.find(blockstate->GetName()) != searched_blocks.end();
+            });
     }
 
     // Sort stone positions
@@ -239,7 +245,7 @@ Status StartSpawners(BehaviourClient& client)
     std::shared_ptr<World> world = client.GetWorld();
     Blackboard& blackboard = client.GetBlackboard();
 
-    const Position& lever_pos = blackboard.Get<Position>("DispenserFarmBot.stone_lever_position");
+    const Position& lever_pos = blackboard.Get(stone_lever_position_key);
     
     {
         std::lock_guard<std::mutex> lock_world(world->GetMutex());
@@ -310,8 +316,8 @@ Status CleanChest(BehaviourClient& client, const std::string& chest_pos_blackboa
     std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
 
     const Position& pos = blackboard.Get<Position>(chest_pos_blackboard);
-    const Position& cactus_standing_pos = blackboard.Get<Position>("DispenserFarmBot.cactus_standing_position");
-    const Position& cactus_pos = blackboard.Get<Position>("DispenserFarmBot.cactus_position");
+    const Position& cactus_standing_pos = blackboard.Get(cactus_standing_position_key);
+    const Position& cactus_pos = blackboard.Get(cactus_position_key);
 
     bool has_wrong_items = true;
     while (has_wrong_items)
@@ -346,22 +352,24 @@ Status CleanChest(BehaviourClient& client, const std::string& chest_pos_blackboa
         // Get slots to remove and free slots in inventory
         {
             std::lock_guard<std::mutex> inventory_manager_lock(inventory_manager->GetMutex());
-            for (const auto& s : container->GetSlots())
+            const std::vector<Slot>& slots = container->GetSlots();
+            for (short index = 0; index < static_cast<short>(slots.size()); ++index)
             {
-                if (s.first < container->GetFirstPlayerInventorySlot() && !s.second.IsEmptySlot() &&
+                const Slot& slot = slots[index];
+                if (index < container->GetFirstPlayerInventorySlot() && !slot.IsEmptySlot() &&
 #if PROTOCOL_VERSION < 340
-                    AssetsManager::getInstance().Items().at(s.second.GetBlockID()).at(s.second.GetItemDamage())->GetName() != item_to_keep
+                    AssetsManager::getInstance().Items().at(slot.GetBlockID()).at(slot.GetItemDamage())->GetName() != item_to_keep
 #else
-                    AssetsManager::getInstance().Items().at(s.second.GetItemID())->GetName() != item_to_keep
+                    AssetsManager::getInstance().Items().at(slot.GetItemID())->GetName() != item_to_keep
 #endif
                     )
                 {
-                    slots_to_remove.push_back(s.first);
+                    slots_to_remove.push_back(index);
                 }
-                else if (s.first >= container->GetFirstPlayerInventorySlot() &&
-                    s.second.IsEmptySlot())
+                else if (index >= container->GetFirstPlayerInventorySlot() &&
+                    slot.IsEmptySlot())
                 {
-                    free_slots_inventory.push_back(s.first);
+                    free_slots_inventory.push_back(index);
                 }
             }
         }
@@ -427,7 +435,7 @@ Status StoreDispenser(BehaviourClient& client)
     Blackboard& b = client.GetBlackboard();
     std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
 
-    if (OpenContainer(client, b.Get<Position>("DispenserFarmBot.output_shulker_position")) == Status::Failure)
+    if (OpenContainer(client, b.Get(output_shulker_position_key)) == Status::Failure)
     {
         LOG_WARNING("Can't open output chest to store crafted dispenser");
         return Status::Failure;
@@ -456,30 +464,32 @@ Status StoreDispenser(BehaviourClient& client)
     {
         std::lock_guard<std::mutex> lock_inventory_manager(inventory_manager->GetMutex());
         const auto dispenser_id = AssetsManager::getInstance().GetItemID("minecraft:dispenser");
-        for (const auto& s : container->GetSlots())
+        const std::vector<Slot>& slots = container->GetSlots();
+        for (short index = 0; index < static_cast<short>(slots.size()); ++index)
         {
-            if (dst_slot == -1 && s.first < container->GetFirstPlayerInventorySlot() && 
-                (s.second.IsEmptySlot() || (
+            const Slot& slot = slots[index];
+            if (dst_slot == -1 && index < container->GetFirstPlayerInventorySlot() && 
+                (slot.IsEmptySlot() || (
 #if PROTOCOL_VERSION < 340
-                s.second.GetBlockID() == dispenser_id.first && s.second.GetItemDamage() == dispenser_id.second
+                slot.GetBlockID() == dispenser_id.first && slot.GetItemDamage() == dispenser_id.second
 #else
-                s.second.GetItemID() == dispenser_id
+                slot.GetItemID() == dispenser_id
 #endif
-                && s.second.GetItemCount() < AssetsManager::getInstance().Items().at(dispenser_id)->GetStackSize() - 1)
+                && slot.GetItemCount() < AssetsManager::getInstance().Items().at(dispenser_id)->GetStackSize() - 1)
                 )
                )
             {
-                dst_slot = s.first;
+                dst_slot = index;
             }
-            else if (src_slot == -1 && s.first >= container->GetFirstPlayerInventorySlot() &&
+            else if (src_slot == -1 && index >= container->GetFirstPlayerInventorySlot() &&
 #if PROTOCOL_VERSION < 340
-                s.second.GetBlockID() == dispenser_id.first && s.second.GetItemDamage() == dispenser_id.second
+                slot.GetBlockID() == dispenser_id.first && slot.GetItemDamage() == dispenser_id.second
 #else
-                s.second.GetItemID() == dispenser_id
+                slot.GetItemID() == dispenser_id
 #endif
                 )
             {
-                src_slot = s.first;
+                src_slot = index;
             }
             else if (src_slot != -1 && dst_slot != -1)
             {
@@ -519,10 +529,9 @@ Status MineCobblestone(BehaviourClient& client)
     std::shared_ptr<World> world = client.GetWorld();
     Blackboard& blackboard = client.GetBlackboard();
 
-    const std::vector<Position>& stone_positions = blackboard.Get<std::vector<Position>>("DispenserFarmBot.stone_positions");
+    const std::vector<Position>& stone_positions = blackboard.Get(stone_positions_key);
 
     const Position* mining_pos = nullptr;
-    float mining_time = 0.0f;
     {
         std::lock_guard<std::mutex> world_lock(world->GetMutex());
         for (int i = 0; i < stone_positions.size(); ++i)
@@ -531,14 +540,12 @@ Status MineCobblestone(BehaviourClient& client)
             if (block && block->GetBlockstate()->GetName() == "minecraft:stone")
             {
                 mining_pos = stone_positions.data() + i;
-                mining_time = 0.6f;
                 break;
             }
             // Depending on the tick on which lava flows we could also get some cobble
             else if (block && block->GetBlockstate()->GetName() == "minecraft:cobblestone")
             {
                 mining_pos = stone_positions.data() + i;
-                mining_time = 0.75f;
                 break;
             }
         }
@@ -547,7 +554,7 @@ Status MineCobblestone(BehaviourClient& client)
     // No stone, trigger the note block
     if (!mining_pos)
     {
-        const Position& note_block_pos = blackboard.Get<Position>("DispenserFarmBot.note_block_position");
+        const Position& note_block_pos = blackboard.Get(note_block_position_key);
         if (InteractWithBlock(client, note_block_pos, Direction::Down, true) == Status::Failure)
         {
             LOG_WARNING("Error trying to activate the stone note block");
@@ -577,14 +584,12 @@ Status MineCobblestone(BehaviourClient& client)
                 if (block && block->GetBlockstate()->GetName() == "minecraft:stone")
                 {
                     mining_pos = stone_positions.data() + i;
-                    mining_time = 0.6f;
                     break;
                 }
                 // Depending on the tick on which lava flows we could also get some cobble
                 else if (block && block->GetBlockstate()->GetName() == "minecraft:cobblestone")
                 {
                     mining_pos = stone_positions.data() + i;
-                    mining_time = 0.75f;
                     break;
                 }
             }
@@ -596,13 +601,14 @@ Status MineCobblestone(BehaviourClient& client)
         }
     }
 
-    if (Dig(client, *mining_pos, true, Direction::North, mining_time) == Status::Failure)
+    // Mining time is computed from the held pickaxe and memoized
+    if (Dig(client, *mining_pos, true, Direction::North) == Status::Failure)
     {
         LOG_WARNING("Error digging stone.");
         return Status::Failure;
     }
 
-    const Position& stone_shulker_position = blackboard.Get<Position>("DispenserFarmBot.stone_shulker_position");
+    const Position& stone_shulker_position = blackboard.Get(stone_shulker_position_key);
     if (OpenContainer(client, stone_shulker_position) == Status::Failure)
     {
         LOG_WARNING("Error trying to open stone shulker.");
@@ -641,18 +647,20 @@ Status MineCobblestone(BehaviourClient& client)
             std::lock_guard<std::mutex> lock_inventory_manager(inventory_manager->GetMutex());
             dst_slot = -1;
             int quantity = 0;
-            for (const auto& s: shulker_container->GetSlots())
+            const std::vector<Slot>& slots = shulker_container->GetSlots();
+            for (short index = 0; index < static_cast<short>(slots.size()); ++index)
             {
-                if (src_slot == -1 && s.first < shulker_container->GetFirstPlayerInventorySlot())
+                const Slot& slot = slots[index];
+                if (src_slot == -1 && index < shulker_container->GetFirstPlayerInventorySlot())
                 {
 #if PROTOCOL_VERSION < 340
-                    if (!s.second.IsEmptySlot() && AssetsManager::getInstance().Items().at(s.second.GetBlockID()).at(s.second.GetItemDamage())->GetName() == "minecraft:cobblestone")
+                    if (!slot.IsEmptySlot() && AssetsManager::getInstance().Items().at(slot.GetBlockID()).at(slot.GetItemDamage())->GetName() == "minecraft:cobblestone")
 #else
-                    if (!s.second.IsEmptySlot() && AssetsManager::getInstance().Items().at(s.second.GetItemID())->GetName() == "minecraft:cobblestone")
+                    if (!slot.IsEmptySlot() && AssetsManager::getInstance().Items().at(slot.GetItemID())->GetName() == "minecraft:cobblestone")
 #endif
                     {
-                        src_slot = s.first;
-                        quantity = s.second.GetItemCount();
+                        src_slot = index;
+                        quantity = slot.GetItemCount();
                         if (dst_slot != -1)
                         {
                             break;
@@ -660,17 +668,17 @@ Status MineCobblestone(BehaviourClient& client)
                     }
                 }
 
-                if (src_slot != -1 && s.first >= shulker_container->GetFirstPlayerInventorySlot())
+                if (src_slot != -1 && index >= shulker_container->GetFirstPlayerInventorySlot())
                 {
-                    if (s.second.IsEmptySlot() || (s.second.GetItemCount() < 64 - quantity &&
+                    if (slot.IsEmptySlot() || (slot.GetItemCount() < 64 - quantity &&
 #if PROTOCOL_VERSION < 340
-                        AssetsManager::getInstance().Items().at(s.second.GetBlockID()).at(s.second.GetItemDamage())->GetName() == "minecraft:cobblestone"
+                        AssetsManager::getInstance().Items().at(slot.GetBlockID()).at(slot.GetItemDamage())->GetName() == "minecraft:cobblestone"
 #else
-                        AssetsManager::getInstance().Items().at(s.second.GetItemID())->GetName() == "minecraft:cobblestone"
+                        AssetsManager::getInstance().Items().at(slot.GetItemID())->GetName() == "minecraft:cobblestone"
 #endif
                         ))
                     {
-                        dst_slot = s.first;
+                        dst_slot = index;
                         break;
                     }
                 }
@@ -727,29 +735,31 @@ Status TakeFromChest(BehaviourClient& client, const std::string& item_name, cons
     int num_in_inventory = 0;
     {
         std::lock_guard<std::mutex> lock_inventory_manager(inventory_manager->GetMutex());
-        for (const auto& s : container->GetSlots())
+        const std::vector<Slot>& slots = container->GetSlots();
+        for (short index = 0; index < static_cast<short>(slots.size()); ++index)
         {
-            if (!s.second.IsEmptySlot() &&
+            const Slot& slot = slots[index];
+            if (!slot.IsEmptySlot() &&
 #if PROTOCOL_VERSION < 340
-                AssetsManager::getInstance().Items().at(s.second.GetBlockID()).at(s.second.GetItemDamage())->GetName() == item_name
+                AssetsManager::getInstance().Items().at(slot.GetBlockID()).at(slot.GetItemDamage())->GetName() == item_name
 #else
-                AssetsManager::getInstance().Items().at(s.second.GetItemID())->GetName() == item_name
+                AssetsManager::getInstance().Items().at(slot.GetItemID())->GetName() == item_name
 #endif
                 )
             {
-                if (s.first < container->GetFirstPlayerInventorySlot())
+                if (index < container->GetFirstPlayerInventorySlot())
                 {
-                    to_take_slots.push_back(s.first);
+                    to_take_slots.push_back(index);
                 }
                 else
                 {
-                    num_in_inventory += s.second.GetItemCount();
+                    num_in_inventory += slot.GetItemCount();
                 }
             }
-            else if (s.first >= container->GetFirstPlayerInventorySlot() &&
-                s.second.IsEmptySlot())
+            else if (index >= container->GetFirstPlayerInventorySlot() &&
+                slot.IsEmptySlot())
             {
-                available_slots.push_back(s.first);
+                available_slots.push_back(index);
             }
         }
     }
@@ -777,7 +787,19 @@ Status CollectCropsAndReplant(BehaviourClient& client, const std::string& blocks
     std::shared_ptr<World> world = client.GetWorld();
     Blackboard& blackboard = client.GetBlackboard();
 
-    const std::vector<Position>& positions = blackboard.Get<std::vector<Position>>(blocks_pos_blackboard);
+    const std::vector<Position>& crops_positions = blackboard.Get<std::vector<Position>>(blocks_pos_blackboard);
+
+    // Visit the crops in one short trip instead of the list order
+    std::vector<Position> positions;
+    positions.reserve(crops_positions.size());
+    {
+        const Vector3<double> player_position = client.GetEntityManager()->GetLocalPlayer()->GetState().position;
+        const Position start(std::floor(player_position.x), std::floor(player_position.y), std::floor(player_position.z));
+        for (const size_t i : OrderVisits(world, start, crops_positions))
+        {
+            positions.push_back(crops_positions[i]);
+        }
+    }
 
     for (int i = 0; i < positions.size(); ++i)
     {
@@ -837,7 +859,25 @@ Status CollectCropsAndReplant(BehaviourClient& client, const std::string& blocks
         client.Yield();
     }
 
+    // Pick up the items in one short trip too
+    std::vector<int> items_ids;
+    std::vector<Position> items_positions;
     for (const auto& e : entity_positions)
+    {
+        items_ids.push_back(e.first);
+        items_positions.push_back(Position(std::floor(e.second.x), std::floor(e.second.y), std::floor(e.second.z)));
+    }
+    std::vector<std::pair<int, Position> > items;
+    {
+        const Vector3<double> player_position = client.GetEntityManager()->GetLocalPlayer()->GetState().position;
+        const Position start(std::floor(player_position.x), std::floor(player_position.y), std::floor(player_position.z));
+        for (const size_t i : OrderVisits(world, start, items_positions))
+        {
+            items.push_back({ items_ids[i], items_positions[i] });
+        }
+    }
+
+    for (const auto& e : items)
     {
         if (GoTo(client, e.second, 2) == Status::Failure)
         {
@@ -899,23 +939,25 @@ Status DestroyItems(BehaviourClient& client, const std::string& item_name)
     std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
     std::shared_ptr<Window> inventory = inventory_manager->GetPlayerInventory();
 
-    const Position& cactus_standing_pos = blackboard.Get<Position>("DispenserFarmBot.cactus_standing_position");
-    const Position& cactus_pos = blackboard.Get<Position>("DispenserFarmBot.cactus_position");
+    const Position& cactus_standing_pos = blackboard.Get(cactus_standing_position_key);
+    const Position& cactus_pos = blackboard.Get(cactus_position_key);
 
     std::vector<short> slots_to_remove;
     {
         std::lock_guard<std::mutex> lock_inventory_manager(inventory_manager->GetMutex());
-        for (const auto& s : inventory->GetSlots())
+        const std::vector<Slot>& slots = inventory->GetSlots();
+        for (short index = 0; index < static_cast<short>(slots.size()); ++index)
         {
-            if (s.first >= inventory->GetFirstPlayerInventorySlot() && !s.second.IsEmptySlot() &&
+            const Slot& slot = slots[index];
+            if (index >= inventory->GetFirstPlayerInventorySlot() && !slot.IsEmptySlot() &&
 #if PROTOCOL_VERSION < 340
-                AssetsManager::getInstance().Items().at(s.second.GetBlockID()).at(s.second.GetItemDamage())->GetName() == item_name
+                AssetsManager::getInstance().Items().at(slot.GetBlockID()).at(slot.GetItemDamage())->GetName() == item_name
 #else
-                AssetsManager::getInstance().Items().at(s.second.GetItemID())->GetName() == item_name
+                AssetsManager::getInstance().Items().at(slot.GetItemID())->GetName() == item_name
 #endif
                 )
             {
-                slots_to_remove.push_back(s.first);
+                slots_to_remove.push_back(index);
             }
         }
     }
@@ -128,7 +128,11 @@ std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> Create
                 .leaf(Botcraft::CopyBlackboardData, "DispenserFarmBot.buying_standing_position", "GoTo.goal")
                 .leaf(Botcraft::SetBlackboardData<int>, "GoTo.dist_tolerance", 0)
                 .leaf(Botcraft::GoToBlackboard)
-                .leaf(CopyRandomFromVectorBlackboardData<int>, blackboard_entity_location, "InteractEntity.entity_id")
+                // Skip the merchants known to be out of stock
+                .leaf(Botcraft::CopyBlackboardData, blackboard_entity_location, "SelectMerchantName.entity_ids")
+                .leaf(Botcraft::SetBlackboardData<std::string>, "SelectMerchantName.item_name", item_name)
+                .leaf(Botcraft::SetBlackboardData<bool>, "SelectMerchantName.buy", true)
+                .leaf(Botcraft::SelectMerchantNameBlackboard)
                 .leaf(Botcraft::SetBlackboardData<bool>, "InteractEntity.swing", true)
                 .leaf(Botcraft::InteractEntityBlackboard)
                 .repeater(100)
@@ -172,7 +176,11 @@ std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> Create
                 .inverter()
                     .sequence()
                         .leaf(Botcraft::HasItemInInventory, "minecraft:rotten_flesh", 32)
-                        .leaf(CopyRandomFromVectorBlackboardData<int>, "DispenserFarmBot.cleric_id", "InteractEntity.entity_id")
+                        // Skip the merchants known to be out of stock
+                        .leaf(Botcraft::CopyBlackboardData, "DispenserFarmBot.cleric_id", "SelectMerchantName.entity_ids")
+                        .leaf(Botcraft::SetBlackboardData<std::string>, "SelectMerchantName.item_name", std::string("minecraft:rotten_flesh"))
+                        .leaf(Botcraft::SetBlackboardData<bool>, "SelectMerchantName.buy", false)
+                        .leaf(Botcraft::SelectMerchantNameBlackboard)
                         .leaf(Botcraft::SetBlackboardData<bool>, "InteractEntity.swing", true)
                         .leaf(Botcraft::InteractEntityBlackboard)
                         .selector()
@@ -242,7 +250,11 @@ std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> Create
                 .inverter()
                     .sequence()
                         .leaf(Botcraft::HasItemInInventory, "minecraft:white_dye", 12)
-                        .leaf(CopyRandomFromVectorBlackboardData<int>, "DispenserFarmBot.shepperd_id", "InteractEntity.entity_id")
+                        // Skip the merchants known to be out of stock
+                        .leaf(Botcraft::CopyBlackboardData, "DispenserFarmBot.shepperd_id", "SelectMerchantName.entity_ids")
+                        .leaf(Botcraft::SetBlackboardData<std::string>, "SelectMerchantName.item_name", std::string("minecraft:white_dye"))
+                        .leaf(Botcraft::SetBlackboardData<bool>, "SelectMerchantName.buy", false)
+                        .leaf(Botcraft::SelectMerchantNameBlackboard)
                         .leaf(Botcraft::SetBlackboardData<bool>, "InteractEntity.swing", true)
                         .leaf(Botcraft::InteractEntityBlackboard)
                         .selector()
@@ -279,7 +291,11 @@ std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> Create
                 .inverter()
                     .sequence()
                         .leaf(Botcraft::HasItemInInventory, item_name, min_item_to_sell)
-                        .leaf(CopyRandomFromVectorBlackboardData<int>, "DispenserFarmBot.farmer_id", "InteractEntity.entity_id")
+                        // Skip the merchants known to be out of stock
+                        .leaf(Botcraft::CopyBlackboardData, "DispenserFarmBot.farmer_id", "SelectMerchantName.entity_ids")
+                        .leaf(Botcraft::SetBlackboardData<std::string>, "SelectMerchantName.item_name", item_name)
+                        .leaf(Botcraft::SetBlackboardData<bool>, "SelectMerchantName.buy", false)
+                        .leaf(Botcraft::SelectMerchantNameBlackboard)
                         .leaf(Botcraft::SetBlackboardData<bool>, "InteractEntity.swing", true)
                         .leaf(Botcraft::InteractEntityBlackboard)
                         .repeater(100)
@@ -352,6 +368,7 @@ std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> Create
 
 std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> CreateCraftDispenserTree()
 {
+#if PROTOCOL_VERSION < 348
     std::array<std::array<std::string, 3>, 3> dispenser_recipe;
     dispenser_recipe[0][0] = "minecraft:cobblestone";
     dispenser_recipe[0][1] = "minecraft:cobblestone";
@@ -362,6 +379,7 @@ std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> Create
     dispenser_recipe[2][0] = "minecraft:cobblestone";
     dispenser_recipe[2][1] = "minecraft:redstone";
     dispenser_recipe[2][2] = "minecraft:cobblestone";
+#endif
 
     return Botcraft::Builder<Botcraft::SimpleBehaviourClient>()
         .sequence()
@@ -373,7 +391,12 @@ std::shared_ptr<Botcraft::BehaviourTree<Botcraft::SimpleBehaviourClient>> Create
             .repeater(100)
                 .leaf(Botcraft::Yield)
             .end()
+#if PROTOCOL_VERSION < 348
             .leaf(Botcraft::CraftNamed, dispenser_recipe, false)
+#else
+            // Use the server recipes, crafting the bow from sticks and string if needed
+            .leaf(Botcraft::CraftItem, "minecraft:dispenser", 1, false)
+#endif
             .leaf(Botcraft::CloseContainer, -1)
             .selector()
                 .leaf(StoreDispenser)
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include "botcraft/Game/ClientMetrics.hpp"
+#include "botcraft/Game/ManagersClient.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+void ShowHelp(const char* argv0)
+{
+    std::cout << "Usage: " << argv0 << " <options>\n"
+        << "Record the packets sent by a server, or replay them without any server to benchmark packets processing\n"
+        << "Options:\n"
+        << "\t-h, --help\tShow this help message\n"
+        << "\t--record\tConnect to a server and record the received packets in this file\n"
+        << "\t--replay\tProcess the packets of this file instead of connecting to a server\n"
+        << "\t--address\tAddress of the server you want to connect to, default: 127.0.0.1:25565\n"
+        << "\t--login\t\tPlayer name in offline mode, login for Mojang account, empty for Microsoft account, default: BCReplay\n"
+        << "\t--password\tMojang account password, empty for servers in offline mode or Microsoft account, default: empty\n"
+        << "\t--duration\tRecording duration in seconds, default: 30\n"
+        << "\t--speed\t\tReplay speed relative to the capture timings, 0 to replay as fast as possible, default: 0\n"
+        << "\t--repeat\tNumber of times the capture is replayed, default: 1\n"
+        << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // Init logging, log everything >= Info, only to console, no file
+        Botcraft::Logger::GetInstance().SetLogLevel(Botcraft::LogLevel::Info);
+        Botcraft::Logger::GetInstance().SetFilename("");
+        // Add a name to this thread for logging
+        Botcraft::Logger::GetInstance().RegisterThread("main");
+
+        std::string address = "127.0.0.1:25565";
+        std::string login = "BCReplay";
+        std::string password = "";
+        std::string record_path = "";
+        std::string replay_path = "";
+        int duration = 30;
+        double speed = 0.0;
+        int repeat = 1;
+
+        if (argc == 1)
+        {
+            ShowHelp(argv[0]);
+            return 0;
+        }
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help")
+            {
+                ShowHelp(argv[0]);
+                return 0;
+            }
+
+            // All other options take one argument
+            if (i + 1 >= argc)
+            {
+                LOG_FATAL(arg << " requires an argument");
+                return 1;
+            }
+
+            if (arg == "--record")
+            {
+                record_path = argv[++i];
+            }
+            else if (arg == "--replay")
+            {
+                replay_path = argv[++i];
+            }
+            else if (arg == "--address")
+            {
+                address = argv[++i];
+            }
+            else if (arg == "--login")
+            {
+                login = argv[++i];
+            }
+            else if (arg == "--password")
+            {
+                password = argv[++i];
+            }
+            else if (arg == "--duration")
+            {
+                duration = std::stoi(argv[++i]);
+            }
+            else if (arg == "--speed")
+            {
+                speed = std::stod(argv[++i]);
+            }
+            else if (arg == "--repeat")
+            {
+                repeat = std::stoi(argv[++i]);
+            }
+            else
+            {
+                LOG_FATAL("Unknown option " << arg);
+                return 1;
+            }
+        }
+
+        if (record_path.empty() == replay_path.empty())
+        {
+            LOG_FATAL("Exactly one of --record and --replay must be given");
+            return 1;
+        }
+
+        if (!record_path.empty())
+        {
+            Botcraft::ManagersClient client(false);
+            client.SetAutoRespawn(true);
+            client.SetCapturePath(record_path);
+
+            LOG_INFO("Starting connection process");
+            client.Connect(address, login, password);
+            std::this_thread::sleep_for(std::chrono::seconds(duration));
+            client.Disconnect();
+
+            LOG_INFO("Capture saved in " << record_path);
+            return 0;
+        }
+
+        for (int i = 0; i < repeat; ++i)
+        {
+            Botcraft::ManagersClient client(false);
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            const size_t num_packets = client.Replay(replay_path, speed);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const Botcraft::ClientMetrics metrics = client.GetMetrics();
+            unsigned long long num_bytes = 0;
+            double read_time_ms = 0.0;
+            double handle_time_ms = 0.0;
+            for (const auto& p : metrics.network.clientbound)
+            {
+                num_bytes += p.second.bytes;
+                read_time_ms += p.second.read_time_ms;
+                handle_time_ms += p.second.handle_time_ms;
+            }
+
+            LOG_INFO("Replay " << i + 1 << "/" << repeat << ": " << num_packets << " packets in " << seconds << " s ("
+                << num_packets / seconds << " packets/s, " << num_bytes / seconds / 1e6 << " MB/s of Play packets)\n"
+                << "\tParsing: " << read_time_ms << " ms, handlers: " << handle_time_ms << " ms\n"
+                << "\tWorld: " << metrics.world.num_chunks << " chunks, " << metrics.world.num_sections << " sections, "
+                << metrics.world.memory_bytes / 1e6 << " MB\n"
+                << "\tEntities: " << metrics.entities.num_entities);
+
+            client.Disconnect();
+        }
+
+        return 0;
+    }
+    catch (std::exception &e)
+    {
+        LOG_FATAL("Exception: " << e.what());
+        return 1;
+    }
+    catch (...)
+    {
+        LOG_FATAL("Unknown exception");
+        return 2;
+    }
+
+    return 0;
+}
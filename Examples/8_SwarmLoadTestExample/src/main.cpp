@@ -0,0 +1,262 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include "botcraft/AI/SimpleBehaviourClient.hpp"
+#include "botcraft/AI/Swarm.hpp"
+#include "botcraft/Network/FakeServer.hpp"
+#include "botcraft/Game/World/WorldSnapshot.hpp"
+#include "botcraft/Network/NetworkManager.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
+
+void ShowHelp(const char* argv0)
+{
+    std::cout << "Usage: " << argv0 << " <options>\n"
+        << "Start an in-process fake server and connect a swarm of bots to it, to measure how the bots scale without a real server\n"
+        << "Options:\n"
+        << "\t-h, --help\tShow this help message\n"
+        << "\t--bots\t\tNumber of bots, default: 100\n"
+        << "\t--port\t\tPort of the fake server, default: 25565\n"
+        << "\t--view-distance\tRadius of the chunk square sent to each bot, default: 4\n"
+        << "\t--entities\tNumber of mobs around spawn, default: 32\n"
+        << "\t--entity-rate\tMoves per second of each mob, default: 5\n"
+        << "\t--chunk-rate\tChunks sent again to each bot per second, default: 0\n"
+        << "\t--compression\tCompression threshold, -1 to disable compression, default: 256\n"
+        << "\t--duration\tTest duration in seconds, default: 60\n"
+        << "\t--metrics-port\tIf not 0, serve the bots metrics in Prometheus format on this port, default: 0\n"
+        << "\t--control-port\tIf not 0, accept control requests (see ControlServer) on this port, default: 0\n"
+        << "\t--decompression-threads\tIf >= 0, decompress the big packets on a pool with this number of threads (0 for one per core), default: -1\n"
+        << "\t--affinity-groups\tPin the bots to groups of cores: -1 for one group per NUMA node, N > 0 to split the cores in N groups, default: 0 (no pinning)\n"
+        << "\t--world\t\tIf not empty, file created with WorldSnapshot::Write to use instead of the flat world, bots spawn at 0,0, default: empty\n"
+        << "\t--speed\t\tSpeed of the game time compared to real time (see VirtualClock), default: 1"
+        << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // Init logging, log everything >= Info, only to console, no file
+        Botcraft::Logger::GetInstance().SetLogLevel(Botcraft::LogLevel::Info);
+        Botcraft::Logger::GetInstance().SetFilename("");
+        // Add a name to this thread for logging
+        Botcraft::Logger::GetInstance().RegisterThread("main");
+
+        int num_bots = 100;
+        int duration = 60;
+        unsigned short metrics_port = 0;
+        unsigned short control_port = 0;
+        int decompression_threads = -1;
+        int affinity_groups = 0;
+        std::string world_file;
+        double speed = 1.0;
+        Botcraft::FakeServerConfig server_config;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help")
+            {
+                ShowHelp(argv[0]);
+                return 0;
+            }
+
+            // All other options take one argument
+            if (i + 1 >= argc)
+            {
+                LOG_FATAL(arg << " requires an argument");
+                return 1;
+            }
+
+            if (arg == "--bots")
+            {
+                num_bots = std::stoi(argv[++i]);
+            }
+            else if (arg == "--port")
+            {
+                server_config.port = static_cast<unsigned short>(std::stoi(argv[++i]));
+            }
+            else if (arg == "--view-distance")
+            {
+                server_config.view_distance = std::stoi(argv[++i]);
+            }
+            else if (arg == "--entities")
+            {
+                server_config.num_entities = std::stoi(argv[++i]);
+            }
+            else if (arg == "--entity-rate")
+            {
+                server_config.entity_moves_per_second = std::stod(argv[++i]);
+            }
+            else if (arg == "--chunk-rate")
+            {
+                server_config.chunks_per_second = std::stod(argv[++i]);
+            }
+            else if (arg == "--compression")
+            {
+                server_config.compression_threshold = std::stoi(argv[++i]);
+            }
+            else if (arg == "--duration")
+            {
+                duration = std::stoi(argv[++i]);
+            }
+            else if (arg == "--metrics-port")
+            {
+                metrics_port = static_cast<unsigned short>(std::stoi(argv[++i]));
+            }
+            else if (arg == "--control-port")
+            {
+                control_port = static_cast<unsigned short>(std::stoi(argv[++i]));
+            }
+            else if (arg == "--decompression-threads")
+            {
+                decompression_threads = std::stoi(argv[++i]);
+            }
+            else if (arg == "--affinity-groups")
+            {
+                affinity_groups = std::stoi(argv[++i]);
+            }
+            else if (arg == "--world")
+            {
+                world_file = argv[++i];
+            }
+            else if (arg == "--speed")
+            {
+                speed = std::stod(argv[++i]);
+            }
+            else
+            {
+                LOG_FATAL("Unknown option " << arg);
+                return 1;
+            }
+        }
+
+        Botcraft::VirtualClock::SetSpeed(speed);
+        if (!world_file.empty())
+        {
+            std::ifstream file(world_file, std::ios::binary);
+            if (!file)
+            {
+                LOG_FATAL("Can't open " << world_file);
+                return 1;
+            }
+            const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            ProtocolCraft::ReadIterator iter = data.data();
+            size_t length = data.size();
+            std::shared_ptr<Botcraft::WorldSnapshot> world = std::make_shared<Botcraft::WorldSnapshot>(Botcraft::WorldSnapshot::Read(iter, length));
+            server_config.world = world;
+            server_config.spawn_position.y = world->GetHighestBlock(0, 0, Botcraft::HeightmapType::MotionBlocking) + 1.0;
+            LOG_INFO("Loaded " << world->GetAllChunks().size() << " chunks from " << world_file);
+        }
+
+        Botcraft::FakeServer server(server_config);
+        const std::string address = server_config.address + ":" + std::to_string(server_config.port);
+
+        Botcraft::SwarmConfig swarm_config;
+        if (decompression_threads >= 0)
+        {
+            // The pool is only used by connections with their own processing thread
+            swarm_config.process_packets_on_io_threads = false;
+            Botcraft::NetworkManager::StartDecompressionPool(decompression_threads);
+        }
+        if (affinity_groups < 0)
+        {
+            swarm_config.affinity_groups = Botcraft::GetNumaNodesCpus();
+        }
+        else if (affinity_groups > 0)
+        {
+            std::vector<int> cpus;
+            for (const std::vector<int>& node : Botcraft::GetNumaNodesCpus())
+            {
+                cpus.insert(cpus.end(), node.begin(), node.end());
+            }
+            // Contiguous slices, so groups don't cross NUMA nodes when possible
+            swarm_config.affinity_groups.resize(affinity_groups);
+            for (size_t i = 0; i < cpus.size(); ++i)
+            {
+                swarm_config.affinity_groups[i * affinity_groups / cpus.size()].push_back(cpus[i]);
+            }
+            // More groups than cpus
+            for (size_t i = 0; i < swarm_config.affinity_groups.size(); ++i)
+            {
+                if (swarm_config.affinity_groups[i].empty())
+                {
+                    swarm_config.affinity_groups[i].push_back(cpus[i % cpus.size()]);
+                }
+            }
+        }
+        Botcraft::Swarm<Botcraft::SimpleBehaviourClient> swarm(swarm_config);
+        if (metrics_port != 0)
+        {
+            swarm.StartMetricsServer(metrics_port);
+        }
+        if (control_port != 0)
+        {
+            swarm.StartControlServer(control_port);
+        }
+
+        LOG_INFO("Connecting " << num_bots << " bots to " << address);
+        for (int i = 0; i < num_bots; ++i)
+        {
+            swarm.AddBot(address, "BCLoad" + std::to_string(i));
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Botcraft::FakeServerStats previous_stats;
+        for (int t = 1; t <= duration; ++t)
+        {
+            std::this_thread::sleep_until(start + std::chrono::seconds(t));
+
+            const Botcraft::FakeServerStats stats = server.GetStats();
+            unsigned long long packets_in = 0;
+            unsigned long long bytes_in = 0;
+            size_t num_entities = 0;
+            size_t connected = 0;
+            for (const Botcraft::ClientMetrics& m : swarm.GetMetrics())
+            {
+                packets_in += m.network.packets_in;
+                bytes_in += m.network.bytes_in;
+                num_entities = std::max(num_entities, m.entities.num_entities);
+                connected += !m.name.empty();
+            }
+
+            LOG_INFO("[" << t << " s] " << connected << "/" << num_bots << " bots, " << stats.players << " players on server, "
+                << stats.slow_players_dropped << " dropped\n"
+                << "\tServer: " << stats.packets_sent - previous_stats.packets_sent << " packets/s, "
+                << (stats.bytes_sent - previous_stats.bytes_sent) / 1e6 << " MB/s\n"
+                << "\tBots: " << packets_in << " packets and " << bytes_in / 1e6 << " MB received in total, "
+                << num_entities << " entities\n"
+                << "\tKeep alive RTT: " << stats.mean_keep_alive_rtt_ms << " ms mean, " << stats.max_keep_alive_rtt_ms << " ms max");
+            previous_stats = stats;
+
+            if (!swarm_config.affinity_groups.empty())
+            {
+                for (const Botcraft::SwarmGroupReport& report : swarm.GetGroupReport())
+                {
+                    LOG_INFO("\tGroup " << report.group << " (" << report.cpus.size() << " cpus): " << report.num_connected << "/" << report.num_bots << " bots, "
+                        << report.packets_in_per_s << " packets/s, " << report.bytes_in_per_s / 1e6 << " MB/s");
+                }
+            }
+        }
+
+        swarm.Stop();
+        return 0;
+    }
+    catch (std::exception &e)
+    {
+        LOG_FATAL("Exception: " << e.what());
+        return 1;
+    }
+    catch (...)
+    {
+        LOG_FATAL("Unknown exception");
+        return 2;
+    }
+
+    return 0;
+}
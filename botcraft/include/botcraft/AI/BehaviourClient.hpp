@@ -1,10 +1,37 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
 #include "botcraft/Game/ManagersClient.hpp"
 #include "botcraft/AI/Blackboard.hpp"
+#include "botcraft/Utilities/TimerWheel.hpp"
 
 namespace Botcraft
 {
+    struct ParallelChild;
+
+    struct BehaviourStats
+    {
+        /// @brief Number of behaviour steps run
+        unsigned long long num_steps = 0;
+        /// @brief Total time spent in the behaviour steps, in ms
+        double total_step_time_ms = 0.0;
+        /// @brief Duration of the last step, in ms
+        double last_step_time_ms = 0.0;
+        /// @brief Longest step duration, in ms
+        double max_step_time_ms = 0.0;
+        /// @brief Number of timers waiting to fire
+        size_t num_timers = 0;
+        /// @brief Number of steps longer than the BehaviourScheduler budget
+        unsigned long long num_budget_overruns = 0;
+        /// @brief Number of steps skipped by the BehaviourScheduler to pay back overruns
+        unsigned long long num_throttled_steps = 0;
+    };
+
     /// @brief A ManagersClient extended with a blackboard that can store any
     /// kind of data and a virtual Yield function.
     /// You should **not** inherit from this class, but from TemplatedBehaviourClient
@@ -17,9 +44,102 @@ namespace Botcraft
 
         virtual void Yield() = 0;
 
+        /// @brief Run the behaviour until the next Yield call
+        virtual void BehaviourStep() = 0;
+
         Blackboard& GetBlackboard();
 
+        /// @brief Yield until condition is true. condition is only checked
+        /// again after an event of the given type, and the behaviour isn't
+        /// resumed at all in between, so a waiting bot doesn't cost anything.
+        /// Must be called from the behaviour
+        /// @param type The event that can make condition true
+        /// @param condition The condition to wait for
+        /// @param timeout_ms Max waiting time, in ms
+        /// @return True if condition is true, false if timeout has been reached
+        const bool WaitFor(const EventType type, const std::function<bool()>& condition, const int timeout_ms);
+
+        /// @brief Yield until the next event of the given type
+        /// @param type The event to wait for
+        /// @param timeout_ms Max waiting time, in ms
+        /// @return True if the event happened, false if timeout has been reached
+        const bool WaitFor(const EventType type, const int timeout_ms);
+
+        /// @brief Yield for a given time. The behaviour isn't resumed
+        /// at all in between. Must be called from the behaviour
+        /// @param duration_ms Waiting time, in ms
+        void Wait(const int duration_ms);
+
+        /// @brief Get the timers of this client. They are fired on the thread
+        /// stepping the behaviour, just before each step, with a 10 ms resolution.
+        /// Can be used to schedule delayed actions from the behaviour
+        TimerWheel& GetTimers();
+
+        /// @brief Get the Parallel node child currently running, if any
+        ParallelChild* GetParallelChild() const;
+        /// @brief Set by Parallel nodes around their children ticks
+        void SetParallelChild(ParallelChild* child);
+
+        /// @brief Get the index of the innermost Profiler node currently
+        /// running, or BehaviourClient::no_profiled_node
+        const size_t GetProfiledNode() const;
+        /// @brief Set by Profiler nodes around their child tick
+        void SetProfiledNode(const size_t index);
+
+        /// @brief Set the BehaviourScheduler priority of this client. High
+        /// priority clients are stepped first and are never throttled
+        /// when they exceed the step budget
+        /// @param b True for high priority
+        void SetHighPriority(const bool b);
+        const bool GetHighPriority() const;
+
+        /// @brief Get the time spent running the behaviour
+        const BehaviourStats GetBehaviourStats() const;
+
+        /// @brief Get the resources used by this bot, behaviour included
+        virtual ClientMetrics GetMetrics() override;
+
+    public:
+        static constexpr size_t no_profiled_node = static_cast<size_t>(-1);
+
+    protected:
+        /// @brief Check if the behaviour is waiting in WaitFor, and
+        /// shouldn't be resumed as nothing happened since
+        const bool IsWaitingForEvent() const;
+
+        /// @brief Fire the timers that reached their deadline. Called before each behaviour step
+        void AdvanceTimers();
+
+        /// @brief Update the behaviour counters after a step
+        /// @param duration Time spent in the step
+        void RecordBehaviourStep(const std::chrono::steady_clock::duration duration);
+
     protected:
         Blackboard blackboard;
+
+    private:
+        friend class BehaviourScheduler;
+
+        /// @brief Called by the BehaviourScheduler when a step exceeded the budget
+        void RecordBudgetOverrun();
+        /// @brief Called by the BehaviourScheduler when a step is skipped
+        void RecordThrottledStep();
+
+    private:
+        // Set by WaitFor before yielding, read by the thread stepping the behaviour
+        std::atomic<bool> waiting_event;
+        EventType waiting_event_type;
+        unsigned long long waiting_event_count;
+        /// @brief Set by the timer of the current WaitFor call when its timeout is reached
+        std::shared_ptr<std::atomic<bool> > waiting_event_timed_out;
+
+        TimerWheel timers;
+
+        ParallelChild* parallel_child;
+        size_t profiled_node;
+        std::atomic<bool> high_priority;
+
+        mutable std::mutex behaviour_stats_mutex;
+        BehaviourStats behaviour_stats;
     };
 } // namespace Botcraft
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Botcraft
+{
+    struct NodeProfile
+    {
+        /// @brief Name given to the Profiler node
+        std::string name;
+        /// @brief Number of completed ticks
+        unsigned long long num_ticks = 0;
+        /// @brief Number of ticks that returned Success
+        unsigned long long num_success = 0;
+        /// @brief Sum of the ticks wall time, in ms (including the time spent in Yield)
+        double total_ms = 0.0;
+        /// @brief Longest tick wall time, in ms
+        double max_ms = 0.0;
+        /// @brief Number of behaviour steps that exceeded the BehaviourScheduler
+        /// budget while this node was the innermost running Profiler node
+        unsigned long long num_budget_overruns = 0;
+        /// @brief Sum of the time spent above the budget during these steps, in ms
+        double total_overrun_ms = 0.0;
+    };
+
+    /// @brief A process-wide registry of the stats recorded by the
+    /// Profiler nodes. Nodes with the same name (e.g. the same tree
+    /// used by several bots) share their stats.
+    class BehaviourProfiler
+    {
+    public:
+        static BehaviourProfiler& GetInstance();
+
+        BehaviourProfiler(const BehaviourProfiler&) = delete;
+        BehaviourProfiler& operator=(const BehaviourProfiler&) = delete;
+        BehaviourProfiler(BehaviourProfiler&&) = delete;
+        BehaviourProfiler& operator=(BehaviourProfiler&&) = delete;
+
+        /// @brief Get the index of a profiled node, registering it if necessary
+        /// @param name Node name
+        /// @return The index to use in Record
+        const size_t GetNodeIndex(const std::string& name);
+
+        /// @brief Add a tick to a node stats
+        /// @param index Node index, from GetNodeIndex
+        /// @param success True if the tick returned Success
+        /// @param duration_ms Tick wall time, in ms
+        void Record(const size_t index, const bool success, const double duration_ms);
+
+        /// @brief Add a behaviour step budget overrun to a node stats
+        /// @param index Node index, from GetNodeIndex
+        /// @param overrun_ms Time spent above the budget, in ms
+        void RecordBudgetOverrun(const size_t index, const double overrun_ms);
+
+        /// @brief Get a copy of all the nodes stats
+        const std::vector<NodeProfile> GetProfiles() const;
+
+        /// @brief Get all the nodes stats formatted as a table
+        const std::string Dump() const;
+
+        /// @brief Set all the recorded stats to 0, registered names are kept
+        void Reset();
+
+    private:
+        BehaviourProfiler() {}
+
+    private:
+        mutable std::mutex profiler_mutex;
+        std::vector<NodeProfile> profiles;
+        std::unordered_map<std::string, size_t> indices;
+    };
+} // Botcraft
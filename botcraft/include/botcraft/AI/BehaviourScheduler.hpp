@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Botcraft
+{
+    class BehaviourClient;
+
+    /// @brief A process-wide scheduler stepping the behaviour of all the
+    /// registered clients on a few worker threads, every 10 ms. Clients
+    /// started with StartBehaviourOnScheduler run their tree in a fiber
+    /// instead of a dedicated thread, and Yield just switches back to the
+    /// worker, so thousands of bots don't need thousands of threads. Each
+    /// client is pinned to one worker, and the clients of a worker are
+    /// stepped one after the other: a client doing a lot of work between
+    /// two Yield delays all the others of its worker. To keep this fair,
+    /// a step budget can be set: clients whose step exceed it are skipped
+    /// for the next ticks until the extra time is paid back, and the
+    /// overrun is recorded for the innermost running Profiler node.
+    /// High priority clients (see BehaviourClient::SetHighPriority) are
+    /// always stepped first and never skipped.
+    /// If AffinityGroups are set when the workers start, workers are split
+    /// between the groups, and clients go to a worker of the group of the
+    /// thread registering them.
+    class BehaviourScheduler
+    {
+    public:
+        static BehaviourScheduler& GetInstance();
+
+        BehaviourScheduler(const BehaviourScheduler&) = delete;
+        BehaviourScheduler& operator=(const BehaviourScheduler&) = delete;
+        BehaviourScheduler(BehaviourScheduler&&) = delete;
+        BehaviourScheduler& operator=(BehaviourScheduler&&) = delete;
+        ~BehaviourScheduler();
+
+        /// @brief Set the number of threads stepping the behaviours. Only
+        /// applied when no client is registered
+        /// @param n Number of worker threads, must be > 0
+        void SetNumWorkers(const unsigned int n);
+        const unsigned int GetNumWorkers() const;
+
+        /// @brief Set the stack size of the behaviour fibers started after this call
+        /// @param size Stack size in bytes
+        void SetStackSize(const size_t size);
+        const size_t GetStackSize() const;
+
+        /// @brief Set the time a client can spend in one step. A client
+        /// exceeding it is skipped for the next ticks, until its extra time
+        /// is paid back at the rate of one budget per skipped tick
+        /// @param budget Step budget, 0 (default) to disable
+        void SetStepBudget(const std::chrono::microseconds& budget);
+        const std::chrono::microseconds GetStepBudget() const;
+
+        /// @brief Add a client to step every 10 ms, on the worker with the
+        /// less clients (in the affinity group of the calling thread if any).
+        /// Worker threads are started with the first registered client
+        void Register(BehaviourClient* client);
+
+        /// @brief Remove a client from the scheduler. Blocks until its worker
+        /// is done with the current step, so the client is never stepped after
+        /// this returns. Worker threads are stopped with the last unregistered
+        /// client. Must not be called from a behaviour step
+        /// @param client The client to remove
+        /// @param last_step If not empty, called by the worker of the client
+        /// instead of its next step, before removing it. Used to unwind a
+        /// behaviour fiber on the thread it always ran on
+        void Unregister(BehaviourClient* client, const std::function<void()>& last_step = std::function<void()>());
+
+    private:
+        BehaviourScheduler();
+
+        void Start();
+        void Stop();
+
+        struct ScheduledClient
+        {
+            BehaviourClient* client;
+            /// @brief Time spent above the budget not paid back yet, in us
+            long long int debt_us;
+            /// @brief If not empty, run by the worker before removing the client
+            std::function<void()> last_step;
+        };
+
+        struct Worker
+        {
+            std::mutex mutex;
+            /// @brief Notified when clients with a last step are removed
+            std::condition_variable removed_condition;
+            std::vector<ScheduledClient> clients;
+            std::thread thread;
+            /// @brief Affinity group of the thread, -1 if none
+            int group = -1;
+        };
+
+        void RunWorker(Worker* worker);
+        /// @brief Run the last step of the unregistered clients of a worker
+        /// and remove them. worker->mutex must be locked
+        void RemoveUnregistered(Worker* worker);
+        /// @brief Step a client if it's not throttled, and update its debt
+        void StepClient(ScheduledClient& scheduled, const long long int budget_us);
+
+    private:
+        // Serialize Register/Unregister/SetNumWorkers
+        std::mutex lifecycle_mutex;
+        unsigned int num_workers;
+        std::atomic<size_t> stack_size;
+        std::atomic<long long int> step_budget_us;
+        size_t num_clients;
+
+        std::atomic<bool> running;
+        std::vector<std::unique_ptr<Worker> > workers;
+    };
+} // Botcraft
@@ -3,6 +3,18 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <type_traits>
+#include <mutex>
+#include <unordered_map>
+
+#include "botcraft/AI/BehaviourProfiler.hpp"
+#include "botcraft/Game/EventNotifier.hpp"
+#include "botcraft/Utilities/Fiber.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
 
 // A behaviour tree implementation following this blog article
 // https://www.gamasutra.com/blogs/ChrisSimpson/20140717/221339/Behavior_trees_for_AI_How_they_work.php
@@ -20,6 +32,30 @@ namespace Botcraft
         Success
     };
 
+    /// @brief How many children of a Parallel node
+    /// must succeed (or fail) to end it
+    enum class ParallelPolicy
+    {
+        RequireOne,
+        RequireAll
+    };
+
+    /// @brief A child running in a Parallel node. While it's set
+    /// in the context, Yield only switches back to the Parallel node
+    struct ParallelChild
+    {
+        Fiber* fiber = nullptr;
+        bool cancelled = false;
+        /// @brief False until the fiber is resumed for the first time
+        bool started = false;
+    };
+
+    /// @brief Thrown by Yield in a Parallel child that is not needed
+    /// anymore, to unwind it. Should not be caught by tasks
+    class ParallelCancelledException : public std::exception
+    {
+    };
+
     template<class Context>
     class Node
     {
@@ -81,6 +117,8 @@ namespace Botcraft
         virtual ~Leaf() {}
         virtual const Status Tick(Context& context) const override
         {
+            // Leaves can yield and be resumed on another thread, so they are recorded on the context track
+            TRACE_ASYNC_ZONE("Leaf", &context);
             return func(context);
         }
 
@@ -169,6 +207,151 @@ namespace Botcraft
 
 
 
+    /// @brief Parallel implementation. Tick all children at the same
+    /// time, each one in its own fiber: when a child yields, the next
+    /// one is resumed, and the context really yields once all of them
+    /// did. Stops as soon as the policies are met, the children still
+    /// running are cancelled.
+    /// The context must provide GetParallelChild/SetParallelChild and
+    /// handle them in Yield (as TemplatedBehaviourClient does).
+    /// @tparam Context The tree context type
+    template<class Context>
+    class Parallel : public Composite<Context>
+    {
+    public:
+        /// @param success_policy_ RequireOne to succeed as soon as one child succeeds, RequireAll to wait for all of them
+        /// @param failure_policy_ RequireOne to fail as soon as one child fails, RequireAll to wait for all of them
+        /// @param stack_size_ Stack size of the children fibers, in bytes
+        Parallel(const ParallelPolicy success_policy_ = ParallelPolicy::RequireAll,
+            const ParallelPolicy failure_policy_ = ParallelPolicy::RequireOne,
+            const size_t stack_size_ = 256 * 1024)
+        {
+            success_policy = success_policy_;
+            failure_policy = failure_policy_;
+            stack_size = stack_size_;
+        }
+
+        virtual const Status Tick(Context& context) const override
+        {
+            const size_t num_children = this->children.size();
+            std::vector<ParallelChild> states(num_children);
+            std::vector<Status> results(num_children, Status::Failure);
+            std::vector<std::exception_ptr> exceptions(num_children);
+            std::vector<std::unique_ptr<Fiber> > fibers(num_children);
+            for (size_t i = 0; i < num_children; ++i)
+            {
+                fibers[i] = std::make_unique<Fiber>([&, i]()
+                    {
+                        try
+                        {
+                            results[i] = this->children[i]->Tick(context);
+                        }
+                        catch (const ParallelCancelledException&)
+                        {
+
+                        }
+                        catch (...)
+                        {
+                            exceptions[i] = std::current_exception();
+                        }
+                    }, stack_size);
+                states[i].fiber = fibers[i].get();
+            }
+
+            Status status = Status::Success;
+            std::exception_ptr exception = nullptr;
+            try
+            {
+                while (true)
+                {
+                    size_t num_finished = 0;
+                    size_t num_success = 0;
+                    size_t num_failure = 0;
+                    for (size_t i = 0; i < num_children; ++i)
+                    {
+                        if (!fibers[i]->IsFinished())
+                        {
+                            ResumeChild(context, states[i]);
+                        }
+                        if (fibers[i]->IsFinished())
+                        {
+                            if (exceptions[i] != nullptr)
+                            {
+                                std::rethrow_exception(exceptions[i]);
+                            }
+                            num_finished += 1;
+                            num_success += results[i] == Status::Success;
+                            num_failure += results[i] == Status::Failure;
+                        }
+                    }
+
+                    if (success_policy == ParallelPolicy::RequireOne && num_success > 0)
+                    {
+                        status = Status::Success;
+                        break;
+                    }
+                    if (failure_policy == ParallelPolicy::RequireOne && num_failure > 0)
+                    {
+                        status = Status::Failure;
+                        break;
+                    }
+                    if (num_finished == num_children)
+                    {
+                        const bool success = success_policy == ParallelPolicy::RequireAll ? num_success == num_children : num_success > 0;
+                        status = success ? Status::Success : Status::Failure;
+                        break;
+                    }
+
+                    context.Yield();
+                }
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            // Unwind the children still running
+            for (size_t i = 0; i < num_children; ++i)
+            {
+                // A child that never ran has nothing to unwind,
+                // resuming it would start its Tick
+                if (!states[i].started)
+                {
+                    fibers[i]->Cancel();
+                    continue;
+                }
+                states[i].cancelled = true;
+                while (!fibers[i]->IsFinished())
+                {
+                    ResumeChild(context, states[i]);
+                }
+            }
+
+            if (exception != nullptr)
+            {
+                std::rethrow_exception(exception);
+            }
+            return status;
+        }
+
+    private:
+        static void ResumeChild(Context& context, ParallelChild& child)
+        {
+            // Save the current child in case we are in a nested Parallel
+            ParallelChild* previous = context.GetParallelChild();
+            context.SetParallelChild(&child);
+            child.started = true;
+            child.fiber->Resume();
+            context.SetParallelChild(previous);
+        }
+
+    private:
+        ParallelPolicy success_policy;
+        ParallelPolicy failure_policy;
+        size_t stack_size;
+    };
+
+
     // Common Decorators implementations
         
     /// @brief A Decorator that inverts the result of its child.
@@ -242,6 +425,205 @@ namespace Botcraft
         size_t n;
     };
 
+    /// @brief Base class of the Decorators that memoize the result
+    /// of their child. The tree can be shared between multiple
+    /// contexts, so results are stored per context
+    /// @tparam Context The tree context type
+    template<class Context>
+    class Memoizer : public Decorator<Context>
+    {
+    protected:
+        struct Memo
+        {
+            bool valid = false;
+            Status status = Status::Failure;
+            VirtualClock::time_point time;
+            size_t ticks = 0;
+            unsigned long long event_count = 0;
+        };
+
+        /// @brief Get the memo of a context. Each context is only
+        /// ticked by one thread, so the memo can be used without lock
+        Memo& GetMemo(const Context& context) const
+        {
+            std::lock_guard<std::mutex> lock(memos_mutex);
+            return memos[&context];
+        }
+
+        /// @brief Tick the child and save its result in the memo
+        const Status Update(Context& context, Memo& memo) const
+        {
+            // Invalidate first, if the child throws the next tick runs it again
+            memo.valid = false;
+            memo.status = this->child->Tick(context);
+            memo.valid = true;
+            return memo.status;
+        }
+
+    private:
+        mutable std::mutex memos_mutex;
+        /// @brief unordered_map references are stable, so a memo
+        /// stays valid while other contexts are added
+        mutable std::unordered_map<const Context*, Memo> memos;
+    };
+
+    /// @brief A Decorator that only ticks its child once every n
+    /// ticks, returning the last result of the child in between
+    /// @tparam Context The tree context type
+    template<class Context>
+    class Throttle : public Memoizer<Context>
+    {
+    public:
+        Throttle(const size_t n_)
+        {
+            n = n_;
+        }
+
+        virtual const Status Tick(Context& context) const override
+        {
+            typename Memoizer<Context>::Memo& memo = this->GetMemo(context);
+            if (memo.valid && memo.ticks + 1 < n)
+            {
+                memo.ticks += 1;
+                return memo.status;
+            }
+            memo.ticks = 0;
+            return this->Update(context, memo);
+        }
+
+    private:
+        size_t n;
+    };
+
+    /// @brief A Decorator that ticks its child at most once every
+    /// duration_ms, returning the last result of the child in between
+    /// @tparam Context The tree context type
+    template<class Context>
+    class CacheFor : public Memoizer<Context>
+    {
+    public:
+        CacheFor(const int duration_ms_)
+        {
+            duration_ms = duration_ms_;
+        }
+
+        virtual const Status Tick(Context& context) const override
+        {
+            typename Memoizer<Context>::Memo& memo = this->GetMemo(context);
+            const VirtualClock::time_point now = VirtualClock::now();
+            if (memo.valid && now - memo.time < std::chrono::milliseconds(duration_ms))
+            {
+                return memo.status;
+            }
+            memo.time = now;
+            return this->Update(context, memo);
+        }
+
+    private:
+        int duration_ms;
+    };
+
+    /// @brief A Decorator that only ticks its child again once an event
+    /// of a given type happened, returning the last result of the child
+    /// otherwise. The context must provide GetEventCount (as ManagersClient does)
+    /// @tparam Context The tree context type
+    template<class Context>
+    class UntilChanged : public Memoizer<Context>
+    {
+    public:
+        UntilChanged(const EventType type_)
+        {
+            type = type_;
+        }
+
+        virtual const Status Tick(Context& context) const override
+        {
+            typename Memoizer<Context>::Memo& memo = this->GetMemo(context);
+            const unsigned long long event_count = context.GetEventCount(type);
+            if (memo.valid && memo.event_count == event_count)
+            {
+                return memo.status;
+            }
+            // Get the count before ticking, so events
+            // happening during the tick are not missed
+            memo.event_count = event_count;
+            return this->Update(context, memo);
+        }
+
+    private:
+        EventType type;
+    };
+
+    /// @brief Check if a context provides GetProfiledNode/SetProfiledNode
+    template<class Context, class = void>
+    struct HasProfiledNode : std::false_type {};
+
+    template<class Context>
+    struct HasProfiledNode<Context, std::void_t<decltype(std::declval<Context&>().SetProfiledNode(std::declval<Context&>().GetProfiledNode()))> > : std::true_type {};
+
+    /// @brief A Decorator that records the number of ticks, the
+    /// success ratio and the wall time of its child in the
+    /// BehaviourProfiler, under a given name. Returns the
+    /// result of its child. If the context provides
+    /// GetProfiledNode/SetProfiledNode (like BehaviourClient),
+    /// it is kept informed of the innermost running Profiler
+    /// node, so BehaviourScheduler budget overruns are recorded
+    /// for this node.
+    /// @tparam Context The tree context type
+    template<class Context>
+    class Profiler : public Decorator<Context>
+    {
+    public:
+        Profiler(const std::string& name)
+        {
+            index = BehaviourProfiler::GetInstance().GetNodeIndex(name);
+#if USE_TRACING
+            trace_name = Tracer::GetInstance().Intern(name);
+#endif
+        }
+
+        virtual const Status Tick(Context& context) const override
+        {
+            TRACE_ASYNC_ZONE(trace_name, &context);
+            if constexpr (HasProfiledNode<Context>::value)
+            {
+                const size_t previous = context.GetProfiledNode();
+                context.SetProfiledNode(index);
+                try
+                {
+                    const Status child_status = TickChild(context);
+                    context.SetProfiledNode(previous);
+                    return child_status;
+                }
+                catch (...)
+                {
+                    context.SetProfiledNode(previous);
+                    throw;
+                }
+            }
+            else
+            {
+                return TickChild(context);
+            }
+        }
+
+    private:
+        const Status TickChild(Context& context) const
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            const Status child_status = this->child->Tick(context);
+            const double duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            BehaviourProfiler::GetInstance().Record(index, child_status == Status::Success, duration_ms);
+            return child_status;
+        }
+
+    private:
+        size_t index;
+#if USE_TRACING
+        const char* trace_name;
+#endif
+    };
+
 
 
 
@@ -290,6 +672,15 @@ namespace Botcraft
             return CompositeBuilder<CompositeBuilder, Context>(this, (Selector<Context>*)child.get());
         }
 
+        // Custom function to add a parallel
+        CompositeBuilder<CompositeBuilder, Context> parallel(const ParallelPolicy success_policy = ParallelPolicy::RequireAll,
+            const ParallelPolicy failure_policy = ParallelPolicy::RequireOne)
+        {
+            auto child = std::make_shared<Parallel<Context>>(success_policy, failure_policy);
+            node->AddChild(child);
+            return CompositeBuilder<CompositeBuilder, Context>(this, (Parallel<Context>*)child.get());
+        }
+
         // To add any other type of composite
         template <class CompositeType, class... Args>
         CompositeBuilder<CompositeBuilder, Context> composite(Args... args)
@@ -324,6 +715,38 @@ namespace Botcraft
             return DecoratorBuilder<CompositeBuilder, Context>(this, (Repeater<Context>*)child.get());
         }
 
+        // Profiler
+        DecoratorBuilder<CompositeBuilder, Context> profiler(const std::string& name)
+        {
+            auto child = std::make_shared<Profiler<Context>>(name);
+            node->AddChild(child);
+            return DecoratorBuilder<CompositeBuilder, Context>(this, (Profiler<Context>*)child.get());
+        }
+
+        // Throttle
+        DecoratorBuilder<CompositeBuilder, Context> throttle(const size_t n)
+        {
+            auto child = std::make_shared<Throttle<Context>>(n);
+            node->AddChild(child);
+            return DecoratorBuilder<CompositeBuilder, Context>(this, (Throttle<Context>*)child.get());
+        }
+
+        // CacheFor
+        DecoratorBuilder<CompositeBuilder, Context> cache_for(const int duration_ms)
+        {
+            auto child = std::make_shared<CacheFor<Context>>(duration_ms);
+            node->AddChild(child);
+            return DecoratorBuilder<CompositeBuilder, Context>(this, (CacheFor<Context>*)child.get());
+        }
+
+        // UntilChanged
+        DecoratorBuilder<CompositeBuilder, Context> until_changed(const EventType type)
+        {
+            auto child = std::make_shared<UntilChanged<Context>>(type);
+            node->AddChild(child);
+            return DecoratorBuilder<CompositeBuilder, Context>(this, (UntilChanged<Context>*)child.get());
+        }
+
         // To add any other type of decorator
         template <class DecoratorType, class... Args>
         DecoratorBuilder<CompositeBuilder, Context> decorator(Args... args)
@@ -383,6 +806,15 @@ namespace Botcraft
             return CompositeBuilder<DecoratorBuilder, Context>(this, (Selector<Context>*)child.get());
         }
 
+        // Custom function to add a parallel
+        CompositeBuilder<DecoratorBuilder, Context> parallel(const ParallelPolicy success_policy = ParallelPolicy::RequireAll,
+            const ParallelPolicy failure_policy = ParallelPolicy::RequireOne)
+        {
+            auto child = std::make_shared<Parallel<Context>>(success_policy, failure_policy);
+            node->SetChild(child);
+            return CompositeBuilder<DecoratorBuilder, Context>(this, (Parallel<Context>*)child.get());
+        }
+
         // To add any other type of composite
         template <class CompositeType, class... Args>
         CompositeBuilder<DecoratorBuilder, Context> composite(Args... args)
@@ -417,6 +849,38 @@ namespace Botcraft
             return DecoratorBuilder<DecoratorBuilder, Context>(this, (Repeater<Context>*)child.get());
         }
 
+        // Profiler
+        DecoratorBuilder<DecoratorBuilder, Context> profiler(const std::string& name)
+        {
+            auto child = std::make_shared<Profiler<Context>>(name);
+            node->SetChild(child);
+            return DecoratorBuilder<DecoratorBuilder, Context>(this, (Profiler<Context>*)child.get());
+        }
+
+        // Throttle
+        DecoratorBuilder<DecoratorBuilder, Context> throttle(const size_t n)
+        {
+            auto child = std::make_shared<Throttle<Context>>(n);
+            node->SetChild(child);
+            return DecoratorBuilder<DecoratorBuilder, Context>(this, (Throttle<Context>*)child.get());
+        }
+
+        // CacheFor
+        DecoratorBuilder<DecoratorBuilder, Context> cache_for(const int duration_ms)
+        {
+            auto child = std::make_shared<CacheFor<Context>>(duration_ms);
+            node->SetChild(child);
+            return DecoratorBuilder<DecoratorBuilder, Context>(this, (CacheFor<Context>*)child.get());
+        }
+
+        // UntilChanged
+        DecoratorBuilder<DecoratorBuilder, Context> until_changed(const EventType type)
+        {
+            auto child = std::make_shared<UntilChanged<Context>>(type);
+            node->SetChild(child);
+            return DecoratorBuilder<DecoratorBuilder, Context>(this, (UntilChanged<Context>*)child.get());
+        }
+
         // To add any other type of decorator
         template <class DecoratorType, class... Args>
         DecoratorBuilder<DecoratorBuilder, Context> decorator(Args... args)
@@ -472,6 +936,14 @@ namespace Botcraft
             return CompositeBuilder<Builder, Context>(this, (Selector<Context>*)root.get());
         }
 
+        // Custom function to add a parallel
+        CompositeBuilder<Builder, Context> parallel(const ParallelPolicy success_policy = ParallelPolicy::RequireAll,
+            const ParallelPolicy failure_policy = ParallelPolicy::RequireOne)
+        {
+            root = std::make_shared<Parallel<Context>>(success_policy, failure_policy);
+            return CompositeBuilder<Builder, Context>(this, (Parallel<Context>*)root.get());
+        }
+
         // To add any other type of composite
         template <class CompositeType, class... Args>
         CompositeBuilder<Builder, Context> composite(Args... args)
@@ -502,6 +974,34 @@ namespace Botcraft
             return DecoratorBuilder<Builder, Context>(this, (Repeater<Context>*)root.get());
         }
 
+        // Profiler
+        DecoratorBuilder<Builder, Context> profiler(const std::string& name)
+        {
+            root = std::make_shared<Profiler<Context>>(name);
+            return DecoratorBuilder<Builder, Context>(this, (Profiler<Context>*)root.get());
+        }
+
+        // Throttle
+        DecoratorBuilder<Builder, Context> throttle(const size_t n)
+        {
+            root = std::make_shared<Throttle<Context>>(n);
+            return DecoratorBuilder<Builder, Context>(this, (Throttle<Context>*)root.get());
+        }
+
+        // CacheFor
+        DecoratorBuilder<Builder, Context> cache_for(const int duration_ms)
+        {
+            root = std::make_shared<CacheFor<Context>>(duration_ms);
+            return DecoratorBuilder<Builder, Context>(this, (CacheFor<Context>*)root.get());
+        }
+
+        // UntilChanged
+        DecoratorBuilder<Builder, Context> until_changed(const EventType type)
+        {
+            root = std::make_shared<UntilChanged<Context>>(type);
+            return DecoratorBuilder<Builder, Context>(this, (UntilChanged<Context>*)root.get());
+        }
+
         // To add any other type of decorator
         template <class DecoratorType, class... Args>
         DecoratorBuilder<Builder, Context> decorator(Args... args)
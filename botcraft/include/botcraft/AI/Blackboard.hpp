@@ -1,12 +1,22 @@
 #pragma once
 
-#include <map>
+#include <algorithm>
 #include <any>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
 
 namespace Botcraft
-{    
-    /// @brief A map wrapper to store arbitrary data
+{
+    template<class T>
+    class BlackboardKey;
+
+    /// @brief A map wrapper to store arbitrary data. Key names are
+    /// interned to slot indices shared by all the blackboards, and
+    /// values are stored typed in these slots. Hot code can use a
+    /// BlackboardKey to skip the name lookup, both access the same values.
     class Blackboard
     {
     public:
@@ -21,9 +31,16 @@ namespace Botcraft
         template<class T>
         const T& Get(const std::string& key)
         {
-            return std::any_cast<T&>(blackboard[key]);
+            return GetSlotValue<T>(Intern(key));
+        }
+
+        /// @brief Same as Get, using an interned key
+        template<class T>
+        const T& Get(const BlackboardKey<T>& key)
+        {
+            return GetSlotValue<T>(key.GetIndex());
         }
-        
+
         /// @brief Get the map value at key, casting it to T.
         /// If the key is not present in the map, add
         /// it with default_value, and returns it.
@@ -34,12 +51,14 @@ namespace Botcraft
         template<class T>
         const T& Get(const std::string& key, const T& default_value)
         {
-            auto it = blackboard.find(key);
-            if (it == blackboard.end())
-            {
-                it = blackboard.insert(std::pair<std::string, std::any>(key, default_value)).first;
-            }
-            return std::any_cast<T&>(it->second);
+            return GetOrCreateSlotValue<T>(Intern(key), default_value);
+        }
+
+        /// @brief Same as Get with a default value, using an interned key
+        template<class T>
+        const T& Get(const BlackboardKey<T>& key, const typename BlackboardKey<T>::value_type& default_value)
+        {
+            return GetOrCreateSlotValue<T>(key.GetIndex(), default_value);
         }
 
         /// @brief Get a ref to the map value at key, casting it to T&.
@@ -52,12 +71,14 @@ namespace Botcraft
         template<class T>
         T& GetRef(const std::string& key, const T& default_value)
         {
-            auto it = blackboard.find(key);
-            if (it == blackboard.end())
-            {
-                it = blackboard.insert(std::pair<std::string, std::any>(key, default_value)).first;
-            }
-            return std::any_cast<T&>(it->second);
+            return GetOrCreateSlotValue<T>(Intern(key), default_value);
+        }
+
+        /// @brief Same as GetRef, using an interned key
+        template<class T>
+        T& GetRef(const BlackboardKey<T>& key, const typename BlackboardKey<T>::value_type& default_value)
+        {
+            return GetOrCreateSlotValue<T>(key.GetIndex(), default_value);
         }
 
         /// @brief Set map entry at key to value
@@ -67,7 +88,15 @@ namespace Botcraft
         template<class T>
         void Set(const std::string& key, const T& value)
         {
-            blackboard[key] = value;
+            SetSlotValue<std::decay_t<const T&> >(Intern(key), value);
+        }
+
+        /// @brief Same as Set, using an interned key. If a value of the
+        /// same type is already stored, it's assigned in place
+        template<class T>
+        void Set(const BlackboardKey<T>& key, const typename BlackboardKey<T>::value_type& value)
+        {
+            SetSlotValue<T>(key.GetIndex(), value);
         }
 
         /// @brief Copy a blackboard value
@@ -75,23 +104,137 @@ namespace Botcraft
         /// @param dst Destination key
         void Copy(const std::string& src, const std::string& dst)
         {
-            blackboard[dst] = blackboard[src];
+            const size_t src_index = Intern(src);
+            const size_t dst_index = Intern(dst);
+            if (src_index == dst_index)
+            {
+                return;
+            }
+            Reserve(std::max(src_index, dst_index));
+            slots[dst_index] = slots[src_index] == nullptr ? nullptr : slots[src_index]->Clone();
         }
 
         /// @brief Remove a map entry if present
         /// @param key key we want to remove
         void Erase(const std::string& key)
         {
-            blackboard.erase(key);
+            const size_t index = Intern(key);
+            if (index < slots.size())
+            {
+                slots[index] = nullptr;
+            }
+        }
+
+        /// @brief Same as Erase, using an interned key
+        template<class T>
+        void Erase(const BlackboardKey<T>& key)
+        {
+            if (key.GetIndex() < slots.size())
+            {
+                slots[key.GetIndex()] = nullptr;
+            }
         }
-        
+
         /// @brief Clear all the entries in the blackboard
         void Clear()
         {
-            blackboard.clear();
+            slots.clear();
+        }
+
+        /// @brief Get the slot index of a key name, registering it if it's
+        /// the first time it's used. Indices are shared by all the blackboards
+        /// @param key Name of the key
+        /// @return The slot index
+        static const size_t Intern(const std::string& key);
+
+    private:
+        struct SlotBase
+        {
+            SlotBase(const std::type_info& type_) : type(type_) {}
+            virtual ~SlotBase() {}
+            virtual std::unique_ptr<SlotBase> Clone() const = 0;
+
+            const std::type_info& type;
+        };
+
+        template<class T>
+        struct Slot : public SlotBase
+        {
+            Slot(const T& value_) : SlotBase(typeid(T)), value(value_) {}
+            virtual std::unique_ptr<SlotBase> Clone() const override
+            {
+                return std::make_unique<Slot<T> >(value);
+            }
+
+            T value;
+        };
+
+        void Reserve(const size_t index)
+        {
+            if (index >= slots.size())
+            {
+                slots.resize(index + 1);
+            }
+        }
+
+        template<class T>
+        T& GetSlotValue(const size_t index)
+        {
+            if (index >= slots.size() || slots[index] == nullptr || slots[index]->type != typeid(T))
+            {
+                throw std::bad_any_cast();
+            }
+            return static_cast<Slot<T>*>(slots[index].get())->value;
+        }
+
+        template<class T>
+        T& GetOrCreateSlotValue(const size_t index, const T& default_value)
+        {
+            Reserve(index);
+            if (slots[index] == nullptr)
+            {
+                slots[index] = std::make_unique<Slot<T> >(default_value);
+            }
+            return GetSlotValue<T>(index);
+        }
+
+        template<class T>
+        void SetSlotValue(const size_t index, const T& value)
+        {
+            Reserve(index);
+            if (slots[index] != nullptr && slots[index]->type == typeid(T))
+            {
+                static_cast<Slot<T>*>(slots[index].get())->value = value;
+            }
+            else
+            {
+                slots[index] = std::make_unique<Slot<T> >(value);
+            }
+        }
+
+    private:
+        // Interned key index --> value, nullptr if not set
+        std::vector<std::unique_ptr<SlotBase> > slots;
+    };
+
+    /// @brief A typed handle on a blackboard entry. The name is interned
+    /// once at construction, so it's meant to be stored (e.g. as a static
+    /// variable) and reused, not created for each access
+    /// @tparam T Type of the value stored at this key
+    template<class T>
+    class BlackboardKey
+    {
+    public:
+        using value_type = T;
+
+        explicit BlackboardKey(const std::string& name) : index(Blackboard::Intern(name)) {}
+
+        const size_t GetIndex() const
+        {
+            return index;
         }
 
     private:
-        std::map<std::string, std::any> blackboard;
+        size_t index;
     };
 } // namespace Botcraft
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class World;
+    struct PathSearchJob;
+
+    /// @brief Handle on a path search running in the background. The
+    /// search is cancelled when all the handles waiting for it are
+    /// cancelled or destroyed before it's done
+    class PathSearchHandle
+    {
+    public:
+        PathSearchHandle();
+        ~PathSearchHandle();
+
+        PathSearchHandle(const PathSearchHandle&) = delete;
+        PathSearchHandle& operator=(const PathSearchHandle&) = delete;
+        PathSearchHandle(PathSearchHandle&& other);
+        PathSearchHandle& operator=(PathSearchHandle&& other);
+
+        /// @brief Check if this handle is attached to a search
+        const bool IsValid() const;
+
+        /// @brief Check if the search is over, without blocking
+        const bool IsDone() const;
+
+        /// @brief Get the path found, only valid once IsDone returns true
+        /// @return The positions of the path, without start
+        const std::vector<Position>& GetPath() const;
+
+        /// @brief Stop waiting for the search, and stop it if nobody else waits for it
+        void Cancel();
+
+    private:
+        friend class PathSearchPool;
+
+        PathSearchHandle(const std::shared_ptr<PathSearchJob>& job_);
+
+    private:
+        std::shared_ptr<PathSearchJob> job;
+    };
+
+    /// @brief A process-wide pool of threads running path searches, so
+    /// behaviours can keep running (and be interrupted) while a path is
+    /// computed. Identical searches (same world, start, end and
+    /// parameters) submitted while one is still running are shared.
+    class PathSearchPool
+    {
+    public:
+        static PathSearchPool& GetInstance();
+
+        PathSearchPool(const PathSearchPool&) = delete;
+        PathSearchPool& operator=(const PathSearchPool&) = delete;
+        PathSearchPool(PathSearchPool&&) = delete;
+        PathSearchPool& operator=(PathSearchPool&&) = delete;
+        ~PathSearchPool();
+
+        /// @brief Set the number of threads running the searches. Only
+        /// applied when no search is running
+        /// @param n Number of worker threads, 0 to run the searches synchronously in Submit
+        void SetNumWorkers(const unsigned int n);
+        const unsigned int GetNumWorkers() const;
+
+        /// @brief Start a path search in the background. Worker threads are started with the first search
+        /// @param world The world to search in
+        /// @param start Starting position
+        /// @param end Goal position
+        /// @param min_end_dist Desired minimal distance between the final position and end
+        /// @param allow_jump If true, allow to jump above 1-wide gaps
+        /// @param hierarchical If true, use FindHierarchicalPath instead of FindPath
+        /// @param time_budget_ms If > 0, max duration of the search, the best path found so far is returned after that
+        /// @return A handle to poll the search
+        PathSearchHandle Submit(const std::shared_ptr<World>& world, const Position& start, const Position& end,
+            const int min_end_dist, const bool allow_jump, const bool hierarchical = false, const int time_budget_ms = 0);
+
+    private:
+        friend class PathSearchHandle;
+
+        PathSearchPool();
+
+        void Start();
+        void Stop();
+
+        /// @brief Wait for jobs and run them
+        void RunWorker();
+
+        /// @brief Remove a waiter from a job
+        void Release(PathSearchJob& job);
+
+        static void Run(PathSearchJob& job);
+
+    private:
+        mutable std::mutex pool_mutex;
+        std::condition_variable pool_condition;
+        unsigned int num_workers;
+        bool running;
+
+        std::deque<std::shared_ptr<PathSearchJob> > queue;
+        // Queued and running jobs, to share identical searches
+        std::vector<std::shared_ptr<PathSearchJob> > in_flight;
+
+        std::vector<std::thread> worker_threads;
+    };
+} // Botcraft
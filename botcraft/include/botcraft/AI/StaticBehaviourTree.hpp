@@ -0,0 +1,266 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "botcraft/AI/BehaviourTree.hpp"
+
+// Compile-time alternative to the runtime nodes of BehaviourTree.hpp.
+// Each node stores its children by value in its own type (e.g.
+// Sequence<Leaf<F1>, Inverter<Leaf<F2> > >), so ticking the tree is a
+// chain of direct calls the compiler can inline instead of virtual and
+// std::function calls on shared_ptr linked nodes. The tree shape is fixed
+// at compile time, use the runtime Builder for trees built dynamically.
+//
+// Usage:
+// auto root = Static::sequence(
+//     Static::leaf(Say, "Hello"),
+//     Static::inverter(Static::leaf(IsHungry)),
+//     Static::selector(Static::leaf(Dig, pos, true), Static::leaf(Say, "Can't dig"))
+// );
+// std::shared_ptr<BehaviourTree<MyClient> > tree = Static::build<MyClient>(root);
+//
+// A static tree can also be used as a leaf of a runtime tree with
+// Builder<MyClient>().sequence().leaf(root).end().build()
+
+namespace Botcraft
+{
+    namespace Static
+    {
+        /// @brief A leaf calling func with the context
+        /// @tparam FunctionType Any callable with a Status(Context&) signature
+        template<class FunctionType>
+        class Leaf
+        {
+        public:
+            Leaf(const FunctionType& func_) : func(func_) {}
+
+            template<class Context>
+            const Status Tick(Context& context) const
+            {
+                return func(context);
+            }
+
+            template<class Context>
+            const Status operator()(Context& context) const
+            {
+                return Tick(context);
+            }
+
+        private:
+            FunctionType func;
+        };
+
+        /// @brief Sequence implementation. Run all children until
+        /// one fails. Succeeds if all children succeed.
+        /// Equivalent to a logical AND.
+        /// @tparam Children The children node types
+        template<class... Children>
+        class Sequence
+        {
+        public:
+            Sequence(const Children&... children_) : children(children_...) {}
+
+            template<class Context>
+            const Status Tick(Context& context) const
+            {
+                return TickChildren(context, std::index_sequence_for<Children...>());
+            }
+
+            template<class Context>
+            const Status operator()(Context& context) const
+            {
+                return Tick(context);
+            }
+
+        private:
+            template<class Context, size_t... I>
+            const Status TickChildren(Context& context, std::index_sequence<I...>) const
+            {
+                // && fold stops at the first failure
+                return ((std::get<I>(children).Tick(context) == Status::Success) && ...) ? Status::Success : Status::Failure;
+            }
+
+        private:
+            std::tuple<Children...> children;
+        };
+
+        /// @brief Selector implementation. Run all children until
+        /// one succeeds. Fails if all children fail.
+        /// Equivalent to a logical OR.
+        /// @tparam Children The children node types
+        template<class... Children>
+        class Selector
+        {
+        public:
+            Selector(const Children&... children_) : children(children_...) {}
+
+            template<class Context>
+            const Status Tick(Context& context) const
+            {
+                return TickChildren(context, std::index_sequence_for<Children...>());
+            }
+
+            template<class Context>
+            const Status operator()(Context& context) const
+            {
+                return Tick(context);
+            }
+
+        private:
+            template<class Context, size_t... I>
+            const Status TickChildren(Context& context, std::index_sequence<I...>) const
+            {
+                // || fold stops at the first success
+                return ((std::get<I>(children).Tick(context) == Status::Success) || ...) ? Status::Success : Status::Failure;
+            }
+
+        private:
+            std::tuple<Children...> children;
+        };
+
+        /// @brief A Decorator that inverts the result of its child.
+        /// @tparam Child The child node type
+        template<class Child>
+        class Inverter
+        {
+        public:
+            Inverter(const Child& child_) : child(child_) {}
+
+            template<class Context>
+            const Status Tick(Context& context) const
+            {
+                return child.Tick(context) == Status::Success ? Status::Failure : Status::Success;
+            }
+
+            template<class Context>
+            const Status operator()(Context& context) const
+            {
+                return Tick(context);
+            }
+
+        private:
+            Child child;
+        };
+
+        /// @brief A Decorator that always return success,
+        /// independently of the result of its child.
+        /// @tparam Child The child node type
+        template<class Child>
+        class Succeeder
+        {
+        public:
+            Succeeder(const Child& child_) : child(child_) {}
+
+            template<class Context>
+            const Status Tick(Context& context) const
+            {
+                child.Tick(context);
+                return Status::Success;
+            }
+
+            template<class Context>
+            const Status operator()(Context& context) const
+            {
+                return Tick(context);
+            }
+
+        private:
+            Child child;
+        };
+
+        /// @brief A Decorator that ticks its child n times
+        /// (repeat until first success if n == 0).
+        /// Always returns success.
+        /// @tparam Child The child node type
+        template<class Child>
+        class Repeater
+        {
+        public:
+            Repeater(const Child& child_, const size_t n_) : child(child_), n(n_) {}
+
+            template<class Context>
+            const Status Tick(Context& context) const
+            {
+                Status child_status = Status::Failure;
+                size_t counter = 0;
+                while ((child_status == Status::Failure && n == 0) || counter < n)
+                {
+                    child_status = child.Tick(context);
+                    counter += 1;
+                }
+                return Status::Success;
+            }
+
+            template<class Context>
+            const Status operator()(Context& context) const
+            {
+                return Tick(context);
+            }
+
+        private:
+            Child child;
+            size_t n;
+        };
+
+        // Builder functions, deducing the node types from the arguments
+
+        /// @brief Create a leaf from a Status(Context&) callable
+        template<class FunctionType>
+        Leaf<std::decay_t<FunctionType> > leaf(FunctionType&& func)
+        {
+            return Leaf<std::decay_t<FunctionType> >(std::forward<FunctionType>(func));
+        }
+
+        /// @brief Create a leaf calling func(context, args...), args are stored by value
+        template<class FunctionType, class Arg, class... Args>
+        auto leaf(FunctionType func, Arg arg, Args... args)
+        {
+            return leaf([=](auto& c) -> Status { return func(c, arg, (args)...); });
+        }
+
+        template<class... Children>
+        Sequence<Children...> sequence(const Children&... children)
+        {
+            return Sequence<Children...>(children...);
+        }
+
+        template<class... Children>
+        Selector<Children...> selector(const Children&... children)
+        {
+            return Selector<Children...>(children...);
+        }
+
+        template<class Child>
+        Inverter<Child> inverter(const Child& child)
+        {
+            return Inverter<Child>(child);
+        }
+
+        template<class Child>
+        Succeeder<Child> succeeder(const Child& child)
+        {
+            return Succeeder<Child>(child);
+        }
+
+        template<class Child>
+        Repeater<Child> repeater(const size_t n, const Child& child)
+        {
+            return Repeater<Child>(child, n);
+        }
+
+        /// @brief Wrap a static tree in a runtime BehaviourTree, so it can be
+        /// used anywhere a runtime tree is expected. Only the root call is
+        /// type-erased, the static tree itself is still inlined
+        /// @tparam Context The tree context type
+        /// @param root Root node of the static tree
+        /// @return A runtime tree ticking root
+        template<class Context, class Root>
+        std::shared_ptr<BehaviourTree<Context> > build(const Root& root)
+        {
+            return Builder<Context>().leaf(std::function<Status(Context&)>(root)).build();
+        }
+    } // namespace Static
+} // namespace Botcraft
@@ -0,0 +1,475 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "botcraft/AI/BehaviourScheduler.hpp"
+#include "botcraft/AI/BehaviourTree.hpp"
+#include "botcraft/AI/Tasks/PathfindingTask.hpp"
+#include "botcraft/Game/AssetsManager.hpp"
+#include "botcraft/Game/ClientMetrics.hpp"
+#include "botcraft/Game/Entities/EntityManager.hpp"
+#include "botcraft/Game/Physics/PhysicsScheduler.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Network/ControlServer.hpp"
+#include "botcraft/Network/MetricsServer.hpp"
+#include "botcraft/Network/NetworkManager.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+
+namespace Botcraft
+{
+    struct SwarmConfig
+    {
+        /// @brief Number of network IO threads, 0 for one per hardware core
+        unsigned int num_io_threads = 0;
+        /// @brief Number of physics threads, must be > 0
+        unsigned int num_physics_workers = 1;
+        /// @brief Number of behaviour threads, 0 to keep BehaviourScheduler default
+        unsigned int num_behaviour_workers = 0;
+        /// @brief If true, packets are processed by the IO threads,
+        /// instead of one processing thread per bot
+        bool process_packets_on_io_threads = true;
+        /// @brief If true, all the bots connected to the same server share one World
+        bool share_worlds = true;
+        /// @brief If true, all the bots connected to the same server store their entities in one shared EntityManager
+        bool share_entities = true;
+        /// @brief Number of chunk decoding threads of each shared World
+        unsigned int num_chunk_decode_threads = 0;
+        /// @brief If true, the bots sharing a World reserve the cells of their
+        /// paths in GoTo, see EnablePathReservations. Requires share_worlds
+        bool reserve_paths = false;
+        /// @brief Cpus of each affinity group (see AffinityGroups), e.g. GetNumaNodesCpus()
+        /// for one group per NUMA node. Bots are spread over the groups, and the network,
+        /// physics and behaviour work of each bot stays on the cores of its group, with
+        /// one shared World per group and server. Empty (default) for no affinity
+        std::vector<std::vector<int> > affinity_groups;
+    };
+
+    /// @brief Load of one affinity group of a Swarm, see Swarm::GetGroupReport
+    struct SwarmGroupReport
+    {
+        /// @brief Index of the group, -1 for all the bots if there is no group
+        int group = -1;
+        /// @brief Cpus of the group, empty if there is no group
+        std::vector<int> cpus;
+        size_t num_bots = 0;
+        /// @brief Number of bots with a name, i.e. connected
+        size_t num_connected = 0;
+        unsigned long long packets_in = 0;
+        unsigned long long bytes_in = 0;
+        unsigned long long packets_out = 0;
+        unsigned long long bytes_out = 0;
+        /// @brief Received packets per second since the previous report
+        double packets_in_per_s = 0.0;
+        /// @brief Received bytes per second since the previous report
+        double bytes_in_per_s = 0.0;
+    };
+
+    /// @brief Run a lot of bots in the same process with shared services.
+    /// While the swarm is alive, network IO, packet processing, physics and
+    /// behaviours of its bots all run on the few threads of the process-wide
+    /// pools (IOContextPool, PhysicsScheduler, BehaviourScheduler), and bots
+    /// connected to the same server share the same World and entities. Assets, logger and
+    /// authentication cache are process-wide already. A bot is then mostly
+    /// its managers state, without any dedicated thread.
+    /// Bots sharing a World are expected to stay in the same dimension.
+    /// Only one Swarm should exist at a time, as it configures process-wide services.
+    /// With affinity groups, each bot is assigned to the group with the less
+    /// bots, and its connection, physics and behaviour are routed to the
+    /// workers pinned to this group cores.
+    /// @tparam TClient Bot type, derived from TemplatedBehaviourClient
+    template<class TClient>
+    class Swarm
+    {
+    public:
+        Swarm(const SwarmConfig& config_ = SwarmConfig()) : config(config_)
+        {
+            // Make sure the assets are loaded once before creating the bots
+            AssetsManager::getInstance();
+
+            // Before starting the pools, so their threads are split between the groups
+            if (!config.affinity_groups.empty())
+            {
+                AffinityGroups::GetInstance().SetGroups(config.affinity_groups);
+            }
+
+            NetworkManager::StartSharedIOPool(config.num_io_threads);
+            NetworkManager::SetProcessPacketsOnIOThreads(config.process_packets_on_io_threads);
+            PhysicsScheduler::GetInstance().SetNumWorkers(std::max(1u, config.num_physics_workers));
+            if (config.num_behaviour_workers > 0)
+            {
+                BehaviourScheduler::GetInstance().SetNumWorkers(config.num_behaviour_workers);
+            }
+        }
+
+        ~Swarm()
+        {
+            Stop();
+        }
+
+        /// @brief Authenticate Microsoft accounts before adding the bots, see NetworkManager::PreAuthenticateMicrosoft
+        /// @param logins Microsoft logins of the bots
+        /// @return The number of successfully authenticated accounts
+        size_t PreAuthenticate(const std::vector<std::string>& logins) const
+        {
+            return NetworkManager::PreAuthenticateMicrosoft(logins);
+        }
+
+        /// @brief Create a bot and connect it to a server
+        /// @param address Server address
+        /// @param login Bot login (Microsoft login or offline name)
+        /// @param password Mojang password, empty for Microsoft or offline accounts
+        /// @param force_microsoft_account Use Microsoft auth even if login is not empty
+        /// @param tree If not null, the tree is set and the behaviour started on the scheduler
+        /// @return The new bot
+        std::shared_ptr<TClient> AddBot(const std::string& address, const std::string& login, const std::string& password = "",
+            const bool force_microsoft_account = false, const std::shared_ptr<BehaviourTree<TClient> >& tree = nullptr)
+        {
+            const int group = PickGroup();
+            // Route the connection, physics and behaviour of this bot to the group workers
+            AffinityGroupScope scope(group);
+
+            std::shared_ptr<TClient> bot = std::make_shared<TClient>(false);
+            if (config.share_worlds)
+            {
+                bot->SetSharedWorld(GetWorld(address, group));
+            }
+            if (config.share_entities)
+            {
+                bot->SetSharedEntityManager(GetSharedEntityManager(address));
+            }
+            bot->Connect(address, login, password, force_microsoft_account);
+
+            if (tree)
+            {
+                bot->SetBehaviourTree(tree);
+                bot->StartBehaviourOnScheduler();
+            }
+
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            bots.push_back(bot);
+            started[bot.get()] = tree != nullptr;
+            groups[bot.get()] = group;
+            return bot;
+        }
+
+        /// @brief Set the same tree to all the bots, and start the behaviour of those not started yet
+        /// @param tree The tree to use
+        void StartBehaviours(const std::shared_ptr<BehaviourTree<TClient> >& tree)
+        {
+            for (const std::shared_ptr<TClient>& bot : GetBots())
+            {
+                StartBehaviour(bot, tree);
+            }
+        }
+
+        /// @brief Get the World shared by the bots connected to a given server, created if needed
+        /// @param address Server address
+        /// @param group Affinity group of the bots, each group has its own World. Ignored if there is no group
+        /// @return The shared World
+        std::shared_ptr<World> GetWorld(const std::string& address, const int group = 0)
+        {
+            const int world_group = config.affinity_groups.empty() ? -1 : group;
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            std::shared_ptr<World>& world = worlds[{ address, world_group }];
+            if (world == nullptr)
+            {
+                // Decoding threads are pinned to the group
+                AffinityGroupScope scope(world_group);
+                world = std::make_shared<World>(true, false, config.num_chunk_decode_threads);
+                if (config.reserve_paths)
+                {
+                    EnablePathReservations(world);
+                }
+            }
+            return world;
+        }
+
+        /// @brief Get the EntityManager storing the entities of the bots connected to a given server, created if needed
+        /// @param address Server address
+        /// @return The shared EntityManager
+        std::shared_ptr<EntityManager> GetSharedEntityManager(const std::string& address)
+        {
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            std::shared_ptr<EntityManager>& entity_manager = entity_managers[address];
+            if (entity_manager == nullptr)
+            {
+                entity_manager = std::make_shared<EntityManager>();
+            }
+            return entity_manager;
+        }
+
+        /// @brief Get a copy of the bot list
+        std::vector<std::shared_ptr<TClient> > GetBots() const
+        {
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            return bots;
+        }
+
+        /// @brief Get the resources used by all the bots
+        std::vector<ClientMetrics> GetMetrics() const
+        {
+            std::vector<ClientMetrics> output;
+            for (const std::shared_ptr<TClient>& bot : GetBots())
+            {
+                output.push_back(bot->GetMetrics());
+            }
+            return output;
+        }
+
+        /// @brief Get the number of bots and the network throughput of each affinity group.
+        /// Rates are computed since the previous call
+        /// @return One report per group, or one for all the bots if there is no group
+        std::vector<SwarmGroupReport> GetGroupReport()
+        {
+            std::vector<std::pair<std::shared_ptr<TClient>, int> > bots_groups;
+            {
+                std::lock_guard<std::mutex> lock(swarm_mutex);
+                for (const std::shared_ptr<TClient>& bot : bots)
+                {
+                    bots_groups.push_back({ bot, groups[bot.get()] });
+                }
+            }
+
+            std::vector<SwarmGroupReport> output(std::max<size_t>(1, config.affinity_groups.size()));
+            for (size_t i = 0; i < config.affinity_groups.size(); ++i)
+            {
+                output[i].group = static_cast<int>(i);
+                output[i].cpus = config.affinity_groups[i];
+            }
+            for (const auto& b : bots_groups)
+            {
+                const ClientMetrics metrics = b.first->GetMetrics();
+                SwarmGroupReport& report = output[std::max(0, b.second)];
+                report.num_bots += 1;
+                report.num_connected += metrics.name.empty() ? 0 : 1;
+                report.packets_in += metrics.network.packets_in;
+                report.bytes_in += metrics.network.bytes_in;
+                report.packets_out += metrics.network.packets_out;
+                report.bytes_out += metrics.network.bytes_out;
+            }
+
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            const double elapsed_s = std::chrono::duration<double>(now - last_report_time).count();
+            if (last_report.size() == output.size() && elapsed_s > 0.0)
+            {
+                for (size_t i = 0; i < output.size(); ++i)
+                {
+                    // Counters of removed bots are gone, don't report negative rates
+                    output[i].packets_in_per_s = output[i].packets_in > last_report[i].packets_in ? (output[i].packets_in - last_report[i].packets_in) / elapsed_s : 0.0;
+                    output[i].bytes_in_per_s = output[i].bytes_in > last_report[i].bytes_in ? (output[i].bytes_in - last_report[i].bytes_in) / elapsed_s : 0.0;
+                }
+            }
+            last_report = output;
+            last_report_time = now;
+            return output;
+        }
+
+        /// @brief Serve the metrics of all the bots in Prometheus text format
+        /// @param port TCP port to listen on
+        /// @param address Address to listen on
+        void StartMetricsServer(const unsigned short port, const std::string& address = "0.0.0.0")
+        {
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            metrics_server = std::make_unique<MetricsServer>(port, [this]() { return MetricsToPrometheus(GetMetrics()); }, address);
+        }
+
+        /// @brief Start a ControlServer to drive the bots from another program
+        /// @param port TCP port to listen on
+        /// @param trees Trees that can be set by name with SetTree requests. Bots with
+        /// no behaviour started yet are started with their new tree
+        /// @param address Address to listen on
+        void StartControlServer(const unsigned short port, const std::map<std::string, std::shared_ptr<BehaviourTree<TClient> > >& trees = {}, const std::string& address = "127.0.0.1")
+        {
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            control_server = std::make_unique<ControlServer>(port,
+                [this]()
+                {
+                    const std::vector<std::shared_ptr<TClient> > swarm_bots = GetBots();
+                    return std::vector<std::shared_ptr<BehaviourClient> >(swarm_bots.begin(), swarm_bots.end());
+                },
+                [this, trees](BehaviourClient& client, const std::string& tree_name)
+                {
+                    auto it = trees.find(tree_name);
+                    if (it == trees.end())
+                    {
+                        return false;
+                    }
+                    for (const std::shared_ptr<TClient>& bot : GetBots())
+                    {
+                        if (bot.get() == &client)
+                        {
+                            StartBehaviour(bot, it->second);
+                            break;
+                        }
+                    }
+                    return true;
+                }, address);
+        }
+
+        /// @brief Destroy all the bots that have been disconnected
+        /// @return The number of removed bots
+        size_t RemoveClosedBots()
+        {
+            std::vector<std::shared_ptr<TClient> > removed;
+            {
+                std::lock_guard<std::mutex> lock(swarm_mutex);
+                for (auto it = bots.begin(); it != bots.end();)
+                {
+                    if ((*it)->GetShouldBeClosed())
+                    {
+                        started.erase(it->get());
+                        groups.erase(it->get());
+                        removed.push_back(*it);
+                        it = bots.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+            // Bots are destroyed here, without holding the lock
+            return removed.size();
+        }
+
+        /// @brief Connect again all the bots that have been disconnected (kicked or
+        /// connection lost) instead of destroying them, see ManagersClient::Reconnect
+        /// @return The number of reconnected bots
+        size_t ReconnectClosedBots()
+        {
+            size_t num_reconnected = 0;
+            for (const std::shared_ptr<TClient>& bot : GetBots())
+            {
+                if (!bot->GetShouldBeClosed())
+                {
+                    continue;
+                }
+                int group = -1;
+                {
+                    std::lock_guard<std::mutex> lock(swarm_mutex);
+                    group = groups[bot.get()];
+                }
+                AffinityGroupScope scope(group);
+                try
+                {
+                    bot->Reconnect();
+                    num_reconnected += 1;
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_WARNING("Can't reconnect bot: " << e.what());
+                }
+            }
+            return num_reconnected;
+        }
+
+        /// @brief Disconnect and destroy all the bots, then stop the shared IO threads
+        void Stop()
+        {
+            std::unique_ptr<MetricsServer> server;
+            std::unique_ptr<ControlServer> control;
+            {
+                std::lock_guard<std::mutex> lock(swarm_mutex);
+                server.swap(metrics_server);
+                control.swap(control_server);
+            }
+            // Destroyed without the lock as they could be serving a request
+            server.reset();
+            control.reset();
+
+            std::vector<std::shared_ptr<TClient> > to_destroy;
+            {
+                std::lock_guard<std::mutex> lock(swarm_mutex);
+                to_destroy.swap(bots);
+                started.clear();
+                groups.clear();
+            }
+            to_destroy.clear();
+
+            {
+                std::lock_guard<std::mutex> lock(swarm_mutex);
+                if (config.reserve_paths)
+                {
+                    for (const auto& w : worlds)
+                    {
+                        DisablePathReservations(w.second);
+                    }
+                }
+                worlds.clear();
+                entity_managers.clear();
+            }
+
+            NetworkManager::SetProcessPacketsOnIOThreads(false);
+            NetworkManager::StopSharedIOPool();
+            if (!config.affinity_groups.empty())
+            {
+                AffinityGroups::GetInstance().SetGroups({});
+            }
+        }
+
+    private:
+        /// @brief Set the tree of a bot, and start its behaviour if not started yet
+        void StartBehaviour(const std::shared_ptr<TClient>& bot, const std::shared_ptr<BehaviourTree<TClient> >& tree)
+        {
+            bot->SetBehaviourTree(tree);
+            bool already_started = false;
+            int group = -1;
+            {
+                std::lock_guard<std::mutex> lock(swarm_mutex);
+                already_started = started[bot.get()];
+                started[bot.get()] = true;
+                group = groups[bot.get()];
+            }
+            if (!already_started)
+            {
+                AffinityGroupScope scope(group);
+                bot->StartBehaviourOnScheduler();
+            }
+        }
+
+        /// @brief Get the affinity group with the less bots
+        /// @return The group index, -1 if there is no group
+        int PickGroup() const
+        {
+            if (config.affinity_groups.empty())
+            {
+                return -1;
+            }
+            std::vector<size_t> num_bots(config.affinity_groups.size(), 0);
+            std::lock_guard<std::mutex> lock(swarm_mutex);
+            for (const auto& g : groups)
+            {
+                if (g.second >= 0 && static_cast<size_t>(g.second) < num_bots.size())
+                {
+                    num_bots[g.second] += 1;
+                }
+            }
+            return static_cast<int>(std::min_element(num_bots.begin(), num_bots.end()) - num_bots.begin());
+        }
+
+    private:
+        SwarmConfig config;
+
+        mutable std::mutex swarm_mutex;
+        std::vector<std::shared_ptr<TClient> > bots;
+        std::map<TClient*, bool> started;
+        /// @brief Affinity group of each bot, -1 if there is no group
+        std::map<TClient*, int> groups;
+        /// @brief (address, affinity group) --> World
+        std::map<std::pair<std::string, int>, std::shared_ptr<World> > worlds;
+        std::map<std::string, std::shared_ptr<EntityManager> > entity_managers;
+        std::unique_ptr<MetricsServer> metrics_server;
+        std::unique_ptr<ControlServer> control_server;
+
+        std::vector<SwarmGroupReport> last_report;
+        std::chrono::steady_clock::time_point last_report_time;
+    };
+} // Botcraft
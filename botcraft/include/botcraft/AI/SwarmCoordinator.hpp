@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Botcraft
+{
+    class World;
+    class InventoryManager;
+
+    /// @brief Coordination between bot processes running on multiple machines,
+    /// with a small binary protocol over TCP. One process hosts the hub, all the
+    /// others connect to it, and messages published by one process are relayed to
+    /// all the others.
+    /// On top of the generic channels, a process can share:
+    /// - the chunks of its worlds (ShareWorld), so only one process per area
+    ///   needs a full view distance
+    /// - the known content of the containers (ShareContainers)
+    /// - the path reservations of its bots (SharePathReservations)
+    /// - exclusive claims on named resources, e.g. build tiles (Claim)
+    /// All the processes are expected to play on the same server. All
+    /// callbacks run on the coordinator network thread, they must not block
+    class SwarmCoordinator
+    {
+    public:
+        /// @brief Called with the key and data of a message published by another process
+        using Callback = std::function<void(const std::string& key, const std::vector<unsigned char>& data)>;
+
+        /// @brief Host the hub
+        /// @param port TCP port to listen on
+        /// @param address Address to listen on
+        SwarmCoordinator(const unsigned short port, const std::string& address = "0.0.0.0");
+        /// @brief Connect to a hub. Throws a std::runtime_error if the connection fails.
+        /// There is no automatic reconnection if the hub goes away
+        /// @param hub_address Address of the hub
+        /// @param port TCP port of the hub
+        SwarmCoordinator(const std::string& hub_address, const unsigned short port);
+        ~SwarmCoordinator();
+
+        SwarmCoordinator(const SwarmCoordinator&) = delete;
+        SwarmCoordinator& operator=(const SwarmCoordinator&) = delete;
+
+        const bool IsHub() const;
+        /// @brief Check if the connection with the hub is still alive, always true for the hub
+        const bool IsConnected() const;
+        /// @brief Get the id of this process, 0 for the hub, -1 if not known yet
+        const int GetNodeId() const;
+
+        /// @brief Send a message to all the other processes
+        /// @param channel Channel of the message
+        /// @param key Key of the message in the channel
+        /// @param data Content of the message
+        /// @param retain If true, the hub keeps the last data of each key and
+        /// sends it to the processes connecting later. Retained empty data remove the key
+        void Publish(const std::string& channel, const std::string& key, const std::vector<unsigned char>& data, const bool retain = true);
+
+        /// @brief Set the max size of the retained data kept by this process, 256 MiB by default.
+        /// Above it, the least recently published keys are dropped, and not sent to the
+        /// processes connecting later
+        /// @param bytes Max size, in bytes
+        void SetMaxRetainedMemory(const size_t bytes);
+
+        /// @brief Get the messages of a channel published by the other processes
+        /// @param channel The channel
+        /// @param callback Called for each message, including the retained ones sent when connecting
+        void Subscribe(const std::string& channel, const Callback& callback);
+
+        /// @brief Claim a resource for this process, exclusive across all the
+        /// processes. Claims are released with Release, or when the process
+        /// disconnects. Must not be called from a callback
+        /// @param key Name of the resource
+        /// @param timeout Max time to wait for the hub answer
+        /// @return True if this process owns the resource
+        const bool Claim(const std::string& key, const std::chrono::milliseconds& timeout = std::chrono::milliseconds(2000));
+        /// @brief Release a resource claimed by this process
+        void Release(const std::string& key);
+
+        /// @brief Publish the chunks of a world each time their blocks change,
+        /// and add the chunks published by the other processes to it if they're
+        /// not already loaded. The server data then replace them as usual
+        /// @param world The world to share
+        /// @param interval Time between two checks of the modified chunks
+        void ShareWorld(const std::shared_ptr<World>& world, const std::chrono::milliseconds& interval = std::chrono::milliseconds(1000));
+
+        /// @brief Publish the known content of the containers (see InventoryManager::GetKnownContainers),
+        /// and add the ones published by the other processes
+        /// @param inventory_manager The inventory manager to share
+        /// @param interval Time between two checks of the known containers
+        void ShareContainers(const std::shared_ptr<InventoryManager>& inventory_manager, const std::chrono::milliseconds& interval = std::chrono::milliseconds(1000));
+
+        /// @brief Publish the path reservations of the bots of a world, and add the ones of the
+        /// bots of the other processes. Reservations must be enabled on this world first (see
+        /// EnablePathReservations). Steps are sent relative to the current one, so the clocks of
+        /// the machines don't need to be synchronized, but they are shifted by the network latency
+        /// @param world The world shared by the bots
+        void SharePathReservations(const std::shared_ptr<World>& world);
+
+    private:
+        // Keeps asio out of this header
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
+} // Botcraft
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "botcraft/AI/BehaviourTree.hpp"
 #include "botcraft/AI/BehaviourClient.hpp"
 
@@ -20,4 +22,31 @@ namespace Botcraft
     /// @param c The client performing the action
     /// @return Success if the block is broken, Failure otherwise
     Status DigBlackboard(BehaviourClient& c);
+
+    /// @brief Dig several blocks in a row. The next block is started as soon as the previous
+    /// one is finished, without waiting for the server to confirm it's broken. Unconfirmed
+    /// blocks are dug again later. If too far from a block, will try to pathfind toward it
+    /// @param c The client performing the action
+    /// @param positions Locations of the blocks to dig, in digging order
+    /// @param send_swing If true, will send swing packets to show other players digging in progress
+    /// @param face Digging direction
+    /// @return Success if all the blocks are broken, Failure otherwise
+    Status DigMany(BehaviourClient& c, const std::vector<Position>& positions, const bool send_swing = false, const PlayerDiggingFace face = PlayerDiggingFace::Up);
+
+    /// @brief Same thing as DigMany, but reads its parameters from the blackboard
+    /// @param c The client performing the action
+    /// @return Success if all the blocks are broken, Failure otherwise
+    Status DigManyBlackboard(BehaviourClient& c);
+
+    /// @brief Select the hotbar slot with the item breaking a block the fastest.
+    /// Mining times are memoized, so it can be called before each Dig in a mining loop
+    /// @param c The client performing the action
+    /// @param pos Location of the block to dig
+    /// @return Success if the best item is selected, Failure otherwise
+    Status SetBestToolInHand(BehaviourClient& c, const Position& pos);
+
+    /// @brief Same thing as SetBestToolInHand, but reads its parameters from the blackboard
+    /// @param c The client performing the action
+    /// @return Success if the best item is selected, Failure otherwise
+    Status SetBestToolInHandBlackboard(BehaviourClient& c);
 }
\ No newline at end of file
@@ -16,6 +16,24 @@ namespace Botcraft
     /// @return Success if the slots is clicked (for versions < 1.17 and the server confirms it), Failure otherwise
     Status ClickSlotInContainer(BehaviourClient& client, const short container_id, const short slot_id, const int click_type, const char button_num);
 
+    /// @brief A click action in a container, same parameters as in ServerboundContainerClickPacket
+    struct ContainerClick
+    {
+        short slot_id;
+        int click_type;
+        char button_num;
+    };
+
+    /// @brief Perform several click actions on a container, without waiting
+    /// for the server to confirm each one before sending the next. Clicks are
+    /// applied to the inventory as soon as they are sent, and rolled back if
+    /// the server refuses them (versions < 1.17)
+    /// @param client The client performing the action
+    /// @param container_id Container id
+    /// @param clicks The clicks to perform, in order
+    /// @return Success if all the clicks are performed (for versions < 1.17 and the server confirms them), Failure otherwise
+    Status ClickSlotsInContainer(BehaviourClient& client, const short container_id, const std::vector<ContainerClick>& clicks);
+
     /// @brief Same thing as ClickSlotInContainer, but reads its parameters from the blackboard
     /// @param client The client performing the action
     /// @return Success if the slots is clicked (for versions < 1.17 and the server confirms it), Failure otherwise
@@ -162,6 +180,38 @@ namespace Botcraft
     /// @param client The client performing the action
     /// @return Success if the exchange went sucessfully, Failure otherwise
     Status TradeNameBlackboard(BehaviourClient& client);
+
+    /// @brief Choose a merchant to trade an item with, using the offers seen the last
+    /// times the bot traded with them. Merchants with the trade available are chosen
+    /// first, then the ones never seen or whose trade could have been restocked since.
+    /// Merchants with the trade locked and no possible restock, or not trading this
+    /// item, are skipped. Chosen at random between the merchants with the same rank
+    /// @param client The client performing the action
+    /// @param entity_ids Entity ids of the candidate merchants
+    /// @param item_id Id of the item to buy/sell
+    /// @param buy If true, the item is bought, otherwise is sold
+    /// @param blackboard_output Blackboard key where the chosen entity id is written
+    /// @return Success if a merchant is chosen, Failure if none of them can trade the item
+    Status SelectMerchant(BehaviourClient& client, const std::vector<int>& entity_ids, const int item_id, const bool buy, const std::string& blackboard_output = "InteractEntity.entity_id");
+
+    /// @brief Same thing as SelectMerchant, but reads its parameters from the blackboard
+    /// @param client The client performing the action
+    /// @return Success if a merchant is chosen, Failure if none of them can trade the item
+    Status SelectMerchantBlackboard(BehaviourClient& client);
+
+    /// @brief Choose a merchant to trade an item with, see SelectMerchant
+    /// @param client The client performing the action
+    /// @param entity_ids Entity ids of the candidate merchants
+    /// @param item_name Item to buy/sell
+    /// @param buy If true, the item is bought, otherwise is sold
+    /// @param blackboard_output Blackboard key where the chosen entity id is written
+    /// @return Success if a merchant is chosen, Failure if none of them can trade the item
+    Status SelectMerchantName(BehaviourClient& client, const std::vector<int>& entity_ids, const std::string& item_name, const bool buy, const std::string& blackboard_output = "InteractEntity.entity_id");
+
+    /// @brief Same thing as SelectMerchantName, but reads its parameters from the blackboard
+    /// @param client The client performing the action
+    /// @return Success if a merchant is chosen, Failure if none of them can trade the item
+    Status SelectMerchantNameBlackboard(BehaviourClient& client);
 #endif
 
     /// @brief Put item in a crafting container and click on the output, storing it in the inventory.
@@ -192,6 +242,23 @@ namespace Botcraft
     /// @return Success if item is crafted, Failure otherwise
     Status CraftNamedBlackboard(BehaviourClient& client);
 
+#if PROTOCOL_VERSION > 347
+    /// @brief Craft an item using the recipes sent by the server, crafting the
+    /// missing intermediate items first (e.g. planks and sticks for a pickaxe).
+    /// 3x3 recipes are only used if a crafting table is already open
+    /// @param client The client performing the action
+    /// @param item_name The item to craft
+    /// @param quantity Minimum number of items to get
+    /// @param allow_inventory_craft If true, the client will use the inventory small 2x2 grid to craft if possible
+    /// @return Success if the whole plan is crafted, Failure otherwise
+    Status CraftItem(BehaviourClient& client, const std::string& item_name, const int quantity = 1, const bool allow_inventory_craft = true);
+
+    /// @brief Same thing as CraftItem, but reads its parameters from the blackboard
+    /// @param client The client performing the action
+    /// @return Success if the whole plan is crafted, Failure otherwise
+    Status CraftItemBlackboard(BehaviourClient& client);
+#endif
+
     /// @brief Check if item_name is present in inventory
     /// @param client The client performing the action
     /// @param item_name Item name
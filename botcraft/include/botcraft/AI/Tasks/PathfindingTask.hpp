@@ -1,5 +1,11 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "botcraft/AI/BehaviourTree.hpp"
 #include "botcraft/AI/BehaviourClient.hpp"
 
@@ -7,6 +13,96 @@
 
 namespace Botcraft
 {
+    class World;
+
+    /// @brief Find a path between two positions with A*
+    /// @param world The world to search in, read from a snapshot so the world mutex is not locked
+    /// @param start Starting position
+    /// @param end Goal position
+    /// @param min_end_dist Desired minimal distance between the final position and end
+    /// @param allow_jump If true, allow to jump above 1-wide gaps
+    /// @param should_stop If not null, polled during the search, which is stopped when it returns true
+    /// @return The positions of the path, without start. If end can't be reached, a path to the closest position found
+    const std::vector<Position> FindPath(const std::shared_ptr<World>& world, const Position& start, const Position& end, const int min_end_dist, const bool allow_jump,
+        const std::function<bool()>& should_stop = nullptr);
+
+    /// @brief Find a path to the cheapest reachable position among several targets with a single A* search,
+    /// instead of one FindPath per target
+    /// @param world The world to search in, read from a snapshot so the world mutex is not locked
+    /// @param start Starting position
+    /// @param targets Candidate goal positions
+    /// @param max_visits Max number of nodes visited before giving up
+    /// @param allow_jump If true, allow to jump above 1-wide gaps
+    /// @param reached_target If not null, set to the index in targets of the reached target, -1 if none was reached
+    /// @return The positions of the path, without start. Empty if no target was reached or if start is one of them
+    const std::vector<Position> FindPathsToAny(const std::shared_ptr<World>& world, const Position& start, const std::vector<Position>& targets,
+        const int max_visits = 10000, const bool allow_jump = true, int* reached_target = nullptr);
+
+    /// @brief Hierarchical version of FindPath for long trips. A coarse path is first
+    /// searched on the graph of the 16x16x16 sections connected by walkable portals,
+    /// then refined with FindPath between successive portals.
+    const std::vector<Position> FindHierarchicalPath(const std::shared_ptr<World>& world, const Position& start, const Position& end, const int min_end_dist, const bool allow_jump,
+        const std::function<bool()>& should_stop = nullptr);
+
+    /// @brief Precompute the distances from some landmarks to all the positions reachable
+    /// around them, used by FindPath to bound the remaining distance to the goal with the
+    /// triangle inequality (ALT heuristic). Much fewer nodes are expanded around walls and
+    /// buildings, worth it when a lot of paths are searched in the same known area. Distances
+    /// are computed again when blocks change in the covered chunks, at most every 5 seconds
+    /// @param world The world to compute the distances in
+    /// @param landmarks Landmark positions (standing positions), a few spread on the border of the area work best. Empty to remove the landmarks
+    /// @param max_nodes Max number of positions reached from each landmark
+    void SetPathLandmarks(const std::shared_ptr<World>& world, const std::vector<Position>& landmarks, const int max_nodes = 100000);
+
+    /// @brief Stop using landmarks in FindPath for a world
+    void ClearPathLandmarks(const std::shared_ptr<World>& world);
+
+    /// @brief Compute a flow field toward a target: the distance to the target from all the
+    /// positions that can reach it, with a single reverse Dijkstra. GoTo calls to this target
+    /// (with min_end_dist = 0 and allow_jump) then follow the field instead of running their own
+    /// search, so any number of bots can converge on it for the cost of one search. When blocks
+    /// change in the covered chunks, the field is computed again on a background thread, and GoTo
+    /// falls back to a normal search in the meantime. Blocking, call it from your setup code
+    /// @param world The world to compute the field in
+    /// @param target The target position
+    /// @param max_nodes Max number of positions in the field
+    void EnableFlowField(const std::shared_ptr<World>& world, const Position& target, const int max_nodes = 200000);
+
+    /// @brief Remove the flow field of a target
+    void DisableFlowField(const std::shared_ptr<World>& world, const Position& target);
+
+    /// @brief Get a path to a target by following its flow field
+    /// @param world The world of the field
+    /// @param start Starting position
+    /// @param target Target of the field
+    /// @return The positions of the path, without start. Empty if there is no up to date field for target or if start can't reach it
+    const std::vector<Position> FollowFlowField(const std::shared_ptr<World>& world, const Position& start, const Position& target);
+
+    /// @brief Make the bots of a world that navigate with GoTo reserve the cells of their path in a
+    /// shared space-time table. Bots then wait in place instead of walking into a cell another bot
+    /// will be in at the same time, so they don't push each other off their path and replan
+    /// @param world The world shared by the bots
+    /// @param step_ms Duration of one time step, roughly the time to move one block
+    void EnablePathReservations(const std::shared_ptr<World>& world, const int step_ms = 250);
+
+    /// @brief Stop reserving paths in a world
+    void DisablePathReservations(const std::shared_ptr<World>& world);
+
+    /// @brief Get notified each time a bot of a world reserves or releases its path,
+    /// to share the reservations with other processes. Reservations must be enabled first
+    /// @param world The world shared by the bots
+    /// @param listener Called with the bot and its reserved cells as (position, steps from now),
+    /// empty when it's released. Called with the reservations locked, it must not call the
+    /// other reservation functions. nullptr to remove it
+    void SetPathReservationsListener(const std::shared_ptr<World>& world, const std::function<void(const void*, const std::vector<std::pair<Position, int> >&)>& listener);
+
+    /// @brief Add the reservations of a bot of another process, replacing its previous ones.
+    /// Cells already reserved by another bot are skipped
+    /// @param world The world shared by the bots
+    /// @param owner Unique name of the bot
+    /// @param cells (position, steps from now) of its path, empty to release them
+    void SetExternalPathReservations(const std::shared_ptr<World>& world, const std::string& owner, const std::vector<std::pair<Position, int> >& cells);
+
     /// @brief Find a path to a position and navigate to it.
     /// @param client The client performing the action
     /// @param goal The end goal
@@ -23,6 +119,24 @@ namespace Botcraft
     /// @return Success if goal is reached, Failure otherwise
     Status GoToBlackboard(BehaviourClient& client);
 
+    /// @brief Order a set of targets to visit them all in one short trip, with a nearest neighbour tour
+    /// improved by 2-opt. Distances are estimated without searching paths: manhattan distance, tightened
+    /// with the landmark lower bounds if landmarks are set for this world (see SetPathLandmarks)
+    /// @param world The world of the targets, can be null to only use manhattan distances
+    /// @param start Starting position
+    /// @param targets Positions to visit
+    /// @return Indices in targets, in visit order
+    const std::vector<size_t> OrderVisits(const std::shared_ptr<World>& world, const Position& start, const std::vector<Position>& targets);
+
+    /// @brief Go to all the targets in the order given by OrderVisits, and run an action at each of them
+    /// @param client The client performing the action
+    /// @param targets Positions to visit
+    /// @param action If not null, called when each target is reached. Stop the trip if it returns Failure
+    /// @param dist_tolerance, min_end_dist, speed, allow_jump GoTo parameters for each target
+    /// @return Success if all the targets were visited, Failure otherwise
+    Status VisitPositions(BehaviourClient& client, const std::vector<Position>& targets, const std::function<Status(BehaviourClient&, const Position&)>& action = nullptr,
+        const int dist_tolerance = 0, const int min_end_dist = 0, const float speed = 4.317f, const bool allow_jump = true);
+
     /// @brief Turn the camera to look at a given target, and wait at least one tick so the server register it
     /// @param client The client performing the action
     /// @param target The target to look at
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include "botcraft/AI/BehaviourClient.hpp"
+#include "botcraft/AI/BehaviourScheduler.hpp"
 #include "botcraft/AI/BehaviourTree.hpp"
+#include "botcraft/Game/Entities/EntityManager.hpp"
 #include "botcraft/Network/NetworkManager.hpp"
+#include "botcraft/Utilities/Fiber.hpp"
 #include "botcraft/Utilities/Logger.hpp"
 #include "botcraft/Utilities/SleepUtilities.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
 
 namespace Botcraft
 {
@@ -34,10 +41,29 @@ namespace Botcraft
             BehaviourClient(use_renderer_)
         {
             swap_tree = false;
+            keep_blackboard = false;
         }
 
         virtual ~TemplatedBehaviourClient()
         {
+            if (behaviour_fiber)
+            {
+                // The fiber must only be resumed by the worker it's pinned to
+                BehaviourScheduler::GetInstance().Unregister(this, [this]()
+                    {
+                        {
+                            std::lock_guard<std::mutex> behaviour_guard(behaviour_mutex);
+                            should_be_closed = true;
+                        }
+                        // Resume the tree one last time so Yield throws and its stack is unwound
+                        if (!behaviour_fiber->IsFinished())
+                        {
+                            behaviour_fiber->Resume();
+                        }
+                    });
+                behaviour_fiber.reset();
+            }
+
             // Make sure should_be_closed is set to false
             // otherwise the behaviour_thread will not exit
             // properly
@@ -60,6 +86,25 @@ namespace Botcraft
             std::lock_guard<std::mutex> behaviour_guard(behaviour_mutex);
             swap_tree = true;
             new_tree = tree_;
+            keep_blackboard = false;
+        }
+
+        /// @brief Connect again to the same server, see ManagersClient::Reconnect.
+        /// The tree is restarted from its root once connected, as the interrupted
+        /// tasks could keep pointers to the previous managers. The blackboard is kept
+        virtual void Reconnect() override
+        {
+            {
+                std::lock_guard<std::mutex> behaviour_guard(behaviour_mutex);
+                // Don't override a tree change waiting to be applied
+                if (!swap_tree)
+                {
+                    swap_tree = true;
+                    new_tree = tree;
+                    keep_blackboard = true;
+                }
+            }
+            BehaviourClient::Reconnect();
         }
 
         /// @brief Can be called to pause the execution of the internal
@@ -67,6 +112,34 @@ namespace Botcraft
         /// can be interrupted.
         virtual void Yield() override
         {
+            // Inside a Parallel node child, only switch back to the Parallel node
+            ParallelChild* parallel_child = GetParallelChild();
+            if (parallel_child != nullptr)
+            {
+                parallel_child->fiber->Suspend();
+                if (parallel_child->cancelled)
+                {
+                    throw ParallelCancelledException();
+                }
+                return;
+            }
+
+            if (behaviour_fiber)
+            {
+                // Switch back to the scheduler worker
+                behaviour_fiber->Suspend();
+                std::lock_guard<std::mutex> behaviour_guard(behaviour_mutex);
+                if (should_be_closed)
+                {
+                    throw InterruptedException();
+                }
+                else if (swap_tree)
+                {
+                    throw SwapTreeException();
+                }
+                return;
+            }
+
             std::unique_lock<std::mutex> lock(behaviour_mutex);
             behaviour_cond_var.notify_all();
             behaviour_cond_var.wait(lock);
@@ -83,6 +156,11 @@ namespace Botcraft
         /// @brief Start the behaviour thread loop.
         void StartBehaviour()
         {
+            if (behaviour_fiber)
+            {
+                LOG_WARNING("Behaviour already started on the scheduler");
+                return;
+            }
             std::unique_lock<std::mutex> lock(behaviour_mutex);
             behaviour_thread = std::thread(&TemplatedBehaviourClient<TDerived>::TreeLoop, this);
             // Wait for the first Yield call to be sure 
@@ -90,11 +168,27 @@ namespace Botcraft
             behaviour_cond_var.wait(lock);
         }
 
+        /// @brief Start the behaviour in a fiber stepped by the BehaviourScheduler,
+        /// instead of a dedicated thread. BehaviourStep must not be called manually after this.
+        void StartBehaviourOnScheduler()
+        {
+            if (behaviour_thread.joinable() || behaviour_fiber)
+            {
+                LOG_WARNING("Behaviour already started");
+                return;
+            }
+
+            behaviour_fiber = std::make_unique<Fiber>([this]() { TreeLoop(); }, BehaviourScheduler::GetInstance().GetStackSize());
+            // The fiber is started by the first step of its worker, so it's
+            // always resumed by the same thread
+            BehaviourScheduler::GetInstance().Register(this);
+        }
+
         /// @brief Blocking call, will return only when the client is
         /// disconnected from the server.
         void RunBehaviourUntilClosed()
         {
-            if (!behaviour_thread.joinable())
+            if (!behaviour_thread.joinable() && !behaviour_fiber)
             {
                 StartBehaviour();
             }
@@ -102,10 +196,14 @@ namespace Botcraft
             // Main behaviour loop
             while (!should_be_closed)
             {
-                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-                std::chrono::steady_clock::time_point end = start + std::chrono::milliseconds(10);
+                VirtualClock::time_point start = VirtualClock::now();
+                VirtualClock::time_point end = start + std::chrono::milliseconds(10);
 
-                BehaviourStep();
+                // When running on the scheduler, just wait for the disconnection
+                if (!behaviour_fiber)
+                {
+                    BehaviourStep();
+                }
 
                 SleepUntil(end);
             }
@@ -113,24 +211,64 @@ namespace Botcraft
 
         /// @brief Perform one step of the behaviour tree.
         /// Don't forget to call StartBehaviour before.
-        void BehaviourStep()
+        virtual void BehaviourStep() override
         {
             if (should_be_closed || !network_manager || network_manager->GetConnectionState() != ProtocolCraft::ConnectionState::Play)
             {
                 return;
             }
 
-            std::unique_lock<std::mutex> lock(behaviour_mutex);
-            // Resume tree ticking
-            behaviour_cond_var.notify_all();
-            // Wait for the next call to Yield()
-            behaviour_cond_var.wait(lock);
+            // The state switches to Play before the login packet, wait for
+            // it so the tree doesn't get the placeholder local player
+            if (!entity_manager || !entity_manager->IsLocalPlayerSpawned())
+            {
+                return;
+            }
+
+            TRACE_ZONE("BehaviourStep");
+            AdvanceTimers();
+
+            // Don't wake the tree up if it's waiting for an event that didn't happen yet
+            if (!swap_tree && IsWaitingForEvent())
+            {
+                return;
+            }
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (behaviour_fiber)
+            {
+                behaviour_fiber->Resume();
+                RecordBehaviourStep(std::chrono::steady_clock::now() - start);
+                return;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(behaviour_mutex);
+                // Resume tree ticking
+                behaviour_cond_var.notify_all();
+                // Wait for the next call to Yield()
+                behaviour_cond_var.wait(lock);
+            }
+            RecordBehaviourStep(std::chrono::steady_clock::now() - start);
         }
 
     private:
         void TreeLoop()
         {
-            Logger::GetInstance().RegisterThread("BehaviourTreeLoop");
+            // Fibers run on the scheduler threads, already registered
+            if (!behaviour_fiber)
+            {
+                Logger::GetInstance().RegisterThread("BehaviourTreeLoop");
+            }
+            else
+            {
+                // Started by the last step, nothing to unwind
+                std::lock_guard<std::mutex> behaviour_guard(behaviour_mutex);
+                if (should_be_closed)
+                {
+                    return;
+                }
+            }
             while (true)
             {
                 try
@@ -144,10 +282,19 @@ namespace Botcraft
                 // We need to update the tree with the new one
                 catch (const SwapTreeException&)
                 {
-                    tree = new_tree;
-                    new_tree = nullptr;
-                    swap_tree = false;
-                    blackboard.Clear();
+                    bool clear_blackboard = false;
+                    {
+                        std::lock_guard<std::mutex> behaviour_guard(behaviour_mutex);
+                        tree = new_tree;
+                        new_tree = nullptr;
+                        swap_tree = false;
+                        clear_blackboard = !keep_blackboard;
+                        keep_blackboard = false;
+                    }
+                    if (clear_blackboard)
+                    {
+                        blackboard.Clear();
+                    }
                     continue;
                 }
                 // We need to stop the behaviour thread
@@ -171,9 +318,15 @@ namespace Botcraft
     private:
         std::shared_ptr<BehaviourTree<TDerived> > tree;
         std::shared_ptr<BehaviourTree<TDerived> > new_tree;
-        bool swap_tree;
+        // Written under behaviour_mutex, but also read
+        // without it by BehaviourStep on the stepping thread
+        std::atomic<bool> swap_tree;
+        // True if the tree is restarted after a reconnection
+        bool keep_blackboard;
 
         std::thread behaviour_thread;
+        // Only used when the behaviour runs on the BehaviourScheduler
+        std::unique_ptr<Fiber> behaviour_fiber;
         std::condition_variable behaviour_cond_var;
         std::mutex behaviour_mutex;
     };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include "botcraft/Game/AABB.hpp"
+
+namespace Botcraft
+{
+    /// @brief A group of AABB stored as a structure of arrays (min and
+    /// max per axis), to test one box against all of them at once.
+    /// Kernels are written as branchless loops over contiguous arrays
+    /// so the compiler can vectorize them on any architecture.
+    class AABBBatch
+    {
+    public:
+        AABBBatch();
+
+        void Clear();
+        void Reserve(const size_t n);
+        void Add(const AABB& box);
+        const size_t Size() const;
+        const AABB Get(const size_t i) const;
+
+        /// @brief Test which boxes collide with a given one, same as AABB::Collide
+        /// @param box The box to test
+        /// @param hits Output, hits[i] is 1 if box collides with the ith box, 0 otherwise
+        void Collide(const AABB& box, std::vector<char>& hits) const;
+
+        /// @brief Check if a box collides with any of the boxes
+        /// @param box The box to test
+        /// @return The index of the first box colliding, -1 if none
+        const int AnyCollide(const AABB& box) const;
+
+        /// @brief Sweep a moving box against all the boxes, same as AABB::SweptCollide
+        /// @param box The moving box
+        /// @param speed Movement of the box
+        /// @param normal Output, normal of the earliest hit face. Not modified if no hit
+        /// @param index Output, index of the earliest hit box, -1 if no hit
+        /// @return The fraction (between 0 and 1) of the speed that can be performed before the earliest hit
+        const double SweptCollide(const AABB& box, const Vector3<double>& speed, Vector3<double>& normal, int& index) const;
+
+    private:
+        std::vector<double> min_x;
+        std::vector<double> min_y;
+        std::vector<double> min_z;
+        std::vector<double> max_x;
+        std::vector<double> max_y;
+        std::vector<double> max_z;
+    };
+} // Botcraft
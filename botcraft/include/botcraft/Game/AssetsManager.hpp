@@ -4,6 +4,7 @@
 #include "botcraft/Game/World/Blockstate.hpp"
 #include "botcraft/Game/Inventory/Item.hpp"
 
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -16,11 +17,41 @@ namespace Botcraft
     }
 #endif
 
+    /// @brief Which assets data are loaded by the AssetsManager
+    enum class AssetsProfile
+    {
+        /// @brief Everything, including the models faces and the textures with the GUI
+        Full,
+        /// @brief Blockstates properties and colliders only, for bots without renderer
+        CollisionOnly
+    };
+
     class AssetsManager
     {
     public:
         static AssetsManager& getInstance();
 
+        /// @brief Set the data to load. Must be called before the first getInstance(). Without
+        /// the GUI there is no rendering data anyway, so both profiles are the same
+        /// @param profile The assets profile, AssetsProfile::Full by default
+        static void SetProfile(const AssetsProfile profile);
+
+        /// @brief Start loading the assets on a background thread and return immediately,
+        /// so parsing the files overlaps with other work like connecting to a server.
+        /// The next getInstance() calls wait for the loading to be done. Calling it
+        /// again or after the assets are loaded does nothing
+        static void Preload();
+
+        /// @brief Get an estimation of the memory used by the loaded blockstates,
+        /// biomes and items. Textures are not counted, they are sent to the GPU
+        /// @return The size in bytes
+        const size_t GetMemoryUsage() const;
+
+        /// @brief Get the time spent loading each category of assets
+        /// @return Category name and duration in ms, in loading order. Blocks, biomes and items
+        /// files are parsed in parallel, their durations overlap
+        const std::vector<std::pair<std::string, double> >& GetLoadingTimings() const;
+
         AssetsManager(AssetsManager const&) = delete;
         void operator=(AssetsManager const&) = delete;
 
@@ -30,6 +61,18 @@ namespace Botcraft
         const std::unordered_map<int, std::unique_ptr<Blockstate> >& Blockstates() const;
 #endif
         
+        /// @brief Get the precomputed properties of a blockstate. Faster than
+        /// looking for the Blockstate object and testing its properties
+        /// @param id Blockstate id (Blockstate::IdMetadataToId(id, metadata) before 1.13)
+        /// @return BlockstateFlag values combined with bitwise or
+        const unsigned short GetBlockstateFlags(const int id) const;
+
+        /// @brief Get a blockstate from its id. Faster than looking into Blockstates()
+        /// as it's a direct index in a flat array
+        /// @param id Blockstate id (Blockstate::IdMetadataToId(id, metadata) before 1.13)
+        /// @return The blockstate, or the default blockstate for unknown ids
+        const Blockstate* GetBlockstate(const int id) const;
+
 #if PROTOCOL_VERSION < 358
         const std::unordered_map<unsigned char, std::unique_ptr<Biome> >& Biomes() const;
         const Biome* GetBiome(const unsigned char id);
@@ -44,10 +87,22 @@ namespace Botcraft
         const std::unordered_map<int, std::unique_ptr<Item> >& Items() const;
 #endif
 
+        /// @brief Get the id of an item from its name, using a precomputed index
+        /// @param item_name Item name, e.g. "minecraft:stone"
+        /// @return The item id, -1 if not found
 #if PROTOCOL_VERSION < 347
-        const std::pair<int, unsigned char> GetItemID(const std::string& item_name) const;
+        const std::pair<int, unsigned char> GetItemID(const std::string_view item_name) const;
 #else
-        const int GetItemID(const std::string& item_name) const;
+        const int GetItemID(const std::string_view item_name) const;
+#endif
+
+        /// @brief Get an item from its id. Faster than looking into Items() as
+        /// it's a direct index in a flat array after 1.13
+        /// @return The item, or the default item for unknown ids
+#if PROTOCOL_VERSION < 347
+        const Item* GetItem(const int id, const unsigned char damage_id) const;
+#else
+        const Item* GetItem(const int id) const;
 #endif
 
 #if USE_GUI
@@ -58,15 +113,25 @@ namespace Botcraft
         AssetsManager();
 
         void LoadBlocksFile();
+        // Fill the flat blockstate flags and pointers arrays
+        void IndexBlockstates();
         void LoadBiomesFile();
         void LoadItemsFile();
+        void IndexItems();
 #if USE_GUI
         void LoadTextures();
 #endif
         void ClearCaches();
 
+        // Read all the assets from a binary bundle instead of the json files.
+        // Returns false if the bundle doesn't exist or the assets changed since it was written
+        const bool LoadAssetsBundle(const std::string& path);
+        void SaveAssetsBundle(const std::string& path) const;
+
 #if USE_GUI
         void UpdateModelsWithAtlasData();
+        // Remove the models faces and textures, for the collision only profile
+        void ClearRenderingData();
 #endif
 
     private:
@@ -75,6 +140,13 @@ namespace Botcraft
 #else
         std::unordered_map<int, std::unique_ptr<Blockstate> > blockstates;
 #endif
+        // Flags of each blockstate, indexed by id
+        std::vector<unsigned short> blockstate_flags;
+        // Flags of the default blockstate, used for unknown ids
+        unsigned short default_blockstate_flags;
+        // Blockstates indexed by id, unknown ids point to default_blockstate
+        std::vector<const Blockstate*> blockstates_by_id;
+        const Blockstate* default_blockstate;
 #if PROTOCOL_VERSION < 358
         std::unordered_map<unsigned char, std::unique_ptr<Biome> > biomes;
 #else
@@ -85,8 +157,18 @@ namespace Botcraft
 #else
         std::unordered_map<int, std::unique_ptr<Item> > items;
 #endif
+        // Item ids indexed by name, keys are views on the names stored in the items
+#if PROTOCOL_VERSION < 347
+        std::unordered_map<std::string_view, std::pair<int, unsigned char> > item_ids_by_name;
+#else
+        std::unordered_map<std::string_view, int> item_ids_by_name;
+        // Items indexed by id, nullptr for unknown ids
+        std::vector<const Item*> items_by_id;
+#endif
+        const Item* default_item;
 #if USE_GUI
         std::unique_ptr<Renderer::Atlas> atlas;
 #endif
+        std::vector<std::pair<std::string, double> > loading_timings;
     };
 } // Botcraft
\ No newline at end of file
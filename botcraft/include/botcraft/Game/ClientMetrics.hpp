@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "botcraft/AI/BehaviourClient.hpp"
+#include "botcraft/Game/Entities/EntityManager.hpp"
+#include "botcraft/Game/Physics/PhysicsManager.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Network/NetworkManager.hpp"
+
+namespace Botcraft
+{
+    /// @brief Resources used by one bot, see ManagersClient::GetMetrics
+    struct ClientMetrics
+    {
+        /// @brief Name of the bot, empty if not connected
+        std::string name;
+        NetworkStats network;
+        WorldStats world;
+        /// @brief If true, world counters are the ones of the World shared with other bots
+        bool world_shared = false;
+        EntityManagerStats entities;
+        /// @brief False if the physics are not running
+        bool has_physics = false;
+        PhysicsStats physics;
+        /// @brief False if the bot has no behaviour (ManagersClient)
+        bool has_behaviour = false;
+        BehaviourStats behaviour;
+        /// @brief Estimation of the memory used by the loaded assets, in bytes. Shared by all the bots
+        size_t assets_memory_bytes = 0;
+#if USE_GUI
+        /// @brief GPU memory used by the renderer faces buffers, in bytes, 0 without renderer
+        size_t renderer_memory_bytes = 0;
+#endif
+    };
+
+    /// @brief Format metrics of several bots in Prometheus text exposition format,
+    /// with one "bot" label per metric
+    /// @param metrics The metrics of all the bots
+    /// @return The text to serve on a /metrics endpoint
+    std::string MetricsToPrometheus(const std::vector<ClientMetrics>& metrics);
+} // Botcraft
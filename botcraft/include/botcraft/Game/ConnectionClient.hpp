@@ -24,6 +24,25 @@ namespace Botcraft
         void Connect(const std::string& address, const std::string& login, const std::string& password, const bool force_microsoft_account = false);
         virtual void Disconnect();
 
+        /// @brief Connect again to the last server given to Connect, after being kicked
+        /// or a connection loss. The account is not authenticated again and the network
+        /// settings and buffers of the previous connection are reused, see NetworkManager.
+        /// Must be called after Connect and before Disconnect, not from a network thread
+        virtual void Reconnect();
+
+        /// @brief Record all the packets received after the next Connect call in a file, see NetworkManager::StartCapture
+        /// @param path Path of the capture file, empty to disable capture
+        void SetCapturePath(const std::string& path);
+
+        /// @brief Process a capture file instead of connecting to a server.
+        /// Packets go through the same parsing and handlers as during the
+        /// capture, without any network. Outgoing packets are dropped.
+        /// Blocks until all packets are processed
+        /// @param path Path of a file recorded with SetCapturePath or NetworkManager::StartCapture
+        /// @param speed Replay speed relative to the capture timings, 0 to process the packets as fast as possible
+        /// @return The number of processed packets
+        size_t Replay(const std::string& path, const double speed = 0.0);
+
         const bool GetShouldBeClosed() const;
         void SetShouldBeClosed(const bool b);
 
@@ -49,5 +68,10 @@ namespace Botcraft
         std::shared_ptr<NetworkManager> network_manager;
 
         bool should_be_closed;
+
+        std::string capture_path;
+
+        /// @brief Address given to the last Connect call
+        std::string server_address;
     };
 } //Botcraft
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class Entity;
+    enum class EntityType;
+
+    /// @brief Hot kinematic state (id, position, yaw, pitch, on ground, type)
+    /// of the entities of an EntityManager, stored as a structure of arrays
+    /// so bulk updates and queries only touch contiguous memory. Entities
+    /// keep their own state and mirror it in the table each time it's set.
+    /// Rows are moved when an entity is removed, use GetRow to find an
+    /// entity. Not thread-safe, EntityManager mutex must be locked.
+    class EntityKinematicsTable
+    {
+    public:
+        EntityKinematicsTable();
+        ~EntityKinematicsTable();
+
+        EntityKinematicsTable(const EntityKinematicsTable&) = delete;
+        EntityKinematicsTable& operator=(const EntityKinematicsTable&) = delete;
+
+        /// @brief Add an entity to the table, its current state is copied in it.
+        /// If an entity with the same id is already in the table, it's removed first
+        /// @param entity The entity to add, must stay alive until removed from the table
+        void Add(Entity* entity);
+
+        /// @brief Remove an entity from the table
+        /// @param id Id of the entity to remove
+        void Remove(const int id);
+
+        /// @brief Remove all the entities from the table
+        void Clear();
+
+        /// @brief Get the row of an entity
+        /// @param id Id of the entity
+        /// @return The row index, -1 if this entity is not in the table
+        const int GetRow(const int id) const;
+
+        const size_t Size() const;
+
+        /// @brief Get the version of the table, incremented each
+        /// time an entity is added, removed or its state modified
+        const unsigned long long GetVersion() const;
+
+        const std::vector<int>& GetIds() const;
+        const std::vector<Vector3<double> >& GetPositions() const;
+        const std::vector<float>& GetYaws() const;
+        const std::vector<float>& GetPitches() const;
+        const std::vector<char>& GetOnGrounds() const;
+        const std::vector<EntityType>& GetTypes() const;
+
+        /// @brief Set the position of the entity at a given row, through
+        /// the entity setter so its rendered faces are updated too
+        void SetPosition(const int row, const Vector3<double>& position);
+        void SetYaw(const int row, const float yaw);
+        void SetPitch(const int row, const float pitch);
+        void SetOnGround(const int row, const bool on_ground);
+
+    private:
+        friend class Entity;
+
+        /// @brief Copy the kinematic state of an entity in its row
+        void Mirror(const int row, const Entity& entity);
+
+        std::vector<int> ids;
+        std::vector<Vector3<double> > positions;
+        std::vector<float> yaws;
+        std::vector<float> pitches;
+        std::vector<char> on_grounds;
+        std::vector<EntityType> types;
+        std::vector<Entity*> entities;
+
+        std::unordered_map<int, int> rows;
+
+        unsigned long long version;
+    };
+} // Botcraft
@@ -1,14 +1,26 @@
 #pragma once
 
 #include "protocolCraft/Handler.hpp"
+#include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Game/AABB.hpp"
+#include "botcraft/Game/Enums.hpp"
+#include "botcraft/Game/EventNotifier.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/Entities/EntityKinematicsTable.hpp"
+#include "botcraft/Game/Entities/EntitySnapshot.hpp"
+#include <atomic>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <mutex>
+#include <vector>
+#include <functional>
 
 namespace Botcraft
 {
     class Entity;
     class LocalPlayer;
+    enum class EntityType;
 
 #if USE_GUI
     namespace Renderer
@@ -17,20 +29,192 @@ namespace Botcraft
     }
 #endif
 
+    /// @brief Decide how a new entity is tracked
+    /// @param type Type of the entity
+    /// @param position Spawn position of the entity
+    /// @param player_position Current position of the local player
+    /// @return The tracking mode to use for this entity
+    using EntityTrackingFilter = std::function<EntityTrackingMode(const EntityType type, const Vector3<double>& position, const Vector3<double>& player_position)>;
+
+    struct EntityManagerStats
+    {
+        /// @brief Number of stored entities, local player included
+        size_t num_entities = 0;
+        /// @brief Number of stored entities only tracked as StubEntity
+        size_t num_stubs = 0;
+        /// @brief Number of entities ignored by the tracking filter
+        size_t num_ignored = 0;
+        /// @brief With a shared entity manager, number of entities this bot can see
+        size_t num_visible = 0;
+        /// @brief Number of memory blocks of destroyed entities waiting to be reused (process-wide)
+        size_t num_pooled_blocks = 0;
+        /// @brief Estimation of the memory used by the stored entities, metadata excluded, in bytes
+        size_t entities_memory_bytes = 0;
+        /// @brief Estimation of the memory used by the metadata of the stored entities, in bytes
+        size_t metadata_memory_bytes = 0;
+    };
+
+    /// @brief Content of an entity movement packet, decoded without
+    /// creating a message, see EntityManager::ApplyMovements
+    struct EntityMovement
+    {
+        enum class Type : unsigned char
+        {
+            Pos,
+            PosRot,
+            Rot,
+            Teleport
+        };
+
+        Type type;
+        int entity_id;
+        /// @brief Position delta for Pos and PosRot, in 1/4096 block
+        short xa;
+        short ya;
+        short za;
+        /// @brief New position for Teleport
+        Vector3<double> position;
+        /// @brief Angles for PosRot, Rot and Teleport, in 1/256 of a full turn
+        unsigned char y_rot;
+        unsigned char x_rot;
+        bool on_ground;
+    };
+
     class EntityManager : public ProtocolCraft::Handler
     {
     public:
         EntityManager();
+        /// @brief Create an entity manager storing the entities in a shared
+        /// one, to deduplicate the entities seen by several bots connected
+        /// to the same server. Only the local player and the list of the
+        /// entities this bot can see are kept here. GetEntities, GetEntity,
+        /// queries, snapshot, mutex and event notifier are the shared ones,
+        /// so they contain all the entities seen by any bot, the other bots
+        /// included. Updates of an entity are applied by the first bot that
+        /// saw it only, so relative moves are not applied twice
+        /// @param shared_entities_ The shared entity manager, not connected to any server
+        EntityManager(const std::shared_ptr<EntityManager>& shared_entities_);
+        ~EntityManager();
+
+        /// @brief Set the filter used to decide how new entities are tracked.
+        /// Stub entities are StubEntity objects only keeping their id, position and
+        /// orientation, their metadata and equipment updates are dropped. Ignored entities
+        /// are not stored at all. Already tracked entities are not affected.
+        /// When using a shared entity manager, this filter only decides
+        /// which entities are ignored by this bot, as other bots may need
+        /// the same entities fully tracked
+        /// @param filter_ The filter to use, nullptr to fully track all entities
+        void SetTrackingFilter(const EntityTrackingFilter& filter_);
+
+        /// @brief Create a tracking filter based on the type and distance of the entities
+        /// @param types Types of the entities to fully track
+        /// @param max_distance Entities spawning further than this from the local player use others_mode, ignored if negative
+        /// @param others_mode Tracking mode of the entities not fully tracked
+        /// @return A filter to use with SetTrackingFilter
+        static EntityTrackingFilter MakeTrackingFilter(const std::unordered_set<EntityType>& types,
+            const double max_distance = -1.0, const EntityTrackingMode others_mode = EntityTrackingMode::Ignored);
+
+        /// @brief Enable/disable recycling of entities memory. When enabled, new
+        /// entities are allocated in a process-wide pool, and the memory of an
+        /// entity removed by the server (ClientboundRemoveEntitiesPacket) is
+        /// kept to be reused by the next entity of the same type, as soon as
+        /// nobody else holds a reference to it. Only affects entities
+        /// created after the call. Disabled by default. When using a shared
+        /// entity manager, entities are created by the shared one
+        /// @param b True to enable recycling
+        void SetEntityRecycling(const bool b);
 
         std::shared_ptr<LocalPlayer> GetLocalPlayer();
+        /// @brief Check if the local player has been created by the server login packet.
+        /// Before that, GetLocalPlayer returns a placeholder replaced at login
+        /// @return True if the local player is the one of the current session
+        const bool IsLocalPlayerSpawned() const;
         const std::unordered_map<int, std::shared_ptr<Entity> >& GetEntities() const;
         std::shared_ptr<Entity> GetEntity(const int id) const;
         void AddEntity(const std::shared_ptr<Entity>& entity);
 
+        /// @brief Get the position, orientation and type of all the entities
+        /// but the local player, in contiguous arrays. Entity manager mutex
+        /// must be locked by the caller
+        const EntityKinematicsTable& GetKinematics() const;
+
+        /// @brief Get a read-only copy of the position, orientation and type
+        /// of all the entities but the local player, that can be iterated without
+        /// locking the entity manager mutex. A new copy is only made if something
+        /// changed since the last call. Entity manager mutex must NOT be locked by
+        /// the caller
+        const EntitySnapshot GetSnapshot();
+
+        /// @brief Get all the entities with their position in a sphere, using a
+        /// spatial index. The local player is never returned. Entity manager
+        /// mutex must be locked by the caller
+        /// @param center Center of the sphere
+        /// @param radius Radius of the sphere
+        /// @param filter If not nullptr, only entities for which it returns true are returned
+        /// @return The entities found, in no particular order
+        std::vector<std::shared_ptr<Entity> > QueryRadius(const Vector3<double>& center, const double radius,
+            const std::function<bool(const Entity&)>& filter = nullptr) const;
+
+        /// @brief Get all the entities with their collider intersecting a box,
+        /// using a spatial index. The local player is never returned. Entity
+        /// manager mutex must be locked by the caller
+        /// @param box The box to test
+        /// @param filter If not nullptr, only entities for which it returns true are returned
+        /// @return The entities found, in no particular order
+        std::vector<std::shared_ptr<Entity> > QueryAABB(const AABB& box,
+            const std::function<bool(const Entity&)>& filter = nullptr) const;
+
 #if USE_GUI
         void SetRenderingManager(std::shared_ptr<Renderer::RenderingManager> rendering_manager_);
 #endif
         std::mutex& GetMutex();
+        /// @brief Get the notifier signaled when this manager state changes
+        const EventNotifier& GetEventNotifier() const;
+
+        /// @brief Get the number of entities tracked by this manager.
+        /// Entity manager mutex must NOT be locked by the caller
+        const EntityManagerStats GetStats();
+
+        /// @brief Apply a batch of movements with the same effect as the
+        /// corresponding packets Handle, locking the manager only once.
+        /// Entity manager mutex must NOT be locked by the caller
+        /// @param movements The movements, applied in order
+        void ApplyMovements(const std::vector<EntityMovement>& movements);
+
+        /// @brief All the message types processed by EntityManager
+        using HandledMessages = std::tuple<
+            ProtocolCraft::ClientboundLoginPacket,
+            ProtocolCraft::ClientboundPlayerPositionPacket,
+            ProtocolCraft::ClientboundAddEntityPacket,
+#if PROTOCOL_VERSION < 759
+            ProtocolCraft::ClientboundAddMobPacket,
+#endif
+            ProtocolCraft::ClientboundAddExperienceOrbPacket,
+#if PROTOCOL_VERSION < 721
+            ProtocolCraft::ClientboundAddGlobalEntityPacket,
+#endif
+            ProtocolCraft::ClientboundAddPlayerPacket,
+            ProtocolCraft::ClientboundSetHealthPacket,
+            ProtocolCraft::ClientboundTeleportEntityPacket,
+            ProtocolCraft::ClientboundPlayerAbilitiesPacket,
+#if PROTOCOL_VERSION < 755
+            ProtocolCraft::ClientboundMoveEntityPacket,
+#endif
+            ProtocolCraft::ClientboundMoveEntityPacketPos,
+            ProtocolCraft::ClientboundMoveEntityPacketPosRot,
+            ProtocolCraft::ClientboundMoveEntityPacketRot,
+#if PROTOCOL_VERSION == 755
+            ProtocolCraft::ClientboundRemoveEntityPacket,
+#else
+            ProtocolCraft::ClientboundRemoveEntitiesPacket,
+#endif
+            ProtocolCraft::ClientboundSetEntityDataPacket,
+            ProtocolCraft::ClientboundSetEntityMotionPacket,
+            ProtocolCraft::ClientboundSetEquipmentPacket,
+            ProtocolCraft::ClientboundUpdateAttributesPacket,
+            ProtocolCraft::ClientboundUpdateMobEffectPacket,
+            ProtocolCraft::ClientboundRemoveMobEffectPacket
+        >;
 
     protected:
         virtual void Handle(ProtocolCraft::ClientboundLoginPacket& msg) override;
@@ -63,17 +247,80 @@ namespace Botcraft
         virtual void Handle(ProtocolCraft::ClientboundSetEquipmentPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundUpdateAttributesPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundUpdateMobEffectPacket& msg) override;
+        virtual void Handle(ProtocolCraft::ClientboundRemoveMobEffectPacket& msg) override;
 
 
+    private:
+        /// @brief Get the tracking mode of a new entity and remember it if not fully tracked
+        /// @return The tracking mode according to the current filter
+        EntityTrackingMode TrackEntity(const int id, const EntityType type, const Vector3<double>& position);
+        /// @brief Create a new entity according to its tracking mode
+        /// @return The created entity, nullptr if ignored
+        std::shared_ptr<Entity> CreateTrackedEntity(const int id, const EntityType type, const Vector3<double>& position);
+        /// @brief Add an entity in the kinematics table and the spatial index
+        void IndexEntity(const std::shared_ptr<Entity>& entity);
+        /// @brief Remove an entity from the kinematics table and the spatial index
+        void UnindexEntity(const int id);
+        /// @brief Update the spatial index cell of an entity after it moved
+        void UpdateEntityCell(const int id, const Vector3<double>& pos);
+        /// @brief Remove an entity from the spatial index
+        void RemoveEntityCell(const int id);
+        /// @brief Call a function for all the indexed entities in cells overlapping a XZ area
+        void ForEachEntityInCells(const double min_x, const double min_z, const double max_x, const double max_z,
+            const std::function<void(const std::shared_ptr<Entity>&)>& func) const;
+        /// @brief Remove an entity from all the containers. entity_manager_mutex must be locked
+        void RemoveEntity(const int id);
+        /// @brief Update the position/rotation of an entity. entity_manager_mutex must be locked
+        void ApplyMovement(const EntityMovement& movement);
+
+        /// @brief In shared mode, send a spawn packet to the shared manager if this bot is the first to see the entity
+        /// @return False if not in shared mode or for the local player, and the packet must be processed here
+        template<class TPacket>
+        bool ForwardSpawnToShared(TPacket& msg, const int id, const EntityType type, const Vector3<double>& position);
+        /// @brief In shared mode, send an entity update packet to the shared manager if this bot owns the entity
+        /// @return False if not in shared mode or for the local player, and the packet must be processed here
+        template<class TPacket>
+        bool ForwardUpdateToShared(TPacket& msg, const int id);
+        /// @brief Stop seeing some entities, they are removed from the shared
+        /// manager if no other bot can see them
+        void RemoveSharedViewers(const std::vector<int>& ids);
+
     private:
         std::unordered_map<int, std::shared_ptr<Entity> > entities;
+        /// @brief Hot kinematic state of the entities, local player excluded
+        EntityKinematicsTable kinematics;
+        /// @brief Spatial index, entities id by chunk column, local player excluded
+        std::unordered_map<std::pair<int, int>, std::unordered_set<int>, ChunkCoordinatesHasher> entity_cells;
+        /// @brief Current cell of each indexed entity
+        std::unordered_map<int, std::pair<int, int> > entity_cell_coords;
+        /// @brief Largest half width of the indexed entities
+        double max_entity_half_width;
+        /// @brief Last snapshot made, with the kinematics table version as epoch
+        std::shared_ptr<const EntitySnapshot::Data> snapshot;
+        /// @brief Filter used to decide how new entities are tracked
+        EntityTrackingFilter tracking_filter;
+        /// @brief If true, new entities are allocated in EntityPool
+        bool recycle_entities;
+        /// @brief Tracking mode of the entities not fully tracked
+        std::unordered_map<int, EntityTrackingMode> untracked_entities;
         // The current player is stored independently
         std::shared_ptr<LocalPlayer> local_player;
+        std::atomic<bool> local_player_spawned;
 
         std::mutex entity_manager_mutex;
+        EventNotifier event_notifier;
 
 #if USE_GUI
         std::shared_ptr<Renderer::RenderingManager> rendering_manager;
 #endif
+
+        /// @brief If not null, the manager actually storing the entities
+        std::shared_ptr<EntityManager> shared_entities;
+        /// @brief In shared mode, the entities this bot can see
+        std::unordered_set<int> visible_entities;
+        /// @brief In the shared manager, the managers that can see each entity,
+        /// the first one being the one sending its updates
+        std::unordered_map<int, std::vector<const EntityManager*> > viewers;
+        std::mutex viewers_mutex;
     };
 } // Botcraft
\ No newline at end of file
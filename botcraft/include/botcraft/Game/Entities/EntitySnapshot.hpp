@@ -0,0 +1,83 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class Entity;
+    enum class EntityType;
+
+    /// @brief A read-only copy of the kinematic state of the entities
+    /// at a given time. A snapshot is never modified, so it can be
+    /// iterated without locking the entity manager mutex while the
+    /// network thread keeps updating the entities. The Entity objects
+    /// pointed by a snapshot are the live ones, their other properties
+    /// still need the entity manager mutex to be read.
+    class EntitySnapshot
+    {
+    public:
+        /// @brief Number of floats per entity written by FillFeatures:
+        /// type, dx, dy, dz, yaw, pitch, on_ground, distance
+        static constexpr size_t NUM_FEATURES = 8;
+
+        struct EntityState
+        {
+            int id;
+            EntityType type;
+            Vector3<double> position;
+            float yaw;
+            float pitch;
+            bool on_ground;
+            std::shared_ptr<Entity> entity;
+        };
+
+        struct Data
+        {
+            std::vector<EntityState> states;
+            // entity id --> index in states
+            std::unordered_map<int, size_t> indices;
+            unsigned long long epoch;
+        };
+
+        EntitySnapshot(const std::shared_ptr<const Data>& data_);
+
+        /// @brief Get the epoch of this snapshot. Two snapshots
+        /// with the same epoch hold exactly the same state
+        const unsigned long long GetEpoch() const;
+
+        /// @brief Get the state of all the entities in the snapshot
+        const std::vector<EntityState>& GetEntities() const;
+
+        /// @brief Get the state of one entity
+        /// @param id Id of the entity
+        /// @return A pointer to the state, nullptr if not in the snapshot. Valid as long as the snapshot exists
+        const EntityState* GetEntity(const int id) const;
+
+        /// @brief Get all the entities with their position in a sphere
+        /// @param center Center of the sphere
+        /// @param radius Radius of the sphere
+        /// @param filter If not nullptr, only entities for which it returns true are returned
+        /// @return Pointers to the states found, valid as long as the snapshot exists
+        std::vector<const EntityState*> QueryRadius(const Vector3<double>& center, const double radius,
+            const std::function<bool(const EntityState&)>& filter = nullptr) const;
+
+        /// @brief Fill a feature table with the entities in a sphere, closest first,
+        /// e.g. to build observations around a bot
+        /// @param center Center of the sphere, positions are relative to it
+        /// @param radius Radius of the sphere
+        /// @param output Buffer of max_entities * NUM_FEATURES floats, one row per entity
+        /// @param max_entities Max number of rows to write
+        /// @param filter If not nullptr, only entities for which it returns true are written
+        /// @return The number of rows written, rows after it are left untouched
+        size_t FillFeatures(const Vector3<double>& center, const double radius, float* output, const size_t max_entities,
+            const std::function<bool(const EntityState&)>& filter = nullptr) const;
+
+    private:
+        std::shared_ptr<const Data> data;
+    };
+} // Botcraft
@@ -1,11 +1,30 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <mutex>
 
 #include "botcraft/Game/Entities/entities/player/PlayerEntity.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
 
 namespace Botcraft 
 {
+    /// @brief Copy of the local player state, as published
+    /// at the end of each physics tick
+    struct LocalPlayerState
+    {
+        Vector3<double> position;
+        Vector3<double> speed;
+        float yaw = 0.0f;
+        float pitch = 0.0f;
+        bool on_ground = false;
+        float health = 0.0f;
+        int food = 0;
+        float food_saturation = 0.0f;
+    };
+
     class LocalPlayer : public PlayerEntity
     {
     public:
@@ -14,6 +33,26 @@ namespace Botcraft
 
         std::mutex& GetMutex();
 
+        /// @brief Get a consistent copy of the last published state without
+        /// locking the player mutex. Can be up to one physics tick late
+        /// @return The last published state
+        LocalPlayerState GetState() const;
+        /// @brief Publish the current state for GetState readers.
+        /// player_mutex must be locked by the caller
+        void PublishState();
+
+        /// @brief Queue a modification of the player, applied at the beginning of
+        /// the next physics tick. Lock-free, can be called from any thread
+        /// @param command Function to apply to the player, called with player_mutex locked
+        void QueueCommand(std::function<void(LocalPlayer&)>&& command);
+        /// @brief Queue some inputs, added to the player inputs at the next physics tick
+        void QueueInputs(const Vector3<double>& inputs);
+        /// @brief Queue a LookAt, applied at the next physics tick
+        void QueueLookAt(const Vector3<double>& pos, const bool set_pitch = false);
+        /// @brief Apply all the queued commands in the order they were queued.
+        /// player_mutex must be locked by the caller
+        void ProcessQueuedCommands();
+
         const Vector3<double>& GetFrontVector() const;
         const Vector3<double>& GetXZVector() const;
         const Vector3<double>& GetRightVector() const;
@@ -43,6 +82,16 @@ namespace Botcraft
         void SetFoodSaturation(const float food_saturation_);
         void SetHasMoved(const bool has_moved_);
 
+        /// @brief Set an active effect on the player
+        /// @param effect The effect type
+        /// @param amplifier Effect amplifier (level - 1)
+        /// @param duration_ticks Effect duration, in ticks
+        void SetEffect(const EffectType effect, const int amplifier, const int duration_ticks);
+        void RemoveEffect(const EffectType effect);
+        /// @brief Get the level of an active effect
+        /// @return The effect level (amplifier + 1), 0 if not active
+        const int GetEffectLevel(const EffectType effect) const;
+
         virtual void SetPosition(const Vector3<double>& pos) override;
         virtual void SetX(const double x) override;
         virtual void SetY(const double y) override;
@@ -68,9 +117,23 @@ namespace Botcraft
     private:
         void UpdateVectors();
 
+    private:
+        struct QueuedCommand
+        {
+            std::function<void(LocalPlayer&)> command;
+            QueuedCommand* next;
+        };
+
     private:
         std::mutex player_mutex;
 
+        /// @brief Seqlock protecting published_state, odd while it's being written
+        std::atomic<unsigned int> state_sequence;
+        LocalPlayerState published_state;
+
+        /// @brief Lock-free stack of commands waiting for the next physics tick, most recent first
+        std::atomic<QueuedCommand*> queued_commands;
+
         Vector3<double> frontVector;
         Vector3<double> xzVector;
         Vector3<double> rightVector;
@@ -88,5 +151,8 @@ namespace Botcraft
         float food_saturation;
 
         bool has_moved;
+
+        // Amplifier and end time of each active effect
+        std::map<EffectType, std::pair<int, VirtualClock::time_point> > effects;
     };
 } // Botcraft
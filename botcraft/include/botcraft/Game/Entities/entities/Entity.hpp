@@ -4,6 +4,7 @@
 #include <map>
 #include <optional>
 #include <any>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -26,6 +27,7 @@ namespace Botcraft
 #if PROTOCOL_VERSION < 458
     enum class ObjectEntityType;
 #endif
+    class EntityKinematicsTable;
 
     class Entity
     {
@@ -91,7 +93,8 @@ namespace Botcraft
 
         // Generic properties getter
         int GetEntityID() const;
-        const Vector3<double>& GetPosition() const;
+        const ProtocolCraft::UUID& GetUUID() const;
+        Vector3<double> GetPosition() const;
         double GetX() const;
         double GetY() const;
         double GetZ() const;
@@ -104,6 +107,14 @@ namespace Botcraft
         bool GetOnGround() const;
         const std::map<EquipmentSlot, ProtocolCraft::Slot>& GetEquipments() const;
         const ProtocolCraft::Slot& GetEquipment(const EquipmentSlot slot) const;
+
+        /// @brief Get an estimation of the memory used by this entity, metadata excluded
+        /// @return The size in bytes
+        const size_t GetMemoryUsage() const;
+        /// @brief Get an estimation of the memory used by the metadata values of this entity.
+        /// Values kept in their network form count the whole metadata packet once
+        /// @return The size in bytes
+        const size_t GetMetadataMemoryUsage() const;
 #if USE_GUI
         const std::vector<Renderer::Face>& GetFaces();
         bool GetAreRenderedFacesUpToDate() const;
@@ -111,6 +122,7 @@ namespace Botcraft
 
         // Generic properties setter
         void SetEntityID(const int entity_id_);
+        void SetUUID(const ProtocolCraft::UUID& uuid_);
         virtual void SetPosition(const Vector3<double>& position_);
         virtual void SetX(const double x_);
         virtual void SetY(const double y_);
@@ -177,9 +189,13 @@ namespace Botcraft
         virtual bool IsThrowableProjectile() const;
 
         // Factory stuff
-        static std::shared_ptr<Entity> CreateEntity(const EntityType type);
+        /// @brief Create a new entity of a given type
+        /// @param type Type of the entity
+        /// @param pooled If true, the entity is allocated in a process-wide pool. When
+        /// destroyed, its memory is kept to be reused by the next entity of the same type
+        static std::shared_ptr<Entity> CreateEntity(const EntityType type, const bool pooled = false);
 #if PROTOCOL_VERSION < 458
-        static std::shared_ptr<Entity> CreateObjectEntity(const ObjectEntityType type);
+        static std::shared_ptr<Entity> CreateObjectEntity(const ObjectEntityType type, const bool pooled = false);
 #endif
     
     protected:
@@ -187,8 +203,31 @@ namespace Botcraft
         virtual void InitializeFaces();
 #endif
 
+        /// @brief Get a metadata value, decoding it first if it was
+        /// kept in its network form by LoadMetadataFromRawArray
+        /// @param index Index of the metadata
+        /// @return The decoded value
+        const std::any& GetMetadata(const int index) const;
+
+    private:
+        /// @brief Metadata value kept in its network form until first access
+        struct RawMetadata
+        {
+            int type;
+            std::shared_ptr<const std::vector<unsigned char> > data;
+            size_t offset;
+        };
+
+        /// @brief Decode a metadata value
+        /// @return The value, empty if type is unknown
+        static std::any ReadMetadataValue(const int type, ProtocolCraft::ReadIterator& iter, size_t& length);
+        /// @brief Move iter after a metadata value if it is expensive enough to be decoded lazily
+        /// @return True if the value has been skipped, false if iter wasn't moved
+        static bool SkipMetadataValue(const int type, ProtocolCraft::ReadIterator& iter, size_t& length);
+
     protected:
         int entity_id;
+        ProtocolCraft::UUID uuid;
         Vector3<double> position;
         float yaw;
         float pitch;
@@ -196,7 +235,18 @@ namespace Botcraft
         bool on_ground;
         std::map<EquipmentSlot, ProtocolCraft::Slot> equipments;
 
-        std::map<std::string, std::any> metadata;
+        // Metadata values, indexed like in the network format. Slots, chats and
+        // NBT can be stored as RawMetadata, use GetMetadata to read them
+        mutable std::vector<std::any> metadata;
+
+    private:
+        friend class EntityKinematicsTable;
+        // If not nullptr, position, yaw, pitch and on_ground
+        // are mirrored in this table each time they are set
+        EntityKinematicsTable* kinematics_table;
+        int kinematics_row;
+
+    protected:
 
 #if USE_GUI
         //All the faces of this model
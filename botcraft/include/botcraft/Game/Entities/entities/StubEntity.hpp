@@ -0,0 +1,29 @@
+#pragma once
+
+#include "botcraft/Game/Entities/entities/Entity.hpp"
+
+namespace Botcraft
+{
+    /// @brief Minimal entity used by EntityManager for entities tracked
+    /// as stubs. Only id, position and orientation are kept up to date,
+    /// metadata and equipment are never loaded. GetType returns
+    /// EntityType::None so a stub is never mistaken for (and cast to)
+    /// the real entity class, use GetStubbedType to get the real type
+    class StubEntity : public Entity
+    {
+    public:
+        StubEntity(const EntityType stubbed_type_);
+        virtual ~StubEntity();
+
+        // Object related stuff
+        virtual std::string GetName() const override;
+        virtual EntityType GetType() const override;
+        virtual double GetWidth() const;
+        virtual double GetHeight() const;
+
+        EntityType GetStubbedType() const;
+
+    private:
+        EntityType stubbed_type;
+    };
+}
@@ -70,6 +70,44 @@ namespace Botcraft
         Leaves
     };
 
+    /// @brief Precomputed blockstate properties, see AssetsManager::GetBlockstateFlags
+    enum class BlockstateFlag : unsigned short
+    {
+        None        = 0,
+        Air         = 1 << 0,
+        Solid       = 1 << 1,
+        Transparent = 1 << 2,
+        Fluid       = 1 << 3,
+        Water       = 1 << 4,
+        Lava        = 1 << 5,
+        Climbable   = 1 << 6,
+        Hazardous   = 1 << 7,
+        FullCube    = 1 << 8  // Solid, with a 1x1x1 collider
+    };
+
+    /// @brief Chunk heightmaps, see Chunk::GetHighestBlock
+    enum class HeightmapType
+    {
+        /// @brief Highest non-air block
+        WorldSurface = 0,
+        /// @brief Highest solid or fluid block
+        MotionBlocking = 1
+    };
+
+    /// @brief Kinds of block entities with dedicated accessors in Chunk
+    enum class BlockEntityType : unsigned char
+    {
+        /// @brief No block entity at this position
+        None,
+        Other,
+        /// @brief Chests, trapped chests and barrels
+        Chest,
+        Sign,
+        /// @brief Furnaces, blast furnaces and smokers
+        Furnace,
+        Spawner
+    };
+
     enum class Orientation
     {
         None = -1,
@@ -156,4 +194,72 @@ namespace Botcraft
         ChestPlate,
         Helmet
     };
+
+    enum class EntityTrackingMode
+    {
+        Full,    // Entity is fully tracked
+        Stub,    // Only id, position and orientation are tracked
+        Ignored  // Entity is not tracked at all
+    };
+
+    // Same ids as in the protocol, see https://wiki.vg/Protocol#Entity_Effect
+    enum class EffectType
+    {
+        Speed = 1,
+        Slowness,
+        Haste,
+        MiningFatigue,
+        Strength,
+        InstantHealth,
+        InstantDamage,
+        JumpBoost,
+        Nausea,
+        Regeneration,
+        Resistance,
+        FireResistance,
+        WaterBreathing,
+        Invisibility,
+        Blindness,
+        NightVision,
+        Hunger,
+        Weakness,
+        Poison,
+        Wither,
+        HealthBoost,
+        Absorption,
+        Saturation,
+        Glowing,
+        Levitation,
+        Luck,
+        Unluck,
+        SlowFalling,
+        ConduitPower,
+        DolphinsGrace,
+        BadOmen,
+        HeroOfTheVillage,
+        Darkness
+    };
+
+    enum class ToolType
+    {
+        None,
+        Axe,
+        Hoe,
+        Pickaxe,
+        Shears,
+        Shovel,
+        Sword
+    };
+
+    // Sorted by harvest level
+    enum class ToolMaterial
+    {
+        None,
+        Wood,
+        Gold,
+        Stone,
+        Iron,
+        Diamond,
+        Netherite
+    };
 } // Botcraft
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Botcraft
+{
+    /// @brief Game state changes a behaviour can wait for
+    enum class EventType
+    {
+        /// @brief A container window has been opened (InventoryManager)
+        WindowOpened,
+        /// @brief A container window has been closed (InventoryManager)
+        WindowClosed,
+        /// @brief A slot, the cursor or the selected hotbar slot changed (InventoryManager)
+        InventoryChanged,
+        /// @brief A transaction has been accepted or refused by the server (InventoryManager)
+        TransactionUpdated,
+        /// @brief A block has been modified (World)
+        BlockChanged,
+        /// @brief A chunk has been loaded (World)
+        ChunkLoaded,
+        /// @brief A chunk has been unloaded (World)
+        ChunkUnloaded,
+        /// @brief An entity has been added (EntityManager)
+        EntityAdded,
+        /// @brief An entity has been removed (EntityManager)
+        EntityRemoved,
+        NUM_EVENT_TYPES
+    };
+
+    /// @brief A set of event counters, incremented by a manager each time
+    /// an event happens. Waiting code compares the counters instead of
+    /// polling the state. Thread-safe.
+    class EventNotifier
+    {
+    public:
+        EventNotifier();
+
+        /// @brief Signal an event. Must be called *after* the state is updated
+        /// @param type The event type
+        void Notify(const EventType type);
+
+        /// @brief Get the number of events of a given type since creation
+        /// @param type The event type
+        /// @return The event counter
+        const unsigned long long GetCount(const EventType type) const;
+
+    private:
+        std::array<std::atomic<unsigned long long>, static_cast<size_t>(EventType::NUM_EVENT_TYPES)> counts;
+    };
+} // Botcraft
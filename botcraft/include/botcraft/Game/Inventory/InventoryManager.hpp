@@ -3,10 +3,17 @@
 #include <memory>
 #include <map>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "protocolCraft/Types/Slot.hpp"
 #include "protocolCraft/Handler.hpp"
 
 #include "botcraft/Game/Enums.hpp"
+#include "botcraft/Game/EventNotifier.hpp"
+#include "botcraft/Game/Inventory/InventorySnapshot.hpp"
+#include "botcraft/Game/Inventory/RecipeBook.hpp"
+#include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
 
 namespace Botcraft
 {
@@ -25,9 +32,30 @@ namespace Botcraft
 #if PROTOCOL_VERSION < 755
         std::map<short, ProtocolCraft::Slot> changed_slots;
         ProtocolCraft::Slot carried_item;
+        // If true, the transaction has been applied when sent,
+        // and previous_slots/previous_carried_item are used to
+        // roll it back if the server refuses it
+        bool optimistic = false;
+        std::map<short, ProtocolCraft::Slot> previous_slots;
+        ProtocolCraft::Slot previous_carried_item;
+        // Order in which the transactions were added to the pending ones,
+        // as uids are shorts and wrap around
+        unsigned long long sequence = 0;
 #endif
     };
 
+#if PROTOCOL_VERSION > 451
+    /// @brief Last offers seen for a villager or a wandering trader
+    struct MerchantOffers
+    {
+        std::vector<ProtocolCraft::Trade> offers;
+        /// @brief False for wandering traders, whose locked offers are never unlocked
+        bool can_restock = true;
+        /// @brief When the offers were received, or last used
+        VirtualClock::time_point update_time;
+    };
+#endif
+
     class Window;
 
     class InventoryManager : public ProtocolCraft::Handler
@@ -36,6 +64,20 @@ namespace Botcraft
         InventoryManager();
 
         std::mutex& GetMutex();
+        /// @brief Get the notifier signaled when this manager state changes
+        const EventNotifier& GetEventNotifier() const;
+
+        /// @brief Get a number changing each time a window is opened or closed,
+        /// or a slot, the cursor or the selected hotbar slot changes. Lock-free,
+        /// can be compared to the epoch of a snapshot to know if it's still up to date
+        const unsigned long long GetVersion() const;
+
+        /// @brief Get a read-only copy of the opened windows, the cursor and
+        /// the selected hotbar slot, that can be read without locking the
+        /// inventory manager mutex. A new copy is only made if something
+        /// changed since the last call. Inventory manager mutex must NOT
+        /// be locked by the caller
+        const InventorySnapshot GetSnapshot();
 
         const std::shared_ptr<Window> GetWindow(const short window_id) const;
         const short GetFirstOpenedWindowId() const;
@@ -44,12 +86,21 @@ namespace Botcraft
         std::shared_ptr<Window> GetPlayerInventory();
         const short GetIndexHotbarSelected() const;
         const ProtocolCraft::Slot& GetHotbarSelected() const;
+        /// @brief Set the selected hotbar slot locally, the server must be notified separately
+        void SetHotbarSelected(const short index);
         const ProtocolCraft::Slot& GetOffHand() const;
         const ProtocolCraft::Slot& GetCursor() const;
         void EraseInventory(const short window_id);
 #if PROTOCOL_VERSION < 755
         const TransactionState GetTransactionState(const short window_id, const int transaction_id);
         void AddPendingTransaction(const InventoryTransaction& transaction);
+        /// @brief Apply a transaction right away and add it to the pending
+        /// ones, without waiting for the server confirmation. If the server
+        /// refuses it, this transaction and all the following pending ones
+        /// in the same container are rolled back
+        /// @param transaction The transaction, as returned by PrepareTransaction
+        /// @return False if the container is not opened, nothing is applied nor added then
+        const bool AddOptimisticTransaction(const InventoryTransaction& transaction);
 #endif
         /// @brief "think" about the changes made by this transaction, filling in the necessary values in the msg
         /// @param transaction The transaction to update with the modifications
@@ -59,13 +110,59 @@ namespace Botcraft
         /// @brief Apply a given transaction to a container
         /// @param transaction The transaction to apply
         void ApplyTransaction(const InventoryTransaction& transaction);
+
+        /// @brief Set the position of the container block the next opened window belongs to,
+        /// so its content is remembered in the known containers. The server doesn't send it
+        /// @param pos Position of the container block
+        void SetNextContainerPosition(const Position& pos);
+        /// @brief Get the last content seen in each container opened with a known position.
+        /// Entries are removed when the container or a block next to it (comparator, second
+        /// half of a double chest...) changes, or when someone else opens it.
+        /// Mutex must be locked by the caller
+        /// @return Container position --> container slots (without the player inventory part)
+        const std::unordered_map<Position, std::map<short, ProtocolCraft::Slot> >& GetKnownContainers() const;
+        /// @brief Get the known containers with a given item inside, without opening them.
+        /// Mutex must be locked by the caller
+        /// @return The container positions, sorted by number of this item, most first
+#if PROTOCOL_VERSION < 350
+        const std::vector<Position> GetKnownContainersWithItem(const short block_id, const short item_damage) const;
+#else
+        const std::vector<Position> GetKnownContainersWithItem(const short item_id) const;
+#endif
+        /// @brief Remove the known content of a container
+        void ForgetContainer(const Position& pos);
+        /// @brief Set the known content of a container, seen by another bot
+        /// @param pos Position of the container block
+        /// @param content Container slots (without the player inventory part)
+        void SetKnownContainer(const Position& pos, const std::map<short, ProtocolCraft::Slot>& content);
+
+#if PROTOCOL_VERSION > 347
+        /// @brief Get the crafting recipes sent by the server
+        const RecipeBook& GetRecipeBook() const;
+#endif
 #if PROTOCOL_VERSION > 451
         const std::vector<ProtocolCraft::Trade>& GetAvailableTrades() const;
         ProtocolCraft::Trade& GetAvailableTrade(const int index);
+        /// @brief Count one use of a trade of the opened trading window,
+        /// in the available trades and in the known merchant offers
+        /// @param index Index of the trade in the available trades
+        void UseAvailableTrade(const int index);
+
+        /// @brief Set the entity the next merchant offers belong to, so they are remembered
+        /// in the known merchants. The server doesn't send it. Set by InteractEntity
+        /// @param uuid UUID of the villager or the wandering trader
+        void SetNextMerchant(const ProtocolCraft::UUID& uuid);
+        /// @brief Get the last offers seen for each merchant, updated each time its trading
+        /// window is opened. Mutex must be locked by the caller
+        /// @return Merchant UUID --> offers
+        const std::map<ProtocolCraft::UUID, MerchantOffers>& GetKnownMerchants() const;
+        /// @brief Remove the known offers of a merchant
+        void ForgetMerchant(const ProtocolCraft::UUID& uuid);
+        /// @brief Set the known offers of a merchant, seen by another bot
+        void SetKnownMerchant(const ProtocolCraft::UUID& uuid, const MerchantOffers& offers);
 #endif
 
     private:
-        void SetHotbarSelected(const short index);
         void SetCursor(const ProtocolCraft::Slot& c);
 
         void AddInventory(const short window_id, const InventoryType window_type);
@@ -76,6 +173,32 @@ namespace Botcraft
 #if PROTOCOL_VERSION > 755
         void SetStateId(const short window_id, const int state_id);
 #endif
+        /// @brief Copy the container part of a window in the known containers, if its position is known
+        void RememberContainerContent(const short window_id);
+        /// @brief Remove the known containers at pos and next to it
+        void InvalidateContainersAround(const Position& pos);
+
+    public:
+        /// @brief All the message types processed by InventoryManager
+        using HandledMessages = std::tuple<
+            ProtocolCraft::ClientboundContainerSetSlotPacket,
+            ProtocolCraft::ClientboundContainerSetContentPacket,
+            ProtocolCraft::ClientboundOpenScreenPacket,
+            ProtocolCraft::ClientboundSetCarriedItemPacket,
+#if PROTOCOL_VERSION < 755
+            ProtocolCraft::ClientboundContainerAckPacket,
+#endif
+#if PROTOCOL_VERSION > 451
+            ProtocolCraft::ClientboundMerchantOffersPacket,
+#endif
+#if PROTOCOL_VERSION > 347
+            ProtocolCraft::ClientboundUpdateRecipesPacket,
+#endif
+            ProtocolCraft::ClientboundContainerClosePacket,
+            ProtocolCraft::ClientboundBlockUpdatePacket,
+            ProtocolCraft::ClientboundSectionBlocksUpdatePacket,
+            ProtocolCraft::ClientboundBlockEventPacket
+        >;
 
     private:
 
@@ -89,16 +212,38 @@ namespace Botcraft
 #endif
 #if PROTOCOL_VERSION > 451
         virtual void Handle(ProtocolCraft::ClientboundMerchantOffersPacket& msg) override;
+#endif
+#if PROTOCOL_VERSION > 347
+        virtual void Handle(ProtocolCraft::ClientboundUpdateRecipesPacket& msg) override;
 #endif
         virtual void Handle(ProtocolCraft::ClientboundContainerClosePacket& msg) override;
+        virtual void Handle(ProtocolCraft::ClientboundBlockUpdatePacket& msg) override;
+        virtual void Handle(ProtocolCraft::ClientboundSectionBlocksUpdatePacket& msg) override;
+        virtual void Handle(ProtocolCraft::ClientboundBlockEventPacket& msg) override;
 
         void ApplyTransactionInternal(const InventoryTransaction& transaction);
+#if PROTOCOL_VERSION < 755
+        /// @brief Undo a refused optimistic transaction and all the pending
+        /// optimistic ones sent after it in the same container
+        void RollbackTransactions(const short window_id, const short uid);
+#endif
 
     private:
         std::mutex inventory_manager_mutex;
+        EventNotifier event_notifier;
         std::map<short, std::shared_ptr<Window> > inventories;
         short index_hotbar_selected;
         ProtocolCraft::Slot cursor;
+        /// @brief Last snapshot made, with GetVersion as epoch
+        std::shared_ptr<const InventorySnapshot::Data> snapshot;
+
+        /// @brief Container block position set before opening it, for the next opened window
+        Position next_container_position;
+        bool has_next_container_position;
+        /// @brief Window id --> position of the container block, for the opened containers
+        std::map<short, Position> container_positions;
+        /// @brief Last content seen in each container
+        std::unordered_map<Position, std::map<short, ProtocolCraft::Slot> > known_containers;
 
 #if PROTOCOL_VERSION < 755
         // Storing all the transactions that have neither been accepted
@@ -106,10 +251,24 @@ namespace Botcraft
         std::map<short, std::map<short, InventoryTransaction > > pending_transactions;
         // Storing the old transactions (accepted/refused) for all opened windows
         std::map<short, std::map<short, TransactionState> > transaction_states;
+        // Sequence of the last transaction added to the pending ones
+        unsigned long long transaction_sequence;
+#endif
+#if PROTOCOL_VERSION > 347
+        RecipeBook recipe_book;
 #endif
 #if PROTOCOL_VERSION > 451
         int trading_container_id;
         std::vector<ProtocolCraft::Trade> available_trades;
+
+        /// @brief Merchant set before interacting with it, for the next offers
+        ProtocolCraft::UUID next_merchant;
+        bool has_next_merchant;
+        /// @brief Merchant of the opened trading window
+        ProtocolCraft::UUID trading_merchant;
+        bool has_trading_merchant;
+        /// @brief Last offers seen for each merchant
+        std::map<ProtocolCraft::UUID, MerchantOffers> known_merchants;
 #endif
     };
 } // Botcraft
\ No newline at end of file
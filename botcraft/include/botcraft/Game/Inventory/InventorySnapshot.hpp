@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include "protocolCraft/Types/Slot.hpp"
+
+namespace Botcraft
+{
+    class Window;
+
+    /// @brief A read-only copy of the opened windows, the cursor and the
+    /// selected hotbar slot at a given time. A snapshot is never modified,
+    /// so it can be read without locking the inventory manager mutex while
+    /// the network thread keeps updating the inventory.
+    class InventorySnapshot
+    {
+    public:
+        struct Data
+        {
+            std::map<short, std::shared_ptr<const Window> > windows;
+            short index_hotbar_selected = 0;
+            ProtocolCraft::Slot cursor;
+            unsigned long long epoch = 0;
+        };
+
+        InventorySnapshot(const std::shared_ptr<const Data>& data_);
+
+        /// @brief Get the epoch of this snapshot. Two snapshots
+        /// with the same epoch hold exactly the same state
+        const unsigned long long GetEpoch() const;
+
+        /// @brief Get a window of the snapshot
+        /// @param window_id Id of the window
+        /// @return The window, nullptr if it was not opened
+        const std::shared_ptr<const Window> GetWindow(const short window_id) const;
+        const std::shared_ptr<const Window> GetPlayerInventory() const;
+        const short GetFirstOpenedWindowId() const;
+        const short GetIndexHotbarSelected() const;
+        const ProtocolCraft::Slot& GetHotbarSelected() const;
+        const ProtocolCraft::Slot& GetOffHand() const;
+        const ProtocolCraft::Slot& GetCursor() const;
+
+    private:
+        std::shared_ptr<const Data> data;
+    };
+} // Botcraft
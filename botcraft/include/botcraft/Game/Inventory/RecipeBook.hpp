@@ -0,0 +1,72 @@
+#pragma once
+
+#if PROTOCOL_VERSION > 347
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "protocolCraft/Types/Recipes/Recipe.hpp"
+
+namespace Botcraft
+{
+    /// @brief A crafting table recipe, shaped or shapeless
+    struct CraftingRecipe
+    {
+        int output_id = -1;
+        int output_count = 1;
+        // Accepted item ids for each cell of a width x height grid (row major),
+        // an empty vector for an empty cell. For shapeless recipes, the cells
+        // are filled row major in the smallest grid that fits them
+        int width = 0;
+        int height = 0;
+        std::vector<std::vector<int> > ingredients;
+    };
+
+    /// @brief One step of a crafting plan: craft recipe count times with
+    /// the given grid (-1 for empty cells), as expected by Craft
+    struct CraftingStep
+    {
+        const CraftingRecipe* recipe = nullptr;
+        std::array<std::array<int, 3>, 3> inputs;
+        int count = 0;
+        bool needs_crafting_table = false;
+    };
+
+    /// @brief The crafting recipes of the server, indexed by output item.
+    /// Plans are computed from the current inventory, crafting the missing
+    /// intermediate items recursively
+    class RecipeBook
+    {
+    public:
+        /// @brief Replace all the known recipes, only crafting table recipes are kept
+        /// @param recipes Recipes as sent by the server
+        void LoadRecipes(const std::vector<ProtocolCraft::Recipe>& recipes);
+
+        /// @brief Get all the recipes crafting a given item, cheapest first
+        const std::vector<CraftingRecipe>& GetRecipes(const int item_id) const;
+
+        /// @brief Compute a list of crafts to get quantity item_id from the available items
+        /// @param item_id The item to craft
+        /// @param quantity How many we want
+        /// @param available Number of each item id available, updated with the plan consumptions and leftovers
+        /// @param allow_crafting_table If false, only 2x2 recipes are used
+        /// @param plan The steps to perform in order, the last one crafts item_id
+        /// @return True if a plan was found, false otherwise (plan and available are untouched then)
+        const bool ComputePlan(const int item_id, const int quantity, std::unordered_map<int, int>& available,
+            const bool allow_crafting_table, std::vector<CraftingStep>& plan) const;
+
+    private:
+        const int ComputeCost(const int item_id, std::unordered_set<int>& visiting);
+
+        const bool Solve(const int item_id, const int quantity, std::unordered_map<int, int>& available,
+            const bool allow_crafting_table, std::vector<CraftingStep>& plan, std::unordered_set<int>& visiting) const;
+
+    private:
+        std::unordered_map<int, std::vector<CraftingRecipe> > recipes;
+        // Memoized number of crafts needed to get an item from
+        // uncraftable ones, used to try the cheapest recipes first
+        std::unordered_map<int, int> costs;
+    };
+} // Botcraft
+#endif
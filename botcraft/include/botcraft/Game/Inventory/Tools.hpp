@@ -0,0 +1,81 @@
+#pragma once
+
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "botcraft/Game/Enums.hpp"
+
+#include "protocolCraft/Types/Slot.hpp"
+
+namespace Botcraft
+{
+    class Blockstate;
+
+    struct ToolInfo
+    {
+        ToolType type = ToolType::None;
+        ToolMaterial material = ToolMaterial::None;
+    };
+
+    /// @brief Get the tool type and material of an item
+    /// @param item_name Item name, e.g. "minecraft:stone_pickaxe"
+    /// @return The tool info, None/None if the item is not a tool
+    const ToolInfo GetToolInfo(const std::string& item_name);
+
+    /// @brief Get the tool type and material of the item in a slot
+    const ToolInfo GetToolInfo(const ProtocolCraft::Slot& slot);
+
+    /// @brief Get the efficiency enchantment level of the item in a slot
+    /// @return The efficiency level, 0 if not enchanted
+    const int GetEfficiencyLevel(const ProtocolCraft::Slot& slot);
+
+    /// @brief Memoized survival mining times, indexed by blockstate, tool
+    /// and status effects. As the assets don't have tool data, the best tool
+    /// of each block is guessed from its name the first time it's queried
+    class DigTimeTable
+    {
+    public:
+        static DigTimeTable& GetInstance();
+
+        DigTimeTable(const DigTimeTable&) = delete;
+        DigTimeTable& operator=(const DigTimeTable&) = delete;
+
+        /// @brief Get the time needed to break a block
+        /// @param blockstate The block to break
+        /// @param tool The tool used
+        /// @param efficiency Efficiency enchantment level of the tool
+        /// @param haste Haste effect level
+        /// @param mining_fatigue Mining fatigue effect level
+        /// @param on_ground Whether the player is on ground
+        /// @return Mining time in seconds, rounded up to a tick
+        const float GetMiningTime(const Blockstate* blockstate, const ToolInfo& tool, const int efficiency,
+            const int haste, const int mining_fatigue, const bool on_ground);
+
+    private:
+        DigTimeTable() = default;
+
+        struct Key
+        {
+            const Blockstate* blockstate;
+            ToolInfo tool;
+            int efficiency;
+            int haste;
+            int mining_fatigue;
+            bool on_ground;
+
+            bool operator==(const Key& other) const;
+        };
+
+        struct KeyHasher
+        {
+            size_t operator()(const Key& k) const;
+        };
+
+        const float ComputeMiningTime(const Key& key) const;
+
+    private:
+        std::shared_mutex mutex;
+        std::unordered_map<Key, float, KeyHasher> mining_times;
+    };
+} // Botcraft
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <map>
+#include <unordered_map>
+#include <vector>
+
 #include "protocolCraft/Types/Slot.hpp"
 #include "botcraft/Game/Enums.hpp"
 
@@ -23,9 +25,43 @@ namespace Botcraft
         Window(const InventoryType type_ = InventoryType::Default);
 
         const ProtocolCraft::Slot& GetSlot(const short index) const;
-        const std::map<short, ProtocolCraft::Slot>& GetSlots() const;
+        /// @brief Get all the slots, indexed by slot index. Empty until the
+        /// first slot is set, then sized to hold all the slots of this window type
+        const std::vector<ProtocolCraft::Slot>& GetSlots() const;
         const InventoryType GetType() const;
+        /// @brief Set the content of a slot. Item NBT is shared with all the
+        /// identical stacks already stored in any window, so copying slots
+        /// doesn't copy their NBT. Negative indices are ignored
         void SetSlot(const short index, const ProtocolCraft::Slot& slot);
+
+        /// @brief Get the indices of all the slots containing a given item,
+        /// without iterating over all the slots. Sorted by index
+#if PROTOCOL_VERSION < 350
+        const std::vector<short>& GetSlotsWithItem(const short block_id, const short item_damage) const;
+#else
+        const std::vector<short>& GetSlotsWithItem(const short item_id) const;
+#endif
+        /// @brief Get the total number of a given item in this window
+#if PROTOCOL_VERSION < 350
+        const int GetItemCount(const short block_id, const short item_damage) const;
+#else
+        const int GetItemCount(const short item_id) const;
+#endif
+        /// @brief Get the first slot containing a given item with an index >= start
+        /// @return The slot index, -1 if not found
+#if PROTOCOL_VERSION < 350
+        const short GetFirstSlotWithItem(const short block_id, const short item_damage, const short start = 0) const;
+#else
+        const short GetFirstSlotWithItem(const short item_id, const short start = 0) const;
+#endif
+
+        /// @brief Get the indices of all the known empty slots. Sorted by index
+        const std::vector<short>& GetFreeSlots() const;
+        /// @brief Get the first known empty slot with an index >= start
+        /// @return The slot index, -1 if not found
+        const short GetFirstFreeSlot(const short start = 0) const;
+        /// @brief Get the number of known empty slots with an index >= start
+        const int GetNumFreeSlots(const short start = 0) const;
 #if PROTOCOL_VERSION < 755
         const int GetNextTransactionId() const;
         void SetNextTransactionId(const int n);
@@ -36,8 +72,21 @@ namespace Botcraft
         const short GetFirstPlayerInventorySlot() const;
 
     private:
-        std::map<short, ProtocolCraft::Slot> slots;
+        static const int GetItemKey(const ProtocolCraft::Slot& slot);
+        /// @brief Get the number of slots of this window type, player inventory included
+        const short GetNumSlots() const;
+#if PROTOCOL_VERSION < 350
+        static const int GetItemKey(const short block_id, const short item_damage);
+#endif
+
+    private:
+        std::vector<ProtocolCraft::Slot> slots;
         InventoryType type;
+        // Sorted indices of the non empty slots and total count of each item,
+        // and sorted indices of the empty slots, kept up to date by SetSlot
+        std::unordered_map<int, std::vector<short> > item_slots;
+        std::unordered_map<int, int> item_counts;
+        std::vector<short> free_slots;
 
 #if PROTOCOL_VERSION < 755
         // TODO, need mutex to make this thread-safe?
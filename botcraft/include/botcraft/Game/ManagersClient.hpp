@@ -2,11 +2,15 @@
 
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
 
 #include "protocolCraft/Handler.hpp"
 #include "protocolCraft/Message.hpp"
 #include "protocolCraft/AllMessages.hpp"
 #include "botcraft/Game/Enums.hpp"
+#include "botcraft/Game/EventNotifier.hpp"
 #include "botcraft/Game/ConnectionClient.hpp"
 
 namespace Botcraft
@@ -15,11 +19,13 @@ namespace Botcraft
     class InventoryManager;
     class EntityManager;
     class PhysicsManager;
+    struct ClientMetrics;
 
 #if USE_GUI
     namespace Renderer
     {
         class RenderingManager;
+        class RenderingContextGroup;
     }
 #endif
     
@@ -35,25 +41,71 @@ namespace Botcraft
 
         virtual void Disconnect() override;
 
+        /// @brief Connect again to the same server, see ConnectionClient::Reconnect.
+        /// The World is kept as a stale cache, its chunks are replaced when the
+        /// server sends them again (or dropped if the player spawns in another
+        /// dimension). Other managers are recreated during login as in Connect
+        virtual void Reconnect() override;
+
         void SetSharedWorld(const std::shared_ptr<World> world_);
+        /// @brief Store the entities seen by this bot in a manager shared with other bots
+        /// connected to the same server, see EntityManager. Must be set before connecting
+        /// @param entity_manager_ The shared manager, created with the default constructor
+        void SetSharedEntityManager(const std::shared_ptr<EntityManager> entity_manager_);
+#if USE_GUI
+        /// @brief Share the atlas texture and the shaders of the renderer with the other
+        /// bots using the same group, see RenderingContextGroup. Must be set before connecting
+        /// @param context_group_ The group, nullptr for a renderer with its own objects
+        void SetRenderingContextGroup(const std::shared_ptr<Renderer::RenderingContextGroup> context_group_);
+#endif
 
         const bool GetAutoRespawn() const;
         void SetAutoRespawn(const bool b);
 
+        /// @brief Apply the entity movement packets directly to the EntityManager,
+        /// see NetworkManager::SetEntityMovementFastPath. Handle is then NOT called
+        /// for these packets, don't enable it if your client overrides them.
+        /// Ignored if the renderer is used. Must be set before connecting
+        /// @param b True to enable the fast path
+        void SetEntityMovementFastPath(const bool b);
+
         // Set the right transaction id, add it to the inventory manager,
         // update the next transaction id and send it to the server
-        // return the id of the transaction
-        const int SendInventoryTransaction(const std::shared_ptr<ProtocolCraft::ServerboundContainerClickPacket>& transaction);
+        // return the id of the transaction. If optimistic is true, the
+        // transaction is applied right away instead of when confirmed
+        // by the server, and rolled back if refused (< 1.17 only, 1.17+
+        // transactions are always applied right away)
+        const int SendInventoryTransaction(const std::shared_ptr<ProtocolCraft::ServerboundContainerClickPacket>& transaction, const bool optimistic = false);
 
         std::shared_ptr<World> GetWorld() const;
         std::shared_ptr<EntityManager> GetEntityManager() const;
         std::shared_ptr<InventoryManager> GetInventoryManager() const;
         const bool GetCreativeMode() const;
 
+        /// @brief Get the number of events of a given type received by
+        /// the manager in charge of it (see EventType)
+        /// @param type The event type
+        /// @return The event counter, 0 if the manager doesn't exist yet
+        const unsigned long long GetEventCount(const EventType type) const;
+
+        /// @brief Get the network traffic, world and entities counters of this bot
+        /// @return The current values, see ClientMetrics and MetricsToPrometheus
+        virtual ClientMetrics GetMetrics();
+
         /// @brief Get the current tick
         /// @return An int representing the time of day
         const int GetDayTime() const;
 
+        /// @brief Set the view distance used when no task asks for more (see ScopedViewDistance).
+        /// A small value saves bandwidth, chunk decoding and memory for idle bots
+        /// @param view_distance_ View distance sent to the server, in chunks
+        /// @param interest_radius_ Chunks further than this from the player chunk are dropped
+        /// locally (1.14+, not for shared worlds), negative to keep all the chunks sent by the server
+        void SetViewDistance(const int view_distance_, const int interest_radius_ = -1);
+
+        /// @brief Get the view distance currently sent to the server, in chunks
+        const int GetViewDistance() const;
+
     protected:
         virtual void Handle(ProtocolCraft::Message &msg) override;
         virtual void Handle(ProtocolCraft::ClientboundGameProfilePacket &msg) override;
@@ -63,21 +115,44 @@ namespace Botcraft
         virtual void Handle(ProtocolCraft::ClientboundPlayerAbilitiesPacket &msg) override;
         virtual void Handle(ProtocolCraft::ClientboundRespawnPacket &msg) override;
         virtual void Handle(ProtocolCraft::ClientboundSetTimePacket& msg) override;
+#if PROTOCOL_VERSION < 757
+        virtual void Handle(ProtocolCraft::ClientboundLevelChunkPacket& msg) override;
+#else
+        virtual void Handle(ProtocolCraft::ClientboundLevelChunkWithLightPacket& msg) override;
+#endif
+
+    private:
+        friend class ScopedViewDistance;
+
+        /// @brief Record a chunk received during startup, and log the
+        /// startup timings once all the chunks in view are received
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        void OnStartupChunk(const int x, const int z);
+
+        /// @brief Send the client settings to the server
+        void SendClientInformation();
+        /// @brief Compute the view distance and interest radius from the base values
+        /// and the requests, and apply them if they changed
+        void UpdateViewDistance();
 
     protected:
         std::shared_ptr<World> world;
         std::shared_ptr<EntityManager> entity_manager;
+        /// @brief If not null, entity_manager stores its entities in this one
+        std::shared_ptr<EntityManager> shared_entity_manager;
         std::shared_ptr<InventoryManager> inventory_manager;
         std::shared_ptr<PhysicsManager> physics_manager;
 #if USE_GUI
         // If true, opens a window to display the view
-        // from the bot. Only one renderer can be active
-        // at the same time
+        // from the bot
         bool use_renderer;
         std::shared_ptr<Renderer::RenderingManager> rendering_manager;
+        std::shared_ptr<Renderer::RenderingContextGroup> rendering_context_group;
 #endif
 
         bool auto_respawn;
+        bool entity_movement_fast_path;
 
         GameType game_mode;
 
@@ -90,5 +165,44 @@ namespace Botcraft
 
         bool allow_flying;
         bool creative_mode; // Instant break
+
+    private:
+        mutable std::mutex view_distance_mutex;
+        /// @brief View distance and interest radius used without any request
+        int base_view_distance;
+        int base_interest_radius;
+        /// @brief View distances asked by the alive ScopedViewDistance
+        std::multiset<int> view_distance_requests;
+        /// @brief Currently applied values
+        int view_distance;
+        int interest_radius;
+        /// @brief True once the client settings have been sent in this connection
+        bool client_information_sent;
+
+        // Startup report, only used by the packets processing thread
+        /// @brief View distance of the server, -1 if unknown
+        int server_view_distance;
+        std::chrono::steady_clock::time_point first_chunk_time;
+        /// @brief Chunks received since the login, cleared once all the chunks in view are there
+        std::set<std::pair<int, int> > startup_chunks;
+        bool startup_reported;
+    };
+
+    /// @brief Raise the view distance of a client while alive, for tasks
+    /// that need to see far (pathfinding...). The client uses the highest
+    /// distance between its base one and all the alive requests, and go
+    /// back to its base one when they are all destroyed
+    class ScopedViewDistance
+    {
+    public:
+        ScopedViewDistance(ManagersClient& client_, const int view_distance_);
+        ~ScopedViewDistance();
+
+        ScopedViewDistance(const ScopedViewDistance&) = delete;
+        ScopedViewDistance& operator=(const ScopedViewDistance&) = delete;
+
+    private:
+        ManagersClient& client;
+        const int view_distance;
     };
 } //Botcraft
@@ -8,6 +8,7 @@
 #include <deque>
 
 #include "botcraft/Game/AABB.hpp"
+#include "protocolCraft/BinaryReadWrite.hpp"
 #if USE_GUI
 #include "botcraft/Game/Enums.hpp"
 #include "botcraft/Renderer/Transformation.hpp"
@@ -56,16 +57,48 @@ namespace Botcraft
         }
 
         const std::vector<AABB> &GetColliders() const;
-        std::vector<AABB> &GetColliders();
+        void SetColliders(const std::vector<AABB>& colliders);
+        /// @brief Get the id of the colliders shape of this model in the global shapes table
+        /// @return The shape id, 0 is the empty shape
+        const unsigned short GetCollidersId() const;
+
+        /// @brief Get the id of a colliders shape, adding it to the global table if it's a new one.
+        /// The shapes are only added while loading the assets, all the models sharing the same
+        /// colliders get the same id
+        /// @param colliders The colliders of the shape
+        /// @return The shape id
+        static const unsigned short GetCollidersId(const std::vector<AABB>& colliders);
+        /// @brief Get a colliders shape from the global table
+        /// @param colliders_id A shape id returned by GetCollidersId
+        /// @return The colliders of this shape
+        static const std::vector<AABB>& GetColliders(const unsigned short colliders_id);
+        /// @brief Get the number of different colliders shapes
+        static const size_t GetNumCollidersShapes();
 
         static void ClearCache();
 
+        /// @brief Serialize the collision data of this model, the rendering data are not saved
+        /// @param container Container to append the data to
+        void Write(ProtocolCraft::WriteContainer& container) const;
+
+        /// @brief Create a model from data previously created by Write
+        /// @param iter Data to read
+        /// @param length Size of the remaining data
+        /// @return The model, without rendering data. Throws a std::runtime_error if data are invalid
+        static Model Read(ProtocolCraft::ReadIterator& iter, size_t& length);
+
 #if USE_GUI
         const std::vector<FaceDescriptor> &GetFaces() const;
         std::vector<FaceDescriptor> &GetFaces();
+        /// @brief Remove the faces and textures data, only keeping the colliders
+        void ClearRenderingData();
 #endif
     private:
         static std::unordered_map<std::string, Model> cached_models;
+        // Deque so the references to the shapes stay valid when new ones are added
+        static std::deque<std::vector<AABB> > colliders_shapes;
+        // Flattened centers and half sizes --> shape id
+        static std::map<std::vector<double>, unsigned short> colliders_shapes_ids;
 
         bool ambient_occlusion;
 
@@ -76,6 +109,6 @@ namespace Botcraft
         //All the faces of this model
         std::vector<FaceDescriptor> faces;
 #endif
-        std::vector<AABB> colliders;
+        unsigned short colliders_id;
     };
 } // Botcraft
\ No newline at end of file
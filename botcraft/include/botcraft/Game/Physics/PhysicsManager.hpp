@@ -1,13 +1,31 @@
 #pragma once
 
+#include <array>
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "botcraft/Game/AABB.hpp"
+#include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
+
+namespace ProtocolCraft
+{
+    class ServerboundMovePlayerPacketPos;
+    class ServerboundMovePlayerPacketPosRot;
+    class ServerboundMovePlayerPacketRot;
+    class ServerboundMovePlayerPacketStatusOnly;
+}
 
 namespace Botcraft
 {
     class EntityManager;
+    class LocalPlayer;
     class World;
+    class WorldSnapshot;
     class NetworkManager;
 #if USE_GUI
     namespace Renderer
@@ -16,6 +34,34 @@ namespace Botcraft
     }
 #endif
 
+    /// @brief Kinematic state of a player used by the physics
+    struct PlayerPhysicsState
+    {
+        Vector3<double> position;
+        Vector3<double> speed;
+        bool on_ground = false;
+    };
+
+    struct PhysicsStats
+    {
+        /// @brief Number of jitter buckets, the last one has no upper bound
+        static constexpr size_t num_jitter_buckets = 8;
+        /// @brief Upper bound of the first num_jitter_buckets - 1 buckets, in ms
+        static constexpr double jitter_buckets_ms[num_jitter_buckets - 1] = { 0.1, 0.25, 0.5, 1.0, 2.0, 5.0, 10.0 };
+
+        /// @brief Number of ticks with a measured jitter
+        unsigned long long num_ticks = 0;
+        /// @brief Number of ticks in each jitter bucket. Jitter is the difference
+        /// between the time elapsed since the previous tick and the tick duration
+        unsigned long long jitter_counts[num_jitter_buckets] = {};
+        /// @brief Sum of the jitter of all the ticks, in ms
+        double total_jitter_ms = 0.0;
+        /// @brief Highest jitter, in ms
+        double max_jitter_ms = 0.0;
+        /// @brief Number of ticks skipped because the player was at rest
+        unsigned long long num_rest_ticks = 0;
+    };
+
     class PhysicsManager// : public ProtocolCraft::Handler // There is no physics related packets yet
     {
     public:
@@ -30,14 +76,83 @@ namespace Botcraft
         );
         ~PhysicsManager();
 
+        /// @brief Start the physics, on the shared PhysicsScheduler if enabled,
+        /// else on a dedicated thread
         void StartPhysics();
         void StopPhysics();
         void SetShouldFallInVoid(const bool b);
 
+        /// @brief Get the tick jitter metrics since the physics were started
+        const PhysicsStats GetStats() const;
+
+        /// @brief Run the local player physics (collisions, gravity and drag) on a given
+        /// state, without modifying the local player or sending anything to the server.
+        /// Uses a snapshot of the world, so it can be called from any thread
+        /// @param initial_state State of the player at the beginning of the simulation
+        /// @param inputs Player inputs (as set with LocalPlayer::SetPlayerInputs) for each tick, missing ones are null
+        /// @param n_ticks Number of physics ticks to simulate
+        /// @return The state after n_ticks, or when the player leaves the loaded chunks
+        const PlayerPhysicsState Simulate(const PlayerPhysicsState& initial_state, const std::vector<Vector3<double> >& inputs, const int n_ticks) const;
+
     private:
+        friend class PhysicsScheduler;
+        friend class PhysicsBatch;
+
+        /// @brief Local player state during a physics step, from
+        /// the copy of the player to the application of the result
+        struct PhysicsStep
+        {
+            std::shared_ptr<LocalPlayer> local_player;
+            PlayerPhysicsState initial_state;
+            /// @brief State after the collisions
+            PlayerPhysicsState state;
+            Vector3<double> inputs;
+            Vector3<double> half_size;
+            bool skip_step = false;
+            bool is_loaded = false;
+            bool is_in_fluid = false;
+            /// @brief If true, next_speed is the player speed after drag,
+            /// precomputed for a player with drag_speed and drag_on_ground
+            bool has_next_speed = false;
+            Vector3<double> drag_speed;
+            bool drag_on_ground = false;
+            Vector3<double> next_speed;
+        };
+
         void RunSyncPos();
-        void Physics(const bool is_in_fluid);
-        void UpdatePlayerSpeed() const;
+        /// @brief Compute one physics step and send the position to the server if needed
+        void Tick();
+        /// @brief Copy the local player state at the beginning of a step
+        /// @return False if there is nothing to compute this tick
+        const bool BeginStep(PhysicsStep& step);
+        /// @brief Check if the step can be skipped, and if the player is in a loaded fluid
+        void CheckStepWorld(const WorldSnapshot& world_snapshot, PhysicsStep& step) const;
+        /// @brief Apply the result of a step to the local player and send the position to the server if needed
+        void EndStep(const WorldSnapshot& world_snapshot, PhysicsStep& step);
+        /// @brief Add the time since the previous tick to the jitter stats
+        void RecordTickJitter();
+        /// @brief Apply drag to the local player speed and remove the inputs used by the step.
+        /// Player mutex must be locked by the caller
+        void UpdatePlayerSpeed(const PhysicsStep& step) const;
+
+        /// @brief Move a player state according to its speed and inputs, colliding with the world
+        /// @param colliders Buffer used to store the colliders around the player
+        void ApplyCollisions(PlayerPhysicsState& state, const Vector3<double>& inputs, const Vector3<double>& half_size,
+            const bool is_in_fluid, const WorldSnapshot& world_snapshot, std::vector<AABB>& colliders) const;
+        /// @brief Narrow phase of ApplyCollisions, once the box swept by the player is known
+        /// @param player_movement Movement of the player during this step
+        /// @param min_player_collider Min corner of the box swept by the player
+        /// @param max_player_collider Max corner of the box swept by the player
+        static void MoveAndCollide(PlayerPhysicsState& state, Vector3<double> player_movement, const Vector3<double>& half_size,
+            const Vector3<double>& min_player_collider, const Vector3<double>& max_player_collider,
+            const bool is_in_fluid, const WorldSnapshot& world_snapshot, std::vector<AABB>& colliders);
+        /// @brief Apply gravity and drag to the speed of a player state
+        static void ApplyDrag(PlayerPhysicsState& state);
+        /// @brief Get the blocks versions of the chunks under a player, to know if the blocks supporting it may have changed
+        static std::array<unsigned long long, 4> GetSupportVersions(const WorldSnapshot& world_snapshot, const Vector3<double>& position, const double half_width);
+        /// @brief Check if a position is loaded and in a fluid block
+        /// @return True if loaded, false otherwise
+        static const bool IsLoadedAndInFluid(const WorldSnapshot& world_snapshot, const Vector3<double>& position, bool& is_in_fluid);
 
     private:
 #if USE_GUI
@@ -52,5 +167,33 @@ namespace Botcraft
         bool should_fall_in_void;
 
         std::thread thread_physics;//Thread running to compute position and send it to the server every 50 ms (20 ticks/s)
+        bool use_scheduler;
+
+        VirtualClock::time_point last_send;
+        std::shared_ptr<ProtocolCraft::ServerboundMovePlayerPacketPos> msg_pos;
+        std::shared_ptr<ProtocolCraft::ServerboundMovePlayerPacketPosRot> msg_pos_rot;
+        std::shared_ptr<ProtocolCraft::ServerboundMovePlayerPacketRot> msg_rot;
+        std::shared_ptr<ProtocolCraft::ServerboundMovePlayerPacketStatusOnly> msg_status;
+        bool has_moved;
+
+        /// @brief Last state sent to the server, to only send what changed
+        Vector3<double> last_sent_position;
+        float last_sent_yaw;
+        float last_sent_pitch;
+        bool last_sent_on_ground;
+
+        /// @brief World-space colliders around the player, filled at each physics step
+        std::vector<AABB> collision_cache;
+
+        /// @brief True if the player landed at the previous step, with no speed nor input.
+        /// Steps are skipped until it moves or the chunks under it change
+        bool is_resting;
+        Vector3<double> rest_position;
+        std::array<unsigned long long, 4> rest_support_versions;
+
+        /// @brief Start of the previous tick, to measure the jitter
+        VirtualClock::time_point last_tick_start;
+        PhysicsStats stats;
+        mutable std::mutex stats_mutex;
     };
 } // Botcraft
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Botcraft
+{
+    class PhysicsManager;
+
+    struct PhysicsSchedulerStats
+    {
+        /// @brief Number of ticks run
+        unsigned long long num_ticks = 0;
+        /// @brief Number of ticks that took longer than the tick duration
+        unsigned long long num_overruns = 0;
+        /// @brief Number of ticks skipped to catch up after overruns
+        unsigned long long num_skipped_ticks = 0;
+        /// @brief Duration of the last tick, in ms
+        double last_tick_duration_ms = 0.0;
+        /// @brief Longest tick duration, in ms
+        double max_tick_duration_ms = 0.0;
+        /// @brief Number of managers stepped during the last tick
+        size_t num_managers = 0;
+        /// @brief Number of batches of managers stepped together during the last tick
+        size_t num_batches = 0;
+    };
+
+    /// @brief A process-wide scheduler running the physics of all the
+    /// registered PhysicsManager on a small pool of worker threads, at
+    /// 50 ms ticks aligned on the steady clock. Using it instead of one
+    /// physics thread per bot avoids hundreds of threads waking up
+    /// independently when running a lot of bots in the same process.
+    /// Disabled by default, call SetNumWorkers before starting the physics.
+    /// If AffinityGroups are set when the workers start, workers are split
+    /// between the groups, and step the managers registered from a thread
+    /// of their group first, before helping the other groups.
+    /// Managers using the same World can be stepped together, see SetBatchSize
+    class PhysicsScheduler
+    {
+    public:
+        static PhysicsScheduler& GetInstance();
+
+        PhysicsScheduler(const PhysicsScheduler&) = delete;
+        PhysicsScheduler& operator=(const PhysicsScheduler&) = delete;
+        PhysicsScheduler(PhysicsScheduler&&) = delete;
+        PhysicsScheduler& operator=(PhysicsScheduler&&) = delete;
+        ~PhysicsScheduler();
+
+        /// @brief Set the number of threads running the physics. Only applied
+        /// to PhysicsManager started after this call, and when no manager is
+        /// currently registered
+        /// @param n Number of worker threads, 0 to disable the scheduler and use one thread per PhysicsManager
+        void SetNumWorkers(const unsigned int n);
+        const unsigned int GetNumWorkers() const;
+        const bool IsEnabled() const;
+
+        /// @brief Step the managers using the same World (see ManagersClient::SetSharedWorld)
+        /// together, by batches of at most n managers. The players of a batch are moved
+        /// with the same world snapshot, and their broadphase and drag are computed in
+        /// vectorized loops. Applied from the next tick
+        /// @param n Max number of managers per batch, 0 or 1 to step each manager alone
+        void SetBatchSize(const size_t n);
+        const size_t GetBatchSize() const;
+
+        /// @brief Add a manager to step every tick. Worker threads are started
+        /// with the first registered manager
+        void Register(PhysicsManager* manager);
+
+        /// @brief Remove a manager from the scheduler. Blocks until the current
+        /// tick is over, so the manager is never stepped after this returns.
+        /// Worker threads are stopped with the last unregistered manager.
+        /// Must not be called from a physics step
+        void Unregister(PhysicsManager* manager);
+
+        /// @brief Get the tick metrics since the workers were started
+        const PhysicsSchedulerStats GetStats() const;
+
+    private:
+        PhysicsScheduler();
+
+        void Start();
+        void Stop();
+
+        /// @brief Wait for the ticks and dispatch them to the other workers
+        void RunTicker();
+        /// @brief Step managers of the current tick until there is none left
+        void RunWorker(const int group);
+        /// @brief Step managers of the current tick, called by all the threads.
+        /// Managers of the given group first, then the other ones
+        void StepManagers(const int group);
+        /// @brief Split a list of managers in batches of managers using the same World
+        /// @param list Managers, sorted so the ones of a batch are contiguous
+        /// @param batches Output, first manager and number of managers of each batch
+        void MakeBatches(std::vector<PhysicsManager*>& list, std::vector<std::pair<size_t, size_t> >& batches) const;
+
+    private:
+        static constexpr std::chrono::milliseconds tick_duration = std::chrono::milliseconds(50);
+
+        // Serialize Register/Unregister/SetNumWorkers
+        std::mutex lifecycle_mutex;
+        unsigned int num_workers;
+
+        // Lock order: managers_mutex, then tick_mutex
+        mutable std::mutex managers_mutex;
+        /// @brief Managers and the affinity group they were registered from
+        std::vector<std::pair<PhysicsManager*, int> > managers;
+        /// @brief Number of affinity groups when the workers were started, 0 if none
+        size_t num_groups;
+        size_t batch_size;
+
+        mutable std::mutex tick_mutex;
+        std::condition_variable tick_condition;
+        std::condition_variable done_condition;
+        bool running;
+        unsigned long long tick_index;
+        // Managers stepped during the current tick, one list per affinity group
+        std::vector<std::vector<PhysicsManager*> > tick_managers;
+        // Batches of tick_managers, stepped by one thread each
+        std::vector<std::vector<std::pair<size_t, size_t> > > tick_batches;
+        std::vector<size_t> next_batches;
+        size_t num_tick_managers;
+        size_t num_done;
+
+        PhysicsSchedulerStats stats;
+
+        std::thread ticker_thread;
+        std::vector<std::thread> worker_threads;
+    };
+} // Botcraft
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    /// @brief A block position packed in 64 bits, with the same layout as
+    /// the protocol positions: 26 bits for x and z, 12 bits for y. Covers
+    /// the whole world (+/- 33M blocks horizontally, +/- 2048 vertically)
+    struct PositionKey
+    {
+        uint64_t value;
+
+        PositionKey() : value(0)
+        {
+
+        }
+
+        explicit PositionKey(const Position& pos) :
+            value((static_cast<uint64_t>(pos.x) & 0x3FFFFFF) << 38 |
+                (static_cast<uint64_t>(pos.z) & 0x3FFFFFF) << 12 |
+                (static_cast<uint64_t>(pos.y) & 0xFFF))
+        {
+
+        }
+
+        const Position ToPosition() const
+        {
+            // Shift back to sign extend each component
+            return Position(
+                static_cast<int>(static_cast<int64_t>(value) >> 38),
+                static_cast<int>(static_cast<int64_t>(value << 52) >> 52),
+                static_cast<int>(static_cast<int64_t>(value << 26) >> 38)
+            );
+        }
+
+        /// @brief Mix all the bits of the key (murmur3 finalizer), so
+        /// neighbour positions are spread over the whole table
+        const size_t Hash() const
+        {
+            uint64_t h = value;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+
+        bool operator==(const PositionKey& other) const
+        {
+            return value == other.value;
+        }
+
+        bool operator!=(const PositionKey& other) const
+        {
+            return value != other.value;
+        }
+    };
+
+    /// @brief Hash map from block positions to T, with open addressing and
+    /// linear probing on packed keys. Faster than std::unordered_map<Position, T>
+    /// as there is no allocation per element and probing stays in cache.
+    /// Pointers to values are invalidated when an element is added or removed
+    template<class T>
+    class PositionMap
+    {
+    public:
+        PositionMap()
+        {
+            num_elements = 0;
+        }
+
+        const size_t Size() const
+        {
+            return num_elements;
+        }
+
+        const bool Empty() const
+        {
+            return num_elements == 0;
+        }
+
+        void Clear()
+        {
+            entries.clear();
+            used.clear();
+            num_elements = 0;
+        }
+
+        /// @brief Allocate enough space for n elements without rehashing
+        void Reserve(const size_t n)
+        {
+            size_t capacity = 16;
+            while (capacity < 2 * n)
+            {
+                capacity *= 2;
+            }
+            if (capacity > entries.size())
+            {
+                Rehash(capacity);
+            }
+        }
+
+        /// @brief Get the value of a position
+        /// @return A pointer to the value, nullptr if pos is not in the map
+        T* Find(const Position& pos)
+        {
+            const size_t slot = FindSlot(PositionKey(pos));
+            return slot == npos ? nullptr : &entries[slot].second;
+        }
+
+        const T* Find(const Position& pos) const
+        {
+            const size_t slot = FindSlot(PositionKey(pos));
+            return slot == npos ? nullptr : &entries[slot].second;
+        }
+
+        const bool Contains(const Position& pos) const
+        {
+            return FindSlot(PositionKey(pos)) != npos;
+        }
+
+        /// @brief Add a value if pos is not in the map yet
+        /// @return A pointer to the value of pos, and true if it has been added
+        std::pair<T*, bool> Insert(const Position& pos, const T& value)
+        {
+            if (2 * (num_elements + 1) > entries.size())
+            {
+                Rehash(entries.empty() ? 16 : 2 * entries.size());
+            }
+            const PositionKey key(pos);
+            const size_t mask = entries.size() - 1;
+            size_t slot = key.Hash() & mask;
+            while (used[slot])
+            {
+                if (entries[slot].first == key)
+                {
+                    return { &entries[slot].second, false };
+                }
+                slot = (slot + 1) & mask;
+            }
+            used[slot] = 1;
+            entries[slot] = { key, value };
+            num_elements += 1;
+            return { &entries[slot].second, true };
+        }
+
+        /// @brief Get the value of pos, added with its default value if needed
+        T& operator[](const Position& pos)
+        {
+            return *Insert(pos, T()).first;
+        }
+
+        /// @brief Remove a position from the map
+        /// @return True if it was in the map
+        bool Erase(const Position& pos)
+        {
+            size_t slot = FindSlot(PositionKey(pos));
+            if (slot == npos)
+            {
+                return false;
+            }
+
+            // Backward shift deletion, no tombstones needed
+            const size_t mask = entries.size() - 1;
+            size_t next = (slot + 1) & mask;
+            while (used[next])
+            {
+                const size_t ideal = entries[next].first.Hash() & mask;
+                // Move next into the hole if its probe sequence goes through it
+                if (((next - ideal) & mask) >= ((next - slot) & mask))
+                {
+                    entries[slot] = std::move(entries[next]);
+                    slot = next;
+                }
+                next = (next + 1) & mask;
+            }
+            used[slot] = 0;
+            entries[slot] = std::pair<PositionKey, T>();
+            num_elements -= 1;
+            return true;
+        }
+
+        /// @brief Call f(position, value) for all the elements, in no particular order
+        template<class F>
+        void ForEach(const F& f) const
+        {
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (used[i])
+                {
+                    f(entries[i].first.ToPosition(), entries[i].second);
+                }
+            }
+        }
+
+        /// @brief Call f(position, value) for all the elements, in no particular order
+        template<class F>
+        void ForEach(const F& f)
+        {
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (used[i])
+                {
+                    f(entries[i].first.ToPosition(), entries[i].second);
+                }
+            }
+        }
+
+    private:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        size_t FindSlot(const PositionKey& key) const
+        {
+            if (num_elements == 0)
+            {
+                return npos;
+            }
+            const size_t mask = entries.size() - 1;
+            size_t slot = key.Hash() & mask;
+            while (used[slot])
+            {
+                if (entries[slot].first == key)
+                {
+                    return slot;
+                }
+                slot = (slot + 1) & mask;
+            }
+            return npos;
+        }
+
+        void Rehash(const size_t capacity)
+        {
+            std::vector<std::pair<PositionKey, T> > old_entries(capacity);
+            std::vector<unsigned char> old_used(capacity, 0);
+            old_entries.swap(entries);
+            old_used.swap(used);
+
+            const size_t mask = capacity - 1;
+            for (size_t i = 0; i < old_entries.size(); ++i)
+            {
+                if (!old_used[i])
+                {
+                    continue;
+                }
+                size_t slot = old_entries[i].first.Hash() & mask;
+                while (used[slot])
+                {
+                    slot = (slot + 1) & mask;
+                }
+                used[slot] = 1;
+                entries[slot] = std::move(old_entries[i]);
+            }
+        }
+
+    private:
+        std::vector<std::pair<PositionKey, T> > entries;
+        /// @brief 1 if the slot at the same index in entries is used
+        std::vector<unsigned char> used;
+        size_t num_elements;
+    };
+
+    /// @brief Set of block positions, see PositionMap
+    class PositionSet
+    {
+    public:
+        const size_t Size() const
+        {
+            return positions.Size();
+        }
+
+        void Clear()
+        {
+            positions.Clear();
+        }
+
+        void Reserve(const size_t n)
+        {
+            positions.Reserve(n);
+        }
+
+        const bool Contains(const Position& pos) const
+        {
+            return positions.Contains(pos);
+        }
+
+        /// @return True if pos has been added, false if it was already there
+        bool Insert(const Position& pos)
+        {
+            return positions.Insert(pos, 0).second;
+        }
+
+        bool Erase(const Position& pos)
+        {
+            return positions.Erase(pos);
+        }
+
+        /// @brief Call f(position) for all the elements, in no particular order
+        template<class F>
+        void ForEach(const F& f) const
+        {
+            positions.ForEach([&f](const Position& pos, const char) { f(pos); });
+        }
+
+    private:
+        PositionMap<char> positions;
+    };
+} // Botcraft
+
+namespace std
+{
+    template <>
+    struct hash<Botcraft::PositionKey>
+    {
+        inline size_t operator()(const Botcraft::PositionKey& k) const
+        {
+            return k.Hash();
+        }
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+
+#include "botcraft/Game/Entities/EntitySnapshot.hpp"
+#include "botcraft/Game/Entities/LocalPlayer.hpp"
+#include "botcraft/Game/Inventory/InventorySnapshot.hpp"
+#include "botcraft/Game/World/WorldSnapshot.hpp"
+
+namespace Botcraft
+{
+    class ManagersClient;
+    class World;
+    class EntityManager;
+    class InventoryManager;
+
+    /// @brief Read-only snapshots of the world, the entities, the inventory
+    /// and the local player of a client, taken together so they describe the
+    /// same moment. A task can plan a whole step from them without locking any
+    /// manager mutex, then check cheaply, with the versions of the snapshots,
+    /// if what it read changed before acting on its plan. Like WorldSnapshot,
+    /// a transaction should not be shared between threads
+    class ReadTransaction
+    {
+    public:
+        /// @brief Take the snapshots of a client managers, see Refresh
+        /// @param client The client to read
+        ReadTransaction(ManagersClient& client);
+
+        /// @brief Take new snapshots of all the managers. None of their
+        /// mutexes must be locked by the caller. The world and inventory
+        /// versions are checked after the snapshots are taken, and the
+        /// snapshots taken again if they changed in between (a few times at
+        /// most), so the entities, updated each tick, are seen in the same
+        /// world and inventory as the ones in the transaction
+        void Refresh();
+
+        const WorldSnapshot& GetWorld() const;
+        const EntitySnapshot& GetEntities() const;
+        const InventorySnapshot& GetInventory() const;
+        /// @brief Get the local player state, as published by the last physics tick
+        /// before the transaction. It changes every tick and is not version checked
+        const LocalPlayerState& GetPlayerState() const;
+
+        /// @brief Check if any chunk has been loaded, unloaded or modified since the transaction
+        const bool IsWorldStale() const;
+        /// @brief Check if the blocks of a chunk changed since the transaction,
+        /// or if it has been loaded or unloaded
+        /// @param chunk_x X chunk coordinate
+        /// @param chunk_z Z chunk coordinate
+        const bool IsChunkStale(const int chunk_x, const int chunk_z) const;
+        /// @brief Same as IsChunkStale, for the chunk of a block
+        /// @param pos Position of the block, in world coordinates
+        const bool IsBlockStale(const Position& pos) const;
+        /// @brief Check if any entity moved, appeared or disappeared since the transaction.
+        /// Takes a new entity snapshot if it did, so the next one is cheap to get
+        const bool IsEntitiesStale() const;
+        /// @brief Check if an entity moved, appeared or disappeared since the transaction
+        /// @param id Id of the entity
+        const bool IsEntityStale(const int id) const;
+        /// @brief Check if a window has been opened or closed, or a slot, the cursor
+        /// or the selected hotbar slot changed since the transaction. Lock-free
+        const bool IsInventoryStale() const;
+        /// @brief Check if the world, the entities or the inventory changed since the transaction
+        const bool IsStale() const;
+
+    private:
+        std::shared_ptr<World> world;
+        std::shared_ptr<EntityManager> entity_manager;
+        std::shared_ptr<InventoryManager> inventory_manager;
+
+        WorldSnapshot world_snapshot;
+        EntitySnapshot entity_snapshot;
+        InventorySnapshot inventory_snapshot;
+        LocalPlayerState player_state;
+    };
+} // Botcraft
@@ -2,6 +2,7 @@
 
 #include <ostream>
 #include <cassert>
+#include <cstdint>
 
 #include <nlohmann/json.hpp>
 
@@ -222,7 +223,13 @@ namespace std
             size_t value = hasher(v.x);
             value ^= hasher(v.y) + 0x9e3779b9 + (value << 6) + (value >> 2);
             value ^= hasher(v.z) + 0x9e3779b9 + (value << 6) + (value >> 2);
-            return value;
+            // std::hash<int> is the identity, mix the bits so neighbour
+            // positions don't end up in neighbour buckets
+            uint64_t h = static_cast<uint64_t>(value);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
         }
     };
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <array>
 #include <map>
 #include <string>
 #include <memory>
 
+#include "protocolCraft/BinaryReadWrite.hpp"
+
 namespace Botcraft
 {
     // Enum for biomes with special color processing
@@ -32,11 +35,24 @@ namespace Botcraft
         const unsigned int GetColorMultiplier(const int height, const bool is_grass) const;
         const unsigned int GetWaterColorMultiplier() const;
 
+        /// @brief Serialize this biome
+        /// @param container Container to append the data to
+        void Write(ProtocolCraft::WriteContainer& container) const;
+
+        /// @brief Create a biome from data previously created by Write
+        /// @param iter Data to read
+        /// @param length Size of the remaining data
+        /// @return The loaded biome, throws a std::runtime_error if data are invalid
+        static std::unique_ptr<Biome> Read(ProtocolCraft::ReadIterator& iter, size_t& length);
+
     private:
         // Compute the value of the pixel in the triangle defined by the colors of the three corners
         // height is 0 if y <= 64 and y - 64 otherwise
         const unsigned int ComputeColorTriangle(const int height, const bool is_grass) const;
 
+        // Compute the grass or leaves color at a height above the sea level
+        const unsigned int ComputeColorMultiplier(const int height, const bool is_grass) const;
+
     private:
         std::string name;
         float temperature;
@@ -44,5 +60,12 @@ namespace Botcraft
         unsigned int default_grass;
         unsigned int default_leaves;
         BiomeType biome_type;
+
+        // Grass and leaves colors are precomputed for
+        // this many blocks above the sea level
+        static constexpr int num_precomputed_heights = 320;
+        // Grass and leaves colors, indexed by height - sea level - 1
+        std::array<unsigned int, num_precomputed_heights> grass_colors;
+        std::array<unsigned int, num_precomputed_heights> leaves_colors;
     };
 } // Botcraft
\ No newline at end of file
@@ -16,18 +16,45 @@ namespace Botcraft
 #if PROTOCOL_VERSION < 347
         Block(const int id_ = 0, const unsigned char metadata_ = 0);
 
-        void ChangeBlockstate(const int id_, const unsigned char metadata_, const int model_id_ = -1, const Position* pos = nullptr);
+        /// @brief Change the blockstate of this block
+        /// @param model_id_ Model to force, -1 to pick it from the block position when needed
+        void ChangeBlockstate(const int id_, const unsigned char metadata_, const int model_id_ = -1);
 #else
         Block(const int id_ = 0);
 
-        void ChangeBlockstate(const int id_, const int model_id_ = -1, const Position* pos = nullptr);
+        /// @brief Change the blockstate of this block
+        /// @param model_id_ Model to force, -1 to pick it from the block position when needed
+        void ChangeBlockstate(const int id_, const int model_id_ = -1);
 #endif
 
         const Blockstate* GetBlockstate() const;
-        const unsigned short GetModelId() const;
+        /// @brief Get the model forced for this block
+        /// @return The model id, or -1 if it's picked from the position (always -1 without GUI)
+        const int GetModelId() const;
+        /// @brief Get the model of this block. Unless forced, the weighted
+        /// random variant is picked from the position, on demand
+        /// @param pos Position of the block, with x and z relative to its chunk
+        /// @return The model id
+        const int GetModelId(const Position& pos) const;
+        /// @brief Get the colliders shape of the block model, without dereferencing the blockstate
+        /// @return The shape id, to use with Model::GetColliders
+        const unsigned short GetCollidersId() const;
+
+        /// @brief Get the precomputed properties of the blockstate, without dereferencing it
+        /// @return BlockstateFlag values combined with bitwise or
+        const unsigned short GetFlags() const;
+        /// @brief Test a property of the blockstate, without dereferencing it
+        /// @param flag Property to test
+        /// @return True if the blockstate has this property
+        const bool HasFlag(const BlockstateFlag flag) const;
 
     private:
         const Blockstate* blockstate;
-        unsigned short model_id;
+#if USE_GUI
+        // Only the renderer needs a forced model, -1 if not forced
+        short model_id;
+#endif
+        unsigned short flags;
+        unsigned short colliders_id;
     };
 } // Botcraft
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class Block;
+    class Chunk;
+    struct Section;
+    class WorldSnapshot;
+
+    /// @brief A cursor on the blocks of a WorldSnapshot. The chunk and the
+    /// section of the current position are kept, so moving around or reading
+    /// the neighbours only resolves them again when crossing a section border.
+    /// Block pointers are valid as long as the snapshot exists. An accessor
+    /// must not be shared between threads
+    class BlockAccessor
+    {
+    public:
+        /// @brief Create a cursor
+        /// @param snapshot_ Snapshot to read, must outlive the accessor
+        /// @param pos Initial position, in world coordinates
+        BlockAccessor(const WorldSnapshot& snapshot_, const Position& pos = Position(0, 0, 0));
+
+        const Position& GetPosition() const;
+
+        /// @brief Move the cursor to a position
+        /// @param pos New position, in world coordinates
+        void MoveTo(const Position& pos);
+        /// @brief Move the cursor relatively to its current position
+        void Move(const int dx, const int dy, const int dz);
+
+        /// @brief Check if the chunk of the current position is loaded
+        const bool IsLoaded() const;
+
+        /// @brief Get the block at the cursor position
+        /// @return A pointer to the block, nullptr if not loaded
+        const Block* Get() const;
+
+        /// @brief Get a block relatively to the cursor, without moving it
+        /// @return A pointer to the block, nullptr if not loaded
+        const Block* GetRelative(const int dx, const int dy, const int dz) const;
+
+        /// @brief Get the 3x3x3 blocks around the cursor at once
+        /// @param blocks Output blocks, indexed by (dy + 1) * 9 + (dz + 1) * 3 + (dx + 1),
+        /// nullptr for blocks that are not loaded
+        void GetNeighbourhood(std::array<const Block*, 27>& blocks) const;
+
+    private:
+        /// @brief Find the chunk and the section of the current position
+        void Resolve();
+
+        /// @brief Find the section at given section coordinates
+        /// @return The section, nullptr if not loaded
+        const Section* FindSection(const Position& section_coords) const;
+
+        /// @brief Get the index of a block in its section
+        static int GetIndex(const int x, const int y, const int z);
+
+    private:
+        const WorldSnapshot* snapshot;
+
+        Position position;
+        /// @brief Coordinates of the section containing position (position >> 4)
+        Position section_coords;
+        const Chunk* chunk;
+        const Section* section;
+    };
+} // Botcraft
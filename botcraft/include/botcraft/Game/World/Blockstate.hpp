@@ -3,6 +3,7 @@
 #include <string>
 #include <random>
 #include <map>
+#include <memory>
 
 #include <nlohmann/json.hpp>
 
@@ -60,14 +61,30 @@ namespace Botcraft
         const float GetHardness() const;
         const TintType GetTintType() const;
 
+        /// @brief Get an estimation of the memory used by this blockstate and its models
+        /// @return The size in bytes
+        const size_t GetMemoryUsage() const;
+
 #if PROTOCOL_VERSION < 347
         const static unsigned int IdMetadataToId(const unsigned int id_, const unsigned char metadata_);
         static void IdToIdMetadata(const unsigned int input_id, unsigned int &output_id, unsigned char &output_metadata);
 #endif
         static void ClearCache();
 
+        /// @brief Serialize this blockstate, its models are saved without rendering data
+        /// @param container Container to append the data to
+        void Write(ProtocolCraft::WriteContainer& container) const;
+
+        /// @brief Create a blockstate from data previously created by Write
+        /// @param iter Data to read
+        /// @param length Size of the remaining data
+        /// @return The loaded blockstate, throws a std::runtime_error if data are invalid
+        static std::unique_ptr<Blockstate> Read(ProtocolCraft::ReadIterator& iter, size_t& length);
+
 #if USE_GUI
         void UpdateModelsWithAtlasData(const Renderer::Atlas* atlas);
+        /// @brief Remove the rendering data of all the models, only keeping the colliders
+        void ClearRenderingData();
 #endif
 
     private:
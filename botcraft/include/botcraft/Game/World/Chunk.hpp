@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <map>
 #include <memory>
+#include <string>
+#include <functional>
+#include <utility>
 
 #include "botcraft/Game/World/Block.hpp"
 #include "botcraft/Game/Enums.hpp"
@@ -18,6 +22,43 @@ namespace Botcraft
     static const int CHUNK_WIDTH = 16;
     static const int SECTION_HEIGHT = 16;
 
+    /// @brief Hash function for (x, z) chunk coordinates, to
+    /// use them as key in unordered containers
+    struct ChunkCoordinatesHasher
+    {
+        inline size_t operator()(const std::pair<int, int>& coords) const
+        {
+            // Pack both 32 bits coordinates in one 64 bits value
+            return std::hash<unsigned long long int>()(
+                (static_cast<unsigned long long int>(static_cast<unsigned int>(coords.first)) << 32) |
+                static_cast<unsigned long long int>(static_cast<unsigned int>(coords.second)));
+        }
+    };
+
+    /// @brief Estimation of the memory used by a chunk, by kind of data, in bytes
+    struct ChunkMemoryUsage
+    {
+        /// @brief Everything, the three other members included
+        size_t total = 0;
+        /// @brief Sections blocks, light excluded
+        size_t sections = 0;
+        /// @brief Sections block and sky light
+        size_t light = 0;
+        /// @brief Block entities, with their NBT data
+        size_t block_entities = 0;
+    };
+
+    /// @brief A block entity stored in a chunk
+    struct BlockEntity
+    {
+        /// @brief (y - min_y) << 8 | z << 4 | x, block entities are sorted by it
+        unsigned int index;
+        /// @brief Kind of the block entity, from the block at its position when it was set
+        BlockEntityType type;
+        /// @brief Full data, tags are only indexed when accessed
+        std::shared_ptr<ProtocolCraft::NBT> data;
+    };
+
     class Chunk
     {
     public:
@@ -28,10 +69,25 @@ namespace Botcraft
 #else
         Chunk(const int min_y_, const unsigned int height_, const std::string& dim = "minecraft:overworld");
 #endif
+        /// @brief Copy a chunk. Sections are shared between both
+        /// chunks until one of them is modified (copy on write),
+        /// making a copy cheap
         Chunk(const Chunk& c);
 
         static const Position BlockCoordsToChunkCoords(const Position& pos);
 
+        /// @brief Write this chunk (blocks, light, biomes and block
+        /// entities) in a compact binary format. The format depends
+        /// on the protocol version, and can be loaded back with Read
+        /// @param container Container to append the data to
+        void Write(ProtocolCraft::WriteContainer& container) const;
+
+        /// @brief Create a chunk from data previously created by Write
+        /// @param iter Data to read
+        /// @param length Size of the remaining data
+        /// @return The loaded chunk, throws a std::runtime_error if data are invalid
+        static std::shared_ptr<Chunk> Read(ProtocolCraft::ReadIterator& iter, size_t& length);
+
         const int GetMinY() const;
         const int GetHeight() const;
 
@@ -57,7 +113,27 @@ namespace Botcraft
         void SetBlockEntityData(const Position& pos, const ProtocolCraft::NBT& block_entity);
         void RemoveBlockEntityData(const Position& pos);
         const std::shared_ptr<ProtocolCraft::NBT> GetBlockEntityData(const Position& pos) const;
+        /// @brief Get the kind of the block entity at a position, without looking at its data
+        /// @param pos Position in chunk coordinates
+        /// @return The kind of the block entity, BlockEntityType::None if there is none
+        const BlockEntityType GetBlockEntityType(const Position& pos) const;
+        /// @brief Get the positions of all the block entities of one kind
+        /// @param type Kind of block entities to search for
+        /// @return Positions in chunk coordinates, sorted by y, z then x
+        const std::vector<Position> GetBlockEntitiesPositions(const BlockEntityType type) const;
+        /// @brief Get the four lines of a sign
+        /// @param pos Position of the sign in chunk coordinates
+        /// @return The raw (json) text of each line, empty strings if there is no sign
+        const std::array<std::string, 4> GetSignText(const Position& pos) const;
+        /// @brief Get the entity spawned by a spawner
+        /// @param pos Position of the spawner in chunk coordinates
+        /// @return The entity id (e.g. minecraft:zombie), empty if unknown or if there is no spawner
+        const std::string GetSpawnerEntity(const Position& pos) const;
 
+        /// @brief Get a block of this chunk
+        /// @param pos Position of the block in chunk coordinates
+        /// @return A pointer to the block, nullptr if out of the chunk. Invalidated
+        /// when a block of the same section is set, as its palette can be compacted
         const Block *GetBlock(const Position &pos) const;
 #if PROTOCOL_VERSION < 347
         void SetBlock(const Position &pos, const unsigned int id, unsigned char metadata, const int model_id = -1);
@@ -65,21 +141,78 @@ namespace Botcraft
         void SetBlock(const Position &pos, const unsigned int id, const int model_id = -1);
 #endif
         void SetBlock(const Position& pos, const Block* block);
+        /// @brief Set multiple blocks of one section. The section is resolved and
+        /// made writable only once, and the blocks version is bumped only once
+        /// @param section_y Index of the section
+        /// @param blocks (index of the block in the section, raw blockstate id) of each block,
+        /// pre-1.13 raw ids are id << 4 | metadata
+        /// @return True if at least one block changed
+        const bool SetSectionBlocks(const int section_y, const std::vector<std::pair<int, unsigned int> >& blocks);
 
         const unsigned char GetBlockLight(const Position &pos) const;
         void SetBlockLight(const Position &pos, const unsigned char v);
         const unsigned char GetSkyLight(const Position &pos) const;
         void SetSkyLight(const Position &pos, const unsigned char v);
+        /// @brief Replace all the light values of a section
+        /// @param y Index of the section
+        /// @param data Section::NUM_BLOCKS / 2 bytes, with two 4 bits values per byte, nullptr to set all values to 0
+        /// @param sky If true, set sky light, block light otherwise
+        void SetSectionLight(const int y, const unsigned char* data, const bool sky);
+
+        /// @brief Get the Y of the highest block of a column matching a heightmap, without any scan
+        /// @param x X coordinate in the chunk
+        /// @param z Z coordinate in the chunk
+        /// @param type Heightmap to use
+        /// @return The world Y of the block, GetMinY() - 1 if there is no such block in the column
+        const int GetHighestBlock(const int x, const int z, const HeightmapType type) const;
+        /// @brief Get a whole heightmap of this chunk
+        /// @param type Heightmap to get
+        /// @return One value per column, indexed by z * CHUNK_WIDTH + x. Each value is the
+        /// highest matching block Y - GetMinY() + 1, 0 if there is no such block
+        const std::array<unsigned short, CHUNK_WIDTH * CHUNK_WIDTH>& GetHeightmap(const HeightmapType type) const;
+#if PROTOCOL_VERSION > 442
+        /// @brief Load the heightmaps sent with the chunk data. Must be called after
+        /// LoadChunkData, missing or invalid heightmaps are computed from the blocks
+        /// @param heightmaps_nbt Heightmaps NBT from the chunk packet
+        void LoadHeightmaps(const ProtocolCraft::NBT& heightmaps_nbt);
+#endif
+
 #if PROTOCOL_VERSION < 719
         const Dimension GetDimension() const;
 #else
         const std::string& GetDimension() const;
 #endif
-        const std::map<Position, std::shared_ptr<ProtocolCraft::NBT> >& GetBlockEntitiesData() const;
+        /// @brief Get all the block entities of this chunk
+        /// @return The block entities, sorted by index
+        const std::vector<BlockEntity>& GetBlockEntitiesData() const;
 
         const bool HasSection(const int y) const;
+        /// @brief Get a section of this chunk
+        /// @param y Index of the section
+        /// @return A pointer to the section, nullptr if there is no section at this index
+        const Section* GetSection(const int y) const;
+        /// @brief Add an air section, shared with all the other empty
+        /// sections until it's modified (see GetWritableSection)
+        /// @param y Index of the section
         void AddSection(const int y);
 
+        /// @brief Get the number of sections stored in this chunk
+        const size_t GetNumSections() const;
+
+        /// @brief Get an estimation of the memory used by this chunk.
+        /// Sections shared with other chunks are counted in each of them
+        /// @return The size in bytes
+        const size_t GetMemoryUsage() const;
+
+        /// @brief Get an estimation of the memory used by this chunk, by kind of data.
+        /// Sections and block entities shared with other chunks are counted in each of them
+        const ChunkMemoryUsage GetDetailedMemoryUsage() const;
+
+        /// @brief Get the version of the blocks of this chunk. It changes each
+        /// time a block is modified and is unique across all the chunks, so
+        /// a chunk with the same version as a previous one has the same blocks
+        const unsigned long long GetBlocksVersion() const;
+
 #if PROTOCOL_VERSION < 358
         const unsigned char GetBiome(const int x, const int z) const;
         void SetBiome(const int x, const int z, const unsigned char b);
@@ -93,16 +226,82 @@ namespace Botcraft
         void SetBiome(const int x, const int y, const int z, const int new_biome);
         void SetBiome(const int i, const int new_biome);
 #endif
-        void UpdateNeighbour(const std::shared_ptr<Chunk> neighbour, const Orientation direction);
-        
+
     private:
-        std::vector<std::shared_ptr<Section> > sections;
+        /// @brief Get a section to modify it, copying it first if it's shared with another chunk
+        /// @param y Index of the section
+        /// @return A pointer to the section, nullptr if there is no section at this index
+        Section* GetWritableSection(const int y);
+
+        /// @brief Give a new blocks version to this chunk
+        void BumpBlocksVersion();
+
+        /// @brief Find the block entity at a position
+        /// @param pos Position in chunk coordinates
+        /// @return A pointer to the block entity, nullptr if there is none
+        const BlockEntity* FindBlockEntity(const Position& pos) const;
+        /// @brief Add or replace the block entity at a position, keeping block_entities_data sorted
+        /// @param pos Position in chunk coordinates
+        /// @param data Data of the block entity
+        void InsertBlockEntity(const Position& pos, const std::shared_ptr<ProtocolCraft::NBT>& data);
+
+        /// @brief Compute all the heightmaps from the blocks
+        void ComputeHeightmaps();
+        /// @brief Update the heightmaps after a block change
+        /// @param pos Position of the block, in chunk coordinates
+        /// @param flags Flags of the new block
+        void UpdateHeightmaps(const Position& pos, const unsigned short flags);
+
+#if PROTOCOL_VERSION > 756
+        /// @brief Biomes of one section, kept in the network paletted
+        /// format and only unpacked when queried
+        struct SectionBiomes
+        {
+            /// @brief Biome ids, empty if data contains global ids
+            std::vector<int> palette;
+            /// @brief Bits per entry in data, 0 for a single biome section
+            unsigned char bits_per_entry = 0;
+            /// @brief Packed entries, they don't span across multiple longs
+            std::vector<unsigned long long int> data;
+
+            const int Get(const int i) const;
+            void Set(const int i, const int biome);
+
+        private:
+            const unsigned int GetRaw(const int i) const;
+            void SetRaw(const int i, const unsigned int raw);
+            /// @brief Repack all the entries with more bits
+            void Grow(const unsigned char new_bits_per_entry);
+        };
+
+        /// @brief Decode all the blocks of a section at once
+        /// @param section_y Index of the section
+        /// @param bits_per_block Bits per entry in data_array, 0 for a single value section
+        /// @param palette Network palette, empty for global palette
+        /// @param data_array Packed palette indices
+        void LoadSectionBlocks(const int section_y, const unsigned char bits_per_block, const std::vector<int>& palette, const std::vector<unsigned long long int>& data_array);
+#endif
+
 #if PROTOCOL_VERSION < 358
-        std::vector<unsigned char> biomes;
+        using Biomes = std::vector<unsigned char>;
+#elif PROTOCOL_VERSION < 757
+        using Biomes = std::vector<int>;
 #else
-        std::vector<int> biomes;
+        // One per section
+        using Biomes = std::vector<SectionBiomes>;
 #endif
-        std::map<Position, std::shared_ptr<ProtocolCraft::NBT> > block_entities_data;
+        /// @brief Get the biomes to modify them, copying them first if they're shared with another chunk
+        Biomes& GetWritableBiomes();
+        /// @brief Get the block entities to modify them, copying them first if they're shared with another chunk
+        std::vector<BlockEntity>& GetWritableBlockEntities();
+        
+    private:
+        std::vector<std::shared_ptr<Section> > sections;
+        // Biomes and block entities are shared with the
+        // copies of this chunk until modified, like sections
+        std::shared_ptr<Biomes> biomes;
+        // Sorted by index
+        std::shared_ptr<std::vector<BlockEntity> > block_entities_data;
 #if PROTOCOL_VERSION < 719
         Dimension dimension;
 #else
@@ -115,6 +314,9 @@ namespace Botcraft
         int min_y;
         int height;
 #endif
+        unsigned long long blocks_version;
+        // Indexed by HeightmapType
+        std::array<std::array<unsigned short, CHUNK_WIDTH * CHUNK_WIDTH>, 2> heightmaps;
 #if USE_GUI
         bool modified_since_last_rendered;
 #endif
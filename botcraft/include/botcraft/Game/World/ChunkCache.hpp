@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Botcraft
+{
+    class Chunk;
+
+    /// @brief A disk cache for decoded chunks, so they can be loaded
+    /// back when reconnecting to the same server. Chunks are grouped
+    /// in region files of 32x32 chunks, one folder per dimension.
+    /// Data are only valid for the protocol version that wrote them,
+    /// files from other versions are ignored. Region files are written
+    /// by a background thread, so Save never waits for the disk.
+    class ChunkCache
+    {
+    public:
+        /// @brief Create a cache
+        /// @param folder_ Folder to store the region files in, created if it doesn't exist. Use one folder per server
+        ChunkCache(const std::string& folder_);
+        ~ChunkCache();
+
+        /// @brief Save a chunk in the cache. Data are kept in memory
+        /// and written in the region files when Flush or FlushAsync is called,
+        /// or by the background thread when too many chunks are waiting
+        /// @param dimension Dimension of the chunk
+        /// @param x X chunk coordinate
+        /// @param z Z chunk coordinate
+        /// @param chunk The chunk to save
+        void Save(const std::string& dimension, const int x, const int z, const Chunk& chunk);
+
+        /// @brief Load all the cached chunks in a square around a center chunk
+        /// @param dimension Dimension of the chunks
+        /// @param center_x X center chunk coordinate
+        /// @param center_z Z center chunk coordinate
+        /// @param radius Max distance, in chunks, on each axis
+        /// @return All the cached chunks found with their coordinates
+        std::vector<std::pair<std::pair<int, int>, std::shared_ptr<Chunk> > > Load(const std::string& dimension,
+            const int center_x, const int center_z, const int radius);
+
+        /// @brief Write all the saved chunks in the region files
+        void Flush();
+
+        /// @brief Ask the background thread to write the saved chunks in the region files, without waiting
+        void FlushAsync();
+
+    private:
+        /// @brief Background thread function, writing the saved chunks when asked
+        void WriteLoop();
+
+        /// @brief Get the path of a region file
+        const std::string GetRegionPath(const std::string& dimension, const int region_x, const int region_z) const;
+
+        /// @brief Read all the serialized chunks of a region file
+        /// @param path Path of the region file
+        /// @return Serialized chunks, by chunk coordinates. Empty if the file doesn't exist or is invalid
+        static std::map<std::pair<int, int>, std::vector<unsigned char> > ReadRegion(const std::string& path);
+
+        /// @brief Write all the serialized chunks of a region file
+        static void WriteRegion(const std::string& path, const std::map<std::pair<int, int>, std::vector<unsigned char> >& chunks);
+
+    private:
+        // Max number of chunks waiting to be written before an automatic flush
+        static constexpr size_t max_pending_chunks = 1024;
+
+        std::string folder;
+
+        /// @brief Held while reading or writing the region files
+        std::mutex io_mutex;
+        /// @brief Protects the pending chunks and the background thread state, never held during disk access
+        std::mutex cache_mutex;
+        // dimension --> region coordinates --> chunk coordinates --> serialized chunk
+        std::map<std::string, std::map<std::pair<int, int>, std::map<std::pair<int, int>, std::vector<unsigned char> > > > pending_chunks;
+        size_t num_pending_chunks;
+
+        std::thread write_thread;
+        std::condition_variable write_condition;
+        bool write_requested;
+        bool running;
+    };
+} // Botcraft
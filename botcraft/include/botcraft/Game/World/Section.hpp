@@ -1,27 +1,168 @@
 #pragma once
 
 #include <vector>
+#include <deque>
 #include <map>
 #include <memory>
+#include <unordered_map>
 
 #include "botcraft/Game/World/Chunk.hpp"
+#include "protocolCraft/BinaryReadWrite.hpp"
 
 namespace Botcraft
 {
+    /// @brief A 16x16x16 section of a chunk. Blocks are stored in a palette
+    /// of unique Block and a bit-packed array of indices in this
+    /// palette (like in the network format)
     struct Section
     {
-        Section(const bool has_sky_light)
+        /// @brief Number of blocks in a section
+        static constexpr int NUM_BLOCKS = CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT;
+
+        Section();
+
+        /// @brief Create a new air section. Memory of the deleted sections
+        /// is recycled, so once enough sections have been created, loading
+        /// chunks doesn't allocate anymore
+        /// @return A shared pointer to the new section
+        static std::shared_ptr<Section> Create();
+
+        /// @brief Create a copy of a section, recycling memory like Create()
+        /// @param other The section to copy
+        /// @return A shared pointer to the new section
+        static std::shared_ptr<Section> Create(const Section& other);
+
+        /// @brief Set the max memory kept by the process-wide pool of deleted sections
+        /// recycled by Create, 64 MiB by default. Pooled sections above it are released
+        /// @param bytes Max size of the pool, in bytes. 0 disables the pool
+        static void SetPoolMaxMemory(const size_t bytes);
+        static const size_t GetPoolMaxMemory();
+        /// @brief Get the memory currently kept by the pool of deleted sections
+        /// @return The size in bytes
+        static const size_t GetPoolMemoryUsage();
+        /// @brief Release the memory of the pool of deleted sections, e.g.
+        /// when the chunks won't be needed again. Called when the last World is destroyed
+        /// @param bytes Memory to keep in the pool, in bytes
+        static void TrimPool(const size_t bytes = 0);
+
+        /// @brief Get a section filled with a single block and without
+        /// light, shared by all the chunks using it. It must never be
+        /// modified, it's always shared so Chunk::GetWritableSection
+        /// copies it on first write
+        /// @param block The block filling the section, air by default
+        /// @return A shared pointer to the section, nullptr if block has a forced model
+        static std::shared_ptr<Section> GetSingleValueSection(const Block& block = Block());
+
+        /// @brief Get the block at a given index
+        /// @param index y * CHUNK_WIDTH * CHUNK_WIDTH + z * CHUNK_WIDTH + x
+        /// @return A pointer to the palette entry, valid as long as the section exists and SetBlocks is not called.
+        /// SetBlock can also invalidate it when the palette is full and gets compacted
+        const Block* GetBlock(const int index) const;
+
+        /// @brief Set the block at a given index
+        /// @param index y * CHUNK_WIDTH * CHUNK_WIDTH + z * CHUNK_WIDTH + x
+        /// @param block The block to store, added to the palette if not already there
+        void SetBlock(const int index, const Block& block);
+
+        /// @brief Replace all the blocks of the section at once. This
+        /// invalidates the pointers previously returned by GetBlock
+        /// @param blocks_palette The blocks used in the section
+        /// @param indices NUM_BLOCKS indices in blocks_palette, in y, z, x order
+        void SetBlocks(const std::vector<Block>& blocks_palette, const std::vector<unsigned short>& indices);
+
+        /// @brief Check if all the blocks of this section are the same
+        /// @return True if there is only one block in the palette
+        const bool IsSingleValue() const;
+
+        /// @brief Get the number of blocks that are not air in this section
+        /// @return The number of non-air blocks, 0 for an empty section
+        const unsigned short GetNumNonAirBlocks() const;
+
+        /// @brief Get an estimation of the memory used by this section
+        /// @return The size in bytes
+        const size_t GetMemoryUsage() const;
+
+        /// @brief Get the part of GetMemoryUsage used by the light data
+        /// @return The size in bytes
+        const size_t GetLightMemoryUsage() const;
+
+        /// @brief Get the blocks used in this section. Can contain
+        /// blocks that are not present anymore
+        /// @return All the palette entries
+        const std::deque<Block>& GetPalette() const;
+
+        /// @brief Get the palette entry index of a block
+        /// @param index y * CHUNK_WIDTH * CHUNK_WIDTH + z * CHUNK_WIDTH + x
+        /// @return The index of the block in GetPalette()
+        const unsigned short GetPaletteIndex(const int index) const;
+
+        /// @brief Check if this section stores block light values
+        /// @return False if all block light values are 0
+        const bool HasBlockLightData() const;
+        /// @brief Check if this section stores sky light values
+        /// @return False if all sky light values are 0
+        const bool HasSkyLightData() const;
+
+        const unsigned char GetBlockLight(const int index) const;
+        void SetBlockLight(const int index, const unsigned char v);
+        const unsigned char GetSkyLight(const int index) const;
+        void SetSkyLight(const int index, const unsigned char v);
+
+        /// @brief Replace all the block light values of the section
+        /// @param data NUM_BLOCKS / 2 bytes, with two 4 bits values per byte as sent by the server, nullptr to set all values to 0
+        void SetBlockLightData(const unsigned char* data);
+        /// @brief Replace all the sky light values of the section
+        /// @param data NUM_BLOCKS / 2 bytes, with two 4 bits values per byte as sent by the server, nullptr to set all values to 0
+        void SetSkyLightData(const unsigned char* data);
+
+        /// @brief Write this section in a compact binary format (palette,
+        /// packed indices and light), that can be loaded back with Read
+        /// @param container Container to append the data to
+        void Write(ProtocolCraft::WriteContainer& container) const;
+
+        /// @brief Replace this section with data previously created by Write
+        /// @param iter Data to read
+        /// @param length Size of the remaining data
+        void Read(ProtocolCraft::ReadIterator& iter, size_t& length);
+
+    private:
+        /// @brief Set the section back to air, keeping allocated memory
+        void Reset();
+        void SetPaletteIndex(const int index, const unsigned short palette_index);
+        const unsigned short GetOrAddPaletteEntry(const Block& block);
+        void ResizeIndices(const unsigned char new_bits_per_entry);
+        /// @brief Remove the palette entries no block uses anymore, and
+        /// pack the indices with as few bits per entry as possible
+        /// while keeping at least half of the indices free
+        void CompactPalette();
+        void CountNonAirBlocks();
+
+    private:
+        // A deque so pointers to palette entries stay
+        // valid when a new entry is added
+        std::deque<Block> palette;
+
+        struct PaletteKeyHasher
         {
-            // +2 because we also store the neighbour section blocks
-            data_blocks = std::vector<Block>((CHUNK_WIDTH + 2) * (CHUNK_WIDTH + 2) * SECTION_HEIGHT);
-            block_light = std::vector<unsigned char>(CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT);
-            if (has_sky_light)
+            size_t operator()(const std::pair<const Blockstate*, int>& key) const
             {
-                sky_light = std::vector<unsigned char>(CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT);
+                return std::hash<const Blockstate*>()(key.first) ^ (std::hash<int>()(key.second) << 1);
             }
-        }
-        std::vector<Block> data_blocks;
+        };
+        // (blockstate, model id) --> palette index, only used
+        // once the palette is too large for a linear search.
+        // Cleared each time the palette is replaced
+        std::unordered_map<std::pair<const Blockstate*, int>, unsigned short, PaletteKeyHasher> palette_lookup;
+        // Packed palette indices, entries don't span across multiple longs
+        std::vector<unsigned long long int> data_indices;
+        // 0 for single value sections, 4, 8 or 16 otherwise
+        unsigned char bits_per_entry;
+        // Kept up to date on each change so empty sections can be skipped
+        unsigned short num_non_air_blocks;
+
+        // Light values, with two 4 bits values per byte (like
+        // in the network format), empty if all values are 0
         std::vector<unsigned char> block_light;
         std::vector<unsigned char> sky_light;
     };
-} // Botcraft
\ No newline at end of file
+} // Botcraft
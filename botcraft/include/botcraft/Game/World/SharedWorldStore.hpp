@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Game/World/Section.hpp"
+
+namespace Botcraft
+{
+    class Blockstate;
+    class Chunk;
+
+    /// @brief The blocks of one dimension in a memory-mapped file, shared
+    /// by multiple processes. Processes running bots in the same area can
+    /// write the chunks they receive in it (see World::SetSharedStore), and
+    /// all the others map it read-only and read the blocks from there instead
+    /// of keeping their own copy, for example with a small interest radius
+    /// on their World. World never reads from a store, blocks are read with
+    /// the functions of this class. Sections are stored as raw blockstate ids in a fixed
+    /// size hash table, each slot protected by a seqlock: readers never block
+    /// writers and just retry if a section changed while they read it.
+    /// Writers lock the slots with their pid, so the locks of a crashed process
+    /// are taken over, and all waits give up after a short time.
+    /// Slots are never freed, chunks unloaded by the writers keep their last
+    /// known blocks, so the store must be sized for all the sections of the
+    /// area the bots go through. Data are only valid for the protocol version
+    /// that created the file.
+    class SharedWorldStore
+    {
+    public:
+        /// @brief Map a store file
+        /// @param path_ Path of the file. In writable mode, it's created if it doesn't exist
+        /// @param writable If true, the file is mapped read-write, read-only otherwise
+        /// @param max_sections Number of section slots when the file is created, ignored otherwise.
+        /// Each slot takes 8 KiB in the file (sparse if the filesystem supports it)
+        /// @param dimension_ Dimension stored in the file when it's created, ignored otherwise.
+        /// Before 1.16 dimensions are stored with their number (e.g. "0" for the overworld)
+        /// Throws a std::runtime_error if the file can't be mapped or is invalid
+        SharedWorldStore(const std::string& path_, const bool writable, const unsigned int max_sections = 16384, const std::string& dimension_ = "minecraft:overworld");
+        ~SharedWorldStore();
+
+        SharedWorldStore(const SharedWorldStore&) = delete;
+        SharedWorldStore& operator=(const SharedWorldStore&) = delete;
+
+        const std::string& GetPath() const;
+        const std::string& GetDimension() const;
+        const bool IsWritable() const;
+        /// @brief Get the max number of sections in the store
+        const unsigned int GetCapacity() const;
+        /// @brief Get the number of section slots already used
+        const unsigned int GetNumSections() const;
+        /// @brief Get a counter incremented each time a section is modified
+        /// by any process, to check if something changed since a previous read
+        const unsigned long long GetGeneration() const;
+
+        /// @brief Write all the sections of a chunk. Missing sections are written as air.
+        /// Sections with the same blocks as in the store are not modified
+        /// @param x X chunk coordinate
+        /// @param z Z chunk coordinate
+        /// @param chunk The chunk to write, must be in the dimension of the store
+        /// @param previous A previous copy of the chunk, already fully written in the store.
+        /// The sections it shares with chunk didn't change and are skipped. nullptr to write them all
+        /// @return False if some sections couldn't be written, see WriteSection
+        const bool WriteChunk(const int x, const int z, const Chunk& chunk, const Chunk* previous = nullptr);
+
+        /// @brief Write the blocks of a section
+        /// @param x X section coordinate (chunk coordinate)
+        /// @param y Y section coordinate (world y / SECTION_HEIGHT, can be negative)
+        /// @param z Z section coordinate (chunk coordinate)
+        /// @param ids Section::NUM_BLOCKS blockstate ids in y, z, x order
+        /// (Blockstate::IdMetadataToId(id, metadata) before 1.13)
+        /// @return False if the section is not in the store and the store is full,
+        /// or if another process kept it locked for too long
+        const bool WriteSection(const int x, const int y, const int z, const unsigned short* ids);
+
+        /// @brief Check if the section containing a position is in the store
+        /// @param pos Position in world coordinates
+        const bool IsLoaded(const Position& pos) const;
+
+        /// @brief Get the blockstate id at a position
+        /// @param pos Position in world coordinates
+        /// @param id Output blockstate id
+        /// @return False if the section is not in the store, or was being written for too long
+        const bool GetBlockstateId(const Position& pos, unsigned short& id) const;
+
+        /// @brief Get the blockstate at a position
+        /// @param pos Position in world coordinates
+        /// @return The blockstate, nullptr if the section is not in the store
+        const Blockstate* GetBlockstate(const Position& pos) const;
+
+        /// @brief Copy all the blockstate ids of a section
+        /// @param x X section coordinate (chunk coordinate)
+        /// @param y Y section coordinate (world y / SECTION_HEIGHT, can be negative)
+        /// @param z Z section coordinate (chunk coordinate)
+        /// @param ids Output ids, in y, z, x order
+        /// @return False if the section is not in the store, or was being written for too long
+        const bool ReadSection(const int x, const int y, const int z, std::array<unsigned short, Section::NUM_BLOCKS>& ids) const;
+
+    private:
+        struct Header;
+        struct Slot;
+
+        /// @brief Find the slot of a section
+        /// @return The slot index, -1 if the section has no slot
+        const int FindSlot(const int x, const int y, const int z) const;
+        /// @brief Find the slot of a section, allocating it if needed
+        /// @return The slot index, -1 if the store is full or the table stayed locked too long
+        const int FindOrAddSlot(const int x, const int y, const int z);
+
+        /// @brief Copy blocks of a slot, waiting at most a short time if they are being written
+        /// @param slot_index Index of the slot
+        /// @param offset Index of the first block to copy
+        /// @param count Number of blocks to copy
+        /// @param output Copied blockstate ids
+        /// @return False if the slot was never written or stayed locked too long
+        const bool ReadSlot(const int slot_index, const size_t offset, const size_t count, unsigned short* output) const;
+
+        /// @brief Get the blocks of a slot
+        unsigned short* GetSlotData(const int slot) const;
+
+        /// @brief Create the header of a new file. File must be mapped
+        void InitHeader(const unsigned int max_sections);
+        /// @brief Check the header of an existing file. File must be mapped
+        void CheckHeader() const;
+
+    private:
+        struct Mapping;
+
+        std::string path;
+        std::string dimension;
+        bool writable;
+
+        std::unique_ptr<Mapping> mapping;
+        Header* header;
+        Slot* slots;
+        unsigned short* blocks;
+    };
+} // Botcraft
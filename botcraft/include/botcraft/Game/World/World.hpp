@@ -1,14 +1,24 @@
 #pragma once
 
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <array>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <set>
+#include <optional>
 
 #include "botcraft/Game/Vector3.hpp"
 #include "botcraft/Game/Enums.hpp"
+#include "botcraft/Game/EventNotifier.hpp"
 #include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/WorldSnapshot.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
 
 #include "protocolCraft/Types/NBT/NBT.hpp"
 #include "protocolCraft/Handler.hpp"
@@ -18,6 +28,48 @@ namespace Botcraft
     class Block;
     class Blockstate;
     class AsyncHandler;
+    class ChunkCache;
+    class SharedWorldStore;
+
+    struct WorldStats
+    {
+        /// @brief Number of loaded chunks
+        size_t num_chunks = 0;
+        /// @brief Number of sections in the loaded chunks
+        size_t num_sections = 0;
+        /// @brief Estimation of the memory used by the loaded chunks, in bytes
+        size_t memory_bytes = 0;
+        /// @brief Part of memory_bytes used by the sections blocks
+        size_t sections_memory_bytes = 0;
+        /// @brief Part of memory_bytes used by the sections light
+        size_t light_memory_bytes = 0;
+        /// @brief Part of memory_bytes used by the block entities and their NBT
+        size_t block_entities_memory_bytes = 0;
+        /// @brief Number of chunks forgotten by the server and still kept in memory
+        size_t num_forgotten_chunks = 0;
+        /// @brief Estimation of the memory used by the forgotten chunks, in bytes
+        size_t forgotten_memory_bytes = 0;
+    };
+
+    /// @brief A block modification recorded in the world block changes journal
+    struct BlockChange
+    {
+        /// @brief Sequence number of the change, strictly increasing
+        unsigned long long sequence;
+        Position pos;
+        /// @brief Blockstate before the change, nullptr if there was no section
+        const Blockstate* old_state;
+        const Blockstate* new_state;
+    };
+
+    /// @brief Result of one ray of World::RaycastBatch
+    struct RaycastHit
+    {
+        /// @brief Blockstate of the hit cube, nullptr if nothing was hit
+        const Blockstate* blockstate = nullptr;
+        Position pos;
+        Position normal;
+    };
 
     class World : public ProtocolCraft::Handler
     {
@@ -27,26 +79,119 @@ namespace Botcraft
         // when they are in the same area, but slowing things down
         // if too many share the same instance
         //
-        // if async_handler_ is true, all packets will be copied
-        // and processed on another specific thread instead of
+        // if async_handler_ is true, all packets will be
+        // processed on another specific thread instead of
         // directly on the main network processing thread
-        // This adds a **lot** of copy but can prevent some timeouts
-        // when CPU is too slow to cope with all chunk data sent
-        // when loading a dimension
-        World(const bool is_shared_, const bool async_handler_ = false);
+        // Decoded packets are shared with this thread, not copied,
+        // this can prevent some timeouts when CPU is too slow
+        // to cope with all chunk data sent when loading a dimension
+        //
+        // if num_chunk_decode_threads_ is > 0, chunk data packets
+        // are decoded into new chunks by this number of worker
+        // threads, and only added to the world once decoded
+        // (1.18+ only, ignored for older versions)
+        //
+        // if store_light_ is false, light data sent by the server
+        // are ignored (1.14+ only) and all light values are 0,
+        // saving memory and CPU for bots that never read them
+        World(const bool is_shared_, const bool async_handler_ = false, const unsigned int num_chunk_decode_threads_ = 0, const bool store_light_ = true);
         ~World();
 
         std::mutex& GetMutex();
+        /// @brief Get the notifier signaled when blocks or chunks change
+        const EventNotifier& GetEventNotifier() const;
         const bool IsShared() const;
 
+        /// @brief Get the number of chunks and memory used by this world.
+        /// Iterates over all the chunks, don't call it too often
+        const WorldStats GetStats();
+
+        /// @brief Get a read-only snapshot of the world, as of the last
+        /// PublishSnapshot call. Can be called, and the snapshot used,
+        /// without locking the world mutex
+        /// @return The current snapshot
+        const WorldSnapshot GetSnapshot() const;
+
+        /// @brief Make all the modifications done since the last call visible
+        /// in new snapshots. Called automatically after each world packet, but
+        /// it must be called manually after modifying the world directly
+        /// (AddChunk, SetBlock...). World mutex must be locked by the caller
+        void PublishSnapshot();
+
         ProtocolCraft::Handler* GetAsyncHandler();
 
+        /// @brief Set a disk cache for the chunks. Unloaded chunks are
+        /// saved in it, and when joining a dimension, the cached chunks
+        /// in view distance are added before the server sends them
+        /// (1.14+). Chunks sent by the server then replace them.
+        /// @param cache The cache to use, nullptr to disable it
+        void SetChunkCache(const std::shared_ptr<ChunkCache>& cache);
+
+        /// @brief Set a store shared with other processes. If the store is
+        /// writable, the chunks of its dimension are written in it each time
+        /// they are published (see PublishSnapshot), so processes mapping it
+        /// read-only can use them without storing their own copy
+        /// @param store The store to use, nullptr to disable it
+        void SetSharedStore(const std::shared_ptr<SharedWorldStore>& store);
+
+        /// @brief Keep the chunks forgotten by the server, or left behind when
+        /// changing dimension, in memory, up to a memory budget, evicting the
+        /// least recently forgotten first. They are not part of the world
+        /// anymore, but when the server sends one of them again (even after
+        /// going back and forth through a portal), it's updated in place
+        /// instead of being created from scratch. Data not sent again (light, and before 1.18, empty
+        /// sections) keep their previous value, like when the server resends
+        /// a loaded chunk
+        /// @param max_bytes Max estimated memory of the forgotten chunks, 0 to drop them right away
+        void SetForgottenChunksBudget(const size_t max_bytes);
+
+#if PROTOCOL_VERSION > 471
+        /// @brief Only keep the chunks close to the chunk the server centers
+        /// the view on. Chunks further than radius are dropped when the
+        /// center moves, and the data received for them ignored, saving
+        /// decode time and memory. Ignored for shared worlds, as other bots
+        /// may need these chunks.
+        /// @param radius Max distance in chunks on each axis, negative to keep all the chunks sent by the server
+        void SetInterestRadius(const int radius);
+#endif
+
+        /// @brief Save all the loaded chunks (blocks, light, biomes and
+        /// block entities) in a compact binary file that can be loaded
+        /// back with Load. The format depends on the protocol version
+        /// @param path Path of the file to write
+        /// @param compressed If true, data are compressed with zlib (requires USE_COMPRESSION)
+        /// @return True if the file was written successfully
+        bool Save(const std::string& path, const bool compressed = true);
+
+        /// @brief Replace the whole world with the content of a file created by Save
+        /// @param path Path of the file to read
+        /// @return True if the file was loaded successfully
+        bool Load(const std::string& path);
+
+        /// @brief Replace the whole world with data created by Save. The data are
+        /// only read during the call, so they can be a memory mapped file
+        /// @param data Pointer to the data
+        /// @param size Size of the data
+        /// @return True if the data were loaded successfully
+        bool Load(const unsigned char* data, const size_t size);
+
 #if PROTOCOL_VERSION < 719
         bool AddChunk(const int x, const int z, const Dimension dim);
 #else
         bool AddChunk(const int x, const int z, const std::string& dim);
 #endif
         bool RemoveChunk(const int x, const int z);
+        /// @brief Add a chunk received from outside of the server connection
+        /// (e.g. another process, see SwarmCoordinator). The data sent by the
+        /// server for this chunk then update it. World mutex must be locked
+        /// by the caller, and PublishSnapshot called after
+        /// @param x X chunk coordinate
+        /// @param z Z chunk coordinate
+        /// @param chunk The chunk, must be in the current dimension
+        /// @param expected_version Blocks version of the loaded chunk to replace,
+        /// 0 to only add the chunk if it's not loaded
+        /// @return True if the chunk has been added
+        bool AddExternalChunk(const int x, const int z, const std::shared_ptr<Chunk>& chunk, const unsigned long long expected_version = 0);
 
 #if USE_GUI
         const bool HasChunkBeenModified(const int x, const int z);
@@ -73,12 +218,21 @@ namespace Botcraft
 #if PROTOCOL_VERSION > 551 && PROTOCOL_VERSION < 757
         bool LoadBiomesInChunk(const int x, const int z, const std::vector<int>& biomes);
 #endif
+#if PROTOCOL_VERSION > 442
+        bool LoadHeightmapsInChunk(const int x, const int z, const ProtocolCraft::NBT& heightmaps);
+#endif
 
-        // Update the neighbour blocks of this chunk and the
-        // one in the specified direction, if direction is 0,0,0
-        // then update all neighbours chunks
+        // Flag the neighbour chunk in the specified direction
+        // as modified for the renderer, if direction is 0,0,0
+        // then flag all neighbours chunks
         void UpdateChunk(const int x, const int z, const Position& pos = Position());
 
+        /// @brief Get a read-only copy of a chunk, usable without the lock. World mutex
+        /// must be locked by the caller. The copy shares all its data with the world
+        /// chunk (copy on write), and is the published snapshot chunk if it's up to date
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @return The copy, nullptr if the chunk is not loaded
         const std::shared_ptr<const Chunk> GetChunkCopy(const int x, const int z);
 
 #if PROTOCOL_VERSION < 347
@@ -86,8 +240,75 @@ namespace Botcraft
 #else
         bool SetBlock(const Position &pos, const unsigned int id, const int model_id = -1);
 #endif
-        //Get the block at a given position
+        /// @brief Set multiple blocks of one chunk. The chunk is resolved, flagged as
+        /// modified and its neighbours updated only once for the whole batch
+        /// @param chunk_x X chunk coordinate
+        /// @param chunk_z Z chunk coordinate
+        /// @param blocks (position in the chunk, raw blockstate id) of each block,
+        /// pre-1.13 raw ids are id << 4 | metadata
+        /// @return False if the chunk is not loaded
+        bool SetBlocksInChunk(const int chunk_x, const int chunk_z, const std::vector<std::pair<Position, unsigned int> >& blocks);
+
+        /// @brief Record each individual block change in a ring journal, so
+        /// derived structures can be updated incrementally with GetBlockChanges
+        /// @param capacity Max number of changes kept, 0 to disable the journal (default)
+        void SetBlockChangesJournalSize(const size_t capacity);
+        /// @brief Get the block changes recorded since a given one. Whole chunk loads
+        /// and unloads are not recorded, use GetChunkBlocksVersion and ChunkLoaded/
+        /// ChunkUnloaded events for them
+        /// @param since Sequence number of the last change already processed, 0 for all
+        /// @param changes Output, changes with a sequence number greater than since, in order
+        /// @return False if some of the requested changes are not in the journal anymore, a full rescan is needed
+        const bool GetBlockChanges(const unsigned long long since, std::vector<BlockChange>& changes);
+        /// @brief Get the version of the blocks of a chunk, that changes each time one of its blocks
+        /// is modified (see Chunk::GetBlocksVersion). World mutex must be locked by the caller
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @return The version, 0 if the chunk is not loaded
+        const unsigned long long GetChunkBlocksVersion(const int x, const int z);
+        // Get the block at a given position, world mutex must be
+        // locked by the caller. The pointer is only valid while the
+        // lock is held, as setting a block can compact the palette of
+        // its section: copy the blockstate to keep it longer.
+        // For read-only accesses, prefer GetSnapshot().GetBlock(pos),
+        // which doesn't need the lock and so can run concurrently with
+        // other readers
         const Block* GetBlock(const Position& pos);
+
+        /// @brief Get the Y of the highest block of a column, using the chunk
+        /// heightmaps instead of scanning down. World mutex must be locked by
+        /// the caller, GetSnapshot().GetHighestBlock doesn't need the lock
+        /// @param x X world coordinate
+        /// @param z Z world coordinate
+        /// @param type Which blocks are counted
+        /// @return The Y of the block, min y - 1 if the column is empty,
+        /// std::numeric_limits<int>::min() if the chunk is not loaded
+        const int GetHighestBlock(const int x, const int z, const HeightmapType type);
+
+        /// @brief Call a function for all the non-air blocks in
+        /// a box. The world mutex is locked only once during the
+        /// whole scan, so it must *not* be locked by the caller.
+        /// Blocks are visited in memory order, not in x, y, z order
+        /// @param start First corner of the box (included)
+        /// @param end Second corner of the box (included)
+        /// @param callback Called with the position and the block
+        /// @param filter If set, only blocks with a blockstate matching the filter are visited.
+        /// It is evaluated once per distinct block in each section, not once per position
+        void ForEachBlockInBox(const Position& start, const Position& end,
+            const std::function<void(const Position&, const Block&)>& callback,
+            const std::function<bool(const Blockstate*)>& filter = nullptr);
+
+        /// @brief Find the closest non-air block matching a filter. The
+        /// world mutex is locked during the search, so it must *not*
+        /// be locked by the caller. Sections without any matching block
+        /// are skipped entirely, and the search stops as soon as the
+        /// remaining sections are further than the best match
+        /// @param filter The filter the block must match
+        /// @param origin Position to search around
+        /// @param radius Max euclidean distance between origin and the block
+        /// @return The position of the closest matching block, if any
+        const std::optional<Position> FindNearest(const std::function<bool(const Blockstate*)>& filter,
+            const Position& origin, const int radius);
         const bool IsLoaded(const Position& pos) const;
 
         const int GetHeight() const;
@@ -150,16 +371,136 @@ namespace Botcraft
         const Blockstate* Raycast(const Vector3<double> &origin, const Vector3<double> &direction,
             const float max_radius, Position &out_pos, Position &out_normal);
 
+        /// @brief Perform multiple raycasts at once, e.g. towards all the entities around a bot.
+        /// The rays are traced in the current snapshot, so the world mutex doesn't need to be
+        /// locked, and chunks are looked up only once for all the rays
+        /// @param rays (origin, direction) of each ray, directions must not be null
+        /// @param max_radius maximum distance of the search, must be > 0
+        /// @return One result per ray, in the same order
+        std::vector<RaycastHit> RaycastBatch(const std::vector<std::pair<Vector3<double>, Vector3<double> > >& rays, const float max_radius);
+
+        /// @brief Check if there is no block between an eye and some targets.
+        /// Results are cached by (eye block, target block) for a short time (see
+        /// SetLineOfSightCacheDuration), and until one of the chunks crossed by the ray
+        /// is modified. The world mutex doesn't need to be locked
+        /// @param eye Origin of the rays
+        /// @param targets Points to check
+        /// @return One value per target, true if the segment between eye and target doesn't hit any block
+        std::vector<bool> HasLineOfSight(const Vector3<double>& eye, const std::vector<Vector3<double> >& targets);
+        const bool HasLineOfSight(const Vector3<double>& eye, const Vector3<double>& target);
+        /// @brief Set how long a line of sight result can be reused. As they are cached by blocks,
+        /// results can be a bit off when the eye or the target move inside their block
+        /// @param duration_ms Max age of a cached result in game time, 0 to disable the cache
+        void SetLineOfSightCacheDuration(const int duration_ms);
+
         // Get the list of chunks
-        const std::map<std::pair<int, int>, std::shared_ptr<Chunk> >& GetAllChunks() const;
+        const std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, ChunkCoordinatesHasher>& GetAllChunks() const;
 
 
 #if PROTOCOL_VERSION > 758
         const int GetNextWorldInteractionSequenceId();
+        /// @brief Apply a block change locally before the server confirms it, so the next
+        /// actions can be planned without waiting one round trip. Server updates of this block
+        /// are held back until the server acknowledges the sequence id, then the last one
+        /// received is applied, rolling back the change if the server refused it. Ignored in
+        /// shared worlds, as the acknowledgements of the bots can't be told apart.
+        /// World mutex must be locked by the caller
+        /// @param pos Position of the block
+        /// @param blockstate_id Predicted blockstate
+        /// @param sequence_id Sequence id sent with the interaction, from GetNextWorldInteractionSequenceId
+        void PredictBlockChange(const Position& pos, const unsigned int blockstate_id, const int sequence_id);
+        /// @brief Get the last interaction sequence id acknowledged by the server. World mutex must be locked by the caller
+        const int GetLastAcknowledgedSequenceId() const;
 #endif
 
     private:
         std::shared_ptr<Chunk> GetChunk(const int x, const int z);
+#if PROTOCOL_VERSION > 404
+#if PROTOCOL_VERSION < 755
+        static void LoadLightInChunk(Chunk* chunk, const int light_mask, const int empty_light_mask, const std::vector<std::vector<char> >& data, const bool sky);
+#else
+        static void LoadLightInChunk(Chunk* chunk, const std::vector<unsigned long long int>& light_mask, const std::vector<unsigned long long int>& empty_light_mask,
+            const std::vector<std::vector<char> >& data, const bool sky);
+#endif
+#endif
+#if PROTOCOL_VERSION > 756
+        /// @brief Worker thread function decoding chunk data packets
+        void DecodeChunks();
+        /// @brief If chunk x, z is being decoded, store the update
+        /// to apply it once the chunk is added. World mutex must be locked
+        /// @return True if the update has been deferred, false if it should be applied now
+        const bool DeferChunkUpdate(const int x, const int z, const std::function<void()>& update);
+#endif
+        /// @brief Mark a chunk so it's updated in the next published snapshot
+        void SetChunkModified(const int x, const int z);
+        /// @brief Add a change in the block changes journal, if enabled. World mutex must be locked
+        void RecordBlockChange(const Position& pos, const Blockstate* old_state, const Blockstate* new_state);
+
+        /// @brief Get the name of the current dimension for the chunk cache
+        const std::string GetCacheDimensionName() const;
+        /// @brief Save a loaded chunk in the chunk cache, if any. World mutex must be locked
+        void SaveChunkToCache(const int x, const int z);
+
+        /// @brief Remove a chunk from the world, keeping it in the forgotten
+        /// chunks if the budget allows it. World mutex must be locked
+        void ForgetChunk(const int x, const int z);
+        /// @brief Keep all the loaded chunks in the forgotten chunks if the budget
+        /// allows it, and clear the world. World mutex must be locked
+        void ForgetAllChunks();
+        /// @brief Remove a chunk from the forgotten chunks. World mutex must be locked
+        /// @return The chunk, nullptr if it's not there
+#if PROTOCOL_VERSION < 719
+        std::shared_ptr<Chunk> TakeForgottenChunk(const Dimension dim, const int x, const int z);
+#else
+        std::shared_ptr<Chunk> TakeForgottenChunk(const std::string& dim, const int x, const int z);
+#endif
+        /// @brief Add a chunk in the forgotten chunks, without checking the budget. World mutex must be locked
+        void AddForgottenChunk(const int x, const int z, const std::shared_ptr<Chunk>& chunk);
+        /// @brief Drop the least recently forgotten chunks until they fit in the budget. World mutex must be locked
+        void EvictForgottenChunks();
+        /// @brief Drop all the forgotten chunks. World mutex must be locked
+        void ClearForgottenChunks();
+
+        /// @brief Check which palette entries of a section are non-air and match a filter
+        /// @param section The section to check
+        /// @param filter The filter, nullptr to match all non-air blocks
+        /// @param matching_entries Output, true for each matching entry of the section palette
+        /// @return True if at least one entry matches
+        static const bool GetMatchingPaletteEntries(const Section* section,
+            const std::function<bool(const Blockstate*)>& filter, std::vector<bool>& matching_entries);
+
+    public:
+        /// @brief All the message types processed by World
+        using HandledMessages = std::tuple<
+            ProtocolCraft::ClientboundLoginPacket,
+            ProtocolCraft::ClientboundRespawnPacket,
+            ProtocolCraft::ClientboundBlockUpdatePacket,
+            ProtocolCraft::ClientboundSectionBlocksUpdatePacket,
+            ProtocolCraft::ClientboundForgetLevelChunkPacket,
+#if PROTOCOL_VERSION < 757
+            ProtocolCraft::ClientboundLevelChunkPacket,
+#else
+            ProtocolCraft::ClientboundLevelChunkWithLightPacket,
+#endif
+#if PROTOCOL_VERSION > 404
+            ProtocolCraft::ClientboundLightUpdatePacket,
+#endif
+#if PROTOCOL_VERSION > 471
+            ProtocolCraft::ClientboundSetChunkCacheCenterPacket,
+#endif
+#if PROTOCOL_VERSION > 758
+            ProtocolCraft::ClientboundBlockChangedAckPacket,
+#endif
+            ProtocolCraft::ClientboundBlockEntityDataPacket
+        >;
+
+    private:
+#if PROTOCOL_VERSION > 471
+        /// @brief Check if a chunk is too far from the view center to be kept. world_mutex must be locked
+        bool IsOutsideInterest(const int x, const int z) const;
+        /// @brief Remove all the chunks too far from the view center. world_mutex must be locked
+        void DropChunksOutsideInterest();
+#endif
 
     protected:
         virtual void Handle(ProtocolCraft::ClientboundLoginPacket& msg) override;
@@ -174,6 +515,12 @@ namespace Botcraft
 #endif
 #if PROTOCOL_VERSION > 404
         virtual void Handle(ProtocolCraft::ClientboundLightUpdatePacket& msg) override;
+#endif
+#if PROTOCOL_VERSION > 471
+        virtual void Handle(ProtocolCraft::ClientboundSetChunkCacheCenterPacket& msg) override;
+#endif
+#if PROTOCOL_VERSION > 758
+        virtual void Handle(ProtocolCraft::ClientboundBlockChangedAckPacket& msg) override;
 #endif
         virtual void Handle(ProtocolCraft::ClientboundBlockEntityDataPacket& msg) override;
 
@@ -181,11 +528,83 @@ namespace Botcraft
         int cached_x;
         int cached_z;
         std::mutex world_mutex;
+        EventNotifier event_notifier;
         std::shared_ptr<Chunk> cached;
 
-        std::map<std::pair<int, int>, std::shared_ptr<Chunk> > terrain;
+        std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, ChunkCoordinatesHasher> terrain;
+        /// @brief Published read-only copy of terrain, chunks share
+        /// their sections with the ones in terrain until modified.
+        /// Must be accessed with std::atomic_load/std::atomic_store
+        std::shared_ptr<const WorldSnapshot::Regions> terrain_snapshot;
+        /// @brief Chunks modified since the last PublishSnapshot
+        std::set<std::pair<int, int> > modified_chunks;
 
         bool is_shared;
+        bool store_light;
+
+        /// @brief A chunk forgotten by the server and kept in memory
+        struct ForgottenChunk
+        {
+            std::pair<int, int> coords;
+            std::shared_ptr<Chunk> chunk;
+            /// @brief Estimated memory when it was forgotten
+            size_t memory_bytes;
+        };
+        /// @brief Max memory of forgotten_chunks, in bytes
+        size_t forgotten_chunks_budget;
+        size_t forgotten_chunks_memory;
+        /// @brief Most recently forgotten first
+        std::list<ForgottenChunk> forgotten_chunks;
+        /// @brief Forgotten chunks of each dimension
+#if PROTOCOL_VERSION < 719
+        std::map<Dimension, std::unordered_map<std::pair<int, int>, std::list<ForgottenChunk>::iterator, ChunkCoordinatesHasher> > forgotten_chunks_index;
+#else
+        std::map<std::string, std::unordered_map<std::pair<int, int>, std::list<ForgottenChunk>::iterator, ChunkCoordinatesHasher> > forgotten_chunks_index;
+#endif
+
+        /// @brief Ring buffer of the last block changes, empty if the journal is disabled
+        std::vector<BlockChange> block_changes;
+        /// @brief Sequence number of the last recorded change
+        unsigned long long last_block_change;
+        /// @brief Sequence number of the first change recorded with the current journal
+        unsigned long long first_block_change;
+
+        /// @brief A cached HasLineOfSight result
+        struct LineOfSightEntry
+        {
+            bool visible;
+            VirtualClock::time_point computed;
+            /// @brief (coordinates, blocks version) of the chunks crossed by the ray
+            std::vector<std::pair<std::pair<int, int>, unsigned long long> > chunk_versions;
+        };
+        struct LineOfSightKeyHasher
+        {
+            size_t operator()(const std::pair<Position, Position>& key) const
+            {
+                const size_t h = std::hash<Position>()(key.first);
+                return h ^ (std::hash<Position>()(key.second) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+            }
+        };
+        std::mutex line_of_sight_mutex;
+        std::unordered_map<std::pair<Position, Position>, LineOfSightEntry, LineOfSightKeyHasher> line_of_sight_cache;
+        std::chrono::milliseconds line_of_sight_duration;
+
+        std::shared_ptr<ChunkCache> chunk_cache;
+        std::shared_ptr<SharedWorldStore> shared_store;
+        /// @brief Chunks with sections that couldn't be written in the shared store, fully written at their next publication
+        std::set<std::pair<int, int> > incomplete_shared_chunks;
+        /// @brief True if the cached chunks have already been loaded in the current dimension
+        bool chunk_cache_loaded;
+        /// @brief Server view distance, in chunks
+        int chunk_cache_radius;
+#if PROTOCOL_VERSION > 471
+        /// @brief Max distance to the view center of the kept chunks, negative to keep all
+        int interest_radius;
+        /// @brief True if the server already sent the view center in the current dimension
+        bool has_interest_center;
+        int interest_center_x;
+        int interest_center_z;
+#endif
 #if PROTOCOL_VERSION < 719
         Dimension current_dimension;
 #else
@@ -201,6 +620,37 @@ namespace Botcraft
 
 #if PROTOCOL_VERSION > 758
         int world_interaction_sequence_id;
+        int last_acknowledged_sequence_id;
+        /// @brief A block changed locally, not acknowledged by the server yet
+        struct PredictedBlock
+        {
+            /// @brief Sequence id of the last interaction predicting this block
+            int sequence_id;
+            /// @brief Last blockstate sent by the server for this block
+            unsigned int server_blockstate_id;
+        };
+        std::unordered_map<Position, PredictedBlock> predicted_blocks;
+#endif
+
+#if PROTOCOL_VERSION > 756
+        struct ChunkDecodeJob
+        {
+            std::shared_ptr<ProtocolCraft::ClientboundLevelChunkWithLightPacket> msg;
+            std::string dimension;
+            int min_y;
+            unsigned int height;
+            unsigned long long int id;
+        };
+        std::vector<std::thread> chunk_decode_threads;
+        std::queue<ChunkDecodeJob> chunk_decode_jobs;
+        std::mutex chunk_decode_mutex;
+        std::condition_variable chunk_decode_condition;
+        bool decoding_chunks;
+        unsigned long long int next_chunk_decode_id;
+        /// @brief Id of the last decode job of each chunk not added yet, protected by world mutex
+        std::unordered_map<std::pair<int, int>, unsigned long long int, ChunkCoordinatesHasher> pending_chunk_decodes;
+        /// @brief Updates received while their chunk was decoded, protected by world mutex
+        std::unordered_map<std::pair<int, int>, std::vector<std::function<void()> >, ChunkCoordinatesHasher> deferred_chunk_updates;
 #endif
     };
 } // Botcraft
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <limits>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+
+namespace Botcraft
+{
+    class Block;
+
+    /// @brief A read-only view of the world at a given time.
+    /// Chunks of a snapshot are never modified, so it can be
+    /// used without locking the world mutex. Block pointers
+    /// are valid as long as the snapshot object exists.
+    /// A WorldSnapshot is cheap to get but should not be shared
+    /// between threads, as it caches the last accessed chunk.
+    class WorldSnapshot
+    {
+    public:
+        using ChunksMap = std::unordered_map<std::pair<int, int>, std::shared_ptr<const Chunk>, ChunkCoordinatesHasher>;
+
+        /// @brief Chunks of a snapshot, grouped by regions of REGION_WIDTH x REGION_WIDTH
+        /// chunks. A region map is shared by the successive snapshots until one of its
+        /// chunks changes, so publishing a snapshot only copies the modified regions
+        struct Regions
+        {
+            static constexpr int REGION_WIDTH = 8;
+            /// @brief Get the region coordinate of a chunk coordinate
+            static const int ChunkToRegion(const int c);
+
+            /// @brief Region coordinates --> chunks of the region
+            std::unordered_map<std::pair<int, int>, std::shared_ptr<const ChunksMap>, ChunkCoordinatesHasher> maps;
+            /// @brief All the chunks in one map, built by the first GetAllChunks call
+            mutable std::once_flag all_chunks_flag;
+            mutable ChunksMap all_chunks;
+        };
+
+        /// @brief Bits written by FillBlockFlags
+        static constexpr unsigned char FLAG_LOADED = 1 << 0;
+        static constexpr unsigned char FLAG_NOT_AIR = 1 << 1;
+        static constexpr unsigned char FLAG_SOLID = 1 << 2;
+        static constexpr unsigned char FLAG_FLUID = 1 << 3;
+        static constexpr unsigned char FLAG_TRANSPARENT = 1 << 4;
+
+        /// @brief Create a snapshot from a map of chunks
+        WorldSnapshot(const std::shared_ptr<const ChunksMap>& chunks_);
+        WorldSnapshot(const std::shared_ptr<const Regions>& regions_);
+
+        /// @brief Check if two snapshots come from the same publication of the world,
+        /// i.e. no chunk was loaded, unloaded or modified between them
+        const bool IsSame(const WorldSnapshot& other) const;
+
+        /// @brief Get the block at a given position
+        /// @param pos Position of the block, in world coordinates
+        /// @return A pointer to the block, nullptr if not loaded. Valid as long
+        /// as this snapshot exists, the World copies a shared section before
+        /// modifying it so its palette is never compacted under the snapshot
+        const Block* GetBlock(const Position& pos) const;
+        const bool IsLoaded(const Position& pos) const;
+
+        /// @brief Get the Y of the highest block of a column, from the chunk heightmaps
+        /// @param x X world coordinate
+        /// @param z Z world coordinate
+        /// @param type Which blocks are counted
+        /// @return The Y of the block, min y - 1 if the column is empty,
+        /// std::numeric_limits<int>::min() if the chunk is not loaded
+        const int GetHighestBlock(const int x, const int z, const HeightmapType type) const;
+        /// @brief Get the highest blocks Y of all the columns of an area at once
+        /// @param min_x X world coordinate of the first column
+        /// @param min_z Z world coordinate of the first column
+        /// @param size_x Number of columns along X
+        /// @param size_z Number of columns along Z
+        /// @param type Which blocks are counted
+        /// @return size_x * size_z values as returned by GetHighestBlock, indexed by (z - min_z) * size_x + (x - min_x)
+        const std::vector<int> GetHighestBlocks(const int min_x, const int min_z, const int size_x, const int size_z, const HeightmapType type) const;
+
+        /// @brief Fill a buffer with the blockstate ids of all the blocks in a box,
+        /// e.g. to build observations around a bot. Each palette entry of a section
+        /// is converted only once, and uniform or missing sections are filled by rows
+        /// @param min_corner Min corner of the box (included)
+        /// @param size Number of blocks of the box along each axis
+        /// @param output Buffer of size.x * size.y * size.z values, filled in y, z, x order:
+        /// ((y - min_corner.y) * size.z + (z - min_corner.z)) * size.x + (x - min_corner.x).
+        /// Positions above or below the world are air (id 0). Ids are Blockstate::IdMetadataToId before 1.13
+        /// @param unloaded_id Value written for the positions in unloaded chunks
+        void FillBlockstateIds(const Position& min_corner, const Position& size, unsigned short* output,
+            const unsigned short unloaded_id = std::numeric_limits<unsigned short>::max()) const;
+
+        /// @brief Same as FillBlockstateIds, with a combination of FLAG_* bits per block instead of its id.
+        /// Positions in unloaded chunks are 0, positions above or below the world are FLAG_LOADED | FLAG_TRANSPARENT
+        void FillBlockFlags(const Position& min_corner, const Position& size, unsigned char* output) const;
+
+        const std::shared_ptr<const Chunk> GetChunk(const int x, const int z) const;
+        /// @brief Get all the chunks in one map. It is built on the first call for
+        /// each published snapshot, prefer GetChunk to access a few chunks
+        const ChunksMap& GetAllChunks() const;
+
+        /// @brief Write all the chunks of this snapshot with Chunk::Write, e.g. to
+        /// save a world once and use it later in a FakeServer for offline runs
+        /// @param container Container to append the data to
+        void Write(ProtocolCraft::WriteContainer& container) const;
+
+        /// @brief Create a snapshot from data previously created by Write
+        /// @param iter Data to read
+        /// @param length Size of the remaining data
+        /// @return The loaded snapshot, throws a std::runtime_error if data are invalid
+        static WorldSnapshot Read(ProtocolCraft::ReadIterator& iter, size_t& length);
+
+    private:
+        /// @brief Find a chunk without copying its shared_ptr
+        /// @return The chunk, nullptr if not loaded
+        const Chunk* FindChunk(const int x, const int z) const;
+
+    private:
+        std::shared_ptr<const Regions> regions;
+
+        mutable int cached_x;
+        mutable int cached_z;
+        mutable const Chunk* cached;
+    };
+} // Botcraft
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Botcraft
+{
+    class BehaviourClient;
+
+    /// @brief An embedded TCP endpoint to control the bots of this process
+    /// from an external program, without going through the game chat.
+    /// Requests are processed by a dedicated thread, which never waits for the
+    /// behaviours. A client can send several requests without waiting for the
+    /// answers, which can then come in a different order than the requests.
+    ///
+    /// Each frame is a big endian int size followed by the payload. A request
+    /// payload is a VarInt type, a VarInt request id and the body; the answer
+    /// is the same type and request id, a bool (true if ok), then the answer
+    /// body or a string error. Strings are VarInt size + UTF-8 bytes.
+    /// Bots are selected by a VarInt count followed by their names, 0 for all the bots.
+    /// Values are a VarInt tag then the value: 0 none, 1 bool, 2 int (4 bytes),
+    /// 3 float, 4 double, 5 string, 6 position (3 ints).
+    ///  - 1 ListBots: no body. Answer: VarInt count, then name and bool connected per bot
+    ///  - 2 SetBlackboard: bots, VarInt count, then key (string) and value per entry, none to erase.
+    ///    Answer: VarInt number of bots. Values are applied on the behaviour thread before its next step
+    ///  - 3 SetTree: bots, string tree name. Answer: VarInt number of bots
+    ///  - 4 Query: bots, VarInt count, then key (string) and VarInt tag per blackboard value to read.
+    ///    Answer: VarInt count, then per bot name, bool connected, 3 doubles position, float health,
+    ///    VarInt food, bool blackboard_read and, if true, one value per requested key (none if
+    ///    absent or with a different type). Blackboards are read on the behaviour thread, blackboard_read
+    ///    is false for bots that didn't step their behaviour before the query timeout
+    class ControlServer
+    {
+    public:
+        /// @brief Get the bots to control
+        using BotsGetter = std::function<std::vector<std::shared_ptr<BehaviourClient> >()>;
+        /// @brief Set a tree to a bot, return false if the tree name is unknown
+        using TreeSetter = std::function<bool(BehaviourClient& bot, const std::string& tree_name)>;
+
+        /// @brief Start listening
+        /// @param port TCP port to listen on
+        /// @param get_bots_ Called for each request to get the bots
+        /// @param set_tree_ Called by SetTree requests, nullptr if trees can't be changed
+        /// @param address Address to listen on, local only by default as there is no authentication
+        /// @param query_timeout_ Max time to wait for the behaviours to read their blackboard in a Query
+        ControlServer(const unsigned short port, const BotsGetter& get_bots_, const TreeSetter& set_tree_ = nullptr,
+            const std::string& address = "127.0.0.1", const std::chrono::milliseconds& query_timeout_ = std::chrono::milliseconds(100));
+        ~ControlServer();
+
+        ControlServer(const ControlServer&) = delete;
+        ControlServer& operator=(const ControlServer&) = delete;
+
+    private:
+        // Keeps asio out of this header
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
+} // Botcraft
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "protocolCraft/Types/Slot.hpp"
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class WorldSnapshot;
+
+    struct FakeServerConfig
+    {
+        /// @brief TCP port to listen on
+        unsigned short port = 25565;
+        /// @brief Address to listen on
+        std::string address = "127.0.0.1";
+        /// @brief Number of network threads
+        unsigned int num_threads = 1;
+        /// @brief Compression threshold sent at login, -1 to disable compression
+        int compression_threshold = 256;
+        /// @brief Radius of the square of chunks sent around spawn at login
+        int view_distance = 4;
+        /// @brief Number of chunks of the view area sent again to each player per second, to stream chunk data
+        double chunks_per_second = 0.0;
+        /// @brief Number of mobs wandering around spawn, shared by all the players
+        int num_entities = 32;
+        /// @brief Number of moves per second of each mob
+        double entity_moves_per_second = 5.0;
+        /// @brief Interval between two keep alive packets sent to each player
+        double keep_alive_interval_s = 1.0;
+        /// @brief A player is disconnected if more than this number of bytes are waiting to be sent to it
+        size_t max_pending_bytes = 64 * 1024 * 1024;
+
+        /// @brief If not nullptr, the players are sent the chunks of this world (e.g. a
+        /// World::GetSnapshot() saved from a real server) instead of a flat one, and
+        /// the server keeps it up to date with the blocks they break and place
+        std::shared_ptr<const WorldSnapshot> world;
+        /// @brief Position of the players at login, and center of the mobs area
+        Vector3<double> spawn_position = Vector3<double>(0.5, 0.0, 0.5);
+        /// @brief Game mode of the players (0 survival, 1 creative...)
+        int game_mode = 0;
+        /// @brief Content of the player inventory at login, index --> item, see Window::INVENTORY_*
+        std::map<short, ProtocolCraft::Slot> inventory;
+    };
+
+    struct FakeServerStats
+    {
+        /// @brief Total number of accepted connections
+        unsigned long long connections = 0;
+        /// @brief Number of players currently in Play state
+        unsigned long long players = 0;
+        /// @brief Number of packets sent to all players
+        unsigned long long packets_sent = 0;
+        /// @brief Bytes sent to all players, framing included
+        unsigned long long bytes_sent = 0;
+        /// @brief Number of keep alive answers received
+        unsigned long long keep_alive_answers = 0;
+        /// @brief Mean time between a keep alive and its answer
+        double mean_keep_alive_rtt_ms = 0.0;
+        /// @brief Max time between a keep alive and its answer
+        double max_keep_alive_rtt_ms = 0.0;
+        /// @brief Number of players disconnected because they didn't read fast enough
+        unsigned long long slow_players_dropped = 0;
+        /// @brief Number of blocks broken or placed by the players
+        unsigned long long block_changes = 0;
+    };
+
+    /// @brief Minimal in-process server for load tests and offline simulations, without
+    /// any real game. Accepts offline mode clients, logs them in a flat world or a world
+    /// snapshot, sends the chunks around them, streams mobs movements and chunk data at
+    /// configurable rates and keeps the connection alive. The only game rules are a minimal
+    /// model of block changes (breaking and placing blocks, without any check) and of the player
+    /// inventory (trusting the clicks of the clients). Everything else sent by the clients is ignored.
+    /// Ticks follow the VirtualClock, so bots and server can be run together faster than real time
+    /// with VirtualClock::SetSpeed.
+    /// Only available for the latest supported game version (1.19), throws a
+    /// std::runtime_error on creation otherwise.
+    class FakeServer
+    {
+    public:
+        /// @brief Start listening, throws a std::runtime_error on failure
+        FakeServer(const FakeServerConfig& config = FakeServerConfig());
+        ~FakeServer();
+
+        FakeServer(const FakeServer&) = delete;
+        FakeServer& operator=(const FakeServer&) = delete;
+
+        const FakeServerStats GetStats() const;
+
+    private:
+        // Keeps asio out of this header
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
+} // Botcraft
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace Botcraft
+{
+    /// @brief A minimal HTTP server answering all GET requests with
+    /// the output of a function, to expose metrics to Prometheus
+    /// (see MetricsToPrometheus). Requests are served one at a time
+    /// by a dedicated thread.
+    class MetricsServer
+    {
+    public:
+        /// @brief Start listening
+        /// @param port TCP port to listen on
+        /// @param collect_ Called for each request, returns the body of the response
+        /// @param address Address to listen on
+        MetricsServer(const unsigned short port, const std::function<std::string()>& collect_, const std::string& address = "0.0.0.0");
+        ~MetricsServer();
+
+        MetricsServer(const MetricsServer&) = delete;
+        MetricsServer& operator=(const MetricsServer&) = delete;
+
+    private:
+        // Keeps asio out of this header
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
+} // Botcraft
@@ -4,57 +4,446 @@
 #include "protocolCraft/enums.hpp"
 
 #include <vector>
+#include <map>
+#include <memory>
 #include <queue>
+#include <tuple>
+#include <typeindex>
+#include <typeinfo>
 #include <thread>
 #include <mutex>
+#include <chrono>
 #include <condition_variable>
+#include <atomic>
 
 namespace Botcraft
 {
     class TCP_Com;
     class Authentifier;
+    class PacketCaptureWriter;
+    class EntityManager;
+    struct EntityMovement;
+#if USE_COMPRESSION
+    class CompressionContext;
+    struct DecompressionJob;
+#endif
+
+    struct PacketStats
+    {
+        /// @brief Number of packets
+        unsigned long long count = 0;
+        /// @brief Total uncompressed size, in bytes
+        unsigned long long bytes = 0;
+        /// @brief Total time spent parsing these packets, in ms (clientbound only)
+        double read_time_ms = 0.0;
+        /// @brief Total time spent in the handlers of these packets, in ms (clientbound only)
+        double handle_time_ms = 0.0;
+    };
+
+    struct NetworkStats
+    {
+        /// @brief Number of packets received, ignored ones included
+        unsigned long long packets_in = 0;
+        /// @brief Bytes received, as sent by the server (compressed, without length prefix)
+        unsigned long long bytes_in = 0;
+        /// @brief Number of packets dropped without parsing
+        unsigned long long packets_ignored = 0;
+        /// @brief Number of packets sent
+        unsigned long long packets_out = 0;
+        /// @brief Bytes sent (compressed, without length prefix)
+        unsigned long long bytes_out = 0;
+        /// @brief Number of packets processed on the priority lane
+        unsigned long long packets_priority = 0;
+        /// @brief Packets currently waiting on the priority lane
+        size_t priority_queue_depth = 0;
+        /// @brief Packets currently waiting on the normal lane
+        size_t normal_queue_depth = 0;
+        /// @brief Highest number of packets waiting on the priority lane
+        size_t max_priority_queue_depth = 0;
+        /// @brief Highest number of packets waiting on the normal lane
+        size_t max_normal_queue_depth = 0;
+        /// @brief Longest time a packet waited before being processed, in ms
+        double max_queue_lag_ms = 0.0;
+        /// @brief Bytes of the packets currently waiting on both lanes, as received
+        size_t queued_bytes = 0;
+        /// @brief Number of times reading the socket was paused because too many packets were waiting
+        unsigned long long read_pauses = 0;
+        /// @brief True if reading the socket is currently paused
+        bool read_paused = false;
+        /// @brief Play state packets received, by packet id
+        std::map<int, PacketStats> clientbound;
+        /// @brief Play state packets sent, by packet id
+        std::map<int, PacketStats> serverbound;
+    };
+
+    /// @brief Duration of the steps needed to join a server, in ms, -1 if not done (yet)
+    struct ConnectionTimings
+    {
+        /// @brief Time when the connection was started, before authentication
+        std::chrono::steady_clock::time_point start;
+        /// @brief Account authentication, 0 in offline mode or after a reconnection
+        double auth_ms = 0.0;
+        /// @brief HTTP requests sent for the account, "METHOD host/endpoint" and duration in ms, in sending order
+        std::vector<std::pair<std::string, double> > auth_requests;
+        /// @brief SRV DNS lookup, close to 0 if the address has a port
+        double srv_lookup_ms = -1.0;
+        /// @brief Server address resolution
+        double dns_ms = -1.0;
+        /// @brief TCP connection, once the address is resolved
+        double tcp_connect_ms = -1.0;
+        /// @brief From the TCP connection to the login success, encryption included
+        double login_ms = -1.0;
+        /// @brief Encryption request handling (server join request and key exchange), 0 without encryption
+        double encryption_ms = 0.0;
+    };
 
     class NetworkManager : public ProtocolCraft::Handler
     {
     public:
         NetworkManager(const std::string& address, const std::string& login, const std::string& password, const bool force_microsoft_auth);
+        /// @brief Open a new connection for the account of a previous one, without
+        /// authenticating again. The previous connection is closed, and its settings
+        /// (messages filter and pooling, priority packets, queue limit, compression
+        /// level, flush delay) and allocated buffers are moved to the new one.
+        /// Handlers are not kept and must be added again. Must not be called from
+        /// a thread processing the packets of previous
+        /// @param address Address to connect to
+        /// @param previous The connection to replace, closed and not usable anymore after this call
+        NetworkManager(const std::string& address, NetworkManager& previous);
         // Used to create a dummy network manager that does not fire any message
         // but is always in constant_connection_state
         NetworkManager(const ProtocolCraft::ConnectionState constant_connection_state);
         ~NetworkManager();
 
         void AddHandler(ProtocolCraft::Handler* h);
+
+        /// @brief Register a handler that only consumes some message types.
+        /// Instead of calling its Handle for every incoming message, dispatch
+        /// uses a lookup in a per packet id table. Filtered handlers are called
+        /// after the ones registered with AddHandler. Must be called before
+        /// the connection or from the network thread (in a Handle)
+        /// @tparam TMessages A std::tuple with all the message types the handler consumes
+        /// @param h The handler
+        template<class TMessages>
+        void AddFilteredHandler(ProtocolCraft::Handler* h)
+        {
+            AddFilteredHandlerImpl(h, static_cast<TMessages*>(nullptr));
+        }
+        /// @brief Decode the entity movement packets (MoveEntityPacketPos/PosRot/Rot
+        /// and TeleportEntityPacket) directly from the raw data, without creating
+        /// any message, and apply them to an EntityManager. Consecutive movements
+        /// are applied in batches, before the next packet of another type is
+        /// dispatched. These packets are then NOT sent to any handler anymore,
+        /// including the ones registered with AddHandler. Must be called before
+        /// the connection or from the network thread (in a Handle)
+        /// @param entity_manager The manager to update, nullptr to dispatch these packets as usual
+        void SetEntityMovementFastPath(EntityManager* entity_manager);
         void Send(const std::shared_ptr<ProtocolCraft::Message> msg);
         const ProtocolCraft::ConnectionState GetConnectionState() const;
+
+        /// @brief Block until the connection reaches the given state
+        /// @param s Expected state
+        /// @param timeout Max waiting time
+        /// @return True if the connection is in state s, false if timed out
+        const bool WaitForConnectionState(const ProtocolCraft::ConnectionState s, const std::chrono::milliseconds timeout);
         const std::string& GetMyName() const;
 
+        /// @brief Skip the given Play state clientbound messages. They are
+        /// dropped based on their id, without allocation or parsing. Should
+        /// be set before the connection reaches Play state
+        /// @tparam TMessages A std::tuple with all the message types to skip
+        template<class TMessages>
+        void SetIgnoredMessages()
+        {
+            ignored_packets.clear();
+            SetPacketsIgnoredImpl(static_cast<TMessages*>(nullptr), true);
+        }
+
+        /// @brief Only parse the given Play state clientbound messages, all
+        /// the others are dropped based on their id, without allocation or
+        /// parsing. Keep alive and disconnect messages are always processed.
+        /// Be careful to include all the messages the managers need!
+        /// Should be set before the connection reaches Play state
+        /// @tparam TMessages A std::tuple with all the message types to process
+        template<class TMessages>
+        void SetAllowedMessages()
+        {
+            // Play ids are all < 0x80, so we know they'll all be ignored
+            ignored_packets = std::vector<char>(0x80, 1);
+            SetPacketsIgnoredImpl(static_cast<TMessages*>(nullptr), false);
+            SetPacketsIgnoredImpl(static_cast<std::tuple<ProtocolCraft::ClientboundKeepAlivePacket, ProtocolCraft::ClientboundDisconnectPacket>*>(nullptr), false);
+        }
+
+        /// @brief Remove any allowlist/denylist set with SetAllowedMessages/SetIgnoredMessages
+        void ClearMessagesFilter();
+
+        /// @brief Enable/disable reuse of message instances between packets.
+        /// When enabled (disabled by default), a Play message is read in an
+        /// instance kept from the previous packet with the same id instead
+        /// of a new one. A message received in a Handle is then only valid
+        /// during the call, use msg.Clone() or msg.shared_from_this() to
+        /// keep it longer (as AsyncHandler does)
+        /// @param b True to enable pooling
+        void SetMessagePooling(const bool b);
+
+        /// @brief Set the maximum number of received packets waiting to be
+        /// processed. When reached, the socket is not read anymore until half
+        /// of them are processed, letting TCP flow control slow the server down.
+        /// Has no effect if packets are processed on the IO threads
+        /// @param max_packets Maximum number of waiting packets, 0 (default) for no limit
+        void SetMaxQueuedPackets(const size_t max_packets);
+
+        /// @brief Set zlib level used to compress outgoing packets
+        /// @param level 0 (no compression) to 9 (best compression), -1 for zlib default
+        void SetCompressionLevel(const int level);
+
+        /// @brief Set a flush window for outgoing packets. All packets
+        /// sent during this window after a first one are grouped
+        /// into one single network write.
+        /// @param delay Flush window duration, 0 (default) to send as soon as possible
+        void SetSendFlushDelay(const std::chrono::microseconds delay);
+
+        /// @brief Get the traffic and processing time counters of this connection
+        const NetworkStats GetStats() const;
+
+        /// @brief Get the duration of the steps already done to join the server
+        const ConnectionTimings GetConnectionTimings() const;
+
+        /// @brief Start writing all the clientbound packets received, decompressed,
+        /// with their timestamp and connection state in a file that can be processed
+        /// again with Replay. Packets ignored with SetIgnoredMessages/SetAllowedMessages
+        /// are captured too
+        /// @param path Path of the capture file, overwritten if it exists
+        /// @return True if the file was created
+        bool StartCapture(const std::string& path);
+
+        /// @brief Stop the current capture and close the file
+        void StopCapture();
+
+        /// @brief Process all the packets of a capture file as if they were received
+        /// from a server, running the same parsing and handlers. Must be used on a
+        /// NetworkManager created with the constant state constructor, as the state
+        /// is set from the capture. Blocks until all packets are processed
+        /// @param path Path of the capture file
+        /// @param speed Replay speed relative to the capture timings, 0 to process the packets as fast as possible
+        /// @return The number of processed packets
+        size_t Replay(const std::string& path, const double speed = 0.0);
+
+        /// @brief Start a process-wide pool of network IO threads.
+        /// All the connections created after this call share these
+        /// threads instead of spawning a dedicated one each.
+        /// Useful when running a lot of bots in the same process.
+        /// @param num_threads Number of IO threads, 0 to use one per hardware core
+        static void StartSharedIOPool(const unsigned int num_threads = 0);
+
+        /// @brief Stop the shared network IO pool. All the connections
+        /// using it must have been closed (NetworkManager destroyed) before
+        static void StopSharedIOPool();
+
+        /// @brief Process the incoming packets directly on the shared
+        /// IO threads instead of one processing thread per connection.
+        /// Only applied to connections created after this call while
+        /// the shared IO pool is running. A slow handler then delays
+        /// all the connections using the same IO thread.
+        /// @param b True to process packets on the IO threads
+        static void SetProcessPacketsOnIOThreads(const bool b);
+
+        /// @brief Start a process-wide pool of threads decompressing the
+        /// big received packets (mostly chunks) of all the connections.
+        /// Packets are still dispatched in the order they were received.
+        /// Has no effect on connections processing packets on the IO threads
+        /// @param num_threads Number of decompression threads, 0 to use one per hardware core
+        static void StartDecompressionPool(const unsigned int num_threads = 0);
+
+        /// @brief Stop the decompression pool. All the connections
+        /// using it must have been closed (NetworkManager destroyed) before
+        static void StopDecompressionPool();
+
+        /// @brief Authenticate a list of Microsoft accounts before creating
+        /// the bots. Tokens are refreshed in parallel and the credentials
+        /// cache file is written only once. The NetworkManager created
+        /// afterwards with these logins then get their token from memory.
+        /// @param logins Microsoft logins, as given to the constructor
+        /// @param max_parallel Max number of accounts authenticated at the same time
+        /// @param min_interval Min delay between two authentications that need web requests
+        /// @return The number of successfully authenticated accounts
+        static size_t PreAuthenticateMicrosoft(const std::vector<std::string>& logins, const unsigned int max_parallel = 8,
+            const std::chrono::milliseconds min_interval = std::chrono::milliseconds(250));
+
     private:
+        /// @brief Start the connection threads and send the login packets
+        /// @param address Address to connect to
+        void Start(const std::string& address);
+        /// @brief Close the connection and wait for the processing thread to finish
+        void Stop();
+
+        template<class... TMessages>
+        void AddFilteredHandlerImpl(ProtocolCraft::Handler* h, std::tuple<TMessages...>*)
+        {
+            (AddFilteredHandler(h, TMessages().GetId(), typeid(TMessages)), ...);
+        }
+        void AddFilteredHandler(ProtocolCraft::Handler* h, const int id, const std::type_info& type);
+
+        template<class... TMessages>
+        void SetPacketsIgnoredImpl(std::tuple<TMessages...>*, const bool ignored)
+        {
+            (SetPacketIgnored(TMessages().GetId(), ignored), ...);
+        }
+        void SetPacketIgnored(const int id, const bool ignored);
+        /// @brief Check if a raw packet, as received from TCP_Com, should
+        /// be processed on the priority lane. Only uncompressed Play packets
+        /// can be classified without decompressing them, latency critical
+        /// packets are small so they are never compressed anyway
+        /// @param packet Raw packet data
+        /// @return True if the packet is latency critical
+        const bool IsPriorityPacket(const std::vector<unsigned char>& packet) const;
+        /// @brief Check if a packet should be dropped without parsing
+        /// @param packet_id Id of the packet
+        /// @return True if the packet is a Play packet we don't want
+        const bool IsPacketIgnored(const int packet_id) const;
+
         void WaitForNewPackets();
-        void ProcessPacket(const std::vector<unsigned char>& packet);
-        void OnNewRawData(const std::vector<unsigned char>& packet);
+        /// @brief Parse and dispatch a packet
+        /// @param packet Raw packet data (uncompressed)
+        /// @param start Index of the first byte of the packet (packet ID) in packet
+        void ProcessPacket(const std::vector<unsigned char>& packet, const size_t start = 0);
+        /// @brief Decompress (if needed) and process a packet as received from TCP_Com
+        /// @param packet Raw packet data
+        void ProcessRawPacket(const std::vector<unsigned char>& packet);
+#if USE_COMPRESSION
+        /// @brief Wait for a packet to be decompressed by the DecompressionPool, then process it
+        /// @param job The decompression job of the packet
+        void ProcessDecompressionJob(DecompressionJob& job);
+#endif
+        /// @brief Update the sent packets counters
+        /// @param packet_id Id of the packet
+        /// @param uncompressed_size Size of the packet data
+        /// @param sent_size Size of the data actually sent
+        void RecordSentPacket(const int packet_id, const size_t uncompressed_size, const size_t sent_size);
+        /// @brief If packet_id is an entity movement packet and the fast path
+        /// is enabled, decode it in pending_movements
+        /// @return True if the packet has been decoded
+        bool ReadEntityMovement(const int packet_id, ProtocolCraft::ReadIterator& iter, size_t& length);
+        /// @brief Apply the decoded movements to the entity manager
+        void FlushEntityMovements();
+        /// @brief Get a message instance to read a packet into, from the pool if possible
+        std::shared_ptr<ProtocolCraft::Message> GetMessageInstance(const int packet_id);
+        /// @brief Queue (or process) a packet as received from TCP_Com
+        /// @param packet Raw packet data
+        /// @return False if TCP_Com should stop reading the socket
+        bool OnNewRawData(std::vector<unsigned char>&& packet);
 
 
         virtual void Handle(ProtocolCraft::Message& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundLoginCompressionPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundGameProfilePacket& msg) override;
+        virtual void Handle(ProtocolCraft::ClientboundLoginPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundHelloPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundKeepAlivePacket& msg) override;
 
     private:
         std::vector<ProtocolCraft::Handler*> subscribed;
+        // For each packet id, the handlers registered for this id
+        // and the type of message they want (to distinguish between states)
+        std::vector<std::vector<std::pair<std::type_index, ProtocolCraft::Handler*> > > filtered_subscribed;
+        // For each Play packet id, 1 if it should be dropped without parsing
+        std::vector<char> ignored_packets;
+        // For each Play packet id, the last instance created, to be reused
+        std::vector<std::shared_ptr<ProtocolCraft::Message> > message_pool;
+        bool use_message_pool;
+        // If not null, entity movement packets are decoded in
+        // pending_movements and applied to it instead of dispatched
+        EntityManager* entity_movement_manager;
+        std::vector<EntityMovement> pending_movements;
+        // Play ids of the packets decoded by the fast path
+        int move_entity_pos_id;
+        int move_entity_pos_rot_id;
+        int move_entity_rot_id;
+        int teleport_entity_id;
 
         std::shared_ptr<TCP_Com> com;
         std::shared_ptr<Authentifier> authentifier;
         ProtocolCraft::ConnectionState state;
+        std::mutex mutex_state;
+        std::condition_variable state_condition;
 
         std::thread m_thread_process;//Thread running to process incoming packets without blocking com
+        // If true, packets are processed by the TCP_Com thread and m_thread_process is not used
+        bool process_on_io_thread;
+        static std::atomic<bool> process_packets_on_io_threads;
 
-        std::queue<std::vector<unsigned char> > packets_to_process;
-        std::mutex mutex_process;
+        struct QueuedPacket
+        {
+            std::vector<unsigned char> data;
+            std::chrono::steady_clock::time_point received;
+            // Size of the received data, still counted when moved to a job
+            size_t size;
+#if USE_COMPRESSION
+            // If set, data has been moved in the job and is decompressed in the
+            // DecompressionPool. The queue stays in the received order, so the
+            // processing thread waits for the job before dispatching it
+            std::shared_ptr<DecompressionJob> job;
+#endif
+        };
+        std::queue<QueuedPacket> packets_to_process;
+        // Latency critical packets (keep alive, teleportations), processed
+        // before the ones waiting in packets_to_process so they are not
+        // delayed by a chunk burst
+        std::queue<QueuedPacket> priority_packets_to_process;
+        // For each Play packet id, 1 if it goes on the priority lane
+        std::vector<char> priority_packets;
+        // False until the login packet is processed, so a teleportation
+        // sent right after it can't be processed before the player exists
+        std::atomic<bool> priority_lane_enabled;
+        size_t max_priority_queue_depth;
+        size_t max_normal_queue_depth;
+        // 0 if unbounded
+        size_t max_queued_packets;
+        // True if TCP_Com has been asked to stop reading
+        bool reading_paused;
+        unsigned long long read_pauses;
+        double max_queue_lag_ms;
+        // Bytes of the packets waiting in both lanes
+        size_t queued_bytes;
+        mutable std::mutex mutex_process;
         std::condition_variable process_condition;
-        int compression;
+        // Set by the processing thread, read by the IO thread
+        // to send the compressed packets to the DecompressionPool
+        std::atomic<int> compression;
+#if USE_COMPRESSION
+        // Persistent zlib streams and buffer for decompressed packets
+        std::unique_ptr<CompressionContext> compression_context;
+        std::vector<unsigned char> uncompressed_packet;
+#endif
 
         std::mutex mutex_send;
+        // Reused for all sent packets, protected by mutex_send
+        std::vector<unsigned char> send_buffer;
+        std::vector<unsigned char> compressed_send_buffer;
+        // Room left at the beginning of the send buffers for the
+        // frame length VarInt and the uncompressed packet 0 prefix
+        static constexpr size_t send_headroom = 6;
+        // Kept to be applied again after a reconnection
+        std::chrono::microseconds send_flush_delay;
+
+        std::mutex mutex_capture;
+        std::unique_ptr<PacketCaptureWriter> capture;
+        // Set with capture, to check it without locking mutex_capture
+        std::atomic<bool> capturing;
+        std::chrono::steady_clock::time_point capture_start;
+
+        mutable std::mutex mutex_stats;
+        // Totals, per id maps are left empty and filled by GetStats
+        NetworkStats stats;
+        // Play packets per id
+        std::vector<PacketStats> clientbound_stats;
+        std::vector<PacketStats> serverbound_stats;
+
+        // Protected by mutex_stats
+        std::chrono::steady_clock::time_point connection_start;
+        std::chrono::steady_clock::time_point login_end;
+        double auth_ms;
+        double encryption_ms;
 
         std::string name;
 
@@ -45,6 +45,14 @@ namespace Botcraft
             void SetTextureMultipliers(const std::array<unsigned int, 2> &mult);
             const std::array<float, 4>& GetTextureCoords(const bool overlay) const;
             void SetTextureCoords(const std::array<float, 4>& coords, const bool overlay);
+            // Repeat the texture along the face local x and z axes
+            // (used for merged faces), max 256 each
+            void SetTextureRepeat(const unsigned int repeat_x, const unsigned int repeat_z);
+            const std::array<unsigned int, 2> GetTextureRepeat() const;
+            // Texture rotation, in number of quarter turns
+            const unsigned int GetTextureRotation() const;
+            // All the packed texture data, as sent to the shader
+            const unsigned int GetTextureData() const;
 
             void UpdateMatrix(const FaceTransformation& transformations, const Orientation orientation);
 
@@ -60,7 +68,7 @@ namespace Botcraft
             std::array<float, 4> texture_coords_overlay;
 
             //One int with all textures data packed inside
-            //(unused : 26 bits, use_overlay : 1 bit, rotation : 2 bits, display_backface: 1 bit, transparency_data : 2 bit)
+            //(unused : 10 bits, texture_repeat_z - 1 : 8 bits, texture_repeat_x - 1 : 8 bits, use_overlay : 1 bit, rotation : 2 bits, display_backface: 1 bit, transparency_data : 2 bit)
             unsigned int texture_data;
 
             //One int with texture multiplier packed inside (rgba) x2 for one optional overlay
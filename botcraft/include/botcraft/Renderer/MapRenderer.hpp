@@ -0,0 +1,96 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Botcraft
+{
+    class World;
+    class Chunk;
+    class Blockstate;
+
+    namespace Renderer
+    {
+        /// @brief Top-down map renderer running on the CPU, one pixel per
+        /// block. It doesn't need any OpenGL context, so maps can be
+        /// generated by any bot, from any thread, without opening a window
+        class MapRenderer
+        {
+        public:
+            /// @param world_ The world to render, only read under its mutex
+            MapRenderer(const std::shared_ptr<World> world_);
+            ~MapRenderer();
+
+            /// @brief Render a rectangular area of the world
+            /// @param min_x x coordinate of the north-west corner
+            /// @param min_z z coordinate of the north-west corner
+            /// @param width Size of the area along x, in blocks
+            /// @param depth Size of the area along z, in blocks
+            /// @return width * depth RGBA pixels, rows from north to south. Unloaded chunks are transparent
+            const std::vector<unsigned char> RenderTile(const int min_x, const int min_z, const int width, const int depth);
+
+            /// @brief Render an area in square tiles on multiple threads and save
+            /// them as png files named tile_<i>_<j>.png with i = floor(x / tile_size)
+            /// and j = floor(z / tile_size). Tiles without any loaded chunk are not saved
+            /// @param min_x Minimum x coordinate of the area
+            /// @param min_z Minimum z coordinate of the area
+            /// @param max_x Maximum x coordinate of the area (included)
+            /// @param max_z Maximum z coordinate of the area (included)
+            /// @param tile_size Size of the tiles, in blocks
+            /// @param folder Folder in which the tiles are saved, must exist
+            /// @param num_threads Number of rendering threads, 0 to use all the hardware threads
+            /// @return The number of saved tiles
+            const int RenderRegion(const int min_x, const int min_z, const int max_x, const int max_z,
+                const int tile_size, const std::string& folder, const int num_threads = 0);
+
+        private:
+            struct BlockColor
+            {
+                // Packed RGBA, R in the low byte, alpha is 0 if the block can't be seen from above
+                unsigned int color;
+                bool tinted;
+            };
+
+            struct ColumnData
+            {
+                unsigned int color;
+                int height;
+            };
+
+            struct ChunkColumns
+            {
+                unsigned long long blocks_version;
+                // Top block of each column, z * CHUNK_WIDTH + x
+                std::vector<ColumnData> columns;
+            };
+
+            using ChunkCopies = std::map<std::pair<int, int>, std::shared_ptr<const Chunk> >;
+
+            // Copy all the chunks needed to render an area, with the row north of it for the shading
+            const ChunkCopies CopyChunks(const int min_x, const int min_z, const int max_x, const int max_z) const;
+
+            const std::vector<unsigned char> RenderTile(const int min_x, const int min_z, const int width, const int depth, const ChunkCopies& chunks);
+
+            // Get the top blocks of a chunk, only computed again if the chunk blocks changed
+            const std::shared_ptr<const ChunkColumns> GetChunkColumns(const int x, const int z, const std::shared_ptr<const Chunk>& chunk);
+
+            const BlockColor GetBlockColor(const Blockstate* blockstate);
+            const BlockColor ComputeBlockColor(const Blockstate* blockstate) const;
+
+        private:
+            std::shared_ptr<World> world;
+
+            std::shared_mutex mutex_colors;
+            std::unordered_map<const Blockstate*, BlockColor> block_colors;
+
+            std::mutex mutex_columns;
+            std::map<std::pair<int, int>, std::shared_ptr<const ChunkColumns> > chunk_columns;
+        };
+    } // Renderer
+} // Botcraft
\ No newline at end of file
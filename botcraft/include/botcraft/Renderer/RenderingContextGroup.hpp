@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct GLFWwindow;
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        class Shader;
+
+        /// @brief OpenGL objects shared by the windows of several RenderingManager
+        /// in the same process. The windows of a group share their OpenGL objects,
+        /// so the atlas texture and the shaders are created once, by the first
+        /// window, instead of once per viewer. The shared objects are never modified
+        /// after their creation, per window values are in each window uniform buffer.
+        /// Give the same instance to all the RenderingManager that should share them.
+        /// Each RenderingManager without group gets its own, with only one window
+        class RenderingContextGroup
+        {
+        public:
+            RenderingContextGroup();
+            ~RenderingContextGroup();
+
+            /// @brief Get the number of windows currently in the group
+            const size_t GetNumWindows() const;
+
+        private:
+            friend class RenderingManager;
+
+            /// @brief Create a window whose context shares its objects with the
+            /// others of the group, and make it current on the calling thread.
+            /// The shared objects are created with the first window
+            /// @param width Window width
+            /// @param height Window height
+            /// @param headless If true, the window is not visible
+            /// @param use_imgui Set to true if no other window of the group
+            /// uses ImGui, whose backends use a global state
+            /// @return The window, nullptr if it can't be created
+            GLFWwindow* AddWindow(const int width, const int height, const bool headless, bool& use_imgui);
+
+            /// @brief Destroy a window created with AddWindow, its context must
+            /// be current. The shared objects are deleted with the last window
+            /// @param window The window to destroy
+            /// @param used_imgui True if the window was using ImGui
+            void RemoveWindow(GLFWwindow* window, const bool used_imgui);
+
+            /// @brief Process the events of all the windows, GLFW
+            /// event functions are not thread safe
+            void PollEvents();
+
+            const unsigned int GetAtlasTexture() const;
+            /// @brief Shader for entities, with full model matrices
+            Shader& GetShader();
+            /// @brief Shader for chunks, with PackedFace
+            Shader& GetPackedShader();
+
+        private:
+            /// @brief Create the shared objects, called with the first window current
+            /// @return False if they can't be created
+            const bool InitSharedGL();
+            /// @brief Delete the shared objects, called with the last window current
+            void ClearSharedGL();
+
+        private:
+            /// @brief Windows of this group, protected by the process-wide
+            /// GLFW mutex as all the groups use the same GLFW instance
+            std::vector<GLFWwindow*> windows;
+            bool imgui_used;
+
+            unsigned int atlas_texture;
+            std::unique_ptr<Shader> shader;
+            std::unique_ptr<Shader> packed_shader;
+        };
+    } // Renderer
+} // Botcraft
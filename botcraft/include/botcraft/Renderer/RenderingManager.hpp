@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 #include <tuple>
@@ -13,6 +14,8 @@
 #include <condition_variable>
 #include <deque>
 #include <fstream>
+#include <chrono>
+#include <string>
 
 #include "botcraft/Game/Enums.hpp"
 #include "botcraft/Game/Vector3.hpp"
@@ -27,12 +30,15 @@ namespace Botcraft
     class World;
     class InventoryManager;
     class EntityManager;
+    class NetworkManager;
 
     namespace Renderer
     {
         class Shader;
         class Atlas;
         class WorldRenderer;
+        class ScreenshotWriter;
+        class RenderingContextGroup;
 
         // Key that can be used in KeyboardCallback when set
         enum class KEY_CODE
@@ -55,10 +61,13 @@ namespace Botcraft
             // Window can be resized at runtime
             // Chunks in renderer are independant of chunks in the corresponding world.
             // Set headless_ to true to run without opening a window (rendering is still done)
+            // Managers created with the same context_group_ share their atlas texture and
+            // shaders, to watch several bots in the same process (see RenderingContextGroup)
             RenderingManager(std::shared_ptr<World> world_, std::shared_ptr<InventoryManager> inventory_manager_,
                 std::shared_ptr<EntityManager> entity_manager_,
                 const unsigned int &window_width, const unsigned int &window_height,
-                const unsigned int section_height_ = 16, const bool headless = false);
+                const unsigned int section_height_ = 16, const bool headless = false,
+                std::shared_ptr<RenderingContextGroup> context_group_ = nullptr);
             ~RenderingManager();
 
             // Set a flag to terminate the rendering loop after the current frame
@@ -73,12 +82,57 @@ namespace Botcraft
             // Set world renderer's camera position and orientation
             void SetPosOrientation(const double x_, const double y_, const double z_, const float yaw_, const float pitch_);
 
-            // Take a screenshot of the current frame and save it to path
+            // Take a screenshot of the next frame and save it to path.
+            // The image is read and written asynchronously, without
+            // stalling the rendering. Requests are kept in order
             void Screenshot(const std::string &path);
 
+            // Merge coplanar block faces with the same texture to reduce
+            // the number of rendered faces (enabled by default).
+            // Only applies to chunks updated after the call
+            void SetGreedyMeshing(const bool b);
+
+            // Render the chunks further than d blocks from the camera with
+            // a simplified mesh of their surface, 0 to disable (default)
+            void SetLodDistance(const float d);
+
+            // Skip the sections hidden from the camera by opaque
+            // blocks, like caves under the ground (enabled by default)
+            void SetCaveCulling(const bool b);
+
+            // Only render a new frame when something changed (camera,
+            // chunks, entities, user input) and at least once per second.
+            // Useful to watch many bots at once. Disabled by default
+            void SetRenderOnDemand(const bool b);
+
+            // Limit the number of frames per second, 0 for no limit (default 60)
+            void SetMaxFPS(const unsigned int fps);
+
+            // Set the network manager whose packet queues and
+            // rates are displayed in the performance overlay
+            void SetNetworkManager(std::shared_ptr<NetworkManager> network_manager_);
+
+            // Get the memory used by the chunks and entities faces
+            // buffers on the GPU, in bytes
+            const size_t GetGPUMemory() const;
+
         protected:
             void WaitForRenderingUpdate();
 
+            // Add the chunks whose mesh detail level doesn't match
+            // their distance anymore to the chunks to update.
+            // mutex_updating must be locked by the caller
+            void AddOutdatedLodChunksToUpdate();
+
+            // Add a chunk (x, 0, z) or a rendering section (x, section index, z)
+            // to update if it's not already waiting. mutex_updating must be
+            // locked by the caller
+            void AddToMeshQueue(const Position& pos, const bool full_chunk);
+
+            // Compute again the priority of all the chunks and sections
+            // to update. mutex_updating must be locked by the caller
+            void SortMeshQueue();
+
             virtual void Handle(ProtocolCraft::Message& msg) override;
             
             // Chunk stuff
@@ -133,15 +187,46 @@ namespace Botcraft
             // Get GLFW keyboard inputs and pass them to the callback
             void InternalProcessInput(GLFWwindow *window);
 
+            // Mark the rendering sections containing these blocks to be updated,
+            // with the neighbour ones when a block is on a section border
+            void AddBlocksToUpdate(const std::vector<Position>& positions);
+
+            // Mesh the chunks to update, nearest to the camera first.
+            // Run by all the meshing threads concurrently
+            void MeshChunks();
+
+            // Ask for a new frame when rendering on demand
+            void RequestRedraw();
+
+#if USE_IMGUI
+            // Draw the frame time, rendering, network and behaviour stats window
+            void DrawPerformanceOverlay(const int num_chunks, const int num_rendered_chunks);
+#endif
+
         private:
             // External modules
             std::shared_ptr<World> world;
             std::shared_ptr<InventoryManager> inventory_manager;
             std::shared_ptr<EntityManager> entity_manager;
+            std::shared_ptr<NetworkManager> network_manager;
+            std::mutex mutex_network_manager;
 
+            // ImGui backends use a global state, only one window
+            // of a context group can display the overlays
+            bool imgui_enabled;
 #if USE_IMGUI
             bool inventory_open;
             unsigned long long int last_time_inventory_changed;
+
+            // Duration of the last frames in ms, circular buffer
+            std::array<float, 120> frame_times;
+            size_t frame_times_index;
+            // Received packet counts by id when the rates were last computed
+            std::map<int, unsigned long long> last_packet_counts;
+            std::chrono::steady_clock::time_point last_packet_rates_time;
+            // (packet name, packets per second), highest rate first
+            std::vector<std::pair<std::string, double> > packet_rates;
+            std::unordered_map<int, std::string> packet_names;
 #endif
 
             std::thread rendering_thread;// OpenGL thread
@@ -161,24 +246,64 @@ namespace Botcraft
             // 0.5 is noon, 0 and 1 are midnight
             float day_time;
 
-            std::unique_ptr<Shader> my_shader;
+            // Window, atlas and shaders
+            std::shared_ptr<RenderingContextGroup> context_group;
 
             std::unique_ptr<WorldRenderer> world_renderer;
+            unsigned int section_height;
 
             std::function<void(double, double)> MouseCallback;
             std::function<void(std::array<bool, (int)KEY_CODE::NUMBER_OF_KEYS>, double)> KeyboardCallback;
 
-            std::string screenshot_path;
-            bool take_screenshot;
+            // Paths of the screenshots to take, one per frame
+            std::deque<std::string> screenshot_paths;
+            std::mutex mutex_screenshot;
+            std::atomic<bool> take_screenshot;
+            std::unique_ptr<ScreenshotWriter> screenshot_writer;
 
             bool running;
 
+            std::atomic<bool> render_on_demand;
+            // Set when something changed since the last rendered frame
+            std::atomic<bool> redraw_requested;
+            std::atomic<unsigned int> max_fps;
+
             std::unordered_set<Position> chunks_to_udpate;
+            // Rendering sections (chunk x, section index, chunk z) to update
+            // after a block change, when the whole chunk doesn't need to be
+            std::unordered_set<Position> sections_to_update;
             std::unordered_set<int> entities_to_update;
             std::mutex mutex_updating;
             std::condition_variable condition_update;
-            // Thread used to update the rendered data with current data 
+            // Chunks (x, 0, z) currently meshed by a meshing thread, not given
+            // to another one before the first is done with them
+            std::unordered_set<Position> chunks_being_meshed;
+            struct MeshTask
+            {
+                // Lower is meshed first
+                float priority;
+                Position pos;
+                bool full_chunk;
+                // Reversed, so the heap functions put the lowest priority on top
+                bool operator<(const MeshTask& other) const { return priority > other.priority; }
+            };
+            // Min heap of the chunks and sections to update, nearest visible
+            // first. The sets above avoid duplicates, entries removed from them
+            // stay in the heap and are skipped when popped
+            std::vector<MeshTask> mesh_queue;
+            // Set when the camera moved or turned enough to change the order
+            bool mesh_queue_should_be_sorted;
+            // Camera chunk (x, 0, z) and orientation when the mesh queue was last sorted
+            Position mesh_queue_camera_chunk;
+            float mesh_queue_camera_yaw;
+            float mesh_queue_camera_pitch;
+            // Chunk (x, 0, z) of the camera when LOD meshes were last checked
+            Position lod_camera_chunk;
+            // Thread used to update the rendered entities with current data
             std::thread thread_updating_renderable; 
+            // Threads building the faces of the chunks to update, the
+            // GPU upload stays on the rendering thread
+            std::vector<std::thread> meshing_threads;
         };
     } // Renderer
 } // Botcraft
\ No newline at end of file
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <thread>
-#include <queue>
+#include <vector>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
@@ -9,8 +10,10 @@
 
 namespace Botcraft
 {
-    // A proxy handler that duplicate every packets and resend them
-    // asynchronously to a main handler on another thread
+    // A proxy handler that forwards every packets asynchronously
+    // to a main handler on another thread. Messages are not copied,
+    // the decoded instance is shared with the processing thread
+    // through a bounded lock-free ring buffer
     class AsyncHandler : public ProtocolCraft::Handler
     {
     public:
@@ -23,13 +26,30 @@ namespace Botcraft
 
     private:
         void DequeueMsg();
+
     private:
+        /// @brief Number of slots in the ring, must be a power of 2
+        static constexpr size_t ring_size = 1024;
+
         std::thread processing_thread;
-        std::queue<std::shared_ptr<ProtocolCraft::Message> > msg_to_process;
-        std::mutex processing_mutex;
-        std::condition_variable processing_condition_variable;
-        bool processing;
+        std::atomic<bool> processing;
+
+        /// @brief Ring buffer between the network thread(s) and the processing thread
+        std::vector<std::shared_ptr<ProtocolCraft::Message> > ring;
+        /// @brief Next slot to read, only written by the processing thread
+        alignas(64) std::atomic<size_t> ring_head;
+        /// @brief Next slot to write, only written by the producer
+        alignas(64) std::atomic<size_t> ring_tail;
+
+        /// @brief Only one producer at a time can write in the ring. Uncontended
+        /// unless the world is shared between multiple bots
+        std::mutex producer_mutex;
+
+        /// @brief Only used to put the processing thread to sleep when the ring is empty
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_condition_variable;
+        std::atomic<bool> consumer_sleeping;
 
         ProtocolCraft::Handler* main_handler;
     };
-}
\ No newline at end of file
+}
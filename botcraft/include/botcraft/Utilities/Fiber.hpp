@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+namespace Botcraft
+{
+    /// @brief A minimal stackful fiber, with its own stack and
+    /// execution context. Resume runs the function until it calls
+    /// Suspend (or returns), then the caller continues. It's not
+    /// thread-safe, and as thread_local values can be cached across
+    /// Suspend calls, a fiber should always be resumed by the same thread.
+    class Fiber
+    {
+    public:
+        /// @brief Create a fiber, func is not started before the first Resume call
+        /// @param func_ The function to run in the fiber. It must not throw
+        /// @param stack_size Size of the fiber stack, in bytes
+        Fiber(const std::function<void()>& func_, const size_t stack_size);
+        /// @brief Delete the fiber. If it's not finished, the objects alive on its stack are
+        /// *not* destroyed, make sure func returns before deleting the fiber
+        ~Fiber();
+
+        Fiber(const Fiber&) = delete;
+        Fiber& operator=(const Fiber&) = delete;
+
+        /// @brief Switch to the fiber, until it's suspended or finished.
+        /// Must not be called from inside the fiber
+        void Resume();
+
+        /// @brief Switch back to the Resume caller. Must be called from inside the fiber
+        void Suspend();
+
+        /// @brief Mark the fiber as finished without running its function.
+        /// Must only be called before the first Resume call
+        void Cancel();
+
+        /// @brief Check if the fiber function has returned
+        const bool IsFinished() const;
+
+        /// @brief Check if we are currently inside the fiber
+        const bool IsRunning() const;
+
+    private:
+        struct Impl;
+
+        void Run();
+
+    private:
+        std::function<void()> func;
+        std::unique_ptr<Impl> impl;
+        bool finished;
+        bool running;
+    };
+} // Botcraft
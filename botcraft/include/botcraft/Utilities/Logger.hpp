@@ -8,6 +8,9 @@
 #include <sstream>
 #include <atomic>
 #include <thread>
+#include <memory>
+#include <fstream>
+#include <condition_variable>
 
 constexpr const char* file_name(const char* path)
 {
@@ -28,8 +31,8 @@ constexpr const char* file_name(const char* path)
     if (level < logger.GetLogLevel()) \
         break; \
     std::ostringstream s; \
-    s << logger.GetDate().rdbuf() << ' ' << Botcraft::Logger::level_strings.at(level) \
-    << " [" << logger.GetThreadName(std::this_thread::get_id()) << "(" << std::this_thread::get_id() << ")] " \
+    s << logger.GetCachedDate() << ' ' << Botcraft::Logger::GetLevelString(level) \
+    << " [" << logger.GetCurrentThreadPrefix() << "] " \
     << file_name(__FILE__) << '(' << __LINE__ << "): " << osstream << '\n'; \
     logger.Log(s.str()); \
 } while(0);
@@ -43,6 +46,8 @@ constexpr const char* file_name(const char* path)
 
 namespace Botcraft
 {
+    class LogRingBuffer;
+
     enum class LogLevel
     {
         Trace,
@@ -76,13 +81,30 @@ namespace Botcraft
         ~Logger();
 
         static Logger& GetInstance();
+        static const char* GetLevelString(const LogLevel l);
+
+        /// @brief Queue a message for the writer thread. Never blocks
+        /// unless the queue is full
+        /// @param s Message to log
         void Log(const std::string& s);
+        void Log(std::string&& s);
         void SetFilename(const std::string& s);
         void SetLogLevel(const LogLevel l);
         LogLevel GetLogLevel() const;
         void SetLogFunc(const std::function<void(const std::string&)>& f);
         std::stringstream GetDate() const;
 
+        /// @brief Same as GetDate, but the formatted date is cached
+        /// in a thread_local string and only updated once per second
+        /// @return The current date, valid until next call on this thread
+        const std::string& GetCachedDate() const;
+
+        /// @brief Get "name(id)" for the current thread. The value is cached
+        /// in a thread_local string and only updated when a thread
+        /// is registered or unregistered
+        /// @return The prefix of the current thread, valid until next call on this thread
+        const std::string& GetCurrentThreadPrefix();
+
         /// @brief Register the current thread in the map. It will be automatically removed on thread exit.
         /// @param name Thread name
         void RegisterThread(const std::string& name);
@@ -102,15 +124,33 @@ namespace Botcraft
         void UnregisterThread(const std::thread::id id);
 
     private:
+        /// @brief Writer thread loop, pop messages from the queue
+        /// and send them to log_func and the file
+        void Run();
+
+        /// @brief Write all the messages currently in the queue
+        /// @return True if at least one message was written
+        bool Drain();
+
+    private:
+        /// @brief Protect filename, file and log_func. Only locked by the writer thread
+        /// and setters, never by callers of Log
         std::mutex mutex;
         std::string filename;
+        std::ofstream file;
         std::atomic<LogLevel> log_level;
         std::function<void(const std::string&)> log_func;
 
-        std::chrono::steady_clock::time_point last_time_logged;
-        std::string file_buffer;
+        std::unique_ptr<LogRingBuffer> queue;
+        std::thread writer_thread;
+        std::atomic<bool> running;
+        std::atomic<bool> writer_sleeping;
+        std::mutex writer_mutex;
+        std::condition_variable writer_condition;
 
         std::mutex thread_mutex;
         std::unordered_map<std::thread::id, std::string> thread_names;
+        /// @brief Incremented each time thread_names changes, used to invalidate cached prefixes
+        std::atomic<size_t> thread_names_version;
     };
 }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "protocolCraft/Types/NBT/Tag.hpp"
+
+#ifdef USE_COMPRESSION
+struct z_stream_s;
+#endif
+
+namespace Botcraft
+{
+    /// @brief Callbacks called by NBTStreamReader while reading.
+    /// name is empty for list elements. Default implementations
+    /// do nothing, so only the needed ones can be overriden.
+    class NBTStreamHandler
+    {
+    public:
+        virtual ~NBTStreamHandler() {}
+
+        virtual void OnCompoundStart(const std::string& name) {}
+        virtual void OnCompoundEnd() {}
+        virtual void OnListStart(const std::string& name, const ProtocolCraft::TagType elements_type, const int size) {}
+        virtual void OnListEnd() {}
+
+        virtual void OnByte(const std::string& name, const char value) {}
+        virtual void OnShort(const std::string& name, const short value) {}
+        virtual void OnInt(const std::string& name, const int value) {}
+        virtual void OnLong(const std::string& name, const long long int value) {}
+        virtual void OnFloat(const std::string& name, const float value) {}
+        virtual void OnDouble(const std::string& name, const double value) {}
+        virtual void OnString(const std::string& name, const std::string& value) {}
+        virtual void OnByteArray(const std::string& name, const std::vector<char>& values) {}
+        virtual void OnIntArray(const std::string& name, const std::vector<int>& values) {}
+        virtual void OnLongArray(const std::string& name, const std::vector<long long int>& values) {}
+    };
+
+    /// @brief Read NBT from a stream without building any Tag,
+    /// calling a NBTStreamHandler for every tag instead.
+    /// Data are read by small chunks, so huge files (structures,
+    /// schematics) can be processed with a constant memory usage.
+    /// Gzip compressed data are detected and decompressed on the
+    /// fly if botcraft is compiled with compression support.
+    class NBTStreamReader
+    {
+    public:
+        NBTStreamReader(std::istream& stream_);
+        ~NBTStreamReader();
+
+        /// @brief Read a full NBT (root compound) from the stream
+        /// @param handler Callbacks to call for each tag
+        void Read(NBTStreamHandler& handler);
+
+        /// @brief Open a file and read it
+        /// @param path Path to the NBT file, compressed or not
+        /// @param handler Callbacks to call for each tag
+        static void ReadFile(const std::string& path, NBTStreamHandler& handler);
+
+    private:
+        /// @brief Read the payload of a tag and call the corresponding callbacks
+        void ReadPayload(const ProtocolCraft::TagType type, const std::string& name, NBTStreamHandler& handler, const int depth);
+
+        template<typename T>
+        T ReadValue();
+        std::string ReadNBTString();
+
+        /// @brief Get exactly size bytes from the stream, throws if not possible
+        void ReadBytes(unsigned char* out, const size_t size);
+        /// @brief Refill the (decompressed) buffer, return false at the end of the data
+        bool FillBuffer();
+
+    private:
+        std::istream& stream;
+
+        std::vector<unsigned char> input_buffer;
+        std::vector<unsigned char> output_buffer;
+        size_t output_position;
+        size_t output_size;
+
+        bool compressed;
+#ifdef USE_COMPRESSION
+        std::unique_ptr<z_stream_s> inflate_stream;
+        bool inflate_finished;
+#endif
+    };
+} // Botcraft
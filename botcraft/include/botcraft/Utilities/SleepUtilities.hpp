@@ -2,13 +2,31 @@
 
 #include <chrono>
 
+#include "botcraft/Utilities/VirtualClock.hpp"
+
 namespace Botcraft
 {
+    /// @brief Sleep until a given time. The thread sleeps until the
+    /// spin threshold before the deadline, then busy-waits until the end
+    /// @param end Time to wake up
     void SleepUntil(const std::chrono::steady_clock::time_point& end);
 
+    /// @brief Sleep until the VirtualClock reaches a given time
+    /// @param end Virtual time to wake up
+    void SleepUntil(const VirtualClock::time_point& end);
+
+    /// @brief Sleep for a duration of VirtualClock time
     template <class _Rep, class _Period>
     void SleepFor(const std::chrono::duration<_Rep, _Period>& time)
     {
-        SleepUntil(std::chrono::steady_clock::now() + time);
+        SleepUntil(VirtualClock::now() + time);
     }
+
+    /// @brief Set how long before the deadline SleepUntil stops sleeping and
+    /// busy-waits instead. A few hundred microseconds compensate for the OS
+    /// wake up latency, making ticks much more regular at the cost of some CPU.
+    /// Applies to all the threads
+    /// @param threshold Spin duration, 0 (default) to never spin
+    void SetSleepSpinThreshold(const std::chrono::microseconds& threshold);
+    std::chrono::microseconds GetSleepSpinThreshold();
 }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+namespace Botcraft
+{
+    /// @brief Get the cpus of each NUMA node of the machine
+    /// @return One list of cpu indices per node. A single node with
+    /// all the cpus if the topology is unknown (non Linux systems)
+    std::vector<std::vector<int> > GetNumaNodesCpus();
+
+    /// @brief Restrict the calling thread to some cpus
+    /// @param cpus Indices of the allowed cpus
+    /// @return False if the affinity couldn't be set
+    bool SetCurrentThreadAffinity(const std::vector<int>& cpus);
+
+    /// @brief Process-wide split of the cpus in groups, used by the shared
+    /// services (IOContextPool, PhysicsScheduler, BehaviourScheduler and
+    /// World chunk decoding threads) to keep the work of a set of bots on
+    /// the same cores. Each worker thread of these services belongs to one
+    /// group and is pinned to its cpus. Work is routed with the group of
+    /// the calling thread: a bot connected, or its physics/behaviour
+    /// started, from a thread of group g (or in an AffinityGroupScope(g))
+    /// gets the workers of group g. As memory is allocated on the NUMA
+    /// node of the thread touching it first, data created by these
+    /// workers (chunks, entities...) also stay on the group node.
+    /// Groups must be set before starting the services, see SwarmConfig::affinity_groups.
+    /// No group (default) means no pinning and no routing
+    class AffinityGroups
+    {
+    public:
+        static AffinityGroups& GetInstance();
+
+        AffinityGroups(const AffinityGroups&) = delete;
+        AffinityGroups& operator=(const AffinityGroups&) = delete;
+        AffinityGroups(AffinityGroups&&) = delete;
+        AffinityGroups& operator=(AffinityGroups&&) = delete;
+
+        /// @brief Set the groups. Threads already started keep their group
+        /// @param cpus_ Cpus of each group, empty to disable
+        void SetGroups(const std::vector<std::vector<int> >& cpus_);
+        const size_t GetNumGroups() const;
+        const std::vector<int> GetCpus(const int group) const;
+
+        /// @brief Pin the calling thread to the cpus of a group, and mark it as part of it.
+        /// Does nothing if group is not valid
+        /// @param group Index of the group
+        void JoinGroup(const int group);
+
+        /// @brief Get the group of the calling thread
+        /// @return The group index, -1 if the thread doesn't belong to a group
+        static const int GetCurrentGroup();
+
+    private:
+        AffinityGroups();
+
+        friend class AffinityGroupScope;
+        static thread_local int current_group;
+
+        mutable std::mutex mutex;
+        std::vector<std::vector<int> > cpus;
+    };
+
+    /// @brief Make the calling thread route its work to a group while
+    /// the scope is alive, without pinning it
+    class AffinityGroupScope
+    {
+    public:
+        AffinityGroupScope(const int group);
+        ~AffinityGroupScope();
+
+        AffinityGroupScope(const AffinityGroupScope&) = delete;
+        AffinityGroupScope& operator=(const AffinityGroupScope&) = delete;
+
+    private:
+        int previous_group;
+    };
+} // Botcraft
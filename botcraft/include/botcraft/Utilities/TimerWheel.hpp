@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "botcraft/Utilities/VirtualClock.hpp"
+
+namespace Botcraft
+{
+    /// @brief A hashed timer wheel. Timers are stored in the slot of their
+    /// deadline tick, so scheduling and cancelling are O(1), and advancing
+    /// only looks at the slots of the elapsed ticks. Callbacks are called by
+    /// the thread calling Advance, without any lock held, so they can
+    /// schedule or cancel other timers. Thread-safe.
+    class TimerWheel
+    {
+    public:
+        using TimerId = unsigned long long;
+
+        /// @param tick_duration_ Resolution of the wheel, timers fire at most one tick late
+        /// @param num_slots_ Number of slots in the wheel
+        TimerWheel(const std::chrono::milliseconds& tick_duration_ = std::chrono::milliseconds(10), const size_t num_slots_ = 512);
+
+        /// @brief Schedule a callback
+        /// @param deadline Time at which callback should be called
+        /// @param callback Function to call
+        /// @return An id that can be used to cancel the timer, never 0
+        TimerId Schedule(const VirtualClock::time_point& deadline, std::function<void()>&& callback);
+
+        /// @brief Schedule a callback after a delay
+        /// @param delay_ms Delay before callback is called, in ms
+        /// @param callback Function to call
+        /// @return An id that can be used to cancel the timer, never 0
+        TimerId ScheduleIn(const int delay_ms, std::function<void()>&& callback);
+
+        /// @brief Cancel a timer that hasn't fired yet
+        /// @param id The timer to cancel
+        /// @return True if the timer was cancelled, false if it already fired or doesn't exist
+        bool Cancel(const TimerId id);
+
+        /// @brief Fire all the timers with a deadline before now
+        /// @param now Current time
+        /// @return The number of fired timers
+        size_t Advance(const VirtualClock::time_point& now);
+
+        /// @brief Get the number of timers waiting to fire
+        size_t GetNumTimers() const;
+
+    private:
+        struct Timer
+        {
+            TimerId id;
+            long long int deadline_tick;
+            std::function<void()> callback;
+        };
+
+        /// @brief Get the tick a time point belongs to, rounded up
+        long long int GetTick(const VirtualClock::time_point& t) const;
+
+    private:
+        const VirtualClock::duration tick_duration;
+        const VirtualClock::time_point origin;
+
+        mutable std::mutex wheel_mutex;
+        std::vector<std::list<Timer> > slots;
+        /// @brief Slot and position of every waiting timer, for O(1) cancellation
+        std::unordered_map<TimerId, std::pair<size_t, std::list<Timer>::iterator> > timers;
+        /// @brief Last tick processed by Advance
+        long long int current_tick;
+        TimerId next_id;
+    };
+} // Botcraft
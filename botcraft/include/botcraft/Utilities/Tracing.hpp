@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Botcraft
+{
+    struct TraceThreadBuffer;
+
+    /// @brief Collect timed zones from all the threads (network IO, packet
+    /// processing, chunk decoding, physics, behaviours, rendering) and export
+    /// them in Chrome trace event JSON format, that can be opened in
+    /// chrome://tracing, Perfetto, or Tracy after conversion with its
+    /// import-chrome tool. Threads are named after their Logger::RegisterThread name.
+    /// Zones are only recorded if botcraft is compiled with BOTCRAFT_TRACING,
+    /// otherwise the TRACE_ZONE macros expand to nothing and Stop does nothing
+    class Tracer
+    {
+    public:
+        static Tracer& GetInstance();
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+        Tracer(Tracer&&) = delete;
+        Tracer& operator=(Tracer&&) = delete;
+
+        /// @brief Start recording zones. Zones recorded by a previous Start are discarded
+        void Start();
+
+        /// @brief Stop recording and write the zones recorded since Start
+        /// @param path Path of the JSON file, overwritten if it exists
+        /// @return False if the file can't be written or botcraft has been compiled without tracing
+        bool Stop(const std::string& path);
+
+        const bool IsRunning() const;
+
+        /// @brief Get a copy of a string that stays valid until the end of
+        /// the program, to name zones with names known at runtime only
+        /// @param s The string to copy
+        /// @return A pointer to the copy, the same for all the calls with an equal string
+        const char* Intern(const std::string& s);
+
+    private:
+        Tracer();
+
+#if USE_TRACING
+        friend class TraceZone;
+        friend class TraceAsyncZone;
+
+        /// @brief Zones are recorded in per thread buffers, so recording
+        /// doesn't need to lock a shared mutex. Zones above this count are dropped
+        static constexpr size_t max_events_per_thread = 1 << 20;
+
+        /// @brief Add an event in the buffer of the calling thread
+        /// @param phase 'X' for a complete zone, 'b'/'e' for the begin/end of an async one
+        void Record(const char phase, const char* name, const std::chrono::steady_clock::time_point& start,
+            const std::chrono::steady_clock::time_point& end, const void* id = nullptr,
+            const int num_args = 0, const char* const* arg_names = nullptr, const long long* args = nullptr);
+#endif
+
+        std::atomic<bool> running;
+
+        std::mutex interned_mutex;
+        std::unordered_set<std::string> interned;
+
+#if USE_TRACING
+        mutable std::mutex buffers_mutex;
+        std::vector<std::shared_ptr<TraceThreadBuffer> > buffers;
+        /// @brief Time of the last Start call, events are written relative to it
+        std::chrono::steady_clock::time_point origin;
+#endif
+    };
+
+#if USE_TRACING
+    /// @brief Record a zone on the calling thread from its construction to its
+    /// destruction, with up to two integer arguments (packet id, chunk coordinates...).
+    /// Use TRACE_ZONE instead of creating it directly
+    class TraceZone
+    {
+    public:
+        TraceZone(const char* name_);
+        TraceZone(const char* name_, const char* arg_name_0, const long long arg_0);
+        TraceZone(const char* name_, const char* arg_name_0, const long long arg_0, const char* arg_name_1, const long long arg_1);
+        ~TraceZone();
+
+        TraceZone(const TraceZone&) = delete;
+        TraceZone& operator=(const TraceZone&) = delete;
+
+    private:
+        const char* name;
+        const char* arg_names[2];
+        long long args[2];
+        int num_args;
+        // False if the tracer was not running when the zone started
+        bool active;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// @brief Record a zone that can be suspended and resumed on another
+    /// thread, like a behaviour tree node running in a fiber. Zones with the
+    /// same id are displayed on their own track, nested in creation order.
+    /// Use TRACE_ASYNC_ZONE instead of creating it directly
+    class TraceAsyncZone
+    {
+    public:
+        TraceAsyncZone(const char* name_, const void* id_);
+        ~TraceAsyncZone();
+
+        TraceAsyncZone(const TraceAsyncZone&) = delete;
+        TraceAsyncZone& operator=(const TraceAsyncZone&) = delete;
+
+    private:
+        const char* name;
+        const void* id;
+        bool active;
+    };
+#endif
+} // Botcraft
+
+#if USE_TRACING
+#define BOTCRAFT_TRACE_CONCAT_IMPL(a, b) a##b
+#define BOTCRAFT_TRACE_CONCAT(a, b) BOTCRAFT_TRACE_CONCAT_IMPL(a, b)
+/// @brief Record the rest of the current scope as a zone: TRACE_ZONE("Name"),
+/// TRACE_ZONE("Name", "arg", value) or TRACE_ZONE("Name", "arg0", value0, "arg1", value1).
+/// Names must stay valid until the trace is written (string literals or Tracer::Intern)
+#define TRACE_ZONE(...) Botcraft::TraceZone BOTCRAFT_TRACE_CONCAT(botcraft_trace_zone_, __LINE__)(__VA_ARGS__)
+/// @brief Record the rest of the current scope as a zone that can be
+/// suspended and resumed on other threads, on the track of id
+#define TRACE_ASYNC_ZONE(name, id) Botcraft::TraceAsyncZone BOTCRAFT_TRACE_CONCAT(botcraft_trace_zone_, __LINE__)(name, id)
+#else
+#define TRACE_ZONE(...)
+#define TRACE_ASYNC_ZONE(name, id)
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+
+namespace Botcraft
+{
+    /// @brief The clock used for everything measured in game time: physics
+    /// ticks, behaviour steps, TimerWheel, task timeouts, effects durations...
+    /// It follows std::chrono::steady_clock by default, but can run faster
+    /// (or slower) to execute bots against a FakeServer quicker than real time,
+    /// e.g. for regression or tuning runs of behaviour trees. Network, profiling
+    /// and rendering code keeps using the real clock. Task timeouts waiting for
+    /// a server answer shrink too, so the speed must keep them above the real
+    /// round trip time (a few tens is fine against a local FakeServer).
+    /// Time points of this clock are not convertible to steady_clock ones on purpose,
+    /// use ToSteady to get the real time matching a virtual one (e.g. to sleep).
+    class VirtualClock
+    {
+    public:
+        using rep = std::chrono::steady_clock::rep;
+        using period = std::chrono::steady_clock::period;
+        using duration = std::chrono::steady_clock::duration;
+        using time_point = std::chrono::time_point<VirtualClock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept;
+
+        /// @brief Set how fast the virtual time goes compared to the real one.
+        /// The virtual time stays continuous, but everything already waiting
+        /// keeps its deadline, so it should be set before starting the bots
+        /// @param speed Speed factor, 1 (default) for real time, 100 to run everything 100 times faster
+        static void SetSpeed(const double speed);
+        static double GetSpeed();
+
+        /// @brief Get the real time at which the virtual clock will reach a given time
+        /// @param t A virtual time point
+        /// @return The matching steady_clock time point
+        static std::chrono::steady_clock::time_point ToSteady(const time_point& t);
+    };
+} // Botcraft
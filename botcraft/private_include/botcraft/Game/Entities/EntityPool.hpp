@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Botcraft
+{
+    /// @brief A process-wide set of free lists of memory blocks, indexed
+    /// by size. Used to allocate entities with their shared_ptr control
+    /// block: when an entity is destroyed, its block is kept to be reused
+    /// by the next entity of the same type instead of going back to the heap.
+    class EntityPool
+    {
+    private:
+        EntityPool();
+    public:
+        EntityPool(const EntityPool&) = delete;
+        EntityPool& operator=(const EntityPool&) = delete;
+        EntityPool(EntityPool&&) = delete;
+        EntityPool& operator=(EntityPool&&) = delete;
+
+        /// @brief Never destroyed, as pooled entities can outlive any static object
+        static EntityPool& GetInstance();
+
+        /// @brief Get a block of a given size, reused if possible
+        void* Allocate(const size_t size);
+
+        /// @brief Give a block back to the pool. It is freed if
+        /// there are already too many blocks of this size waiting
+        void Release(void* block, const size_t size);
+
+        /// @brief Get the number of blocks waiting to be reused
+        size_t GetNumFreeBlocks() const;
+
+    private:
+        /// @brief Max number of blocks waiting to be reused, for each size
+        static constexpr size_t max_free_blocks_per_size = 256;
+
+        std::unordered_map<size_t, std::vector<void*> > free_blocks;
+        size_t num_free_blocks;
+        mutable std::mutex pool_mutex;
+    };
+
+    /// @brief Allocator using EntityPool, to be used with std::allocate_shared
+    template<class T>
+    class EntityPoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        EntityPoolAllocator() = default;
+
+        template<class U>
+        EntityPoolAllocator(const EntityPoolAllocator<U>&)
+        {
+
+        }
+
+        T* allocate(const size_t n)
+        {
+            return static_cast<T*>(EntityPool::GetInstance().Allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, const size_t n)
+        {
+            EntityPool::GetInstance().Release(p, n * sizeof(T));
+        }
+
+        template<class U>
+        bool operator==(const EntityPoolAllocator<U>&) const
+        {
+            return true;
+        }
+
+        template<class U>
+        bool operator!=(const EntityPoolAllocator<U>&) const
+        {
+            return false;
+        }
+    };
+} // Botcraft
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "botcraft/Game/Physics/PhysicsManager.hpp"
+
+namespace Botcraft
+{
+    /// @brief Physics tick of several PhysicsManager using the same World.
+    /// The kinematic states of the players are copied in structure of arrays,
+    /// so the swept boxes, the gravity and the drag of all the players are
+    /// computed in the same vectorizable loops, and a single world snapshot
+    /// is taken for the whole batch. Only the collisions with the blocks
+    /// around each player are computed separately. Reused between ticks
+    /// to keep its buffers
+    class PhysicsBatch
+    {
+    public:
+        PhysicsBatch();
+        ~PhysicsBatch();
+
+        /// @brief Run one physics tick for a list of managers
+        /// @param managers First manager of the list, they must all use the same World
+        /// @param num_managers Number of managers in the list
+        void Tick(PhysicsManager* const* managers, const size_t num_managers);
+
+    private:
+        /// @brief Resize all the arrays to n players
+        void Resize(const size_t n);
+        /// @brief Compute the movement and the box swept by each player
+        void ComputeBroadphase();
+        /// @brief Keep the players above the void and apply gravity and drag
+        /// to their speed, like PhysicsManager::ApplyDrag
+        /// @param world_min_y Min y of the world
+        void ComputeDrag(const double world_min_y);
+
+    private:
+        /// @brief One step per manager of the batch
+        std::vector<PhysicsManager::PhysicsStep> steps;
+        /// @brief Index of the steps begun this tick
+        std::vector<size_t> begun_steps;
+        /// @brief Index of the steps with a player in loaded chunks,
+        /// one per element of the following arrays
+        std::vector<size_t> loaded_steps;
+
+        std::vector<double> position_x;
+        std::vector<double> position_y;
+        std::vector<double> position_z;
+        std::vector<double> speed_x;
+        std::vector<double> speed_y;
+        std::vector<double> speed_z;
+        std::vector<double> input_x;
+        std::vector<double> input_y;
+        std::vector<double> input_z;
+        std::vector<double> half_width;
+        std::vector<double> half_height;
+        std::vector<unsigned char> on_ground;
+        std::vector<unsigned char> fall_in_void;
+
+        std::vector<double> movement_x;
+        std::vector<double> movement_y;
+        std::vector<double> movement_z;
+        std::vector<double> min_x;
+        std::vector<double> min_y;
+        std::vector<double> min_z;
+        std::vector<double> max_x;
+        std::vector<double> max_y;
+        std::vector<double> max_z;
+
+        std::vector<double> drag_speed_y;
+        std::vector<unsigned char> drag_on_ground;
+        std::vector<double> next_speed_x;
+        std::vector<double> next_speed_y;
+        std::vector<double> next_speed_z;
+    };
+} // Botcraft
@@ -19,10 +19,29 @@ namespace Botcraft
         std::vector<unsigned char> Encrypt(const std::vector<unsigned char>& in);
         std::vector<unsigned char> Decrypt(const std::vector<unsigned char>& in);
 
+        // AES-CFB8 output has the same size as the input,
+        // so we can directly encrypt/decrypt data in the buffers
+        void EncryptInPlace(unsigned char* data, const size_t size);
+        void DecryptInPlace(unsigned char* data, const size_t size);
+
+    private:
+        /// @brief CFB8 decryption using AES-NI/ARMv8 crypto instructions.
+        /// Unlike encryption, each output byte only depends on the
+        /// previous 16 ciphertext bytes, so several blocks can be
+        /// computed at the same time
+        void DecryptInPlaceHardware(unsigned char* data, const size_t size);
+
     private:
         EVP_CIPHER_CTX* encryption_context;
         EVP_CIPHER_CTX* decryption_context;
         unsigned int blocksize;
+
+        /// @brief True if DecryptInPlaceHardware is used instead of OpenSSL
+        bool hardware_decryption;
+        /// @brief AES-128 expanded key, 11 round keys
+        alignas(16) unsigned char round_keys[176];
+        /// @brief Last 16 ciphertext bytes received
+        unsigned char decryption_register[16];
     };
 }
 #endif // USE_ENCRYPTION
\ No newline at end of file
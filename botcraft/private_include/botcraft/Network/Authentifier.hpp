@@ -2,6 +2,9 @@
 #include <nlohmann/json.hpp>
 
 #include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
 
 namespace Botcraft
 {
@@ -35,11 +38,26 @@ namespace Botcraft
 
         const std::string& GetPlayerDisplayName() const;
 
+        /// @brief Get the HTTP requests sent by this Authentifier
+        /// @return "METHOD host/endpoint" and duration in ms of each request, in sending order
+        const std::vector<std::pair<std::string, double> > GetRequestTimings() const;
+
+        /// @brief Authenticate several Microsoft accounts in parallel. The cache file
+        /// is only written once at the end, and the obtained credentials stay in the
+        /// in memory cache, so AuthMicrosoft on these logins doesn't need any request.
+        /// @param logins Logins used as keys for the cached credentials
+        /// @param max_parallel Max number of accounts authenticated at the same time
+        /// @param min_interval Min delay between two authentication starts, to avoid being rate limited
+        /// @return The number of successfully authenticated accounts
+        static size_t AuthMicrosoftBatch(const std::vector<std::string>& logins, const unsigned int max_parallel,
+            const std::chrono::milliseconds min_interval);
+
     private:
 #ifdef USE_ENCRYPTION
-        /// @brief Get the content of the whole cache file
+        /// @brief Get the in memory copy of the cache file, loaded
+        /// on first access. cache_mutex must be locked by the caller
         /// @return The content in JSON
-        nlohmann::json GetCachedProfiles() const;
+        static nlohmann::json& GetCachedProfiles();
 
         /// @brief Try to find a cached account corresponding to login.
         /// Only one Microsoft account can be cached using an empty login.
@@ -67,9 +85,14 @@ namespace Botcraft
         /// @return True if expired, false if valid
         const bool IsTokenExpired(const long long int& t) const;
 
-        /// @brief Save a profiles list to cache file
+        /// @brief Save a profiles list to cache file. Content is written to a
+        /// temporary file first, then renamed, so the file is never half written
         /// @param profiles A json object with logins as keys and cache credentials as values
-        void WriteCacheFile(const nlohmann::json& profiles) const;
+        static void WriteCacheFile(const nlohmann::json& profiles);
+
+        /// @brief Write the in memory cache to file, or mark it as dirty when
+        /// a batch is running. cache_mutex must be locked by the caller
+        static void SaveCachedProfiles();
 
         /// @brief Update the cached MSA data for the given login
         /// @param login The login we want to update the data for
@@ -161,6 +184,11 @@ namespace Botcraft
         /// @return A WebRequestResponse returned by the server
         const WebRequestResponse GETRequest(const std::string& host, const std::string& endpoint,
             const std::string& authorization = "") const;
+
+        /// @brief Add a request to the ones returned by GetRequestTimings
+        /// @param name "METHOD host/endpoint"
+        /// @param start Time when the request was started
+        void RecordRequestTiming(const std::string& name, const std::chrono::steady_clock::time_point& start) const;
 #endif
 
     private:
@@ -173,10 +201,22 @@ namespace Botcraft
 
         /// @brief Default cached credentials JSON
         static const nlohmann::json defaultCachedCredentials;
+
+        /// @brief Protect all the cache static members, shared by all the Authentifier
+        static std::mutex cache_mutex;
+        static nlohmann::json cached_profiles;
+        static bool cached_profiles_loaded;
+        /// @brief Number of running AuthMicrosoftBatch, the file is not written while > 0
+        static int cache_batch_depth;
+        /// @brief True if the in memory cache has been modified but not written to file yet
+        static bool cache_dirty;
         
         std::string player_display_name;
         std::string mc_access_token;
         std::string mc_player_uuid;
-        
+
+        /// @brief Filled by the const request functions, JoinServer is called from a network thread
+        mutable std::mutex request_timings_mutex;
+        mutable std::vector<std::pair<std::string, double> > request_timings;
     };
 }
@@ -1,11 +1,73 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+
+#ifdef USE_COMPRESSION
+struct z_stream_s;
+#endif
 
 namespace Botcraft
 {
 #ifdef USE_COMPRESSION
     std::vector<unsigned char> Compress(const std::vector<unsigned char> &raw, const int &start = 0, const int &size = -1);
     std::vector<unsigned char> Decompress(const std::vector<unsigned char> &compressed, const int &start = 0, const int &size = -1);
+
+    /// @brief Keep zlib streams alive across packets
+    /// to avoid paying zlib init for each of them.
+    /// Compression and decompression use separate streams
+    /// so they can be used from two different threads.
+    class CompressionContext
+    {
+    public:
+        /// @param compression_level_ zlib deflate level (0-9), -1 for zlib default
+        /// @param use_fast_backend_ If false, always use zlib even if a faster backend is available
+        CompressionContext(const int compression_level_ = -1, const bool use_fast_backend_ = true);
+        ~CompressionContext();
+
+        /// @brief Check if botcraft has been compiled with a faster backend
+        /// than zlib (libdeflate) for whole packet (de)compression
+        static const bool HasFastBackend();
+
+        void SetCompressionLevel(const int compression_level_);
+        const int GetCompressionLevel() const;
+
+        /// @brief Compress data and append the result at the end of out
+        /// @param data Pointer to the data to compress
+        /// @param size Size of the data to compress
+        /// @param out Output buffer, compressed data are appended at the end
+        /// @param limit_size If true, throw if data are too big to be sent in a packet
+        void Compress(const unsigned char* data, const size_t size, std::vector<unsigned char>& out, const bool limit_size = true);
+
+        /// @brief Decompress data into out. out is resized to
+        /// the decompressed size, but its capacity is kept
+        /// so it can be reused for the next packet. When
+        /// expected_size is given, the fast backend (if any)
+        /// decodes the whole buffer in one call
+        /// @param data Pointer to the compressed data
+        /// @param size Size of the compressed data
+        /// @param out Output buffer
+        /// @param expected_size Decompressed size if known (0 otherwise)
+        void Decompress(const unsigned char* data, const size_t size, std::vector<unsigned char>& out, const size_t expected_size = 0);
+
+        /// @brief Decompress only the first bytes of some data
+        /// @param data Pointer to the compressed data
+        /// @param size Size of the compressed data
+        /// @param out Output buffer
+        /// @param out_size Max number of bytes to decompress
+        /// @return The number of decompressed bytes written in out
+        const size_t DecompressPrefix(const unsigned char* data, const size_t size, unsigned char* out, const size_t out_size);
+
+    private:
+        std::unique_ptr<z_stream_s> deflate_stream;
+        std::unique_ptr<z_stream_s> inflate_stream;
+        int compression_level;
+
+        /// @brief Defined in Compression.cpp only when a fast backend is
+        /// compiled, so this class layout doesn't depend on it
+        struct FastBackend;
+        /// @brief nullptr if zlib is used for everything
+        std::unique_ptr<FastBackend> fast_backend;
+    };
 #endif
-} // Botcraft
\ No newline at end of file
+} // Botcraft
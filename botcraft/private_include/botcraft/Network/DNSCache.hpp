@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+#include <asio.hpp>
+
+namespace Botcraft
+{
+    /// @brief A process-wide cache of server address lookups.
+    /// SRV answers are kept for their TTL, resolved endpoints for
+    /// a fixed duration (getaddrinfo doesn't give TTLs). Concurrent
+    /// lookups of the same name wait for the one in progress, so a lot
+    /// of bots (re)connecting at the same time only send one query.
+    class DNSCache
+    {
+    private:
+        DNSCache();
+    public:
+        using ResolveHandler = std::function<void(const asio::error_code&, const asio::ip::tcp::resolver::results_type&)>;
+
+        DNSCache(const DNSCache&) = delete;
+        DNSCache& operator=(const DNSCache&) = delete;
+        DNSCache(DNSCache&&) = delete;
+        DNSCache& operator=(DNSCache&&) = delete;
+        ~DNSCache();
+
+        static DNSCache& GetInstance();
+
+        /// @brief Get the minecraft SRV record of an address. Blocking if not in cache
+        /// @param address Server address without port
+        /// @param target Output target host, only set if found
+        /// @param port Output target port, only set if found
+        /// @return True if a SRV record exists for this address
+        bool LookupSRV(const std::string& address, std::string& target, unsigned short& port);
+
+        /// @brief Resolve host:port. Blocking if not in cache, throws if resolution fails
+        /// @param host Host to resolve
+        /// @param port Port
+        /// @return The resolved endpoints
+        asio::ip::tcp::resolver::results_type Resolve(const std::string& host, const unsigned short port);
+
+        /// @brief Resolve host:port asynchronously. If the result is not in cache, the
+        /// resolution is started on io_service, so it must outlive the query (shared IOContextPool)
+        /// @param io_service io_service on which the handler will be called
+        /// @param host Host to resolve
+        /// @param port Port
+        /// @param handler Function called with the result
+        void AsyncResolve(asio::io_service& io_service, const std::string& host, const unsigned short port, const ResolveHandler& handler);
+
+        /// @brief Forget all cached results
+        void Clear();
+
+    private:
+        /// @brief Send a SRV query and wait for the answer
+        /// @param address Server address without port
+        /// @param target Output target host
+        /// @param port Output target port
+        /// @param ttl Output TTL of the answer, in seconds
+        /// @return True if a SRV record has been found
+        bool QuerySRV(const std::string& address, std::string& target, unsigned short& port, unsigned int& ttl);
+
+        /// @brief Store a resolution result and notify everyone waiting for it
+        /// @param key Entry key
+        /// @param error Resolution error
+        /// @param endpoints Resolved endpoints
+        void OnResolved(const std::string& key, const asio::error_code& error, const asio::ip::tcp::resolver::results_type& endpoints);
+
+    private:
+        struct SRVEntry
+        {
+            std::chrono::steady_clock::time_point expiration;
+            bool pending = false;
+            bool found = false;
+            std::string target;
+            unsigned short port = 0;
+        };
+
+        struct ResolveEntry
+        {
+            std::chrono::steady_clock::time_point expiration;
+            bool pending = false;
+            asio::ip::tcp::resolver::results_type endpoints;
+            std::vector<std::pair<asio::io_service*, ResolveHandler> > waiting_handlers;
+        };
+
+        std::mutex cache_mutex;
+        std::condition_variable cache_condition;
+        std::unordered_map<std::string, SRVEntry> srv_entries;
+        std::unordered_map<std::string, ResolveEntry> resolve_entries;
+
+        /// @brief How long to remember that an address has no SRV record
+        static constexpr std::chrono::seconds srv_negative_ttl = std::chrono::seconds(60);
+        /// @brief How long to keep resolved endpoints
+        static constexpr std::chrono::seconds resolve_ttl = std::chrono::seconds(60);
+        /// @brief Max time to wait for a SRV answer
+        static constexpr std::chrono::seconds srv_timeout = std::chrono::seconds(3);
+    };
+} // Botcraft
@@ -0,0 +1,79 @@
+#pragma once
+
+#ifdef USE_COMPRESSION
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace Botcraft
+{
+    /// @brief A compressed packet inflated by the DecompressionPool
+    struct DecompressionJob
+    {
+        /// @brief Packet as received from TCP_Com (data length VarInt + compressed data)
+        std::vector<unsigned char> packet;
+        /// @brief Decompressed packet, empty if packet was not compressed
+        std::vector<unsigned char> output;
+        /// @brief Decompression error, empty if none
+        std::string error;
+
+        /// @brief Block until the job has been processed by a worker
+        void Wait();
+
+    private:
+        friend class DecompressionPool;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool done = false;
+    };
+
+    /// @brief A process-wide pool of threads inflating received packets,
+    /// so big compressed packets (mostly chunks) of one or multiple
+    /// connections are decompressed on multiple cores. Packets are still
+    /// dispatched by the processing thread of their connection, in order
+    class DecompressionPool
+    {
+    private:
+        DecompressionPool();
+    public:
+        DecompressionPool(const DecompressionPool&) = delete;
+        DecompressionPool& operator=(const DecompressionPool&) = delete;
+        DecompressionPool(DecompressionPool&&) = delete;
+        DecompressionPool& operator=(DecompressionPool&&) = delete;
+        ~DecompressionPool();
+
+        static DecompressionPool& GetInstance();
+
+        /// @brief Start the pool. Does nothing if it's already running
+        /// @param num_threads Number of worker threads, 0 for one per hardware core
+        void Start(const unsigned int num_threads = 0);
+
+        /// @brief Stop the pool and join the threads, the pending jobs are processed first
+        void Stop();
+
+        const bool IsRunning() const;
+
+        /// @brief Queue a packet to decompress
+        /// @param packet Packet as received from TCP_Com
+        /// @return The job, nullptr if the pool is not running
+        std::shared_ptr<DecompressionJob> Submit(std::vector<unsigned char>&& packet);
+
+    private:
+        void Run();
+
+    private:
+        std::vector<std::thread> threads;
+        std::deque<std::shared_ptr<DecompressionJob> > jobs;
+        std::atomic<bool> running;
+        std::mutex pool_mutex;
+        std::mutex jobs_mutex;
+        std::condition_variable jobs_condition;
+    };
+} // Botcraft
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifdef USE_ENCRYPTION
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+
+namespace Botcraft
+{
+    /// @brief A TLS connection to a web server, that can be
+    /// given back to the pool to be reused by a later request
+    struct HTTPSConnection
+    {
+        HTTPSConnection(asio::io_context& io_context, asio::ssl::context& ssl_context, const std::string& host_);
+
+        std::string host;
+        asio::ssl::stream<asio::ip::tcp::socket> stream;
+        std::chrono::steady_clock::time_point last_used;
+        /// @brief True if this connection already served at least one request
+        bool reused;
+    };
+
+    /// @brief A process-wide pool of idle keep-alive HTTPS connections,
+    /// indexed by host. New connections to a known host resume
+    /// the previous TLS session and reuse the resolved endpoints,
+    /// to avoid full handshakes when a lot of bots log in at the same time.
+    class HTTPSConnectionPool
+    {
+    private:
+        HTTPSConnectionPool();
+    public:
+        HTTPSConnectionPool(const HTTPSConnectionPool&) = delete;
+        HTTPSConnectionPool& operator=(const HTTPSConnectionPool&) = delete;
+        HTTPSConnectionPool(HTTPSConnectionPool&&) = delete;
+        HTTPSConnectionPool& operator=(HTTPSConnectionPool&&) = delete;
+        ~HTTPSConnectionPool();
+
+        static HTTPSConnectionPool& GetInstance();
+
+        /// @brief Get an idle connection to host, or open a new one if there is none.
+        /// Throws if a new connection can't be established
+        /// @param host The host address
+        /// @return A connected stream, owned by the caller until Release is called
+        std::unique_ptr<HTTPSConnection> Acquire(const std::string& host);
+
+        /// @brief Give a connection back to the pool after a complete response has been read.
+        /// Connections that should not be reused must simply be destroyed instead
+        /// @param connection The connection to keep alive
+        void Release(std::unique_ptr<HTTPSConnection>&& connection);
+
+        /// @brief Close all idle connections and forget cached sessions and endpoints
+        void Clear();
+
+    private:
+        /// @brief Get the endpoints of host, resolving them if not cached or too old
+        /// @param host The host address
+        /// @param force_resolve If true, ignore cached endpoints
+        /// @return The resolved endpoints
+        asio::ip::tcp::resolver::results_type GetEndpoints(const std::string& host, const bool force_resolve);
+
+        /// @brief OpenSSL callback called when a new session is established (or a TLS1.3 ticket arrives)
+        static int OnNewSession(SSL* ssl, SSL_SESSION* session);
+
+    private:
+        asio::io_context io_context;
+        asio::ssl::context ssl_context;
+
+        std::mutex pool_mutex;
+        std::unordered_map<std::string, std::vector<std::unique_ptr<HTTPSConnection> > > idle_connections;
+        std::unordered_map<std::string, SSL_SESSION*> sessions;
+        std::unordered_map<std::string, std::pair<std::chrono::steady_clock::time_point, asio::ip::tcp::resolver::results_type> > endpoints;
+
+        /// @brief Idle connections older than that are closed instead of being reused
+        static constexpr std::chrono::seconds idle_timeout = std::chrono::seconds(30);
+        /// @brief Resolved endpoints older than that are resolved again
+        static constexpr std::chrono::minutes endpoints_timeout = std::chrono::minutes(5);
+        /// @brief Max number of idle connections kept for the same host
+        static constexpr size_t max_idle_per_host = 16;
+    };
+} // Botcraft
+
+#endif
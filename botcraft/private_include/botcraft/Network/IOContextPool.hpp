@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <asio.hpp>
+
+namespace Botcraft
+{
+    /// @brief A process-wide pool of io_service, each one
+    /// run by its own thread. When started, TCP_Com attach
+    /// themselves to one of the io_service (round robin) instead
+    /// of creating their own io_service and thread.
+    /// As each io_service is run by only one thread, all the
+    /// handlers of a given connection are still executed sequentially.
+    /// If AffinityGroups are set when the pool starts, threads are split
+    /// between the groups, and connections get an io_service of the group
+    /// of the thread creating them.
+    class IOContextPool
+    {
+    private:
+        IOContextPool();
+    public:
+        IOContextPool(const IOContextPool&) = delete;
+        IOContextPool& operator=(const IOContextPool&) = delete;
+        IOContextPool(IOContextPool&&) = delete;
+        IOContextPool& operator=(IOContextPool&&) = delete;
+        ~IOContextPool();
+
+        static IOContextPool& GetInstance();
+
+        /// @brief Start the pool. Does nothing if it's already running
+        /// @param num_threads Number of threads (and io_service) in the pool, 0 for one per hardware core
+        void Start(const unsigned int num_threads = 0);
+
+        /// @brief Stop all the io_service and join the threads.
+        /// All connections using the pool must be closed before calling this
+        void Stop();
+
+        const bool IsRunning() const;
+
+        /// @brief Get the next io_service to use (round robin, in the
+        /// group of the calling thread if any)
+        /// @return A reference to an io_service of the pool
+        asio::io_service& GetIOService();
+
+    private:
+        std::vector<std::unique_ptr<asio::io_service> > io_services;
+        std::vector<std::unique_ptr<asio::io_service::work> > works;
+        std::vector<std::thread> threads;
+        /// @brief Indices of the io_service of each affinity group
+        std::vector<std::vector<size_t> > group_io_services;
+
+        std::atomic<size_t> next_io_service;
+        std::atomic<bool> running;
+        std::mutex pool_mutex;
+    };
+} // Botcraft
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "protocolCraft/enums.hpp"
+
+namespace Botcraft
+{
+    /// @brief One packet of a capture file
+    struct PacketCaptureRecord
+    {
+        /// @brief Time since the start of the capture, in microseconds
+        long long int timestamp_us = 0;
+        /// @brief Connection state when the packet was received
+        ProtocolCraft::ConnectionState state = ProtocolCraft::ConnectionState::None;
+        /// @brief Decompressed packet data, starting with the packet id
+        std::vector<unsigned char> data;
+    };
+
+    /// @brief Write clientbound packets in a capture file.
+    /// File format: "BCPC" magic, protocol version (int), then for each
+    /// packet: timestamp (long long), state (char), size (int) and data.
+    /// Numbers are big endian, like in the network protocol
+    class PacketCaptureWriter
+    {
+    public:
+        /// @brief Create the file and write the header, throws a std::runtime_error on failure
+        /// @param path Path of the file to create
+        PacketCaptureWriter(const std::string& path);
+
+        /// @brief Append one packet to the file
+        void Write(const long long int timestamp_us, const ProtocolCraft::ConnectionState state, const unsigned char* data, const size_t size);
+
+    private:
+        std::ofstream file;
+        std::vector<unsigned char> buffer;
+    };
+
+    /// @brief Read a file written by PacketCaptureWriter
+    class PacketCaptureReader
+    {
+    public:
+        /// @brief Open a capture file, throws a std::runtime_error if it's not a valid capture for this protocol version
+        /// @param path Path of the file to read
+        PacketCaptureReader(const std::string& path);
+
+        /// @brief Read the next packet of the file
+        /// @param record Output record, its data buffer is reused
+        /// @return False at the end of the file
+        bool Next(PacketCaptureRecord& record);
+
+    private:
+        std::ifstream file;
+    };
+} // Botcraft
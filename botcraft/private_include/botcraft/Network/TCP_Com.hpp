@@ -1,7 +1,11 @@
 #pragma once
 
-#include <deque>
+#include <vector>
 #include <thread>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <asio.hpp>
 
 namespace Botcraft
@@ -10,16 +14,49 @@ namespace Botcraft
     class AESEncrypter;
 #endif
 
+    /// @brief Time of each connection step, default time_point if not reached (yet)
+    struct TCP_ComTimings
+    {
+        /// @brief TCP_Com creation
+        std::chrono::steady_clock::time_point start;
+        /// @brief End of the SRV lookup, right after start if the address has a port
+        std::chrono::steady_clock::time_point srv_lookup_end;
+        /// @brief End of the address resolution
+        std::chrono::steady_clock::time_point resolve_end;
+        /// @brief Connection established
+        std::chrono::steady_clock::time_point connect_end;
+    };
+
     class TCP_Com
     {
     public:
+        /// @param address Server address, with or without a port
+        /// @param callback Function called with each complete incoming frame,
+        /// returns false to stop reading the socket until ResumeReading is called
+        /// @param read_size_ Maximum number of bytes to read from the socket at once
         TCP_Com(const std::string &address,
-            std::function<void(const std::vector<unsigned char>&)> callback);
+            std::function<bool(std::vector<unsigned char>&&)> callback,
+            const size_t read_size_ = 16384);
         ~TCP_Com();
 
         void close();
 
-        void SendPacket(const std::vector<unsigned char> &msg);
+        /// @brief Queue a frame to be sent. The data are copied in the
+        /// output buffer, so no allocation is needed once it's large enough
+        /// @param frame Pointer to the frame, starting with its VarInt length
+        /// @param size Size of the frame, length prefix included
+        void SendFrame(const unsigned char* frame, const size_t size);
+
+        /// @brief Restart reading the socket after the callback asked to
+        /// stop. Frames already received are delivered first
+        void ResumeReading();
+
+        /// @brief Set the time to wait before actually sending data after
+        /// the first packet is queued. All the packets sent in this window
+        /// are grouped in one single write. 0 to send as soon as possible
+        /// (packets queued during a write are still grouped)
+        /// @param delay The flush window
+        void SetFlushDelay(const std::chrono::microseconds delay);
 #ifdef USE_ENCRYPTION
         void SetEncrypter(const std::shared_ptr<AESEncrypter> encrypter_);
 #endif
@@ -27,13 +64,21 @@ namespace Botcraft
         const std::string& GetIp() const;
         const unsigned short GetPort() const;
 
+        const TCP_ComTimings GetTimings() const;
+
     private:
 
         void handle_connect(const asio::error_code& error);
 
+        void start_read();
+
         void handle_read(const asio::error_code& error, std::size_t bytes_transferred);
 
-        void do_write(const std::vector<unsigned char> &msg);
+        /// @brief Deliver the complete frames in input_msg and read
+        /// more data, unless the callback asked to pause
+        void process_input();
+
+        void do_write();
 
         void handle_write(const asio::error_code& error);
 
@@ -41,24 +86,59 @@ namespace Botcraft
 
         void SetIPAndPortFromAddress(const std::string& address);
 
+        // Keep track of the async operations/handlers still referencing
+        // this, so we can safely be destroyed when using a shared io_service
+        void StartOperation();
+        void EndOperation();
+
 
     private:
+        // nullptr if attached to the shared IOContextPool
+        std::unique_ptr<asio::io_service> owned_io_service;
         // io_service must be declared before socket
-        asio::io_service io_service;
+        asio::io_service& io_service;
         asio::ip::tcp::socket socket;
 
+        // Only used if we have our own io_service
         std::thread thread_com;
 
-        std::array<unsigned char, 512> read_msg;
-        std::vector<unsigned char> input_msg;
-        std::deque<std::vector<unsigned char> > output_msg;
+        std::atomic<int> pending_operations;
+        std::mutex mutex_pending;
+        std::condition_variable pending_condition;
 
-        std::function<void(const std::vector<unsigned char>&)> NewPacketCallback;
+        // Raw data received from the socket, the bytes between
+        // input_start and input_end are not processed yet. Socket
+        // reads are done directly after input_end
+        std::vector<unsigned char> input_msg;
+        size_t input_start;
+        size_t input_end;
+        size_t read_size;
+        // Set when the callback asked to stop reading, the frames not
+        // delivered yet stay in input_msg and no read is in progress
+        bool read_paused;
+        // Set if ResumeReading is called before reading is actually paused
+        bool resume_requested;
+        std::mutex mutex_read;
+        // Frames waiting to be sent, one after the other
+        std::vector<unsigned char> output_data;
+        // Frames currently being sent, only used by the io_service thread.
+        // Swapped with output_data so both buffers capacities are kept
+        std::vector<unsigned char> writing_data;
+        // True if a write is in progress or will be started soon
+        bool write_scheduled;
+        // Set by any thread with SetFlushDelay, read when a frame is sent
+        std::atomic<std::chrono::microseconds> flush_delay;
+        asio::steady_timer flush_timer;
+
+        std::function<bool(std::vector<unsigned char>&&)> NewPacketCallback;
         std::mutex mutex_output;
 
         std::string ip;
         unsigned short port;
 
+        mutable std::mutex mutex_timings;
+        TCP_ComTimings timings;
+
 #ifdef USE_ENCRYPTION
         std::shared_ptr<AESEncrypter> encrypter;
 #endif
@@ -26,8 +26,10 @@ namespace Botcraft
 
             void Reset(const int height_, const int width_);
 
-            // Load data 
-            void LoadData(const std::vector<std::pair<std::string, std::string> > &textures_path);
+            // Load data. If cache_path is not empty, the packed atlas is
+            // read from this file when the textures didn't change since it
+            // was written, and the file is updated otherwise
+            void LoadData(const std::vector<std::pair<std::string, std::string> > &textures_path, const std::string& cache_path = "");
 
             const int GetWidth() const;
             const int GetHeight() const;
@@ -39,6 +41,10 @@ namespace Botcraft
         private:
             unsigned char* Get(const int row = 0, const int col = 0, const int depth = 0);
 
+            // Read the atlas from a cache file, return false if it doesn't exist or doesn't match key
+            const bool LoadCache(const std::string& path, const unsigned long long key);
+            void SaveCache(const std::string& path, const unsigned long long key) const;
+
         private:
 
             std::vector<unsigned char> data;
@@ -2,8 +2,10 @@
 
 #include <deque>
 #include <mutex>
+#include <vector>
 
 #include "botcraft/Renderer/Face.hpp"
+#include "botcraft/Renderer/FaceTemplates.hpp"
 
 namespace Botcraft
 {
@@ -24,21 +26,32 @@ namespace Botcraft
             ~BlockRenderable();
 
             void Update();
-            void ClearFaces();
             const unsigned int GetNumFace() const;
+            // Size of data_VBO in bytes
+            const size_t GetGPUMemory() const;
             void Render() const;
 
+            // Set the per instance attributes of the faces in the
+            // buffer bound to GL_ARRAY_BUFFER, starting at first_face
+            static void SetFacesAttribPointers(const size_t first_face);
+            // Same as SetFacesAttribPointers, for PackedFace buffers
+            static void SetPackedFacesAttribPointers(const size_t first_face);
+
         protected:
+            // Create a buffer of face_number PackedFace
             void GenerateOpenGLBuffer();
             void DeleteOpenGLBuffer();
+            // Send faces to data_VBO. The buffer is only reallocated
+            // if it's too small, else it's updated in place
+            void UploadFaces(const std::vector<PackedFace>& data);
 
         protected:
             unsigned int faces_VAO;
             unsigned int faces_VBO;
             unsigned int data_VBO;
             unsigned int face_number;
-
-            std::deque<Face> faces;
+            // Number of faces data_VBO can hold
+            unsigned int buffer_capacity;
 
             BufferStatus buffer_status;
 
@@ -2,19 +2,52 @@
 
 #include "botcraft/Renderer/BlockRenderable.hpp"
 
+#include <array>
+#include <deque>
+#include <utility>
+
 namespace Botcraft
 {
     namespace Renderer
     {
+        class FaceBufferArena;
+
         class Chunk : public BlockRenderable
         {
         public:
             Chunk();
             ~Chunk();
 
-            void Update();
-            void AddFace(const Face &f, const std::array<unsigned int, 2>& texture_multipliers,
+            // Send the faces to their range in arena if they changed,
+            // the range is reallocated if it's too small
+            void Update(FaceBufferArena& arena);
+            // Add a face, template_index must be the index of f in the FaceTemplates
+            void AddFace(const Face &f, const unsigned int template_index, const std::array<unsigned int, 2>& texture_multipliers,
                 const float offset_x, const float offset_y, const float offset_z);
+            void ClearFaces();
+            // Get the min and max y of the faces, min > max if there is no face.
+            // Not thread safe, the faces must not be modified at the same time
+            const std::pair<float, float> GetVerticalBounds() const;
+            // Get the (offset, number of faces) of this chunk in the arena
+            const std::pair<unsigned int, unsigned int> GetArenaRange() const;
+
+        protected:
+            struct ChunkFace
+            {
+                PackedFace packed;
+                // World position of the face center, used to sort transparent faces
+                std::array<float, 3> center;
+            };
+            std::deque<ChunkFace> faces;
+
+            // Copy the GPU part of faces, mutex_faces must be locked
+            const std::vector<PackedFace> GetPackedFaces() const;
+
+            unsigned int arena_offset;
+            // Number of faces reserved in the arena
+            unsigned int arena_capacity;
+            float min_y;
+            float max_y;
         };
     } // Renderer
 } // Botcraft
\ No newline at end of file
@@ -4,22 +4,38 @@
 
 #include "botcraft/Game/Vector3.hpp"
 
+#include <utility>
+
 namespace Botcraft
 {
     namespace Renderer
     {
+        class FaceBufferArena;
+
         class Entity : public BlockRenderable
         {
         public:
             Entity(const std::vector<Face>& faces_);
             ~Entity();
 
-            void Update();
+            // Send the faces to their range in arena if they changed,
+            // the range is reallocated if it's too small
+            void Update(FaceBufferArena& arena);
             void UpdateFaces(const std::vector<Face>& faces_);
+            void ClearFaces();
 
             /// @brief Get an approximate position for this model
             /// @return The center of the first face of this entity
             Vector3<float> GetApproxPos();
+
+            // Get the (offset, number of faces) of this entity in the arena
+            const std::pair<unsigned int, unsigned int> GetArenaRange() const;
+
+        protected:
+            std::deque<Face> faces;
+            unsigned int arena_offset;
+            // Number of faces reserved in the arena
+            unsigned int arena_capacity;
         };
     } // Renderer
 } // Botcraft
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "botcraft/Renderer/Face.hpp"
+#include "botcraft/Renderer/FaceTemplates.hpp"
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        /// @brief One big GPU buffer shared by all the opaque chunk faces.
+        /// Chunks get a range of it and update it in place, so there is
+        /// no per chunk buffer allocation and contiguous visible ranges
+        /// are rendered with a single draw call. All the functions must
+        /// be called from the OpenGL thread. The buffer holds either Face
+        /// or PackedFace, never both
+        class FaceBufferArena
+        {
+        public:
+            /// @param initial_capacity_ Number of faces the buffer can initially hold
+            /// @param packed_faces_ If true, the buffer holds PackedFace instead of Face
+            FaceBufferArena(const unsigned int initial_capacity_, const bool packed_faces_);
+            ~FaceBufferArena();
+
+            /// @brief Create the OpenGL buffers
+            void InitGL();
+
+            /// @brief Get a range of the buffer, the buffer grows if it's full
+            /// @param size Number of faces of the range
+            /// @return Offset of the range, in faces
+            const unsigned int Allocate(const unsigned int size);
+
+            /// @brief Give back a range obtained with Allocate
+            /// @param offset Offset of the range, in faces
+            /// @param size Number of faces of the range
+            void Free(const unsigned int offset, const unsigned int size);
+
+            /// @brief Write faces in the buffer, it must hold Face
+            /// @param offset Offset of the first face, in faces
+            /// @param faces The data to write, must fit in an allocated range
+            void Upload(const unsigned int offset, const std::vector<Face>& faces);
+
+            /// @brief Write faces in the buffer, it must hold PackedFace
+            /// @param offset Offset of the first face, in faces
+            /// @param faces The data to write, must fit in an allocated range
+            void Upload(const unsigned int offset, const std::vector<PackedFace>& faces);
+
+            /// @brief Render multiple ranges of faces. Adjacent ranges are
+            /// rendered with the same draw call
+            /// @param ranges (offset, number of faces) of each range to render
+            /// @return The number of draw calls
+            const int Render(std::vector<std::pair<unsigned int, unsigned int> >& ranges) const;
+
+            /// @brief Get the size of the GPU buffer, used or not
+            /// @return The size in bytes
+            const size_t GetGPUMemory() const;
+
+        private:
+            // Resize the buffer to hold at least new_capacity faces, keeping its content
+            void Grow(const unsigned int new_capacity);
+
+            void UploadData(const unsigned int offset, const void* data, const size_t num_faces);
+
+        private:
+            unsigned int faces_VAO;
+            unsigned int faces_VBO;
+            unsigned int data_VBO;
+
+            bool packed_faces;
+            // Size of one face in the buffer, in bytes
+            size_t face_size;
+
+            // Number of faces the buffer can hold
+            unsigned int capacity;
+            // Unused ranges, offset --> size in faces
+            std::map<unsigned int, unsigned int> free_ranges;
+        };
+    } // Renderer
+} // Botcraft
\ No newline at end of file
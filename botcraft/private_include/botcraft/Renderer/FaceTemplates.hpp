@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "botcraft/Renderer/Face.hpp"
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        /// @brief GPU data of one chunk face, 20 bytes instead of the 104 of Face.
+        /// Everything that doesn't depend on the face position (model matrix without
+        /// the block offset, texture coordinates and data) is stored once per
+        /// different model face in FaceTemplates, and read back by the vertex shader
+        struct PackedFace
+        {
+            /// @brief Position of the face center, in half blocks. Only the lowest 16 bits are
+            /// kept, the shader gets the full value back from the camera position
+            std::array<unsigned short, 3> position;
+            unsigned short padding;
+            /// @brief Index of the face in FaceTemplates
+            unsigned int template_index;
+            std::array<unsigned int, 2> texture_multipliers;
+        };
+        static_assert(sizeof(PackedFace) == 20, "PackedFace must match the vertex attributes layout");
+
+        /// @brief Table of all the different model faces used by the chunks, stored
+        /// in a texture buffer. Model faces are never removed, the table only grows
+        /// when new blocks or new merged face sizes are displayed
+        class FaceTemplates
+        {
+        public:
+            /// @brief Number of RGBA32F texels of one template: the three first rows
+            /// of the model matrix, the texture coordinates, the overlay texture
+            /// coordinates and the texture data
+            static constexpr int texels_per_template = 6;
+
+            FaceTemplates();
+            ~FaceTemplates();
+
+            /// @brief Get the index of a face, added to the table if it's new. Thread safe
+            /// @param face The face, without the block offset
+            /// @return The index to use in PackedFace
+            const unsigned int GetIndex(const Face& face);
+
+            /// @brief Create the OpenGL buffer
+            void InitGL();
+
+            /// @brief Send the templates added since the last call to the GPU. Must be
+            /// called from the OpenGL thread before rendering faces using them
+            void UpdateGL();
+
+            /// @brief Bind the texture buffer
+            /// @param texture_unit Texture unit to bind to, other than the atlas one
+            void BindGL(const unsigned int texture_unit) const;
+
+            /// @brief Get the size of the GPU buffer, must be called from the OpenGL thread
+            /// @return The size in bytes
+            const size_t GetGPUMemory() const;
+
+        private:
+            using TemplateData = std::array<float, 4 * texels_per_template>;
+
+            struct TemplateDataHasher
+            {
+                size_t operator()(const TemplateData& t) const;
+            };
+
+        private:
+            std::mutex templates_mutex;
+            std::unordered_map<TemplateData, unsigned int, TemplateDataHasher> indices;
+            // All the templates, one after the other
+            std::vector<float> data;
+            // Number of floats already on the GPU
+            size_t uploaded_size;
+
+            unsigned int templates_buffer;
+            unsigned int templates_texture;
+            // Number of floats the GPU buffer can hold
+            size_t buffer_capacity;
+        };
+    } // Renderer
+} // Botcraft
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        /// @brief Save screenshots without stalling the rendering loop. The
+        /// framebuffer is copied into one of two pixel buffer objects, mapped
+        /// a few frames later when the GPU is done with it, and the images are
+        /// encoded on a worker thread. All the functions but the constructor
+        /// and the destructor must be called from the OpenGL thread
+        class ScreenshotWriter
+        {
+        public:
+            ScreenshotWriter();
+            /// @brief Wait for the images already read to be written
+            ~ScreenshotWriter();
+
+            /// @brief Create the pixel buffer objects
+            void InitGL();
+
+            /// @brief Finish the pending reads and delete the pixel buffer objects
+            void ClearGL();
+
+            /// @brief Start copying the current framebuffer, without waiting for it
+            /// @param path Path of the PNG image to write
+            /// @param width Framebuffer width
+            /// @param height Framebuffer height
+            /// @return False if both buffers are still in use, try again next frame
+            const bool Capture(const std::string& path, const int width, const int height);
+
+            /// @brief Send the finished copies to the encoding thread, should be called once per frame
+            /// @param wait If true, wait for the GPU instead of leaving the unfinished copies for the next call
+            void Update(const bool wait = false);
+
+        private:
+            // Encode and write the images, run by writing_thread
+            void WriteImages();
+
+        private:
+            struct PendingRead
+            {
+                std::string path;
+                int width = 0;
+                int height = 0;
+                // Signaled when the copy in the buffer is done, nullptr if the buffer is free
+                GLsync fence = nullptr;
+            };
+
+            struct Image
+            {
+                std::string path;
+                int width;
+                int height;
+                std::vector<unsigned char> pixels;
+            };
+
+            std::array<unsigned int, 2> pbos;
+            std::array<PendingRead, 2> pending_reads;
+            // Buffer used by the next Capture, also the oldest pending one
+            size_t next_pbo;
+
+            std::deque<Image> images_to_write;
+            std::mutex images_mutex;
+            std::condition_variable images_condition;
+            bool running;
+            std::thread writing_thread;
+        };
+    } // Renderer
+} // Botcraft
@@ -17,7 +17,9 @@ namespace Botcraft
         {
         public:
             // constructor reads and builds the shader
-            Shader(const std::string &vertexPath = "", const std::string &fragmentPath = "");
+            // if vertexPath is empty, the default vertex shader
+            // for either Face or PackedFace buffers is used
+            Shader(const std::string &vertexPath = "", const std::string &fragmentPath = "", const bool packed_faces = false);
             ~Shader();
 
             const unsigned int Program();
@@ -33,6 +35,7 @@ namespace Botcraft
             void SetMat4xN(const std::string &name, const std::vector<glm::mat4> &value) const;
             void SetMat3xN(const std::string &name, const std::vector<glm::mat3> &value) const;
             void SetVec3(const std::string &name, const glm::vec3 &value) const;
+            void SetIVec3(const std::string &name, const glm::ivec3 &value) const;
             void SetVec2(const std::string &name, const glm::vec2 &value) const;
 
         private:
@@ -40,6 +43,7 @@ namespace Botcraft
             void CheckCompileErrors(const unsigned int shader, const std::string &type);
 
             static const std::string default_vertex_shader;
+            static const std::string default_packed_vertex_shader;
             static const std::string default_fragment_shader;
         };
     } // Renderer
@@ -14,13 +14,20 @@ namespace Botcraft
             TransparentChunk();
             ~TransparentChunk();
 
-            void SetDisplayStatus(const BufferStatus s);
+            void AddFace(const Face& f, const unsigned int template_index, const std::array<unsigned int, 2>& texture_multipliers,
+                const float offset_x, const float offset_y, const float offset_z);
+            void ClearFaces();
+
+            // Sort the faces from far to near cam_pos. Doesn't use OpenGL so
+            // it can be called from any thread, the sorted faces are sent
+            // to the GPU on the next Update
             void Sort(const glm::vec3 &cam_pos);
             void Update();
 
         protected:
-            std::vector<Face> display_faces_positions;
-            BufferStatus display_buffer_status;
+            // True if faces have been added or removed since the last sort,
+            // if not the previous order is almost sorted already
+            bool faces_changed;
         };
     } // Renderer
 } // Botcraft
\ No newline at end of file
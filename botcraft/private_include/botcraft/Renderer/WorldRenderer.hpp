@@ -1,10 +1,14 @@
 #pragma once
 
+#include "botcraft/Game/Enums.hpp"
 #include "botcraft/Game/Vector3.hpp"
 
 #include <glm/glm.hpp>
 
 #include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <vector>
@@ -24,6 +28,9 @@ namespace Botcraft
         class TransparentChunk;
         class Camera;
         class Atlas;
+        class FaceBufferArena;
+        class FaceTemplates;
+        class Shader;
 
         // Intersection test for frustum culling
         enum class FrustumResult
@@ -33,6 +40,29 @@ namespace Botcraft
             Inside         // Box is inside the frustum
         };
 
+        /// @brief The faces of a chunk, built without touching the renderer
+        /// data so multiple chunks can be meshed concurrently
+        struct ChunkMesh
+        {
+            struct MeshFace
+            {
+                // Points to the blockstate model face
+                const Face* face;
+                std::array<unsigned int, 2> texture_multipliers;
+                // Min block of the face
+                Position pos;
+                // Number of blocks covered along each axis, more than
+                // one for faces merged with their coplanar neighbours
+                Position size = Position(1, 1, 1);
+            };
+            std::vector<MeshFace> faces;
+            // True for the simplified meshes of far chunks
+            bool lod = false;
+            // (rendering section index, connectivity) of the meshed sections,
+            // see WorldRenderer::section_visibility. Empty for LOD meshes
+            std::vector<std::pair<int, unsigned long long> > visibility;
+        };
+
         class WorldRenderer
         {
         public:
@@ -42,38 +72,152 @@ namespace Botcraft
 
             std::shared_ptr<Camera> GetCamera();
 
-            void InitGL();
+            /// @brief Create the OpenGL objects of this renderer
+            /// @param atlas_texture_ Atlas texture, owned by the caller as it
+            /// can be shared with other renderers (see RenderingContextGroup)
+            void InitGL(const unsigned int atlas_texture_);
             void UpdateViewMatrix();
+            /// @brief Set the camera projection matrix, used for culling and
+            /// by the shaders. Must be called from the OpenGL thread
             void SetCameraProjection(const glm::mat4& proj);
             void UpdateFaces();
-            void UpdateChunk(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk);
+            /// @brief Update the faces of a chunk
+            /// @param x_ X chunk coordinate
+            /// @param z_ Z chunk coordinate
+            /// @param chunk The chunk to render, nullptr to remove it
+            /// @param neighbour_chunks North, West, East and South neighbours (nullptr if not loaded)
+            void UpdateChunk(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+                const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks);
+            /// @brief Compute the faces of a chunk. Thread safe, the renderer is not modified
+            /// @param x_ X chunk coordinate
+            /// @param z_ Z chunk coordinate
+            /// @param chunk The chunk to mesh
+            /// @param neighbour_chunks North, West, East and South neighbours (nullptr if not loaded)
+            /// @return The faces to render
+            const ChunkMesh MeshChunk(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+                const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks) const;
+            /// @brief Compute the faces of one rendering section of a chunk. Thread safe, the renderer is not modified
+            /// @param x_ X chunk coordinate
+            /// @param y_ Rendering section index, blocks from y_ * section_height to (y_ + 1) * section_height - 1
+            /// @param z_ Z chunk coordinate
+            /// @param chunk The chunk to mesh
+            /// @param neighbour_chunks North, West, East and South neighbours (nullptr if not loaded)
+            /// @return The faces to render
+            const ChunkMesh MeshSection(const int x_, const int y_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+                const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks) const;
+            /// @brief Compute a simplified mesh of a chunk, for chunks far from the camera. Only
+            /// the top surface and the sides of its height differences are kept. Thread safe,
+            /// the renderer is not modified
+            /// @param x_ X chunk coordinate
+            /// @param z_ Z chunk coordinate
+            /// @param chunk The chunk to mesh
+            /// @param neighbour_chunks North, West, East and South neighbours (nullptr if not loaded)
+            /// @return The faces to render
+            const ChunkMesh MeshChunkLod(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+                const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks) const;
+            /// @brief Replace the faces of a chunk, they are sent to the GPU on the next UpdateFaces
+            /// @param x_ X chunk coordinate
+            /// @param z_ Z chunk coordinate
+            /// @param mesh The new faces, nullptr to remove the chunk
+            void SetChunkMesh(const int x_, const int z_, const ChunkMesh* mesh);
+            /// @brief Replace the faces of one rendering section, only this section buffer is sent again to the GPU
+            /// @param x_ X chunk coordinate
+            /// @param y_ Rendering section index
+            /// @param z_ Z chunk coordinate
+            /// @param mesh The new faces, all in this section, nullptr to clear it
+            void SetSectionMesh(const int x_, const int y_, const int z_, const ChunkMesh* mesh);
+            /// @brief Enable or disable face merging in the next meshed chunks
+            /// @param b If true, coplanar opaque block faces with the same texture
+            /// are merged into bigger ones, with the texture repeated over them
+            void SetGreedyMeshing(const bool b);
+            /// @brief Set the distance past which chunks are meshed with MeshChunkLod
+            /// @param d Distance between the camera and the chunk center, in blocks, 0 to disable LOD
+            void SetLodDistance(const float d);
+            /// @brief Enable or disable cave culling (enabled by default)
+            /// @param b If true, sections hidden behind opaque blocks from the
+            /// camera section are not rendered, even if they are in the frustum
+            void SetCaveCulling(const bool b);
+            /// @brief Check if a chunk should be meshed with MeshChunkLod from the current camera position
+            const bool ShouldUseLod(const int x_, const int z_);
+            /// @brief Check if the current mesh of a chunk is a LOD mesh
+            const bool IsChunkLod(const int x_, const int z_);
+            /// @brief Get the chunks whose current mesh doesn't match ShouldUseLod anymore
+            /// @return (chunk x, 0, chunk z) of each chunk to mesh again
+            const std::vector<Position> GetChunksWithOutdatedLod();
+            /// @brief Sort the transparent faces from far to near the camera. Doesn't use
+            /// OpenGL, the sorted faces are sent to the GPU on the next UpdateFaces
+            void SortTransparentFaces();
+            /// @brief Check if the camera moved to another block since the last SortTransparentFaces
+            const bool GetTransparentFacesShouldBeSorted() const;
+            /// @brief Get the distance between the camera and the center of a chunk column
+            const float GetChunkDistanceToCamera(const int x_, const int z_);
+            /// @brief Get the meshing priority of a chunk column: its distance to the
+            /// camera, increased if the column is outside the view frustum
+            /// @return The priority, lower should be meshed first
+            const float GetChunkMeshPriority(const int x_, const int z_);
+            /// @brief Same as GetChunkMeshPriority for multiple columns, with a single camera lock
+            /// @param chunks (chunk x, any, chunk z) of each column
+            /// @return The priority of each column, lower should be meshed first
+            const std::vector<float> GetChunksMeshPriority(const std::vector<Position>& chunks);
             void UpdateEntity(const int id, const std::vector<Face>& faces);
             void UseAtlasTextureGL();
             void ClearFaces();
 
-            // Set camera position and orientation
-            void SetPosOrientation(const double x_, const double y_, const double z_, const float yaw_, const float pitch_);
+            // Set camera position and orientation, returns false if they didn't change
+            const bool SetPosOrientation(const double x_, const double y_, const double z_, const float yaw_, const float pitch_);
 
             // Render all the faces (chunks + partially transparent chunks + entities)
+            // Chunks are rendered with packed_faces_shader, entities with faces_shader
             // Optional pointer can be passed to get statistics
-            void RenderFaces(int* num_chunks_ = nullptr, int* num_rendered_chunks_ = nullptr,
+            void RenderFaces(Shader& packed_faces_shader, Shader& faces_shader, int* num_chunks_ = nullptr, int* num_rendered_chunks_ = nullptr,
                 int* num_entities_ = nullptr, int* num_rendered_entities_ = nullptr,
-                int* num_faces_ = nullptr, int* num_rendered_faces_ = nullptr);
+                int* num_faces_ = nullptr, int* num_rendered_faces_ = nullptr, int* num_draw_calls_ = nullptr);
+
+            /// @brief Get the size of the face buffers allocated on the GPU,
+            /// must be called from the OpenGL thread
+            /// @return The size in bytes
+            const size_t GetGPUMemory();
 
         private:
-            // Add a face to the rendering data
+            // Add a face to the rendering data, chunks_mutex and
+            // transparent_chunks_mutex must be locked by the caller.
             // It will not be rendered until the next frame with
             // blocks_faces_should_be_updated set to true
-            void AddFace(const int x_, const int y_, const int z_, const Face& face_,
-                const std::vector<std::string>& texture_identifiers_,
-                const std::vector<unsigned int>& texture_multipliers_);
+            void AddFace(const ChunkMesh::MeshFace& face_);
+
+            // Compute the faces of the blocks of a chunk with min_y <= y < max_y
+            const ChunkMesh MeshBlocks(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+                const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks, const int min_y, const int max_y) const;
+
+            // Add the faces with the given orientation of a block to a mesh
+            void AppendBlockFaces(ChunkMesh& mesh, const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+                const Position& pos, const Orientation orientation) const;
+
+            // Merge the adjacent coplanar full block faces with the
+            // same texture and tint into rectangles
+            void MergeFaces(ChunkMesh& mesh) const;
+
+            // Update the far to near order of the sections if the camera
+            // changed block or sections were added or removed
+            // Must be called with chunks_mutex and transparent_chunks_mutex locked
+            void UpdateRenderOrder();
 
             // Returns the color modifier (for redstone/leaves/water etc...)
-            const std::vector<unsigned int> GetColorModifier(const int y, const Biome* biome, const Blockstate* blockstate, const std::vector<bool>& use_tintindex) const;
+            // Only the two first tint indices are used, the others are ignored
+            const std::array<unsigned int, 2> GetColorModifier(const int y, const Biome* biome, const Blockstate* blockstate, const std::vector<bool>& use_tintindex) const;
 
             // Returns the distance from the center of the chunk to the camera
             const float DistanceToCamera(const Position& chunk) const;
 
+            // Returns the meshing priority of a chunk column, m_mutex_camera must be locked by the caller
+            const float MeshPriority(const int x_, const int z_) const;
+
+            // Hide the sections of render_order in section_visible that can't be
+            // seen from the camera section through non opaque blocks, walking
+            // the sections graph away from the camera. chunks_mutex must be
+            // locked by the caller
+            void CullHiddenSections(const std::array<glm::vec4, 6>& frustum_planes, const glm::vec3& camera_pos);
+
 
         private:
             unsigned int view_uniform_buffer;
@@ -83,18 +227,64 @@ namespace Botcraft
             // sections
             unsigned int section_height;
 
+            // Buffer holding the faces of all the opaque rendering sections
+            std::unique_ptr<FaceBufferArena> face_arena;
+            // Data shared by all the instances of each model face
+            // used by the opaque and transparent sections
+            std::unique_ptr<FaceTemplates> face_templates;
+            // Rendering sections, indexed by (chunk x, y / section_height, chunk z)
             std::unordered_map<Position, std::shared_ptr<Chunk> > chunks;
             std::mutex chunks_mutex;
             std::unordered_map<Position, std::shared_ptr<TransparentChunk> > transparent_chunks;
             std::mutex transparent_chunks_mutex;
             bool blocks_faces_should_be_updated;
+            std::atomic<bool> greedy_meshing;
+            // Connectivity of each rendering section faces through non opaque
+            // blocks, bit 6 * a + b is set if faces a and b are connected. Faces
+            // are ordered Y-, Z-, X-, X+, Z+, Y+. Sections without value (LOD or
+            // not meshed) are fully connected. Protected by chunks_mutex
+            std::unordered_map<Position, unsigned long long> section_visibility;
+            std::atomic<bool> cave_culling;
+            std::atomic<float> lod_distance;
+            // Chunks currently rendered with a LOD mesh, as (x, 0, z)
+            std::unordered_set<Position> lod_chunks;
+            std::mutex lod_chunks_mutex;
 
+            // Buffer holding the faces of all the entities, so
+            // they can be rendered with a few draw calls
+            std::unique_ptr<FaceBufferArena> entity_arena;
             std::unordered_map<int, std::shared_ptr<Entity> > entities;
             std::mutex entities_mutex;
             bool entities_faces_should_be_updated;
 
             std::shared_ptr<Camera> camera;
             std::mutex m_mutex_camera;
+            // Block of the camera when its position was last set
+            Position camera_block;
+            std::atomic<bool> transparent_faces_should_be_sorted;
+
+            struct RenderSection
+            {
+                Position pos;
+                std::shared_ptr<Chunk> chunk;
+                std::shared_ptr<TransparentChunk> transparent_chunk;
+            };
+            // All the rendering sections, sorted from far to near
+            // the camera when it was in render_order_camera_block.
+            // Only used by the rendering thread
+            std::vector<RenderSection> render_order;
+            Position render_order_camera_block;
+            std::atomic<bool> render_order_should_be_updated;
+            // Bounding boxes of render_order sections (min x, max x, min y, max y,
+            // min z, max z), one array per coordinate to vectorize the frustum tests
+            std::array<std::vector<float>, 6> section_bounds;
+            std::vector<unsigned char> section_visible;
+            // Sections reached by the last cave culling pass, over the
+            // bounding box of render_order, kept to avoid allocations
+            std::vector<unsigned char> section_reached;
+            // Visible opaque faces ranges, kept to avoid allocations each frame
+            std::vector<std::pair<unsigned int, unsigned int> > arena_ranges;
+            std::vector<std::pair<unsigned int, unsigned int> > entity_ranges;
 
             unsigned int atlas_texture;
         };
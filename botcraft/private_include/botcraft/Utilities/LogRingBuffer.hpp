@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace Botcraft
+{
+    /// @brief A bounded lock-free multi-producer single-consumer
+    /// queue of log messages. Each slot has a sequence number telling
+    /// if it's ready to be written (producers) or read (consumer).
+    /// Capacity must be a power of two.
+    class LogRingBuffer
+    {
+    public:
+        LogRingBuffer(const size_t capacity_) :
+            capacity(capacity_), mask(capacity_ - 1), slots(new Slot[capacity_])
+        {
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            enqueue_pos.store(0, std::memory_order_relaxed);
+            dequeue_pos = 0;
+        }
+
+        /// @brief Push a message in the queue. Can be called from any thread
+        /// @param s Message, moved into the queue on success
+        /// @return False if the queue is full
+        bool TryPush(std::string& s)
+        {
+            size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Slot& slot = slots[pos & mask];
+                const size_t seq = slot.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0)
+                {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        slot.message = std::move(s);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                // Slot not yet consumed, queue is full
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// @brief Pop a message from the queue. Must only be called by the consumer thread
+        /// @param s Output message
+        /// @return False if the queue is empty
+        bool TryPop(std::string& s)
+        {
+            Slot& slot = slots[dequeue_pos & mask];
+            const size_t seq = slot.sequence.load(std::memory_order_acquire);
+            if (seq != dequeue_pos + 1)
+            {
+                return false;
+            }
+            s = std::move(slot.message);
+            slot.message.clear();
+            slot.sequence.store(dequeue_pos + capacity, std::memory_order_release);
+            dequeue_pos += 1;
+            return true;
+        }
+
+        /// @brief Check if there is a message to pop. Must only be called by the consumer thread
+        /// @return True if the queue is empty
+        bool Empty() const
+        {
+            return slots[dequeue_pos & mask].sequence.load(std::memory_order_acquire) != dequeue_pos + 1;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            std::string message;
+        };
+
+        const size_t capacity;
+        const size_t mask;
+        std::unique_ptr<Slot[]> slots;
+
+        // Keep producer and consumer positions on different cache lines
+        alignas(64) std::atomic<size_t> enqueue_pos;
+        alignas(64) size_t dequeue_pos;
+    };
+} // Botcraft
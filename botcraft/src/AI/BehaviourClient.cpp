@@ -1,11 +1,19 @@
 #include "botcraft/AI/BehaviourClient.hpp"
+#include "botcraft/Game/ClientMetrics.hpp"
+
+#include <algorithm>
 
 namespace Botcraft
 {
     BehaviourClient::BehaviourClient(const bool use_renderer_) :
         ManagersClient(use_renderer_)
     {
-
+        waiting_event = false;
+        waiting_event_type = EventType::NUM_EVENT_TYPES;
+        waiting_event_count = 0;
+        parallel_child = nullptr;
+        profiled_node = no_profiled_node;
+        high_priority = false;
     }
 
     BehaviourClient::~BehaviourClient()
@@ -17,4 +25,147 @@ namespace Botcraft
     {
         return blackboard;
     }
+
+    const bool BehaviourClient::WaitFor(const EventType type, const std::function<bool()>& condition, const int timeout_ms)
+    {
+        // The timeout is a timer, so nothing has to
+        // check the clock while the behaviour is waiting
+        std::shared_ptr<std::atomic<bool> > timed_out = std::make_shared<std::atomic<bool> >(timeout_ms <= 0);
+        const TimerWheel::TimerId timer_id = timeout_ms <= 0 ? 0 : timers.ScheduleIn(timeout_ms, [timed_out]() { *timed_out = true; });
+        while (true)
+        {
+            // Get the counter before checking the condition so an event
+            // happening in between isn't missed
+            const unsigned long long count = GetEventCount(type);
+            if (condition())
+            {
+                timers.Cancel(timer_id);
+                return true;
+            }
+            if (*timed_out)
+            {
+                return false;
+            }
+
+            // In a Parallel child, the other children must keep running
+            if (parallel_child == nullptr)
+            {
+                waiting_event_type = type;
+                waiting_event_count = count;
+                waiting_event_timed_out = timed_out;
+                waiting_event.store(true, std::memory_order_release);
+            }
+            try
+            {
+                Yield();
+            }
+            catch (...)
+            {
+                waiting_event = false;
+                timers.Cancel(timer_id);
+                throw;
+            }
+            waiting_event = false;
+        }
+    }
+
+    const bool BehaviourClient::WaitFor(const EventType type, const int timeout_ms)
+    {
+        const unsigned long long count = GetEventCount(type);
+        return WaitFor(type, [this, type, count]() { return GetEventCount(type) != count; }, timeout_ms);
+    }
+
+    void BehaviourClient::Wait(const int duration_ms)
+    {
+        // No event of this type is ever notified, so only the timer can wake the behaviour up
+        WaitFor(EventType::NUM_EVENT_TYPES, []() { return false; }, duration_ms);
+    }
+
+    TimerWheel& BehaviourClient::GetTimers()
+    {
+        return timers;
+    }
+
+    ParallelChild* BehaviourClient::GetParallelChild() const
+    {
+        return parallel_child;
+    }
+
+    void BehaviourClient::SetParallelChild(ParallelChild* child)
+    {
+        parallel_child = child;
+    }
+
+    const size_t BehaviourClient::GetProfiledNode() const
+    {
+        return profiled_node;
+    }
+
+    void BehaviourClient::SetProfiledNode(const size_t index)
+    {
+        profiled_node = index;
+    }
+
+    void BehaviourClient::SetHighPriority(const bool b)
+    {
+        high_priority = b;
+    }
+
+    const bool BehaviourClient::GetHighPriority() const
+    {
+        return high_priority;
+    }
+
+    const bool BehaviourClient::IsWaitingForEvent() const
+    {
+        return waiting_event.load(std::memory_order_acquire) &&
+            GetEventCount(waiting_event_type) == waiting_event_count &&
+            !*waiting_event_timed_out;
+    }
+
+    void BehaviourClient::AdvanceTimers()
+    {
+        timers.Advance(VirtualClock::now());
+    }
+
+    const BehaviourStats BehaviourClient::GetBehaviourStats() const
+    {
+        BehaviourStats stats;
+        {
+            std::lock_guard<std::mutex> lock(behaviour_stats_mutex);
+            stats = behaviour_stats;
+        }
+        stats.num_timers = timers.GetNumTimers();
+        return stats;
+    }
+
+    ClientMetrics BehaviourClient::GetMetrics()
+    {
+        ClientMetrics metrics = ManagersClient::GetMetrics();
+        metrics.has_behaviour = true;
+        metrics.behaviour = GetBehaviourStats();
+        return metrics;
+    }
+
+    void BehaviourClient::RecordBehaviourStep(const std::chrono::steady_clock::duration duration)
+    {
+        const double duration_ms = std::chrono::duration<double, std::milli>(duration).count();
+        std::lock_guard<std::mutex> lock(behaviour_stats_mutex);
+        behaviour_stats.num_steps += 1;
+        behaviour_stats.total_step_time_ms += duration_ms;
+        behaviour_stats.last_step_time_ms = duration_ms;
+        behaviour_stats.max_step_time_ms = std::max(behaviour_stats.max_step_time_ms, duration_ms);
+    }
+
+    void BehaviourClient::RecordBudgetOverrun()
+    {
+        std::lock_guard<std::mutex> lock(behaviour_stats_mutex);
+        behaviour_stats.num_budget_overruns += 1;
+    }
+
+    void BehaviourClient::RecordThrottledStep()
+    {
+        std::lock_guard<std::mutex> lock(behaviour_stats_mutex);
+        behaviour_stats.num_throttled_steps += 1;
+    }
 } // namespace Botcraft
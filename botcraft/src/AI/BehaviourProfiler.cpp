@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "botcraft/AI/BehaviourProfiler.hpp"
+
+namespace Botcraft
+{
+    BehaviourProfiler& BehaviourProfiler::GetInstance()
+    {
+        static BehaviourProfiler instance;
+        return instance;
+    }
+
+    const size_t BehaviourProfiler::GetNodeIndex(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(profiler_mutex);
+        auto it = indices.find(name);
+        if (it != indices.end())
+        {
+            return it->second;
+        }
+
+        const size_t index = profiles.size();
+        profiles.push_back(NodeProfile());
+        profiles.back().name = name;
+        indices[name] = index;
+        return index;
+    }
+
+    void BehaviourProfiler::Record(const size_t index, const bool success, const double duration_ms)
+    {
+        std::lock_guard<std::mutex> lock(profiler_mutex);
+        NodeProfile& profile = profiles[index];
+        profile.num_ticks += 1;
+        profile.num_success += success;
+        profile.total_ms += duration_ms;
+        profile.max_ms = std::max(profile.max_ms, duration_ms);
+    }
+
+    void BehaviourProfiler::RecordBudgetOverrun(const size_t index, const double overrun_ms)
+    {
+        std::lock_guard<std::mutex> lock(profiler_mutex);
+        NodeProfile& profile = profiles[index];
+        profile.num_budget_overruns += 1;
+        profile.total_overrun_ms += overrun_ms;
+    }
+
+    const std::vector<NodeProfile> BehaviourProfiler::GetProfiles() const
+    {
+        std::lock_guard<std::mutex> lock(profiler_mutex);
+        return profiles;
+    }
+
+    const std::string BehaviourProfiler::Dump() const
+    {
+        const std::vector<NodeProfile> current_profiles = GetProfiles();
+
+        std::stringstream output;
+        output << std::left << std::setw(32) << "Node" << std::right
+            << std::setw(10) << "Ticks" << std::setw(10) << "Success"
+            << std::setw(12) << "Total (ms)" << std::setw(12) << "Avg (ms)" << std::setw(12) << "Max (ms)"
+            << std::setw(10) << "Overruns" << std::setw(14) << "Overrun (ms)" << '\n';
+        output << std::fixed << std::setprecision(2);
+        for (size_t i = 0; i < current_profiles.size(); ++i)
+        {
+            const NodeProfile& p = current_profiles[i];
+            output << std::left << std::setw(32) << p.name << std::right
+                << std::setw(10) << p.num_ticks
+                << std::setw(9) << (p.num_ticks == 0 ? 0.0 : 100.0 * p.num_success / p.num_ticks) << '%'
+                << std::setw(12) << p.total_ms
+                << std::setw(12) << (p.num_ticks == 0 ? 0.0 : p.total_ms / p.num_ticks)
+                << std::setw(12) << p.max_ms
+                << std::setw(10) << p.num_budget_overruns
+                << std::setw(14) << p.total_overrun_ms << '\n';
+        }
+        return output.str();
+    }
+
+    void BehaviourProfiler::Reset()
+    {
+        std::lock_guard<std::mutex> lock(profiler_mutex);
+        for (size_t i = 0; i < profiles.size(); ++i)
+        {
+            const std::string name = profiles[i].name;
+            profiles[i] = NodeProfile();
+            profiles[i].name = name;
+        }
+    }
+} // Botcraft
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <chrono>
+
+#include "botcraft/AI/BehaviourScheduler.hpp"
+#include "botcraft/AI/BehaviourClient.hpp"
+#include "botcraft/AI/BehaviourProfiler.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/SleepUtilities.hpp"
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+
+namespace Botcraft
+{
+    BehaviourScheduler::BehaviourScheduler()
+    {
+        num_workers = std::max(1u, std::thread::hardware_concurrency() / 2);
+        stack_size = 256 * 1024;
+        step_budget_us = 0;
+        num_clients = 0;
+        running = false;
+    }
+
+    BehaviourScheduler::~BehaviourScheduler()
+    {
+        Stop();
+    }
+
+    BehaviourScheduler& BehaviourScheduler::GetInstance()
+    {
+        static BehaviourScheduler instance;
+        return instance;
+    }
+
+    void BehaviourScheduler::SetNumWorkers(const unsigned int n)
+    {
+        std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex);
+        if (num_clients > 0)
+        {
+            LOG_WARNING("Can't change the number of behaviour workers while clients are registered");
+            return;
+        }
+        if (n == 0)
+        {
+            LOG_WARNING("Behaviour scheduler needs at least one worker");
+            return;
+        }
+        num_workers = n;
+    }
+
+    const unsigned int BehaviourScheduler::GetNumWorkers() const
+    {
+        return num_workers;
+    }
+
+    void BehaviourScheduler::SetStackSize(const size_t size)
+    {
+        stack_size = size;
+    }
+
+    const size_t BehaviourScheduler::GetStackSize() const
+    {
+        return stack_size;
+    }
+
+    void BehaviourScheduler::SetStepBudget(const std::chrono::microseconds& budget)
+    {
+        step_budget_us = std::max(0LL, static_cast<long long int>(budget.count()));
+    }
+
+    const std::chrono::microseconds BehaviourScheduler::GetStepBudget() const
+    {
+        return std::chrono::microseconds(step_budget_us.load());
+    }
+
+    void BehaviourScheduler::Register(BehaviourClient* client)
+    {
+        std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex);
+        if (!running)
+        {
+            Start();
+        }
+
+        // Only use the workers of the caller group if there is any
+        const int group = AffinityGroups::GetCurrentGroup();
+        const bool use_group = group != -1 && std::any_of(workers.begin(), workers.end(), [group](const std::unique_ptr<Worker>& w) { return w->group == group; });
+
+        Worker* chosen = nullptr;
+        size_t chosen_size = 0;
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            std::lock_guard<std::mutex> worker_lock(workers[i]->mutex);
+            if (std::find_if(workers[i]->clients.begin(), workers[i]->clients.end(), [client](const ScheduledClient& c) { return c.client == client; }) != workers[i]->clients.end())
+            {
+                return;
+            }
+            if (use_group && workers[i]->group != group)
+            {
+                continue;
+            }
+            if (chosen == nullptr || workers[i]->clients.size() < chosen_size)
+            {
+                chosen = workers[i].get();
+                chosen_size = workers[i]->clients.size();
+            }
+        }
+
+        std::lock_guard<std::mutex> worker_lock(chosen->mutex);
+        chosen->clients.push_back(ScheduledClient{ client, 0, std::function<void()>() });
+        num_clients += 1;
+    }
+
+    void BehaviourScheduler::Unregister(BehaviourClient* client, const std::function<void()>& last_step)
+    {
+        std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex);
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            // Wait for the end of the current step if any
+            std::unique_lock<std::mutex> worker_lock(workers[i]->mutex);
+            const auto is_client = [client](const ScheduledClient& c) { return c.client == client; };
+            auto it = std::find_if(workers[i]->clients.begin(), workers[i]->clients.end(), is_client);
+            if (it == workers[i]->clients.end())
+            {
+                continue;
+            }
+            if (last_step)
+            {
+                // Let the worker run the last step and remove the client
+                it->last_step = last_step;
+                workers[i]->removed_condition.wait(worker_lock, [&]()
+                    {
+                        return std::none_of(workers[i]->clients.begin(), workers[i]->clients.end(), is_client);
+                    });
+            }
+            else
+            {
+                workers[i]->clients.erase(it);
+            }
+            num_clients -= 1;
+            break;
+        }
+
+        if (num_clients == 0)
+        {
+            Stop();
+        }
+    }
+
+    void BehaviourScheduler::Start()
+    {
+        running = true;
+        const size_t num_groups = AffinityGroups::GetInstance().GetNumGroups();
+        for (unsigned int i = 0; i < num_workers; ++i)
+        {
+            workers.push_back(std::make_unique<Worker>());
+            workers.back()->group = num_groups > 0 ? static_cast<int>(i % num_groups) : -1;
+        }
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            workers[i]->thread = std::thread(&BehaviourScheduler::RunWorker, this, workers[i].get());
+        }
+    }
+
+    void BehaviourScheduler::Stop()
+    {
+        running = false;
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            if (workers[i]->thread.joinable())
+            {
+                workers[i]->thread.join();
+            }
+        }
+        workers.clear();
+    }
+
+    void BehaviourScheduler::RunWorker(Worker* worker)
+    {
+        Logger::GetInstance().RegisterThread("BehaviourScheduler");
+        AffinityGroups::GetInstance().JoinGroup(worker->group);
+
+        while (running)
+        {
+            const VirtualClock::time_point end = VirtualClock::now() + std::chrono::milliseconds(10);
+            const long long int budget_us = step_budget_us.load(std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> worker_lock(worker->mutex);
+                RemoveUnregistered(worker);
+                // High priority clients first, so they don't wait for the others
+                for (size_t i = 0; i < worker->clients.size(); ++i)
+                {
+                    if (worker->clients[i].client->GetHighPriority())
+                    {
+                        StepClient(worker->clients[i], budget_us);
+                    }
+                }
+                for (size_t i = 0; i < worker->clients.size(); ++i)
+                {
+                    if (!worker->clients[i].client->GetHighPriority())
+                    {
+                        StepClient(worker->clients[i], budget_us);
+                    }
+                }
+            }
+            SleepUntil(end);
+        }
+    }
+
+    void BehaviourScheduler::RemoveUnregistered(Worker* worker)
+    {
+        bool removed = false;
+        for (auto it = worker->clients.begin(); it != worker->clients.end();)
+        {
+            if (!it->last_step)
+            {
+                ++it;
+                continue;
+            }
+            try
+            {
+                it->last_step();
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR("Exception caught during the last behaviour step: " << e.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR("Unknown exception caught during the last behaviour step");
+            }
+            it = worker->clients.erase(it);
+            removed = true;
+        }
+        if (removed)
+        {
+            worker->removed_condition.notify_all();
+        }
+    }
+
+    void BehaviourScheduler::StepClient(ScheduledClient& scheduled, const long long int budget_us)
+    {
+        if (budget_us <= 0)
+        {
+            scheduled.debt_us = 0;
+            scheduled.client->BehaviourStep();
+            return;
+        }
+
+        // Pay back the previous overruns before running again
+        if (scheduled.debt_us > 0 && !scheduled.client->GetHighPriority())
+        {
+            scheduled.debt_us = std::max(0LL, scheduled.debt_us - budget_us);
+            scheduled.client->RecordThrottledStep();
+            return;
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        scheduled.client->BehaviourStep();
+        const long long int duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        if (duration_us > budget_us)
+        {
+            const long long int overrun_us = duration_us - budget_us;
+            scheduled.debt_us += overrun_us;
+            scheduled.client->RecordBudgetOverrun();
+            // The behaviour is suspended in Yield, so the
+            // profiled node is the one that used the time
+            const size_t node = scheduled.client->GetProfiledNode();
+            if (node != BehaviourClient::no_profiled_node)
+            {
+                BehaviourProfiler::GetInstance().RecordBudgetOverrun(node, overrun_us / 1000.0);
+            }
+        }
+    }
+} // Botcraft
@@ -0,0 +1,27 @@
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "botcraft/AI/Blackboard.hpp"
+
+namespace Botcraft
+{
+    const size_t Blackboard::Intern(const std::string& key)
+    {
+        static std::shared_mutex keys_mutex;
+        static std::unordered_map<std::string, size_t> keys;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(keys_mutex);
+            auto it = keys.find(key);
+            if (it != keys.end())
+            {
+                return it->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(keys_mutex);
+        // If another thread added it in the meantime, the existing index is returned
+        return keys.insert({ key, keys.size() }).first->second;
+    }
+} // Botcraft
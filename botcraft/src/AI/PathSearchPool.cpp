@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include "botcraft/AI/PathSearchPool.hpp"
+#include "botcraft/AI/Tasks/PathfindingTask.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+namespace Botcraft
+{
+    struct PathSearchJob
+    {
+        std::shared_ptr<World> world;
+        Position start;
+        Position end;
+        int min_end_dist;
+        bool allow_jump;
+        bool hierarchical;
+        bool has_deadline;
+        std::chrono::steady_clock::time_point deadline;
+
+        // Number of handles waiting for this job, modified with the pool mutex locked
+        std::atomic<int> num_waiters;
+        std::atomic<bool> done;
+        std::vector<Position> path;
+    };
+
+    PathSearchHandle::PathSearchHandle()
+    {
+        job = nullptr;
+    }
+
+    PathSearchHandle::PathSearchHandle(const std::shared_ptr<PathSearchJob>& job_)
+    {
+        job = job_;
+    }
+
+    PathSearchHandle::~PathSearchHandle()
+    {
+        Cancel();
+    }
+
+    PathSearchHandle::PathSearchHandle(PathSearchHandle&& other)
+    {
+        job = std::move(other.job);
+        other.job = nullptr;
+    }
+
+    PathSearchHandle& PathSearchHandle::operator=(PathSearchHandle&& other)
+    {
+        if (this != &other)
+        {
+            Cancel();
+            job = std::move(other.job);
+            other.job = nullptr;
+        }
+        return *this;
+    }
+
+    const bool PathSearchHandle::IsValid() const
+    {
+        return job != nullptr;
+    }
+
+    const bool PathSearchHandle::IsDone() const
+    {
+        return job == nullptr || job->done.load(std::memory_order_acquire);
+    }
+
+    const std::vector<Position>& PathSearchHandle::GetPath() const
+    {
+        static const std::vector<Position> empty_path;
+        return IsDone() && job != nullptr ? job->path : empty_path;
+    }
+
+    void PathSearchHandle::Cancel()
+    {
+        if (job == nullptr)
+        {
+            return;
+        }
+
+        if (!job->done.load(std::memory_order_acquire))
+        {
+            PathSearchPool::GetInstance().Release(*job);
+        }
+        job = nullptr;
+    }
+
+
+    PathSearchPool::PathSearchPool()
+    {
+        num_workers = 1;
+        running = false;
+    }
+
+    PathSearchPool::~PathSearchPool()
+    {
+        Stop();
+    }
+
+    PathSearchPool& PathSearchPool::GetInstance()
+    {
+        static PathSearchPool instance;
+        return instance;
+    }
+
+    void PathSearchPool::SetNumWorkers(const unsigned int n)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (!in_flight.empty())
+            {
+                LOG_WARNING("Can't change the number of path search workers while searches are running");
+                return;
+            }
+            num_workers = n;
+        }
+        // Restarted with the new size at the next Submit
+        Stop();
+    }
+
+    const unsigned int PathSearchPool::GetNumWorkers() const
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        return num_workers;
+    }
+
+    PathSearchHandle PathSearchPool::Submit(const std::shared_ptr<World>& world, const Position& start, const Position& end,
+        const int min_end_dist, const bool allow_jump, const bool hierarchical, const int time_budget_ms)
+    {
+        std::shared_ptr<PathSearchJob> job;
+        bool run_now = false;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+
+            // Share the search if the same one is already running
+            for (size_t i = 0; i < in_flight.size(); ++i)
+            {
+                const PathSearchJob& other = *in_flight[i];
+                if (other.world == world && other.start == start && other.end == end &&
+                    other.min_end_dist == min_end_dist && other.allow_jump == allow_jump &&
+                    other.hierarchical == hierarchical && other.num_waiters > 0)
+                {
+                    in_flight[i]->num_waiters++;
+                    return PathSearchHandle(in_flight[i]);
+                }
+            }
+
+            job = std::make_shared<PathSearchJob>();
+            job->world = world;
+            job->start = start;
+            job->end = end;
+            job->min_end_dist = min_end_dist;
+            job->allow_jump = allow_jump;
+            job->hierarchical = hierarchical;
+            job->has_deadline = time_budget_ms > 0;
+            job->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(time_budget_ms);
+            job->num_waiters = 1;
+            job->done = false;
+
+            if (num_workers == 0)
+            {
+                run_now = true;
+            }
+            else
+            {
+                if (!running)
+                {
+                    Start();
+                }
+                queue.push_back(job);
+                in_flight.push_back(job);
+            }
+        }
+
+        if (run_now)
+        {
+            Run(*job);
+            job->done.store(true, std::memory_order_release);
+        }
+        else
+        {
+            pool_condition.notify_one();
+        }
+
+        return PathSearchHandle(job);
+    }
+
+    void PathSearchPool::Start()
+    {
+        running = true;
+        for (unsigned int i = 0; i < num_workers; ++i)
+        {
+            worker_threads.push_back(std::thread(&PathSearchPool::RunWorker, this));
+        }
+    }
+
+    void PathSearchPool::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            running = false;
+        }
+        pool_condition.notify_all();
+
+        for (size_t i = 0; i < worker_threads.size(); ++i)
+        {
+            if (worker_threads[i].joinable())
+            {
+                worker_threads[i].join();
+            }
+        }
+        worker_threads.clear();
+
+        // Queued searches will never run, don't let their handles wait forever
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            queue[i]->done.store(true, std::memory_order_release);
+        }
+        queue.clear();
+        in_flight.clear();
+    }
+
+    void PathSearchPool::RunWorker()
+    {
+        Logger::GetInstance().RegisterThread("PathSearch");
+
+        while (true)
+        {
+            std::shared_ptr<PathSearchJob> job;
+            {
+                std::unique_lock<std::mutex> lock(pool_mutex);
+                pool_condition.wait(lock, [this]() { return !running || !queue.empty(); });
+                if (!running)
+                {
+                    break;
+                }
+                job = queue.front();
+                queue.pop_front();
+            }
+
+            // Don't bother searching if nobody waits for the result anymore
+            if (job->num_waiters > 0)
+            {
+                Run(*job);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                in_flight.erase(std::remove(in_flight.begin(), in_flight.end(), job), in_flight.end());
+                job->done.store(true, std::memory_order_release);
+            }
+        }
+    }
+
+    void PathSearchPool::Release(PathSearchJob& job)
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (job.num_waiters > 0)
+        {
+            job.num_waiters--;
+        }
+    }
+
+    void PathSearchPool::Run(PathSearchJob& job)
+    {
+        const std::function<bool()> should_stop = [&job]()
+        {
+            return job.num_waiters == 0 ||
+                (job.has_deadline && std::chrono::steady_clock::now() > job.deadline);
+        };
+
+        job.path = job.hierarchical ?
+            FindHierarchicalPath(job.world, job.start, job.end, job.min_end_dist, job.allow_jump, should_stop) :
+            FindPath(job.world, job.start, job.end, job.min_end_dist, job.allow_jump, should_stop);
+    }
+} // Botcraft
@@ -0,0 +1,919 @@
+#include <atomic>
+#include <deque>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <asio.hpp>
+
+#include "botcraft/AI/SwarmCoordinator.hpp"
+#include "botcraft/AI/Tasks/PathfindingTask.hpp"
+#include "botcraft/Game/Inventory/InventoryManager.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Game/World/WorldSnapshot.hpp"
+#include "botcraft/Network/DNSCache.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+    // Each frame is an int size followed by a VarInt message type and its fields
+    enum class CoordinatorMessage
+    {
+        /// @brief hub --> node: VarInt node id
+        Welcome = 0,
+        /// @brief VarInt origin node id, string channel, string key, bool retain, VarInt size, data
+        Publish = 1,
+        /// @brief node --> hub: VarInt request id, string key
+        Claim = 2,
+        /// @brief hub --> node: VarInt request id, bool granted
+        ClaimResult = 3,
+        /// @brief node --> hub: string key
+        Release = 4,
+    };
+
+    // Frames bigger than that are garbage
+    static constexpr size_t max_frame_size = 64 * 1024 * 1024;
+
+    static const std::string world_channel = "world";
+    static const std::string containers_channel = "containers";
+    static const std::string paths_channel = "paths";
+
+    static const std::string GetDimensionName(const Chunk& chunk)
+    {
+#if PROTOCOL_VERSION < 719
+        return std::to_string(static_cast<int>(chunk.GetDimension()));
+#else
+        return chunk.GetDimension();
+#endif
+    }
+
+    static void WriteBytes(const std::vector<unsigned char>& data, WriteContainer& container)
+    {
+        WriteData<VarInt>(static_cast<int>(data.size()), container);
+        container.insert(container.end(), data.begin(), data.end());
+    }
+
+    static std::vector<unsigned char> ReadBytes(ReadIterator& iter, size_t& length)
+    {
+        const int size = ReadData<VarInt>(iter, length);
+        if (size < 0)
+        {
+            throw(std::runtime_error("Wrong data size in coordinator message"));
+        }
+        return ReadArrayData<unsigned char>(iter, length, size);
+    }
+
+    struct SwarmCoordinator::Impl
+    {
+        /// @brief A connection between the hub and a node
+        struct Session
+        {
+            Session(asio::io_service& io_service) : socket(io_service)
+            {
+
+            }
+
+            asio::ip::tcp::socket socket;
+            /// @brief Node id of the other end (only used by the hub)
+            int id = -1;
+            std::array<unsigned char, 4> size_buffer;
+            std::vector<unsigned char> frame;
+            std::deque<std::shared_ptr<const std::vector<unsigned char> > > write_queue;
+            bool closed = false;
+        };
+
+        /// @brief Last data published on a retained key
+        struct RetainedMessage
+        {
+            int origin;
+            std::vector<unsigned char> data;
+            /// @brief Position of the key in retained_lru
+            std::list<std::pair<std::string, std::string> >::iterator lru_it;
+        };
+
+        struct WorldShare
+        {
+            std::shared_ptr<World> world;
+            std::chrono::milliseconds interval;
+            std::unique_ptr<asio::steady_timer> timer;
+            /// @brief Chunk key --> blocks version already published or received
+            std::unordered_map<std::string, unsigned long long> known_versions;
+            /// @brief Chunk key --> blocks version of the chunk added from another process
+            std::unordered_map<std::string, unsigned long long> external_versions;
+        };
+
+        struct ContainersShare
+        {
+            std::shared_ptr<InventoryManager> inventory_manager;
+            std::chrono::milliseconds interval;
+            std::unique_ptr<asio::steady_timer> timer;
+            /// @brief Container position --> serialized content already published or received
+            std::unordered_map<Position, std::vector<unsigned char> > known;
+        };
+
+        Impl(const bool is_hub_) : is_hub(is_hub_), work(io_service)
+        {
+            node_id = is_hub ? 0 : -1;
+            connected = is_hub;
+            next_node_id = 1;
+            next_request_id = 0;
+            retained_memory = 0;
+            max_retained_memory = 256 * 1024 * 1024;
+        }
+
+        ~Impl()
+        {
+            {
+                std::lock_guard<std::mutex> lock(reservation_worlds_mutex);
+                for (const std::shared_ptr<World>& w : reservation_worlds)
+                {
+                    SetPathReservationsListener(w, nullptr);
+                }
+            }
+            io_service.stop();
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+            // Nobody will answer anymore
+            std::lock_guard<std::mutex> lock(claims_mutex);
+            for (auto& p : pending_claims)
+            {
+                p.second.set_value(false);
+            }
+            pending_claims.clear();
+        }
+
+        void Run()
+        {
+            thread = std::thread([this]()
+                {
+                    Logger::GetInstance().RegisterThread("SwarmCoordinator");
+                    io_service.run();
+                });
+        }
+
+        void Accept()
+        {
+            std::shared_ptr<Session> session = std::make_shared<Session>(io_service);
+            acceptor->async_accept(session->socket, [this, session](const asio::error_code& error)
+                {
+                    if (!error)
+                    {
+                        session->id = next_node_id++;
+                        sessions[session->id] = session;
+                        LOG_INFO("Swarm node " << session->id << " connected from " << session->socket.remote_endpoint().address().to_string());
+
+                        std::vector<unsigned char> welcome;
+                        WriteData<VarInt>(static_cast<int>(CoordinatorMessage::Welcome), welcome);
+                        WriteData<VarInt>(session->id, welcome);
+                        Send(session, welcome);
+                        // Bring the new node up to date
+                        for (const auto& channel : retained)
+                        {
+                            for (const auto& message : channel.second)
+                            {
+                                Send(session, MakePublish(message.second.origin, channel.first, message.first, message.second.data, true));
+                            }
+                        }
+                        Read(session);
+                    }
+                    if (error != asio::error::operation_aborted)
+                    {
+                        Accept();
+                    }
+                });
+        }
+
+        void Read(const std::shared_ptr<Session>& session)
+        {
+            asio::async_read(session->socket, asio::buffer(session->size_buffer), [this, session](const asio::error_code& error, std::size_t)
+                {
+                    if (error)
+                    {
+                        Close(session, error.message());
+                        return;
+                    }
+                    ReadIterator iter = session->size_buffer.data();
+                    size_t length = session->size_buffer.size();
+                    const int size = ReadData<int>(iter, length);
+                    if (size <= 0 || static_cast<size_t>(size) > max_frame_size)
+                    {
+                        Close(session, "wrong frame size " + std::to_string(size));
+                        return;
+                    }
+                    session->frame.resize(size);
+                    asio::async_read(session->socket, asio::buffer(session->frame), [this, session](const asio::error_code& error, std::size_t)
+                        {
+                            if (error)
+                            {
+                                Close(session, error.message());
+                                return;
+                            }
+                            try
+                            {
+                                Handle(session, session->frame);
+                            }
+                            catch (const std::exception& e)
+                            {
+                                Close(session, e.what());
+                                return;
+                            }
+                            Read(session);
+                        });
+                });
+        }
+
+        void Send(const std::shared_ptr<Session>& session, const std::vector<unsigned char>& payload)
+        {
+            if (session->closed)
+            {
+                return;
+            }
+            std::shared_ptr<std::vector<unsigned char> > frame = std::make_shared<std::vector<unsigned char> >();
+            frame->reserve(payload.size() + 4);
+            WriteData<int>(static_cast<int>(payload.size()), *frame);
+            frame->insert(frame->end(), payload.begin(), payload.end());
+            session->write_queue.push_back(frame);
+            if (session->write_queue.size() == 1)
+            {
+                Write(session);
+            }
+        }
+
+        void Write(const std::shared_ptr<Session>& session)
+        {
+            asio::async_write(session->socket, asio::buffer(*session->write_queue.front()), [this, session](const asio::error_code& error, std::size_t)
+                {
+                    if (error)
+                    {
+                        Close(session, error.message());
+                        return;
+                    }
+                    session->write_queue.pop_front();
+                    if (!session->write_queue.empty())
+                    {
+                        Write(session);
+                    }
+                });
+        }
+
+        void Close(const std::shared_ptr<Session>& session, const std::string& reason)
+        {
+            if (session->closed)
+            {
+                return;
+            }
+            session->closed = true;
+            session->write_queue.clear();
+            asio::error_code ignored;
+            session->socket.close(ignored);
+
+            if (is_hub)
+            {
+                LOG_INFO("Swarm node " << session->id << " disconnected (" << reason << ")");
+                sessions.erase(session->id);
+                for (auto it = claims.begin(); it != claims.end();)
+                {
+                    it = it->second == session->id ? claims.erase(it) : std::next(it);
+                }
+            }
+            else
+            {
+                LOG_ERROR("Connection with the swarm hub lost (" << reason << ")");
+                connected = false;
+                std::lock_guard<std::mutex> lock(claims_mutex);
+                for (auto& p : pending_claims)
+                {
+                    p.second.set_value(false);
+                }
+                pending_claims.clear();
+            }
+        }
+
+        static std::vector<unsigned char> MakePublish(const int origin, const std::string& channel, const std::string& key, const std::vector<unsigned char>& data, const bool retain)
+        {
+            std::vector<unsigned char> payload;
+            payload.reserve(data.size() + channel.size() + key.size() + 16);
+            WriteData<VarInt>(static_cast<int>(CoordinatorMessage::Publish), payload);
+            WriteData<VarInt>(origin, payload);
+            WriteData<std::string>(channel, payload);
+            WriteData<std::string>(key, payload);
+            WriteData<bool>(retain, payload);
+            WriteBytes(data, payload);
+            return payload;
+        }
+
+        void Handle(const std::shared_ptr<Session>& session, const std::vector<unsigned char>& payload)
+        {
+            ReadIterator iter = payload.data();
+            size_t length = payload.size();
+            const CoordinatorMessage type = static_cast<CoordinatorMessage>(static_cast<int>(ReadData<VarInt>(iter, length)));
+            switch (type)
+            {
+            case CoordinatorMessage::Welcome:
+                node_id = ReadData<VarInt>(iter, length);
+                LOG_INFO("Connected to the swarm hub as node " << node_id);
+                break;
+            case CoordinatorMessage::Publish:
+            {
+                int origin = ReadData<VarInt>(iter, length);
+                const std::string channel = ReadData<std::string>(iter, length);
+                const std::string key = ReadData<std::string>(iter, length);
+                const bool retain = ReadData<bool>(iter, length);
+                const std::vector<unsigned char> data = ReadBytes(iter, length);
+                if (is_hub)
+                {
+                    // Don't trust the sender for its id
+                    origin = session->id;
+                    Relay(origin, channel, key, data, retain);
+                }
+                else if (retain)
+                {
+                    Retain(origin, channel, key, data);
+                }
+                Dispatch(origin, channel, key, data);
+                break;
+            }
+            case CoordinatorMessage::Claim:
+            {
+                const int request_id = ReadData<VarInt>(iter, length);
+                const std::string key = ReadData<std::string>(iter, length);
+                std::vector<unsigned char> answer;
+                WriteData<VarInt>(static_cast<int>(CoordinatorMessage::ClaimResult), answer);
+                WriteData<VarInt>(request_id, answer);
+                WriteData<bool>(TryClaim(key, session->id), answer);
+                Send(session, answer);
+                break;
+            }
+            case CoordinatorMessage::ClaimResult:
+            {
+                const int request_id = ReadData<VarInt>(iter, length);
+                const bool granted = ReadData<bool>(iter, length);
+                std::lock_guard<std::mutex> lock(claims_mutex);
+                auto it = pending_claims.find(request_id);
+                if (it != pending_claims.end())
+                {
+                    it->second.set_value(granted);
+                    pending_claims.erase(it);
+                }
+                break;
+            }
+            case CoordinatorMessage::Release:
+            {
+                const std::string key = ReadData<std::string>(iter, length);
+                auto it = claims.find(key);
+                if (it != claims.end() && it->second == session->id)
+                {
+                    claims.erase(it);
+                }
+                break;
+            }
+            default:
+                throw(std::runtime_error("Unknown coordinator message type " + std::to_string(static_cast<int>(type))));
+            }
+        }
+
+        /// @brief Send a message to all the nodes but its origin, and keep it if retained. Hub only
+        void Relay(const int origin, const std::string& channel, const std::string& key, const std::vector<unsigned char>& data, const bool retain)
+        {
+            if (retain)
+            {
+                Retain(origin, channel, key, data);
+            }
+            const std::vector<unsigned char> payload = MakePublish(origin, channel, key, data, retain);
+            // Copy as Send can close and erase sessions
+            const std::map<int, std::shared_ptr<Session> > targets = sessions;
+            for (const auto& s : targets)
+            {
+                if (s.first != origin)
+                {
+                    Send(s.second, payload);
+                }
+            }
+        }
+
+        /// @brief Keep the last data of a key, to send it to the nodes and subscribers coming later.
+        /// The least recently published keys are dropped above max_retained_memory
+        void Retain(const int origin, const std::string& channel, const std::string& key, const std::vector<unsigned char>& data)
+        {
+            std::map<std::string, RetainedMessage>& messages = retained[channel];
+            auto it = messages.find(key);
+            if (it != messages.end())
+            {
+                retained_memory -= it->second.data.size();
+                retained_lru.erase(it->second.lru_it);
+                messages.erase(it);
+            }
+            if (!data.empty())
+            {
+                retained_lru.emplace_back(channel, key);
+                messages[key] = { origin, data, std::prev(retained_lru.end()) };
+                retained_memory += data.size();
+            }
+            TrimRetained();
+        }
+
+        void TrimRetained()
+        {
+            while (retained_memory > max_retained_memory && !retained_lru.empty())
+            {
+                const std::pair<std::string, std::string>& oldest = retained_lru.front();
+                std::map<std::string, RetainedMessage>& messages = retained[oldest.first];
+                auto it = messages.find(oldest.second);
+                retained_memory -= it->second.data.size();
+                messages.erase(it);
+                retained_lru.pop_front();
+            }
+        }
+
+        /// @brief Call the callbacks of the messages of the other processes
+        void Dispatch(const int origin, const std::string& channel, const std::string& key, const std::vector<unsigned char>& data)
+        {
+            if (origin == node_id)
+            {
+                return;
+            }
+            auto it = subscribers.find(channel);
+            if (it == subscribers.end())
+            {
+                return;
+            }
+            // Copy as a callback could subscribe to the same channel
+            const std::vector<Callback> callbacks = it->second;
+            for (const Callback& c : callbacks)
+            {
+                Call(c, channel, key, data);
+            }
+        }
+
+        static void Call(const Callback& callback, const std::string& channel, const std::string& key, const std::vector<unsigned char>& data)
+        {
+            try
+            {
+                callback(key, data);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR("Error processing swarm message on channel " << channel << ": " << e.what());
+            }
+        }
+
+        /// @brief Add a callback and give it the messages retained so far
+        void AddSubscriber(const std::string& channel, const Callback& callback)
+        {
+            subscribers[channel].push_back(callback);
+            auto it = retained.find(channel);
+            if (it == retained.end())
+            {
+                return;
+            }
+            // Copy as the callback could publish on the same channel
+            const std::map<std::string, RetainedMessage> messages = it->second;
+            for (const auto& m : messages)
+            {
+                if (m.second.origin != node_id)
+                {
+                    Call(callback, channel, m.first, m.second.data);
+                }
+            }
+        }
+
+        /// @brief Give a resource to a node if it's free. Hub only
+        bool TryClaim(const std::string& key, const int owner)
+        {
+            auto it = claims.find(key);
+            if (it == claims.end())
+            {
+                claims[key] = owner;
+                return true;
+            }
+            return it->second == owner;
+        }
+
+        void Publish(const std::string& channel, const std::string& key, const std::vector<unsigned char>& data, const bool retain)
+        {
+            asio::post(io_service, [this, channel, key, data, retain]()
+                {
+                    if (is_hub)
+                    {
+                        Relay(node_id, channel, key, data, retain);
+                    }
+                    else if (hub_session)
+                    {
+                        Send(hub_session, MakePublish(node_id, channel, key, data, retain));
+                    }
+                });
+        }
+
+        void PollWorld(const std::shared_ptr<WorldShare>& share)
+        {
+            const WorldSnapshot snapshot = share->world->GetSnapshot();
+            std::unordered_set<std::string> loaded_keys;
+            loaded_keys.reserve(snapshot.GetAllChunks().size());
+            for (const auto& c : snapshot.GetAllChunks())
+            {
+                const std::string key = GetDimensionName(*c.second) + " " + std::to_string(c.first.first) + " " + std::to_string(c.first.second);
+                loaded_keys.insert(key);
+                const unsigned long long version = c.second->GetBlocksVersion();
+                auto it = share->known_versions.find(key);
+                if (it != share->known_versions.end() && it->second == version)
+                {
+                    continue;
+                }
+                share->known_versions[key] = version;
+                std::vector<unsigned char> data;
+                c.second->Write(data);
+                Publish(world_channel, key, data, true);
+            }
+
+            // Forget the chunks unloaded since, they'll be published again if they come back
+            for (auto it = share->known_versions.begin(); it != share->known_versions.end();)
+            {
+                it = loaded_keys.find(it->first) == loaded_keys.end() ? share->known_versions.erase(it) : std::next(it);
+            }
+            for (auto it = share->external_versions.begin(); it != share->external_versions.end();)
+            {
+                it = loaded_keys.find(it->first) == loaded_keys.end() ? share->external_versions.erase(it) : std::next(it);
+            }
+
+            share->timer->expires_after(share->interval);
+            share->timer->async_wait([this, share](const asio::error_code& error)
+                {
+                    if (!error)
+                    {
+                        PollWorld(share);
+                    }
+                });
+        }
+
+        void ReceiveChunk(const std::shared_ptr<WorldShare>& share, const std::string& key, const std::vector<unsigned char>& data)
+        {
+            if (data.empty())
+            {
+                return;
+            }
+            std::istringstream key_stream(key);
+            std::string dimension;
+            int x, z;
+            if (!(key_stream >> dimension >> x >> z))
+            {
+                throw(std::runtime_error("Wrong chunk key " + key));
+            }
+            ReadIterator iter = data.data();
+            size_t length = data.size();
+            const std::shared_ptr<Chunk> chunk = Chunk::Read(iter, length);
+
+            auto external_it = share->external_versions.find(key);
+            std::lock_guard<std::mutex> world_guard(share->world->GetMutex());
+            // Replace the chunk only if it's still the one received before
+            if (share->world->AddExternalChunk(x, z, chunk, external_it == share->external_versions.end() ? 0 : external_it->second))
+            {
+                share->external_versions[key] = chunk->GetBlocksVersion();
+                share->known_versions[key] = chunk->GetBlocksVersion();
+                share->world->PublishSnapshot();
+            }
+        }
+
+        static std::vector<unsigned char> SerializeContainer(const std::map<short, Slot>& content)
+        {
+            std::vector<unsigned char> data;
+            WriteData<VarInt>(static_cast<int>(content.size()), data);
+            for (const auto& s : content)
+            {
+                WriteData<short>(s.first, data);
+                s.second.Write(data);
+            }
+            return data;
+        }
+
+        static const std::string GetContainerKey(const Position& pos)
+        {
+            return std::to_string(pos.x) + " " + std::to_string(pos.y) + " " + std::to_string(pos.z);
+        }
+
+        void PollContainers(const std::shared_ptr<ContainersShare>& share)
+        {
+            std::unordered_map<Position, std::vector<unsigned char> > current;
+            {
+                std::lock_guard<std::mutex> inventory_lock(share->inventory_manager->GetMutex());
+                for (const auto& c : share->inventory_manager->GetKnownContainers())
+                {
+                    current[c.first] = SerializeContainer(c.second);
+                }
+            }
+            for (const auto& c : current)
+            {
+                auto it = share->known.find(c.first);
+                if (it == share->known.end() || it->second != c.second)
+                {
+                    Publish(containers_channel, GetContainerKey(c.first), c.second, true);
+                }
+            }
+            for (const auto& c : share->known)
+            {
+                if (current.find(c.first) == current.end())
+                {
+                    Publish(containers_channel, GetContainerKey(c.first), {}, true);
+                }
+            }
+            share->known = std::move(current);
+
+            share->timer->expires_after(share->interval);
+            share->timer->async_wait([this, share](const asio::error_code& error)
+                {
+                    if (!error)
+                    {
+                        PollContainers(share);
+                    }
+                });
+        }
+
+        void ReceiveContainer(const std::shared_ptr<ContainersShare>& share, const std::string& key, const std::vector<unsigned char>& data)
+        {
+            std::istringstream key_stream(key);
+            Position pos;
+            if (!(key_stream >> pos.x >> pos.y >> pos.z))
+            {
+                throw(std::runtime_error("Wrong container key " + key));
+            }
+            if (data.empty())
+            {
+                share->inventory_manager->ForgetContainer(pos);
+                share->known.erase(pos);
+                return;
+            }
+
+            ReadIterator iter = data.data();
+            size_t length = data.size();
+            std::map<short, Slot> content;
+            const int num_slots = ReadData<VarInt>(iter, length);
+            for (int i = 0; i < num_slots; ++i)
+            {
+                const short index = ReadData<short>(iter, length);
+                content[index].Read(iter, length);
+            }
+            share->inventory_manager->SetKnownContainer(pos, content);
+            share->known[pos] = data;
+        }
+
+        const bool is_hub;
+        std::atomic<int> node_id;
+        std::atomic<bool> connected;
+
+        asio::io_service io_service;
+        asio::io_service::work work;
+        std::thread thread;
+
+        // Everything below is only used on the io thread, except the mutex protected members
+
+        /// @brief channel --> key --> last data
+        std::map<std::string, std::map<std::string, RetainedMessage> > retained;
+        /// @brief Retained (channel, key), least recently published first
+        std::list<std::pair<std::string, std::string> > retained_lru;
+        /// @brief Size of all the retained data, in bytes
+        size_t retained_memory;
+        size_t max_retained_memory;
+        std::map<std::string, std::vector<Callback> > subscribers;
+
+        // Hub only
+        std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
+        int next_node_id;
+        std::map<int, std::shared_ptr<Session> > sessions;
+        /// @brief resource --> owner node id
+        std::map<std::string, int> claims;
+
+        // Node only
+        std::shared_ptr<Session> hub_session;
+        std::mutex claims_mutex;
+        int next_request_id;
+        std::map<int, std::promise<bool> > pending_claims;
+
+        std::vector<std::shared_ptr<WorldShare> > world_shares;
+        std::vector<std::shared_ptr<ContainersShare> > containers_shares;
+
+        std::mutex reservation_worlds_mutex;
+        std::vector<std::shared_ptr<World> > reservation_worlds;
+    };
+
+    SwarmCoordinator::SwarmCoordinator(const unsigned short port, const std::string& address)
+    {
+        impl = std::make_unique<Impl>(true);
+        impl->acceptor = std::make_unique<asio::ip::tcp::acceptor>(impl->io_service, asio::ip::tcp::endpoint(asio::ip::make_address(address), port));
+        impl->Accept();
+        impl->Run();
+        LOG_INFO("Swarm hub listening on " << address << ":" << port);
+    }
+
+    SwarmCoordinator::SwarmCoordinator(const std::string& hub_address, const unsigned short port)
+    {
+        impl = std::make_unique<Impl>(false);
+        impl->hub_session = std::make_shared<Impl::Session>(impl->io_service);
+        asio::error_code error;
+        asio::connect(impl->hub_session->socket, DNSCache::GetInstance().Resolve(hub_address, port), error);
+        if (error)
+        {
+            throw(std::runtime_error("Can't connect to swarm hub " + hub_address + ":" + std::to_string(port) + " (" + error.message() + ")"));
+        }
+        impl->connected = true;
+        impl->Read(impl->hub_session);
+        impl->Run();
+    }
+
+    SwarmCoordinator::~SwarmCoordinator()
+    {
+
+    }
+
+    const bool SwarmCoordinator::IsHub() const
+    {
+        return impl->is_hub;
+    }
+
+    const bool SwarmCoordinator::IsConnected() const
+    {
+        return impl->connected;
+    }
+
+    const int SwarmCoordinator::GetNodeId() const
+    {
+        return impl->node_id;
+    }
+
+    void SwarmCoordinator::Publish(const std::string& channel, const std::string& key, const std::vector<unsigned char>& data, const bool retain)
+    {
+        impl->Publish(channel, key, data, retain);
+    }
+
+    void SwarmCoordinator::SetMaxRetainedMemory(const size_t bytes)
+    {
+        Impl* impl_ptr = impl.get();
+        asio::post(impl->io_service, [impl_ptr, bytes]()
+            {
+                impl_ptr->max_retained_memory = bytes;
+                impl_ptr->TrimRetained();
+            });
+    }
+
+    void SwarmCoordinator::Subscribe(const std::string& channel, const Callback& callback)
+    {
+        Impl* impl_ptr = impl.get();
+        asio::post(impl->io_service, [impl_ptr, channel, callback]()
+            {
+                impl_ptr->AddSubscriber(channel, callback);
+            });
+    }
+
+    const bool SwarmCoordinator::Claim(const std::string& key, const std::chrono::milliseconds& timeout)
+    {
+        std::promise<bool> promise;
+        std::future<bool> result = promise.get_future();
+        if (impl->is_hub)
+        {
+            asio::post(impl->io_service, [this, key, &promise]()
+                {
+                    promise.set_value(impl->TryClaim(key, impl->node_id));
+                });
+            // The io thread always answers, no need for a timeout
+            return result.get();
+        }
+
+        if (!impl->connected)
+        {
+            return false;
+        }
+        int request_id;
+        {
+            std::lock_guard<std::mutex> lock(impl->claims_mutex);
+            request_id = impl->next_request_id++;
+            impl->pending_claims[request_id] = std::move(promise);
+        }
+        std::vector<unsigned char> payload;
+        WriteData<VarInt>(static_cast<int>(CoordinatorMessage::Claim), payload);
+        WriteData<VarInt>(request_id, payload);
+        WriteData<std::string>(key, payload);
+        asio::post(impl->io_service, [this, payload]()
+            {
+                impl->Send(impl->hub_session, payload);
+            });
+
+        if (result.wait_for(timeout) == std::future_status::ready)
+        {
+            return result.get();
+        }
+        std::lock_guard<std::mutex> lock(impl->claims_mutex);
+        impl->pending_claims.erase(request_id);
+        LOG_WARNING("Swarm hub didn't answer to claim " << key << " in time");
+        return false;
+    }
+
+    void SwarmCoordinator::Release(const std::string& key)
+    {
+        asio::post(impl->io_service, [this, key]()
+            {
+                if (impl->is_hub)
+                {
+                    auto it = impl->claims.find(key);
+                    if (it != impl->claims.end() && it->second == impl->node_id)
+                    {
+                        impl->claims.erase(it);
+                    }
+                }
+                else
+                {
+                    std::vector<unsigned char> payload;
+                    WriteData<VarInt>(static_cast<int>(CoordinatorMessage::Release), payload);
+                    WriteData<std::string>(key, payload);
+                    impl->Send(impl->hub_session, payload);
+                }
+            });
+    }
+
+    void SwarmCoordinator::ShareWorld(const std::shared_ptr<World>& world, const std::chrono::milliseconds& interval)
+    {
+        std::shared_ptr<Impl::WorldShare> share = std::make_shared<Impl::WorldShare>();
+        share->world = world;
+        share->interval = interval;
+        share->timer = std::make_unique<asio::steady_timer>(impl->io_service);
+
+        Impl* impl_ptr = impl.get();
+        Subscribe(world_channel, [impl_ptr, share](const std::string& key, const std::vector<unsigned char>& data)
+            {
+                impl_ptr->ReceiveChunk(share, key, data);
+            });
+        asio::post(impl->io_service, [impl_ptr, share]()
+            {
+                impl_ptr->world_shares.push_back(share);
+                impl_ptr->PollWorld(share);
+            });
+    }
+
+    void SwarmCoordinator::ShareContainers(const std::shared_ptr<InventoryManager>& inventory_manager, const std::chrono::milliseconds& interval)
+    {
+        std::shared_ptr<Impl::ContainersShare> share = std::make_shared<Impl::ContainersShare>();
+        share->inventory_manager = inventory_manager;
+        share->interval = interval;
+        share->timer = std::make_unique<asio::steady_timer>(impl->io_service);
+
+        Impl* impl_ptr = impl.get();
+        Subscribe(containers_channel, [impl_ptr, share](const std::string& key, const std::vector<unsigned char>& data)
+            {
+                impl_ptr->ReceiveContainer(share, key, data);
+            });
+        asio::post(impl->io_service, [impl_ptr, share]()
+            {
+                impl_ptr->containers_shares.push_back(share);
+                impl_ptr->PollContainers(share);
+            });
+    }
+
+    void SwarmCoordinator::SharePathReservations(const std::shared_ptr<World>& world)
+    {
+        Impl* impl_ptr = impl.get();
+        SetPathReservationsListener(world, [impl_ptr](const void* owner, const std::vector<std::pair<Position, int> >& cells)
+            {
+                std::vector<unsigned char> data;
+                WriteData<VarInt>(static_cast<int>(cells.size()), data);
+                for (const auto& c : cells)
+                {
+                    WriteData<int>(c.first.x, data);
+                    WriteData<int>(c.first.y, data);
+                    WriteData<int>(c.first.z, data);
+                    WriteData<VarInt>(c.second, data);
+                }
+                // Reservations are short-lived, don't keep them for the nodes connecting later
+                impl_ptr->Publish(paths_channel, std::to_string(impl_ptr->node_id) + "/" + std::to_string(reinterpret_cast<std::uintptr_t>(owner)), data, false);
+            });
+        Subscribe(paths_channel, [world](const std::string& key, const std::vector<unsigned char>& data)
+            {
+                ReadIterator iter = data.data();
+                size_t length = data.size();
+                const int num_cells = ReadData<VarInt>(iter, length);
+                // Each cell is at least 3 ints and a one byte VarInt
+                if (num_cells < 0 || static_cast<size_t>(num_cells) > length / 13)
+                {
+                    throw(std::runtime_error("Wrong number of path reservations " + std::to_string(num_cells)));
+                }
+                std::vector<std::pair<Position, int> > cells(num_cells);
+                for (size_t i = 0; i < cells.size(); ++i)
+                {
+                    cells[i].first.x = ReadData<int>(iter, length);
+                    cells[i].first.y = ReadData<int>(iter, length);
+                    cells[i].first.z = ReadData<int>(iter, length);
+                    cells[i].second = ReadData<VarInt>(iter, length);
+                }
+                SetExternalPathReservations(world, key, cells);
+            });
+        std::lock_guard<std::mutex> lock(impl->reservation_worlds_mutex);
+        impl->reservation_worlds.push_back(world);
+    }
+} // Botcraft
@@ -44,11 +44,7 @@ namespace Botcraft
     {
         std::shared_ptr<LocalPlayer> local_player = client.GetEntityManager()->GetLocalPlayer();
 
-        Vector3<double> player_pos;
-        {
-            std::lock_guard<std::mutex> lock(local_player->GetMutex());
-            player_pos = local_player->GetPosition();
-        }
+        Vector3<double> player_pos = local_player->GetState().position;
 
         // Compute the distance from the hand? Might be from somewhere else
         player_pos.y += 1.0;
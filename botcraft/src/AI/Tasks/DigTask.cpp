@@ -1,17 +1,84 @@
+#include <algorithm>
+#include <array>
+#include <deque>
+
 #include "botcraft/AI/Tasks/DigTask.hpp"
 #include "botcraft/AI/Tasks/PathfindingTask.hpp"
 #include "botcraft/AI/Blackboard.hpp"
 
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
 #include "botcraft/Game/Entities/EntityManager.hpp"
+#include "botcraft/Game/Inventory/InventoryManager.hpp"
+#include "botcraft/Game/Inventory/Tools.hpp"
+#include "botcraft/Game/Inventory/Window.hpp"
 #include "botcraft/Game/World/World.hpp"
 #include "botcraft/Network/NetworkManager.hpp"
 #include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
 
 using namespace ProtocolCraft;
 
 namespace Botcraft
 {
+    /// @brief Get the survival time needed to break a block with a given item
+    static float GetMiningTime(BehaviourClient& c, const Blockstate* blockstate, const Slot& item)
+    {
+        std::shared_ptr<LocalPlayer> local_player = c.GetEntityManager()->GetLocalPlayer();
+        int haste;
+        int mining_fatigue;
+        bool on_ground;
+        {
+            std::lock_guard<std::mutex> lock(local_player->GetMutex());
+            haste = local_player->GetEffectLevel(EffectType::Haste);
+            mining_fatigue = local_player->GetEffectLevel(EffectType::MiningFatigue);
+            on_ground = local_player->GetOnGround();
+        }
+
+        return DigTimeTable::GetInstance().GetMiningTime(blockstate, GetToolInfo(item), GetEfficiencyLevel(item), haste, mining_fatigue, on_ground);
+    }
+
+    /// @brief Get the survival time needed to break a block with the held item, 0 in creative
+    static float GetMiningTimeInHand(BehaviourClient& c, const Blockstate* blockstate)
+    {
+        if (c.GetCreativeMode())
+        {
+            return 0.0f;
+        }
+
+        std::shared_ptr<InventoryManager> inventory_manager = c.GetInventoryManager();
+        Slot item_in_hand;
+        {
+            std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
+            item_in_hand = inventory_manager->GetHotbarSelected();
+        }
+        return GetMiningTime(c, blockstate, item_in_hand);
+    }
+
+    /// @return The interaction sequence id sent (0 before 1.19)
+    static const int SendDiggingAction(BehaviourClient& c, const PlayerDiggingStatus status, const Position& pos, const PlayerDiggingFace face)
+    {
+        std::shared_ptr<ServerboundPlayerActionPacket> msg_digging = std::make_shared<ServerboundPlayerActionPacket>();
+        msg_digging->SetAction(static_cast<int>(status));
+        msg_digging->SetPos(pos.ToNetworkPosition());
+        msg_digging->SetDirection(static_cast<int>(face));
+        int sequence_id = 0;
+#if PROTOCOL_VERSION > 758
+        {
+            std::shared_ptr<World> world = c.GetWorld();
+            std::lock_guard<std::mutex> world_guard(world->GetMutex());
+            sequence_id = world->GetNextWorldInteractionSequenceId();
+            msg_digging->SetSequence(sequence_id);
+            // Remove the block right away, it will be rolled back if the server refuses it
+            if (status == PlayerDiggingStatus::FinishDigging)
+            {
+                world->PredictBlockChange(pos, 0, sequence_id);
+            }
+        }
+#endif
+        c.GetNetworkManager()->Send(msg_digging);
+        return sequence_id;
+    }
+
     Status Dig(BehaviourClient& c, const Position& pos, const bool send_swing, const PlayerDiggingFace face, const float mining_time)
     {
         std::shared_ptr<LocalPlayer> local_player = c.GetEntityManager()->GetLocalPlayer();
@@ -36,8 +103,8 @@ namespace Botcraft
         std::shared_ptr<World> world = c.GetWorld();
         const Blockstate* blockstate;
         {
-            std::lock_guard<std::mutex> world_guard(world->GetMutex());
-            const Block* block = world->GetBlock(pos);
+            const WorldSnapshot world_snapshot = world->GetSnapshot();
+            const Block* block = world_snapshot.GetBlock(pos);
 
             // No block
             if (!block || block->GetBlockstate()->IsAir())
@@ -63,41 +130,31 @@ namespace Botcraft
         // TODO check line of sight
 
         std::shared_ptr<NetworkManager> network_manager = c.GetNetworkManager();
-        std::shared_ptr<ServerboundPlayerActionPacket> msg_digging = std::make_shared<ServerboundPlayerActionPacket>();
-        msg_digging->SetAction((int)PlayerDiggingStatus::StartDigging);
-        msg_digging->SetPos(pos.ToNetworkPosition());
-        msg_digging->SetDirection((int)face);
-#if PROTOCOL_VERSION > 758
-        {
-            std::lock_guard<std::mutex> world_guard(world->GetMutex());
-            msg_digging->SetSequence(world->GetNextWorldInteractionSequenceId());
-        }
-#endif
-        network_manager->Send(msg_digging);
+        SendDiggingAction(c, PlayerDiggingStatus::StartDigging, pos, face);
 
         std::shared_ptr<ServerboundSwingPacket> swing_packet;
-        std::chrono::steady_clock::time_point last_time_send_swing;
+        VirtualClock::time_point last_time_send_swing;
         if (send_swing)
         {
            swing_packet = std::make_shared<ServerboundSwingPacket>();
            swing_packet->SetHand(static_cast<int>(Hand::Right));
            network_manager->Send(swing_packet);
-           last_time_send_swing = std::chrono::steady_clock::now();
+           last_time_send_swing = VirtualClock::now();
         }
 
-        // TODO, check tools and stuff
-        const long long int expected_mining_time = 1000.0f * (mining_time < 0.0f ? (c.GetCreativeMode() ? 0.0f : 5.0f * blockstate->GetHardness()) : mining_time);
+        const long long int expected_mining_time = static_cast<long long int>(1000.0f * (mining_time < 0.0f ? GetMiningTimeInHand(c, blockstate) : mining_time));
 
         if (expected_mining_time > 60000)
         {
             LOG_INFO("Starting an expected " << expected_mining_time / 1000.0f << " seconds long mining at " << pos << ".A little help?");
         }
 
-        auto start = std::chrono::steady_clock::now();
+        auto start = VirtualClock::now();
         bool finished_sent = false;
+        int finish_sequence_id = 0;
         while (true)
         {
-            auto now = std::chrono::steady_clock::now();
+            auto now = VirtualClock::now();
             long long int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
             if (elapsed > 5000 + expected_mining_time)
             {
@@ -107,17 +164,7 @@ namespace Botcraft
             if (elapsed >= expected_mining_time
                 && !finished_sent)
             {
-                std::shared_ptr<ServerboundPlayerActionPacket> msg_finish(new ServerboundPlayerActionPacket);
-                msg_finish->SetAction((int)PlayerDiggingStatus::FinishDigging);
-                msg_finish->SetPos(pos.ToNetworkPosition());
-                msg_finish->SetDirection((int)face);
-#if PROTOCOL_VERSION > 758
-                {
-                    std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                    msg_finish->SetSequence(world->GetNextWorldInteractionSequenceId());
-                }
-#endif
-                network_manager->Send(msg_finish);
+                finish_sequence_id = SendDiggingAction(c, PlayerDiggingStatus::FinishDigging, pos, face);
 
                 finished_sent = true;
             }
@@ -126,16 +173,37 @@ namespace Botcraft
                 last_time_send_swing = now;
                 network_manager->Send(swing_packet);
             }
-            {
-                std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                const Block* block = world->GetBlock(pos);
 
-                if (!block || block->GetBlockstate()->IsAir())
+            // Sleep until the block is broken or there is something else to do
+            long long int wait_ms = 5000 + expected_mining_time - elapsed;
+            if (!finished_sent)
+            {
+                wait_ms = std::min(wait_ms, expected_mining_time - elapsed);
+                if (send_swing)
                 {
-                    return Status::Success;
+                    wait_ms = std::min(wait_ms, 250 - static_cast<long long int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time_send_swing).count()));
                 }
             }
-            c.Yield();
+            if (c.WaitFor(EventType::BlockChanged, [&]()
+                {
+#if PROTOCOL_VERSION > 758
+                    // Don't trust the predicted air, wait for the server answer
+                    if (finished_sent)
+                    {
+                        std::lock_guard<std::mutex> world_guard(world->GetMutex());
+                        if (world->GetLastAcknowledgedSequenceId() < finish_sequence_id)
+                        {
+                            return false;
+                        }
+                    }
+#endif
+                    const WorldSnapshot world_snapshot = world->GetSnapshot();
+                    const Block* block = world_snapshot.GetBlock(pos);
+                    return !block || block->GetBlockstate()->IsAir();
+                }, static_cast<int>(std::max(wait_ms, 1LL))))
+            {
+                return Status::Success;
+            }
         }
 
         return Status::Success;
@@ -162,4 +230,276 @@ namespace Botcraft
 
         return Dig(c, pos, send_swing, face, mining_time);
     }
+
+    Status DigMany(BehaviourClient& c, const std::vector<Position>& positions, const bool send_swing, const PlayerDiggingFace face)
+    {
+        // Time to wait for a block to disappear after finishing
+        // digging it before considering the server refused it
+        static constexpr long long int confirmation_timeout_ms = 5000;
+        // Number of times we try to dig the same block
+        static constexpr int max_attempts = 2;
+
+        struct PendingDig
+        {
+            Position pos;
+            int attempts;
+            VirtualClock::time_point finish_time;
+        };
+
+        std::shared_ptr<World> world = c.GetWorld();
+        std::shared_ptr<NetworkManager> network_manager = c.GetNetworkManager();
+        std::shared_ptr<LocalPlayer> local_player = c.GetEntityManager()->GetLocalPlayer();
+
+        std::deque<std::pair<Position, int> > to_dig;
+        for (const auto& p : positions)
+        {
+            to_dig.push_back({ p, 1 });
+        }
+        std::vector<PendingDig> pending;
+
+        const auto is_broken = [&](const WorldSnapshot& world_snapshot, const Position& pos)
+        {
+            const Block* block = world_snapshot.GetBlock(pos);
+            return !block || block->GetBlockstate()->IsAir();
+        };
+
+        while (!to_dig.empty() || !pending.empty())
+        {
+            // Check the blocks we finished digging without waiting for them
+            {
+                const auto now = VirtualClock::now();
+                const WorldSnapshot world_snapshot = world->GetSnapshot();
+                for (size_t i = 0; i < pending.size(); )
+                {
+                    if (is_broken(world_snapshot, pending[i].pos))
+                    {
+                        pending.erase(pending.begin() + i);
+                        continue;
+                    }
+                    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - pending[i].finish_time).count() > confirmation_timeout_ms)
+                    {
+                        if (pending[i].attempts >= max_attempts)
+                        {
+                            LOG_WARNING("Something went wrong waiting block breaking confirmation at " << pending[i].pos << " (Timeout).");
+                            return Status::Failure;
+                        }
+                        // The server didn't break it, try again later
+                        to_dig.push_back({ pending[i].pos, pending[i].attempts + 1 });
+                        pending.erase(pending.begin() + i);
+                        continue;
+                    }
+                    ++i;
+                }
+            }
+
+            // Nothing more to dig, wait for the confirmations
+            if (to_dig.empty())
+            {
+                if (pending.empty())
+                {
+                    break;
+                }
+                const long long int wait_ms = confirmation_timeout_ms + 1 - std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now() - pending.front().finish_time).count();
+                c.WaitFor(EventType::BlockChanged, [&]()
+                    {
+                        const WorldSnapshot world_snapshot = world->GetSnapshot();
+                        return std::all_of(pending.begin(), pending.end(), [&](const PendingDig& p) { return is_broken(world_snapshot, p.pos); });
+                    }, static_cast<int>(std::max(wait_ms, 1LL)));
+                continue;
+            }
+
+            const Position pos = to_dig.front().first;
+            const int attempts = to_dig.front().second;
+            to_dig.pop_front();
+
+            Vector3<double> player_pos;
+            {
+                std::lock_guard<std::mutex> lock(local_player->GetMutex());
+                player_pos = local_player->GetPosition();
+            }
+            player_pos.y += 1.0;
+
+            if (player_pos.SqrDist(Vector3<double>(0.5, 0.5, 0.5) + pos) > 20.0f)
+            {
+                if (GoTo(c, pos, 4) == Status::Failure)
+                {
+                    return Status::Failure;
+                }
+            }
+
+            const Blockstate* blockstate;
+            {
+                const WorldSnapshot world_snapshot = world->GetSnapshot();
+                if (is_broken(world_snapshot, pos))
+                {
+                    continue;
+                }
+                blockstate = world_snapshot.GetBlock(pos)->GetBlockstate();
+            }
+
+            // Not breakable
+            if (blockstate->IsFluid() ||
+                blockstate->GetHardness() == -1.0f)
+            {
+                return Status::Failure;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(local_player->GetMutex());
+                local_player->LookAt(Vector3<double>(0.5, 0.5, 0.5) + pos, true);
+            }
+
+            SendDiggingAction(c, PlayerDiggingStatus::StartDigging, pos, face);
+
+            std::shared_ptr<ServerboundSwingPacket> swing_packet;
+            VirtualClock::time_point last_time_send_swing;
+            if (send_swing)
+            {
+                swing_packet = std::make_shared<ServerboundSwingPacket>();
+                swing_packet->SetHand(static_cast<int>(Hand::Right));
+                network_manager->Send(swing_packet);
+                last_time_send_swing = VirtualClock::now();
+            }
+
+            const long long int expected_mining_time = static_cast<long long int>(1000.0f * GetMiningTimeInHand(c, blockstate));
+            const auto start = VirtualClock::now();
+            bool broken = false;
+            while (true)
+            {
+                const auto now = VirtualClock::now();
+                const long long int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+                if (elapsed >= expected_mining_time)
+                {
+                    break;
+                }
+                if (send_swing && std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time_send_swing).count() > 250)
+                {
+                    last_time_send_swing = now;
+                    network_manager->Send(swing_packet);
+                }
+
+                long long int wait_ms = expected_mining_time - elapsed;
+                if (send_swing)
+                {
+                    wait_ms = std::min(wait_ms, 250 - static_cast<long long int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time_send_swing).count()));
+                }
+                // Stop early if something else broke the block
+                if (c.WaitFor(EventType::BlockChanged, [&]()
+                    {
+                        return is_broken(world->GetSnapshot(), pos);
+                    }, static_cast<int>(std::max(wait_ms, 1LL))))
+                {
+                    broken = true;
+                    break;
+                }
+            }
+
+            if (broken)
+            {
+                continue;
+            }
+
+            // Don't wait for the block update, start the next one right away
+            SendDiggingAction(c, PlayerDiggingStatus::FinishDigging, pos, face);
+            pending.push_back({ pos, attempts, VirtualClock::now() });
+        }
+
+        return Status::Success;
+    }
+
+    Status DigManyBlackboard(BehaviourClient& c)
+    {
+        const std::vector<std::string> variable_names = {
+            "DigMany.positions",
+            "DigMany.send_swing",
+            "DigMany.face"
+        };
+
+        Blackboard& blackboard = c.GetBlackboard();
+
+        // Mandatory
+        const std::vector<Position>& positions = blackboard.Get<std::vector<Position> >(variable_names[0]);
+
+        // Optional
+        const bool send_swing = blackboard.Get<bool>(variable_names[1], false);
+        const PlayerDiggingFace face = blackboard.Get<PlayerDiggingFace>(variable_names[2], PlayerDiggingFace::Up);
+
+        return DigMany(c, positions, send_swing, face);
+    }
+
+    Status SetBestToolInHand(BehaviourClient& c, const Position& pos)
+    {
+        const Blockstate* blockstate;
+        {
+            const WorldSnapshot world_snapshot = c.GetWorld()->GetSnapshot();
+            const Block* block = world_snapshot.GetBlock(pos);
+
+            if (!block || block->GetBlockstate()->IsAir())
+            {
+                return Status::Success;
+            }
+            blockstate = block->GetBlockstate();
+        }
+
+        std::shared_ptr<InventoryManager> inventory_manager = c.GetInventoryManager();
+        std::array<Slot, 9> hotbar;
+        short selected;
+        {
+            std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
+            const std::shared_ptr<Window> inventory = inventory_manager->GetPlayerInventory();
+            if (!inventory)
+            {
+                return Status::Failure;
+            }
+            for (short i = 0; i < 9; ++i)
+            {
+                hotbar[i] = inventory->GetSlot(Window::INVENTORY_HOTBAR_START + i);
+            }
+            selected = inventory_manager->GetIndexHotbarSelected();
+        }
+
+        // Keep the current item if no other one is strictly faster
+        short best = selected;
+        float best_time = GetMiningTime(c, blockstate, hotbar[selected]);
+        for (short i = 0; i < 9; ++i)
+        {
+            const float time = GetMiningTime(c, blockstate, hotbar[i]);
+            if (time < best_time)
+            {
+                best = i;
+                best_time = time;
+            }
+        }
+
+        if (best == selected)
+        {
+            return Status::Success;
+        }
+
+        std::shared_ptr<ServerboundSetCarriedItemPacket> msg = std::make_shared<ServerboundSetCarriedItemPacket>();
+        msg->SetSlot(best);
+        c.GetNetworkManager()->Send(msg);
+
+        // The server doesn't confirm the change
+        {
+            std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
+            inventory_manager->SetHotbarSelected(best);
+        }
+
+        return Status::Success;
+    }
+
+    Status SetBestToolInHandBlackboard(BehaviourClient& c)
+    {
+        const std::vector<std::string> variable_names = {
+            "SetBestToolInHand.pos"
+        };
+
+        Blackboard& blackboard = c.GetBlackboard();
+
+        // Mandatory
+        const Position& pos = blackboard.Get<Position>(variable_names[0]);
+
+        return SetBestToolInHand(c, pos);
+    }
 }
\ No newline at end of file
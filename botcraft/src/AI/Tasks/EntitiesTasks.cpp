@@ -6,6 +6,7 @@
 #include "botcraft/Game/Entities/EntityManager.hpp"
 #include "botcraft/Game/Entities/entities/Entity.hpp"
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
+#include "botcraft/Game/Inventory/InventoryManager.hpp"
 
 #include "botcraft/Utilities/Logger.hpp"
 
@@ -36,11 +37,7 @@ namespace Botcraft
             std::lock_guard<std::mutex> lock(entity_manager->GetMutex());
             entity_position = entity->GetPosition();
         }
-        Vector3<double> position;
-        {
-            std::lock_guard<std::mutex> lock(local_player->GetMutex());
-            position = local_player->GetPosition();
-        }
+        Vector3<double> position = local_player->GetState().position;
 
         while (position.SqrDist(entity_position) > 16.0)
         {
@@ -49,8 +46,11 @@ namespace Botcraft
                 return Status::Failure;
             }
 
-            entity_position = entity->GetPosition();
-            position = local_player->GetPosition();
+            {
+                std::lock_guard<std::mutex> lock(entity_manager->GetMutex());
+                entity_position = entity->GetPosition();
+            }
+            position = local_player->GetState().position;
         }
         
         {
@@ -58,6 +58,15 @@ namespace Botcraft
             local_player->LookAt(entity_position + Vector3<double>(0, entity->GetHeight() / 2.0, 0), true);
         }
 
+#if PROTOCOL_VERSION > 451
+        // The offers the server sends after the interaction don't say which
+        // merchant they belong to, remember it to store them
+        if (entity->IsAbstractVillager())
+        {
+            client.GetInventoryManager()->SetNextMerchant(entity->GetUUID());
+        }
+#endif
+
         std::shared_ptr<NetworkManager> network_manager = client.GetNetworkManager();
         std::shared_ptr<ServerboundInteractPacket> msg_interact = std::make_shared<ServerboundInteractPacket>();
         msg_interact->SetEntityId(entity_id);
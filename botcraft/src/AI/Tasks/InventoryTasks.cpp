@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
 #include "botcraft/AI/Tasks/InventoryTasks.hpp"
 #include "botcraft/AI/Tasks/BaseTasks.hpp"
 #include "botcraft/AI/Tasks/PathfindingTask.hpp"
@@ -8,9 +12,11 @@
 #include "botcraft/Game/Inventory/Window.hpp"
 #include "botcraft/Game/Entities/EntityManager.hpp"
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
+#include "botcraft/Game/Entities/entities/Entity.hpp"
 #include "botcraft/Game/World/World.hpp"
 #include "botcraft/Network/NetworkManager.hpp"
 #include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
 
 using namespace ProtocolCraft;
 
@@ -32,28 +38,97 @@ namespace Botcraft
 
         // Wait for the click confirmation (versions < 1.17)
 #if PROTOCOL_VERSION < 755
-        auto start = std::chrono::steady_clock::now();
-        while (true)
-        {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= 10000)
+        TransactionState transaction_state = TransactionState::Waiting;
+        if (!client.WaitFor(EventType::TransactionUpdated, [&]()
             {
-                LOG_WARNING("Something went wrong trying to click slot (Timeout).");
-                return Status::Failure;
-            }
-            TransactionState transaction_state = inventory_manager->GetTransactionState(container_id, transaction_id);
-            if (transaction_state == TransactionState::Accepted)
+                transaction_state = inventory_manager->GetTransactionState(container_id, transaction_id);
+                return transaction_state != TransactionState::Waiting;
+            }, 10000))
+        {
+            LOG_WARNING("Something went wrong trying to click slot (Timeout).");
+            return Status::Failure;
+        }
+        // The transaction has been refused by the server
+        if (transaction_state == TransactionState::Refused)
+        {
+            return Status::Failure;
+        }
+#endif
+        return Status::Success;
+    }
+
+    /// @brief Send a click without waiting for the server confirmation, it's applied to the inventory right away
+    /// @return The id of the transaction
+    static const int SendOptimisticClick(BehaviourClient& client, const short container_id, const ContainerClick& click)
+    {
+        std::shared_ptr<ServerboundContainerClickPacket> click_window_msg = std::make_shared<ServerboundContainerClickPacket>();
+
+        click_window_msg->SetContainerId(container_id);
+        click_window_msg->SetSlotNum(click.slot_id);
+        click_window_msg->SetButtonNum(click.button_num);
+        click_window_msg->SetClickType(click.click_type);
+
+        return client.SendInventoryTransaction(click_window_msg, true);
+    }
+
+    /// @brief Wait for the server to confirm or refuse all the given transactions (versions < 1.17)
+    /// @return Success if they all have been accepted, Failure otherwise
+    static Status WaitForTransactions(BehaviourClient& client, const short container_id, const std::vector<int>& transaction_ids)
+    {
+#if PROTOCOL_VERSION < 755
+        std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
+
+        bool refused = false;
+        if (!client.WaitFor(EventType::TransactionUpdated, [&]()
             {
-                break;
-            }
-            // The transaction has been refused by the server
-            else if (transaction_state == TransactionState::Refused)
+                refused = false;
+                for (const int id : transaction_ids)
+                {
+                    const TransactionState state = inventory_manager->GetTransactionState(container_id, id);
+                    if (state == TransactionState::Waiting)
+                    {
+                        return false;
+                    }
+                    refused = refused || state == TransactionState::Refused;
+                }
+                return true;
+            }, 10000))
+        {
+            LOG_WARNING("Something went wrong trying to click slots (Timeout).");
+            return Status::Failure;
+        }
+        // At least one transaction has been refused by the server,
+        // it and all the following ones have been rolled back
+        if (refused)
+        {
+            return Status::Failure;
+        }
+#endif
+        return Status::Success;
+    }
+
+    Status ClickSlotsInContainer(BehaviourClient& client, const short container_id, const std::vector<ContainerClick>& clicks)
+    {
+        // Limit the number of clicks waiting for a confirmation,
+        // to avoid rolling back too many of them if one is refused
+        constexpr size_t max_clicks_in_flight = 16;
+
+        std::vector<int> transaction_ids;
+        transaction_ids.reserve(std::min(clicks.size(), max_clicks_in_flight));
+        for (size_t i = 0; i < clicks.size(); ++i)
+        {
+            transaction_ids.push_back(SendOptimisticClick(client, container_id, clicks[i]));
+
+            if (transaction_ids.size() == max_clicks_in_flight || i == clicks.size() - 1)
             {
-                return Status::Failure;
+                if (WaitForTransactions(client, container_id, transaction_ids) == Status::Failure)
+                {
+                    return Status::Failure;
+                }
+                transaction_ids.clear();
             }
-
-            client.Yield();
         }
-#endif
+
         return Status::Success;
     }
 
@@ -78,24 +153,15 @@ namespace Botcraft
 
     Status SwapItemsInContainer(BehaviourClient& client, const short container_id, const short first_slot, const short second_slot)
     {
-        // Left click on the first slot, transferring the slot to the cursor
-        if (ClickSlotInContainer(client, container_id, first_slot, 0, 0) == Status::Failure)
-        {
-            LOG_WARNING("Failed to swap items (first click)");
-            return Status::Failure;
-        }
-
-        // Left click on the second slot, transferring the cursor to the slot
-        if (ClickSlotInContainer(client, container_id, second_slot, 0, 0) == Status::Failure)
-        {
-            LOG_WARNING("Failed to swap items (second click)");
-            return Status::Failure;
-        }
-
-        // Left click on the first slot, transferring back the cursor to the slot
-        if (ClickSlotInContainer(client, container_id, first_slot, 0, 0) == Status::Failure)
+        // Left click on the first slot, transferring the slot to the cursor,
+        // then on the second one, transferring the cursor to the slot,
+        // then on the first one, transferring back the cursor to the slot
+        if (ClickSlotsInContainer(client, container_id, {
+                ContainerClick{ first_slot, 0, 0 },
+                ContainerClick{ second_slot, 0, 0 },
+                ContainerClick{ first_slot, 0, 0 } }) == Status::Failure)
         {
-            LOG_WARNING("Failed to swap items (third click)");
+            LOG_WARNING("Failed to swap items");
             return Status::Failure;
         }
 
@@ -174,25 +240,16 @@ namespace Botcraft
 
     Status PutOneItemInContainerSlot(BehaviourClient& client, const short container_id, const short source_slot, const short destination_slot)
     {
-
-        // Left click on the first slot, transferring the slot to the cursor
-        if (ClickSlotInContainer(client, container_id, source_slot, 0, 0) == Status::Failure)
-        {
-            LOG_WARNING("Failed to put one item in slot (first click)");
-            return Status::Failure;
-        }
-
-        // Right click on the second slot, transferring one item of the cursor to the slot
-        if (ClickSlotInContainer(client, container_id, destination_slot, 0, 1) == Status::Failure)
-        {
-            LOG_WARNING("Failed to put one item in slot (second click)");
-            return Status::Failure;
-        }
-
-        // Left click on the first slot, transferring back the cursor to the slot
-        if (ClickSlotInContainer(client, container_id, source_slot, 0, 0) == Status::Failure)
+        // Left click on the first slot, transferring the slot to the cursor,
+        // then right click on the second one, transferring one item of the
+        // cursor to the slot, then left click on the first one, transferring
+        // back the cursor to the slot
+        if (ClickSlotsInContainer(client, container_id, {
+                ContainerClick{ source_slot, 0, 0 },
+                ContainerClick{ destination_slot, 0, 1 },
+                ContainerClick{ source_slot, 0, 0 } }) == Status::Failure)
         {
-            LOG_WARNING("Failed to put one item in slot (third click)");
+            LOG_WARNING("Failed to put one item in slot");
             return Status::Failure;
         }
 
@@ -227,35 +284,30 @@ namespace Botcraft
 
             inventory_destination_slot_index = hand == Hand::Left ? Window::INVENTORY_OFFHAND_INDEX : (Window::INVENTORY_HOTBAR_START + inventory_manager->GetIndexHotbarSelected());
 
+            const auto item_id = AssetsManager::getInstance().GetItemID(item_name);
+
             // We need to check the inventory
             // If the currently selected item is the right one, just go for it
             const Slot& current_selected = hand == Hand::Left ? inventory_manager->GetOffHand() : inventory_manager->GetHotbarSelected();
             if (!current_selected.IsEmptySlot()
-#if PROTOCOL_VERSION < 347
-                && AssetsManager::getInstance().Items().at(current_selected.GetBlockID()).at(current_selected.GetItemDamage())->GetName() == item_name)
+#if PROTOCOL_VERSION < 350
+                && current_selected.GetBlockID() == item_id.first && current_selected.GetItemDamage() == item_id.second)
 #else
-                && AssetsManager::getInstance().Items().at(current_selected.GetItemID())->GetName() == item_name)
+                && current_selected.GetItemID() == item_id)
 #endif
             {
                 return Status::Success;
             }
 
             // Otherwise we need to find a slot with the given item
-            const std::map<short, Slot>& slots = inventory_manager->GetPlayerInventory()->GetSlots();
-            for (auto it = slots.begin(); it != slots.end(); ++it)
-            {
-                if (it->first >= Window::INVENTORY_STORAGE_START
-                    && it->first < Window::INVENTORY_OFFHAND_INDEX
-                    && !it->second.IsEmptySlot()
-#if PROTOCOL_VERSION < 347
-                    && AssetsManager::getInstance().Items().at(it->second.GetBlockID()).at(it->second.GetItemDamage())->GetName() == item_name)
+#if PROTOCOL_VERSION < 350
+            const short index = inventory_manager->GetPlayerInventory()->GetFirstSlotWithItem(item_id.first, item_id.second, Window::INVENTORY_STORAGE_START);
 #else
-                    && AssetsManager::getInstance().Items().at(it->second.GetItemID())->GetName() == item_name)
+            const short index = inventory_manager->GetPlayerInventory()->GetFirstSlotWithItem(item_id, Window::INVENTORY_STORAGE_START);
 #endif
-                {
-                    inventory_correct_slot_index = it->first;
-                    break;
-                }
+            if (index != -1 && index < Window::INVENTORY_OFFHAND_INDEX)
+            {
+                inventory_correct_slot_index = index;
             }
 
             // If there is no stack with the given item in the inventory
@@ -282,6 +334,31 @@ namespace Botcraft
         return SetItemInHand(client, item_name, hand);
     }
 
+#if PROTOCOL_VERSION > 758
+    /// @brief Get the blockstate predicted when placing a block item, the
+    /// first blockstate with the same name
+    /// @return The blockstate id, -1 if the item is not a block
+    static const int GetPlacedBlockstateId(const std::string& item_name)
+    {
+        static const std::unordered_map<std::string, int> placed_blockstates = []()
+        {
+            std::unordered_map<std::string, int> output;
+            for (const auto& b : AssetsManager::getInstance().Blockstates())
+            {
+                auto it = output.find(b.second->GetName());
+                if (it == output.end() || b.first < it->second)
+                {
+                    output[b.second->GetName()] = b.first;
+                }
+            }
+            return output;
+        }();
+
+        auto it = placed_blockstates.find(item_name);
+        return it == placed_blockstates.end() ? -1 : it->second;
+    }
+#endif
+
     Status PlaceBlock(BehaviourClient& client, const std::string& item_name, const Position& pos, const PlayerDiggingFace face, const bool wait_confirmation)
     {
         std::shared_ptr<World> world = client.GetWorld();
@@ -314,9 +391,8 @@ namespace Botcraft
 
         // Check if block is air
         {
-            std::lock_guard<std::mutex> world_guard(world->GetMutex());
-
-            const Block* block = world->GetBlock(pos);
+            const WorldSnapshot world_snapshot = world->GetSnapshot();
+            const Block* block = world_snapshot.GetBlock(pos);
 
             if (block && !block->GetBlockstate()->IsAir())
             {
@@ -329,14 +405,16 @@ namespace Botcraft
             const AABB this_box_collider = AABB(Vector3<double>(pos.x + 0.5, pos.y + 0.5, pos.z + 0.5), Vector3<double>(0.5, 0.5, 0.5));
 
             std::lock_guard<std::mutex> entity_manager_guard(entity_manager->GetMutex());
-            const std::unordered_map<int, std::shared_ptr<Entity> >& entities = entity_manager->GetEntities();
             // TODO, check entity type, xp orbs and items don't collide
-            for (auto it = entities.begin(); it != entities.end(); ++it)
+            if (!entity_manager->QueryAABB(this_box_collider).empty())
             {
-                if (this_box_collider.Collide(it->second->GetCollider()))
-                {
-                    return Status::Failure;
-                }
+                return Status::Failure;
+            }
+            // Local player is not in the entity manager spatial index
+            std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
+            if (this_box_collider.Collide(local_player->GetCollider()))
+            {
+                return Status::Failure;
             }
         }
 
@@ -395,9 +473,17 @@ namespace Botcraft
 #endif
         place_block_msg->SetHand((int)Hand::Right);
 #if PROTOCOL_VERSION > 758
+        int sequence_id = 0;
         {
+            const int predicted_blockstate_id = GetPlacedBlockstateId(item_name);
             std::lock_guard<std::mutex> world_guard(world->GetMutex());
-            place_block_msg->SetSequence(world->GetNextWorldInteractionSequenceId());
+            sequence_id = world->GetNextWorldInteractionSequenceId();
+            place_block_msg->SetSequence(sequence_id);
+            // Show the block right away, it will be rolled back if the server refuses it
+            if (predicted_blockstate_id != -1)
+            {
+                world->PredictBlockChange(pos, static_cast<unsigned int>(predicted_blockstate_id), sequence_id);
+            }
         }
 #endif
 
@@ -410,39 +496,36 @@ namespace Botcraft
             return Status::Success;
         }
 
-        bool is_block_ok = false;
-        bool is_slot_ok = false;
-        auto start = std::chrono::steady_clock::now();
-        while (!is_block_ok || !is_slot_ok)
-        {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= 3000)
-            {
-                LOG_WARNING('[' << network_manager->GetMyName() << "] Something went wrong waiting block placement confirmation at " << pos << " (Timeout).");
-                return Status::Failure;
-            }
-            if (!is_block_ok)
+        // Wait for the block update, then for the slot update
+        auto start = VirtualClock::now();
+        const bool is_block_ok = client.WaitFor(EventType::BlockChanged, [&]()
             {
-                std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                const Block* block = world->GetBlock(pos);
-
-                if (block && block->GetBlockstate()->GetName() == item_name)
+#if PROTOCOL_VERSION > 758
+                // The predicted block is already there, wait for the server answer
                 {
-                    is_block_ok = true;
+                    std::lock_guard<std::mutex> world_guard(world->GetMutex());
+                    if (world->GetLastAcknowledgedSequenceId() < sequence_id)
+                    {
+                        return false;
+                    }
                 }
-            }
-            if (!is_slot_ok)
+#endif
+                const WorldSnapshot world_snapshot = world->GetSnapshot();
+                const Block* block = world_snapshot.GetBlock(pos);
+                return block && block->GetBlockstate()->GetName() == item_name;
+            }, 3000);
+        const int remaining_ms = 3000 - static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now() - start).count());
+        const bool is_slot_ok = is_block_ok && client.WaitFor(EventType::InventoryChanged, [&]()
             {
                 std::lock_guard<std::mutex> inventory_lock(inventory_manager->GetMutex());
                 int new_num_item_in_hand = inventory_manager->GetPlayerInventory()->GetSlot(Window::INVENTORY_HOTBAR_START + inventory_manager->GetIndexHotbarSelected()).GetItemCount();
-                is_slot_ok = new_num_item_in_hand == num_item_in_hand - 1;
-            }
-
-            if (is_block_ok && is_slot_ok)
-            {
-                return Status::Success;
-            }
+                return new_num_item_in_hand == num_item_in_hand - 1;
+            }, remaining_ms);
 
-            client.Yield();
+        if (!is_block_ok || !is_slot_ok)
+        {
+            LOG_WARNING('[' << network_manager->GetMyName() << "] Something went wrong waiting block placement confirmation at " << pos << " (Timeout).");
+            return Status::Failure;
         }
 
         return Status::Success;
@@ -494,15 +577,10 @@ namespace Botcraft
             return Status::Success;
         }
 
-        auto start = std::chrono::steady_clock::now();
-        while (inventory_manager->GetOffHand().GetItemCount() == current_stack_size)
+        if (!client.WaitFor(EventType::InventoryChanged, [&]() { return inventory_manager->GetOffHand().GetItemCount() != current_stack_size; }, 3000))
         {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= 3000)
-            {
-                LOG_WARNING("Something went wrong trying to eat (Timeout).");
-                return Status::Failure;
-            }
-            client.Yield();
+            LOG_WARNING("Something went wrong trying to eat (Timeout).");
+            return Status::Failure;
         }
 
         return Status::Success;
@@ -527,6 +605,9 @@ namespace Botcraft
 
     Status OpenContainer(BehaviourClient& client, const Position& pos)
     {
+        // Remember the content of this container once opened
+        client.GetInventoryManager()->SetNextContainerPosition(pos);
+
         // Open the container
         if (InteractWithBlock(client, pos, PlayerDiggingFace::Up) == Status::Failure)
         {
@@ -536,15 +617,10 @@ namespace Botcraft
         std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
 
         // Wait for a window to be opened
-        auto start = std::chrono::steady_clock::now();
-        while (inventory_manager->GetFirstOpenedWindowId() == -1)
+        if (!client.WaitFor(EventType::WindowOpened, [&]() { return inventory_manager->GetFirstOpenedWindowId() != -1; }, 3000))
         {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= 3000)
-            {
-                LOG_WARNING("Something went wrong trying to open container (Timeout).");
-                return Status::Failure;
-            }
-            client.Yield();
+            LOG_WARNING("Something went wrong trying to open container (Timeout).");
+            return Status::Failure;
         }
 
         return Status::Success;
@@ -608,9 +684,10 @@ namespace Botcraft
         {
             std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
             output << "Cursor --> " << inventory_manager->GetCursor().Serialize().dump() << "\n";
-            for (const auto& s: inventory_manager->GetPlayerInventory()->GetSlots())
+            const std::vector<Slot>& slots = inventory_manager->GetPlayerInventory()->GetSlots();
+            for (size_t i = 0; i < slots.size(); ++i)
             {
-                output << s.first << " --> " << s.second.Serialize().dump() << "\n";
+                output << i << " --> " << slots[i].Serialize().dump() << "\n";
             }
         }
         LOG(output.str(), level);
@@ -637,11 +714,11 @@ namespace Botcraft
 
         // Make sure a trading window is opened and
         // possible trades are available
-        auto start = std::chrono::steady_clock::now();
+        auto start = VirtualClock::now();
         size_t num_trades = 0;
         do
         {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() > 5000)
+            if (std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now() - start).count() > 5000)
             {
                 LOG_WARNING("Something went wrong waiting trade opening (Timeout).");
                 return Status::Failure;
@@ -691,7 +768,7 @@ namespace Botcraft
 
             if (trade_index == -1)
             {
-                LOG_WARNING("Failed trading (this villager does not sell/buy " << AssetsManager::getInstance().Items().at(item_id)->GetName() << ")");
+                LOG_WARNING("Failed trading (this villager does not sell/buy " << AssetsManager::getInstance().GetItem(item_id)->GetName() << ")");
                 return Status::Failure;
             }
 
@@ -711,47 +788,30 @@ namespace Botcraft
 
         network_manager->Send(select_trade_msg);
 
-        start = std::chrono::steady_clock::now();
         // Wait until the output/input is set with the correct item
-        bool correct_items = false;
-        do
-        {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() > 5000)
-            {
-                LOG_WARNING("Something went wrong waiting trade selection (Timeout). Maybe an item was missing?");
-                return Status::Failure;
-            }
-
+        if (!client.WaitFor(EventType::InventoryChanged, [&]()
             {
                 std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
-                correct_items = (buy && trading_container->GetSlot(2).GetItemID() == item_id) ||
+                return (buy && trading_container->GetSlot(2).GetItemID() == item_id) ||
                     (!buy && !trading_container->GetSlot(2).IsEmptySlot()
                         && (trading_container->GetSlot(0).GetItemID() == item_id || trading_container->GetSlot(1).GetItemID() == item_id));
-            }
-            client.Yield();
-        } while (!correct_items);
+            }, 5000))
+        {
+            LOG_WARNING("Something went wrong waiting trade selection (Timeout). Maybe an item was missing?");
+            return Status::Failure;
+        }
 
         // Check we have at least one empty slot to get back input remainings + outputs
         std::vector<short> empty_slots(has_trade_second_item ? 3 : 2);
         int empty_slots_index = 0;
         {
             std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
-            for (const auto& s: trading_container->GetSlots())
+            const std::vector<short>& free_slots = trading_container->GetFreeSlots();
+            for (auto it = std::lower_bound(free_slots.begin(), free_slots.end(), trading_container->GetFirstPlayerInventorySlot());
+                it != free_slots.end() && empty_slots_index < empty_slots.size(); ++it)
             {
-                if (s.first < trading_container->GetFirstPlayerInventorySlot())
-                {
-                    continue;
-                }
-
-                if (s.second.IsEmptySlot())
-                {
-                    empty_slots[empty_slots_index] = s.first;
-                    empty_slots_index++;
-                    if (empty_slots_index == empty_slots.size())
-                    {
-                        break;
-                    }
-                }
+                empty_slots[empty_slots_index] = *it;
+                empty_slots_index++;
             }
         }
         if (empty_slots_index == 0)
@@ -780,24 +840,15 @@ namespace Botcraft
         }
 
         // Wait for the server to update the input slots
-        start = std::chrono::steady_clock::now();
-        while (true)
-        {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() > 5000)
-            {
-                LOG_WARNING("Something went wrong waiting trade input update (Timeout).");
-                return Status::Failure;
-            }
-
+        if (!client.WaitFor(EventType::InventoryChanged, [&]()
             {
                 std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
-                if ((input_slot_1.IsEmptySlot() || input_slot_1.GetItemCount() != trading_container->GetSlot(0).GetItemCount()) &&
-                    (input_slot_2.IsEmptySlot() || input_slot_2.GetItemCount() != trading_container->GetSlot(1).GetItemCount()))
-                {
-                    break;
-                }
-            }
-            client.Yield();
+                return (input_slot_1.IsEmptySlot() || input_slot_1.GetItemCount() != trading_container->GetSlot(0).GetItemCount()) &&
+                    (input_slot_2.IsEmptySlot() || input_slot_2.GetItemCount() != trading_container->GetSlot(1).GetItemCount());
+            }, 5000))
+        {
+            LOG_WARNING("Something went wrong waiting trade input update (Timeout).");
+            return Status::Failure;
         }
 
         // Get back the input remainings in the inventory
@@ -812,11 +863,7 @@ namespace Botcraft
 
         // If we are here, everything is fine (or should be),
         // remove 1 to the possible trade counter on the villager
-        {
-            std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
-            ProtocolCraft::Trade& trade = inventory_manager->GetAvailableTrade(trade_index);
-            trade.SetNumberOfTradesUses(trade.GetNumberOfTradesUses() + 1);
-        }
+        inventory_manager->UseAvailableTrade(trade_index);
 
         return Status::Success;
     }
@@ -867,6 +914,143 @@ namespace Botcraft
 
         return TradeName(client, item_name, buy, trade_id);
     }
+
+    Status SelectMerchant(BehaviourClient& client, const std::vector<int>& entity_ids, const int item_id, const bool buy, const std::string& blackboard_output)
+    {
+        // Villagers restock up to twice a day when they can work at
+        // their job site, a locked trade is worth a retry after that
+        constexpr long long restock_delay_ms = 5 * 60 * 1000;
+
+        std::shared_ptr<EntityManager> entity_manager = client.GetEntityManager();
+        std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
+
+        std::vector<std::pair<int, UUID>> candidates;
+        candidates.reserve(entity_ids.size());
+        {
+            std::lock_guard<std::mutex> lock(entity_manager->GetMutex());
+            for (const int id : entity_ids)
+            {
+                std::shared_ptr<Entity> entity = entity_manager->GetEntity(id);
+                if (entity)
+                {
+                    candidates.push_back({ id, entity->GetUUID() });
+                }
+            }
+        }
+
+        // 0: trade available, 1: unknown or maybe restocked
+        std::vector<int> best_ids;
+        int best_rank = 2;
+        {
+            std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
+            const std::map<UUID, MerchantOffers>& known_merchants = inventory_manager->GetKnownMerchants();
+            const auto now = VirtualClock::now();
+
+            for (const auto& c : candidates)
+            {
+                int rank = 1;
+                auto it = known_merchants.find(c.second);
+                if (it != known_merchants.end())
+                {
+                    const std::vector<ProtocolCraft::Trade>& offers = it->second.offers;
+                    auto trade = std::find_if(offers.begin(), offers.end(), [&](const ProtocolCraft::Trade& t)
+                        {
+                            return (buy && t.GetOutputItem().GetItemID() == item_id)
+                                || (!buy && t.GetInputItem1().GetItemID() == item_id);
+                        });
+                    if (trade == offers.end())
+                    {
+                        continue;
+                    }
+                    if (trade->GetNumberOfTradesUses() < trade->GetMaximumNumberOfTradeUses())
+                    {
+                        rank = 0;
+                    }
+                    else if (!it->second.can_restock ||
+                        std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.update_time).count() < restock_delay_ms)
+                    {
+                        continue;
+                    }
+                }
+
+                if (rank < best_rank)
+                {
+                    best_rank = rank;
+                    best_ids.clear();
+                }
+                if (rank == best_rank)
+                {
+                    best_ids.push_back(c.first);
+                }
+            }
+        }
+
+        if (best_ids.empty())
+        {
+            LOG_WARNING("No merchant available to trade " << AssetsManager::getInstance().GetItem(item_id)->GetName());
+            return Status::Failure;
+        }
+
+        int chosen_id = best_ids[0];
+        if (best_ids.size() > 1)
+        {
+            std::mt19937 random_engine(std::chrono::steady_clock::now().time_since_epoch().count());
+            chosen_id = best_ids[std::uniform_int_distribution<size_t>(0, best_ids.size() - 1)(random_engine)];
+        }
+
+        client.GetBlackboard().Set<int>(blackboard_output, chosen_id);
+
+        return Status::Success;
+    }
+
+    Status SelectMerchantBlackboard(BehaviourClient& client)
+    {
+        const std::vector<std::string> variable_names = {
+               "SelectMerchant.entity_ids", "SelectMerchant.item_id", "SelectMerchant.buy", "SelectMerchant.blackboard_output" };
+
+        Blackboard& blackboard = client.GetBlackboard();
+
+        // Mandatory
+        const std::vector<int>& entity_ids = blackboard.Get<std::vector<int>>(variable_names[0]);
+        const int item_id = blackboard.Get<int>(variable_names[1]);
+        const bool buy = blackboard.Get<bool>(variable_names[2]);
+
+        // Optional
+        const std::string blackboard_output = blackboard.Get<std::string>(variable_names[3], "InteractEntity.entity_id");
+
+        return SelectMerchant(client, entity_ids, item_id, buy, blackboard_output);
+    }
+
+    Status SelectMerchantName(BehaviourClient& client, const std::vector<int>& entity_ids, const std::string& item_name, const bool buy, const std::string& blackboard_output)
+    {
+        // Get item id corresponding to the name
+        const int item_id = AssetsManager::getInstance().GetItemID(item_name);
+        if (item_id < 0)
+        {
+            LOG_WARNING("Trying to select a merchant for an unknown item");
+            return Status::Failure;
+        }
+
+        return SelectMerchant(client, entity_ids, item_id, buy, blackboard_output);
+    }
+
+    Status SelectMerchantNameBlackboard(BehaviourClient& client)
+    {
+        const std::vector<std::string> variable_names = {
+               "SelectMerchantName.entity_ids", "SelectMerchantName.item_name", "SelectMerchantName.buy", "SelectMerchantName.blackboard_output" };
+
+        Blackboard& blackboard = client.GetBlackboard();
+
+        // Mandatory
+        const std::vector<int>& entity_ids = blackboard.Get<std::vector<int>>(variable_names[0]);
+        const std::string& item_name = blackboard.Get<std::string>(variable_names[1]);
+        const bool buy = blackboard.Get<bool>(variable_names[2]);
+
+        // Optional
+        const std::string blackboard_output = blackboard.Get<std::string>(variable_names[3], "InteractEntity.entity_id");
+
+        return SelectMerchantName(client, entity_ids, item_name, buy, blackboard_output);
+    }
 #endif
 
 #if PROTOCOL_VERSION < 350
@@ -917,20 +1101,16 @@ namespace Botcraft
         // If we need a crafting table, make sure one is open
         if (!use_inventory_craft)
         {
-            auto start = std::chrono::steady_clock::now();
-            do
-            {
-                if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() > 5000)
-                {
-                    LOG_WARNING("Something went wrong waiting craft opening (Timeout).");
-                    return Status::Failure;
-                }
+            if (!client.WaitFor(EventType::WindowOpened, [&]()
                 {
                     std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
                     crafting_container_id = inventory_manager->GetFirstOpenedWindowId();
-                }
-                client.Yield();
-            } while (crafting_container_id == -1);
+                    return crafting_container_id != -1;
+                }, 5000))
+            {
+                LOG_WARNING("Something went wrong waiting craft opening (Timeout).");
+                return Status::Failure;
+            }
         }
         else
         {
@@ -950,6 +1130,7 @@ namespace Botcraft
         }
 
         Slot output_slot_before;
+        std::vector<int> transaction_ids;
         // For each input slot
         for (int y = min_y; y < max_y + 1; ++y)
         {
@@ -969,90 +1150,56 @@ namespace Botcraft
                 // Search for the required item in inventory
                 {
                     std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
-                    for (const auto& s : crafting_container->GetSlots())
-                    {
-                        if (s.first < crafting_container->GetFirstPlayerInventorySlot())
-                        {
-                            continue;
-                        }
 #if PROTOCOL_VERSION < 350
-                        if (s.second.GetBlockID() == inputs[y][x].first && s.second.GetItemDamage() == inputs[y][x].second)
+                    source_slot = crafting_container->GetFirstSlotWithItem(inputs[y][x].first, inputs[y][x].second, crafting_container->GetFirstPlayerInventorySlot());
 #else
-                        if (s.second.GetItemID() == inputs[y][x])
+                    source_slot = crafting_container->GetFirstSlotWithItem(inputs[y][x], crafting_container->GetFirstPlayerInventorySlot());
 #endif
-                        {
-                            source_slot = s.first;
-                            source_quantity = s.second.GetItemCount();
-                            break;
-                        }
+                    if (source_slot != -1)
+                    {
+                        source_quantity = crafting_container->GetSlot(source_slot).GetItemCount();
                     }
                 }
 
                 if (source_slot == -1)
                 {
 #if PROTOCOL_VERSION < 350
-                    LOG_WARNING("Not enough source item [" << AssetsManager::getInstance().Items().at(inputs[y][x].first).at(inputs[y][x].second)->GetName() << "] found in inventory for crafting.");
-#else
-                    LOG_WARNING("Not enough source item [" << AssetsManager::getInstance().Items().at(inputs[y][x])->GetName() << "] found in inventory for crafting.");
-#endif
-                    return Status::Failure;
-                }
-
-                if (ClickSlotInContainer(client, crafting_container_id, source_slot, 0, 0) == Status::Failure)
-                {
-#if PROTOCOL_VERSION < 350
-                    LOG_WARNING("Error trying to pick source item [" << AssetsManager::getInstance().Items().at(inputs[y][x].first).at(inputs[y][x].second)->GetName() << "] during crafting");
+                    LOG_WARNING("Not enough source item [" << AssetsManager::getInstance().GetItem(inputs[y][x].first, inputs[y][x].second)->GetName() << "] found in inventory for crafting.");
 #else
-                    LOG_WARNING("Error trying to pick source item [" << AssetsManager::getInstance().Items().at(inputs[y][x])->GetName() << "] during crafting");
+                    LOG_WARNING("Not enough source item [" << AssetsManager::getInstance().GetItem(inputs[y][x])->GetName() << "] found in inventory for crafting.");
 #endif
                     return Status::Failure;
                 }
 
-                // Right click in the destination slot
-                if (ClickSlotInContainer(client, crafting_container_id, destination_slot, 0, 1) == Status::Failure)
-                {
-#if PROTOCOL_VERSION < 350
-                    LOG_WARNING("Error trying to place source item [" << AssetsManager::getInstance().Items().at(inputs[y][x].first).at(inputs[y][x].second)->GetName() << "] during crafting");
-#else
-                    LOG_WARNING("Error trying to place source item [" << AssetsManager::getInstance().Items().at(inputs[y][x])->GetName() << "] during crafting");
-#endif
-                    return Status::Failure;
-                }
-
-                // Put back the remaining items in the origin slot
+                // Pick the source item, right click in the destination slot
+                // and put back the remaining items in the origin slot.
+                // Clicks are applied locally when sent, so the next slot search
+                // already sees them and all of them can be sent without waiting
+                transaction_ids.push_back(SendOptimisticClick(client, crafting_container_id, ContainerClick{ static_cast<short>(source_slot), 0, 0 }));
+                transaction_ids.push_back(SendOptimisticClick(client, crafting_container_id, ContainerClick{ static_cast<short>(destination_slot), 0, 1 }));
                 if (source_quantity > 1)
                 {
-                    if (ClickSlotInContainer(client, crafting_container_id, source_slot, 0, 0) == Status::Failure)
-                    {
-#if PROTOCOL_VERSION < 350
-                        LOG_WARNING("Error trying to place back source item [" << AssetsManager::getInstance().Items().at(inputs[y][x].first).at(inputs[y][x].second)->GetName() << "] during crafting");
-#else
-                        LOG_WARNING("Error trying to place back source item [" << AssetsManager::getInstance().Items().at(inputs[y][x])->GetName() << "] during crafting");
-#endif
-                        return Status::Failure;
-                    }
+                    transaction_ids.push_back(SendOptimisticClick(client, crafting_container_id, ContainerClick{ static_cast<short>(source_slot), 0, 0 }));
                 }
             }
         }
 
+        if (WaitForTransactions(client, crafting_container_id, transaction_ids) == Status::Failure)
+        {
+            LOG_WARNING("Error trying to place source items during crafting");
+            return Status::Failure;
+        }
+
         // Wait for the server to send the output change
         // TODO: with the recipe book, we could know without waiting
-        auto start = std::chrono::steady_clock::now();
-        while (true)
-        {
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() > 5000)
-            {
-                LOG_WARNING("Something went wrong waiting craft output update (Timeout).");
-                return Status::Failure;
-            }
+        if (!client.WaitFor(EventType::InventoryChanged, [&]()
             {
                 std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
-                if (!crafting_container->GetSlot(0).SameItem(output_slot_before))
-                {
-                    break;
-                }
-            }
-            client.Yield();
+                return !crafting_container->GetSlot(0).SameItem(output_slot_before);
+            }, 5000))
+        {
+            LOG_WARNING("Something went wrong waiting craft output update (Timeout).");
+            return Status::Failure;
         }
 
         // All inputs are in place, output is ready, click on output
@@ -1066,26 +1213,36 @@ namespace Botcraft
         int destination_slot = -999;
         {
             std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
-            for (const auto& s : crafting_container->GetSlots())
+            const short start = use_inventory_craft ? Window::INVENTORY_STORAGE_START : crafting_container->GetFirstPlayerInventorySlot();
+            const Slot& cursor = inventory_manager->GetCursor();
+
+            // First slot where it fits (empty or with the same item)
+            const short free_slot = crafting_container->GetFirstFreeSlot(start);
+            if (free_slot != -1)
+            {
+                destination_slot = free_slot;
+            }
+#if PROTOCOL_VERSION < 350
+            for (const short index : crafting_container->GetSlotsWithItem(cursor.GetBlockID(), cursor.GetItemDamage()))
+#else
+            for (const short index : crafting_container->GetSlotsWithItem(cursor.GetItemID()))
+#endif
             {
-                if (s.first < (use_inventory_craft ? Window::INVENTORY_STORAGE_START : crafting_container->GetFirstPlayerInventorySlot()))
+                if (index < start)
                 {
                     continue;
                 }
-
-                // If it fits in a slot (empty or with the same item)
-                if (s.second.IsEmptySlot() ||
+                if (destination_slot != -999 && index > destination_slot)
+                {
+                    break;
+                }
 #if PROTOCOL_VERSION < 347
-                    (inventory_manager->GetCursor().GetBlockID() == s.second.GetBlockID()
-                        && inventory_manager->GetCursor().GetItemDamage() == s.second.GetItemDamage()
-                        && s.second.GetItemCount() < AssetsManager::getInstance().Items().at(s.second.GetBlockID()).at(s.second.GetItemDamage())->GetStackSize() - 1)
+                if (crafting_container->GetSlot(index).GetItemCount() < AssetsManager::getInstance().GetItem(cursor.GetBlockID(), cursor.GetItemDamage())->GetStackSize() - 1)
 #else
-                    (inventory_manager->GetCursor().GetItemID() == s.second.GetItemID() &&
-                        s.second.GetItemCount() < AssetsManager::getInstance().Items().at(s.second.GetItemID())->GetStackSize() - 1)
+                if (crafting_container->GetSlot(index).GetItemCount() < AssetsManager::getInstance().GetItem(cursor.GetItemID())->GetStackSize() - 1)
 #endif
-                    )
                 {
-                    destination_slot = s.first;
+                    destination_slot = index;
                     break;
                 }
             }
@@ -1167,33 +1324,113 @@ namespace Botcraft
         return CraftNamed(client, inputs, allow_inventory_craft);
     }
 
-    Status HasItemInInventory(BehaviourClient& client, const std::string& item_name, const int quantity)
+#if PROTOCOL_VERSION > 347
+    Status CraftItem(BehaviourClient& client, const std::string& item_name, const int quantity, const bool allow_inventory_craft)
     {
         std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
 
-        const auto item_id = AssetsManager::getInstance().GetItemID(item_name);
+        const int item_id = AssetsManager::getInstance().GetItemID(item_name);
+        if (item_id < 0)
+        {
+            LOG_WARNING("Trying to craft an unknown item");
+            return Status::Failure;
+        }
 
-        int quantity_sum = 0;
+        std::vector<CraftingStep> plan;
         {
-            std::lock_guard<std::mutex> lock_inventory_manager(inventory_manager->GetMutex());
-            for (const auto& s : inventory_manager->GetPlayerInventory()->GetSlots())
+            std::lock_guard<std::mutex> lock(inventory_manager->GetMutex());
+
+            // Count what we have, in the opened container if any
+            const short container_id = inventory_manager->GetFirstOpenedWindowId();
+            std::shared_ptr<Window> container = inventory_manager->GetWindow(container_id == -1 ? Window::PLAYER_INVENTORY_INDEX : container_id);
+            if (container == nullptr)
             {
-                if (s.first < Window::INVENTORY_STORAGE_START)
+                LOG_WARNING("Trying to craft without inventory");
+                return Status::Failure;
+            }
+            const short first_slot = container_id == -1 ? Window::INVENTORY_STORAGE_START : container->GetFirstPlayerInventorySlot();
+            std::unordered_map<int, int> available;
+            const std::vector<Slot>& slots = container->GetSlots();
+            for (size_t i = first_slot; i < slots.size(); ++i)
+            {
+                if (!slots[i].IsEmptySlot())
                 {
-                    continue;
+                    available[slots[i].GetItemID()] += slots[i].GetItemCount();
+                }
+            }
+
+#if PROTOCOL_VERSION < 452
+            // Crafting tables are opened as Default windows before 1.14
+            const bool crafting_table_opened = container_id != -1 && container->GetType() == InventoryType::Default;
+#else
+            const bool crafting_table_opened = container_id != -1 && container->GetType() == InventoryType::Crafting;
+#endif
+            if (!inventory_manager->GetRecipeBook().ComputePlan(item_id, quantity, available, crafting_table_opened, plan))
+            {
+                LOG_WARNING("Can't find a way to craft " << quantity << " " << item_name << " with the current inventory");
+                return Status::Failure;
+            }
+        }
+
+        for (const auto& step : plan)
+        {
+            for (int i = 0; i < step.count; ++i)
+            {
+                if (Craft(client, step.inputs, allow_inventory_craft) == Status::Failure)
+                {
+                    LOG_WARNING("Error trying to craft [" << AssetsManager::getInstance().GetItem(step.recipe->output_id)->GetName() << "] while crafting " << item_name);
+                    return Status::Failure;
                 }
+            }
+        }
+
+        return Status::Success;
+    }
+
+    Status CraftItemBlackboard(BehaviourClient& client)
+    {
+        const std::vector<std::string> variable_names = {
+               "CraftItem.item_name",
+               "CraftItem.quantity",
+               "CraftItem.allow_inventory_craft"
+        };
+
+        Blackboard& blackboard = client.GetBlackboard();
+
+        // Mandatory
+        const std::string& item_name = blackboard.Get<std::string>(variable_names[0]);
+
+        // Optional
+        const int quantity = blackboard.Get<int>(variable_names[1], 1);
+        const bool allow_inventory_craft = blackboard.Get<bool>(variable_names[2], true);
 
-                if (!s.second.IsEmptySlot() &&
+        return CraftItem(client, item_name, quantity, allow_inventory_craft);
+    }
+#endif
+
+    Status HasItemInInventory(BehaviourClient& client, const std::string& item_name, const int quantity)
+    {
+        std::shared_ptr<InventoryManager> inventory_manager = client.GetInventoryManager();
+
+        const auto item_id = AssetsManager::getInstance().GetItemID(item_name);
+
+        int quantity_sum = 0;
+        {
+            std::lock_guard<std::mutex> lock_inventory_manager(inventory_manager->GetMutex());
+            std::shared_ptr<Window> player_inventory = inventory_manager->GetPlayerInventory();
 #if PROTOCOL_VERSION < 350
-                    s.second.GetBlockID() == item_id.first && s.second.GetItemDamage() == item_id.second
+            for (const short index : player_inventory->GetSlotsWithItem(item_id.first, item_id.second))
 #else
-                    s.second.GetItemID() == item_id
+            for (const short index : player_inventory->GetSlotsWithItem(item_id))
 #endif
-                    )
+            {
+                if (index < Window::INVENTORY_STORAGE_START)
                 {
-                    quantity_sum += s.second.GetItemCount();
+                    continue;
                 }
 
+                quantity_sum += player_inventory->GetSlot(index).GetItemCount();
+
                 if (quantity_sum >= quantity)
                 {
                     return Status::Success;
@@ -1244,21 +1481,30 @@ namespace Botcraft
                     // check if "lower" slot with same items that
                     // could fit in it
 #if PROTOCOL_VERSION < 350
-                    const int available_space = AssetsManager::getInstance().Items().at(dst_slot.GetBlockID()).at(dst_slot.GetItemDamage())->GetStackSize() - dst_slot.GetItemCount();
+                    const int available_space = AssetsManager::getInstance().GetItem(dst_slot.GetBlockID(), dst_slot.GetItemDamage())->GetStackSize() - dst_slot.GetItemCount();
 #else
-                    const int available_space = AssetsManager::getInstance().Items().at(dst_slot.GetItemID())->GetStackSize() - dst_slot.GetItemCount();
+                    const int available_space = AssetsManager::getInstance().GetItem(dst_slot.GetItemID())->GetStackSize() - dst_slot.GetItemCount();
 #endif
                     if (available_space == 0)
                     {
                         continue;
                     }
 
-                    for (short j = Window::INVENTORY_STORAGE_START; j < i; ++j)
+#if PROTOCOL_VERSION < 350
+                    for (const short j : player_inventory->GetSlotsWithItem(dst_slot.GetBlockID(), dst_slot.GetItemDamage()))
+#else
+                    for (const short j : player_inventory->GetSlotsWithItem(dst_slot.GetItemID()))
+#endif
                     {
-                        const Slot& src_slot = player_inventory->GetSlot(j);
-                        if (!src_slot.IsEmptySlot()
-                            && dst_slot.SameItem(src_slot)
-                            && src_slot.GetItemCount() <= available_space)
+                        if (j < Window::INVENTORY_STORAGE_START)
+                        {
+                            continue;
+                        }
+                        if (j >= i)
+                        {
+                            break;
+                        }
+                        if (player_inventory->GetSlot(j).GetItemCount() <= available_space)
                         {
                             src_index = j;
                             break;
@@ -1,393 +1,2093 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "botcraft/AI/Tasks/PathfindingTask.hpp"
 #include "botcraft/AI/Blackboard.hpp"
+#include "botcraft/AI/PathSearchPool.hpp"
 
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
 #include "botcraft/Game/Entities/EntityManager.hpp"
+#include "botcraft/Game/PositionMap.hpp"
+#include "botcraft/Game/World/BlockAccessor.hpp"
 #include "botcraft/Game/World/World.hpp"
+#include "botcraft/Game/World/Section.hpp"
 #include "botcraft/Network/NetworkManager.hpp"
 
 #include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
 
 namespace Botcraft
 {
-    const std::vector<Position> FindPath(BehaviourClient& client, const Position& start, const Position& end, const int min_end_dist, const bool allow_jump)
+    /// @brief Node storage for the A* search. Nodes are stored in a flat
+    /// array with their cost and parent inline, found with an open-addressing
+    /// hash table, and the open set is an indexed binary heap supporting
+    /// decrease-key. Memory is kept between searches to avoid reallocations
+    class PathfindingArena
     {
-        struct PathNode
+    public:
+        struct Node
         {
             Position pos;
+            int parent;
+            float cost; // distance from start
             float score; // distance from start + heuristic to goal
-            PathNode(const Position& p, const float s)
+            int heap_index; // -1 if not in the open set
+        };
+
+        void Clear()
+        {
+            nodes.clear();
+            heap.clear();
+            if (slots.empty())
+            {
+                slots.resize(1 << 14);
+            }
+            std::fill(slots.begin(), slots.end(), -1);
+        }
+
+        const std::vector<Node>& GetNodes() const
+        {
+            return nodes;
+        }
+
+        const bool Empty() const
+        {
+            return heap.empty();
+        }
+
+        /// @brief Add a node if unknown, or update it if the new cost is lower
+        /// @return The index of the node
+        int Relax(const Position& pos, const int parent, const float cost, const float score)
+        {
+            size_t slot = FindSlot(pos);
+            int index = slots[slot];
+            if (index == -1)
+            {
+                index = static_cast<int>(nodes.size());
+                nodes.push_back({ pos, parent, cost, score, -1 });
+                slots[slot] = index;
+                // Keep the load factor under 0.5
+                if (nodes.size() * 2 > slots.size())
+                {
+                    Rehash();
+                }
+                Push(index);
+            }
+            else if (cost < nodes[index].cost)
+            {
+                nodes[index].parent = parent;
+                nodes[index].cost = cost;
+                nodes[index].score = score;
+                if (nodes[index].heap_index == -1)
+                {
+                    Push(index);
+                }
+                else
+                {
+                    SiftUp(nodes[index].heap_index);
+                }
+            }
+            return index;
+        }
+
+        /// @brief Remove the node with the lowest score from the open set
+        /// @return The index of the node
+        int Pop()
+        {
+            const int index = heap[0];
+            nodes[index].heap_index = -1;
+            const int last = heap.back();
+            heap.pop_back();
+            if (!heap.empty())
+            {
+                heap[0] = last;
+                nodes[last].heap_index = 0;
+                SiftDown(0);
+            }
+            return index;
+        }
+
+    private:
+        static size_t Hash(const Position& pos)
+        {
+            return PositionKey(pos).Hash();
+        }
+
+        size_t FindSlot(const Position& pos) const
+        {
+            const size_t mask = slots.size() - 1;
+            size_t slot = Hash(pos) & mask;
+            while (slots[slot] != -1 && nodes[slots[slot]].pos != pos)
+            {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void Rehash()
+        {
+            slots.assign(slots.size() * 2, -1);
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                slots[FindSlot(nodes[i].pos)] = static_cast<int>(i);
+            }
+        }
+
+        void Push(const int index)
+        {
+            nodes[index].heap_index = static_cast<int>(heap.size());
+            heap.push_back(index);
+            SiftUp(nodes[index].heap_index);
+        }
+
+        void SiftUp(int i)
+        {
+            const int index = heap[i];
+            while (i > 0)
+            {
+                const int parent = (i - 1) / 2;
+                if (nodes[heap[parent]].score <= nodes[index].score)
+                {
+                    break;
+                }
+                heap[i] = heap[parent];
+                nodes[heap[i]].heap_index = i;
+                i = parent;
+            }
+            heap[i] = index;
+            nodes[index].heap_index = i;
+        }
+
+        void SiftDown(int i)
+        {
+            const int index = heap[i];
+            const int size = static_cast<int>(heap.size());
+            while (true)
+            {
+                int child = 2 * i + 1;
+                if (child >= size)
+                {
+                    break;
+                }
+                if (child + 1 < size && nodes[heap[child + 1]].score < nodes[heap[child]].score)
+                {
+                    child++;
+                }
+                if (nodes[index].score <= nodes[heap[child]].score)
+                {
+                    break;
+                }
+                heap[i] = heap[child];
+                nodes[heap[i]].heap_index = i;
+                i = child;
+            }
+            heap[i] = index;
+            nodes[index].heap_index = i;
+        }
+
+    private:
+        std::vector<Node> nodes;
+        // Indices in nodes, -1 if empty
+        std::vector<int> slots;
+        // Indices in nodes
+        std::vector<int> heap;
+    };
+
+    /// @brief Per-search cache of the block flags used by the A* search.
+    /// Sections are scanned in bulk the first time one of their blocks is
+    /// required, then each lookup is a single array access. Memory is kept
+    /// between searches to avoid reallocations
+    class WalkabilityGrid
+    {
+    public:
+        enum Flags : unsigned char
+        {
+            None = 0,
+            Solid = 1 << 0,
+            Fluid = 1 << 1,
+            Water = 1 << 2
+        };
+
+        void Reset(const WorldSnapshot& snapshot_)
+        {
+            snapshot = &snapshot_;
+            section_indices.clear();
+            num_sections = 0;
+            last_section = nullptr;
+        }
+
+        /// @brief Get the flags of a block. Unloaded blocks have no flag
+        const unsigned char Get(const Position& pos)
+        {
+            const Position section_pos(pos.x >> 4, pos.y >> 4, pos.z >> 4);
+            if (last_section == nullptr || section_pos != last_section_pos)
+            {
+                last_section = GetSection(section_pos);
+                last_section_pos = section_pos;
+            }
+            return last_section[((pos.y & 0xF) * CHUNK_WIDTH + (pos.z & 0xF)) * CHUNK_WIDTH + (pos.x & 0xF)];
+        }
+
+    private:
+        const unsigned char* GetSection(const Position& section_pos)
+        {
+            auto it = section_indices.find(section_pos);
+            if (it != section_indices.end())
+            {
+                return sections[it->second].data();
+            }
+
+            if (num_sections == sections.size())
+            {
+                sections.emplace_back();
+            }
+            std::array<unsigned char, Section::NUM_BLOCKS>& flags = sections[num_sections];
+            section_indices[section_pos] = num_sections;
+            num_sections++;
+
+            const std::shared_ptr<const Chunk> chunk = snapshot->GetChunk(section_pos.x, section_pos.z);
+            const Section* section = chunk == nullptr ? nullptr :
+                chunk->GetSection((section_pos.y * SECTION_HEIGHT - chunk->GetMinY()) / SECTION_HEIGHT);
+            if (section == nullptr || section_pos.y * SECTION_HEIGHT < chunk->GetMinY())
+            {
+                flags.fill(None);
+                return flags.data();
+            }
+
+            // Compute the flags once for each palette entry
+            const std::deque<Block>& palette = section->GetPalette();
+            palette_flags.resize(palette.size());
+            for (size_t i = 0; i < palette.size(); ++i)
+            {
+                palette_flags[i] = (palette[i].HasFlag(BlockstateFlag::Solid) ? Solid : None) |
+                    (palette[i].HasFlag(BlockstateFlag::Fluid) ? Fluid : None) |
+                    (palette[i].HasFlag(BlockstateFlag::Water) ? Water : None);
+            }
+
+            if (section->IsSingleValue())
+            {
+                flags.fill(palette_flags[section->GetPaletteIndex(0)]);
+            }
+            else
+            {
+                for (int i = 0; i < Section::NUM_BLOCKS; ++i)
+                {
+                    flags[i] = palette_flags[section->GetPaletteIndex(i)];
+                }
+            }
+            return flags.data();
+        }
+
+    private:
+        const WorldSnapshot* snapshot = nullptr;
+
+        // Sections can be reused between searches, only the
+        // first num_sections are valid for the current one
+        std::vector<std::array<unsigned char, Section::NUM_BLOCKS> > sections;
+        size_t num_sections = 0;
+        std::unordered_map<Position, size_t> section_indices;
+        std::vector<unsigned char> palette_flags;
+
+        Position last_section_pos;
+        const unsigned char* last_section = nullptr;
+    };
+
+    /// @brief Call add_move for each position reachable in one move from pos
+    /// @param grid Walkability flags of the world
+    /// @param pos Starting position
+    /// @param allow_jump If true, allow to jump above 1-wide gaps
+    /// @param min_y Min y of the world, for long falls into water
+    /// @param add_move Callback taking the reached position and the cost of the move
+    template<class MoveCallback>
+    static void ForEachMove(WalkabilityGrid& grid, const Position& pos, const bool allow_jump, const int min_y, const MoveCallback& add_move)
+    {
+        const std::array<Position, 4> neighbour_offsets = { Position(1, 0, 0), Position(-1, 0, 0), Position(0, 0, 1), Position(0, 0, -1) };
+        // For each neighbour, check if it's reachable
+        // and add it to the search list if it is
+        for (int i = 0; i < neighbour_offsets.size(); ++i)
+        {
+            const Position next_location = pos + neighbour_offsets[i];
+            const Position next_next_location = next_location + neighbour_offsets[i];
+            // Get the state around the player in the given location
+            // True = solid, False = go through
+            std::array<bool, 13> surroundings = { false, false, false, false, false, false,
+                false, false, false, false, false, false, false };
+            // 0  1  7
+            // x  2  8
+            // x  3  9
+            //--- 4  10
+            //    5  11
+            //    6  12
+            bool is_in_fluid;
+            {
+                is_in_fluid = grid.Get(pos) & WalkabilityGrid::Fluid;
+                // In fluid, other fluid blocks can't be crossed
+                const unsigned char blocking = WalkabilityGrid::Solid | (is_in_fluid ? WalkabilityGrid::Fluid : WalkabilityGrid::None);
+
+                // Start with 2 because if 2 is solid, no pathfinding is possible
+                surroundings[2] = grid.Get(next_location + Position(0, 1, 0)) & blocking;
+                if (surroundings[2])
+                {
+                    continue;
+                }
+
+                surroundings[0] = grid.Get(pos + Position(0, 2, 0)) & blocking;
+
+                surroundings[1] = grid.Get(next_location + Position(0, 2, 0)) & blocking;
+                surroundings[3] = grid.Get(next_location) & blocking;
+                surroundings[4] = grid.Get(next_location + Position(0, -1, 0)) & blocking;
+                surroundings[5] = grid.Get(next_location + Position(0, -2, 0)) & blocking;
+                surroundings[6] = grid.Get(next_location + Position(0, -3, 0)) & blocking;
+
+                // You can't make large jumps if your feet are in fluid
+                if (allow_jump && !is_in_fluid)
+                {
+                    surroundings[7] = grid.Get(next_next_location + Position(0, 2, 0)) & WalkabilityGrid::Solid;
+                    surroundings[8] = grid.Get(next_next_location + Position(0, 1, 0)) & WalkabilityGrid::Solid;
+                    surroundings[9] = grid.Get(next_next_location) & WalkabilityGrid::Solid;
+                    surroundings[10] = grid.Get(next_next_location + Position(0, -1, 0)) & WalkabilityGrid::Solid;
+                    surroundings[11] = grid.Get(next_next_location + Position(0, -2, 0)) & WalkabilityGrid::Solid;
+                    surroundings[12] = grid.Get(next_next_location + Position(0, -3, 0)) & WalkabilityGrid::Solid;
+                }
+            }
+
+            // We can check all cases that could allow the bot to pass
+            //       ?
+            // x     ?
+            // x  o  ?
+            //--- ?  ?
+            //    ?  ?
+            //    ?  ?
+            if (!surroundings[0] && !surroundings[1]
+                && !surroundings[2] && surroundings[3])
+            {
+                const float move_cost = 2.0f;
+                const Position new_pos = next_location + Position(0, 1, 0);
+                add_move(new_pos, move_cost);
+            }
+
+            // ?  ?  ?
+            // x     ?
+            // x     ?
+            //--- o  ?
+            //    ?  ?
+            //    ?  ?
+            if (!surroundings[2] && !surroundings[3]
+                && surroundings[4])
+            {
+                const float move_cost = 1.0f;
+                add_move(next_location, move_cost);
+            }
+
+            // ?  ?  ?
+            // x     ? 
+            // x     ?
+            //---    ?
+            //    o  ?
+            //    ?  ?
+            if (!surroundings[2] && !surroundings[3]
+                && !surroundings[4] && surroundings[5])
+            {
+                const float move_cost = 2.0f;
+                const Position new_pos = next_location + Position(0, -1, 0);
+                add_move(new_pos, move_cost);
+            }
+
+            // ?  ?  ?
+            // x     ?
+            // x     ?
+            //---    ?
+            //       ?
+            //    o  ?
+            if (!surroundings[2] && !surroundings[3]
+                && !surroundings[4] && !surroundings[5]
+                && surroundings[6])
+            {
+                const float move_cost = 3.0f;
+                const Position new_pos = next_location + Position(0, -2, 0);
+                add_move(new_pos, move_cost);
+            }
+
+            // ?  ?  ?
+            // x     ?
+            // x     ?
+            //---    ?
+            //       ?
+            //       ?
+            // Special case here, we can drop down
+            // if there is some water at the bottom
+            if (!surroundings[2] && !surroundings[3]
+                && !surroundings[4] && !surroundings[5]
+                && !surroundings[6])
+            {
+                for (int y = -4; next_location.y + y >= min_y; --y)
+                {
+                    const unsigned char flags = grid.Get(next_location + Position(0, y, 0));
+
+                    if (flags & WalkabilityGrid::Solid)
+                    {
+                        break;
+                    }
+
+                    if (flags & WalkabilityGrid::Water)
+                    {
+                        const float move_cost = std::abs(y);
+                        const Position new_pos = next_location + Position(0, y + 1, 0);
+                        add_move(new_pos, move_cost);
+
+                        break;
+                    }
+                }
+            }
+
+            if (!allow_jump || is_in_fluid)
+            {
+                continue;
+            }
+
+            //        
+            // x      
+            // x     o
+            //---    ?
+            //    ?  ?
+            //    ?  ?
+            if (!surroundings[0] && !surroundings[1]
+                && !surroundings[2] && !surroundings[3]
+                && !surroundings[4] && !surroundings[7]
+                && !surroundings[8] && surroundings[9])
+            {
+                const float move_cost = 3.0f;
+                const Position new_pos = next_next_location + Position(0, 1, 0);
+                add_move(new_pos, move_cost);
+            }
+
+            //        
+            // x      
+            // x      
+            //---    o
+            //       ?
+            //    ?  ?
+            if (!surroundings[0] && !surroundings[1]
+                && !surroundings[2] && !surroundings[3]
+                && !surroundings[4] && !surroundings[5]
+                && !surroundings[7] && !surroundings[8]
+                && !surroundings[9] && surroundings[10])
+            {
+                const float move_cost = 3.0f;
+                add_move(next_next_location, move_cost);
+            }
+
+            //        
+            // x      
+            // x      
+            //---     
+            //       o
+            //    ?  ?
+            if (!surroundings[0] && !surroundings[1]
+                && !surroundings[2] && !surroundings[3]
+                && !surroundings[4] && !surroundings[5]
+                && !surroundings[7] && !surroundings[8]
+                && !surroundings[9] && !surroundings[10]
+                && surroundings[11])
+            {
+                const float move_cost = 4.0f;
+                const Position new_pos = next_next_location + Position(0, -1, 0);
+                add_move(new_pos, move_cost);
+            }
+
+            //        
+            // x      
+            // x      
+            //---     
+            //        
+            //    ?  o
+            if (!surroundings[0] && !surroundings[1]
+                && !surroundings[2] && !surroundings[3]
+                && !surroundings[4] && !surroundings[5]
+                && !surroundings[7] && !surroundings[8]
+                && !surroundings[9] && !surroundings[10]
+                && !surroundings[11] && surroundings[12])
+            {
+                const float move_cost = 5.0f;
+                const Position new_pos = next_next_location + Position(0, -2, 0);
+                add_move(new_pos, move_cost);
+            }
+        } // neighbour loop
+    }
+
+    /// @brief Cache of the complete paths found by FindPath. A cached path
+    /// is reused as long as all the chunks it goes through keep the same
+    /// blocks version
+    class PathCache
+    {
+    public:
+        static PathCache& GetInstance()
+        {
+            static PathCache instance;
+            return instance;
+        }
+
+        /// @brief Get a cached path still valid in a snapshot
+        /// @return True if a path was found
+        const bool Get(const World* world, const Position& start, const Position& end, const int min_end_dist, const bool allow_jump,
+            const WorldSnapshot& snapshot, std::vector<Position>& path)
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = entries.find(Key{ world, start, end, min_end_dist, allow_jump });
+            if (it == entries.end())
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < it->second.chunks.size(); ++i)
+            {
+                const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(it->second.chunks[i].first.first, it->second.chunks[i].first.second);
+                if (chunk == nullptr || chunk->GetBlocksVersion() != it->second.chunks[i].second)
+                {
+                    entries.erase(it);
+                    return false;
+                }
+            }
+
+            path = it->second.path;
+            return true;
+        }
+
+        /// @brief Add a path to the cache, with the versions of the chunks it goes through
+        void Add(const World* world, const Position& start, const Position& end, const int min_end_dist, const bool allow_jump,
+            const WorldSnapshot& snapshot, const std::vector<Position>& path)
+        {
+            Entry entry;
+            entry.path = path;
+            for (size_t i = 0; i <= path.size(); ++i)
+            {
+                const Position chunk_pos = Chunk::BlockCoordsToChunkCoords(i == 0 ? start : path[i - 1]);
+                const std::pair<int, int> coords(chunk_pos.x, chunk_pos.z);
+                if (std::find_if(entry.chunks.begin(), entry.chunks.end(),
+                    [&coords](const std::pair<std::pair<int, int>, unsigned long long>& c) { return c.first == coords; }) != entry.chunks.end())
+                {
+                    continue;
+                }
+                const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(coords.first, coords.second);
+                if (chunk == nullptr)
+                {
+                    return;
+                }
+                entry.chunks.push_back({ coords, chunk->GetBlocksVersion() });
+            }
+
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            // Simple bound on the memory used, frequent routes are added back quickly
+            if (entries.size() >= max_entries)
+            {
+                entries.clear();
+            }
+            entries[Key{ world, start, end, min_end_dist, allow_jump }] = std::move(entry);
+        }
+
+    private:
+        struct Key
+        {
+            const World* world;
+            Position start;
+            Position end;
+            int min_end_dist;
+            bool allow_jump;
+
+            bool operator==(const Key& other) const
+            {
+                return world == other.world && start == other.start && end == other.end &&
+                    min_end_dist == other.min_end_dist && allow_jump == other.allow_jump;
+            }
+        };
+
+        struct KeyHasher
+        {
+            size_t operator()(const Key& k) const
+            {
+                size_t value = std::hash<const World*>()(k.world);
+                value ^= std::hash<Position>()(k.start) + 0x9e3779b9 + (value << 6) + (value >> 2);
+                value ^= std::hash<Position>()(k.end) + 0x9e3779b9 + (value << 6) + (value >> 2);
+                value ^= std::hash<int>()(k.min_end_dist * 2 + k.allow_jump) + 0x9e3779b9 + (value << 6) + (value >> 2);
+                return value;
+            }
+        };
+
+        struct Entry
+        {
+            std::vector<Position> path;
+            // Chunk coordinates --> blocks version when the path was found
+            std::vector<std::pair<std::pair<int, int>, unsigned long long> > chunks;
+        };
+
+        static constexpr size_t max_entries = 4096;
+
+        std::mutex cache_mutex;
+        std::unordered_map<Key, Entry, KeyHasher> entries;
+    };
+
+    /// @brief Distances from a few landmarks to all the positions reachable
+    /// around them. For any landmark L, d(L, goal) <= d(L, n) + d(n, goal),
+    /// so d(L, goal) - d(L, n) is a lower bound of the distance from n to
+    /// the goal, much tighter than the manhattan distance around walls
+    struct LandmarkTable
+    {
+        std::vector<Position> landmarks;
+        int max_nodes = 0;
+        /// @brief Position --> offset of its distances in distances
+        PositionMap<size_t> offsets;
+        /// @brief landmarks.size() distances for each position, infinity if not reached
+        std::vector<float> distances;
+        /// @brief Chunk coordinates --> blocks version when the distances were computed
+        std::vector<std::pair<std::pair<int, int>, unsigned long long> > chunks;
+        VirtualClock::time_point computed;
+
+        /// @brief Get the distances from all the landmarks to a position
+        /// @return A pointer to landmarks.size() distances, nullptr if pos wasn't reached by any landmark
+        const float* Get(const Position& pos) const
+        {
+            const size_t* offset = offsets.Find(pos);
+            return offset == nullptr ? nullptr : distances.data() + *offset;
+        }
+    };
+
+    /// @brief Landmark tables used by FindPath, for each world. Tables
+    /// are computed again when blocks changed in the chunks they cover,
+    /// at most once every refresh_interval, as recomputing them costs much
+    /// more than a search. In between, outdated distances are still used:
+    /// paths are still found but may not be the shortest ones
+    class PathLandmarks
+    {
+    public:
+        static PathLandmarks& GetInstance()
+        {
+            static PathLandmarks* instance = new PathLandmarks();
+            return *instance;
+        }
+
+        void Set(const std::shared_ptr<World>& world, const std::vector<Position>& landmarks, const int max_nodes)
+        {
+            std::shared_ptr<LandmarkTable> table = Compute(world, landmarks, max_nodes);
+            std::lock_guard<std::mutex> lock(landmarks_mutex);
+            tables[world.get()] = table;
+        }
+
+        void Clear(const World* world)
+        {
+            std::lock_guard<std::mutex> lock(landmarks_mutex);
+            tables.erase(world);
+            refreshing.erase(world);
+        }
+
+        /// @brief Get the landmark table of a world, refreshing it first if it's outdated
+        /// @return The table, nullptr if no landmark is set for this world
+        std::shared_ptr<const LandmarkTable> Get(const std::shared_ptr<World>& world, const WorldSnapshot& snapshot)
+        {
+            std::shared_ptr<LandmarkTable> table;
+            {
+                std::lock_guard<std::mutex> lock(landmarks_mutex);
+                auto it = tables.find(world.get());
+                if (it == tables.end())
+                {
+                    return nullptr;
+                }
+                table = it->second;
+                if (VirtualClock::now() - table->computed < refresh_interval ||
+                    refreshing.count(world.get()) > 0 ||
+                    !IsOutdated(*table, snapshot))
+                {
+                    return table;
+                }
+                // Only one thread refreshes the table, the others keep using the old one
+                refreshing.insert(world.get());
+            }
+
+            std::shared_ptr<LandmarkTable> new_table = Compute(world, table->landmarks, table->max_nodes);
+
+            std::lock_guard<std::mutex> lock(landmarks_mutex);
+            refreshing.erase(world.get());
+            auto it = tables.find(world.get());
+            // Landmarks may have been changed or cleared in the meantime
+            if (it == tables.end() || it->second != table)
+            {
+                return it == tables.end() ? nullptr : it->second;
+            }
+            it->second = new_table;
+            return new_table;
+        }
+
+    private:
+        PathLandmarks() {}
+
+        static const bool IsOutdated(const LandmarkTable& table, const WorldSnapshot& snapshot)
+        {
+            for (size_t i = 0; i < table.chunks.size(); ++i)
             {
-                pos = p;
-                score = s;
+                const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(table.chunks[i].first.first, table.chunks[i].first.second);
+                if (chunk == nullptr || chunk->GetBlocksVersion() != table.chunks[i].second)
+                {
+                    return true;
+                }
             }
+            return false;
+        }
+
+        /// @brief Run one Dijkstra from each landmark, over the moves FindPath can do
+        static std::shared_ptr<LandmarkTable> Compute(const std::shared_ptr<World>& world, const std::vector<Position>& landmarks, const int max_nodes)
+        {
+            std::shared_ptr<LandmarkTable> table = std::make_shared<LandmarkTable>();
+            table->landmarks = landmarks;
+            table->max_nodes = max_nodes;
+
+            const WorldSnapshot snapshot = world->GetSnapshot();
+            const int min_y = world->GetMinY();
+            const size_t num_landmarks = landmarks.size();
+            WalkabilityGrid grid;
+            grid.Reset(snapshot);
+
+            PositionMap<float> dist;
+            const auto compare = [](const std::pair<float, Position>& a, const std::pair<float, Position>& b) { return a.first > b.first; };
+            std::priority_queue<std::pair<float, Position>, std::vector<std::pair<float, Position> >, decltype(compare)> open(compare);
+            for (size_t k = 0; k < num_landmarks; ++k)
+            {
+                dist.Clear();
+                dist[landmarks[k]] = 0.0f;
+                open.push({ 0.0f, landmarks[k] });
+                int num_visited = 0;
+                while (!open.empty())
+                {
+                    const std::pair<float, Position> current = open.top();
+                    open.pop();
+                    // Outdated entry, already visited with a lower distance
+                    if (current.first > dist[current.second])
+                    {
+                        continue;
+                    }
+
+                    const std::pair<size_t*, bool> offset = table->offsets.Insert(current.second, table->distances.size());
+                    if (offset.second)
+                    {
+                        table->distances.resize(table->distances.size() + num_landmarks, std::numeric_limits<float>::infinity());
+                    }
+                    table->distances[*offset.first + k] = current.first;
+
+                    if (++num_visited >= max_nodes)
+                    {
+                        break;
+                    }
+
+                    ForEachMove(grid, current.second, true, min_y, [&](const Position& new_pos, const float move_cost)
+                        {
+                            const float new_cost = current.first + move_cost;
+                            const std::pair<float*, bool> known = dist.Insert(new_pos, new_cost);
+                            if (known.second || new_cost < *known.first)
+                            {
+                                *known.first = new_cost;
+                                open.push({ new_cost, new_pos });
+                            }
+                        });
+                }
+                while (!open.empty())
+                {
+                    open.pop();
+                }
+            }
+
+            // Record the chunks covered, to know when the distances are outdated
+            table->offsets.ForEach([&](const Position& pos, const size_t)
+                {
+                    const Position chunk_pos = Chunk::BlockCoordsToChunkCoords(pos);
+                    const std::pair<int, int> coords(chunk_pos.x, chunk_pos.z);
+                    if (std::find_if(table->chunks.begin(), table->chunks.end(),
+                        [&coords](const std::pair<std::pair<int, int>, unsigned long long>& c) { return c.first == coords; }) != table->chunks.end())
+                    {
+                        return;
+                    }
+                    const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(coords.first, coords.second);
+                    table->chunks.push_back({ coords, chunk == nullptr ? 0 : chunk->GetBlocksVersion() });
+                });
+
+            table->computed = VirtualClock::now();
+            return table;
+        }
+
+    private:
+        static constexpr std::chrono::seconds refresh_interval = std::chrono::seconds(5);
+
+        std::mutex landmarks_mutex;
+        std::unordered_map<const World*, std::shared_ptr<LandmarkTable> > tables;
+        /// @brief Worlds whose table is being recomputed
+        std::unordered_set<const World*> refreshing;
+    };
+
+    void SetPathLandmarks(const std::shared_ptr<World>& world, const std::vector<Position>& landmarks, const int max_nodes)
+    {
+        if (landmarks.empty())
+        {
+            PathLandmarks::GetInstance().Clear(world.get());
+            return;
+        }
+        PathLandmarks::GetInstance().Set(world, landmarks, max_nodes);
+    }
+
+    void ClearPathLandmarks(const std::shared_ptr<World>& world)
+    {
+        PathLandmarks::GetInstance().Clear(world.get());
+    }
+
+    /// @brief Distance to a target from all the positions that can reach it,
+    /// with the next position to go to from each of them
+    struct FlowField
+    {
+        struct Cell
+        {
+            float cost;
+            Position next;
+        };
+
+        Position target;
+        int max_nodes = 0;
+        PositionMap<Cell> cells;
+        /// @brief Chunk coordinates --> blocks version when the field was computed
+        std::vector<std::pair<std::pair<int, int>, unsigned long long> > chunks;
+    };
+
+    /// @brief Flow fields used by GoTo, for each world and target. A field is
+    /// computed once with a reverse Dijkstra from the target, then any bot
+    /// going there follows it with lookups. Outdated fields are not used, and
+    /// computed again on a background thread
+    class FlowFields
+    {
+    public:
+        static FlowFields& GetInstance()
+        {
+            static FlowFields* instance = new FlowFields();
+            return *instance;
+        }
+
+        void Enable(const std::shared_ptr<World>& world, const Position& target, const int max_nodes)
+        {
+            std::shared_ptr<FlowField> field = Compute(world, target, max_nodes);
+            std::lock_guard<std::mutex> lock(fields_mutex);
+            fields[{ world.get(), target }] = field;
+        }
+
+        void Disable(const World* world, const Position& target)
+        {
+            std::lock_guard<std::mutex> lock(fields_mutex);
+            fields.erase({ world, target });
+        }
+
+        /// @brief Follow the field of target from start
+        /// @return The path, without start. Empty if there is no up to date field or start is not in it
+        const std::vector<Position> Follow(const std::shared_ptr<World>& world, const Position& start, const Position& target)
+        {
+            std::shared_ptr<const FlowField> field;
+            {
+                std::lock_guard<std::mutex> lock(fields_mutex);
+                auto it = fields.find({ world.get(), target });
+                if (it == fields.end())
+                {
+                    return std::vector<Position>();
+                }
+                field = it->second;
+            }
+
+            std::vector<Position> path;
+            if (IsOutdated(*field, world->GetSnapshot()))
+            {
+                QueueRefresh(world, target);
+                return path;
+            }
+
+            Position current = start;
+            const FlowField::Cell* cell = field->cells.Find(current);
+            if (cell == nullptr)
+            {
+                return path;
+            }
+            while (current != target)
+            {
+                current = cell->next;
+                path.push_back(current);
+                cell = field->cells.Find(current);
+            }
+            return path;
+        }
+
+    private:
+        FlowFields()
+        {
+
+        }
+
+        static const bool IsOutdated(const FlowField& field, const WorldSnapshot& snapshot)
+        {
+            for (size_t i = 0; i < field.chunks.size(); ++i)
+            {
+                const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(field.chunks[i].first.first, field.chunks[i].first.second);
+                if (chunk == nullptr || chunk->GetBlocksVersion() != field.chunks[i].second)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// @brief Compute a field again on the refresh thread
+        void QueueRefresh(const std::shared_ptr<World>& world, const Position& target)
+        {
+            std::lock_guard<std::mutex> lock(fields_mutex);
+            const std::pair<const World*, Position> key(world.get(), target);
+            if (std::find_if(refresh_queue.begin(), refresh_queue.end(),
+                [&key](const std::pair<std::shared_ptr<World>, Position>& r) { return r.first.get() == key.first && r.second == key.second; }) != refresh_queue.end())
+            {
+                return;
+            }
+            refresh_queue.push_back({ world, target });
+            if (!refresh_thread.joinable())
+            {
+                refresh_thread = std::thread(&FlowFields::RunRefresh, this);
+                // Never joined, as the instance is never destroyed
+                refresh_thread.detach();
+            }
+            refresh_condition.notify_one();
+        }
+
+        void RunRefresh()
+        {
+            Logger::GetInstance().RegisterThread("FlowFieldRefresh");
+            while (true)
+            {
+                std::shared_ptr<World> world;
+                Position target;
+                int max_nodes = 0;
+                {
+                    std::unique_lock<std::mutex> lock(fields_mutex);
+                    refresh_condition.wait(lock, [this]() { return !refresh_queue.empty(); });
+                    world = refresh_queue.front().first;
+                    target = refresh_queue.front().second;
+                    refresh_queue.pop_front();
+                    auto it = fields.find({ world.get(), target });
+                    if (it == fields.end())
+                    {
+                        continue;
+                    }
+                    max_nodes = it->second->max_nodes;
+                }
+
+                std::shared_ptr<FlowField> field = Compute(world, target, max_nodes);
+
+                std::lock_guard<std::mutex> lock(fields_mutex);
+                auto it = fields.find({ world.get(), target });
+                // Don't add back a disabled field
+                if (it != fields.end())
+                {
+                    it->second = field;
+                }
+            }
+        }
+
+        /// @brief Reverse Dijkstra from target. The predecessors of a position
+        /// are found by checking the moves of all the positions one or two
+        /// blocks away horizontally, between one block lower and two blocks higher.
+        /// Long falls into water are not used
+        static std::shared_ptr<FlowField> Compute(const std::shared_ptr<World>& world, const Position& target, const int max_nodes)
+        {
+            std::shared_ptr<FlowField> field = std::make_shared<FlowField>();
+            field->target = target;
+            field->max_nodes = max_nodes;
+
+            const WorldSnapshot snapshot = world->GetSnapshot();
+            const int min_y = world->GetMinY();
+            WalkabilityGrid grid;
+            grid.Reset(snapshot);
+
+            const std::array<Position, 4> directions = { Position(1, 0, 0), Position(-1, 0, 0), Position(0, 0, 1), Position(0, 0, -1) };
+
+            const auto compare = [](const std::pair<float, Position>& a, const std::pair<float, Position>& b) { return a.first > b.first; };
+            std::priority_queue<std::pair<float, Position>, std::vector<std::pair<float, Position> >, decltype(compare)> open(compare);
+            PositionSet closed;
+
+            field->cells.Insert(target, { 0.0f, target });
+            open.push({ 0.0f, target });
+            while (!open.empty() && static_cast<int>(closed.Size()) < max_nodes)
+            {
+                const std::pair<float, Position> current = open.top();
+                open.pop();
+                if (!closed.Insert(current.second))
+                {
+                    continue;
+                }
+
+                for (size_t d = 0; d < directions.size(); ++d)
+                {
+                    for (int step = 1; step <= 2; ++step)
+                    {
+                        for (int dy = -1; dy <= 2; ++dy)
+                        {
+                            const Position previous = current.second - directions[d] * step + Position(0, dy, 0);
+                            if (closed.Contains(previous))
+                            {
+                                continue;
+                            }
+                            float move_cost = std::numeric_limits<float>::max();
+                            ForEachMove(grid, previous, true, min_y, [&](const Position& new_pos, const float cost)
+                                {
+                                    if (new_pos == current.second)
+                                    {
+                                        move_cost = std::min(move_cost, cost);
+                                    }
+                                });
+                            if (move_cost == std::numeric_limits<float>::max())
+                            {
+                                continue;
+                            }
+                            const float new_cost = current.first + move_cost;
+                            const std::pair<FlowField::Cell*, bool> cell = field->cells.Insert(previous, { new_cost, current.second });
+                            if (cell.second || new_cost < cell.first->cost)
+                            {
+                                *cell.first = { new_cost, current.second };
+                                open.push({ new_cost, previous });
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Positions found but never settled may not have their shortest distance
+            std::vector<Position> unsettled;
+            field->cells.ForEach([&](const Position& pos, const FlowField::Cell&)
+                {
+                    if (!closed.Contains(pos))
+                    {
+                        unsettled.push_back(pos);
+                    }
+                });
+            for (const Position& pos : unsettled)
+            {
+                field->cells.Erase(pos);
+            }
+
+            // Record the chunks covered, to know when the field is outdated
+            field->cells.ForEach([&](const Position& pos, const FlowField::Cell&)
+                {
+                    const Position chunk_pos = Chunk::BlockCoordsToChunkCoords(pos);
+                    const std::pair<int, int> coords(chunk_pos.x, chunk_pos.z);
+                    if (std::find_if(field->chunks.begin(), field->chunks.end(),
+                        [&coords](const std::pair<std::pair<int, int>, unsigned long long>& c) { return c.first == coords; }) != field->chunks.end())
+                    {
+                        return;
+                    }
+                    const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(coords.first, coords.second);
+                    field->chunks.push_back({ coords, chunk == nullptr ? 0 : chunk->GetBlocksVersion() });
+                });
+
+            return field;
+        }
+
+    private:
+        struct KeyHasher
+        {
+            size_t operator()(const std::pair<const World*, Position>& k) const
+            {
+                size_t value = std::hash<const World*>()(k.first);
+                value ^= std::hash<Position>()(k.second) + 0x9e3779b9 + (value << 6) + (value >> 2);
+                return value;
+            }
+        };
+
+        std::mutex fields_mutex;
+        std::unordered_map<std::pair<const World*, Position>, std::shared_ptr<FlowField>, KeyHasher> fields;
+
+        std::condition_variable refresh_condition;
+        std::deque<std::pair<std::shared_ptr<World>, Position> > refresh_queue;
+        std::thread refresh_thread;
+    };
+
+    void EnableFlowField(const std::shared_ptr<World>& world, const Position& target, const int max_nodes)
+    {
+        FlowFields::GetInstance().Enable(world, target, max_nodes);
+    }
+
+    void DisableFlowField(const std::shared_ptr<World>& world, const Position& target)
+    {
+        FlowFields::GetInstance().Disable(world.get(), target);
+    }
+
+    const std::vector<Position> FollowFlowField(const std::shared_ptr<World>& world, const Position& start, const Position& target)
+    {
+        return FlowFields::GetInstance().Follow(world, start, target);
+    }
+
+    /// @brief Space-time reservations of the paths followed by the bots of
+    /// a world. Time is split in steps of roughly one block move, and
+    /// each bot reserves the cells of its path at the steps it will be in
+    /// them. A bot waits in place instead of entering a cell reserved by
+    /// another one at the same time, or swapping cells with it
+    class PathReservations
+    {
+    public:
+        static PathReservations& GetInstance()
+        {
+            static PathReservations* instance = new PathReservations();
+            return *instance;
+        }
+
+        void Enable(const World* world, const int step_ms)
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            tables[world].step_ms = std::max(1, step_ms);
+        }
+
+        void Disable(const World* world)
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            tables.erase(world);
+        }
+
+        const bool IsEnabled(const World* world)
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            return tables.find(world) != tables.end();
+        }
+
+        /// @brief Get the current step of a world
+        /// @return The current step, -1 if reservations are not enabled for this world
+        const long long int GetCurrentStep(const World* world)
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            auto it = tables.find(world);
+            if (it == tables.end())
+            {
+                return -1;
+            }
+            return GetCurrentStep(it->second);
+        }
+
+        /// @brief Reserve the cells of a path from now, replacing the previous reservations of owner
+        /// @param world The world of the path
+        /// @param owner The bot following the path
+        /// @param from Position of the bot, before path[first]
+        /// @param path The path
+        /// @param first Index of the first position of path still to reach
+        /// @return For each position of path, the step at which the bot can enter it (from first, 0 before)
+        const std::vector<long long int> Reserve(const World* world, const void* owner, const Position& from, const std::vector<Position>& path, const size_t first)
+        {
+            std::vector<long long int> schedule(path.size(), 0);
+
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            auto table_it = tables.find(world);
+            if (table_it == tables.end())
+            {
+                return schedule;
+            }
+            Table& table = table_it->second;
+            const long long int now = GetCurrentStep(table);
+
+            ReleaseOwner(table, owner);
+            // Remove the reservations of the bots that are done with their path
+            for (auto it = table.owned.begin(); it != table.owned.end();)
+            {
+                if (it->second.empty() || it->second.back().second < now)
+                {
+                    for (const auto& r : it->second)
+                    {
+                        table.cells.erase(r);
+                    }
+                    it = table.owned.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            std::vector<std::pair<Position, long long int> >& owned = table.owned[owner];
+            const auto IsFree = [&](const Position& p, const long long int t)
+            {
+                auto it = table.cells.find({ p, t });
+                return it == table.cells.end() || it->second == owner;
+            };
+            const auto Add = [&](const Position& p, const long long int t)
+            {
+                table.cells[{ p, t }] = owner;
+                owned.push_back({ p, t });
+            };
+
+            long long int t = now;
+            Position previous = from;
+            Add(previous, t);
+            for (size_t i = first; i < path.size(); ++i)
+            {
+                for (int wait = 0; wait < max_waits; ++wait)
+                {
+                    const auto other = table.cells.find({ path[i], t });
+                    // Free, and not swapping cells with another bot
+                    if (IsFree(path[i], t + 1) &&
+                        (other == table.cells.end() || other->second == owner || IsFree(previous, t + 1) || table.cells.at({ previous, t + 1 }) != other->second))
+                    {
+                        break;
+                    }
+                    // Can't wait here either, go anyway
+                    if (!IsFree(previous, t + 1))
+                    {
+                        break;
+                    }
+                    t += 1;
+                    Add(previous, t);
+                }
+                t += 1;
+                Add(path[i], t);
+                schedule[i] = t;
+                previous = path[i];
+            }
+            // Keep the end of the path for a bit, so others don't plan to go through a standing bot
+            for (int i = 0; i < max_waits; ++i)
+            {
+                if (!IsFree(previous, t + 1))
+                {
+                    break;
+                }
+                t += 1;
+                Add(previous, t);
+            }
+
+            if (table.listener)
+            {
+                std::vector<std::pair<Position, int> > relative_cells(owned.size());
+                for (size_t i = 0; i < owned.size(); ++i)
+                {
+                    relative_cells[i] = { owned[i].first, static_cast<int>(owned[i].second - now) };
+                }
+                table.listener(owner, relative_cells);
+            }
+
+            return schedule;
+        }
+
+        void Release(const World* world, const void* owner)
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            auto it = tables.find(world);
+            if (it != tables.end())
+            {
+                ReleaseOwner(it->second, owner);
+                if (it->second.listener)
+                {
+                    it->second.listener(owner, {});
+                }
+            }
+        }
+
+        void SetListener(const World* world, const std::function<void(const void*, const std::vector<std::pair<Position, int> >&)>& listener)
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            auto it = tables.find(world);
+            if (it != tables.end())
+            {
+                it->second.listener = listener;
+            }
+        }
+
+        void SetExternal(const World* world, const std::string& owner, const std::vector<std::pair<Position, int> >& relative_cells)
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            auto table_it = tables.find(world);
+            if (table_it == tables.end())
+            {
+                return;
+            }
+            Table& table = table_it->second;
+
+            // Give each external bot a unique address to use as owner
+            std::unique_ptr<char>& owner_ptr = table.external_owners[owner];
+            if (!owner_ptr)
+            {
+                owner_ptr = std::make_unique<char>();
+            }
+            ReleaseOwner(table, owner_ptr.get());
+            if (relative_cells.empty())
+            {
+                table.external_owners.erase(owner);
+                return;
+            }
+
+            const long long int now = GetCurrentStep(table);
+            std::vector<std::pair<Position, long long int> >& owned = table.owned[owner_ptr.get()];
+            for (const auto& c : relative_cells)
+            {
+                const std::pair<Position, long long int> key = { c.first, now + c.second };
+                // Local bots keep their reservations, they'll be seen by the other process too
+                if (table.cells.find(key) == table.cells.end())
+                {
+                    table.cells[key] = owner_ptr.get();
+                    owned.push_back(key);
+                }
+            }
+        }
+
+    private:
+        PathReservations()
+        {
+
+        }
+
+        struct KeyHasher
+        {
+            size_t operator()(const std::pair<Position, long long int>& k) const
+            {
+                size_t value = std::hash<Position>()(k.first);
+                value ^= std::hash<long long int>()(k.second) + 0x9e3779b9 + (value << 6) + (value >> 2);
+                return value;
+            }
+        };
+
+        struct Table
+        {
+            int step_ms = 250;
+            /// @brief (position, step) --> bot
+            std::unordered_map<std::pair<Position, long long int>, const void*, KeyHasher> cells;
+            /// @brief bot --> its reservations, sorted by step
+            std::unordered_map<const void*, std::vector<std::pair<Position, long long int> > > owned;
+            /// @brief Called when a local bot reserves or releases its path
+            std::function<void(const void*, const std::vector<std::pair<Position, int> >&)> listener;
+            /// @brief Name of the bots of other processes --> their owner address in cells and owned
+            std::unordered_map<std::string, std::unique_ptr<char> > external_owners;
+        };
+
+        /// @brief Table mutex must be locked by the caller
+        static const long long int GetCurrentStep(const Table& table)
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now().time_since_epoch()).count() / table.step_ms;
+        }
+
+        /// @brief Table mutex must be locked by the caller
+        static void ReleaseOwner(Table& table, const void* owner)
+        {
+            auto it = table.owned.find(owner);
+            if (it == table.owned.end())
+            {
+                return;
+            }
+            for (const auto& r : it->second)
+            {
+                table.cells.erase(r);
+            }
+            table.owned.erase(it);
+        }
+
+    private:
+        /// @brief Max number of steps a bot waits before each move
+        static constexpr int max_waits = 8;
+
+        std::mutex reservations_mutex;
+        std::unordered_map<const World*, Table> tables;
+    };
+
+    void EnablePathReservations(const std::shared_ptr<World>& world, const int step_ms)
+    {
+        PathReservations::GetInstance().Enable(world.get(), step_ms);
+    }
+
+    void DisablePathReservations(const std::shared_ptr<World>& world)
+    {
+        PathReservations::GetInstance().Disable(world.get());
+    }
+
+    void SetPathReservationsListener(const std::shared_ptr<World>& world, const std::function<void(const void*, const std::vector<std::pair<Position, int> >&)>& listener)
+    {
+        PathReservations::GetInstance().SetListener(world.get(), listener);
+    }
+
+    void SetExternalPathReservations(const std::shared_ptr<World>& world, const std::string& owner, const std::vector<std::pair<Position, int> >& cells)
+    {
+        PathReservations::GetInstance().SetExternal(world.get(), owner, cells);
+    }
+
+    const std::vector<Position> FindPath(const std::shared_ptr<World>& world, const Position& start, const Position& end, const int min_end_dist, const bool allow_jump,
+        const std::function<bool()>& should_stop)
+    {
+        TRACE_ZONE("FindPath", "distance", std::abs(start.x - end.x) + std::abs(start.y - end.y) + std::abs(start.z - end.z));
+        const auto Heuristic = [](const Position& a, const Position& b)
+        {
+            return static_cast<float>(std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z));
+        };
+
+        // The whole search is done on the same read-only
+        // view of the world, without locking the world mutex
+        const WorldSnapshot world_snapshot = world->GetSnapshot();
+
+        // Repeated routes are reused if nothing changed on them
+        std::vector<Position> cached_path;
+        if (PathCache::GetInstance().Get(world.get(), start, end, min_end_dist, allow_jump, world_snapshot, cached_path))
+        {
+            return cached_path;
+        }
+
+        // Landmark lower bound, if landmarks are set for this world and they reach the goal
+        const std::shared_ptr<const LandmarkTable> landmarks = PathLandmarks::GetInstance().Get(world, world_snapshot);
+        const float* goal_landmark_distances = landmarks == nullptr ? nullptr : landmarks->Get(end);
+        const auto LandmarkHeuristic = [&](const Position& p, const float h)
+        {
+            if (goal_landmark_distances == nullptr)
+            {
+                return h;
+            }
+            const float* distances = landmarks->Get(p);
+            if (distances == nullptr)
+            {
+                return h;
+            }
+            float best = h;
+            for (size_t k = 0; k < landmarks->landmarks.size(); ++k)
+            {
+                // inf - inf is NaN, and any comparison with NaN is false
+                const float bound = goal_landmark_distances[k] - distances[k];
+                if (bound > best && bound != std::numeric_limits<float>::infinity())
+                {
+                    best = bound;
+                }
+            }
+            return best;
+        };
+
+        // Reused between searches on the same thread
+        thread_local PathfindingArena arena;
+        arena.Clear();
+        arena.Relax(start, -1, 0.0f, 0.0f);
+
+        int count_visit = 0;
+        bool reached_goal = false;
+
+        thread_local WalkabilityGrid grid;
+        grid.Reset(world_snapshot);
+
+        while (!arena.Empty())
+        {
+            count_visit++;
+            const int current_index = arena.Pop();
+            // Copy as nodes can be reallocated when adding new ones
+            const PathfindingArena::Node current_node = arena.GetNodes()[current_index];
+            const float current_cost = current_node.cost;
+
+            // Checking every node would be too expensive
+            if (should_stop && count_visit % 256 == 0 && should_stop())
+            {
+                break;
+            }
+
+            if (count_visit > 10000)
+            {
+                break;
+            }
+
+            if ((std::abs(end.x - start.x) + std::abs(end.z - start.z) >= min_end_dist && current_node.pos == end) ||
+                (std::abs(end.x - start.x) + std::abs(end.z - start.z) < min_end_dist) && (std::abs(end.x - current_node.pos.x) + std::abs(end.z - current_node.pos.z) >= min_end_dist))
+            {
+                reached_goal = true;
+                break;
+            }
+
+            ForEachMove(grid, current_node.pos, allow_jump, world->GetMinY(), [&](const Position& new_pos, const float move_cost)
+                {
+                    const float new_cost = current_cost + move_cost;
+                    // If we don't already know this node with a better path, add it
+                    arena.Relax(new_pos, current_index, new_cost, new_cost + LandmarkHeuristic(new_pos, Heuristic(new_pos, end)));
+                });
+        }
+
+        const std::vector<PathfindingArena::Node>& nodes = arena.GetNodes();
+        int end_path = 0;
+
+        // We search for the closest node
+        // respecting the min_end_dist criterion
+        float best_float_dist = std::numeric_limits<float>::max();
+        for (int i = 0; i < nodes.size(); ++i)
+        {
+            const Position diff = nodes[i].pos - end;
+            const float distXZ = std::abs(diff.x) + std::abs(diff.z);
+            const float d = std::abs(diff.y) + distXZ;
+            if (d < best_float_dist && distXZ >= min_end_dist)
+            {
+                best_float_dist = d;
+                end_path = i;
+            }
+        }
+
+        std::deque<Position> output_deque;
+        output_deque.push_front(nodes[end_path].pos);
+        while (nodes[end_path].parent != -1 && nodes[nodes[end_path].parent].pos != start)
+        {
+            end_path = nodes[end_path].parent;
+            output_deque.push_front(nodes[end_path].pos);
+        }
+        const std::vector<Position> output(output_deque.begin(), output_deque.end());
+
+        // Incomplete paths could be improved once more chunks are loaded, don't keep them
+        if (reached_goal)
+        {
+            PathCache::GetInstance().Add(world.get(), start, end, min_end_dist, allow_jump, world_snapshot, output);
+        }
+
+        return output;
+    }
+
+    const std::vector<Position> FindPathsToAny(const std::shared_ptr<World>& world, const Position& start, const std::vector<Position>& targets,
+        const int max_visits, const bool allow_jump, int* reached_target)
+    {
+        if (reached_target != nullptr)
+        {
+            *reached_target = -1;
+        }
+
+        // Target position --> index in targets
+        std::unordered_map<Position, int> target_indices;
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            target_indices.insert({ targets[i], static_cast<int>(i) });
+        }
+        if (target_indices.empty())
+        {
+            return std::vector<Position>();
+        }
+
+        // Distance to the closest target. With a lot of targets, computing
+        // it would cost more than it saves, fall back to plain Dijkstra
+        const bool use_heuristic = targets.size() <= 32;
+        const auto Heuristic = [&](const Position& p)
+        {
+            if (!use_heuristic)
+            {
+                return 0.0f;
+            }
+            int best = std::numeric_limits<int>::max();
+            for (size_t i = 0; i < targets.size(); ++i)
+            {
+                best = std::min(best, std::abs(p.x - targets[i].x) + std::abs(p.y - targets[i].y) + std::abs(p.z - targets[i].z));
+            }
+            return static_cast<float>(best);
+        };
+
+        const WorldSnapshot world_snapshot = world->GetSnapshot();
+
+        // Reused between searches on the same thread
+        thread_local PathfindingArena arena;
+        arena.Clear();
+        arena.Relax(start, -1, 0.0f, Heuristic(start));
+
+        thread_local WalkabilityGrid grid;
+        grid.Reset(world_snapshot);
+
+        int end_index = -1;
+        int count_visit = 0;
+        while (!arena.Empty() && count_visit < max_visits)
+        {
+            count_visit++;
+            const int current_index = arena.Pop();
+            // Copy as nodes can be reallocated when adding new ones
+            const PathfindingArena::Node current_node = arena.GetNodes()[current_index];
+            const float current_cost = current_node.cost;
+
+            // The first target popped is the cheapest one to reach
+            auto target_it = target_indices.find(current_node.pos);
+            if (target_it != target_indices.end())
+            {
+                end_index = current_index;
+                if (reached_target != nullptr)
+                {
+                    *reached_target = target_it->second;
+                }
+                break;
+            }
+
+            ForEachMove(grid, current_node.pos, allow_jump, world->GetMinY(), [&](const Position& new_pos, const float move_cost)
+                {
+                    const float new_cost = current_cost + move_cost;
+                    // If we don't already know this node with a better path, add it
+                    arena.Relax(new_pos, current_index, new_cost, new_cost + Heuristic(new_pos));
+                });
+        }
+
+        if (end_index == -1)
+        {
+            return std::vector<Position>();
+        }
+
+        const std::vector<PathfindingArena::Node>& nodes = arena.GetNodes();
+        std::deque<Position> output_deque;
+        for (int i = end_index; i != -1 && nodes[i].parent != -1; i = nodes[i].parent)
+        {
+            output_deque.push_front(nodes[i].pos);
+        }
+        return std::vector<Position>(output_deque.begin(), output_deque.end());
+    }
+
+    /// @brief Check if the player can stand at a given position (solid block below, two free blocks)
+    static const bool IsStandable(const WorldSnapshot& world_snapshot, const Position& pos)
+    {
+        const BlockAccessor accessor(world_snapshot, pos);
+        const Block* block = accessor.GetRelative(0, -1, 0);
+        if (!block || !block->HasFlag(BlockstateFlag::Solid))
+        {
+            return false;
+        }
+        block = accessor.Get();
+        if (!accessor.IsLoaded() || (block && block->HasFlag(BlockstateFlag::Solid)))
+        {
+            return false;
+        }
+        block = accessor.GetRelative(0, 1, 0);
+        return !block || !block->HasFlag(BlockstateFlag::Solid);
+    }
+
+    /// @brief Get the coordinates of the 16x16x16 section containing a position
+    static const Position GetSectionCoords(const Position& pos)
+    {
+        return Position(
+            static_cast<int>(std::floor(pos.x / static_cast<double>(CHUNK_WIDTH))),
+            static_cast<int>(std::floor(pos.y / static_cast<double>(SECTION_HEIGHT))),
+            static_cast<int>(std::floor(pos.z / static_cast<double>(CHUNK_WIDTH)))
+        );
+    }
+
+    /// @brief Find the portals from a section to its neighbours: for each neighbour section,
+    /// the standable position closest to end that can be reached in one step from the section
+    static const std::unordered_map<Position, Position> FindSectionPortals(const WorldSnapshot& world_snapshot, const Position& section, const Position& end)
+    {
+        std::unordered_map<Position, Position> portals;
+        const std::array<Position, 4> directions = { Position(1, 0, 0), Position(-1, 0, 0), Position(0, 0, 1), Position(0, 0, -1) };
+
+        const Position origin(section.x * CHUNK_WIDTH, section.y * SECTION_HEIGHT, section.z * CHUNK_WIDTH);
+        Position pos;
+        for (int y = 0; y < SECTION_HEIGHT; ++y)
+        {
+            pos.y = origin.y + y;
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
+            {
+                pos.z = origin.z + z;
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
+                {
+                    // Only positions on the section borders can lead to another section
+                    if (x != 0 && x != CHUNK_WIDTH - 1 &&
+                        z != 0 && z != CHUNK_WIDTH - 1 &&
+                        y != 0 && y != SECTION_HEIGHT - 1)
+                    {
+                        continue;
+                    }
+                    pos.x = origin.x + x;
+                    if (!IsStandable(world_snapshot, pos))
+                    {
+                        continue;
+                    }
+
+                    for (size_t i = 0; i < directions.size(); ++i)
+                    {
+                        // Walk, step up or step down
+                        for (int dy : { 0, 1, -1 })
+                        {
+                            const Position next = pos + directions[i] + Position(0, dy, 0);
+                            const Position next_section = GetSectionCoords(next);
+                            if (next_section == section || !IsStandable(world_snapshot, next))
+                            {
+                                continue;
+                            }
+                            auto it = portals.find(next_section);
+                            if (it == portals.end())
+                            {
+                                portals[next_section] = next;
+                            }
+                            else
+                            {
+                                const Position diff_new = next - end;
+                                const Position diff_old = it->second - end;
+                                if (std::abs(diff_new.x) + std::abs(diff_new.y) + std::abs(diff_new.z) <
+                                    std::abs(diff_old.x) + std::abs(diff_old.y) + std::abs(diff_old.z))
+                                {
+                                    it->second = next;
+                                }
+                            }
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        return portals;
+    }
+
+    const std::vector<Position> FindHierarchicalPath(const std::shared_ptr<World>& world, const Position& start, const Position& end, const int min_end_dist, const bool allow_jump,
+        const std::function<bool()>& should_stop)
+    {
+        struct SectionNode
+        {
+            Position section;
+            float score; // distance from start + heuristic to goal
+            SectionNode(const Position& s, const float sc)
+            {
+                section = s;
+                score = sc;
+            }
+
+            bool operator>(const SectionNode& rhs) const
+            {
+                return score > rhs.score;
+            }
+        };
+
+        const auto Manhattan = [](const Position& a, const Position& b)
+        {
+            return static_cast<float>(std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z));
+        };
+
+        const WorldSnapshot world_snapshot = world->GetSnapshot();
+
+        const Position start_section = GetSectionCoords(start);
+        const Position end_section = GetSectionCoords(end);
+
+        std::priority_queue<SectionNode, std::vector<SectionNode>, std::greater<SectionNode> > sections_to_explore;
+        // section --> previous section
+        std::unordered_map<Position, Position> came_from;
+        // section --> position the section is entered at
+        std::unordered_map<Position, Position> entry;
+        std::unordered_map<Position, float> cost;
+
+        sections_to_explore.emplace(SectionNode(start_section, Manhattan(start, end)));
+        came_from[start_section] = start_section;
+        entry[start_section] = start;
+        cost[start_section] = 0.0f;
+
+        Position best_section = start_section;
+        float best_dist = Manhattan(start, end);
+        int count_visit = 0;
+        while (!sections_to_explore.empty() && count_visit < 2048)
+        {
+            if (should_stop && should_stop())
+            {
+                break;
+            }
+
+            const SectionNode current = sections_to_explore.top();
+            sections_to_explore.pop();
+            count_visit++;
+
+            if (current.section == end_section)
+            {
+                best_section = end_section;
+                break;
+            }
+
+            const Position& current_entry = entry[current.section];
+            const float current_cost = cost[current.section];
+            const std::unordered_map<Position, Position> portals = FindSectionPortals(world_snapshot, current.section, end);
+            for (auto it = portals.begin(); it != portals.end(); ++it)
+            {
+                const float new_cost = current_cost + Manhattan(current_entry, it->second);
+                auto cost_it = cost.find(it->first);
+                // If we don't already know this section with a better path, add it
+                if (cost_it == cost.end() || new_cost < cost_it->second)
+                {
+                    cost[it->first] = new_cost;
+                    entry[it->first] = it->second;
+                    came_from[it->first] = current.section;
+                    sections_to_explore.emplace(SectionNode(it->first, new_cost + Manhattan(it->second, end)));
+
+                    const float dist = Manhattan(it->second, end);
+                    if (dist < best_dist)
+                    {
+                        best_dist = dist;
+                        best_section = it->first;
+                    }
+                }
+            }
+        }
+
+        // Get the portals from start to the best section found
+        std::deque<Position> waypoints;
+        for (Position s = best_section; s != start_section; s = came_from[s])
+        {
+            waypoints.push_front(entry[s]);
+        }
+
+        // Refine the path between successive waypoints, skipping every
+        // other one so each local search spans two sections
+        std::vector<Position> output;
+        Position current = start;
+        for (size_t i = 1; i < waypoints.size(); i += 2)
+        {
+            const std::vector<Position> segment = FindPath(world, current, waypoints[i], 0, allow_jump, should_stop);
+            if (segment.size() == 0 || segment.back() == current)
+            {
+                return output;
+            }
+            output.insert(output.end(), segment.begin(), segment.end());
+            current = segment.back();
+            if (current != waypoints[i])
+            {
+                // Local search didn't reach the waypoint, stop here
+                // the caller will search again from there
+                return output;
+            }
+        }
+
+        const std::vector<Position> segment = FindPath(world, current, best_section == end_section ? end : (waypoints.empty() ? end : waypoints.back()), best_section == end_section ? min_end_dist : 0, allow_jump, should_stop);
+        if (segment.size() > 0 && segment.back() != current)
+        {
+            output.insert(output.end(), segment.begin(), segment.end());
+        }
+        return output;
+    }
+
+    /// @brief Check the moves of a path that go through chunks modified between two snapshots
+    /// @param old_snapshot Snapshot the path is known to be valid in
+    /// @param new_snapshot Current snapshot
+    /// @param path The path
+    /// @param first Index of the first move to check
+    /// @param from Position before path[first]
+    /// @param allow_jump If true, allow to jump above 1-wide gaps
+    /// @param min_y Min y of the world
+    /// @return Index of the first move not possible anymore, path.size() if they all still are
+    static const size_t FindFirstInvalidMove(const WorldSnapshot& old_snapshot, const WorldSnapshot& new_snapshot,
+        const std::vector<Position>& path, const size_t first, const Position& from, const bool allow_jump, const int min_y)
+    {
+        const auto HasChunkChanged = [&](const Position& pos)
+        {
+            const int chunk_x = static_cast<int>(std::floor(pos.x / static_cast<double>(CHUNK_WIDTH)));
+            const int chunk_z = static_cast<int>(std::floor(pos.z / static_cast<double>(CHUNK_WIDTH)));
+            return old_snapshot.GetChunk(chunk_x, chunk_z) != new_snapshot.GetChunk(chunk_x, chunk_z);
+        };
 
-            bool operator>(const PathNode& rhs) const
+        WalkabilityGrid grid;
+        grid.Reset(new_snapshot);
+        for (size_t i = first; i < path.size(); ++i)
+        {
+            const Position& previous = i == first ? from : path[i - 1];
+            if (!HasChunkChanged(previous) && !HasChunkChanged(path[i]))
             {
-                return score > rhs.score;
+                continue;
             }
 
-            static const float Heuristic(const Position& a, const Position& b)
+            bool is_valid = false;
+            ForEachMove(grid, previous, allow_jump, min_y, [&](const Position& new_pos, const float)
+                {
+                    is_valid = is_valid || new_pos == path[i];
+                });
+            if (!is_valid)
             {
-                return std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z);
+                return i;
             }
-        };
+        }
+        return path.size();
+    }
 
-        const std::vector<Position> neighbour_offsets({ Position(1, 0, 0), Position(-1, 0, 0), Position(0, 0, 1), Position(0, 0, -1) });
-        std::priority_queue<PathNode, std::vector<PathNode>, std::greater<PathNode> > nodes_to_explore;
-        std::unordered_map<Position, Position> came_from;
-        std::unordered_map<Position, float> cost;
+    /// @brief Replace an invalid move of a path by a local detour rejoining the path a few moves later
+    /// @param client The client performing the action
+    /// @param path The path to repair
+    /// @param invalid Index of the invalid move
+    /// @param from Position before path[invalid]
+    /// @param allow_jump If true, allow to jump above 1-wide gaps
+    /// @return Index of the position where the detour rejoins the path, -1 if no detour was found
+    static const int RepairPath(BehaviourClient& client, std::vector<Position>& path, const size_t invalid, const Position& from, const bool allow_jump)
+    {
+        // Max number of moves replaced by the detour
+        static constexpr size_t repair_window = 8;
 
-        nodes_to_explore.emplace(PathNode(start, 0.0f));
-        came_from[start] = start;
-        cost[start] = 0.0f;
+        const size_t rejoin = std::min(invalid + repair_window, path.size() - 1);
+        const std::vector<Position> detour = FindPath(client.GetWorld(), from, path[rejoin], 0, allow_jump);
+        if (detour.empty() || detour.back() != path[rejoin])
+        {
+            return -1;
+        }
 
-        int count_visit = 0;
+        path.erase(path.begin() + invalid, path.begin() + rejoin + 1);
+        path.insert(path.begin() + invalid, detour.begin(), detour.end());
+        return static_cast<int>(invalid + detour.size() - 1);
+    }
 
-        std::shared_ptr<World> world = client.GetWorld();
+    /// @brief Check if a block can be walked through without jumping nor falling:
+    /// solid floor, and no solid or fluid block at the feet and head levels
+    static const bool IsFlatWalkable(WalkabilityGrid& grid, const Position& pos)
+    {
+        const unsigned char blocking = WalkabilityGrid::Solid | WalkabilityGrid::Fluid;
+        return (grid.Get(pos + Position(0, -1, 0)) & WalkabilityGrid::Solid) &&
+            !(grid.Get(pos) & blocking) &&
+            !(grid.Get(pos + Position(0, 1, 0)) & blocking);
+    }
+
+    /// @brief Count the moves of a path to an adjacent block at the same height, starting at first
+    /// @param grid Walkability flags of the world
+    /// @param path The path
+    /// @param first Index of the first move
+    /// @param from Position before path[first]
+    /// @return Number of successive flat moves, at most max_flat_moves
+    static const size_t CountFlatMoves(WalkabilityGrid& grid, const std::vector<Position>& path, const size_t first, const Position& from)
+    {
+        // Changes in the world are only checked between two runs, keep them short
+        static constexpr size_t max_flat_moves = 16;
 
-        while (!nodes_to_explore.empty())
+        if (!IsFlatWalkable(grid, from))
         {
-            count_visit++;
-            PathNode current_node = nodes_to_explore.top();
-            nodes_to_explore.pop();
+            return 0;
+        }
 
-            if (count_visit > 10000 ||
-                (std::abs(end.x - start.x) + std::abs(end.z - start.z) >= min_end_dist && current_node.pos == end) ||
-                (std::abs(end.x - start.x) + std::abs(end.z - start.z) < min_end_dist) && (std::abs(end.x - current_node.pos.x) + std::abs(end.z - current_node.pos.z) >= min_end_dist))
+        size_t count = 0;
+        Position previous = from;
+        while (first + count < path.size() && count < max_flat_moves)
+        {
+            const Position& next = path[first + count];
+            const Position diff = next - previous;
+            if (diff.y != 0 || std::abs(diff.x) + std::abs(diff.z) != 1 || !IsFlatWalkable(grid, next))
             {
                 break;
             }
+            previous = next;
+            count++;
+        }
+        return count;
+    }
 
-            // For each neighbour, check if it's reachable
-            // and add it to the search list if it is
-            for (int i = 0; i < neighbour_offsets.size(); ++i)
-            {
-                const Position next_location = current_node.pos + neighbour_offsets[i];
-                const Position next_next_location = next_location + neighbour_offsets[i];
-                // Get the state around the player in the given location
-                // True = solid, False = go through
-                std::array<bool, 13> surroundings = { false, false, false, false, false, false,
-                    false, false, false, false, false, false, false };
-                // 0  1  7
-                // x  2  8
-                // x  3  9
-                //--- 4  10
-                //    5  11
-                //    6  12
-                bool is_in_fluid;
-                {
-                    std::lock_guard<std::mutex> world_guard(world->GetMutex());
-
-                    const Block* block = world->GetBlock(current_node.pos);
-                    is_in_fluid = block && block->GetBlockstate()->IsFluid();
-
-                    // Start with 2 because if 2 is solid, no pathfinding is possible
-                    block = world->GetBlock(next_location + Position(0, 1, 0));
-                    surroundings[2] = block && (block->GetBlockstate()->IsSolid() || (is_in_fluid && block->GetBlockstate()->IsFluid()));
-                    if (surroundings[2])
-                    {
-                        continue;
-                    }
-
-                    block = world->GetBlock(current_node.pos + Position(0, 2, 0));
-                    surroundings[0] = block && (block->GetBlockstate()->IsSolid() || (is_in_fluid && block->GetBlockstate()->IsFluid()));
-
-                    block = world->GetBlock(next_location + Position(0, 2, 0));
-                    surroundings[1] = block && (block->GetBlockstate()->IsSolid() || (is_in_fluid && block->GetBlockstate()->IsFluid()));
-                    block = world->GetBlock(next_location);
-                    surroundings[3] = block && (block->GetBlockstate()->IsSolid() || (is_in_fluid && block->GetBlockstate()->IsFluid()));
-                    block = world->GetBlock(next_location + Position(0, -1, 0));
-                    surroundings[4] = block && (block->GetBlockstate()->IsSolid() || (is_in_fluid && block->GetBlockstate()->IsFluid()));
-                    block = world->GetBlock(next_location + Position(0, -2, 0));
-                    surroundings[5] = block && (block->GetBlockstate()->IsSolid() || (is_in_fluid && block->GetBlockstate()->IsFluid()));
-                    block = world->GetBlock(next_location + Position(0, -3, 0));
-                    surroundings[6] = block && (block->GetBlockstate()->IsSolid() || (is_in_fluid && block->GetBlockstate()->IsFluid()));
-
-                    // You can't make large jumps if your feet are in fluid
-                    if (allow_jump && !is_in_fluid)
-                    {
-                        block = world->GetBlock(next_next_location + Position(0, 2, 0));
-                        surroundings[7] = block && block->GetBlockstate()->IsSolid();
-                        block = world->GetBlock(next_next_location + Position(0, 1, 0));
-                        surroundings[8] = block && block->GetBlockstate()->IsSolid();
-                        block = world->GetBlock(next_next_location);
-                        surroundings[9] = block && block->GetBlockstate()->IsSolid();
-                        block = world->GetBlock(next_next_location + Position(0, -1, 0));
-                        surroundings[10] = block && block->GetBlockstate()->IsSolid();
-                        block = world->GetBlock(next_next_location + Position(0, -2, 0));
-                        surroundings[11] = block && block->GetBlockstate()->IsSolid();
-                        block = world->GetBlock(next_next_location + Position(0, -3, 0));
-                        surroundings[12] = block && block->GetBlockstate()->IsSolid();
-                    }
-                }
-
-                // We can check all cases that could allow the bot to pass
-                //       ?
-                // x     ?
-                // x  o  ?
-                //--- ?  ?
-                //    ?  ?
-                //    ?  ?
-                if (!surroundings[0] && !surroundings[1]
-                    && !surroundings[2] && surroundings[3])
-                {
-                    const float new_cost = cost[current_node.pos] + 2.0f;
-                    const Position new_pos = next_location + Position(0, 1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // ?  ?  ?
-                // x     ?
-                // x     ?
-                //--- o  ?
-                //    ?  ?
-                //    ?  ?
-                if (!surroundings[2] && !surroundings[3]
-                    && surroundings[4])
-                {
-                    const float new_cost = cost[current_node.pos] + 1.0f;
-                    auto it = cost.find(next_location);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[next_location] = new_cost;
-                        nodes_to_explore.emplace(PathNode(next_location, new_cost + PathNode::Heuristic(next_location, end)));
-                        came_from[next_location] = current_node.pos;
-                    }
-                }
-
-                // ?  ?  ?
-                // x     ? 
-                // x     ?
-                //---    ?
-                //    o  ?
-                //    ?  ?
-                if (!surroundings[2] && !surroundings[3]
-                    && !surroundings[4] && surroundings[5])
-                {
-                    const float new_cost = cost[current_node.pos] + 2.0f;
-                    const Position new_pos = next_location + Position(0, -1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // ?  ?  ?
-                // x     ?
-                // x     ?
-                //---    ?
-                //       ?
-                //    o  ?
-                if (!surroundings[2] && !surroundings[3]
-                    && !surroundings[4] && !surroundings[5]
-                    && surroundings[6])
+    /// @brief Check if a player can walk in a straight line between two points, without jumping nor falling
+    /// @param grid Walkability flags of the world
+    /// @param from Starting point, at the feet of the player
+    /// @param to End point, at the same height
+    /// @param half_width Half width of the player
+    static const bool HasFlatLineOfSight(WalkabilityGrid& grid, const Vector3<double>& from, const Vector3<double>& to, const double half_width)
+    {
+        // Max distance between two checked player positions
+        static constexpr double step_length = 0.25;
+
+        const int y = static_cast<int>(std::floor(from.y));
+        const Vector3<double> delta(to.x - from.x, 0.0, to.z - from.z);
+        const int num_steps = std::max(1, static_cast<int>(std::ceil(std::sqrt(delta.dot(delta)) / step_length)));
+        Vector3<double> previous = from;
+        for (int i = 1; i <= num_steps; ++i)
+        {
+            const Vector3<double> current = from + delta * (static_cast<double>(i) / num_steps);
+            // All the blocks touched by the player between the two positions
+            const int min_x = static_cast<int>(std::floor(std::min(previous.x, current.x) - half_width));
+            const int max_x = static_cast<int>(std::floor(std::max(previous.x, current.x) + half_width));
+            const int min_z = static_cast<int>(std::floor(std::min(previous.z, current.z) - half_width));
+            const int max_z = static_cast<int>(std::floor(std::max(previous.z, current.z) + half_width));
+            for (int x = min_x; x <= max_x; ++x)
+            {
+                for (int z = min_z; z <= max_z; ++z)
                 {
-                    const float new_cost = cost[current_node.pos] + 3.0f;
-                    const Position new_pos = next_location + Position(0, -2, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
+                    if (!IsFlatWalkable(grid, Position(x, y, z)))
                     {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
+                        return false;
                     }
                 }
+            }
+            previous = current;
+        }
+        return true;
+    }
 
-                // ?  ?  ?
-                // x     ?
-                // x     ?
-                //---    ?
-                //       ?
-                //       ?
-                // Special case here, we can drop down
-                // if there is some water at the bottom
-                if (!surroundings[2] && !surroundings[3]
-                    && !surroundings[4] && !surroundings[5]
-                    && !surroundings[6])
-                {
-                    std::lock_guard<std::mutex> world_guard(world->GetMutex());
+    /// @brief Shortcut a run of flat moves, keeping only the corners needed to walk around obstacles
+    /// @param grid Walkability flags of the world
+    /// @param start Current position of the player
+    /// @param path The path
+    /// @param first Index of the first move of the run
+    /// @param count Number of moves in the run
+    /// @param half_width Half width of the player
+    /// @return The points to walk through, the last one is the center of path[first + count - 1]
+    static const std::vector<Vector3<double> > SmoothFlatMoves(WalkabilityGrid& grid, const Vector3<double>& start, const std::vector<Position>& path,
+        const size_t first, const size_t count, const double half_width)
+    {
+        const auto GetCenter = [&path](const size_t i)
+        {
+            return Vector3<double>(path[i].x + 0.5, path[i].y, path[i].z + 0.5);
+        };
 
-                    const Block* block;
+        std::vector<Vector3<double> > points;
+        Vector3<double> anchor = start;
+        size_t next = first;
+        while (next < first + count)
+        {
+            // Furthest visible position, the next one if none is
+            size_t furthest = first + count - 1;
+            while (furthest > next && !HasFlatLineOfSight(grid, anchor, GetCenter(furthest), half_width))
+            {
+                furthest--;
+            }
+            anchor = GetCenter(furthest);
+            points.push_back(anchor);
+            next = furthest + 1;
+        }
+        return points;
+    }
 
-                    for (int y = -4; next_location.y + y >= world->GetMinY(); --y)
-                    {
-                        block = world->GetBlock(next_location + Position(0, y, 0));
+    /// @brief Walk through a list of points at a constant speed, without stopping at the corners.
+    /// Inputs are given to follow a target point moving along the lines at speed,
+    /// the last point is reached exactly
+    /// @param client The client performing the action
+    /// @param points Points to walk through, at the same height
+    /// @param speed Travel speed (block per s)
+    static void FollowPoints(BehaviourClient& client, const std::vector<Vector3<double> >& points, const float speed)
+    {
+        std::shared_ptr<LocalPlayer> local_player = client.GetEntityManager()->GetLocalPlayer();
 
-                        if (block && block->GetBlockstate()->IsSolid())
-                        {
-                            break;
-                        }
+        std::vector<Vector3<double> > line = { local_player->GetPosition() };
+        line.insert(line.end(), points.begin(), points.end());
+        // Distance from the start to each point along the lines
+        std::vector<double> distances(line.size(), 0.0);
+        for (size_t i = 1; i < line.size(); ++i)
+        {
+            const Vector3<double> segment(line[i].x - line[i - 1].x, 0.0, line[i].z - line[i - 1].z);
+            distances[i] = distances[i - 1] + std::sqrt(segment.dot(segment));
+        }
 
-                        if (block && block->GetBlockstate()->IsFluid()
-                            && block->GetBlockstate()->GetName() == "minecraft:water")
-                        {
-                            const float new_cost = cost[current_node.pos] + std::abs(y);
-                            const Position new_pos = next_location + Position(0, y + 1, 0);
-                            auto it = cost.find(new_pos);
-                            // If we don't already know this node with a better path, add it
-                            if (it == cost.end() ||
-                                new_cost < it->second)
-                            {
-                                cost[new_pos] = new_cost;
-                                nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                                came_from[new_pos] = current_node.pos;
-                            }
+        size_t segment = 1;
+        local_player->LookAt(line[segment]);
+        local_player->SetPitch(0.0f);
 
-                            break;
-                        }
-                    }
-                }
+        const auto start = VirtualClock::now();
+        Vector3<double> previous_point = line[0];
+        while (true)
+        {
+            const double distance = std::chrono::duration<double>(VirtualClock::now() - start).count() * speed;
+            // At the end, move directly to the last point
+            if (distance >= distances.back())
+            {
+                std::lock_guard<std::mutex> player_lock(local_player->GetMutex());
+                local_player->SetPlayerInputsX(line.back().x - local_player->GetX() - local_player->GetSpeedX());
+                local_player->SetY(local_player->GetY() + 0.001);
+                local_player->SetPlayerInputsZ(line.back().z - local_player->GetZ() - local_player->GetSpeedZ());
+                break;
+            }
 
-                if (!allow_jump || is_in_fluid)
+            if (distance > distances[segment])
+            {
+                while (distance > distances[segment])
                 {
-                    continue;
-                }
-
-                //        
-                // x      
-                // x     o
-                //---    ?
-                //    ?  ?
-                //    ?  ?
-                if (!surroundings[0] && !surroundings[1]
-                    && !surroundings[2] && !surroundings[3]
-                    && !surroundings[4] && !surroundings[7]
-                    && !surroundings[8] && surroundings[9])
-                {
-                    const float new_cost = cost[current_node.pos] + 3.0f;
-                    const Position new_pos = next_next_location + Position(0, 1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                //        
-                // x      
-                // x      
-                //---    o
-                //       ?
-                //    ?  ?
-                if (!surroundings[0] && !surroundings[1]
-                    && !surroundings[2] && !surroundings[3]
-                    && !surroundings[4] && !surroundings[5]
-                    && !surroundings[7] && !surroundings[8]
-                    && !surroundings[9] && surroundings[10])
-                {
-                    const float new_cost = cost[current_node.pos] + 3.0f;
-                    auto it = cost.find(next_next_location);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[next_next_location] = new_cost;
-                        nodes_to_explore.emplace(PathNode(next_next_location, new_cost + PathNode::Heuristic(next_next_location, end)));
-                        came_from[next_next_location] = current_node.pos;
-                    }
-                }
-
-                //        
-                // x      
-                // x      
-                //---     
-                //       o
-                //    ?  ?
-                if (!surroundings[0] && !surroundings[1]
-                    && !surroundings[2] && !surroundings[3]
-                    && !surroundings[4] && !surroundings[5]
-                    && !surroundings[7] && !surroundings[8]
-                    && !surroundings[9] && !surroundings[10]
-                    && surroundings[11])
-                {
-                    const float new_cost = cost[current_node.pos] + 4.0f;
-                    const Position new_pos = next_next_location + Position(0, -1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                //        
-                // x      
-                // x      
-                //---     
-                //        
-                //    ?  o
-                if (!surroundings[0] && !surroundings[1]
-                    && !surroundings[2] && !surroundings[3]
-                    && !surroundings[4] && !surroundings[5]
-                    && !surroundings[7] && !surroundings[8]
-                    && !surroundings[9] && !surroundings[10]
-                    && !surroundings[11] && surroundings[12])
-                {
-                    const float new_cost = cost[current_node.pos] + 5.0f;
-                    const Position new_pos = next_next_location + Position(0, -2, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
+                    segment++;
                 }
-            } // neighbour loop
-        }
-
-        auto it_end_path = came_from.begin();
+                local_player->LookAt(line[segment]);
+                local_player->SetPitch(0.0f);
+            }
 
-        // We search for the closest node
-        // respecting the min_end_dist criterion
-        float best_float_dist = std::numeric_limits<float>::max();
-        for (auto it = came_from.begin(); it != came_from.end(); ++it)
-        {
-            const Position diff = it->first - end;
-            const float distXZ = std::abs(diff.x) + std::abs(diff.z);
-            const float d = std::abs(diff.y) + distXZ;
-            if (d < best_float_dist && distXZ >= min_end_dist)
+            const double t = (distance - distances[segment - 1]) / std::max(1e-6, distances[segment] - distances[segment - 1]);
+            const Vector3<double> point = line[segment - 1] + (line[segment] - line[segment - 1]) * t;
             {
-                best_float_dist = d;
-                it_end_path = it;
+                std::lock_guard<std::mutex> player_lock(local_player->GetMutex());
+                local_player->AddPlayerInputsX(point.x - previous_point.x);
+                local_player->SetY(local_player->GetY() + 0.001);
+                local_player->AddPlayerInputsZ(point.z - previous_point.z);
             }
+            previous_point = point;
+            client.Yield();
         }
-
-        std::deque<Position> output_deque;
-        output_deque.push_front(it_end_path->first);
-        while (it_end_path->second != start)
-        {
-            it_end_path = came_from.find(it_end_path->second);
-            output_deque.push_front(it_end_path->first);
-        }
-        return std::vector<Position>(output_deque.begin(), output_deque.end());
     }
 
     Status GoTo(BehaviourClient& client, const Position& goal, const int dist_tolerance,
@@ -395,6 +2095,33 @@ namespace Botcraft
     {
         std::shared_ptr<LocalPlayer> local_player = client.GetEntityManager()->GetLocalPlayer();
         std::shared_ptr<World> world = client.GetWorld();
+
+        // Ask the server for the chunks up to the goal while travelling,
+        // capped to the default view distance
+        int goal_chunk_distance = 0;
+        {
+            std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
+            const Vector3<double> start = local_player->GetPosition();
+            goal_chunk_distance = static_cast<int>(std::max(std::abs(goal.x - start.x), std::abs(goal.z - start.z))) / CHUNK_WIDTH + 2;
+        }
+        ScopedViewDistance travel_view_distance(client, std::min(goal_chunk_distance, 10));
+
+        // Release the reserved cells whatever the way we leave
+        struct ScopedReservation
+        {
+            const World* world;
+            const void* owner;
+            ~ScopedReservation()
+            {
+                PathReservations::GetInstance().Release(world, owner);
+            }
+        } reservation{ world.get(), &client };
+        const bool use_reservations = PathReservations::GetInstance().IsEnabled(world.get());
+
+        // Player dimensions are constant, no need to lock it
+        const double half_width = local_player->GetWidth() / 2.0;
+        WalkabilityGrid grid;
+
         Position current_position;
         do
         {
@@ -408,19 +2135,19 @@ namespace Botcraft
             current_position = Position(std::floor(local_player->GetPosition().x), std::floor(local_player->GetPosition().y), std::floor(local_player->GetPosition().z));
 
             std::vector<Position> path;
-            bool is_goal_loaded;
-            {
-                std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                is_goal_loaded = world->IsLoaded(goal);
-            }
+            // Taken before the search, so any later change is checked
+            WorldSnapshot path_snapshot = world->GetSnapshot();
+            const bool is_goal_loaded = path_snapshot.IsLoaded(goal);
 
-            // Path finding step
+            // Path finding step, run in the background so the
+            // behaviour can be interrupted during the search
+            PathSearchHandle search;
             if (!is_goal_loaded)
             {
                 LOG_INFO('[' << client.GetNetworkManager()->GetMyName() << "] Current goal position " << goal << " is either air or not loaded, trying to get closer to load the chunk");
                 Vector3<double> goal_direction(goal.x - current_position.x, goal.y - current_position.y, goal.z - current_position.z);
                 goal_direction.Normalize();
-                path = FindPath(client, current_position,
+                search = PathSearchPool::GetInstance().Submit(world, current_position,
                     current_position + Position(goal_direction.x * 32, goal_direction.y * 32, goal_direction.z * 32), min_end_dist, allow_jump);
             }
             else
@@ -430,7 +2157,32 @@ namespace Botcraft
                 {
                     return Status::Success;
                 }
-                path = FindPath(client, current_position, goal, min_end_dist, allow_jump);
+                // Bots going to a target with a flow field just follow it
+                if (min_end_dist == 0 && allow_jump)
+                {
+                    path = FollowFlowField(world, current_position, goal);
+                }
+                if (path.empty())
+                {
+                    // Long trips would explode the block level search, use the hierarchical one
+                    search = PathSearchPool::GetInstance().Submit(world, current_position, goal, min_end_dist, allow_jump,
+                        std::abs(diff.x) + std::abs(diff.z) > 64);
+                }
+            }
+
+            while (!search.IsDone())
+            {
+                client.Yield();
+            }
+            if (search.IsValid())
+            {
+                path = search.GetPath();
+            }
+
+            std::vector<long long int> schedule;
+            if (use_reservations)
+            {
+                schedule = PathReservations::GetInstance().Reserve(world.get(), &client, current_position, path, 0);
             }
 
             if (path.size() == 0 || path[path.size() - 1] == current_position)
@@ -451,94 +2203,150 @@ namespace Botcraft
                 }
             }
 
+            bool need_replan = false;
             for (int i = 0; i < path.size(); ++i)
             {
-                const Vector3<double> initial_position = local_player->GetPosition();
-                const Vector3<double> target_position(path[i].x + 0.5, path[i].y, path[i].z + 0.5);
-                const Vector3<double> motion_vector = target_position - initial_position;
-                local_player->LookAt(target_position);
-                local_player->SetPitch(0.0f);
-
-                // If we have to jump to get to the next position
-                if (path[i].y > current_position.y ||
-                    std::abs(motion_vector.x) > 1.5 ||
-                    std::abs(motion_vector.z) > 1.5)
+                // If some blocks changed since the path was computed, only
+                // check the moves in the modified chunks and repair the
+                // broken ones locally instead of searching again from scratch
+                const WorldSnapshot snapshot = world->GetSnapshot();
+                if (!snapshot.IsSame(path_snapshot))
                 {
-                    // Jump
-                    {
-                        std::lock_guard<std::mutex> player_lock(local_player->GetMutex());
-                        local_player->Jump();
-                    }
-
-                    if (std::abs(motion_vector.x) < 1.5 &&
-                        std::abs(motion_vector.z) < 1.5)
+                    size_t invalid = FindFirstInvalidMove(path_snapshot, snapshot, path, i, current_position, allow_jump, world->GetMinY());
+                    while (invalid < path.size())
                     {
-                        auto now = std::chrono::steady_clock::now();
-                        bool has_timeout = false;
-                        while (local_player->GetY() - initial_position.y < 1.0f)
-                        {
-                            // This indicates that a jump we wanted to make is not possible anymore
-                            // recalculating the path
-                            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count() >= 3000)
-                            {
-                                has_timeout = true;
-                                break;
-                            }
-                            client.Yield();
-                        }
-                        if (has_timeout)
+                        const int rejoin = RepairPath(client, path, invalid, invalid == i ? current_position : path[invalid - 1], allow_jump);
+                        if (rejoin == -1)
                         {
+                            need_replan = true;
                             break;
                         }
+                        invalid = FindFirstInvalidMove(path_snapshot, snapshot, path, rejoin + 1, path[rejoin], allow_jump, world->GetMinY());
+                    }
+                    if (need_replan)
+                    {
+                        break;
+                    }
+                    path_snapshot = snapshot;
+                    if (use_reservations)
+                    {
+                        schedule = PathReservations::GetInstance().Reserve(world.get(), &client, current_position, path, i);
                     }
                 }
 
-                auto start = std::chrono::steady_clock::now();
-                auto previous_step = start;
-                const double motion_norm_xz = std::abs(motion_vector.x) + std::abs(motion_vector.z);
-                while (true)
+                // Wait for our turn if the next cell is used by another bot
+                if (use_reservations)
+                {
+                    while (PathReservations::GetInstance().GetCurrentStep(world.get()) + 1 < schedule[i])
+                    {
+                        client.Yield();
+                    }
+                }
+
+                // Walk through the flat parts of the path without stopping at each
+                // block, unless moves are scheduled cell by cell with the reservations
+                size_t num_flat_moves = 0;
+                if (!use_reservations)
+                {
+                    grid.Reset(snapshot);
+                    num_flat_moves = CountFlatMoves(grid, path, i, current_position);
+                }
+                const size_t last = num_flat_moves > 1 ? i + num_flat_moves - 1 : i;
+
+                const Vector3<double> initial_position = local_player->GetPosition();
+                const Vector3<double> target_position(path[last].x + 0.5, path[last].y, path[last].z + 0.5);
+                const Vector3<double> motion_vector = target_position - initial_position;
+
+                if (last > i)
                 {
-                    auto now = std::chrono::steady_clock::now();
-                    long long int time_count = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
-                    // If we are over the time we have at speed to travel one block
-                    if (time_count > 1000 * motion_norm_xz / speed)
+                    FollowPoints(client, SmoothFlatMoves(grid, initial_position, path, i, num_flat_moves, half_width), speed);
+                }
+                else
+                {
+                    local_player->LookAt(target_position);
+                    local_player->SetPitch(0.0f);
+
+                    // If we have to jump to get to the next position
+                    if (path[i].y > current_position.y ||
+                        std::abs(motion_vector.x) > 1.5 ||
+                        std::abs(motion_vector.z) > 1.5)
                     {
+                        // Jump
                         {
                             std::lock_guard<std::mutex> player_lock(local_player->GetMutex());
-                            local_player->SetPlayerInputsX(target_position.x - local_player->GetX() - local_player->GetSpeedX());
-                            local_player->SetY(local_player->GetY() + 0.001);
-                            local_player->SetPlayerInputsZ(target_position.z - local_player->GetZ() - local_player->GetSpeedZ());
+                            local_player->Jump();
+                        }
 
-                            // If the target motion requires going down
-                            if (motion_vector.y < 0)
+                        if (std::abs(motion_vector.x) < 1.5 &&
+                            std::abs(motion_vector.z) < 1.5)
+                        {
+                            auto now = VirtualClock::now();
+                            bool has_timeout = false;
+                            while (local_player->GetY() - initial_position.y < 1.0f)
+                            {
+                                // This indicates that a jump we wanted to make is not possible anymore
+                                // recalculating the path
+                                if (std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now() - now).count() >= 3000)
+                                {
+                                    has_timeout = true;
+                                    break;
+                                }
+                                client.Yield();
+                            }
+                            if (has_timeout)
                             {
-                                local_player->SetOnGround(false);
+                                break;
                             }
                         }
-                        break;
                     }
-                    // Otherwise just move partially toward the goal
-                    else
+
+                    auto start = VirtualClock::now();
+                    auto previous_step = start;
+                    const double motion_norm_xz = std::abs(motion_vector.x) + std::abs(motion_vector.z);
+                    while (true)
                     {
-                        long long int delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(now - previous_step).count();
-                        Vector3<double> delta_v = motion_vector * delta_t / (1000.0 * motion_norm_xz) * speed;
+                        auto now = VirtualClock::now();
+                        long long int time_count = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+                        // If we are over the time we have at speed to travel one block
+                        if (time_count > 1000 * motion_norm_xz / speed)
                         {
-                            std::lock_guard<std::mutex> player_lock(local_player->GetMutex());
-                            local_player->AddPlayerInputsX(delta_v.x);
-                            local_player->SetY(local_player->GetY() + 0.001);
-                            local_player->AddPlayerInputsZ(delta_v.z);
+                            {
+                                std::lock_guard<std::mutex> player_lock(local_player->GetMutex());
+                                local_player->SetPlayerInputsX(target_position.x - local_player->GetX() - local_player->GetSpeedX());
+                                local_player->SetY(local_player->GetY() + 0.001);
+                                local_player->SetPlayerInputsZ(target_position.z - local_player->GetZ() - local_player->GetSpeedZ());
+
+                                // If the target motion requires going down
+                                if (motion_vector.y < 0)
+                                {
+                                    local_player->SetOnGround(false);
+                                }
+                            }
+                            break;
+                        }
+                        // Otherwise just move partially toward the goal
+                        else
+                        {
+                            long long int delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(now - previous_step).count();
+                            Vector3<double> delta_v = motion_vector * delta_t / (1000.0 * motion_norm_xz) * speed;
+                            {
+                                std::lock_guard<std::mutex> player_lock(local_player->GetMutex());
+                                local_player->AddPlayerInputsX(delta_v.x);
+                                local_player->SetY(local_player->GetY() + 0.001);
+                                local_player->AddPlayerInputsZ(delta_v.z);
+                            }
+                            previous_step = now;
                         }
-                        previous_step = now;
+                        client.Yield();
                     }
-                    client.Yield();
                 }
 
                 // Wait for the confirmation that we arrived at the destination
-                start = std::chrono::steady_clock::now();
+                auto start = VirtualClock::now();
                 bool has_timeout = false;
                 while (true)
                 {
-                    if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= 3000)
+                    if (std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now() - start).count() >= 3000)
                     {
                         has_timeout = true;
                         break;
@@ -562,6 +2370,7 @@ namespace Botcraft
                 }
 
                 current_position = Position(std::floor(local_player->GetPosition().x), std::floor(local_player->GetPosition().y), std::floor(local_player->GetPosition().z));
+                i = static_cast<int>(last);
 
                 if (has_timeout)
                 {
@@ -595,6 +2404,134 @@ namespace Botcraft
         return GoTo(client, goal, dist_tolerance, min_end_dist, speed, allow_jump);
     }
 
+    const std::vector<size_t> OrderVisits(const std::shared_ptr<World>& world, const Position& start, const std::vector<Position>& targets)
+    {
+        const size_t n = targets.size();
+        std::vector<size_t> order;
+        order.reserve(n);
+        if (n == 0)
+        {
+            return order;
+        }
+
+        // Estimated path distances, the manhattan distance tightened
+        // with the landmark lower bound if landmarks are set for this world.
+        // Index 0 is start, i + 1 is targets[i]
+        const std::shared_ptr<const LandmarkTable> landmarks = world == nullptr ? nullptr : PathLandmarks::GetInstance().Get(world, world->GetSnapshot());
+        std::vector<const float*> landmark_distances(n + 1, nullptr);
+        if (landmarks != nullptr)
+        {
+            landmark_distances[0] = landmarks->Get(start);
+            for (size_t i = 0; i < n; ++i)
+            {
+                landmark_distances[i + 1] = landmarks->Get(targets[i]);
+            }
+        }
+        std::vector<float> distances((n + 1) * (n + 1), 0.0f);
+        for (size_t i = 0; i < n + 1; ++i)
+        {
+            const Position& a = i == 0 ? start : targets[i - 1];
+            for (size_t j = i + 1; j < n + 1; ++j)
+            {
+                const Position& b = targets[j - 1];
+                float d = static_cast<float>(std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z));
+                if (landmark_distances[i] != nullptr && landmark_distances[j] != nullptr)
+                {
+                    for (size_t k = 0; k < landmarks->landmarks.size(); ++k)
+                    {
+                        const float bound = std::abs(landmark_distances[i][k] - landmark_distances[j][k]);
+                        if (bound > d && bound != std::numeric_limits<float>::infinity())
+                        {
+                            d = bound;
+                        }
+                    }
+                }
+                distances[i * (n + 1) + j] = d;
+                distances[j * (n + 1) + i] = d;
+            }
+        }
+        const auto Distance = [&](const size_t a, const size_t b)
+        {
+            return distances[a * (n + 1) + b];
+        };
+
+        // Nearest neighbour tour (on node indices, start excluded)
+        std::vector<size_t> tour;
+        tour.reserve(n);
+        std::vector<bool> visited(n + 1, false);
+        size_t current = 0;
+        for (size_t step = 0; step < n; ++step)
+        {
+            size_t best = 0;
+            float best_distance = std::numeric_limits<float>::max();
+            for (size_t i = 1; i < n + 1; ++i)
+            {
+                if (!visited[i] && Distance(current, i) < best_distance)
+                {
+                    best_distance = Distance(current, i);
+                    best = i;
+                }
+            }
+            visited[best] = true;
+            tour.push_back(best);
+            current = best;
+        }
+
+        // 2-opt on the open tour: reversing tour[i..j] replaces edges
+        // (prev(i), i) and (j, next(j)) by (prev(i), j) and (i, next(j))
+        bool improved = true;
+        for (int pass = 0; improved && pass < 50; ++pass)
+        {
+            improved = false;
+            for (size_t i = 0; i + 1 < n; ++i)
+            {
+                const size_t prev = i == 0 ? 0 : tour[i - 1];
+                for (size_t j = i + 1; j < n; ++j)
+                {
+                    const float before = Distance(prev, tour[i]) + (j + 1 < n ? Distance(tour[j], tour[j + 1]) : 0.0f);
+                    const float after = Distance(prev, tour[j]) + (j + 1 < n ? Distance(tour[i], tour[j + 1]) : 0.0f);
+                    if (after + 1e-3f < before)
+                    {
+                        std::reverse(tour.begin() + i, tour.begin() + j + 1);
+                        improved = true;
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            order.push_back(tour[i] - 1);
+        }
+        return order;
+    }
+
+    Status VisitPositions(BehaviourClient& client, const std::vector<Position>& targets, const std::function<Status(BehaviourClient&, const Position&)>& action,
+        const int dist_tolerance, const int min_end_dist, const float speed, const bool allow_jump)
+    {
+        Position start;
+        {
+            std::shared_ptr<LocalPlayer> local_player = client.GetEntityManager()->GetLocalPlayer();
+            std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
+            const Vector3<double> position = local_player->GetPosition();
+            start = Position(std::floor(position.x), std::floor(position.y), std::floor(position.z));
+        }
+
+        for (const size_t i : OrderVisits(client.GetWorld(), start, targets))
+        {
+            if (GoTo(client, targets[i], dist_tolerance, min_end_dist, speed, allow_jump) == Status::Failure)
+            {
+                return Status::Failure;
+            }
+            if (action && action(client, targets[i]) == Status::Failure)
+            {
+                return Status::Failure;
+            }
+        }
+
+        return Status::Success;
+    }
+
     Status LookAt(BehaviourClient& client, const Vector3<double>& target, const bool set_pitch)
     {
         {
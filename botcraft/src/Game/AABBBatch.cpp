@@ -0,0 +1,191 @@
+#include "botcraft/Game/AABBBatch.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace Botcraft
+{
+    /// @brief Compute the entry and exit fractions on one axis,
+    /// same as AABB::SweptCollide
+    static inline void SweptAxis(const double speed, const double box_min, const double box_max,
+        const double b_min, const double b_max, double& entry_dist, double& time_entry, double& time_exit)
+    {
+        entry_dist = speed > 0.0 ? b_min - box_max : b_max - box_min;
+        const double exit_dist = speed > 0.0 ? b_max - box_min : b_min - box_max;
+        time_entry = speed == 0.0 ? -std::numeric_limits<double>::infinity() : entry_dist / speed;
+        time_exit = speed == 0.0 ? std::numeric_limits<double>::infinity() : exit_dist / speed;
+        time_entry = time_entry > 1.0 ? -std::numeric_limits<double>::infinity() : time_entry;
+    }
+
+    AABBBatch::AABBBatch()
+    {
+
+    }
+
+    void AABBBatch::Clear()
+    {
+        min_x.clear();
+        min_y.clear();
+        min_z.clear();
+        max_x.clear();
+        max_y.clear();
+        max_z.clear();
+    }
+
+    void AABBBatch::Reserve(const size_t n)
+    {
+        min_x.reserve(n);
+        min_y.reserve(n);
+        min_z.reserve(n);
+        max_x.reserve(n);
+        max_y.reserve(n);
+        max_z.reserve(n);
+    }
+
+    void AABBBatch::Add(const AABB& box)
+    {
+        const Vector3<double> min = box.GetMin();
+        const Vector3<double> max = box.GetMax();
+        min_x.push_back(min.x);
+        min_y.push_back(min.y);
+        min_z.push_back(min.z);
+        max_x.push_back(max.x);
+        max_y.push_back(max.y);
+        max_z.push_back(max.z);
+    }
+
+    const size_t AABBBatch::Size() const
+    {
+        return min_x.size();
+    }
+
+    const AABB AABBBatch::Get(const size_t i) const
+    {
+        const Vector3<double> min(min_x[i], min_y[i], min_z[i]);
+        const Vector3<double> max(max_x[i], max_y[i], max_z[i]);
+        return AABB((min + max) / 2.0, (max - min) / 2.0);
+    }
+
+    void AABBBatch::Collide(const AABB& box, std::vector<char>& hits) const
+    {
+        const size_t n = Size();
+        hits.resize(n);
+
+        const Vector3<double> box_min = box.GetMin();
+        const Vector3<double> box_max = box.GetMax();
+
+        const double* min_x_ = min_x.data();
+        const double* min_y_ = min_y.data();
+        const double* min_z_ = min_z.data();
+        const double* max_x_ = max_x.data();
+        const double* max_y_ = max_y.data();
+        const double* max_z_ = max_z.data();
+        char* hits_ = hits.data();
+        for (size_t i = 0; i < n; ++i)
+        {
+            hits_[i] = (box_min.x <= max_x_[i]) & (box_max.x >= min_x_[i]) &
+                (box_min.y <= max_y_[i]) & (box_max.y >= min_y_[i]) &
+                (box_min.z <= max_z_[i]) & (box_max.z >= min_z_[i]);
+        }
+    }
+
+    const int AABBBatch::AnyCollide(const AABB& box) const
+    {
+        const Vector3<double> box_min = box.GetMin();
+        const Vector3<double> box_max = box.GetMax();
+
+        // Process by blocks so the inner loop stays branchless
+        constexpr size_t block_size = 16;
+        const size_t n = Size();
+        for (size_t start = 0; start < n; start += block_size)
+        {
+            const size_t end = std::min(n, start + block_size);
+            bool any = false;
+            for (size_t i = start; i < end; ++i)
+            {
+                any |= (box_min.x <= max_x[i]) & (box_max.x >= min_x[i]) &
+                    (box_min.y <= max_y[i]) & (box_max.y >= min_y[i]) &
+                    (box_min.z <= max_z[i]) & (box_max.z >= min_z[i]);
+            }
+            if (!any)
+            {
+                continue;
+            }
+            for (size_t i = start; i < end; ++i)
+            {
+                if ((box_min.x <= max_x[i]) & (box_max.x >= min_x[i]) &
+                    (box_min.y <= max_y[i]) & (box_max.y >= min_y[i]) &
+                    (box_min.z <= max_z[i]) & (box_max.z >= min_z[i]))
+                {
+                    return static_cast<int>(i);
+                }
+            }
+        }
+        return -1;
+    }
+
+    const double AABBBatch::SweptCollide(const AABB& box, const Vector3<double>& speed, Vector3<double>& normal, int& index) const
+    {
+        index = -1;
+
+        const Vector3<double> box_min = box.GetMin();
+        const Vector3<double> box_max = box.GetMax();
+
+        const size_t n = Size();
+        double best_time = 1.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double dist_x, entry_x, exit_x, dist_y, entry_y, exit_y, dist_z, entry_z, exit_z;
+            SweptAxis(speed.x, box_min.x, box_max.x, min_x[i], max_x[i], dist_x, entry_x, exit_x);
+            SweptAxis(speed.y, box_min.y, box_max.y, min_y[i], max_y[i], dist_y, entry_y, exit_y);
+            SweptAxis(speed.z, box_min.z, box_max.z, min_z[i], max_z[i], dist_z, entry_z, exit_z);
+
+            const double time_entry = std::max(std::max(entry_x, entry_y), entry_z);
+            const double time_exit = std::min(std::min(exit_x, exit_y), exit_z);
+
+            const bool hit = !(time_entry > time_exit || (entry_x < 0.0 && entry_y < 0.0 && entry_z < 0.0));
+            const double time = hit ? time_entry : 1.0;
+            best_time = time < best_time ? time : best_time;
+        }
+
+        if (best_time >= 1.0)
+        {
+            return 1.0;
+        }
+
+        // Find which box gave the earliest hit, with
+        // the exact same computation, and get its normal
+        for (size_t i = 0; i < n; ++i)
+        {
+            double dist_x, entry_x, exit_x, dist_y, entry_y, exit_y, dist_z, entry_z, exit_z;
+            SweptAxis(speed.x, box_min.x, box_max.x, min_x[i], max_x[i], dist_x, entry_x, exit_x);
+            SweptAxis(speed.y, box_min.y, box_max.y, min_y[i], max_y[i], dist_y, entry_y, exit_y);
+            SweptAxis(speed.z, box_min.z, box_max.z, min_z[i], max_z[i], dist_z, entry_z, exit_z);
+
+            const double time_entry = std::max(std::max(entry_x, entry_y), entry_z);
+            const double time_exit = std::min(std::min(exit_x, exit_y), exit_z);
+
+            if (time_entry > time_exit || (entry_x < 0.0 && entry_y < 0.0 && entry_z < 0.0) || time_entry != best_time)
+            {
+                continue;
+            }
+
+            if (entry_x > entry_y && entry_x > entry_z)
+            {
+                normal = Vector3<double>(dist_x < 0.0 ? 1.0 : -1.0, 0.0, 0.0);
+            }
+            else if (entry_y > entry_x && entry_y > entry_z)
+            {
+                normal = Vector3<double>(0.0, dist_y < 0.0 ? 1.0 : -1.0, 0.0);
+            }
+            else
+            {
+                normal = Vector3<double>(0.0, 0.0, dist_z < 0.0 ? 1.0 : -1.0);
+            }
+            index = static_cast<int>(i);
+            break;
+        }
+
+        return best_time;
+    }
+} // Botcraft
@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <future>
+#include <mutex>
 #include <sstream>
+#include <set>
 
 #include "botcraft/Game/AssetsManager.hpp"
 #include "botcraft/Game/World/Block.hpp"
@@ -12,8 +17,59 @@
 
 #include <nlohmann/json.hpp>
 
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+using namespace ProtocolCraft;
+
 namespace Botcraft
 {
+    // Bundle files start with this, followed by the protocol version and the assets key
+    static const std::string bundle_file_magic = "BCAB1";
+
+    // FNV-1a hash of the assets files paths, sizes and modification times,
+    // to know if a bundle is still valid without reading the files
+    static const unsigned long long ComputeAssetsKey()
+    {
+        unsigned long long key = 14695981039346656037ULL;
+        auto hash_bytes = [&key](const void* bytes, const size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                key ^= static_cast<const unsigned char*>(bytes)[i];
+                key *= 1099511628211ULL;
+            }
+        };
+
+        for (const std::string folder : { "/custom", "/minecraft/blockstates", "/minecraft/models" })
+        {
+            std::error_code ec;
+            std::vector<std::pair<std::string, std::filesystem::directory_entry> > entries;
+            for (auto it = std::filesystem::recursive_directory_iterator(ASSETS_PATH + folder,
+                std::filesystem::directory_options::follow_directory_symlink, ec);
+                !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+            {
+                if (it->is_regular_file(ec))
+                {
+                    entries.push_back({ it->path().generic_string(), *it });
+                }
+            }
+            // Iteration order is not specified
+            std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            for (const auto& e : entries)
+            {
+                hash_bytes(e.first.data(), e.first.size() + 1);
+                const long long file_size = static_cast<long long>(e.second.file_size(ec));
+                hash_bytes(&file_size, sizeof(file_size));
+                const long long write_time = static_cast<long long>(e.second.last_write_time(ec).time_since_epoch().count());
+                hash_bytes(&write_time, sizeof(write_time));
+            }
+        }
+        return key;
+    }
+
+    static AssetsProfile assets_profile = AssetsProfile::Full;
+
     AssetsManager& AssetsManager::getInstance()
     {
         static AssetsManager instance;
@@ -21,29 +77,140 @@ namespace Botcraft
         return instance;
     }
 
+    void AssetsManager::SetProfile(const AssetsProfile profile)
+    {
+        assets_profile = profile;
+    }
+
+    void AssetsManager::Preload()
+    {
+        static std::once_flag preload_flag;
+        // Kept until exit so the program doesn't end while the instance is being constructed
+        static std::future<void> preload;
+        std::call_once(preload_flag, []()
+            {
+                preload = std::async(std::launch::async, []()
+                    {
+                        Logger::GetInstance().RegisterThread("AssetsPreload");
+                        // The static instance initialization is thread safe, other getInstance() calls block until it's done
+                        getInstance();
+                    });
+            });
+    }
+
     AssetsManager::AssetsManager()
     {
-        LOG_INFO("Loading blocks from file...");
-        LoadBlocksFile();
-        LOG_INFO("Done!");
-        LOG_INFO("Loading biomes from file...");
-        LoadBiomesFile();
-        LOG_INFO("Done!");
-        LOG_INFO("Loading items from file...");
-        LoadItemsFile();
-        LOG_INFO("Done!");
+        default_item = nullptr;
+        std::chrono::steady_clock::time_point step_start = std::chrono::steady_clock::now();
+        // Add the time since step_start to loading_timings and start a new step
+        const auto end_step = [this, &step_start](const std::string& category)
+        {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            loading_timings.push_back({ category, std::chrono::duration<double, std::milli>(now - step_start).count() });
+            step_start = now;
+        };
 #if USE_GUI
-        LOG_INFO("Loading textures...");
-        atlas = std::make_unique<Renderer::Atlas>();
-        LoadTextures();
-        LOG_INFO("Done!");
-        LOG_INFO("Updating models with Atlas data...");
-        UpdateModelsWithAtlasData();
-        LOG_INFO("Done!");
+        // The bundle doesn't have the models rendering data
+        const bool use_bundle = assets_profile == AssetsProfile::CollisionOnly;
+#else
+        const bool use_bundle = true;
+#endif
+        const std::string bundle_path = ASSETS_PATH + std::string("/assets_bundle.bin");
+        bool bundle_loaded = false;
+        if (use_bundle)
+        {
+            LOG_INFO("Loading assets bundle...");
+            bundle_loaded = LoadAssetsBundle(bundle_path);
+            LOG_INFO((bundle_loaded ? "Done!" : "No valid bundle found"));
+            end_step("bundle");
+        }
+        if (bundle_loaded)
+        {
+            IndexBlockstates();
+            IndexItems();
+            end_step("index");
+        }
+        else
+        {
+            LOG_INFO("Loading blocks, biomes and items from files...");
+            // The three files fill independent containers, biomes and items
+            // are parsed on other threads while the blocks are loaded here
+            const auto timed_load = [this, step_start](void (AssetsManager::*load)())
+            {
+                (this->*load)();
+                return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - step_start).count();
+            };
+            std::future<double> biomes_loaded = std::async(std::launch::async, timed_load, &AssetsManager::LoadBiomesFile);
+            std::future<double> items_loaded = std::async(std::launch::async, timed_load, &AssetsManager::LoadItemsFile);
+            LoadBlocksFile();
+            IndexBlockstates();
+            end_step("blocks");
+            loading_timings.push_back({ "biomes", biomes_loaded.get() });
+            loading_timings.push_back({ "items", items_loaded.get() });
+            step_start = std::chrono::steady_clock::now();
+            LOG_INFO("Done!");
+            if (use_bundle)
+            {
+                SaveAssetsBundle(bundle_path);
+#if USE_GUI
+                ClearRenderingData();
+#endif
+                end_step("bundle_save");
+            }
+        }
+#if USE_GUI
+        if (assets_profile == AssetsProfile::Full)
+        {
+            LOG_INFO("Loading textures...");
+            atlas = std::make_unique<Renderer::Atlas>();
+            LoadTextures();
+            LOG_INFO("Done!");
+            end_step("textures");
+            LOG_INFO("Updating models with Atlas data...");
+            UpdateModelsWithAtlasData();
+            LOG_INFO("Done!");
+            end_step("models");
+        }
 #endif
         LOG_INFO("Clearing cache from memory...");
         ClearCaches();
         LOG_INFO("Done!");
+        end_step("caches");
+    }
+
+    const std::vector<std::pair<std::string, double> >& AssetsManager::GetLoadingTimings() const
+    {
+        return loading_timings;
+    }
+
+    const size_t AssetsManager::GetMemoryUsage() const
+    {
+        size_t output = sizeof(AssetsManager) +
+            blockstate_flags.capacity() * sizeof(unsigned short) +
+            blockstates_by_id.capacity() * sizeof(const Blockstate*) +
+            // Hash nodes have a pointer to the next one on top of the value
+            item_ids_by_name.size() * (sizeof(void*) + sizeof(decltype(item_ids_by_name)::value_type));
+#if PROTOCOL_VERSION < 347
+        for (const auto& p : blockstates)
+        {
+            for (const auto& p2 : p.second)
+            {
+                output += p2.second->GetMemoryUsage();
+            }
+        }
+        for (const auto& p : items)
+        {
+            output += p.second.size() * sizeof(Item);
+        }
+#else
+        for (const auto& p : blockstates)
+        {
+            output += p.second->GetMemoryUsage();
+        }
+        output += items.size() * sizeof(Item) + items_by_id.capacity() * sizeof(const Item*);
+#endif
+        output += biomes.size() * sizeof(Biome);
+        return output;
     }
 
 #if PROTOCOL_VERSION < 347
@@ -55,6 +222,24 @@ namespace Botcraft
         return blockstates;
     }
 
+    const unsigned short AssetsManager::GetBlockstateFlags(const int id) const
+    {
+        if (id < 0 || id >= static_cast<int>(blockstate_flags.size()))
+        {
+            return default_blockstate_flags;
+        }
+        return blockstate_flags[id];
+    }
+
+    const Blockstate* AssetsManager::GetBlockstate(const int id) const
+    {
+        if (id < 0 || id >= static_cast<int>(blockstates_by_id.size()))
+        {
+            return default_blockstate;
+        }
+        return blockstates_by_id[id];
+    }
+
 #if PROTOCOL_VERSION < 358
     const std::unordered_map<unsigned char, std::unique_ptr<Biome> >& AssetsManager::Biomes() const
 #else
@@ -91,31 +276,48 @@ namespace Botcraft
     }
 
 #if PROTOCOL_VERSION < 347
-    const std::pair<int, unsigned char> AssetsManager::GetItemID(const std::string& item_name) const
+    const std::pair<int, unsigned char> AssetsManager::GetItemID(const std::string_view item_name) const
     {
-        for (const auto& p : items)
+        auto it = item_ids_by_name.find(item_name);
+        if (it == item_ids_by_name.end())
         {
-            for (const auto& p2 : p.second)
-            {
-                if (p2.second->GetName() == item_name)
-                {
-                    return { p.first, p2.first };
-                }
-            }
+            return { -1, 0 };
         }
-        return { -1, 0 };
+        return it->second;
+    }
+
+    const Item* AssetsManager::GetItem(const int id, const unsigned char damage_id) const
+    {
+        auto it = items.find(id);
+        if (it == items.end())
+        {
+            return default_item;
+        }
+        auto it2 = it->second.find(damage_id);
+        if (it2 == it->second.end())
+        {
+            return default_item;
+        }
+        return it2->second.get();
     }
 #else
-    const int AssetsManager::GetItemID(const std::string& item_name) const
+    const int AssetsManager::GetItemID(const std::string_view item_name) const
     {
-        for (const auto& p : items)
+        auto it = item_ids_by_name.find(item_name);
+        if (it == item_ids_by_name.end())
         {
-            if (p.second->GetName() == item_name)
-            {
-                return p.first;
-            }
+            return -1;
         }
-        return -1;
+        return it->second;
+    }
+
+    const Item* AssetsManager::GetItem(const int id) const
+    {
+        if (id < 0 || id >= static_cast<int>(items_by_id.size()) || items_by_id[id] == nullptr)
+        {
+            return default_item;
+        }
+        return items_by_id[id];
     }
 #endif
 
@@ -671,6 +873,42 @@ namespace Botcraft
             items[id] = std::make_unique<Item>(id, item_name, stack_size);
 #endif
         }
+
+        IndexItems();
+    }
+
+    void AssetsManager::IndexItems()
+    {
+        item_ids_by_name.clear();
+#if PROTOCOL_VERSION < 347
+        default_item = items[-1][0].get();
+        for (const auto& p : items)
+        {
+            for (const auto& p2 : p.second)
+            {
+                if (p.first != -1)
+                {
+                    item_ids_by_name[p2.second->GetName()] = { p.first, p2.first };
+                }
+            }
+        }
+#else
+        default_item = items[-1].get();
+        items_by_id.clear();
+        for (const auto& p : items)
+        {
+            if (p.first < 0)
+            {
+                continue;
+            }
+            item_ids_by_name[p.second->GetName()] = p.first;
+            if (p.first >= static_cast<int>(items_by_id.size()))
+            {
+                items_by_id.resize(p.first + 1, nullptr);
+            }
+            items_by_id[p.first] = p.second.get();
+        }
+#endif
     }
 
 #if USE_GUI
@@ -723,17 +961,344 @@ namespace Botcraft
             paths.push_back({ (ASSETS_PATH + std::string("/minecraft/textures/") + *it + ".png") , *it });
         }
 
-        atlas->LoadData(paths);
+        atlas->LoadData(paths, ASSETS_PATH + std::string("/atlas_cache.bin"));
     }
 #endif
 
+    static const unsigned short ComputeFlags(const Blockstate* blockstate)
+    {
+        static const std::set<std::string> climbable_blocks = {
+            "minecraft:ladder",
+            "minecraft:vine",
+            "minecraft:scaffolding",
+            "minecraft:weeping_vines",
+            "minecraft:weeping_vines_plant",
+            "minecraft:twisting_vines",
+            "minecraft:twisting_vines_plant",
+            "minecraft:cave_vines",
+            "minecraft:cave_vines_plant"
+        };
+        static const std::set<std::string> hazardous_blocks = {
+            "minecraft:lava",
+            "minecraft:flowing_lava",
+            "minecraft:fire",
+            "minecraft:soul_fire",
+            "minecraft:magma_block",
+            "minecraft:cactus",
+            "minecraft:sweet_berry_bush",
+            "minecraft:campfire",
+            "minecraft:soul_campfire",
+            "minecraft:wither_rose",
+            "minecraft:powder_snow"
+        };
+
+        const std::string& name = blockstate->GetName();
+        unsigned short flags = static_cast<unsigned short>(BlockstateFlag::None);
+        if (blockstate->IsAir())
+        {
+            flags |= static_cast<unsigned short>(BlockstateFlag::Air);
+        }
+        if (blockstate->IsSolid())
+        {
+            flags |= static_cast<unsigned short>(BlockstateFlag::Solid);
+        }
+        if (blockstate->IsTransparent())
+        {
+            flags |= static_cast<unsigned short>(BlockstateFlag::Transparent);
+        }
+        if (blockstate->IsFluid())
+        {
+            flags |= static_cast<unsigned short>(BlockstateFlag::Fluid);
+            // Before 1.13, flowing water/lava are separate blocks
+            if (name == "minecraft:water" || name == "minecraft:flowing_water")
+            {
+                flags |= static_cast<unsigned short>(BlockstateFlag::Water);
+            }
+            else if (name == "minecraft:lava" || name == "minecraft:flowing_lava")
+            {
+                flags |= static_cast<unsigned short>(BlockstateFlag::Lava);
+            }
+        }
+        if (climbable_blocks.find(name) != climbable_blocks.end())
+        {
+            flags |= static_cast<unsigned short>(BlockstateFlag::Climbable);
+        }
+        if (hazardous_blocks.find(name) != hazardous_blocks.end())
+        {
+            flags |= static_cast<unsigned short>(BlockstateFlag::Hazardous);
+        }
+        if (blockstate->IsSolid() && blockstate->GetNumModels() > 0)
+        {
+            bool full_cube = true;
+            for (int i = 0; i < blockstate->GetNumModels() && full_cube; ++i)
+            {
+                const std::vector<AABB>& colliders = blockstate->GetModel(i).GetColliders();
+                full_cube = colliders.size() == 1 &&
+                    colliders[0].GetMin() == Vector3<double>(0.0, 0.0, 0.0) &&
+                    colliders[0].GetMax() == Vector3<double>(1.0, 1.0, 1.0);
+            }
+            if (full_cube)
+            {
+                flags |= static_cast<unsigned short>(BlockstateFlag::FullCube);
+            }
+        }
+        return flags;
+    }
+
+    void AssetsManager::IndexBlockstates()
+    {
+        blockstate_flags.clear();
+        blockstates_by_id.clear();
+#if PROTOCOL_VERSION < 347
+        default_blockstate = blockstates.at(-1).at(0).get();
+        default_blockstate_flags = ComputeFlags(default_blockstate);
+        for (auto it = blockstates.begin(); it != blockstates.end(); ++it)
+        {
+            if (it->first < 0)
+            {
+                continue;
+            }
+            for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+            {
+                const unsigned int id = Blockstate::IdMetadataToId(it->first, it2->first);
+                if (id >= blockstate_flags.size())
+                {
+                    blockstate_flags.resize(id + 1, default_blockstate_flags);
+                    blockstates_by_id.resize(id + 1, default_blockstate);
+                }
+                blockstate_flags[id] = ComputeFlags(it2->second.get());
+                blockstates_by_id[id] = it2->second.get();
+            }
+        }
+        // Unknown metadata use the blockstate with metadata 0
+        for (auto it = blockstates.begin(); it != blockstates.end(); ++it)
+        {
+            if (it->first < 0 || it->second.find(0) == it->second.end())
+            {
+                continue;
+            }
+            for (unsigned char metadata = 0; metadata < 16; ++metadata)
+            {
+                if (it->second.find(metadata) == it->second.end())
+                {
+                    const unsigned int id = Blockstate::IdMetadataToId(it->first, metadata);
+                    if (id >= blockstate_flags.size())
+                    {
+                        blockstate_flags.resize(id + 1, default_blockstate_flags);
+                        blockstates_by_id.resize(id + 1, default_blockstate);
+                    }
+                    blockstate_flags[id] = blockstate_flags[Blockstate::IdMetadataToId(it->first, 0)];
+                    blockstates_by_id[id] = blockstates_by_id[Blockstate::IdMetadataToId(it->first, 0)];
+                }
+            }
+        }
+#else
+        default_blockstate = blockstates.at(-1).get();
+        default_blockstate_flags = ComputeFlags(default_blockstate);
+        for (auto it = blockstates.begin(); it != blockstates.end(); ++it)
+        {
+            if (it->first < 0)
+            {
+                continue;
+            }
+            if (it->first >= static_cast<int>(blockstate_flags.size()))
+            {
+                blockstate_flags.resize(it->first + 1, default_blockstate_flags);
+                blockstates_by_id.resize(it->first + 1, default_blockstate);
+            }
+            blockstate_flags[it->first] = ComputeFlags(it->second.get());
+            blockstates_by_id[it->first] = it->second.get();
+        }
+#endif
+    }
+
     void AssetsManager::ClearCaches()
     {
         Blockstate::ClearCache();
         Model::ClearCache();
     }
 
+    const bool AssetsManager::LoadAssetsBundle(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        std::vector<unsigned char> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+        file.close();
+
+        try
+        {
+            ReadIterator iter = data.data();
+            size_t length = data.size();
+
+            if (ReadRawString(iter, length, static_cast<int>(bundle_file_magic.size())) != bundle_file_magic ||
+                ReadData<int>(iter, length) != PROTOCOL_VERSION ||
+                ReadData<unsigned long long>(iter, length) != ComputeAssetsKey())
+            {
+                return false;
+            }
+
+            const int num_blockstates = ReadData<VarInt>(iter, length);
+            for (int i = 0; i < num_blockstates; ++i)
+            {
+                std::unique_ptr<Blockstate> blockstate = Blockstate::Read(iter, length);
+#if PROTOCOL_VERSION < 347
+                const int id = blockstate->GetId();
+                const unsigned char metadata = blockstate->GetMetadata();
+                blockstates[id][metadata] = std::move(blockstate);
+#else
+                const int id = blockstate->GetId();
+                blockstates[id] = std::move(blockstate);
+#endif
+            }
+
+            const int num_biomes = ReadData<VarInt>(iter, length);
+            for (int i = 0; i < num_biomes; ++i)
+            {
+#if PROTOCOL_VERSION < 358
+                const unsigned char id = ReadData<unsigned char>(iter, length);
+#else
+                const int id = ReadData<int>(iter, length);
+#endif
+                biomes[id] = Biome::Read(iter, length);
+            }
+
+            const int num_items = ReadData<VarInt>(iter, length);
+            for (int i = 0; i < num_items; ++i)
+            {
+                const int id = ReadData<int>(iter, length);
+#if PROTOCOL_VERSION < 347
+                const unsigned char damage_id = ReadData<unsigned char>(iter, length);
+#endif
+                const std::string name = ReadData<std::string>(iter, length);
+                const unsigned char stack_size = ReadData<unsigned char>(iter, length);
+#if PROTOCOL_VERSION < 347
+                items[id][damage_id] = std::make_unique<Item>(id, damage_id, name, stack_size);
+#else
+                items[id] = std::make_unique<Item>(id, name, stack_size);
+#endif
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARNING("Invalid assets bundle file " << path << ": " << e.what());
+            blockstates.clear();
+            biomes.clear();
+            items.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    void AssetsManager::SaveAssetsBundle(const std::string& path) const
+    {
+        std::vector<unsigned char> data;
+        WriteRawString(bundle_file_magic, data);
+        WriteData<int>(PROTOCOL_VERSION, data);
+        WriteData<unsigned long long>(ComputeAssetsKey(), data);
+
+#if PROTOCOL_VERSION < 347
+        int num_blockstates = 0;
+        for (const auto& p : blockstates)
+        {
+            num_blockstates += static_cast<int>(p.second.size());
+        }
+        WriteData<VarInt>(num_blockstates, data);
+        for (const auto& p : blockstates)
+        {
+            for (const auto& p2 : p.second)
+            {
+                p2.second->Write(data);
+            }
+        }
+#else
+        WriteData<VarInt>(static_cast<int>(blockstates.size()), data);
+        for (const auto& p : blockstates)
+        {
+            p.second->Write(data);
+        }
+#endif
+
+        WriteData<VarInt>(static_cast<int>(biomes.size()), data);
+        for (const auto& p : biomes)
+        {
+#if PROTOCOL_VERSION < 358
+            WriteData<unsigned char>(p.first, data);
+#else
+            WriteData<int>(p.first, data);
+#endif
+            p.second->Write(data);
+        }
+
+#if PROTOCOL_VERSION < 347
+        int num_items = 0;
+        for (const auto& p : items)
+        {
+            num_items += static_cast<int>(p.second.size());
+        }
+        WriteData<VarInt>(num_items, data);
+        for (const auto& p : items)
+        {
+            for (const auto& p2 : p.second)
+            {
+                WriteData<int>(p.first, data);
+                WriteData<unsigned char>(p2.first, data);
+                WriteData<std::string>(p2.second->GetName(), data);
+                WriteData<unsigned char>(p2.second->GetStackSize(), data);
+            }
+        }
+#else
+        WriteData<VarInt>(static_cast<int>(items.size()), data);
+        for (const auto& p : items)
+        {
+            WriteData<int>(p.first, data);
+            WriteData<std::string>(p.second->GetName(), data);
+            WriteData<unsigned char>(p.second->GetStackSize(), data);
+        }
+#endif
+
+        // Write in a temporary file first, so a crash
+        // while writing doesn't leave an invalid bundle
+        const std::string tmp_path = path + ".tmp";
+        std::ofstream file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_WARNING("Can't open assets bundle file " << tmp_path << " for writing");
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.close();
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec)
+        {
+            LOG_WARNING("Can't write assets bundle file " << path << " (" << ec.message() << ")");
+        }
+    }
+
 #if USE_GUI
+    void AssetsManager::ClearRenderingData()
+    {
+        for (auto it = blockstates.begin(); it != blockstates.end(); ++it)
+        {
+#if PROTOCOL_VERSION < 347
+            for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+            {
+                it2->second->ClearRenderingData();
+            }
+#else
+            it->second->ClearRenderingData();
+#endif
+        }
+    }
+
     void AssetsManager::UpdateModelsWithAtlasData()
     {
         for (auto it = blockstates.begin(); it != blockstates.end(); ++it)
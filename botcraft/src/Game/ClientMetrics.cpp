@@ -0,0 +1,204 @@
+#include "botcraft/Game/ClientMetrics.hpp"
+
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+namespace Botcraft
+{
+    static std::string EscapeLabel(const std::string& s)
+    {
+        std::string output;
+        output.reserve(s.size());
+        for (const char c : s)
+        {
+            switch (c)
+            {
+            case '\\':
+                output += "\\\\";
+                break;
+            case '"':
+                output += "\\\"";
+                break;
+            case '\n':
+                output += "\\n";
+                break;
+            default:
+                output += c;
+                break;
+            }
+        }
+        return output;
+    }
+
+    static std::string PacketIdLabel(const int id)
+    {
+        std::stringstream s;
+        s << "0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << id;
+        return s.str();
+    }
+
+    std::string MetricsToPrometheus(const std::vector<ClientMetrics>& metrics)
+    {
+        std::stringstream output;
+        output << std::setprecision(10);
+
+        // Write one metric family, with one value per bot
+        const auto write_family = [&](const std::string& name, const std::string& type, const std::string& help,
+            const std::function<double(const ClientMetrics&)>& value, const std::function<bool(const ClientMetrics&)>& filter = nullptr)
+        {
+            output << "# HELP " << name << " " << help << "\n";
+            output << "# TYPE " << name << " " << type << "\n";
+            for (const ClientMetrics& m : metrics)
+            {
+                if (filter == nullptr || filter(m))
+                {
+                    output << name << "{bot=\"" << EscapeLabel(m.name) << "\"} " << value(m) << "\n";
+                }
+            }
+        };
+
+        // Write one metric family, with one value per bot and packet id
+        const auto write_packet_family = [&](const std::string& name, const std::string& help, const bool clientbound,
+            const std::function<double(const PacketStats&)>& value)
+        {
+            output << "# HELP " << name << " " << help << "\n";
+            output << "# TYPE " << name << " counter\n";
+            for (const ClientMetrics& m : metrics)
+            {
+                const std::map<int, PacketStats>& packets = clientbound ? m.network.clientbound : m.network.serverbound;
+                for (auto it = packets.begin(); it != packets.end(); ++it)
+                {
+                    output << name << "{bot=\"" << EscapeLabel(m.name) << "\",id=\"" << PacketIdLabel(it->first) << "\"} " << value(it->second) << "\n";
+                }
+            }
+        };
+
+        write_family("botcraft_network_received_packets_total", "counter", "Packets received, ignored ones included",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.packets_in); });
+        write_family("botcraft_network_received_bytes_total", "counter", "Bytes received",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.bytes_in); });
+        write_family("botcraft_network_ignored_packets_total", "counter", "Packets dropped without parsing",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.packets_ignored); });
+        write_family("botcraft_network_sent_packets_total", "counter", "Packets sent",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.packets_out); });
+        write_family("botcraft_network_sent_bytes_total", "counter", "Bytes sent",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.bytes_out); });
+        write_family("botcraft_network_priority_packets_total", "counter", "Packets processed on the priority lane",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.packets_priority); });
+        write_family("botcraft_network_priority_queue_depth", "gauge", "Packets waiting on the priority lane",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.priority_queue_depth); });
+        write_family("botcraft_network_normal_queue_depth", "gauge", "Packets waiting on the normal lane",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.normal_queue_depth); });
+        write_family("botcraft_network_max_priority_queue_depth", "gauge", "Highest number of packets waiting on the priority lane",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.max_priority_queue_depth); });
+        write_family("botcraft_network_max_normal_queue_depth", "gauge", "Highest number of packets waiting on the normal lane",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.max_normal_queue_depth); });
+        write_family("botcraft_network_max_queue_lag_seconds", "gauge", "Longest time a received packet waited before being processed",
+            [](const ClientMetrics& m) { return m.network.max_queue_lag_ms / 1000.0; });
+        write_family("botcraft_network_read_pauses_total", "counter", "Times reading the socket was paused because too many packets were waiting",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.read_pauses); });
+        write_family("botcraft_network_queued_bytes", "gauge", "Bytes of the packets waiting on both lanes",
+            [](const ClientMetrics& m) { return static_cast<double>(m.network.queued_bytes); });
+        write_family("botcraft_network_read_paused", "gauge", "1 if reading the socket is paused because too many packets are waiting",
+            [](const ClientMetrics& m) { return m.network.read_paused ? 1.0 : 0.0; });
+
+        write_packet_family("botcraft_packet_received_total", "Play packets received by id", true,
+            [](const PacketStats& p) { return static_cast<double>(p.count); });
+        write_packet_family("botcraft_packet_received_bytes_total", "Uncompressed size of the Play packets received by id", true,
+            [](const PacketStats& p) { return static_cast<double>(p.bytes); });
+        write_packet_family("botcraft_packet_read_seconds_total", "Time spent parsing the Play packets received by id", true,
+            [](const PacketStats& p) { return p.read_time_ms / 1000.0; });
+        write_packet_family("botcraft_packet_handle_seconds_total", "Time spent in the handlers of the Play packets received by id", true,
+            [](const PacketStats& p) { return p.handle_time_ms / 1000.0; });
+        write_packet_family("botcraft_packet_sent_total", "Play packets sent by id", false,
+            [](const PacketStats& p) { return static_cast<double>(p.count); });
+        write_packet_family("botcraft_packet_sent_bytes_total", "Uncompressed size of the Play packets sent by id", false,
+            [](const PacketStats& p) { return static_cast<double>(p.bytes); });
+
+        write_family("botcraft_world_shared", "gauge", "1 if the world is shared with other bots",
+            [](const ClientMetrics& m) { return m.world_shared ? 1.0 : 0.0; });
+        write_family("botcraft_world_chunks", "gauge", "Loaded chunks",
+            [](const ClientMetrics& m) { return static_cast<double>(m.world.num_chunks); });
+        write_family("botcraft_world_sections", "gauge", "Sections in the loaded chunks",
+            [](const ClientMetrics& m) { return static_cast<double>(m.world.num_sections); });
+        write_family("botcraft_world_memory_bytes", "gauge", "Estimated memory used by the loaded chunks",
+            [](const ClientMetrics& m) { return static_cast<double>(m.world.memory_bytes); });
+        write_family("botcraft_world_sections_memory_bytes", "gauge", "Estimated memory used by the sections blocks",
+            [](const ClientMetrics& m) { return static_cast<double>(m.world.sections_memory_bytes); });
+        write_family("botcraft_world_light_memory_bytes", "gauge", "Estimated memory used by the sections light",
+            [](const ClientMetrics& m) { return static_cast<double>(m.world.light_memory_bytes); });
+        write_family("botcraft_world_block_entities_memory_bytes", "gauge", "Estimated memory used by the block entities and their NBT",
+            [](const ClientMetrics& m) { return static_cast<double>(m.world.block_entities_memory_bytes); });
+
+        write_family("botcraft_entities", "gauge", "Stored entities",
+            [](const ClientMetrics& m) { return static_cast<double>(m.entities.num_entities); });
+        write_family("botcraft_entities_stub", "gauge", "Stored entities tracked as stubs",
+            [](const ClientMetrics& m) { return static_cast<double>(m.entities.num_stubs); });
+        write_family("botcraft_entities_ignored", "gauge", "Entities ignored by the tracking filter",
+            [](const ClientMetrics& m) { return static_cast<double>(m.entities.num_ignored); });
+        write_family("botcraft_entities_visible", "gauge", "Entities visible by the bot when using a shared entity manager",
+            [](const ClientMetrics& m) { return static_cast<double>(m.entities.num_visible); });
+        write_family("botcraft_entities_pooled_blocks", "gauge", "Free entity memory blocks kept in the entity pool",
+            [](const ClientMetrics& m) { return static_cast<double>(m.entities.num_pooled_blocks); });
+        write_family("botcraft_entities_memory_bytes", "gauge", "Estimated memory used by the stored entities, metadata excluded",
+            [](const ClientMetrics& m) { return static_cast<double>(m.entities.entities_memory_bytes); });
+        write_family("botcraft_entities_metadata_memory_bytes", "gauge", "Estimated memory used by the metadata of the stored entities",
+            [](const ClientMetrics& m) { return static_cast<double>(m.entities.metadata_memory_bytes); });
+
+        write_family("botcraft_assets_memory_bytes", "gauge", "Estimated memory used by the loaded assets, shared by all the bots",
+            [](const ClientMetrics& m) { return static_cast<double>(m.assets_memory_bytes); });
+#if USE_GUI
+        write_family("botcraft_renderer_gpu_memory_bytes", "gauge", "GPU memory used by the renderer faces buffers",
+            [](const ClientMetrics& m) { return static_cast<double>(m.renderer_memory_bytes); });
+#endif
+
+        output << "# HELP botcraft_physics_tick_jitter_seconds Difference between the time elapsed since the previous physics tick and the tick duration\n";
+        output << "# TYPE botcraft_physics_tick_jitter_seconds histogram\n";
+        for (const ClientMetrics& m : metrics)
+        {
+            if (!m.has_physics)
+            {
+                continue;
+            }
+            const std::string bot_label = "bot=\"" + EscapeLabel(m.name) + "\"";
+            unsigned long long cumulative_count = 0;
+            for (size_t i = 0; i < PhysicsStats::num_jitter_buckets; ++i)
+            {
+                cumulative_count += m.physics.jitter_counts[i];
+                output << "botcraft_physics_tick_jitter_seconds_bucket{" << bot_label << ",le=\"";
+                if (i < PhysicsStats::num_jitter_buckets - 1)
+                {
+                    output << PhysicsStats::jitter_buckets_ms[i] / 1000.0;
+                }
+                else
+                {
+                    output << "+Inf";
+                }
+                output << "\"} " << cumulative_count << "\n";
+            }
+            output << "botcraft_physics_tick_jitter_seconds_sum{" << bot_label << "} " << m.physics.total_jitter_ms / 1000.0 << "\n";
+            output << "botcraft_physics_tick_jitter_seconds_count{" << bot_label << "} " << m.physics.num_ticks << "\n";
+        }
+        write_family("botcraft_physics_tick_max_jitter_seconds", "gauge", "Highest physics tick jitter",
+            [](const ClientMetrics& m) { return m.physics.max_jitter_ms / 1000.0; }, [](const ClientMetrics& m) { return m.has_physics; });
+        write_family("botcraft_physics_rest_ticks_total", "counter", "Physics ticks skipped because the player was at rest",
+            [](const ClientMetrics& m) { return static_cast<double>(m.physics.num_rest_ticks); }, [](const ClientMetrics& m) { return m.has_physics; });
+
+        const auto has_behaviour = [](const ClientMetrics& m) { return m.has_behaviour; };
+        write_family("botcraft_behaviour_steps_total", "counter", "Behaviour steps run",
+            [](const ClientMetrics& m) { return static_cast<double>(m.behaviour.num_steps); }, has_behaviour);
+        write_family("botcraft_behaviour_step_seconds_total", "counter", "Time spent in the behaviour steps",
+            [](const ClientMetrics& m) { return m.behaviour.total_step_time_ms / 1000.0; }, has_behaviour);
+        write_family("botcraft_behaviour_step_max_seconds", "gauge", "Longest behaviour step",
+            [](const ClientMetrics& m) { return m.behaviour.max_step_time_ms / 1000.0; }, has_behaviour);
+        write_family("botcraft_behaviour_budget_overruns_total", "counter", "Behaviour steps longer than the scheduler step budget",
+            [](const ClientMetrics& m) { return static_cast<double>(m.behaviour.num_budget_overruns); }, has_behaviour);
+        write_family("botcraft_behaviour_throttled_steps_total", "counter", "Behaviour steps skipped by the scheduler to pay back budget overruns",
+            [](const ClientMetrics& m) { return static_cast<double>(m.behaviour.num_throttled_steps); }, has_behaviour);
+        write_family("botcraft_behaviour_timers", "gauge", "Behaviour timers waiting to fire",
+            [](const ClientMetrics& m) { return static_cast<double>(m.behaviour.num_timers); }, has_behaviour);
+
+        return output.str();
+    }
+} // Botcraft
@@ -20,7 +20,41 @@ namespace Botcraft
     void ConnectionClient::Connect(const std::string& address, const std::string& login, const std::string& password, const bool force_microsoft_account)
     {
         network_manager = std::make_shared<NetworkManager>(address, login, password, force_microsoft_account);
+        server_address = address;
+        // The server can't answer before a network round trip, so no packet is missed
+        if (!capture_path.empty())
+        {
+            network_manager->StartCapture(capture_path);
+        }
+        network_manager->AddHandler(this);
+    }
+
+    void ConnectionClient::Reconnect()
+    {
+        if (!network_manager || server_address.empty())
+        {
+            throw std::runtime_error("Reconnect can only be called on a client previously connected with Connect");
+        }
+
+        network_manager = std::make_shared<NetworkManager>(server_address, *network_manager);
+        if (!capture_path.empty())
+        {
+            network_manager->StartCapture(capture_path);
+        }
+        network_manager->AddHandler(this);
+        should_be_closed = false;
+    }
+
+    void ConnectionClient::SetCapturePath(const std::string& path)
+    {
+        capture_path = path;
+    }
+
+    size_t ConnectionClient::Replay(const std::string& path, const double speed)
+    {
+        network_manager = std::make_shared<NetworkManager>(ProtocolCraft::ConnectionState::Login);
         network_manager->AddHandler(this);
+        return network_manager->Replay(path, speed);
     }
 
     void ConnectionClient::Disconnect()
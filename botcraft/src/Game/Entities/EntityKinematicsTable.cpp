@@ -0,0 +1,167 @@
+#include "botcraft/Game/Entities/EntityKinematicsTable.hpp"
+#include "botcraft/Game/Entities/entities/Entity.hpp"
+
+namespace Botcraft
+{
+    EntityKinematicsTable::EntityKinematicsTable()
+    {
+        version = 0;
+    }
+
+    EntityKinematicsTable::~EntityKinematicsTable()
+    {
+        Clear();
+    }
+
+    void EntityKinematicsTable::Add(Entity* entity)
+    {
+        if (entity == nullptr)
+        {
+            return;
+        }
+
+        if (entity->kinematics_table != nullptr)
+        {
+            entity->kinematics_table->Remove(entity->GetEntityID());
+        }
+        Remove(entity->GetEntityID());
+
+        const int row = static_cast<int>(ids.size());
+        ids.push_back(entity->GetEntityID());
+        positions.push_back(entity->position);
+        yaws.push_back(entity->yaw);
+        pitches.push_back(entity->pitch);
+        on_grounds.push_back(entity->on_ground);
+        types.push_back(entity->GetType());
+        entities.push_back(entity);
+        rows[entity->GetEntityID()] = row;
+
+        entity->kinematics_table = this;
+        entity->kinematics_row = row;
+        version++;
+    }
+
+    void EntityKinematicsTable::Remove(const int id)
+    {
+        auto it = rows.find(id);
+        if (it == rows.end())
+        {
+            return;
+        }
+
+        const int row = it->second;
+        rows.erase(it);
+
+        Entity* entity = entities[row];
+        entity->kinematics_table = nullptr;
+        entity->kinematics_row = -1;
+
+        // Move the last row in the removed one
+        const int last_row = static_cast<int>(ids.size()) - 1;
+        if (row != last_row)
+        {
+            ids[row] = ids[last_row];
+            positions[row] = positions[last_row];
+            yaws[row] = yaws[last_row];
+            pitches[row] = pitches[last_row];
+            on_grounds[row] = on_grounds[last_row];
+            types[row] = types[last_row];
+            entities[row] = entities[last_row];
+            entities[row]->kinematics_row = row;
+            rows[ids[row]] = row;
+        }
+
+        ids.pop_back();
+        positions.pop_back();
+        yaws.pop_back();
+        pitches.pop_back();
+        on_grounds.pop_back();
+        types.pop_back();
+        entities.pop_back();
+        version++;
+    }
+
+    void EntityKinematicsTable::Clear()
+    {
+        while (!ids.empty())
+        {
+            Remove(ids.back());
+        }
+    }
+
+    const int EntityKinematicsTable::GetRow(const int id) const
+    {
+        auto it = rows.find(id);
+        return it == rows.end() ? -1 : it->second;
+    }
+
+    const size_t EntityKinematicsTable::Size() const
+    {
+        return ids.size();
+    }
+
+    const unsigned long long EntityKinematicsTable::GetVersion() const
+    {
+        return version;
+    }
+
+    const std::vector<int>& EntityKinematicsTable::GetIds() const
+    {
+        return ids;
+    }
+
+    const std::vector<Vector3<double> >& EntityKinematicsTable::GetPositions() const
+    {
+        return positions;
+    }
+
+    const std::vector<float>& EntityKinematicsTable::GetYaws() const
+    {
+        return yaws;
+    }
+
+    const std::vector<float>& EntityKinematicsTable::GetPitches() const
+    {
+        return pitches;
+    }
+
+    const std::vector<char>& EntityKinematicsTable::GetOnGrounds() const
+    {
+        return on_grounds;
+    }
+
+    const std::vector<EntityType>& EntityKinematicsTable::GetTypes() const
+    {
+        return types;
+    }
+
+    void EntityKinematicsTable::SetPosition(const int row, const Vector3<double>& position)
+    {
+        // Entity setters mirror the new value in the table
+        entities[row]->SetPosition(position);
+    }
+
+    void EntityKinematicsTable::SetYaw(const int row, const float yaw)
+    {
+        entities[row]->SetYaw(yaw);
+    }
+
+    void EntityKinematicsTable::SetPitch(const int row, const float pitch)
+    {
+        entities[row]->SetPitch(pitch);
+    }
+
+    void EntityKinematicsTable::SetOnGround(const int row, const bool on_ground)
+    {
+        entities[row]->SetOnGround(on_ground);
+    }
+
+    void EntityKinematicsTable::Mirror(const int row, const Entity& entity)
+    {
+        positions[row] = entity.position;
+        yaws[row] = entity.yaw;
+        pitches[row] = entity.pitch;
+        on_grounds[row] = entity.on_ground;
+        version++;
+    }
+} // Botcraft
@@ -1,10 +1,15 @@
 #include "botcraft/Game/Entities/EntityManager.hpp"
+#include "botcraft/Game/Entities/EntityPool.hpp"
 #include "botcraft/Game/Entities/entities/Entity.hpp"
+#include "botcraft/Game/Entities/entities/StubEntity.hpp"
 #include "botcraft/Game/Entities/entities/UnknownEntity.hpp"
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
 
 #include "botcraft/Utilities/Logger.hpp"
 
+#include <cmath>
+#include <algorithm>
+
 #if USE_GUI
 #include "botcraft/Renderer/RenderingManager.hpp"
 #endif
@@ -14,6 +19,22 @@ namespace Botcraft
     EntityManager::EntityManager()
     {
         local_player = std::make_shared<LocalPlayer>();
+        local_player_spawned = false;
+        max_entity_half_width = 0.0;
+        recycle_entities = false;
+    }
+
+    EntityManager::EntityManager(const std::shared_ptr<EntityManager>& shared_entities_) : EntityManager()
+    {
+        shared_entities = shared_entities_;
+    }
+
+    EntityManager::~EntityManager()
+    {
+        if (shared_entities != nullptr)
+        {
+            RemoveSharedViewers(std::vector<int>(visible_entities.begin(), visible_entities.end()));
+        }
     }
 
     std::shared_ptr<LocalPlayer> EntityManager::GetLocalPlayer()
@@ -21,13 +42,26 @@ namespace Botcraft
         return local_player;
     }
 
+    const bool EntityManager::IsLocalPlayerSpawned() const
+    {
+        return local_player_spawned;
+    }
+
     const std::unordered_map<int, std::shared_ptr<Entity>>& EntityManager::GetEntities() const
     {
+        if (shared_entities != nullptr)
+        {
+            return shared_entities->GetEntities();
+        }
         return entities;
     }
 
     std::shared_ptr<Entity> EntityManager::GetEntity(const int id) const
     {
+        if (shared_entities != nullptr && id != local_player->GetEntityID())
+        {
+            return shared_entities->GetEntity(id);
+        }
         auto it = entities.find(id);
         return it == entities.end() ? nullptr : it->second;
     }
@@ -39,8 +73,141 @@ namespace Botcraft
             return;
         }
 
+        if (shared_entities != nullptr && entity->GetEntityID() != local_player->GetEntityID())
+        {
+            shared_entities->AddEntity(entity);
+            return;
+        }
+
         std::lock_guard<std::mutex> lock(entity_manager_mutex);
         entities[entity->GetEntityID()] = entity;
+        IndexEntity(entity);
+    }
+
+    void EntityManager::SetTrackingFilter(const EntityTrackingFilter& filter_)
+    {
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        tracking_filter = filter_;
+    }
+
+    void EntityManager::SetEntityRecycling(const bool b)
+    {
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        recycle_entities = b;
+    }
+
+    EntityTrackingFilter EntityManager::MakeTrackingFilter(const std::unordered_set<EntityType>& types,
+        const double max_distance, const EntityTrackingMode others_mode)
+    {
+        return [types, max_distance, others_mode](const EntityType type, const Vector3<double>& position, const Vector3<double>& player_position)
+        {
+            if (types.find(type) == types.end())
+            {
+                return others_mode;
+            }
+            if (max_distance >= 0.0 && position.SqrDist(player_position) > max_distance * max_distance)
+            {
+                return others_mode;
+            }
+            return EntityTrackingMode::Full;
+        };
+    }
+
+    const EntityKinematicsTable& EntityManager::GetKinematics() const
+    {
+        if (shared_entities != nullptr)
+        {
+            return shared_entities->GetKinematics();
+        }
+        return kinematics;
+    }
+
+    const EntitySnapshot EntityManager::GetSnapshot()
+    {
+        if (shared_entities != nullptr)
+        {
+            return shared_entities->GetSnapshot();
+        }
+
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        if (snapshot == nullptr || snapshot->epoch != kinematics.GetVersion())
+        {
+            std::shared_ptr<EntitySnapshot::Data> new_snapshot = std::make_shared<EntitySnapshot::Data>();
+            new_snapshot->epoch = kinematics.GetVersion();
+            new_snapshot->states.resize(kinematics.Size());
+            new_snapshot->indices.reserve(kinematics.Size());
+            for (size_t i = 0; i < kinematics.Size(); ++i)
+            {
+                EntitySnapshot::EntityState& state = new_snapshot->states[i];
+                state.id = kinematics.GetIds()[i];
+                state.type = kinematics.GetTypes()[i];
+                state.position = kinematics.GetPositions()[i];
+                state.yaw = kinematics.GetYaws()[i];
+                state.pitch = kinematics.GetPitches()[i];
+                state.on_ground = kinematics.GetOnGrounds()[i];
+                state.entity = entities[state.id];
+                new_snapshot->indices[state.id] = i;
+            }
+            snapshot = new_snapshot;
+        }
+        return EntitySnapshot(snapshot);
+    }
+
+    std::vector<std::shared_ptr<Entity> > EntityManager::QueryRadius(const Vector3<double>& center, const double radius,
+        const std::function<bool(const Entity&)>& filter) const
+    {
+        if (shared_entities != nullptr)
+        {
+            // Other bots can see this one
+            const int local_id = local_player->GetEntityID();
+            return shared_entities->QueryRadius(center, radius, [&](const Entity& e)
+                {
+                    return e.GetEntityID() != local_id && (filter == nullptr || filter(e));
+                });
+        }
+
+        std::vector<std::shared_ptr<Entity> > output;
+        const double sqr_radius = radius * radius;
+        ForEachEntityInCells(center.x - radius, center.z - radius, center.x + radius, center.z + radius,
+            [&](const std::shared_ptr<Entity>& entity)
+            {
+                if ((entity->GetPosition() - center).SqrNorm() <= sqr_radius &&
+                    (filter == nullptr || filter(*entity)))
+                {
+                    output.push_back(entity);
+                }
+            });
+        return output;
+    }
+
+    std::vector<std::shared_ptr<Entity> > EntityManager::QueryAABB(const AABB& box,
+        const std::function<bool(const Entity&)>& filter) const
+    {
+        if (shared_entities != nullptr)
+        {
+            // Other bots can see this one
+            const int local_id = local_player->GetEntityID();
+            return shared_entities->QueryAABB(box, [&](const Entity& e)
+                {
+                    return e.GetEntityID() != local_id && (filter == nullptr || filter(e));
+                });
+        }
+
+        std::vector<std::shared_ptr<Entity> > output;
+        const Vector3<double> min = box.GetMin();
+        const Vector3<double> max = box.GetMax();
+        // Entities are indexed by their position, but their collider can overlap neighbour cells
+        ForEachEntityInCells(min.x - max_entity_half_width, min.z - max_entity_half_width,
+            max.x + max_entity_half_width, max.z + max_entity_half_width,
+            [&](const std::shared_ptr<Entity>& entity)
+            {
+                if (box.Collide(entity->GetCollider()) &&
+                    (filter == nullptr || filter(*entity)))
+                {
+                    output.push_back(entity);
+                }
+            });
+        return output;
     }
 
 #if USE_GUI
@@ -52,116 +219,336 @@ namespace Botcraft
 
     std::mutex& EntityManager::GetMutex()
     {
+        if (shared_entities != nullptr)
+        {
+            return shared_entities->GetMutex();
+        }
         return entity_manager_mutex;
     }
 
-    void EntityManager::Handle(ProtocolCraft::ClientboundLoginPacket& msg)
+    const EventNotifier& EntityManager::GetEventNotifier() const
     {
-        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
-        local_player = std::make_shared<LocalPlayer>();
-        local_player->GetMutex().lock();
-        local_player->SetEntityID(msg.GetPlayerId());
-        local_player->GetMutex().unlock();
-        entities[msg.GetPlayerId()] = local_player;
+        if (shared_entities != nullptr)
+        {
+            return shared_entities->GetEventNotifier();
+        }
+        return event_notifier;
     }
-    
-#if PROTOCOL_VERSION < 755
-    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacket& msg)
+
+    const EntityManagerStats EntityManager::GetStats()
     {
+        EntityManagerStats stats;
+        if (shared_entities != nullptr)
+        {
+            stats = shared_entities->GetStats();
+            stats.num_visible = visible_entities.size();
+            return stats;
+        }
+
+        stats.num_pooled_blocks = EntityPool::GetInstance().GetNumFreeBlocks();
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
-        auto it = entities.find(msg.GetEntityId());
-        if (it == entities.end())
+        stats.num_entities = entities.size();
+        for (auto it = entities.begin(); it != entities.end(); ++it)
         {
-            std::shared_ptr<Entity> entity = std::make_shared<UnknownEntity>();
-            entity->SetEntityID(msg.GetEntityId());
-            entities[msg.GetEntityId()] = entity;
+            stats.entities_memory_bytes += it->second->GetMemoryUsage();
+            stats.metadata_memory_bytes += it->second->GetMetadataMemoryUsage();
+        }
+        for (auto it = untracked_entities.begin(); it != untracked_entities.end(); ++it)
+        {
+            if (it->second == EntityTrackingMode::Stub)
+            {
+                stats.num_stubs += 1;
+            }
+            else if (it->second == EntityTrackingMode::Ignored)
+            {
+                stats.num_ignored += 1;
+            }
         }
+        return stats;
     }
-#endif
 
-    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacketPos& msg)
+    void EntityManager::ApplyMovements(const std::vector<EntityMovement>& movements)
     {
-        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
-        // Player position is also used by physics thread, so we need
-        // to lock it
-        if (msg.GetEntityId() == local_player->GetEntityID())
+        if (shared_entities == nullptr)
         {
-            local_player->GetMutex().lock();
+            std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+            for (const EntityMovement& movement : movements)
+            {
+                ApplyMovement(movement);
+            }
+            return;
         }
-        
-        auto it = entities.find(msg.GetEntityId());
-        if (it != entities.end())
+
+        // Same as ForwardUpdateToShared, but the movements
+        // of the entities this bot owns are sent in one batch
+        const int local_player_id = local_player->GetEntityID();
+        std::vector<EntityMovement> owned_movements;
+        owned_movements.reserve(movements.size());
+        std::vector<EntityMovement> local_movements;
         {
-            it->second->SetX((msg.GetXA() / 128.0f + it->second->GetPosition().x * 32.0f) / 32.0f);
-            it->second->SetY((msg.GetYA() / 128.0f + it->second->GetPosition().y * 32.0f) / 32.0f);
-            it->second->SetZ((msg.GetZA() / 128.0f + it->second->GetPosition().z * 32.0f) / 32.0f);
-            it->second->SetOnGround(msg.GetOnGround());
+            std::lock_guard<std::mutex> viewers_lock(shared_entities->viewers_mutex);
+            for (const EntityMovement& movement : movements)
+            {
+                if (movement.entity_id == local_player_id)
+                {
+                    local_movements.push_back(movement);
+                    continue;
+                }
+                auto it = shared_entities->viewers.find(movement.entity_id);
+                if (it == shared_entities->viewers.end() || it->second.front() == this)
+                {
+                    owned_movements.push_back(movement);
+                }
+            }
         }
-        
-        if (msg.GetEntityId() == local_player->GetEntityID())
+
+        // Viewers lock must not be held here, as the shared manager locks its entity mutex
+        if (!owned_movements.empty())
         {
-#ifdef USE_GUI
-            if (rendering_manager)
+            shared_entities->ApplyMovements(owned_movements);
+        }
+        if (!local_movements.empty())
+        {
+            std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+            for (const EntityMovement& movement : local_movements)
             {
-                rendering_manager->SetPosOrientation(local_player->GetPosition().x, local_player->GetPosition().y + 1.62f, local_player->GetPosition().z, local_player->GetYaw(), local_player->GetPitch());
+                ApplyMovement(movement);
             }
-#endif // USE_GUI
-            local_player->GetMutex().unlock();
         }
     }
 
-    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacketPosRot& msg)
+    EntityTrackingMode EntityManager::TrackEntity(const int id, const EntityType type, const Vector3<double>& position)
     {
-        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
-        // Player position is also used by physics thread, so we need
-        // to lock it
-        if (msg.GetEntityId() == local_player->GetEntityID())
+        untracked_entities.erase(id);
+        if (tracking_filter == nullptr)
         {
-            local_player->GetMutex().lock();
+            return EntityTrackingMode::Full;
         }
 
-        auto it = entities.find(msg.GetEntityId());
-        if (it != entities.end())
+        const Vector3<double> player_position = local_player->GetState().position;
+
+        const EntityTrackingMode mode = tracking_filter(type, position, player_position);
+        if (mode != EntityTrackingMode::Full)
+        {
+            untracked_entities[id] = mode;
+        }
+        if (mode == EntityTrackingMode::Ignored)
         {
-            it->second->SetX((msg.GetXA() / 128.0f + it->second->GetPosition().x * 32.0f) / 32.0f);
-            it->second->SetY((msg.GetYA() / 128.0f + it->second->GetPosition().y * 32.0f) / 32.0f);
-            it->second->SetZ((msg.GetZA() / 128.0f + it->second->GetPosition().z * 32.0f) / 32.0f);
-            it->second->SetYaw(360.0f * msg.GetYRot() / 256.0f);
-            it->second->SetPitch(360.0f * msg.GetXRot() / 256.0f);
-            it->second->SetOnGround(msg.GetOnGround());
+            entities.erase(id);
+            UnindexEntity(id);
         }
+        return mode;
+    }
 
-        if (msg.GetEntityId() == local_player->GetEntityID())
+    std::shared_ptr<Entity> EntityManager::CreateTrackedEntity(const int id, const EntityType type, const Vector3<double>& position)
+    {
+        switch (TrackEntity(id, type, position))
         {
-#ifdef USE_GUI
-            if (rendering_manager)
+        case EntityTrackingMode::Full:
+            return Entity::CreateEntity(type, recycle_entities);
+        case EntityTrackingMode::Stub:
+            if (recycle_entities)
             {
-                rendering_manager->SetPosOrientation(local_player->GetPosition().x, local_player->GetPosition().y + 1.62f, local_player->GetPosition().z, local_player->GetYaw(), local_player->GetPitch());
+                return std::allocate_shared<StubEntity>(EntityPoolAllocator<StubEntity>(), type);
             }
-#endif // USE_GUI
-            local_player->GetMutex().unlock();
+            return std::make_shared<StubEntity>(type);
+        default:
+            return nullptr;
         }
     }
 
-    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacketRot& msg)
+    void EntityManager::IndexEntity(const std::shared_ptr<Entity>& entity)
     {
-        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        // Local player is moved by the physics thread, not by the server
+        if (entity->GetEntityID() == local_player->GetEntityID())
+        {
+            return;
+        }
+
+        kinematics.Add(entity.get());
+        max_entity_half_width = std::max(max_entity_half_width, entity->GetWidth() / 2.0);
+        UpdateEntityCell(entity->GetEntityID(), entity->GetPosition());
+        event_notifier.Notify(EventType::EntityAdded);
+    }
+
+    void EntityManager::UnindexEntity(const int id)
+    {
+        kinematics.Remove(id);
+        RemoveEntityCell(id);
+        event_notifier.Notify(EventType::EntityRemoved);
+    }
+
+    void EntityManager::UpdateEntityCell(const int id, const Vector3<double>& pos)
+    {
+        if (id == local_player->GetEntityID())
+        {
+            return;
+        }
+
+        const std::pair<int, int> cell = {
+            static_cast<int>(std::floor(pos.x / CHUNK_WIDTH)),
+            static_cast<int>(std::floor(pos.z / CHUNK_WIDTH))
+        };
+
+        auto it = entity_cell_coords.find(id);
+        if (it != entity_cell_coords.end())
+        {
+            if (it->second == cell)
+            {
+                return;
+            }
+            auto old_cell = entity_cells.find(it->second);
+            if (old_cell != entity_cells.end())
+            {
+                old_cell->second.erase(id);
+                if (old_cell->second.empty())
+                {
+                    entity_cells.erase(old_cell);
+                }
+            }
+            it->second = cell;
+        }
+        else
+        {
+            entity_cell_coords[id] = cell;
+        }
+        entity_cells[cell].insert(id);
+    }
+
+    void EntityManager::RemoveEntityCell(const int id)
+    {
+        auto it = entity_cell_coords.find(id);
+        if (it == entity_cell_coords.end())
+        {
+            return;
+        }
+        auto cell = entity_cells.find(it->second);
+        if (cell != entity_cells.end())
+        {
+            cell->second.erase(id);
+            if (cell->second.empty())
+            {
+                entity_cells.erase(cell);
+            }
+        }
+        entity_cell_coords.erase(it);
+    }
+
+    void EntityManager::ForEachEntityInCells(const double min_x, const double min_z, const double max_x, const double max_z,
+        const std::function<void(const std::shared_ptr<Entity>&)>& func) const
+    {
+        const int min_cell_x = static_cast<int>(std::floor(min_x / CHUNK_WIDTH));
+        const int min_cell_z = static_cast<int>(std::floor(min_z / CHUNK_WIDTH));
+        const int max_cell_x = static_cast<int>(std::floor(max_x / CHUNK_WIDTH));
+        const int max_cell_z = static_cast<int>(std::floor(max_z / CHUNK_WIDTH));
+
+        // Huge area, iterate over the cells directly
+        if (static_cast<long long int>(max_cell_x - min_cell_x + 1) * (max_cell_z - min_cell_z + 1) > static_cast<long long int>(entity_cells.size()))
+        {
+            for (auto cell = entity_cells.begin(); cell != entity_cells.end(); ++cell)
+            {
+                if (cell->first.first < min_cell_x || cell->first.first > max_cell_x ||
+                    cell->first.second < min_cell_z || cell->first.second > max_cell_z)
+                {
+                    continue;
+                }
+                for (const int id : cell->second)
+                {
+                    func(entities.at(id));
+                }
+            }
+            return;
+        }
+
+        for (int x = min_cell_x; x <= max_cell_x; ++x)
+        {
+            for (int z = min_cell_z; z <= max_cell_z; ++z)
+            {
+                auto cell = entity_cells.find({ x, z });
+                if (cell == entity_cells.end())
+                {
+                    continue;
+                }
+                for (const int id : cell->second)
+                {
+                    func(entities.at(id));
+                }
+            }
+        }
+    }
+
+    void EntityManager::RemoveEntity(const int id)
+    {
+        entities.erase(id);
+        UnindexEntity(id);
+        untracked_entities.erase(id);
+    }
+
+    void EntityManager::ApplyMovement(const EntityMovement& movement)
+    {
+        const bool has_position = movement.type != EntityMovement::Type::Rot;
+        const bool has_rotation = movement.type != EntityMovement::Type::Pos;
+
+        // Indexed entities are updated in the kinematics table only
+        const int row = kinematics.GetRow(movement.entity_id);
+        if (row != -1)
+        {
+            if (has_position)
+            {
+                const Vector3<double>& pos = kinematics.GetPositions()[row];
+                const Vector3<double> new_pos = movement.type == EntityMovement::Type::Teleport ? movement.position : Vector3<double>(
+                    (movement.xa / 128.0f + pos.x * 32.0f) / 32.0f,
+                    (movement.ya / 128.0f + pos.y * 32.0f) / 32.0f,
+                    (movement.za / 128.0f + pos.z * 32.0f) / 32.0f);
+                kinematics.SetPosition(row, new_pos);
+                UpdateEntityCell(movement.entity_id, new_pos);
+            }
+            if (has_rotation)
+            {
+                kinematics.SetYaw(row, 360.0f * movement.y_rot / 256.0f);
+                kinematics.SetPitch(row, 360.0f * movement.x_rot / 256.0f);
+            }
+            kinematics.SetOnGround(row, movement.on_ground);
+            return;
+        }
+
         // Player position is also used by physics thread, so we need
         // to lock it
-        if (msg.GetEntityId() == local_player->GetEntityID())
+        const bool is_local_player = movement.entity_id == local_player->GetEntityID();
+        if (is_local_player)
         {
             local_player->GetMutex().lock();
         }
 
-        auto it = entities.find(msg.GetEntityId());
+        auto it = entities.find(movement.entity_id);
         if (it != entities.end())
         {
-            it->second->SetYaw(360.0f * msg.GetYRot() / 256.0f);
-            it->second->SetPitch(360.0f * msg.GetXRot() / 256.0f);
-            it->second->SetOnGround(msg.GetOnGround());
+            if (movement.type == EntityMovement::Type::Teleport)
+            {
+                it->second->SetX(movement.position.x);
+                it->second->SetY(movement.position.y);
+                it->second->SetZ(movement.position.z);
+            }
+            else if (has_position)
+            {
+                it->second->SetX((movement.xa / 128.0f + it->second->GetPosition().x * 32.0f) / 32.0f);
+                it->second->SetY((movement.ya / 128.0f + it->second->GetPosition().y * 32.0f) / 32.0f);
+                it->second->SetZ((movement.za / 128.0f + it->second->GetPosition().z * 32.0f) / 32.0f);
+            }
+            if (has_position)
+            {
+                UpdateEntityCell(it->second->GetEntityID(), it->second->GetPosition());
+            }
+            if (has_rotation)
+            {
+                it->second->SetYaw(360.0f * movement.y_rot / 256.0f);
+                it->second->SetPitch(360.0f * movement.x_rot / 256.0f);
+            }
+            it->second->SetOnGround(movement.on_ground);
         }
 
-        if (msg.GetEntityId() == local_player->GetEntityID())
+        if (is_local_player)
         {
 #ifdef USE_GUI
             if (rendering_manager)
@@ -173,6 +560,203 @@ namespace Botcraft
         }
     }
 
+    template<class TPacket>
+    bool EntityManager::ForwardSpawnToShared(TPacket& msg, const int id, const EntityType type, const Vector3<double>& position)
+    {
+        if (shared_entities == nullptr || id == local_player->GetEntityID())
+        {
+            return false;
+        }
+
+        if (tracking_filter != nullptr)
+        {
+            const Vector3<double> player_position = local_player->GetState().position;
+            if (tracking_filter(type, position, player_position) == EntityTrackingMode::Ignored)
+            {
+                return true;
+            }
+        }
+
+        if (!visible_entities.insert(id).second)
+        {
+            // Spawned again without being removed, update it if we own it
+            return ForwardUpdateToShared(msg, id);
+        }
+
+        bool first_viewer = false;
+        {
+            std::lock_guard<std::mutex> viewers_lock(shared_entities->viewers_mutex);
+            std::vector<const EntityManager*>& entity_viewers = shared_entities->viewers[id];
+            first_viewer = entity_viewers.empty();
+            entity_viewers.push_back(this);
+        }
+
+        // Viewers lock must not be held here, as the shared handler locks the shared entity mutex
+        if (first_viewer)
+        {
+            shared_entities->Handle(msg);
+        }
+        return true;
+    }
+
+    template<class TPacket>
+    bool EntityManager::ForwardUpdateToShared(TPacket& msg, const int id)
+    {
+        if (shared_entities == nullptr || id == local_player->GetEntityID())
+        {
+            return false;
+        }
+
+        bool owner = false;
+        {
+            std::lock_guard<std::mutex> viewers_lock(shared_entities->viewers_mutex);
+            auto it = shared_entities->viewers.find(id);
+            // Unknown entities are created by the first bot receiving a move packet
+            owner = it == shared_entities->viewers.end() || it->second.front() == this;
+        }
+
+        if (owner)
+        {
+            shared_entities->Handle(msg);
+        }
+        return true;
+    }
+
+    void EntityManager::RemoveSharedViewers(const std::vector<int>& ids)
+    {
+        std::vector<int> removed;
+        {
+            std::lock_guard<std::mutex> viewers_lock(shared_entities->viewers_mutex);
+            for (const int id : ids)
+            {
+                if (visible_entities.erase(id) == 0)
+                {
+                    continue;
+                }
+                auto it = shared_entities->viewers.find(id);
+                if (it == shared_entities->viewers.end())
+                {
+                    continue;
+                }
+                // If this bot was the owner, the next viewer sends the updates from now on
+                it->second.erase(std::remove(it->second.begin(), it->second.end(), this), it->second.end());
+                if (it->second.empty())
+                {
+                    shared_entities->viewers.erase(it);
+                    removed.push_back(id);
+                }
+            }
+        }
+
+        if (removed.empty())
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> entity_manager_locker(shared_entities->entity_manager_mutex);
+        for (const int id : removed)
+        {
+            shared_entities->RemoveEntity(id);
+        }
+    }
+
+    void EntityManager::Handle(ProtocolCraft::ClientboundLoginPacket& msg)
+    {
+        if (shared_entities != nullptr)
+        {
+            // New session, the server will send the visible entities again
+            RemoveSharedViewers(std::vector<int>(visible_entities.begin(), visible_entities.end()));
+        }
+
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        local_player = std::make_shared<LocalPlayer>();
+        local_player->GetMutex().lock();
+        local_player->SetEntityID(msg.GetPlayerId());
+        local_player->GetMutex().unlock();
+        entities[msg.GetPlayerId()] = local_player;
+        UnindexEntity(msg.GetPlayerId());
+        untracked_entities.erase(msg.GetPlayerId());
+        local_player_spawned = true;
+    }
+    
+#if PROTOCOL_VERSION < 755
+    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacket& msg)
+    {
+        if (ForwardUpdateToShared(msg, msg.GetEntityId()))
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        auto it = entities.find(msg.GetEntityId());
+        if (it == entities.end() && untracked_entities.find(msg.GetEntityId()) == untracked_entities.end())
+        {
+            std::shared_ptr<Entity> entity = std::make_shared<UnknownEntity>();
+            entity->SetEntityID(msg.GetEntityId());
+            entities[msg.GetEntityId()] = entity;
+            IndexEntity(entity);
+        }
+    }
+#endif
+
+    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacketPos& msg)
+    {
+        if (ForwardUpdateToShared(msg, msg.GetEntityId()))
+        {
+            return;
+        }
+
+        EntityMovement movement;
+        movement.type = EntityMovement::Type::Pos;
+        movement.entity_id = msg.GetEntityId();
+        movement.xa = msg.GetXA();
+        movement.ya = msg.GetYA();
+        movement.za = msg.GetZA();
+        movement.on_ground = msg.GetOnGround();
+
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        ApplyMovement(movement);
+    }
+
+    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacketPosRot& msg)
+    {
+        if (ForwardUpdateToShared(msg, msg.GetEntityId()))
+        {
+            return;
+        }
+
+        EntityMovement movement;
+        movement.type = EntityMovement::Type::PosRot;
+        movement.entity_id = msg.GetEntityId();
+        movement.xa = msg.GetXA();
+        movement.ya = msg.GetYA();
+        movement.za = msg.GetZA();
+        movement.y_rot = msg.GetYRot();
+        movement.x_rot = msg.GetXRot();
+        movement.on_ground = msg.GetOnGround();
+
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        ApplyMovement(movement);
+    }
+
+    void EntityManager::Handle(ProtocolCraft::ClientboundMoveEntityPacketRot& msg)
+    {
+        if (ForwardUpdateToShared(msg, msg.GetEntityId()))
+        {
+            return;
+        }
+
+        EntityMovement movement;
+        movement.type = EntityMovement::Type::Rot;
+        movement.entity_id = msg.GetEntityId();
+        movement.y_rot = msg.GetYRot();
+        movement.x_rot = msg.GetXRot();
+        movement.on_ground = msg.GetOnGround();
+
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        ApplyMovement(movement);
+    }
+
     void EntityManager::Handle(ProtocolCraft::ClientboundPlayerPositionPacket& msg)
     {
         std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
@@ -181,6 +765,7 @@ namespace Botcraft
         (msg.GetRelativeArguments() & 0x04) ? local_player->SetZ(local_player->GetPosition().z + msg.GetZ()) : local_player->SetZ(msg.GetZ());
         (msg.GetRelativeArguments() & 0x08) ? local_player->SetYaw(local_player->GetYaw() + msg.GetYRot()) : local_player->SetYaw(msg.GetYRot());
         (msg.GetRelativeArguments() & 0x10) ? local_player->SetPitch(local_player->GetPitch() + msg.GetXRot()) : local_player->SetPitch(msg.GetXRot());
+        local_player->PublishState();
 
 #ifdef USE_GUI
         if (rendering_manager)
@@ -192,15 +777,40 @@ namespace Botcraft
 
     void EntityManager::Handle(ProtocolCraft::ClientboundAddEntityPacket& msg)
     {
+#if PROTOCOL_VERSION < 458
+        if (shared_entities != nullptr && ForwardSpawnToShared(msg, msg.GetId_(), Entity::CreateObjectEntity(static_cast<ObjectEntityType>(msg.GetType()))->GetType(), Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ())))
+#else
+        if (ForwardSpawnToShared(msg, msg.GetId_(), static_cast<EntityType>(msg.GetType()), Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ())))
+#endif
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
 
+        const Vector3<double> position(msg.GetX(), msg.GetY(), msg.GetZ());
 #if PROTOCOL_VERSION < 458
-        std::shared_ptr<Entity> entity = Entity::CreateObjectEntity(static_cast<ObjectEntityType>(msg.GetType()));
+        std::shared_ptr<Entity> entity = Entity::CreateObjectEntity(static_cast<ObjectEntityType>(msg.GetType()), recycle_entities);
+        switch (TrackEntity(msg.GetId_(), entity->GetType(), position))
+        {
+        case EntityTrackingMode::Stub:
+            entity = std::make_shared<StubEntity>(entity->GetType());
+            break;
+        case EntityTrackingMode::Ignored:
+            return;
+        default:
+            break;
+        }
 #else
-        std::shared_ptr<Entity> entity = Entity::CreateEntity(static_cast<EntityType>(msg.GetType()));
+        std::shared_ptr<Entity> entity = CreateTrackedEntity(msg.GetId_(), static_cast<EntityType>(msg.GetType()), position);
+        if (entity == nullptr)
+        {
+            return;
+        }
 #endif
-        
+
         entity->SetEntityID(msg.GetId_());
+        entity->SetUUID(msg.GetUUID());
         entity->SetX(msg.GetX());
         entity->SetY(msg.GetY());
         entity->SetZ(msg.GetZ());
@@ -208,16 +818,27 @@ namespace Botcraft
         entity->SetPitch(360.0f * msg.GetXRot() / 256.0f);
 
         entities[msg.GetId_()] = entity;
+        IndexEntity(entity);
     }
 
 #if PROTOCOL_VERSION < 759
     void EntityManager::Handle(ProtocolCraft::ClientboundAddMobPacket& msg)
     {
+        if (ForwardSpawnToShared(msg, msg.GetId_(), static_cast<EntityType>(msg.GetType()), Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ())))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
 
-        std::shared_ptr<Entity> entity = Entity::CreateEntity(static_cast<EntityType>(msg.GetType()));
+        std::shared_ptr<Entity> entity = CreateTrackedEntity(msg.GetId_(), static_cast<EntityType>(msg.GetType()), Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ()));
+        if (entity == nullptr)
+        {
+            return;
+        }
 
         entity->SetEntityID(msg.GetId_());
+        entity->SetUUID(msg.GetEntityUuid());
         entity->SetX(msg.GetX());
         entity->SetY(msg.GetY());
         entity->SetZ(msg.GetZ());
@@ -225,14 +846,24 @@ namespace Botcraft
         entity->SetPitch(360.0f * msg.GetXRot() / 256.0f);
 
         entities[msg.GetId_()] = entity;
+        IndexEntity(entity);
     }
 #endif
 
     void EntityManager::Handle(ProtocolCraft::ClientboundAddExperienceOrbPacket& msg)
     {
+        if (ForwardSpawnToShared(msg, msg.GetId_(), EntityType::ExperienceOrb, Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ())))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
 
-        std::shared_ptr<Entity> entity = Entity::CreateEntity(EntityType::ExperienceOrb);
+        std::shared_ptr<Entity> entity = CreateTrackedEntity(msg.GetId_(), EntityType::ExperienceOrb, Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ()));
+        if (entity == nullptr)
+        {
+            return;
+        }
 
         entity->SetEntityID(msg.GetId_());
         entity->SetX(msg.GetX());
@@ -240,14 +871,24 @@ namespace Botcraft
         entity->SetZ(msg.GetZ());
         // What do we do with the xp value?
         entities[msg.GetId_()] = entity;
+        IndexEntity(entity);
     }
 
 #if PROTOCOL_VERSION < 721
     void EntityManager::Handle(ProtocolCraft::ClientboundAddGlobalEntityPacket& msg)
     {
+        if (ForwardSpawnToShared(msg, msg.GetId_(), static_cast<EntityType>(msg.GetType()), Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ())))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
 
-        std::shared_ptr<Entity> entity = Entity::CreateEntity(static_cast<EntityType>(msg.GetType()));
+        std::shared_ptr<Entity> entity = CreateTrackedEntity(msg.GetId_(), static_cast<EntityType>(msg.GetType()), Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ()));
+        if (entity == nullptr)
+        {
+            return;
+        }
 
         entity->SetEntityID(msg.GetId_());
         entity->SetX(msg.GetX());
@@ -255,11 +896,17 @@ namespace Botcraft
         entity->SetZ(msg.GetZ());
 
         entities[msg.GetId_()] = entity;
+        IndexEntity(entity);
     }
 #endif
 
     void EntityManager::Handle(ProtocolCraft::ClientboundAddPlayerPacket& msg)
     {
+        if (ForwardSpawnToShared(msg, msg.GetEntityId(), EntityType::Player, Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ())))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
 
         std::shared_ptr<Entity> entity;
@@ -267,7 +914,11 @@ namespace Botcraft
         auto it = entities.find(msg.GetEntityId());
         if (it == entities.end())
         {
-            entity = Entity::CreateEntity(EntityType::Player);
+            entity = CreateTrackedEntity(msg.GetEntityId(), EntityType::Player, Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ()));
+            if (entity == nullptr)
+            {
+                return;
+            }
             entities[msg.GetEntityId()] = entity;
         }
         else
@@ -276,11 +927,13 @@ namespace Botcraft
         }
 
         entity->SetEntityID(msg.GetEntityId());
+        entity->SetUUID(msg.GetPlayerId());
         entity->SetX(msg.GetX());
         entity->SetY(msg.GetY());
         entity->SetZ(msg.GetZ());
         entity->SetYaw(360.0f * msg.GetYRot() / 256.0f);
         entity->SetPitch(360.0f * msg.GetXRot() / 256.0f);
+        IndexEntity(entity);
     }
 
     void EntityManager::Handle(ProtocolCraft::ClientboundSetHealthPacket& msg)
@@ -289,37 +942,26 @@ namespace Botcraft
         local_player->SetHealth(msg.GetHealth());
         local_player->SetFood(msg.GetFood());
         local_player->SetFoodSaturation(msg.GetFoodSaturation());
+        local_player->PublishState();
     }
     
     void EntityManager::Handle(ProtocolCraft::ClientboundTeleportEntityPacket& msg)
     {
-        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
-        if (msg.GetId_() == local_player->GetEntityID())
+        if (ForwardUpdateToShared(msg, msg.GetId_()))
         {
-            local_player->GetMutex().lock();
+            return;
         }
 
-        auto it = entities.find(msg.GetId_());
-        if (it != entities.end())
-        {
-            it->second->SetX(msg.GetX());
-            it->second->SetY(msg.GetY());
-            it->second->SetZ(msg.GetZ());
-            it->second->SetYaw(360.0f * msg.GetYRot() / 256.0f);
-            it->second->SetPitch(360.0f * msg.GetXRot() / 256.0f);
-            it->second->SetOnGround(msg.GetOnGround());
-        }
+        EntityMovement movement;
+        movement.type = EntityMovement::Type::Teleport;
+        movement.entity_id = msg.GetId_();
+        movement.position = Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ());
+        movement.y_rot = msg.GetYRot();
+        movement.x_rot = msg.GetXRot();
+        movement.on_ground = msg.GetOnGround();
 
-        if (msg.GetId_() == local_player->GetEntityID())
-        {
-#ifdef USE_GUI
-            if (rendering_manager)
-            {
-                rendering_manager->SetPosOrientation(local_player->GetPosition().x, local_player->GetPosition().y + 1.62f, local_player->GetPosition().z, local_player->GetYaw(), local_player->GetPitch());
-            }
-#endif // USE_GUI
-            local_player->GetMutex().unlock();
-        }
+        std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        ApplyMovement(movement);
     }
     
     void EntityManager::Handle(ProtocolCraft::ClientboundPlayerAbilitiesPacket& msg)
@@ -334,23 +976,46 @@ namespace Botcraft
 #if PROTOCOL_VERSION == 755
     void EntityManager::Handle(ProtocolCraft::ClientboundRemoveEntityPacket& msg)
     {
+        if (shared_entities != nullptr)
+        {
+            RemoveSharedViewers({ msg.GetEntityId() });
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
-        entities.erase(msg.GetEntityId());
+        RemoveEntity(msg.GetEntityId());
     }
 #else
     void EntityManager::Handle(ProtocolCraft::ClientboundRemoveEntitiesPacket& msg)
     {
+        if (shared_entities != nullptr)
+        {
+            RemoveSharedViewers(msg.GetEntityIds());
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
         for (int i = 0; i < msg.GetEntityIds().size(); ++i)
         {
-            entities.erase(msg.GetEntityIds()[i]);
+            RemoveEntity(msg.GetEntityIds()[i]);
         }
     }
 #endif
 
     void EntityManager::Handle(ProtocolCraft::ClientboundSetEntityDataPacket& msg)
     {
+        if (ForwardUpdateToShared(msg, msg.GetId_()))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        // Metadata of stub and ignored entities are dropped
+        if (untracked_entities.find(msg.GetId_()) != untracked_entities.end())
+        {
+            return;
+        }
+
         if (msg.GetId_() == local_player->GetEntityID())
         {
             local_player->GetMutex().lock();
@@ -374,7 +1039,18 @@ namespace Botcraft
 
     void EntityManager::Handle(ProtocolCraft::ClientboundSetEntityMotionPacket& msg)
     {
+        if (ForwardUpdateToShared(msg, msg.GetId_()))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        auto untracked_it = untracked_entities.find(msg.GetId_());
+        if (untracked_it != untracked_entities.end() && untracked_it->second == EntityTrackingMode::Ignored)
+        {
+            return;
+        }
+
         if (msg.GetId_() == local_player->GetEntityID())
         {
             local_player->GetMutex().lock();
@@ -399,7 +1075,18 @@ namespace Botcraft
 
     void EntityManager::Handle(ProtocolCraft::ClientboundSetEquipmentPacket& msg)
     {
+        if (ForwardUpdateToShared(msg, msg.GetEntityId()))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> entity_manager_locker(entity_manager_mutex);
+        // Equipment of stub and ignored entities are dropped
+        if (untracked_entities.find(msg.GetEntityId()) != untracked_entities.end())
+        {
+            return;
+        }
+
 #if PROTOCOL_VERSION > 730
         auto it = entities.find(msg.GetEntityId());
         if (it == entities.end())
@@ -434,6 +1121,20 @@ namespace Botcraft
 
     void EntityManager::Handle(ProtocolCraft::ClientboundUpdateMobEffectPacket& msg)
     {
-        // TODO
+        // Only the local player effects are tracked
+        if (msg.GetEntityId() == local_player->GetEntityID())
+        {
+            std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
+            local_player->SetEffect(static_cast<EffectType>(msg.GetEffectId()), msg.GetEffectAmplifier(), msg.GetEffectDurationTicks());
+        }
+    }
+
+    void EntityManager::Handle(ProtocolCraft::ClientboundRemoveMobEffectPacket& msg)
+    {
+        if (msg.GetEntityId() == local_player->GetEntityID())
+        {
+            std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
+            local_player->RemoveEffect(static_cast<EffectType>(msg.GetEffect()));
+        }
     }
 }
@@ -0,0 +1,55 @@
+#include <new>
+
+#include "botcraft/Game/Entities/EntityPool.hpp"
+
+namespace Botcraft
+{
+    EntityPool::EntityPool()
+    {
+        num_free_blocks = 0;
+    }
+
+    EntityPool& EntityPool::GetInstance()
+    {
+        static EntityPool* instance = new EntityPool();
+
+        return *instance;
+    }
+
+    void* EntityPool::Allocate(const size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            auto it = free_blocks.find(size);
+            if (it != free_blocks.end() && !it->second.empty())
+            {
+                void* block = it->second.back();
+                it->second.pop_back();
+                num_free_blocks -= 1;
+                return block;
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void EntityPool::Release(void* block, const size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            std::vector<void*>& blocks = free_blocks[size];
+            if (blocks.size() < max_free_blocks_per_size)
+            {
+                blocks.push_back(block);
+                num_free_blocks += 1;
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+    size_t EntityPool::GetNumFreeBlocks() const
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        return num_free_blocks;
+    }
+} // Botcraft
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+
+#include "botcraft/Game/Entities/EntitySnapshot.hpp"
+
+namespace Botcraft
+{
+    EntitySnapshot::EntitySnapshot(const std::shared_ptr<const Data>& data_)
+    {
+        if (data_)
+        {
+            data = data_;
+        }
+        else
+        {
+            std::shared_ptr<Data> empty_data = std::make_shared<Data>();
+            empty_data->epoch = 0;
+            data = empty_data;
+        }
+    }
+
+    const unsigned long long EntitySnapshot::GetEpoch() const
+    {
+        return data->epoch;
+    }
+
+    const std::vector<EntitySnapshot::EntityState>& EntitySnapshot::GetEntities() const
+    {
+        return data->states;
+    }
+
+    const EntitySnapshot::EntityState* EntitySnapshot::GetEntity(const int id) const
+    {
+        auto it = data->indices.find(id);
+        if (it == data->indices.end())
+        {
+            return nullptr;
+        }
+        return &data->states[it->second];
+    }
+
+    std::vector<const EntitySnapshot::EntityState*> EntitySnapshot::QueryRadius(const Vector3<double>& center, const double radius,
+        const std::function<bool(const EntityState&)>& filter) const
+    {
+        std::vector<const EntityState*> output;
+        const double sqr_radius = radius * radius;
+        for (size_t i = 0; i < data->states.size(); ++i)
+        {
+            const EntityState& state = data->states[i];
+            if (center.SqrDist(state.position) <= sqr_radius &&
+                (filter == nullptr || filter(state)))
+            {
+                output.push_back(&state);
+            }
+        }
+        return output;
+    }
+
+    size_t EntitySnapshot::FillFeatures(const Vector3<double>& center, const double radius, float* output, const size_t max_entities,
+        const std::function<bool(const EntityState&)>& filter) const
+    {
+        std::vector<std::pair<double, const EntityState*> > found;
+        const double sqr_radius = radius * radius;
+        for (const EntityState& state : data->states)
+        {
+            const double sqr_dist = center.SqrDist(state.position);
+            if (sqr_dist <= sqr_radius &&
+                (filter == nullptr || filter(state)))
+            {
+                found.emplace_back(sqr_dist, &state);
+            }
+        }
+
+        const size_t num_rows = std::min(found.size(), max_entities);
+        std::partial_sort(found.begin(), found.begin() + num_rows, found.end(),
+            [](const std::pair<double, const EntityState*>& a, const std::pair<double, const EntityState*>& b)
+            {
+                return a.first < b.first;
+            });
+
+        for (size_t i = 0; i < num_rows; ++i)
+        {
+            const EntityState& state = *found[i].second;
+            float* row = output + i * NUM_FEATURES;
+            row[0] = static_cast<float>(static_cast<int>(state.type));
+            row[1] = static_cast<float>(state.position.x - center.x);
+            row[2] = static_cast<float>(state.position.y - center.y);
+            row[3] = static_cast<float>(state.position.z - center.z);
+            row[4] = state.yaw;
+            row[5] = state.pitch;
+            row[6] = state.on_ground ? 1.0f : 0.0f;
+            row[7] = static_cast<float>(std::sqrt(found[i].first));
+        }
+        return num_rows;
+    }
+} // Botcraft
@@ -1,3 +1,5 @@
+#include <thread>
+
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
 
 #define PI 3.14159265359
@@ -21,11 +23,21 @@ namespace Botcraft
         food_saturation = 5.0f;
 
         has_moved = true;
+
+        queued_commands = nullptr;
+        state_sequence = 0;
+        PublishState();
     }
 
     LocalPlayer::~LocalPlayer()
     {
-
+        QueuedCommand* command = queued_commands.exchange(nullptr);
+        while (command != nullptr)
+        {
+            QueuedCommand* next = command->next;
+            delete command;
+            command = next;
+        }
     }
 
 
@@ -34,6 +46,87 @@ namespace Botcraft
         return player_mutex;
     }
 
+    LocalPlayerState LocalPlayer::GetState() const
+    {
+        while (true)
+        {
+            const unsigned int sequence = state_sequence.load(std::memory_order_acquire);
+            if (sequence & 1)
+            {
+                // A new state is being published
+                std::this_thread::yield();
+                continue;
+            }
+            const LocalPlayerState state = published_state;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (state_sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                return state;
+            }
+        }
+    }
+
+    void LocalPlayer::PublishState()
+    {
+        // Only one writer as player_mutex is locked
+        const unsigned int sequence = state_sequence.load(std::memory_order_relaxed);
+        state_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        published_state.position = position;
+        published_state.speed = speed;
+        published_state.yaw = yaw;
+        published_state.pitch = pitch;
+        published_state.on_ground = on_ground;
+        published_state.health = health;
+        published_state.food = food;
+        published_state.food_saturation = food_saturation;
+
+        state_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void LocalPlayer::QueueCommand(std::function<void(LocalPlayer&)>&& command)
+    {
+        QueuedCommand* queued = new QueuedCommand{ std::move(command), queued_commands.load(std::memory_order_relaxed) };
+        while (!queued_commands.compare_exchange_weak(queued->next, queued, std::memory_order_release, std::memory_order_relaxed))
+        {
+
+        }
+    }
+
+    void LocalPlayer::QueueInputs(const Vector3<double>& inputs)
+    {
+        QueueCommand([inputs](LocalPlayer& player) { player.AddPlayerInputs(inputs); });
+    }
+
+    void LocalPlayer::QueueLookAt(const Vector3<double>& pos, const bool set_pitch)
+    {
+        QueueCommand([pos, set_pitch](LocalPlayer& player) { player.LookAt(pos, set_pitch); });
+    }
+
+    void LocalPlayer::ProcessQueuedCommands()
+    {
+        QueuedCommand* command = queued_commands.exchange(nullptr, std::memory_order_acquire);
+
+        // Reverse the stack to apply the commands in order
+        QueuedCommand* ordered = nullptr;
+        while (command != nullptr)
+        {
+            QueuedCommand* next = command->next;
+            command->next = ordered;
+            ordered = command;
+            command = next;
+        }
+
+        while (ordered != nullptr)
+        {
+            QueuedCommand* next = ordered->next;
+            ordered->command(*this);
+            delete ordered;
+            ordered = next;
+        }
+    }
+
 
     const Vector3<double>& LocalPlayer::GetFrontVector() const
     {
@@ -147,6 +240,26 @@ namespace Botcraft
         health = health_;
     }
 
+    void LocalPlayer::SetEffect(const EffectType effect, const int amplifier, const int duration_ticks)
+    {
+        effects[effect] = { amplifier, VirtualClock::now() + std::chrono::milliseconds(50 * static_cast<long long int>(duration_ticks)) };
+    }
+
+    void LocalPlayer::RemoveEffect(const EffectType effect)
+    {
+        effects.erase(effect);
+    }
+
+    const int LocalPlayer::GetEffectLevel(const EffectType effect) const
+    {
+        auto it = effects.find(effect);
+        if (it == effects.end() || it->second.second < VirtualClock::now())
+        {
+            return 0;
+        }
+        return it->second.first + 1;
+    }
+
     void LocalPlayer::SetFood(const int food_)
     {
         food = food_;
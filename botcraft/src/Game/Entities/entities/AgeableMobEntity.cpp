@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AgeableMobEntityMetadata
+    {
+        enum
+        {
+            data_baby_id,
+        };
+    };
+
     const std::array<std::string, AgeableMobEntity::metadata_count> AgeableMobEntity::metadata_names{ {
         "data_baby_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     AgeableMobEntity::AgeableMobEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataBabyId(false);
     }
 
@@ -41,19 +51,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool AgeableMobEntity::GetDataBabyId() const
     {
-        return std::any_cast<bool>(metadata.at("data_baby_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AgeableMobEntityMetadata::data_baby_id]);
     }
 
 
     void AgeableMobEntity::SetDataBabyId(const bool data_baby_id)
     {
-        metadata["data_baby_id"] = data_baby_id;
+        metadata[hierarchy_metadata_count + AgeableMobEntityMetadata::data_baby_id] = data_baby_id;
     }
 
 }
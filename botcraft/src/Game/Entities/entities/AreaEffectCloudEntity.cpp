@@ -2,6 +2,22 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AreaEffectCloudEntityMetadata
+    {
+        enum
+        {
+            data_radius,
+            data_color,
+            data_waiting,
+            data_particle,
+#if PROTOCOL_VERSION < 341
+            data_particle_argument1,
+            data_particle_argument2,
+#endif
+        };
+    };
+
     const std::array<std::string, AreaEffectCloudEntity::metadata_count> AreaEffectCloudEntity::metadata_names{ {
         "data_radius",
         "data_color",
@@ -16,6 +32,7 @@ namespace Botcraft
     AreaEffectCloudEntity::AreaEffectCloudEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataRadius(0.5f);
         SetDataColor(0);
         SetDataWaiting(false);
@@ -90,51 +107,51 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     float AreaEffectCloudEntity::GetDataRadius() const
     {
-        return std::any_cast<float>(metadata.at("data_radius"));
+        return std::any_cast<float>(metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_radius]);
     }
 
     int AreaEffectCloudEntity::GetDataColor() const
     {
-        return std::any_cast<int>(metadata.at("data_color"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_color]);
     }
 
     bool AreaEffectCloudEntity::GetDataWaiting() const
     {
-        return std::any_cast<bool>(metadata.at("data_waiting"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_waiting]);
     }
 
 #if PROTOCOL_VERSION > 340
     const std::shared_ptr<ProtocolCraft::Particle>& AreaEffectCloudEntity::GetDataParticle() const
     {
-        return std::any_cast<const std::shared_ptr<ProtocolCraft::Particle>&>(metadata.at("data_particle"));
+        return std::any_cast<const std::shared_ptr<ProtocolCraft::Particle>&>(metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle]);
     }
 #else
     const std::optional<int>& AreaEffectCloudEntity::GetDataParticle() const
     {
-        return std::any_cast<const std::optional<int>&>(metadata.at("data_particle"));
+        return std::any_cast<const std::optional<int>&>(metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle]);
     }
 
     int AreaEffectCloudEntity::GetDataParticleArgument1() const
     {
-        return std::any_cast<int>(metadata.at("data_particle_argument1"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle_argument1]);
     }
 
     int AreaEffectCloudEntity::GetDataParticleArgument2() const
     {
-        return std::any_cast<int>(metadata.at("data_particle_argument2"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle_argument2]);
     }
 #endif
 
 
     void AreaEffectCloudEntity::SetDataRadius(const float data_radius)
     {
-        metadata["data_radius"] = data_radius;
+        metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_radius] = data_radius;
 #if USE_GUI
         are_rendered_faces_up_to_date = false;
         for (size_t i = 0; i < faces.size(); ++i)
@@ -147,33 +164,33 @@ namespace Botcraft
 
     void AreaEffectCloudEntity::SetDataColor(const int data_color)
     {
-        metadata["data_color"] = data_color;
+        metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_color] = data_color;
     }
 
     void AreaEffectCloudEntity::SetDataWaiting(const bool data_waiting)
     {
-        metadata["data_waiting"] = data_waiting;
+        metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_waiting] = data_waiting;
     }
 
 #if PROTOCOL_VERSION > 340
     void AreaEffectCloudEntity::SetDataParticle(const std::shared_ptr<ProtocolCraft::Particle>& data_particle)
     {
-        metadata["data_particle"] = data_particle;
+        metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle] = data_particle;
     }
 #else
     void AreaEffectCloudEntity::SetDataParticle(const std::optional<int>& data_particle)
     {
-        metadata["data_particle"] = data_particle;
+        metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle] = data_particle;
     }
 
     void AreaEffectCloudEntity::SetDataParticleArgument1(const int data_particle_argument1)
     {
-        metadata["data_particle_argument1"] = data_particle_argument1;
+        metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle_argument1] = data_particle_argument1;
     }
 
     void AreaEffectCloudEntity::SetDataParticleArgument2(const int data_particle_argument2)
     {
-        metadata["data_particle_argument2"] = data_particle_argument2;
+        metadata[hierarchy_metadata_count + AreaEffectCloudEntityMetadata::data_particle_argument2] = data_particle_argument2;
     }
 #endif
 
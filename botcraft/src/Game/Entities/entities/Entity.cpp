@@ -1,4 +1,6 @@
 #include "botcraft/Game/Entities/entities/Entity.hpp"
+#include "botcraft/Game/Entities/EntityKinematicsTable.hpp"
+#include "botcraft/Game/Entities/EntityPool.hpp"
 
 #include "protocolCraft/Types/Slot.hpp"
 #include "protocolCraft/Types/Chat/Chat.hpp"
@@ -198,8 +200,41 @@
 #include "botcraft/Game/Entities/entities/player/PlayerEntity.hpp"
 #include "botcraft/Game/Entities/entities/projectile/FishingHookEntity.hpp"
 
+namespace
+{
+    template<class T>
+    std::shared_ptr<Botcraft::Entity> MakeEntity(const bool pooled)
+    {
+        if (pooled)
+        {
+            return std::allocate_shared<T>(Botcraft::EntityPoolAllocator<T>());
+        }
+        return std::make_shared<T>();
+    }
+}
+
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct EntityMetadata
+    {
+        enum
+        {
+            data_shared_flags_id,
+            data_air_supply_id,
+            data_custom_name,
+            data_custom_name_visible,
+            data_silent,
+            data_no_gravity,
+#if PROTOCOL_VERSION > 404
+            data_pose,
+#endif
+#if PROTOCOL_VERSION > 754
+            data_ticks_frozen,
+#endif
+        };
+    };
+
     const std::array<std::string, Entity::metadata_count> Entity::metadata_names{ {
         "data_shared_flags_id",
         "data_air_supply_id",
@@ -219,6 +254,9 @@ namespace Botcraft
     {
         // Initialize base stuff
         entity_id = 0;
+        uuid.fill(0);
+        kinematics_table = nullptr;
+        kinematics_row = -1;
         position = Vector3<double>(0.0, 0.0, 0.0);
         yaw = 0.0f;
         pitch = 0.0f;
@@ -234,6 +272,7 @@ namespace Botcraft
         };
 
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataSharedFlagsId(0);
         SetDataAirSupplyId(300);
 #if PROTOCOL_VERSION > 340
@@ -254,7 +293,10 @@ namespace Botcraft
 
     Entity::~Entity()
     {
-
+        if (kinematics_table != nullptr)
+        {
+            kinematics_table->Remove(entity_id);
+        }
     }
 
 
@@ -281,9 +323,12 @@ namespace Botcraft
             return;
         }
 
-        ProtocolCraft::ReadIterator iter = data.begin();
+        ProtocolCraft::ReadIterator iter = data.data();
         size_t length = data.size();
 
+        // Shared by all the values of this update kept in their raw form
+        std::shared_ptr<const std::vector<unsigned char> > shared_data;
+
         while (true)
         {
             const unsigned char index = ProtocolCraft::ReadData<unsigned char>(iter, length);
@@ -293,295 +338,401 @@ namespace Botcraft
             }
 
             const int type = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            const size_t offset = iter - data.data();
             std::any value;
 
-            switch (type)
+            // Slots, chats and NBT are only decoded if their getter
+            // is called, most of them are never looked at
+            if (SkipMetadataValue(type, iter, length))
             {
-            case 0:
-                value = ProtocolCraft::ReadData<char>(iter, length);
-                break;
-            case 1:
-                value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
-                break;
-            case 2:
-                value = ProtocolCraft::ReadData<float>(iter, length);
-                break;
-            case 3:
-                value = ProtocolCraft::ReadData<std::string>(iter, length);
-                break;
-            case 4:
-                value = ProtocolCraft::Chat();
-                std::any_cast<ProtocolCraft::Chat&>(value).Read(iter, length);
-                break;
-#if PROTOCOL_VERSION > 340
-            case 5:
-                if (ProtocolCraft::ReadData<bool>(iter, length))
+                if (shared_data == nullptr)
                 {
-                    value = std::optional<ProtocolCraft::Chat>(ProtocolCraft::Chat());
-                    std::any_cast<std::optional<ProtocolCraft::Chat>&>(value).value().Read(iter, length);
+                    shared_data = std::make_shared<const std::vector<unsigned char> >(data);
                 }
-                else
+                value = RawMetadata{ type, shared_data, offset };
+            }
+            else
+            {
+                value = ReadMetadataValue(type, iter, length);
+                if (!value.has_value())
                 {
-                    value = std::optional<ProtocolCraft::Chat>();
+                    LOG_ERROR("Unknown type in entity metadata : " << type << ".Stopping current metadata parsing.");
+                    return;
                 }
-                break;
+            }
+            SetMetadataValue(index, value);
+        }
+    }
+
+    const std::any& Entity::GetMetadata(const int index) const
+    {
+        std::any& value = metadata[index];
+        if (value.type() == typeid(RawMetadata))
+        {
+            // Copy as value is overwritten
+            const RawMetadata raw = std::any_cast<const RawMetadata&>(value);
+            ProtocolCraft::ReadIterator iter = raw.data->data() + raw.offset;
+            size_t length = raw.data->size() - raw.offset;
+            value = ReadMetadataValue(raw.type, iter, length);
+        }
+        return value;
+    }
+
+    std::any Entity::ReadMetadataValue(const int type, ProtocolCraft::ReadIterator& iter, size_t& length)
+    {
+        std::any value;
+
+        switch (type)
+        {
+        case 0:
+            value = ProtocolCraft::ReadData<char>(iter, length);
+            break;
+        case 1:
+            value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
+            break;
+        case 2:
+            value = ProtocolCraft::ReadData<float>(iter, length);
+            break;
+        case 3:
+            value = ProtocolCraft::ReadData<std::string>(iter, length);
+            break;
+        case 4:
+            value = ProtocolCraft::Chat();
+            std::any_cast<ProtocolCraft::Chat&>(value).Read(iter, length);
+            break;
+#if PROTOCOL_VERSION > 340
+        case 5:
+            if (ProtocolCraft::ReadData<bool>(iter, length))
+            {
+                value = std::optional<ProtocolCraft::Chat>(ProtocolCraft::Chat());
+                std::any_cast<std::optional<ProtocolCraft::Chat>&>(value).value().Read(iter, length);
+            }
+            else
+            {
+                value = std::optional<ProtocolCraft::Chat>();
+            }
+            break;
 #endif
 #if PROTOCOL_VERSION > 340
-            case 6:
+        case 6:
 #else
-            case 5:
+        case 5:
 #endif
-                value = ProtocolCraft::Slot();
-                std::any_cast<ProtocolCraft::Slot&>(value).Read(iter, length);
-                break;
+            value = ProtocolCraft::Slot();
+            std::any_cast<ProtocolCraft::Slot&>(value).Read(iter, length);
+            break;
 #if PROTOCOL_VERSION > 340
-            case 7:
+        case 7:
 #else
-            case 6:
+        case 6:
 #endif
-                value = ProtocolCraft::ReadData<bool>(iter, length);
-                break;
+            value = ProtocolCraft::ReadData<bool>(iter, length);
+            break;
 #if PROTOCOL_VERSION > 340
-            case 8:
+        case 8:
 #else
-            case 7:
+        case 7:
 #endif
-            {
-                std::vector<float> rotation = ProtocolCraft::ReadArrayData<float>(iter, length, 3);
-                value = Vector3<float>(rotation[0], rotation[1], rotation[2]);
-                break;
-            }
+        {
+            std::vector<float> rotation = ProtocolCraft::ReadArrayData<float>(iter, length, 3);
+            value = Vector3<float>(rotation[0], rotation[1], rotation[2]);
+            break;
+        }
 #if PROTOCOL_VERSION > 340
-            case 9:
+        case 9:
 #else
-            case 8:
+        case 8:
 #endif
+        {
+            ProtocolCraft::NetworkPosition position;
+            position.Read(iter, length);
+            value = Position(position);
+            break;
+        }
+#if PROTOCOL_VERSION > 340
+        case 10:
+#else
+        case 9:
+#endif
+            if (ProtocolCraft::ReadData<bool>(iter, length))
             {
                 ProtocolCraft::NetworkPosition position;
                 position.Read(iter, length);
-                value = Position(position);
-                break;
+                value = std::optional<Position>(position);
+            }
+            else
+            {
+                value = std::optional<Position>();
             }
+            break;
 #if PROTOCOL_VERSION > 340
-            case 10:
+        case 11:
 #else
-            case 9:
+        case 10:
 #endif
-                if (ProtocolCraft::ReadData<bool>(iter, length))
-                {
-                    ProtocolCraft::NetworkPosition position;
-                    position.Read(iter, length);
-                    value = std::optional<Position>(position);
-                }
-                else
-                {
-                    value = std::optional<Position>();
-                }
-                break;
+            value = static_cast<Direction>(static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length)));
+            break;
 #if PROTOCOL_VERSION > 340
-            case 11:
+        case 12:
 #else
-            case 10:
+        case 11:
 #endif
-                value = static_cast<Direction>(static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length)));
-                break;
+            if (ProtocolCraft::ReadData<bool>(iter, length))
+            {
+                value = std::optional<ProtocolCraft::UUID>(ProtocolCraft::ReadData<ProtocolCraft::UUID>(iter, length));
+            }
+            else
+            {
+                value = std::optional<ProtocolCraft::UUID>();
+            }
+            break;
 #if PROTOCOL_VERSION > 340
-            case 12:
+        case 13:
 #else
-            case 11:
+        case 12:
 #endif
-                if (ProtocolCraft::ReadData<bool>(iter, length))
-                {
-                    value = std::optional<ProtocolCraft::UUID>(ProtocolCraft::ReadData<ProtocolCraft::UUID>(iter, length));
-                }
-                else
-                {
-                    value = std::optional<ProtocolCraft::UUID>();
-                }
-                break;
+            value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
+            break;
 #if PROTOCOL_VERSION > 340
-            case 13:
+        case 14:
 #else
-            case 12:
+        case 13:
 #endif
-                value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
-                break;
+            value = ProtocolCraft::NBT();
+            std::any_cast<ProtocolCraft::NBT&>(value).Read(iter, length);
+            break;
 #if PROTOCOL_VERSION > 340
-            case 14:
-#else
-            case 13:
+        case 15:
+            value = ProtocolCraft::Particle::CreateParticle(static_cast<ProtocolCraft::ParticleType>(static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length))));
+            std::any_cast<std::shared_ptr<ProtocolCraft::Particle>&>(value)->Read(iter, length);
+            break;
 #endif
-                value = ProtocolCraft::NBT();
-                std::any_cast<ProtocolCraft::NBT&>(value).Read(iter, length);
-                break;
+#if PROTOCOL_VERSION > 404
+        case 16:
+            value = VillagerData{
+                ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length), // villager_type
+                ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length), // villager_profession
+                ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length) // level
+            };
+            break;
+        case 17:
+        {
+            const int val = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            value = val > 0 ? std::optional<int>(val - 1) : std::optional<int>();
+            break;
+        }
+        case 18:
+            value = static_cast<Pose>(static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length)));
+            break;
+#endif
+#if PROTOCOL_VERSION > 758
+        case 19:
+            value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
+            break;
+        case 20:
+            value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
+            break;
+        case 21:
+            if (ProtocolCraft::ReadData<bool>(iter, length))
+            {
+                ProtocolCraft::Identifier dimension;
+                dimension.Read(iter, length);
+                ProtocolCraft::NetworkPosition pos;
+                pos.Read(iter, length);
+                
+                value = std::optional<GlobalPos>({
+                        dimension,
+                        pos
+                    });
+            }
+            else
+            {
+                value = std::optional<GlobalPos>();
+            }
+            break;
+        case 22:
+            value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
+            break;
+#endif
+        default:
+            // Unknown type, leave value empty
+            break;
+        }
+
+        return value;
+    }
+
+    bool Entity::SkipMetadataValue(const int type, ProtocolCraft::ReadIterator& iter, size_t& length)
+    {
+        switch (type)
+        {
 #if PROTOCOL_VERSION > 340
-            case 15:
-                value = ProtocolCraft::Particle::CreateParticle(static_cast<ProtocolCraft::ParticleType>(static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length))));
-                std::any_cast<std::shared_ptr<ProtocolCraft::Particle>&>(value)->Read(iter, length);
-                break;
+        case 5: // Optional Chat
+            // Nothing to skip if there is no value
+            if (length == 0 || *iter == 0)
+            {
+                return false;
+            }
+            ProtocolCraft::ReadData<bool>(iter, length);
+            [[fallthrough]];
 #endif
-#if PROTOCOL_VERSION > 404
-            case 16:
-                value = VillagerData{
-                    ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length), // villager_type
-                    ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length), // villager_profession
-                    ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length) // level
-                };
-                break;
-            case 17:
+        case 4: // Chat
+        {
+            const size_t size = static_cast<size_t>(static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length)));
+            if (length < size)
             {
-                const int val = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
-                value = val > 0 ? std::optional<int>(val - 1) : std::optional<int>();
-                break;
+                throw std::runtime_error("Wrong input size reading entity metadata");
             }
-            case 18:
-                value = static_cast<Pose>(static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length)));
-                break;
+            iter += size;
+            length -= size;
+            break;
+        }
+#if PROTOCOL_VERSION > 340
+        case 6: // Slot
+#else
+        case 5: // Slot
 #endif
-#if PROTOCOL_VERSION > 758
-            case 19:
-                value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
-                break;
-            case 20:
-                value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
-                break;
-            case 21:
-                if (ProtocolCraft::ReadData<bool>(iter, length))
-                {
-                    ProtocolCraft::Identifier dimension;
-                    dimension.Read(iter, length);
-                    ProtocolCraft::NetworkPosition pos;
-                    pos.Read(iter, length);
-                    
-                    value = std::optional<GlobalPos>({
-                            dimension,
-                            pos
-                        });
-                }
-                else
-                {
-                    value = std::optional<GlobalPos>();
-                }
-                break;
-            case 22:
-                value = static_cast<int>(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length));
+        {
+#if PROTOCOL_VERSION < 402
+            if (ProtocolCraft::ReadData<short>(iter, length) == -1)
+            {
                 break;
+            }
+            ProtocolCraft::ReadData<char>(iter, length); // item_count
+#if PROTOCOL_VERSION < 350
+            ProtocolCraft::ReadData<short>(iter, length); // item_damage
 #endif
-            default:
-                LOG_ERROR("Unknown type in entity metadata : " << type << ".Stopping current metadata parsing.");
-                return;
+#else
+            if (!ProtocolCraft::ReadData<bool>(iter, length))
+            {
+                break;
             }
-            SetMetadataValue(index, value);
+            ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length); // item_id
+            ProtocolCraft::ReadData<char>(iter, length); // item_count
+#endif
+            ProtocolCraft::FlatNBT::Skip(iter, length);
+            break;
+        }
+#if PROTOCOL_VERSION > 340
+        case 14: // NBT
+#else
+        case 13: // NBT
+#endif
+            ProtocolCraft::FlatNBT::Skip(iter, length);
+            break;
+        default:
+            return false;
         }
+        return true;
     }
 
     void Entity::SetMetadataValue(const int index, const std::any& value)
     {
         assert(index >= 0 && index < metadata_count);
-        metadata[metadata_names[index]] = value;
+        metadata[index] = value;
     }
 
 
     char Entity::GetDataSharedFlagsId() const
     {
-        return std::any_cast<char>(metadata.at("data_shared_flags_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + EntityMetadata::data_shared_flags_id]);
     }
 
     int Entity::GetDataAirSupplyId() const
     {
-        return std::any_cast<int>(metadata.at("data_air_supply_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + EntityMetadata::data_air_supply_id]);
     }
 
 #if PROTOCOL_VERSION > 340
     const std::optional<ProtocolCraft::Chat>& Entity::GetDataCustomName() const
     {
-        return std::any_cast<const std::optional<ProtocolCraft::Chat>&>(metadata.at("data_custom_name"));
+        return std::any_cast<const std::optional<ProtocolCraft::Chat>&>(GetMetadata(hierarchy_metadata_count + EntityMetadata::data_custom_name));
     }
 #else
     const std::string& Entity::GetDataCustomName() const
     {
-        return std::any_cast<const std::string&>(metadata.at("data_custom_name"));
+        return std::any_cast<const std::string&>(metadata[hierarchy_metadata_count + EntityMetadata::data_custom_name]);
     }
 #endif
 
     bool Entity::GetDataCustomNameVisible() const
     {
-        return std::any_cast<bool>(metadata.at("data_custom_name_visible"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + EntityMetadata::data_custom_name_visible]);
     }
 
     bool Entity::GetDataSilent() const
     {
-        return std::any_cast<bool>(metadata.at("data_silent"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + EntityMetadata::data_silent]);
     }
 
     bool Entity::GetDataNoGravity() const
     {
-        return std::any_cast<bool>(metadata.at("data_no_gravity"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + EntityMetadata::data_no_gravity]);
     }
 
 #if PROTOCOL_VERSION > 404
     Pose Entity::GetDataPose() const
     {
-        return std::any_cast<Pose>(metadata.at("data_pose"));
+        return std::any_cast<Pose>(metadata[hierarchy_metadata_count + EntityMetadata::data_pose]);
     }
 #endif
 
 #if PROTOCOL_VERSION > 754
     int Entity::GetDataTicksFrozen() const
     {
-        return std::any_cast<int>(metadata.at("data_ticks_frozen"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + EntityMetadata::data_ticks_frozen]);
     }
 #endif
 
 
     void Entity::SetDataSharedFlagsId(const char data_shared_flags_id)
     {
-        metadata["data_shared_flags_id"] = data_shared_flags_id;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_shared_flags_id] = data_shared_flags_id;
     }
 
     void Entity::SetDataAirSupplyId(const int data_air_supply_id)
     {
-        metadata["data_air_supply_id"] = data_air_supply_id;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_air_supply_id] = data_air_supply_id;
     }
 
 #if PROTOCOL_VERSION > 340
     void Entity::SetDataCustomName(const std::optional<ProtocolCraft::Chat>& data_custom_name)
     {
-        metadata["data_custom_name"] = data_custom_name;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_custom_name] = data_custom_name;
     }
 #else
     void Entity::SetDataCustomName(const std::string& data_custom_name)
     {
-        metadata["data_custom_name"] = data_custom_name;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_custom_name] = data_custom_name;
     }
 #endif
 
     void Entity::SetDataCustomNameVisible(const bool data_custom_name_visible)
     {
-        metadata["data_custom_name_visible"] = data_custom_name_visible;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_custom_name_visible] = data_custom_name_visible;
     }
 
     void Entity::SetDataSilent(const bool data_silent)
     {
-        metadata["data_silent"] = data_silent;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_silent] = data_silent;
     }
 
     void Entity::SetDataNoGravity(const bool data_no_gravity)
     {
-        metadata["data_no_gravity"] = data_no_gravity;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_no_gravity] = data_no_gravity;
     }
 
 #if PROTOCOL_VERSION > 404
     void Entity::SetDataPose(const Pose data_pose)
     {
-        metadata["data_pose"] = data_pose;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_pose] = data_pose;
     }
 #endif
 
 #if PROTOCOL_VERSION > 754
     void Entity::SetDataTicksFrozen(const int data_ticks_frozen)
     {
-        metadata["data_ticks_frozen"] = data_ticks_frozen;
+        metadata[hierarchy_metadata_count + EntityMetadata::data_ticks_frozen] = data_ticks_frozen;
     }
 #endif
 
@@ -591,7 +742,12 @@ namespace Botcraft
         return entity_id;
     }
 
-    const Vector3<double>& Entity::GetPosition() const
+    const ProtocolCraft::UUID& Entity::GetUUID() const
+    {
+        return uuid;
+    }
+
+    Vector3<double> Entity::GetPosition() const
     {
         return position;
     }
@@ -656,6 +812,39 @@ namespace Botcraft
         return equipments.at(slot);
     }
 
+    const size_t Entity::GetMemoryUsage() const
+    {
+        // Subclasses store their data in metadata, so they're about the size of Entity
+        size_t output = sizeof(Entity) +
+            // Map nodes have three pointers and a color on top of the value
+            equipments.size() * (sizeof(std::pair<const EquipmentSlot, ProtocolCraft::Slot>) + 4 * sizeof(void*));
+#if USE_GUI
+        output += face_descriptors.capacity() * sizeof(FaceDescriptor) + faces.capacity() * sizeof(Renderer::Face);
+#endif
+        return output;
+    }
+
+    const size_t Entity::GetMetadataMemoryUsage() const
+    {
+        size_t output = metadata.capacity() * sizeof(std::any);
+        const std::vector<unsigned char>* previous_data = nullptr;
+        for (const std::any& value : metadata)
+        {
+            if (value.type() != typeid(RawMetadata))
+            {
+                continue;
+            }
+            // All the raw values of one metadata packet share the same data
+            const RawMetadata& raw = std::any_cast<const RawMetadata&>(value);
+            if (raw.data.get() != previous_data)
+            {
+                previous_data = raw.data.get();
+                output += sizeof(std::vector<unsigned char>) + raw.data->capacity();
+            }
+        }
+        return output;
+    }
+
 #if USE_GUI
     const std::vector<Renderer::Face>& Entity::GetFaces()
     {
@@ -682,9 +871,23 @@ namespace Botcraft
 
     void Entity::SetEntityID(const int entity_id_)
     {
+        // Rows of the kinematics table are indexed by id
+        if (kinematics_table != nullptr && entity_id_ != entity_id)
+        {
+            EntityKinematicsTable* table = kinematics_table;
+            table->Remove(entity_id);
+            entity_id = entity_id_;
+            table->Add(this);
+            return;
+        }
         entity_id = entity_id_;
     }
 
+    void Entity::SetUUID(const ProtocolCraft::UUID& uuid_)
+    {
+        uuid = uuid_;
+    }
+
     void Entity::SetPosition(const Vector3<double>& position_)
     {
 #if USE_GUI
@@ -701,6 +904,10 @@ namespace Botcraft
         }
 #endif
         position = position_;
+        if (kinematics_table)
+        {
+            kinematics_table->Mirror(kinematics_row, *this);
+        }
     }
 
     void Entity::SetX(const double x_)
@@ -716,6 +923,10 @@ namespace Botcraft
         }
 #endif
         position.x = x_;
+        if (kinematics_table)
+        {
+            kinematics_table->Mirror(kinematics_row, *this);
+        }
     }
 
     void Entity::SetY(const double y_)
@@ -731,6 +942,10 @@ namespace Botcraft
         }
 #endif
         position.y = y_;
+        if (kinematics_table)
+        {
+            kinematics_table->Mirror(kinematics_row, *this);
+        }
     }
 
     void Entity::SetZ(const double z_)
@@ -746,6 +961,10 @@ namespace Botcraft
         }
 #endif
         position.z = z_;
+        if (kinematics_table)
+        {
+            kinematics_table->Mirror(kinematics_row, *this);
+        }
     }
 
     void Entity::SetYaw(const float yaw_)
@@ -761,6 +980,10 @@ namespace Botcraft
         }
 #endif
         yaw = yaw_;
+        if (kinematics_table)
+        {
+            kinematics_table->Mirror(kinematics_row, *this);
+        }
     }
 
     void Entity::SetPitch(const float pitch_)
@@ -776,6 +999,10 @@ namespace Botcraft
         }
 #endif
         pitch = pitch_;
+        if (kinematics_table)
+        {
+            kinematics_table->Mirror(kinematics_row, *this);
+        }
     }
 
     void Entity::SetSpeed(const Vector3<double>& speed_)
@@ -801,6 +1028,10 @@ namespace Botcraft
     void Entity::SetOnGround(const bool on_ground_)
     {
         on_ground = on_ground_;
+        if (kinematics_table)
+        {
+            kinematics_table->Mirror(kinematics_row, *this);
+        }
     }
 
     void Entity::SetEquipment(const EquipmentSlot slot, const ProtocolCraft::Slot& item)
@@ -821,11 +1052,11 @@ namespace Botcraft
         nlohmann::json output;
 
         output["id"] = entity_id;
-        output["position"] = position.Serialize();
-        output["yaw"] = yaw;
-        output["pitch"] = pitch;
+        output["position"] = GetPosition().Serialize();
+        output["yaw"] = GetYaw();
+        output["pitch"] = GetPitch();
         output["speed"] = speed.Serialize();
-        output["on_ground"] = on_ground;
+        output["on_ground"] = GetOnGround();
         output["equipment"] = nlohmann::json();
         for (auto& p : equipments)
         {
@@ -1035,7 +1266,7 @@ namespace Botcraft
     }
 
 
-    std::shared_ptr<Entity> Entity::CreateEntity(const EntityType type)
+    std::shared_ptr<Entity> Entity::CreateEntity(const EntityType type, const bool pooled)
     {
         switch (type)
         {
@@ -1043,304 +1274,304 @@ namespace Botcraft
             return nullptr;
 #if PROTOCOL_VERSION > 758
         case EntityType::Allay:
-            return std::make_shared<AllayEntity>();
+            return MakeEntity<AllayEntity>(pooled);
 #endif
         case EntityType::AreaEffectCloud:
-            return std::make_shared<AreaEffectCloudEntity>();
+            return MakeEntity<AreaEffectCloudEntity>(pooled);
         case EntityType::ArmorStand:
-            return std::make_shared<ArmorStandEntity>();
+            return MakeEntity<ArmorStandEntity>(pooled);
         case EntityType::Arrow:
-            return std::make_shared<ArrowEntity>();
+            return MakeEntity<ArrowEntity>(pooled);
 #if PROTOCOL_VERSION > 754
         case EntityType::Axolotl:
-            return std::make_shared<AxolotlEntity>();
+            return MakeEntity<AxolotlEntity>(pooled);
 #endif
         case EntityType::Bat:
-            return std::make_shared<BatEntity>();
+            return MakeEntity<BatEntity>(pooled);
 #if PROTOCOL_VERSION > 498
         case EntityType::Bee:
-            return std::make_shared<BeeEntity>();
+            return MakeEntity<BeeEntity>(pooled);
 #endif
         case EntityType::Blaze:
-            return std::make_shared<BlazeEntity>();
+            return MakeEntity<BlazeEntity>(pooled);
         case EntityType::Boat:
-            return std::make_shared<BoatEntity>();
+            return MakeEntity<BoatEntity>(pooled);
 #if PROTOCOL_VERSION > 758
         case EntityType::ChestBoat:
-            return std::make_shared<ChestBoatEntity>();
+            return MakeEntity<ChestBoatEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 404
         case EntityType::Cat:
-            return std::make_shared<CatEntity>();
+            return MakeEntity<CatEntity>(pooled);
 #endif
         case EntityType::CaveSpider:
-            return std::make_shared<CaveSpiderEntity>();
+            return MakeEntity<CaveSpiderEntity>(pooled);
         case EntityType::Chicken:
-            return std::make_shared<ChickenEntity>();
+            return MakeEntity<ChickenEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::Cod:
-            return std::make_shared<CodEntity>();
+            return MakeEntity<CodEntity>(pooled);
 #endif
         case EntityType::Cow:
-            return std::make_shared<CowEntity>();
+            return MakeEntity<CowEntity>(pooled);
         case EntityType::Creeper:
-            return std::make_shared<CreeperEntity>();
+            return MakeEntity<CreeperEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::Dolphin:
-            return std::make_shared<DolphinEntity>();
+            return MakeEntity<DolphinEntity>(pooled);
 #endif
         case EntityType::Donkey:
-            return std::make_shared<DonkeyEntity>();
+            return MakeEntity<DonkeyEntity>(pooled);
         case EntityType::DragonFireball:
-            return std::make_shared<DragonFireballEntity>();
+            return MakeEntity<DragonFireballEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::Drowned:
-            return std::make_shared<DrownedEntity>();
+            return MakeEntity<DrownedEntity>(pooled);
 #endif
         case EntityType::ElderGuardian:
-            return std::make_shared<ElderGuardianEntity>();
+            return MakeEntity<ElderGuardianEntity>(pooled);
         case EntityType::EndCrystal:
-            return std::make_shared<EndCrystalEntity>();
+            return MakeEntity<EndCrystalEntity>(pooled);
         case EntityType::EnderDragon:
-            return std::make_shared<EnderDragonEntity>();
+            return MakeEntity<EnderDragonEntity>(pooled);
         case EntityType::EnderMan:
-            return std::make_shared<EnderManEntity>();
+            return MakeEntity<EnderManEntity>(pooled);
         case EntityType::Endermite:
-            return std::make_shared<EndermiteEntity>();
+            return MakeEntity<EndermiteEntity>(pooled);
         case EntityType::Evoker:
-            return std::make_shared<EvokerEntity>();
+            return MakeEntity<EvokerEntity>(pooled);
         case EntityType::EvokerFangs:
-            return std::make_shared<EvokerFangsEntity>();
+            return MakeEntity<EvokerFangsEntity>(pooled);
         case EntityType::ExperienceOrb:
-            return std::make_shared<ExperienceOrbEntity>();
+            return MakeEntity<ExperienceOrbEntity>(pooled);
         case EntityType::EyeOfEnder:
-            return std::make_shared<EyeOfEnderEntity>();
+            return MakeEntity<EyeOfEnderEntity>(pooled);
         case EntityType::FallingBlockEntity:
-            return std::make_shared<FallingBlockEntity>();
+            return MakeEntity<FallingBlockEntity>(pooled);
         case EntityType::FireworkRocketEntity:
-            return std::make_shared<FireworkRocketEntity>();
+            return MakeEntity<FireworkRocketEntity>(pooled);
 #if PROTOCOL_VERSION > 404
         case EntityType::Fox:
-            return std::make_shared<FoxEntity>();
+            return MakeEntity<FoxEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 758
         case EntityType::Frog:
-            return std::make_shared<FrogEntity>();
+            return MakeEntity<FrogEntity>(pooled);
 #endif
         case EntityType::Ghast:
-            return std::make_shared<GhastEntity>();
+            return MakeEntity<GhastEntity>(pooled);
         case EntityType::Giant:
-            return std::make_shared<GiantEntity>();
+            return MakeEntity<GiantEntity>(pooled);
 #if PROTOCOL_VERSION > 754
         case EntityType::GlowItemFrame:
-            return std::make_shared<GlowItemFrameEntity>();
+            return MakeEntity<GlowItemFrameEntity>(pooled);
         case EntityType::GlowSquid:
-            return std::make_shared<GlowSquidEntity>();
+            return MakeEntity<GlowSquidEntity>(pooled);
         case EntityType::Goat:
-            return std::make_shared<GoatEntity>();
+            return MakeEntity<GoatEntity>(pooled);
 #endif
         case EntityType::Guardian:
-            return std::make_shared<GuardianEntity>();
+            return MakeEntity<GuardianEntity>(pooled);
 #if PROTOCOL_VERSION > 578
         case EntityType::Hoglin:
-            return std::make_shared<HoglinEntity>();
+            return MakeEntity<HoglinEntity>(pooled);
 #endif
         case EntityType::Horse:
-            return std::make_shared<HorseEntity>();
+            return MakeEntity<HorseEntity>(pooled);
         case EntityType::Husk:
-            return std::make_shared<HuskEntity>();
+            return MakeEntity<HuskEntity>(pooled);
         case EntityType::Illusioner:
-            return std::make_shared<IllusionerEntity>();
+            return MakeEntity<IllusionerEntity>(pooled);
         case EntityType::IronGolem:
-            return std::make_shared<IronGolemEntity>();
+            return MakeEntity<IronGolemEntity>(pooled);
         case EntityType::ItemEntity:
-            return std::make_shared<ItemEntity>();
+            return MakeEntity<ItemEntity>(pooled);
         case EntityType::ItemFrame:
-            return std::make_shared<ItemFrameEntity>();
+            return MakeEntity<ItemFrameEntity>(pooled);
         case EntityType::LargeFireball:
-            return std::make_shared<LargeFireballEntity>();
+            return MakeEntity<LargeFireballEntity>(pooled);
         case EntityType::LeashFenceKnotEntity:
-            return std::make_shared<LeashFenceKnotEntity>();
+            return MakeEntity<LeashFenceKnotEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::LightningBolt:
-            return std::make_shared<LightningBoltEntity>();
+            return MakeEntity<LightningBoltEntity>(pooled);
 #endif
         case EntityType::Llama:
-            return std::make_shared<LlamaEntity>();
+            return MakeEntity<LlamaEntity>(pooled);
         case EntityType::LlamaSpit:
-            return std::make_shared<LlamaSpitEntity>();
+            return MakeEntity<LlamaSpitEntity>(pooled);
         case EntityType::MagmaCube:
-            return std::make_shared<MagmaCubeEntity>();
+            return MakeEntity<MagmaCubeEntity>(pooled);
 #if PROTOCOL_VERSION > 754
         case EntityType::Marker:
-            return std::make_shared<MarkerEntity>();
+            return MakeEntity<MarkerEntity>(pooled);
 #endif
         case EntityType::Minecart:
-            return std::make_shared<MinecartEntity>();
+            return MakeEntity<MinecartEntity>(pooled);
         case EntityType::MinecartChest:
-            return std::make_shared<MinecartChestEntity>();
+            return MakeEntity<MinecartChestEntity>(pooled);
         case EntityType::MinecartCommandBlock:
-            return std::make_shared<MinecartCommandBlockEntity>();
+            return MakeEntity<MinecartCommandBlockEntity>(pooled);
         case EntityType::MinecartFurnace:
-            return std::make_shared<MinecartFurnaceEntity>();
+            return MakeEntity<MinecartFurnaceEntity>(pooled);
         case EntityType::MinecartHopper:
-            return std::make_shared<MinecartHopperEntity>();
+            return MakeEntity<MinecartHopperEntity>(pooled);
         case EntityType::MinecartSpawner:
-            return std::make_shared<MinecartSpawnerEntity>();
+            return MakeEntity<MinecartSpawnerEntity>(pooled);
         case EntityType::MinecartTNT:
-            return std::make_shared<MinecartTNTEntity>();
+            return MakeEntity<MinecartTNTEntity>(pooled);
         case EntityType::Mule:
-            return std::make_shared<MuleEntity>();
+            return MakeEntity<MuleEntity>(pooled);
         case EntityType::MushroomCow:
-            return std::make_shared<MushroomCowEntity>();
+            return MakeEntity<MushroomCowEntity>(pooled);
         case EntityType::Ocelot:
-            return std::make_shared<OcelotEntity>();
+            return MakeEntity<OcelotEntity>(pooled);
         case EntityType::Painting:
-            return std::make_shared<PaintingEntity>();
+            return MakeEntity<PaintingEntity>(pooled);
 #if PROTOCOL_VERSION > 404
         case EntityType::Panda:
-            return std::make_shared<PandaEntity>();
+            return MakeEntity<PandaEntity>(pooled);
 #endif
         case EntityType::Parrot:
-            return std::make_shared<ParrotEntity>();
+            return MakeEntity<ParrotEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::Phantom:
-            return std::make_shared<PhantomEntity>();
+            return MakeEntity<PhantomEntity>(pooled);
 #endif
         case EntityType::Pig:
-            return std::make_shared<PigEntity>();
+            return MakeEntity<PigEntity>(pooled);
 #if PROTOCOL_VERSION > 578
         case EntityType::Piglin:
-            return std::make_shared<PiglinEntity>();
+            return MakeEntity<PiglinEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 736
         case EntityType::PiglinBrute:
-            return std::make_shared<PiglinBruteEntity>();
+            return MakeEntity<PiglinBruteEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 404
         case EntityType::Pillager:
-            return std::make_shared<PillagerEntity>();
+            return MakeEntity<PillagerEntity>(pooled);
 #endif
         case EntityType::PolarBear:
-            return std::make_shared<PolarBearEntity>();
+            return MakeEntity<PolarBearEntity>(pooled);
         case EntityType::PrimedTnt:
-            return std::make_shared<PrimedTntEntity>();
+            return MakeEntity<PrimedTntEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::Pufferfish:
-            return std::make_shared<PufferfishEntity>();
+            return MakeEntity<PufferfishEntity>(pooled);
 #endif
         case EntityType::Rabbit:
-            return std::make_shared<RabbitEntity>();
+            return MakeEntity<RabbitEntity>(pooled);
 #if PROTOCOL_VERSION > 404
         case EntityType::Ravager:
-            return std::make_shared<RavagerEntity>();
+            return MakeEntity<RavagerEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 340
         case EntityType::Salmon:
-            return std::make_shared<SalmonEntity>();
+            return MakeEntity<SalmonEntity>(pooled);
 #endif
         case EntityType::Sheep:
-            return std::make_shared<SheepEntity>();
+            return MakeEntity<SheepEntity>(pooled);
         case EntityType::Shulker:
-            return std::make_shared<ShulkerEntity>();
+            return MakeEntity<ShulkerEntity>(pooled);
         case EntityType::ShulkerBullet:
-            return std::make_shared<ShulkerBulletEntity>();
+            return MakeEntity<ShulkerBulletEntity>(pooled);
         case EntityType::Silverfish:
-            return std::make_shared<SilverfishEntity>();
+            return MakeEntity<SilverfishEntity>(pooled);
         case EntityType::Skeleton:
-            return std::make_shared<SkeletonEntity>();
+            return MakeEntity<SkeletonEntity>(pooled);
         case EntityType::SkeletonHorse:
-            return std::make_shared<SkeletonHorseEntity>();
+            return MakeEntity<SkeletonHorseEntity>(pooled);
         case EntityType::Slime:
-            return std::make_shared<SlimeEntity>();
+            return MakeEntity<SlimeEntity>(pooled);
         case EntityType::SmallFireball:
-            return std::make_shared<SmallFireballEntity>();
+            return MakeEntity<SmallFireballEntity>(pooled);
         case EntityType::SnowGolem:
-            return std::make_shared<SnowGolemEntity>();
+            return MakeEntity<SnowGolemEntity>(pooled);
         case EntityType::Snowball:
-            return std::make_shared<SnowballEntity>();
+            return MakeEntity<SnowballEntity>(pooled);
         case EntityType::SpectralArrow:
-            return std::make_shared<SpectralArrowEntity>();
+            return MakeEntity<SpectralArrowEntity>(pooled);
         case EntityType::Spider:
-            return std::make_shared<SpiderEntity>();
+            return MakeEntity<SpiderEntity>(pooled);
         case EntityType::Squid:
-            return std::make_shared<SquidEntity>();
+            return MakeEntity<SquidEntity>(pooled);
         case EntityType::Stray:
-            return std::make_shared<StrayEntity>();
+            return MakeEntity<StrayEntity>(pooled);
 #if PROTOCOL_VERSION > 578
         case EntityType::Strider:
-            return std::make_shared<StriderEntity>();
+            return MakeEntity<StriderEntity>(pooled);
 #endif
         case EntityType::ThrownEgg:
-            return std::make_shared<ThrownEggEntity>();
+            return MakeEntity<ThrownEggEntity>(pooled);
         case EntityType::ThrownEnderpearl:
-            return std::make_shared<ThrownEnderpearlEntity>();
+            return MakeEntity<ThrownEnderpearlEntity>(pooled);
         case EntityType::ThrownExperienceBottle:
-            return std::make_shared<ThrownExperienceBottleEntity>();
+            return MakeEntity<ThrownExperienceBottleEntity>(pooled);
         case EntityType::ThrownPotion:
-            return std::make_shared<ThrownPotionEntity>();
+            return MakeEntity<ThrownPotionEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::ThrownTrident:
-            return std::make_shared<ThrownTridentEntity>();
+            return MakeEntity<ThrownTridentEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 404
         case EntityType::TraderLlama:
-            return std::make_shared<TraderLlamaEntity>();
+            return MakeEntity<TraderLlamaEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 340
         case EntityType::TropicalFish:
-            return std::make_shared<TropicalFishEntity>();
+            return MakeEntity<TropicalFishEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 340
         case EntityType::Turtle:
-            return std::make_shared<TurtleEntity>();
+            return MakeEntity<TurtleEntity>(pooled);
 #endif
         case EntityType::Vex:
-            return std::make_shared<VexEntity>();
+            return MakeEntity<VexEntity>(pooled);
         case EntityType::Villager:
-            return std::make_shared<VillagerEntity>();
+            return MakeEntity<VillagerEntity>(pooled);
         case EntityType::Vindicator:
-            return std::make_shared<VindicatorEntity>();
+            return MakeEntity<VindicatorEntity>(pooled);
 #if PROTOCOL_VERSION > 404
         case EntityType::WanderingTrader:
-            return std::make_shared<WanderingTraderEntity>();
+            return MakeEntity<WanderingTraderEntity>(pooled);
 #endif
 #if PROTOCOL_VERSION > 758
         case EntityType::Warden:
-            return std::make_shared<WardenEntity>();
+            return MakeEntity<WardenEntity>(pooled);
 #endif
         case EntityType::Witch:
-            return std::make_shared<WitchEntity>();
+            return MakeEntity<WitchEntity>(pooled);
         case EntityType::WitherBoss:
-            return std::make_shared<WitherBossEntity>();
+            return MakeEntity<WitherBossEntity>(pooled);
         case EntityType::WitherSkeleton:
-            return std::make_shared<WitherSkeletonEntity>();
+            return MakeEntity<WitherSkeletonEntity>(pooled);
         case EntityType::WitherSkull:
-            return std::make_shared<WitherSkullEntity>();
+            return MakeEntity<WitherSkullEntity>(pooled);
         case EntityType::Wolf:
-            return std::make_shared<WolfEntity>();
+            return MakeEntity<WolfEntity>(pooled);
 #if PROTOCOL_VERSION > 578
         case EntityType::Zoglin:
-            return std::make_shared<ZoglinEntity>();
+            return MakeEntity<ZoglinEntity>(pooled);
 #endif
         case EntityType::Zombie:
-            return std::make_shared<ZombieEntity>();
+            return MakeEntity<ZombieEntity>(pooled);
         case EntityType::ZombieHorse:
-            return std::make_shared<ZombieHorseEntity>();
+            return MakeEntity<ZombieHorseEntity>(pooled);
         case EntityType::ZombieVillager:
-            return std::make_shared<ZombieVillagerEntity>();
+            return MakeEntity<ZombieVillagerEntity>(pooled);
 #if PROTOCOL_VERSION > 578
         case EntityType::ZombifiedPiglin:
-            return std::make_shared<ZombifiedPiglinEntity>();
+            return MakeEntity<ZombifiedPiglinEntity>(pooled);
 #else
         case EntityType::PigZombie:
-            return std::make_shared<PigZombieEntity>();
+            return MakeEntity<PigZombieEntity>(pooled);
 #endif
         case EntityType::Player:
-            return std::make_shared<PlayerEntity>();
+            return MakeEntity<PlayerEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case EntityType::FishingHook:
-            return std::make_shared<FishingHookEntity>();
+            return MakeEntity<FishingHookEntity>(pooled);
 #endif
         default:
             return nullptr;
@@ -1348,67 +1579,67 @@ namespace Botcraft
     }
 
 #if PROTOCOL_VERSION < 458
-    std::shared_ptr<Entity> Entity::CreateObjectEntity(const ObjectEntityType type)
+    std::shared_ptr<Entity> Entity::CreateObjectEntity(const ObjectEntityType type, const bool pooled)
     {
         switch (type)
         {
         case ObjectEntityType::None:
             return nullptr;
         case ObjectEntityType::Boat:
-            return std::make_shared<BoatEntity>();
+            return MakeEntity<BoatEntity>(pooled);
         case ObjectEntityType::ItemEntity:
-            return std::make_shared<ItemEntity>();
+            return MakeEntity<ItemEntity>(pooled);
         case ObjectEntityType::AreaEffectCloud:
-            return std::make_shared<AreaEffectCloudEntity>();
+            return MakeEntity<AreaEffectCloudEntity>(pooled);
         case ObjectEntityType::PrimedTnt:
-            return std::make_shared<PrimedTntEntity>();
+            return MakeEntity<PrimedTntEntity>(pooled);
         case ObjectEntityType::EndCrystal:
-            return std::make_shared<EndCrystalEntity>();
+            return MakeEntity<EndCrystalEntity>(pooled);
         case ObjectEntityType::Arrow:
-            return std::make_shared<ArrowEntity>();
+            return MakeEntity<ArrowEntity>(pooled);
         case ObjectEntityType::Snowball:
-            return std::make_shared<SnowballEntity>();
+            return MakeEntity<SnowballEntity>(pooled);
         case ObjectEntityType::ThrownEgg:
-            return std::make_shared<ThrownEggEntity>();
+            return MakeEntity<ThrownEggEntity>(pooled);
         case ObjectEntityType::LargeFireball:
-            return std::make_shared<LargeFireballEntity>();
+            return MakeEntity<LargeFireballEntity>(pooled);
         case ObjectEntityType::SmallFireball:
-            return std::make_shared<SmallFireballEntity>();
+            return MakeEntity<SmallFireballEntity>(pooled);
         case ObjectEntityType::ThrownEnderpearl:
-            return std::make_shared<ThrownEnderpearlEntity>();
+            return MakeEntity<ThrownEnderpearlEntity>(pooled);
         case ObjectEntityType::WitherSkull:
-            return std::make_shared<WitherSkullEntity>();
+            return MakeEntity<WitherSkullEntity>(pooled);
         case ObjectEntityType::ShulkerBullet:
-            return std::make_shared<ShulkerBulletEntity>();
+            return MakeEntity<ShulkerBulletEntity>(pooled);
         case ObjectEntityType::LlamaSpit:
-            return std::make_shared<LlamaSpitEntity>();
+            return MakeEntity<LlamaSpitEntity>(pooled);
         case ObjectEntityType::FallingBlockEntity:
-            return std::make_shared<FallingBlockEntity>();
+            return MakeEntity<FallingBlockEntity>(pooled);
         case ObjectEntityType::ItemFrame:
-            return std::make_shared<ItemFrameEntity>();
+            return MakeEntity<ItemFrameEntity>(pooled);
         case ObjectEntityType::EyeOfEnder:
-            return std::make_shared<EyeOfEnderEntity>();
+            return MakeEntity<EyeOfEnderEntity>(pooled);
         case ObjectEntityType::ThrownPotion:
-            return std::make_shared<ThrownPotionEntity>();
+            return MakeEntity<ThrownPotionEntity>(pooled);
         case ObjectEntityType::ThrownExperienceBottle:
-            return std::make_shared<ThrownExperienceBottleEntity>();
+            return MakeEntity<ThrownExperienceBottleEntity>(pooled);
         case ObjectEntityType::FireworkRocketEntity:
-            return std::make_shared<FireworkRocketEntity>();
+            return MakeEntity<FireworkRocketEntity>(pooled);
         case ObjectEntityType::LeashFenceKnotEntity:
-            return std::make_shared<LeashFenceKnotEntity>();
+            return MakeEntity<LeashFenceKnotEntity>(pooled);
         case ObjectEntityType::ArmorStand:
-            return std::make_shared<ArmorStandEntity>();
+            return MakeEntity<ArmorStandEntity>(pooled);
         case ObjectEntityType::EvokerFangs:
-            return std::make_shared<EvokerFangsEntity>();
+            return MakeEntity<EvokerFangsEntity>(pooled);
         case ObjectEntityType::FishingHook:
-            return std::make_shared<FishingHookEntity>();
+            return MakeEntity<FishingHookEntity>(pooled);
         case ObjectEntityType::SpectralArrow:
-            return std::make_shared<SpectralArrowEntity>();
+            return MakeEntity<SpectralArrowEntity>(pooled);
         case ObjectEntityType::DragonFireball:
-            return std::make_shared<DragonFireballEntity>();
+            return MakeEntity<DragonFireballEntity>(pooled);
 #if PROTOCOL_VERSION > 340
         case ObjectEntityType::ThrownTrident:
-            return std::make_shared<ThrownTridentEntity>();
+            return MakeEntity<ThrownTridentEntity>(pooled);
 #endif
         default:
             return nullptr;
@@ -1436,10 +1667,10 @@ namespace Botcraft
             // Base translation
             face_descriptors[i].transformations.translations.push_back(std::make_shared<Renderer::Translation>(0.0f, GetHeight() / 2.0f, 0.0f));
             // Entity pos translation
-            face_descriptors[i].transformations.translations.push_back(std::make_shared<Renderer::Translation>(position.x, position.y, position.z));
+            face_descriptors[i].transformations.translations.push_back(std::make_shared<Renderer::Translation>(GetX(), GetY(), GetZ()));
             // Entity yaw/pitch rotation
-            face_descriptors[i].transformations.rotations.push_back(std::make_shared<Renderer::Rotation>(0.0f, 1.0f, 0.0f, yaw));
-            face_descriptors[i].transformations.rotations.push_back(std::make_shared<Renderer::Rotation>(1.0f, 0.0f, 0.0f, pitch));
+            face_descriptors[i].transformations.rotations.push_back(std::make_shared<Renderer::Rotation>(0.0f, 1.0f, 0.0f, GetYaw()));
+            face_descriptors[i].transformations.rotations.push_back(std::make_shared<Renderer::Rotation>(1.0f, 0.0f, 0.0f, GetPitch()));
 
             face_descriptors[i].transformations.rotation = 0;
 
@@ -1453,7 +1684,8 @@ namespace Botcraft
             std::array<Renderer::Transparency, 2> transparencies = { Renderer::Transparency::Opaque, Renderer::Transparency::Opaque };
             std::array<Renderer::Animation, 2> animated = { Renderer::Animation::Static, Renderer::Animation::Static };
 
-            for (int i = 0; i < std::min(2, static_cast<int>(face_descriptors[i].texture_names.size())); ++i)
+            // No atlas with the collision only assets profile
+            for (int i = 0; atlas != nullptr && i < std::min(2, static_cast<int>(face_descriptors[i].texture_names.size())); ++i)
             {
                 const Renderer::TextureData& texture_data = atlas->GetData(face_descriptors[i].texture_names[i]);
                 std::tie(texture_pos[2 * i + 0], texture_pos[2 * i + 1]) = texture_data.position;
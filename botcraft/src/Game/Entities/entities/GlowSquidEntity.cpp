@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct GlowSquidEntityMetadata
+    {
+        enum
+        {
+            data_dark_ticks_remaining,
+        };
+    };
+
     const std::array<std::string, GlowSquidEntity::metadata_count> GlowSquidEntity::metadata_names{ {
         "data_dark_ticks_remaining",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     GlowSquidEntity::GlowSquidEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataDarkTicksRemaining(0);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int GlowSquidEntity::GetDataDarkTicksRemaining() const
     {
-        return std::any_cast<int>(metadata.at("data_dark_ticks_remaining"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + GlowSquidEntityMetadata::data_dark_ticks_remaining]);
     }
 
 
     void GlowSquidEntity::SetDataDarkTicksRemaining(const int data_dark_ticks_remaining)
     {
-        metadata["data_dark_ticks_remaining"] = data_dark_ticks_remaining;
+        metadata[hierarchy_metadata_count + GlowSquidEntityMetadata::data_dark_ticks_remaining] = data_dark_ticks_remaining;
     }
 
 }
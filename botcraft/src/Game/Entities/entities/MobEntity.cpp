@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct MobEntityMetadata
+    {
+        enum
+        {
+            data_mob_flags_id,
+        };
+    };
+
     const std::array<std::string, MobEntity::metadata_count> MobEntity::metadata_names{ {
         "data_mob_flags_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     MobEntity::MobEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataMobFlagsId(0);
     }
 
@@ -41,19 +51,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char MobEntity::GetDataMobFlagsId() const
     {
-        return std::any_cast<char>(metadata.at("data_mob_flags_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + MobEntityMetadata::data_mob_flags_id]);
     }
 
 
     void MobEntity::SetDataMobFlagsId(const char data_mob_flags_id)
     {
-        metadata["data_mob_flags_id"] = data_mob_flags_id;
+        metadata[hierarchy_metadata_count + MobEntityMetadata::data_mob_flags_id] = data_mob_flags_id;
     }
 
 }
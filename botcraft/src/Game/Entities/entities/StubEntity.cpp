@@ -0,0 +1,39 @@
+#include "botcraft/Game/Entities/entities/StubEntity.hpp"
+
+namespace Botcraft
+{
+    StubEntity::StubEntity(const EntityType stubbed_type_)
+    {
+        stubbed_type = stubbed_type_;
+    }
+
+    StubEntity::~StubEntity()
+    {
+
+    }
+
+    std::string StubEntity::GetName() const
+    {
+        return "stub";
+    }
+
+    EntityType StubEntity::GetType() const
+    {
+        return EntityType::None;
+    }
+
+    EntityType StubEntity::GetStubbedType() const
+    {
+        return stubbed_type;
+    }
+
+    double StubEntity::GetWidth() const
+    {
+        return 1.0;
+    }
+
+    double StubEntity::GetHeight() const
+    {
+        return 1.0;
+    }
+}
@@ -2,6 +2,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct TamableAnimalEntityMetadata
+    {
+        enum
+        {
+            data_flags_id,
+            data_owneruuid_id,
+        };
+    };
+
     const std::array<std::string, TamableAnimalEntity::metadata_count> TamableAnimalEntity::metadata_names{ {
         "data_flags_id",
         "data_owneruuid_id",
@@ -10,6 +20,7 @@ namespace Botcraft
     TamableAnimalEntity::TamableAnimalEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataFlagsId(0);
         SetDataOwneruuidId(std::optional<ProtocolCraft::UUID>());
     }
@@ -44,29 +55,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char TamableAnimalEntity::GetDataFlagsId() const
     {
-        return std::any_cast<char>(metadata.at("data_flags_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + TamableAnimalEntityMetadata::data_flags_id]);
     }
 
     const std::optional<ProtocolCraft::UUID>& TamableAnimalEntity::GetDataOwneruuidId() const
     {
-        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata.at("data_owneruuid_id"));
+        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata[hierarchy_metadata_count + TamableAnimalEntityMetadata::data_owneruuid_id]);
     }
 
 
     void TamableAnimalEntity::SetDataFlagsId(const char data_flags_id)
     {
-        metadata["data_flags_id"] = data_flags_id;
+        metadata[hierarchy_metadata_count + TamableAnimalEntityMetadata::data_flags_id] = data_flags_id;
     }
 
     void TamableAnimalEntity::SetDataOwneruuidId(const std::optional<ProtocolCraft::UUID>& data_owneruuid_id)
     {
-        metadata["data_owneruuid_id"] = data_owneruuid_id;
+        metadata[hierarchy_metadata_count + TamableAnimalEntityMetadata::data_owneruuid_id] = data_owneruuid_id;
     }
 
 }
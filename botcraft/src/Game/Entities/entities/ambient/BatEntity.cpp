@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct BatEntityMetadata
+    {
+        enum
+        {
+            data_id_flags,
+        };
+    };
+
     const std::array<std::string, BatEntity::metadata_count> BatEntity::metadata_names{ {
         "data_id_flags",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     BatEntity::BatEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdFlags(0);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char BatEntity::GetDataIdFlags() const
     {
-        return std::any_cast<char>(metadata.at("data_id_flags"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + BatEntityMetadata::data_id_flags]);
     }
 
 
     void BatEntity::SetDataIdFlags(const char data_id_flags)
     {
-        metadata["data_id_flags"] = data_id_flags;
+        metadata[hierarchy_metadata_count + BatEntityMetadata::data_id_flags] = data_id_flags;
     }
 
 }
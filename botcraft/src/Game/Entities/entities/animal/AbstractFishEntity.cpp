@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AbstractFishEntityMetadata
+    {
+        enum
+        {
+            from_bucket,
+        };
+    };
+
     const std::array<std::string, AbstractFishEntity::metadata_count> AbstractFishEntity::metadata_names{ {
         "from_bucket",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     AbstractFishEntity::AbstractFishEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetFromBucket(false);
     }
 
@@ -41,19 +51,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool AbstractFishEntity::GetFromBucket() const
     {
-        return std::any_cast<bool>(metadata.at("from_bucket"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AbstractFishEntityMetadata::from_bucket]);
     }
 
 
     void AbstractFishEntity::SetFromBucket(const bool from_bucket)
     {
-        metadata["from_bucket"] = from_bucket;
+        metadata[hierarchy_metadata_count + AbstractFishEntityMetadata::from_bucket] = from_bucket;
     }
 
 }
@@ -3,6 +3,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct BeeEntityMetadata
+    {
+        enum
+        {
+            data_flags_id,
+            data_remaining_anger_time,
+        };
+    };
+
     const std::array<std::string, BeeEntity::metadata_count> BeeEntity::metadata_names{ {
         "data_flags_id",
         "data_remaining_anger_time",
@@ -11,6 +21,7 @@ namespace Botcraft
     BeeEntity::BeeEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataFlagsId(0);
         SetDataRemainingAngerTime(0);
     }
@@ -72,29 +83,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char BeeEntity::GetDataFlagsId() const
     {
-        return std::any_cast<char>(metadata.at("data_flags_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + BeeEntityMetadata::data_flags_id]);
     }
 
     int BeeEntity::GetDataRemainingAngerTime() const
     {
-        return std::any_cast<int>(metadata.at("data_remaining_anger_time"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + BeeEntityMetadata::data_remaining_anger_time]);
     }
 
 
     void BeeEntity::SetDataFlagsId(const char data_flags_id)
     {
-        metadata["data_flags_id"] = data_flags_id;
+        metadata[hierarchy_metadata_count + BeeEntityMetadata::data_flags_id] = data_flags_id;
     }
 
     void BeeEntity::SetDataRemainingAngerTime(const int data_remaining_anger_time)
     {
-        metadata["data_remaining_anger_time"] = data_remaining_anger_time;
+        metadata[hierarchy_metadata_count + BeeEntityMetadata::data_remaining_anger_time] = data_remaining_anger_time;
     }
 
 }
@@ -3,6 +3,18 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct CatEntityMetadata
+    {
+        enum
+        {
+            data_type_id,
+            is_lying,
+            relax_state_one,
+            data_collar_color,
+        };
+    };
+
     const std::array<std::string, CatEntity::metadata_count> CatEntity::metadata_names{ {
         "data_type_id",
         "is_lying",
@@ -13,6 +25,7 @@ namespace Botcraft
     CatEntity::CatEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataTypeId(1);
         SetIsLying(false);
         SetRelaxStateOne(false);
@@ -78,49 +91,49 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int CatEntity::GetDataTypeId() const
     {
-        return std::any_cast<int>(metadata.at("data_type_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + CatEntityMetadata::data_type_id]);
     }
 
     bool CatEntity::GetIsLying() const
     {
-        return std::any_cast<bool>(metadata.at("is_lying"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + CatEntityMetadata::is_lying]);
     }
 
     bool CatEntity::GetRelaxStateOne() const
     {
-        return std::any_cast<bool>(metadata.at("relax_state_one"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + CatEntityMetadata::relax_state_one]);
     }
 
     int CatEntity::GetDataCollarColor() const
     {
-        return std::any_cast<int>(metadata.at("data_collar_color"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + CatEntityMetadata::data_collar_color]);
     }
 
 
     void CatEntity::SetDataTypeId(const int data_type_id)
     {
-        metadata["data_type_id"] = data_type_id;
+        metadata[hierarchy_metadata_count + CatEntityMetadata::data_type_id] = data_type_id;
     }
 
     void CatEntity::SetIsLying(const bool is_lying)
     {
-        metadata["is_lying"] = is_lying;
+        metadata[hierarchy_metadata_count + CatEntityMetadata::is_lying] = is_lying;
     }
 
     void CatEntity::SetRelaxStateOne(const bool relax_state_one)
     {
-        metadata["relax_state_one"] = relax_state_one;
+        metadata[hierarchy_metadata_count + CatEntityMetadata::relax_state_one] = relax_state_one;
     }
 
     void CatEntity::SetDataCollarColor(const int data_collar_color)
     {
-        metadata["data_collar_color"] = data_collar_color;
+        metadata[hierarchy_metadata_count + CatEntityMetadata::data_collar_color] = data_collar_color;
     }
 
 }
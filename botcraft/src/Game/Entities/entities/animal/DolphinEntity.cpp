@@ -3,6 +3,17 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct DolphinEntityMetadata
+    {
+        enum
+        {
+            treasure_pos,
+            got_fish,
+            moistness_level,
+        };
+    };
+
     const std::array<std::string, DolphinEntity::metadata_count> DolphinEntity::metadata_names{ {
         "treasure_pos",
         "got_fish",
@@ -12,6 +23,7 @@ namespace Botcraft
     DolphinEntity::DolphinEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetTreasurePos(Position(0, 0, 0));
         SetGotFish(false);
         SetMoistnessLevel(2400);
@@ -75,39 +87,39 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const Position& DolphinEntity::GetTreasurePos() const
     {
-        return std::any_cast<const Position&>(metadata.at("treasure_pos"));
+        return std::any_cast<const Position&>(metadata[hierarchy_metadata_count + DolphinEntityMetadata::treasure_pos]);
     }
 
     bool DolphinEntity::GetGotFish() const
     {
-        return std::any_cast<bool>(metadata.at("got_fish"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + DolphinEntityMetadata::got_fish]);
     }
 
     int DolphinEntity::GetMoistnessLevel() const
     {
-        return std::any_cast<int>(metadata.at("moistness_level"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + DolphinEntityMetadata::moistness_level]);
     }
 
 
     void DolphinEntity::SetTreasurePos(const Position& treasure_pos)
     {
-        metadata["treasure_pos"] = treasure_pos;
+        metadata[hierarchy_metadata_count + DolphinEntityMetadata::treasure_pos] = treasure_pos;
     }
 
     void DolphinEntity::SetGotFish(const bool got_fish)
     {
-        metadata["got_fish"] = got_fish;
+        metadata[hierarchy_metadata_count + DolphinEntityMetadata::got_fish] = got_fish;
     }
 
     void DolphinEntity::SetMoistnessLevel(const int moistness_level)
     {
-        metadata["moistness_level"] = moistness_level;
+        metadata[hierarchy_metadata_count + DolphinEntityMetadata::moistness_level] = moistness_level;
     }
 
 }
@@ -3,6 +3,18 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct FoxEntityMetadata
+    {
+        enum
+        {
+            data_type_id,
+            data_flags_id,
+            data_trusted_id_0,
+            data_trusted_id_1,
+        };
+    };
+
     const std::array<std::string, FoxEntity::metadata_count> FoxEntity::metadata_names{ {
         "data_type_id",
         "data_flags_id",
@@ -13,6 +25,7 @@ namespace Botcraft
     FoxEntity::FoxEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataTypeId(0);
         SetDataFlagsId(0);
         SetDataTrustedId0(std::optional<ProtocolCraft::UUID>());
@@ -78,49 +91,49 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int FoxEntity::GetDataTypeId() const
     {
-        return std::any_cast<int>(metadata.at("data_type_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + FoxEntityMetadata::data_type_id]);
     }
 
     char FoxEntity::GetDataFlagsId() const
     {
-        return std::any_cast<char>(metadata.at("data_flags_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + FoxEntityMetadata::data_flags_id]);
     }
 
     const std::optional<ProtocolCraft::UUID>& FoxEntity::GetDataTrustedId0() const
     {
-        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata.at("data_trusted_id_0"));
+        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata[hierarchy_metadata_count + FoxEntityMetadata::data_trusted_id_0]);
     }
 
     const std::optional<ProtocolCraft::UUID>& FoxEntity::GetDataTrustedId1() const
     {
-        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata.at("data_trusted_id_1"));
+        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata[hierarchy_metadata_count + FoxEntityMetadata::data_trusted_id_1]);
     }
 
 
     void FoxEntity::SetDataTypeId(const int data_type_id)
     {
-        metadata["data_type_id"] = data_type_id;
+        metadata[hierarchy_metadata_count + FoxEntityMetadata::data_type_id] = data_type_id;
     }
 
     void FoxEntity::SetDataFlagsId(const char data_flags_id)
     {
-        metadata["data_flags_id"] = data_flags_id;
+        metadata[hierarchy_metadata_count + FoxEntityMetadata::data_flags_id] = data_flags_id;
     }
 
     void FoxEntity::SetDataTrustedId0(const std::optional<ProtocolCraft::UUID>& data_trusted_id_0)
     {
-        metadata["data_trusted_id_0"] = data_trusted_id_0;
+        metadata[hierarchy_metadata_count + FoxEntityMetadata::data_trusted_id_0] = data_trusted_id_0;
     }
 
     void FoxEntity::SetDataTrustedId1(const std::optional<ProtocolCraft::UUID>& data_trusted_id_1)
     {
-        metadata["data_trusted_id_1"] = data_trusted_id_1;
+        metadata[hierarchy_metadata_count + FoxEntityMetadata::data_trusted_id_1] = data_trusted_id_1;
     }
 
 }
@@ -3,6 +3,15 @@
 namespace Botcraft
 {
 #if PROTOCOL_VERSION > 404
+    // Index of each metadata in metadata_names
+    struct MushroomCowEntityMetadata
+    {
+        enum
+        {
+            data_type,
+        };
+    };
+
     const std::array<std::string, MushroomCowEntity::metadata_count> MushroomCowEntity::metadata_names{ {
         "data_type",
     } };
@@ -12,6 +21,7 @@ namespace Botcraft
     {
 #if PROTOCOL_VERSION > 404
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataType("red");
 #endif
     }
@@ -73,19 +83,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const std::string& MushroomCowEntity::GetDataType() const
     {
-        return std::any_cast<const std::string&>(metadata.at("data_type"));
+        return std::any_cast<const std::string&>(metadata[hierarchy_metadata_count + MushroomCowEntityMetadata::data_type]);
     }
 
 
     void MushroomCowEntity::SetDataType(const std::string& data_type)
     {
-        metadata["data_type"] = data_type;
+        metadata[hierarchy_metadata_count + MushroomCowEntityMetadata::data_type] = data_type;
     }
 #endif
 
@@ -2,6 +2,19 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct OcelotEntityMetadata
+    {
+        enum
+        {
+#if PROTOCOL_VERSION > 404
+            data_trusting,
+#else
+            data_type_id,
+#endif
+        };
+    };
+
     const std::array<std::string, OcelotEntity::metadata_count> OcelotEntity::metadata_names{ {
 #if PROTOCOL_VERSION > 404
         "data_trusting",
@@ -13,6 +26,7 @@ namespace Botcraft
     OcelotEntity::OcelotEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
 #if PROTOCOL_VERSION > 404
         SetDataTrusting(false);
 #else
@@ -80,31 +94,31 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
 #if PROTOCOL_VERSION > 404
     bool OcelotEntity::GetDataTrusting() const
     {
-        return std::any_cast<bool>(metadata.at("data_trusting"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + OcelotEntityMetadata::data_trusting]);
     }
 
 
     void OcelotEntity::SetDataTrusting(const bool data_trusting)
     {
-        metadata["data_trusting"] = data_trusting;
+        metadata[hierarchy_metadata_count + OcelotEntityMetadata::data_trusting] = data_trusting;
     }
 #else
     int OcelotEntity::GetDataTypeId() const
     {
-        return std::any_cast<int>(metadata.at("data_type_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + OcelotEntityMetadata::data_type_id]);
     }
 
 
     void OcelotEntity::SetDataTypeId(const int data_type_id)
     {
-        metadata["data_type_id"] = data_type_id;
+        metadata[hierarchy_metadata_count + OcelotEntityMetadata::data_type_id] = data_type_id;
     }
 #endif
 
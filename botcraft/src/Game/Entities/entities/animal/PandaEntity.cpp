@@ -3,6 +3,20 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PandaEntityMetadata
+    {
+        enum
+        {
+            unhappy_counter,
+            sneeze_counter,
+            eat_counter,
+            main_gene_id,
+            hidden_gene_id,
+            data_id_flags,
+        };
+    };
+
     const std::array<std::string, PandaEntity::metadata_count> PandaEntity::metadata_names{ {
         "unhappy_counter",
         "sneeze_counter",
@@ -15,6 +29,7 @@ namespace Botcraft
     PandaEntity::PandaEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetUnhappyCounter(0);
         SetSneezeCounter(0);
         SetEatCounter(0);
@@ -84,69 +99,69 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int PandaEntity::GetUnhappyCounter() const
     {
-        return std::any_cast<int>(metadata.at("unhappy_counter"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PandaEntityMetadata::unhappy_counter]);
     }
 
     int PandaEntity::GetSneezeCounter() const
     {
-        return std::any_cast<int>(metadata.at("sneeze_counter"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PandaEntityMetadata::sneeze_counter]);
     }
 
     int PandaEntity::GetEatCounter() const
     {
-        return std::any_cast<int>(metadata.at("eat_counter"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PandaEntityMetadata::eat_counter]);
     }
 
     char PandaEntity::GetMainGeneId() const
     {
-        return std::any_cast<char>(metadata.at("main_gene_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + PandaEntityMetadata::main_gene_id]);
     }
 
     char PandaEntity::GetHiddenGeneId() const
     {
-        return std::any_cast<char>(metadata.at("hidden_gene_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + PandaEntityMetadata::hidden_gene_id]);
     }
 
     char PandaEntity::GetDataIdFlags() const
     {
-        return std::any_cast<char>(metadata.at("data_id_flags"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + PandaEntityMetadata::data_id_flags]);
     }
 
 
     void PandaEntity::SetUnhappyCounter(const int unhappy_counter)
     {
-        metadata["unhappy_counter"] = unhappy_counter;
+        metadata[hierarchy_metadata_count + PandaEntityMetadata::unhappy_counter] = unhappy_counter;
     }
 
     void PandaEntity::SetSneezeCounter(const int sneeze_counter)
     {
-        metadata["sneeze_counter"] = sneeze_counter;
+        metadata[hierarchy_metadata_count + PandaEntityMetadata::sneeze_counter] = sneeze_counter;
     }
 
     void PandaEntity::SetEatCounter(const int eat_counter)
     {
-        metadata["eat_counter"] = eat_counter;
+        metadata[hierarchy_metadata_count + PandaEntityMetadata::eat_counter] = eat_counter;
     }
 
     void PandaEntity::SetMainGeneId(const char main_gene_id)
     {
-        metadata["main_gene_id"] = main_gene_id;
+        metadata[hierarchy_metadata_count + PandaEntityMetadata::main_gene_id] = main_gene_id;
     }
 
     void PandaEntity::SetHiddenGeneId(const char hidden_gene_id)
     {
-        metadata["hidden_gene_id"] = hidden_gene_id;
+        metadata[hierarchy_metadata_count + PandaEntityMetadata::hidden_gene_id] = hidden_gene_id;
     }
 
     void PandaEntity::SetDataIdFlags(const char data_id_flags)
     {
-        metadata["data_id_flags"] = data_id_flags;
+        metadata[hierarchy_metadata_count + PandaEntityMetadata::data_id_flags] = data_id_flags;
     }
 
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ParrotEntityMetadata
+    {
+        enum
+        {
+            data_variant_id,
+        };
+    };
+
     const std::array<std::string, ParrotEntity::metadata_count> ParrotEntity::metadata_names{ {
         "data_variant_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     ParrotEntity::ParrotEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataVariantId(0);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int ParrotEntity::GetDataVariantId() const
     {
-        return std::any_cast<int>(metadata.at("data_variant_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + ParrotEntityMetadata::data_variant_id]);
     }
 
 
     void ParrotEntity::SetDataVariantId(const int data_variant_id)
     {
-        metadata["data_variant_id"] = data_variant_id;
+        metadata[hierarchy_metadata_count + ParrotEntityMetadata::data_variant_id] = data_variant_id;
     }
 
 }
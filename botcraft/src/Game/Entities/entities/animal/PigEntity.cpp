@@ -2,6 +2,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PigEntityMetadata
+    {
+        enum
+        {
+            data_saddle_id,
+            data_boost_time,
+        };
+    };
+
     const std::array<std::string, PigEntity::metadata_count> PigEntity::metadata_names{ {
         "data_saddle_id",
         "data_boost_time",
@@ -10,6 +20,7 @@ namespace Botcraft
     PigEntity::PigEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataSaddleId(false);
         SetDataBoostTime(0);
     }
@@ -71,29 +82,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool PigEntity::GetDataSaddleId() const
     {
-        return std::any_cast<bool>(metadata.at("data_saddle_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + PigEntityMetadata::data_saddle_id]);
     }
 
     int PigEntity::GetDataBoostTime() const
     {
-        return std::any_cast<int>(metadata.at("data_boost_time"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PigEntityMetadata::data_boost_time]);
     }
 
 
     void PigEntity::SetDataSaddleId(const bool data_saddle_id)
     {
-        metadata["data_saddle_id"] = data_saddle_id;
+        metadata[hierarchy_metadata_count + PigEntityMetadata::data_saddle_id] = data_saddle_id;
     }
 
     void PigEntity::SetDataBoostTime(const int data_boost_time)
     {
-        metadata["data_boost_time"] = data_boost_time;
+        metadata[hierarchy_metadata_count + PigEntityMetadata::data_boost_time] = data_boost_time;
     }
 
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PolarBearEntityMetadata
+    {
+        enum
+        {
+            data_standing_id,
+        };
+    };
+
     const std::array<std::string, PolarBearEntity::metadata_count> PolarBearEntity::metadata_names{ {
         "data_standing_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     PolarBearEntity::PolarBearEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataStandingId(false);
     }
 
@@ -72,19 +82,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool PolarBearEntity::GetDataStandingId() const
     {
-        return std::any_cast<bool>(metadata.at("data_standing_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + PolarBearEntityMetadata::data_standing_id]);
     }
 
 
     void PolarBearEntity::SetDataStandingId(const bool data_standing_id)
     {
-        metadata["data_standing_id"] = data_standing_id;
+        metadata[hierarchy_metadata_count + PolarBearEntityMetadata::data_standing_id] = data_standing_id;
     }
 
 }
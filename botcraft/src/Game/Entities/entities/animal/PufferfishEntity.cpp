@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PufferfishEntityMetadata
+    {
+        enum
+        {
+            puff_state,
+        };
+    };
+
     const std::array<std::string, PufferfishEntity::metadata_count> PufferfishEntity::metadata_names{ {
         "puff_state",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     PufferfishEntity::PufferfishEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetPuffState(0);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int PufferfishEntity::GetPuffState() const
     {
-        return std::any_cast<int>(metadata.at("puff_state"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PufferfishEntityMetadata::puff_state]);
     }
 
 
     void PufferfishEntity::SetPuffState(const int puff_state)
     {
-        metadata["puff_state"] = puff_state;
+        metadata[hierarchy_metadata_count + PufferfishEntityMetadata::puff_state] = puff_state;
     }
 
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct RabbitEntityMetadata
+    {
+        enum
+        {
+            data_type_id,
+        };
+    };
+
     const std::array<std::string, RabbitEntity::metadata_count> RabbitEntity::metadata_names{ {
         "data_type_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     RabbitEntity::RabbitEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataTypeId(0);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int RabbitEntity::GetDataTypeId() const
     {
-        return std::any_cast<int>(metadata.at("data_type_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + RabbitEntityMetadata::data_type_id]);
     }
 
 
     void RabbitEntity::SetDataTypeId(const int data_type_id)
     {
-        metadata["data_type_id"] = data_type_id;
+        metadata[hierarchy_metadata_count + RabbitEntityMetadata::data_type_id] = data_type_id;
     }
 
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct SheepEntityMetadata
+    {
+        enum
+        {
+            data_wool_id,
+        };
+    };
+
     const std::array<std::string, SheepEntity::metadata_count> SheepEntity::metadata_names{ {
         "data_wool_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     SheepEntity::SheepEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataWoolId(0);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char SheepEntity::GetDataWoolId() const
     {
-        return std::any_cast<char>(metadata.at("data_wool_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + SheepEntityMetadata::data_wool_id]);
     }
 
 
     void SheepEntity::SetDataWoolId(const char data_wool_id)
     {
-        metadata["data_wool_id"] = data_wool_id;
+        metadata[hierarchy_metadata_count + SheepEntityMetadata::data_wool_id] = data_wool_id;
     }
 
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct SnowGolemEntityMetadata
+    {
+        enum
+        {
+            data_pumpkin_id,
+        };
+    };
+
     const std::array<std::string, SnowGolemEntity::metadata_count> SnowGolemEntity::metadata_names{ {
         "data_pumpkin_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     SnowGolemEntity::SnowGolemEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataPumpkinId(16);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char SnowGolemEntity::GetDataPumpkinId() const
     {
-        return std::any_cast<char>(metadata.at("data_pumpkin_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + SnowGolemEntityMetadata::data_pumpkin_id]);
     }
 
 
     void SnowGolemEntity::SetDataPumpkinId(const char data_pumpkin_id)
     {
-        metadata["data_pumpkin_id"] = data_pumpkin_id;
+        metadata[hierarchy_metadata_count + SnowGolemEntityMetadata::data_pumpkin_id] = data_pumpkin_id;
     }
 
 }
@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct TropicalFishEntityMetadata
+    {
+        enum
+        {
+            data_id_type_variant,
+        };
+    };
+
     const std::array<std::string, TropicalFishEntity::metadata_count> TropicalFishEntity::metadata_names{ {
         "data_id_type_variant",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     TropicalFishEntity::TropicalFishEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdTypeVariant(0);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int TropicalFishEntity::GetDataIdTypeVariant() const
     {
-        return std::any_cast<int>(metadata.at("data_id_type_variant"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + TropicalFishEntityMetadata::data_id_type_variant]);
     }
 
 
     void TropicalFishEntity::SetDataIdTypeVariant(const int data_id_type_variant)
     {
-        metadata["data_id_type_variant"] = data_id_type_variant;
+        metadata[hierarchy_metadata_count + TropicalFishEntityMetadata::data_id_type_variant] = data_id_type_variant;
     }
 
 }
@@ -3,6 +3,20 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct TurtleEntityMetadata
+    {
+        enum
+        {
+            home_pos,
+            has_egg,
+            laying_egg,
+            travel_pos,
+            going_home,
+            travelling,
+        };
+    };
+
     const std::array<std::string, TurtleEntity::metadata_count> TurtleEntity::metadata_names{ {
         "home_pos",
         "has_egg",
@@ -15,6 +29,7 @@ namespace Botcraft
     TurtleEntity::TurtleEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetHomePos(Position(0, 0, 0));
         SetHasEgg(false);
         SetLayingEgg(false);
@@ -84,69 +99,69 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const Position& TurtleEntity::GetHomePos() const
     {
-        return std::any_cast<const Position&>(metadata.at("home_pos"));
+        return std::any_cast<const Position&>(metadata[hierarchy_metadata_count + TurtleEntityMetadata::home_pos]);
     }
 
     bool TurtleEntity::GetHasEgg() const
     {
-        return std::any_cast<bool>(metadata.at("has_egg"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + TurtleEntityMetadata::has_egg]);
     }
 
     bool TurtleEntity::GetLayingEgg() const
     {
-        return std::any_cast<bool>(metadata.at("laying_egg"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + TurtleEntityMetadata::laying_egg]);
     }
 
     const Position& TurtleEntity::GetTravelPos() const
     {
-        return std::any_cast<const Position&>(metadata.at("travel_pos"));
+        return std::any_cast<const Position&>(metadata[hierarchy_metadata_count + TurtleEntityMetadata::travel_pos]);
     }
 
     bool TurtleEntity::GetGoingHome() const
     {
-        return std::any_cast<bool>(metadata.at("going_home"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + TurtleEntityMetadata::going_home]);
     }
 
     bool TurtleEntity::GetTravelling() const
     {
-        return std::any_cast<bool>(metadata.at("travelling"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + TurtleEntityMetadata::travelling]);
     }
 
 
     void TurtleEntity::SetHomePos(const Position& home_pos)
     {
-        metadata["home_pos"] = home_pos;
+        metadata[hierarchy_metadata_count + TurtleEntityMetadata::home_pos] = home_pos;
     }
 
     void TurtleEntity::SetHasEgg(const bool has_egg)
     {
-        metadata["has_egg"] = has_egg;
+        metadata[hierarchy_metadata_count + TurtleEntityMetadata::has_egg] = has_egg;
     }
 
     void TurtleEntity::SetLayingEgg(const bool laying_egg)
     {
-        metadata["laying_egg"] = laying_egg;
+        metadata[hierarchy_metadata_count + TurtleEntityMetadata::laying_egg] = laying_egg;
     }
 
     void TurtleEntity::SetTravelPos(const Position& travel_pos)
     {
-        metadata["travel_pos"] = travel_pos;
+        metadata[hierarchy_metadata_count + TurtleEntityMetadata::travel_pos] = travel_pos;
     }
 
     void TurtleEntity::SetGoingHome(const bool going_home)
     {
-        metadata["going_home"] = going_home;
+        metadata[hierarchy_metadata_count + TurtleEntityMetadata::going_home] = going_home;
     }
 
     void TurtleEntity::SetTravelling(const bool travelling)
     {
-        metadata["travelling"] = travelling;
+        metadata[hierarchy_metadata_count + TurtleEntityMetadata::travelling] = travelling;
     }
 
 }
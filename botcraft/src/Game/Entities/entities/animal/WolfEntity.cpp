@@ -2,6 +2,22 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct WolfEntityMetadata
+    {
+        enum
+        {
+#if PROTOCOL_VERSION < 499
+            data_health_id,
+#endif
+            data_interested_id,
+            data_collar_color,
+#if PROTOCOL_VERSION > 578
+            data_remaining_anger_time,
+#endif
+        };
+    };
+
     const std::array<std::string, WolfEntity::metadata_count> WolfEntity::metadata_names{ {
 #if PROTOCOL_VERSION < 499
         "data_health_id",
@@ -16,6 +32,7 @@ namespace Botcraft
     WolfEntity::WolfEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
 #if PROTOCOL_VERSION < 499
         SetDataHealthId(1.0f);
 #endif
@@ -89,31 +106,31 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
 #if PROTOCOL_VERSION < 499
     float WolfEntity::GetDataHealthId() const
     {
-        return std::any_cast<float>(metadata.at("data_health_id"));
+        return std::any_cast<float>(metadata[hierarchy_metadata_count + WolfEntityMetadata::data_health_id]);
     }
 #endif
 
     bool WolfEntity::GetDataInterestedId() const
     {
-        return std::any_cast<bool>(metadata.at("data_interested_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + WolfEntityMetadata::data_interested_id]);
     }
 
     int WolfEntity::GetDataCollarColor() const
     {
-        return std::any_cast<int>(metadata.at("data_collar_color"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + WolfEntityMetadata::data_collar_color]);
     }
 
 #if PROTOCOL_VERSION > 578
     int WolfEntity::GetDataRemainingAngerTime() const
     {
-        return std::any_cast<int>(metadata.at("data_remaining_anger_time"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + WolfEntityMetadata::data_remaining_anger_time]);
     }
 #endif
 
@@ -121,24 +138,24 @@ namespace Botcraft
 #if PROTOCOL_VERSION < 499
     void WolfEntity::SetDataHealthId(const float data_health_id)
     {
-        metadata["data_health_id"] = data_health_id;
+        metadata[hierarchy_metadata_count + WolfEntityMetadata::data_health_id] = data_health_id;
     }
 #endif
 
     void WolfEntity::SetDataInterestedId(const bool data_interested_id)
     {
-        metadata["data_interested_id"] = data_interested_id;
+        metadata[hierarchy_metadata_count + WolfEntityMetadata::data_interested_id] = data_interested_id;
     }
 
     void WolfEntity::SetDataCollarColor(const int data_collar_color)
     {
-        metadata["data_collar_color"] = data_collar_color;
+        metadata[hierarchy_metadata_count + WolfEntityMetadata::data_collar_color] = data_collar_color;
     }
 
 #if PROTOCOL_VERSION > 578
     void WolfEntity::SetDataRemainingAngerTime(const int data_remaining_anger_time)
     {
-        metadata["data_remaining_anger_time"] = data_remaining_anger_time;
+        metadata[hierarchy_metadata_count + WolfEntityMetadata::data_remaining_anger_time] = data_remaining_anger_time;
     }
 #endif
 
@@ -3,6 +3,17 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AxolotlEntityMetadata
+    {
+        enum
+        {
+            data_variant,
+            data_playing_dead,
+            from_bucket,
+        };
+    };
+
     const std::array<std::string, AxolotlEntity::metadata_count> AxolotlEntity::metadata_names{ {
         "data_variant",
         "data_playing_dead",
@@ -12,6 +23,7 @@ namespace Botcraft
     AxolotlEntity::AxolotlEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataVariant(0);
         SetDataPlayingDead(false);
         SetFromBucket(false);
@@ -75,39 +87,39 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int AxolotlEntity::GetDataVariant() const
     {
-        return std::any_cast<int>(metadata.at("data_variant"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AxolotlEntityMetadata::data_variant]);
     }
 
     bool AxolotlEntity::GetDataPlayingDead() const
     {
-        return std::any_cast<bool>(metadata.at("data_playing_dead"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AxolotlEntityMetadata::data_playing_dead]);
     }
 
     bool AxolotlEntity::GetFromBucket() const
     {
-        return std::any_cast<bool>(metadata.at("from_bucket"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AxolotlEntityMetadata::from_bucket]);
     }
 
 
     void AxolotlEntity::SetDataVariant(const int data_variant)
     {
-        metadata["data_variant"] = data_variant;
+        metadata[hierarchy_metadata_count + AxolotlEntityMetadata::data_variant] = data_variant;
     }
 
     void AxolotlEntity::SetDataPlayingDead(const bool data_playing_dead)
     {
-        metadata["data_playing_dead"] = data_playing_dead;
+        metadata[hierarchy_metadata_count + AxolotlEntityMetadata::data_playing_dead] = data_playing_dead;
     }
 
     void AxolotlEntity::SetFromBucket(const bool from_bucket)
     {
-        metadata["from_bucket"] = from_bucket;
+        metadata[hierarchy_metadata_count + AxolotlEntityMetadata::from_bucket] = from_bucket;
     }
 
 }
@@ -3,6 +3,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct FrogEntityMetadata
+    {
+        enum
+        {
+            data_variant_id,
+            data_tongue_target_id,
+        };
+    };
+
     const std::array<std::string, FrogEntity::metadata_count> FrogEntity::metadata_names{ {
         "data_variant_id",
         "data_tongue_target_id",
@@ -11,6 +21,7 @@ namespace Botcraft
     FrogEntity::FrogEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataVariantId(0);
         SetDataTongueTargetId(std::optional<int>());
     }
@@ -72,29 +83,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const int FrogEntity::GetDataVariantId() const
     {
-        return std::any_cast<int>(metadata.at("data_variant_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + FrogEntityMetadata::data_variant_id]);
     }
 
     const std::optional<int>& FrogEntity::GetDataTongueTargetId() const
     {
-        return std::any_cast<const std::optional<int>&>(metadata.at("data_tongue_target_id"));
+        return std::any_cast<const std::optional<int>&>(metadata[hierarchy_metadata_count + FrogEntityMetadata::data_tongue_target_id]);
     }
 
 
     void FrogEntity::SetDataVariantId(const int data_variant_id)
     {
-        metadata["data_variant_id"] = data_variant_id;
+        metadata[hierarchy_metadata_count + FrogEntityMetadata::data_variant_id] = data_variant_id;
     }
 
     void FrogEntity::SetDataTongueTargetId(const std::optional<int>& data_tongue_target_id)
     {
-        metadata["data_tongue_target_id"] = data_tongue_target_id;
+        metadata[hierarchy_metadata_count + FrogEntityMetadata::data_tongue_target_id] = data_tongue_target_id;
     }
 
 }
@@ -3,6 +3,19 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct GoatEntityMetadata
+    {
+        enum
+        {
+            data_is_screaming_goat,
+#if PROTOCOL_VERSION > 758
+            data_has_left_horn,
+            data_has_right_horn,
+#endif
+        };
+    };
+
     const std::array<std::string, GoatEntity::metadata_count> GoatEntity::metadata_names{ {
         "data_is_screaming_goat",
 #if PROTOCOL_VERSION > 758
@@ -14,6 +27,7 @@ namespace Botcraft
     GoatEntity::GoatEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIsScreamingGoat(false);
 #if PROTOCOL_VERSION > 758
         SetDataHasLeftHorn(true);
@@ -81,42 +95,42 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool GoatEntity::GetDataIsScreamingGoat() const
     {
-        return std::any_cast<bool>(metadata.at("data_is_screaming_goat"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + GoatEntityMetadata::data_is_screaming_goat]);
     }
 
 #if PROTOCOL_VERSION > 758
     bool GoatEntity::GetDataHasLeftHorn() const
     {
-        return std::any_cast<bool>(metadata.at("data_has_left_horn"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + GoatEntityMetadata::data_has_left_horn]);
     }
 
     bool GoatEntity::GetDataHasRightHorn() const
     {
-        return std::any_cast<bool>(metadata.at("data_has_right_horn"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + GoatEntityMetadata::data_has_right_horn]);
     }
 #endif
 
 
     void GoatEntity::SetDataIsScreamingGoat(const bool data_is_screaming_goat)
     {
-        metadata["data_is_screaming_goat"] = data_is_screaming_goat;
+        metadata[hierarchy_metadata_count + GoatEntityMetadata::data_is_screaming_goat] = data_is_screaming_goat;
     }
 
 #if PROTOCOL_VERSION > 758
     void GoatEntity::SetDataHasLeftHorn(const bool data_has_left_horn)
     {
-        metadata["data_has_left_horn"] = data_has_left_horn;
+        metadata[hierarchy_metadata_count + GoatEntityMetadata::data_has_left_horn] = data_has_left_horn;
     }
 
     void GoatEntity::SetDataHasRightHorn(const bool data_has_right_horn)
     {
-        metadata["data_has_right_horn"] = data_has_right_horn;
+        metadata[hierarchy_metadata_count + GoatEntityMetadata::data_has_right_horn] = data_has_right_horn;
     }
 #endif
 
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AbstractChestedHorseEntityMetadata
+    {
+        enum
+        {
+            data_id_chest,
+        };
+    };
+
     const std::array<std::string, AbstractChestedHorseEntity::metadata_count> AbstractChestedHorseEntity::metadata_names{ {
         "data_id_chest",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     AbstractChestedHorseEntity::AbstractChestedHorseEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdChest(false);
     }
 
@@ -41,19 +51,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool AbstractChestedHorseEntity::GetDataIdChest() const
     {
-        return std::any_cast<bool>(metadata.at("data_id_chest"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AbstractChestedHorseEntityMetadata::data_id_chest]);
     }
 
 
     void AbstractChestedHorseEntity::SetDataIdChest(const bool data_id_chest)
     {
-        metadata["data_id_chest"] = data_id_chest;
+        metadata[hierarchy_metadata_count + AbstractChestedHorseEntityMetadata::data_id_chest] = data_id_chest;
     }
 
 }
@@ -2,6 +2,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AbstractHorseEntityMetadata
+    {
+        enum
+        {
+            data_id_flags,
+            data_id_owner_uuid,
+        };
+    };
+
     const std::array<std::string, AbstractHorseEntity::metadata_count> AbstractHorseEntity::metadata_names{ {
         "data_id_flags",
         "data_id_owner_uuid",
@@ -10,6 +20,7 @@ namespace Botcraft
     AbstractHorseEntity::AbstractHorseEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdFlags(0);
         SetDataIdOwnerUuid(std::optional<ProtocolCraft::UUID>());
     }
@@ -44,29 +55,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char AbstractHorseEntity::GetDataIdFlags() const
     {
-        return std::any_cast<char>(metadata.at("data_id_flags"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + AbstractHorseEntityMetadata::data_id_flags]);
     }
 
     const std::optional<ProtocolCraft::UUID>& AbstractHorseEntity::GetDataIdOwnerUuid() const
     {
-        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata.at("data_id_owner_uuid"));
+        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata[hierarchy_metadata_count + AbstractHorseEntityMetadata::data_id_owner_uuid]);
     }
 
 
     void AbstractHorseEntity::SetDataIdFlags(const char data_id_flags)
     {
-        metadata["data_id_flags"] = data_id_flags;
+        metadata[hierarchy_metadata_count + AbstractHorseEntityMetadata::data_id_flags] = data_id_flags;
     }
 
     void AbstractHorseEntity::SetDataIdOwnerUuid(const std::optional<ProtocolCraft::UUID>& data_id_owner_uuid)
     {
-        metadata["data_id_owner_uuid"] = data_id_owner_uuid;
+        metadata[hierarchy_metadata_count + AbstractHorseEntityMetadata::data_id_owner_uuid] = data_id_owner_uuid;
     }
 
 }
@@ -2,6 +2,18 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct HorseEntityMetadata
+    {
+        enum
+        {
+            data_id_type_variant,
+#if PROTOCOL_VERSION < 405
+            armor_type,
+#endif
+        };
+    };
+
     const std::array<std::string, HorseEntity::metadata_count> HorseEntity::metadata_names{ {
         "data_id_type_variant",
 #if PROTOCOL_VERSION < 405
@@ -12,6 +24,7 @@ namespace Botcraft
     HorseEntity::HorseEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdTypeVariant(0);
 #if PROTOCOL_VERSION < 405
         SetArmorType(std::optional<int>());
@@ -77,32 +90,32 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int HorseEntity::GetDataIdTypeVariant() const
     {
-        return std::any_cast<int>(metadata.at("data_id_type_variant"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + HorseEntityMetadata::data_id_type_variant]);
     }
 
 #if PROTOCOL_VERSION < 405
     const std::optional<int>& HorseEntity::GetArmorType() const
     {
-        return std::any_cast<const std::optional<int>&>(metadata.at("armor_type"));
+        return std::any_cast<const std::optional<int>&>(metadata[hierarchy_metadata_count + HorseEntityMetadata::armor_type]);
     }
 #endif
 
 
     void HorseEntity::SetDataIdTypeVariant(const int data_id_type_variant)
     {
-        metadata["data_id_type_variant"] = data_id_type_variant;
+        metadata[hierarchy_metadata_count + HorseEntityMetadata::data_id_type_variant] = data_id_type_variant;
     }
 
 #if PROTOCOL_VERSION < 405
     void HorseEntity::SetArmorType(const std::optional<int>& armor_type)
     {
-        metadata["armor_type"] = armor_type;
+        metadata[hierarchy_metadata_count + HorseEntityMetadata::armor_type] = armor_type;
     }
 #endif
 
@@ -2,6 +2,17 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct LlamaEntityMetadata
+    {
+        enum
+        {
+            data_strength_id,
+            data_swag_id,
+            data_variant_id,
+        };
+    };
+
     const std::array<std::string, LlamaEntity::metadata_count> LlamaEntity::metadata_names{ {
         "data_strength_id",
         "data_swag_id",
@@ -11,6 +22,7 @@ namespace Botcraft
     LlamaEntity::LlamaEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataStrengthId(0);
         SetDataSwagId(-1);
         SetDataVariantId(0);
@@ -74,39 +86,39 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int LlamaEntity::GetDataStrengthId() const
     {
-        return std::any_cast<int>(metadata.at("data_strength_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + LlamaEntityMetadata::data_strength_id]);
     }
 
     int LlamaEntity::GetDataSwagId() const
     {
-        return std::any_cast<int>(metadata.at("data_swag_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + LlamaEntityMetadata::data_swag_id]);
     }
 
     int LlamaEntity::GetDataVariantId() const
     {
-        return std::any_cast<int>(metadata.at("data_variant_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + LlamaEntityMetadata::data_variant_id]);
     }
 
 
     void LlamaEntity::SetDataStrengthId(const int data_strength_id)
     {
-        metadata["data_strength_id"] = data_strength_id;
+        metadata[hierarchy_metadata_count + LlamaEntityMetadata::data_strength_id] = data_strength_id;
     }
 
     void LlamaEntity::SetDataSwagId(const int data_swag_id)
     {
-        metadata["data_swag_id"] = data_swag_id;
+        metadata[hierarchy_metadata_count + LlamaEntityMetadata::data_swag_id] = data_swag_id;
     }
 
     void LlamaEntity::SetDataVariantId(const int data_variant_id)
     {
-        metadata["data_variant_id"] = data_variant_id;
+        metadata[hierarchy_metadata_count + LlamaEntityMetadata::data_variant_id] = data_variant_id;
     }
 
 }
@@ -2,6 +2,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct EndCrystalEntityMetadata
+    {
+        enum
+        {
+            data_beam_target,
+            data_show_bottom,
+        };
+    };
+
     const std::array<std::string, EndCrystalEntity::metadata_count> EndCrystalEntity::metadata_names{ {
         "data_beam_target",
         "data_show_bottom",
@@ -10,6 +20,7 @@ namespace Botcraft
     EndCrystalEntity::EndCrystalEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataBeamTarget(std::optional<Position>());
         SetDataShowBottom(true);
     }
@@ -71,29 +82,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const std::optional<Position>& EndCrystalEntity::GetDataBeamTarget() const
     {
-        return std::any_cast<const std::optional<Position>&>(metadata.at("data_beam_target"));
+        return std::any_cast<const std::optional<Position>&>(metadata[hierarchy_metadata_count + EndCrystalEntityMetadata::data_beam_target]);
     }
 
     bool EndCrystalEntity::GetDataShowBottom() const
     {
-        return std::any_cast<bool>(metadata.at("data_show_bottom"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + EndCrystalEntityMetadata::data_show_bottom]);
     }
 
 
     void EndCrystalEntity::SetDataBeamTarget(const std::optional<Position>& data_beam_target)
     {
-        metadata["data_beam_target"] = data_beam_target;
+        metadata[hierarchy_metadata_count + EndCrystalEntityMetadata::data_beam_target] = data_beam_target;
     }
 
     void EndCrystalEntity::SetDataShowBottom(const bool data_show_bottom)
     {
-        metadata["data_show_bottom"] = data_show_bottom;
+        metadata[hierarchy_metadata_count + EndCrystalEntityMetadata::data_show_bottom] = data_show_bottom;
     }
 
 }
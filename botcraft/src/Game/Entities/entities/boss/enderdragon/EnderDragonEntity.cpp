@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct EnderDragonEntityMetadata
+    {
+        enum
+        {
+            data_phase,
+        };
+    };
+
     const std::array<std::string, EnderDragonEntity::metadata_count> EnderDragonEntity::metadata_names{ {
         "data_phase",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     EnderDragonEntity::EnderDragonEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataPhase(10);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int EnderDragonEntity::GetDataPhase() const
     {
-        return std::any_cast<int>(metadata.at("data_phase"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + EnderDragonEntityMetadata::data_phase]);
     }
 
 
     void EnderDragonEntity::SetDataPhase(const int data_phase)
     {
-        metadata["data_phase"] = data_phase;
+        metadata[hierarchy_metadata_count + EnderDragonEntityMetadata::data_phase] = data_phase;
     }
 
 }
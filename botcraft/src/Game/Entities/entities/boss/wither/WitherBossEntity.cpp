@@ -2,6 +2,18 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct WitherBossEntityMetadata
+    {
+        enum
+        {
+            data_target_a,
+            data_target_b,
+            data_target_c,
+            data_id_inv,
+        };
+    };
+
     const std::array<std::string, WitherBossEntity::metadata_count> WitherBossEntity::metadata_names{ {
         "data_target_a",
         "data_target_b",
@@ -12,6 +24,7 @@ namespace Botcraft
     WitherBossEntity::WitherBossEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataTargetA(0);
         SetDataTargetB(0);
         SetDataTargetC(0);
@@ -77,49 +90,49 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int WitherBossEntity::GetDataTargetA() const
     {
-        return std::any_cast<int>(metadata.at("data_target_a"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_target_a]);
     }
 
     int WitherBossEntity::GetDataTargetB() const
     {
-        return std::any_cast<int>(metadata.at("data_target_b"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_target_b]);
     }
 
     int WitherBossEntity::GetDataTargetC() const
     {
-        return std::any_cast<int>(metadata.at("data_target_c"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_target_c]);
     }
 
     int WitherBossEntity::GetDataIdInv() const
     {
-        return std::any_cast<int>(metadata.at("data_id_inv"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_id_inv]);
     }
 
 
     void WitherBossEntity::SetDataTargetA(const int data_target_a)
     {
-        metadata["data_target_a"] = data_target_a;
+        metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_target_a] = data_target_a;
     }
 
     void WitherBossEntity::SetDataTargetB(const int data_target_b)
     {
-        metadata["data_target_b"] = data_target_b;
+        metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_target_b] = data_target_b;
     }
 
     void WitherBossEntity::SetDataTargetC(const int data_target_c)
     {
-        metadata["data_target_c"] = data_target_c;
+        metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_target_c] = data_target_c;
     }
 
     void WitherBossEntity::SetDataIdInv(const int data_id_inv)
     {
-        metadata["data_id_inv"] = data_id_inv;
+        metadata[hierarchy_metadata_count + WitherBossEntityMetadata::data_id_inv] = data_id_inv;
     }
 
 }
@@ -2,6 +2,21 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ArmorStandEntityMetadata
+    {
+        enum
+        {
+            data_client_flags,
+            data_head_pose,
+            data_body_pose,
+            data_left_arm_pose,
+            data_right_arm_pose,
+            data_left_leg_pose,
+            data_right_leg_pose,
+        };
+    };
+
     const std::array<std::string, ArmorStandEntity::metadata_count> ArmorStandEntity::metadata_names{ {
         "data_client_flags",
         "data_head_pose",
@@ -15,6 +30,7 @@ namespace Botcraft
     ArmorStandEntity::ArmorStandEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataClientFlags(0);
         SetDataHeadPose(Vector3<float>(0.0f, 0.0f, 0.0f));
         SetDataBodyPose(Vector3<float>(0.0f, 0.0f, 0.0f));
@@ -86,79 +102,79 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char ArmorStandEntity::GetDataClientFlags() const
     {
-        return std::any_cast<char>(metadata.at("data_client_flags"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_client_flags]);
     }
 
     const Vector3<float>& ArmorStandEntity::GetDataHeadPose() const
     {
-        return std::any_cast<const Vector3<float>&>(metadata.at("data_head_pose"));
+        return std::any_cast<const Vector3<float>&>(metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_head_pose]);
     }
 
     const Vector3<float>& ArmorStandEntity::GetDataBodyPose() const
     {
-        return std::any_cast<const Vector3<float>&>(metadata.at("data_body_pose"));
+        return std::any_cast<const Vector3<float>&>(metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_body_pose]);
     }
 
     const Vector3<float>& ArmorStandEntity::GetDataLeftArmPose() const
     {
-        return std::any_cast<const Vector3<float>&>(metadata.at("data_left_arm_pose"));
+        return std::any_cast<const Vector3<float>&>(metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_left_arm_pose]);
     }
 
     const Vector3<float>& ArmorStandEntity::GetDataRightArmPose() const
     {
-        return std::any_cast<const Vector3<float>&>(metadata.at("data_right_arm_pose"));
+        return std::any_cast<const Vector3<float>&>(metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_right_arm_pose]);
     }
 
     const Vector3<float>& ArmorStandEntity::GetDataLeftLegPose() const
     {
-        return std::any_cast<const Vector3<float>&>(metadata.at("data_left_leg_pose"));
+        return std::any_cast<const Vector3<float>&>(metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_left_leg_pose]);
     }
 
     const Vector3<float>& ArmorStandEntity::GetDataRightLegPose() const
     {
-        return std::any_cast<const Vector3<float>&>(metadata.at("data_right_leg_pose"));
+        return std::any_cast<const Vector3<float>&>(metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_right_leg_pose]);
     }
 
 
     void ArmorStandEntity::SetDataClientFlags(const char data_client_flags)
     {
-        metadata["data_client_flags"] = data_client_flags;
+        metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_client_flags] = data_client_flags;
     }
 
     void ArmorStandEntity::SetDataHeadPose(const Vector3<float>& data_head_pose)
     {
-        metadata["data_head_pose"] = data_head_pose;
+        metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_head_pose] = data_head_pose;
     }
 
     void ArmorStandEntity::SetDataBodyPose(const Vector3<float>& data_body_pose)
     {
-        metadata["data_body_pose"] = data_body_pose;
+        metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_body_pose] = data_body_pose;
     }
 
     void ArmorStandEntity::SetDataLeftArmPose(const Vector3<float>& data_left_arm_pose)
     {
-        metadata["data_left_arm_pose"] = data_left_arm_pose;
+        metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_left_arm_pose] = data_left_arm_pose;
     }
 
     void ArmorStandEntity::SetDataRightArmPose(const Vector3<float>& data_right_arm_pose)
     {
-        metadata["data_right_arm_pose"] = data_right_arm_pose;
+        metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_right_arm_pose] = data_right_arm_pose;
     }
 
     void ArmorStandEntity::SetDataLeftLegPose(const Vector3<float>& data_left_leg_pose)
     {
-        metadata["data_left_leg_pose"] = data_left_leg_pose;
+        metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_left_leg_pose] = data_left_leg_pose;
     }
 
     void ArmorStandEntity::SetDataRightLegPose(const Vector3<float>& data_right_leg_pose)
     {
-        metadata["data_right_leg_pose"] = data_right_leg_pose;
+        metadata[hierarchy_metadata_count + ArmorStandEntityMetadata::data_right_leg_pose] = data_right_leg_pose;
     }
 
 }
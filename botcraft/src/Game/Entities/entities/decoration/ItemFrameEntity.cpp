@@ -2,6 +2,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ItemFrameEntityMetadata
+    {
+        enum
+        {
+            data_item,
+            data_rotation,
+        };
+    };
+
     const std::array<std::string, ItemFrameEntity::metadata_count> ItemFrameEntity::metadata_names{ {
         "data_item",
         "data_rotation",
@@ -10,6 +20,7 @@ namespace Botcraft
     ItemFrameEntity::ItemFrameEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataItem(ProtocolCraft::Slot());
         SetDataRotation(0);
     }
@@ -71,29 +82,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const ProtocolCraft::Slot& ItemFrameEntity::GetDataItem() const
     {
-        return std::any_cast<const ProtocolCraft::Slot&>(metadata.at("data_item"));
+        return std::any_cast<const ProtocolCraft::Slot&>(GetMetadata(hierarchy_metadata_count + ItemFrameEntityMetadata::data_item));
     }
 
     int ItemFrameEntity::GetDataRotation() const
     {
-        return std::any_cast<int>(metadata.at("data_rotation"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + ItemFrameEntityMetadata::data_rotation]);
     }
 
 
     void ItemFrameEntity::SetDataItem(const ProtocolCraft::Slot& data_item)
     {
-        metadata["data_item"] = data_item;
+        metadata[hierarchy_metadata_count + ItemFrameEntityMetadata::data_item] = data_item;
     }
 
     void ItemFrameEntity::SetDataRotation(const int data_rotation)
     {
-        metadata["data_rotation"] = data_rotation;
+        metadata[hierarchy_metadata_count + ItemFrameEntityMetadata::data_rotation] = data_rotation;
     }
 
 }
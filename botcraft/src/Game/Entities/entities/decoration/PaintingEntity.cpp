@@ -3,6 +3,15 @@
 namespace Botcraft
 {
 #if PROTOCOL_VERSION > 758
+    // Index of each metadata in metadata_names
+    struct PaintingEntityMetadata
+    {
+        enum
+        {
+            data_painting_variant_id,
+        };
+    };
+
     const std::array<std::string, PaintingEntity::metadata_count> PaintingEntity::metadata_names{ {
         "data_painting_variant_id",
     } };
@@ -12,6 +21,7 @@ namespace Botcraft
     {
 #if PROTOCOL_VERSION > 758
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataPaintingVariantId(0);
 #endif
     }
@@ -73,19 +83,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const int PaintingEntity::GetDataPaintingVariantId() const
     {
-        return std::any_cast<int>(metadata.at("data_painting_variant_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PaintingEntityMetadata::data_painting_variant_id]);
     }
 
 
     void PaintingEntity::SetDataPaintingVariantId(const int data_painting_variant_id)
     {
-        metadata["data_painting_variant_id"] = data_painting_variant_id;
+        metadata[hierarchy_metadata_count + PaintingEntityMetadata::data_painting_variant_id] = data_painting_variant_id;
     }
 #endif
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct FallingBlockEntityMetadata
+    {
+        enum
+        {
+            data_start_pos,
+        };
+    };
+
     const std::array<std::string, FallingBlockEntity::metadata_count> FallingBlockEntity::metadata_names{ {
         "data_start_pos",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     FallingBlockEntity::FallingBlockEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataStartPos(Position(0, 0, 0));
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const Position& FallingBlockEntity::GetDataStartPos() const
     {
-        return std::any_cast<const Position&>(metadata.at("data_start_pos"));
+        return std::any_cast<const Position&>(metadata[hierarchy_metadata_count + FallingBlockEntityMetadata::data_start_pos]);
     }
 
 
     void FallingBlockEntity::SetDataStartPos(const Position& data_start_pos)
     {
-        metadata["data_start_pos"] = data_start_pos;
+        metadata[hierarchy_metadata_count + FallingBlockEntityMetadata::data_start_pos] = data_start_pos;
     }
 
 }
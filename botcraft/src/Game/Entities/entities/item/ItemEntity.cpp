@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ItemEntityMetadata
+    {
+        enum
+        {
+            data_item,
+        };
+    };
+
     const std::array<std::string, ItemEntity::metadata_count> ItemEntity::metadata_names{ {
         "data_item",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     ItemEntity::ItemEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataItem(ProtocolCraft::Slot());
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const ProtocolCraft::Slot& ItemEntity::GetDataItem() const
     {
-        return std::any_cast<const ProtocolCraft::Slot&>(metadata.at("data_item"));
+        return std::any_cast<const ProtocolCraft::Slot&>(GetMetadata(hierarchy_metadata_count + ItemEntityMetadata::data_item));
     }
 
 
     void ItemEntity::SetDataItem(const ProtocolCraft::Slot& data_item)
     {
-        metadata["data_item"] = data_item;
+        metadata[hierarchy_metadata_count + ItemEntityMetadata::data_item] = data_item;
     }
 
 }
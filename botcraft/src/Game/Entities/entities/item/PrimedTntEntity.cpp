@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PrimedTntEntityMetadata
+    {
+        enum
+        {
+            data_fuse_id,
+        };
+    };
+
     const std::array<std::string, PrimedTntEntity::metadata_count> PrimedTntEntity::metadata_names{ {
         "data_fuse_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     PrimedTntEntity::PrimedTntEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataFuseId(80);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int PrimedTntEntity::GetDataFuseId() const
     {
-        return std::any_cast<int>(metadata.at("data_fuse_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PrimedTntEntityMetadata::data_fuse_id]);
     }
 
 
     void PrimedTntEntity::SetDataFuseId(const int data_fuse_id)
     {
-        metadata["data_fuse_id"] = data_fuse_id;
+        metadata[hierarchy_metadata_count + PrimedTntEntityMetadata::data_fuse_id] = data_fuse_id;
     }
 
 }
@@ -3,6 +3,15 @@
 namespace Botcraft
 {
 #if PROTOCOL_VERSION < 405
+    // Index of each metadata in metadata_names
+    struct AbstractIllagerEntityMetadata
+    {
+        enum
+        {
+            has_target,
+        };
+    };
+
     const std::array<std::string, AbstractIllagerEntity::metadata_count> AbstractIllagerEntity::metadata_names{ {
         "has_target",
     } };
@@ -11,6 +20,7 @@ namespace Botcraft
     {
 #if PROTOCOL_VERSION < 405
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetHasTarget(0);
 #endif
     }
@@ -45,18 +55,18 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char AbstractIllagerEntity::GetHasTarget() const
     {
-        return std::any_cast<char>(metadata.at("has_target"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + AbstractIllagerEntityMetadata::has_target]);
     }
 
     void AbstractIllagerEntity::SetHasTarget(const char has_target)
     {
-        metadata["has_target"] = has_target;
+        metadata[hierarchy_metadata_count + AbstractIllagerEntityMetadata::has_target] = has_target;
     }
 #endif
 
@@ -3,6 +3,15 @@
 namespace Botcraft
 {
 #if PROTOCOL_VERSION < 405
+    // Index of each metadata in metadata_names
+    struct AbstractSkeletonEntityMetadata
+    {
+        enum
+        {
+            is_swinging_arms,
+        };
+    };
+
     const std::array<std::string, AbstractSkeletonEntity::metadata_count> AbstractSkeletonEntity::metadata_names{ {
         "is_swinging_arms",
     } };
@@ -12,6 +21,7 @@ namespace Botcraft
     {
 #if PROTOCOL_VERSION < 405
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIsSwingingArms(false);
 #endif
     }
@@ -46,19 +56,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool AbstractSkeletonEntity::GetIsSwingingArms() const
     {
-        return std::any_cast<bool>(metadata.at("is_swinging_arms"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AbstractSkeletonEntityMetadata::is_swinging_arms]);
     }
 
 
     void AbstractSkeletonEntity::SetIsSwingingArms(const bool is_swinging_arms)
     {
-        metadata["is_swinging_arms"] = is_swinging_arms;
+        metadata[hierarchy_metadata_count + AbstractSkeletonEntityMetadata::is_swinging_arms] = is_swinging_arms;
     }
 #endif
 
@@ -2,6 +2,17 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct CreeperEntityMetadata
+    {
+        enum
+        {
+            data_swell_dir,
+            data_is_powered,
+            data_is_ignited,
+        };
+    };
+
     const std::array<std::string, CreeperEntity::metadata_count> CreeperEntity::metadata_names{ {
         "data_swell_dir",
         "data_is_powered",
@@ -11,6 +22,7 @@ namespace Botcraft
     CreeperEntity::CreeperEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataSwellDir(-1);
         SetDataIsPowered(false);
         SetDataIsIgnited(false);
@@ -74,39 +86,39 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int CreeperEntity::GetDataSwellDir() const
     {
-        return std::any_cast<int>(metadata.at("data_swell_dir"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + CreeperEntityMetadata::data_swell_dir]);
     }
 
     bool CreeperEntity::GetDataIsPowered() const
     {
-        return std::any_cast<bool>(metadata.at("data_is_powered"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + CreeperEntityMetadata::data_is_powered]);
     }
 
     bool CreeperEntity::GetDataIsIgnited() const
     {
-        return std::any_cast<bool>(metadata.at("data_is_ignited"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + CreeperEntityMetadata::data_is_ignited]);
     }
 
 
     void CreeperEntity::SetDataSwellDir(const int data_swell_dir)
     {
-        metadata["data_swell_dir"] = data_swell_dir;
+        metadata[hierarchy_metadata_count + CreeperEntityMetadata::data_swell_dir] = data_swell_dir;
     }
 
     void CreeperEntity::SetDataIsPowered(const bool data_is_powered)
     {
-        metadata["data_is_powered"] = data_is_powered;
+        metadata[hierarchy_metadata_count + CreeperEntityMetadata::data_is_powered] = data_is_powered;
     }
 
     void CreeperEntity::SetDataIsIgnited(const bool data_is_ignited)
     {
-        metadata["data_is_ignited"] = data_is_ignited;
+        metadata[hierarchy_metadata_count + CreeperEntityMetadata::data_is_ignited] = data_is_ignited;
     }
 
 }
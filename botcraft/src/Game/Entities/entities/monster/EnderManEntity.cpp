@@ -2,6 +2,19 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct EnderManEntityMetadata
+    {
+        enum
+        {
+            data_carry_state,
+            data_creepy,
+#if PROTOCOL_VERSION > 498
+            data_stared_at,
+#endif
+        };
+    };
+
     const std::array<std::string, EnderManEntity::metadata_count> EnderManEntity::metadata_names{ {
         "data_carry_state",
         "data_creepy",
@@ -13,6 +26,7 @@ namespace Botcraft
     EnderManEntity::EnderManEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataCarryState(0);
         SetDataCreepy(false);
 #if PROTOCOL_VERSION > 498
@@ -80,42 +94,42 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int EnderManEntity::GetDataCarryState() const
     {
-        return std::any_cast<int>(metadata.at("data_carry_state"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + EnderManEntityMetadata::data_carry_state]);
     }
 
     bool EnderManEntity::GetDataCreepy() const
     {
-        return std::any_cast<bool>(metadata.at("data_creepy"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + EnderManEntityMetadata::data_creepy]);
     }
 
 #if PROTOCOL_VERSION > 498
     bool EnderManEntity::GetDataStaredAt() const
     {
-        return std::any_cast<bool>(metadata.at("data_stared_at"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + EnderManEntityMetadata::data_stared_at]);
     }
 #endif
 
 
     void EnderManEntity::SetDataCarryState(const int data_carry_state)
     {
-        metadata["data_carry_state"] = data_carry_state;
+        metadata[hierarchy_metadata_count + EnderManEntityMetadata::data_carry_state] = data_carry_state;
     }
 
     void EnderManEntity::SetDataCreepy(const bool data_creepy)
     {
-        metadata["data_creepy"] = data_creepy;
+        metadata[hierarchy_metadata_count + EnderManEntityMetadata::data_creepy] = data_creepy;
     }
 
 #if PROTOCOL_VERSION > 498
     void EnderManEntity::SetDataStaredAt(const bool data_stared_at)
     {
-        metadata["data_stared_at"] = data_stared_at;
+        metadata[hierarchy_metadata_count + EnderManEntityMetadata::data_stared_at] = data_stared_at;
     }
 #endif
 
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct GhastEntityMetadata
+    {
+        enum
+        {
+            data_is_charging,
+        };
+    };
+
     const std::array<std::string, GhastEntity::metadata_count> GhastEntity::metadata_names{ {
         "data_is_charging",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     GhastEntity::GhastEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIsCharging(false);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool GhastEntity::GetDataIsCharging() const
     {
-        return std::any_cast<bool>(metadata.at("data_is_charging"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + GhastEntityMetadata::data_is_charging]);
     }
 
 
     void GhastEntity::SetDataIsCharging(const bool data_is_charging)
     {
-        metadata["data_is_charging"] = data_is_charging;
+        metadata[hierarchy_metadata_count + GhastEntityMetadata::data_is_charging] = data_is_charging;
     }
 
 }
@@ -2,6 +2,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct GuardianEntityMetadata
+    {
+        enum
+        {
+            data_id_moving,
+            data_id_attack_target,
+        };
+    };
+
     const std::array<std::string, GuardianEntity::metadata_count> GuardianEntity::metadata_names{ {
         "data_id_moving",
         "data_id_attack_target",
@@ -10,6 +20,7 @@ namespace Botcraft
     GuardianEntity::GuardianEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdMoving(false);
         SetDataIdAttackTarget(0);
     }
@@ -71,29 +82,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool GuardianEntity::GetDataIdMoving() const
     {
-        return std::any_cast<bool>(metadata.at("data_id_moving"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + GuardianEntityMetadata::data_id_moving]);
     }
 
     int GuardianEntity::GetDataIdAttackTarget() const
     {
-        return std::any_cast<int>(metadata.at("data_id_attack_target"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + GuardianEntityMetadata::data_id_attack_target]);
     }
 
 
     void GuardianEntity::SetDataIdMoving(const bool data_id_moving)
     {
-        metadata["data_id_moving"] = data_id_moving;
+        metadata[hierarchy_metadata_count + GuardianEntityMetadata::data_id_moving] = data_id_moving;
     }
 
     void GuardianEntity::SetDataIdAttackTarget(const int data_id_attack_target)
     {
-        metadata["data_id_attack_target"] = data_id_attack_target;
+        metadata[hierarchy_metadata_count + GuardianEntityMetadata::data_id_attack_target] = data_id_attack_target;
     }
 
 }
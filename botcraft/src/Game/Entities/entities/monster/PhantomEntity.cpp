@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PhantomEntityMetadata
+    {
+        enum
+        {
+            id_size,
+        };
+    };
+
     const std::array<std::string, PhantomEntity::metadata_count> PhantomEntity::metadata_names{ {
         "id_size",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     PhantomEntity::PhantomEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIdSize(0);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int PhantomEntity::GetIdSize() const
     {
-        return std::any_cast<int>(metadata.at("id_size"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PhantomEntityMetadata::id_size]);
     }
 
 
     void PhantomEntity::SetIdSize(const int id_size)
     {
-        metadata["id_size"] = id_size;
+        metadata[hierarchy_metadata_count + PhantomEntityMetadata::id_size] = id_size;
     }
 
 }
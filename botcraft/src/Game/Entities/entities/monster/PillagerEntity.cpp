@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PillagerEntityMetadata
+    {
+        enum
+        {
+            is_charging_crossbow,
+        };
+    };
+
     const std::array<std::string, PillagerEntity::metadata_count> PillagerEntity::metadata_names{ {
         "is_charging_crossbow",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     PillagerEntity::PillagerEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIsChargingCrossbow(false);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool PillagerEntity::GetIsChargingCrossbow() const
     {
-        return std::any_cast<bool>(metadata.at("is_charging_crossbow"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + PillagerEntityMetadata::is_charging_crossbow]);
     }
 
 
     void PillagerEntity::SetIsChargingCrossbow(const bool is_charging_crossbow)
     {
-        metadata["is_charging_crossbow"] = is_charging_crossbow;
+        metadata[hierarchy_metadata_count + PillagerEntityMetadata::is_charging_crossbow] = is_charging_crossbow;
     }
 
 }
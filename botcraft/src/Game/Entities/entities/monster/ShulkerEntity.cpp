@@ -2,6 +2,20 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ShulkerEntityMetadata
+    {
+        enum
+        {
+            data_attach_face_id,
+#if PROTOCOL_VERSION < 755
+            data_attach_pos_id,
+#endif
+            data_peek_id,
+            data_color_id,
+        };
+    };
+
     const std::array<std::string, ShulkerEntity::metadata_count> ShulkerEntity::metadata_names{ {
         "data_attach_face_id",
 #if PROTOCOL_VERSION < 755
@@ -14,6 +28,7 @@ namespace Botcraft
     ShulkerEntity::ShulkerEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataAttachFaceId(Direction::Down);
 #if PROTOCOL_VERSION < 755
         SetDataAttachPosId(std::optional<Position>());
@@ -83,53 +98,53 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     Direction ShulkerEntity::GetDataAttachFaceId() const
     {
-        return std::any_cast<Direction>(metadata.at("data_attach_face_id"));
+        return std::any_cast<Direction>(metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_attach_face_id]);
     }
 
 #if PROTOCOL_VERSION < 755
     const std::optional<Position>& ShulkerEntity::GetDataAttachPosId() const
     {
-        return std::any_cast<const std::optional<Position>&>(metadata.at("data_attach_pos_id"));
+        return std::any_cast<const std::optional<Position>&>(metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_attach_pos_id]);
     }
 #endif
 
     char ShulkerEntity::GetDataPeekId() const
     {
-        return std::any_cast<char>(metadata.at("data_peek_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_peek_id]);
     }
 
     char ShulkerEntity::GetDataColorId() const
     {
-        return std::any_cast<char>(metadata.at("data_color_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_color_id]);
     }
 
 
     void ShulkerEntity::SetDataAttachFaceId(const Direction data_attach_face_id)
     {
-        metadata["data_attach_face_id"] = data_attach_face_id;
+        metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_attach_face_id] = data_attach_face_id;
     }
 
 #if PROTOCOL_VERSION < 755
     void ShulkerEntity::SetDataAttachPosId(const std::optional<Position>& data_attach_pos_id)
     {
-        metadata["data_attach_pos_id"] = data_attach_pos_id;
+        metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_attach_pos_id] = data_attach_pos_id;
     }
 #endif
 
     void ShulkerEntity::SetDataPeekId(const char data_peek_id)
     {
-        metadata["data_peek_id"] = data_peek_id;
+        metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_peek_id] = data_peek_id;
     }
 
     void ShulkerEntity::SetDataColorId(const char data_color_id)
     {
-        metadata["data_color_id"] = data_color_id;
+        metadata[hierarchy_metadata_count + ShulkerEntityMetadata::data_color_id] = data_color_id;
     }
 
 }
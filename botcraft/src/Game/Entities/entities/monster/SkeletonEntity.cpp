@@ -3,6 +3,15 @@
 namespace Botcraft
 {
 #if PROTOCOL_VERSION > 754
+    // Index of each metadata in metadata_names
+    struct SkeletonEntityMetadata
+    {
+        enum
+        {
+            data_stray_conversion_id,
+        };
+    };
+
     const std::array<std::string, SkeletonEntity::metadata_count> SkeletonEntity::metadata_names{ {
         "data_stray_conversion_id",
     } };
@@ -12,6 +21,7 @@ namespace Botcraft
     {
 #if PROTOCOL_VERSION > 754
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataStrayConversionId(false);
 #endif
     }
@@ -73,19 +83,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool SkeletonEntity::GetDataStrayConversionId() const
     {
-        return std::any_cast<bool>(metadata.at("data_stray_conversion_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + SkeletonEntityMetadata::data_stray_conversion_id]);
     }
 
 
     void SkeletonEntity::SetDataStrayConversionId(const bool data_stray_conversion_id)
     {
-        metadata["data_stray_conversion_id"] = data_stray_conversion_id;
+        metadata[hierarchy_metadata_count + SkeletonEntityMetadata::data_stray_conversion_id] = data_stray_conversion_id;
     }
 #endif
 
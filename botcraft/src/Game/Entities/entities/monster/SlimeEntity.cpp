@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct SlimeEntityMetadata
+    {
+        enum
+        {
+            id_size,
+        };
+    };
+
     const std::array<std::string, SlimeEntity::metadata_count> SlimeEntity::metadata_names{ {
         "id_size",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     SlimeEntity::SlimeEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIdSize(1);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int SlimeEntity::GetIdSize() const
     {
-        return std::any_cast<int>(metadata.at("id_size"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + SlimeEntityMetadata::id_size]);
     }
 
 
     void SlimeEntity::SetIdSize(const int id_size)
     {
-        metadata["id_size"] = id_size;
+        metadata[hierarchy_metadata_count + SlimeEntityMetadata::id_size] = id_size;
 #if USE_GUI
         are_rendered_faces_up_to_date = false;
         for (size_t i = 0; i < faces.size(); ++i)
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct SpellcasterIllagerEntityMetadata
+    {
+        enum
+        {
+            data_spell_casting_id,
+        };
+    };
+
     const std::array<std::string, SpellcasterIllagerEntity::metadata_count> SpellcasterIllagerEntity::metadata_names{ {
         "data_spell_casting_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     SpellcasterIllagerEntity::SpellcasterIllagerEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataSpellCastingId(0);
     }
 
@@ -41,19 +51,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char SpellcasterIllagerEntity::GetDataSpellCastingId() const
     {
-        return std::any_cast<char>(metadata.at("data_spell_casting_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + SpellcasterIllagerEntityMetadata::data_spell_casting_id]);
     }
 
 
     void SpellcasterIllagerEntity::SetDataSpellCastingId(const char data_spell_casting_id)
     {
-        metadata["data_spell_casting_id"] = data_spell_casting_id;
+        metadata[hierarchy_metadata_count + SpellcasterIllagerEntityMetadata::data_spell_casting_id] = data_spell_casting_id;
     }
 
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct SpiderEntityMetadata
+    {
+        enum
+        {
+            data_flags_id,
+        };
+    };
+
     const std::array<std::string, SpiderEntity::metadata_count> SpiderEntity::metadata_names{ {
         "data_flags_id",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     SpiderEntity::SpiderEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataFlagsId(0);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char SpiderEntity::GetDataFlagsId() const
     {
-        return std::any_cast<char>(metadata.at("data_flags_id"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + SpiderEntityMetadata::data_flags_id]);
     }
 
 
     void SpiderEntity::SetDataFlagsId(const char data_flags_id)
     {
-        metadata["data_flags_id"] = data_flags_id;
+        metadata[hierarchy_metadata_count + SpiderEntityMetadata::data_flags_id] = data_flags_id;
     }
 
 }
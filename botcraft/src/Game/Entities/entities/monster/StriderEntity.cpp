@@ -3,6 +3,17 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct StriderEntityMetadata
+    {
+        enum
+        {
+            data_boost_time,
+            data_suffocating,
+            data_saddle_id,
+        };
+    };
+
     const std::array<std::string, StriderEntity::metadata_count> StriderEntity::metadata_names{ {
         "data_boost_time",
         "data_suffocating",
@@ -12,6 +23,7 @@ namespace Botcraft
     StriderEntity::StriderEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataBoostTime(0);
         SetDataSuffocating(false);
         SetDataSaddleId(false);
@@ -75,39 +87,39 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int StriderEntity::GetDataBoostTime() const
     {
-        return std::any_cast<int>(metadata.at("data_boost_time"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + StriderEntityMetadata::data_boost_time]);
     }
 
     bool StriderEntity::GetDataSuffocating() const
     {
-        return std::any_cast<bool>(metadata.at("data_suffocating"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + StriderEntityMetadata::data_suffocating]);
     }
 
     bool StriderEntity::GetDataSaddleId() const
     {
-        return std::any_cast<bool>(metadata.at("data_saddle_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + StriderEntityMetadata::data_saddle_id]);
     }
 
 
     void StriderEntity::SetDataBoostTime(const int data_boost_time)
     {
-        metadata["data_boost_time"] = data_boost_time;
+        metadata[hierarchy_metadata_count + StriderEntityMetadata::data_boost_time] = data_boost_time;
     }
 
     void StriderEntity::SetDataSuffocating(const bool data_suffocating)
     {
-        metadata["data_suffocating"] = data_suffocating;
+        metadata[hierarchy_metadata_count + StriderEntityMetadata::data_suffocating] = data_suffocating;
     }
 
     void StriderEntity::SetDataSaddleId(const bool data_saddle_id)
     {
-        metadata["data_saddle_id"] = data_saddle_id;
+        metadata[hierarchy_metadata_count + StriderEntityMetadata::data_saddle_id] = data_saddle_id;
     }
 
 }
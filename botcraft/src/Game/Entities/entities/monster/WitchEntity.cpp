@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct WitchEntityMetadata
+    {
+        enum
+        {
+            data_using_item,
+        };
+    };
+
     const std::array<std::string, WitchEntity::metadata_count> WitchEntity::metadata_names{ {
         "data_using_item",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     WitchEntity::WitchEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataUsingItem(false);
     }
 
@@ -76,19 +86,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool WitchEntity::GetDataUsingItem() const
     {
-        return std::any_cast<bool>(metadata.at("data_using_item"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + WitchEntityMetadata::data_using_item]);
     }
 
 
     void WitchEntity::SetDataUsingItem(const bool data_using_item)
     {
-        metadata["data_using_item"] = data_using_item;
+        metadata[hierarchy_metadata_count + WitchEntityMetadata::data_using_item] = data_using_item;
     }
 
 }
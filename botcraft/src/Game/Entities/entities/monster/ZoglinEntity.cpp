@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ZoglinEntityMetadata
+    {
+        enum
+        {
+            data_baby_id,
+        };
+    };
+
     const std::array<std::string, ZoglinEntity::metadata_count> ZoglinEntity::metadata_names{ {
         "data_baby_id",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     ZoglinEntity::ZoglinEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataBabyId(false);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool ZoglinEntity::GetDataBabyId() const
     {
-        return std::any_cast<bool>(metadata.at("data_baby_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + ZoglinEntityMetadata::data_baby_id]);
     }
 
 
     void ZoglinEntity::SetDataBabyId(const bool data_baby_id)
     {
-        metadata["data_baby_id"] = data_baby_id;
+        metadata[hierarchy_metadata_count + ZoglinEntityMetadata::data_baby_id] = data_baby_id;
     }
 
 }
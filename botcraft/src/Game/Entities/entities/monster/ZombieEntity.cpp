@@ -2,6 +2,22 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ZombieEntityMetadata
+    {
+        enum
+        {
+            data_baby_id,
+            data_special_type_id,
+#if PROTOCOL_VERSION < 405
+            data_are_hands_up,
+#endif
+#if PROTOCOL_VERSION > 340
+            data_drowned_conversion_id,
+#endif
+        };
+    };
+
     const std::array<std::string, ZombieEntity::metadata_count> ZombieEntity::metadata_names{ {
         "data_baby_id",
         "data_special_type_id",
@@ -16,6 +32,7 @@ namespace Botcraft
     ZombieEntity::ZombieEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataBabyId(false);
         SetDataSpecialTypeId(0);
 #if PROTOCOL_VERSION < 405
@@ -89,56 +106,56 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool ZombieEntity::GetDataBabyId() const
     {
-        return std::any_cast<bool>(metadata.at("data_baby_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_baby_id]);
     }
 
     int ZombieEntity::GetDataSpecialTypeId() const
     {
-        return std::any_cast<int>(metadata.at("data_special_type_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_special_type_id]);
     }
 
 #if PROTOCOL_VERSION < 405
     bool ZombieEntity::GetDataAreHandsUp() const
     {
-        return std::any_cast<bool>(metadata.at("data_are_hands_up"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_are_hands_up]);
     }
 #endif
 
 #if PROTOCOL_VERSION > 340
     bool ZombieEntity::GetDataDrownedConversionId() const
     {
-        return std::any_cast<bool>(metadata.at("data_drowned_conversion_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_drowned_conversion_id]);
     }
 #endif
 
 
     void ZombieEntity::SetDataBabyId(const bool data_baby_id)
     {
-        metadata["data_baby_id"] = data_baby_id;
+        metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_baby_id] = data_baby_id;
     }
 
     void ZombieEntity::SetDataSpecialTypeId(const int data_special_type_id)
     {
-        metadata["data_special_type_id"] = data_special_type_id;
+        metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_special_type_id] = data_special_type_id;
     }
 
 #if PROTOCOL_VERSION < 405
     void ZombieEntity::SetDataAreHandsUp(const bool data_are_hands_up)
     {
-        metadata["data_are_hands_up"] = data_are_hands_up;
+        metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_are_hands_up] = data_are_hands_up;
     }
 #endif
 
 #if PROTOCOL_VERSION > 340
     void ZombieEntity::SetDataDrownedConversionId(const bool data_drowned_conversion_id)
     {
-        metadata["data_drowned_conversion_id"] = data_drowned_conversion_id;
+        metadata[hierarchy_metadata_count + ZombieEntityMetadata::data_drowned_conversion_id] = data_drowned_conversion_id;
     }
 #endif
 
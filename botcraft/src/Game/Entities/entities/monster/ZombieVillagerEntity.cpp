@@ -2,6 +2,20 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ZombieVillagerEntityMetadata
+    {
+        enum
+        {
+            data_converting_id,
+#if PROTOCOL_VERSION > 404
+            data_villager_data,
+#else
+            data_villager_profession_id,
+#endif
+        };
+    };
+
     const std::array<std::string, ZombieVillagerEntity::metadata_count> ZombieVillagerEntity::metadata_names{ {
         "data_converting_id",
 #if PROTOCOL_VERSION > 404
@@ -14,6 +28,7 @@ namespace Botcraft
     ZombieVillagerEntity::ZombieVillagerEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataConvertingId(false);
 #if PROTOCOL_VERSION > 404
         SetDataVillagerData(VillagerData{ 2, 0, 1 });
@@ -83,42 +98,42 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool ZombieVillagerEntity::GetDataConvertingId() const
     {
-        return std::any_cast<bool>(metadata.at("data_converting_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + ZombieVillagerEntityMetadata::data_converting_id]);
     }
 
 #if PROTOCOL_VERSION > 404
     const VillagerData& ZombieVillagerEntity::GetDataVillagerData() const
     {
-        return std::any_cast<const VillagerData&>(metadata.at("data_villager_data"));
+        return std::any_cast<const VillagerData&>(metadata[hierarchy_metadata_count + ZombieVillagerEntityMetadata::data_villager_data]);
     }
 #else
     int ZombieVillagerEntity::GetDataVillagerProfessionId() const
     {
-        return std::any_cast<int>(metadata.at("data_villager_profession_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + ZombieVillagerEntityMetadata::data_villager_profession_id]);
     }
 #endif
 
 
     void ZombieVillagerEntity::SetDataConvertingId(const bool data_converting_id)
     {
-        metadata["data_converting_id"] = data_converting_id;
+        metadata[hierarchy_metadata_count + ZombieVillagerEntityMetadata::data_converting_id] = data_converting_id;
     }
 
 #if PROTOCOL_VERSION > 404
     void ZombieVillagerEntity::SetDataVillagerData(const VillagerData& data_villager_data)
     {
-        metadata["data_villager_data"] = data_villager_data;
+        metadata[hierarchy_metadata_count + ZombieVillagerEntityMetadata::data_villager_data] = data_villager_data;
     }
 #else
     void ZombieVillagerEntity::SetDataVillagerProfessionId(const int data_villager_profession_id)
     {
-        metadata["data_villager_profession_id"] = data_villager_profession_id;
+        metadata[hierarchy_metadata_count + ZombieVillagerEntityMetadata::data_villager_profession_id] = data_villager_profession_id;
     }
 #endif
 
@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct HoglinEntityMetadata
+    {
+        enum
+        {
+            data_immune_to_zombification,
+        };
+    };
+
     const std::array<std::string, HoglinEntity::metadata_count> HoglinEntity::metadata_names{ {
         "data_immune_to_zombification",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     HoglinEntity::HoglinEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataImmuneToZombification(false);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool HoglinEntity::GetDataImmuneToZombification() const
     {
-        return std::any_cast<bool>(metadata.at("data_immune_to_zombification"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + HoglinEntityMetadata::data_immune_to_zombification]);
     }
 
 
     void HoglinEntity::SetDataImmuneToZombification(const bool data_immune_to_zombification)
     {
-        metadata["data_immune_to_zombification"] = data_immune_to_zombification;
+        metadata[hierarchy_metadata_count + HoglinEntityMetadata::data_immune_to_zombification] = data_immune_to_zombification;
     }
 
 }
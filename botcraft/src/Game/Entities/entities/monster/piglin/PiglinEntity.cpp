@@ -3,6 +3,20 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PiglinEntityMetadata
+    {
+        enum
+        {
+            data_baby_id,
+#if PROTOCOL_VERSION < 737
+            data_immune_to_zombification,
+#endif
+            data_is_charging_crossbow,
+            data_is_dancing,
+        };
+    };
+
     const std::array<std::string, PiglinEntity::metadata_count> PiglinEntity::metadata_names{ {
         "data_baby_id",
 #if PROTOCOL_VERSION < 737
@@ -15,6 +29,7 @@ namespace Botcraft
     PiglinEntity::PiglinEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataBabyId(false);
 #if PROTOCOL_VERSION < 737
         SetDataImmuneToZombification(false);
@@ -92,52 +107,52 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool PiglinEntity::GetDataBabyId() const
     {
-        return std::any_cast<bool>(metadata.at("data_baby_id"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_baby_id]);
     }
 
 #if PROTOCOL_VERSION < 737
     bool PiglinEntity::GetDataImmuneToZombification() const
     {
-        return std::any_cast<bool>(metadata.at("data_immune_to_zombification"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_immune_to_zombification]);
     }
 #endif
 
     bool PiglinEntity::GetDataIsChargingCrossbow() const
     {
-        return std::any_cast<bool>(metadata.at("data_is_charging_crossbow"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_is_charging_crossbow]);
     }
 
     bool PiglinEntity::GetDataIsDancing() const
     {
-        return std::any_cast<bool>(metadata.at("data_is_dancing"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_is_dancing]);
     }
 
 
     void PiglinEntity::SetDataBabyId(const bool data_baby_id)
     {
-        metadata["data_baby_id"] = data_baby_id;
+        metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_baby_id] = data_baby_id;
     }
 
 #if PROTOCOL_VERSION < 737
     void PiglinEntity::SetDataImmuneToZombification(const bool data_immune_to_zombification)
     {
-        metadata["data_immune_to_zombification"] = data_immune_to_zombification;
+        metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_immune_to_zombification] = data_immune_to_zombification;
     }
 #endif
     void PiglinEntity::SetDataIsChargingCrossbow(const bool data_is_charging_crossbow)
     {
-        metadata["data_is_charging_crossbow"] = data_is_charging_crossbow;
+        metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_is_charging_crossbow] = data_is_charging_crossbow;
     }
 
     void PiglinEntity::SetDataIsDancing(const bool data_is_dancing)
     {
-        metadata["data_is_dancing"] = data_is_dancing;
+        metadata[hierarchy_metadata_count + PiglinEntityMetadata::data_is_dancing] = data_is_dancing;
     }
 
 }
@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct WardenEntityMetadata
+    {
+        enum
+        {
+            client_anger_level,
+        };
+    };
+
     const std::array<std::string, WardenEntity::metadata_count> WardenEntity::metadata_names{ {
         "client_anger_level",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     WardenEntity::WardenEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetClientAngerLevel(0);
     }
 
@@ -69,19 +79,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int WardenEntity::GetClientAngerLevel() const
     {
-        return std::any_cast<int>(metadata.at("client_anger_level"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + WardenEntityMetadata::client_anger_level]);
     }
 
 
     void WardenEntity::SetClientAngerLevel(const int client_anger_level)
     {
-        metadata["client_anger_level"] = client_anger_level;
+        metadata[hierarchy_metadata_count + WardenEntityMetadata::client_anger_level] = client_anger_level;
     }
 
 }
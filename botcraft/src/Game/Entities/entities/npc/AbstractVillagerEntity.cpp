@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AbstractVillagerEntityMetadata
+    {
+        enum
+        {
+            data_unhappy_counter,
+        };
+    };
+
     const std::array<std::string, AbstractVillagerEntity::metadata_count> AbstractVillagerEntity::metadata_names{ {
         "data_unhappy_counter",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     AbstractVillagerEntity::AbstractVillagerEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataUnhappyCounter(0);
     }
 
@@ -42,19 +52,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int AbstractVillagerEntity::GetDataUnhappyCounter() const
     {
-        return std::any_cast<int>(metadata.at("data_unhappy_counter"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AbstractVillagerEntityMetadata::data_unhappy_counter]);
     }
 
 
     void AbstractVillagerEntity::SetDataUnhappyCounter(const int data_unhappy_counter)
     {
-        metadata["data_unhappy_counter"] = data_unhappy_counter;
+        metadata[hierarchy_metadata_count + AbstractVillagerEntityMetadata::data_unhappy_counter] = data_unhappy_counter;
     }
 
 }
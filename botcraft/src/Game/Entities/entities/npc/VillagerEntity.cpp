@@ -2,6 +2,19 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct VillagerEntityMetadata
+    {
+        enum
+        {
+#if PROTOCOL_VERSION > 404
+            data_villager_data,
+#else
+            data_villager_profession_id,
+#endif
+        };
+    };
+
     const std::array<std::string, VillagerEntity::metadata_count> VillagerEntity::metadata_names{ {
 #if PROTOCOL_VERSION > 404
         "data_villager_data",
@@ -13,6 +26,7 @@ namespace Botcraft
     VillagerEntity::VillagerEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
 #if PROTOCOL_VERSION > 404
         SetDataVillagerData(VillagerData{ 2, 0, 1 });
 #else
@@ -88,31 +102,31 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
 #if PROTOCOL_VERSION > 404
     const VillagerData& VillagerEntity::GetDataVillagerData() const
     {
-        return std::any_cast<const VillagerData&>(metadata.at("data_villager_data"));
+        return std::any_cast<const VillagerData&>(metadata[hierarchy_metadata_count + VillagerEntityMetadata::data_villager_data]);
     }
 
 
     void VillagerEntity::SetDataVillagerData(const VillagerData& data_villager_data)
     {
-        metadata["data_villager_data"] = data_villager_data;
+        metadata[hierarchy_metadata_count + VillagerEntityMetadata::data_villager_data] = data_villager_data;
     }
 #else
     int VillagerEntity::GetDataVillagerProfessionId() const
     {
-        return std::any_cast<int>(metadata.at("data_villager_profession_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + VillagerEntityMetadata::data_villager_profession_id]);
     }
 
 
     void VillagerEntity::SetDataVillagerProfessionId(const int data_villager_profession_id)
     {
-        metadata["data_villager_profession_id"] = data_villager_profession_id;
+        metadata[hierarchy_metadata_count + VillagerEntityMetadata::data_villager_profession_id] = data_villager_profession_id;
     }
 #endif
 }
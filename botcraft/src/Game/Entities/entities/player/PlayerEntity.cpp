@@ -2,6 +2,20 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct PlayerEntityMetadata
+    {
+        enum
+        {
+            data_player_absorption_id,
+            data_score_id,
+            data_player_mode_customisation,
+            data_player_main_hand,
+            data_shoulder_left,
+            data_shoulder_right,
+        };
+    };
+
     const std::array<std::string, PlayerEntity::metadata_count> PlayerEntity::metadata_names{ {
         "data_player_absorption_id",
         "data_score_id",
@@ -14,6 +28,7 @@ namespace Botcraft
     PlayerEntity::PlayerEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataPlayerAbsorptionId(0.0f);
         SetDataScoreId(0);
         SetDataPlayerModeCustomisation(0);
@@ -83,69 +98,69 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     float PlayerEntity::GetDataPlayerAbsorptionId() const
     {
-        return std::any_cast<float>(metadata.at("data_player_absorption_id"));
+        return std::any_cast<float>(metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_player_absorption_id]);
     }
 
     int PlayerEntity::GetDataScoreId() const
     {
-        return std::any_cast<int>(metadata.at("data_score_id"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_score_id]);
     }
 
     char PlayerEntity::GetDataPlayerModeCustomisation() const
     {
-        return std::any_cast<char>(metadata.at("data_player_mode_customisation"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_player_mode_customisation]);
     }
 
     char PlayerEntity::GetDataPlayerMainHand() const
     {
-        return std::any_cast<char>(metadata.at("data_player_main_hand"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_player_main_hand]);
     }
 
     const ProtocolCraft::NBT& PlayerEntity::GetDataShoulderLeft() const
     {
-        return std::any_cast<const ProtocolCraft::NBT&>(metadata.at("data_shoulder_left"));
+        return std::any_cast<const ProtocolCraft::NBT&>(GetMetadata(hierarchy_metadata_count + PlayerEntityMetadata::data_shoulder_left));
     }
 
     const ProtocolCraft::NBT& PlayerEntity::GetDataShoulderRight() const
     {
-        return std::any_cast<const ProtocolCraft::NBT&>(metadata.at("data_shoulder_right"));
+        return std::any_cast<const ProtocolCraft::NBT&>(GetMetadata(hierarchy_metadata_count + PlayerEntityMetadata::data_shoulder_right));
     }
 
 
     void PlayerEntity::SetDataPlayerAbsorptionId(const float data_player_absorption_id)
     {
-        metadata["data_player_absorption_id"] = data_player_absorption_id;
+        metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_player_absorption_id] = data_player_absorption_id;
     }
 
     void PlayerEntity::SetDataScoreId(const int data_score_id)
     {
-        metadata["data_score_id"] = data_score_id;
+        metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_score_id] = data_score_id;
     }
 
     void PlayerEntity::SetDataPlayerModeCustomisation(const char data_player_mode_customisation)
     {
-        metadata["data_player_mode_customisation"] = data_player_mode_customisation;
+        metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_player_mode_customisation] = data_player_mode_customisation;
     }
 
     void PlayerEntity::SetDataPlayerMainHand(const char data_player_main_hand)
     {
-        metadata["data_player_main_hand"] = data_player_main_hand;
+        metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_player_main_hand] = data_player_main_hand;
     }
 
     void PlayerEntity::SetDataShoulderLeft(const ProtocolCraft::NBT& data_shoulder_left)
     {
-        metadata["data_shoulder_left"] = data_shoulder_left;
+        metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_shoulder_left] = data_shoulder_left;
     }
 
     void PlayerEntity::SetDataShoulderRight(const ProtocolCraft::NBT& data_shoulder_right)
     {
-        metadata["data_shoulder_right"] = data_shoulder_right;
+        metadata[hierarchy_metadata_count + PlayerEntityMetadata::data_shoulder_right] = data_shoulder_right;
     }
 
     bool PlayerEntity::IsRemotePlayer() const
@@ -2,6 +2,21 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AbstractArrowEntityMetadata
+    {
+        enum
+        {
+            id_flags,
+#if PROTOCOL_VERSION < 579 && PROTOCOL_VERSION > 393
+            data_owneruuid_id,
+#endif
+#if PROTOCOL_VERSION > 404
+            pierce_level,
+#endif
+        };
+    };
+
     const std::array<std::string, AbstractArrowEntity::metadata_count> AbstractArrowEntity::metadata_names{ {
         "id_flags",
 #if PROTOCOL_VERSION < 579 && PROTOCOL_VERSION > 393
@@ -15,6 +30,7 @@ namespace Botcraft
     AbstractArrowEntity::AbstractArrowEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIdFlags(0);
 #if PROTOCOL_VERSION < 579 && PROTOCOL_VERSION > 393
         SetDataOwneruuidId(std::optional<ProtocolCraft::UUID>());
@@ -67,46 +83,46 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char AbstractArrowEntity::GetIdFlags() const
     {
-        return std::any_cast<char>(metadata.at("id_flags"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + AbstractArrowEntityMetadata::id_flags]);
     }
 
 #if PROTOCOL_VERSION < 579 && PROTOCOL_VERSION > 393
     const std::optional<ProtocolCraft::UUID>& AbstractArrowEntity::GetDataOwneruuidId() const
     {
-        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata.at("data_owneruuid_id"));
+        return std::any_cast<const std::optional<ProtocolCraft::UUID>&>(metadata[hierarchy_metadata_count + AbstractArrowEntityMetadata::data_owneruuid_id]);
     }
 #endif
 
 #if PROTOCOL_VERSION > 404
     char AbstractArrowEntity::GetPierceLevel() const
     {
-        return std::any_cast<char>(metadata.at("pierce_level"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + AbstractArrowEntityMetadata::pierce_level]);
     }
 #endif
 
 
     void AbstractArrowEntity::SetIdFlags(const char id_flags)
     {
-        metadata["id_flags"] = id_flags;
+        metadata[hierarchy_metadata_count + AbstractArrowEntityMetadata::id_flags] = id_flags;
     }
 
 #if PROTOCOL_VERSION < 579 && PROTOCOL_VERSION > 393
     void AbstractArrowEntity::SetDataOwneruuidId(const std::optional<ProtocolCraft::UUID>& data_owneruuid_id)
     {
-        metadata["data_owneruuid_id"] = data_owneruuid_id;
+        metadata[hierarchy_metadata_count + AbstractArrowEntityMetadata::data_owneruuid_id] = data_owneruuid_id;
     }
 #endif
 
 #if PROTOCOL_VERSION > 404
     void AbstractArrowEntity::SetPierceLevel(const char pierce_level)
     {
-        metadata["pierce_level"] = pierce_level;
+        metadata[hierarchy_metadata_count + AbstractArrowEntityMetadata::pierce_level] = pierce_level;
     }
 #endif
 
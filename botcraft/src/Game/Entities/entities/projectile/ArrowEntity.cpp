@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ArrowEntityMetadata
+    {
+        enum
+        {
+            id_effect_color,
+        };
+    };
+
     const std::array<std::string, ArrowEntity::metadata_count> ArrowEntity::metadata_names{ {
         "id_effect_color",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     ArrowEntity::ArrowEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIdEffectColor(-1);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int ArrowEntity::GetIdEffectColor() const
     {
-        return std::any_cast<int>(metadata.at("id_effect_color"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + ArrowEntityMetadata::id_effect_color]);
     }
 
 
     void ArrowEntity::SetIdEffectColor(const int id_effect_color)
     {
-        metadata["id_effect_color"] = id_effect_color;
+        metadata[hierarchy_metadata_count + ArrowEntityMetadata::id_effect_color] = id_effect_color;
     }
 
 }
@@ -3,6 +3,15 @@
 namespace Botcraft
 {
 #if PROTOCOL_VERSION > 404
+    // Index of each metadata in metadata_names
+    struct EyeOfEnderEntityMetadata
+    {
+        enum
+        {
+            data_item_stack,
+        };
+    };
+
     const std::array<std::string, EyeOfEnderEntity::metadata_count> EyeOfEnderEntity::metadata_names{ {
         "data_item_stack",
     } };
@@ -12,6 +21,7 @@ namespace Botcraft
     {
 #if PROTOCOL_VERSION > 404
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataItemStack(ProtocolCraft::Slot());
 #endif
     }
@@ -73,19 +83,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const ProtocolCraft::Slot& EyeOfEnderEntity::GetDataItemStack() const
     {
-        return std::any_cast<const ProtocolCraft::Slot&>(metadata.at("data_item_stack"));
+        return std::any_cast<const ProtocolCraft::Slot&>(GetMetadata(hierarchy_metadata_count + EyeOfEnderEntityMetadata::data_item_stack));
     }
 
 
     void EyeOfEnderEntity::SetDataItemStack(const ProtocolCraft::Slot& data_item_stack)
     {
-        metadata["data_item_stack"] = data_item_stack;
+        metadata[hierarchy_metadata_count + EyeOfEnderEntityMetadata::data_item_stack] = data_item_stack;
     }
 #endif
 
@@ -2,6 +2,19 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct FireworkRocketEntityMetadata
+    {
+        enum
+        {
+            data_id_fireworks_item,
+            data_attached_to_target,
+#if PROTOCOL_VERSION > 404
+            data_shot_at_angle,
+#endif
+        };
+    };
+
     const std::array<std::string, FireworkRocketEntity::metadata_count> FireworkRocketEntity::metadata_names{ {
         "data_id_fireworks_item",
         "data_attached_to_target",
@@ -13,6 +26,7 @@ namespace Botcraft
     FireworkRocketEntity::FireworkRocketEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdFireworksItem(ProtocolCraft::Slot());
 #if PROTOCOL_VERSION > 404
         SetDataAttachedToTarget(std::optional<int>());
@@ -92,52 +106,52 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const ProtocolCraft::Slot& FireworkRocketEntity::GetDataIdFireworksItem() const
     {
-        return std::any_cast<const ProtocolCraft::Slot&>(metadata.at("data_id_fireworks_item"));
+        return std::any_cast<const ProtocolCraft::Slot&>(GetMetadata(hierarchy_metadata_count + FireworkRocketEntityMetadata::data_id_fireworks_item));
     }
 
 #if PROTOCOL_VERSION > 404
     const std::optional<int>& FireworkRocketEntity::GetDataAttachedToTarget() const
     {
-        return std::any_cast<const std::optional<int>&>(metadata.at("data_attached_to_target"));
+        return std::any_cast<const std::optional<int>&>(metadata[hierarchy_metadata_count + FireworkRocketEntityMetadata::data_attached_to_target]);
     }
 
     bool FireworkRocketEntity::GetDataShotAtAngle() const
     {
-        return std::any_cast<bool>(metadata.at("data_shot_at_angle"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + FireworkRocketEntityMetadata::data_shot_at_angle]);
     }
 #else
     int FireworkRocketEntity::GetDataAttachedToTarget() const
     {
-        return std::any_cast<int>(metadata.at("data_attached_to_target"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + FireworkRocketEntityMetadata::data_attached_to_target]);
     }
 #endif
 
 
     void FireworkRocketEntity::SetDataIdFireworksItem(const ProtocolCraft::Slot& data_id_fireworks_item)
     {
-        metadata["data_id_fireworks_item"] = data_id_fireworks_item;
+        metadata[hierarchy_metadata_count + FireworkRocketEntityMetadata::data_id_fireworks_item] = data_id_fireworks_item;
     }
 
 #if PROTOCOL_VERSION > 404
     void FireworkRocketEntity::SetDataAttachedToTarget(const std::optional<int>& data_attached_to_target)
     {
-        metadata["data_attached_to_target"] = data_attached_to_target;
+        metadata[hierarchy_metadata_count + FireworkRocketEntityMetadata::data_attached_to_target] = data_attached_to_target;
     }
 
     void FireworkRocketEntity::SetDataShotAtAngle(const bool data_shot_at_angle)
     {
-        metadata["data_shot_at_angle"] = data_shot_at_angle;
+        metadata[hierarchy_metadata_count + FireworkRocketEntityMetadata::data_shot_at_angle] = data_shot_at_angle;
     }
 #else
     void FireworkRocketEntity::SetDataAttachedToTarget(const int data_attached_to_target)
     {
-        metadata["data_attached_to_target"] = data_attached_to_target;
+        metadata[hierarchy_metadata_count + FireworkRocketEntityMetadata::data_attached_to_target] = data_attached_to_target;
     }
 #endif
 
@@ -2,6 +2,18 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct FishingHookEntityMetadata
+    {
+        enum
+        {
+            data_hooked_entity,
+#if PROTOCOL_VERSION > 578
+            data_biting,
+#endif
+        };
+    };
+
     const std::array<std::string, FishingHookEntity::metadata_count> FishingHookEntity::metadata_names{ {
         "data_hooked_entity",
 #if PROTOCOL_VERSION > 578
@@ -12,6 +24,7 @@ namespace Botcraft
     FishingHookEntity::FishingHookEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataHookedEntity(0);
 #if PROTOCOL_VERSION > 578
         SetDataBiting(false);
@@ -84,32 +97,32 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int FishingHookEntity::GetDataHookedEntity() const
     {
-        return std::any_cast<int>(metadata.at("data_hooked_entity"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + FishingHookEntityMetadata::data_hooked_entity]);
     }
 
 #if PROTOCOL_VERSION > 578
     bool FishingHookEntity::GetDataBiting() const
     {
-        return std::any_cast<bool>(metadata.at("data_biting"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + FishingHookEntityMetadata::data_biting]);
     }
 #endif
 
 
     void FishingHookEntity::SetDataHookedEntity(const int data_hooked_entity)
     {
-        metadata["data_hooked_entity"] = data_hooked_entity;
+        metadata[hierarchy_metadata_count + FishingHookEntityMetadata::data_hooked_entity] = data_hooked_entity;
     }
 
 #if PROTOCOL_VERSION > 578
     void FishingHookEntity::SetDataBiting(const bool data_biting)
     {
-        metadata["data_biting"] = data_biting;
+        metadata[hierarchy_metadata_count + FishingHookEntityMetadata::data_biting] = data_biting;
     }
 #endif
 
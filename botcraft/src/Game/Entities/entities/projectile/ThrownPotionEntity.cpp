@@ -3,6 +3,15 @@
 namespace Botcraft
 {
 #if PROTOCOL_VERSION < 579
+    // Index of each metadata in metadata_names
+    struct ThrownPotionEntityMetadata
+    {
+        enum
+        {
+            data_item_stack,
+        };
+    };
+
     const std::array<std::string, ThrownPotionEntity::metadata_count> ThrownPotionEntity::metadata_names{ {
         "data_item_stack",
     } };
@@ -12,6 +21,7 @@ namespace Botcraft
     {
 #if PROTOCOL_VERSION < 579
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataItemStack(ProtocolCraft::Slot());
 #endif
     }
@@ -73,19 +83,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const ProtocolCraft::Slot& ThrownPotionEntity::GetDataItemStack() const
     {
-        return std::any_cast<const ProtocolCraft::Slot&>(metadata.at("data_item_stack"));
+        return std::any_cast<const ProtocolCraft::Slot&>(GetMetadata(hierarchy_metadata_count + ThrownPotionEntityMetadata::data_item_stack));
     }
 
 
     void ThrownPotionEntity::SetDataItemStack(const ProtocolCraft::Slot& data_item_stack)
     {
-        metadata["data_item_stack"] = data_item_stack;
+        metadata[hierarchy_metadata_count + ThrownPotionEntityMetadata::data_item_stack] = data_item_stack;
     }
 #endif
 
@@ -3,6 +3,18 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct ThrownTridentEntityMetadata
+    {
+        enum
+        {
+            id_loyalty,
+#if PROTOCOL_VERSION > 498
+            id_foil,
+#endif
+        };
+    };
+
     const std::array<std::string, ThrownTridentEntity::metadata_count> ThrownTridentEntity::metadata_names{ {
         "id_loyalty",
 #if PROTOCOL_VERSION > 498
@@ -13,6 +25,7 @@ namespace Botcraft
     ThrownTridentEntity::ThrownTridentEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIdLoyalty(0);
 #if PROTOCOL_VERSION > 498
         SetIdFoil(false);
@@ -78,32 +91,32 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     char ThrownTridentEntity::GetIdLoyalty() const
     {
-        return std::any_cast<char>(metadata.at("id_loyalty"));
+        return std::any_cast<char>(metadata[hierarchy_metadata_count + ThrownTridentEntityMetadata::id_loyalty]);
     }
 
 #if PROTOCOL_VERSION > 498
     bool ThrownTridentEntity::GetIdFoil() const
     {
-        return std::any_cast<bool>(metadata.at("id_foil"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + ThrownTridentEntityMetadata::id_foil]);
     }
 #endif
 
 
     void ThrownTridentEntity::SetIdLoyalty(const char id_loyalty)
     {
-        metadata["id_loyalty"] = id_loyalty;
+        metadata[hierarchy_metadata_count + ThrownTridentEntityMetadata::id_loyalty] = id_loyalty;
     }
 
 #if PROTOCOL_VERSION > 498
     void ThrownTridentEntity::SetIdFoil(const bool id_foil)
     {
-        metadata["id_foil"] = id_foil;
+        metadata[hierarchy_metadata_count + ThrownTridentEntityMetadata::id_foil] = id_foil;
     }
 #endif
 
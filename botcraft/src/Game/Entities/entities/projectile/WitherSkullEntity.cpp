@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct WitherSkullEntityMetadata
+    {
+        enum
+        {
+            data_dangerous,
+        };
+    };
+
     const std::array<std::string, WitherSkullEntity::metadata_count> WitherSkullEntity::metadata_names{ {
         "data_dangerous",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     WitherSkullEntity::WitherSkullEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataDangerous(false);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool WitherSkullEntity::GetDataDangerous() const
     {
-        return std::any_cast<bool>(metadata.at("data_dangerous"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + WitherSkullEntityMetadata::data_dangerous]);
     }
 
 
     void WitherSkullEntity::SetDataDangerous(const bool data_dangerous)
     {
-        metadata["data_dangerous"] = data_dangerous;
+        metadata[hierarchy_metadata_count + WitherSkullEntityMetadata::data_dangerous] = data_dangerous;
     }
 
 }
@@ -3,6 +3,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct RaiderEntityMetadata
+    {
+        enum
+        {
+            is_celebrating,
+        };
+    };
+
     const std::array<std::string, RaiderEntity::metadata_count> RaiderEntity::metadata_names{ {
         "is_celebrating",
     } };
@@ -10,6 +19,7 @@ namespace Botcraft
     RaiderEntity::RaiderEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetIsCelebrating(false);
     }
 
@@ -42,19 +52,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool RaiderEntity::GetIsCelebrating() const
     {
-        return std::any_cast<bool>(metadata.at("is_celebrating"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + RaiderEntityMetadata::is_celebrating]);
     }
 
 
     void RaiderEntity::SetIsCelebrating(const bool is_celebrating)
     {
-        metadata["is_celebrating"] = is_celebrating;
+        metadata[hierarchy_metadata_count + RaiderEntityMetadata::is_celebrating] = is_celebrating;
     }
 
 }
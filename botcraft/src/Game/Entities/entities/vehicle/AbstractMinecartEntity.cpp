@@ -2,6 +2,20 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct AbstractMinecartEntityMetadata
+    {
+        enum
+        {
+            data_id_hurt,
+            data_id_hurtdir,
+            data_id_damage,
+            data_id_display_block,
+            data_id_display_offset,
+            data_id_custom_display,
+        };
+    };
+
     const std::array<std::string, AbstractMinecartEntity::metadata_count> AbstractMinecartEntity::metadata_names{ {
         "data_id_hurt",
         "data_id_hurtdir",
@@ -14,6 +28,7 @@ namespace Botcraft
     AbstractMinecartEntity::AbstractMinecartEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdHurt(0);
         SetDataIdHurtdir(1);
         SetDataIdDamage(0.0f);
@@ -56,69 +71,69 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int AbstractMinecartEntity::GetDataIdHurt() const
     {
-        return std::any_cast<int>(metadata.at("data_id_hurt"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_hurt]);
     }
 
     int AbstractMinecartEntity::GetDataIdHurtdir() const
     {
-        return std::any_cast<int>(metadata.at("data_id_hurtdir"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_hurtdir]);
     }
 
     float AbstractMinecartEntity::GetDataIdDamage() const
     {
-        return std::any_cast<float>(metadata.at("data_id_damage"));
+        return std::any_cast<float>(metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_damage]);
     }
 
     int AbstractMinecartEntity::GetDataIdDisplayBlock() const
     {
-        return std::any_cast<int>(metadata.at("data_id_display_block"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_display_block]);
     }
 
     int AbstractMinecartEntity::GetDataIdDisplayOffset() const
     {
-        return std::any_cast<int>(metadata.at("data_id_display_offset"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_display_offset]);
     }
 
     bool AbstractMinecartEntity::GetDataIdCustomDisplay() const
     {
-        return std::any_cast<bool>(metadata.at("data_id_custom_display"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_custom_display]);
     }
 
 
     void AbstractMinecartEntity::SetDataIdHurt(const int data_id_hurt)
     {
-        metadata["data_id_hurt"] = data_id_hurt;
+        metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_hurt] = data_id_hurt;
     }
 
     void AbstractMinecartEntity::SetDataIdHurtdir(const int data_id_hurtdir)
     {
-        metadata["data_id_hurtdir"] = data_id_hurtdir;
+        metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_hurtdir] = data_id_hurtdir;
     }
 
     void AbstractMinecartEntity::SetDataIdDamage(const float data_id_damage)
     {
-        metadata["data_id_damage"] = data_id_damage;
+        metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_damage] = data_id_damage;
     }
 
     void AbstractMinecartEntity::SetDataIdDisplayBlock(const int data_id_display_block)
     {
-        metadata["data_id_display_block"] = data_id_display_block;
+        metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_display_block] = data_id_display_block;
     }
 
     void AbstractMinecartEntity::SetDataIdDisplayOffset(const int data_id_display_offset)
     {
-        metadata["data_id_display_offset"] = data_id_display_offset;
+        metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_display_offset] = data_id_display_offset;
     }
 
     void AbstractMinecartEntity::SetDataIdCustomDisplay(const bool data_id_custom_display)
     {
-        metadata["data_id_custom_display"] = data_id_custom_display;
+        metadata[hierarchy_metadata_count + AbstractMinecartEntityMetadata::data_id_custom_display] = data_id_custom_display;
     }
 
 }
@@ -2,6 +2,23 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct BoatEntityMetadata
+    {
+        enum
+        {
+            data_id_hurt,
+            data_id_hurtdir,
+            data_id_damage,
+            data_id_type,
+            data_id_paddle_left,
+            data_id_paddle_right,
+#if PROTOCOL_VERSION > 340
+            data_id_bubble_time,
+#endif
+        };
+    };
+
     const std::array<std::string, BoatEntity::metadata_count> BoatEntity::metadata_names{ {
         "data_id_hurt",
         "data_id_hurtdir",
@@ -17,6 +34,7 @@ namespace Botcraft
     BoatEntity::BoatEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdHurt(0);
         SetDataIdHurtdir(1);
         SetDataIdDamage(0.0f);
@@ -92,82 +110,82 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     int BoatEntity::GetDataIdHurt() const
     {
-        return std::any_cast<int>(metadata.at("data_id_hurt"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_hurt]);
     }
 
     int BoatEntity::GetDataIdHurtdir() const
     {
-        return std::any_cast<int>(metadata.at("data_id_hurtdir"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_hurtdir]);
     }
 
     float BoatEntity::GetDataIdDamage() const
     {
-        return std::any_cast<float>(metadata.at("data_id_damage"));
+        return std::any_cast<float>(metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_damage]);
     }
 
     int BoatEntity::GetDataIdType() const
     {
-        return std::any_cast<int>(metadata.at("data_id_type"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_type]);
     }
 
     bool BoatEntity::GetDataIdPaddleLeft() const
     {
-        return std::any_cast<bool>(metadata.at("data_id_paddle_left"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_paddle_left]);
     }
 
     bool BoatEntity::GetDataIdPaddleRight() const
     {
-        return std::any_cast<bool>(metadata.at("data_id_paddle_right"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_paddle_right]);
     }
 
 #if PROTOCOL_VERSION > 340
     int BoatEntity::GetDataIdBubbleTime() const
     {
-        return std::any_cast<int>(metadata.at("data_id_bubble_time"));
+        return std::any_cast<int>(metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_bubble_time]);
     }
 #endif
 
 
     void BoatEntity::SetDataIdHurt(const int data_id_hurt)
     {
-        metadata["data_id_hurt"] = data_id_hurt;
+        metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_hurt] = data_id_hurt;
     }
 
     void BoatEntity::SetDataIdHurtdir(const int data_id_hurtdir)
     {
-        metadata["data_id_hurtdir"] = data_id_hurtdir;
+        metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_hurtdir] = data_id_hurtdir;
     }
 
     void BoatEntity::SetDataIdDamage(const float data_id_damage)
     {
-        metadata["data_id_damage"] = data_id_damage;
+        metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_damage] = data_id_damage;
     }
 
     void BoatEntity::SetDataIdType(const int data_id_type)
     {
-        metadata["data_id_type"] = data_id_type;
+        metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_type] = data_id_type;
     }
 
     void BoatEntity::SetDataIdPaddleLeft(const bool data_id_paddle_left)
     {
-        metadata["data_id_paddle_left"] = data_id_paddle_left;
+        metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_paddle_left] = data_id_paddle_left;
     }
 
     void BoatEntity::SetDataIdPaddleRight(const bool data_id_paddle_right)
     {
-        metadata["data_id_paddle_right"] = data_id_paddle_right;
+        metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_paddle_right] = data_id_paddle_right;
     }
 
 #if PROTOCOL_VERSION > 340
     void BoatEntity::SetDataIdBubbleTime(const int data_id_bubble_time)
     {
-        metadata["data_id_bubble_time"] = data_id_bubble_time;
+        metadata[hierarchy_metadata_count + BoatEntityMetadata::data_id_bubble_time] = data_id_bubble_time;
     }
 #endif
 
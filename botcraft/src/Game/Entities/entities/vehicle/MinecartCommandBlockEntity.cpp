@@ -2,6 +2,16 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct MinecartCommandBlockEntityMetadata
+    {
+        enum
+        {
+            data_id_command_name,
+            data_id_last_output,
+        };
+    };
+
     const std::array<std::string, MinecartCommandBlockEntity::metadata_count> MinecartCommandBlockEntity::metadata_names{ {
         "data_id_command_name",
         "data_id_last_output",
@@ -10,6 +20,7 @@ namespace Botcraft
     MinecartCommandBlockEntity::MinecartCommandBlockEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdCommandName("");
         SetDataIdLastOutput(ProtocolCraft::Chat());
     }
@@ -71,29 +82,29 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     const std::string& MinecartCommandBlockEntity::GetDataIdCommandName() const
     {
-        return std::any_cast<const std::string&>(metadata.at("data_id_command_name"));
+        return std::any_cast<const std::string&>(metadata[hierarchy_metadata_count + MinecartCommandBlockEntityMetadata::data_id_command_name]);
     }
 
     const ProtocolCraft::Chat& MinecartCommandBlockEntity::GetDataIdLastOutput() const
     {
-        return std::any_cast<const ProtocolCraft::Chat&>(metadata.at("data_id_last_output"));
+        return std::any_cast<const ProtocolCraft::Chat&>(GetMetadata(hierarchy_metadata_count + MinecartCommandBlockEntityMetadata::data_id_last_output));
     }
 
 
     void MinecartCommandBlockEntity::SetDataIdCommandName(const std::string& data_id_command_name)
     {
-        metadata["data_id_command_name"] = data_id_command_name;
+        metadata[hierarchy_metadata_count + MinecartCommandBlockEntityMetadata::data_id_command_name] = data_id_command_name;
     }
 
     void MinecartCommandBlockEntity::SetDataIdLastOutput(const ProtocolCraft::Chat& data_id_last_output)
     {
-        metadata["data_id_last_output"] = data_id_last_output;
+        metadata[hierarchy_metadata_count + MinecartCommandBlockEntityMetadata::data_id_last_output] = data_id_last_output;
     }
 
 }
@@ -2,6 +2,15 @@
 
 namespace Botcraft
 {
+    // Index of each metadata in metadata_names
+    struct MinecartFurnaceEntityMetadata
+    {
+        enum
+        {
+            data_id_fuel,
+        };
+    };
+
     const std::array<std::string, MinecartFurnaceEntity::metadata_count> MinecartFurnaceEntity::metadata_names{ {
         "data_id_fuel",
     } };
@@ -9,6 +18,7 @@ namespace Botcraft
     MinecartFurnaceEntity::MinecartFurnaceEntity()
     {
         // Initialize all metadata with default values
+        metadata.resize(hierarchy_metadata_count + metadata_count);
         SetDataIdFuel(false);
     }
 
@@ -68,19 +78,19 @@ namespace Botcraft
         }
         else if (index - hierarchy_metadata_count < metadata_count)
         {
-            metadata[metadata_names[index - hierarchy_metadata_count]] = value;
+            metadata[index] = value;
         }
     }
 
     bool MinecartFurnaceEntity::GetDataIdFuel() const
     {
-        return std::any_cast<bool>(metadata.at("data_id_fuel"));
+        return std::any_cast<bool>(metadata[hierarchy_metadata_count + MinecartFurnaceEntityMetadata::data_id_fuel]);
     }
 
 
     void MinecartFurnaceEntity::SetDataIdFuel(const bool data_id_fuel)
     {
-        metadata["data_id_fuel"] = data_id_fuel;
+        metadata[hierarchy_metadata_count + MinecartFurnaceEntityMetadata::data_id_fuel] = data_id_fuel;
     }
 
 }
@@ -0,0 +1,22 @@
+#include "botcraft/Game/EventNotifier.hpp"
+
+namespace Botcraft
+{
+    EventNotifier::EventNotifier()
+    {
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            counts[i] = 0;
+        }
+    }
+
+    void EventNotifier::Notify(const EventType type)
+    {
+        counts[static_cast<size_t>(type)].fetch_add(1, std::memory_order_release);
+    }
+
+    const unsigned long long EventNotifier::GetCount(const EventType type) const
+    {
+        return counts[static_cast<size_t>(type)].load(std::memory_order_acquire);
+    }
+} // Botcraft
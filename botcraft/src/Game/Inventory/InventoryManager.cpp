@@ -1,4 +1,7 @@
+#include <algorithm>
+
 #include "botcraft/Game/AssetsManager.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
 #include "botcraft/Game/Inventory/InventoryManager.hpp"
 #include "botcraft/Game/Inventory/Window.hpp"
 #include "botcraft/Utilities/Logger.hpp"
@@ -11,6 +14,15 @@ namespace Botcraft
     {
         index_hotbar_selected = 0;
         cursor = Slot();
+        has_next_container_position = false;
+#if PROTOCOL_VERSION < 755
+        transaction_sequence = 0;
+#endif
+#if PROTOCOL_VERSION > 451
+        trading_container_id = -1;
+        has_next_merchant = false;
+        has_trading_merchant = false;
+#endif
         inventories[Window::PLAYER_INVENTORY_INDEX] = std::make_shared<Window>(InventoryType::PlayerInventory);
     }
 
@@ -19,6 +31,41 @@ namespace Botcraft
         return inventory_manager_mutex;
     }
 
+    const EventNotifier& InventoryManager::GetEventNotifier() const
+    {
+        return event_notifier;
+    }
+
+    const unsigned long long InventoryManager::GetVersion() const
+    {
+        // All the modifications of the windows, the cursor
+        // and the selected slot are followed by one of these
+        return event_notifier.GetCount(EventType::WindowOpened) +
+            event_notifier.GetCount(EventType::WindowClosed) +
+            event_notifier.GetCount(EventType::InventoryChanged);
+    }
+
+    const InventorySnapshot InventoryManager::GetSnapshot()
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        // Notifications are sent with the mutex locked, so
+        // the version can't change while the copy is made
+        const unsigned long long version = GetVersion();
+        if (snapshot == nullptr || snapshot->epoch != version)
+        {
+            std::shared_ptr<InventorySnapshot::Data> new_snapshot = std::make_shared<InventorySnapshot::Data>();
+            new_snapshot->epoch = version;
+            for (auto it = inventories.begin(); it != inventories.end(); ++it)
+            {
+                new_snapshot->windows[it->first] = std::make_shared<const Window>(*it->second);
+            }
+            new_snapshot->index_hotbar_selected = index_hotbar_selected;
+            new_snapshot->cursor = cursor;
+            snapshot = new_snapshot;
+        }
+        return InventorySnapshot(snapshot);
+    }
+
     void InventoryManager::SetSlot(const short window_id, const short index, const Slot &slot)
     {
         auto it = inventories.find(window_id);
@@ -120,15 +167,20 @@ namespace Botcraft
         // when a container is closed, as the server does not send info
         SynchronizeContainerPlayerInventory(window_id);
 #endif
+        // Keep what we last saw in this container
+        RememberContainerContent(window_id);
+        container_positions.erase(window_id);
         inventories.erase(window_id);
 
 #if PROTOCOL_VERSION > 451
         if (window_id == trading_container_id)
         {
-            trading_container_id == -1;
+            trading_container_id = -1;
             available_trades.clear();
+            has_trading_merchant = false;
         }
 #endif
+        event_notifier.Notify(EventType::WindowClosed);
     }
 
 #if PROTOCOL_VERSION < 755
@@ -154,9 +206,84 @@ namespace Botcraft
         return it2->second;
     }
 
+    const bool InventoryManager::AddOptimisticTransaction(const InventoryTransaction& transaction)
+    {
+        std::lock_guard<std::mutex> inventory_manager_locker(inventory_manager_mutex);
+
+        std::shared_ptr<Window> window = GetWindow(transaction.msg->GetContainerId());
+        if (window == nullptr)
+        {
+            LOG_WARNING("Can't apply an optimistic transaction in a closed container");
+            return false;
+        }
+
+        InventoryTransaction optimistic_transaction = transaction;
+        optimistic_transaction.optimistic = true;
+        optimistic_transaction.previous_carried_item = cursor;
+        for (const auto& p : transaction.changed_slots)
+        {
+            optimistic_transaction.previous_slots[p.first] = window->GetSlot(p.first);
+        }
+
+        ApplyTransactionInternal(optimistic_transaction);
+        AddPendingTransaction(optimistic_transaction);
+        return true;
+    }
+
+    void InventoryManager::RollbackTransactions(const short window_id, const short uid)
+    {
+        auto container_transactions = pending_transactions.find(window_id);
+        if (container_transactions == pending_transactions.end())
+        {
+            return;
+        }
+
+        auto refused = container_transactions->second.find(uid);
+        if (refused == container_transactions->second.end())
+        {
+            return;
+        }
+        const unsigned long long refused_sequence = refused->second.sequence;
+
+        // Uids wrap around, use the sequence to find the transactions sent after this one
+        std::vector<std::map<short, InventoryTransaction>::iterator> rolled_back;
+        for (auto it = container_transactions->second.begin(); it != container_transactions->second.end(); ++it)
+        {
+            if (it->second.optimistic && it->second.sequence >= refused_sequence)
+            {
+                rolled_back.push_back(it);
+            }
+        }
+        // Undo the most recent first, so each transaction restores
+        // the state it was applied on
+        std::sort(rolled_back.begin(), rolled_back.end(), [](const std::map<short, InventoryTransaction>::iterator& a, const std::map<short, InventoryTransaction>::iterator& b)
+            {
+                return a->second.sequence > b->second.sequence;
+            });
+
+        std::shared_ptr<Window> window = GetWindow(window_id);
+        std::map<short, TransactionState>& states = transaction_states[window_id];
+        for (const auto& it : rolled_back)
+        {
+            if (window != nullptr)
+            {
+                for (const auto& p : it->second.previous_slots)
+                {
+                    window->SetSlot(p.first, p.second);
+                }
+            }
+            cursor = it->second.previous_carried_item;
+            states[it->first] = TransactionState::Refused;
+            container_transactions->second.erase(it);
+        }
+        event_notifier.Notify(EventType::InventoryChanged);
+    }
+
     void InventoryManager::AddPendingTransaction(const InventoryTransaction& transaction)
     {
-        pending_transactions[transaction.msg->GetContainerId()].insert(std::make_pair(transaction.msg->GetUid(), transaction));
+        InventoryTransaction pending_transaction = transaction;
+        pending_transaction.sequence = ++transaction_sequence;
+        pending_transactions[transaction.msg->GetContainerId()].insert(std::make_pair(transaction.msg->GetUid(), pending_transaction));
         transaction_states[transaction.msg->GetContainerId()].insert(std::make_pair(transaction.msg->GetUid(), TransactionState::Waiting));
 
         // Clean oldest transaction to avoid infinite growing map
@@ -222,6 +349,7 @@ namespace Botcraft
     void InventoryManager::SetHotbarSelected(const short index)
     {
         index_hotbar_selected = index;
+        event_notifier.Notify(EventType::InventoryChanged);
     }
 
     const Slot& InventoryManager::GetCursor() const
@@ -281,9 +409,9 @@ namespace Botcraft
             else if (!cursor.IsEmptySlot() &&
                 cursor.GetItemCount() + clicked_slot.GetItemCount() >
 #if PROTOCOL_VERSION < 347
-                AssetsManager::getInstance().Items().at(cursor.GetBlockID()).at(cursor.GetItemDamage())->GetStackSize()
+                AssetsManager::getInstance().GetItem(cursor.GetBlockID(), cursor.GetItemDamage())->GetStackSize()
 #else
-                AssetsManager::getInstance().Items().at(cursor.GetItemID())->GetStackSize()
+                AssetsManager::getInstance().GetItem(cursor.GetItemID())->GetStackSize()
 #endif
                 )
             {
@@ -362,9 +490,9 @@ namespace Botcraft
                             {
                                 const int sum_count = cursor.GetItemCount() + clicked_slot.GetItemCount();
 #if PROTOCOL_VERSION < 347
-                                const int max_stack_size = AssetsManager::getInstance().Items().at(cursor.GetBlockID()).at(cursor.GetItemDamage())->GetStackSize();
+                                const int max_stack_size = AssetsManager::getInstance().GetItem(cursor.GetBlockID(), cursor.GetItemDamage())->GetStackSize();
 #else
-                                const int max_stack_size = AssetsManager::getInstance().Items().at(cursor.GetItemID())->GetStackSize();
+                                const int max_stack_size = AssetsManager::getInstance().GetItem(cursor.GetItemID())->GetStackSize();
 #endif
                                 // The cursor becomes the clicked slot
                                 carried_item = clicked_slot;
@@ -412,9 +540,9 @@ namespace Botcraft
 #endif
                             {
 #if PROTOCOL_VERSION < 347
-                                const int max_stack_size = AssetsManager::getInstance().Items().at(cursor.GetBlockID()).at(cursor.GetItemDamage())->GetStackSize();
+                                const int max_stack_size = AssetsManager::getInstance().GetItem(cursor.GetBlockID(), cursor.GetItemDamage())->GetStackSize();
 #else
-                                const int max_stack_size = AssetsManager::getInstance().Items().at(cursor.GetItemID())->GetStackSize();
+                                const int max_stack_size = AssetsManager::getInstance().GetItem(cursor.GetItemID())->GetStackSize();
 #endif
                                 const bool transfer = clicked_slot.GetItemCount() < max_stack_size;
                                 // The cursor loses 1 item if possible
@@ -480,6 +608,7 @@ namespace Botcraft
         {
             window->SetSlot(p.first, p.second);
         }
+        event_notifier.Notify(EventType::InventoryChanged);
     }
 
     void InventoryManager::ApplyTransaction(const InventoryTransaction& transaction)
@@ -488,6 +617,108 @@ namespace Botcraft
         ApplyTransactionInternal(transaction);
     }
 
+    void InventoryManager::SetNextContainerPosition(const Position& pos)
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        next_container_position = pos;
+        has_next_container_position = true;
+    }
+
+    const std::unordered_map<Position, std::map<short, Slot> >& InventoryManager::GetKnownContainers() const
+    {
+        return known_containers;
+    }
+
+#if PROTOCOL_VERSION < 350
+    const std::vector<Position> InventoryManager::GetKnownContainersWithItem(const short block_id, const short item_damage) const
+#else
+    const std::vector<Position> InventoryManager::GetKnownContainersWithItem(const short item_id) const
+#endif
+    {
+        std::vector<std::pair<int, Position> > found;
+        for (const auto& c : known_containers)
+        {
+            int count = 0;
+            for (const auto& s : c.second)
+            {
+#if PROTOCOL_VERSION < 350
+                if (s.second.GetBlockID() == block_id && s.second.GetItemDamage() == item_damage)
+#else
+                if (s.second.GetItemID() == item_id)
+#endif
+                {
+                    count += s.second.GetItemCount();
+                }
+            }
+            if (count > 0)
+            {
+                found.push_back({ count, c.first });
+            }
+        }
+        std::sort(found.begin(), found.end(), [](const std::pair<int, Position>& a, const std::pair<int, Position>& b) { return a.first > b.first; });
+
+        std::vector<Position> output;
+        output.reserve(found.size());
+        for (const auto& f : found)
+        {
+            output.push_back(f.second);
+        }
+        return output;
+    }
+
+    void InventoryManager::ForgetContainer(const Position& pos)
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        known_containers.erase(pos);
+    }
+
+    void InventoryManager::SetKnownContainer(const Position& pos, const std::map<short, Slot>& content)
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        known_containers[pos] = content;
+    }
+
+    void InventoryManager::RememberContainerContent(const short window_id)
+    {
+        auto position_it = container_positions.find(window_id);
+        auto window_it = inventories.find(window_id);
+        if (position_it == container_positions.end() || window_it == inventories.end())
+        {
+            return;
+        }
+
+        std::map<short, Slot>& content = known_containers[position_it->second];
+        content.clear();
+        const std::vector<Slot>& slots = window_it->second->GetSlots();
+        const short first_player_slot = std::min(window_it->second->GetFirstPlayerInventorySlot(), static_cast<short>(slots.size()));
+        for (short i = 0; i < first_player_slot; ++i)
+        {
+            content.insert({ i, slots[i] });
+        }
+    }
+
+    void InventoryManager::InvalidateContainersAround(const Position& pos)
+    {
+        if (known_containers.empty())
+        {
+            return;
+        }
+        known_containers.erase(pos);
+        known_containers.erase(pos + Position(1, 0, 0));
+        known_containers.erase(pos + Position(-1, 0, 0));
+        known_containers.erase(pos + Position(0, 1, 0));
+        known_containers.erase(pos + Position(0, -1, 0));
+        known_containers.erase(pos + Position(0, 0, 1));
+        known_containers.erase(pos + Position(0, 0, -1));
+    }
+
+#if PROTOCOL_VERSION > 347
+    const RecipeBook& InventoryManager::GetRecipeBook() const
+    {
+        return recipe_book;
+    }
+#endif
+
 #if PROTOCOL_VERSION > 451
     const std::vector<ProtocolCraft::Trade>& InventoryManager::GetAvailableTrades() const
     {
@@ -498,6 +729,52 @@ namespace Botcraft
     {
         return available_trades[index];
     }
+
+    void InventoryManager::UseAvailableTrade(const int index)
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        if (index < 0 || index >= available_trades.size())
+        {
+            return;
+        }
+        ProtocolCraft::Trade& trade = available_trades[index];
+        trade.SetNumberOfTradesUses(trade.GetNumberOfTradesUses() + 1);
+
+        if (!has_trading_merchant)
+        {
+            return;
+        }
+        auto it = known_merchants.find(trading_merchant);
+        if (it != known_merchants.end() && index < it->second.offers.size())
+        {
+            it->second.offers[index] = trade;
+            it->second.update_time = VirtualClock::now();
+        }
+    }
+
+    void InventoryManager::SetNextMerchant(const ProtocolCraft::UUID& uuid)
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        next_merchant = uuid;
+        has_next_merchant = true;
+    }
+
+    const std::map<ProtocolCraft::UUID, MerchantOffers>& InventoryManager::GetKnownMerchants() const
+    {
+        return known_merchants;
+    }
+
+    void InventoryManager::ForgetMerchant(const ProtocolCraft::UUID& uuid)
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        known_merchants.erase(uuid);
+    }
+
+    void InventoryManager::SetKnownMerchant(const ProtocolCraft::UUID& uuid, const MerchantOffers& offers)
+    {
+        std::lock_guard<std::mutex> inventory_lock(inventory_manager_mutex);
+        known_merchants[uuid] = offers;
+    }
 #endif
 
     void InventoryManager::Handle(ProtocolCraft::Message& msg)
@@ -531,11 +808,14 @@ namespace Botcraft
 #if PROTOCOL_VERSION > 755
             SetStateId(msg.GetContainerId(), msg.GetStateId());
 #endif
+            RememberContainerContent(msg.GetContainerId());
         }
         else
         {
             LOG_WARNING("Unknown window called during ClientboundContainerSetSlotPacket Handle : " << msg.GetContainerId() << ", " << msg.GetSlot());
+            return;
         }
+        event_notifier.Notify(EventType::InventoryChanged);
     }
 
     void InventoryManager::Handle(ProtocolCraft::ClientboundContainerSetContentPacket& msg)
@@ -552,6 +832,8 @@ namespace Botcraft
             SetStateId(msg.GetContainerId(), msg.GetStateId());
         }
 #endif
+        RememberContainerContent(msg.GetContainerId());
+        event_notifier.Notify(EventType::InventoryChanged);
     }
 
     void InventoryManager::Handle(ProtocolCraft::ClientboundOpenScreenPacket& msg)
@@ -582,6 +864,16 @@ namespace Botcraft
 #else
         AddInventory(msg.GetContainerId(), static_cast<InventoryType>(msg.GetType()));
 #endif
+        if (has_next_container_position)
+        {
+            container_positions[msg.GetContainerId()] = next_container_position;
+            has_next_container_position = false;
+        }
+        else
+        {
+            container_positions.erase(msg.GetContainerId());
+        }
+        event_notifier.Notify(EventType::WindowOpened);
     }
 
     void InventoryManager::Handle(ProtocolCraft::ClientboundSetCarriedItemPacket& msg)
@@ -603,6 +895,7 @@ namespace Botcraft
             it_container = transaction_states.find(msg.GetContainerId());
         }
         it_container->second[msg.GetUid()] = msg.GetAccepted() ? TransactionState::Accepted : TransactionState::Refused;
+        event_notifier.Notify(EventType::TransactionUpdated);
 
         auto container_transactions = pending_transactions.find(msg.GetContainerId());
 
@@ -621,7 +914,16 @@ namespace Botcraft
             return;
         }
 
-        if (msg.GetAccepted())
+        if (transaction->second.optimistic)
+        {
+            // Already applied when sent, only undo it if refused
+            if (!msg.GetAccepted())
+            {
+                RollbackTransactions(msg.GetContainerId(), msg.GetUid());
+                return;
+            }
+        }
+        else if (msg.GetAccepted())
         {
             ApplyTransactionInternal(transaction->second);
         }
@@ -637,6 +939,30 @@ namespace Botcraft
         std::lock_guard<std::mutex> inventory_manager_locker(inventory_manager_mutex);
         trading_container_id = msg.GetContainerId();
         available_trades = msg.GetOffers();
+
+        // Offers are sent again each time the window is opened, and after
+        // each trade, so the known offers follow the restocks and stock-outs
+        if (has_next_merchant)
+        {
+            trading_merchant = next_merchant;
+            has_trading_merchant = true;
+            has_next_merchant = false;
+        }
+        if (has_trading_merchant)
+        {
+            MerchantOffers& known_offers = known_merchants[trading_merchant];
+            known_offers.offers = available_trades;
+            known_offers.can_restock = msg.GetCanRestock();
+            known_offers.update_time = VirtualClock::now();
+        }
+    }
+#endif
+
+#if PROTOCOL_VERSION > 347
+    void InventoryManager::Handle(ProtocolCraft::ClientboundUpdateRecipesPacket& msg)
+    {
+        std::lock_guard<std::mutex> inventory_manager_locker(inventory_manager_mutex);
+        recipe_book.LoadRecipes(msg.GetRecipes());
     }
 #endif
 
@@ -645,4 +971,63 @@ namespace Botcraft
         EraseInventory(msg.GetContainerId());
     }
 
+    void InventoryManager::Handle(ProtocolCraft::ClientboundBlockUpdatePacket& msg)
+    {
+        std::lock_guard<std::mutex> inventory_manager_locker(inventory_manager_mutex);
+        InvalidateContainersAround(msg.GetPos());
+    }
+
+    void InventoryManager::Handle(ProtocolCraft::ClientboundSectionBlocksUpdatePacket& msg)
+    {
+        std::lock_guard<std::mutex> inventory_manager_locker(inventory_manager_mutex);
+        if (known_containers.empty())
+        {
+            return;
+        }
+#if PROTOCOL_VERSION < 739
+        for (int i = 0; i < msg.GetRecordCount(); ++i)
+        {
+            InvalidateContainersAround(Position(
+                msg.GetChunkX() * CHUNK_WIDTH + ((msg.GetRecords()[i].GetHorizontalPosition() >> 4) & 0x0F),
+                msg.GetRecords()[i].GetYCoordinate(),
+                msg.GetChunkZ() * CHUNK_WIDTH + (msg.GetRecords()[i].GetHorizontalPosition() & 0x0F)
+            ));
+        }
+#else
+        const int chunk_x = static_cast<int>(msg.GetSectionPos() >> 42); // 22 bits
+        const int chunk_z = static_cast<int>(msg.GetSectionPos() << 22 >> 42); // 22 bits
+        const int chunk_y = SECTION_HEIGHT * static_cast<int>(msg.GetSectionPos() << 44 >> 44); // 20 bits
+        for (size_t i = 0; i < msg.GetPositions().size(); ++i)
+        {
+            InvalidateContainersAround(Position(
+                chunk_x * CHUNK_WIDTH + ((msg.GetPositions()[i] >> 8) & 0xF),
+                chunk_y + (msg.GetPositions()[i] & 0xF),
+                chunk_z * CHUNK_WIDTH + ((msg.GetPositions()[i] >> 4) & 0xF)
+            ));
+        }
+#endif
+    }
+
+    void InventoryManager::Handle(ProtocolCraft::ClientboundBlockEventPacket& msg)
+    {
+        // For chests and shulker boxes, action 1 is sent with the number
+        // of players viewing it. If someone else is looking, the content
+        // can change without us knowing
+        if (msg.GetB0() != 1)
+        {
+            return;
+        }
+        const Position pos = msg.GetPos();
+        std::lock_guard<std::mutex> inventory_manager_locker(inventory_manager_mutex);
+        int our_viewers = 0;
+        for (const auto& p : container_positions)
+        {
+            our_viewers += p.second == pos;
+        }
+        if (msg.GetB1() > our_viewers)
+        {
+            known_containers.erase(pos);
+        }
+    }
+
 } //Botcraft
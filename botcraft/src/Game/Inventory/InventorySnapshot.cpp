@@ -0,0 +1,85 @@
+#include "botcraft/Game/Inventory/InventorySnapshot.hpp"
+#include "botcraft/Game/Inventory/Window.hpp"
+
+namespace Botcraft
+{
+    InventorySnapshot::InventorySnapshot(const std::shared_ptr<const Data>& data_)
+    {
+        if (data_)
+        {
+            data = data_;
+        }
+        else
+        {
+            data = std::make_shared<Data>();
+        }
+    }
+
+    const unsigned long long InventorySnapshot::GetEpoch() const
+    {
+        return data->epoch;
+    }
+
+    const std::shared_ptr<const Window> InventorySnapshot::GetWindow(const short window_id) const
+    {
+        auto it = data->windows.find(window_id);
+        if (it == data->windows.end())
+        {
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    const std::shared_ptr<const Window> InventorySnapshot::GetPlayerInventory() const
+    {
+        return GetWindow(Window::PLAYER_INVENTORY_INDEX);
+    }
+
+    const short InventorySnapshot::GetFirstOpenedWindowId() const
+    {
+        for (auto it = data->windows.begin(); it != data->windows.end(); ++it)
+        {
+            if (it->first != Window::PLAYER_INVENTORY_INDEX &&
+                it->second->GetSlots().size() > 0)
+            {
+                return it->first;
+            }
+        }
+
+        return -1;
+    }
+
+    const short InventorySnapshot::GetIndexHotbarSelected() const
+    {
+        return data->index_hotbar_selected;
+    }
+
+    const ProtocolCraft::Slot& InventorySnapshot::GetHotbarSelected() const
+    {
+        const std::shared_ptr<const Window> inventory = GetPlayerInventory();
+
+        if (!inventory)
+        {
+            return Window::EMPTY_SLOT;
+        }
+
+        return inventory->GetSlot(Window::INVENTORY_HOTBAR_START + data->index_hotbar_selected);
+    }
+
+    const ProtocolCraft::Slot& InventorySnapshot::GetOffHand() const
+    {
+        const std::shared_ptr<const Window> inventory = GetPlayerInventory();
+
+        if (!inventory)
+        {
+            return Window::EMPTY_SLOT;
+        }
+
+        return inventory->GetSlot(Window::INVENTORY_OFFHAND_INDEX);
+    }
+
+    const ProtocolCraft::Slot& InventorySnapshot::GetCursor() const
+    {
+        return data->cursor;
+    }
+} // Botcraft
@@ -0,0 +1,302 @@
+#if PROTOCOL_VERSION > 347
+#include <algorithm>
+#include <limits>
+
+#include "botcraft/Game/Inventory/RecipeBook.hpp"
+
+#include "protocolCraft/Types/Recipes/RecipeTypeDataShaped.hpp"
+#include "protocolCraft/Types/Recipes/RecipeTypeDataShapeless.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+    // Cost of items that can't be crafted because of a cycle
+    static constexpr int infinite_cost = std::numeric_limits<int>::max() / 2;
+    // Maximum number of nested crafts explored by the solver
+    static constexpr size_t max_plan_depth = 8;
+
+    static std::vector<int> GetIngredientItems(const Ingredient& ingredient)
+    {
+        std::vector<int> output;
+        for (const auto& s : ingredient.GeItems())
+        {
+            if (!s.IsEmptySlot())
+            {
+                output.push_back(s.GetItemID());
+            }
+        }
+        return output;
+    }
+
+    void RecipeBook::LoadRecipes(const std::vector<Recipe>& recipes_)
+    {
+        recipes.clear();
+        costs.clear();
+
+        for (const auto& r : recipes_)
+        {
+            CraftingRecipe recipe;
+            if (r.GetType().GetName() == "crafting_shaped")
+            {
+                const std::shared_ptr<RecipeTypeDataShaped> data = std::static_pointer_cast<RecipeTypeDataShaped>(r.GetData());
+                recipe.output_id = data->GetResult().GetItemID();
+                recipe.output_count = data->GetResult().GetItemCount();
+                recipe.width = data->GetWidth();
+                recipe.height = data->GetHeight();
+                for (const auto& ingredient : data->GetIngredients())
+                {
+                    recipe.ingredients.push_back(GetIngredientItems(ingredient));
+                }
+            }
+            else if (r.GetType().GetName() == "crafting_shapeless")
+            {
+                const std::shared_ptr<RecipeTypeDataShapeless> data = std::static_pointer_cast<RecipeTypeDataShapeless>(r.GetData());
+                recipe.output_id = data->GetResult().GetItemID();
+                recipe.output_count = data->GetResult().GetItemCount();
+                const int num_ingredients = static_cast<int>(data->GetIngredients().size());
+                // Use a 2x2 grid if possible so it can be crafted in the inventory
+                recipe.width = num_ingredients > 4 ? 3 : std::min(2, num_ingredients);
+                recipe.height = recipe.width == 0 ? 0 : (num_ingredients + recipe.width - 1) / recipe.width;
+                for (const auto& ingredient : data->GetIngredients())
+                {
+                    recipe.ingredients.push_back(GetIngredientItems(ingredient));
+                }
+                recipe.ingredients.resize(recipe.width * recipe.height);
+            }
+            else
+            {
+                continue;
+            }
+
+            if (recipe.output_id < 0 || recipe.width > 3 || recipe.height > 3 || recipe.output_count < 1)
+            {
+                continue;
+            }
+            recipes[recipe.output_id].push_back(recipe);
+        }
+
+        // Sort the recipes of each item, cheapest first
+        std::unordered_set<int> visiting;
+        for (const auto& p : recipes)
+        {
+            ComputeCost(p.first, visiting);
+        }
+        for (auto& p : recipes)
+        {
+            std::vector<std::pair<int, size_t> > recipe_costs(p.second.size());
+            for (size_t i = 0; i < p.second.size(); ++i)
+            {
+                int cost = 1;
+                for (const auto& cell : p.second[i].ingredients)
+                {
+                    int cell_cost = cell.empty() ? 0 : infinite_cost;
+                    for (const int id : cell)
+                    {
+                        cell_cost = std::min(cell_cost, ComputeCost(id, visiting));
+                    }
+                    cost = std::min(infinite_cost, cost + cell_cost);
+                }
+                recipe_costs[i] = { cost, i };
+            }
+            std::stable_sort(recipe_costs.begin(), recipe_costs.end());
+
+            std::vector<CraftingRecipe> sorted;
+            sorted.reserve(p.second.size());
+            for (const auto& c : recipe_costs)
+            {
+                sorted.push_back(p.second[c.second]);
+            }
+            p.second = std::move(sorted);
+        }
+    }
+
+    const std::vector<CraftingRecipe>& RecipeBook::GetRecipes(const int item_id) const
+    {
+        static const std::vector<CraftingRecipe> empty;
+        auto it = recipes.find(item_id);
+        if (it == recipes.end())
+        {
+            return empty;
+        }
+        return it->second;
+    }
+
+    const bool RecipeBook::ComputePlan(const int item_id, const int quantity, std::unordered_map<int, int>& available,
+        const bool allow_crafting_table, std::vector<CraftingStep>& plan) const
+    {
+        std::unordered_map<int, int> available_copy = available;
+        std::vector<CraftingStep> plan_copy = plan;
+        std::unordered_set<int> visiting;
+        if (!Solve(item_id, quantity, available_copy, allow_crafting_table, plan_copy, visiting))
+        {
+            return false;
+        }
+        available = available_copy;
+        plan = plan_copy;
+        return true;
+    }
+
+    const int RecipeBook::ComputeCost(const int item_id, std::unordered_set<int>& visiting)
+    {
+        auto it = costs.find(item_id);
+        if (it != costs.end())
+        {
+            return it->second;
+        }
+
+        auto it_recipes = recipes.find(item_id);
+        if (it_recipes == recipes.end())
+        {
+            costs[item_id] = 0;
+            return 0;
+        }
+
+        if (visiting.find(item_id) != visiting.end())
+        {
+            return infinite_cost;
+        }
+
+        visiting.insert(item_id);
+        int best = infinite_cost;
+        for (const auto& r : it_recipes->second)
+        {
+            int cost = 1;
+            for (const auto& cell : r.ingredients)
+            {
+                int cell_cost = cell.empty() ? 0 : infinite_cost;
+                for (const int id : cell)
+                {
+                    cell_cost = std::min(cell_cost, ComputeCost(id, visiting));
+                }
+                cost = std::min(infinite_cost, cost + cell_cost);
+            }
+            best = std::min(best, cost);
+        }
+        visiting.erase(item_id);
+
+        costs[item_id] = best;
+        return best;
+    }
+
+    const bool RecipeBook::Solve(const int item_id, const int quantity, std::unordered_map<int, int>& available,
+        const bool allow_crafting_table, std::vector<CraftingStep>& plan, std::unordered_set<int>& visiting) const
+    {
+        // Use what we already have first
+        int& available_quantity = available[item_id];
+        const int used = std::min(available_quantity, quantity);
+        available_quantity -= used;
+        const int missing = quantity - used;
+        if (missing == 0)
+        {
+            return true;
+        }
+
+        if (visiting.size() >= max_plan_depth || visiting.find(item_id) != visiting.end())
+        {
+            available[item_id] += used;
+            return false;
+        }
+
+        visiting.insert(item_id);
+        for (const auto& r : GetRecipes(item_id))
+        {
+            const bool needs_crafting_table = r.width > 2 || r.height > 2;
+            if (needs_crafting_table && !allow_crafting_table)
+            {
+                continue;
+            }
+
+            const int num_crafts = (missing + r.output_count - 1) / r.output_count;
+            const std::unordered_map<int, int> saved_available = available;
+            const size_t saved_plan_size = plan.size();
+
+            CraftingStep step;
+            step.count = num_crafts;
+            step.needs_crafting_table = needs_crafting_table;
+            for (auto& row : step.inputs)
+            {
+                row.fill(-1);
+            }
+
+            // Cells with the same ingredient are solved together,
+            // so a missing intermediate item is crafted in one step
+            std::vector<std::pair<const std::vector<int>*, std::vector<size_t> > > groups;
+            for (size_t i = 0; i < r.ingredients.size(); ++i)
+            {
+                if (r.ingredients[i].empty())
+                {
+                    continue;
+                }
+                auto it = std::find_if(groups.begin(), groups.end(), [&](const auto& g) { return *g.first == r.ingredients[i]; });
+                if (it == groups.end())
+                {
+                    groups.push_back({ &r.ingredients[i], { i } });
+                }
+                else
+                {
+                    it->second.push_back(i);
+                }
+            }
+
+            bool success = true;
+            for (size_t g = 0; g < groups.size() && success; ++g)
+            {
+                const int needed = num_crafts * static_cast<int>(groups[g].second.size());
+
+                // Try the alternatives we have first, then the cheapest to craft
+                std::vector<int> alternatives = *groups[g].first;
+                std::stable_sort(alternatives.begin(), alternatives.end(), [&](const int a, const int b)
+                    {
+                        auto it_a = available.find(a);
+                        auto it_b = available.find(b);
+                        const bool enough_a = it_a != available.end() && it_a->second >= needed;
+                        const bool enough_b = it_b != available.end() && it_b->second >= needed;
+                        if (enough_a != enough_b)
+                        {
+                            return enough_a;
+                        }
+                        auto cost_a = costs.find(a);
+                        auto cost_b = costs.find(b);
+                        return (cost_a == costs.end() ? 0 : cost_a->second) < (cost_b == costs.end() ? 0 : cost_b->second);
+                    });
+
+                success = false;
+                for (const int alternative : alternatives)
+                {
+                    const std::unordered_map<int, int> group_saved_available = available;
+                    const size_t group_saved_plan_size = plan.size();
+                    if (Solve(alternative, needed, available, allow_crafting_table, plan, visiting))
+                    {
+                        for (const size_t i : groups[g].second)
+                        {
+                            step.inputs[i / r.width][i % r.width] = alternative;
+                        }
+                        success = true;
+                        break;
+                    }
+                    available = group_saved_available;
+                    plan.resize(group_saved_plan_size);
+                }
+            }
+
+            if (success)
+            {
+                step.recipe = &r;
+                plan.push_back(step);
+                // Keep the leftovers for the next steps
+                available[item_id] += num_crafts * r.output_count - missing;
+                visiting.erase(item_id);
+                return true;
+            }
+
+            available = saved_available;
+            plan.resize(saved_plan_size);
+        }
+        visiting.erase(item_id);
+
+        available[item_id] += used;
+        return false;
+    }
+} // Botcraft
+#endif
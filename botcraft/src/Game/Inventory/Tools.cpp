@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "botcraft/Game/Inventory/Tools.hpp"
+#include "botcraft/Game/AssetsManager.hpp"
+#include "botcraft/Game/World/Blockstate.hpp"
+
+#include "protocolCraft/Types/NBT/FlatNBT.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+    // Best tool for a block, and the minimum tool
+    // needed to get drops (None if it drops anyway)
+    struct BlockToolRequirement
+    {
+        ToolType tool = ToolType::None;
+        ToolMaterial harvest_material = ToolMaterial::None;
+        bool requires_tool = false;
+    };
+
+    static bool Contains(const std::string& s, const char* sub)
+    {
+        return s.find(sub) != std::string::npos;
+    }
+
+    static bool ContainsAny(const std::string& s, const std::vector<const char*>& subs)
+    {
+        for (const char* sub : subs)
+        {
+            if (Contains(s, sub))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static BlockToolRequirement GetBlockToolRequirement(const std::string& name)
+    {
+        BlockToolRequirement output;
+
+        if (Contains(name, "cobweb") || name == "minecraft:web")
+        {
+            output.tool = ToolType::Sword;
+            output.requires_tool = true;
+            return output;
+        }
+
+        if (Contains(name, "wool"))
+        {
+            output.tool = ToolType::Shears;
+            return output;
+        }
+
+        if (Contains(name, "leaves"))
+        {
+            output.tool = ToolType::Hoe;
+            return output;
+        }
+
+        // Pickaxe blocks, all of them need at least a wooden pickaxe to drop
+        static const std::vector<const char*> pickaxe_exceptions = {
+            "glowstone", "redstone_wire", "redstone_torch", "redstone_wall_torch", "redstone_lamp", "_button", "concrete_powder",
+            "jack_o_lantern", "sea_lantern"
+        };
+        static const std::vector<const char*> pickaxe_blocks = {
+            "stone", "cobble", "_ore", "brick", "obsidian", "deepslate", "terracotta", "concrete", "andesite", "granite",
+            "diorite", "netherrack", "prismarine", "purpur", "quartz", "basalt", "tuff", "calcite", "amethyst",
+            "copper", "iron_", "gold_block", "diamond_block", "emerald_block", "lapis_block", "redstone_block",
+            "coal_block", "netherite_block", "ancient_debris", "respawn_anchor", "furnace", "dispenser", "dropper",
+            "observer", "anvil", "cauldron", "hopper", "spawner", "enchanting_table", "ender_chest", "magma_block",
+            "lantern", "chain", "bell", "stonecutter", "grindstone", "lodestone", "conduit", "dripstone"
+        };
+        if (ContainsAny(name, pickaxe_blocks) && !ContainsAny(name, pickaxe_exceptions))
+        {
+            output.tool = ToolType::Pickaxe;
+            output.requires_tool = true;
+            if (ContainsAny(name, { "obsidian", "netherite_block", "ancient_debris", "respawn_anchor" }))
+            {
+                output.harvest_material = ToolMaterial::Diamond;
+            }
+            else if (ContainsAny(name, { "diamond_ore", "diamond_block", "emerald_", "redstone_ore" }) ||
+                (ContainsAny(name, { "gold_ore", "gold_block" }) && !Contains(name, "nether_gold_ore")))
+            {
+                output.harvest_material = ToolMaterial::Iron;
+            }
+            else if (ContainsAny(name, { "iron_ore", "iron_block", "lapis_", "copper_ore", "raw_copper_block" }))
+            {
+                output.harvest_material = ToolMaterial::Stone;
+            }
+            else
+            {
+                output.harvest_material = ToolMaterial::Wood;
+            }
+            return output;
+        }
+
+        static const std::vector<const char*> shovel_blocks = {
+            "dirt", "grass_block", "sand", "gravel", "clay", "soul_soil", "mycelium", "podzol", "farmland", "path", "mud", "concrete_powder"
+        };
+        if (name == "minecraft:snow" || name == "minecraft:snow_block" || name == "minecraft:snow_layer")
+        {
+            output.tool = ToolType::Shovel;
+            output.harvest_material = ToolMaterial::Wood;
+            output.requires_tool = true;
+            return output;
+        }
+        // Grass block is "minecraft:grass" before 1.13
+        if (ContainsAny(name, shovel_blocks) || name == "minecraft:grass")
+        {
+            output.tool = ToolType::Shovel;
+            return output;
+        }
+
+        static const std::vector<const char*> axe_blocks = {
+            "log", "wood", "planks", "_stem", "hyphae", "chest", "crafting_table", "bookshelf", "barrel", "ladder", "sign",
+            "pumpkin", "melon", "campfire", "note_block", "noteblock", "jukebox", "lectern", "composter", "loom", "_table", "bee"
+        };
+        if (ContainsAny(name, axe_blocks))
+        {
+            output.tool = ToolType::Axe;
+            return output;
+        }
+
+        static const std::vector<const char*> hoe_blocks = {
+            "hay_block", "sponge", "wart_block", "sculk", "moss", "target", "shroomlight"
+        };
+        if (ContainsAny(name, hoe_blocks))
+        {
+            output.tool = ToolType::Hoe;
+            return output;
+        }
+
+        return output;
+    }
+
+    static float GetToolSpeed(const ToolInfo& tool, const std::string& block_name, const BlockToolRequirement& requirement)
+    {
+        if (tool.type == ToolType::Shears)
+        {
+            if (requirement.tool == ToolType::Sword || Contains(block_name, "leaves"))
+            {
+                return 15.0f;
+            }
+            return Contains(block_name, "wool") ? 5.0f : 1.0f;
+        }
+
+        if (tool.type == ToolType::Sword)
+        {
+            return requirement.tool == ToolType::Sword ? 15.0f : 1.0f;
+        }
+
+        if (tool.type == ToolType::None || tool.type != requirement.tool)
+        {
+            return 1.0f;
+        }
+
+        switch (tool.material)
+        {
+        case ToolMaterial::Wood:
+            return 2.0f;
+        case ToolMaterial::Stone:
+            return 4.0f;
+        case ToolMaterial::Iron:
+            return 6.0f;
+        case ToolMaterial::Diamond:
+            return 8.0f;
+        case ToolMaterial::Netherite:
+            return 9.0f;
+        case ToolMaterial::Gold:
+            return 12.0f;
+        default:
+            return 1.0f;
+        }
+    }
+
+    static bool CanHarvest(const ToolInfo& tool, const BlockToolRequirement& requirement)
+    {
+        if (!requirement.requires_tool)
+        {
+            return true;
+        }
+        // Cobweb can be harvested with shears too
+        if (requirement.tool == ToolType::Sword)
+        {
+            return tool.type == ToolType::Sword || tool.type == ToolType::Shears;
+        }
+        if (tool.type != requirement.tool)
+        {
+            return false;
+        }
+        return static_cast<int>(tool.material) >= static_cast<int>(requirement.harvest_material);
+    }
+
+    const ToolInfo GetToolInfo(const std::string& item_name)
+    {
+        ToolInfo output;
+
+        if (item_name == "minecraft:shears")
+        {
+            output.type = ToolType::Shears;
+            return output;
+        }
+
+        static const std::array<std::pair<const char*, ToolType>, 5> types = { {
+            { "_pickaxe", ToolType::Pickaxe },
+            { "_axe", ToolType::Axe },
+            { "_shovel", ToolType::Shovel },
+            { "_hoe", ToolType::Hoe },
+            { "_sword", ToolType::Sword }
+        } };
+        for (const auto& t : types)
+        {
+            if (Contains(item_name, t.first))
+            {
+                output.type = t.second;
+                break;
+            }
+        }
+        if (output.type == ToolType::None)
+        {
+            return output;
+        }
+
+        static const std::array<std::pair<const char*, ToolMaterial>, 6> materials = { {
+            { "wooden_", ToolMaterial::Wood },
+            { "stone_", ToolMaterial::Stone },
+            { "iron_", ToolMaterial::Iron },
+            { "golden_", ToolMaterial::Gold },
+            { "diamond_", ToolMaterial::Diamond },
+            { "netherite_", ToolMaterial::Netherite }
+        } };
+        for (const auto& m : materials)
+        {
+            if (Contains(item_name, m.first))
+            {
+                output.material = m.second;
+                break;
+            }
+        }
+        // Unknown material, don't guess
+        if (output.material == ToolMaterial::None)
+        {
+            output.type = ToolType::None;
+        }
+
+        return output;
+    }
+
+    const ToolInfo GetToolInfo(const Slot& slot)
+    {
+        if (slot.IsEmptySlot())
+        {
+            return ToolInfo();
+        }
+#if PROTOCOL_VERSION < 350
+        return GetToolInfo(AssetsManager::getInstance().GetItem(slot.GetBlockID(), static_cast<unsigned char>(slot.GetItemDamage()))->GetName());
+#else
+        return GetToolInfo(AssetsManager::getInstance().GetItem(slot.GetItemID())->GetName());
+#endif
+    }
+
+    const int GetEfficiencyLevel(const Slot& slot)
+    {
+        if (slot.IsEmptySlot() || !slot.GetNBT().HasData())
+        {
+            return 0;
+        }
+
+#if PROTOCOL_VERSION < 347
+        const FlatTag enchantments = slot.GetNBT().GetFlatTag("ench");
+#else
+        const FlatTag enchantments = slot.GetNBT().GetFlatTag("Enchantments");
+#endif
+        if (enchantments.GetType() != TagType::List)
+        {
+            return 0;
+        }
+
+        for (const FlatTag enchantment : enchantments)
+        {
+            if (enchantment.GetType() != TagType::Compound)
+            {
+                continue;
+            }
+            const FlatTag id = enchantment.GetChild("id");
+            const FlatTag lvl = enchantment.GetChild("lvl");
+#if PROTOCOL_VERSION < 347
+            // Efficiency numerical id
+            if (id.GetType() != TagType::Short || id.GetShort() != 32)
+            {
+                continue;
+            }
+#else
+            if (id.GetType() != TagType::String || !(id.GetString() == "minecraft:efficiency"))
+            {
+                continue;
+            }
+#endif
+            if (lvl.GetType() == TagType::Short)
+            {
+                return lvl.GetShort();
+            }
+            if (lvl.GetType() == TagType::Int)
+            {
+                return lvl.GetInt();
+            }
+        }
+
+        return 0;
+    }
+
+    DigTimeTable& DigTimeTable::GetInstance()
+    {
+        static DigTimeTable instance;
+        return instance;
+    }
+
+    const float DigTimeTable::GetMiningTime(const Blockstate* blockstate, const ToolInfo& tool, const int efficiency,
+        const int haste, const int mining_fatigue, const bool on_ground)
+    {
+        const Key key{ blockstate, tool, efficiency, haste, mining_fatigue, on_ground };
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = mining_times.find(key);
+            if (it != mining_times.end())
+            {
+                return it->second;
+            }
+        }
+
+        const float mining_time = ComputeMiningTime(key);
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        mining_times[key] = mining_time;
+        return mining_time;
+    }
+
+    bool DigTimeTable::Key::operator==(const Key& other) const
+    {
+        return blockstate == other.blockstate &&
+            tool.type == other.tool.type &&
+            tool.material == other.tool.material &&
+            efficiency == other.efficiency &&
+            haste == other.haste &&
+            mining_fatigue == other.mining_fatigue &&
+            on_ground == other.on_ground;
+    }
+
+    size_t DigTimeTable::KeyHasher::operator()(const Key& k) const
+    {
+        size_t value = static_cast<size_t>(k.tool.type);
+        value = value * 8 + static_cast<size_t>(k.tool.material);
+        value = value * 16 + static_cast<size_t>(k.efficiency & 0xF);
+        value = value * 8 + static_cast<size_t>(k.haste & 0x7);
+        value = value * 8 + static_cast<size_t>(k.mining_fatigue & 0x7);
+        value = value * 2 + static_cast<size_t>(k.on_ground);
+        return std::hash<const Blockstate*>()(k.blockstate) ^ (value * 0x9E3779B97F4A7C15ULL);
+    }
+
+    const float DigTimeTable::ComputeMiningTime(const Key& key) const
+    {
+        const float hardness = key.blockstate->GetHardness();
+        if (hardness == 0.0f)
+        {
+            return 0.0f;
+        }
+
+        const BlockToolRequirement requirement = GetBlockToolRequirement(key.blockstate->GetName());
+
+        float speed = GetToolSpeed(key.tool, key.blockstate->GetName(), requirement);
+        if (speed > 1.0f && key.efficiency > 0)
+        {
+            speed += key.efficiency * key.efficiency + 1;
+        }
+        if (key.haste > 0)
+        {
+            speed *= 1.0f + 0.2f * key.haste;
+        }
+        if (key.mining_fatigue > 0)
+        {
+            static constexpr std::array<float, 4> fatigue_multipliers = { 0.3f, 0.09f, 0.0027f, 0.00081f };
+            speed *= fatigue_multipliers[std::min(key.mining_fatigue, 4) - 1];
+        }
+        if (!key.on_ground)
+        {
+            speed /= 5.0f;
+        }
+
+        const float damage = speed / hardness / (CanHarvest(key.tool, requirement) ? 30.0f : 100.0f);
+        // Instant break
+        if (damage > 1.0f)
+        {
+            return 0.0f;
+        }
+
+        return std::ceil(1.0f / damage) / 20.0f;
+    }
+} // Botcraft
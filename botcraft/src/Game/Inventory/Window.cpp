@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <mutex>
+#include <string_view>
+
 #include "botcraft/Game/Inventory/Window.hpp"
 
 using namespace ProtocolCraft;
@@ -27,15 +31,15 @@ namespace Botcraft
 
     const Slot& Window::GetSlot(const short index) const
     {
-        if (slots.find(index) == slots.end())
+        if (index < 0 || index >= static_cast<short>(slots.size()))
         {
             return EMPTY_SLOT;
         }
         
-        return slots.at(index);
+        return slots[index];
     }
 
-    const std::map<short, Slot>& Window::GetSlots() const
+    const std::vector<Slot>& Window::GetSlots() const
     {
         return slots;
     }
@@ -45,9 +49,143 @@ namespace Botcraft
         return type;
     }
 
+    // Add/remove an index in a sorted vector
+    static void InsertSorted(std::vector<short>& indices, const short index)
+    {
+        indices.insert(std::lower_bound(indices.begin(), indices.end(), index), index);
+    }
+
+    static void EraseSorted(std::vector<short>& indices, const short index)
+    {
+        auto it = std::lower_bound(indices.begin(), indices.end(), index);
+        if (it != indices.end() && *it == index)
+        {
+            indices.erase(it);
+        }
+    }
+
+    // Get the NBT already stored for an identical stack, or keep this one for the next ones
+    static std::shared_ptr<const NBT> InternNBT(const std::shared_ptr<const NBT>& nbt)
+    {
+        static std::mutex interned_mutex;
+        // Weak pointers so the NBT is freed when the last slot using it is overwritten
+        static std::unordered_map<size_t, std::vector<std::weak_ptr<const NBT> > > interned;
+        static size_t next_cleanup_size = 1024;
+
+        const std::vector<unsigned char>& data = nbt->GetRawData();
+        const size_t hash = std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+
+        std::lock_guard<std::mutex> lock(interned_mutex);
+        std::vector<std::weak_ptr<const NBT> >& candidates = interned[hash];
+        for (auto it = candidates.begin(); it != candidates.end();)
+        {
+            std::shared_ptr<const NBT> candidate = it->lock();
+            if (candidate == nullptr)
+            {
+                it = candidates.erase(it);
+                continue;
+            }
+            if (candidate->GetRawData() == data)
+            {
+                return candidate;
+            }
+            ++it;
+        }
+        candidates.push_back(nbt);
+
+        // Remove the hashes of the NBT that don't exist anymore
+        if (interned.size() >= next_cleanup_size)
+        {
+            for (auto it = interned.begin(); it != interned.end();)
+            {
+                it->second.erase(std::remove_if(it->second.begin(), it->second.end(),
+                    [](const std::weak_ptr<const NBT>& p) { return p.expired(); }), it->second.end());
+                it = it->second.empty() ? interned.erase(it) : std::next(it);
+            }
+            next_cleanup_size = std::max(static_cast<size_t>(1024), 2 * interned.size());
+        }
+        return nbt;
+    }
+
     void Window::SetSlot(const short index, const ProtocolCraft::Slot& slot)
     {
-        slots[index] = slot;
+        if (index < 0)
+        {
+            return;
+        }
+
+        if (slots.empty())
+        {
+            slots.resize(std::max(GetNumSlots(), static_cast<short>(index + 1)));
+        }
+        else if (index >= static_cast<short>(slots.size()))
+        {
+            slots.resize(index + 1);
+        }
+        // Unset slots are empty, they are only counted as free once set
+        else if (slots[index].IsEmptySlot())
+        {
+            EraseSorted(free_slots, index);
+        }
+        // Remove the previous content from the indices
+        else
+        {
+            const int key = GetItemKey(slots[index]);
+            EraseSorted(item_slots[key], index);
+            item_counts[key] -= slots[index].GetItemCount();
+        }
+
+        Slot& stored = slots[index];
+        stored = slot;
+        if (stored.GetSharedNBT() != nullptr)
+        {
+            stored.SetNBT(InternNBT(stored.GetSharedNBT()));
+        }
+
+        if (stored.IsEmptySlot())
+        {
+            InsertSorted(free_slots, index);
+        }
+        else
+        {
+            const int key = GetItemKey(stored);
+            InsertSorted(item_slots[key], index);
+            item_counts[key] += stored.GetItemCount();
+        }
+    }
+
+#if PROTOCOL_VERSION < 350
+    const std::vector<short>& Window::GetSlotsWithItem(const short block_id, const short item_damage) const
+    {
+        static const std::vector<short> empty;
+        auto it = item_slots.find(GetItemKey(block_id, item_damage));
+#else
+    const std::vector<short>& Window::GetSlotsWithItem(const short item_id) const
+    {
+        static const std::vector<short> empty;
+        auto it = item_slots.find(item_id);
+#endif
+        if (it == item_slots.end())
+        {
+            return empty;
+        }
+        return it->second;
+    }
+
+#if PROTOCOL_VERSION < 350
+    const int Window::GetItemCount(const short block_id, const short item_damage) const
+    {
+        auto it = item_counts.find(GetItemKey(block_id, item_damage));
+#else
+    const int Window::GetItemCount(const short item_id) const
+    {
+        auto it = item_counts.find(item_id);
+#endif
+        if (it == item_counts.end())
+        {
+            return 0;
+        }
+        return it->second;
     }
 
 #if PROTOCOL_VERSION < 755
@@ -72,6 +210,64 @@ namespace Botcraft
     }
 #endif
 
+#if PROTOCOL_VERSION < 350
+    const short Window::GetFirstSlotWithItem(const short block_id, const short item_damage, const short start) const
+    {
+        const std::vector<short>& indices = GetSlotsWithItem(block_id, item_damage);
+#else
+    const short Window::GetFirstSlotWithItem(const short item_id, const short start) const
+    {
+        const std::vector<short>& indices = GetSlotsWithItem(item_id);
+#endif
+        auto it = std::lower_bound(indices.begin(), indices.end(), start);
+        return it == indices.end() ? -1 : *it;
+    }
+
+    const std::vector<short>& Window::GetFreeSlots() const
+    {
+        return free_slots;
+    }
+
+    const short Window::GetFirstFreeSlot(const short start) const
+    {
+        auto it = std::lower_bound(free_slots.begin(), free_slots.end(), start);
+        return it == free_slots.end() ? -1 : *it;
+    }
+
+    const int Window::GetNumFreeSlots(const short start) const
+    {
+        return static_cast<int>(free_slots.end() - std::lower_bound(free_slots.begin(), free_slots.end(), start));
+    }
+
+    const int Window::GetItemKey(const Slot& slot)
+    {
+#if PROTOCOL_VERSION < 350
+        return GetItemKey(slot.GetBlockID(), slot.GetItemDamage());
+#else
+        return slot.GetItemID();
+#endif
+    }
+
+#if PROTOCOL_VERSION < 350
+    const int Window::GetItemKey(const short block_id, const short item_damage)
+    {
+        return static_cast<int>((static_cast<unsigned int>(static_cast<unsigned short>(block_id)) << 16) | static_cast<unsigned short>(item_damage));
+    }
+#endif
+
+    const short Window::GetNumSlots() const
+    {
+        switch (type)
+        {
+        case InventoryType::Default:
+        case InventoryType::PlayerInventory:
+            // Offhand slot is after the hotbar
+            return INVENTORY_OFFHAND_INDEX + 1;
+        default:
+            return GetFirstPlayerInventorySlot() + 36;
+        }
+    }
+
     const short Window::GetFirstPlayerInventorySlot() const
     {
         switch (type)
@@ -1,4 +1,5 @@
 #include "botcraft/Game/AssetsManager.hpp"
+#include "botcraft/Game/ClientMetrics.hpp"
 #include "botcraft/Game/Entities/EntityManager.hpp"
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
 #include "botcraft/Game/World/Chunk.hpp"
@@ -12,6 +13,10 @@
 #include "botcraft/Utilities/Logger.hpp"
 #include "botcraft/Utilities/SleepUtilities.hpp"
 
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
 #include "botcraft/Network/NetworkManager.hpp"
 #if USE_GUI
 #include "botcraft/Renderer/RenderingManager.hpp"
@@ -19,6 +24,33 @@
 
 using namespace ProtocolCraft;
 
+namespace
+{
+    /// @brief Format durations as "name 12 ms, other 3 ms", successive
+    /// steps with the same name are merged into "name 15 ms (x2)"
+    std::string FormatTimings(const std::vector<std::pair<std::string, double> >& timings)
+    {
+        std::stringstream output;
+        output << std::fixed << std::setprecision(0);
+        for (size_t i = 0; i < timings.size();)
+        {
+            size_t count = 0;
+            double total = 0.0;
+            for (; i + count < timings.size() && timings[i + count].first == timings[i].first; ++count)
+            {
+                total += timings[i + count].second;
+            }
+            output << (i == 0 ? "" : ", ") << timings[i].first << " " << total << " ms";
+            if (count > 1)
+            {
+                output << " (x" << count << ")";
+            }
+            i += count;
+        }
+        return output.str();
+    }
+}
+
 namespace Botcraft
 {
     ManagersClient::ManagersClient(const bool use_renderer_)
@@ -37,6 +69,7 @@ namespace Botcraft
 #if USE_GUI
         use_renderer = use_renderer_;
         rendering_manager = nullptr;
+        rendering_context_group = nullptr;
 #else
         if (use_renderer_)
         {
@@ -44,9 +77,19 @@ namespace Botcraft
         }
 #endif
         auto_respawn = false;
-
-        // Ensure the assets are loaded
-        AssetsManager::getInstance();
+        entity_movement_fast_path = false;
+
+        base_view_distance = 10;
+        base_interest_radius = -1;
+        view_distance = base_view_distance;
+        interest_radius = base_interest_radius;
+        client_information_sent = false;
+        server_view_distance = -1;
+        startup_reported = false;
+
+        // Start loading the assets, so it overlaps with DNS resolution,
+        // authentication and handshake if Connect is called right after
+        AssetsManager::Preload();
     }
 
     ManagersClient::~ManagersClient()
@@ -64,6 +107,10 @@ namespace Botcraft
         difficulty_locked = true;
 #endif
         is_hardcore = false;
+        {
+            std::lock_guard<std::mutex> lock(view_distance_mutex);
+            client_information_sent = false;
+        }
 
         physics_manager.reset();
         entity_manager.reset();
@@ -82,16 +129,112 @@ namespace Botcraft
         }
     }
 
+    void ManagersClient::Reconnect()
+    {
+        // Stop sending player updates on the previous connection
+        physics_manager.reset();
+
+        game_mode = GameType::None;
+        difficulty = Difficulty::None;
+#if PROTOCOL_VERSION > 463
+        difficulty_locked = true;
+#endif
+        is_hardcore = false;
+        {
+            std::lock_guard<std::mutex> lock(view_distance_mutex);
+            client_information_sent = false;
+        }
+
+#if USE_GUI
+        // Replaced during the login, kept alive until the
+        // previous connection doesn't send it packets anymore
+        std::shared_ptr<Renderer::RenderingManager> previous_rendering_manager = rendering_manager;
+#endif
+
+        // Entity and inventory managers are replaced when
+        // the new connection reaches the Play state
+        ConnectionClient::Reconnect();
+
+#if USE_GUI
+        if (previous_rendering_manager)
+        {
+            previous_rendering_manager->Close();
+        }
+#endif
+    }
+
     const int ManagersClient::GetDayTime() const
     {
         return day_time;
     }
 
-    const int ManagersClient::SendInventoryTransaction(const std::shared_ptr<ProtocolCraft::ServerboundContainerClickPacket>& transaction)
+    void ManagersClient::SetViewDistance(const int view_distance_, const int interest_radius_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(view_distance_mutex);
+            base_view_distance = view_distance_;
+            base_interest_radius = interest_radius_;
+        }
+        UpdateViewDistance();
+    }
+
+    const int ManagersClient::GetViewDistance() const
+    {
+        std::lock_guard<std::mutex> lock(view_distance_mutex);
+        return view_distance;
+    }
+
+    void ManagersClient::UpdateViewDistance()
+    {
+        std::lock_guard<std::mutex> lock(view_distance_mutex);
+        const int new_view_distance = view_distance_requests.empty() ? base_view_distance : std::max(base_view_distance, *view_distance_requests.rbegin());
+        int new_interest_radius = base_interest_radius;
+        // Keep all the requested area while a task needs it
+        if (base_interest_radius >= 0 && !view_distance_requests.empty())
+        {
+            new_interest_radius = std::max(base_interest_radius, new_view_distance);
+        }
+
+        const bool view_changed = new_view_distance != view_distance;
+        const bool interest_changed = new_interest_radius != interest_radius;
+        view_distance = new_view_distance;
+        interest_radius = new_interest_radius;
+
+#if PROTOCOL_VERSION > 471
+        if (interest_changed && world && !world->IsShared())
+        {
+            world->SetInterestRadius(interest_radius);
+        }
+#endif
+        // Before the first settings, the new distance will be sent with them
+        if (view_changed && client_information_sent && network_manager)
+        {
+            SendClientInformation();
+        }
+    }
+
+    void ManagersClient::SendClientInformation()
+    {
+        std::shared_ptr<ServerboundClientInformationPacket> settings_msg = std::make_shared<ServerboundClientInformationPacket>();
+        settings_msg->SetLanguage("fr_FR");
+        settings_msg->SetViewDistance(view_distance);
+        settings_msg->SetChatVisibility((int)ChatMode::Enabled);
+        settings_msg->SetChatColors(true);
+        settings_msg->SetModelCustomisation(0xFF);
+        settings_msg->SetMainHand((int)Hand::Right);
+
+        network_manager->Send(settings_msg);
+    }
+
+    const int ManagersClient::SendInventoryTransaction(const std::shared_ptr<ProtocolCraft::ServerboundContainerClickPacket>& transaction, const bool optimistic)
     {
         InventoryTransaction inventory_transaction = inventory_manager->PrepareTransaction(transaction);
 #if PROTOCOL_VERSION < 755
-        inventory_manager->AddPendingTransaction(inventory_transaction);
+        // If the container is closed, wait for the server answer instead
+        if (!optimistic || !inventory_manager->AddOptimisticTransaction(inventory_transaction))
+        {
+            inventory_manager->AddPendingTransaction(inventory_transaction);
+        }
         network_manager->Send(transaction);
         return transaction->GetUid();
 #else
@@ -107,6 +250,18 @@ namespace Botcraft
         world = world_;
     }
 
+    void ManagersClient::SetSharedEntityManager(const std::shared_ptr<EntityManager> entity_manager_)
+    {
+        shared_entity_manager = entity_manager_;
+    }
+
+#if USE_GUI
+    void ManagersClient::SetRenderingContextGroup(const std::shared_ptr<Renderer::RenderingContextGroup> context_group_)
+    {
+        rendering_context_group = context_group_;
+    }
+#endif
+
     const bool ManagersClient::GetAutoRespawn() const
     {
         return auto_respawn;
@@ -117,6 +272,11 @@ namespace Botcraft
         auto_respawn = b;
     }
 
+    void ManagersClient::SetEntityMovementFastPath(const bool b)
+    {
+        entity_movement_fast_path = b;
+    }
+
     std::shared_ptr<World> ManagersClient::GetWorld() const
     {
         return world;
@@ -137,6 +297,78 @@ namespace Botcraft
         return creative_mode;
     }
 
+    const unsigned long long ManagersClient::GetEventCount(const EventType type) const
+    {
+        switch (type)
+        {
+        case EventType::WindowOpened:
+        case EventType::WindowClosed:
+        case EventType::InventoryChanged:
+        case EventType::TransactionUpdated:
+        {
+            std::shared_ptr<InventoryManager> manager = inventory_manager;
+            return manager ? manager->GetEventNotifier().GetCount(type) : 0;
+        }
+        case EventType::BlockChanged:
+        case EventType::ChunkLoaded:
+        case EventType::ChunkUnloaded:
+        {
+            std::shared_ptr<World> manager = world;
+            return manager ? manager->GetEventNotifier().GetCount(type) : 0;
+        }
+        case EventType::EntityAdded:
+        case EventType::EntityRemoved:
+        {
+            std::shared_ptr<EntityManager> manager = entity_manager;
+            return manager ? manager->GetEventNotifier().GetCount(type) : 0;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    ClientMetrics ManagersClient::GetMetrics()
+    {
+        ClientMetrics metrics;
+
+        std::shared_ptr<NetworkManager> network = network_manager;
+        if (network)
+        {
+            metrics.name = network->GetMyName();
+            metrics.network = network->GetStats();
+        }
+
+        std::shared_ptr<World> world_manager = world;
+        if (world_manager)
+        {
+            metrics.world_shared = world_manager->IsShared();
+            metrics.world = world_manager->GetStats();
+        }
+
+        std::shared_ptr<EntityManager> entities = entity_manager;
+        if (entities)
+        {
+            metrics.entities = entities->GetStats();
+        }
+
+        std::shared_ptr<PhysicsManager> physics = physics_manager;
+        if (physics)
+        {
+            metrics.has_physics = true;
+            metrics.physics = physics->GetStats();
+        }
+
+        metrics.assets_memory_bytes = AssetsManager::getInstance().GetMemoryUsage();
+#if USE_GUI
+        if (rendering_manager)
+        {
+            metrics.renderer_memory_bytes = rendering_manager->GetGPUMemory();
+        }
+#endif
+
+        return metrics;
+    }
+
     void ManagersClient::Handle(Message &msg)
     {
 
@@ -144,27 +376,51 @@ namespace Botcraft
 
     void ManagersClient::Handle(ClientboundGameProfilePacket &msg)
     {
+        server_view_distance = -1;
+        first_chunk_time = std::chrono::steady_clock::time_point();
+        startup_chunks.clear();
+        startup_reported = false;
+
         if (!world)
         {
             world = std::make_shared<World>(false, false);
         }
+#if PROTOCOL_VERSION > 471
+        {
+            std::lock_guard<std::mutex> lock(view_distance_mutex);
+            if (interest_radius >= 0 && !world->IsShared())
+            {
+                world->SetInterestRadius(interest_radius);
+            }
+        }
+#endif
 
         inventory_manager = std::make_shared<InventoryManager>();
-        entity_manager = std::make_shared<EntityManager>();
+        entity_manager = shared_entity_manager ? std::make_shared<EntityManager>(shared_entity_manager) : std::make_shared<EntityManager>();
 
-        network_manager->AddHandler(world->GetAsyncHandler());
-        network_manager->AddHandler(inventory_manager.get());
-        network_manager->AddHandler(entity_manager.get());
+        network_manager->AddFilteredHandler<World::HandledMessages>(world->GetAsyncHandler());
+        network_manager->AddFilteredHandler<InventoryManager::HandledMessages>(inventory_manager.get());
+        network_manager->AddFilteredHandler<EntityManager::HandledMessages>(entity_manager.get());
 
 #if USE_GUI
         if (use_renderer)
         {
-            rendering_manager = std::make_shared<Renderer::RenderingManager>(world, inventory_manager, entity_manager, 800, 600, CHUNK_WIDTH, false);
+            rendering_manager = std::make_shared<Renderer::RenderingManager>(world, inventory_manager, entity_manager, 800, 600, CHUNK_WIDTH, false, rendering_context_group);
             network_manager->AddHandler(rendering_manager.get());
+            rendering_manager->SetNetworkManager(network_manager);
             entity_manager->SetRenderingManager(rendering_manager);
         }
+        // The renderer also needs the movement messages
+        if (entity_movement_fast_path && !rendering_manager)
+        {
+            network_manager->SetEntityMovementFastPath(entity_manager.get());
+        }
         physics_manager = std::make_shared<PhysicsManager>(rendering_manager, entity_manager, world, network_manager);
 #else
+        if (entity_movement_fast_path)
+        {
+            network_manager->SetEntityMovementFastPath(entity_manager.get());
+        }
         physics_manager = std::make_shared<PhysicsManager>(entity_manager, world, network_manager);
 #endif
         physics_manager->StartPhysics();
@@ -189,6 +445,9 @@ namespace Botcraft
 
 #if PROTOCOL_VERSION < 464
         difficulty = (Difficulty)msg.GetDifficulty();
+#endif
+#if PROTOCOL_VERSION >= 477
+        server_view_distance = msg.GetChunkRadius();
 #endif
     }
 
@@ -211,15 +470,9 @@ namespace Botcraft
             physics_manager->SetShouldFallInVoid(!creative_mode);
         }
 
-        std::shared_ptr<ServerboundClientInformationPacket> settings_msg = std::make_shared<ServerboundClientInformationPacket>();
-        settings_msg->SetLanguage("fr_FR");
-        settings_msg->SetViewDistance(10);
-        settings_msg->SetChatVisibility((int)ChatMode::Enabled);
-        settings_msg->SetChatColors(true);
-        settings_msg->SetModelCustomisation(0xFF);
-        settings_msg->SetMainHand((int)Hand::Right);
-
-        network_manager->Send(settings_msg);
+        std::lock_guard<std::mutex> lock(view_distance_mutex);
+        SendClientInformation();
+        client_information_sent = true;
     }
 
     void ManagersClient::Handle(ClientboundRespawnPacket &msg)
@@ -234,4 +487,92 @@ namespace Botcraft
     {
         day_time = msg.GetDayTime() % 24000;
     }
+
+#if PROTOCOL_VERSION < 757
+    void ManagersClient::Handle(ProtocolCraft::ClientboundLevelChunkPacket& msg)
+#else
+    void ManagersClient::Handle(ProtocolCraft::ClientboundLevelChunkWithLightPacket& msg)
+#endif
+    {
+        if (!startup_reported)
+        {
+            OnStartupChunk(msg.GetX(), msg.GetZ());
+        }
+    }
+
+    void ManagersClient::OnStartupChunk(const int x, const int z)
+    {
+        if (startup_chunks.empty())
+        {
+            first_chunk_time = std::chrono::steady_clock::now();
+        }
+        startup_chunks.insert({ x, z });
+
+        std::shared_ptr<LocalPlayer> local_player = entity_manager ? entity_manager->GetLocalPlayer() : nullptr;
+        if (local_player == nullptr)
+        {
+            return;
+        }
+
+        // The server sends the chunks in a square around the player, up to
+        // the smallest of its view distance and the one sent by the client
+        int radius;
+        {
+            std::lock_guard<std::mutex> lock(view_distance_mutex);
+            radius = server_view_distance < 0 ? view_distance : std::min(view_distance, server_view_distance);
+        }
+        const Vector3<double> position = local_player->GetPosition();
+        const int player_x = static_cast<int>(std::floor(position.x / CHUNK_WIDTH));
+        const int player_z = static_cast<int>(std::floor(position.z / CHUNK_WIDTH));
+        for (int i = player_x - radius; i <= player_x + radius; ++i)
+        {
+            for (int j = player_z - radius; j <= player_z + radius; ++j)
+            {
+                if (startup_chunks.find({ i, j }) == startup_chunks.end())
+                {
+                    return;
+                }
+            }
+        }
+
+        startup_reported = true;
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const ConnectionTimings timings = network_manager->GetConnectionTimings();
+        const std::vector<std::pair<std::string, double> >& assets_timings = AssetsManager::getInstance().GetLoadingTimings();
+        double assets_ms = 0.0;
+        for (const auto& t : assets_timings)
+        {
+            assets_ms += t.second;
+        }
+        const double first_chunk_ms = std::chrono::duration<double, std::milli>(first_chunk_time - timings.start).count();
+        const double all_chunks_ms = std::chrono::duration<double, std::milli>(now - timings.start).count();
+
+        LOG_INFO("Startup of " << network_manager->GetMyName() << std::fixed << std::setprecision(0)
+            << ": assets " << assets_ms << " ms (" << FormatTimings(assets_timings) << ")"
+            << " | auth " << timings.auth_ms << " ms" << (timings.auth_requests.empty() ? "" : " (" + FormatTimings(timings.auth_requests) + ")")
+            << " | srv " << timings.srv_lookup_ms << " ms, dns " << timings.dns_ms << " ms, tcp " << timings.tcp_connect_ms
+            << " ms, login " << timings.login_ms << " ms (encryption " << timings.encryption_ms << " ms)"
+            << " | first chunk " << first_chunk_ms << " ms, all " << startup_chunks.size() << " chunks "
+            << all_chunks_ms << " ms after connection start");
+        startup_chunks.clear();
+    }
+
+
+    ScopedViewDistance::ScopedViewDistance(ManagersClient& client_, const int view_distance_) : client(client_), view_distance(view_distance_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(client.view_distance_mutex);
+            client.view_distance_requests.insert(view_distance);
+        }
+        client.UpdateViewDistance();
+    }
+
+    ScopedViewDistance::~ScopedViewDistance()
+    {
+        {
+            std::lock_guard<std::mutex> lock(client.view_distance_mutex);
+            client.view_distance_requests.erase(client.view_distance_requests.find(view_distance));
+        }
+        client.UpdateViewDistance();
+    }
 } //Botcraft
@@ -6,14 +6,21 @@
 
 #include <sstream>
 #include <fstream>
+#include <limits>
+
+using namespace ProtocolCraft;
 
 namespace Botcraft
 {
     std::unordered_map<std::string, Model> Model::cached_models;
+    // Shape 0 is always the empty one
+    std::deque<std::vector<AABB> > Model::colliders_shapes = { std::vector<AABB>() };
+    std::map<std::vector<double>, unsigned short> Model::colliders_shapes_ids = { { std::vector<double>(), 0 } };
 
     Model::Model()
     {
         ambient_occlusion = false;
+        colliders_id = 0;
     }
 
     const Model& Model::GetModel(const std::string& filepath, const bool custom)
@@ -47,6 +54,7 @@ namespace Botcraft
 
         bool error = filepath == "";
         nlohmann::json obj;
+        std::vector<AABB> colliders;
         
         if (!error)
         {
@@ -68,6 +76,7 @@ namespace Botcraft
         {
             ambient_occlusion = false;
             colliders.push_back(AABB(Vector3<double>(0.5, 0.5, 0.5), Vector3<double>(0.5, 0.5, 0.5)));
+            SetColliders(colliders);
 #ifdef USE_GUI
             faces = std::vector<FaceDescriptor>();
             for (int i = 0; i < 6; ++i)
@@ -100,7 +109,7 @@ namespace Botcraft
 #else
             const Model& parent_model = GetModel(it.value(), custom);
 #endif
-            colliders = parent_model.colliders;
+            colliders = parent_model.GetColliders();
 #if USE_GUI
             textures_variables = parent_model.textures_variables;
             textures_base_size = parent_model.textures_base_size;
@@ -430,6 +439,7 @@ namespace Botcraft
 #endif
             }
         }
+        SetColliders(colliders);
 
 #if USE_GUI
         bool has_changed = true;
@@ -503,7 +513,7 @@ namespace Botcraft
     Model::Model(const unsigned char height, const std::string &texture)
     {
         ambient_occlusion = false;
-        colliders = std::vector<AABB>({ AABB(Vector3<double>(0.5, (height + 1.0) / 2.0 / 16.0, 0.5), Vector3<double>(0.5, (height + 1.0) / 2.0 / 16.0, 0.5)) });
+        SetColliders({ AABB(Vector3<double>(0.5, (height + 1.0) / 2.0 / 16.0, 0.5), Vector3<double>(0.5, (height + 1.0) / 2.0 / 16.0, 0.5)) });
 
 #ifdef USE_GUI
         faces = std::vector<FaceDescriptor>(6);
@@ -568,7 +578,12 @@ namespace Botcraft
     Model &Model::operator+=(const Model &m)
     {
         this->ambient_occlusion = this->ambient_occlusion || m.ambient_occlusion;
-        this->colliders.insert(this->colliders.end(), m.colliders.begin(), m.colliders.end());
+        if (m.colliders_id != 0)
+        {
+            std::vector<AABB> colliders = GetColliders();
+            colliders.insert(colliders.end(), m.GetColliders().begin(), m.GetColliders().end());
+            SetColliders(colliders);
+        }
 #ifdef USE_GUI
         this->faces.insert(this->faces.end(), m.faces.begin(), m.faces.end());
 #endif
@@ -577,12 +592,59 @@ namespace Botcraft
 
     const std::vector<AABB> &Model::GetColliders() const
     {
-        return colliders;
+        return colliders_shapes[colliders_id];
+    }
+
+    void Model::SetColliders(const std::vector<AABB>& colliders)
+    {
+        colliders_id = GetCollidersId(colliders);
     }
 
-    std::vector<AABB> &Model::GetColliders()
+    const unsigned short Model::GetCollidersId() const
     {
-        return colliders;
+        return colliders_id;
+    }
+
+    const unsigned short Model::GetCollidersId(const std::vector<AABB>& colliders)
+    {
+        std::vector<double> key;
+        key.reserve(6 * colliders.size());
+        for (const auto& c : colliders)
+        {
+            for (const Vector3<double>& v : { c.GetCenter(), c.GetHalfSize() })
+            {
+                key.push_back(v.x);
+                key.push_back(v.y);
+                key.push_back(v.z);
+            }
+        }
+
+        auto it = colliders_shapes_ids.find(key);
+        if (it != colliders_shapes_ids.end())
+        {
+            return it->second;
+        }
+
+        if (colliders_shapes.size() > std::numeric_limits<unsigned short>::max())
+        {
+            LOG_ERROR("Too many different colliders shapes, using the empty one");
+            return 0;
+        }
+
+        const unsigned short id = static_cast<unsigned short>(colliders_shapes.size());
+        colliders_shapes.push_back(colliders);
+        colliders_shapes_ids[key] = id;
+        return id;
+    }
+
+    const std::vector<AABB>& Model::GetColliders(const unsigned short colliders_id)
+    {
+        return colliders_shapes[colliders_id];
+    }
+
+    const size_t Model::GetNumCollidersShapes()
+    {
+        return colliders_shapes.size();
     }
 
     void Model::ClearCache()
@@ -590,6 +652,49 @@ namespace Botcraft
         cached_models.clear();
     }
 
+    void Model::Write(WriteContainer& container) const
+    {
+        WriteData<bool>(ambient_occlusion, container);
+        const std::vector<AABB>& colliders = GetColliders();
+        WriteData<VarInt>(static_cast<int>(colliders.size()), container);
+        for (const auto& c : colliders)
+        {
+            for (const Vector3<double>& v : { c.GetCenter(), c.GetHalfSize() })
+            {
+                WriteData<double>(v.x, container);
+                WriteData<double>(v.y, container);
+                WriteData<double>(v.z, container);
+            }
+        }
+    }
+
+    Model Model::Read(ReadIterator& iter, size_t& length)
+    {
+        Model model;
+        model.ambient_occlusion = ReadData<bool>(iter, length);
+        const int num_colliders = ReadData<VarInt>(iter, length);
+        if (num_colliders < 0)
+        {
+            throw(std::runtime_error("Wrong number of colliders when reading model (" + std::to_string(num_colliders) + ")"));
+        }
+        std::vector<AABB> colliders;
+        colliders.reserve(num_colliders);
+        for (int i = 0; i < num_colliders; ++i)
+        {
+            Vector3<double> center;
+            center.x = ReadData<double>(iter, length);
+            center.y = ReadData<double>(iter, length);
+            center.z = ReadData<double>(iter, length);
+            Vector3<double> half_size;
+            half_size.x = ReadData<double>(iter, length);
+            half_size.y = ReadData<double>(iter, length);
+            half_size.z = ReadData<double>(iter, length);
+            colliders.push_back(AABB(center, half_size));
+        }
+        model.SetColliders(colliders);
+        return model;
+    }
+
 #ifdef USE_GUI
     const std::vector<FaceDescriptor> &Model::GetFaces() const
     {
@@ -600,5 +705,12 @@ namespace Botcraft
     {
         return faces;
     }
+
+    void Model::ClearRenderingData()
+    {
+        faces = std::vector<FaceDescriptor>();
+        textures_variables = std::map<std::string, std::string>();
+        textures_base_size = std::map<std::string, std::pair<int, int> >();
+    }
 #endif
 } //Botcraft
\ No newline at end of file
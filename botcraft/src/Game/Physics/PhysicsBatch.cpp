@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+
+#include "botcraft/Game/Physics/PhysicsBatch.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
+
+namespace Botcraft
+{
+    PhysicsBatch::PhysicsBatch()
+    {
+
+    }
+
+    PhysicsBatch::~PhysicsBatch()
+    {
+
+    }
+
+    void PhysicsBatch::Tick(PhysicsManager* const* managers, const size_t num_managers)
+    {
+        TRACE_ZONE("PhysicsBatchTick");
+
+        if (steps.size() < num_managers)
+        {
+            steps.resize(num_managers);
+        }
+
+        begun_steps.clear();
+        for (size_t i = 0; i < num_managers; ++i)
+        {
+            if (managers[i]->BeginStep(steps[i]))
+            {
+                begun_steps.push_back(i);
+            }
+        }
+
+        if (begun_steps.empty())
+        {
+            return;
+        }
+
+        // Same world for all the managers, one snapshot is enough
+        const std::shared_ptr<World>& world = managers[0]->world;
+        const WorldSnapshot world_snapshot = world->GetSnapshot();
+
+        loaded_steps.clear();
+        for (const size_t i : begun_steps)
+        {
+            managers[i]->CheckStepWorld(world_snapshot, steps[i]);
+            if (steps[i].is_loaded)
+            {
+                loaded_steps.push_back(i);
+            }
+        }
+
+        const size_t n = loaded_steps.size();
+        Resize(n);
+        for (size_t k = 0; k < n; ++k)
+        {
+            const PhysicsManager::PhysicsStep& step = steps[loaded_steps[k]];
+            position_x[k] = step.state.position.x;
+            position_y[k] = step.state.position.y;
+            position_z[k] = step.state.position.z;
+            speed_x[k] = step.state.speed.x;
+            speed_y[k] = step.state.speed.y;
+            speed_z[k] = step.state.speed.z;
+            input_x[k] = step.inputs.x;
+            input_y[k] = step.inputs.y;
+            input_z[k] = step.inputs.z;
+            half_width[k] = step.half_size.x;
+            half_height[k] = step.half_size.y;
+        }
+
+        ComputeBroadphase();
+
+        // Narrow phase, only against the blocks in each swept box
+        for (size_t k = 0; k < n; ++k)
+        {
+            const size_t i = loaded_steps[k];
+            PhysicsManager::PhysicsStep& step = steps[i];
+            PhysicsManager::MoveAndCollide(step.state,
+                Vector3<double>(movement_x[k], movement_y[k], movement_z[k]), step.half_size,
+                Vector3<double>(min_x[k], min_y[k], min_z[k]), Vector3<double>(max_x[k], max_y[k], max_z[k]),
+                step.is_in_fluid, world_snapshot, managers[i]->collision_cache);
+
+            // Collisions may have stopped the player along any axis
+            position_y[k] = step.state.position.y;
+            speed_x[k] = step.state.speed.x;
+            speed_y[k] = step.state.speed.y;
+            speed_z[k] = step.state.speed.z;
+            on_ground[k] = step.state.on_ground;
+            fall_in_void[k] = managers[i]->should_fall_in_void;
+        }
+
+        ComputeDrag(static_cast<double>(world->GetMinY()));
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            PhysicsManager::PhysicsStep& step = steps[loaded_steps[k]];
+            step.has_next_speed = true;
+            step.drag_speed = Vector3<double>(speed_x[k], drag_speed_y[k], speed_z[k]);
+            step.drag_on_ground = drag_on_ground[k];
+            step.next_speed = Vector3<double>(next_speed_x[k], next_speed_y[k], next_speed_z[k]);
+        }
+
+        for (const size_t i : begun_steps)
+        {
+            managers[i]->EndStep(world_snapshot, steps[i]);
+            // Don't keep the player alive until next tick
+            steps[i].local_player.reset();
+        }
+    }
+
+    void PhysicsBatch::Resize(const size_t n)
+    {
+        for (std::vector<double>* v : {
+            &position_x, &position_y, &position_z,
+            &speed_x, &speed_y, &speed_z,
+            &input_x, &input_y, &input_z,
+            &half_width, &half_height,
+            &movement_x, &movement_y, &movement_z,
+            &min_x, &min_y, &min_z,
+            &max_x, &max_y, &max_z,
+            &drag_speed_y,
+            &next_speed_x, &next_speed_y, &next_speed_z })
+        {
+            v->resize(n);
+        }
+        on_ground.resize(n);
+        fall_in_void.resize(n);
+        drag_on_ground.resize(n);
+    }
+
+    void PhysicsBatch::ComputeBroadphase()
+    {
+        // Same operations as PhysicsManager::ApplyCollisions,
+        // so both paths give exactly the same results
+        const size_t n = loaded_steps.size();
+        for (size_t k = 0; k < n; ++k)
+        {
+            movement_x[k] = speed_x[k] + input_x[k];
+            movement_y[k] = speed_y[k] + input_y[k];
+            movement_z[k] = speed_z[k] + input_z[k];
+
+            const double center_y = position_y[k] + half_height[k];
+            const double box_min_x = position_x[k] - half_width[k];
+            const double box_min_y = center_y - half_height[k];
+            const double box_min_z = position_z[k] - half_width[k];
+            const double box_max_x = position_x[k] + half_width[k];
+            const double box_max_y = center_y + half_height[k];
+            const double box_max_z = position_z[k] + half_width[k];
+
+            min_x[k] = std::min(box_min_x, box_min_x + movement_x[k]);
+            min_y[k] = std::min(box_min_y, box_min_y + movement_y[k]);
+            min_z[k] = std::min(box_min_z, box_min_z + movement_z[k]);
+            max_x[k] = std::max(box_max_x, box_max_x + movement_x[k]);
+            max_y[k] = std::max(box_max_y, box_max_y + movement_y[k]);
+            max_z[k] = std::max(box_max_z, box_max_z + movement_z[k]);
+        }
+    }
+
+    void PhysicsBatch::ComputeDrag(const double world_min_y)
+    {
+        const size_t n = loaded_steps.size();
+        for (size_t k = 0; k < n; ++k)
+        {
+            // Avoid forever falling if position is in the void
+            const bool is_in_void = !fall_in_void[k] && position_y[k] <= world_min_y;
+            const bool ground = is_in_void || on_ground[k];
+            drag_speed_y[k] = is_in_void ? 0.0 : speed_y[k];
+            drag_on_ground[k] = ground;
+
+            double x = speed_x[k] * 0.91;
+            double y = (drag_speed_y[k] - 0.08) * 0.98;
+            double z = speed_z[k] * 0.91;
+            x = ground ? x * 0.6 : x;
+            y = ground ? y * 0.0 : y;
+            z = ground ? z * 0.6 : z;
+
+            next_speed_x[k] = std::abs(x) < 0.003 ? 0.0 : x;
+            next_speed_y[k] = y;
+            next_speed_z[k] = std::abs(z) < 0.003 ? 0.0 : z;
+        }
+    }
+} // Botcraft
@@ -1,14 +1,19 @@
 #include "botcraft/Game/Physics/PhysicsManager.hpp"
+#include "botcraft/Game/Physics/PhysicsScheduler.hpp"
 #include "botcraft/Utilities/Logger.hpp"
 #include "botcraft/Utilities/SleepUtilities.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
 #include "botcraft/Game/Entities/EntityManager.hpp"
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
 #include "botcraft/Network/NetworkManager.hpp"
 #include "botcraft/Game/World/World.hpp"
+#include "botcraft/Game/World/BlockAccessor.hpp"
 #if USE_GUI
 #include "botcraft/Renderer/RenderingManager.hpp"
 #endif
 
+#include <limits>
+
 using namespace ProtocolCraft;
 
 namespace Botcraft
@@ -27,6 +32,9 @@ namespace Botcraft
         entity_manager = entity_manager_;
         world = world_;
         network_manager = network_manager_;
+        use_scheduler = false;
+        has_moved = false;
+        is_resting = false;
     }
 
     PhysicsManager::~PhysicsManager()
@@ -38,13 +46,45 @@ namespace Botcraft
     {
         should_run = true;
 
-        // Launch the physics thread (continuously sending the position to the server)
-        thread_physics = std::thread(&PhysicsManager::RunSyncPos, this);
+        last_send = VirtualClock::now();
+        msg_pos = std::make_shared<ServerboundMovePlayerPacketPos>();
+        msg_pos_rot = std::make_shared<ServerboundMovePlayerPacketPosRot>();
+        msg_rot = std::make_shared<ServerboundMovePlayerPacketRot>();
+        msg_status = std::make_shared<ServerboundMovePlayerPacketStatusOnly>();
+        has_moved = false;
+        last_sent_position = Vector3<double>(0.0);
+        // NaN is never equal to anything, so the first
+        // position packet always contains the rotation
+        last_sent_yaw = std::numeric_limits<float>::quiet_NaN();
+        last_sent_pitch = std::numeric_limits<float>::quiet_NaN();
+        last_sent_on_ground = false;
+        is_resting = false;
+        last_tick_start = VirtualClock::time_point();
+        {
+            std::lock_guard<std::mutex> stats_lock(stats_mutex);
+            stats = PhysicsStats();
+        }
+
+        use_scheduler = PhysicsScheduler::GetInstance().IsEnabled();
+        if (use_scheduler)
+        {
+            PhysicsScheduler::GetInstance().Register(this);
+        }
+        else
+        {
+            // Launch the physics thread (continuously sending the position to the server)
+            thread_physics = std::thread(&PhysicsManager::RunSyncPos, this);
+        }
     }
 
     void PhysicsManager::StopPhysics()
     {
         should_run = false;
+        if (use_scheduler)
+        {
+            PhysicsScheduler::GetInstance().Unregister(this);
+            use_scheduler = false;
+        }
         if (thread_physics.joinable())
         {
             thread_physics.join();
@@ -58,133 +98,296 @@ namespace Botcraft
 
 
 
+    const PhysicsStats PhysicsManager::GetStats() const
+    {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        return stats;
+    }
+
     void PhysicsManager::RunSyncPos()
     {
         Logger::GetInstance().RegisterThread("RunSyncPos");
 
-        // Wait for 500 milliseconds before starting to send position continuously
-        // TODO: wait for something better?
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        // Don't send anything before the server accepted us
+        while (should_run && !network_manager->WaitForConnectionState(ProtocolCraft::ConnectionState::Play, std::chrono::milliseconds(100)))
+        {
 
-        auto last_send = std::chrono::steady_clock::now();
-        std::shared_ptr<ServerboundMovePlayerPacketPosRot> msg_position = std::make_shared<ServerboundMovePlayerPacketPosRot>();
-        bool has_moved = false;
+        }
 
         while (should_run)
         {
             // End of the current tick
-            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+            auto end = VirtualClock::now() + std::chrono::milliseconds(50);
+
+            Tick();
+
+            SleepUntil(end);
+        }
+    }
+
+    void PhysicsManager::Tick()
+    {
+        TRACE_ZONE("PhysicsTick");
+
+        PhysicsStep step;
+        if (!BeginStep(step))
+        {
+            return;
+        }
+
+        const WorldSnapshot world_snapshot = world->GetSnapshot();
+        CheckStepWorld(world_snapshot, step);
+        if (step.is_loaded)
+        {
+            //Check that we did not go through a block
+            ApplyCollisions(step.state, step.inputs, step.half_size, step.is_in_fluid, world_snapshot, collision_cache);
+        }
 
-            if (network_manager->GetConnectionState() == ProtocolCraft::ConnectionState::Play)
+        EndStep(world_snapshot, step);
+    }
+
+    const bool PhysicsManager::BeginStep(PhysicsStep& step)
+    {
+        RecordTickJitter();
+
+        if (network_manager->GetConnectionState() != ProtocolCraft::ConnectionState::Play)
+        {
+            return false;
+        }
+
+        step.local_player = entity_manager->GetLocalPlayer();
+        if (!step.local_player)
+        {
+            return false;
+        }
+
+        // Copy the player state in a short critical section,
+        // the physics step itself runs without any lock
+        {
+            std::lock_guard<std::mutex> player_guard(step.local_player->GetMutex());
+            step.local_player->ProcessQueuedCommands();
+            step.initial_state.position = step.local_player->GetPosition();
+            step.initial_state.speed = step.local_player->GetSpeed();
+            step.initial_state.on_ground = step.local_player->GetOnGround();
+            step.inputs = step.local_player->GetPlayerInputs();
+        }
+
+        if (step.initial_state.position.y >= 1000.0)
+        {
+            return false;
+        }
+
+        // Player dimensions are constant, no need to lock it
+        step.half_size = Vector3<double>(step.local_player->GetWidth() / 2.0, step.local_player->GetHeight() / 2.0, step.local_player->GetWidth() / 2.0);
+        step.state = step.initial_state;
+        step.has_next_speed = false;
+        return true;
+    }
+
+    void PhysicsManager::CheckStepWorld(const WorldSnapshot& world_snapshot, PhysicsStep& step) const
+    {
+        // A player standing still on the ground stays there until something moves
+        // it or the blocks around change, no need to compute the collisions again
+        step.skip_step = is_resting && step.initial_state.on_ground &&
+            step.initial_state.position == rest_position &&
+            step.initial_state.speed == Vector3<double>(0.0) &&
+            step.inputs == Vector3<double>(0.0) &&
+            GetSupportVersions(world_snapshot, step.initial_state.position, step.half_size.x) == rest_support_versions;
+        step.is_in_fluid = false;
+        step.is_loaded = !step.skip_step && IsLoadedAndInFluid(world_snapshot, step.initial_state.position, step.is_in_fluid);
+    }
+
+    void PhysicsManager::EndStep(const WorldSnapshot& world_snapshot, PhysicsStep& step)
+    {
+        const std::shared_ptr<LocalPlayer>& local_player = step.local_player;
+
+        Vector3<double> position;
+        float yaw;
+        float pitch;
+        bool on_ground;
+        {
+            std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
+            if (step.is_loaded)
             {
-                std::shared_ptr<LocalPlayer> local_player = entity_manager->GetLocalPlayer();
-                if (local_player && local_player->GetPosition().y < 1000.0)
+                // If the player has been moved during the physics step (teleported by the server,
+                // knockback...), this new state takes precedence and the step is dropped
+                const bool is_step_applied = local_player->GetPosition() == step.initial_state.position &&
+                    local_player->GetSpeed() == step.initial_state.speed;
+                if (is_step_applied)
                 {
-                    bool is_loaded = false;
-                    bool is_in_fluid = false;
-                    std::lock_guard<std::mutex> player_guard(local_player->GetMutex());
-                    {
-                        std::lock_guard<std::mutex> mutex_guard(world->GetMutex());
-                        const Position player_position = Position(std::floor(local_player->GetX()), std::floor(local_player->GetY()), std::floor(local_player->GetZ()));
+                    local_player->SetPosition(step.state.position);
+                    local_player->SetOnGround(step.state.on_ground);
+                    local_player->SetSpeedY(step.state.speed.y);
+                }
 
-                        is_loaded = world->IsLoaded(player_position);
+                if (local_player->GetHasMoved() ||
+                    std::abs(local_player->GetSpeed().x) > 1e-3 ||
+                    std::abs(local_player->GetSpeed().y) > 1e-3 ||
+                    std::abs(local_player->GetSpeed().z) > 1e-3)
+                {
+                    has_moved = true;
+                    // Reset the player move state until next tick
+                    local_player->SetHasMoved(false);
+                }
+                else
+                {
+                    has_moved = false;
+                }
 
-                        if (is_loaded)
-                        {
-                            const Block* block_ptr = world->GetBlock(player_position);
-                            is_in_fluid = block_ptr && block_ptr->GetBlockstate()->IsFluid();
-                        }
-                    }
+                //Avoid forever falling if position is in the void
+                if (!should_fall_in_void && local_player->GetPosition().y <= world->GetMinY())
+                {
+                    local_player->SetY(world->GetMinY());
+                    local_player->SetSpeedY(0.0);
+                    local_player->SetOnGround(true);
+                }
 
-                    if (is_loaded)
-                    {
-                        //Check that we did not go through a block
-                        Physics(is_in_fluid);
+                UpdatePlayerSpeed(step);
 
-                        if (local_player->GetHasMoved() ||
-                            std::abs(local_player->GetSpeed().x) > 1e-3 ||
-                            std::abs(local_player->GetSpeed().y) > 1e-3 ||
-                            std::abs(local_player->GetSpeed().z) > 1e-3)
-                        {
-                            has_moved = true;
-                            // Reset the player move state until next tick
-                            local_player->SetHasMoved(false);
-                        }
-                        else
-                        {
-                            has_moved = false;
-                        }
+                // Landed and nothing will move the player at next tick
+                is_resting = is_step_applied && local_player->GetOnGround() &&
+                    local_player->GetSpeed() == Vector3<double>(0.0) &&
+                    local_player->GetPlayerInputs() == Vector3<double>(0.0);
+                rest_position = local_player->GetPosition();
+            }
+            else if (step.skip_step)
+            {
+                has_moved = false;
+            }
+            else
+            {
+                is_resting = false;
+            }
 
-                        //Avoid forever falling if position is in the void
-                        if (!should_fall_in_void && local_player->GetPosition().y <= world->GetMinY())
-                        {
-                            local_player->SetY(world->GetMinY());
-                            local_player->SetSpeedY(0.0);
-                            local_player->SetOnGround(true);
-                        }
+            local_player->PublishState();
+            position = local_player->GetPosition();
+            yaw = local_player->GetYaw();
+            pitch = local_player->GetPitch();
+            on_ground = local_player->GetOnGround();
+        }
 
-                        UpdatePlayerSpeed();
-                    }
+        if (step.skip_step)
+        {
+            std::lock_guard<std::mutex> stats_lock(stats_mutex);
+            stats.num_rest_ticks++;
+        }
+        else if (is_resting)
+        {
+            rest_support_versions = GetSupportVersions(world_snapshot, rest_position, step.half_size.x);
+        }
 
 #if USE_GUI
-                    if (rendering_manager && has_moved)
-                    {
-                        rendering_manager->SetPosOrientation(local_player->GetPosition().x, local_player->GetPosition().y + 1.62, local_player->GetPosition().z, local_player->GetYaw(), local_player->GetPitch());
-                    }
+        if (rendering_manager && has_moved)
+        {
+            rendering_manager->SetPosOrientation(position.x, position.y + 1.62, position.z, yaw, pitch);
+        }
 #endif
-                    if (has_moved || std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - last_send).count() >= 1000)
-                    {
-                        msg_position->SetX(local_player->GetPosition().x);
-                        msg_position->SetY(local_player->GetPosition().y);
-                        msg_position->SetZ(local_player->GetPosition().z);
-                        msg_position->SetYRot(local_player->GetYaw());
-                        msg_position->SetXRot(local_player->GetPitch());
-                        msg_position->SetOnGround(local_player->GetOnGround());
-
-                        network_manager->Send(msg_position);
-                        last_send = std::chrono::steady_clock::now();
-                    }
-                }
-            }
-            SleepUntil(end);
+        // Only send what changed since the last packet, like vanilla client.
+        // Position is sent at least once per second even if it didn't change.
+        // Movements smaller than 2e-4 blocks are ignored, as vanilla does
+        const bool position_changed = position.SqrDist(last_sent_position) > 4e-8 ||
+            std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now() - last_send).count() >= 1000;
+        const bool rotation_changed = yaw != last_sent_yaw || pitch != last_sent_pitch;
+
+        if (position_changed && rotation_changed)
+        {
+            msg_pos_rot->SetX(position.x);
+            msg_pos_rot->SetY(position.y);
+            msg_pos_rot->SetZ(position.z);
+            msg_pos_rot->SetYRot(yaw);
+            msg_pos_rot->SetXRot(pitch);
+            msg_pos_rot->SetOnGround(on_ground);
+            network_manager->Send(msg_pos_rot);
+        }
+        else if (position_changed)
+        {
+            msg_pos->SetX(position.x);
+            msg_pos->SetY(position.y);
+            msg_pos->SetZ(position.z);
+            msg_pos->SetOnGround(on_ground);
+            network_manager->Send(msg_pos);
+        }
+        else if (rotation_changed)
+        {
+            msg_rot->SetYRot(yaw);
+            msg_rot->SetXRot(pitch);
+            msg_rot->SetOnGround(on_ground);
+            network_manager->Send(msg_rot);
+        }
+        else if (on_ground != last_sent_on_ground)
+        {
+            msg_status->SetOnGround(on_ground);
+            network_manager->Send(msg_status);
+        }
+
+        if (position_changed)
+        {
+            last_sent_position = position;
+            last_send = VirtualClock::now();
+        }
+        if (rotation_changed)
+        {
+            last_sent_yaw = yaw;
+            last_sent_pitch = pitch;
         }
+        last_sent_on_ground = on_ground;
     }
 
-    void PhysicsManager::Physics(const bool is_in_fluid)
+    void PhysicsManager::RecordTickJitter()
     {
-        if (!entity_manager)
+        const VirtualClock::time_point now = VirtualClock::now();
+        const VirtualClock::time_point previous = last_tick_start;
+        last_tick_start = now;
+        if (previous == VirtualClock::time_point())
         {
             return;
         }
 
-        std::shared_ptr<LocalPlayer> local_player = entity_manager->GetLocalPlayer();
-
-        //If the player did not move we assume it does not collide
-        /*if (!local_player->GetHasMoved() &&
-            abs(local_player->GetSpeed().x) < 1e-3 &&
-            abs(local_player->GetSpeed().y) < 1e-3 &&
-            abs(local_player->GetSpeed().z) < 1e-3)
+        const double jitter_ms = std::abs(std::chrono::duration<double, std::milli>(now - previous).count() - 50.0);
+        size_t bucket = 0;
+        while (bucket < PhysicsStats::num_jitter_buckets - 1 && jitter_ms > PhysicsStats::jitter_buckets_ms[bucket])
         {
-            // We could return if we were sure that we have a block under our feet
-            return;
-        }*/
+            bucket++;
+        }
+
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        stats.num_ticks++;
+        stats.jitter_counts[bucket]++;
+        stats.total_jitter_ms += jitter_ms;
+        stats.max_jitter_ms = std::max(stats.max_jitter_ms, jitter_ms);
+    }
 
-        // Player mutex is already locked by calling function
-        Position player_position(std::floor(local_player->GetX()), std::floor(local_player->GetY()), std::floor(local_player->GetX()));
-        Vector3<double> player_movement = local_player->GetSpeed() + local_player->GetPlayerInputs();
+    void PhysicsManager::ApplyCollisions(PlayerPhysicsState& state, const Vector3<double>& inputs, const Vector3<double>& half_size,
+        const bool is_in_fluid, const WorldSnapshot& world_snapshot, std::vector<AABB>& colliders) const
+    {
+        const AABB player_collider(Vector3<double>(state.position.x, state.position.y + half_size.y, state.position.z), half_size);
+        const Vector3<double> player_movement = state.speed + inputs;
         Vector3<double> min_player_collider, max_player_collider;
         for (int i = 0; i < 3; ++i)
         {
-            min_player_collider[i] = std::min(local_player->GetCollider().GetMin()[i], local_player->GetCollider().GetMin()[i] + player_movement[i]);
-            max_player_collider[i] = std::max(local_player->GetCollider().GetMax()[i], local_player->GetCollider().GetMax()[i] + player_movement[i]);
+            min_player_collider[i] = std::min(player_collider.GetMin()[i], player_collider.GetMin()[i] + player_movement[i]);
+            max_player_collider[i] = std::max(player_collider.GetMax()[i], player_collider.GetMax()[i] + player_movement[i]);
         }
 
+        MoveAndCollide(state, player_movement, half_size, min_player_collider, max_player_collider, is_in_fluid, world_snapshot, colliders);
+    }
+
+    void PhysicsManager::MoveAndCollide(PlayerPhysicsState& state, Vector3<double> player_movement, const Vector3<double>& half_size,
+        const Vector3<double>& min_player_collider, const Vector3<double>& max_player_collider,
+        const bool is_in_fluid, const WorldSnapshot& world_snapshot, std::vector<AABB>& colliders)
+    {
+        const AABB player_collider(Vector3<double>(state.position.x, state.position.y + half_size.y, state.position.z), half_size);
+        Position player_position(std::floor(state.position.x), std::floor(state.position.y), std::floor(state.position.x));
         AABB broadphase_collider = AABB((min_player_collider + max_player_collider) / 2.0, (max_player_collider - min_player_collider) / 2.0);
 
         bool has_hit_down = false;
         bool has_hit_up = false;
 
-        Position cube_pos;
+        // Gather all the world-space colliders touched by the movement once,
+        // then sweep the player against this local cache
+        colliders.clear();
+        Position cube_pos((int)std::floor(min_player_collider.x), (int)std::floor(min_player_collider.y), (int)std::floor(min_player_collider.z));
+        BlockAccessor accessor(world_snapshot, cube_pos);
         for (int x = (int)std::floor(min_player_collider.x); x < (int)std::ceil(max_player_collider.x); ++x)
         {
             cube_pos.x = x;
@@ -195,99 +398,199 @@ namespace Botcraft
                 {
                     cube_pos.z = z;
 
-                    Block block;
+                    accessor.MoveTo(cube_pos);
+                    const Block* block_ptr = accessor.Get();
+                    if (block_ptr == nullptr)
                     {
-                        std::lock_guard<std::mutex> mutex_guard(world->GetMutex());
-                        const Block* block_ptr = world->GetBlock(cube_pos);
-
-                        if (block_ptr == nullptr)
-                        {
-                            continue;
-                        }
-                        block = *block_ptr;
+                        continue;
                     }
+                    const Block& block = *block_ptr;
 
-                    if (!is_in_fluid && !block.GetBlockstate()->IsSolid())
+                    if (!is_in_fluid && !block.HasFlag(BlockstateFlag::Solid))
                     {
                         continue;
                     }
 
                     if (is_in_fluid &&
-                        !block.GetBlockstate()->IsSolid() &&
-                        (!block.GetBlockstate()->IsFluid() ||
+                        !block.HasFlag(BlockstateFlag::Solid) &&
+                        (!block.HasFlag(BlockstateFlag::Fluid) ||
                             cube_pos.y >= player_position.y))
                     {
                         continue;
                     }
 
-                    const std::vector<AABB>& block_colliders = block.GetBlockstate()->GetModel(block.GetModelId()).GetColliders();
+                    const Vector3<double> offset(cube_pos.x, cube_pos.y, cube_pos.z);
 
-                    for (int i = 0; i < block_colliders.size(); ++i)
+                    // Full cubes don't need to look at the model
+                    if (block.HasFlag(BlockstateFlag::FullCube))
                     {
-                        if (!broadphase_collider.Collide(block_colliders[i] + Vector3<double>(cube_pos.x, cube_pos.y, cube_pos.z)))
+                        const AABB collider(offset + Vector3<double>(0.5, 0.5, 0.5), Vector3<double>(0.5, 0.5, 0.5));
+                        if (broadphase_collider.Collide(collider))
                         {
-                            continue;
-                        }
-
-                        Vector3<double> normal;
-                        const double speed_fraction = local_player->GetCollider().SweptCollide(player_movement, block_colliders[i] + Vector3<double>(cube_pos.x, cube_pos.y, cube_pos.z), normal);
-
-                        if (speed_fraction < 1.0)
-                        {
-                            const Vector3<double> remaining_speed = player_movement * (1.0 - speed_fraction);
-
-                            // We remove epsilon to be sure we do not go
-                            // through the face due to numerical imprecision
-                            player_movement = player_movement * (speed_fraction - 1e-6) + // Base speed truncated
-                                (remaining_speed - normal * remaining_speed.dot(normal)); // Remaining speed projected on the plane
+                            colliders.push_back(collider);
                         }
+                        continue;
+                    }
 
-                        if (normal.y == 1.0)
-                        {
-                            has_hit_down = true;
-                        }
-                        else if (normal.y == -1.0)
+                    const std::vector<AABB>& block_colliders = Model::GetColliders(block.GetCollidersId());
+                    for (int i = 0; i < block_colliders.size(); ++i)
+                    {
+                        const AABB collider = block_colliders[i] + offset;
+                        if (broadphase_collider.Collide(collider))
                         {
-                            has_hit_up = true;
+                            colliders.push_back(collider);
                         }
-
                     }
                 }
             }
         }
-        local_player->SetPosition(local_player->GetPosition() + player_movement);
-        local_player->SetOnGround(has_hit_down);
+
+        for (size_t i = 0; i < colliders.size(); ++i)
+        {
+            Vector3<double> normal;
+            const double speed_fraction = player_collider.SweptCollide(player_movement, colliders[i], normal);
+
+            if (speed_fraction < 1.0)
+            {
+                const Vector3<double> remaining_speed = player_movement * (1.0 - speed_fraction);
+
+                // We remove epsilon to be sure we do not go
+                // through the face due to numerical imprecision
+                player_movement = player_movement * (speed_fraction - 1e-6) + // Base speed truncated
+                    (remaining_speed - normal * remaining_speed.dot(normal)); // Remaining speed projected on the plane
+            }
+
+            if (normal.y == 1.0)
+            {
+                has_hit_down = true;
+            }
+            else if (normal.y == -1.0)
+            {
+                has_hit_up = true;
+            }
+        }
+        state.position += player_movement;
+        state.on_ground = has_hit_down;
         if (has_hit_up)
         {
-            local_player->SetSpeedY(0.0);
+            state.speed.y = 0.0;
         }
     }
 
-    void PhysicsManager::UpdatePlayerSpeed() const
+    void PhysicsManager::UpdatePlayerSpeed(const PhysicsStep& step) const
     {
         // Player mutex should already locked by calling function
-        std::shared_ptr<LocalPlayer> local_player = entity_manager->GetLocalPlayer();
+        const std::shared_ptr<LocalPlayer>& local_player = step.local_player;
+
+        // Drag already computed by a PhysicsBatch, valid if
+        // the player ended up in the state it expected
+        if (step.has_next_speed &&
+            local_player->GetSpeed() == step.drag_speed &&
+            local_player->GetOnGround() == step.drag_on_ground)
+        {
+            local_player->SetSpeed(step.next_speed);
+        }
+        else
+        {
+            PlayerPhysicsState state;
+            state.position = local_player->GetPosition();
+            state.speed = local_player->GetSpeed();
+            state.on_ground = local_player->GetOnGround();
 
-        local_player->SetSpeed(Vector3<double>(local_player->GetSpeedX() * 0.91, (local_player->GetSpeedY() - 0.08) * 0.98, local_player->GetSpeedZ() * 0.91));
+            ApplyDrag(state);
 
-        if (local_player->GetOnGround())
+            local_player->SetSpeed(state.speed);
+        }
+
+        // Remove the inputs used by this step, keeping
+        // the ones added while it was computed
+        local_player->SetPlayerInputs(local_player->GetPlayerInputs() - step.inputs);
+    }
+
+    void PhysicsManager::ApplyDrag(PlayerPhysicsState& state)
+    {
+        state.speed = Vector3<double>(state.speed.x * 0.91, (state.speed.y - 0.08) * 0.98, state.speed.z * 0.91);
+
+        if (state.on_ground)
         {
             const Vector3<double> ground_drag(0.6, 0.0, 0.6);
             // TODO: adapt drag depending on blocks (slime, ice)
-            local_player->SetSpeed(local_player->GetSpeed() * ground_drag);
+            state.speed = state.speed * ground_drag;
         }
 
-        if (std::abs(local_player->GetSpeedX()) < 0.003)
+        if (std::abs(state.speed.x) < 0.003)
         {
-            local_player->SetSpeedX(0.0);
+            state.speed.x = 0.0;
         }
-        if (std::abs(local_player->GetSpeedZ()) < 0.003)
+        if (std::abs(state.speed.z) < 0.003)
         {
-            local_player->SetSpeedZ(0.0);
+            state.speed.z = 0.0;
+        }
+    }
+
+    std::array<unsigned long long, 4> PhysicsManager::GetSupportVersions(const WorldSnapshot& world_snapshot, const Vector3<double>& position, const double half_width)
+    {
+        std::array<unsigned long long, 4> output;
+        // Chunks under each corner of the player
+        for (int i = 0; i < 4; ++i)
+        {
+            const double x = position.x + ((i & 1) ? half_width : -half_width);
+            const double z = position.z + ((i & 2) ? half_width : -half_width);
+            const std::shared_ptr<const Chunk> chunk = world_snapshot.GetChunk(static_cast<int>(std::floor(x / CHUNK_WIDTH)), static_cast<int>(std::floor(z / CHUNK_WIDTH)));
+            output[i] = chunk == nullptr ? 0 : chunk->GetBlocksVersion();
+        }
+        return output;
+    }
+
+    const bool PhysicsManager::IsLoadedAndInFluid(const WorldSnapshot& world_snapshot, const Vector3<double>& position, bool& is_in_fluid)
+    {
+        const Position block_position = Position(std::floor(position.x), std::floor(position.y), std::floor(position.z));
+
+        is_in_fluid = false;
+        if (!world_snapshot.IsLoaded(block_position))
+        {
+            return false;
+        }
+
+        const Block* block_ptr = world_snapshot.GetBlock(block_position);
+        is_in_fluid = block_ptr && block_ptr->HasFlag(BlockstateFlag::Fluid);
+        return true;
+    }
+
+    const PlayerPhysicsState PhysicsManager::Simulate(const PlayerPhysicsState& initial_state, const std::vector<Vector3<double> >& inputs, const int n_ticks) const
+    {
+        PlayerPhysicsState state = initial_state;
+
+        // Player dimensions are constant, no need to lock it
+        std::shared_ptr<LocalPlayer> local_player = entity_manager->GetLocalPlayer();
+        const Vector3<double> half_size(local_player->GetWidth() / 2.0, local_player->GetHeight() / 2.0, local_player->GetWidth() / 2.0);
+
+        const WorldSnapshot world_snapshot = world->GetSnapshot();
+        const int min_y = world->GetMinY();
+        std::vector<AABB> colliders;
+
+        for (int i = 0; i < n_ticks; ++i)
+        {
+            bool is_in_fluid = false;
+            if (!IsLoadedAndInFluid(world_snapshot, state.position, is_in_fluid))
+            {
+                // Physics don't run outside of loaded chunks
+                break;
+            }
+
+            ApplyCollisions(state, i < inputs.size() ? inputs[i] : Vector3<double>(0.0), half_size, is_in_fluid, world_snapshot, colliders);
+
+            if (!should_fall_in_void && state.position.y <= min_y)
+            {
+                state.position.y = min_y;
+                state.speed.y = 0.0;
+                state.on_ground = true;
+            }
+
+            ApplyDrag(state);
         }
 
-        // Reset player inputs
-        local_player->SetPlayerInputs(Vector3<double>(0.0));
+        return state;
     }
 
 } //Botcraft
@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <exception>
+#include <functional>
+
+#include "botcraft/Game/Physics/PhysicsScheduler.hpp"
+#include "botcraft/Game/Physics/PhysicsManager.hpp"
+#include "botcraft/Game/Physics/PhysicsBatch.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/SleepUtilities.hpp"
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+
+namespace Botcraft
+{
+    PhysicsScheduler::PhysicsScheduler()
+    {
+        num_workers = 0;
+        running = false;
+        tick_index = 0;
+        num_groups = 0;
+        batch_size = 0;
+        num_tick_managers = 0;
+        num_done = 0;
+    }
+
+    PhysicsScheduler::~PhysicsScheduler()
+    {
+        Stop();
+    }
+
+    PhysicsScheduler& PhysicsScheduler::GetInstance()
+    {
+        static PhysicsScheduler instance;
+        return instance;
+    }
+
+    void PhysicsScheduler::SetNumWorkers(const unsigned int n)
+    {
+        std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex);
+        if (ticker_thread.joinable())
+        {
+            LOG_WARNING("Can't change the number of physics workers while physics are running");
+            return;
+        }
+        num_workers = n;
+    }
+
+    const unsigned int PhysicsScheduler::GetNumWorkers() const
+    {
+        return num_workers;
+    }
+
+    const bool PhysicsScheduler::IsEnabled() const
+    {
+        return num_workers > 0;
+    }
+
+    void PhysicsScheduler::SetBatchSize(const size_t n)
+    {
+        std::lock_guard<std::mutex> managers_lock(managers_mutex);
+        batch_size = n;
+    }
+
+    const size_t PhysicsScheduler::GetBatchSize() const
+    {
+        std::lock_guard<std::mutex> managers_lock(managers_mutex);
+        return batch_size;
+    }
+
+    void PhysicsScheduler::Register(PhysicsManager* manager)
+    {
+        std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex);
+        {
+            std::lock_guard<std::mutex> managers_lock(managers_mutex);
+            if (std::find_if(managers.begin(), managers.end(), [manager](const std::pair<PhysicsManager*, int>& p) { return p.first == manager; }) == managers.end())
+            {
+                managers.push_back({ manager, AffinityGroups::GetCurrentGroup() });
+            }
+        }
+
+        if (!ticker_thread.joinable())
+        {
+            Start();
+        }
+    }
+
+    void PhysicsScheduler::Unregister(PhysicsManager* manager)
+    {
+        std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex);
+        bool is_empty = false;
+        {
+            // Wait for the end of the current tick if any
+            std::lock_guard<std::mutex> managers_lock(managers_mutex);
+            managers.erase(std::remove_if(managers.begin(), managers.end(), [manager](const std::pair<PhysicsManager*, int>& p) { return p.first == manager; }), managers.end());
+            is_empty = managers.empty();
+        }
+
+        if (is_empty)
+        {
+            Stop();
+        }
+    }
+
+    const PhysicsSchedulerStats PhysicsScheduler::GetStats() const
+    {
+        std::lock_guard<std::mutex> tick_lock(tick_mutex);
+        return stats;
+    }
+
+    void PhysicsScheduler::Start()
+    {
+        {
+            std::lock_guard<std::mutex> tick_lock(tick_mutex);
+            running = true;
+            stats = PhysicsSchedulerStats();
+        }
+        {
+            std::lock_guard<std::mutex> managers_lock(managers_mutex);
+            num_groups = AffinityGroups::GetInstance().GetNumGroups();
+        }
+
+        // The ticker thread also steps managers, so only start n - 1 other workers
+        ticker_thread = std::thread(&PhysicsScheduler::RunTicker, this);
+        for (unsigned int i = 1; i < std::max(num_workers, 1u); ++i)
+        {
+            worker_threads.push_back(std::thread(&PhysicsScheduler::RunWorker, this, num_groups > 0 ? static_cast<int>(i % num_groups) : -1));
+        }
+    }
+
+    void PhysicsScheduler::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> tick_lock(tick_mutex);
+            running = false;
+        }
+        tick_condition.notify_all();
+
+        if (ticker_thread.joinable())
+        {
+            ticker_thread.join();
+        }
+        for (size_t i = 0; i < worker_threads.size(); ++i)
+        {
+            if (worker_threads[i].joinable())
+            {
+                worker_threads[i].join();
+            }
+        }
+        worker_threads.clear();
+    }
+
+    void PhysicsScheduler::RunTicker()
+    {
+        Logger::GetInstance().RegisterThread("PhysicsTicker");
+        // The ticker is the first worker
+        const int group = num_groups > 0 ? 0 : -1;
+        AffinityGroups::GetInstance().JoinGroup(group);
+
+        // Align the ticks on the clock, so all the bots move at the same time
+        VirtualClock::time_point next_tick = VirtualClock::time_point(
+            (VirtualClock::now().time_since_epoch() / tick_duration + 1) * tick_duration);
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> tick_lock(tick_mutex);
+                if (tick_condition.wait_until(tick_lock, VirtualClock::ToSteady(next_tick) - GetSleepSpinThreshold(), [this]() { return !running; }))
+                {
+                    return;
+                }
+            }
+            // Spin for the remaining time if enabled
+            SleepUntil(next_tick);
+
+            const auto tick_start = VirtualClock::now();
+            size_t num_managers = 0;
+            size_t num_batches = 0;
+            {
+                // Managers can't be unregistered during the tick
+                std::lock_guard<std::mutex> managers_lock(managers_mutex);
+                {
+                    std::lock_guard<std::mutex> tick_lock(tick_mutex);
+                    const size_t num_lists = std::max<size_t>(1, num_groups);
+                    tick_managers.resize(num_lists);
+                    for (size_t i = 0; i < num_lists; ++i)
+                    {
+                        tick_managers[i].clear();
+                    }
+                    for (size_t i = 0; i < managers.size(); ++i)
+                    {
+                        // Spread the managers without group over all the lists
+                        const int manager_group = managers[i].second;
+                        const size_t list = manager_group >= 0 && static_cast<size_t>(manager_group) < num_lists ? manager_group : i % num_lists;
+                        tick_managers[list].push_back(managers[i].first);
+                    }
+                    tick_batches.resize(num_lists);
+                    for (size_t i = 0; i < num_lists; ++i)
+                    {
+                        MakeBatches(tick_managers[i], tick_batches[i]);
+                        num_batches += tick_batches[i].size();
+                    }
+                    next_batches.assign(num_lists, 0);
+                    num_tick_managers = managers.size();
+                    num_done = 0;
+                    tick_index++;
+                }
+                num_managers = num_tick_managers;
+                tick_condition.notify_all();
+
+                StepManagers(group);
+
+                std::unique_lock<std::mutex> tick_lock(tick_mutex);
+                done_condition.wait(tick_lock, [this]() { return num_done == num_tick_managers; });
+            }
+            const auto tick_end = VirtualClock::now();
+
+            next_tick += tick_duration;
+            unsigned long long num_skipped = 0;
+            if (tick_end > next_tick)
+            {
+                num_skipped = (tick_end - next_tick) / tick_duration + 1;
+                next_tick += num_skipped * tick_duration;
+            }
+
+            {
+                std::lock_guard<std::mutex> tick_lock(tick_mutex);
+                const double duration_ms = std::chrono::duration<double, std::milli>(tick_end - tick_start).count();
+                stats.num_ticks++;
+                stats.last_tick_duration_ms = duration_ms;
+                stats.max_tick_duration_ms = std::max(stats.max_tick_duration_ms, duration_ms);
+                stats.num_managers = num_managers;
+                stats.num_batches = num_batches;
+                if (tick_end - tick_start > tick_duration)
+                {
+                    stats.num_overruns++;
+                }
+                stats.num_skipped_ticks += num_skipped;
+            }
+        }
+    }
+
+    void PhysicsScheduler::RunWorker(const int group)
+    {
+        Logger::GetInstance().RegisterThread("PhysicsWorker");
+        AffinityGroups::GetInstance().JoinGroup(group);
+
+        unsigned long long last_tick = 0;
+        {
+            std::lock_guard<std::mutex> tick_lock(tick_mutex);
+            last_tick = tick_index;
+        }
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> tick_lock(tick_mutex);
+                tick_condition.wait(tick_lock, [this, &last_tick]() { return !running || tick_index != last_tick; });
+                if (!running)
+                {
+                    return;
+                }
+                last_tick = tick_index;
+            }
+
+            StepManagers(group);
+        }
+    }
+
+    void PhysicsScheduler::StepManagers(const int group)
+    {
+        // Each thread keeps its batch buffers between ticks
+        thread_local PhysicsBatch batch;
+
+        while (true)
+        {
+            PhysicsManager* const* batch_managers = nullptr;
+            size_t num_batch_managers = 0;
+            {
+                std::lock_guard<std::mutex> tick_lock(tick_mutex);
+                // Own group first, then help the others
+                const size_t first_list = group >= 0 ? static_cast<size_t>(group) : 0;
+                for (size_t i = 0; i < tick_batches.size() && batch_managers == nullptr; ++i)
+                {
+                    const size_t list = (first_list + i) % tick_batches.size();
+                    if (next_batches[list] < tick_batches[list].size())
+                    {
+                        const std::pair<size_t, size_t>& b = tick_batches[list][next_batches[list]];
+                        batch_managers = tick_managers[list].data() + b.first;
+                        num_batch_managers = b.second;
+                        next_batches[list]++;
+                    }
+                }
+                if (batch_managers == nullptr)
+                {
+                    return;
+                }
+            }
+
+            try
+            {
+                if (num_batch_managers == 1)
+                {
+                    batch_managers[0]->Tick();
+                }
+                else
+                {
+                    batch.Tick(batch_managers, num_batch_managers);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR("Exception during physics tick: " << e.what());
+            }
+            // Anything escaping would leave num_done short and the tick thread waiting forever
+            catch (...)
+            {
+                LOG_ERROR("Unknown exception during physics tick");
+            }
+
+            bool is_tick_done = false;
+            {
+                std::lock_guard<std::mutex> tick_lock(tick_mutex);
+                num_done += num_batch_managers;
+                is_tick_done = num_done == num_tick_managers;
+            }
+            if (is_tick_done)
+            {
+                done_condition.notify_one();
+            }
+        }
+    }
+
+    void PhysicsScheduler::MakeBatches(std::vector<PhysicsManager*>& list, std::vector<std::pair<size_t, size_t> >& batches) const
+    {
+        batches.clear();
+        if (batch_size < 2)
+        {
+            for (size_t i = 0; i < list.size(); ++i)
+            {
+                batches.push_back({ i, 1 });
+            }
+            return;
+        }
+
+        std::stable_sort(list.begin(), list.end(), [](const PhysicsManager* a, const PhysicsManager* b) {
+            return std::less<const World*>()(a->world.get(), b->world.get());
+        });
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            if (batches.empty() ||
+                batches.back().second == batch_size ||
+                list[batches.back().first]->world != list[i]->world)
+            {
+                batches.push_back({ i, 0 });
+            }
+            batches.back().second++;
+        }
+    }
+} // Botcraft
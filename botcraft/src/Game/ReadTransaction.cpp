@@ -0,0 +1,151 @@
+#include <cmath>
+
+#include "botcraft/Game/ReadTransaction.hpp"
+#include "botcraft/Game/ManagersClient.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Game/Entities/EntityManager.hpp"
+#include "botcraft/Game/Inventory/InventoryManager.hpp"
+
+namespace Botcraft
+{
+    ReadTransaction::ReadTransaction(ManagersClient& client) :
+        world_snapshot(std::shared_ptr<const WorldSnapshot::Regions>()), entity_snapshot(nullptr), inventory_snapshot(nullptr)
+    {
+        world = client.GetWorld();
+        entity_manager = client.GetEntityManager();
+        inventory_manager = client.GetInventoryManager();
+
+        Refresh();
+    }
+
+    void ReadTransaction::Refresh()
+    {
+        // World and inventory changes are rare compared to entity
+        // movements, so a few attempts are enough to get them all
+        // in the same state. Otherwise, keep the last ones
+        for (int attempt = 0; attempt < 4; ++attempt)
+        {
+            if (world)
+            {
+                world_snapshot = world->GetSnapshot();
+            }
+            if (inventory_manager)
+            {
+                inventory_snapshot = inventory_manager->GetSnapshot();
+            }
+            if (entity_manager)
+            {
+                entity_snapshot = entity_manager->GetSnapshot();
+                std::shared_ptr<LocalPlayer> local_player = entity_manager->GetLocalPlayer();
+                if (local_player)
+                {
+                    player_state = local_player->GetState();
+                }
+            }
+
+            if (!IsWorldStale() && !IsInventoryStale())
+            {
+                break;
+            }
+        }
+    }
+
+    const WorldSnapshot& ReadTransaction::GetWorld() const
+    {
+        return world_snapshot;
+    }
+
+    const EntitySnapshot& ReadTransaction::GetEntities() const
+    {
+        return entity_snapshot;
+    }
+
+    const InventorySnapshot& ReadTransaction::GetInventory() const
+    {
+        return inventory_snapshot;
+    }
+
+    const LocalPlayerState& ReadTransaction::GetPlayerState() const
+    {
+        return player_state;
+    }
+
+    const bool ReadTransaction::IsWorldStale() const
+    {
+        if (!world)
+        {
+            return false;
+        }
+        return !world->GetSnapshot().IsSame(world_snapshot);
+    }
+
+    const bool ReadTransaction::IsChunkStale(const int chunk_x, const int chunk_z) const
+    {
+        if (!world)
+        {
+            return false;
+        }
+
+        const std::shared_ptr<const Chunk> current = world->GetSnapshot().GetChunk(chunk_x, chunk_z);
+        const std::shared_ptr<const Chunk> read = world_snapshot.GetChunk(chunk_x, chunk_z);
+        if (current == nullptr || read == nullptr)
+        {
+            return current != read;
+        }
+        return current->GetBlocksVersion() != read->GetBlocksVersion();
+    }
+
+    const bool ReadTransaction::IsBlockStale(const Position& pos) const
+    {
+        return IsChunkStale((int)floor(pos.x / (double)CHUNK_WIDTH), (int)floor(pos.z / (double)CHUNK_WIDTH));
+    }
+
+    const bool ReadTransaction::IsEntitiesStale() const
+    {
+        if (!entity_manager)
+        {
+            return false;
+        }
+        return entity_manager->GetSnapshot().GetEpoch() != entity_snapshot.GetEpoch();
+    }
+
+    const bool ReadTransaction::IsEntityStale(const int id) const
+    {
+        if (!entity_manager)
+        {
+            return false;
+        }
+
+        const EntitySnapshot current_snapshot = entity_manager->GetSnapshot();
+        if (current_snapshot.GetEpoch() == entity_snapshot.GetEpoch())
+        {
+            return false;
+        }
+
+        const EntitySnapshot::EntityState* current = current_snapshot.GetEntity(id);
+        const EntitySnapshot::EntityState* read = entity_snapshot.GetEntity(id);
+        if (current == nullptr || read == nullptr)
+        {
+            return current != read;
+        }
+        return current->entity != read->entity ||
+            current->position != read->position ||
+            current->yaw != read->yaw ||
+            current->pitch != read->pitch ||
+            current->on_ground != read->on_ground;
+    }
+
+    const bool ReadTransaction::IsInventoryStale() const
+    {
+        if (!inventory_manager)
+        {
+            return false;
+        }
+        return inventory_manager->GetVersion() != inventory_snapshot.GetEpoch();
+    }
+
+    const bool ReadTransaction::IsStale() const
+    {
+        return IsWorldStale() || IsInventoryStale() || IsEntitiesStale();
+    }
+} // Botcraft
@@ -3,6 +3,8 @@
 
 #include "botcraft/Game/World/Biome.hpp"
 
+using namespace ProtocolCraft;
+
 namespace Botcraft
 {
     // The corners of the triangle defining grass and leaves colors in the following order:
@@ -22,12 +24,36 @@ namespace Botcraft
 
         default_grass = ComputeColorTriangle(0, true);
         default_leaves = ComputeColorTriangle(0, false);
+
+        // Colors are asked for each rendered face, compute them once
+        for (int i = 0; i < num_precomputed_heights; ++i)
+        {
+            grass_colors[i] = ComputeColorMultiplier(sea_level + 1 + i, true);
+            leaves_colors[i] = ComputeColorMultiplier(sea_level + 1 + i, false);
+        }
     }
 
     Biome::~Biome()
     {
     }
 
+    void Biome::Write(WriteContainer& container) const
+    {
+        WriteData<std::string>(name, container);
+        WriteData<float>(temperature, container);
+        WriteData<float>(rainfall, container);
+        WriteData<char>(static_cast<char>(biome_type), container);
+    }
+
+    std::unique_ptr<Biome> Biome::Read(ReadIterator& iter, size_t& length)
+    {
+        const std::string name_ = ReadData<std::string>(iter, length);
+        const float temperature_ = ReadData<float>(iter, length);
+        const float rainfall_ = ReadData<float>(iter, length);
+        const BiomeType biome_type_ = static_cast<BiomeType>(ReadData<char>(iter, length));
+        return std::make_unique<Biome>(name_, temperature_, rainfall_, biome_type_);
+    }
+
     const unsigned int Biome::GetColorMultiplier(const int height, const bool is_grass) const
     {
         if (height <= sea_level)
@@ -42,6 +68,16 @@ namespace Botcraft
             }
         }
 
+        const int index = height - sea_level - 1;
+        if (index < num_precomputed_heights)
+        {
+            return is_grass ? grass_colors[index] : leaves_colors[index];
+        }
+        return ComputeColorMultiplier(height, is_grass);
+    }
+
+    const unsigned int Biome::ComputeColorMultiplier(const int height, const bool is_grass) const
+    {
 
         switch (biome_type)
         {
@@ -9,34 +9,18 @@ namespace Botcraft
         ChangeBlockstate(id_, metadata_);
     }
 
-    void Block::ChangeBlockstate(const int id_, const unsigned char metadata_, const int model_id_, const Position* pos)
+    void Block::ChangeBlockstate(const int id_, const unsigned char metadata_, const int model_id_)
     {
-        auto &blockstates_map = AssetsManager::getInstance().Blockstates();
-        auto it = blockstates_map.find(id_);
-        if (it != blockstates_map.end())
-        {
-            auto it2 = it->second.find(metadata_);
-            if (it2 != it->second.end())
-            {
-                blockstate = it2->second.get();
-            }
-            else
-            {
-                blockstate = it->second.at(0).get();
-            }
-        }
-        else
-        {
-            blockstate = blockstates_map.at(-1).at(0).get();
-        }
-        if (model_id_ < 0)
-        {
-            model_id = blockstate->GetRandomModelId();
-        }
-        else
-        {
-            model_id = model_id_;
-        }
+        const AssetsManager& assets_manager = AssetsManager::getInstance();
+        const int id = Blockstate::IdMetadataToId(id_, metadata_);
+        blockstate = assets_manager.GetBlockstate(id);
+        flags = assets_manager.GetBlockstateFlags(id);
+#if USE_GUI
+        model_id = static_cast<short>(model_id_ < 0 ? -1 : model_id_);
+#endif
+        // Random variants of a blockstate share the same colliders
+        const int colliders_model = model_id_ < 0 ? 0 : model_id_;
+        colliders_id = colliders_model < blockstate->GetNumModels() ? blockstate->GetModel(colliders_model).GetCollidersId() : 0;
     }
 #else
     Block::Block(const int id_)
@@ -44,29 +28,32 @@ namespace Botcraft
         ChangeBlockstate(id_);
     }
 
-    void Block::ChangeBlockstate(const int id_, const int model_id_, const Position* pos)
+    void Block::ChangeBlockstate(const int id_, const int model_id_)
     {
         // For air we know there is no model, so we can optimize this
         if (id_ == 0)
         {
             static const Blockstate* air_blockstate = AssetsManager::getInstance().Blockstates().at(0).get();
+            static const unsigned short air_flags = AssetsManager::getInstance().GetBlockstateFlags(0);
             blockstate = air_blockstate;
-            model_id = model_id_;
+            flags = air_flags;
+#if USE_GUI
+            model_id = static_cast<short>(model_id_ < 0 ? -1 : model_id_);
+#endif
+            colliders_id = 0;
             return;
         }
 
-        auto &blockstates_map = AssetsManager::getInstance().Blockstates();
-        auto it = blockstates_map.find(id_);
-        if (it != blockstates_map.end())
-        {
-            blockstate = it->second.get();
-        }
-        else
-        {
-            blockstate = blockstates_map.at(-1).get();
-        }
+        const AssetsManager& assets_manager = AssetsManager::getInstance();
+        blockstate = assets_manager.GetBlockstate(id_);
+        flags = assets_manager.GetBlockstateFlags(id_);
 
-        model_id = model_id_ < 0 ? blockstate->GetRandomModelId(pos) : model_id_;
+#if USE_GUI
+        model_id = static_cast<short>(model_id_ < 0 ? -1 : model_id_);
+#endif
+        // Random variants of a blockstate share the same colliders
+        const int colliders_model = model_id_ < 0 ? 0 : model_id_;
+        colliders_id = colliders_model < blockstate->GetNumModels() ? blockstate->GetModel(colliders_model).GetCollidersId() : 0;
     }
 #endif
 
@@ -75,8 +62,37 @@ namespace Botcraft
         return blockstate;
     }
 
-    const unsigned short Block::GetModelId() const
+    const int Block::GetModelId() const
     {
+#if USE_GUI
         return model_id;
+#else
+        return -1;
+#endif
+    }
+
+    const int Block::GetModelId(const Position& pos) const
+    {
+        const int forced_model_id = GetModelId();
+        if (forced_model_id >= 0)
+        {
+            return forced_model_id;
+        }
+        return blockstate->GetNumModels() > 1 ? blockstate->GetRandomModelId(&pos) : 0;
+    }
+
+    const unsigned short Block::GetCollidersId() const
+    {
+        return colliders_id;
+    }
+
+    const unsigned short Block::GetFlags() const
+    {
+        return flags;
+    }
+
+    const bool Block::HasFlag(const BlockstateFlag flag) const
+    {
+        return flags & static_cast<unsigned short>(flag);
     }
 } //Botcraft
@@ -0,0 +1,154 @@
+#include "botcraft/Game/World/BlockAccessor.hpp"
+#include "botcraft/Game/World/Section.hpp"
+#include "botcraft/Game/World/WorldSnapshot.hpp"
+
+namespace Botcraft
+{
+    BlockAccessor::BlockAccessor(const WorldSnapshot& snapshot_, const Position& pos)
+    {
+        snapshot = &snapshot_;
+        position = pos;
+        chunk = nullptr;
+        section = nullptr;
+        Resolve();
+    }
+
+    const Position& BlockAccessor::GetPosition() const
+    {
+        return position;
+    }
+
+    void BlockAccessor::MoveTo(const Position& pos)
+    {
+        position = pos;
+        if ((pos.x >> 4) != section_coords.x ||
+            (pos.y >> 4) != section_coords.y ||
+            (pos.z >> 4) != section_coords.z)
+        {
+            Resolve();
+        }
+    }
+
+    void BlockAccessor::Move(const int dx, const int dy, const int dz)
+    {
+        MoveTo(Position(position.x + dx, position.y + dy, position.z + dz));
+    }
+
+    const bool BlockAccessor::IsLoaded() const
+    {
+        return chunk != nullptr;
+    }
+
+    const Block* BlockAccessor::Get() const
+    {
+        if (section == nullptr)
+        {
+            return nullptr;
+        }
+        return section->GetBlock(GetIndex(position.x & 0xF, position.y & 0xF, position.z & 0xF));
+    }
+
+    const Block* BlockAccessor::GetRelative(const int dx, const int dy, const int dz) const
+    {
+        const int x = position.x + dx;
+        const int y = position.y + dy;
+        const int z = position.z + dz;
+        const Position coords(x >> 4, y >> 4, z >> 4);
+        const Section* s = coords == section_coords ? section : FindSection(coords);
+        if (s == nullptr)
+        {
+            return nullptr;
+        }
+        return s->GetBlock(GetIndex(x & 0xF, y & 0xF, z & 0xF));
+    }
+
+    void BlockAccessor::GetNeighbourhood(std::array<const Block*, 27>& blocks) const
+    {
+        const int local_x = position.x & 0xF;
+        const int local_y = position.y & 0xF;
+        const int local_z = position.z & 0xF;
+
+        // Fast path, all the neighbours are in the current section
+        if (local_x > 0 && local_x < CHUNK_WIDTH - 1 &&
+            local_y > 0 && local_y < SECTION_HEIGHT - 1 &&
+            local_z > 0 && local_z < CHUNK_WIDTH - 1)
+        {
+            if (section == nullptr)
+            {
+                blocks.fill(nullptr);
+                return;
+            }
+            int i = 0;
+            for (int y = local_y - 1; y <= local_y + 1; ++y)
+            {
+                for (int z = local_z - 1; z <= local_z + 1; ++z)
+                {
+                    for (int x = local_x - 1; x <= local_x + 1; ++x)
+                    {
+                        blocks[i++] = section->GetBlock(GetIndex(x, y, z));
+                    }
+                }
+            }
+            return;
+        }
+
+        // On a border, each of the up to 8 sections touched is resolved only once
+        std::array<const Section*, 27> sections;
+        std::array<bool, 27> resolved;
+        resolved.fill(false);
+        int i = 0;
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const int x = position.x + dx;
+                    const int y = position.y + dy;
+                    const int z = position.z + dz;
+                    const Position offset((x >> 4) - section_coords.x, (y >> 4) - section_coords.y, (z >> 4) - section_coords.z);
+                    const int s = (offset.y + 1) * 9 + (offset.z + 1) * 3 + (offset.x + 1);
+                    if (!resolved[s])
+                    {
+                        sections[s] = s == 13 ? section : FindSection(section_coords + offset);
+                        resolved[s] = true;
+                    }
+                    blocks[i++] = sections[s] == nullptr ? nullptr : sections[s]->GetBlock(GetIndex(x & 0xF, y & 0xF, z & 0xF));
+                }
+            }
+        }
+    }
+
+    void BlockAccessor::Resolve()
+    {
+        const Position coords(position.x >> 4, position.y >> 4, position.z >> 4);
+        if (chunk == nullptr || coords.x != section_coords.x || coords.z != section_coords.z)
+        {
+            chunk = snapshot->GetChunk(coords.x, coords.z).get();
+        }
+        section_coords = coords;
+
+        section = nullptr;
+        if (chunk != nullptr && position.y >= chunk->GetMinY() && position.y < chunk->GetMinY() + chunk->GetHeight())
+        {
+            section = chunk->GetSection((position.y - chunk->GetMinY()) / SECTION_HEIGHT);
+        }
+    }
+
+    const Section* BlockAccessor::FindSection(const Position& coords) const
+    {
+        const Chunk* c = (coords.x == section_coords.x && coords.z == section_coords.z) ?
+            chunk : snapshot->GetChunk(coords.x, coords.z).get();
+        const int y = coords.y * SECTION_HEIGHT;
+        if (c == nullptr || y < c->GetMinY() || y >= c->GetMinY() + c->GetHeight())
+        {
+            return nullptr;
+        }
+        return c->GetSection((y - c->GetMinY()) / SECTION_HEIGHT);
+    }
+
+    int BlockAccessor::GetIndex(const int x, const int y, const int z)
+    {
+        return (y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x;
+    }
+} // Botcraft
@@ -13,6 +13,8 @@
 #include "botcraft/Renderer/Atlas.hpp"
 #endif
 
+using namespace ProtocolCraft;
+
 namespace Botcraft
 {
     // Utilities functions
@@ -43,7 +45,7 @@ namespace Botcraft
 
         if (rotation_x != 0)
         {
-            std::vector<AABB> &colliders = output.GetColliders();
+            std::vector<AABB> colliders = output.GetColliders();
 
             for (int i = 0; i < colliders.size(); ++i)
             {
@@ -75,11 +77,12 @@ namespace Botcraft
                     break;
                 }
             }
+            output.SetColliders(colliders);
         }
 
         if (rotation_y != 0)
         {
-            std::vector<AABB> &colliders = output.GetColliders();
+            std::vector<AABB> colliders = output.GetColliders();
 
             for (int i = 0; i < colliders.size(); ++i)
             {
@@ -111,6 +114,7 @@ namespace Botcraft
                     break;
                 }
             }
+            output.SetColliders(colliders);
         }
 
 #ifdef USE_GUI
@@ -576,6 +580,78 @@ namespace Botcraft
         models = { model_ };
     }
 
+    void Blockstate::Write(WriteContainer& container) const
+    {
+        WriteData<int>(static_cast<int>(id), container);
+#if PROTOCOL_VERSION < 347
+        WriteData<unsigned char>(metadata, container);
+#endif
+        WriteData<bool>(transparent, container);
+        WriteData<bool>(solid, container);
+        WriteData<bool>(fluid, container);
+        WriteData<float>(hardness, container);
+        WriteData<char>(static_cast<char>(tint_type), container);
+        WriteData<std::string>(m_name, container);
+
+        WriteData<VarInt>(static_cast<int>(models.size()), container);
+        for (size_t i = 0; i < models.size(); ++i)
+        {
+            models[i].Write(container);
+            WriteData<VarInt>(models_weights[i], container);
+        }
+
+        WriteData<VarInt>(static_cast<int>(variables.size()), container);
+        for (auto it = variables.begin(); it != variables.end(); ++it)
+        {
+            WriteData<std::string>(it->first, container);
+            WriteData<std::string>(it->second, container);
+        }
+    }
+
+    std::unique_ptr<Blockstate> Blockstate::Read(ReadIterator& iter, size_t& length)
+    {
+        const int id_ = ReadData<int>(iter, length);
+#if PROTOCOL_VERSION < 347
+        const unsigned char metadata_ = ReadData<unsigned char>(iter, length);
+#endif
+        const bool transparent_ = ReadData<bool>(iter, length);
+        const bool solid_ = ReadData<bool>(iter, length);
+        const bool fluid_ = ReadData<bool>(iter, length);
+        const float hardness_ = ReadData<float>(iter, length);
+        const TintType tint_type_ = static_cast<TintType>(ReadData<char>(iter, length));
+        const std::string name_ = ReadData<std::string>(iter, length);
+
+#if PROTOCOL_VERSION < 347
+        std::unique_ptr<Blockstate> blockstate = std::make_unique<Blockstate>(id_, metadata_, transparent_, solid_, fluid_, hardness_, tint_type_, name_, Model());
+#else
+        std::unique_ptr<Blockstate> blockstate = std::make_unique<Blockstate>(id_, transparent_, solid_, fluid_, hardness_, tint_type_, name_, Model());
+#endif
+
+        const int num_models = ReadData<VarInt>(iter, length);
+        if (num_models < 0)
+        {
+            throw(std::runtime_error("Wrong number of models when reading blockstate " + name_));
+        }
+        blockstate->models.clear();
+        blockstate->models_weights.clear();
+        blockstate->weights_sum = 0;
+        for (int i = 0; i < num_models; ++i)
+        {
+            blockstate->models.push_back(Model::Read(iter, length));
+            blockstate->models_weights.push_back(ReadData<VarInt>(iter, length));
+            blockstate->weights_sum += blockstate->models_weights.back();
+        }
+
+        const int num_variables = ReadData<VarInt>(iter, length);
+        for (int i = 0; i < num_variables; ++i)
+        {
+            const std::string key = ReadData<std::string>(iter, length);
+            blockstate->variables[key] = ReadData<std::string>(iter, length);
+        }
+
+        return blockstate;
+    }
+
     const unsigned int Blockstate::GetId() const
     {
         return id;
@@ -659,6 +735,24 @@ namespace Botcraft
         return tint_type;
     }
 
+    const size_t Blockstate::GetMemoryUsage() const
+    {
+        size_t output = sizeof(Blockstate) + m_name.capacity() +
+            models.capacity() * sizeof(Model) + models_weights.capacity() * sizeof(int);
+        for (auto it = variables.begin(); it != variables.end(); ++it)
+        {
+            // Hash nodes have a pointer to the next one on top of the value
+            output += sizeof(void*) + sizeof(std::pair<const std::string, std::string>) + it->first.capacity() + it->second.capacity();
+        }
+#if USE_GUI
+        for (const Model& m : models)
+        {
+            output += m.GetFaces().capacity() * sizeof(FaceDescriptor);
+        }
+#endif
+        return output;
+    }
+
 #if PROTOCOL_VERSION < 347
     const unsigned int Blockstate::IdMetadataToId(const unsigned int id_, const unsigned char metadata_)
     {
@@ -678,6 +772,14 @@ namespace Botcraft
     }
 
 #if USE_GUI
+    void Blockstate::ClearRenderingData()
+    {
+        for (auto& m : models)
+        {
+            m.ClearRenderingData();
+        }
+    }
+
     void Blockstate::UpdateModelsWithAtlasData(const Renderer::Atlas* atlas)
     {
         for (auto& m : models)
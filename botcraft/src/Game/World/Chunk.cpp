@@ -2,7 +2,11 @@
 #include "botcraft/Game/World/Section.hpp"
 #include "botcraft/Utilities/Logger.hpp"
 
-#include "protocolCraft/Types/NBT/TagInt.hpp"
+#include "protocolCraft/Types/NBT/FlatNBT.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
 
 using namespace ProtocolCraft;
 
@@ -17,6 +21,107 @@ namespace Botcraft
         GlobalPalette
     };
 
+    static bool EndsWith(const std::string& s, const std::string& suffix)
+    {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    /// @brief Get the kind of block entity attached to a block, from the block name
+    static BlockEntityType GetBlockEntityTypeFromBlock(const Block* block)
+    {
+        if (block == nullptr || block->GetBlockstate() == nullptr)
+        {
+            return BlockEntityType::Other;
+        }
+
+        const std::string& name = block->GetBlockstate()->GetName();
+        if ((EndsWith(name, "chest") && name != "minecraft:ender_chest") || name == "minecraft:barrel")
+        {
+            return BlockEntityType::Chest;
+        }
+        if (EndsWith(name, "sign"))
+        {
+            return BlockEntityType::Sign;
+        }
+        if (EndsWith(name, "furnace") || name == "minecraft:smoker")
+        {
+            return BlockEntityType::Furnace;
+        }
+        if (EndsWith(name, "spawner"))
+        {
+            return BlockEntityType::Spawner;
+        }
+        return BlockEntityType::Other;
+    }
+
+#if PROTOCOL_VERSION > 756
+    /// @brief Unpack all the palette indices of a section data array.
+    /// Entries don't span across multiple longs. With a compile time
+    /// entry size, the inner loop has a fixed count and constant
+    /// shifts and can be unrolled/vectorized by the compiler
+    template<unsigned char BitsPerEntry>
+    static void UnpackPaletteIndices(const std::vector<unsigned long long int>& data_array, unsigned short* out, const int num_entries)
+    {
+        static constexpr int entries_per_long = 64 / BitsPerEntry;
+        static constexpr unsigned long long int mask = (1ULL << BitsPerEntry) - 1;
+
+        const size_t num_full_longs = std::min(data_array.size(), static_cast<size_t>(num_entries / entries_per_long));
+        int index = 0;
+        for (size_t i = 0; i < num_full_longs; ++i)
+        {
+            const unsigned long long int value = data_array[i];
+            for (int j = 0; j < entries_per_long; ++j)
+            {
+                out[index + j] = static_cast<unsigned short>((value >> (j * BitsPerEntry)) & mask);
+            }
+            index += entries_per_long;
+        }
+
+        // Last partially filled long
+        if (num_full_longs < data_array.size())
+        {
+            const unsigned long long int value = data_array[num_full_longs];
+            for (int j = 0; index < num_entries && j < entries_per_long; ++j, ++index)
+            {
+                out[index] = static_cast<unsigned short>((value >> (j * BitsPerEntry)) & mask);
+            }
+        }
+
+        // Missing data (should not happen with a valid packet)
+        for (; index < num_entries; ++index)
+        {
+            out[index] = 0;
+        }
+    }
+
+    static void UnpackPaletteIndices(const unsigned char bits_per_entry, const std::vector<unsigned long long int>& data_array, unsigned short* out, const int num_entries)
+    {
+        switch (bits_per_entry)
+        {
+        case 4: UnpackPaletteIndices<4>(data_array, out, num_entries); break;
+        case 5: UnpackPaletteIndices<5>(data_array, out, num_entries); break;
+        case 6: UnpackPaletteIndices<6>(data_array, out, num_entries); break;
+        case 7: UnpackPaletteIndices<7>(data_array, out, num_entries); break;
+        case 8: UnpackPaletteIndices<8>(data_array, out, num_entries); break;
+        case 9: UnpackPaletteIndices<9>(data_array, out, num_entries); break;
+        case 10: UnpackPaletteIndices<10>(data_array, out, num_entries); break;
+        case 11: UnpackPaletteIndices<11>(data_array, out, num_entries); break;
+        case 12: UnpackPaletteIndices<12>(data_array, out, num_entries); break;
+        case 13: UnpackPaletteIndices<13>(data_array, out, num_entries); break;
+        case 14: UnpackPaletteIndices<14>(data_array, out, num_entries); break;
+        case 15: UnpackPaletteIndices<15>(data_array, out, num_entries); break;
+        case 16: UnpackPaletteIndices<16>(data_array, out, num_entries); break;
+        default:
+            LOG_ERROR("Unsupported number of bits per block in chunk data: " << static_cast<int>(bits_per_entry));
+            std::fill(out, out + num_entries, 0);
+            break;
+        }
+    }
+#endif
+
+    // Shared by all the chunks, so a blocks version is never reused
+    static std::atomic<unsigned long long> blocks_version_counter(0);
+
 #if PROTOCOL_VERSION < 719
     Chunk::Chunk(const Dimension &dim)
 #elif PROTOCOL_VERSION < 757
@@ -31,14 +136,25 @@ namespace Botcraft
         min_y = min_y_;
 #endif
 #if PROTOCOL_VERSION < 358
-        biomes = std::vector<unsigned char>(CHUNK_WIDTH * CHUNK_WIDTH, 0);
+        biomes = std::make_shared<Biomes>(CHUNK_WIDTH * CHUNK_WIDTH, 0);
 #elif PROTOCOL_VERSION < 552
-        biomes = std::vector<int>(CHUNK_WIDTH * CHUNK_WIDTH, 0);
+        biomes = std::make_shared<Biomes>(CHUNK_WIDTH * CHUNK_WIDTH, 0);
+#elif PROTOCOL_VERSION < 757
+        // Each section has 64 biomes, one for each 4*4*4 cubes
+        biomes = std::make_shared<Biomes>(64 * height / SECTION_HEIGHT, 0);
 #else
         // Each section has 64 biomes, one for each 4*4*4 cubes
-        biomes = std::vector<int>(64 * height / SECTION_HEIGHT, 0);
+        SectionBiomes default_biomes;
+        default_biomes.palette = std::vector<int>(1, 0);
+        biomes = std::make_shared<Biomes>(height / SECTION_HEIGHT, default_biomes);
 #endif
+        block_entities_data = std::make_shared<std::vector<BlockEntity> >();
         sections = std::vector<std::shared_ptr<Section> >(height / SECTION_HEIGHT);
+        for (auto& h : heightmaps)
+        {
+            h.fill(0);
+        }
+        BumpBlocksVersion();
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -48,35 +164,142 @@ namespace Botcraft
     Chunk::Chunk(const Chunk& c)
     {
         dimension = c.dimension;
-        biomes = c.biomes;
 
 #if PROTOCOL_VERSION > 756
         height = c.height;
         min_y = c.min_y;
 #endif
 
-        sections = std::vector<std::shared_ptr<Section> >(height / SECTION_HEIGHT);
-        for (int i = 0; i < c.sections.size(); i++)
+        // Sections are shared with c and copied
+        // on write (see GetWritableSection)
+        sections = c.sections;
+        // Same for biomes and block entities
+        biomes = c.biomes;
+        block_entities_data = c.block_entities_data;
+        blocks_version = c.blocks_version;
+        heightmaps = c.heightmaps;
+
+#if USE_GUI
+        modified_since_last_rendered = c.modified_since_last_rendered;
+#endif
+    }
+
+    const Position Chunk::BlockCoordsToChunkCoords(const Position& pos)
+    {
+        return Position(static_cast<int>(floor(pos.x / (double)CHUNK_WIDTH)), 0, static_cast<int>(floor(pos.z / (double)CHUNK_WIDTH)));
+    }
+
+    void Chunk::Write(WriteContainer& container) const
+    {
+#if PROTOCOL_VERSION < 719
+        WriteData<int>(static_cast<int>(dimension), container);
+#else
+        WriteData<std::string>(dimension, container);
+#endif
+#if PROTOCOL_VERSION > 756
+        WriteData<int>(min_y, container);
+        WriteData<int>(height, container);
+#endif
+
+#if PROTOCOL_VERSION < 757
+        const int num_biomes = static_cast<int>(biomes->size());
+#else
+        const int num_biomes = static_cast<int>(64 * biomes->size());
+#endif
+        WriteData<VarInt>(num_biomes, container);
+        for (int i = 0; i < num_biomes; ++i)
         {
-            if (c.sections[i] == nullptr)
-            {
-                sections[i] = nullptr;
-            }
-            else
+#if PROTOCOL_VERSION < 358
+            WriteData<unsigned char>((*biomes)[i], container);
+#elif PROTOCOL_VERSION < 757
+            WriteData<VarInt>((*biomes)[i], container);
+#else
+            WriteData<VarInt>(GetBiome(i), container);
+#endif
+        }
+
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            WriteData<bool>(sections[i] != nullptr, container);
+            if (sections[i])
             {
-                sections[i] = std::make_shared<Section>(*c.sections[i]);
+                sections[i]->Write(container);
             }
         }
 
-        for (auto it = c.block_entities_data.begin(); it != c.block_entities_data.end(); it++)
+        WriteData<VarInt>(static_cast<int>(block_entities_data->size()), container);
+        for (const BlockEntity& block_entity : *block_entities_data)
         {
-            block_entities_data[it->first] = std::make_shared<NBT>(*it->second);
+            WriteData<int>(block_entity.index & 0x0F, container);
+            WriteData<int>(static_cast<int>(block_entity.index >> 8) + min_y, container);
+            WriteData<int>((block_entity.index >> 4) & 0x0F, container);
+            block_entity.data->Write(container);
         }
     }
 
-    const Position Chunk::BlockCoordsToChunkCoords(const Position& pos)
+    std::shared_ptr<Chunk> Chunk::Read(ReadIterator& iter, size_t& length)
     {
-        return Position(static_cast<int>(floor(pos.x / (double)CHUNK_WIDTH)), 0, static_cast<int>(floor(pos.z / (double)CHUNK_WIDTH)));
+#if PROTOCOL_VERSION < 719
+        const Dimension dim = static_cast<Dimension>(ReadData<int>(iter, length));
+#else
+        const std::string dim = ReadData<std::string>(iter, length);
+#endif
+#if PROTOCOL_VERSION > 756
+        const int min_y_ = ReadData<int>(iter, length);
+        const int height_ = ReadData<int>(iter, length);
+        if (height_ <= 0 || height_ % SECTION_HEIGHT != 0)
+        {
+            throw(std::runtime_error("Wrong chunk height when reading chunk (" + std::to_string(height_) + ")"));
+        }
+        std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>(min_y_, height_, dim);
+#else
+        std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>(dim);
+#endif
+
+        const int num_biomes = ReadData<VarInt>(iter, length);
+#if PROTOCOL_VERSION < 757
+        if (num_biomes < 0 || static_cast<size_t>(num_biomes) != chunk->biomes->size())
+#else
+        if (num_biomes < 0 || static_cast<size_t>(num_biomes) != 64 * chunk->biomes->size())
+#endif
+        {
+            throw(std::runtime_error("Wrong number of biomes when reading chunk (" + std::to_string(num_biomes) + ")"));
+        }
+        for (int i = 0; i < num_biomes; ++i)
+        {
+#if PROTOCOL_VERSION < 358
+            (*chunk->biomes)[i] = ReadData<unsigned char>(iter, length);
+#elif PROTOCOL_VERSION < 757
+            (*chunk->biomes)[i] = ReadData<VarInt>(iter, length);
+#else
+            chunk->SetBiome(i, ReadData<VarInt>(iter, length));
+#endif
+        }
+
+        for (size_t i = 0; i < chunk->sections.size(); ++i)
+        {
+            if (ReadData<bool>(iter, length))
+            {
+                chunk->AddSection(static_cast<int>(i));
+                chunk->GetWritableSection(static_cast<int>(i))->Read(iter, length);
+            }
+        }
+
+        const int num_block_entities = ReadData<VarInt>(iter, length);
+        for (int i = 0; i < num_block_entities; ++i)
+        {
+            Position pos;
+            pos.x = ReadData<int>(iter, length);
+            pos.y = ReadData<int>(iter, length);
+            pos.z = ReadData<int>(iter, length);
+            std::shared_ptr<NBT> block_entity = std::make_shared<NBT>();
+            block_entity->Read(iter, length);
+            chunk->InsertBlockEntity(pos, block_entity);
+        }
+
+        chunk->ComputeHeightmaps();
+
+        return chunk;
     }
 
     const int Chunk::GetMinY() const
@@ -110,7 +333,8 @@ namespace Botcraft
     void Chunk::LoadChunkData(const std::vector<unsigned char>& data, const std::vector<unsigned long long int>& primary_bit_mask)
 #endif
     {
-        std::vector<unsigned char>::const_iterator iter = data.begin();
+        BumpBlocksVersion();
+        ProtocolCraft::ReadIterator iter = data.data();
         size_t length = data.size();
 
         if (data.size() == 0)
@@ -247,44 +471,14 @@ namespace Botcraft
 
 #if PROTOCOL_VERSION <= 404
             //Block light
-            for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
-            {
-                pos.y = block_y + sectionY * SECTION_HEIGHT + min_y;
-                for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                {
-                    pos.z = block_z;
-                    for (int block_x = 0; block_x < CHUNK_WIDTH; block_x += 2)
-                    {
-                        pos.x = block_x;
-                        unsigned char two_light_values = ReadData<unsigned char>(iter, length);
-
-                        SetBlockLight(pos, two_light_values & 0x0F);
-                        pos.x = block_x + 1;
-                        SetBlockLight(pos, (two_light_values >> 4) & 0x0F);
-                    }
-                }
-            }
+            const std::vector<unsigned char> block_light = ReadByteArray(iter, length, Section::NUM_BLOCKS / 2);
+            SetSectionLight(sectionY, block_light.data(), false);
 
             //Sky light
             if (GetDimension() == Dimension::Overworld)
             {
-                for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
-                {
-                    pos.y = block_y + sectionY * SECTION_HEIGHT + min_y;
-                    for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                    {
-                        pos.z = block_z;
-                        for (int block_x = 0; block_x < CHUNK_WIDTH; block_x += 2)
-                        {
-                            pos.x = block_x;
-                            unsigned char two_light_values = ReadData<unsigned char>(iter, length);
-
-                            SetSkyLight(pos, two_light_values & 0x0F);
-                            pos.x = block_x + 1;
-                            SetSkyLight(pos, (two_light_values >> 4) & 0x0F);
-                        }
-                    }
-                }
+                const std::vector<unsigned char> sky_light = ReadByteArray(iter, length, Section::NUM_BLOCKS / 2);
+                SetSectionLight(sectionY, sky_light.data(), true);
             }
 #endif
         }
@@ -306,6 +500,10 @@ namespace Botcraft
             }
         }
 #endif
+#if PROTOCOL_VERSION < 443
+        // No heightmaps sent by the server before 1.14
+        ComputeHeightmaps();
+#endif
 #if USE_GUI
         modified_since_last_rendered = true;
 #endif
@@ -313,7 +511,8 @@ namespace Botcraft
 #else
     void Chunk::LoadChunkData(const std::vector<unsigned char>& data)
     {
-        std::vector<unsigned char>::const_iterator iter = data.begin();
+        BumpBlocksVersion();
+        ProtocolCraft::ReadIterator iter = data.data();
         size_t length = data.size();
 
         if (data.size() == 0)
@@ -359,9 +558,6 @@ namespace Botcraft
                 break;
             }
 
-            //A mask 0...01..1 with bits_per_block ones
-            unsigned int individual_value_mask = (unsigned int)((1 << bits_per_block) - 1);
-
             //Data array length
             int data_array_size = ReadData<VarInt>(iter, length);
 
@@ -373,56 +569,13 @@ namespace Botcraft
             }
 
             //Blocks data
-            int bit_offset = 0;
-            Position pos;
             if (block_count != 0)
             {
-                for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
+                if (palette_type == Palette::SingleValue)
                 {
-                    pos.y = block_y + sectionY * SECTION_HEIGHT + min_y;
-                    for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                    {
-                        pos.z = block_z;
-                        for (int block_x = 0; block_x < CHUNK_WIDTH; ++block_x)
-                        {
-                            pos.x = block_x;
-                            if (palette_type == Palette::SingleValue)
-                            {
-                                SetBlock(pos, palette_value);
-                                continue;
-                            }
-
-                            // Entries don't span across multiple longs
-                            if (64 - (bit_offset % 64) < bits_per_block)
-                            {
-                                bit_offset += 64 - (bit_offset % 64);
-                            }
-                            int start_long_index = bit_offset / 64;
-                            int end_long_index = start_long_index;
-                            int start_offset = bit_offset % 64;
-                            bit_offset += bits_per_block;
-
-                            unsigned int raw_id;
-                            if (start_long_index == end_long_index)
-                            {
-                                raw_id = (unsigned int)(data_array[start_long_index] >> start_offset);
-                            }
-                            else
-                            {
-                                int end_offset = 64 - start_offset;
-                                raw_id = (unsigned int)(data_array[start_long_index] >> start_offset | data_array[end_long_index] << end_offset);
-                            }
-                            raw_id &= individual_value_mask;
-
-                            if (palette_type == Palette::SectionPalette)
-                            {
-                                raw_id = palette[raw_id];
-                            }
-
-                            SetBlock(pos, raw_id);
-                        }
-                    }
+                    palette = std::vector<int>(1, palette_value);
                 }
+                LoadSectionBlocks(sectionY, palette_type == Palette::SingleValue ? 0 : bits_per_block, palette, data_array);
             }
             else
             {
@@ -430,93 +583,106 @@ namespace Botcraft
             }
 
 
-            // Paletted biomes
-            unsigned char bits_per_biome = ReadData<unsigned char>(iter, length);
+            // Paletted biomes, kept packed until queried
+            SectionBiomes& section_biomes = GetWritableBiomes()[sectionY];
+            section_biomes.bits_per_entry = ReadData<unsigned char>(iter, length);
 
-            palette_type = (bits_per_biome == 0 ? Palette::SingleValue : (bits_per_biome <= 3 ? Palette::SectionPalette : Palette::GlobalPalette));
+            palette_type = (section_biomes.bits_per_entry == 0 ? Palette::SingleValue : (section_biomes.bits_per_entry <= 3 ? Palette::SectionPalette : Palette::GlobalPalette));
 
             switch (palette_type)
             {
             case Botcraft::Palette::SingleValue:
-                palette_value = ReadData<VarInt>(iter, length);
+                section_biomes.palette = std::vector<int>(1, ReadData<VarInt>(iter, length));
                 break;
             case Botcraft::Palette::SectionPalette:
                 palette_length = ReadData<VarInt>(iter, length);
-                palette = std::vector<int>(palette_length);
+                section_biomes.palette = std::vector<int>(palette_length);
                 for (int i = 0; i < palette_length; ++i)
                 {
-                    palette[i] = ReadData<VarInt>(iter, length);
+                    section_biomes.palette[i] = ReadData<VarInt>(iter, length);
                 }
                 break;
             case Botcraft::Palette::GlobalPalette:
+                section_biomes.palette.clear();
                 break;
             default:
                 break;
             }
 
-            //A mask 0...01..1 with bits_per_biome ones
-            individual_value_mask = (unsigned int)((1 << bits_per_biome) - 1);
-
             //Data array length
             data_array_size = ReadData<VarInt>(iter, length);
 
             //Data array
-            data_array = std::vector<unsigned long long int>(data_array_size);
+            section_biomes.data = std::vector<unsigned long long int>(data_array_size);
             for (int i = 0; i < data_array_size; ++i)
             {
-                data_array[i] = ReadData<unsigned long long int>(iter, length);
+                section_biomes.data[i] = ReadData<unsigned long long int>(iter, length);
             }
+        }
+#if USE_GUI
+        modified_since_last_rendered = true;
+#endif
+    }
+
+    void Chunk::LoadSectionBlocks(const int section_y, const unsigned char bits_per_block, const std::vector<int>& palette, const std::vector<unsigned long long int>& data_array)
+    {
+        static constexpr int num_blocks = CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT;
+
+        // Raw network values, either index in palette or global ids
+        std::vector<unsigned short> raw_values(num_blocks, 0);
+        if (bits_per_block != 0)
+        {
+            UnpackPaletteIndices(bits_per_block, data_array, raw_values.data(), num_blocks);
+        }
 
-            //Biomes data
-            bit_offset = 0;
-            for (int block_y = 0; block_y < SECTION_HEIGHT / 4; ++block_y)
+        // With a global palette, build a local palette with the ids used
+        std::vector<int> global_palette;
+        if (bits_per_block != 0 && palette.empty())
+        {
+            std::unordered_map<unsigned short, unsigned short> global_to_local;
+            for (int i = 0; i < num_blocks; ++i)
             {
-                for (int block_z = 0; block_z < CHUNK_WIDTH / 4; ++block_z)
+                auto it = global_to_local.find(raw_values[i]);
+                if (it == global_to_local.end())
                 {
-                    for (int block_x = 0; block_x < CHUNK_WIDTH / 4; ++block_x)
-                    {
-                        const int biome_index = sectionY * 64 + block_y * 16 + block_z * 4 + block_x;
-                        if (palette_type == Palette::SingleValue)
-                        {
-                            SetBiome(biome_index, palette_value);
-                            continue;
-                        }
-
-                        // Entries don't span across multiple longs
-                        if (64 - (bit_offset % 64) < bits_per_biome)
-                        {
-                            bit_offset += 64 - (bit_offset % 64);
-                        }
-                        int start_long_index = bit_offset / 64;
-                        int end_long_index = start_long_index;
-                        int start_offset = bit_offset % 64;
-                        bit_offset += bits_per_biome;
+                    it = global_to_local.insert({ raw_values[i], static_cast<unsigned short>(global_palette.size()) }).first;
+                    global_palette.push_back(raw_values[i]);
+                }
+                raw_values[i] = it->second;
+            }
+        }
+        const std::vector<int>& network_palette = palette.empty() ? global_palette : palette;
 
-                        unsigned int raw_id;
-                        if (start_long_index == end_long_index)
-                        {
-                            raw_id = (unsigned int)(data_array[start_long_index] >> start_offset);
-                        }
-                        else
-                        {
-                            int end_offset = 64 - start_offset;
-                            raw_id = (unsigned int)(data_array[start_long_index] >> start_offset | data_array[end_long_index] << end_offset);
-                        }
-                        raw_id &= individual_value_mask;
+        // Resolve each palette entry only once. Model variants are
+        // picked from the position by the renderer, so one network
+        // palette entry is one section palette entry
+        std::vector<Block> section_palette(network_palette.size());
+        for (size_t i = 0; i < network_palette.size(); ++i)
+        {
+            section_palette[i].ChangeBlockstate(network_palette[i]);
+        }
 
-                        if (palette_type == Palette::SectionPalette)
-                        {
-                            raw_id = palette[raw_id];
-                        }
+        std::vector<unsigned short> indices(num_blocks);
+        for (int i = 0; i < num_blocks; ++i)
+        {
+            indices[i] = raw_values[i] < network_palette.size() ? raw_values[i] : 0;
+        }
 
-                        SetBiome(biome_index, raw_id);
-                    }
+        if (!sections[section_y])
+        {
+            // Single value sections (mostly stone or water) are
+            // shared, until some block or light is set inside
+            if (section_palette.size() == 1)
+            {
+                sections[section_y] = Section::GetSingleValueSection(section_palette[0]);
+                if (sections[section_y])
+                {
+                    return;
                 }
             }
+            AddSection(section_y);
         }
-#if USE_GUI
-        modified_since_last_rendered = true;
-#endif
+        GetWritableSection(section_y)->SetBlocks(section_palette, indices);
     }
 #endif
 
@@ -527,27 +693,27 @@ namespace Botcraft
 #endif
     {
         // Block entities data
-        block_entities_data.clear();
+        GetWritableBlockEntities().clear();
 
         for (int i = 0; i < block_entities.size(); ++i)
         {
 #if PROTOCOL_VERSION < 757
             if (block_entities[i].HasData())
             {
-                std::shared_ptr<TagInt> tag_x = std::dynamic_pointer_cast<TagInt>(block_entities[i].GetTag("x"));
-                std::shared_ptr<TagInt> tag_y = std::dynamic_pointer_cast<TagInt>(block_entities[i].GetTag("y"));
-                std::shared_ptr<TagInt> tag_z = std::dynamic_pointer_cast<TagInt>(block_entities[i].GetTag("z"));
+                const FlatTag tag_x = block_entities[i].GetFlatTag("x");
+                const FlatTag tag_y = block_entities[i].GetFlatTag("y");
+                const FlatTag tag_z = block_entities[i].GetFlatTag("z");
 
-                if (tag_x && tag_y && tag_z)
+                if (tag_x.GetType() == TagType::Int && tag_y.GetType() == TagType::Int && tag_z.GetType() == TagType::Int)
                 {
-                    block_entities_data[Position((tag_x->GetValue() % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, tag_y->GetValue(), (tag_z->GetValue() % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH)] = std::make_shared<NBT>(block_entities[i]);
+                    InsertBlockEntity(Position((tag_x.GetInt() % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, tag_y.GetInt(), (tag_z.GetInt() % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH), std::make_shared<NBT>(block_entities[i]));
                 }
             }
 #else
-            const int x = (block_entities[i].GetPackedXZ() & 15) << 4;
-            const int z = (block_entities[i].GetPackedXZ() & 15);
-            // And what about the type ???
-            block_entities_data[Position((x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, block_entities[i].GetY(), (z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH)] = std::make_shared<NBT>(block_entities[i].GetTag());
+            // Packed as x << 4 | z, both in chunk coordinates
+            const int x = (block_entities[i].GetPackedXZ() >> 4) & 15;
+            const int z = block_entities[i].GetPackedXZ() & 15;
+            InsertBlockEntity(Position(x, block_entities[i].GetY(), z), std::make_shared<NBT>(block_entities[i].GetTag()));
 #endif
         }
 
@@ -558,12 +724,12 @@ namespace Botcraft
 
     void Chunk::SetBlockEntityData(const Position& pos, const ProtocolCraft::NBT& block_entity)
     {
-        if (pos.x < -1 || pos.x > CHUNK_WIDTH || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < -1 || pos.z > CHUNK_WIDTH)
+        if (pos.x < 0 || pos.x > CHUNK_WIDTH - 1 || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < 0 || pos.z > CHUNK_WIDTH - 1)
         {
             return;
         }
 
-        block_entities_data[pos] = std::make_shared<NBT>(block_entity);
+        InsertBlockEntity(pos, std::make_shared<NBT>(block_entity));
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -572,23 +738,125 @@ namespace Botcraft
 
     void Chunk::RemoveBlockEntityData(const Position& pos)
     {
-        block_entities_data.erase(pos);
+        const BlockEntity* block_entity = FindBlockEntity(pos);
+        if (block_entity != nullptr)
+        {
+            const size_t index = block_entity - block_entities_data->data();
+            std::vector<BlockEntity>& writable_block_entities = GetWritableBlockEntities();
+            writable_block_entities.erase(writable_block_entities.begin() + index);
+        }
     }
 
     const std::shared_ptr<NBT> Chunk::GetBlockEntityData(const Position& pos) const
     {
-        auto it = block_entities_data.find(pos);
-        if (it == block_entities_data.end())
+        const BlockEntity* block_entity = FindBlockEntity(pos);
+        if (block_entity == nullptr)
+        {
+            return nullptr;
+        }
+
+        return block_entity->data;
+    }
+
+    const BlockEntityType Chunk::GetBlockEntityType(const Position& pos) const
+    {
+        const BlockEntity* block_entity = FindBlockEntity(pos);
+        return block_entity == nullptr ? BlockEntityType::None : block_entity->type;
+    }
+
+    const std::vector<Position> Chunk::GetBlockEntitiesPositions(const BlockEntityType type) const
+    {
+        std::vector<Position> output;
+        for (const BlockEntity& block_entity : *block_entities_data)
+        {
+            if (block_entity.type == type)
+            {
+                output.emplace_back(block_entity.index & 0x0F, static_cast<int>(block_entity.index >> 8) + min_y, (block_entity.index >> 4) & 0x0F);
+            }
+        }
+        return output;
+    }
+
+    const std::array<std::string, 4> Chunk::GetSignText(const Position& pos) const
+    {
+        std::array<std::string, 4> output;
+        const BlockEntity* block_entity = FindBlockEntity(pos);
+        if (block_entity == nullptr || block_entity->type != BlockEntityType::Sign)
+        {
+            return output;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            const FlatTag line = block_entity->data->GetFlatTag("Text" + std::to_string(i + 1));
+            if (line.GetType() == TagType::String)
+            {
+                output[i] = line.GetString();
+            }
+        }
+        return output;
+    }
+
+    const std::string Chunk::GetSpawnerEntity(const Position& pos) const
+    {
+        const BlockEntity* block_entity = FindBlockEntity(pos);
+        if (block_entity == nullptr || block_entity->type != BlockEntityType::Spawner)
+        {
+            return "";
+        }
+
+        FlatTag spawn_data = block_entity->data->GetFlatTag("SpawnData");
+#if PROTOCOL_VERSION > 756
+        // Entity data are in a sub compound since 1.18
+        spawn_data = spawn_data.GetChild("entity");
+#endif
+        const FlatTag id = spawn_data.GetChild("id");
+        return id.GetType() == TagType::String ? id.GetString() : "";
+    }
+
+    const BlockEntity* Chunk::FindBlockEntity(const Position& pos) const
+    {
+        if (pos.x < 0 || pos.x > CHUNK_WIDTH - 1 || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < 0 || pos.z > CHUNK_WIDTH - 1)
+        {
+            return nullptr;
+        }
+
+        const unsigned int index = static_cast<unsigned int>(pos.y - min_y) << 8 | pos.z << 4 | pos.x;
+        auto it = std::lower_bound(block_entities_data->begin(), block_entities_data->end(), index,
+            [](const BlockEntity& b, const unsigned int i) { return b.index < i; });
+        if (it == block_entities_data->end() || it->index != index)
         {
             return nullptr;
         }
+        return &(*it);
+    }
+
+    void Chunk::InsertBlockEntity(const Position& pos, const std::shared_ptr<NBT>& data)
+    {
+        if (pos.x < 0 || pos.x > CHUNK_WIDTH - 1 || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < 0 || pos.z > CHUNK_WIDTH - 1)
+        {
+            return;
+        }
 
-        return it->second;
+        const unsigned int index = static_cast<unsigned int>(pos.y - min_y) << 8 | pos.z << 4 | pos.x;
+        const BlockEntityType type = GetBlockEntityTypeFromBlock(GetBlock(pos));
+        std::vector<BlockEntity>& writable_block_entities = GetWritableBlockEntities();
+        auto it = std::lower_bound(writable_block_entities.begin(), writable_block_entities.end(), index,
+            [](const BlockEntity& b, const unsigned int i) { return b.index < i; });
+        if (it != writable_block_entities.end() && it->index == index)
+        {
+            it->type = type;
+            it->data = data;
+        }
+        else
+        {
+            writable_block_entities.insert(it, BlockEntity{ index, type, data });
+        }
     }
 
     const Block *Chunk::GetBlock(const Position &pos) const
     {
-        if (pos.x < -1 || pos.x > CHUNK_WIDTH || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < -1 || pos.z > CHUNK_WIDTH)
+        if (pos.x < 0 || pos.x > CHUNK_WIDTH - 1 || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < 0 || pos.z > CHUNK_WIDTH - 1)
         {
             return nullptr;
         }
@@ -598,7 +866,7 @@ namespace Botcraft
             return nullptr;
         }
 
-        return sections[(pos.y - min_y) / SECTION_HEIGHT]->data_blocks.data() + (((pos.y - min_y) % SECTION_HEIGHT) * (CHUNK_WIDTH + 2) * (CHUNK_WIDTH + 2) + (pos.z + 1) * (CHUNK_WIDTH + 2) + pos.x + 1);
+        return sections[(pos.y - min_y) / SECTION_HEIGHT]->GetBlock(((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x);
     }
 
 #if PROTOCOL_VERSION < 347
@@ -607,7 +875,7 @@ namespace Botcraft
     void Chunk::SetBlock(const Position &pos, const unsigned int id, const int model_id)
 #endif
     {
-        if (pos.x < -1 || pos.x > CHUNK_WIDTH || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < -1 || pos.z > CHUNK_WIDTH)
+        if (pos.x < 0 || pos.x > CHUNK_WIDTH - 1 || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < 0 || pos.z > CHUNK_WIDTH - 1)
         {
             return;
         }
@@ -623,15 +891,28 @@ namespace Botcraft
                 AddSection((pos.y - min_y) / SECTION_HEIGHT);
             }
         }
-        Block *block = sections[(pos.y - min_y) / SECTION_HEIGHT]->data_blocks.data() + (((pos.y - min_y) % SECTION_HEIGHT) * (CHUNK_WIDTH + 2) * (CHUNK_WIDTH + 2) + (pos.z + 1) * (CHUNK_WIDTH + 2) + pos.x + 1);
-
+        const int section_y = (pos.y - min_y) / SECTION_HEIGHT;
+        const int block_index = ((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x;
 
+        Block block;
 #if PROTOCOL_VERSION < 347
-        block->ChangeBlockstate(id, metadata, model_id, &pos);
+        block.ChangeBlockstate(id, metadata, model_id);
 #else
-        block->ChangeBlockstate(id, model_id, &pos);
+        block.ChangeBlockstate(id, model_id);
 #endif
 
+        // Don't copy a shared section if nothing changes
+        const Block* current_block = sections[section_y]->GetBlock(block_index);
+        if (current_block->GetBlockstate() == block.GetBlockstate() &&
+            current_block->GetModelId() == block.GetModelId())
+        {
+            return;
+        }
+
+        GetWritableSection(section_y)->SetBlock(block_index, block);
+        UpdateHeightmaps(pos, block.GetFlags());
+        BumpBlocksVersion();
+
 #if USE_GUI
         modified_since_last_rendered = true;
 #endif
@@ -656,6 +937,70 @@ namespace Botcraft
 #endif
         }
     }
+
+    const bool Chunk::SetSectionBlocks(const int section_y, const std::vector<std::pair<int, unsigned int> >& blocks)
+    {
+        if (section_y < 0 || section_y >= sections.size())
+        {
+            return false;
+        }
+
+        // Only made writable once a block actually changes
+        Section* section = nullptr;
+        for (const auto& b : blocks)
+        {
+            const int block_index = b.first;
+
+            Block block;
+#if PROTOCOL_VERSION < 347
+            unsigned int id;
+            unsigned char metadata;
+            Blockstate::IdToIdMetadata(b.second, id, metadata);
+            block.ChangeBlockstate(id, metadata);
+#else
+            const unsigned int id = b.second;
+            block.ChangeBlockstate(id);
+#endif
+
+            if (!sections[section_y])
+            {
+                if (id == 0)
+                {
+                    continue;
+                }
+                AddSection(section_y);
+            }
+
+            const Block* current_block = sections[section_y]->GetBlock(block_index);
+            if (current_block->GetBlockstate() == block.GetBlockstate() &&
+                current_block->GetModelId() == block.GetModelId())
+            {
+                continue;
+            }
+
+            if (section == nullptr)
+            {
+                section = GetWritableSection(section_y);
+            }
+            section->SetBlock(block_index, block);
+            UpdateHeightmaps(Position(
+                block_index % CHUNK_WIDTH,
+                min_y + section_y * SECTION_HEIGHT + block_index / (CHUNK_WIDTH * CHUNK_WIDTH),
+                (block_index / CHUNK_WIDTH) % CHUNK_WIDTH), block.GetFlags());
+        }
+
+        if (section == nullptr)
+        {
+            return false;
+        }
+
+        BumpBlocksVersion();
+#if USE_GUI
+        modified_since_last_rendered = true;
+#endif
+        return true;
+    }
+
     const unsigned char Chunk::GetBlockLight(const Position &pos) const
     {
         if (pos.x < 0 || pos.x > CHUNK_WIDTH - 1 || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < 0 || pos.z > CHUNK_WIDTH - 1)
@@ -668,7 +1013,7 @@ namespace Botcraft
             return 0;
         }
 
-        return sections[(pos.y - min_y) / SECTION_HEIGHT]->block_light[((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x];
+        return sections[(pos.y - min_y) / SECTION_HEIGHT]->GetBlockLight(((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x);
     }
 
     void Chunk::SetBlockLight(const Position &pos, const unsigned char v)
@@ -683,7 +1028,7 @@ namespace Botcraft
             AddSection((pos.y - min_y)/ SECTION_HEIGHT);
         }
 
-        sections[(pos.y - min_y) / SECTION_HEIGHT]->block_light[((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x] = v;
+        GetWritableSection((pos.y - min_y) / SECTION_HEIGHT)->SetBlockLight(((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x, v);
 
         // Not necessary as we don't render lights
 //#if USE_GUI
@@ -708,7 +1053,7 @@ namespace Botcraft
             return 0;
         }
 
-        return sections[(pos.y - min_y) / SECTION_HEIGHT]->sky_light[((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x];
+        return sections[(pos.y - min_y) / SECTION_HEIGHT]->GetSkyLight(((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x);
     }
 
     void Chunk::SetSkyLight(const Position &pos, const unsigned char v)
@@ -728,13 +1073,54 @@ namespace Botcraft
             AddSection((pos.y - min_y) / SECTION_HEIGHT);
         }
 
-        sections[(pos.y - min_y) / SECTION_HEIGHT]->block_light[((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x] = v;
+        GetWritableSection((pos.y - min_y) / SECTION_HEIGHT)->SetSkyLight(((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x, v);
         // Not necessary as we don't render lights
 //#if USE_GUI
 //        modified_since_last_rendered = true;
 //#endif
     }
 
+    void Chunk::SetSectionLight(const int y, const unsigned char* data, const bool sky)
+    {
+        if (y < 0 || y >= sections.size())
+        {
+            return;
+        }
+
+#if PROTOCOL_VERSION < 719
+        if (sky && dimension != Dimension::Overworld)
+#else
+        if (sky && dimension != "minecraft:overworld")
+#endif
+        {
+            return;
+        }
+
+        // Don't copy a shared section to set values it already has
+        const bool dark = data == nullptr || std::all_of(data, data + Section::NUM_BLOCKS / 2, [](const unsigned char c) { return c == 0; });
+        if (!sections[y])
+        {
+            if (dark)
+            {
+                return;
+            }
+            AddSection(y);
+        }
+        else if (dark && !(sky ? sections[y]->HasSkyLightData() : sections[y]->HasBlockLightData()))
+        {
+            return;
+        }
+
+        if (sky)
+        {
+            GetWritableSection(y)->SetSkyLightData(data);
+        }
+        else
+        {
+            GetWritableSection(y)->SetBlockLightData(data);
+        }
+    }
+
 #if PROTOCOL_VERSION < 358
     const unsigned char Chunk::GetBiome(const int x, const int z) const
     {
@@ -743,7 +1129,7 @@ namespace Botcraft
             return 0;
         }
 
-        return biomes[z * CHUNK_WIDTH + x];
+        return (*biomes)[z * CHUNK_WIDTH + x];
     }
 
     void Chunk::SetBiome(const int x, const int z, const unsigned char b)
@@ -753,7 +1139,7 @@ namespace Botcraft
             return;
         }
 
-        biomes[z * CHUNK_WIDTH + x] = b;
+        GetWritableBiomes()[z * CHUNK_WIDTH + x] = b;
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -768,7 +1154,7 @@ namespace Botcraft
             return 0;
         }
 
-        return biomes[z * CHUNK_WIDTH + x];
+        return (*biomes)[z * CHUNK_WIDTH + x];
     }
 
     void Chunk::SetBiome(const int x, const int z, const int b)
@@ -778,7 +1164,57 @@ namespace Botcraft
             return;
         }
 
-        biomes[z * CHUNK_WIDTH + x] = b;
+        GetWritableBiomes()[z * CHUNK_WIDTH + x] = b;
+
+#if USE_GUI
+        modified_since_last_rendered = true;
+#endif
+    }
+#elif PROTOCOL_VERSION < 757
+    const int Chunk::GetBiome(const int x, const int y, const int z) const
+    {
+        // y / 4 * 16 + z / 4 * 4 + x / 4
+        return GetBiome((((y - min_y) >> 2) & 63) << 4 | ((z >> 2) & 3) << 2 | ((x >> 2) & 3));
+    }
+
+    const int Chunk::GetBiome(const int i) const
+    {
+        if (i < 0 || i > biomes->size() - 1)
+        {
+            return 0;
+        }
+
+        return (*biomes)[i];
+    }
+
+    void Chunk::SetBiomes(const std::vector<int>& new_biomes)
+    {
+        if (new_biomes.size() != 64 * height / SECTION_HEIGHT)
+        {
+            LOG_ERROR("Trying to set biomes with a wrong size");
+            return;
+        }
+        biomes = std::make_shared<Biomes>(new_biomes);
+
+#if USE_GUI
+        modified_since_last_rendered = true;
+#endif
+    }
+
+    void Chunk::SetBiome(const int x, const int y, const int z, const int new_biome)
+    {
+        // y / 4 * 16 + z / 4 * 4 + x / 4
+        SetBiome((((y - min_y) >> 2) & 63) << 4 | ((z >> 2) & 3) << 2 | ((x >> 2) & 3), new_biome);
+    }
+
+    void Chunk::SetBiome(const int i, const int new_biome)
+    {
+        if (i < 0 || i > biomes->size() - 1)
+        {
+            return;
+        }
+
+        GetWritableBiomes()[i] = new_biome;
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -793,12 +1229,12 @@ namespace Botcraft
 
     const int Chunk::GetBiome(const int i) const
     {
-        if (i < 0 || i > biomes.size() - 1)
+        if (i < 0 || i >= 64 * biomes->size())
         {
             return 0;
         }
 
-        return biomes[i];
+        return (*biomes)[i >> 6].Get(i & 63);
     }
 
     void Chunk::SetBiomes(const std::vector<int>& new_biomes)
@@ -808,7 +1244,11 @@ namespace Botcraft
             LOG_ERROR("Trying to set biomes with a wrong size");
             return;
         }
-        biomes = new_biomes;
+        Biomes& writable_biomes = GetWritableBiomes();
+        for (size_t i = 0; i < new_biomes.size(); ++i)
+        {
+            writable_biomes[i >> 6].Set(i & 63, new_biomes[i]);
+        }
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -823,194 +1263,384 @@ namespace Botcraft
 
     void Chunk::SetBiome(const int i, const int new_biome)
     {
-        if (i < 0 || i > biomes.size() - 1)
+        if (i < 0 || i >= 64 * biomes->size())
         {
             return;
         }
 
-        biomes[i] = new_biome;
+        GetWritableBiomes()[i >> 6].Set(i & 63, new_biome);
 
 #if USE_GUI
         modified_since_last_rendered = true;
 #endif
     }
+
+    const int Chunk::SectionBiomes::Get(const int i) const
+    {
+        const unsigned int raw = GetRaw(i);
+        if (palette.empty())
+        {
+            return static_cast<int>(raw);
+        }
+        return raw < palette.size() ? palette[raw] : 0;
+    }
+
+    void Chunk::SectionBiomes::Set(const int i, const int biome)
+    {
+        // Global ids
+        if (palette.empty())
+        {
+            unsigned char needed_bits = std::max(bits_per_entry, static_cast<unsigned char>(1));
+            while (needed_bits < 32 && (static_cast<unsigned int>(biome) >> needed_bits) != 0)
+            {
+                needed_bits += 1;
+            }
+            if (needed_bits != bits_per_entry)
+            {
+                Grow(needed_bits);
+            }
+            SetRaw(i, static_cast<unsigned int>(biome));
+            return;
+        }
+
+        const size_t index = std::find(palette.begin(), palette.end(), biome) - palette.begin();
+        if (index == palette.size())
+        {
+            palette.push_back(biome);
+            if (palette.size() > (1ULL << bits_per_entry))
+            {
+                Grow(bits_per_entry + 1);
+            }
+        }
+        if (bits_per_entry == 0)
+        {
+            return;
+        }
+        SetRaw(i, static_cast<unsigned int>(index));
+    }
+
+    const unsigned int Chunk::SectionBiomes::GetRaw(const int i) const
+    {
+        if (bits_per_entry == 0)
+        {
+            return 0;
+        }
+        const int entries_per_long = 64 / bits_per_entry;
+        const size_t long_index = i / entries_per_long;
+        if (long_index >= data.size())
+        {
+            return 0;
+        }
+        return static_cast<unsigned int>(data[long_index] >> ((i % entries_per_long) * bits_per_entry)) & ((1U << bits_per_entry) - 1);
+    }
+
+    void Chunk::SectionBiomes::SetRaw(const int i, const unsigned int raw)
+    {
+        const int entries_per_long = 64 / bits_per_entry;
+        const int shift = (i % entries_per_long) * bits_per_entry;
+        const unsigned long long int mask = ((1ULL << bits_per_entry) - 1) << shift;
+        unsigned long long int& packed = data[i / entries_per_long];
+        packed = (packed & ~mask) | ((static_cast<unsigned long long int>(raw) << shift) & mask);
+    }
+
+    void Chunk::SectionBiomes::Grow(const unsigned char new_bits_per_entry)
+    {
+        std::array<unsigned int, 64> raw_values;
+        for (int i = 0; i < 64; ++i)
+        {
+            raw_values[i] = GetRaw(i);
+        }
+
+        bits_per_entry = new_bits_per_entry;
+        const int entries_per_long = 64 / bits_per_entry;
+        data = std::vector<unsigned long long int>((64 + entries_per_long - 1) / entries_per_long, 0);
+        for (int i = 0; i < 64; ++i)
+        {
+            SetRaw(i, raw_values[i]);
+        }
+    }
 #endif
 
-    void Chunk::UpdateNeighbour(const std::shared_ptr<Chunk> neighbour, const Orientation direction)
+#if PROTOCOL_VERSION < 719
+    const Dimension Chunk::GetDimension() const
+#else
+    const std::string& Chunk::GetDimension() const
+#endif
+    {
+        return dimension;
+    }
+
+    const std::vector<BlockEntity>& Chunk::GetBlockEntitiesData() const
+    {
+        return *block_entities_data;
+    }
+
+    const bool Chunk::HasSection(const int y) const
+    {
+        return sections[y] != nullptr;
+    }
+
+    const Section* Chunk::GetSection(const int y) const
     {
-        Position this_dest_position = Position(0, 0, 0);
-        Position this_src_position = Position(0, 0, 0);
-        Position neighbour_dest_position = Position(0, 0, 0);
-        Position neighbour_src_position = Position(0, 0, 0);
-        switch (direction)
+        if (y < 0 || y >= sections.size())
         {
-            // The neighbour is on "the left" on the x axis
-        case Orientation::West:
-            this_dest_position.x = -1;
-            this_src_position.x = 0;
-            neighbour_src_position.x = CHUNK_WIDTH - 1;
-            neighbour_dest_position.x = CHUNK_WIDTH;
+            return nullptr;
+        }
 
-            for (int y = min_y; y < height + min_y; ++y)
+        return sections[y].get();
+    }
+
+    const size_t Chunk::GetNumSections() const
+    {
+        size_t output = 0;
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            output += sections[i] != nullptr;
+        }
+        return output;
+    }
+
+    const size_t Chunk::GetMemoryUsage() const
+    {
+        return GetDetailedMemoryUsage().total;
+    }
+
+    const ChunkMemoryUsage Chunk::GetDetailedMemoryUsage() const
+    {
+        ChunkMemoryUsage output;
+        output.total = sizeof(Chunk) + sections.capacity() * sizeof(std::shared_ptr<Section>) +
+#if PROTOCOL_VERSION < 358
+            biomes->capacity();
+#elif PROTOCOL_VERSION < 757
+            biomes->capacity() * sizeof(int);
+#else
+            biomes->capacity() * sizeof(SectionBiomes);
+        for (size_t i = 0; i < biomes->size(); ++i)
+        {
+            output.total += (*biomes)[i].palette.capacity() * sizeof(int) + (*biomes)[i].data.capacity() * sizeof(unsigned long long int);
+        }
+#endif
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            if (sections[i] != nullptr)
             {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int z = 0; z < CHUNK_WIDTH; ++z)
-                {
-                    this_dest_position.z = z;
-                    this_src_position.z = z;
-                    neighbour_src_position.z = z;
-                    neighbour_dest_position.z = z;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
-                    {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
-                    {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
-                    }
-                }
+                const size_t light = sections[i]->GetLightMemoryUsage();
+                output.sections += sections[i]->GetMemoryUsage() - light;
+                output.light += light;
             }
-            break;
-            // The neighbour is on "the right" on the x axis
-        case Orientation::East:
-            this_dest_position.x = CHUNK_WIDTH;
-            this_src_position.x = CHUNK_WIDTH - 1;
-            neighbour_src_position.x = 0;
-            neighbour_dest_position.x = -1;
-
-            for (int y = min_y; y < height + min_y; ++y)
-            {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int z = 0; z < CHUNK_WIDTH; ++z)
+        }
+        output.block_entities = block_entities_data->capacity() * sizeof(BlockEntity);
+        for (const BlockEntity& b : *block_entities_data)
+        {
+            if (b.data != nullptr)
+            {
+                output.block_entities += b.data->GetMemoryUsage();
+            }
+        }
+        output.total += output.sections + output.light + output.block_entities;
+        return output;
+    }
+
+    void Chunk::AddSection(const int y)
+    {
+        // Shared until something is written in it
+        sections[y] = Section::GetSingleValueSection();
+        BumpBlocksVersion();
+    }
+
+    // Whether a block with these flags is counted in a heightmap
+    static const bool MatchesHeightmap(const unsigned short flags, const HeightmapType type)
+    {
+        switch (type)
+        {
+        case HeightmapType::WorldSurface:
+            return !(flags & static_cast<unsigned short>(BlockstateFlag::Air));
+        case HeightmapType::MotionBlocking:
+            return flags & (static_cast<unsigned short>(BlockstateFlag::Solid) | static_cast<unsigned short>(BlockstateFlag::Fluid));
+        default:
+            return false;
+        }
+    }
+
+    const int Chunk::GetHighestBlock(const int x, const int z, const HeightmapType type) const
+    {
+        if (x < 0 || x > CHUNK_WIDTH - 1 || z < 0 || z > CHUNK_WIDTH - 1)
+        {
+            return min_y - 1;
+        }
+        return min_y + heightmaps[static_cast<int>(type)][z * CHUNK_WIDTH + x] - 1;
+    }
+
+    const std::array<unsigned short, CHUNK_WIDTH * CHUNK_WIDTH>& Chunk::GetHeightmap(const HeightmapType type) const
+    {
+        return heightmaps[static_cast<int>(type)];
+    }
+
+#if PROTOCOL_VERSION > 442
+    void Chunk::LoadHeightmaps(const NBT& heightmaps_nbt)
+    {
+        // Values go from 0 to height included
+        int bits_per_entry = 0;
+        while ((1 << bits_per_entry) < height + 1)
+        {
+            bits_per_entry += 1;
+        }
+        const unsigned long long int mask = (1ULL << bits_per_entry) - 1;
+
+        bool missing = false;
+        for (const HeightmapType type : { HeightmapType::WorldSurface, HeightmapType::MotionBlocking })
+        {
+            const FlatTag tag = heightmaps_nbt.GetFlatTag(type == HeightmapType::WorldSurface ? "WORLD_SURFACE" : "MOTION_BLOCKING");
+            if (!tag.IsValid() || tag.GetType() != TagType::LongArray)
+            {
+                missing = true;
+                continue;
+            }
+            const std::vector<long long int> data = tag.GetLongArray();
+#if PROTOCOL_VERSION > 712
+            // Entries don't span across multiple longs
+            const int entries_per_long = 64 / bits_per_entry;
+            if (data.size() * entries_per_long < CHUNK_WIDTH * CHUNK_WIDTH)
+#else
+            if (data.size() * 64 < CHUNK_WIDTH * CHUNK_WIDTH * bits_per_entry)
+#endif
+            {
+                missing = true;
+                continue;
+            }
+
+            std::array<unsigned short, CHUNK_WIDTH * CHUNK_WIDTH>& heightmap = heightmaps[static_cast<int>(type)];
+            for (int i = 0; i < CHUNK_WIDTH * CHUNK_WIDTH; ++i)
+            {
+#if PROTOCOL_VERSION > 712
+                const unsigned long long int value = static_cast<unsigned long long int>(data[i / entries_per_long]) >> ((i % entries_per_long) * bits_per_entry);
+#else
+                const int bit_offset = i * bits_per_entry;
+                unsigned long long int value = static_cast<unsigned long long int>(data[bit_offset / 64]) >> (bit_offset % 64);
+                if (bit_offset % 64 + bits_per_entry > 64)
                 {
-                    this_dest_position.z = z;
-                    this_src_position.z = z;
-                    neighbour_src_position.z = z;
-                    neighbour_dest_position.z = z;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
-                    {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
-                    {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
-                    }
+                    value |= static_cast<unsigned long long int>(data[bit_offset / 64 + 1]) << (64 - bit_offset % 64);
                 }
+#endif
+                heightmap[i] = static_cast<unsigned short>(std::min(value & mask, static_cast<unsigned long long int>(height)));
             }
-            break;
-            // The neighbour is on "the left" on the z axis
-        case Orientation::North:
-            this_dest_position.z = -1;
-            this_src_position.z = 0;
-            neighbour_src_position.z = CHUNK_WIDTH - 1;
-            neighbour_dest_position.z = CHUNK_WIDTH;
-
-            for (int y = min_y; y < height + min_y; ++y)
-            {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int x = 0; x < CHUNK_WIDTH; ++x)
+        }
+
+        if (missing)
+        {
+            ComputeHeightmaps();
+        }
+    }
+#endif
+
+    void Chunk::ComputeHeightmaps()
+    {
+        for (auto& h : heightmaps)
+        {
+            h.fill(0);
+        }
+
+        // Number of (column, heightmap) without value yet
+        int remaining = static_cast<int>(heightmaps.size()) * CHUNK_WIDTH * CHUNK_WIDTH;
+        for (int s = static_cast<int>(sections.size()) - 1; s >= 0 && remaining > 0; --s)
+        {
+            if (!sections[s] || sections[s]->GetNumNonAirBlocks() == 0)
+            {
+                continue;
+            }
+            for (int local_y = SECTION_HEIGHT - 1; local_y >= 0 && remaining > 0; --local_y)
+            {
+                const unsigned short value = static_cast<unsigned short>(s * SECTION_HEIGHT + local_y + 1);
+                for (int i = 0; i < CHUNK_WIDTH * CHUNK_WIDTH; ++i)
                 {
-                    this_dest_position.x = x;
-                    this_src_position.x = x;
-                    neighbour_src_position.x = x;
-                    neighbour_dest_position.x = x;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
-                    {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
+                    const unsigned short flags = sections[s]->GetBlock(local_y * CHUNK_WIDTH * CHUNK_WIDTH + i)->GetFlags();
+                    for (size_t t = 0; t < heightmaps.size(); ++t)
                     {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
+                        if (heightmaps[t][i] == 0 && MatchesHeightmap(flags, static_cast<HeightmapType>(t)))
+                        {
+                            heightmaps[t][i] = value;
+                            remaining -= 1;
+                        }
                     }
                 }
             }
-            break;
-            // The neighbour is on "the right" on the z axis
-        case Orientation::South:
-            this_dest_position.z = CHUNK_WIDTH;
-            this_src_position.z = CHUNK_WIDTH - 1;
-            neighbour_src_position.z = 0;
-            neighbour_dest_position.z = -1;
-
-            for (int y = min_y; y < height + min_y; ++y)
-            {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int x = 0; x < CHUNK_WIDTH; ++x)
+        }
+    }
+
+    void Chunk::UpdateHeightmaps(const Position& pos, const unsigned short flags)
+    {
+        const int index = pos.z * CHUNK_WIDTH + pos.x;
+        const unsigned short value = static_cast<unsigned short>(pos.y - min_y + 1);
+        for (size_t t = 0; t < heightmaps.size(); ++t)
+        {
+            unsigned short& h = heightmaps[t][index];
+            if (MatchesHeightmap(flags, static_cast<HeightmapType>(t)))
+            {
+                h = std::max(h, value);
+            }
+            // The highest block has been replaced, look for the new one below
+            else if (h == value)
+            {
+                h = 0;
+                for (int y = pos.y - 1; y >= min_y; --y)
                 {
-                    this_dest_position.x = x;
-                    this_src_position.x = x;
-                    neighbour_src_position.x = x;
-                    neighbour_dest_position.x = x;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
+                    const Block* block = GetBlock(Position(pos.x, y, pos.z));
+                    if (block != nullptr && MatchesHeightmap(block->GetFlags(), static_cast<HeightmapType>(t)))
                     {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
-                    {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
+                        h = static_cast<unsigned short>(y - min_y + 1);
+                        break;
                     }
                 }
             }
-            break;
-        default:
-            break;
         }
     }
 
-#if PROTOCOL_VERSION < 719
-    const Dimension Chunk::GetDimension() const
-#else
-    const std::string& Chunk::GetDimension() const
-#endif
+    const unsigned long long Chunk::GetBlocksVersion() const
     {
-        return dimension;
+        return blocks_version;
     }
 
-    const std::map<Position, std::shared_ptr<NBT> >& Chunk::GetBlockEntitiesData() const
+    void Chunk::BumpBlocksVersion()
     {
-        return block_entities_data;
+        blocks_version = ++blocks_version_counter;
     }
 
-    const bool Chunk::HasSection(const int y) const
+    Section* Chunk::GetWritableSection(const int y)
     {
-        return sections[y] != nullptr;
+        if (sections[y] == nullptr)
+        {
+            return nullptr;
+        }
+
+        // If the section is shared with another chunk (a copy or a
+        // world snapshot), copy it so the other one is not modified.
+        // Other references can only be created by copying this chunk,
+        // so it can't go from 1 to 2 while we are writing
+        if (sections[y].use_count() > 1)
+        {
+            sections[y] = Section::Create(*sections[y]);
+        }
+
+        return sections[y].get();
     }
 
-    void Chunk::AddSection(const int y)
+    Chunk::Biomes& Chunk::GetWritableBiomes()
     {
-#if PROTOCOL_VERSION < 719
-        sections[y] = std::shared_ptr<Section>(new Section(dimension == Dimension::Overworld));
-#else
-        sections[y] = std::shared_ptr<Section>(new Section(dimension == "minecraft:overworld"));
-#endif
+        // Same as sections, only copies of this chunk can share them
+        if (biomes.use_count() > 1)
+        {
+            biomes = std::make_shared<Biomes>(*biomes);
+        }
+        return *biomes;
+    }
+
+    std::vector<BlockEntity>& Chunk::GetWritableBlockEntities()
+    {
+        if (block_entities_data.use_count() > 1)
+        {
+            block_entities_data = std::make_shared<std::vector<BlockEntity> >(*block_entities_data);
+        }
+        return *block_entities_data;
     }
 
 } //Botcraft
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "botcraft/Game/World/ChunkCache.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+    // Region files start with this, followed by the protocol version
+    static const std::string region_file_magic = "BCRC";
+    // Each region file contains REGION_WIDTH * REGION_WIDTH chunks
+    static const int REGION_WIDTH = 32;
+
+    static const int ChunkToRegionCoord(const int c)
+    {
+        return c >= 0 ? c / REGION_WIDTH : (c - REGION_WIDTH + 1) / REGION_WIDTH;
+    }
+
+    ChunkCache::ChunkCache(const std::string& folder_)
+    {
+        folder = folder_;
+        num_pending_chunks = 0;
+        write_requested = false;
+        running = true;
+
+        std::error_code ec;
+        std::filesystem::create_directories(folder, ec);
+        if (ec)
+        {
+            LOG_ERROR("Can't create chunk cache folder " << folder << " (" << ec.message() << ")");
+        }
+
+        write_thread = std::thread(&ChunkCache::WriteLoop, this);
+    }
+
+    ChunkCache::~ChunkCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            running = false;
+        }
+        write_condition.notify_all();
+        if (write_thread.joinable())
+        {
+            write_thread.join();
+        }
+        Flush();
+    }
+
+    void ChunkCache::Save(const std::string& dimension, const int x, const int z, const Chunk& chunk)
+    {
+        std::vector<unsigned char> data;
+        chunk.Write(data);
+
+        bool should_flush = false;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            std::map<std::pair<int, int>, std::vector<unsigned char> >& region = pending_chunks[dimension][{ ChunkToRegionCoord(x), ChunkToRegionCoord(z) }];
+            auto it = region.find({ x, z });
+            if (it == region.end())
+            {
+                region[{ x, z }] = std::move(data);
+                num_pending_chunks++;
+            }
+            else
+            {
+                it->second = std::move(data);
+            }
+            should_flush = num_pending_chunks >= max_pending_chunks;
+        }
+
+        if (should_flush)
+        {
+            FlushAsync();
+        }
+    }
+
+    std::vector<std::pair<std::pair<int, int>, std::shared_ptr<Chunk> > > ChunkCache::Load(const std::string& dimension,
+        const int center_x, const int center_z, const int radius)
+    {
+        std::vector<std::pair<std::pair<int, int>, std::shared_ptr<Chunk> > > output;
+
+        // Region files can't be written while reading them, so the
+        // chunks are either still pending or already in the files
+        std::lock_guard<std::mutex> io_lock(io_mutex);
+        for (int region_x = ChunkToRegionCoord(center_x - radius); region_x <= ChunkToRegionCoord(center_x + radius); ++region_x)
+        {
+            for (int region_z = ChunkToRegionCoord(center_z - radius); region_z <= ChunkToRegionCoord(center_z + radius); ++region_z)
+            {
+                std::map<std::pair<int, int>, std::vector<unsigned char> > region = ReadRegion(GetRegionPath(dimension, region_x, region_z));
+
+                // Chunks not written yet are more recent
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                auto dim_it = pending_chunks.find(dimension);
+                if (dim_it != pending_chunks.end())
+                {
+                    auto region_it = dim_it->second.find({ region_x, region_z });
+                    if (region_it != dim_it->second.end())
+                    {
+                        for (auto it = region_it->second.begin(); it != region_it->second.end(); ++it)
+                        {
+                            region[it->first] = it->second;
+                        }
+                    }
+                }
+
+                for (auto it = region.begin(); it != region.end(); ++it)
+                {
+                    if (std::abs(it->first.first - center_x) > radius || std::abs(it->first.second - center_z) > radius)
+                    {
+                        continue;
+                    }
+
+                    try
+                    {
+                        ReadIterator iter = it->second.data();
+                        size_t length = it->second.size();
+                        output.push_back({ it->first, Chunk::Read(iter, length) });
+                    }
+                    catch (const std::exception& e)
+                    {
+                        LOG_WARNING("Invalid cached chunk (" << it->first.first << ", " << it->first.second << ") in " << dimension << ": " << e.what());
+                    }
+                }
+            }
+        }
+
+        return output;
+    }
+
+    void ChunkCache::Flush()
+    {
+        std::lock_guard<std::mutex> io_lock(io_mutex);
+        std::map<std::string, std::map<std::pair<int, int>, std::map<std::pair<int, int>, std::vector<unsigned char> > > > to_write;
+        {
+            // Chunks saved from now are kept for the next flush
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            to_write.swap(pending_chunks);
+            num_pending_chunks = 0;
+        }
+
+        for (auto dim_it = to_write.begin(); dim_it != to_write.end(); ++dim_it)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(std::filesystem::path(GetRegionPath(dim_it->first, 0, 0)).parent_path(), ec);
+
+            for (auto region_it = dim_it->second.begin(); region_it != dim_it->second.end(); ++region_it)
+            {
+                const std::string path = GetRegionPath(dim_it->first, region_it->first.first, region_it->first.second);
+                std::map<std::pair<int, int>, std::vector<unsigned char> > region = ReadRegion(path);
+                for (auto it = region_it->second.begin(); it != region_it->second.end(); ++it)
+                {
+                    region[it->first] = std::move(it->second);
+                }
+                WriteRegion(path, region);
+            }
+        }
+    }
+
+    void ChunkCache::FlushAsync()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            write_requested = true;
+        }
+        write_condition.notify_all();
+    }
+
+    void ChunkCache::WriteLoop()
+    {
+        Logger::GetInstance().RegisterThread("ChunkCacheWriter");
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(cache_mutex);
+                write_condition.wait(lock, [this]() { return write_requested || !running; });
+                if (!running)
+                {
+                    return;
+                }
+                write_requested = false;
+            }
+            Flush();
+        }
+    }
+
+    const std::string ChunkCache::GetRegionPath(const std::string& dimension, const int region_x, const int region_z) const
+    {
+        // minecraft:overworld --> minecraft_overworld
+        std::string dimension_folder = dimension;
+        for (size_t i = 0; i < dimension_folder.size(); ++i)
+        {
+            if (dimension_folder[i] == ':' || dimension_folder[i] == '/' || dimension_folder[i] == '\\')
+            {
+                dimension_folder[i] = '_';
+            }
+        }
+
+        return (std::filesystem::path(folder) / dimension_folder / ("r." + std::to_string(region_x) + "." + std::to_string(region_z) + ".bcr")).string();
+    }
+
+    std::map<std::pair<int, int>, std::vector<unsigned char> > ChunkCache::ReadRegion(const std::string& path)
+    {
+        std::map<std::pair<int, int>, std::vector<unsigned char> > output;
+
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+        {
+            return output;
+        }
+
+        const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+
+        try
+        {
+            ReadIterator iter = data.data();
+            size_t length = data.size();
+
+            if (ReadRawString(iter, length, static_cast<int>(region_file_magic.size())) != region_file_magic ||
+                ReadData<int>(iter, length) != PROTOCOL_VERSION)
+            {
+                return output;
+            }
+
+            const int num_chunks = ReadData<VarInt>(iter, length);
+            for (int i = 0; i < num_chunks; ++i)
+            {
+                const int x = ReadData<int>(iter, length);
+                const int z = ReadData<int>(iter, length);
+                const int size = ReadData<VarInt>(iter, length);
+                output[{ x, z }] = ReadByteArray(iter, length, size);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARNING("Invalid chunk cache region file " << path << ": " << e.what());
+            output.clear();
+        }
+
+        return output;
+    }
+
+    void ChunkCache::WriteRegion(const std::string& path, const std::map<std::pair<int, int>, std::vector<unsigned char> >& chunks)
+    {
+        std::vector<unsigned char> data;
+        WriteRawString(region_file_magic, data);
+        WriteData<int>(PROTOCOL_VERSION, data);
+        WriteData<VarInt>(static_cast<int>(chunks.size()), data);
+        for (auto it = chunks.begin(); it != chunks.end(); ++it)
+        {
+            WriteData<int>(it->first.first, data);
+            WriteData<int>(it->first.second, data);
+            WriteData<VarInt>(static_cast<int>(it->second.size()), data);
+            WriteByteArray(it->second, data);
+        }
+
+        // Write in a temporary file first, so a crash
+        // while writing doesn't corrupt the region
+        const std::string tmp_path = path + ".tmp";
+        std::ofstream file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Can't open chunk cache region file " << tmp_path << " for writing");
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.close();
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec)
+        {
+            LOG_ERROR("Can't write chunk cache region file " << path << " (" << ec.message() << ")");
+        }
+    }
+} // Botcraft
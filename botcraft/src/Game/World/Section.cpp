@@ -0,0 +1,750 @@
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <string>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "botcraft/Game/World/Section.hpp"
+
+namespace Botcraft
+{
+    /// @brief Keeps the memory of deleted sections and of their
+    /// shared_ptr control blocks to reuse it for new sections
+    class SectionPool
+    {
+    public:
+        static SectionPool& GetInstance()
+        {
+            // Never deleted, as sections can still be released
+            // during static destruction (static World, threads)
+            static SectionPool* instance = new SectionPool();
+            return *instance;
+        }
+
+        Section* AcquireSection()
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (free_sections.empty())
+            {
+                return nullptr;
+            }
+            Section* section = free_sections.back().first;
+            pooled_bytes -= free_sections.back().second;
+            free_sections.pop_back();
+            return section;
+        }
+
+        void ReleaseSection(Section* section)
+        {
+            const size_t size = section->GetMemoryUsage();
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                if (pooled_bytes + size <= max_pooled_bytes)
+                {
+                    free_sections.push_back({ section, size });
+                    pooled_bytes += size;
+                    return;
+                }
+            }
+            delete section;
+        }
+
+        void* AllocateControlBlock(const size_t size)
+        {
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                // All control blocks have the same type, so the same size
+                if (control_block_size == 0)
+                {
+                    control_block_size = size;
+                }
+                if (size == control_block_size && !free_control_blocks.empty())
+                {
+                    void* block = free_control_blocks.back();
+                    free_control_blocks.pop_back();
+                    pooled_bytes -= control_block_size;
+                    return block;
+                }
+            }
+            return ::operator new(size);
+        }
+
+        void DeallocateControlBlock(void* block, const size_t size)
+        {
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                if (size == control_block_size && pooled_bytes + size <= max_pooled_bytes)
+                {
+                    free_control_blocks.push_back(block);
+                    pooled_bytes += size;
+                    return;
+                }
+            }
+            ::operator delete(block);
+        }
+
+        void SetMaxMemory(const size_t bytes)
+        {
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                max_pooled_bytes = bytes;
+            }
+            Trim(bytes);
+        }
+
+        const size_t GetMaxMemory()
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            return max_pooled_bytes;
+        }
+
+        const size_t GetMemoryUsage()
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            return pooled_bytes;
+        }
+
+        void Trim(const size_t bytes)
+        {
+            std::vector<Section*> sections_to_delete;
+            std::vector<void*> blocks_to_delete;
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                while (pooled_bytes > bytes && !free_sections.empty())
+                {
+                    sections_to_delete.push_back(free_sections.back().first);
+                    pooled_bytes -= free_sections.back().second;
+                    free_sections.pop_back();
+                }
+                while (pooled_bytes > bytes && !free_control_blocks.empty())
+                {
+                    blocks_to_delete.push_back(free_control_blocks.back());
+                    pooled_bytes -= control_block_size;
+                    free_control_blocks.pop_back();
+                }
+                // Give the memory of the vectors back too
+                if (free_sections.empty())
+                {
+                    std::vector<std::pair<Section*, size_t> >().swap(free_sections);
+                }
+                if (free_control_blocks.empty())
+                {
+                    std::vector<void*>().swap(free_control_blocks);
+                }
+            }
+
+            // Delete outside of the lock, it can take a while
+            for (Section* s : sections_to_delete)
+            {
+                delete s;
+            }
+            for (void* b : blocks_to_delete)
+            {
+                ::operator delete(b);
+            }
+        }
+
+    private:
+        SectionPool()
+        {
+            control_block_size = 0;
+            pooled_bytes = 0;
+            max_pooled_bytes = 64 * 1024 * 1024;
+        }
+
+    private:
+        std::mutex pool_mutex;
+        // Unused sections with the memory they use
+        std::vector<std::pair<Section*, size_t> > free_sections;
+        std::vector<void*> free_control_blocks;
+        size_t control_block_size;
+        // Memory used by the unused sections and control blocks
+        size_t pooled_bytes;
+        size_t max_pooled_bytes;
+    };
+
+    struct SectionDeleter
+    {
+        void operator()(Section* section) const
+        {
+            SectionPool::GetInstance().ReleaseSection(section);
+        }
+    };
+
+    template<class T>
+    struct SectionControlBlockAllocator
+    {
+        using value_type = T;
+
+        SectionControlBlockAllocator() = default;
+        template<class U>
+        SectionControlBlockAllocator(const SectionControlBlockAllocator<U>&) {}
+
+        T* allocate(const size_t n)
+        {
+            return static_cast<T*>(SectionPool::GetInstance().AllocateControlBlock(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, const size_t n)
+        {
+            SectionPool::GetInstance().DeallocateControlBlock(p, n * sizeof(T));
+        }
+    };
+
+    template<class T, class U>
+    bool operator==(const SectionControlBlockAllocator<T>&, const SectionControlBlockAllocator<U>&)
+    {
+        return true;
+    }
+
+    template<class T, class U>
+    bool operator!=(const SectionControlBlockAllocator<T>&, const SectionControlBlockAllocator<U>&)
+    {
+        return false;
+    }
+
+    /// @brief Get the position of a block in the packed indices
+    /// @param index y * CHUNK_WIDTH * CHUNK_WIDTH + z * CHUNK_WIDTH + x
+    static inline size_t GetStorageIndex(const int index)
+    {
+#if SECTION_BRICK_LAYOUT
+        // 64 4x4x4 bricks, each stored contiguously, so the 3D neighbours
+        // of a block are in the same few cache lines. Index bits are
+        // yyyy zzzz xxxx, the two high bits of each coordinate select
+        // the brick and the two low bits the block in the brick
+        return static_cast<size_t>(
+            (index & 0xC00) | ((index & 0x0C0) << 2) | ((index & 0x00C) << 4) | // brick
+            ((index & 0x300) >> 4) | ((index & 0x030) >> 2) | (index & 0x003)); // block in brick
+#else
+        return static_cast<size_t>(index);
+#endif
+    }
+
+    static const unsigned char GetLightValue(const std::vector<unsigned char>& light, const int index)
+    {
+        if (light.empty())
+        {
+            return 0;
+        }
+
+        return (light[index >> 1] >> ((index & 1) << 2)) & 0x0F;
+    }
+
+    static void SetLightValue(std::vector<unsigned char>& light, const int index, const unsigned char v)
+    {
+        if (light.empty())
+        {
+            if (v == 0)
+            {
+                return;
+            }
+            light.assign(Section::NUM_BLOCKS / 2, 0);
+        }
+
+        const int shift = (index & 1) << 2;
+        light[index >> 1] = (light[index >> 1] & ~(0x0F << shift)) | ((v & 0x0F) << shift);
+    }
+
+    static void SetLightData(std::vector<unsigned char>& light, const unsigned char* data)
+    {
+        // Dark sections don't need to store anything, release
+        // the array instead of keeping its capacity
+        if (data == nullptr || std::all_of(data, data + Section::NUM_BLOCKS / 2, [](const unsigned char c) { return c == 0; }))
+        {
+            std::vector<unsigned char>().swap(light);
+            return;
+        }
+
+        light.assign(data, data + Section::NUM_BLOCKS / 2);
+    }
+
+    Section::Section()
+    {
+        // A new section is filled with air
+        palette.emplace_back();
+        bits_per_entry = 0;
+        num_non_air_blocks = 0;
+    }
+
+    std::shared_ptr<Section> Section::Create()
+    {
+        Section* section = SectionPool::GetInstance().AcquireSection();
+        if (section == nullptr)
+        {
+            section = new Section();
+        }
+        else
+        {
+            section->Reset();
+        }
+
+        return std::shared_ptr<Section>(section, SectionDeleter(), SectionControlBlockAllocator<Section>());
+    }
+
+    void Section::SetPoolMaxMemory(const size_t bytes)
+    {
+        SectionPool::GetInstance().SetMaxMemory(bytes);
+    }
+
+    const size_t Section::GetPoolMaxMemory()
+    {
+        return SectionPool::GetInstance().GetMaxMemory();
+    }
+
+    const size_t Section::GetPoolMemoryUsage()
+    {
+        return SectionPool::GetInstance().GetMemoryUsage();
+    }
+
+    void Section::TrimPool(const size_t bytes)
+    {
+        SectionPool::GetInstance().Trim(bytes);
+    }
+
+    std::shared_ptr<Section> Section::Create(const Section& other)
+    {
+        Section* section = SectionPool::GetInstance().AcquireSection();
+        if (section == nullptr)
+        {
+            section = new Section(other);
+        }
+        else
+        {
+            // Assignment reuses the already allocated memory
+            *section = other;
+        }
+
+        return std::shared_ptr<Section>(section, SectionDeleter(), SectionControlBlockAllocator<Section>());
+    }
+
+    std::shared_ptr<Section> Section::GetSingleValueSection(const Block& block)
+    {
+        if (block.GetModelId() != -1)
+        {
+            return nullptr;
+        }
+
+        // Never deleted, like the pool, as chunks can still
+        // be released during static destruction
+        static std::mutex sections_mutex;
+        static std::unordered_map<const Blockstate*, std::shared_ptr<Section> >* sections = new std::unordered_map<const Blockstate*, std::shared_ptr<Section> >();
+
+        std::lock_guard<std::mutex> lock(sections_mutex);
+        std::shared_ptr<Section>& section = (*sections)[block.GetBlockstate()];
+        if (section == nullptr)
+        {
+            section = std::make_shared<Section>();
+            section->palette[0] = block;
+            section->CountNonAirBlocks();
+        }
+        return section;
+    }
+
+    const Block* Section::GetBlock(const int index) const
+    {
+        return &palette[GetPaletteIndex(index)];
+    }
+
+    void Section::SetBlock(const int index, const Block& block)
+    {
+        const bool was_air = GetBlock(index)->HasFlag(BlockstateFlag::Air);
+        const bool is_air = block.HasFlag(BlockstateFlag::Air);
+        if (was_air && !is_air)
+        {
+            num_non_air_blocks += 1;
+        }
+        else if (!was_air && is_air)
+        {
+            num_non_air_blocks -= 1;
+        }
+
+        // When the palette is full, drop the entries of the blocks replaced
+        // since it was built before using more bits per entry
+        if (bits_per_entry != 0 && palette.size() >= (1ULL << bits_per_entry))
+        {
+            CompactPalette();
+        }
+
+        const unsigned short palette_index = GetOrAddPaletteEntry(block);
+
+        if (bits_per_entry == 0)
+        {
+            if (palette_index == 0)
+            {
+                return;
+            }
+            ResizeIndices(4);
+        }
+        else if (palette_index >> bits_per_entry)
+        {
+            ResizeIndices(bits_per_entry * 2);
+        }
+
+        SetPaletteIndex(index, palette_index);
+    }
+
+    void Section::SetBlocks(const std::vector<Block>& blocks_palette, const std::vector<unsigned short>& indices)
+    {
+        palette = std::deque<Block>(blocks_palette.begin(), blocks_palette.end());
+        palette_lookup.clear();
+        if (palette.size() == 1)
+        {
+            bits_per_entry = 0;
+            data_indices.clear();
+            CountNonAirBlocks();
+            return;
+        }
+
+        unsigned char new_bits_per_entry = 4;
+        while (palette.size() > (1ULL << new_bits_per_entry))
+        {
+            new_bits_per_entry *= 2;
+        }
+        bits_per_entry = new_bits_per_entry;
+        data_indices.assign((NUM_BLOCKS * bits_per_entry + 63) / 64, 0);
+        for (int i = 0; i < NUM_BLOCKS; ++i)
+        {
+            SetPaletteIndex(i, indices[i]);
+        }
+        CountNonAirBlocks();
+    }
+
+    const bool Section::IsSingleValue() const
+    {
+        return bits_per_entry == 0;
+    }
+
+    const bool Section::HasBlockLightData() const
+    {
+        return !block_light.empty();
+    }
+
+    const bool Section::HasSkyLightData() const
+    {
+        return !sky_light.empty();
+    }
+
+    const unsigned char Section::GetBlockLight(const int index) const
+    {
+        return GetLightValue(block_light, index);
+    }
+
+    void Section::SetBlockLight(const int index, const unsigned char v)
+    {
+        SetLightValue(block_light, index, v);
+    }
+
+    const unsigned char Section::GetSkyLight(const int index) const
+    {
+        return GetLightValue(sky_light, index);
+    }
+
+    void Section::SetSkyLight(const int index, const unsigned char v)
+    {
+        SetLightValue(sky_light, index, v);
+    }
+
+    void Section::SetBlockLightData(const unsigned char* data)
+    {
+        SetLightData(block_light, data);
+    }
+
+    void Section::SetSkyLightData(const unsigned char* data)
+    {
+        SetLightData(sky_light, data);
+    }
+
+    const unsigned short Section::GetNumNonAirBlocks() const
+    {
+        return num_non_air_blocks;
+    }
+
+    const size_t Section::GetMemoryUsage() const
+    {
+        return sizeof(Section) + palette.size() * sizeof(Block) +
+            // Approximate size of the hash map nodes and buckets
+            palette_lookup.size() * (sizeof(std::pair<const Blockstate*, int>) + sizeof(unsigned short) + 2 * sizeof(void*)) +
+            palette_lookup.bucket_count() * sizeof(void*) +
+            data_indices.capacity() * sizeof(unsigned long long int) +
+            block_light.capacity() + sky_light.capacity();
+    }
+
+    const size_t Section::GetLightMemoryUsage() const
+    {
+        return block_light.capacity() + sky_light.capacity();
+    }
+
+    const std::deque<Block>& Section::GetPalette() const
+    {
+        return palette;
+    }
+
+    const unsigned short Section::GetPaletteIndex(const int index) const
+    {
+        if (bits_per_entry == 0)
+        {
+            return 0;
+        }
+
+        const size_t bit_offset = GetStorageIndex(index) * bits_per_entry;
+        return static_cast<unsigned short>((data_indices[bit_offset >> 6] >> (bit_offset & 63)) & ((1ULL << bits_per_entry) - 1));
+    }
+
+    void Section::SetPaletteIndex(const int index, const unsigned short palette_index)
+    {
+        const size_t bit_offset = GetStorageIndex(index) * bits_per_entry;
+        const unsigned long long int mask = ((1ULL << bits_per_entry) - 1) << (bit_offset & 63);
+        unsigned long long int& data = data_indices[bit_offset >> 6];
+        data = (data & ~mask) | ((static_cast<unsigned long long int>(palette_index) << (bit_offset & 63)) & mask);
+    }
+
+    const unsigned short Section::GetOrAddPaletteEntry(const Block& block)
+    {
+        // Linear search is faster than hashing for small palettes
+        constexpr size_t max_linear_search_size = 8;
+
+        const std::pair<const Blockstate*, int> key(block.GetBlockstate(), block.GetModelId());
+        if (palette.size() <= max_linear_search_size)
+        {
+            for (size_t i = 0; i < palette.size(); ++i)
+            {
+                if (palette[i].GetBlockstate() == key.first &&
+                    palette[i].GetModelId() == key.second)
+                {
+                    return static_cast<unsigned short>(i);
+                }
+            }
+        }
+        else
+        {
+            if (palette_lookup.empty())
+            {
+                for (size_t i = 0; i < palette.size(); ++i)
+                {
+                    palette_lookup.emplace(std::make_pair(palette[i].GetBlockstate(), palette[i].GetModelId()), static_cast<unsigned short>(i));
+                }
+            }
+            auto it = palette_lookup.find(key);
+            if (it != palette_lookup.end())
+            {
+                return it->second;
+            }
+        }
+
+        palette.push_back(block);
+        const unsigned short index = static_cast<unsigned short>(palette.size() - 1);
+        if (!palette_lookup.empty())
+        {
+            palette_lookup.emplace(key, index);
+        }
+        return index;
+    }
+
+    void Section::Write(ProtocolCraft::WriteContainer& container) const
+    {
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(palette.size()), container);
+        for (size_t i = 0; i < palette.size(); ++i)
+        {
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(palette[i].GetBlockstate()->GetId(), container);
+#if PROTOCOL_VERSION < 347
+            ProtocolCraft::WriteData<unsigned char>(palette[i].GetBlockstate()->GetMetadata(), container);
+#endif
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(palette[i].GetModelId(), container);
+        }
+
+        ProtocolCraft::WriteData<unsigned char>(bits_per_entry, container);
+#if SECTION_BRICK_LAYOUT
+        // Always written in y, z, x order so the data doesn't depend on the build options
+        for (size_t i = 0; i < data_indices.size(); ++i)
+        {
+            const int entries_per_long = 64 / bits_per_entry;
+            unsigned long long int data = 0;
+            for (int j = 0; j < entries_per_long; ++j)
+            {
+                data |= static_cast<unsigned long long int>(GetPaletteIndex(static_cast<int>(i) * entries_per_long + j)) << (j * bits_per_entry);
+            }
+            ProtocolCraft::WriteData<unsigned long long int>(data, container);
+        }
+#else
+        for (size_t i = 0; i < data_indices.size(); ++i)
+        {
+            ProtocolCraft::WriteData<unsigned long long int>(data_indices[i], container);
+        }
+#endif
+
+        ProtocolCraft::WriteData<bool>(!block_light.empty(), container);
+        if (!block_light.empty())
+        {
+            container.insert(container.end(), block_light.begin(), block_light.end());
+        }
+        ProtocolCraft::WriteData<bool>(!sky_light.empty(), container);
+        if (!sky_light.empty())
+        {
+            container.insert(container.end(), sky_light.begin(), sky_light.end());
+        }
+    }
+
+    void Section::Read(ProtocolCraft::ReadIterator& iter, size_t& length)
+    {
+        const int palette_size = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+        if (palette_size < 1 || palette_size > 0x10000)
+        {
+            throw(std::runtime_error("Wrong palette size when reading section (" + std::to_string(palette_size) + ")"));
+        }
+
+        palette.clear();
+        palette_lookup.clear();
+        for (int i = 0; i < palette_size; ++i)
+        {
+            const int id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+#if PROTOCOL_VERSION < 347
+            const unsigned char metadata = ProtocolCraft::ReadData<unsigned char>(iter, length);
+#endif
+            const int model_id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            palette.emplace_back();
+#if PROTOCOL_VERSION < 347
+            palette.back().ChangeBlockstate(id, metadata, model_id);
+#else
+            palette.back().ChangeBlockstate(id, model_id);
+#endif
+        }
+
+        bits_per_entry = ProtocolCraft::ReadData<unsigned char>(iter, length);
+        if (bits_per_entry != 0 && bits_per_entry != 4 && bits_per_entry != 8 && bits_per_entry != 16)
+        {
+            throw(std::runtime_error("Wrong bits per entry when reading section (" + std::to_string(bits_per_entry) + ")"));
+        }
+        data_indices.resize(bits_per_entry == 0 ? 0 : (NUM_BLOCKS * bits_per_entry + 63) / 64);
+#if SECTION_BRICK_LAYOUT
+        // Data is in y, z, x order, see Write
+        for (size_t i = 0; i < data_indices.size(); ++i)
+        {
+            const int entries_per_long = 64 / bits_per_entry;
+            const unsigned long long int data = ProtocolCraft::ReadData<unsigned long long int>(iter, length);
+            for (int j = 0; j < entries_per_long; ++j)
+            {
+                SetPaletteIndex(static_cast<int>(i) * entries_per_long + j, static_cast<unsigned short>((data >> (j * bits_per_entry)) & ((1ULL << bits_per_entry) - 1)));
+            }
+        }
+#else
+        for (size_t i = 0; i < data_indices.size(); ++i)
+        {
+            data_indices[i] = ProtocolCraft::ReadData<unsigned long long int>(iter, length);
+        }
+#endif
+        // Make sure all indices are in the palette
+        for (int i = 0; i < NUM_BLOCKS && bits_per_entry != 0; ++i)
+        {
+            if (GetPaletteIndex(i) >= palette.size())
+            {
+                throw(std::runtime_error("Wrong palette index when reading section"));
+            }
+        }
+        CountNonAirBlocks();
+
+        if (ProtocolCraft::ReadData<bool>(iter, length))
+        {
+            const std::vector<unsigned char> data = ProtocolCraft::ReadByteArray(iter, length, NUM_BLOCKS / 2);
+            SetBlockLightData(data.data());
+        }
+        else
+        {
+            SetBlockLightData(nullptr);
+        }
+        if (ProtocolCraft::ReadData<bool>(iter, length))
+        {
+            const std::vector<unsigned char> data = ProtocolCraft::ReadByteArray(iter, length, NUM_BLOCKS / 2);
+            SetSkyLightData(data.data());
+        }
+        else
+        {
+            SetSkyLightData(nullptr);
+        }
+    }
+
+    void Section::Reset()
+    {
+        palette.clear();
+        palette.emplace_back();
+        palette_lookup.clear();
+        bits_per_entry = 0;
+        num_non_air_blocks = 0;
+        data_indices.clear();
+        std::vector<unsigned char>().swap(block_light);
+        std::vector<unsigned char>().swap(sky_light);
+    }
+
+    void Section::ResizeIndices(const unsigned char new_bits_per_entry)
+    {
+        std::array<unsigned short, NUM_BLOCKS> indices;
+        for (int i = 0; i < NUM_BLOCKS; ++i)
+        {
+            indices[i] = GetPaletteIndex(i);
+        }
+
+        bits_per_entry = new_bits_per_entry;
+        data_indices.assign((NUM_BLOCKS * bits_per_entry + 63) / 64, 0);
+        for (int i = 0; i < NUM_BLOCKS; ++i)
+        {
+            SetPaletteIndex(i, indices[i]);
+        }
+    }
+
+    void Section::CompactPalette()
+    {
+        // This invalidates the pointers previously returned by GetBlock
+        // on this section. Snapshots are not affected, as a section
+        // shared with a snapshot is copied before being modified
+        std::vector<unsigned short> indices(NUM_BLOCKS);
+        std::vector<int> remap(palette.size(), -1);
+        std::deque<Block> new_palette;
+        for (int i = 0; i < NUM_BLOCKS; ++i)
+        {
+            const unsigned short old_index = GetPaletteIndex(i);
+            if (remap[old_index] == -1)
+            {
+                remap[old_index] = static_cast<int>(new_palette.size());
+                new_palette.push_back(palette[old_index]);
+            }
+            indices[i] = static_cast<unsigned short>(remap[old_index]);
+        }
+
+        palette = std::move(new_palette);
+        palette_lookup.clear();
+
+        // Keep at least half of the indices free, so the next
+        // compaction only happens after as many new blocks
+        unsigned char new_bits_per_entry = 4;
+        while (palette.size() * 2 > (1ULL << new_bits_per_entry) && new_bits_per_entry < 16)
+        {
+            new_bits_per_entry *= 2;
+        }
+        bits_per_entry = new_bits_per_entry;
+        data_indices.assign((NUM_BLOCKS * bits_per_entry + 63) / 64, 0);
+        for (int i = 0; i < NUM_BLOCKS; ++i)
+        {
+            SetPaletteIndex(i, indices[i]);
+        }
+    }
+
+    void Section::CountNonAirBlocks()
+    {
+        if (bits_per_entry == 0)
+        {
+            num_non_air_blocks = palette[0].HasFlag(BlockstateFlag::Air) ? 0 : NUM_BLOCKS;
+            return;
+        }
+
+        std::vector<bool> is_air(palette.size());
+        for (size_t i = 0; i < palette.size(); ++i)
+        {
+            is_air[i] = palette[i].HasFlag(BlockstateFlag::Air);
+        }
+        num_non_air_blocks = 0;
+        for (int i = 0; i < NUM_BLOCKS; ++i)
+        {
+            num_non_air_blocks += !is_air[GetPaletteIndex(i)];
+        }
+    }
+} // Botcraft
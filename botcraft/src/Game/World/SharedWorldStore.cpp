@@ -0,0 +1,665 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "botcraft/Game/World/SharedWorldStore.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/Blockstate.hpp"
+#include "botcraft/Game/AssetsManager.hpp"
+
+namespace Botcraft
+{
+    // Atomics in the mapped file are used by multiple processes
+    static_assert(std::atomic<unsigned int>::is_always_lock_free, "SharedWorldStore needs lock-free 32 bits atomics");
+    static_assert(std::atomic<unsigned long long>::is_always_lock_free, "SharedWorldStore needs lock-free 64 bits atomics");
+
+    // Store files start with this, followed by the protocol version
+    static const char store_file_magic[8] = { 'B', 'C', 'W', 'S', 'T', 'O', 'R', 'E' };
+    static constexpr size_t max_dimension_length = 128;
+    // Max time to wait for another process to finish creating a file
+    static constexpr std::chrono::seconds creation_timeout(5);
+    // Max time to wait for a lock, or for a section being written, before giving up
+    static constexpr std::chrono::milliseconds lock_timeout(500);
+
+    struct SharedWorldStore::Header
+    {
+        char magic[8];
+        int protocol_version;
+        /// @brief Max number of sections, size of the blocks array
+        unsigned int max_sections;
+        /// @brief Number of slots in the hash table, a power of 2
+        unsigned int table_size;
+        char dimension[max_dimension_length];
+        /// @brief 1 once the file is fully initialized by its creator
+        std::atomic<unsigned int> ready;
+        /// @brief Lock of the writers adding slots, pid of the owner process, 0 if free
+        std::atomic<unsigned int> table_lock;
+        /// @brief Number of used slots, also index of the next blocks array entry
+        std::atomic<unsigned int> num_sections;
+        std::atomic<unsigned long long> generation;
+    };
+
+    struct SharedWorldStore::Slot
+    {
+        /// @brief 1 once the coordinates are set, never reset
+        std::atomic<unsigned int> used;
+        /// @brief Seqlock, odd while the blocks are written, 0 if they have never been
+        std::atomic<unsigned int> sequence;
+        /// @brief Lock of the writers of the blocks, pid of the owner process, 0 if free
+        std::atomic<unsigned int> writer;
+        int x;
+        int y;
+        int z;
+        /// @brief Index of this section in the blocks array
+        unsigned int data_index;
+    };
+
+    static constexpr size_t AlignUp(const size_t v, const size_t alignment)
+    {
+        return (v + alignment - 1) / alignment * alignment;
+    }
+
+    /// @brief Get the offset of the blocks array in a store file
+    static const size_t GetBlocksOffset(const size_t slots_offset, const size_t slot_size, const unsigned int table_size)
+    {
+        return AlignUp(slots_offset + table_size * slot_size, 4096);
+    }
+
+    static const size_t HashSection(const int x, const int y, const int z)
+    {
+        size_t h = static_cast<size_t>(static_cast<unsigned int>(x)) * 73856093u;
+        h ^= static_cast<size_t>(static_cast<unsigned int>(y)) * 19349663u;
+        h ^= static_cast<size_t>(static_cast<unsigned int>(z)) * 83492791u;
+        return h ^ (h >> 16);
+    }
+
+    static const int SectionCoord(const int v)
+    {
+        return v >= 0 ? v / SECTION_HEIGHT : (v - SECTION_HEIGHT + 1) / SECTION_HEIGHT;
+    }
+
+    static const unsigned int GetCurrentPid()
+    {
+#ifdef _WIN32
+        return static_cast<unsigned int>(GetCurrentProcessId());
+#else
+        return static_cast<unsigned int>(getpid());
+#endif
+    }
+
+    /// @brief Check if a process still exists, to break the locks of the writers that crashed
+    static const bool IsProcessAlive(const unsigned int pid)
+    {
+#ifdef _WIN32
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+        if (process == nullptr)
+        {
+            // The process exists but we can't query it
+            return GetLastError() == ERROR_ACCESS_DENIED;
+        }
+        DWORD exit_code = 0;
+        const bool alive = GetExitCodeProcess(process, &exit_code) && exit_code == STILL_ACTIVE;
+        CloseHandle(process);
+        return alive;
+#else
+        return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+#endif
+    }
+
+    /// @brief Take a lock storing the pid of its owner. A lock owned by a process
+    /// that doesn't exist anymore is taken over
+    /// @return False if another process held the lock for more than lock_timeout
+    static const bool LockOwned(std::atomic<unsigned int>& lock)
+    {
+        const unsigned int pid = GetCurrentPid();
+        std::chrono::steady_clock::time_point deadline;
+        bool waiting = false;
+        unsigned int owner = 0;
+        while (!lock.compare_exchange_weak(owner, pid, std::memory_order_acquire))
+        {
+            // Spurious failure
+            if (owner == 0)
+            {
+                continue;
+            }
+            if (!waiting)
+            {
+                if (!IsProcessAlive(owner))
+                {
+                    // If it fails, someone else broke the lock first, owner is updated
+                    if (lock.compare_exchange_strong(owner, pid, std::memory_order_acquire))
+                    {
+                        return true;
+                    }
+                    continue;
+                }
+                deadline = std::chrono::steady_clock::now() + lock_timeout;
+                waiting = true;
+            }
+            else if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+            owner = 0;
+        }
+        return true;
+    }
+
+    /// @brief A file mapped in memory
+    struct SharedWorldStore::Mapping
+    {
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE file_mapping = nullptr;
+#else
+        int file = -1;
+#endif
+        void* address = nullptr;
+        size_t size = 0;
+        bool writable = false;
+
+        ~Mapping()
+        {
+            Unmap();
+#ifdef _WIN32
+            if (file != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(file);
+            }
+#else
+            if (file != -1)
+            {
+                close(file);
+            }
+#endif
+        }
+
+        /// @brief Open the file
+        /// @param path Path of the file
+        /// @param create If true, create the file, failing if it already exists
+        /// @return False if the file can't be opened
+        bool Open(const std::string& path, const bool create)
+        {
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, create ? CREATE_NEW : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            return file != INVALID_HANDLE_VALUE;
+#else
+            file = open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | (create ? O_CREAT | O_EXCL : 0), 0644);
+            return file != -1;
+#endif
+        }
+
+        const size_t GetFileSize() const
+        {
+#ifdef _WIN32
+            LARGE_INTEGER file_size;
+            return GetFileSizeEx(file, &file_size) ? static_cast<size_t>(file_size.QuadPart) : 0;
+#else
+            struct stat file_stat;
+            return fstat(file, &file_stat) == 0 ? static_cast<size_t>(file_stat.st_size) : 0;
+#endif
+        }
+
+        bool Resize(const size_t new_size)
+        {
+#ifdef _WIN32
+            LARGE_INTEGER file_size;
+            file_size.QuadPart = static_cast<LONGLONG>(new_size);
+            return SetFilePointerEx(file, file_size, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+#else
+            return ftruncate(file, static_cast<off_t>(new_size)) == 0;
+#endif
+        }
+
+        bool Map(const size_t new_size)
+        {
+            Unmap();
+#ifdef _WIN32
+            file_mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                static_cast<DWORD>(static_cast<unsigned long long>(new_size) >> 32), static_cast<DWORD>(new_size & 0xFFFFFFFF), nullptr);
+            if (file_mapping == nullptr)
+            {
+                return false;
+            }
+            address = MapViewOfFile(file_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, new_size);
+            if (address == nullptr)
+            {
+                CloseHandle(file_mapping);
+                file_mapping = nullptr;
+                return false;
+            }
+#else
+            address = mmap(nullptr, new_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+            if (address == MAP_FAILED)
+            {
+                address = nullptr;
+                return false;
+            }
+#endif
+            size = new_size;
+            return true;
+        }
+
+        void Unmap()
+        {
+            if (address == nullptr)
+            {
+                return;
+            }
+#ifdef _WIN32
+            UnmapViewOfFile(address);
+            CloseHandle(file_mapping);
+            file_mapping = nullptr;
+#else
+            munmap(address, size);
+#endif
+            address = nullptr;
+            size = 0;
+        }
+    };
+
+    SharedWorldStore::SharedWorldStore(const std::string& path_, const bool writable_, const unsigned int max_sections, const std::string& dimension_)
+    {
+        path = path_;
+        writable = writable_;
+        header = nullptr;
+        slots = nullptr;
+        blocks = nullptr;
+
+        if (dimension_.size() >= max_dimension_length)
+        {
+            throw(std::runtime_error("Dimension name too long for a shared world store (" + dimension_ + ")"));
+        }
+
+        const size_t slots_offset = AlignUp(sizeof(Header), 64);
+        const size_t section_bytes = Section::NUM_BLOCKS * sizeof(unsigned short);
+
+        mapping = std::make_unique<Mapping>();
+        mapping->writable = writable;
+
+        // Try to create the file first, so only one process initializes it
+        if (writable && mapping->Open(path, true))
+        {
+            if (max_sections == 0)
+            {
+                throw(std::runtime_error("Can't create a shared world store without sections"));
+            }
+            unsigned int table_size = 16;
+            while (table_size < 2 * max_sections)
+            {
+                table_size *= 2;
+            }
+            const size_t file_size = GetBlocksOffset(slots_offset, sizeof(Slot), table_size) + static_cast<size_t>(max_sections) * section_bytes;
+            if (!mapping->Resize(file_size) || !mapping->Map(file_size))
+            {
+                throw(std::runtime_error("Can't map shared world store " + path));
+            }
+            header = static_cast<Header*>(mapping->address);
+            header->table_size = table_size;
+            dimension = dimension_;
+            InitHeader(max_sections);
+        }
+        else
+        {
+            if (!mapping->Open(path, false))
+            {
+                throw(std::runtime_error("Can't open shared world store " + path));
+            }
+
+            // Wait for the creator to initialize the header if it's still doing it
+            const auto start = std::chrono::steady_clock::now();
+            while (true)
+            {
+                if (mapping->GetFileSize() >= sizeof(Header))
+                {
+                    if (!mapping->Map(sizeof(Header)))
+                    {
+                        throw(std::runtime_error("Can't map shared world store " + path));
+                    }
+                    header = static_cast<Header*>(mapping->address);
+                    if (header->ready.load(std::memory_order_acquire) == 1)
+                    {
+                        break;
+                    }
+                }
+                if (std::chrono::steady_clock::now() - start > creation_timeout)
+                {
+                    throw(std::runtime_error("Shared world store " + path + " is not initialized"));
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            CheckHeader();
+            const size_t file_size = GetBlocksOffset(slots_offset, sizeof(Slot), header->table_size) + static_cast<size_t>(header->max_sections) * section_bytes;
+            if (mapping->GetFileSize() < file_size || !mapping->Map(file_size))
+            {
+                throw(std::runtime_error("Can't map shared world store " + path));
+            }
+            header = static_cast<Header*>(mapping->address);
+            dimension = std::string(header->dimension);
+        }
+
+        slots = reinterpret_cast<Slot*>(static_cast<char*>(mapping->address) + slots_offset);
+        blocks = reinterpret_cast<unsigned short*>(static_cast<char*>(mapping->address) + GetBlocksOffset(slots_offset, sizeof(Slot), header->table_size));
+    }
+
+    SharedWorldStore::~SharedWorldStore()
+    {
+
+    }
+
+    const std::string& SharedWorldStore::GetPath() const
+    {
+        return path;
+    }
+
+    const std::string& SharedWorldStore::GetDimension() const
+    {
+        return dimension;
+    }
+
+    const bool SharedWorldStore::IsWritable() const
+    {
+        return writable;
+    }
+
+    const unsigned int SharedWorldStore::GetCapacity() const
+    {
+        return header->max_sections;
+    }
+
+    const unsigned int SharedWorldStore::GetNumSections() const
+    {
+        return header->num_sections.load(std::memory_order_relaxed);
+    }
+
+    const unsigned long long SharedWorldStore::GetGeneration() const
+    {
+        return header->generation.load(std::memory_order_acquire);
+    }
+
+    const bool SharedWorldStore::WriteChunk(const int x, const int z, const Chunk& chunk, const Chunk* previous)
+    {
+        if (!writable)
+        {
+            throw(std::runtime_error("Can't write in read-only shared world store " + path));
+        }
+
+        bool all_written = true;
+        std::vector<unsigned short> ids(Section::NUM_BLOCKS);
+        std::vector<unsigned short> palette_ids;
+        const int min_section_y = SectionCoord(chunk.GetMinY());
+        const int num_sections = chunk.GetHeight() / SECTION_HEIGHT;
+        // Sections are copied on write, the ones shared with the previous version didn't change
+        const bool same_layout = previous != nullptr && previous->GetMinY() == chunk.GetMinY() && previous->GetHeight() == chunk.GetHeight();
+        for (int i = 0; i < num_sections; ++i)
+        {
+            const Section* section = chunk.GetSection(i);
+            if (same_layout && previous->GetSection(i) == section)
+            {
+                continue;
+            }
+            if (section == nullptr)
+            {
+                std::fill(ids.begin(), ids.end(), 0);
+            }
+            else
+            {
+                // Convert each palette entry only once
+                const std::deque<Block>& palette = section->GetPalette();
+                palette_ids.resize(palette.size());
+                for (size_t j = 0; j < palette.size(); ++j)
+                {
+#if PROTOCOL_VERSION < 347
+                    palette_ids[j] = static_cast<unsigned short>(Blockstate::IdMetadataToId(palette[j].GetBlockstate()->GetId(), palette[j].GetBlockstate()->GetMetadata()));
+#else
+                    palette_ids[j] = static_cast<unsigned short>(palette[j].GetBlockstate()->GetId());
+#endif
+                }
+                for (int j = 0; j < Section::NUM_BLOCKS; ++j)
+                {
+                    ids[j] = palette_ids[section->GetPaletteIndex(j)];
+                }
+            }
+            all_written &= WriteSection(x, min_section_y + i, z, ids.data());
+        }
+        return all_written;
+    }
+
+    const bool SharedWorldStore::WriteSection(const int x, const int y, const int z, const unsigned short* ids)
+    {
+        if (!writable)
+        {
+            throw(std::runtime_error("Can't write in read-only shared world store " + path));
+        }
+
+        const int slot_index = FindOrAddSlot(x, y, z);
+        if (slot_index == -1)
+        {
+            return false;
+        }
+        Slot& slot = slots[slot_index];
+        unsigned short* data = GetSlotData(slot_index);
+
+        if (!LockOwned(slot.writer))
+        {
+            return false;
+        }
+
+        // Odd if the previous writer crashed in the middle of a write, the blocks are rewritten anyway
+        unsigned int sequence = slot.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) == 0)
+        {
+            // Nothing changed, don't make the readers retry
+            if (sequence != 0 && std::memcmp(data, ids, Section::NUM_BLOCKS * sizeof(unsigned short)) == 0)
+            {
+                slot.writer.store(0, std::memory_order_release);
+                return true;
+            }
+            sequence += 1;
+            slot.sequence.store(sequence, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        std::memcpy(data, ids, Section::NUM_BLOCKS * sizeof(unsigned short));
+        slot.sequence.store(sequence + 1, std::memory_order_release);
+        slot.writer.store(0, std::memory_order_release);
+        header->generation.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    const bool SharedWorldStore::IsLoaded(const Position& pos) const
+    {
+        const int slot_index = FindSlot(SectionCoord(pos.x), SectionCoord(pos.y), SectionCoord(pos.z));
+        return slot_index != -1 && slots[slot_index].sequence.load(std::memory_order_acquire) != 0;
+    }
+
+    const bool SharedWorldStore::GetBlockstateId(const Position& pos, unsigned short& id) const
+    {
+        const int slot_index = FindSlot(SectionCoord(pos.x), SectionCoord(pos.y), SectionCoord(pos.z));
+        if (slot_index == -1)
+        {
+            return false;
+        }
+        const int index = ((pos.y - SectionCoord(pos.y) * SECTION_HEIGHT) * CHUNK_WIDTH + (pos.z - SectionCoord(pos.z) * CHUNK_WIDTH)) * CHUNK_WIDTH + (pos.x - SectionCoord(pos.x) * CHUNK_WIDTH);
+        return ReadSlot(slot_index, index, 1, &id);
+    }
+
+    const Blockstate* SharedWorldStore::GetBlockstate(const Position& pos) const
+    {
+        unsigned short id;
+        if (!GetBlockstateId(pos, id))
+        {
+            return nullptr;
+        }
+        return AssetsManager::getInstance().GetBlockstate(id);
+    }
+
+    const bool SharedWorldStore::ReadSection(const int x, const int y, const int z, std::array<unsigned short, Section::NUM_BLOCKS>& ids) const
+    {
+        const int slot_index = FindSlot(x, y, z);
+        if (slot_index == -1)
+        {
+            return false;
+        }
+        return ReadSlot(slot_index, 0, Section::NUM_BLOCKS, ids.data());
+    }
+
+    const bool SharedWorldStore::ReadSlot(const int slot_index, const size_t offset, const size_t count, unsigned short* output) const
+    {
+        const Slot& slot = slots[slot_index];
+        const unsigned short* data = GetSlotData(slot_index) + offset;
+
+        std::chrono::steady_clock::time_point deadline;
+        bool waiting = false;
+        // Seqlock read, retry if a writer modified the section meanwhile
+        while (true)
+        {
+            const unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+            // Slot added by a writer that didn't finish the first write yet
+            if (sequence == 0)
+            {
+                return false;
+            }
+            if ((sequence & 1) == 0)
+            {
+                std::memcpy(output, data, count * sizeof(unsigned short));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+                {
+                    return true;
+                }
+            }
+            // Being written, or the writer crashed in the middle of it
+            if (!waiting)
+            {
+                deadline = std::chrono::steady_clock::now() + lock_timeout;
+                waiting = true;
+            }
+            else if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    const int SharedWorldStore::FindSlot(const int x, const int y, const int z) const
+    {
+        const size_t mask = header->table_size - 1;
+        size_t index = HashSection(x, y, z) & mask;
+        for (unsigned int i = 0; i < header->table_size; ++i)
+        {
+            const Slot& slot = slots[index];
+            // Coordinates are written before used is set, and never change after
+            if (slot.used.load(std::memory_order_acquire) == 0)
+            {
+                return -1;
+            }
+            if (slot.x == x && slot.y == y && slot.z == z)
+            {
+                return static_cast<int>(index);
+            }
+            index = (index + 1) & mask;
+        }
+        return -1;
+    }
+
+    const int SharedWorldStore::FindOrAddSlot(const int x, const int y, const int z)
+    {
+        const int existing = FindSlot(x, y, z);
+        if (existing != -1)
+        {
+            return existing;
+        }
+
+        if (!LockOwned(header->table_lock))
+        {
+            return -1;
+        }
+
+        // Search again, another writer could have added it before we got the lock
+        int output = -1;
+        const size_t mask = header->table_size - 1;
+        size_t index = HashSection(x, y, z) & mask;
+        while (true)
+        {
+            Slot& slot = slots[index];
+            if (slot.used.load(std::memory_order_relaxed) == 0)
+            {
+                const unsigned int num_sections = header->num_sections.load(std::memory_order_relaxed);
+                if (num_sections < header->max_sections)
+                {
+                    slot.x = x;
+                    slot.y = y;
+                    slot.z = z;
+                    slot.data_index = num_sections;
+                    // Count it first, if this process crashes before setting used, the
+                    // next writer taking the lock only loses one blocks array entry
+                    header->num_sections.store(num_sections + 1, std::memory_order_relaxed);
+                    slot.used.store(1, std::memory_order_release);
+                    output = static_cast<int>(index);
+                }
+                break;
+            }
+            if (slot.x == x && slot.y == y && slot.z == z)
+            {
+                output = static_cast<int>(index);
+                break;
+            }
+            index = (index + 1) & mask;
+        }
+
+        header->table_lock.store(0, std::memory_order_release);
+        return output;
+    }
+
+    unsigned short* SharedWorldStore::GetSlotData(const int slot) const
+    {
+        return blocks + static_cast<size_t>(slots[slot].data_index) * Section::NUM_BLOCKS;
+    }
+
+    void SharedWorldStore::InitHeader(const unsigned int max_sections)
+    {
+        // The file is zero-filled, which is a valid state for all the atomics and slots
+        std::memcpy(header->magic, store_file_magic, sizeof(store_file_magic));
+        header->protocol_version = PROTOCOL_VERSION;
+        header->max_sections = max_sections;
+        std::memset(header->dimension, 0, max_dimension_length);
+        std::memcpy(header->dimension, dimension.data(), dimension.size());
+        header->ready.store(1, std::memory_order_release);
+    }
+
+    void SharedWorldStore::CheckHeader() const
+    {
+        if (std::memcmp(header->magic, store_file_magic, sizeof(store_file_magic)) != 0)
+        {
+            throw(std::runtime_error(path + " is not a shared world store"));
+        }
+        if (header->protocol_version != PROTOCOL_VERSION)
+        {
+            throw(std::runtime_error("Shared world store " + path + " was created for protocol version " + std::to_string(header->protocol_version)));
+        }
+        if (header->table_size == 0 || (header->table_size & (header->table_size - 1)) != 0 || header->max_sections > header->table_size ||
+            header->dimension[max_dimension_length - 1] != '\0')
+        {
+            throw(std::runtime_error("Invalid shared world store header in " + path));
+        }
+    }
+} // Botcraft
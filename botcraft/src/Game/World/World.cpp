@@ -1,22 +1,53 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <limits>
+
 #include "botcraft/Game/World/World.hpp"
 #include "botcraft/Game/World/Chunk.hpp"
 #include "botcraft/Game/World/Block.hpp"
+#include "botcraft/Game/World/Blockstate.hpp"
+#include "botcraft/Game/World/Section.hpp"
+#include "botcraft/Game/World/ChunkCache.hpp"
+#include "botcraft/Game/World/SharedWorldStore.hpp"
 #include "botcraft/Game/Enums.hpp"
 #include "botcraft/Utilities/AsyncHandler.hpp"
 #include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
+#include "botcraft/Network/Compression.hpp"
 
 #include "protocolCraft/Types/NBT/NBT.hpp"
-#include "protocolCraft/Types/NBT/TagInt.hpp"
-#if PROTOCOL_VERSION > 758
-#include "protocolCraft/Types/NBT/TagList.hpp"
-#include "protocolCraft/Types/NBT/TagString.hpp"
-#endif
+#include "protocolCraft/BinaryReadWrite.hpp"
 
 namespace Botcraft
 {
-    World::World(const bool is_shared_, const bool async_handler_)
+    // World files start with this, followed by the protocol version
+    static const std::string world_file_magic = "BCWD";
+
+    // Worlds alive in the process, the pool of deleted sections
+    // is released when the last one is destroyed
+    static std::atomic<int> num_alive_worlds(0);
+
+    World::World(const bool is_shared_, const bool async_handler_, const unsigned int num_chunk_decode_threads_, const bool store_light_)
     {
         is_shared = is_shared_;
+        store_light = store_light_;
+        num_alive_worlds++;
+        chunk_cache_loaded = false;
+        chunk_cache_radius = 8;
+        forgotten_chunks_budget = 0;
+        forgotten_chunks_memory = 0;
+        last_block_change = 0;
+        first_block_change = 1;
+        // A few ticks
+        line_of_sight_duration = std::chrono::milliseconds(200);
+#if PROTOCOL_VERSION > 471
+        interest_radius = -1;
+        has_interest_center = false;
+        interest_center_x = 0;
+        interest_center_z = 0;
+#endif
 
 #if PROTOCOL_VERSION < 719
         current_dimension = Dimension::None;
@@ -34,12 +65,63 @@ namespace Botcraft
 
 #if PROTOCOL_VERSION > 758
         world_interaction_sequence_id = 0;
+        last_acknowledged_sequence_id = 0;
+#endif
+        terrain_snapshot = std::make_shared<const WorldSnapshot::Regions>();
+
+#if PROTOCOL_VERSION > 756
+        next_chunk_decode_id = 0;
+        decoding_chunks = true;
+        // Decoded chunks are allocated on the node of the affinity group creating the world
+        const int group = AffinityGroups::GetCurrentGroup();
+        for (unsigned int i = 0; i < num_chunk_decode_threads_; ++i)
+        {
+            chunk_decode_threads.emplace_back([this, group]()
+                {
+                    AffinityGroups::GetInstance().JoinGroup(group);
+                    DecodeChunks();
+                });
+        }
 #endif
     }
 
     World::~World()
     {
+        if (chunk_cache)
+        {
+            {
+                std::lock_guard<std::mutex> world_guard(world_mutex);
+                for (auto it = terrain.begin(); it != terrain.end(); ++it)
+                {
+                    SaveChunkToCache(it->first.first, it->first.second);
+                }
+            }
+            chunk_cache->Flush();
+        }
 
+#if PROTOCOL_VERSION > 756
+        {
+            std::lock_guard<std::mutex> lock(chunk_decode_mutex);
+            decoding_chunks = false;
+        }
+        chunk_decode_condition.notify_all();
+        for (size_t i = 0; i < chunk_decode_threads.size(); ++i)
+        {
+            if (chunk_decode_threads[i].joinable())
+            {
+                chunk_decode_threads[i].join();
+            }
+        }
+#endif
+
+        // Release the chunks now so their sections go back to the pool before it's trimmed
+        terrain.clear();
+        forgotten_chunks.clear();
+        terrain_snapshot = nullptr;
+        if (--num_alive_worlds == 0)
+        {
+            Section::TrimPool();
+        }
     }
 
     std::mutex& World::GetMutex()
@@ -47,11 +129,426 @@ namespace Botcraft
         return world_mutex;
     }
 
+    const EventNotifier& World::GetEventNotifier() const
+    {
+        return event_notifier;
+    }
+
     const bool World::IsShared() const
     {
         return is_shared;
     }
 
+    const WorldSnapshot World::GetSnapshot() const
+    {
+        return WorldSnapshot(std::atomic_load(&terrain_snapshot));
+    }
+
+    void World::PublishSnapshot()
+    {
+        if (modified_chunks.empty())
+        {
+            return;
+        }
+
+        // Unloaded chunks are kept in the shared store, other processes may still use them
+        const bool write_shared_store = shared_store && shared_store->IsWritable() && shared_store->GetDimension() == GetCacheDimensionName();
+
+        // Only the regions of the modified chunks are copied, the others
+        // are shared with the previous snapshot. As sections are shared
+        // until modified, copying the modified chunks is mostly pointer copies
+        const std::shared_ptr<const WorldSnapshot::Regions> previous_snapshot = std::atomic_load(&terrain_snapshot);
+        std::shared_ptr<WorldSnapshot::Regions> new_snapshot = std::make_shared<WorldSnapshot::Regions>();
+        new_snapshot->maps = previous_snapshot->maps;
+        // Regions already copied for this snapshot
+        std::unordered_map<std::pair<int, int>, std::shared_ptr<WorldSnapshot::ChunksMap>, ChunkCoordinatesHasher> copied_regions;
+        for (auto it = modified_chunks.begin(); it != modified_chunks.end(); ++it)
+        {
+            const std::pair<int, int> region_coords = { WorldSnapshot::Regions::ChunkToRegion(it->first), WorldSnapshot::Regions::ChunkToRegion(it->second) };
+            std::shared_ptr<WorldSnapshot::ChunksMap>& region = copied_regions[region_coords];
+            if (region == nullptr)
+            {
+                auto previous_it = previous_snapshot->maps.find(region_coords);
+                region = previous_it == previous_snapshot->maps.end() ?
+                    std::make_shared<WorldSnapshot::ChunksMap>() : std::make_shared<WorldSnapshot::ChunksMap>(*previous_it->second);
+            }
+
+            auto terrain_it = terrain.find(*it);
+            if (terrain_it == terrain.end())
+            {
+                region->erase(*it);
+            }
+            else
+            {
+                std::shared_ptr<const Chunk>& published_chunk = (*region)[*it];
+                if (write_shared_store)
+                {
+                    // Only write the sections modified since the previous snapshot,
+                    // unless some of them couldn't be written last time
+                    const bool write_all = published_chunk == nullptr || incomplete_shared_chunks.erase(*it) > 0;
+                    if (!shared_store->WriteChunk(it->first, it->second, *terrain_it->second, write_all ? nullptr : published_chunk.get()))
+                    {
+                        incomplete_shared_chunks.insert(*it);
+                        LOG_WARNING("Shared world store " << shared_store->GetPath() << " is full or busy, chunk " << it->first << ", " << it->second << " not fully written");
+                    }
+                }
+                published_chunk = std::make_shared<const Chunk>(*terrain_it->second);
+            }
+        }
+        modified_chunks.clear();
+
+        for (auto it = copied_regions.begin(); it != copied_regions.end(); ++it)
+        {
+            if (it->second->empty())
+            {
+                new_snapshot->maps.erase(it->first);
+            }
+            else
+            {
+                new_snapshot->maps[it->first] = it->second;
+            }
+        }
+
+        std::atomic_store(&terrain_snapshot, std::shared_ptr<const WorldSnapshot::Regions>(new_snapshot));
+    }
+
+    const WorldStats World::GetStats()
+    {
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        WorldStats stats;
+        stats.num_chunks = terrain.size();
+        for (auto it = terrain.begin(); it != terrain.end(); ++it)
+        {
+            stats.num_sections += it->second->GetNumSections();
+            const ChunkMemoryUsage memory = it->second->GetDetailedMemoryUsage();
+            stats.memory_bytes += memory.total;
+            stats.sections_memory_bytes += memory.sections;
+            stats.light_memory_bytes += memory.light;
+            stats.block_entities_memory_bytes += memory.block_entities;
+        }
+        stats.num_forgotten_chunks = forgotten_chunks.size();
+        stats.forgotten_memory_bytes = forgotten_chunks_memory;
+        return stats;
+    }
+
+    void World::SetChunkCache(const std::shared_ptr<ChunkCache>& cache)
+    {
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        chunk_cache = cache;
+    }
+
+    void World::SetSharedStore(const std::shared_ptr<SharedWorldStore>& store)
+    {
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        shared_store = store;
+        incomplete_shared_chunks.clear();
+        // Write the chunks already loaded
+        if (shared_store && shared_store->IsWritable() && shared_store->GetDimension() == GetCacheDimensionName())
+        {
+            for (auto it = terrain.begin(); it != terrain.end(); ++it)
+            {
+                if (!shared_store->WriteChunk(it->first.first, it->first.second, *it->second))
+                {
+                    incomplete_shared_chunks.insert(it->first);
+                }
+            }
+        }
+    }
+
+    void World::SetForgottenChunksBudget(const size_t max_bytes)
+    {
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        forgotten_chunks_budget = max_bytes;
+        EvictForgottenChunks();
+    }
+
+#if PROTOCOL_VERSION > 471
+    void World::SetInterestRadius(const int radius)
+    {
+        if (is_shared)
+        {
+            LOG_WARNING("Interest radius is ignored for shared worlds");
+            return;
+        }
+
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        interest_radius = radius;
+        DropChunksOutsideInterest();
+    }
+
+    bool World::IsOutsideInterest(const int x, const int z) const
+    {
+        if (interest_radius < 0 || !has_interest_center)
+        {
+            return false;
+        }
+        return std::abs(x - interest_center_x) > interest_radius || std::abs(z - interest_center_z) > interest_radius;
+    }
+
+    void World::DropChunksOutsideInterest()
+    {
+        if (interest_radius < 0 || !has_interest_center)
+        {
+            return;
+        }
+
+        std::vector<std::pair<int, int> > to_remove;
+        for (auto it = terrain.begin(); it != terrain.end(); ++it)
+        {
+            if (IsOutsideInterest(it->first.first, it->first.second))
+            {
+                to_remove.push_back(it->first);
+            }
+        }
+
+        for (size_t i = 0; i < to_remove.size(); ++i)
+        {
+#if PROTOCOL_VERSION > 756
+            pending_chunk_decodes.erase(to_remove[i]);
+            deferred_chunk_updates.erase(to_remove[i]);
+#endif
+            SaveChunkToCache(to_remove[i].first, to_remove[i].second);
+            RemoveChunk(to_remove[i].first, to_remove[i].second);
+        }
+
+        if (!to_remove.empty())
+        {
+            PublishSnapshot();
+            event_notifier.Notify(EventType::ChunkUnloaded);
+        }
+    }
+#endif
+
+    bool World::Save(const std::string& path, const bool compressed)
+    {
+#ifndef USE_COMPRESSION
+        if (compressed)
+        {
+            LOG_ERROR("Program compiled without USE_COMPRESSION, can't save a compressed world");
+            return false;
+        }
+#endif
+
+        std::vector<unsigned char> data;
+        {
+            std::lock_guard<std::mutex> world_guard(world_mutex);
+#if PROTOCOL_VERSION < 719
+            ProtocolCraft::WriteData<int>(static_cast<int>(current_dimension), data);
+#else
+            ProtocolCraft::WriteData<std::string>(current_dimension, data);
+#endif
+#if PROTOCOL_VERSION > 756
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(dimension_height.size()), data);
+            for (auto it = dimension_height.begin(); it != dimension_height.end(); ++it)
+            {
+                ProtocolCraft::WriteData<std::string>(it->first, data);
+                ProtocolCraft::WriteData<int>(static_cast<int>(it->second), data);
+            }
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(dimension_min_y.size()), data);
+            for (auto it = dimension_min_y.begin(); it != dimension_min_y.end(); ++it)
+            {
+                ProtocolCraft::WriteData<std::string>(it->first, data);
+                ProtocolCraft::WriteData<int>(it->second, data);
+            }
+#endif
+            ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(terrain.size()), data);
+            std::vector<unsigned char> chunk_data;
+            for (auto it = terrain.begin(); it != terrain.end(); ++it)
+            {
+                chunk_data.clear();
+                it->second->Write(chunk_data);
+                ProtocolCraft::WriteData<int>(it->first.first, data);
+                ProtocolCraft::WriteData<int>(it->first.second, data);
+                ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(chunk_data.size()), data);
+                data.insert(data.end(), chunk_data.begin(), chunk_data.end());
+            }
+        }
+
+        std::vector<unsigned char> header;
+        ProtocolCraft::WriteRawString(world_file_magic, header);
+        ProtocolCraft::WriteData<int>(PROTOCOL_VERSION, header);
+        ProtocolCraft::WriteData<bool>(compressed, header);
+
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Can't open " << path << " to save the world");
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+#ifdef USE_COMPRESSION
+        if (compressed)
+        {
+            std::vector<unsigned char> compressed_data;
+            ProtocolCraft::WriteData<ProtocolCraft::VarLong>(static_cast<long long int>(data.size()), compressed_data);
+            try
+            {
+                CompressionContext().Compress(data.data(), data.size(), compressed_data, false);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR("Error compressing world data: " << e.what());
+                return false;
+            }
+            data = std::move(compressed_data);
+        }
+#endif
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.close();
+
+        if (file.fail())
+        {
+            LOG_ERROR("Error writing world in " << path);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool World::Load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Can't open " << path << " to load the world");
+            return false;
+        }
+
+        // Read the whole file at once, everything is then decoded from memory
+        std::vector<unsigned char> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+        file.close();
+
+        return Load(data.data(), data.size());
+    }
+
+    bool World::Load(const unsigned char* data, const size_t size)
+    {
+        std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, ChunkCoordinatesHasher> loaded_terrain;
+#if PROTOCOL_VERSION < 719
+        Dimension loaded_dimension;
+#else
+        std::string loaded_dimension;
+#endif
+#if PROTOCOL_VERSION > 756
+        std::map<std::string, unsigned int> loaded_dimension_height;
+        std::map<std::string, int> loaded_dimension_min_y;
+#endif
+
+        try
+        {
+            ProtocolCraft::ReadIterator iter = data;
+            size_t length = size;
+
+            if (ProtocolCraft::ReadRawString(iter, length, static_cast<int>(world_file_magic.size())) != world_file_magic)
+            {
+                LOG_ERROR("Invalid world data");
+                return false;
+            }
+            const int protocol_version = ProtocolCraft::ReadData<int>(iter, length);
+            if (protocol_version != PROTOCOL_VERSION)
+            {
+                LOG_ERROR("World data were saved for protocol version " << protocol_version << ", current one is " << PROTOCOL_VERSION);
+                return false;
+            }
+
+            std::vector<unsigned char> decompressed_data;
+            if (ProtocolCraft::ReadData<bool>(iter, length))
+            {
+#ifdef USE_COMPRESSION
+                const long long int decompressed_size = ProtocolCraft::ReadData<ProtocolCraft::VarLong>(iter, length);
+                CompressionContext().Decompress(iter, length, decompressed_data, static_cast<size_t>(decompressed_size));
+                if (decompressed_data.size() != static_cast<size_t>(decompressed_size))
+                {
+                    throw std::runtime_error("wrong decompressed size");
+                }
+                iter = decompressed_data.data();
+                length = decompressed_data.size();
+#else
+                LOG_ERROR("Program compiled without USE_COMPRESSION, can't load a compressed world");
+                return false;
+#endif
+            }
+
+#if PROTOCOL_VERSION < 719
+            loaded_dimension = static_cast<Dimension>(ProtocolCraft::ReadData<int>(iter, length));
+#else
+            loaded_dimension = ProtocolCraft::ReadData<std::string>(iter, length);
+#endif
+#if PROTOCOL_VERSION > 756
+            const int num_heights = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            for (int i = 0; i < num_heights; ++i)
+            {
+                const std::string dim = ProtocolCraft::ReadData<std::string>(iter, length);
+                loaded_dimension_height[dim] = static_cast<unsigned int>(ProtocolCraft::ReadData<int>(iter, length));
+            }
+            const int num_min_y = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            for (int i = 0; i < num_min_y; ++i)
+            {
+                const std::string dim = ProtocolCraft::ReadData<std::string>(iter, length);
+                loaded_dimension_min_y[dim] = ProtocolCraft::ReadData<int>(iter, length);
+            }
+#endif
+            const int num_chunks = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            loaded_terrain.reserve(num_chunks);
+            for (int i = 0; i < num_chunks; ++i)
+            {
+                const int x = ProtocolCraft::ReadData<int>(iter, length);
+                const int z = ProtocolCraft::ReadData<int>(iter, length);
+                const size_t chunk_size = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+                if (chunk_size > length)
+                {
+                    throw std::runtime_error("not enough data for chunk (" + std::to_string(x) + ", " + std::to_string(z) + ")");
+                }
+                ProtocolCraft::ReadIterator chunk_iter = iter;
+                size_t chunk_length = chunk_size;
+                loaded_terrain[{ x, z }] = Chunk::Read(chunk_iter, chunk_length);
+                iter += chunk_size;
+                length -= chunk_size;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("Error loading world data: " << e.what());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        // Old chunks are removed
+        for (auto it = terrain.begin(); it != terrain.end(); ++it)
+        {
+            if (loaded_terrain.find(it->first) == loaded_terrain.end())
+            {
+                SetChunkModified(it->first.first, it->first.second);
+            }
+        }
+        terrain = std::move(loaded_terrain);
+        cached = nullptr;
+        ClearForgottenChunks();
+        current_dimension = loaded_dimension;
+#if PROTOCOL_VERSION > 756
+        dimension_height = std::move(loaded_dimension_height);
+        dimension_min_y = std::move(loaded_dimension_min_y);
+        pending_chunk_decodes.clear();
+        deferred_chunk_updates.clear();
+#endif
+        for (auto it = terrain.begin(); it != terrain.end(); ++it)
+        {
+            SetChunkModified(it->first.first, it->first.second);
+        }
+#if USE_GUI
+        for (auto it = modified_chunks.begin(); it != modified_chunks.end(); ++it)
+        {
+            UpdateChunk(it->first, it->second);
+        }
+#endif
+        PublishSnapshot();
+
+        return true;
+    }
+
     ProtocolCraft::Handler* World::GetAsyncHandler()
     {
         if (async_handler != nullptr)
@@ -74,11 +571,22 @@ namespace Botcraft
 
         if (!chunk)
         {
+            // Reuse the forgotten chunk if we still have it,
+            // the data sent by the server will update it
+            std::shared_ptr<Chunk> forgotten = TakeForgottenChunk(dim, x, z);
+            if (forgotten)
+            {
+                terrain[{x, z}] = forgotten;
+                UpdateChunk(x, z);
+            }
+            else
+            {
 #if PROTOCOL_VERSION < 757
-            terrain[{x, z}] = std::make_shared<Chunk>(dim);
+                terrain[{x, z}] = std::make_shared<Chunk>(dim);
 #else
-            terrain[{x, z}] = std::make_shared<Chunk>(dimension_min_y[dim], dimension_height[dim], dim);
+                terrain[{x, z}] = std::make_shared<Chunk>(dimension_min_y[dim], dimension_height[dim], dim);
 #endif
+            }
         }
         else if (chunk->GetDimension() != dim)
         {
@@ -90,18 +598,53 @@ namespace Botcraft
 #endif
         }
         
+        SetChunkModified(x, z);
+
         //Not necessary, from void to air, there is no difference
         //UpdateChunk(x, z);
 
         return true;
     }
 
+    bool World::AddExternalChunk(const int x, const int z, const std::shared_ptr<Chunk>& chunk, const unsigned long long expected_version)
+    {
+        if (!chunk || chunk->GetDimension() != current_dimension)
+        {
+            return false;
+        }
+
+#if PROTOCOL_VERSION > 756
+        // The server data are already being decoded
+        if (pending_chunk_decodes.find({ x, z }) != pending_chunk_decodes.end())
+        {
+            return false;
+        }
+#endif
+
+        auto it = terrain.find({ x, z });
+        if (it != terrain.end() && (expected_version == 0 || it->second->GetBlocksVersion() != expected_version))
+        {
+            return false;
+        }
+
+        terrain[{ x, z }] = chunk;
+        if (cached && cached_x == x && cached_z == z)
+        {
+            cached = nullptr;
+        }
+        SetChunkModified(x, z);
+        UpdateChunk(x, z);
+        event_notifier.Notify(EventType::ChunkLoaded);
+        return true;
+    }
+
     bool World::RemoveChunk(const int x, const int z)
     {
-        std::map<std::pair<int, int>, std::shared_ptr<Chunk> >::iterator it = terrain.find({ x, z });
+        std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, ChunkCoordinatesHasher>::iterator it = terrain.find({ x, z });
         if (it != terrain.end())
         {
             terrain.erase(it);
+            SetChunkModified(x, z);
 
             if (cached && cached_x == x && cached_z == z)
             {
@@ -150,6 +693,7 @@ namespace Botcraft
     bool World::LoadDataInChunk(const int x, const int z, const std::vector<unsigned char>& data)
 #endif
     {
+        TRACE_ZONE("LoadChunkData", "x", x, "z", z);
         std::shared_ptr<Chunk> chunk = GetChunk(x, z);
         if (chunk)
         {
@@ -160,6 +704,7 @@ namespace Botcraft
 #else
             chunk->LoadChunkData(data);
 #endif
+            SetChunkModified(x, z);
             UpdateChunk(x, z);
             return true;
         }
@@ -176,6 +721,7 @@ namespace Botcraft
         if (chunk)
         {
             chunk->LoadChunkBlockEntitiesData(block_entities);
+            SetChunkModified(x, z);
             UpdateChunk(x, z);
             return true;
         }
@@ -189,6 +735,7 @@ namespace Botcraft
         if (chunk)
         {
             chunk->SetBiomes(biomes);
+            SetChunkModified(x, z);
             UpdateChunk(x, z);
             return true;
         }
@@ -196,6 +743,20 @@ namespace Botcraft
     }
 #endif
 
+#if PROTOCOL_VERSION > 442
+    bool World::LoadHeightmapsInChunk(const int x, const int z, const ProtocolCraft::NBT& heightmaps)
+    {
+        std::shared_ptr<Chunk> chunk = GetChunk(x, z);
+        if (chunk)
+        {
+            chunk->LoadHeightmaps(heightmaps);
+            SetChunkModified(x, z);
+            return true;
+        }
+        return false;
+    }
+#endif
+
 #if PROTOCOL_VERSION < 347
     bool World::SetBlock(const Position &pos, const unsigned int id, unsigned char metadata, const int model_id)
 #else
@@ -223,11 +784,20 @@ namespace Botcraft
 
         const int in_chunk_x = (pos.x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
         const int in_chunk_z = (pos.z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
+        const Position in_chunk_pos(in_chunk_x, pos.y, in_chunk_z);
+        const Block* old_block = block_changes.empty() ? nullptr : cached->GetBlock(in_chunk_pos);
+        const Blockstate* old_state = old_block == nullptr ? nullptr : old_block->GetBlockstate();
 #if PROTOCOL_VERSION < 347
-        cached->SetBlock(Position(in_chunk_x, pos.y, in_chunk_z), id, metadata, model_id);
+        cached->SetBlock(in_chunk_pos, id, metadata, model_id);
 #else
-        cached->SetBlock(Position(in_chunk_x, pos.y, in_chunk_z), id, model_id);
+        cached->SetBlock(in_chunk_pos, id, model_id);
 #endif
+        SetChunkModified(chunk_x, chunk_z);
+        if (!block_changes.empty())
+        {
+            const Block* new_block = cached->GetBlock(in_chunk_pos);
+            RecordBlockChange(pos, old_state, new_block == nullptr ? nullptr : new_block->GetBlockstate());
+        }
 
         if (in_chunk_x > 0 && in_chunk_x < CHUNK_WIDTH - 1 &&
             in_chunk_z > 0 && in_chunk_z < CHUNK_WIDTH - 1)
@@ -254,7 +824,107 @@ namespace Botcraft
             update_pos.z = 1;
         }
 
-        UpdateChunk(chunk_x, chunk_z, update_pos);
+        // Blocks inside the chunk don't change the neighbours
+        if (update_pos != Position())
+        {
+            UpdateChunk(chunk_x, chunk_z, update_pos);
+        }
+
+        return true;
+    }
+
+    bool World::SetBlocksInChunk(const int chunk_x, const int chunk_z, const std::vector<std::pair<Position, unsigned int> >& blocks)
+    {
+        if (!cached || cached_x != chunk_x || cached_z != chunk_z)
+        {
+            auto it = terrain.find({ chunk_x, chunk_z });
+
+            if (it != terrain.end())
+            {
+                cached_x = chunk_x;
+                cached_z = chunk_z;
+                cached = it->second;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        const int min_y = cached->GetMinY();
+        const int height = cached->GetHeight();
+
+        // Group the blocks by section, in the order they are received
+        std::map<int, std::vector<std::pair<int, unsigned int> > > sections_blocks;
+        bool border_x_min = false;
+        bool border_x_max = false;
+        bool border_z_min = false;
+        bool border_z_max = false;
+        for (const auto& b : blocks)
+        {
+            const Position& pos = b.first;
+            if (pos.x < 0 || pos.x > CHUNK_WIDTH - 1 || pos.y < min_y || pos.y > height + min_y - 1 || pos.z < 0 || pos.z > CHUNK_WIDTH - 1)
+            {
+                continue;
+            }
+            sections_blocks[(pos.y - min_y) / SECTION_HEIGHT].push_back({
+                ((pos.y - min_y) % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH + pos.z * CHUNK_WIDTH + pos.x, b.second });
+
+            border_x_min |= pos.x == 0;
+            border_x_max |= pos.x == CHUNK_WIDTH - 1;
+            border_z_min |= pos.z == 0;
+            border_z_max |= pos.z == CHUNK_WIDTH - 1;
+        }
+
+        // Old states are only needed for the journal
+        std::vector<const Blockstate*> old_states;
+        if (!block_changes.empty())
+        {
+            old_states.reserve(blocks.size());
+            for (const auto& b : blocks)
+            {
+                const Block* block = cached->GetBlock(b.first);
+                old_states.push_back(block == nullptr ? nullptr : block->GetBlockstate());
+            }
+        }
+
+        bool changed = false;
+        for (const auto& s : sections_blocks)
+        {
+            changed |= cached->SetSectionBlocks(s.first, s.second);
+        }
+
+        if (!changed)
+        {
+            return true;
+        }
+
+        for (size_t i = 0; i < old_states.size(); ++i)
+        {
+            const Block* block = cached->GetBlock(blocks[i].first);
+            RecordBlockChange(Position(chunk_x * CHUNK_WIDTH + blocks[i].first.x, blocks[i].first.y, chunk_z * CHUNK_WIDTH + blocks[i].first.z),
+                old_states[i], block == nullptr ? nullptr : block->GetBlockstate());
+        }
+
+        SetChunkModified(chunk_x, chunk_z);
+
+        // One update per neighbour, whatever the number of border blocks
+        if (border_x_min)
+        {
+            UpdateChunk(chunk_x, chunk_z, Position(-1, 0, 0));
+        }
+        if (border_x_max)
+        {
+            UpdateChunk(chunk_x, chunk_z, Position(1, 0, 0));
+        }
+        if (border_z_min)
+        {
+            UpdateChunk(chunk_x, chunk_z, Position(0, 0, -1));
+        }
+        if (border_z_max)
+        {
+            UpdateChunk(chunk_x, chunk_z, Position(0, 0, 1));
+        }
 
         return true;
     }
@@ -289,7 +959,7 @@ namespace Botcraft
         {
             cached->RemoveBlockEntityData(chunk_pos);
         }
-        UpdateChunk(chunk_x, chunk_z, chunk_pos);
+        SetChunkModified(chunk_x, chunk_z);
 
         return true;
     }
@@ -302,6 +972,7 @@ namespace Botcraft
         if (it != terrain.end())
         {
             it->second->SetBiome((x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, (z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, biome);
+            SetChunkModified(it->first.first, it->first.second);
             return true;
         }
 
@@ -315,6 +986,7 @@ namespace Botcraft
         if (it != terrain.end())
         {
             it->second->SetBiome((x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, (z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, biome);
+            SetChunkModified(it->first.first, it->first.second);
             return true;
         }
 
@@ -328,6 +1000,7 @@ namespace Botcraft
         if (it != terrain.end())
         {
             it->second->SetBiome((x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, y, (z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, biome);
+            SetChunkModified(it->first.first, it->first.second);
             return true;
         }
 
@@ -347,6 +1020,7 @@ namespace Botcraft
 #endif
         {
             it->second->SetSkyLight(Position((pos.x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, pos.y, (pos.z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH), skylight);
+            SetChunkModified(it->first.first, it->first.second);
             return true;
         }
 
@@ -360,6 +1034,7 @@ namespace Botcraft
         if (it != terrain.end())
         {
             it->second->SetBlockLight(Position((pos.x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, pos.y, (pos.z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH), blocklight);
+            SetChunkModified(it->first.first, it->first.second);
             return true;
         }
 
@@ -379,6 +1054,11 @@ namespace Botcraft
         const std::vector<std::vector<char>>& data, const bool sky)
 #endif
     {
+        if (!store_light)
+        {
+            return;
+        }
+
         std::shared_ptr<Chunk> chunk = GetChunk(x, z);
 
         if (chunk == nullptr)
@@ -387,182 +1067,104 @@ namespace Botcraft
             chunk = GetChunk(x, z);
         }
 
+        SetChunkModified(x, z);
+
+        LoadLightInChunk(chunk.get(), light_mask, empty_light_mask, data, sky);
+    }
+
+#if PROTOCOL_VERSION < 755
+    void World::LoadLightInChunk(Chunk* chunk, const int light_mask, const int empty_light_mask,
+        const std::vector<std::vector<char>>& data, const bool sky)
+#else
+    void World::LoadLightInChunk(Chunk* chunk, const std::vector<unsigned long long int>& light_mask, const std::vector<unsigned long long int>& empty_light_mask,
+        const std::vector<std::vector<char>>& data, const bool sky)
+#endif
+    {
         int counter_arrays = 0;
-        Position pos1, pos2;
 
-        const int num_sections = GetHeight() / 16 + 2;
+        const int num_sections = chunk->GetHeight() / 16 + 2;
 
         for (int i = 0; i < num_sections; ++i)
         {
+            // Light sections include one section below and one above the chunk
             const int section_Y = i - 1;
 
-            // Sky light
 #if PROTOCOL_VERSION < 755
             if ((light_mask >> i) & 1)
 #else
             if ((light_mask.size() > i / 64) && (light_mask[i / 64] >> (i % 64)) & 1)
 #endif
             {
-                if (i > 0 && i < num_sections - 1)
+                if (i > 0 && i < num_sections - 1 && counter_arrays < data.size())
                 {
-                    for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
+                    if (data[counter_arrays].size() < Section::NUM_BLOCKS / 2)
                     {
-                        pos1.y = block_y + section_Y * SECTION_HEIGHT + GetMinY();
-                        pos2.y = pos1.y;
-                        for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                        {
-                            pos1.z = block_z;
-                            pos2.z = block_z;
-                            for (int block_x = 0; block_x < CHUNK_WIDTH; block_x += 2)
-                            {
-                                pos1.x = block_x;
-                                pos2.x = block_x + 1;
-                                const char two_light_values = data[counter_arrays][(block_y * CHUNK_WIDTH * CHUNK_WIDTH + block_z * CHUNK_WIDTH + block_x) / 2];
-
-                                if (sky)
-                                {
-                                    chunk->SetSkyLight(pos1, two_light_values & 0x0F);
-                                    chunk->SetSkyLight(pos2, (two_light_values >> 4) & 0x0F);
-                                }
-                                else
-                                {
-                                    chunk->SetBlockLight(pos1, two_light_values & 0x0F);
-                                    chunk->SetBlockLight(pos2, (two_light_values >> 4) & 0x0F);
-                                }
-                            }
-                        }
+                        LOG_WARNING("Wrong light data size (" << data[counter_arrays].size() << "), section light ignored");
+                    }
+                    else
+                    {
+                        // Light is stored as it's sent by the server
+                        chunk->SetSectionLight(section_Y, reinterpret_cast<const unsigned char*>(data[counter_arrays].data()), sky);
                     }
                 }
                 counter_arrays++;
             }
 #if PROTOCOL_VERSION < 755
             else if ((empty_light_mask >> i) & 1)
-#else
-            else if ((empty_light_mask.size() > i / 64) && (empty_light_mask[i / 64] >> (i % 64)) & 1)
-#endif
-            {
-                if (i > 0 && i < num_sections - 1)
-                {
-                    for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
-                    {
-                        pos1.y = block_y + section_Y * SECTION_HEIGHT + GetMinY();
-                        pos2.y = pos1.y;
-                        for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                        {
-                            pos1.z = block_z;
-                            pos2.z = block_z;
-                            for (int block_x = 0; block_x < CHUNK_WIDTH; block_x += 2)
-                            {
-                                pos1.x = block_x;
-                                pos2.x = block_x + 1;
-                                if (sky)
-                                {
-                                    chunk->SetSkyLight(pos1, 0);
-                                    chunk->SetSkyLight(pos2, 0);
-                                }
-                                else
-                                {
-                                    chunk->SetBlockLight(pos1, 0);
-                                    chunk->SetBlockLight(pos2, 0);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-#endif
-
-    void World::UpdateChunk(const int x, const int z, const Position& pos)
-    {
-        std::shared_ptr<Chunk> chunk = GetChunk(x, z);
-        if (pos == Position())
-        {
-            if (chunk)
-            {
-                chunk->UpdateNeighbour(GetChunk(x - 1, z), Orientation::West);
-                chunk->UpdateNeighbour(GetChunk(x + 1, z), Orientation::East);
-                chunk->UpdateNeighbour(GetChunk(x, z - 1), Orientation::North);
-                chunk->UpdateNeighbour(GetChunk(x, z + 1), Orientation::South);
-            }
-            else
-            {
-                std::shared_ptr<Chunk> neighbour_chunk;
-                neighbour_chunk = GetChunk(x - 1, z);
-                if (neighbour_chunk)
-                {
-                    neighbour_chunk->UpdateNeighbour(nullptr, Orientation::East);
-                }
-                neighbour_chunk = GetChunk(x + 1, z);
-                if (neighbour_chunk)
-                {
-                    neighbour_chunk->UpdateNeighbour(nullptr, Orientation::West);
-                }
-                neighbour_chunk = GetChunk(x, z - 1);
-                if (neighbour_chunk)
-                {
-                    neighbour_chunk->UpdateNeighbour(nullptr, Orientation::South);
-                }
-                neighbour_chunk = GetChunk(x, z + 1);
-                if (neighbour_chunk)
+#else
+            else if ((empty_light_mask.size() > i / 64) && (empty_light_mask[i / 64] >> (i % 64)) & 1)
+#endif
+            {
+                if (i > 0 && i < num_sections - 1)
                 {
-                    neighbour_chunk->UpdateNeighbour(nullptr, Orientation::North);
+                    chunk->SetSectionLight(section_Y, nullptr, sky);
                 }
             }
-            return;
         }
-        
-        if (pos.x == -1)
+    }
+
+#endif
+
+    void World::UpdateChunk(const int x, const int z, const Position& pos)
+    {
+#if USE_GUI
+        // Chunks don't store their neighbours' blocks, the renderer
+        // reads them when needed. We just need to tell it that the
+        // neighbours' borders faces may have changed
+        std::shared_ptr<Chunk> neighbour_chunk;
+        if (pos == Position() || pos.x == -1)
         {
-            std::shared_ptr<Chunk> neighbour_chunk = GetChunk(x - 1, z);
-            if (chunk)
-            {
-                chunk->UpdateNeighbour(neighbour_chunk, Orientation::West);
-            }
-            else if (neighbour_chunk)
+            neighbour_chunk = GetChunk(x - 1, z);
+            if (neighbour_chunk)
             {
-                neighbour_chunk->UpdateNeighbour(nullptr, Orientation::East);
+                neighbour_chunk->SetModifiedSinceLastRender(true);
             }
         }
-        else if (pos.x == 1)
+        if (pos == Position() || pos.x == 1)
         {
-            std::shared_ptr<Chunk> neighbour_chunk = GetChunk(x + 1, z);
-            if (chunk)
+            neighbour_chunk = GetChunk(x + 1, z);
+            if (neighbour_chunk)
             {
-                chunk->UpdateNeighbour(neighbour_chunk, Orientation::East);
-            }
-            else if (neighbour_chunk)
-            {
-                neighbour_chunk->UpdateNeighbour(nullptr, Orientation::West);
+                neighbour_chunk->SetModifiedSinceLastRender(true);
             }
         }
-
-        if (pos.z == -1)
+        if (pos == Position() || pos.z == -1)
         {
-            std::shared_ptr<Chunk> neighbour_chunk = GetChunk(x, z - 1);
-            if (chunk)
-            {
-                chunk->UpdateNeighbour(neighbour_chunk, Orientation::North);
-            }
-            else if (neighbour_chunk)
+            neighbour_chunk = GetChunk(x, z - 1);
+            if (neighbour_chunk)
             {
-                neighbour_chunk->UpdateNeighbour(nullptr, Orientation::South);
+                neighbour_chunk->SetModifiedSinceLastRender(true);
             }
         }
-        else if (pos.z == 1)
+        if (pos == Position() || pos.z == 1)
         {
-            std::shared_ptr<Chunk> neighbour_chunk = GetChunk(x, z + 1);
-            if (chunk)
-            {
-                chunk->UpdateNeighbour(neighbour_chunk, Orientation::South);
-            }
-            else if (neighbour_chunk)
+            neighbour_chunk = GetChunk(x, z + 1);
+            if (neighbour_chunk)
             {
-                neighbour_chunk->UpdateNeighbour(nullptr, Orientation::North);
+                neighbour_chunk->SetModifiedSinceLastRender(true);
             }
         }
+#endif
     }
 
     const std::shared_ptr<const Chunk> World::GetChunkCopy(const int x, const int z)
@@ -573,7 +1175,17 @@ namespace Botcraft
             return nullptr;
         }
 
-        return std::shared_ptr<const Chunk>(new Chunk(*chunk));
+        // Not modified since last publication, the snapshot already has the same chunk
+        if (modified_chunks.find({ x, z }) == modified_chunks.end())
+        {
+            const std::shared_ptr<const Chunk> published = GetSnapshot().GetChunk(x, z);
+            if (published != nullptr)
+            {
+                return published;
+            }
+        }
+
+        return std::make_shared<const Chunk>(*chunk);
     }
 
     const Block* World::GetBlock(const Position &pos)
@@ -599,6 +1211,239 @@ namespace Botcraft
         return cached->GetBlock(Position((pos.x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, pos.y, (pos.z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH));
     }
 
+    const int World::GetHighestBlock(const int x, const int z, const HeightmapType type)
+    {
+        const int chunk_x = (int)floor(x / (double)CHUNK_WIDTH);
+        const int chunk_z = (int)floor(z / (double)CHUNK_WIDTH);
+
+        if (!cached || cached_x != chunk_x || cached_z != chunk_z)
+        {
+            auto it = terrain.find({ chunk_x, chunk_z });
+
+            if (it != terrain.end())
+            {
+                cached_x = chunk_x;
+                cached_z = chunk_z;
+                cached = it->second;
+            }
+            else
+            {
+                return std::numeric_limits<int>::min();
+            }
+        }
+        return cached->GetHighestBlock((x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, (z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, type);
+    }
+
+    void World::ForEachBlockInBox(const Position& start, const Position& end,
+        const std::function<void(const Position&, const Block&)>& callback,
+        const std::function<bool(const Blockstate*)>& filter)
+    {
+        const Position min_pos(std::min(start.x, end.x), std::min(start.y, end.y), std::min(start.z, end.z));
+        const Position max_pos(std::max(start.x, end.x), std::max(start.y, end.y), std::max(start.z, end.z));
+
+        const int min_chunk_x = (int)floor(min_pos.x / (double)CHUNK_WIDTH);
+        const int max_chunk_x = (int)floor(max_pos.x / (double)CHUNK_WIDTH);
+        const int min_chunk_z = (int)floor(min_pos.z / (double)CHUNK_WIDTH);
+        const int max_chunk_z = (int)floor(max_pos.z / (double)CHUNK_WIDTH);
+
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+
+        // Get all the loaded chunks in the box. If the box is
+        // bigger than the loaded area, iterate over the terrain
+        std::vector<std::pair<std::pair<int, int>, const Chunk*> > chunks;
+        if ((max_chunk_x - min_chunk_x + 1LL) * (max_chunk_z - min_chunk_z + 1LL) > static_cast<long long int>(terrain.size()))
+        {
+            for (auto it = terrain.begin(); it != terrain.end(); ++it)
+            {
+                if (it->first.first >= min_chunk_x && it->first.first <= max_chunk_x &&
+                    it->first.second >= min_chunk_z && it->first.second <= max_chunk_z)
+                {
+                    chunks.push_back({ it->first, it->second.get() });
+                }
+            }
+        }
+        else
+        {
+            for (int chunk_x = min_chunk_x; chunk_x <= max_chunk_x; ++chunk_x)
+            {
+                for (int chunk_z = min_chunk_z; chunk_z <= max_chunk_z; ++chunk_z)
+                {
+                    auto it = terrain.find({ chunk_x, chunk_z });
+                    if (it != terrain.end())
+                    {
+                        chunks.push_back({ it->first, it->second.get() });
+                    }
+                }
+            }
+        }
+
+        std::vector<bool> matching_entries;
+        Position pos;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            const int chunk_x = chunks[i].first.first;
+            const int chunk_z = chunks[i].first.second;
+            const Chunk* chunk = chunks[i].second;
+
+            const int start_x = std::max(min_pos.x - chunk_x * CHUNK_WIDTH, 0);
+            const int end_x = std::min(max_pos.x - chunk_x * CHUNK_WIDTH, CHUNK_WIDTH - 1);
+            const int start_z = std::max(min_pos.z - chunk_z * CHUNK_WIDTH, 0);
+            const int end_z = std::min(max_pos.z - chunk_z * CHUNK_WIDTH, CHUNK_WIDTH - 1);
+            const int start_y = std::max(min_pos.y, chunk->GetMinY()) - chunk->GetMinY();
+            const int end_y = std::min(max_pos.y, chunk->GetMinY() + chunk->GetHeight() - 1) - chunk->GetMinY();
+
+            for (int section_y = start_y / SECTION_HEIGHT; section_y <= end_y / SECTION_HEIGHT && start_y <= end_y; ++section_y)
+            {
+                // Missing sections are only air
+                const Section* section = chunk->GetSection(section_y);
+                if (section == nullptr)
+                {
+                    continue;
+                }
+
+                // Check the palette first, so sections with
+                // no matching block are skipped entirely
+                if (!GetMatchingPaletteEntries(section, filter, matching_entries))
+                {
+                    continue;
+                }
+                const std::deque<Block>& palette = section->GetPalette();
+
+                const int section_start_y = std::max(start_y - section_y * SECTION_HEIGHT, 0);
+                const int section_end_y = std::min(end_y - section_y * SECTION_HEIGHT, SECTION_HEIGHT - 1);
+                for (int y = section_start_y; y <= section_end_y; ++y)
+                {
+                    pos.y = chunk->GetMinY() + section_y * SECTION_HEIGHT + y;
+                    for (int z = start_z; z <= end_z; ++z)
+                    {
+                        pos.z = chunk_z * CHUNK_WIDTH + z;
+                        for (int x = start_x; x <= end_x; ++x)
+                        {
+                            const unsigned short palette_index = section->GetPaletteIndex(y * CHUNK_WIDTH * CHUNK_WIDTH + z * CHUNK_WIDTH + x);
+                            if (matching_entries[palette_index])
+                            {
+                                pos.x = chunk_x * CHUNK_WIDTH + x;
+                                callback(pos, palette[palette_index]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const std::optional<Position> World::FindNearest(const std::function<bool(const Blockstate*)>& filter,
+        const Position& origin, const int radius)
+    {
+        struct SectionCandidate
+        {
+            int sqr_dist;
+            int chunk_x;
+            int chunk_z;
+            int section_y;
+            const Chunk* chunk;
+            std::vector<bool> matching_entries;
+        };
+
+        const int sqr_radius = radius * radius;
+        const int min_chunk_x = (int)floor((origin.x - radius) / (double)CHUNK_WIDTH);
+        const int max_chunk_x = (int)floor((origin.x + radius) / (double)CHUNK_WIDTH);
+        const int min_chunk_z = (int)floor((origin.z - radius) / (double)CHUNK_WIDTH);
+        const int max_chunk_z = (int)floor((origin.z + radius) / (double)CHUNK_WIDTH);
+
+        // Squared distance between a coordinate and a [min, max] interval
+        auto SqrAxisDist = [](const int v, const int min, const int max)
+        {
+            const int d = v < min ? min - v : (v > max ? v - max : 0);
+            return d * d;
+        };
+
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+
+        // Get all the sections in range with at least one matching block
+        std::vector<SectionCandidate> candidates;
+        std::vector<bool> matching_entries;
+        for (int chunk_x = min_chunk_x; chunk_x <= max_chunk_x; ++chunk_x)
+        {
+            for (int chunk_z = min_chunk_z; chunk_z <= max_chunk_z; ++chunk_z)
+            {
+                auto it = terrain.find({ chunk_x, chunk_z });
+                if (it == terrain.end())
+                {
+                    continue;
+                }
+                const Chunk* chunk = it->second.get();
+
+                const int horizontal_sqr_dist = SqrAxisDist(origin.x, chunk_x * CHUNK_WIDTH, chunk_x * CHUNK_WIDTH + CHUNK_WIDTH - 1) +
+                    SqrAxisDist(origin.z, chunk_z * CHUNK_WIDTH, chunk_z * CHUNK_WIDTH + CHUNK_WIDTH - 1);
+                if (horizontal_sqr_dist > sqr_radius)
+                {
+                    continue;
+                }
+
+                for (int section_y = 0; section_y < chunk->GetHeight() / SECTION_HEIGHT; ++section_y)
+                {
+                    const int section_min_y = chunk->GetMinY() + section_y * SECTION_HEIGHT;
+                    const int sqr_dist = horizontal_sqr_dist + SqrAxisDist(origin.y, section_min_y, section_min_y + SECTION_HEIGHT - 1);
+                    if (sqr_dist > sqr_radius)
+                    {
+                        continue;
+                    }
+
+                    const Section* section = chunk->GetSection(section_y);
+                    if (section == nullptr || !GetMatchingPaletteEntries(section, filter, matching_entries))
+                    {
+                        continue;
+                    }
+
+                    candidates.push_back({ sqr_dist, chunk_x, chunk_z, section_y, chunk, matching_entries });
+                }
+            }
+        }
+
+        // Check the closest sections first
+        std::sort(candidates.begin(), candidates.end(), [](const SectionCandidate& a, const SectionCandidate& b)
+            {
+                return a.sqr_dist < b.sqr_dist;
+            });
+
+        std::optional<Position> output;
+        int best_sqr_dist = sqr_radius + 1;
+        Position pos;
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            const SectionCandidate& candidate = candidates[i];
+            // No block in the remaining sections can be closer
+            if (candidate.sqr_dist >= best_sqr_dist)
+            {
+                break;
+            }
+
+            const Section* section = candidate.chunk->GetSection(candidate.section_y);
+            for (int y = 0; y < SECTION_HEIGHT; ++y)
+            {
+                pos.y = candidate.chunk->GetMinY() + candidate.section_y * SECTION_HEIGHT + y;
+                for (int z = 0; z < CHUNK_WIDTH; ++z)
+                {
+                    pos.z = candidate.chunk_z * CHUNK_WIDTH + z;
+                    for (int x = 0; x < CHUNK_WIDTH; ++x)
+                    {
+                        pos.x = candidate.chunk_x * CHUNK_WIDTH + x;
+                        const int sqr_dist = static_cast<int>(pos.SqrDist(origin));
+                        if (sqr_dist < best_sqr_dist &&
+                            candidate.matching_entries[section->GetPaletteIndex(y * CHUNK_WIDTH * CHUNK_WIDTH + z * CHUNK_WIDTH + x)])
+                        {
+                            best_sqr_dist = sqr_dist;
+                            output = pos;
+                        }
+                    }
+                }
+            }
+        }
+
+        return output;
+    }
+
     const bool World::IsLoaded(const Position& pos) const
     {
         const int chunk_x = (int)floor(pos.x / (double)CHUNK_WIDTH);
@@ -776,7 +1621,7 @@ namespace Botcraft
 #endif
 
 
-    const std::map<std::pair<int, int>, std::shared_ptr<Chunk> >& World::GetAllChunks() const
+    const std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, ChunkCoordinatesHasher>& World::GetAllChunks() const
     {
         return terrain;
     }
@@ -786,31 +1631,266 @@ namespace Botcraft
     {
         return ++world_interaction_sequence_id;
     }
+
+    void World::PredictBlockChange(const Position& pos, const unsigned int blockstate_id, const int sequence_id)
+    {
+        if (is_shared)
+        {
+            return;
+        }
+        const Block* block = GetBlock(pos);
+        if (block == nullptr)
+        {
+            return;
+        }
+
+        auto it = predicted_blocks.find(pos);
+        if (it == predicted_blocks.end())
+        {
+            predicted_blocks[pos] = { sequence_id, block->GetBlockstate()->GetId() };
+        }
+        else
+        {
+            it->second.sequence_id = sequence_id;
+        }
+        SetBlock(pos, blockstate_id);
+        PublishSnapshot();
+        event_notifier.Notify(EventType::BlockChanged);
+    }
+
+    const int World::GetLastAcknowledgedSequenceId() const
+    {
+        return last_acknowledged_sequence_id;
+    }
+#endif
+
+    std::shared_ptr<Chunk> World::GetChunk(const int x, const int z)
+    {
+        if (!cached || cached_x != x || cached_z != z)
+        {
+            auto it = terrain.find({ x, z });
+
+            if (it != terrain.end())
+            {
+                cached_x = x;
+                cached_z = z;
+                cached = it->second;
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
+        return cached;
+    }
+
+    const bool World::GetMatchingPaletteEntries(const Section* section,
+        const std::function<bool(const Blockstate*)>& filter, std::vector<bool>& matching_entries)
+    {
+        const std::deque<Block>& palette = section->GetPalette();
+        matching_entries.assign(palette.size(), false);
+        bool any_match = false;
+        for (size_t i = 0; i < palette.size(); ++i)
+        {
+            const Blockstate* blockstate = palette[i].GetBlockstate();
+            matching_entries[i] = blockstate != nullptr && !blockstate->IsAir() && (!filter || filter(blockstate));
+            any_match |= matching_entries[i];
+        }
+        return any_match;
+    }
+
+    const std::string World::GetCacheDimensionName() const
+    {
+#if PROTOCOL_VERSION < 719
+        return std::to_string(static_cast<int>(current_dimension));
+#else
+        return current_dimension;
+#endif
+    }
+
+    void World::SaveChunkToCache(const int x, const int z)
+    {
+        if (!chunk_cache)
+        {
+            return;
+        }
+
+        auto it = terrain.find({ x, z });
+        if (it == terrain.end())
+        {
+            return;
+        }
+
+        chunk_cache->Save(GetCacheDimensionName(), x, z, *it->second);
+    }
+
+    void World::ForgetChunk(const int x, const int z)
+    {
+        auto it = terrain.find({ x, z });
+        if (it == terrain.end())
+        {
+            return;
+        }
+
+        if (forgotten_chunks_budget > 0)
+        {
+            AddForgottenChunk(x, z, it->second);
+        }
+        RemoveChunk(x, z);
+        EvictForgottenChunks();
+    }
+
+    void World::ForgetAllChunks()
+    {
+#if PROTOCOL_VERSION > 758
+        predicted_blocks.clear();
+#endif
+        if (forgotten_chunks_budget > 0)
+        {
+            for (auto it = terrain.begin(); it != terrain.end(); ++it)
+            {
+                AddForgottenChunk(it->first.first, it->first.second, it->second);
+            }
+            EvictForgottenChunks();
+        }
+        terrain = std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, ChunkCoordinatesHasher>();
+        cached = nullptr;
+    }
+
+#if PROTOCOL_VERSION < 719
+    std::shared_ptr<Chunk> World::TakeForgottenChunk(const Dimension dim, const int x, const int z)
+#else
+    std::shared_ptr<Chunk> World::TakeForgottenChunk(const std::string& dim, const int x, const int z)
 #endif
+    {
+        auto dim_it = forgotten_chunks_index.find(dim);
+        if (dim_it == forgotten_chunks_index.end())
+        {
+            return nullptr;
+        }
+        auto it = dim_it->second.find({ x, z });
+        if (it == dim_it->second.end())
+        {
+            return nullptr;
+        }
+
+        std::shared_ptr<Chunk> chunk = it->second->chunk;
+        forgotten_chunks_memory -= it->second->memory_bytes;
+        forgotten_chunks.erase(it->second);
+        dim_it->second.erase(it);
+        return chunk;
+    }
+
+    void World::AddForgottenChunk(const int x, const int z, const std::shared_ptr<Chunk>& chunk)
+    {
+        // Replace any older version of it
+        TakeForgottenChunk(chunk->GetDimension(), x, z);
+        const size_t memory_bytes = chunk->GetMemoryUsage();
+        forgotten_chunks.push_front(ForgottenChunk{ { x, z }, chunk, memory_bytes });
+        forgotten_chunks_index[chunk->GetDimension()][{ x, z }] = forgotten_chunks.begin();
+        forgotten_chunks_memory += memory_bytes;
+    }
+
+    void World::EvictForgottenChunks()
+    {
+        while (!forgotten_chunks.empty() && forgotten_chunks_memory > forgotten_chunks_budget)
+        {
+            const ForgottenChunk& oldest = forgotten_chunks.back();
+            forgotten_chunks_memory -= oldest.memory_bytes;
+            forgotten_chunks_index[oldest.chunk->GetDimension()].erase(oldest.coords);
+            forgotten_chunks.pop_back();
+        }
+    }
+
+    void World::ClearForgottenChunks()
+    {
+        forgotten_chunks.clear();
+        forgotten_chunks_index.clear();
+        forgotten_chunks_memory = 0;
+    }
+
+    void World::SetChunkModified(const int x, const int z)
+    {
+        modified_chunks.insert({ x, z });
+    }
+
+    void World::SetBlockChangesJournalSize(const size_t capacity)
+    {
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        // Changes recorded before are lost
+        block_changes = std::vector<BlockChange>(capacity);
+        first_block_change = last_block_change + 1;
+    }
+
+    const bool World::GetBlockChanges(const unsigned long long since, std::vector<BlockChange>& changes)
+    {
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        if (block_changes.empty())
+        {
+            return since >= last_block_change;
+        }
+
+        // Oldest change still in the ring
+        unsigned long long oldest = first_block_change;
+        if (last_block_change >= block_changes.size() && last_block_change - block_changes.size() + 1 > oldest)
+        {
+            oldest = last_block_change - block_changes.size() + 1;
+        }
+        for (unsigned long long i = std::max(since + 1, oldest); i <= last_block_change; ++i)
+        {
+            changes.push_back(block_changes[i % block_changes.size()]);
+        }
+        return since + 1 >= oldest;
+    }
+
+    const unsigned long long World::GetChunkBlocksVersion(const int x, const int z)
+    {
+        std::shared_ptr<Chunk> chunk = GetChunk(x, z);
+        return chunk == nullptr ? 0 : chunk->GetBlocksVersion();
+    }
 
-    std::shared_ptr<Chunk> World::GetChunk(const int x, const int z)
+    void World::RecordBlockChange(const Position& pos, const Blockstate* old_state, const Blockstate* new_state)
     {
-        if (!cached || cached_x != x || cached_z != z)
+        if (block_changes.empty() || old_state == new_state)
         {
-            auto it = terrain.find({ x, z });
-
-            if (it != terrain.end())
-            {
-                cached_x = x;
-                cached_z = z;
-                cached = it->second;
-            }
-            else
-            {
-                return nullptr;
-            }
+            return;
         }
 
-        return cached;
+        last_block_change += 1;
+        block_changes[last_block_change % block_changes.size()] = BlockChange{ last_block_change, pos, old_state, new_state };
     }
 
     void World::Handle(ProtocolCraft::ClientboundLoginPacket& msg)
     {
+        {
+            std::lock_guard<std::mutex> world_guard(world_mutex);
+            chunk_cache_loaded = false;
+#if PROTOCOL_VERSION >= 477
+            chunk_cache_radius = msg.GetChunkRadius();
+#endif
+#if PROTOCOL_VERSION > 471
+            has_interest_center = false;
+#endif
+            // After a reconnection, chunks are kept as a stale cache
+            // until the server sends them again, unless the player
+            // is now in another dimension
+#if PROTOCOL_VERSION < 719
+            const bool dimension_changed = current_dimension != (Dimension)msg.GetDimension();
+#else
+            const bool dimension_changed = current_dimension != msg.GetDimension().GetFull();
+#endif
+            if (!is_shared && dimension_changed && !terrain.empty())
+            {
+                ForgetAllChunks();
+                modified_chunks.clear();
+                std::atomic_store(&terrain_snapshot, std::make_shared<const WorldSnapshot::Regions>());
+#if PROTOCOL_VERSION > 756
+                pending_chunk_decodes.clear();
+                deferred_chunk_updates.clear();
+#endif
+            }
+        }
 #if PROTOCOL_VERSION < 719
         current_dimension = (Dimension)msg.GetDimension();
 #else
@@ -818,18 +1898,17 @@ namespace Botcraft
 #endif
 #if PROTOCOL_VERSION > 756
 #if PROTOCOL_VERSION < 759
-        dimension_height[current_dimension] = std::dynamic_pointer_cast<ProtocolCraft::TagInt>(msg.GetDimensionType().GetTag("height"))->GetValue();
-        dimension_min_y[current_dimension] = std::dynamic_pointer_cast<ProtocolCraft::TagInt>(msg.GetDimensionType().GetTag("min_y"))->GetValue();
+        dimension_height[current_dimension] = msg.GetDimensionType().GetFlatTag("height").GetInt();
+        dimension_min_y[current_dimension] = msg.GetDimensionType().GetFlatTag("min_y").GetInt();
 #else
-        std::shared_ptr<ProtocolCraft::TagList> dimension_types = std::dynamic_pointer_cast<ProtocolCraft::TagList>(std::dynamic_pointer_cast<ProtocolCraft::TagCompound>(msg.GetRegistryHolder().GetTag("minecraft:dimension_type"))->GetValues().at("value"));
-        for (const auto& d : dimension_types->GetValues())
+        const ProtocolCraft::FlatTag dimension_types = msg.GetRegistryHolder().GetFlatTag("minecraft:dimension_type").GetChild("value");
+        for (const ProtocolCraft::FlatTag dim_entry : dimension_types)
         {
-            const std::shared_ptr<ProtocolCraft::TagCompound> dim_entry = std::dynamic_pointer_cast<ProtocolCraft::TagCompound>(d);
-            const std::string& dim_name = std::dynamic_pointer_cast<ProtocolCraft::TagString>(dim_entry->GetValues().at("name"))->GetValue();
-            const std::shared_ptr<ProtocolCraft::TagCompound> dim_element = std::dynamic_pointer_cast<ProtocolCraft::TagCompound>(dim_entry->GetValues().at("element"));
+            const std::string dim_name = dim_entry.GetChild("name").GetString();
+            const ProtocolCraft::FlatTag dim_element = dim_entry.GetChild("element");
 
-            dimension_height[dim_name] = std::dynamic_pointer_cast<ProtocolCraft::TagInt>(dim_element->GetValues().at("height"))->GetValue();
-            dimension_min_y[dim_name] = std::dynamic_pointer_cast<ProtocolCraft::TagInt>(dim_element->GetValues().at("min_y"))->GetValue();
+            dimension_height[dim_name] = dim_element.GetChild("height").GetInt();
+            dimension_min_y[dim_name] = dim_element.GetChild("min_y").GetInt();
         }
 #endif
 #endif
@@ -838,7 +1917,29 @@ namespace Botcraft
     void World::Handle(ProtocolCraft::ClientboundRespawnPacket& msg)
     {
         std::lock_guard<std::mutex> world_guard(world_mutex);
-        terrain = std::map<std::pair<int, int>, std::shared_ptr<Chunk> >();
+        if (chunk_cache)
+        {
+            for (auto it = terrain.begin(); it != terrain.end(); ++it)
+            {
+                SaveChunkToCache(it->first.first, it->first.second);
+            }
+            // Don't write them on the network thread while holding the world mutex
+            chunk_cache->FlushAsync();
+        }
+        chunk_cache_loaded = false;
+#if PROTOCOL_VERSION > 471
+        has_interest_center = false;
+#endif
+        // Chunks of the previous dimension are kept if possible, the
+        // server will send them again if we come back
+        ForgetAllChunks();
+        modified_chunks.clear();
+        std::atomic_store(&terrain_snapshot, std::make_shared<const WorldSnapshot::Regions>());
+#if PROTOCOL_VERSION > 756
+        // Chunks being decoded are from the previous dimension
+        pending_chunk_decodes.clear();
+        deferred_chunk_updates.clear();
+#endif
 
 #if PROTOCOL_VERSION < 719
         current_dimension = (Dimension)msg.GetDimension();
@@ -847,8 +1948,8 @@ namespace Botcraft
 #endif
 
 #if PROTOCOL_VERSION > 756 && PROTOCOL_VERSION < 759
-        dimension_height[current_dimension] = std::dynamic_pointer_cast<ProtocolCraft::TagInt>(msg.GetDimensionType().GetTag("height"))->GetValue();
-        dimension_min_y[current_dimension] = std::dynamic_pointer_cast<ProtocolCraft::TagInt>(msg.GetDimensionType().GetTag("min_y"))->GetValue();
+        dimension_height[current_dimension] = msg.GetDimensionType().GetFlatTag("height").GetInt();
+        dimension_min_y[current_dimension] = msg.GetDimensionType().GetFlatTag("min_y").GetInt();
 #endif
     }
 
@@ -861,58 +1962,110 @@ namespace Botcraft
         Blockstate::IdToIdMetadata(msg.GetBlockstate(), id, metadata);
         SetBlock(msg.GetPos(), id, metadata);
 #else
+#if PROTOCOL_VERSION > 756
+        const Position pos = msg.GetPos();
+        const unsigned int blockstate = msg.GetBlockstate();
+        const Position chunk_coords = Chunk::BlockCoordsToChunkCoords(pos);
+        if (DeferChunkUpdate(chunk_coords.x, chunk_coords.z, [this, pos, blockstate]() { SetBlock(pos, blockstate); }))
+        {
+            return;
+        }
+#endif
+#if PROTOCOL_VERSION > 758
+        // Keep the predicted block until the server acknowledges it
+        auto predicted = predicted_blocks.find(msg.GetPos());
+        if (predicted != predicted_blocks.end())
+        {
+            predicted->second.server_blockstate_id = msg.GetBlockstate();
+            return;
+        }
+#endif
         SetBlock(msg.GetPos(), msg.GetBlockstate());
 #endif
+        PublishSnapshot();
+        event_notifier.Notify(EventType::BlockChanged);
     }
 
     void World::Handle(ProtocolCraft::ClientboundSectionBlocksUpdatePacket& msg)
     {
+        // Positions are relative to the chunk, all the
+        // blocks are applied as one batch
+        std::vector<std::pair<Position, unsigned int> > blocks;
 #if PROTOCOL_VERSION < 739
+        const int chunk_x = msg.GetChunkX();
+        const int chunk_z = msg.GetChunkZ();
+
+        blocks.reserve(msg.GetRecordCount());
         for (int i = 0; i < msg.GetRecordCount(); ++i)
         {
-            unsigned char x = (msg.GetRecords()[i].GetHorizontalPosition() >> 4) & 0x0F;
-            unsigned char z = msg.GetRecords()[i].GetHorizontalPosition() & 0x0F;
+            const int x = (msg.GetRecords()[i].GetHorizontalPosition() >> 4) & 0x0F;
+            const int z = msg.GetRecords()[i].GetHorizontalPosition() & 0x0F;
 
-            const int x_pos = CHUNK_WIDTH * msg.GetChunkX() + x;
-            const int y_pos = msg.GetRecords()[i].GetYCoordinate();
-            const int z_pos = CHUNK_WIDTH * msg.GetChunkZ() + z;
+            blocks.push_back({ Position(x, msg.GetRecords()[i].GetYCoordinate(), z), static_cast<unsigned int>(msg.GetRecords()[i].GetBlockId()) });
+        }
 #else
-        const int chunk_x = CHUNK_WIDTH * (msg.GetSectionPos() >> 42); // 22 bits
-        const int chunk_z = CHUNK_WIDTH * (msg.GetSectionPos() << 22 >> 42); // 22 bits
-        const int chunk_y = SECTION_HEIGHT * (msg.GetSectionPos() << 44 >> 44); // 20 bits
+        const int chunk_x = static_cast<int>(msg.GetSectionPos() >> 42); // 22 bits
+        const int chunk_z = static_cast<int>(msg.GetSectionPos() << 22 >> 42); // 22 bits
+        const int chunk_y = SECTION_HEIGHT * static_cast<int>(msg.GetSectionPos() << 44 >> 44); // 20 bits
 
         const size_t data_size = msg.GetPositions().size();
+        blocks.reserve(data_size);
         for (int i = 0; i < data_size; ++i)
         {
-            const unsigned int block_id = msg.GetStates()[i];
-
-            const int x_pos = chunk_x + ((msg.GetPositions()[i] >> 8) & 0xF);
-            const int z_pos = chunk_z + ((msg.GetPositions()[i] >> 4) & 0xF);
-            const int y_pos = chunk_y + ((msg.GetPositions()[i] >> 0) & 0xF);
+            blocks.push_back({
+                Position(
+                    (msg.GetPositions()[i] >> 8) & 0xF,
+                    chunk_y + ((msg.GetPositions()[i] >> 0) & 0xF),
+                    (msg.GetPositions()[i] >> 4) & 0xF
+                ),
+                static_cast<unsigned int>(msg.GetStates()[i])
+            });
+        }
 #endif
-            Position cube_pos(x_pos, y_pos, z_pos);
 
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+#if PROTOCOL_VERSION > 758
+        // Keep the predicted blocks until the server acknowledges them
+        if (!predicted_blocks.empty())
+        {
+            for (auto it = blocks.begin(); it != blocks.end();)
             {
-                std::lock_guard<std::mutex> world_guard(world_mutex);
-#if PROTOCOL_VERSION < 347
-                unsigned int id;
-                unsigned char metadata;
-                Blockstate::IdToIdMetadata(msg.GetRecords()[i].GetBlockId(), id, metadata);
-
-                SetBlock(cube_pos, id, metadata);
-#elif PROTOCOL_VERSION < 739
-                SetBlock(cube_pos, msg.GetRecords()[i].GetBlockId());
-#else
-                SetBlock(cube_pos, block_id);
-#endif
+                auto predicted = predicted_blocks.find(Position(chunk_x * CHUNK_WIDTH + it->first.x, it->first.y, chunk_z * CHUNK_WIDTH + it->first.z));
+                if (predicted != predicted_blocks.end())
+                {
+                    predicted->second.server_blockstate_id = it->second;
+                    it = blocks.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
             }
         }
+#endif
+#if PROTOCOL_VERSION > 756
+        if (!DeferChunkUpdate(chunk_x, chunk_z, [this, chunk_x, chunk_z, blocks]() { SetBlocksInChunk(chunk_x, chunk_z, blocks); }))
+#endif
+        {
+            SetBlocksInChunk(chunk_x, chunk_z, blocks);
+        }
+
+        PublishSnapshot();
+        event_notifier.Notify(EventType::BlockChanged);
     }
 
     void World::Handle(ProtocolCraft::ClientboundForgetLevelChunkPacket& msg)
     {
         std::lock_guard<std::mutex> world_guard(world_mutex);
-        RemoveChunk(msg.GetX(), msg.GetZ());
+#if PROTOCOL_VERSION > 756
+        // Drop the chunk if it's still being decoded
+        pending_chunk_decodes.erase({ msg.GetX(), msg.GetZ() });
+        deferred_chunk_updates.erase({ msg.GetX(), msg.GetZ() });
+#endif
+        SaveChunkToCache(msg.GetX(), msg.GetZ());
+        ForgetChunk(msg.GetX(), msg.GetZ());
+        PublishSnapshot();
+        event_notifier.Notify(EventType::ChunkUnloaded);
     }
 
 #if PROTOCOL_VERSION < 757
@@ -925,6 +2078,12 @@ namespace Botcraft
 #endif
         {
             std::lock_guard<std::mutex> world_guard(world_mutex);
+#if PROTOCOL_VERSION > 471
+            if (IsOutsideInterest(msg.GetX(), msg.GetZ()))
+            {
+                return;
+            }
+#endif
             chunk_dim = GetDimension(msg.GetX(), msg.GetZ());
         }
 
@@ -973,13 +2132,49 @@ namespace Botcraft
 #else
             LoadBiomesInChunk(msg.GetX(), msg.GetZ(), msg.GetBiomes());
 #endif
+#endif
+#if PROTOCOL_VERSION > 442
+            LoadHeightmapsInChunk(msg.GetX(), msg.GetZ(), msg.GetHeightmaps());
 #endif
             LoadBlockEntityDataInChunk(msg.GetX(), msg.GetZ(), msg.GetBlockEntitiesTags());
+            PublishSnapshot();
+            event_notifier.Notify(EventType::ChunkLoaded);
         }
     }
 #else
     void World::Handle(ProtocolCraft::ClientboundLevelChunkWithLightPacket& msg)
     {
+        {
+            std::lock_guard<std::mutex> world_guard(world_mutex);
+            if (IsOutsideInterest(msg.GetX(), msg.GetZ()))
+            {
+                return;
+            }
+        }
+
+        if (!chunk_decode_threads.empty())
+        {
+            ChunkDecodeJob job;
+            // Copy the message as it can be reused by the network manager
+            job.msg = std::static_pointer_cast<ProtocolCraft::ClientboundLevelChunkWithLightPacket>(msg.Clone());
+            {
+                std::lock_guard<std::mutex> world_guard(world_mutex);
+                job.dimension = current_dimension;
+                job.min_y = dimension_min_y[current_dimension];
+                job.height = dimension_height[current_dimension];
+                job.id = ++next_chunk_decode_id;
+                // Updates received before this packet are already in it
+                pending_chunk_decodes[{ msg.GetX(), msg.GetZ() }] = job.id;
+                deferred_chunk_updates.erase({ msg.GetX(), msg.GetZ() });
+            }
+            {
+                std::lock_guard<std::mutex> lock(chunk_decode_mutex);
+                chunk_decode_jobs.push(std::move(job));
+            }
+            chunk_decode_condition.notify_one();
+            return;
+        }
+
         std::string chunk_dim;
         {
             std::lock_guard<std::mutex> world_guard(world_mutex);
@@ -1004,17 +2199,23 @@ namespace Botcraft
             // lock guard scope
             std::lock_guard<std::mutex> world_guard(world_mutex);
             LoadDataInChunk(msg.GetX(), msg.GetZ(), msg.GetChunkData().GetBuffer());
+            LoadHeightmapsInChunk(msg.GetX(), msg.GetZ(), msg.GetChunkData().GetHeightmaps());
             LoadBlockEntityDataInChunk(msg.GetX(), msg.GetZ(), msg.GetChunkData().GetBlockEntitiesData());
             UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
                 msg.GetLightData().GetSkyYMask(), msg.GetLightData().GetEmptySkyYMask(), msg.GetLightData().GetSkyUpdates(), true);
             UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
                 msg.GetLightData().GetBlockYMask(), msg.GetLightData().GetEmptyBlockYMask(), msg.GetLightData().GetBlockUpdates(), false);
+            PublishSnapshot();
+            event_notifier.Notify(EventType::ChunkLoaded);
         }
     }
 #endif
 
-    const Blockstate* World::Raycast(const Vector3<double> &origin, const Vector3<double> &direction,
-        const float max_radius, Position & out_pos, Position & out_normal)
+    /// @brief Voxel traversal used by the raycasts
+    /// @param get_chunk Called with the coordinates of each chunk the ray enters, returns nullptr if not loaded
+    template<class ChunkGetter>
+    static const Blockstate* TraceRay(const Vector3<double>& origin, const Vector3<double>& direction,
+        const float max_radius, Position& out_pos, Position& out_normal, ChunkGetter&& get_chunk)
     {
         // Inspired from https://gist.github.com/dogfuntom/cc881c8fc86ad43d55d8
         // Searching along origin + t * direction line
@@ -1071,23 +2272,114 @@ namespace Botcraft
 
         const float radius = max_radius / std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
 
+        // Current chunk and section, only looked up again when
+        // the ray crosses a chunk or a section boundary
+        const Chunk* chunk = nullptr;
+        int chunk_x = 0;
+        int chunk_z = 0;
+        bool chunk_valid = false;
+        const Section* section = nullptr;
+        int section_y = 0;
+        bool section_valid = false;
+
         while (true)
         {
-            const Block* block = GetBlock(out_pos);
+            const int current_chunk_x = static_cast<int>(std::floor(out_pos.x / static_cast<double>(CHUNK_WIDTH)));
+            const int current_chunk_z = static_cast<int>(std::floor(out_pos.z / static_cast<double>(CHUNK_WIDTH)));
+            if (!chunk_valid || current_chunk_x != chunk_x || current_chunk_z != chunk_z)
+            {
+                chunk_x = current_chunk_x;
+                chunk_z = current_chunk_z;
+                chunk = get_chunk(chunk_x, chunk_z);
+                chunk_valid = true;
+                section_valid = false;
+            }
 
-            if (block)
+            // Sections are aligned on multiples of SECTION_HEIGHT, even without chunk
+            const int current_section_y = static_cast<int>(std::floor(out_pos.y / static_cast<double>(SECTION_HEIGHT)));
+            if (!section_valid || current_section_y != section_y)
             {
-                const Blockstate* blockstate = block->GetBlockstate();
-                if (!block->GetBlockstate()->IsAir())
+                section_y = current_section_y;
+                section = nullptr;
+                if (chunk != nullptr)
                 {
-                    const auto& cubes = blockstate->GetModel(block->GetModelId()).GetColliders();
-                    for (int i = 0; i < cubes.size(); ++i)
+                    const int min_section_y = chunk->GetMinY() / SECTION_HEIGHT;
+                    section = chunk->GetSection(section_y - min_section_y);
+                }
+                section_valid = true;
+            }
+
+            if (section == nullptr || section->GetNumNonAirBlocks() == 0)
+            {
+                // Nothing to hit in this section, jump to the
+                // first block of the next one the ray goes through
+                const Position section_min(chunk_x * CHUNK_WIDTH, section_y * SECTION_HEIGHT, chunk_z * CHUNK_WIDTH);
+                const Position section_max = section_min + Position(CHUNK_WIDTH - 1, SECTION_HEIGHT - 1, CHUNK_WIDTH - 1);
+
+                // t-value and number of steps to exit the section along each axis
+                Vector3<double> t_exit;
+                Position num_exit_steps;
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (step[i] > 0)
                     {
-                        const AABB current_cube = cubes[i] + out_pos;
-                        if (current_cube.Intersect(origin, direction))
-                        {
-                            return blockstate;
-                        }
+                        num_exit_steps[i] = section_max[i] - out_pos[i] + 1;
+                    }
+                    else if (step[i] < 0)
+                    {
+                        num_exit_steps[i] = out_pos[i] - section_min[i] + 1;
+                    }
+                    else
+                    {
+                        num_exit_steps[i] = 0;
+                    }
+                    t_exit[i] = step[i] == 0 ? std::numeric_limits<double>::max() : tMax[i] + (num_exit_steps[i] - 1) * tDelta[i];
+                }
+
+                int exit_axis = 0;
+                for (int i = 1; i < 3; ++i)
+                {
+                    if (t_exit[i] < t_exit[exit_axis])
+                    {
+                        exit_axis = i;
+                    }
+                }
+
+                if (t_exit[exit_axis] > radius)
+                {
+                    return nullptr;
+                }
+
+                // Also move on the other axes for all the boundaries crossed before exiting
+                for (int i = 0; i < 3; ++i)
+                {
+                    int num_steps = num_exit_steps[i];
+                    if (i != exit_axis)
+                    {
+                        num_steps = (step[i] == 0 || tMax[i] >= t_exit[exit_axis]) ? 0 :
+                            std::min(num_exit_steps[i] - 1, static_cast<int>(std::ceil((t_exit[exit_axis] - tMax[i]) / tDelta[i])));
+                    }
+                    out_pos[i] += static_cast<int>(step[i]) * num_steps;
+                    tMax[i] += num_steps * tDelta[i];
+                    out_normal[i] = i == exit_axis ? -static_cast<int>(step[i]) : 0;
+                }
+                continue;
+            }
+
+            const Block* block = section->GetBlock(
+                (out_pos.y - section_y * SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_WIDTH +
+                (out_pos.z - chunk_z * CHUNK_WIDTH) * CHUNK_WIDTH +
+                (out_pos.x - chunk_x * CHUNK_WIDTH));
+
+            if (!block->HasFlag(BlockstateFlag::Air))
+            {
+                const auto& cubes = Model::GetColliders(block->GetCollidersId());
+                for (int i = 0; i < cubes.size(); ++i)
+                {
+                    const AABB current_cube = cubes[i] + out_pos;
+                    if (current_cube.Intersect(origin, direction))
+                    {
+                        return block->GetBlockstate();
                     }
                 }
             }
@@ -1129,10 +2421,122 @@ namespace Botcraft
                 out_pos.z += step.z;
                 tMax.z += tDelta.z;
                 out_normal.x = 0;
-                out_normal.x = 0;
-                out_normal.x = -step.z;
+                out_normal.y = 0;
+                out_normal.z = -step.z;
+            }
+        }
+    }
+
+    const Blockstate* World::Raycast(const Vector3<double> &origin, const Vector3<double> &direction,
+        const float max_radius, Position & out_pos, Position & out_normal)
+    {
+        return TraceRay(origin, direction, max_radius, out_pos, out_normal, [this](const int x, const int z) -> const Chunk*
+            {
+                auto it = terrain.find({ x, z });
+                return it == terrain.end() ? nullptr : it->second.get();
+            });
+    }
+
+    std::vector<RaycastHit> World::RaycastBatch(const std::vector<std::pair<Vector3<double>, Vector3<double> > >& rays, const float max_radius)
+    {
+        const WorldSnapshot snapshot = GetSnapshot();
+        // Chunks already looked up by the previous rays, most rays go through the same few chunks
+        std::unordered_map<std::pair<int, int>, const Chunk*, ChunkCoordinatesHasher> chunks;
+        auto get_chunk = [&](const int x, const int z) -> const Chunk*
+        {
+            auto it = chunks.find({ x, z });
+            if (it == chunks.end())
+            {
+                it = chunks.insert({ { x, z }, snapshot.GetChunk(x, z).get() }).first;
+            }
+            return it->second;
+        };
+
+        std::vector<RaycastHit> output(rays.size());
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            output[i].blockstate = TraceRay(rays[i].first, rays[i].second, max_radius, output[i].pos, output[i].normal, get_chunk);
+        }
+        return output;
+    }
+
+    std::vector<bool> World::HasLineOfSight(const Vector3<double>& eye, const std::vector<Vector3<double> >& targets)
+    {
+        const WorldSnapshot snapshot = GetSnapshot();
+        const VirtualClock::time_point now = VirtualClock::now();
+        const Position eye_block(std::floor(eye.x), std::floor(eye.y), std::floor(eye.z));
+
+        std::vector<bool> output(targets.size(), true);
+        std::lock_guard<std::mutex> line_of_sight_guard(line_of_sight_mutex);
+        // Don't let the cache grow with old entries
+        if (line_of_sight_cache.size() > 4096)
+        {
+            for (auto it = line_of_sight_cache.begin(); it != line_of_sight_cache.end();)
+            {
+                it = now - it->second.computed > line_of_sight_duration ? line_of_sight_cache.erase(it) : std::next(it);
+            }
+        }
+
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            const Vector3<double> direction = targets[i] - eye;
+            const double distance = std::sqrt(direction.dot(direction));
+            if (distance == 0.0)
+            {
+                continue;
+            }
+
+            const std::pair<Position, Position> key(eye_block, Position(std::floor(targets[i].x), std::floor(targets[i].y), std::floor(targets[i].z)));
+            auto it = line_of_sight_cache.find(key);
+            if (it != line_of_sight_cache.end() && now - it->second.computed <= line_of_sight_duration)
+            {
+                bool up_to_date = true;
+                for (const auto& [coords, version] : it->second.chunk_versions)
+                {
+                    const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(coords.first, coords.second);
+                    if ((chunk == nullptr ? 0 : chunk->GetBlocksVersion()) != version)
+                    {
+                        up_to_date = false;
+                        break;
+                    }
+                }
+                if (up_to_date)
+                {
+                    output[i] = it->second.visible;
+                    continue;
+                }
+            }
+
+            LineOfSightEntry entry;
+            Position hit_pos;
+            Position hit_normal;
+            entry.visible = TraceRay(eye, direction, static_cast<float>(distance), hit_pos, hit_normal, [&](const int x, const int z) -> const Chunk*
+                {
+                    const std::shared_ptr<const Chunk> chunk = snapshot.GetChunk(x, z);
+                    entry.chunk_versions.push_back({ { x, z }, chunk == nullptr ? 0 : chunk->GetBlocksVersion() });
+                    // Snapshot chunks live as long as the snapshot
+                    return chunk.get();
+                }) == nullptr;
+            entry.computed = now;
+            output[i] = entry.visible;
+            if (line_of_sight_duration.count() > 0)
+            {
+                line_of_sight_cache[key] = std::move(entry);
             }
         }
+        return output;
+    }
+
+    const bool World::HasLineOfSight(const Vector3<double>& eye, const Vector3<double>& target)
+    {
+        return HasLineOfSight(eye, std::vector<Vector3<double> >{ target })[0];
+    }
+
+    void World::SetLineOfSightCacheDuration(const int duration_ms)
+    {
+        std::lock_guard<std::mutex> line_of_sight_guard(line_of_sight_mutex);
+        line_of_sight_duration = std::chrono::milliseconds(std::max(0, duration_ms));
+        line_of_sight_cache.clear();
     }
 
 #if PROTOCOL_VERSION > 404
@@ -1145,18 +2549,204 @@ namespace Botcraft
         UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
             msg.GetBlockYMask(), msg.GetEmptyBlockYMask(), msg.GetBlockUpdates(), false);
 #else
+        const int x = msg.GetX();
+        const int z = msg.GetZ();
+        // Only copy the light data if it can't be applied now,
+        // the message buffers are reused for the next packet
+        if (pending_chunk_decodes.find({ x, z }) != pending_chunk_decodes.end())
+        {
+            const ProtocolCraft::ClientboundLightUpdatePacketData light_data = msg.GetLightData();
+            const std::string dimension = current_dimension;
+            DeferChunkUpdate(x, z, [this, x, z, light_data, dimension]()
+                {
+                    UpdateChunkLight(x, z, dimension, light_data.GetSkyYMask(), light_data.GetEmptySkyYMask(), light_data.GetSkyUpdates(), true);
+                    UpdateChunkLight(x, z, dimension, light_data.GetBlockYMask(), light_data.GetEmptyBlockYMask(), light_data.GetBlockUpdates(), false);
+                });
+            return;
+        }
         UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
             msg.GetLightData().GetSkyYMask(), msg.GetLightData().GetEmptySkyYMask(), msg.GetLightData().GetSkyUpdates(), true);
         UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
             msg.GetLightData().GetBlockYMask(), msg.GetLightData().GetEmptyBlockYMask(), msg.GetLightData().GetBlockUpdates(), false);
 #endif
+        PublishSnapshot();
+    }
+#endif
+
+#if PROTOCOL_VERSION > 471
+    void World::Handle(ProtocolCraft::ClientboundSetChunkCacheCenterPacket& msg)
+    {
+        std::unique_lock<std::mutex> world_guard(world_mutex);
+        has_interest_center = true;
+        interest_center_x = msg.GetX();
+        interest_center_z = msg.GetZ();
+        DropChunksOutsideInterest();
+
+        if (!chunk_cache || chunk_cache_loaded)
+        {
+            return;
+        }
+        // Only load the cached chunks once after joining a dimension,
+        // the server will then send or forget all chunks in its view
+        chunk_cache_loaded = true;
+        const std::string dimension = GetCacheDimensionName();
+        const int radius = chunk_cache_radius;
+        const std::shared_ptr<ChunkCache> cache = chunk_cache;
+
+        // Read the region files without blocking the world
+        world_guard.unlock();
+        const std::vector<std::pair<std::pair<int, int>, std::shared_ptr<Chunk> > > cached_chunks =
+            cache->Load(dimension, msg.GetX(), msg.GetZ(), radius);
+        world_guard.lock();
+
+        // The player changed dimension while loading
+        if (!chunk_cache_loaded || GetCacheDimensionName() != dimension)
+        {
+            return;
+        }
+        for (size_t i = 0; i < cached_chunks.size(); ++i)
+        {
+            const std::pair<int, int>& coords = cached_chunks[i].first;
+            // Don't replace chunks already sent by the server
+            if (terrain.find(coords) != terrain.end()
+#if PROTOCOL_VERSION > 756
+                || pending_chunk_decodes.find(coords) != pending_chunk_decodes.end()
+#endif
+                )
+            {
+                continue;
+            }
+            terrain[coords] = cached_chunks[i].second;
+            SetChunkModified(coords.first, coords.second);
+            UpdateChunk(coords.first, coords.second);
+        }
+        LOG_INFO(cached_chunks.size() << " chunks loaded from cache");
+        PublishSnapshot();
+    }
+#endif
+
+#if PROTOCOL_VERSION > 758
+    void World::Handle(ProtocolCraft::ClientboundBlockChangedAckPacket& msg)
+    {
+        std::lock_guard<std::mutex> world_guard(world_mutex);
+        last_acknowledged_sequence_id = std::max(last_acknowledged_sequence_id, msg.GetSequence());
+        // The server processed these interactions, its blocks are now the truth
+        for (auto it = predicted_blocks.begin(); it != predicted_blocks.end();)
+        {
+            if (it->second.sequence_id <= msg.GetSequence())
+            {
+                SetBlock(it->first, it->second.server_blockstate_id);
+                it = predicted_blocks.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        PublishSnapshot();
+        event_notifier.Notify(EventType::BlockChanged);
     }
 #endif
 
     void World::Handle(ProtocolCraft::ClientboundBlockEntityDataPacket& msg)
     {
         std::lock_guard<std::mutex> world_guard(world_mutex);
+#if PROTOCOL_VERSION > 756
+        const Position pos = msg.GetPos();
+        const ProtocolCraft::NBT tag = msg.GetTag();
+        const Position chunk_coords = Chunk::BlockCoordsToChunkCoords(pos);
+        if (DeferChunkUpdate(chunk_coords.x, chunk_coords.z, [this, pos, tag]() { SetBlockEntityData(pos, tag); }))
+        {
+            return;
+        }
+#endif
         SetBlockEntityData(msg.GetPos(), msg.GetTag());
+        PublishSnapshot();
+    }
+
+#if PROTOCOL_VERSION > 756
+    void World::DecodeChunks()
+    {
+        Logger::GetInstance().RegisterThread("ChunkDecode");
+        while (true)
+        {
+            ChunkDecodeJob job;
+            {
+                std::unique_lock<std::mutex> lock(chunk_decode_mutex);
+                chunk_decode_condition.wait(lock, [this]() { return !decoding_chunks || !chunk_decode_jobs.empty(); });
+                if (!decoding_chunks)
+                {
+                    return;
+                }
+                job = std::move(chunk_decode_jobs.front());
+                chunk_decode_jobs.pop();
+            }
+
+            const int x = job.msg->GetX();
+            const int z = job.msg->GetZ();
+            TRACE_ZONE("DecodeChunk", "x", x, "z", z);
+
+            // Decode everything in a new chunk without any lock
+            std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>(job.min_y, job.height, job.dimension);
+            chunk->LoadChunkData(job.msg->GetChunkData().GetBuffer());
+            chunk->LoadHeightmaps(job.msg->GetChunkData().GetHeightmaps());
+            chunk->LoadChunkBlockEntitiesData(job.msg->GetChunkData().GetBlockEntitiesData());
+            if (store_light)
+            {
+                LoadLightInChunk(chunk.get(), job.msg->GetLightData().GetSkyYMask(), job.msg->GetLightData().GetEmptySkyYMask(), job.msg->GetLightData().GetSkyUpdates(), true);
+                LoadLightInChunk(chunk.get(), job.msg->GetLightData().GetBlockYMask(), job.msg->GetLightData().GetEmptyBlockYMask(), job.msg->GetLightData().GetBlockUpdates(), false);
+            }
+
+            std::lock_guard<std::mutex> world_guard(world_mutex);
+            auto pending = pending_chunk_decodes.find({ x, z });
+            // The chunk has been unloaded or a more recent
+            // version has been received in the meantime
+            if (pending == pending_chunk_decodes.end() || pending->second != job.id)
+            {
+                continue;
+            }
+            pending_chunk_decodes.erase(pending);
+
+            // Already decoded in a new chunk, the old one isn't needed anymore
+            TakeForgottenChunk(job.dimension, x, z);
+            terrain[{ x, z }] = chunk;
+            if (cached && cached_x == x && cached_z == z)
+            {
+                cached = chunk;
+            }
+            SetChunkModified(x, z);
+            UpdateChunk(x, z);
+
+            auto deferred = deferred_chunk_updates.find({ x, z });
+            const bool has_deferred_updates = deferred != deferred_chunk_updates.end();
+            if (has_deferred_updates)
+            {
+                for (size_t i = 0; i < deferred->second.size(); ++i)
+                {
+                    deferred->second[i]();
+                }
+                deferred_chunk_updates.erase(deferred);
+            }
+
+            PublishSnapshot();
+            event_notifier.Notify(EventType::ChunkLoaded);
+            if (has_deferred_updates)
+            {
+                event_notifier.Notify(EventType::BlockChanged);
+            }
+        }
     }
 
+    const bool World::DeferChunkUpdate(const int x, const int z, const std::function<void()>& update)
+    {
+        if (pending_chunk_decodes.find({ x, z }) == pending_chunk_decodes.end())
+        {
+            return false;
+        }
+
+        deferred_chunk_updates[{ x, z }].push_back(update);
+        return true;
+    }
+#endif
+
 } // Botcraft
\ No newline at end of file
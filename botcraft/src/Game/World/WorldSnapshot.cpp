@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "botcraft/Game/World/WorldSnapshot.hpp"
+#include "botcraft/Game/World/Blockstate.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/Section.hpp"
+
+namespace Botcraft
+{
+    /// @brief Fill a box of values, converting each palette entry of each section once
+    /// @param find_chunk Called with chunk coordinates, returns the chunk or nullptr if not loaded
+    /// @param convert Called with each block used in the box sections
+    template<class T, class ChunkFinder, class Converter>
+    static void FillBox(const ChunkFinder& find_chunk, const Position& min_corner, const Position& size, T* output,
+        const T unloaded_value, const T air_value, const Converter& convert)
+    {
+        if (size.x <= 0 || size.y <= 0 || size.z <= 0)
+        {
+            return;
+        }
+
+        const int min_chunk_x = (int)floor(min_corner.x / (double)CHUNK_WIDTH);
+        const int max_chunk_x = (int)floor((min_corner.x + size.x - 1) / (double)CHUNK_WIDTH);
+        const int min_chunk_z = (int)floor(min_corner.z / (double)CHUNK_WIDTH);
+        const int max_chunk_z = (int)floor((min_corner.z + size.z - 1) / (double)CHUNK_WIDTH);
+
+        std::vector<T> palette_values;
+        for (int chunk_x = min_chunk_x; chunk_x <= max_chunk_x; ++chunk_x)
+        {
+            const int start_x = std::max(min_corner.x, chunk_x * CHUNK_WIDTH);
+            const int end_x = std::min(min_corner.x + size.x, (chunk_x + 1) * CHUNK_WIDTH);
+            const int row_size = end_x - start_x;
+            for (int chunk_z = min_chunk_z; chunk_z <= max_chunk_z; ++chunk_z)
+            {
+                const int start_z = std::max(min_corner.z, chunk_z * CHUNK_WIDTH);
+                const int end_z = std::min(min_corner.z + size.z, (chunk_z + 1) * CHUNK_WIDTH);
+
+                const Chunk* chunk = find_chunk(chunk_x, chunk_z);
+
+                const Section* previous_section = nullptr;
+                for (int y = min_corner.y; y < min_corner.y + size.y; ++y)
+                {
+                    // Value of the whole layer if it doesn't depend on the blocks
+                    const T* layer_value = nullptr;
+                    const Section* section = nullptr;
+                    if (chunk == nullptr)
+                    {
+                        layer_value = &unloaded_value;
+                    }
+                    else if (y < chunk->GetMinY() || y >= chunk->GetMinY() + chunk->GetHeight())
+                    {
+                        layer_value = &air_value;
+                    }
+                    else
+                    {
+                        // Missing sections are only air
+                        section = chunk->GetSection((y - chunk->GetMinY()) / SECTION_HEIGHT);
+                        if (section == nullptr)
+                        {
+                            layer_value = &air_value;
+                        }
+                        else if (section != previous_section)
+                        {
+                            const std::deque<Block>& palette = section->GetPalette();
+                            palette_values.resize(palette.size());
+                            for (size_t i = 0; i < palette.size(); ++i)
+                            {
+                                palette_values[i] = convert(palette[i]);
+                            }
+                            previous_section = section;
+                        }
+                        if (section != nullptr && section->IsSingleValue())
+                        {
+                            layer_value = &palette_values[section->GetPaletteIndex(0)];
+                        }
+                    }
+
+                    const int section_y = section == nullptr ? 0 : ((y - chunk->GetMinY()) % SECTION_HEIGHT);
+                    for (int z = start_z; z < end_z; ++z)
+                    {
+                        T* row = output + (static_cast<size_t>(y - min_corner.y) * size.z + (z - min_corner.z)) * size.x + (start_x - min_corner.x);
+                        if (layer_value != nullptr)
+                        {
+                            std::fill(row, row + row_size, *layer_value);
+                            continue;
+                        }
+                        const int block_index = (section_y * CHUNK_WIDTH + (z - chunk_z * CHUNK_WIDTH)) * CHUNK_WIDTH + (start_x - chunk_x * CHUNK_WIDTH);
+                        for (int x = 0; x < row_size; ++x)
+                        {
+                            row[x] = palette_values[section->GetPaletteIndex(block_index + x)];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const int WorldSnapshot::Regions::ChunkToRegion(const int c)
+    {
+        return c >= 0 ? c / REGION_WIDTH : (c - REGION_WIDTH + 1) / REGION_WIDTH;
+    }
+
+    WorldSnapshot::WorldSnapshot(const std::shared_ptr<const ChunksMap>& chunks_)
+    {
+        std::shared_ptr<Regions> new_regions = std::make_shared<Regions>();
+        if (chunks_)
+        {
+            std::unordered_map<std::pair<int, int>, std::shared_ptr<ChunksMap>, ChunkCoordinatesHasher> maps;
+            for (const auto& [coords, chunk] : *chunks_)
+            {
+                std::shared_ptr<ChunksMap>& region = maps[{ Regions::ChunkToRegion(coords.first), Regions::ChunkToRegion(coords.second) }];
+                if (region == nullptr)
+                {
+                    region = std::make_shared<ChunksMap>();
+                }
+                (*region)[coords] = chunk;
+            }
+            new_regions->maps.insert(maps.begin(), maps.end());
+        }
+        regions = new_regions;
+        cached_x = 0;
+        cached_z = 0;
+        cached = nullptr;
+    }
+
+    WorldSnapshot::WorldSnapshot(const std::shared_ptr<const Regions>& regions_)
+    {
+        regions = regions_ ? regions_ : std::make_shared<const Regions>();
+        cached_x = 0;
+        cached_z = 0;
+        cached = nullptr;
+    }
+
+    const bool WorldSnapshot::IsSame(const WorldSnapshot& other) const
+    {
+        return regions == other.regions;
+    }
+
+    const Chunk* WorldSnapshot::FindChunk(const int x, const int z) const
+    {
+        auto region_it = regions->maps.find({ Regions::ChunkToRegion(x), Regions::ChunkToRegion(z) });
+        if (region_it == regions->maps.end())
+        {
+            return nullptr;
+        }
+        auto it = region_it->second->find({ x, z });
+        return it == region_it->second->end() ? nullptr : it->second.get();
+    }
+
+    const Block* WorldSnapshot::GetBlock(const Position& pos) const
+    {
+        const int chunk_x = (int)floor(pos.x / (double)CHUNK_WIDTH);
+        const int chunk_z = (int)floor(pos.z / (double)CHUNK_WIDTH);
+
+        if (!cached || cached_x != chunk_x || cached_z != chunk_z)
+        {
+            const Chunk* chunk = FindChunk(chunk_x, chunk_z);
+
+            if (chunk == nullptr)
+            {
+                return nullptr;
+            }
+
+            cached_x = chunk_x;
+            cached_z = chunk_z;
+            cached = chunk;
+        }
+
+        return cached->GetBlock(Position((pos.x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, pos.y, (pos.z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH));
+    }
+
+    const bool WorldSnapshot::IsLoaded(const Position& pos) const
+    {
+        const int chunk_x = (int)floor(pos.x / (double)CHUNK_WIDTH);
+        const int chunk_z = (int)floor(pos.z / (double)CHUNK_WIDTH);
+
+        return FindChunk(chunk_x, chunk_z) != nullptr;
+    }
+
+    const int WorldSnapshot::GetHighestBlock(const int x, const int z, const HeightmapType type) const
+    {
+        const int chunk_x = (int)floor(x / (double)CHUNK_WIDTH);
+        const int chunk_z = (int)floor(z / (double)CHUNK_WIDTH);
+
+        if (!cached || cached_x != chunk_x || cached_z != chunk_z)
+        {
+            const Chunk* chunk = FindChunk(chunk_x, chunk_z);
+
+            if (chunk == nullptr)
+            {
+                return std::numeric_limits<int>::min();
+            }
+
+            cached_x = chunk_x;
+            cached_z = chunk_z;
+            cached = chunk;
+        }
+
+        return cached->GetHighestBlock((x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, (z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH, type);
+    }
+
+    const std::vector<int> WorldSnapshot::GetHighestBlocks(const int min_x, const int min_z, const int size_x, const int size_z, const HeightmapType type) const
+    {
+        std::vector<int> output(std::max(0, size_x) * std::max(0, size_z), std::numeric_limits<int>::min());
+
+        // Copy whole chunk rows instead of going through GetHighestBlock for each column
+        const int min_chunk_x = (int)floor(min_x / (double)CHUNK_WIDTH);
+        const int max_chunk_x = (int)floor((min_x + size_x - 1) / (double)CHUNK_WIDTH);
+        const int min_chunk_z = (int)floor(min_z / (double)CHUNK_WIDTH);
+        const int max_chunk_z = (int)floor((min_z + size_z - 1) / (double)CHUNK_WIDTH);
+        for (int chunk_x = min_chunk_x; chunk_x <= max_chunk_x; ++chunk_x)
+        {
+            for (int chunk_z = min_chunk_z; chunk_z <= max_chunk_z; ++chunk_z)
+            {
+                const Chunk* chunk = FindChunk(chunk_x, chunk_z);
+                if (chunk == nullptr)
+                {
+                    continue;
+                }
+                const int chunk_min_y = chunk->GetMinY();
+                const std::array<unsigned short, CHUNK_WIDTH * CHUNK_WIDTH>& heightmap = chunk->GetHeightmap(type);
+
+                const int start_x = std::max(min_x, chunk_x * CHUNK_WIDTH);
+                const int end_x = std::min(min_x + size_x, (chunk_x + 1) * CHUNK_WIDTH);
+                const int start_z = std::max(min_z, chunk_z * CHUNK_WIDTH);
+                const int end_z = std::min(min_z + size_z, (chunk_z + 1) * CHUNK_WIDTH);
+                for (int z = start_z; z < end_z; ++z)
+                {
+                    for (int x = start_x; x < end_x; ++x)
+                    {
+                        output[(z - min_z) * size_x + (x - min_x)] = chunk_min_y + heightmap[(z - chunk_z * CHUNK_WIDTH) * CHUNK_WIDTH + (x - chunk_x * CHUNK_WIDTH)] - 1;
+                    }
+                }
+            }
+        }
+
+        return output;
+    }
+
+    void WorldSnapshot::FillBlockstateIds(const Position& min_corner, const Position& size, unsigned short* output, const unsigned short unloaded_id) const
+    {
+        FillBox<unsigned short>([this](const int x, const int z) { return FindChunk(x, z); }, min_corner, size, output, unloaded_id, 0,
+            [](const Block& block)
+            {
+                const Blockstate* blockstate = block.GetBlockstate();
+#if PROTOCOL_VERSION < 347
+                return static_cast<unsigned short>(Blockstate::IdMetadataToId(blockstate->GetId(), blockstate->GetMetadata()));
+#else
+                return static_cast<unsigned short>(blockstate->GetId());
+#endif
+            });
+    }
+
+    void WorldSnapshot::FillBlockFlags(const Position& min_corner, const Position& size, unsigned char* output) const
+    {
+        FillBox<unsigned char>([this](const int x, const int z) { return FindChunk(x, z); }, min_corner, size, output, 0, FLAG_LOADED | FLAG_TRANSPARENT,
+            [](const Block& block)
+            {
+                const Blockstate* blockstate = block.GetBlockstate();
+                return static_cast<unsigned char>(FLAG_LOADED |
+                    (blockstate->IsAir() ? 0 : FLAG_NOT_AIR) |
+                    (blockstate->IsSolid() ? FLAG_SOLID : 0) |
+                    (blockstate->IsFluid() ? FLAG_FLUID : 0) |
+                    (blockstate->IsTransparent() ? FLAG_TRANSPARENT : 0));
+            });
+    }
+
+    const std::shared_ptr<const Chunk> WorldSnapshot::GetChunk(const int x, const int z) const
+    {
+        auto region_it = regions->maps.find({ Regions::ChunkToRegion(x), Regions::ChunkToRegion(z) });
+        if (region_it == regions->maps.end())
+        {
+            return nullptr;
+        }
+        auto it = region_it->second->find({ x, z });
+        if (it == region_it->second->end())
+        {
+            return nullptr;
+        }
+
+        return it->second;
+    }
+
+    const WorldSnapshot::ChunksMap& WorldSnapshot::GetAllChunks() const
+    {
+        // Regions are shared between threads, the merged map is built only once
+        std::call_once(regions->all_chunks_flag, [this]()
+            {
+                for (const auto& r : regions->maps)
+                {
+                    regions->all_chunks.insert(r.second->begin(), r.second->end());
+                }
+            });
+        return regions->all_chunks;
+    }
+
+    void WorldSnapshot::Write(ProtocolCraft::WriteContainer& container) const
+    {
+        const ChunksMap& chunks = GetAllChunks();
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(chunks.size()), container);
+        for (const auto& [coords, chunk] : chunks)
+        {
+            ProtocolCraft::WriteData<int>(coords.first, container);
+            ProtocolCraft::WriteData<int>(coords.second, container);
+            chunk->Write(container);
+        }
+    }
+
+    WorldSnapshot WorldSnapshot::Read(ProtocolCraft::ReadIterator& iter, size_t& length)
+    {
+        std::shared_ptr<ChunksMap> loaded_chunks = std::make_shared<ChunksMap>();
+        const int num_chunks = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+        for (int i = 0; i < num_chunks; ++i)
+        {
+            const int x = ProtocolCraft::ReadData<int>(iter, length);
+            const int z = ProtocolCraft::ReadData<int>(iter, length);
+            (*loaded_chunks)[{ x, z }] = Chunk::Read(iter, length);
+        }
+        return WorldSnapshot(loaded_chunks);
+    }
+} // Botcraft
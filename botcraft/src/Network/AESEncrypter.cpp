@@ -8,11 +8,144 @@
 
 #include <random>
 #include <chrono>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AES_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AES_KERNEL_TARGET
+#else
+#define AES_KERNEL_TARGET __attribute__((target("aes,sse2")))
+#endif
+#elif defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+#define AES_KERNEL_ARM 1
+#include <arm_neon.h>
+#define AES_KERNEL_TARGET
+#endif
+
+namespace
+{
+    // Number of AES blocks computed at the same time
+    constexpr size_t aes_kernel_width = 8;
+
+#if AES_KERNEL_X86 || AES_KERNEL_ARM
+    const unsigned char sbox[256] = {
+        0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+        0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+        0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+        0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+        0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+        0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+        0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+        0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+        0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+        0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+        0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+        0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+        0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+        0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+        0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+        0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+    };
+
+    /// @brief Standard AES-128 key schedule, round keys are stored
+    /// in the byte order expected by both AES-NI and ARMv8 instructions
+    void ExpandKey128(const unsigned char* key, unsigned char* round_keys)
+    {
+        const unsigned char rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+        std::memcpy(round_keys, key, 16);
+        for (int i = 4; i < 44; ++i)
+        {
+            unsigned char word[4];
+            std::memcpy(word, round_keys + 4 * (i - 1), 4);
+            if (i % 4 == 0)
+            {
+                const unsigned char first = word[0];
+                word[0] = sbox[word[1]] ^ rcon[i / 4 - 1];
+                word[1] = sbox[word[2]];
+                word[2] = sbox[word[3]];
+                word[3] = sbox[first];
+            }
+            for (int j = 0; j < 4; ++j)
+            {
+                round_keys[4 * i + j] = round_keys[4 * (i - 4) + j] ^ word[j];
+            }
+        }
+    }
+
+    bool HasAESInstructions()
+    {
+#if AES_KERNEL_ARM
+        return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] >> 25) & 1;
+#else
+        return __builtin_cpu_supports("aes");
+#endif
+    }
+
+    /// @brief Compute the first byte of the AES encryption of N 16 bytes
+    /// windows starting at input, input + 1, ..., input + N - 1
+    template<size_t N>
+    AES_KERNEL_TARGET void EncryptWindowsFirstByte(const unsigned char* round_keys, const unsigned char* input, unsigned char* output)
+    {
+#if AES_KERNEL_X86
+        __m128i blocks[N];
+        const __m128i first_key = _mm_load_si128(reinterpret_cast<const __m128i*>(round_keys));
+        for (size_t k = 0; k < N; ++k)
+        {
+            blocks[k] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + k)), first_key);
+        }
+        for (int r = 1; r < 10; ++r)
+        {
+            const __m128i key = _mm_load_si128(reinterpret_cast<const __m128i*>(round_keys + 16 * r));
+            for (size_t k = 0; k < N; ++k)
+            {
+                blocks[k] = _mm_aesenc_si128(blocks[k], key);
+            }
+        }
+        const __m128i last_key = _mm_load_si128(reinterpret_cast<const __m128i*>(round_keys + 160));
+        for (size_t k = 0; k < N; ++k)
+        {
+            output[k] = static_cast<unsigned char>(_mm_cvtsi128_si32(_mm_aesenclast_si128(blocks[k], last_key)));
+        }
+#else
+        uint8x16_t blocks[N];
+        for (size_t k = 0; k < N; ++k)
+        {
+            blocks[k] = vld1q_u8(input + k);
+        }
+        for (int r = 0; r < 9; ++r)
+        {
+            const uint8x16_t key = vld1q_u8(round_keys + 16 * r);
+            for (size_t k = 0; k < N; ++k)
+            {
+                blocks[k] = vaesmcq_u8(vaeseq_u8(blocks[k], key));
+            }
+        }
+        const uint8x16_t key_9 = vld1q_u8(round_keys + 144);
+        const uint8x16_t key_10 = vld1q_u8(round_keys + 160);
+        for (size_t k = 0; k < N; ++k)
+        {
+            output[k] = vgetq_lane_u8(veorq_u8(vaeseq_u8(blocks[k], key_9), key_10), 0);
+        }
+#endif
+    }
+#endif
+}
 
 namespace Botcraft
 {
     AESEncrypter::AESEncrypter()
     {
+        encryption_context = nullptr;
+        decryption_context = nullptr;
+        blocksize = 0;
+        hardware_decryption = false;
     }
 
     AESEncrypter::~AESEncrypter()
@@ -64,6 +197,16 @@ namespace Botcraft
         EVP_DecryptInit_ex(decryption_context, EVP_aes_128_cfb8(), nullptr, raw_shared_secret.data(), raw_shared_secret.data());
 
         blocksize = EVP_CIPHER_block_size(EVP_aes_128_cfb8());
+
+#if AES_KERNEL_X86 || AES_KERNEL_ARM
+        hardware_decryption = HasAESInstructions();
+        if (hardware_decryption)
+        {
+            ExpandKey128(raw_shared_secret.data(), round_keys);
+            // Minecraft uses the shared secret as IV
+            std::memcpy(decryption_register, raw_shared_secret.data(), 16);
+        }
+#endif
     }
 
     std::vector<unsigned char> AESEncrypter::Encrypt(const std::vector<unsigned char>& in)
@@ -92,6 +235,13 @@ namespace Botcraft
             return in;
         }
 
+        if (hardware_decryption)
+        {
+            std::vector<unsigned char> output = in;
+            DecryptInPlaceHardware(output.data(), output.size());
+            return output;
+        }
+
         std::vector<unsigned char> output;
         int size = 0;
 
@@ -101,5 +251,67 @@ namespace Botcraft
 
         return output;
     }
+
+    void AESEncrypter::EncryptInPlace(unsigned char* data, const size_t size)
+    {
+        if (encryption_context == nullptr)
+        {
+            LOG_WARNING("Warning, trying to encrypt packet while encryption is not initialized yet");
+            return;
+        }
+
+        int output_size = 0;
+        EVP_EncryptUpdate(encryption_context, data, &output_size, data, static_cast<int>(size));
+    }
+
+    void AESEncrypter::DecryptInPlace(unsigned char* data, const size_t size)
+    {
+        if (decryption_context == nullptr)
+        {
+            LOG_WARNING("Warning, trying to decrypt packet while decryption is not initialized yet");
+            return;
+        }
+
+        if (hardware_decryption)
+        {
+            DecryptInPlaceHardware(data, size);
+            return;
+        }
+
+        int output_size = 0;
+        EVP_DecryptUpdate(decryption_context, data, &output_size, data, static_cast<int>(size));
+    }
+
+    void AESEncrypter::DecryptInPlaceHardware(unsigned char* data, const size_t size)
+    {
+#if AES_KERNEL_X86 || AES_KERNEL_ARM
+        // The 16 ciphertext bytes preceding the current position followed
+        // by the next ciphertext bytes, as data is overwritten with plaintext
+        unsigned char window[16 + aes_kernel_width];
+        unsigned char keystream[aes_kernel_width];
+        std::memcpy(window, decryption_register, 16);
+
+        size_t i = 0;
+        for (; i + aes_kernel_width <= size; i += aes_kernel_width)
+        {
+            std::memcpy(window + 16, data + i, aes_kernel_width);
+            EncryptWindowsFirstByte<aes_kernel_width>(round_keys, window, keystream);
+            for (size_t k = 0; k < aes_kernel_width; ++k)
+            {
+                data[i + k] ^= keystream[k];
+            }
+            std::memmove(window, window + aes_kernel_width, 16);
+        }
+        for (; i < size; ++i)
+        {
+            window[16] = data[i];
+            EncryptWindowsFirstByte<1>(round_keys, window, keystream);
+            data[i] ^= keystream[0];
+            std::memmove(window, window + 1, 16);
+        }
+
+        std::memcpy(decryption_register, window, 16);
+#endif
+    }
 }
 #endif // USE_ENCRYPTION
@@ -5,13 +5,20 @@
 #include <openssl/sha.h>
 #endif
 
+#include <algorithm>
+#include <cctype>
 #include <iomanip>
 #include <fstream>
+#include <filesystem>
+#include <thread>
+#include <atomic>
 #include <sstream>
 #include <iostream>
 
 #include "botcraft/Network/Authentifier.hpp"
+#include "botcraft/Network/HTTPSConnectionPool.hpp"
 #include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/SleepUtilities.hpp"
 
 namespace Botcraft
 {
@@ -29,6 +36,12 @@ namespace Botcraft
         {"expires_date", nullptr}
     };
 
+    std::mutex Authentifier::cache_mutex;
+    nlohmann::json Authentifier::cached_profiles;
+    bool Authentifier::cached_profiles_loaded = false;
+    int Authentifier::cache_batch_depth = 0;
+    bool Authentifier::cache_dirty = false;
+
     Authentifier::Authentifier()
     {
 
@@ -298,24 +311,123 @@ namespace Botcraft
         return player_display_name;
     }
 
+    const std::vector<std::pair<std::string, double> > Authentifier::GetRequestTimings() const
+    {
+        std::lock_guard<std::mutex> lock(request_timings_mutex);
+        return request_timings;
+    }
+
+    size_t Authentifier::AuthMicrosoftBatch(const std::vector<std::string>& logins, const unsigned int max_parallel,
+        const std::chrono::milliseconds min_interval)
+    {
+#ifndef USE_ENCRYPTION
+        return 0;
+#else
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            // Load the cache file before starting the threads
+            GetCachedProfiles();
+            cache_batch_depth += 1;
+        }
+
+        std::atomic<size_t> next_login = 0;
+        std::atomic<size_t> num_success = 0;
+        std::mutex schedule_mutex;
+        std::chrono::steady_clock::time_point next_start = std::chrono::steady_clock::now();
+
+        auto worker = [&]()
+        {
+            while (true)
+            {
+                const size_t index = next_login++;
+                if (index >= logins.size())
+                {
+                    return;
+                }
+                const std::string& login = logins[index];
+
+                try
+                {
+                    Authentifier authentifier;
+
+                    // Only rate limit accounts that will send requests
+                    const nlohmann::json cached = authentifier.GetCachedCredentials(login);
+                    const bool cached_valid = cached.contains("mc_token") && cached["mc_token"].is_string() &&
+                        cached.contains("expires_date") && cached["expires_date"].is_number() &&
+                        !authentifier.IsTokenExpired(cached["expires_date"].get<long long int>());
+                    if (!cached_valid)
+                    {
+                        std::chrono::steady_clock::time_point start;
+                        {
+                            std::lock_guard<std::mutex> lock(schedule_mutex);
+                            start = std::max(next_start, std::chrono::steady_clock::now());
+                            next_start = start + min_interval;
+                        }
+                        SleepUntil(start);
+                    }
+
+                    if (authentifier.AuthMicrosoft(login))
+                    {
+                        num_success += 1;
+                    }
+                    else
+                    {
+                        LOG_WARNING("Authentication failed for Microsoft account with login <" << login << ">");
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_ERROR("Error trying to authenticate Microsoft account with login <" << login << ">: " << e.what());
+                }
+            }
+        };
+
+        const size_t num_threads = std::min(static_cast<size_t>(std::max(1u, max_parallel)), logins.size());
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            threads[i].join();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            cache_batch_depth -= 1;
+            if (cache_batch_depth == 0 && cache_dirty)
+            {
+                SaveCachedProfiles();
+            }
+        }
+
+        return num_success;
+#endif
+    }
+
 #ifdef USE_ENCRYPTION
-    nlohmann::json Authentifier::GetCachedProfiles() const
+    nlohmann::json& Authentifier::GetCachedProfiles()
     {
-        std::ifstream cache_file(cached_credentials_path);
-        if (!cache_file.good())
+        if (!cached_profiles_loaded)
         {
-            return {};
+            cached_profiles_loaded = true;
+            std::ifstream cache_file(cached_credentials_path);
+            if (cache_file.good())
+            {
+                cache_file >> cached_profiles;
+                cache_file.close();
+            }
         }
-        nlohmann::json cached_content;
-        cache_file >> cached_content;
-        cache_file.close();
 
-        return cached_content;
+        return cached_profiles;
     }
 
     nlohmann::json Authentifier::GetCachedCredentials(const std::string& login) const
     {
-        const nlohmann::json profiles = GetCachedProfiles();
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        const nlohmann::json& profiles = GetCachedProfiles();
 
         if (!profiles.empty() &&
             profiles.contains(login) &&
@@ -405,22 +517,48 @@ namespace Botcraft
         return t < std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
     }
 
-    void Authentifier::WriteCacheFile(const nlohmann::json& profiles) const
+    void Authentifier::WriteCacheFile(const nlohmann::json& profiles)
     {
-        std::ofstream cached_ofile(cached_credentials_path);
+        const std::string tmp_path = cached_credentials_path + ".tmp";
+        std::ofstream cached_ofile(tmp_path);
         if (!cached_ofile.is_open())
         {
             return;
         }
         cached_ofile << profiles.dump(4) << std::endl;
         cached_ofile.close();
+        if (cached_ofile.fail())
+        {
+            LOG_ERROR("Error trying to write cached credentials to " << tmp_path);
+            return;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, cached_credentials_path, ec);
+        if (ec)
+        {
+            LOG_ERROR("Error trying to replace " << cached_credentials_path << " by " << tmp_path << ": " << ec.message());
+        }
+    }
+
+    void Authentifier::SaveCachedProfiles()
+    {
+        if (cache_batch_depth > 0)
+        {
+            cache_dirty = true;
+            return;
+        }
+
+        WriteCacheFile(cached_profiles);
+        cache_dirty = false;
     }
 
     void Authentifier::UpdateCachedMSA(const std::string& login,
         const std::string& access_token, const std::string& refresh_token,
         const long long int& expiration) const
     {
-        nlohmann::json profiles = GetCachedProfiles();
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        nlohmann::json& profiles = GetCachedProfiles();
 
         if (!profiles.contains(login))
         {
@@ -454,13 +592,14 @@ namespace Botcraft
             profiles[login]["msa"]["expires_date"] = expiration;
         }
 
-        WriteCacheFile(profiles);
+        SaveCachedProfiles();
     }
 
     void Authentifier::UpdateCachedMCToken(const std::string& login,
         const std::string& mc_token, const long long int& expiration) const
     {
-        nlohmann::json profiles = GetCachedProfiles();
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        nlohmann::json& profiles = GetCachedProfiles();
 
         if (!profiles.contains(login))
         {
@@ -485,12 +624,13 @@ namespace Botcraft
             profiles[login]["expires_date"] = expiration;
         }
 
-        WriteCacheFile(profiles);
+        SaveCachedProfiles();
     }
 
     void Authentifier::UpdateCachedMCProfile(const std::string& login, const std::string& name, const std::string& id) const
     {
-        nlohmann::json profiles = GetCachedProfiles();
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        nlohmann::json& profiles = GetCachedProfiles();
 
         if (!profiles.contains(login))
         {
@@ -515,14 +655,15 @@ namespace Botcraft
             profiles[login]["id"] = id;
         }
 
-        WriteCacheFile(profiles);
+        SaveCachedProfiles();
     }
 
     void Authentifier::UpdateCachedMC(const std::string& login,
         const std::string& name, const std::string& id,
         const std::string& token)
     {
-        nlohmann::json profiles = GetCachedProfiles();
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        nlohmann::json& profiles = GetCachedProfiles();
 
         if (!profiles.contains(login))
         {
@@ -556,7 +697,7 @@ namespace Botcraft
             profiles[login]["mc_token"] = token;
         }
 
-        WriteCacheFile(profiles);
+        SaveCachedProfiles();
     }
 
     const std::string Authentifier::GetMSAToken(const std::string& login) const
@@ -931,38 +1072,41 @@ namespace Botcraft
 
     const WebRequestResponse Authentifier::WebRequest(const std::string& host, const std::string& raw_request) const
     {
-        asio::io_context io_context;
-
-        // Get a list of endpoints corresponding to the server name.
-        asio::ip::tcp::resolver resolver(io_context);
-        asio::ip::tcp::resolver::results_type endpoints = resolver.resolve(host, "https");
-
-        asio::ssl::context ctx(asio::ssl::context::sslv23);
-        ctx.set_default_verify_paths();
-        ctx.set_options(asio::ssl::context::default_workarounds | asio::ssl::context::verify_none);
-
-        asio::ssl::stream<asio::ip::tcp::socket> socket(io_context, ctx);
-        socket.set_verify_mode(asio::ssl::verify_none);
-        socket.set_verify_callback([](bool, asio::ssl::verify_context&) {return true; });
-        SSL_set_tlsext_host_name(socket.native_handle(), host.c_str());
-        asio::connect(socket.lowest_layer(), endpoints);
-        socket.handshake(socket.client);
-        socket.lowest_layer().set_option(asio::ip::tcp::no_delay(true));
+        HTTPSConnectionPool& pool = HTTPSConnectionPool::GetInstance();
 
         // Send the request
         asio::streambuf request;
         std::ostream request_stream(&request);
         request_stream << raw_request;
 
-        asio::write(socket, request);
-
-        WebRequestResponse web_response;
-
         // Read the response status line. The response streambuf will automatically
         // grow to accommodate the entire line. The growth may be limited by passing
         // a maximum size to the streambuf constructor.
         asio::streambuf response;
-        asio::read_until(socket, response, "\r\n");
+        std::unique_ptr<HTTPSConnection> connection;
+        while (true)
+        {
+            connection = pool.Acquire(host);
+            try
+            {
+                asio::write(connection->stream, request.data());
+                asio::read_until(connection->stream, response, "\r\n");
+                break;
+            }
+            catch (const asio::system_error&)
+            {
+                // A kept alive connection may have been closed by the server
+                // while idle. Nothing has been received, so it's safe to send
+                // the request again with another connection
+                if (!connection->reused)
+                {
+                    throw;
+                }
+                response.consume(response.size());
+            }
+        }
+
+        WebRequestResponse web_response;
 
         // Check that response is OK.
         std::istream response_stream(&response);
@@ -982,46 +1126,124 @@ namespace Botcraft
             return web_response;
         }
 
-        // Empty response
-        if (web_response.status_code == 204)
-        {
-            web_response.response = {};
-            return web_response;
-        }
-
         // Read the response headers, which are terminated by a blank line.
-        asio::read_until(socket, response, "\r\n\r\n");
+        asio::read_until(connection->stream, response, "\r\n\r\n");
 
         // Process the response headers.
         std::string header;
         long long int data_length = -1;
+        bool chunked = false;
+        bool keep_alive = http_version == "HTTP/1.1";
         while (std::getline(response_stream, header) && header != "\r")
         {
-            if (header.find("Content-Length: ") == 0)
+            std::string header_name = header.substr(0, header.find(':'));
+            std::transform(header_name.begin(), header_name.end(), header_name.begin(), [](const unsigned char c) { return std::tolower(c); });
+            std::string header_value = header.size() > header_name.size() + 1 ? header.substr(header_name.size() + 1) : "";
+            header_value.erase(std::remove_if(header_value.begin(), header_value.end(), [](const unsigned char c) { return std::isspace(c); }), header_value.end());
+            std::transform(header_value.begin(), header_value.end(), header_value.begin(), [](const unsigned char c) { return std::tolower(c); });
+
+            if (header_name == "content-length")
+            {
+                data_length = std::stoll(header_value);
+            }
+            else if (header_name == "transfer-encoding")
+            {
+                chunked = header_value.find("chunked") != std::string::npos;
+            }
+            else if (header_name == "connection")
             {
-                data_length = std::stoll(header.substr(16));
+                keep_alive = header_value.find("close") == std::string::npos;
             }
         }
 
-        // Write whatever content we already have to output.
-        std::stringstream output_stringstream;
-        if (response.size() > 0)
+        std::string raw_response;
+        asio::error_code error;
+        // No content
+        if (web_response.status_code == 204 || web_response.status_code == 304)
         {
-            output_stringstream << &response;
-        }
 
-        // Read until EOF, writing data to output as we go.
-        asio::error_code error;
-        while (asio::read(socket, response, asio::transfer_at_least(1), error))
+        }
+        else if (chunked)
         {
-            output_stringstream << &response;
+            while (true)
+            {
+                asio::read_until(connection->stream, response, "\r\n");
+                std::string chunk_header;
+                std::getline(response_stream, chunk_header);
+                const size_t chunk_size = std::stoull(chunk_header, nullptr, 16);
+                if (chunk_size == 0)
+                {
+                    break;
+                }
+                // Chunk data + \r\n
+                if (response.size() < chunk_size + 2)
+                {
+                    asio::read(connection->stream, response, asio::transfer_exactly(chunk_size + 2 - response.size()));
+                }
+                const char* data = asio::buffer_cast<const char*>(response.data());
+                raw_response.append(data, chunk_size);
+                response.consume(chunk_size + 2);
+            }
+            // Skip trailers until the blank line
+            while (true)
+            {
+                asio::read_until(connection->stream, response, "\r\n");
+                std::getline(response_stream, header);
+                if (header == "\r")
+                {
+                    break;
+                }
+            }
+        }
+        else if (data_length >= 0)
+        {
+            if (response.size() < static_cast<size_t>(data_length))
+            {
+                asio::read(connection->stream, response, asio::transfer_exactly(data_length - response.size()), error);
+            }
+            if (!error)
+            {
+                const char* data = asio::buffer_cast<const char*>(response.data());
+                raw_response = std::string(data, std::min(response.size(), static_cast<size_t>(data_length)));
+                response.consume(raw_response.size());
+            }
+        }
+        // No length information, the server will close the connection after the content
+        else
+        {
+            keep_alive = false;
+            std::stringstream output_stringstream;
+            if (response.size() > 0)
+            {
+                output_stringstream << &response;
+            }
+            while (asio::read(connection->stream, response, asio::transfer_at_least(1), error))
+            {
+                output_stringstream << &response;
+            }
+            if (error == asio::error::eof || error == asio::ssl::error::stream_truncated)
+            {
+                error = asio::error_code();
+            }
+            raw_response = output_stringstream.str();
         }
-        const std::string raw_response = output_stringstream.str();
 
-        if (error != asio::error::eof && raw_response.size() != data_length)
+        if (error)
         {
             LOG_ERROR("Error trying to read web request response, Error:\n " << error);
             web_response.response = {};
+            return web_response;
+        }
+
+        // Only reuse the connection if there is nothing left after this response
+        if (keep_alive && response.size() == 0)
+        {
+            pool.Release(std::move(connection));
+        }
+
+        if (raw_response.empty())
+        {
+            web_response.response = {};
         }
         else
         {
@@ -1034,9 +1256,8 @@ namespace Botcraft
     const WebRequestResponse Authentifier::POSTRequest(const std::string& host, const std::string& endpoint,
         const std::string& content_type, const std::string& accept, const std::string& data) const
     {
-        // Form the request. We specify the "Connection: close" header so that the
-        // server will close the socket after transmitting the response. This will
-        // allow us to treat all data up until the EOF as the content.
+        // Form the request. The connection is kept alive so it can
+        // be reused by the next request to the same host.
         std::string raw_request = "";
         raw_request += "POST " + endpoint + " HTTP/1.1 \r\n";
         raw_request += "Host: " + host + "\r\n";
@@ -1044,17 +1265,19 @@ namespace Botcraft
         raw_request += "Content-Type: " + content_type + " \r\n";
         raw_request += "Accept: " + accept + "\r\n";
         raw_request += "Content-Length: " + std::to_string(data.length()) + "\r\n";
-        raw_request += "Connection: close\r\n\r\n";
+        raw_request += "Connection: keep-alive\r\n\r\n";
         raw_request += data;
 
-        return WebRequest(host, raw_request);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const WebRequestResponse response = WebRequest(host, raw_request);
+        RecordRequestTiming("POST " + host + endpoint, start);
+        return response;
     }
 
     const WebRequestResponse Authentifier::GETRequest(const std::string& host, const std::string& endpoint, const std::string& authorization) const
     {
-        // Form the request. We specify the "Connection: close" header so that the
-        // server will close the socket after transmitting the response. This will
-        // allow us to treat all data up until the EOF as the content.
+        // Form the request. The connection is kept alive so it can
+        // be reused by the next request to the same host.
         std::string raw_request = "";
         raw_request += "GET " + endpoint + " HTTP/1.1 \r\n";
         raw_request += "Host: " + host + "\r\n";
@@ -1063,9 +1286,19 @@ namespace Botcraft
             raw_request += "Authorization: " + authorization + "\r\n";
         }
         raw_request += "User-Agent: C/1.0\r\n";
-        raw_request += "Connection: close\r\n\r\n";
+        raw_request += "Connection: keep-alive\r\n\r\n";
 
-        return WebRequest(host, raw_request);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const WebRequestResponse response = WebRequest(host, raw_request);
+        RecordRequestTiming("GET " + host + endpoint, start);
+        return response;
+    }
+
+    void Authentifier::RecordRequestTiming(const std::string& name, const std::chrono::steady_clock::time_point& start) const
+    {
+        const double duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(request_timings_mutex);
+        request_timings.push_back({ name, duration_ms });
     }
 #endif
 }
@@ -5,11 +5,61 @@
 #include <string>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
+
+#if USE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
 
 namespace Botcraft
 {
     const unsigned long MAX_COMPRESSED_PACKET_LEN = 200 * 1024;
 
+#if USE_LIBDEFLATE
+    /// @brief libdeflate only works on whole buffers, which is fine for Minecraft
+    /// packets as the uncompressed size is sent with them. zlib is still used for
+    /// DecompressPrefix and when the size is wrong
+    struct CompressionContext::FastBackend
+    {
+        FastBackend(const int compression_level)
+        {
+            decompressor = libdeflate_alloc_decompressor();
+            compressor = nullptr;
+            if (decompressor == nullptr)
+            {
+                throw(std::runtime_error("libdeflate_alloc_decompressor failed"));
+            }
+            SetCompressionLevel(compression_level);
+        }
+
+        ~FastBackend()
+        {
+            libdeflate_free_decompressor(decompressor);
+            libdeflate_free_compressor(compressor);
+        }
+
+        void SetCompressionLevel(const int compression_level)
+        {
+            // libdeflate levels go from 0 to 12, 6 is the same default as zlib
+            libdeflate_compressor* new_compressor = libdeflate_alloc_compressor(compression_level < 0 ? 6 : compression_level);
+            if (new_compressor == nullptr)
+            {
+                throw(std::runtime_error("Error changing compression level to " + std::to_string(compression_level)));
+            }
+            libdeflate_free_compressor(compressor);
+            compressor = new_compressor;
+        }
+
+        libdeflate_compressor* compressor;
+        libdeflate_decompressor* decompressor;
+    };
+#else
+    struct CompressionContext::FastBackend
+    {
+
+    };
+#endif
+
     std::vector<unsigned char> Compress(const std::vector<unsigned char> &raw, const int &start, const int &size)
     {
         unsigned long size_to_compress = size > 0 ? size : raw.size() - start;
@@ -80,5 +130,204 @@ namespace Botcraft
             }
         }
     }
+
+    CompressionContext::CompressionContext(const int compression_level_, const bool use_fast_backend_)
+    {
+        compression_level = compression_level_;
+#if USE_LIBDEFLATE
+        if (use_fast_backend_)
+        {
+            fast_backend = std::make_unique<FastBackend>(compression_level);
+        }
+#endif
+
+        deflate_stream = std::make_unique<z_stream>();
+        memset(deflate_stream.get(), 0, sizeof(z_stream));
+        int res = deflateInit(deflate_stream.get(), compression_level);
+        if (res != Z_OK)
+        {
+            throw(std::runtime_error("deflateInit failed: " + std::string(deflate_stream->msg ? deflate_stream->msg : "")));
+        }
+
+        inflate_stream = std::make_unique<z_stream>();
+        memset(inflate_stream.get(), 0, sizeof(z_stream));
+        res = inflateInit(inflate_stream.get());
+        if (res != Z_OK)
+        {
+            deflateEnd(deflate_stream.get());
+            throw(std::runtime_error("inflateInit failed: " + std::string(inflate_stream->msg ? inflate_stream->msg : "")));
+        }
+    }
+
+    CompressionContext::~CompressionContext()
+    {
+        deflateEnd(deflate_stream.get());
+        inflateEnd(inflate_stream.get());
+    }
+
+    const bool CompressionContext::HasFastBackend()
+    {
+#if USE_LIBDEFLATE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void CompressionContext::SetCompressionLevel(const int compression_level_)
+    {
+        if (compression_level_ == compression_level)
+        {
+            return;
+        }
+
+#if USE_LIBDEFLATE
+        if (fast_backend)
+        {
+            fast_backend->SetCompressionLevel(compression_level_);
+        }
+#endif
+
+        // The stream is always reset after use so there is nothing to flush
+        if (deflateParams(deflate_stream.get(), compression_level_, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw(std::runtime_error("Error changing compression level to " + std::to_string(compression_level_)));
+        }
+        compression_level = compression_level_;
+    }
+
+    const int CompressionContext::GetCompressionLevel() const
+    {
+        return compression_level;
+    }
+
+    void CompressionContext::Compress(const unsigned char* data, const size_t size, std::vector<unsigned char>& out, const bool limit_size)
+    {
+#if USE_LIBDEFLATE
+        if (fast_backend)
+        {
+            const size_t bound = libdeflate_zlib_compress_bound(fast_backend->compressor, size);
+            if (limit_size && bound > MAX_COMPRESSED_PACKET_LEN)
+            {
+                throw(std::runtime_error("Outgoing packet is too big to be compressed"));
+            }
+
+            const size_t start = out.size();
+            out.resize(start + bound);
+            const size_t compressed = libdeflate_zlib_compress(fast_backend->compressor, data, size, out.data() + start, bound);
+            if (compressed == 0)
+            {
+                out.resize(start);
+                throw(std::runtime_error("Error compressing packet"));
+            }
+            out.resize(start + compressed);
+            return;
+        }
+#endif
+        const unsigned long compressed_bound = deflateBound(deflate_stream.get(), size);
+
+        if (limit_size && compressed_bound > MAX_COMPRESSED_PACKET_LEN)
+        {
+            throw(std::runtime_error("Outgoing packet is too big to be compressed"));
+        }
+
+        const size_t start_size = out.size();
+        out.resize(start_size + compressed_bound);
+
+        deflate_stream->next_in = const_cast<unsigned char*>(data);
+        deflate_stream->avail_in = size;
+        deflate_stream->next_out = out.data() + start_size;
+        deflate_stream->avail_out = compressed_bound;
+
+        const int res = deflate(deflate_stream.get(), Z_FINISH);
+        const size_t compressed_size = deflate_stream->total_out;
+        deflateReset(deflate_stream.get());
+
+        if (res != Z_STREAM_END)
+        {
+            out.resize(start_size);
+            throw(std::runtime_error("Error compressing packet"));
+        }
+
+        out.resize(start_size + compressed_size);
+    }
+
+    void CompressionContext::Decompress(const unsigned char* data, const size_t size, std::vector<unsigned char>& out, const size_t expected_size)
+    {
+#if USE_LIBDEFLATE
+        if (fast_backend && expected_size > 0)
+        {
+            out.resize(expected_size);
+            size_t decompressed = 0;
+            const libdeflate_result res = libdeflate_zlib_decompress(fast_backend->decompressor, data, size, out.data(), expected_size, &decompressed);
+            if (res == LIBDEFLATE_SUCCESS)
+            {
+                out.resize(decompressed);
+                return;
+            }
+            else if (res == LIBDEFLATE_BAD_DATA)
+            {
+                throw(std::runtime_error("Inflate decompression failed: bad data"));
+            }
+            // Wrong expected size, let zlib grow the buffer as needed
+        }
+#endif
+        out.resize(expected_size > 0 ? expected_size : std::max(static_cast<size_t>(64 * 1024), 4 * size));
+
+        inflate_stream->next_in = const_cast<unsigned char*>(data);
+        inflate_stream->avail_in = size;
+        inflate_stream->next_out = out.data();
+        inflate_stream->avail_out = out.size();
+
+        for (;;)
+        {
+            const int res = inflate(inflate_stream.get(), Z_NO_FLUSH);
+            if (res == Z_STREAM_END)
+            {
+                break;
+            }
+            // Output buffer full (size not given or wrong), make some room and continue
+            else if ((res == Z_OK || res == Z_BUF_ERROR) && inflate_stream->avail_out == 0)
+            {
+                const size_t current_size = out.size();
+                out.resize(2 * current_size);
+                inflate_stream->next_out = out.data() + current_size;
+                inflate_stream->avail_out = out.size() - current_size;
+            }
+            // Input exhausted without the end of the stream
+            else if (res == Z_OK && inflate_stream->avail_in == 0)
+            {
+                break;
+            }
+            else
+            {
+                const std::string error_msg = inflate_stream->msg ? inflate_stream->msg : std::to_string(res);
+                inflateReset(inflate_stream.get());
+                throw(std::runtime_error("Inflate decompression failed: " + error_msg));
+            }
+        }
+
+        out.resize(inflate_stream->total_out);
+        inflateReset(inflate_stream.get());
+    }
+
+    const size_t CompressionContext::DecompressPrefix(const unsigned char* data, const size_t size, unsigned char* out, const size_t out_size)
+    {
+        inflate_stream->next_in = const_cast<unsigned char*>(data);
+        inflate_stream->avail_in = size;
+        inflate_stream->next_out = out;
+        inflate_stream->avail_out = out_size;
+
+        const int res = inflate(inflate_stream.get(), Z_SYNC_FLUSH);
+        const size_t decompressed_size = inflate_stream->total_out;
+        inflateReset(inflate_stream.get());
+
+        if (res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR)
+        {
+            throw(std::runtime_error("Inflate decompression failed"));
+        }
+
+        return decompressed_size;
+    }
 } //Botcraft
 #endif
\ No newline at end of file
@@ -0,0 +1,658 @@
+#include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <asio.hpp>
+
+#include "botcraft/Network/ControlServer.hpp"
+#include "botcraft/AI/BehaviourClient.hpp"
+#include "botcraft/Game/Entities/EntityManager.hpp"
+#include "botcraft/Game/Entities/LocalPlayer.hpp"
+#include "botcraft/Network/NetworkManager.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+    enum class ControlRequest
+    {
+        ListBots = 1,
+        SetBlackboard = 2,
+        SetTree = 3,
+        Query = 4,
+    };
+
+    enum class ControlValue
+    {
+        None = 0,
+        Bool = 1,
+        Int = 2,
+        Float = 3,
+        Double = 4,
+        String = 5,
+        Position = 6,
+    };
+
+    // Requests bigger than that are garbage
+    static constexpr size_t max_request_size = 16 * 1024 * 1024;
+    // Stop reading the requests of a connection while it has this number of unanswered ones
+    static constexpr size_t max_pending_requests = 64;
+
+    /// @brief A value read from a request, to be set in the blackboards
+    struct ControlEntry
+    {
+        std::string key;
+        ControlValue type = ControlValue::None;
+        bool b = false;
+        int i = 0;
+        float f = 0.0f;
+        double d = 0.0;
+        std::string s;
+        Position pos;
+    };
+
+    static ControlEntry ReadValue(ReadIterator& iter, size_t& length)
+    {
+        ControlEntry output;
+        output.type = static_cast<ControlValue>(static_cast<int>(ReadData<VarInt>(iter, length)));
+        switch (output.type)
+        {
+        case ControlValue::None:
+            break;
+        case ControlValue::Bool:
+            output.b = ReadData<bool>(iter, length);
+            break;
+        case ControlValue::Int:
+            output.i = ReadData<int>(iter, length);
+            break;
+        case ControlValue::Float:
+            output.f = ReadData<float>(iter, length);
+            break;
+        case ControlValue::Double:
+            output.d = ReadData<double>(iter, length);
+            break;
+        case ControlValue::String:
+            output.s = ReadData<std::string>(iter, length);
+            break;
+        case ControlValue::Position:
+            output.pos.x = ReadData<int>(iter, length);
+            output.pos.y = ReadData<int>(iter, length);
+            output.pos.z = ReadData<int>(iter, length);
+            break;
+        default:
+            throw(std::runtime_error("Unknown value type " + std::to_string(static_cast<int>(output.type))));
+        }
+        return output;
+    }
+
+    static void SetBlackboardValue(Blackboard& blackboard, const ControlEntry& entry)
+    {
+        switch (entry.type)
+        {
+        case ControlValue::None:
+            blackboard.Erase(entry.key);
+            break;
+        case ControlValue::Bool:
+            blackboard.Set<bool>(entry.key, entry.b);
+            break;
+        case ControlValue::Int:
+            blackboard.Set<int>(entry.key, entry.i);
+            break;
+        case ControlValue::Float:
+            blackboard.Set<float>(entry.key, entry.f);
+            break;
+        case ControlValue::Double:
+            blackboard.Set<double>(entry.key, entry.d);
+            break;
+        case ControlValue::String:
+            blackboard.Set<std::string>(entry.key, entry.s);
+            break;
+        case ControlValue::Position:
+            blackboard.Set<Position>(entry.key, entry.pos);
+            break;
+        }
+    }
+
+    /// @brief Serialize a blackboard value, or none if it's absent or of another type
+    static void WriteBlackboardValue(Blackboard& blackboard, const std::string& key, const ControlValue type, WriteContainer& container)
+    {
+        WriteContainer value;
+        try
+        {
+            WriteData<VarInt>(static_cast<int>(type), value);
+            switch (type)
+            {
+            case ControlValue::None:
+                break;
+            case ControlValue::Bool:
+                WriteData<bool>(blackboard.Get<bool>(key), value);
+                break;
+            case ControlValue::Int:
+                WriteData<int>(blackboard.Get<int>(key), value);
+                break;
+            case ControlValue::Float:
+                WriteData<float>(blackboard.Get<float>(key), value);
+                break;
+            case ControlValue::Double:
+                WriteData<double>(blackboard.Get<double>(key), value);
+                break;
+            case ControlValue::String:
+                WriteData<std::string>(blackboard.Get<std::string>(key), value);
+                break;
+            case ControlValue::Position:
+            {
+                const Position& pos = blackboard.Get<Position>(key);
+                WriteData<int>(pos.x, value);
+                WriteData<int>(pos.y, value);
+                WriteData<int>(pos.z, value);
+                break;
+            }
+            default:
+                value.clear();
+                WriteData<VarInt>(static_cast<int>(ControlValue::None), value);
+                break;
+            }
+        }
+        catch (const std::bad_any_cast&)
+        {
+            value.clear();
+            WriteData<VarInt>(static_cast<int>(ControlValue::None), value);
+        }
+        container.insert(container.end(), value.begin(), value.end());
+    }
+
+    static const std::string GetBotName(const BehaviourClient& bot)
+    {
+        const std::shared_ptr<NetworkManager> network_manager = bot.GetNetworkManager();
+        return network_manager == nullptr ? "" : network_manager->GetMyName();
+    }
+
+    struct ControlServer::Impl
+    {
+        struct Session
+        {
+            Session(asio::io_service& io_service) : socket(io_service)
+            {
+
+            }
+
+            asio::ip::tcp::socket socket;
+            std::array<unsigned char, 4> size_buffer;
+            std::vector<unsigned char> request;
+            std::deque<std::shared_ptr<const WriteContainer> > write_queue;
+            /// @brief Number of requests read but not answered yet
+            size_t num_pending = 0;
+            /// @brief True if reading stopped because of max_pending_requests
+            bool read_paused = false;
+            bool closed = false;
+        };
+
+        /// @brief Called on the io thread with the answer body of a request
+        using AnswerCallback = std::function<void(const WriteContainer& body)>;
+
+        /// @brief A Query waiting for the behaviour threads to read the blackboards
+        struct QueryResults
+        {
+            std::vector<std::shared_ptr<BehaviourClient> > bots;
+            std::shared_ptr<std::vector<std::pair<std::string, ControlValue> > > keys;
+            AnswerCallback answer;
+            /// @brief Fires at the query timeout, io thread only
+            std::unique_ptr<asio::steady_timer> timer;
+            /// @brief True once the answer has been sent, io thread only
+            bool answered = false;
+
+            // Shared with the behaviour threads
+            std::mutex mutex;
+            size_t num_done = 0;
+            /// @brief Serialized values per bot, empty if not read yet
+            std::vector<WriteContainer> values;
+            /// @brief Set when the answer is sent or the server stopped, later reads are ignored
+            bool timed_out = false;
+        };
+
+        Impl(const unsigned short port, const BotsGetter& get_bots_, const TreeSetter& set_tree_, const std::string& address, const std::chrono::milliseconds& query_timeout_)
+            : acceptor(io_service, asio::ip::tcp::endpoint(asio::ip::make_address(address), port)), get_bots(get_bots_), set_tree(set_tree_), query_timeout(query_timeout_)
+        {
+            Accept();
+            thread = std::thread([this]()
+                {
+                    Logger::GetInstance().RegisterThread("ControlServer");
+                    io_service.run();
+                });
+        }
+
+        ~Impl()
+        {
+            io_service.stop();
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+            // Make sure the behaviour threads don't post the results to the stopped io_service
+            for (const std::shared_ptr<QueryResults>& results : pending_queries)
+            {
+                std::lock_guard<std::mutex> lock(results->mutex);
+                results->timed_out = true;
+                // The results can be kept alive by the behaviours, after the io_service
+                results->timer.reset();
+            }
+        }
+
+        void Accept()
+        {
+            std::shared_ptr<Session> session = std::make_shared<Session>(io_service);
+            acceptor.async_accept(session->socket, [this, session](const asio::error_code& error)
+                {
+                    if (!error)
+                    {
+                        asio::error_code ignored;
+                        session->socket.set_option(asio::ip::tcp::no_delay(true), ignored);
+                        Read(session);
+                    }
+                    if (error != asio::error::operation_aborted)
+                    {
+                        Accept();
+                    }
+                });
+        }
+
+        void Read(const std::shared_ptr<Session>& session)
+        {
+            asio::async_read(session->socket, asio::buffer(session->size_buffer), [this, session](const asio::error_code& error, std::size_t)
+                {
+                    if (error)
+                    {
+                        return;
+                    }
+                    ReadIterator iter = session->size_buffer.data();
+                    size_t length = session->size_buffer.size();
+                    const int size = ReadData<int>(iter, length);
+                    if (size <= 0 || static_cast<size_t>(size) > max_request_size)
+                    {
+                        LOG_WARNING("Wrong control request size (" << size << "), closing connection");
+                        return;
+                    }
+                    session->request.resize(size);
+                    asio::async_read(session->socket, asio::buffer(session->request), [this, session](const asio::error_code& error, std::size_t)
+                        {
+                            if (error)
+                            {
+                                return;
+                            }
+                            session->num_pending += 1;
+                            Handle(session, session->request);
+                            // Don't wait for the answer to read the next request
+                            if (session->num_pending < max_pending_requests)
+                            {
+                                Read(session);
+                            }
+                            else
+                            {
+                                session->read_paused = true;
+                            }
+                        });
+                });
+        }
+
+        /// @brief Queue a framed answer on a session
+        void Send(const std::shared_ptr<Session>& session, const std::shared_ptr<const WriteContainer>& answer)
+        {
+            session->num_pending -= 1;
+            if (session->closed)
+            {
+                return;
+            }
+            session->write_queue.push_back(answer);
+            if (session->write_queue.size() == 1)
+            {
+                Write(session);
+            }
+            if (session->read_paused)
+            {
+                session->read_paused = false;
+                Read(session);
+            }
+        }
+
+        void Write(const std::shared_ptr<Session>& session)
+        {
+            asio::async_write(session->socket, asio::buffer(*session->write_queue.front()), [this, session](const asio::error_code& error, std::size_t)
+                {
+                    if (error)
+                    {
+                        session->closed = true;
+                        session->write_queue.clear();
+                        asio::error_code ignored;
+                        session->socket.close(ignored);
+                        return;
+                    }
+                    session->write_queue.pop_front();
+                    if (!session->write_queue.empty())
+                    {
+                        Write(session);
+                    }
+                });
+        }
+
+        /// @brief Process a request. The request is fully read before returning,
+        /// but the answer can be sent later, by the io thread
+        void Handle(const std::shared_ptr<Session>& session, const std::vector<unsigned char>& request)
+        {
+            ReadIterator iter = request.data();
+            size_t length = request.size();
+
+            int type = 0;
+            int request_id = 0;
+            bool answered = false;
+            AnswerCallback answer = [this, session, &type, &request_id, &answered](const WriteContainer& body)
+                {
+                    answered = true;
+                    Send(session, FrameAnswer(type, request_id, body));
+                };
+            try
+            {
+                type = ReadData<VarInt>(iter, length);
+                request_id = ReadData<VarInt>(iter, length);
+                WriteContainer body;
+                WriteData<bool>(true, body);
+                switch (static_cast<ControlRequest>(type))
+                {
+                case ControlRequest::ListBots:
+                    ListBots(body);
+                    break;
+                case ControlRequest::SetBlackboard:
+                    SetBlackboard(iter, length, body);
+                    break;
+                case ControlRequest::SetTree:
+                    SetTree(iter, length, body);
+                    break;
+                case ControlRequest::Query:
+                {
+                    // Answered later, type and request_id must be copied
+                    Query(iter, length, [this, session, type, request_id](const WriteContainer& body)
+                        {
+                            Send(session, FrameAnswer(type, request_id, body));
+                        });
+                    return;
+                }
+                default:
+                    throw(std::runtime_error("Unknown request type " + std::to_string(type)));
+                }
+                answer(body);
+            }
+            catch (const std::exception& e)
+            {
+                if (answered)
+                {
+                    return;
+                }
+                WriteContainer body;
+                WriteData<bool>(false, body);
+                WriteData<std::string>(e.what(), body);
+                answer(body);
+            }
+        }
+
+        static std::shared_ptr<const WriteContainer> FrameAnswer(const int type, const int request_id, const WriteContainer& body)
+        {
+            WriteContainer payload;
+            WriteData<VarInt>(type, payload);
+            WriteData<VarInt>(request_id, payload);
+            payload.insert(payload.end(), body.begin(), body.end());
+
+            std::shared_ptr<WriteContainer> answer = std::make_shared<WriteContainer>();
+            answer->reserve(payload.size() + 4);
+            WriteData<int>(static_cast<int>(payload.size()), *answer);
+            answer->insert(answer->end(), payload.begin(), payload.end());
+            return answer;
+        }
+
+        /// @brief Read a bot selection and get the matching bots, in the selection order
+        std::vector<std::shared_ptr<BehaviourClient> > ReadBots(ReadIterator& iter, size_t& length) const
+        {
+            const int num_names = ReadData<VarInt>(iter, length);
+            // Each name is at least one byte
+            if (num_names < 0 || static_cast<size_t>(num_names) > length)
+            {
+                throw(std::runtime_error("Wrong number of bots"));
+            }
+            std::vector<std::string> names(num_names);
+            for (int i = 0; i < num_names; ++i)
+            {
+                names[i] = ReadData<std::string>(iter, length);
+            }
+
+            std::vector<std::shared_ptr<BehaviourClient> > bots = get_bots();
+            if (names.empty())
+            {
+                return bots;
+            }
+
+            std::map<std::string, std::shared_ptr<BehaviourClient> > bots_by_name;
+            for (const std::shared_ptr<BehaviourClient>& bot : bots)
+            {
+                bots_by_name[GetBotName(*bot)] = bot;
+            }
+            std::vector<std::shared_ptr<BehaviourClient> > output;
+            output.reserve(names.size());
+            for (const std::string& name : names)
+            {
+                auto it = bots_by_name.find(name);
+                if (it == bots_by_name.end())
+                {
+                    throw(std::runtime_error("Unknown bot " + name));
+                }
+                output.push_back(it->second);
+            }
+            return output;
+        }
+
+        void ListBots(WriteContainer& body) const
+        {
+            const std::vector<std::shared_ptr<BehaviourClient> > bots = get_bots();
+            WriteData<VarInt>(static_cast<int>(bots.size()), body);
+            for (const std::shared_ptr<BehaviourClient>& bot : bots)
+            {
+                WriteData<std::string>(GetBotName(*bot), body);
+                WriteData<bool>(!bot->GetShouldBeClosed(), body);
+            }
+        }
+
+        void SetBlackboard(ReadIterator& iter, size_t& length, WriteContainer& body) const
+        {
+            const std::vector<std::shared_ptr<BehaviourClient> > bots = ReadBots(iter, length);
+            const int num_entries = ReadData<VarInt>(iter, length);
+            // Each entry is at least a one byte key and a one byte value
+            if (num_entries < 0 || static_cast<size_t>(num_entries) > length / 2)
+            {
+                throw(std::runtime_error("Wrong number of blackboard entries"));
+            }
+            std::shared_ptr<std::vector<ControlEntry> > entries = std::make_shared<std::vector<ControlEntry> >(num_entries);
+            for (int i = 0; i < num_entries; ++i)
+            {
+                const std::string key = ReadData<std::string>(iter, length);
+                (*entries)[i] = ReadValue(iter, length);
+                (*entries)[i].key = key;
+            }
+
+            for (const std::shared_ptr<BehaviourClient>& bot : bots)
+            {
+                // The blackboard is not thread-safe, timers are fired by the behaviour thread.
+                // The timer lives in the bot, so it can't outlive it
+                BehaviourClient* client = bot.get();
+                client->GetTimers().ScheduleIn(0, [client, entries]()
+                    {
+                        for (const ControlEntry& e : *entries)
+                        {
+                            SetBlackboardValue(client->GetBlackboard(), e);
+                        }
+                    });
+            }
+            WriteData<VarInt>(static_cast<int>(bots.size()), body);
+        }
+
+        void SetTree(ReadIterator& iter, size_t& length, WriteContainer& body) const
+        {
+            const std::vector<std::shared_ptr<BehaviourClient> > bots = ReadBots(iter, length);
+            const std::string tree_name = ReadData<std::string>(iter, length);
+            if (set_tree == nullptr)
+            {
+                throw(std::runtime_error("Trees can't be changed on this server"));
+            }
+            for (const std::shared_ptr<BehaviourClient>& bot : bots)
+            {
+                if (!set_tree(*bot, tree_name))
+                {
+                    throw(std::runtime_error("Unknown tree " + tree_name));
+                }
+            }
+            WriteData<VarInt>(static_cast<int>(bots.size()), body);
+        }
+
+        /// @brief Read a Query and ask the behaviour threads to read the blackboards.
+        /// The answer is given on the io thread, once all the bots are done or at the timeout
+        void Query(ReadIterator& iter, size_t& length, const AnswerCallback& answer)
+        {
+            std::shared_ptr<QueryResults> results = std::make_shared<QueryResults>();
+            results->bots = ReadBots(iter, length);
+            const int num_keys = ReadData<VarInt>(iter, length);
+            // Each key is at least a one byte name and a one byte tag
+            if (num_keys < 0 || static_cast<size_t>(num_keys) > length / 2)
+            {
+                throw(std::runtime_error("Wrong number of blackboard keys"));
+            }
+            results->keys = std::make_shared<std::vector<std::pair<std::string, ControlValue> > >(num_keys);
+            for (int i = 0; i < num_keys; ++i)
+            {
+                (*results->keys)[i].first = ReadData<std::string>(iter, length);
+                (*results->keys)[i].second = static_cast<ControlValue>(static_cast<int>(ReadData<VarInt>(iter, length)));
+            }
+            results->answer = answer;
+            results->values.resize(results->bots.size());
+
+            if (results->keys->empty() || results->bots.empty())
+            {
+                AnswerQuery(results);
+                return;
+            }
+
+            pending_queries.insert(results);
+            for (size_t i = 0; i < results->bots.size(); ++i)
+            {
+                BehaviourClient* client = results->bots[i].get();
+                asio::io_service* io = &io_service;
+                // Only results is shared, the io_service is not used once timed_out is set by ~Impl
+                client->GetTimers().ScheduleIn(0, [this, client, results, i, io]()
+                    {
+                        WriteContainer values;
+                        for (const auto& k : *results->keys)
+                        {
+                            WriteBlackboardValue(client->GetBlackboard(), k.first, k.second, values);
+                        }
+                        std::lock_guard<std::mutex> lock(results->mutex);
+                        if (results->timed_out)
+                        {
+                            return;
+                        }
+                        results->values[i] = std::move(values);
+                        results->num_done += 1;
+                        if (results->num_done == results->bots.size())
+                        {
+                            asio::post(*io, [this, results]() { AnswerQuery(results); });
+                        }
+                    });
+            }
+
+            results->timer = std::make_unique<asio::steady_timer>(io_service);
+            results->timer->expires_after(query_timeout);
+            results->timer->async_wait([this, results](const asio::error_code& error)
+                {
+                    if (!error)
+                    {
+                        AnswerQuery(results);
+                    }
+                });
+        }
+
+        /// @brief Send the answer of a Query with the values read so far. Io thread only
+        void AnswerQuery(const std::shared_ptr<QueryResults>& results)
+        {
+            if (results->answered)
+            {
+                return;
+            }
+            results->answered = true;
+            if (results->timer)
+            {
+                results->timer->cancel();
+            }
+            pending_queries.erase(results);
+            {
+                // Late reads are ignored
+                std::lock_guard<std::mutex> lock(results->mutex);
+                results->timed_out = true;
+            }
+
+            const std::vector<std::shared_ptr<BehaviourClient> >& bots = results->bots;
+            WriteContainer body;
+            WriteData<bool>(true, body);
+            WriteData<VarInt>(static_cast<int>(bots.size()), body);
+            for (size_t i = 0; i < bots.size(); ++i)
+            {
+                const std::shared_ptr<BehaviourClient>& bot = bots[i];
+                WriteData<std::string>(GetBotName(*bot), body);
+                WriteData<bool>(!bot->GetShouldBeClosed(), body);
+
+                LocalPlayerState state;
+                const std::shared_ptr<EntityManager> entity_manager = bot->GetEntityManager();
+                const std::shared_ptr<LocalPlayer> local_player = entity_manager == nullptr ? nullptr : entity_manager->GetLocalPlayer();
+                if (local_player != nullptr)
+                {
+                    state = local_player->GetState();
+                }
+                WriteData<double>(state.position.x, body);
+                WriteData<double>(state.position.y, body);
+                WriteData<double>(state.position.z, body);
+                WriteData<float>(state.health, body);
+                WriteData<VarInt>(state.food, body);
+
+                // No lock needed, timed_out is set so nobody writes anymore
+                const bool read = results->keys->empty() || !results->values[i].empty();
+                WriteData<bool>(read, body);
+                if (read)
+                {
+                    body.insert(body.end(), results->values[i].begin(), results->values[i].end());
+                }
+            }
+            results->answer(body);
+        }
+
+        asio::io_service io_service;
+        asio::ip::tcp::acceptor acceptor;
+        std::thread thread;
+
+        BotsGetter get_bots;
+        TreeSetter set_tree;
+        std::chrono::milliseconds query_timeout;
+
+        /// @brief Queries waiting for the behaviour threads, io thread only
+        std::set<std::shared_ptr<QueryResults> > pending_queries;
+    };
+
+    ControlServer::ControlServer(const unsigned short port, const BotsGetter& get_bots_, const TreeSetter& set_tree_, const std::string& address, const std::chrono::milliseconds& query_timeout_)
+    {
+        impl = std::make_unique<Impl>(port, get_bots_, set_tree_, address, query_timeout_);
+        LOG_INFO("Control server listening on " << address << ":" << port);
+    }
+
+    ControlServer::~ControlServer()
+    {
+
+    }
+} // Botcraft
@@ -0,0 +1,269 @@
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+#include "botcraft/Network/DNSCache.hpp"
+#include "botcraft/Network/DNS/DNSMessage.hpp"
+#include "botcraft/Network/DNS/DNSSrvData.hpp"
+
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/StringUtilities.hpp"
+
+namespace Botcraft
+{
+    DNSCache::DNSCache()
+    {
+
+    }
+
+    DNSCache::~DNSCache()
+    {
+
+    }
+
+    DNSCache& DNSCache::GetInstance()
+    {
+        static DNSCache instance;
+
+        return instance;
+    }
+
+    bool DNSCache::LookupSRV(const std::string& address, std::string& target, unsigned short& port)
+    {
+        {
+            std::unique_lock<std::mutex> lock(cache_mutex);
+            // Someone else is already asking, wait for the answer
+            cache_condition.wait(lock, [this, &address] { return !srv_entries[address].pending; });
+            SRVEntry& entry = srv_entries[address];
+
+            if (entry.expiration > std::chrono::steady_clock::now())
+            {
+                if (entry.found)
+                {
+                    target = entry.target;
+                    port = entry.port;
+                }
+                return entry.found;
+            }
+            entry.pending = true;
+        }
+
+        std::string found_target;
+        unsigned short found_port = 0;
+        unsigned int ttl = 0;
+        bool found = false;
+        try
+        {
+            found = QuerySRV(address, found_target, found_port, ttl);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARNING("Error during SRV DNS lookup: " << e.what());
+            found = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            SRVEntry& entry = srv_entries[address];
+            entry.pending = false;
+            entry.found = found;
+            entry.target = found_target;
+            entry.port = found_port;
+            entry.expiration = std::chrono::steady_clock::now() + (found ? std::chrono::seconds(ttl) : srv_negative_ttl);
+        }
+        cache_condition.notify_all();
+
+        if (found)
+        {
+            target = found_target;
+            port = found_port;
+        }
+        return found;
+    }
+
+    asio::ip::tcp::resolver::results_type DNSCache::Resolve(const std::string& host, const unsigned short port)
+    {
+        const std::string key = host + ":" + std::to_string(port);
+        {
+            std::unique_lock<std::mutex> lock(cache_mutex);
+            cache_condition.wait(lock, [this, &key] { return !resolve_entries[key].pending; });
+            ResolveEntry& entry = resolve_entries[key];
+
+            if (entry.expiration > std::chrono::steady_clock::now())
+            {
+                return entry.endpoints;
+            }
+            entry.pending = true;
+        }
+
+        asio::io_service local_io_service;
+        asio::ip::tcp::resolver resolver(local_io_service);
+        asio::error_code error;
+        const asio::ip::tcp::resolver::results_type endpoints = resolver.resolve(host, std::to_string(port), error);
+        OnResolved(key, error, endpoints);
+
+        if (error)
+        {
+            throw asio::system_error(error);
+        }
+        return endpoints;
+    }
+
+    void DNSCache::AsyncResolve(asio::io_service& io_service, const std::string& host, const unsigned short port, const ResolveHandler& handler)
+    {
+        const std::string key = host + ":" + std::to_string(port);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            ResolveEntry& entry = resolve_entries[key];
+            if (entry.pending)
+            {
+                entry.waiting_handlers.push_back({ &io_service, handler });
+                return;
+            }
+
+            if (entry.expiration > std::chrono::steady_clock::now())
+            {
+                const asio::ip::tcp::resolver::results_type endpoints = entry.endpoints;
+                asio::post(io_service, [handler, endpoints]()
+                    {
+                        handler(asio::error_code(), endpoints);
+                    });
+                return;
+            }
+            entry.pending = true;
+            entry.waiting_handlers.push_back({ &io_service, handler });
+        }
+
+        std::shared_ptr<asio::ip::tcp::resolver> resolver = std::make_shared<asio::ip::tcp::resolver>(io_service);
+        resolver->async_resolve(host, std::to_string(port),
+            [this, key, resolver](const asio::error_code& error, const asio::ip::tcp::resolver::results_type& endpoints)
+            {
+                OnResolved(key, error, endpoints);
+            });
+    }
+
+    void DNSCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        // Keep the entries with a query in progress, someone is waiting for them
+        for (auto it = srv_entries.begin(); it != srv_entries.end();)
+        {
+            it = it->second.pending ? std::next(it) : srv_entries.erase(it);
+        }
+        for (auto it = resolve_entries.begin(); it != resolve_entries.end();)
+        {
+            it = it->second.pending ? std::next(it) : resolve_entries.erase(it);
+        }
+    }
+
+    void DNSCache::OnResolved(const std::string& key, const asio::error_code& error, const asio::ip::tcp::resolver::results_type& endpoints)
+    {
+        std::vector<std::pair<asio::io_service*, ResolveHandler> > handlers;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            ResolveEntry& entry = resolve_entries[key];
+            entry.pending = false;
+            // Failures are not cached, next lookup will try again
+            if (!error)
+            {
+                entry.endpoints = endpoints;
+                entry.expiration = std::chrono::steady_clock::now() + resolve_ttl;
+            }
+            handlers.swap(entry.waiting_handlers);
+        }
+        cache_condition.notify_all();
+
+        for (const auto& p : handlers)
+        {
+            const ResolveHandler handler = p.second;
+            asio::post(*p.first, [handler, error, endpoints]()
+                {
+                    handler(error, endpoints);
+                });
+        }
+    }
+
+    bool DNSCache::QuerySRV(const std::string& address, std::string& target, unsigned short& port, unsigned int& ttl)
+    {
+        LOG_INFO("Performing SRV DNS lookup on " << "_minecraft._tcp." << address << " to find an endpoint");
+        asio::io_service local_io_service;
+        asio::ip::udp::socket udp_socket(local_io_service);
+
+        // Create the query
+        DNSMessage query;
+        // Random identification
+        query.SetIdentification({ 0x42, 0x42 });
+        query.SetFlagQR(0);
+        query.SetFlagOPCode(0);
+        query.SetFlagAA(0);
+        query.SetFlagTC(0);
+        query.SetFlagRD(1);
+        query.SetFlagRA(0);
+        query.SetFlagZ(0);
+        query.SetFlagRCode(0);
+        query.SetNumberQuestion(1);
+        query.SetNumberAnswer(0);
+        query.SetNumberAuthority(0);
+        query.SetNumberAdditionalRR(0);
+        DNSQuestion question;
+        // SRV type
+        question.SetTypeCode(33);
+        question.SetClassCode(1);
+        question.SetNameLabels(SplitString("_minecraft._tcp." + address, '.'));
+        query.SetQuestions({ question });
+
+        // Write the request and send it to google DNS
+        std::vector<unsigned char> encoded_query;
+        query.Write(encoded_query);
+        udp_socket.open(asio::ip::udp::v4());
+        asio::ip::udp::endpoint endpoint(asio::ip::address::from_string("8.8.8.8"), 53);
+        udp_socket.send_to(asio::buffer(encoded_query), endpoint);
+
+        // Wait for the answer, but not forever
+        std::vector<unsigned char> answer_buffer(512);
+        asio::ip::udp::endpoint sender_endpoint;
+        size_t len = 0;
+        bool received = false;
+        udp_socket.async_receive_from(asio::buffer(answer_buffer), sender_endpoint,
+            [&](const asio::error_code& error, std::size_t bytes_transferred)
+            {
+                received = !error;
+                len = bytes_transferred;
+            });
+        local_io_service.run_for(srv_timeout);
+
+        if (!received)
+        {
+            LOG_WARNING("SRV DNS lookup timed out");
+            return false;
+        }
+
+        ProtocolCraft::ReadIterator iter = answer_buffer.data();
+        size_t remaining = len;
+
+        // Read answer
+        DNSMessage answer;
+        answer.Read(iter, remaining);
+
+        // If there is an answer and it's a SRV one (as it should be)
+        if (answer.GetNumberAnswer() > 0
+            && answer.GetAnswers()[0].GetTypeCode() == 0x21)
+        {
+            DNSSrvData data;
+            ProtocolCraft::ReadIterator iter2 = answer.GetAnswers()[0].GetRData().data();
+            size_t len2 = answer.GetAnswers()[0].GetRDLength();
+            data.Read(iter2, len2);
+            target = "";
+            for (int i = 0; i < data.GetNameLabels().size(); ++i)
+            {
+                target += data.GetNameLabels()[i] + (i == data.GetNameLabels().size() - 1 ? "" : ".");
+            }
+            port = data.GetPort();
+            ttl = answer.GetAnswers()[0].GetTTL();
+
+            LOG_INFO("SRV DNS lookup successful!");
+            return true;
+        }
+        LOG_WARNING("SRV DNS lookup failed to find an address");
+
+        return false;
+    }
+} // Botcraft
@@ -0,0 +1,151 @@
+#ifdef USE_COMPRESSION
+#include <algorithm>
+#include <exception>
+
+#include "botcraft/Network/DecompressionPool.hpp"
+#include "botcraft/Network/Compression.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
+
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+namespace Botcraft
+{
+    void DecompressionJob::Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return done; });
+    }
+
+    DecompressionPool::DecompressionPool()
+    {
+        running = false;
+    }
+
+    DecompressionPool::~DecompressionPool()
+    {
+        Stop();
+    }
+
+    DecompressionPool& DecompressionPool::GetInstance()
+    {
+        static DecompressionPool instance;
+
+        return instance;
+    }
+
+    void DecompressionPool::Start(const unsigned int num_threads)
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (running)
+        {
+            return;
+        }
+
+        unsigned int pool_size = num_threads;
+        if (pool_size == 0)
+        {
+            pool_size = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        running = true;
+        threads.reserve(pool_size);
+        for (unsigned int i = 0; i < pool_size; ++i)
+        {
+            threads.emplace_back(&DecompressionPool::Run, this);
+            Logger::GetInstance().RegisterThread(threads.back().get_id(), "DecompressionPool" + std::to_string(i));
+        }
+        LOG_INFO("Decompression pool started with " << pool_size << " thread" << (pool_size > 1 ? "s" : ""));
+    }
+
+    void DecompressionPool::Stop()
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!running)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock_jobs(jobs_mutex);
+            running = false;
+        }
+        jobs_condition.notify_all();
+
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            if (threads[i].joinable())
+            {
+                Logger::GetInstance().UnregisterThread(threads[i].get_id());
+                threads[i].join();
+            }
+        }
+        threads.clear();
+    }
+
+    const bool DecompressionPool::IsRunning() const
+    {
+        return running;
+    }
+
+    std::shared_ptr<DecompressionJob> DecompressionPool::Submit(std::vector<unsigned char>&& packet)
+    {
+        std::shared_ptr<DecompressionJob> job = std::make_shared<DecompressionJob>();
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            if (!running)
+            {
+                return nullptr;
+            }
+            job->packet = std::move(packet);
+            jobs.push_back(job);
+        }
+        jobs_condition.notify_one();
+        return job;
+    }
+
+    void DecompressionPool::Run()
+    {
+        // Each worker keeps its own zlib stream
+        CompressionContext compression_context;
+        while (true)
+        {
+            std::shared_ptr<DecompressionJob> job;
+            {
+                std::unique_lock<std::mutex> lock(jobs_mutex);
+                jobs_condition.wait(lock, [this]() { return !running || !jobs.empty(); });
+                // Finish the pending jobs before stopping,
+                // someone may be waiting for them
+                if (jobs.empty())
+                {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            try
+            {
+                size_t length = job->packet.size();
+                ProtocolCraft::ReadIterator iter = job->packet.data();
+                const int data_length = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+                if (data_length != 0)
+                {
+                    TRACE_ZONE("Decompress", "bytes", data_length);
+                    compression_context.Decompress(job->packet.data() + job->packet.size() - length, length, job->output, data_length);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                job->error = e.what();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->done = true;
+            }
+            job->condition.notify_all();
+        }
+    }
+} // Botcraft
+#endif
@@ -0,0 +1,1388 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <asio.hpp>
+
+#include "protocolCraft/AllMessages.hpp"
+#include "protocolCraft/MessageFactory.hpp"
+
+#include "botcraft/Network/FakeServer.hpp"
+#include "botcraft/Network/Compression.hpp"
+#include "botcraft/Game/AssetsManager.hpp"
+#include "botcraft/Game/Entities/entities/Entity.hpp"
+#include "botcraft/Game/Inventory/Item.hpp"
+#include "botcraft/Game/Inventory/Window.hpp"
+#include "botcraft/Game/World/Block.hpp"
+#include "botcraft/Game/World/Blockstate.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/Section.hpp"
+#include "botcraft/Game/World/WorldSnapshot.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/VirtualClock.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+#if PROTOCOL_VERSION > 758
+    namespace
+    {
+        using Frame = std::shared_ptr<const std::vector<unsigned char> >;
+
+        constexpr int flat_world_min_y = -64;
+        constexpr int flat_world_height = 384;
+        constexpr double tick_duration_s = 0.05;
+        constexpr size_t inventory_size = 46;
+
+        /// @brief Minimal NBT writer to create the registry sent at login
+        class NBTWriter
+        {
+        public:
+            void StartCompound(const std::string& name)
+            {
+                Tag(TagType::Compound, name);
+            }
+
+            void EndCompound()
+            {
+                WriteData<char>(static_cast<char>(TagType::End), data);
+            }
+
+            void String(const std::string& name, const std::string& value)
+            {
+                Tag(TagType::String, name);
+                Name(value);
+            }
+
+            void Int(const std::string& name, const int value)
+            {
+                Tag(TagType::Int, name);
+                WriteData<int>(value, data);
+            }
+
+            void Byte(const std::string& name, const char value)
+            {
+                Tag(TagType::Byte, name);
+                WriteData<char>(value, data);
+            }
+
+            void Float(const std::string& name, const float value)
+            {
+                Tag(TagType::Float, name);
+                WriteData<float>(value, data);
+            }
+
+            void Double(const std::string& name, const double value)
+            {
+                Tag(TagType::Double, name);
+                WriteData<double>(value, data);
+            }
+
+            /// @brief Start a list of compounds, each one must be closed with EndCompound
+            void StartCompoundList(const std::string& name, const int size)
+            {
+                Tag(TagType::List, name);
+                WriteData<char>(static_cast<char>(TagType::Compound), data);
+                WriteData<int>(size, data);
+            }
+
+            NBT Get() const
+            {
+                NBT output;
+                ReadIterator iter = data.data();
+                size_t length = data.size();
+                output.Read(iter, length);
+                return output;
+            }
+
+        private:
+            void Tag(const TagType type, const std::string& name)
+            {
+                WriteData<char>(static_cast<char>(type), data);
+                Name(name);
+            }
+
+            void Name(const std::string& name)
+            {
+                WriteData<unsigned short>(static_cast<unsigned short>(name.size()), data);
+                data.insert(data.end(), name.begin(), name.end());
+            }
+
+        private:
+            std::vector<unsigned char> data;
+        };
+
+        Identifier MakeIdentifier(const std::string& name)
+        {
+            Identifier output;
+            output.SetNamespace("minecraft");
+            output.SetName(name);
+            return output;
+        }
+
+        /// @brief Registry with only the overworld dimension type, the only part the clients read
+        NBT CreateRegistry(const int world_min_y, const int world_height)
+        {
+            NBTWriter writer;
+            writer.StartCompound("");
+            writer.StartCompound("minecraft:dimension_type");
+            writer.String("type", "minecraft:dimension_type");
+            writer.StartCompoundList("value", 1);
+            writer.String("name", "minecraft:overworld");
+            writer.Int("id", 0);
+            writer.StartCompound("element");
+            writer.Byte("piglin_safe", 0);
+            writer.Byte("natural", 1);
+            writer.Float("ambient_light", 0.0f);
+            writer.String("infiniburn", "#minecraft:infiniburn_overworld");
+            writer.Byte("respawn_anchor_works", 0);
+            writer.Byte("has_skylight", 1);
+            writer.Byte("bed_works", 1);
+            writer.String("effects", "minecraft:overworld");
+            writer.Byte("has_raids", 1);
+            writer.Int("logical_height", world_height);
+            writer.Double("coordinate_scale", 1.0);
+            writer.Int("min_y", world_min_y);
+            writer.Int("height", world_height);
+            writer.Byte("ultrawarm", 0);
+            writer.Byte("has_ceiling", 0);
+            writer.Int("monster_spawn_block_light_limit", 0);
+            writer.Int("monster_spawn_light_level", 0);
+            writer.EndCompound(); // element
+            writer.EndCompound(); // list entry
+            writer.EndCompound(); // minecraft:dimension_type
+            writer.EndCompound(); // root
+            return writer.Get();
+        }
+
+        int GetBlockId(const std::string& name)
+        {
+            for (const auto& b : AssetsManager::getInstance().Blockstates())
+            {
+                if (b.second->GetName() == name)
+                {
+                    return b.first;
+                }
+            }
+            return 0;
+        }
+
+        /// @brief Chunk data of a flat world, stone under y=0, air above
+        std::vector<unsigned char> CreateFlatChunkData()
+        {
+            const int stone = GetBlockId("minecraft:stone");
+            std::vector<unsigned char> output;
+            for (int section_y = 0; section_y < flat_world_height / 16; ++section_y)
+            {
+                const bool is_ground = flat_world_min_y + section_y * 16 < 0;
+                // Single value sections
+                WriteData<short>(is_ground ? 4096 : 0, output);
+                WriteData<unsigned char>(0, output);
+                WriteData<VarInt>(is_ground ? stone : 0, output);
+                WriteData<VarInt>(0, output);
+                // Single value biomes
+                WriteData<unsigned char>(0, output);
+                WriteData<VarInt>(0, output);
+                WriteData<VarInt>(0, output);
+            }
+            return output;
+        }
+
+        /// @brief Chunk data of a loaded chunk. Heightmaps, light and block
+        /// entities are not sent, heightmaps are computed by the clients
+        std::vector<unsigned char> CreateChunkData(const Chunk& chunk)
+        {
+            std::vector<unsigned char> output;
+            std::vector<unsigned short> indices(Section::NUM_BLOCKS);
+            for (int section_y = 0; section_y < chunk.GetHeight() / SECTION_HEIGHT; ++section_y)
+            {
+                const Section* section = chunk.GetSection(section_y);
+                std::vector<int> ids;
+                std::vector<bool> is_air;
+                bool single_value = true;
+                if (section != nullptr)
+                {
+                    for (const Block& b : section->GetPalette())
+                    {
+                        ids.push_back(b.GetBlockstate()->GetId());
+                        is_air.push_back(b.GetBlockstate()->IsAir());
+                    }
+                    for (int i = 0; i < Section::NUM_BLOCKS; ++i)
+                    {
+                        indices[i] = section->GetPaletteIndex(i);
+                        single_value = single_value && indices[i] == indices[0];
+                    }
+                }
+
+                if (section == nullptr || single_value)
+                {
+                    const bool air = section == nullptr || is_air[indices[0]];
+                    WriteData<short>(air ? 0 : Section::NUM_BLOCKS, output);
+                    WriteData<unsigned char>(0, output);
+                    WriteData<VarInt>(section == nullptr ? 0 : ids[indices[0]], output);
+                    WriteData<VarInt>(0, output);
+                }
+                else
+                {
+                    short block_count = 0;
+                    for (int i = 0; i < Section::NUM_BLOCKS; ++i)
+                    {
+                        block_count += is_air[indices[i]] ? 0 : 1;
+                    }
+                    WriteData<short>(block_count, output);
+
+                    unsigned char bits_per_block = 4;
+                    while ((1u << bits_per_block) < ids.size())
+                    {
+                        bits_per_block += 1;
+                    }
+                    // Too many different blocks, send global ids
+                    const bool global_palette = bits_per_block > 8;
+                    if (global_palette)
+                    {
+                        const int max_id = *std::max_element(ids.begin(), ids.end());
+                        bits_per_block = 9;
+                        while ((1 << bits_per_block) <= max_id)
+                        {
+                            bits_per_block += 1;
+                        }
+                    }
+                    WriteData<unsigned char>(bits_per_block, output);
+                    if (!global_palette)
+                    {
+                        WriteData<VarInt>(static_cast<int>(ids.size()), output);
+                        for (const int id : ids)
+                        {
+                            WriteData<VarInt>(id, output);
+                        }
+                    }
+
+                    // Values don't span over two longs
+                    const int values_per_long = 64 / bits_per_block;
+                    std::vector<unsigned long long int> data_array((Section::NUM_BLOCKS + values_per_long - 1) / values_per_long, 0);
+                    for (int i = 0; i < Section::NUM_BLOCKS; ++i)
+                    {
+                        const unsigned long long int value = global_palette ? ids[indices[i]] : indices[i];
+                        data_array[i / values_per_long] |= value << ((i % values_per_long) * bits_per_block);
+                    }
+                    WriteData<VarInt>(static_cast<int>(data_array.size()), output);
+                    for (const unsigned long long int l : data_array)
+                    {
+                        WriteData<unsigned long long int>(l, output);
+                    }
+                }
+
+                // Single value biomes
+                WriteData<unsigned char>(0, output);
+                WriteData<VarInt>(0, output);
+                WriteData<VarInt>(0, output);
+            }
+            return output;
+        }
+
+        /// @brief Get the blockstate placed by a block item, the first one with the same name
+        /// like the clients prediction
+        /// @return The blockstate id, -1 if the item is not a block
+        int GetPlacedBlockstateId(const std::string& item_name)
+        {
+            static const std::unordered_map<std::string, int> placed_blockstates = []()
+            {
+                std::unordered_map<std::string, int> output;
+                for (const auto& b : AssetsManager::getInstance().Blockstates())
+                {
+                    auto it = output.find(b.second->GetName());
+                    if (it == output.end() || b.first < it->second)
+                    {
+                        output[b.second->GetName()] = b.first;
+                    }
+                }
+                return output;
+            }();
+
+            auto it = placed_blockstates.find(item_name);
+            return it == placed_blockstates.end() ? -1 : it->second;
+        }
+
+        std::pair<int, int> GetChunkCoords(const double x, const double z)
+        {
+            return { static_cast<int>(std::floor(x / CHUNK_WIDTH)), static_cast<int>(std::floor(z / CHUNK_WIDTH)) };
+        }
+
+        NBT CreateEmptyCompound()
+        {
+            NBTWriter writer;
+            writer.StartCompound("");
+            writer.EndCompound();
+            return writer.Get();
+        }
+
+        UUID MakeUUID(const unsigned long long int n)
+        {
+            UUID output{};
+            for (int i = 0; i < 8; ++i)
+            {
+                output[15 - i] = static_cast<unsigned char>((n >> (8 * i)) & 0xFF);
+            }
+            return output;
+        }
+    }
+
+    struct Mob
+    {
+        int id;
+        double x;
+        double z;
+    };
+
+    struct FakeServer::Impl
+    {
+        class Session;
+
+        Impl(const FakeServerConfig& config_) : config(config_), acceptor(io_service), tick_timer(io_service), tick_strand(io_service)
+        {
+#ifndef USE_COMPRESSION
+            if (config.compression_threshold >= 0)
+            {
+                LOG_WARNING("Botcraft was compiled without compression support, FakeServer compression disabled");
+                config.compression_threshold = -1;
+            }
+#endif
+            world_min_y = flat_world_min_y;
+            world_height = flat_world_height;
+            if (config.world != nullptr)
+            {
+                // Copy the chunks, as they will be modified by the players
+                for (const auto& [coords, chunk] : config.world->GetAllChunks())
+                {
+                    world_chunks[coords] = std::make_shared<Chunk>(*chunk);
+                    world_min_y = chunk->GetMinY();
+                    world_height = chunk->GetHeight();
+                }
+            }
+            else
+            {
+                chunk_data = CreateFlatChunkData();
+            }
+            registry = CreateRegistry(world_min_y, world_height);
+            heightmaps = CreateEmptyCompound();
+            start_time = std::chrono::steady_clock::now();
+            next_entity_id = 1;
+            stopping = false;
+
+            std::mt19937 random_engine(42);
+            const double spawn_area = std::max(1, config.view_distance) * 16.0;
+            std::uniform_real_distribution<double> position_distribution(-spawn_area, spawn_area);
+            for (int i = 0; i < config.num_entities; ++i)
+            {
+                mobs.push_back(Mob{ 1000000 + i, config.spawn_position.x + position_distribution(random_engine), config.spawn_position.z + position_distribution(random_engine) });
+            }
+
+            const asio::ip::tcp::endpoint endpoint(asio::ip::make_address(config.address), config.port);
+            acceptor.open(endpoint.protocol());
+            acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+            acceptor.bind(endpoint);
+            acceptor.listen();
+
+            Accept();
+            ScheduleTick();
+
+            for (unsigned int i = 0; i < std::max(1u, config.num_threads); ++i)
+            {
+                threads.emplace_back([this, i]()
+                    {
+                        Logger::GetInstance().RegisterThread("FakeServer - " + std::to_string(i));
+                        io_service.run();
+                    });
+            }
+        }
+
+        ~Impl()
+        {
+            stopping = true;
+            io_service.stop();
+            for (std::thread& t : threads)
+            {
+                if (t.joinable())
+                {
+                    t.join();
+                }
+            }
+        }
+
+        const long long int NowUs() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+        }
+
+        /// @brief Serialize a message, with compression if enabled
+        /// @param context Compression context, must not be used by another thread during the call
+        Frame MakeFrame(const Message& msg, CompressionContext* context) const
+        {
+            std::vector<unsigned char> payload;
+            msg.Write(payload);
+
+            std::vector<unsigned char> body;
+            if (config.compression_threshold < 0)
+            {
+                body = std::move(payload);
+            }
+            else if (payload.size() < static_cast<size_t>(config.compression_threshold))
+            {
+                body.reserve(payload.size() + 1);
+                body.push_back(0x00);
+                body.insert(body.end(), payload.begin(), payload.end());
+            }
+            else
+            {
+#ifdef USE_COMPRESSION
+                WriteData<VarInt>(static_cast<int>(payload.size()), body);
+                context->Compress(payload.data(), payload.size(), body);
+#endif
+            }
+
+            std::shared_ptr<std::vector<unsigned char> > output = std::make_shared<std::vector<unsigned char> >();
+            output->reserve(body.size() + 5);
+            WriteData<VarInt>(static_cast<int>(body.size()), *output);
+            output->insert(output->end(), body.begin(), body.end());
+            return output;
+        }
+
+        /// @brief Get the frame of a chunk packet. All players spawn at the same place and get
+        /// the same chunks, so they are compressed only once (until a block is changed)
+        /// @return The frame, nullptr if the chunk is not in the world
+        Frame GetChunkFrame(const int x, const int z, CompressionContext* context)
+        {
+            {
+                std::lock_guard<std::mutex> lock(chunk_frames_mutex);
+                auto it = chunk_frames.find({ x, z });
+                if (it != chunk_frames.end())
+                {
+                    return it->second;
+                }
+            }
+
+            ClientboundLevelChunkPacketData data;
+            data.SetHeightmaps(heightmaps);
+            if (config.world == nullptr)
+            {
+                data.SetBuffer(chunk_data);
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(world_mutex);
+                auto it = world_chunks.find({ x, z });
+                if (it == world_chunks.end())
+                {
+                    return nullptr;
+                }
+                data.SetBuffer(CreateChunkData(*it->second));
+            }
+            ClientboundLightUpdatePacketData light_data;
+            light_data.SetTrustEdges(true);
+            ClientboundLevelChunkWithLightPacket msg;
+            msg.SetX(x);
+            msg.SetZ(z);
+            msg.SetChunkData(data);
+            msg.SetLightData(light_data);
+            Frame frame = MakeFrame(msg, context);
+
+            std::lock_guard<std::mutex> lock(chunk_frames_mutex);
+            chunk_frames[{ x, z }] = frame;
+            return frame;
+        }
+
+        void Accept()
+        {
+            std::shared_ptr<Session> session = std::make_shared<Session>(*this);
+            acceptor.async_accept(session->socket, [this, session](const asio::error_code& error)
+                {
+                    if (!error)
+                    {
+                        stats_connections += 1;
+                        session->socket.set_option(asio::ip::tcp::no_delay(true));
+                        session->Start();
+                    }
+                    if (error != asio::error::operation_aborted && !stopping)
+                    {
+                        Accept();
+                    }
+                });
+        }
+
+        /// @brief Change a block of the world and send it to all the players
+        /// @param pos Position of the block
+        /// @param blockstate New blockstate id
+        /// @param source Session that changed the block, the update is sent to it directly
+        /// (it must be called on its strand), so it arrives before the acknowledgement
+        /// @return False if the position is not in the world
+        bool SetBlock(const Position& pos, const int blockstate, Session& source)
+        {
+            const std::pair<int, int> coords = GetChunkCoords(pos.x, pos.z);
+            {
+                std::lock_guard<std::mutex> lock(world_mutex);
+                auto it = world_chunks.find(coords);
+                if (it == world_chunks.end() || pos.y < world_min_y || pos.y >= world_min_y + world_height)
+                {
+                    return false;
+                }
+                it->second->SetBlock(Position(pos.x - coords.first * CHUNK_WIDTH, pos.y, pos.z - coords.second * CHUNK_WIDTH), blockstate);
+            }
+            {
+                std::lock_guard<std::mutex> lock(chunk_frames_mutex);
+                chunk_frames.erase(coords);
+            }
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                stats_block_changes += 1;
+            }
+
+            ClientboundBlockUpdatePacket msg;
+            msg.SetPos(pos.ToNetworkPosition());
+            msg.SetBlockstate(blockstate);
+            const Frame frame = MakeFrame(msg, &source.compression);
+
+            std::vector<std::shared_ptr<Session> > players;
+            {
+                std::lock_guard<std::mutex> lock(sessions_mutex);
+                players.assign(sessions.begin(), sessions.end());
+            }
+            for (const std::shared_ptr<Session>& p : players)
+            {
+                if (p.get() == &source)
+                {
+                    p->Send(frame);
+                }
+                else
+                {
+                    p->Post(frame);
+                }
+            }
+            return true;
+        }
+
+        /// @brief Get a block of the world
+        /// @return The blockstate, nullptr if not in the world
+        const Blockstate* GetBlockstate(const Position& pos)
+        {
+            const std::pair<int, int> coords = GetChunkCoords(pos.x, pos.z);
+            std::lock_guard<std::mutex> lock(world_mutex);
+            auto it = world_chunks.find(coords);
+            if (it == world_chunks.end())
+            {
+                return nullptr;
+            }
+            const Block* block = it->second->GetBlock(Position(pos.x - coords.first * CHUNK_WIDTH, pos.y, pos.z - coords.second * CHUNK_WIDTH));
+            return block == nullptr ? AssetsManager::getInstance().GetBlockstate(0) : block->GetBlockstate();
+        }
+
+        void ScheduleTick()
+        {
+            // Ticks follow the virtual clock, so the mobs keep up with accelerated bots
+            tick_timer.expires_from_now(std::chrono::microseconds(static_cast<long long int>(1e6 * tick_duration_s / VirtualClock::GetSpeed())));
+            tick_timer.async_wait(tick_strand.wrap([this](const asio::error_code& error)
+                {
+                    if (error || stopping)
+                    {
+                        return;
+                    }
+                    Tick();
+                    ScheduleTick();
+                }));
+        }
+
+        /// @brief Move the mobs and send the updates to all the players. Runs on tick_strand
+        void Tick()
+        {
+            std::vector<std::shared_ptr<Session> > players;
+            {
+                std::lock_guard<std::mutex> lock(sessions_mutex);
+                players.assign(sessions.begin(), sessions.end());
+            }
+
+            std::vector<Frame> frames;
+            {
+                std::lock_guard<std::mutex> lock(mobs_mutex);
+                const double spawn_area = std::max(1, config.view_distance) * 16.0;
+                std::uniform_real_distribution<double> step_distribution(-0.25, 0.25);
+                for (Mob& m : mobs)
+                {
+                    mob_move_budget += config.entity_moves_per_second * tick_duration_s;
+                    if (mob_move_budget < 1.0)
+                    {
+                        continue;
+                    }
+                    mob_move_budget -= 1.0;
+
+                    const double dx = std::max(config.spawn_position.x - spawn_area, std::min(config.spawn_position.x + spawn_area, m.x + step_distribution(random_engine))) - m.x;
+                    const double dz = std::max(config.spawn_position.z - spawn_area, std::min(config.spawn_position.z + spawn_area, m.z + step_distribution(random_engine))) - m.z;
+                    const short xa = static_cast<short>(dx * 4096.0);
+                    const short za = static_cast<short>(dz * 4096.0);
+                    // Keep the positions in sync with what the clients compute
+                    m.x += xa / 4096.0;
+                    m.z += za / 4096.0;
+
+                    ClientboundMoveEntityPacketPos msg;
+                    msg.SetEntityId(m.id);
+                    msg.SetXA(xa);
+                    msg.SetYA(0);
+                    msg.SetZA(za);
+                    msg.SetOnGround(true);
+                    frames.push_back(MakeFrame(msg, &tick_compression));
+                }
+            }
+
+            const long long int now = NowUs();
+            for (const std::shared_ptr<Session>& p : players)
+            {
+                p->OnTick(frames, now);
+            }
+        }
+
+        void Register(const std::shared_ptr<Session>& session)
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex);
+            sessions.insert(session);
+            stats_players = sessions.size();
+        }
+
+        void Unregister(const std::shared_ptr<Session>& session)
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex);
+            sessions.erase(session);
+            stats_players = sessions.size();
+        }
+
+        /// @brief One client connection
+        class Session : public std::enable_shared_from_this<Session>
+        {
+        public:
+            Session(Impl& server_) : server(server_), socket(server_.io_service), strand(server_.io_service)
+            {
+                state = ConnectionState::Handshake;
+                compressed = false;
+                closed = false;
+                writing = false;
+                pending_bytes = 0;
+                entity_id = 0;
+                chunk_budget = 0.0;
+                next_chunk_index = 0;
+                last_keep_alive_us = 0;
+                read_buffer.resize(16 * 1024);
+                position = server.config.spawn_position;
+                center_chunk = GetChunkCoords(position.x, position.z);
+                inventory = std::vector<Slot>(inventory_size);
+                for (const auto& [index, slot] : server.config.inventory)
+                {
+                    if (index >= 0 && static_cast<size_t>(index) < inventory_size)
+                    {
+                        inventory[index] = slot;
+                    }
+                }
+                held_slot = 0;
+                inventory_state_id = 0;
+            }
+
+            void Start()
+            {
+                Read();
+            }
+
+            /// @brief Called by the server each tick, from any thread
+            void OnTick(const std::vector<Frame>& frames, const long long int now)
+            {
+                std::shared_ptr<Session> self = shared_from_this();
+                strand.post([self, frames, now]()
+                    {
+                        if (self->closed)
+                        {
+                            return;
+                        }
+                        for (const Frame& f : frames)
+                        {
+                            self->Send(f);
+                        }
+                        self->StreamChunks();
+                        if (now - self->last_keep_alive_us >= static_cast<long long int>(1e6 * self->server.config.keep_alive_interval_s))
+                        {
+                            self->last_keep_alive_us = now;
+                            ClientboundKeepAlivePacket msg;
+                            msg.SetId_(now);
+                            self->Send(self->server.MakeFrame(msg, &self->compression));
+                        }
+                    });
+            }
+
+            /// @brief Send a frame, from any thread
+            void Post(const Frame& frame)
+            {
+                std::shared_ptr<Session> self = shared_from_this();
+                strand.post([self, frame]()
+                    {
+                        self->Send(frame);
+                    });
+            }
+
+            asio::ip::tcp::socket socket;
+
+        private:
+            friend struct Impl;
+
+            void Read()
+            {
+                std::shared_ptr<Session> self = shared_from_this();
+                socket.async_read_some(asio::buffer(read_buffer), strand.wrap([self](const asio::error_code& error, const std::size_t size)
+                    {
+                        if (error)
+                        {
+                            self->Close();
+                            return;
+                        }
+                        self->input.insert(self->input.end(), self->read_buffer.begin(), self->read_buffer.begin() + size);
+                        try
+                        {
+                            self->ProcessInput();
+                        }
+                        catch (const std::exception& e)
+                        {
+                            LOG_WARNING("FakeServer closing connection after a packet error: " << e.what());
+                            self->Close();
+                            return;
+                        }
+                        if (!self->closed)
+                        {
+                            self->Read();
+                        }
+                    }));
+            }
+
+            /// @brief Split the received data in packets
+            void ProcessInput()
+            {
+                size_t position = 0;
+                while (!closed)
+                {
+                    // Read the frame length VarInt
+                    int frame_size = 0;
+                    size_t varint_size = 0;
+                    bool complete = false;
+                    while (position + varint_size < input.size() && varint_size < 5)
+                    {
+                        const unsigned char b = input[position + varint_size];
+                        frame_size |= (b & 0x7F) << (7 * varint_size);
+                        varint_size += 1;
+                        if ((b & 0x80) == 0)
+                        {
+                            complete = true;
+                            break;
+                        }
+                    }
+                    if (!complete)
+                    {
+                        if (varint_size == 5)
+                        {
+                            throw std::runtime_error("invalid frame length");
+                        }
+                        break;
+                    }
+                    if (input.size() - position - varint_size < static_cast<size_t>(frame_size))
+                    {
+                        break;
+                    }
+                    position += varint_size;
+                    ProcessFrame(input.data() + position, frame_size);
+                    position += frame_size;
+                }
+                input.erase(input.begin(), input.begin() + position);
+            }
+
+            void ProcessFrame(const unsigned char* data, const size_t size)
+            {
+                ReadIterator iter = data;
+                size_t length = size;
+                std::vector<unsigned char> decompressed;
+                if (compressed)
+                {
+                    const int data_length = ReadData<VarInt>(iter, length);
+                    if (data_length != 0)
+                    {
+#ifdef USE_COMPRESSION
+                        compression.Decompress(iter, length, decompressed, data_length);
+#endif
+                        iter = decompressed.data();
+                        length = decompressed.size();
+                    }
+                }
+
+                const int id = ReadData<VarInt>(iter, length);
+                switch (state)
+                {
+                case ConnectionState::Handshake:
+                {
+                    ServerboundClientIntentionPacket msg;
+                    if (id != msg.GetId())
+                    {
+                        throw std::runtime_error("unexpected packet during handshake");
+                    }
+                    msg.Read(iter, length);
+                    if (msg.GetIntention() != static_cast<int>(ConnectionState::Login))
+                    {
+                        // Status requests are not supported
+                        Close();
+                        return;
+                    }
+                    state = ConnectionState::Login;
+                    break;
+                }
+                case ConnectionState::Login:
+                {
+                    ServerboundHelloPacket msg;
+                    if (id != msg.GetId())
+                    {
+                        throw std::runtime_error("unexpected packet during login");
+                    }
+                    msg.Read(iter, length);
+                    Login(msg.GetName_());
+                    break;
+                }
+                case ConnectionState::Play:
+                    ProcessPlayPacket(id, iter, length);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            void ProcessPlayPacket(const int id, ReadIterator& iter, size_t& length)
+            {
+                static const int keep_alive_id = ServerboundKeepAlivePacket().GetId();
+                static const int move_pos_id = ServerboundMovePlayerPacketPos().GetId();
+                static const int move_pos_rot_id = ServerboundMovePlayerPacketPosRot().GetId();
+                static const int player_action_id = ServerboundPlayerActionPacket().GetId();
+                static const int use_item_on_id = ServerboundUseItemOnPacket().GetId();
+                static const int set_carried_item_id = ServerboundSetCarriedItemPacket().GetId();
+                static const int set_creative_slot_id = ServerboundSetCreativeModeSlotPacket().GetId();
+                static const int container_click_id = ServerboundContainerClickPacket().GetId();
+
+                if (id == keep_alive_id)
+                {
+                    ServerboundKeepAlivePacket msg;
+                    msg.Read(iter, length);
+                    const double rtt_ms = (server.NowUs() - msg.GetId_()) / 1000.0;
+                    std::lock_guard<std::mutex> lock(server.stats_mutex);
+                    server.stats_keep_alive_answers += 1;
+                    server.stats_keep_alive_rtt_sum_ms += rtt_ms;
+                    server.stats_max_keep_alive_rtt_ms = std::max(server.stats_max_keep_alive_rtt_ms, rtt_ms);
+                }
+                else if (id == move_pos_id)
+                {
+                    ServerboundMovePlayerPacketPos msg;
+                    msg.Read(iter, length);
+                    MoveTo(Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ()));
+                }
+                else if (id == move_pos_rot_id)
+                {
+                    ServerboundMovePlayerPacketPosRot msg;
+                    msg.Read(iter, length);
+                    MoveTo(Vector3<double>(msg.GetX(), msg.GetY(), msg.GetZ()));
+                }
+                else if (id == player_action_id)
+                {
+                    ServerboundPlayerActionPacket msg;
+                    msg.Read(iter, length);
+                    // Creative players break blocks when they start digging, others when they finish
+                    if ((msg.GetAction() == 0 && server.config.game_mode == 1) || msg.GetAction() == 2)
+                    {
+                        server.SetBlock(Position(msg.GetPos().GetX(), msg.GetPos().GetY(), msg.GetPos().GetZ()), 0, *this);
+                    }
+                    if (msg.GetAction() <= 2)
+                    {
+                        AcknowledgeBlockChange(msg.GetSequence());
+                    }
+                }
+                else if (id == use_item_on_id)
+                {
+                    ServerboundUseItemOnPacket msg;
+                    msg.Read(iter, length);
+                    PlaceBlock(msg);
+                    AcknowledgeBlockChange(msg.GetSequence());
+                }
+                else if (id == set_carried_item_id)
+                {
+                    ServerboundSetCarriedItemPacket msg;
+                    msg.Read(iter, length);
+                    held_slot = std::max<short>(0, std::min<short>(8, msg.GetSlot()));
+                }
+                else if (id == set_creative_slot_id)
+                {
+                    ServerboundSetCreativeModeSlotPacket msg;
+                    msg.Read(iter, length);
+                    if (msg.GetSlotNum() >= 0 && static_cast<size_t>(msg.GetSlotNum()) < inventory_size)
+                    {
+                        inventory[msg.GetSlotNum()] = msg.GetItemStack();
+                    }
+                }
+                else if (id == container_click_id)
+                {
+                    ServerboundContainerClickPacket msg;
+                    msg.Read(iter, length);
+                    // Trust the client prediction, only the player inventory is known
+                    if (msg.GetContainerId() == Window::PLAYER_INVENTORY_INDEX)
+                    {
+                        for (const auto& [index, slot] : msg.GetChangeSlots())
+                        {
+                            if (index >= 0 && static_cast<size_t>(index) < inventory_size)
+                            {
+                                inventory[index] = slot;
+                            }
+                        }
+                    }
+                }
+                // Everything else is ignored
+            }
+
+            /// @brief Update the position of the player, and send the chunks around it when it changes chunk
+            void MoveTo(const Vector3<double>& new_position)
+            {
+                position = new_position;
+                const std::pair<int, int> chunk = GetChunkCoords(position.x, position.z);
+                if (server.config.world == nullptr || chunk == center_chunk)
+                {
+                    return;
+                }
+                center_chunk = chunk;
+                ClientboundSetChunkCacheCenterPacket center_msg;
+                center_msg.SetX(center_chunk.first);
+                center_msg.SetZ(center_chunk.second);
+                Send(server.MakeFrame(center_msg, &compression));
+                SendViewArea();
+            }
+
+            /// @brief Send the chunks of the view area not sent yet, and unload the ones too far
+            void SendViewArea()
+            {
+                const int radius = server.config.view_distance;
+                for (auto it = sent_chunks.begin(); it != sent_chunks.end();)
+                {
+                    if (std::abs(it->first - center_chunk.first) > radius + 1 || std::abs(it->second - center_chunk.second) > radius + 1)
+                    {
+                        ClientboundForgetLevelChunkPacket msg;
+                        msg.SetX(it->first);
+                        msg.SetZ(it->second);
+                        Send(server.MakeFrame(msg, &compression));
+                        it = sent_chunks.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+                for (int x = center_chunk.first - radius; x <= center_chunk.first + radius; ++x)
+                {
+                    for (int z = center_chunk.second - radius; z <= center_chunk.second + radius; ++z)
+                    {
+                        if (sent_chunks.count({ x, z }) > 0)
+                        {
+                            continue;
+                        }
+                        const Frame frame = server.GetChunkFrame(x, z, &compression);
+                        if (frame != nullptr)
+                        {
+                            Send(frame);
+                            sent_chunks.insert({ x, z });
+                        }
+                    }
+                }
+            }
+
+            void AcknowledgeBlockChange(const int sequence)
+            {
+                ClientboundBlockChangedAckPacket msg;
+                msg.SetSequence(sequence);
+                Send(server.MakeFrame(msg, &compression));
+            }
+
+            /// @brief Place the block held in hand, like a vanilla server without any check
+            void PlaceBlock(const ServerboundUseItemOnPacket& msg)
+            {
+                if (server.config.world == nullptr)
+                {
+                    return;
+                }
+                const short slot_index = msg.GetHand() == 1 ? Window::INVENTORY_OFFHAND_INDEX : Window::INVENTORY_HOTBAR_START + held_slot;
+                Slot& slot = inventory[slot_index];
+                if (slot.IsEmptySlot())
+                {
+                    return;
+                }
+                const Item* item = AssetsManager::getInstance().GetItem(slot.GetItemID());
+                const int blockstate = item == nullptr ? -1 : GetPlacedBlockstateId(item->GetName());
+                if (blockstate == -1)
+                {
+                    return;
+                }
+
+                // The clicked block is replaced if it's air or fluid, else the block is placed against its face
+                Position pos(msg.GetLocation().GetX(), msg.GetLocation().GetY(), msg.GetLocation().GetZ());
+                const Blockstate* clicked = server.GetBlockstate(pos);
+                if (clicked != nullptr && !clicked->IsAir() && !clicked->IsFluid())
+                {
+                    static const std::array<Position, 6> face_offsets = {
+                        Position(0, -1, 0), Position(0, 1, 0), Position(0, 0, -1),
+                        Position(0, 0, 1), Position(-1, 0, 0), Position(1, 0, 0)
+                    };
+                    pos = pos + face_offsets[std::max(0, std::min(5, msg.GetDirection()))];
+                    const Blockstate* target = server.GetBlockstate(pos);
+                    if (target != nullptr && !target->IsAir() && !target->IsFluid())
+                    {
+                        return;
+                    }
+                }
+                if (!server.SetBlock(pos, blockstate, *this))
+                {
+                    return;
+                }
+
+                if (server.config.game_mode != 1)
+                {
+                    slot.SetItemCount(slot.GetItemCount() - 1);
+                    if (slot.GetItemCount() <= 0)
+                    {
+                        slot = Slot();
+                    }
+                    ClientboundContainerSetSlotPacket slot_msg;
+                    slot_msg.SetContainerId(Window::PLAYER_INVENTORY_INDEX);
+                    slot_msg.SetSlot_(slot_index);
+                    slot_msg.SetItemStack(slot);
+                    slot_msg.SetStateId(++inventory_state_id);
+                    Send(server.MakeFrame(slot_msg, &compression));
+                }
+            }
+
+            void Login(const std::string& name)
+            {
+                if (server.config.compression_threshold >= 0)
+                {
+                    ClientboundLoginCompressionPacket compression_msg;
+                    compression_msg.SetCompressionThreshold(server.config.compression_threshold);
+                    // This one is sent before enabling compression
+                    std::vector<unsigned char> payload;
+                    compression_msg.Write(payload);
+                    std::shared_ptr<std::vector<unsigned char> > frame = std::make_shared<std::vector<unsigned char> >();
+                    WriteData<VarInt>(static_cast<int>(payload.size()), *frame);
+                    frame->insert(frame->end(), payload.begin(), payload.end());
+                    Send(frame);
+                    compressed = true;
+                }
+
+                entity_id = server.next_entity_id++;
+
+                GameProfile profile;
+                profile.SetUUID(MakeUUID(entity_id));
+                profile.SetName(name);
+                ClientboundGameProfilePacket profile_msg;
+                profile_msg.SetGameProfile(profile);
+                Send(server.MakeFrame(profile_msg, &compression));
+                state = ConnectionState::Play;
+
+                ClientboundLoginPacket login_msg;
+                login_msg.SetPlayerId(entity_id);
+                login_msg.SetHardcore(false);
+                login_msg.SetGameType(server.config.game_mode);
+                login_msg.SetPreviousGameType(static_cast<unsigned char>(-1));
+                login_msg.SetLevels({ MakeIdentifier("overworld") });
+                login_msg.SetRegistryHolder(server.registry);
+                login_msg.SetDimensionType(MakeIdentifier("overworld"));
+                login_msg.SetDimension(MakeIdentifier("overworld"));
+                login_msg.SetSeed(0);
+                login_msg.SetMaxPlayers(100000);
+                login_msg.SetChunkRadius(server.config.view_distance);
+                login_msg.SetSimulationDistance(server.config.view_distance);
+                login_msg.SetReducedDebugInfo(false);
+                login_msg.SetShowDeathScreen(true);
+                login_msg.SetIsDebug(false);
+                login_msg.SetIsFlat(server.config.world == nullptr);
+                Send(server.MakeFrame(login_msg, &compression));
+
+                ClientboundSetChunkCacheCenterPacket center_msg;
+                center_msg.SetX(center_chunk.first);
+                center_msg.SetZ(center_chunk.second);
+                Send(server.MakeFrame(center_msg, &compression));
+
+                SendViewArea();
+
+                ClientboundContainerSetContentPacket inventory_msg;
+                inventory_msg.SetContainerId(Window::PLAYER_INVENTORY_INDEX);
+                inventory_msg.SetItems(inventory);
+                inventory_msg.SetCarriedItem(Slot());
+                inventory_msg.SetStateId(inventory_state_id);
+                Send(server.MakeFrame(inventory_msg, &compression));
+
+                ClientboundPlayerPositionPacket position_msg;
+                position_msg.SetX(position.x);
+                position_msg.SetY(position.y);
+                position_msg.SetZ(position.z);
+                position_msg.SetYRot(0.0f);
+                position_msg.SetXRot(0.0f);
+                position_msg.SetRelativeArguments(0);
+                position_msg.SetId_(1);
+                position_msg.SetDismountVehicle(false);
+                Send(server.MakeFrame(position_msg, &compression));
+
+                ClientboundSetHealthPacket health_msg;
+                health_msg.SetHealth(20.0f);
+                health_msg.SetFood(20);
+                health_msg.SetFoodSaturation(5.0f);
+                Send(server.MakeFrame(health_msg, &compression));
+
+                {
+                    std::lock_guard<std::mutex> lock(server.mobs_mutex);
+                    for (const Mob& m : server.mobs)
+                    {
+                        ClientboundAddEntityPacket entity_msg;
+                        entity_msg.SetId_(m.id);
+                        entity_msg.SetUUID(MakeUUID(m.id));
+                        entity_msg.SetType(static_cast<char>(EntityType::Zombie));
+                        entity_msg.SetX(m.x);
+                        entity_msg.SetY(server.config.spawn_position.y);
+                        entity_msg.SetZ(m.z);
+                        Send(server.MakeFrame(entity_msg, &compression));
+                    }
+                    // Registered with the lock, so no move is missed
+                    // between the spawn and the first tick
+                    server.Register(shared_from_this());
+                }
+            }
+
+            /// @brief Send chunks of the view area again, at the configured rate
+            void StreamChunks()
+            {
+                if (server.config.chunks_per_second <= 0.0 || state != ConnectionState::Play)
+                {
+                    return;
+                }
+                chunk_budget += server.config.chunks_per_second * tick_duration_s;
+                const int diameter = 2 * server.config.view_distance + 1;
+                while (chunk_budget >= 1.0)
+                {
+                    chunk_budget -= 1.0;
+                    const int x = center_chunk.first + next_chunk_index % diameter - server.config.view_distance;
+                    const int z = center_chunk.second + next_chunk_index / diameter - server.config.view_distance;
+                    next_chunk_index = (next_chunk_index + 1) % (diameter * diameter);
+                    const Frame frame = server.GetChunkFrame(x, z, &compression);
+                    if (frame != nullptr)
+                    {
+                        Send(frame);
+                    }
+                }
+            }
+
+            /// @brief Queue a frame, must be called on strand
+            void Send(const Frame& frame)
+            {
+                if (closed)
+                {
+                    return;
+                }
+                pending_bytes += frame->size();
+                if (pending_bytes > server.config.max_pending_bytes)
+                {
+                    LOG_WARNING("FakeServer dropping a client not reading fast enough");
+                    {
+                        std::lock_guard<std::mutex> lock(server.stats_mutex);
+                        server.stats_slow_players_dropped += 1;
+                    }
+                    Close();
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(server.stats_mutex);
+                    server.stats_packets_sent += 1;
+                    server.stats_bytes_sent += frame->size();
+                }
+                output.push_back(frame);
+                if (!writing)
+                {
+                    Write();
+                }
+            }
+
+            /// @brief Write all queued frames at once
+            void Write()
+            {
+                writing = true;
+                in_flight.assign(output.begin(), output.end());
+                output.clear();
+                std::vector<asio::const_buffer> buffers;
+                buffers.reserve(in_flight.size());
+                for (const Frame& f : in_flight)
+                {
+                    buffers.push_back(asio::buffer(*f));
+                }
+
+                std::shared_ptr<Session> self = shared_from_this();
+                asio::async_write(socket, buffers, strand.wrap([self](const asio::error_code& error, const std::size_t size)
+                    {
+                        self->pending_bytes -= size;
+                        self->in_flight.clear();
+                        self->writing = false;
+                        if (error)
+                        {
+                            self->Close();
+                            return;
+                        }
+                        if (!self->output.empty() && !self->closed)
+                        {
+                            self->Write();
+                        }
+                    }));
+            }
+
+            void Close()
+            {
+                if (closed)
+                {
+                    return;
+                }
+                closed = true;
+                asio::error_code ec;
+                socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+                socket.close(ec);
+                output.clear();
+                server.Unregister(shared_from_this());
+            }
+
+        private:
+            Impl& server;
+            asio::io_service::strand strand;
+
+            ConnectionState state;
+            bool compressed;
+            bool closed;
+            int entity_id;
+
+            std::vector<unsigned char> read_buffer;
+            std::vector<unsigned char> input;
+
+            std::deque<Frame> output;
+            std::vector<Frame> in_flight;
+            bool writing;
+            size_t pending_bytes;
+
+            double chunk_budget;
+            int next_chunk_index;
+            long long int last_keep_alive_us;
+
+            Vector3<double> position;
+            std::pair<int, int> center_chunk;
+            std::set<std::pair<int, int> > sent_chunks;
+
+            std::vector<Slot> inventory;
+            short held_slot;
+            int inventory_state_id;
+
+            CompressionContext compression;
+        };
+
+        FakeServerConfig config;
+
+        asio::io_service io_service;
+        asio::ip::tcp::acceptor acceptor;
+        asio::steady_timer tick_timer;
+        asio::io_service::strand tick_strand;
+        std::vector<std::thread> threads;
+        std::atomic<bool> stopping;
+
+        std::chrono::steady_clock::time_point start_time;
+        std::atomic<int> next_entity_id;
+
+        NBT registry;
+        NBT heightmaps;
+        // Flat world chunk, used if there is no config.world
+        std::vector<unsigned char> chunk_data;
+        int world_min_y;
+        int world_height;
+        std::mutex world_mutex;
+        std::map<std::pair<int, int>, std::shared_ptr<Chunk> > world_chunks;
+        std::mutex chunk_frames_mutex;
+        std::map<std::pair<int, int>, Frame> chunk_frames;
+
+        std::mutex sessions_mutex;
+        std::set<std::shared_ptr<Session> > sessions;
+
+        std::mutex mobs_mutex;
+        std::vector<Mob> mobs;
+        double mob_move_budget = 0.0;
+        std::mt19937 random_engine;
+        // Only used on tick_strand
+        CompressionContext tick_compression;
+
+        mutable std::mutex stats_mutex;
+        std::atomic<unsigned long long> stats_connections{ 0 };
+        std::atomic<unsigned long long> stats_players{ 0 };
+        unsigned long long stats_packets_sent = 0;
+        unsigned long long stats_bytes_sent = 0;
+        unsigned long long stats_keep_alive_answers = 0;
+        double stats_keep_alive_rtt_sum_ms = 0.0;
+        double stats_max_keep_alive_rtt_ms = 0.0;
+        unsigned long long stats_slow_players_dropped = 0;
+        unsigned long long stats_block_changes = 0;
+    };
+
+    FakeServer::FakeServer(const FakeServerConfig& config)
+    {
+        impl = std::make_unique<Impl>(config);
+    }
+
+    FakeServer::~FakeServer()
+    {
+
+    }
+
+    const FakeServerStats FakeServer::GetStats() const
+    {
+        FakeServerStats output;
+        output.connections = impl->stats_connections;
+        output.players = impl->stats_players;
+        std::lock_guard<std::mutex> lock(impl->stats_mutex);
+        output.packets_sent = impl->stats_packets_sent;
+        output.bytes_sent = impl->stats_bytes_sent;
+        output.keep_alive_answers = impl->stats_keep_alive_answers;
+        output.mean_keep_alive_rtt_ms = impl->stats_keep_alive_answers == 0 ? 0.0 : impl->stats_keep_alive_rtt_sum_ms / impl->stats_keep_alive_answers;
+        output.max_keep_alive_rtt_ms = impl->stats_max_keep_alive_rtt_ms;
+        output.slow_players_dropped = impl->stats_slow_players_dropped;
+        output.block_changes = impl->stats_block_changes;
+        return output;
+    }
+#else
+    struct FakeServer::Impl
+    {
+
+    };
+
+    FakeServer::FakeServer(const FakeServerConfig& config)
+    {
+        throw std::runtime_error("FakeServer is only available for game version 1.19");
+    }
+
+    FakeServer::~FakeServer()
+    {
+
+    }
+
+    const FakeServerStats FakeServer::GetStats() const
+    {
+        return FakeServerStats();
+    }
+#endif
+} // Botcraft
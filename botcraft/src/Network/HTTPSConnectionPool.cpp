@@ -0,0 +1,170 @@
+#ifdef USE_ENCRYPTION
+
+#include "botcraft/Network/HTTPSConnectionPool.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+namespace Botcraft
+{
+    HTTPSConnection::HTTPSConnection(asio::io_context& io_context, asio::ssl::context& ssl_context, const std::string& host_) :
+        host(host_), stream(io_context, ssl_context)
+    {
+        last_used = std::chrono::steady_clock::now();
+        reused = false;
+    }
+
+    HTTPSConnectionPool::HTTPSConnectionPool() : ssl_context(asio::ssl::context::sslv23)
+    {
+        ssl_context.set_default_verify_paths();
+        ssl_context.set_options(asio::ssl::context::default_workarounds | asio::ssl::context::verify_none);
+
+        // Sessions are stored by OnNewSession, indexed by host
+        SSL_CTX_set_app_data(ssl_context.native_handle(), this);
+        SSL_CTX_set_session_cache_mode(ssl_context.native_handle(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ssl_context.native_handle(), &HTTPSConnectionPool::OnNewSession);
+    }
+
+    HTTPSConnectionPool::~HTTPSConnectionPool()
+    {
+        Clear();
+    }
+
+    HTTPSConnectionPool& HTTPSConnectionPool::GetInstance()
+    {
+        static HTTPSConnectionPool instance;
+
+        return instance;
+    }
+
+    std::unique_ptr<HTTPSConnection> HTTPSConnectionPool::Acquire(const std::string& host)
+    {
+        SSL_SESSION* session = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            auto it = idle_connections.find(host);
+            if (it != idle_connections.end())
+            {
+                const auto now = std::chrono::steady_clock::now();
+                // Most recently released connections are at the back
+                while (!it->second.empty())
+                {
+                    std::unique_ptr<HTTPSConnection> connection = std::move(it->second.back());
+                    it->second.pop_back();
+                    if (now - connection->last_used < idle_timeout)
+                    {
+                        return connection;
+                    }
+                }
+            }
+
+            auto session_it = sessions.find(host);
+            if (session_it != sessions.end())
+            {
+                session = session_it->second;
+                SSL_SESSION_up_ref(session);
+            }
+        }
+
+        std::unique_ptr<HTTPSConnection> connection = std::make_unique<HTTPSConnection>(io_context, ssl_context, host);
+        connection->stream.set_verify_mode(asio::ssl::verify_none);
+        connection->stream.set_verify_callback([](bool, asio::ssl::verify_context&) {return true; });
+        SSL_set_tlsext_host_name(connection->stream.native_handle(), host.c_str());
+        if (session != nullptr)
+        {
+            SSL_set_session(connection->stream.native_handle(), session);
+            SSL_SESSION_free(session);
+        }
+
+        try
+        {
+            asio::connect(connection->stream.lowest_layer(), GetEndpoints(host, false));
+        }
+        catch (const asio::system_error&)
+        {
+            // Cached endpoints may be outdated, try again with fresh ones
+            connection->stream.lowest_layer().close();
+            asio::connect(connection->stream.lowest_layer(), GetEndpoints(host, true));
+        }
+        connection->stream.lowest_layer().set_option(asio::ip::tcp::no_delay(true));
+        connection->stream.handshake(connection->stream.client);
+
+        return connection;
+    }
+
+    void HTTPSConnectionPool::Release(std::unique_ptr<HTTPSConnection>&& connection)
+    {
+        if (connection == nullptr)
+        {
+            return;
+        }
+
+        connection->last_used = std::chrono::steady_clock::now();
+        connection->reused = true;
+
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        std::vector<std::unique_ptr<HTTPSConnection> >& host_connections = idle_connections[connection->host];
+        if (host_connections.size() >= max_idle_per_host)
+        {
+            // Drop the oldest one
+            host_connections.erase(host_connections.begin());
+        }
+        host_connections.push_back(std::move(connection));
+    }
+
+    void HTTPSConnectionPool::Clear()
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        idle_connections.clear();
+        for (auto& p : sessions)
+        {
+            SSL_SESSION_free(p.second);
+        }
+        sessions.clear();
+        endpoints.clear();
+    }
+
+    asio::ip::tcp::resolver::results_type HTTPSConnectionPool::GetEndpoints(const std::string& host, const bool force_resolve)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (!force_resolve)
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            auto it = endpoints.find(host);
+            if (it != endpoints.end() && now - it->second.first < endpoints_timeout)
+            {
+                return it->second.second;
+            }
+        }
+
+        // Resolve without holding the lock, it can take some time
+        asio::ip::tcp::resolver resolver(io_context);
+        asio::ip::tcp::resolver::results_type results = resolver.resolve(host, "https");
+
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        endpoints[host] = { now, results };
+        return results;
+    }
+
+    int HTTPSConnectionPool::OnNewSession(SSL* ssl, SSL_SESSION* session)
+    {
+        const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+        HTTPSConnectionPool* pool = static_cast<HTTPSConnectionPool*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+        if (host == nullptr || pool == nullptr)
+        {
+            // Let OpenSSL free the session
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(pool->pool_mutex);
+        SSL_SESSION*& stored = pool->sessions[host];
+        if (stored != nullptr)
+        {
+            SSL_SESSION_free(stored);
+        }
+        stored = session;
+
+        // We keep the reference OpenSSL gave us
+        return 1;
+    }
+} // Botcraft
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdexcept>
+#include <algorithm>
+
+#include "botcraft/Network/IOContextPool.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+
+namespace Botcraft
+{
+    IOContextPool::IOContextPool()
+    {
+        next_io_service = 0;
+        running = false;
+    }
+
+    IOContextPool::~IOContextPool()
+    {
+        Stop();
+    }
+
+    IOContextPool& IOContextPool::GetInstance()
+    {
+        static IOContextPool instance;
+
+        return instance;
+    }
+
+    void IOContextPool::Start(const unsigned int num_threads)
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (running)
+        {
+            return;
+        }
+
+        unsigned int pool_size = num_threads;
+        if (pool_size == 0)
+        {
+            pool_size = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        io_services.reserve(pool_size);
+        works.reserve(pool_size);
+        threads.reserve(pool_size);
+        for (unsigned int i = 0; i < pool_size; ++i)
+        {
+            io_services.emplace_back(new asio::io_service());
+            // Keep the io_service running even if there is no connection attached
+            works.emplace_back(new asio::io_service::work(*io_services.back()));
+        }
+
+        const size_t num_groups = AffinityGroups::GetInstance().GetNumGroups();
+        group_io_services = std::vector<std::vector<size_t> >(num_groups);
+        for (unsigned int i = 0; i < pool_size; ++i)
+        {
+            asio::io_service* io_service = io_services[i].get();
+            const int group = num_groups > 0 ? static_cast<int>(i % num_groups) : -1;
+            if (group != -1)
+            {
+                group_io_services[group].push_back(i);
+            }
+            threads.emplace_back([io_service, group]
+                {
+                    AffinityGroups::GetInstance().JoinGroup(group);
+                    io_service->run();
+                });
+            Logger::GetInstance().RegisterThread(threads.back().get_id(), "NetworkIOPool" + std::to_string(i));
+        }
+
+        next_io_service = 0;
+        running = true;
+        LOG_INFO("Shared network IO pool started with " << pool_size << " thread" << (pool_size > 1 ? "s" : "")
+            << (num_groups > 0 ? " in " + std::to_string(num_groups) + " affinity groups" : ""));
+    }
+
+    void IOContextPool::Stop()
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!running)
+        {
+            return;
+        }
+        running = false;
+
+        // Let the io_service finish the remaining work before stopping
+        works.clear();
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            if (threads[i].joinable())
+            {
+                Logger::GetInstance().UnregisterThread(threads[i].get_id());
+                threads[i].join();
+            }
+        }
+        threads.clear();
+        io_services.clear();
+        group_io_services.clear();
+    }
+
+    const bool IOContextPool::IsRunning() const
+    {
+        return running;
+    }
+
+    asio::io_service& IOContextPool::GetIOService()
+    {
+        if (!running)
+        {
+            throw(std::runtime_error("Trying to get an io_service from a stopped IOContextPool"));
+        }
+        const int group = AffinityGroups::GetCurrentGroup();
+        // A group can have no thread if there are more groups than threads
+        if (group >= 0 && group < static_cast<int>(group_io_services.size()) && !group_io_services[group].empty())
+        {
+            const std::vector<size_t>& indices = group_io_services[group];
+            return *io_services[indices[next_io_service++ % indices.size()]];
+        }
+        return *io_services[next_io_service++ % io_services.size()];
+    }
+} // Botcraft
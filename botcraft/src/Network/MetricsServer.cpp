@@ -0,0 +1,110 @@
+#include <thread>
+#include <asio.hpp>
+
+#include "botcraft/Network/MetricsServer.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+namespace Botcraft
+{
+    struct MetricsServer::Impl
+    {
+        Impl(const unsigned short port, const std::function<std::string()>& collect_, const std::string& address)
+            : acceptor(io_service, asio::ip::tcp::endpoint(asio::ip::make_address(address), port)), collect(collect_)
+        {
+            Accept();
+            thread = std::thread([this]()
+                {
+                    Logger::GetInstance().RegisterThread("MetricsServer");
+                    io_service.run();
+                });
+        }
+
+        ~Impl()
+        {
+            io_service.stop();
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+
+        void Accept()
+        {
+            std::shared_ptr<asio::ip::tcp::socket> socket = std::make_shared<asio::ip::tcp::socket>(io_service);
+            acceptor.async_accept(*socket, [this, socket](const asio::error_code& error)
+                {
+                    if (!error)
+                    {
+                        ReadRequest(socket);
+                    }
+                    if (error != asio::error::operation_aborted)
+                    {
+                        Accept();
+                    }
+                });
+        }
+
+        void ReadRequest(const std::shared_ptr<asio::ip::tcp::socket>& socket)
+        {
+            std::shared_ptr<asio::streambuf> request = std::make_shared<asio::streambuf>(max_request_size);
+            asio::async_read_until(*socket, *request, "\r\n\r\n", [this, socket, request](const asio::error_code& error, std::size_t)
+                {
+                    if (error)
+                    {
+                        return;
+                    }
+
+                    std::istream request_stream(request.get());
+                    std::string method;
+                    request_stream >> method;
+
+                    std::string body;
+                    std::string status = "200 OK";
+                    if (method != "GET")
+                    {
+                        status = "405 Method Not Allowed";
+                    }
+                    else
+                    {
+                        try
+                        {
+                            body = collect();
+                        }
+                        catch (const std::exception& e)
+                        {
+                            LOG_ERROR("Error collecting metrics: " << e.what());
+                            status = "500 Internal Server Error";
+                        }
+                    }
+
+                    std::shared_ptr<std::string> response = std::make_shared<std::string>(
+                        "HTTP/1.1 " + status + "\r\n"
+                        "Content-Type: text/plain; version=0.0.4\r\n"
+                        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                        "Connection: close\r\n\r\n" + body);
+                    asio::async_write(*socket, asio::buffer(*response), [socket, response](const asio::error_code&, std::size_t)
+                        {
+                            asio::error_code ignored;
+                            socket->shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+                        });
+                });
+        }
+
+        static constexpr size_t max_request_size = 8192;
+
+        asio::io_service io_service;
+        asio::ip::tcp::acceptor acceptor;
+        std::function<std::string()> collect;
+        std::thread thread;
+    };
+
+    MetricsServer::MetricsServer(const unsigned short port, const std::function<std::string()>& collect_, const std::string& address)
+    {
+        impl = std::make_unique<Impl>(port, collect_, address);
+    }
+
+    MetricsServer::~MetricsServer()
+    {
+
+    }
+} // Botcraft
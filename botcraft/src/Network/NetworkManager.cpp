@@ -1,23 +1,77 @@
+#include <array>
 #include <functional>
+#include <algorithm>
 
 #include "botcraft/Network/NetworkManager.hpp"
 #include "botcraft/Network/TCP_Com.hpp"
+#include "botcraft/Network/IOContextPool.hpp"
 #include "botcraft/Network/Authentifier.hpp"
 #include "botcraft/Network/AESEncrypter.hpp"
+#include "botcraft/Network/PacketCapture.hpp"
+#include "botcraft/Game/Entities/EntityManager.hpp"
 #include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
 
 #if USE_COMPRESSION
 #include "botcraft/Network/Compression.hpp"
+#include "botcraft/Network/DecompressionPool.hpp"
 #endif
 
 #include "protocolCraft/BinaryReadWrite.hpp"
 #include "protocolCraft/MessageFactory.hpp"
 
+namespace
+{
+    /// @brief Min size of a received packet to decompress it in the
+    /// DecompressionPool, smaller ones are not worth the thread switch
+    constexpr size_t min_pool_decompression_size = 2048;
+
+    /// @brief Write a VarInt so that it ends right before a given position
+    /// @param value Value to write
+    /// @param end Position right after the last byte of the VarInt
+    /// @return Pointer to the first byte of the VarInt
+    unsigned char* WriteVarIntBefore(const int value, unsigned char* end)
+    {
+        unsigned char bytes[5];
+        size_t num_bytes = 0;
+        unsigned int remaining = static_cast<unsigned int>(value);
+        do
+        {
+            bytes[num_bytes] = remaining & 0x7F;
+            remaining >>= 7;
+            if (remaining != 0)
+            {
+                bytes[num_bytes] |= 0x80;
+            }
+            num_bytes += 1;
+        } while (remaining != 0);
+
+        unsigned char* start = end - num_bytes;
+        std::copy(bytes, bytes + num_bytes, start);
+        return start;
+    }
+
+    /// @brief Duration between two time points in ms, -1 if one of them is not set
+    double ElapsedMs(const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end)
+    {
+        if (start == std::chrono::steady_clock::time_point() || end == std::chrono::steady_clock::time_point())
+        {
+            return -1.0;
+        }
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
 namespace Botcraft
 {
+    std::atomic<bool> NetworkManager::process_packets_on_io_threads(false);
+
     NetworkManager::NetworkManager(const std::string& address, const std::string& login, const std::string& password, const bool force_microfost_auth)
     {
         com = nullptr;
+        connection_start = std::chrono::steady_clock::now();
+        encryption_ms = 0.0;
 
         // Online mode with Microsoft login flow
         if (login.empty() || force_microfost_auth)
@@ -45,20 +99,108 @@ namespace Botcraft
             authentifier = nullptr;
             name = login;
         }
+        auth_ms = authentifier == nullptr ? 0.0 : ElapsedMs(connection_start, std::chrono::steady_clock::now());
+
+        compression = -1;
+        use_message_pool = false;
+        entity_movement_manager = nullptr;
+        capturing = false;
+        max_priority_queue_depth = 0;
+        max_normal_queue_depth = 0;
+        max_queued_packets = 0;
+        reading_paused = false;
+        read_pauses = 0;
+        max_queue_lag_ms = 0.0;
+        queued_bytes = 0;
+        priority_lane_enabled = false;
+        send_flush_delay = std::chrono::microseconds(0);
+        // Play ids are all < 0x80
+        priority_packets = std::vector<char>(0x80, 0);
+        priority_packets[ProtocolCraft::ClientboundKeepAlivePacket().GetId()] = 1;
+        priority_packets[ProtocolCraft::ClientboundPlayerPositionPacket().GetId()] = 1;
+#ifdef USE_COMPRESSION
+        compression_context = std::make_unique<CompressionContext>();
+#endif
+
+        Start(address);
+    }
+
+    NetworkManager::NetworkManager(const std::string& address, NetworkManager& previous)
+    {
+        com = nullptr;
+        connection_start = std::chrono::steady_clock::now();
+        auth_ms = 0.0;
+        encryption_ms = 0.0;
+
+        // Close the previous connection first, so its buffers
+        // can be taken without any thread using them
+        previous.Stop();
+
+        // Same account, no need to authenticate again
+        authentifier = previous.authentifier;
+        name = previous.name;
 
         compression = -1;
+        capturing = false;
+        max_priority_queue_depth = 0;
+        max_normal_queue_depth = 0;
+        reading_paused = false;
+        read_pauses = 0;
+        max_queue_lag_ms = 0.0;
+        queued_bytes = 0;
+        priority_lane_enabled = false;
+
+        // Like the handlers, the fast path must be set again
+        entity_movement_manager = nullptr;
+
+        // Keep the settings of the previous connection
+        use_message_pool = previous.use_message_pool;
+        ignored_packets = previous.ignored_packets;
+        priority_packets = previous.priority_packets;
+        max_queued_packets = previous.max_queued_packets;
+        send_flush_delay = previous.send_flush_delay;
+
+        // Reuse the allocated memory of the previous connection
+        message_pool = std::move(previous.message_pool);
+        send_buffer = std::move(previous.send_buffer);
+        compressed_send_buffer = std::move(previous.compressed_send_buffer);
+#ifdef USE_COMPRESSION
+        uncompressed_packet = std::move(previous.uncompressed_packet);
+        // zlib streams are reset for each packet, so they can be used
+        // for the new connection, with the same compression level
+        compression_context = std::move(previous.compression_context);
+#endif
+
+        Start(address);
+    }
+
+    void NetworkManager::Start(const std::string& address)
+    {
         AddHandler(this);
 
         state = ProtocolCraft::ConnectionState::Handshake;
 
-        //Start the thread to process the incoming packets
-        m_thread_process = std::thread(&NetworkManager::WaitForNewPackets, this);
+        // Start the thread to process the incoming packets, unless
+        // they are processed directly by the shared IO threads
+        process_on_io_thread = process_packets_on_io_threads && IOContextPool::GetInstance().IsRunning();
+        if (!process_on_io_thread)
+        {
+            // Stay in the affinity group of the thread creating the connection
+            const int group = AffinityGroups::GetCurrentGroup();
+            m_thread_process = std::thread([this, group]()
+                {
+                    AffinityGroups::GetInstance().JoinGroup(group);
+                    WaitForNewPackets();
+                });
+        }
 
+        // Packets sent before the connection is established are
+        // queued by TCP_Com and written as soon as it's connected
         com = std::shared_ptr<TCP_Com>(new TCP_Com(address, std::bind(&NetworkManager::OnNewRawData, this, std::placeholders::_1)));
-
-        //Let some time to initialize the communication before actually send data
-        // TODO: make this in a cleaner way?
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (send_flush_delay.count() > 0)
+        {
+            com->SetFlushDelay(send_flush_delay);
+        }
 
         std::shared_ptr<ProtocolCraft::ServerboundClientIntentionPacket> handshake_msg(new ProtocolCraft::ServerboundClientIntentionPacket);
         handshake_msg->SetProtocolVersion(PROTOCOL_VERSION);
@@ -81,9 +223,31 @@ namespace Botcraft
     NetworkManager::NetworkManager(const ProtocolCraft::ConnectionState constant_connection_state)
     {
         state = constant_connection_state;
+        connection_start = std::chrono::steady_clock::now();
+        auth_ms = 0.0;
+        encryption_ms = 0.0;
+        use_message_pool = false;
+        entity_movement_manager = nullptr;
+        process_on_io_thread = false;
+        capturing = false;
+        compression = -1;
+        max_priority_queue_depth = 0;
+        max_normal_queue_depth = 0;
+        max_queued_packets = 0;
+        reading_paused = false;
+        read_pauses = 0;
+        max_queue_lag_ms = 0.0;
+        queued_bytes = 0;
+        priority_lane_enabled = false;
+        send_flush_delay = std::chrono::microseconds(0);
     }
 
     NetworkManager::~NetworkManager()
+    {
+        Stop();
+    }
+
+    void NetworkManager::Stop()
     {
         state = ProtocolCraft::ConnectionState::None;
 
@@ -100,7 +264,14 @@ namespace Botcraft
         }
         compression = -1;
 
-        com.reset();
+        // Taken under mutex_send so a thread sending a message on a stopped connection
+        // doesn't use it. Destroyed without the lock as it waits for its pending operations
+        std::shared_ptr<TCP_Com> stopped_com;
+        {
+            std::lock_guard<std::mutex> lock(mutex_send);
+            stopped_com.swap(com);
+        }
+        stopped_com.reset();
     }
 
     void NetworkManager::AddHandler(ProtocolCraft::Handler* h)
@@ -108,32 +279,117 @@ namespace Botcraft
         subscribed.push_back(h);
     }
 
+    void NetworkManager::AddFilteredHandler(ProtocolCraft::Handler* h, const int id, const std::type_info& type)
+    {
+        if (id < 0)
+        {
+            return;
+        }
+        if (id >= filtered_subscribed.size())
+        {
+            filtered_subscribed.resize(id + 1);
+        }
+        filtered_subscribed[id].push_back({ std::type_index(type), h });
+    }
+
+    void NetworkManager::SetEntityMovementFastPath(EntityManager* entity_manager)
+    {
+        FlushEntityMovements();
+        entity_movement_manager = entity_manager;
+        move_entity_pos_id = ProtocolCraft::ClientboundMoveEntityPacketPos().GetId();
+        move_entity_pos_rot_id = ProtocolCraft::ClientboundMoveEntityPacketPosRot().GetId();
+        move_entity_rot_id = ProtocolCraft::ClientboundMoveEntityPacketRot().GetId();
+        teleport_entity_id = ProtocolCraft::ClientboundTeleportEntityPacket().GetId();
+    }
+
+    void NetworkManager::ClearMessagesFilter()
+    {
+        ignored_packets.clear();
+    }
+
+    void NetworkManager::SetPacketIgnored(const int id, const bool ignored)
+    {
+        if (id < 0)
+        {
+            return;
+        }
+        if (id >= ignored_packets.size())
+        {
+            ignored_packets.resize(id + 1, 0);
+        }
+        ignored_packets[id] = ignored;
+    }
+
+    const bool NetworkManager::IsPriorityPacket(const std::vector<unsigned char>& packet) const
+    {
+        if (state != ProtocolCraft::ConnectionState::Play || !priority_lane_enabled || packet.empty())
+        {
+            return false;
+        }
+
+        ProtocolCraft::ReadIterator iter = packet.data();
+        size_t length = packet.size();
+        if (compression != -1)
+        {
+            // Compressed packet, we can't know its id without decompressing it
+            if (ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length) != 0 || length == 0)
+            {
+                return false;
+            }
+        }
+        const int packet_id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+        return packet_id >= 0
+            && packet_id < priority_packets.size()
+            && priority_packets[packet_id];
+    }
+
+    const bool NetworkManager::IsPacketIgnored(const int packet_id) const
+    {
+        return state == ProtocolCraft::ConnectionState::Play
+            && packet_id >= 0
+            && packet_id < ignored_packets.size()
+            && ignored_packets[packet_id];
+    }
+
     void NetworkManager::Send(const std::shared_ptr<ProtocolCraft::Message> msg)
     {
+        std::lock_guard<std::mutex> lock(mutex_send);
         if (com)
         {
-            std::lock_guard<std::mutex> lock(mutex_send);
-            std::vector<unsigned char> msg_data;
-            msg->Write(msg_data);
+            // Leave some room before the message for the frame
+            // length and the compression prefix, so the frame
+            // can be built in place
+            send_buffer.resize(send_headroom);
+            msg->Write(send_buffer);
+            unsigned char* payload = send_buffer.data() + send_headroom;
+            const size_t uncompressed_size = send_buffer.size() - send_headroom;
             if (compression == -1)
             {
-                com->SendPacket(msg_data);
+                unsigned char* frame = WriteVarIntBefore(static_cast<int>(uncompressed_size), payload);
+                RecordSentPacket(msg->GetId(), uncompressed_size, uncompressed_size);
+                com->SendFrame(frame, send_buffer.data() + send_buffer.size() - frame);
             }
             else
             {
 #ifdef USE_COMPRESSION
-                if (msg_data.size() < compression)
+                if (uncompressed_size < compression)
                 {
-                    msg_data.insert(msg_data.begin(), 0x00);
-                    com->SendPacket(msg_data);
+                    // 0 data length for uncompressed packets
+                    payload -= 1;
+                    *payload = 0x00;
+                    unsigned char* frame = WriteVarIntBefore(static_cast<int>(uncompressed_size + 1), payload);
+                    RecordSentPacket(msg->GetId(), uncompressed_size, uncompressed_size + 1);
+                    com->SendFrame(frame, send_buffer.data() + send_buffer.size() - frame);
                 }
                 else
                 {
-                    std::vector<unsigned char> compressed_msg;
-                    ProtocolCraft::WriteData<ProtocolCraft::VarInt>(msg_data.size(), compressed_msg);
-                    std::vector<unsigned char> compressed_data = Compress(msg_data);
-                    compressed_msg.insert(compressed_msg.end(), compressed_data.begin(), compressed_data.end());
-                    com->SendPacket(compressed_msg);
+                    compressed_send_buffer.resize(send_headroom);
+                    ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(uncompressed_size), compressed_send_buffer);
+                    compression_context->Compress(payload, uncompressed_size, compressed_send_buffer);
+                    const size_t compressed_size = compressed_send_buffer.size() - send_headroom;
+                    unsigned char* frame = WriteVarIntBefore(static_cast<int>(compressed_size), compressed_send_buffer.data() + send_headroom);
+                    RecordSentPacket(msg->GetId(), uncompressed_size, compressed_size);
+                    com->SendFrame(frame, compressed_send_buffer.data() + compressed_send_buffer.size() - frame);
                 }
 #else
                 throw(std::runtime_error("Program compiled without ZLIB. Cannot send compressed message"));
@@ -142,11 +398,100 @@ namespace Botcraft
         }
     }
 
+    void NetworkManager::SetCompressionLevel(const int level)
+    {
+#ifdef USE_COMPRESSION
+        if (compression_context)
+        {
+            std::lock_guard<std::mutex> lock(mutex_send);
+            compression_context->SetCompressionLevel(level);
+        }
+#else
+        LOG_WARNING("Program compiled without USE_COMPRESSION, compression level is ignored");
+#endif
+    }
+
+    void NetworkManager::SetSendFlushDelay(const std::chrono::microseconds delay)
+    {
+        send_flush_delay = delay;
+        if (com)
+        {
+            com->SetFlushDelay(delay);
+        }
+    }
+
+    void NetworkManager::SetMaxQueuedPackets(const size_t max_packets)
+    {
+        bool resume_reading = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_process);
+            max_queued_packets = max_packets;
+            if (reading_paused && (max_queued_packets == 0 ||
+                priority_packets_to_process.size() + packets_to_process.size() <= max_queued_packets / 2))
+            {
+                reading_paused = false;
+                resume_reading = true;
+            }
+        }
+        if (resume_reading && com)
+        {
+            com->ResumeReading();
+        }
+    }
+
+    void NetworkManager::SetMessagePooling(const bool b)
+    {
+        use_message_pool = b;
+    }
+
+    void NetworkManager::StartSharedIOPool(const unsigned int num_threads)
+    {
+        IOContextPool::GetInstance().Start(num_threads);
+    }
+
+    void NetworkManager::StopSharedIOPool()
+    {
+        IOContextPool::GetInstance().Stop();
+    }
+
+    void NetworkManager::SetProcessPacketsOnIOThreads(const bool b)
+    {
+        process_packets_on_io_threads = b;
+    }
+
+    void NetworkManager::StartDecompressionPool(const unsigned int num_threads)
+    {
+#ifdef USE_COMPRESSION
+        DecompressionPool::GetInstance().Start(num_threads);
+#else
+        LOG_WARNING("Program compiled without USE_COMPRESSION, decompression pool is not started");
+#endif
+    }
+
+    void NetworkManager::StopDecompressionPool()
+    {
+#ifdef USE_COMPRESSION
+        DecompressionPool::GetInstance().Stop();
+#endif
+    }
+
+    size_t NetworkManager::PreAuthenticateMicrosoft(const std::vector<std::string>& logins, const unsigned int max_parallel,
+        const std::chrono::milliseconds min_interval)
+    {
+        return Authentifier::AuthMicrosoftBatch(logins, max_parallel, min_interval);
+    }
+
     const ProtocolCraft::ConnectionState NetworkManager::GetConnectionState() const
     {
         return state;
     }
 
+    const bool NetworkManager::WaitForConnectionState(const ProtocolCraft::ConnectionState s, const std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex_state);
+        return state_condition.wait_for(lock, timeout, [this, s] { return state == s; });
+    }
+
     const std::string& NetworkManager::GetMyName() const
     {
         return name;
@@ -157,87 +502,549 @@ namespace Botcraft
         Logger::GetInstance().RegisterThread("NetworkPacketProcessing");
         while (state != ProtocolCraft::ConnectionState::None)
         {
+            // Don't keep movements waiting for a packet that may not come soon
+            if (!pending_movements.empty())
             {
-                std::unique_lock<std::mutex> lck(mutex_process);
-                process_condition.wait(lck);
+                bool idle = false;
+                {
+                    std::lock_guard<std::mutex> lck(mutex_process);
+                    idle = priority_packets_to_process.empty() && packets_to_process.empty();
+                }
+                if (idle)
+                {
+                    FlushEntityMovements();
+                }
             }
-            while (!packets_to_process.empty())
+
+            std::vector<unsigned char> packet;
+#if USE_COMPRESSION
+            std::shared_ptr<DecompressionJob> job;
+#endif
+            std::chrono::steady_clock::time_point received;
+            bool priority = false;
+            bool resume_reading = false;
             {
-                std::vector<unsigned char> packet;
-                { // process_guard scope
-                    std::lock_guard<std::mutex> process_guard(mutex_process);
-                    if (!packets_to_process.empty())
-                    {
-                        packet = packets_to_process.front();
-                        packets_to_process.pop();
-                    }
+                std::unique_lock<std::mutex> lck(mutex_process);
+                process_condition.wait(lck, [this]() {
+                    return state == ProtocolCraft::ConnectionState::None ||
+                        !priority_packets_to_process.empty() ||
+                        !packets_to_process.empty();
+                });
+                // Priority lane is always emptied first
+                if (!priority_packets_to_process.empty())
+                {
+                    packet = std::move(priority_packets_to_process.front().data);
+                    received = priority_packets_to_process.front().received;
+                    queued_bytes -= priority_packets_to_process.front().size;
+                    priority_packets_to_process.pop();
+                    priority = true;
                 }
-                if (packet.size() > 0)
+                else if (!packets_to_process.empty())
                 {
-                    if (compression == -1)
-                    {
-                        ProcessPacket(packet);
-                    }
-                    else
-                    {
+                    packet = std::move(packets_to_process.front().data);
+                    received = packets_to_process.front().received;
+#if USE_COMPRESSION
+                    job = std::move(packets_to_process.front().job);
+#endif
+                    queued_bytes -= packets_to_process.front().size;
+                    packets_to_process.pop();
+                }
+                if (packet.size() > 0
+#if USE_COMPRESSION
+                    || job
+#endif
+                    )
+                {
+                    max_queue_lag_ms = std::max(max_queue_lag_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - received).count());
+                }
+                // Restart reading when half of the queue has been processed
+                if (reading_paused && (priority_packets_to_process.size() + packets_to_process.size()) <= max_queued_packets / 2)
+                {
+                    reading_paused = false;
+                    resume_reading = true;
+                }
+            }
+            if (resume_reading && com)
+            {
+                com->ResumeReading();
+            }
+            if (priority)
+            {
+                std::lock_guard<std::mutex> lock(mutex_stats);
+                stats.packets_priority += 1;
+            }
+#if USE_COMPRESSION
+            if (job)
+            {
+                ProcessDecompressionJob(*job);
+                continue;
+            }
+#endif
+            if (packet.size() > 0)
+            {
+                ProcessRawPacket(packet);
+            }
+        }
+    }
+
+    const ConnectionTimings NetworkManager::GetConnectionTimings() const
+    {
+        ConnectionTimings timings;
+        if (authentifier != nullptr)
+        {
+            timings.auth_requests = authentifier->GetRequestTimings();
+        }
+        TCP_ComTimings tcp_timings;
+        if (com != nullptr)
+        {
+            tcp_timings = com->GetTimings();
+        }
+        timings.srv_lookup_ms = ElapsedMs(tcp_timings.start, tcp_timings.srv_lookup_end);
+        timings.dns_ms = ElapsedMs(tcp_timings.srv_lookup_end, tcp_timings.resolve_end);
+        timings.tcp_connect_ms = ElapsedMs(tcp_timings.resolve_end, tcp_timings.connect_end);
+
+        std::lock_guard<std::mutex> lock(mutex_stats);
+        timings.start = connection_start;
+        timings.auth_ms = auth_ms;
+        timings.login_ms = ElapsedMs(tcp_timings.connect_end, login_end);
+        timings.encryption_ms = encryption_ms;
+        return timings;
+    }
+
+    const NetworkStats NetworkManager::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_stats);
+        NetworkStats output = stats;
+        {
+            std::lock_guard<std::mutex> lock_process(mutex_process);
+            output.priority_queue_depth = priority_packets_to_process.size();
+            output.normal_queue_depth = packets_to_process.size();
+            output.max_priority_queue_depth = max_priority_queue_depth;
+            output.max_normal_queue_depth = max_normal_queue_depth;
+            output.max_queue_lag_ms = max_queue_lag_ms;
+            output.queued_bytes = queued_bytes;
+            output.read_pauses = read_pauses;
+            output.read_paused = reading_paused;
+        }
+        for (size_t i = 0; i < clientbound_stats.size(); ++i)
+        {
+            if (clientbound_stats[i].count > 0)
+            {
+                output.clientbound[static_cast<int>(i)] = clientbound_stats[i];
+            }
+        }
+        for (size_t i = 0; i < serverbound_stats.size(); ++i)
+        {
+            if (serverbound_stats[i].count > 0)
+            {
+                output.serverbound[static_cast<int>(i)] = serverbound_stats[i];
+            }
+        }
+        return output;
+    }
+
+    bool NetworkManager::StartCapture(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mutex_capture);
+        try
+        {
+            capture = std::make_unique<PacketCaptureWriter>(path);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR(e.what());
+            capture.reset();
+            capturing = false;
+            return false;
+        }
+        capture_start = std::chrono::steady_clock::now();
+        capturing = true;
+        return true;
+    }
+
+    void NetworkManager::StopCapture()
+    {
+        std::lock_guard<std::mutex> lock(mutex_capture);
+        capturing = false;
+        capture.reset();
+    }
+
+    size_t NetworkManager::Replay(const std::string& path, const double speed)
+    {
+        PacketCaptureReader reader(path);
+        PacketCaptureRecord record;
+        size_t num_packets = 0;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (reader.Next(record))
+        {
+            if (speed > 0.0)
+            {
+                std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<long long int>(record.timestamp_us / speed)));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_state);
+                state = record.state;
+            }
+            state_condition.notify_all();
+
+            ProcessPacket(record.data);
+            num_packets += 1;
+        }
+        FlushEntityMovements();
+        return num_packets;
+    }
+
+    void NetworkManager::RecordSentPacket(const int packet_id, const size_t uncompressed_size, const size_t sent_size)
+    {
+        std::lock_guard<std::mutex> lock(mutex_stats);
+        stats.packets_out += 1;
+        stats.bytes_out += sent_size;
+        if (state != ProtocolCraft::ConnectionState::Play || packet_id < 0)
+        {
+            return;
+        }
+        if (packet_id >= serverbound_stats.size())
+        {
+            serverbound_stats.resize(packet_id + 1);
+        }
+        serverbound_stats[packet_id].count += 1;
+        serverbound_stats[packet_id].bytes += uncompressed_size;
+    }
+
+    void NetworkManager::ProcessRawPacket(const std::vector<unsigned char>& packet)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_stats);
+            stats.packets_in += 1;
+            stats.bytes_in += packet.size();
+        }
+
+        if (compression == -1)
+        {
+            ProcessPacket(packet);
+            return;
+        }
+
 #ifdef USE_COMPRESSION
-                        size_t length = packet.size();
-                        ProtocolCraft::ReadIterator iter = packet.begin();
-                        int data_length = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+        size_t length = packet.size();
+        ProtocolCraft::ReadIterator iter = packet.data();
+        int data_length = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
 
-                        //Packet not compressed
-                        if (data_length == 0)
-                        {
-                            //Erase the first 0
-                            packet.erase(packet.begin());
-                            ProcessPacket(packet);
-                        }
-                        //Packet compressed
-                        else
-                        {
-                            int size_varint = packet.size() - length;
+        //Packet not compressed
+        if (data_length == 0)
+        {
+            //Skip the first 0
+            ProcessPacket(packet, packet.size() - length);
+        }
+        //Packet compressed
+        else
+        {
+            const size_t size_varint = packet.size() - length;
 
-                            std::vector<unsigned char> uncompressed_msg = Decompress(packet, size_varint);
-                            ProcessPacket(uncompressed_msg);
-                        }
-#else
-                        throw(std::runtime_error("Program compiled without USE_COMPRESSION. Cannot read compressed message"));
-#endif
-                    }
+            // Only decompress the packet id first to check if we need it.
+            // Captures keep all the packets
+            if (!ignored_packets.empty() && !capturing)
+            {
+                // A VarInt id is at most 5 bytes, no need to allocate for it
+                std::array<unsigned char, 5> packet_id_data;
+                ProtocolCraft::ReadIterator id_iter = packet_id_data.data();
+                size_t id_length = compression_context->DecompressPrefix(packet.data() + size_varint, length, packet_id_data.data(), packet_id_data.size());
+                if (IsPacketIgnored(ProtocolCraft::ReadData<ProtocolCraft::VarInt>(id_iter, id_length)))
+                {
+                    std::lock_guard<std::mutex> lock(mutex_stats);
+                    stats.packets_ignored += 1;
+                    return;
                 }
             }
+
+            {
+                TRACE_ZONE("Decompress", "bytes", data_length);
+                compression_context->Decompress(packet.data() + size_varint, length, uncompressed_packet, data_length);
+            }
+            ProcessPacket(uncompressed_packet);
+        }
+#else
+        throw(std::runtime_error("Program compiled without USE_COMPRESSION. Cannot read compressed message"));
+#endif
+    }
+
+#if USE_COMPRESSION
+    void NetworkManager::ProcessDecompressionJob(DecompressionJob& job)
+    {
+        job.Wait();
+        if (job.error.empty() && job.output.empty())
+        {
+            // Not compressed after all
+            ProcessRawPacket(job.packet);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_stats);
+            stats.packets_in += 1;
+            stats.bytes_in += job.packet.size();
         }
+        if (!job.error.empty())
+        {
+            throw(std::runtime_error(job.error));
+        }
+        ProcessPacket(job.output);
     }
+#endif
 
-    void NetworkManager::ProcessPacket(const std::vector<unsigned char>& packet)
+    void NetworkManager::ProcessPacket(const std::vector<unsigned char>& packet, const size_t start)
     {
-        if (packet.empty())
+        if (packet.size() <= start)
         {
             return;
         }
 
-        std::vector<unsigned char>::const_iterator packet_iterator = packet.begin();
-        size_t length = packet.size();
+        if (capturing)
+        {
+            std::lock_guard<std::mutex> lock(mutex_capture);
+            if (capture)
+            {
+                capture->Write(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - capture_start).count(),
+                    state, packet.data() + start, packet.size() - start);
+            }
+        }
+
+        ProtocolCraft::ReadIterator packet_iterator = packet.data() + start;
+        size_t length = packet.size() - start;
 
         int packet_id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(packet_iterator, length);
 
-        std::shared_ptr<ProtocolCraft::Message> msg = ProtocolCraft::MessageFactory::CreateMessageClientbound(packet_id, state);
+        if (IsPacketIgnored(packet_id))
+        {
+            std::lock_guard<std::mutex> lock(mutex_stats);
+            stats.packets_ignored += 1;
+            return;
+        }
+
+        if (entity_movement_manager != nullptr && state == ProtocolCraft::ConnectionState::Play)
+        {
+            const std::chrono::steady_clock::time_point read_start = std::chrono::steady_clock::now();
+            if (ReadEntityMovement(packet_id, packet_iterator, length))
+            {
+                const std::chrono::steady_clock::time_point read_end = std::chrono::steady_clock::now();
+                std::lock_guard<std::mutex> lock(mutex_stats);
+                if (packet_id >= clientbound_stats.size())
+                {
+                    clientbound_stats.resize(packet_id + 1);
+                }
+                PacketStats& packet_stats = clientbound_stats[packet_id];
+                packet_stats.count += 1;
+                packet_stats.bytes += packet.size() - start;
+                packet_stats.read_time_ms += std::chrono::duration<double, std::milli>(read_end - read_start).count();
+                return;
+            }
+        }
+        // Movements must be applied before any other packet is dispatched
+        FlushEntityMovements();
+
+        TRACE_ZONE("ProcessPacket", "id", packet_id);
+
+        std::shared_ptr<ProtocolCraft::Message> msg = GetMessageInstance(packet_id);
 
         if (msg)
         {
+            // Handlers can change the state
+            const bool is_play = state == ProtocolCraft::ConnectionState::Play;
+            const size_t packet_size = packet.size() - start;
+            const std::chrono::steady_clock::time_point read_start = std::chrono::steady_clock::now();
             msg->Read(packet_iterator, length);
+            const std::chrono::steady_clock::time_point handle_start = std::chrono::steady_clock::now();
             for (int i = 0; i < subscribed.size(); i++)
             {
                 msg->Dispatch(subscribed[i]);
             }
+
+            if (packet_id >= 0 && packet_id < filtered_subscribed.size())
+            {
+                const std::vector<std::pair<std::type_index, ProtocolCraft::Handler*> >& handlers = filtered_subscribed[packet_id];
+                if (!handlers.empty())
+                {
+                    const std::type_index msg_type(typeid(*msg));
+                    for (int i = 0; i < handlers.size(); ++i)
+                    {
+                        if (handlers[i].first == msg_type)
+                        {
+                            msg->Dispatch(handlers[i].second);
+                        }
+                    }
+                }
+            }
+
+            if (is_play && packet_id >= 0)
+            {
+                const std::chrono::steady_clock::time_point handle_end = std::chrono::steady_clock::now();
+                std::lock_guard<std::mutex> lock(mutex_stats);
+                if (packet_id >= clientbound_stats.size())
+                {
+                    clientbound_stats.resize(packet_id + 1);
+                }
+                PacketStats& packet_stats = clientbound_stats[packet_id];
+                packet_stats.count += 1;
+                packet_stats.bytes += packet_size;
+                packet_stats.read_time_ms += std::chrono::duration<double, std::milli>(handle_start - read_start).count();
+                packet_stats.handle_time_ms += std::chrono::duration<double, std::milli>(handle_end - handle_start).count();
+            }
         }
     }
     
-    void NetworkManager::OnNewRawData(const std::vector<unsigned char>& packet)
+    bool NetworkManager::ReadEntityMovement(const int packet_id, ProtocolCraft::ReadIterator& iter, size_t& length)
+    {
+        EntityMovement movement;
+        if (packet_id == move_entity_pos_id)
+        {
+            movement.type = EntityMovement::Type::Pos;
+            movement.entity_id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            movement.xa = ProtocolCraft::ReadData<short>(iter, length);
+            movement.ya = ProtocolCraft::ReadData<short>(iter, length);
+            movement.za = ProtocolCraft::ReadData<short>(iter, length);
+        }
+        else if (packet_id == move_entity_pos_rot_id)
+        {
+            movement.type = EntityMovement::Type::PosRot;
+            movement.entity_id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            movement.xa = ProtocolCraft::ReadData<short>(iter, length);
+            movement.ya = ProtocolCraft::ReadData<short>(iter, length);
+            movement.za = ProtocolCraft::ReadData<short>(iter, length);
+            movement.y_rot = ProtocolCraft::ReadData<unsigned char>(iter, length);
+            movement.x_rot = ProtocolCraft::ReadData<unsigned char>(iter, length);
+        }
+        else if (packet_id == move_entity_rot_id)
+        {
+            movement.type = EntityMovement::Type::Rot;
+            movement.entity_id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            movement.y_rot = ProtocolCraft::ReadData<unsigned char>(iter, length);
+            movement.x_rot = ProtocolCraft::ReadData<unsigned char>(iter, length);
+        }
+        else if (packet_id == teleport_entity_id)
+        {
+            movement.type = EntityMovement::Type::Teleport;
+            movement.entity_id = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(iter, length);
+            movement.position.x = ProtocolCraft::ReadData<double>(iter, length);
+            movement.position.y = ProtocolCraft::ReadData<double>(iter, length);
+            movement.position.z = ProtocolCraft::ReadData<double>(iter, length);
+            movement.y_rot = ProtocolCraft::ReadData<unsigned char>(iter, length);
+            movement.x_rot = ProtocolCraft::ReadData<unsigned char>(iter, length);
+        }
+        else
+        {
+            return false;
+        }
+        movement.on_ground = ProtocolCraft::ReadData<bool>(iter, length);
+
+        pending_movements.push_back(movement);
+        // Bound the delay of the first movements of a long burst
+        if (pending_movements.size() >= 256)
+        {
+            FlushEntityMovements();
+        }
+        return true;
+    }
+
+    void NetworkManager::FlushEntityMovements()
+    {
+        if (pending_movements.empty())
+        {
+            return;
+        }
+        TRACE_ZONE("FlushEntityMovements", "count", static_cast<long long>(pending_movements.size()));
+        entity_movement_manager->ApplyMovements(pending_movements);
+        pending_movements.clear();
+    }
+
+    std::shared_ptr<ProtocolCraft::Message> NetworkManager::GetMessageInstance(const int packet_id)
     {
+        if (!use_message_pool || state != ProtocolCraft::ConnectionState::Play || packet_id < 0)
+        {
+            return ProtocolCraft::MessageFactory::CreateMessageClientbound(packet_id, state);
+        }
+
+        if (packet_id >= message_pool.size())
+        {
+            message_pool.resize(packet_id + 1);
+        }
+
+        std::shared_ptr<ProtocolCraft::Message>& pooled = message_pool[packet_id];
+        // Only reuse the instance if nobody else kept a reference to it
+        if (pooled && pooled.use_count() == 1)
+        {
+            pooled->Reset();
+        }
+        else
+        {
+            pooled = ProtocolCraft::MessageFactory::CreateMessageClientbound(packet_id, state);
+        }
+        return pooled;
+    }
+
+    bool NetworkManager::OnNewRawData(std::vector<unsigned char>&& packet)
+    {
+        if (process_on_io_thread)
+        {
+            // Already on the connection io thread, handlers
+            // of this connection are called one after the other
+            if (state != ProtocolCraft::ConnectionState::None && packet.size() > 0)
+            {
+                // Don't let one connection take down the IO thread shared with others
+                try
+                {
+                    ProcessRawPacket(packet);
+                    // No way to know when the next packet will come
+                    FlushEntityMovements();
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_ERROR("Error processing packet: " << e.what());
+                }
+            }
+            return true;
+        }
+
+        const bool priority = IsPriorityPacket(packet);
+        // Before data is moved to a decompression job
+        const size_t packet_size = packet.size();
+#if USE_COMPRESSION
+        // Compression can't be disabled once set, so if it's already
+        // known here, this packet starts with the data length VarInt.
+        // Otherwise, it's decompressed by the processing thread as usual
+        std::shared_ptr<DecompressionJob> job;
+        if (!priority && compression != -1 && packet.size() >= min_pool_decompression_size &&
+            DecompressionPool::GetInstance().IsRunning())
+        {
+            job = DecompressionPool::GetInstance().Submit(std::move(packet));
+        }
+#endif
         std::unique_lock<std::mutex> lck(mutex_process);
-        packets_to_process.push(packet);
+        if (priority)
+        {
+            priority_packets_to_process.push({ std::move(packet), std::chrono::steady_clock::now(), packet_size });
+            max_priority_queue_depth = std::max(max_priority_queue_depth, priority_packets_to_process.size());
+        }
+        else
+        {
+            packets_to_process.push({ std::move(packet), std::chrono::steady_clock::now(), packet_size });
+#if USE_COMPRESSION
+            packets_to_process.back().job = std::move(job);
+#endif
+            max_normal_queue_depth = std::max(max_normal_queue_depth, packets_to_process.size());
+        }
+        queued_bytes += packet_size;
         process_condition.notify_all();
+
+        // Too many packets waiting, stop reading until
+        // the processing thread catches up
+        if (max_queued_packets > 0 && priority_packets_to_process.size() + packets_to_process.size() >= max_queued_packets)
+        {
+            reading_paused = true;
+            read_pauses += 1;
+            return false;
+        }
+        return true;
     }
 
     void NetworkManager::Handle(ProtocolCraft::Message& msg)
@@ -252,7 +1059,20 @@ namespace Botcraft
 
     void NetworkManager::Handle(ProtocolCraft::ClientboundGameProfilePacket& msg)
     {
-        state = ProtocolCraft::ConnectionState::Play;
+        {
+            std::lock_guard<std::mutex> lock(mutex_stats);
+            login_end = std::chrono::steady_clock::now();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_state);
+            state = ProtocolCraft::ConnectionState::Play;
+        }
+        state_condition.notify_all();
+    }
+
+    void NetworkManager::Handle(ProtocolCraft::ClientboundLoginPacket& msg)
+    {
+        priority_lane_enabled = true;
     }
 
     void NetworkManager::Handle(ProtocolCraft::ClientboundHelloPacket& msg)
@@ -264,6 +1084,7 @@ namespace Botcraft
         }
 
 #ifdef USE_ENCRYPTION
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         std::shared_ptr<AESEncrypter> encrypter = std::shared_ptr<AESEncrypter>(new AESEncrypter());
 
         std::vector<unsigned char> encrypted_token;
@@ -283,6 +1104,9 @@ namespace Botcraft
 
         // Enable encryption from now on
         com->SetEncrypter(encrypter);
+
+        std::lock_guard<std::mutex> lock(mutex_stats);
+        encryption_ms = ElapsedMs(start, std::chrono::steady_clock::now());
 #else
         throw(std::runtime_error("Your version of botcraft doesn't support encryption. Either run your server with online-mode=false or recompile botcraft"));
 #endif
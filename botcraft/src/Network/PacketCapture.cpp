@@ -0,0 +1,91 @@
+#include "botcraft/Network/PacketCapture.hpp"
+
+#include <stdexcept>
+
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+namespace Botcraft
+{
+    static const std::string capture_file_magic = "BCPC";
+    // Timestamp, state and size
+    static const size_t record_header_size = sizeof(long long int) + sizeof(char) + sizeof(int);
+
+    PacketCaptureWriter::PacketCaptureWriter(const std::string& path) : file(path, std::ios::out | std::ios::binary)
+    {
+        if (!file.is_open())
+        {
+            throw(std::runtime_error("Can't create packet capture file " + path));
+        }
+
+        std::vector<unsigned char> header;
+        ProtocolCraft::WriteRawString(capture_file_magic, header);
+        ProtocolCraft::WriteData<int>(PROTOCOL_VERSION, header);
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    }
+
+    void PacketCaptureWriter::Write(const long long int timestamp_us, const ProtocolCraft::ConnectionState state, const unsigned char* data, const size_t size)
+    {
+        buffer.clear();
+        ProtocolCraft::WriteData<long long int>(timestamp_us, buffer);
+        ProtocolCraft::WriteData<char>(static_cast<char>(state), buffer);
+        ProtocolCraft::WriteData<int>(static_cast<int>(size), buffer);
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        file.write(reinterpret_cast<const char*>(data), size);
+    }
+
+    PacketCaptureReader::PacketCaptureReader(const std::string& path) : file(path, std::ios::in | std::ios::binary)
+    {
+        if (!file.is_open())
+        {
+            throw(std::runtime_error("Can't open packet capture file " + path));
+        }
+
+        std::vector<unsigned char> header(capture_file_magic.size() + sizeof(int));
+        file.read(reinterpret_cast<char*>(header.data()), header.size());
+        if (file.gcount() != header.size())
+        {
+            throw(std::runtime_error("Invalid packet capture file " + path));
+        }
+
+        ProtocolCraft::ReadIterator iter = header.data();
+        size_t length = header.size();
+        if (ProtocolCraft::ReadRawString(iter, length, capture_file_magic.size()) != capture_file_magic)
+        {
+            throw(std::runtime_error("Invalid packet capture file " + path));
+        }
+        const int protocol_version = ProtocolCraft::ReadData<int>(iter, length);
+        if (protocol_version != PROTOCOL_VERSION)
+        {
+            throw(std::runtime_error("Packet capture " + path + " was recorded with protocol " + std::to_string(protocol_version) +
+                " but botcraft is compiled for " + std::to_string(PROTOCOL_VERSION)));
+        }
+    }
+
+    bool PacketCaptureReader::Next(PacketCaptureRecord& record)
+    {
+        unsigned char header[record_header_size];
+        file.read(reinterpret_cast<char*>(header), record_header_size);
+        if (file.gcount() != record_header_size)
+        {
+            return false;
+        }
+
+        ProtocolCraft::ReadIterator iter = header;
+        size_t length = record_header_size;
+        record.timestamp_us = ProtocolCraft::ReadData<long long int>(iter, length);
+        record.state = static_cast<ProtocolCraft::ConnectionState>(ProtocolCraft::ReadData<char>(iter, length));
+        const int size = ProtocolCraft::ReadData<int>(iter, length);
+        if (size < 0)
+        {
+            throw(std::runtime_error("Invalid packet size in capture file"));
+        }
+
+        record.data.resize(size);
+        file.read(reinterpret_cast<char*>(record.data.data()), size);
+        if (file.gcount() != size)
+        {
+            throw(std::runtime_error("Truncated packet capture file"));
+        }
+        return true;
+    }
+} // Botcraft
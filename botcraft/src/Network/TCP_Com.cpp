@@ -1,67 +1,169 @@
+#include <algorithm>
 #include <functional>
 
 #include "protocolCraft/BinaryReadWrite.hpp"
 
-#include "botcraft/Network/DNS/DNSMessage.hpp"
-#include "botcraft/Network/DNS/DNSSrvData.hpp"
+#include "botcraft/Network/DNSCache.hpp"
 #include "botcraft/Network/TCP_Com.hpp"
+#include "botcraft/Network/IOContextPool.hpp"
 #ifdef USE_ENCRYPTION
 #include "botcraft/Network/AESEncrypter.hpp"
 #endif
 
 #include "botcraft/Utilities/Logger.hpp"
 #include "botcraft/Utilities/StringUtilities.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
 
 namespace Botcraft
 {
     TCP_Com::TCP_Com(const std::string &address,
-        std::function<void(const std::vector<unsigned char>&)> callback)
-        : socket(io_service)
+        std::function<bool(std::vector<unsigned char>&&)> callback,
+        const size_t read_size_)
+        : owned_io_service(IOContextPool::GetInstance().IsRunning() ? nullptr : new asio::io_service()),
+        io_service(owned_io_service ? *owned_io_service : IOContextPool::GetInstance().GetIOService()),
+        socket(io_service),
+        flush_timer(io_service)
     {
         NewPacketCallback = callback;
-
+        pending_operations = 0;
+        read_size = std::max(static_cast<size_t>(1), read_size_);
+        input_start = 0;
+        input_end = 0;
+        read_paused = false;
+        resume_requested = false;
+        write_scheduled = false;
+        flush_delay = std::chrono::microseconds(0);
+
+        timings.start = std::chrono::steady_clock::now();
         SetIPAndPortFromAddress(address);
+        timings.srv_lookup_end = std::chrono::steady_clock::now();
+
+        // Frames sent before the connection is established are
+        // queued, they will be written by handle_connect
+        write_scheduled = true;
 
-        asio::ip::tcp::resolver resolver(io_service);
-        asio::ip::tcp::resolver::query query(ip, std::to_string(port));
-        asio::ip::tcp::resolver::iterator iterator = resolver.resolve(query);
         LOG_INFO("Trying to connect to " << ip << ":" << port);
-        asio::async_connect(socket, iterator,
-            std::bind(&TCP_Com::handle_connect, this,
-            std::placeholders::_1));
+        StartOperation();
+        if (owned_io_service)
+        {
+            const asio::ip::tcp::resolver::results_type endpoints = DNSCache::GetInstance().Resolve(ip, port);
+            {
+                std::lock_guard<std::mutex> lock(mutex_timings);
+                timings.resolve_end = std::chrono::steady_clock::now();
+            }
+            asio::async_connect(socket, endpoints,
+                std::bind(&TCP_Com::handle_connect, this,
+                std::placeholders::_1));
+        }
+        // Resolve on the shared io_service, it outlives us
+        else
+        {
+            DNSCache::GetInstance().AsyncResolve(io_service, ip, port,
+                [this](const asio::error_code& error, const asio::ip::tcp::resolver::results_type& endpoints)
+                {
+                    if (error)
+                    {
+                        LOG_ERROR("Error when resolving " << ip << ":" << port << ". Error code :" << error);
+                        EndOperation();
+                        return;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_timings);
+                        timings.resolve_end = std::chrono::steady_clock::now();
+                    }
+                    asio::async_connect(socket, endpoints,
+                        std::bind(&TCP_Com::handle_connect, this,
+                        std::placeholders::_1));
+                });
+        }
 
-        thread_com = std::thread([&] { io_service.run(); });
-        Logger::GetInstance().RegisterThread(thread_com.get_id(), "NetworkIOService");
+        // If we are attached to the shared pool, the io_service is already running
+        if (owned_io_service)
+        {
+            thread_com = std::thread([&] { io_service.run(); });
+            Logger::GetInstance().RegisterThread(thread_com.get_id(), "NetworkIOService");
+        }
     }
 
     TCP_Com::~TCP_Com()
     {
-        if (thread_com.joinable())
+        if (owned_io_service)
+        {
+            if (thread_com.joinable())
+            {
+                Logger::GetInstance().UnregisterThread(thread_com.get_id());
+                thread_com.join();
+            }
+        }
+        else
         {
-            Logger::GetInstance().UnregisterThread(thread_com.get_id());
-            thread_com.join();
+            // The io_service is shared and will keep running after we're gone,
+            // wait for all the handlers referencing this to be done
+            close();
+            std::unique_lock<std::mutex> lock(mutex_pending);
+            pending_condition.wait(lock, [this] { return pending_operations == 0; });
         }
     }
 
-    void TCP_Com::SendPacket(const std::vector<unsigned char>& msg)
+    void TCP_Com::SendFrame(const unsigned char* frame, const size_t size)
     {
-        std::vector<unsigned char> sized_packet;
-        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(msg.size(), sized_packet);
-        sized_packet.insert(sized_packet.end(), msg.begin(), msg.end());
-
+        bool schedule_write = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_output);
+            const size_t start = output_data.size();
+            output_data.insert(output_data.end(), frame, frame + size);
+            // Encrypt when the mutex is locked to be sure
+            // the frames are queued in the encryption order
 #ifdef USE_ENCRYPTION
-        if (encrypter != nullptr)
+            if (encrypter != nullptr)
+            {
+                encrypter->EncryptInPlace(output_data.data() + start, size);
+            }
+#endif
+            // If a write is already planned or in progress, this frame
+            // will be sent with the next batch
+            schedule_write = !write_scheduled;
+            write_scheduled = true;
+        }
+
+        if (!schedule_write)
+        {
+            return;
+        }
+
+        StartOperation();
+        const std::chrono::microseconds delay = flush_delay;
+        if (delay.count() > 0)
         {
-            std::vector<unsigned char> encrypted = encrypter->Encrypt(sized_packet);
-            io_service.post(std::bind(&TCP_Com::do_write, this, encrypted));
+            // Wait a little bit to group this frame with the next ones.
+            // The timer is armed on the io thread, as do_close cancels it
+            // there and asio timers are not thread safe
+            io_service.post([this, delay]
+                {
+                    flush_timer.expires_after(delay);
+                    flush_timer.async_wait([this](const asio::error_code& error)
+                        {
+                            if (!error)
+                            {
+                                do_write();
+                            }
+                            EndOperation();
+                        });
+                });
         }
         else
         {
-            io_service.post(std::bind(&TCP_Com::do_write, this, sized_packet));
+            io_service.post([this]
+                {
+                    do_write();
+                    EndOperation();
+                });
         }
-#else
-        io_service.post(std::bind(&TCP_Com::do_write, this, sized_packet));
-#endif
+    }
+
+    void TCP_Com::SetFlushDelay(const std::chrono::microseconds delay)
+    {
+        flush_delay = delay;
     }
 
 #ifdef USE_ENCRYPTION
@@ -81,139 +183,233 @@ namespace Botcraft
         return port;
     }
 
+    const TCP_ComTimings TCP_Com::GetTimings() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_timings);
+        return timings;
+    }
+
     void TCP_Com::close()
     {
-        io_service.post(std::bind(&TCP_Com::do_close, this));
+        StartOperation();
+        io_service.post([this]
+            {
+                do_close();
+                EndOperation();
+            });
     }
 
     void TCP_Com::handle_connect(const asio::error_code& error)
     {
         if (!error)
         {
+            {
+                std::lock_guard<std::mutex> lock(mutex_timings);
+                timings.connect_end = std::chrono::steady_clock::now();
+            }
             LOG_INFO("Connected to server.");
-            socket.async_read_some(asio::buffer(read_msg.data(), read_msg.size()),
-                std::bind(&TCP_Com::handle_read, this,
-                std::placeholders::_1, std::placeholders::_2));
+            start_read();
+            // Send what has been queued while connecting
+            do_write();
         }
         else
         {
             LOG_ERROR("Error when connecting to server. Error code :" << error);
         }
+        EndOperation();
+    }
+
+    void TCP_Com::start_read()
+    {
+        // Make sure there is enough room after input_end
+        if (input_msg.size() - input_end < read_size)
+        {
+            // Move remaining data at the beginning of the buffer
+            if (input_start > 0)
+            {
+                std::copy(input_msg.begin() + input_start, input_msg.begin() + input_end, input_msg.begin());
+                input_end -= input_start;
+                input_start = 0;
+            }
+            if (input_msg.size() - input_end < read_size)
+            {
+                input_msg.resize(input_end + read_size);
+            }
+        }
+
+        StartOperation();
+        socket.async_read_some(asio::buffer(input_msg.data() + input_end, read_size),
+            std::bind(&TCP_Com::handle_read, this,
+            std::placeholders::_1, std::placeholders::_2));
     }
 
     void TCP_Com::handle_read(const asio::error_code& error, std::size_t bytes_transferred)
     {
         if (!error)
         {
+            TRACE_ZONE("TCP_Com::Read", "bytes", bytes_transferred);
 #ifdef USE_ENCRYPTION
             if (encrypter != nullptr)
             {
-                std::vector<unsigned char> decrypted(bytes_transferred);
-                std::copy_n(read_msg.begin(), bytes_transferred, decrypted.data());
-                decrypted = encrypter->Decrypt(decrypted);
-                for (int i = 0; i < decrypted.size(); ++i)
-                {
-                    input_msg.push_back(decrypted[i]);
-                }
+                encrypter->DecryptInPlace(input_msg.data() + input_end, bytes_transferred);
             }
-            else
+#endif
+            input_end += bytes_transferred;
+
+            process_input();
+        }
+        else
+        {
+            do_close();
+        }
+        EndOperation();
+    }
+
+    void TCP_Com::process_input()
+    {
+        bool keep_reading = true;
+        while (input_end > input_start)
+        {
+            if (!keep_reading)
             {
-                for (int i = 0; i < bytes_transferred; ++i)
+                std::lock_guard<std::mutex> lock(mutex_read);
+                // ResumeReading was called before we had time to pause
+                if (!resume_requested)
                 {
-                    input_msg.push_back(read_msg[i]);
+                    read_paused = true;
+                    return;
                 }
+                resume_requested = false;
+                keep_reading = true;
             }
-#else
-            for (int i = 0; i < bytes_transferred; ++i)
+
+            ProtocolCraft::ReadIterator read_iter = input_msg.data() + input_start;
+            size_t max_length = input_end - input_start;
+            int packet_length;
+            try
             {
-                input_msg.push_back(read_msg[i]);
+                packet_length = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(read_iter, max_length);
             }
-#endif
-
-            while (input_msg.size() != 0)
+            catch (const std::runtime_error &e)
             {
-                std::vector<unsigned char>::const_iterator read_iter = input_msg.begin();
-                size_t max_length = input_msg.size();
-                int packet_length;
-                try
-                {
-                    packet_length = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(read_iter, max_length);
-                }
-                catch (const std::runtime_error &e)
-                {
-                    break;
-                }
-                int bytes_read = std::distance<std::vector<unsigned char>::const_iterator>(input_msg.begin(), read_iter);
-                std::vector<unsigned char> data_packet;
-
-                if (packet_length > 0 && input_msg.size() >= bytes_read + packet_length)
-                {
-                    data_packet = std::vector<unsigned char>(input_msg.begin() + bytes_read, input_msg.begin() + bytes_read + packet_length);
+                break;
+            }
+            const size_t bytes_read = input_end - input_start - max_length;
 
-                    NewPacketCallback(data_packet);
-                    input_msg.erase(input_msg.begin(), input_msg.begin() + bytes_read + packet_length);
-                }
-                else
-                {
-                    break;
-                }
+            if (packet_length > 0 && max_length >= packet_length)
+            {
+                const size_t packet_start = input_start + bytes_read;
+                input_start = packet_start + packet_length;
+                keep_reading = NewPacketCallback(std::vector<unsigned char>(input_msg.begin() + packet_start, input_msg.begin() + packet_start + packet_length));
+            }
+            else
+            {
+                break;
             }
+        }
 
-            socket.async_read_some(asio::buffer(read_msg.data(), read_msg.size()),
-                std::bind(&TCP_Com::handle_read, this,
-                std::placeholders::_1, std::placeholders::_2));
+        // Everything has been processed, restart from the beginning of the buffer
+        if (input_start == input_end)
+        {
+            input_start = 0;
+            input_end = 0;
         }
-        else
+
+        if (!keep_reading)
         {
-            do_close();
+            std::lock_guard<std::mutex> lock(mutex_read);
+            if (!resume_requested)
+            {
+                read_paused = true;
+                return;
+            }
+            resume_requested = false;
         }
+
+        start_read();
     }
 
-    void TCP_Com::do_write(const std::vector<unsigned char> &msg)
+    void TCP_Com::ResumeReading()
     {
-        mutex_output.lock();
-        bool write_in_progress = !output_msg.empty();
-        output_msg.push_back(msg);
-        mutex_output.unlock();
+        {
+            std::lock_guard<std::mutex> lock(mutex_read);
+            if (!read_paused)
+            {
+                // The callback asked to pause but process_input
+                // didn't stop reading yet
+                resume_requested = true;
+                return;
+            }
+            read_paused = false;
+        }
+
+        StartOperation();
+        io_service.post([this]
+            {
+                if (socket.is_open())
+                {
+                    process_input();
+                }
+                EndOperation();
+            });
+    }
 
-        if (!write_in_progress)
+    void TCP_Com::do_write()
+    {
         {
-            asio::async_write(socket,
-                asio::buffer(output_msg.front().data(),
-                output_msg.front().size()),
-                std::bind(&TCP_Com::handle_write, this,
-                std::placeholders::_1));
+            std::lock_guard<std::mutex> lock(mutex_output);
+            if (output_data.empty())
+            {
+                write_scheduled = false;
+                return;
+            }
+
+            // Send all the queued frames at once
+            writing_data.swap(output_data);
         }
+
+        StartOperation();
+        asio::async_write(socket, asio::buffer(writing_data),
+            std::bind(&TCP_Com::handle_write, this,
+            std::placeholders::_1));
     }
 
     void TCP_Com::handle_write(const asio::error_code& error)
     {
         if (!error)
         {
-            mutex_output.lock();
-            output_msg.pop_front();
-            mutex_output.unlock();
-
-            if (!output_msg.empty())
-            {
-                asio::async_write(socket,
-                    asio::buffer(output_msg.front().data(),
-                    output_msg.front().size()),
-                    std::bind(&TCP_Com::handle_write, this,
-                    std::placeholders::_1));
-            }
+            writing_data.clear();
+            // Send everything that has been queued during this write
+            do_write();
         }
         else
         {
             do_close();
         }
+        EndOperation();
     }
 
     void TCP_Com::do_close()
     {
+        flush_timer.cancel();
         socket.close();
     }
 
+    void TCP_Com::StartOperation()
+    {
+        pending_operations++;
+    }
+
+    void TCP_Com::EndOperation()
+    {
+        std::lock_guard<std::mutex> lock(mutex_pending);
+        pending_operations--;
+        if (pending_operations == 0)
+        {
+            pending_condition.notify_all();
+        }
+    }
+
     void TCP_Com::SetIPAndPortFromAddress(const std::string& address)
     {
         std::string addressOnly;
@@ -242,70 +438,14 @@ namespace Botcraft
         }
 
         // If port is unknown we first try a SRV DNS lookup
-        LOG_INFO("Performing SRV DNS lookup on " << "_minecraft._tcp." << address << " to find an endpoint");
-        asio::ip::udp::socket udp_socket(io_service);
-
-        // Create the query
-        DNSMessage query;
-        // Random identification
-        query.SetIdentification({ 0x42, 0x42 });
-        query.SetFlagQR(0);
-        query.SetFlagOPCode(0);
-        query.SetFlagAA(0);
-        query.SetFlagTC(0);
-        query.SetFlagRD(1);
-        query.SetFlagRA(0);
-        query.SetFlagZ(0);
-        query.SetFlagRCode(0);
-        query.SetNumberQuestion(1);
-        query.SetNumberAnswer(0);
-        query.SetNumberAuthority(0);
-        query.SetNumberAdditionalRR(0);
-        DNSQuestion question;
-        // SRV type
-        question.SetTypeCode(33);
-        question.SetClassCode(1);
-        question.SetNameLabels(SplitString("_minecraft._tcp." + address, '.'));
-        query.SetQuestions({ question });
-
-        // Write the request and send it to google DNS
-        std::vector<unsigned char> encoded_query;
-        query.Write(encoded_query);
-        udp_socket.open(asio::ip::udp::v4());
-        asio::ip::udp::endpoint endpoint(asio::ip::address::from_string("8.8.8.8"), 53);
-        udp_socket.send_to(asio::buffer(encoded_query), endpoint);
-
-        // Wait for the answer
-        std::vector<unsigned char> answer_buffer(512);
-        asio::ip::udp::endpoint sender_endpoint;
-        const size_t len = udp_socket.receive_from(asio::buffer(answer_buffer), sender_endpoint);
-
-        ProtocolCraft::ReadIterator iter = answer_buffer.begin();
-        size_t remaining = len;
-
-        // Read answer
-        DNSMessage answer;
-        answer.Read(iter, remaining);
-
-        // If there is an answer and it's a SRV one (as it should be)
-        if (answer.GetNumberAnswer() > 0
-            && answer.GetAnswers()[0].GetTypeCode() == 0x21)
+        std::string srv_target;
+        unsigned short srv_port = 0;
+        if (DNSCache::GetInstance().LookupSRV(addressOnly, srv_target, srv_port))
         {
-            DNSSrvData data;
-            auto iter2 = answer.GetAnswers()[0].GetRData().begin();
-            size_t len2 = answer.GetAnswers()[0].GetRDLength();
-            data.Read(iter2, len2);
-            ip = "";
-            for (int i = 0; i < data.GetNameLabels().size(); ++i)
-            {
-                ip += data.GetNameLabels()[i] + (i == data.GetNameLabels().size() - 1 ? "" : ".");
-            }
-            port = data.GetPort();
-
-            LOG_INFO("SRV DNS lookup successful!")
+            ip = srv_target;
+            port = srv_port;
             return;
         }
-        LOG_WARNING("SRV DNS lookup failed to find an address");
 
         // If we are here either the port was given or the SRV failed 
         // In both cases we need to assume the given address is the correct one
@@ -3,6 +3,8 @@
 
 #include "botcraft/Utilities/Logger.hpp"
 
+#include "protocolCraft/BinaryReadWrite.hpp"
+
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
 #include <stb_image/stb_image.h>
@@ -10,9 +12,12 @@
 // rectpack2D
 #include "finders_interface.h"
 
+#include <filesystem>
 #include <fstream>
 #include <string>
 
+using namespace ProtocolCraft;
+
 namespace Botcraft
 {
     namespace Renderer
@@ -33,6 +38,38 @@ namespace Botcraft
             }
         };
 
+        // Cache files start with this, followed by the key of the textures
+        static const std::string cache_file_magic = "BCAT1";
+
+        // FNV-1a hash of the textures files, to know if a cache file is still valid
+        static const unsigned long long ComputeTexturesKey(const std::vector<std::pair<std::string, std::string> >& textures_path_names)
+        {
+            unsigned long long key = 14695981039346656037ULL;
+            auto hash_bytes = [&key](const void* bytes, const size_t size)
+            {
+                for (size_t i = 0; i < size; ++i)
+                {
+                    key ^= static_cast<const unsigned char*>(bytes)[i];
+                    key *= 1099511628211ULL;
+                }
+            };
+
+            for (const auto& p : textures_path_names)
+            {
+                hash_bytes(p.first.data(), p.first.size() + 1);
+                hash_bytes(p.second.data(), p.second.size() + 1);
+
+                std::error_code ec;
+                const long long file_size = static_cast<long long>(std::filesystem::file_size(p.first, ec));
+                hash_bytes(&file_size, sizeof(file_size));
+                const long long write_time = ec ? 0 : static_cast<long long>(std::filesystem::last_write_time(p.first, ec).time_since_epoch().count());
+                hash_bytes(&write_time, sizeof(write_time));
+                const bool animated = std::filesystem::exists(p.first + ".mcmeta", ec);
+                hash_bytes(&animated, sizeof(animated));
+            }
+            return key;
+        }
+
         Atlas::Atlas()
         {
             height = 0;
@@ -68,7 +105,7 @@ namespace Botcraft
             }
         }
 
-        void Atlas::LoadData(const std::vector<std::pair<std::string, std::string> >& textures_path_names)
+        void Atlas::LoadData(const std::vector<std::pair<std::string, std::string> >& textures_path_names, const std::string& cache_path)
         {
             if (textures_path_names.size() == 0)
             {
@@ -76,6 +113,13 @@ namespace Botcraft
                 return;
             }
 
+            const unsigned long long cache_key = cache_path.empty() ? 0 : ComputeTexturesKey(textures_path_names);
+            if (!cache_path.empty() && LoadCache(cache_path, cache_key))
+            {
+                LOG_INFO("Textures atlas loaded from cache, size: " << height << "x" << width);
+                return;
+            }
+
             std::vector<Texture> textures;
             textures.reserve(textures_path_names.size());
 
@@ -222,6 +266,11 @@ namespace Botcraft
 
             //In case we want to save the atlas to check the data
             //WriteImage("atlas.png", height, width, 4, data.data(), false);
+
+            if (!cache_path.empty())
+            {
+                SaveCache(cache_path, cache_key);
+            }
         }
 
         const int Atlas::GetWidth() const
@@ -254,5 +303,112 @@ namespace Botcraft
         {
             return data.data() + ((row * width + col) * 4 + depth);
         }
+
+        const bool Atlas::LoadCache(const std::string& path, const unsigned long long key)
+        {
+            std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+            {
+                return false;
+            }
+
+            // Read the whole file at once, most of it is the pixels
+            std::vector<unsigned char> file_data(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(file_data.data()), file_data.size());
+            file.close();
+
+            try
+            {
+                ReadIterator iter = file_data.data();
+                size_t length = file_data.size();
+
+                if (ReadRawString(iter, length, static_cast<int>(cache_file_magic.size())) != cache_file_magic ||
+                    ReadData<unsigned long long>(iter, length) != key)
+                {
+                    return false;
+                }
+
+                const int height_ = ReadData<int>(iter, length);
+                const int width_ = ReadData<int>(iter, length);
+                if (height_ < 1 || width_ < 1)
+                {
+                    return false;
+                }
+
+                std::unordered_map<std::string, TextureData> textures_map_;
+                const int num_textures = ReadData<VarInt>(iter, length);
+                for (int i = 0; i < num_textures; ++i)
+                {
+                    const std::string identifier = ReadData<std::string>(iter, length);
+                    TextureData& texture = textures_map_[identifier];
+                    texture.size.first = ReadData<int>(iter, length);
+                    texture.size.second = ReadData<int>(iter, length);
+                    texture.position.first = ReadData<int>(iter, length);
+                    texture.position.second = ReadData<int>(iter, length);
+                    texture.transparency = static_cast<Transparency>(ReadData<char>(iter, length));
+                    texture.animation = static_cast<Animation>(ReadData<char>(iter, length));
+                }
+                if (textures_map_.find("") == textures_map_.end())
+                {
+                    return false;
+                }
+
+                std::vector<unsigned char> data_ = ReadByteArray(iter, length, static_cast<size_t>(height_) * width_ * 4);
+
+                height = height_;
+                width = width_;
+                textures_map = std::move(textures_map_);
+                data = std::move(data_);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_WARNING("Invalid textures atlas cache file " << path << ": " << e.what());
+                return false;
+            }
+
+            return true;
+        }
+
+        void Atlas::SaveCache(const std::string& path, const unsigned long long key) const
+        {
+            std::vector<unsigned char> file_data;
+            file_data.reserve(data.size() + 64 * textures_map.size() + 64);
+            WriteRawString(cache_file_magic, file_data);
+            WriteData<unsigned long long>(key, file_data);
+            WriteData<int>(height, file_data);
+            WriteData<int>(width, file_data);
+            WriteData<VarInt>(static_cast<int>(textures_map.size()), file_data);
+            for (auto it = textures_map.begin(); it != textures_map.end(); ++it)
+            {
+                WriteData(it->first, file_data);
+                WriteData<int>(it->second.size.first, file_data);
+                WriteData<int>(it->second.size.second, file_data);
+                WriteData<int>(it->second.position.first, file_data);
+                WriteData<int>(it->second.position.second, file_data);
+                WriteData<char>(static_cast<char>(it->second.transparency), file_data);
+                WriteData<char>(static_cast<char>(it->second.animation), file_data);
+            }
+            WriteByteArray(data, file_data);
+
+            // Write in a temporary file first, so a crash
+            // while writing doesn't leave an invalid cache
+            const std::string tmp_path = path + ".tmp";
+            std::ofstream file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                LOG_WARNING("Can't open textures atlas cache file " << tmp_path << " for writing");
+                return;
+            }
+            file.write(reinterpret_cast<const char*>(file_data.data()), file_data.size());
+            file.close();
+
+            std::error_code ec;
+            std::filesystem::rename(tmp_path, path, ec);
+            if (ec)
+            {
+                LOG_WARNING("Can't write textures atlas cache file " << path << " (" << ec.message() << ")");
+            }
+        }
     } // Renderer
 } // Botcraft
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "botcraft/Renderer/BlockRenderable.hpp"
 
+#include <cstddef>
+
 namespace Botcraft
 {
     namespace Renderer
@@ -12,6 +14,7 @@ namespace Botcraft
             faces_VBO = 0;
             data_VBO = 0;
             face_number = 0;
+            buffer_capacity = 0;
 
             buffer_status = BufferStatus::Created;
         }
@@ -26,19 +29,14 @@ namespace Botcraft
 
         }
 
-        void BlockRenderable::ClearFaces()
+        const unsigned int BlockRenderable::GetNumFace() const
         {
-            std::lock_guard<std::mutex> lock_faces(mutex_faces);
-            faces.clear();
-            if (buffer_status != BufferStatus::Created)
-            {
-                buffer_status = BufferStatus::Updated;
-            }
+            return face_number;
         }
 
-        const unsigned int BlockRenderable::GetNumFace() const
+        const size_t BlockRenderable::GetGPUMemory() const
         {
-            return face_number;
+            return sizeof(PackedFace) * buffer_capacity;
         }
 
         void BlockRenderable::Render() const
@@ -63,56 +61,87 @@ namespace Botcraft
 
             glGenBuffers(1, &data_VBO);
             glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(Face) * face_number, 0, GL_DYNAMIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(PackedFace) * face_number, 0, GL_DYNAMIC_DRAW);
+            buffer_capacity = face_number;
+
+            SetPackedFacesAttribPointers(0);
+
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindVertexArray(0);
+        }
+
+        void BlockRenderable::SetFacesAttribPointers(const size_t first_face)
+        {
+            const size_t offset = first_face * sizeof(Face);
 
             //(matrix4x4) model matrix of the face
             //Actually passed as 4 columns
             glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)0);
+            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)offset);
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(1, 1);
 
             glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(4 * sizeof(float)));
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(offset + 4 * sizeof(float)));
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(2, 1);
 
             glEnableVertexAttribArray(3);
-            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(8 * sizeof(float)));
+            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(offset + 8 * sizeof(float)));
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(3, 1);
 
             glEnableVertexAttribArray(4);
-            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(12 * sizeof(float)));
+            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(offset + 12 * sizeof(float)));
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(4, 1);
 
             glEnableVertexAttribArray(5);
             //tex_coords(u0, v0, u1, v1) for one face
-            glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(16 * sizeof(float)));
+            glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(offset + 16 * sizeof(float)));
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(5, 1);
             
             glEnableVertexAttribArray(6);
             //tex_coords_overlay(u0, v0, u1, v1) for one face
-            glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(20 * sizeof(float)));
+            glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Face), (void*)(offset + 20 * sizeof(float)));
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(6, 1);
 
             glEnableVertexAttribArray(7);
             //(texture_data) for one face
-            glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, sizeof(Face), (void*)(24 * sizeof(float)));
+            glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, sizeof(Face), (void*)(offset + 24 * sizeof(float)));
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(7, 1);
 
             glEnableVertexAttribArray(8);
             //(texture_multiplier, texture_multiplier_overlay) for one face
-            glVertexAttribIPointer(8, 2, GL_UNSIGNED_INT, sizeof(Face), (void*)(25 * sizeof(float)));
+            glVertexAttribIPointer(8, 2, GL_UNSIGNED_INT, sizeof(Face), (void*)(offset + 25 * sizeof(float)));
             //Specify that only one instance of this must be sent to one index
             glVertexAttribDivisor(8, 1);
+        }
 
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glBindVertexArray(0);
+        void BlockRenderable::SetPackedFacesAttribPointers(const size_t first_face)
+        {
+            const size_t offset = first_face * sizeof(PackedFace);
+
+            glEnableVertexAttribArray(1);
+            //(x, y, z) position of the face, in half blocks
+            glVertexAttribIPointer(1, 3, GL_UNSIGNED_SHORT, sizeof(PackedFace), (void*)(offset + offsetof(PackedFace, position)));
+            //Specify that only one instance of this must be sent to one index
+            glVertexAttribDivisor(1, 1);
+
+            glEnableVertexAttribArray(2);
+            //(template_index) for one face
+            glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(PackedFace), (void*)(offset + offsetof(PackedFace, template_index)));
+            //Specify that only one instance of this must be sent to one index
+            glVertexAttribDivisor(2, 1);
+
+            glEnableVertexAttribArray(3);
+            //(texture_multiplier, texture_multiplier_overlay) for one face
+            glVertexAttribIPointer(3, 2, GL_UNSIGNED_INT, sizeof(PackedFace), (void*)(offset + offsetof(PackedFace, texture_multipliers)));
+            //Specify that only one instance of this must be sent to one index
+            glVertexAttribDivisor(3, 1);
         }
 
         void BlockRenderable::DeleteOpenGLBuffer()
@@ -129,6 +158,24 @@ namespace Botcraft
             {
                 glDeleteVertexArrays(1, &faces_VAO);
             }
+            buffer_capacity = 0;
+        }
+
+        void BlockRenderable::UploadFaces(const std::vector<PackedFace>& data)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
+            if (data.size() > buffer_capacity)
+            {
+                // Keep some margin so the next few added faces
+                // don't need a new allocation
+                buffer_capacity = static_cast<unsigned int>(data.size() + data.size() / 4);
+                glBufferData(GL_ARRAY_BUFFER, sizeof(PackedFace) * buffer_capacity, nullptr, GL_DYNAMIC_DRAW);
+            }
+            if (!data.empty())
+            {
+                glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(PackedFace) * data.size(), data.data());
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
     } // Renderer
 } // Botcraft
\ No newline at end of file
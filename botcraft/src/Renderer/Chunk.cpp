@@ -1,6 +1,9 @@
-#include <glad/glad.h>
-
 #include "botcraft/Renderer/Chunk.hpp"
+#include "botcraft/Renderer/FaceBufferArena.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace Botcraft
 {
@@ -8,7 +11,10 @@ namespace Botcraft
     {
         Chunk::Chunk()
         {
-
+            arena_offset = 0;
+            arena_capacity = 0;
+            min_y = std::numeric_limits<float>::max();
+            max_y = std::numeric_limits<float>::lowest();
         }
 
         Chunk::~Chunk()
@@ -16,48 +22,63 @@ namespace Botcraft
 
         }
 
-        void Chunk::Update()
+        void Chunk::Update(FaceBufferArena& arena)
         {
             std::lock_guard<std::mutex> lock_faces(mutex_faces);
-            switch (buffer_status)
+            if (buffer_status == BufferStatus::UpToDate)
             {
-            case BufferStatus::Created:
+                return;
+            }
+
+            const std::vector<PackedFace> faces_data = GetPackedFaces();
+            face_number = faces_data.size();
+            if (face_number > arena_capacity || face_number == 0)
             {
-                GenerateOpenGLBuffer();
-                std::vector<Face> faces_data(faces.begin(), faces.end());
-                face_number = faces_data.size();
-                glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-                glBufferData(GL_ARRAY_BUFFER, sizeof(Face) * face_number, faces_data.data(), GL_DYNAMIC_DRAW);
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
-                buffer_status = BufferStatus::UpToDate;
-                break;
+                arena.Free(arena_offset, arena_capacity);
+                // Keep some margin so the next few added faces
+                // don't need a new range
+                arena_capacity = face_number + face_number / 4;
+                arena_offset = arena_capacity == 0 ? 0 : arena.Allocate(arena_capacity);
             }
-            case BufferStatus::Updated:
+            arena.Upload(arena_offset, faces_data);
+
+            buffer_status = face_number == 0 ? BufferStatus::Created : BufferStatus::UpToDate;
+        }
+
+        void Chunk::ClearFaces()
+        {
+            std::lock_guard<std::mutex> lock_faces(mutex_faces);
+            faces.clear();
+            if (buffer_status != BufferStatus::Created)
             {
-                std::vector<Face> faces_data(faces.begin(), faces.end());
-                face_number = faces_data.size();
-                glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-                glBufferData(GL_ARRAY_BUFFER, sizeof(Face) * face_number, faces_data.data(), GL_DYNAMIC_DRAW);
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
-                if (face_number == 0)
-                {
-                    DeleteOpenGLBuffer();
-                    buffer_status = BufferStatus::Created;
-                }
-                else
-                {
-                    buffer_status = BufferStatus::UpToDate;
-                }
-                break;
+                buffer_status = BufferStatus::Updated;
             }
-            case BufferStatus::UpToDate:
-                break;
-            default:
-                break;
+            min_y = std::numeric_limits<float>::max();
+            max_y = std::numeric_limits<float>::lowest();
+        }
+
+        const std::pair<float, float> Chunk::GetVerticalBounds() const
+        {
+            return { min_y, max_y };
+        }
+
+        const std::pair<unsigned int, unsigned int> Chunk::GetArenaRange() const
+        {
+            return { arena_offset, face_number };
+        }
+
+        const std::vector<PackedFace> Chunk::GetPackedFaces() const
+        {
+            std::vector<PackedFace> output;
+            output.reserve(faces.size());
+            for (const ChunkFace& f : faces)
+            {
+                output.push_back(f.packed);
             }
+            return output;
         }
 
-        void Chunk::AddFace(const Face &f, const std::array<unsigned int, 2>& texture_multipliers,
+        void Chunk::AddFace(const Face &f, const unsigned int template_index, const std::array<unsigned int, 2>& texture_multipliers,
             const float offset_x, const float offset_y, const float offset_z)
         {
             std::lock_guard<std::mutex> lock_faces(mutex_faces);
@@ -66,15 +87,33 @@ namespace Botcraft
                 buffer_status = BufferStatus::Updated;
             }
 
-            Face local_face(f);
-
-            local_face.GetMatrix()[12] += offset_x;
-            local_face.GetMatrix()[13] += offset_y;
-            local_face.GetMatrix()[14] += offset_z;
+            // Y of the corners of the base face (x, -1, z)
+            const std::array<float, 16>& m = f.GetMatrix();
+            for (const float x : { -1.0f, 1.0f })
+            {
+                for (const float z : { -1.0f, 1.0f })
+                {
+                    const float y = m[1] * x - m[5] + m[9] * z + m[13] + offset_y;
+                    min_y = std::min(min_y, y);
+                    max_y = std::max(max_y, y);
+                }
+            }
 
-            local_face.SetTextureMultipliers(texture_multipliers);
+            ChunkFace face;
+            // Offsets are the centers of the blocks covered
+            // by the face, always a multiple of half a block
+            face.packed.position = {
+                static_cast<unsigned short>(static_cast<int>(std::lround(2.0f * offset_x)) & 0xFFFF),
+                static_cast<unsigned short>(static_cast<int>(std::lround(2.0f * offset_y)) & 0xFFFF),
+                static_cast<unsigned short>(static_cast<int>(std::lround(2.0f * offset_z)) & 0xFFFF)
+            };
+            face.packed.padding = 0;
+            face.packed.template_index = template_index;
+            face.packed.texture_multipliers = texture_multipliers;
+            // Center of the base face (0, -1, 0)
+            face.center = { m[12] - m[4] + offset_x, m[13] - m[5] + offset_y, m[14] - m[6] + offset_z };
 
-            faces.push_back(std::move(local_face));
+            faces.push_back(face);
         }
     } // Renderer
 } // Botcraft
\ No newline at end of file
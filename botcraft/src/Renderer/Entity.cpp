@@ -1,6 +1,5 @@
-#include <glad/glad.h>
-
 #include "botcraft/Renderer/Entity.hpp"
+#include "botcraft/Renderer/FaceBufferArena.hpp"
 
 namespace Botcraft
 {
@@ -10,6 +9,8 @@ namespace Botcraft
         {
             faces = std::deque<Face>(faces_.begin(), faces_.end());
             face_number = faces.size();
+            arena_offset = 0;
+            arena_capacity = 0;
         }
 
         Entity::~Entity()
@@ -17,45 +18,25 @@ namespace Botcraft
 
         }
 
-        void Entity::Update()
+        void Entity::Update(FaceBufferArena& arena)
         {
             std::lock_guard<std::mutex> lock_faces(mutex_faces);
-            switch (buffer_status)
-            {
-            case BufferStatus::Created:
+            if (buffer_status == BufferStatus::UpToDate)
             {
-                GenerateOpenGLBuffer();
-                std::vector<Face> faces_data(faces.begin(), faces.end());
-                face_number = faces_data.size();
-                glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-                glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Face) * face_number, faces_data.data());
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
-                buffer_status = BufferStatus::UpToDate;
-                break;
+                return;
             }
-            case BufferStatus::Updated:
+
+            std::vector<Face> faces_data(faces.begin(), faces.end());
+            face_number = faces_data.size();
+            if (face_number > arena_capacity || face_number == 0)
             {
-                std::vector<Face> faces_data(faces.begin(), faces.end());
-                face_number = faces_data.size();
-                glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-                glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Face) * face_number, faces_data.data());
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
-                if (face_number == 0)
-                {
-                    DeleteOpenGLBuffer();
-                    buffer_status = BufferStatus::Created;
-                }
-                else
-                {
-                    buffer_status = BufferStatus::UpToDate;
-                }
-                break;
-            }
-            case BufferStatus::UpToDate:
-                break;
-            default:
-                break;
+                arena.Free(arena_offset, arena_capacity);
+                arena_capacity = face_number;
+                arena_offset = arena_capacity == 0 ? 0 : arena.Allocate(arena_capacity);
             }
+            arena.Upload(arena_offset, faces_data);
+
+            buffer_status = face_number == 0 ? BufferStatus::Created : BufferStatus::UpToDate;
         }
 
         void Entity::UpdateFaces(const std::vector<Face> &faces_)
@@ -69,6 +50,16 @@ namespace Botcraft
             faces = std::deque<Face>(faces_.begin(), faces_.end());
         }
 
+        void Entity::ClearFaces()
+        {
+            std::lock_guard<std::mutex> lock_faces(mutex_faces);
+            faces.clear();
+            if (buffer_status != BufferStatus::Created)
+            {
+                buffer_status = BufferStatus::Updated;
+            }
+        }
+
         Vector3<float> Entity::GetApproxPos()
         {
             std::lock_guard<std::mutex> lock_faces(mutex_faces);
@@ -83,5 +74,10 @@ namespace Botcraft
                     faces[0].GetMatrix()[14]
                 );
         }
+
+        const std::pair<unsigned int, unsigned int> Entity::GetArenaRange() const
+        {
+            return { arena_offset, face_number };
+        }
     } // Renderer
 } // Botcraft
@@ -1,5 +1,7 @@
 #include "botcraft/Renderer/Face.hpp"
 
+#include <algorithm>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -194,6 +196,29 @@ namespace Botcraft
             }
         }
 
+        void Face::SetTextureRepeat(const unsigned int repeat_x, const unsigned int repeat_z)
+        {
+            const unsigned int clamped_x = std::min(256u, std::max(1u, repeat_x));
+            const unsigned int clamped_z = std::min(256u, std::max(1u, repeat_z));
+            texture_data &= ~(0xFFFFUL << 6);
+            texture_data |= ((clamped_x - 1) << 6) | ((clamped_z - 1) << 14);
+        }
+
+        const std::array<unsigned int, 2> Face::GetTextureRepeat() const
+        {
+            return { ((texture_data >> 6) & 0xFF) + 1, ((texture_data >> 14) & 0xFF) + 1 };
+        }
+
+        const unsigned int Face::GetTextureRotation() const
+        {
+            return (texture_data >> 3) & 0x03;
+        }
+
+        const unsigned int Face::GetTextureData() const
+        {
+            return texture_data;
+        }
+
         void Face::UpdateMatrix(const FaceTransformation& transformations, const Orientation orientation)
         {
             IMatrix model;
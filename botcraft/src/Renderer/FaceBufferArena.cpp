@@ -0,0 +1,210 @@
+#include <glad/glad.h>
+
+#include "botcraft/Renderer/FaceBufferArena.hpp"
+#include "botcraft/Renderer/BlockRenderable.hpp"
+
+#include <algorithm>
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        FaceBufferArena::FaceBufferArena(const unsigned int initial_capacity_, const bool packed_faces_)
+        {
+            faces_VAO = 0;
+            faces_VBO = 0;
+            data_VBO = 0;
+
+            packed_faces = packed_faces_;
+            face_size = packed_faces ? sizeof(PackedFace) : sizeof(Face);
+
+            capacity = std::max(1u, initial_capacity_);
+            free_ranges[0] = capacity;
+        }
+
+        FaceBufferArena::~FaceBufferArena()
+        {
+            if (faces_VBO)
+            {
+                glDeleteBuffers(1, &faces_VBO);
+            }
+            if (data_VBO)
+            {
+                glDeleteBuffers(1, &data_VBO);
+            }
+            if (faces_VAO)
+            {
+                glDeleteVertexArrays(1, &faces_VAO);
+            }
+        }
+
+        void FaceBufferArena::InitGL()
+        {
+            glGenVertexArrays(1, &faces_VAO);
+            glGenBuffers(1, &faces_VBO);
+
+            //Buffer for the base face (x,y,z)
+            glBindVertexArray(faces_VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, faces_VBO);
+            glBufferData(GL_ARRAY_BUFFER, Face::base_face.size() * sizeof(float), Face::base_face.data(), GL_STATIC_DRAW);
+
+            //(x, y, z) for base face
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+            glGenBuffers(1, &data_VBO);
+            glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
+            glBufferData(GL_ARRAY_BUFFER, face_size * capacity, nullptr, GL_DYNAMIC_DRAW);
+
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindVertexArray(0);
+        }
+
+        const unsigned int FaceBufferArena::Allocate(const unsigned int size)
+        {
+            // First fit, the lowest offsets are used first
+            // so the ranges stay packed at the buffer start
+            for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it)
+            {
+                if (it->second < size)
+                {
+                    continue;
+                }
+
+                const unsigned int offset = it->first;
+                const unsigned int remaining = it->second - size;
+                free_ranges.erase(it);
+                if (remaining > 0)
+                {
+                    free_ranges[offset + size] = remaining;
+                }
+                return offset;
+            }
+
+            Grow(std::max(2 * capacity, capacity + size));
+            return Allocate(size);
+        }
+
+        void FaceBufferArena::Free(const unsigned int offset, const unsigned int size)
+        {
+            if (size == 0)
+            {
+                return;
+            }
+
+            auto it = free_ranges.insert({ offset, size }).first;
+
+            // Merge with the next free range
+            auto next = std::next(it);
+            if (next != free_ranges.end() && it->first + it->second == next->first)
+            {
+                it->second += next->second;
+                free_ranges.erase(next);
+            }
+
+            // Merge with the previous one
+            if (it != free_ranges.begin())
+            {
+                auto previous = std::prev(it);
+                if (previous->first + previous->second == it->first)
+                {
+                    previous->second += it->second;
+                    free_ranges.erase(it);
+                }
+            }
+        }
+
+        void FaceBufferArena::Upload(const unsigned int offset, const std::vector<Face>& faces)
+        {
+            UploadData(offset, faces.data(), faces.size());
+        }
+
+        void FaceBufferArena::Upload(const unsigned int offset, const std::vector<PackedFace>& faces)
+        {
+            UploadData(offset, faces.data(), faces.size());
+        }
+
+        void FaceBufferArena::UploadData(const unsigned int offset, const void* data, const size_t num_faces)
+        {
+            if (num_faces == 0)
+            {
+                return;
+            }
+
+            glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
+            glBufferSubData(GL_ARRAY_BUFFER, face_size * offset, face_size * num_faces, data);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        const int FaceBufferArena::Render(std::vector<std::pair<unsigned int, unsigned int> >& ranges) const
+        {
+            std::sort(ranges.begin(), ranges.end());
+
+            int num_draw_calls = 0;
+            glBindVertexArray(faces_VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
+            size_t i = 0;
+            while (i < ranges.size())
+            {
+                const unsigned int first_face = ranges[i].first;
+                unsigned int num_faces = ranges[i].second;
+                // Ranges that end where the next one starts are drawn together
+                while (i + 1 < ranges.size() && first_face + num_faces == ranges[i + 1].first)
+                {
+                    num_faces += ranges[i + 1].second;
+                    i += 1;
+                }
+                i += 1;
+
+                if (num_faces == 0)
+                {
+                    continue;
+                }
+
+                // No base instance in OpenGL 3.3, the instance
+                // attributes have to point to the first face instead
+                if (packed_faces)
+                {
+                    BlockRenderable::SetPackedFacesAttribPointers(first_face);
+                }
+                else
+                {
+                    BlockRenderable::SetFacesAttribPointers(first_face);
+                }
+                glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, num_faces);
+                num_draw_calls += 1;
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindVertexArray(0);
+
+            return num_draw_calls;
+        }
+
+        const size_t FaceBufferArena::GetGPUMemory() const
+        {
+            return face_size * capacity;
+        }
+
+        void FaceBufferArena::Grow(const unsigned int new_capacity)
+        {
+            if (new_capacity <= capacity)
+            {
+                return;
+            }
+
+            unsigned int new_VBO;
+            glGenBuffers(1, &new_VBO);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, new_VBO);
+            glBufferData(GL_COPY_WRITE_BUFFER, face_size * new_capacity, nullptr, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_COPY_READ_BUFFER, data_VBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, face_size * capacity);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &data_VBO);
+            data_VBO = new_VBO;
+
+            Free(capacity, new_capacity - capacity);
+            capacity = new_capacity;
+        }
+    } // Renderer
+} // Botcraft
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <glad/glad.h>
+
+#include "botcraft/Renderer/FaceTemplates.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        FaceTemplates::FaceTemplates()
+        {
+            uploaded_size = 0;
+            templates_buffer = 0;
+            templates_texture = 0;
+            buffer_capacity = 0;
+        }
+
+        FaceTemplates::~FaceTemplates()
+        {
+            if (templates_texture)
+            {
+                glDeleteTextures(1, &templates_texture);
+            }
+            if (templates_buffer)
+            {
+                glDeleteBuffers(1, &templates_buffer);
+            }
+        }
+
+        size_t FaceTemplates::TemplateDataHasher::operator()(const TemplateData& t) const
+        {
+            std::hash<float> hasher;
+            size_t value = hasher(t[0]);
+            for (size_t i = 1; i < t.size(); ++i)
+            {
+                value ^= hasher(t[i]) + 0x9e3779b9 + (value << 6) + (value >> 2);
+            }
+            return value;
+        }
+
+        const unsigned int FaceTemplates::GetIndex(const Face& face)
+        {
+            TemplateData t;
+            // Matrix rows, the last one is always (0, 0, 0, 1)
+            const std::array<float, 16>& m = face.GetMatrix();
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    t[4 * row + column] = m[4 * column + row];
+                }
+            }
+            const std::array<float, 4>& coords = face.GetTextureCoords(false);
+            const std::array<float, 4>& coords_overlay = face.GetTextureCoords(true);
+            for (int i = 0; i < 4; ++i)
+            {
+                t[12 + i] = coords[i];
+                t[16 + i] = coords_overlay[i];
+            }
+            // Less than 24 bits are used, so it's exactly stored as a float
+            t[20] = static_cast<float>(face.GetTextureData());
+            t[21] = 0.0f;
+            t[22] = 0.0f;
+            t[23] = 0.0f;
+
+            std::lock_guard<std::mutex> lock(templates_mutex);
+            auto it = indices.find(t);
+            if (it != indices.end())
+            {
+                return it->second;
+            }
+
+            const unsigned int index = static_cast<unsigned int>(indices.size());
+            indices[t] = index;
+            data.insert(data.end(), t.begin(), t.end());
+            return index;
+        }
+
+        void FaceTemplates::InitGL()
+        {
+            glGenBuffers(1, &templates_buffer);
+            glGenTextures(1, &templates_texture);
+        }
+
+        void FaceTemplates::UpdateGL()
+        {
+            std::lock_guard<std::mutex> lock(templates_mutex);
+            if (uploaded_size == data.size())
+            {
+                return;
+            }
+
+            glBindBuffer(GL_TEXTURE_BUFFER, templates_buffer);
+            if (data.size() > buffer_capacity)
+            {
+                // Reallocate with some margin and send everything again
+                buffer_capacity = std::max(2 * buffer_capacity, data.size());
+                glBufferData(GL_TEXTURE_BUFFER, sizeof(float) * buffer_capacity, nullptr, GL_DYNAMIC_DRAW);
+                uploaded_size = 0;
+            }
+            glBufferSubData(GL_TEXTURE_BUFFER, sizeof(float) * uploaded_size, sizeof(float) * (data.size() - uploaded_size), data.data() + uploaded_size);
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+            uploaded_size = data.size();
+
+            // Attach the (possibly new) buffer storage to the texture
+            glBindTexture(GL_TEXTURE_BUFFER, templates_texture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, templates_buffer);
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        }
+
+        void FaceTemplates::BindGL(const unsigned int texture_unit) const
+        {
+            glActiveTexture(GL_TEXTURE0 + texture_unit);
+            glBindTexture(GL_TEXTURE_BUFFER, templates_texture);
+            glActiveTexture(GL_TEXTURE0);
+        }
+
+        const size_t FaceTemplates::GetGPUMemory() const
+        {
+            return sizeof(float) * buffer_capacity;
+        }
+    } // Renderer
+} // Botcraft
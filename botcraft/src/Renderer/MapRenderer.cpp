@@ -0,0 +1,425 @@
+#include "botcraft/Renderer/MapRenderer.hpp"
+#include "botcraft/Renderer/Atlas.hpp"
+#include "botcraft/Renderer/ImageSaver.hpp"
+
+#include "botcraft/Game/AssetsManager.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/Section.hpp"
+#include "botcraft/Game/World/Blockstate.hpp"
+#include "botcraft/Game/World/Biome.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        static const unsigned int MultiplyColors(const unsigned int a, const unsigned int b)
+        {
+            unsigned int output = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                const unsigned int c = ((a >> (8 * i)) & 0xFF) * ((b >> (8 * i)) & 0xFF) / 255;
+                output |= c << (8 * i);
+            }
+            return output;
+        }
+
+        static const unsigned int BlendColors(const unsigned int top, const unsigned int bottom, const float alpha)
+        {
+            unsigned int output = 0xFF000000;
+            for (int i = 0; i < 3; ++i)
+            {
+                const float c = alpha * ((top >> (8 * i)) & 0xFF) + (1.0f - alpha) * ((bottom >> (8 * i)) & 0xFF);
+                output |= static_cast<unsigned int>(std::min(255.0f, c)) << (8 * i);
+            }
+            return output;
+        }
+
+        MapRenderer::MapRenderer(const std::shared_ptr<World> world_)
+        {
+            world = world_;
+        }
+
+        MapRenderer::~MapRenderer()
+        {
+
+        }
+
+        const std::vector<unsigned char> MapRenderer::RenderTile(const int min_x, const int min_z, const int width, const int depth)
+        {
+            const ChunkCopies chunks = CopyChunks(min_x, min_z, min_x + width - 1, min_z + depth - 1);
+            return RenderTile(min_x, min_z, width, depth, chunks);
+        }
+
+        const int MapRenderer::RenderRegion(const int min_x, const int min_z, const int max_x, const int max_z,
+            const int tile_size, const std::string& folder, const int num_threads)
+        {
+            if (tile_size < 1 || max_x < min_x || max_z < min_z)
+            {
+                return 0;
+            }
+
+            // Copy everything in one go, so the world is only locked once
+            // and all the tiles are rendered from the same state
+            const ChunkCopies chunks = CopyChunks(min_x, min_z, max_x, max_z);
+
+            const int min_tile_x = static_cast<int>(std::floor(min_x / static_cast<double>(tile_size)));
+            const int min_tile_z = static_cast<int>(std::floor(min_z / static_cast<double>(tile_size)));
+            const int max_tile_x = static_cast<int>(std::floor(max_x / static_cast<double>(tile_size)));
+            const int max_tile_z = static_cast<int>(std::floor(max_z / static_cast<double>(tile_size)));
+            const int num_tiles_x = max_tile_x - min_tile_x + 1;
+            const int num_tiles = num_tiles_x * (max_tile_z - min_tile_z + 1);
+
+            std::atomic<int> next_tile = 0;
+            std::atomic<int> num_saved = 0;
+            auto render_tiles = [&]()
+            {
+                while (true)
+                {
+                    const int tile = next_tile++;
+                    if (tile >= num_tiles)
+                    {
+                        return;
+                    }
+                    const int tile_x = min_tile_x + tile % num_tiles_x;
+                    const int tile_z = min_tile_z + tile / num_tiles_x;
+
+                    const std::vector<unsigned char> pixels = RenderTile(tile_x * tile_size, tile_z * tile_size, tile_size, tile_size, chunks);
+                    bool empty = true;
+                    for (size_t i = 3; i < pixels.size() && empty; i += 4)
+                    {
+                        empty = pixels[i] == 0;
+                    }
+                    if (empty)
+                    {
+                        continue;
+                    }
+
+                    WriteImage(folder + "/tile_" + std::to_string(tile_x) + "_" + std::to_string(tile_z) + ".png",
+                        tile_size, tile_size, 4, pixels.data(), false);
+                    num_saved++;
+                }
+            };
+
+            const int num_workers = std::max(1, std::min(num_tiles,
+                num_threads > 0 ? num_threads : static_cast<int>(std::thread::hardware_concurrency())));
+            std::vector<std::thread> workers;
+            for (int i = 1; i < num_workers; ++i)
+            {
+                workers.emplace_back(render_tiles);
+            }
+            render_tiles();
+            for (auto& t : workers)
+            {
+                t.join();
+            }
+
+            return num_saved;
+        }
+
+        const MapRenderer::ChunkCopies MapRenderer::CopyChunks(const int min_x, const int min_z, const int max_x, const int max_z) const
+        {
+            const int min_chunk_x = static_cast<int>(std::floor(min_x / static_cast<double>(CHUNK_WIDTH)));
+            const int min_chunk_z = static_cast<int>(std::floor((min_z - 1) / static_cast<double>(CHUNK_WIDTH)));
+            const int max_chunk_x = static_cast<int>(std::floor(max_x / static_cast<double>(CHUNK_WIDTH)));
+            const int max_chunk_z = static_cast<int>(std::floor(max_z / static_cast<double>(CHUNK_WIDTH)));
+
+            ChunkCopies output;
+            std::lock_guard<std::mutex> world_guard(world->GetMutex());
+            for (int x = min_chunk_x; x <= max_chunk_x; ++x)
+            {
+                for (int z = min_chunk_z; z <= max_chunk_z; ++z)
+                {
+                    std::shared_ptr<const Chunk> chunk = world->GetChunkCopy(x, z);
+                    if (chunk != nullptr)
+                    {
+                        output[{ x, z }] = chunk;
+                    }
+                }
+            }
+            return output;
+        }
+
+        const std::vector<unsigned char> MapRenderer::RenderTile(const int min_x, const int min_z, const int width, const int depth, const ChunkCopies& chunks)
+        {
+            std::vector<unsigned char> output(4 * std::max(0, width) * std::max(0, depth), 0);
+
+            // Consecutive blocks are mostly in the same chunk
+            std::pair<int, int> current_chunk_key = { 0, 0 };
+            std::shared_ptr<const ChunkColumns> current_chunk;
+            bool current_chunk_valid = false;
+            auto get_column = [&](const int x, const int z) -> const ColumnData*
+            {
+                const std::pair<int, int> chunk_key = {
+                    static_cast<int>(std::floor(x / static_cast<double>(CHUNK_WIDTH))),
+                    static_cast<int>(std::floor(z / static_cast<double>(CHUNK_WIDTH)))
+                };
+                if (!current_chunk_valid || chunk_key != current_chunk_key)
+                {
+                    current_chunk_key = chunk_key;
+                    current_chunk_valid = true;
+                    auto it = chunks.find(chunk_key);
+                    current_chunk = it == chunks.end() ? nullptr : GetChunkColumns(chunk_key.first, chunk_key.second, it->second);
+                }
+                if (current_chunk == nullptr)
+                {
+                    return nullptr;
+                }
+                const int local_x = x - chunk_key.first * CHUNK_WIDTH;
+                const int local_z = z - chunk_key.second * CHUNK_WIDTH;
+                return &current_chunk->columns[local_z * CHUNK_WIDTH + local_x];
+            };
+
+            // Height of the row north of the current one, for the shading
+            std::vector<int> previous_heights(std::max(0, width));
+            std::vector<bool> previous_valid(std::max(0, width), false);
+            for (int x = 0; x < width; ++x)
+            {
+                const ColumnData* column = get_column(min_x + x, min_z - 1);
+                if (column != nullptr)
+                {
+                    previous_heights[x] = column->height;
+                    previous_valid[x] = (column->color >> 24) != 0;
+                }
+            }
+
+            for (int z = 0; z < depth; ++z)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    const ColumnData* column = get_column(min_x + x, min_z + z);
+                    if (column == nullptr || (column->color >> 24) == 0)
+                    {
+                        previous_valid[x] = false;
+                        continue;
+                    }
+
+                    // Slopes facing north are brighter, like the in-game maps
+                    float shade = 1.0f;
+                    if (previous_valid[x])
+                    {
+                        shade = column->height > previous_heights[x] ? 1.1f : (column->height < previous_heights[x] ? 0.85f : 1.0f);
+                    }
+                    previous_heights[x] = column->height;
+                    previous_valid[x] = true;
+
+                    unsigned char* pixel = output.data() + 4 * (z * width + x);
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        pixel[i] = static_cast<unsigned char>(std::min(255.0f, shade * ((column->color >> (8 * i)) & 0xFF)));
+                    }
+                    pixel[3] = 0xFF;
+                }
+            }
+
+            return output;
+        }
+
+        const std::shared_ptr<const MapRenderer::ChunkColumns> MapRenderer::GetChunkColumns(const int x, const int z, const std::shared_ptr<const Chunk>& chunk)
+        {
+            const std::pair<int, int> key = { x, z };
+            {
+                std::lock_guard<std::mutex> columns_guard(mutex_columns);
+                auto it = chunk_columns.find(key);
+                if (it != chunk_columns.end() && it->second->blocks_version == chunk->GetBlocksVersion())
+                {
+                    return it->second;
+                }
+            }
+
+            AssetsManager& assets_manager = AssetsManager::getInstance();
+
+            // Not locked as it may be long, two threads can compute
+            // the same chunk but the results are identical anyway
+            std::shared_ptr<ChunkColumns> columns = std::make_shared<ChunkColumns>();
+            columns->blocks_version = chunk->GetBlocksVersion();
+            columns->columns = std::vector<ColumnData>(CHUNK_WIDTH * CHUNK_WIDTH, { 0, chunk->GetMinY() });
+
+            const int min_section_y = chunk->GetMinY() / SECTION_HEIGHT;
+            const int num_sections = chunk->GetHeight() / SECTION_HEIGHT;
+            for (int local_z = 0; local_z < CHUNK_WIDTH; ++local_z)
+            {
+                for (int local_x = 0; local_x < CHUNK_WIDTH; ++local_x)
+                {
+                    ColumnData& column = columns->columns[local_z * CHUNK_WIDTH + local_x];
+                    unsigned int water_color = 0;
+                    int water_depth = 0;
+                    bool found = false;
+                    // Start from the surface instead of the top of the chunk
+                    const int top_y = chunk->GetHighestBlock(local_x, local_z, HeightmapType::WorldSurface);
+                    for (int s = std::min(num_sections - 1, (top_y - chunk->GetMinY()) / SECTION_HEIGHT); s >= 0 && !found; --s)
+                    {
+                        const Section* section = chunk->GetSection(s);
+                        if (section == nullptr || section->GetNumNonAirBlocks() == 0)
+                        {
+                            continue;
+                        }
+                        for (int local_y = std::min(SECTION_HEIGHT - 1, top_y - chunk->GetMinY() - s * SECTION_HEIGHT); local_y >= 0 && !found; --local_y)
+                        {
+                            const Block* block = section->GetBlock(local_y * CHUNK_WIDTH * CHUNK_WIDTH + local_z * CHUNK_WIDTH + local_x);
+                            if (block == nullptr || block->HasFlag(BlockstateFlag::Air))
+                            {
+                                continue;
+                            }
+                            const Blockstate* blockstate = block->GetBlockstate();
+                            const BlockColor block_color = GetBlockColor(blockstate);
+                            if ((block_color.color >> 24) == 0)
+                            {
+                                continue;
+                            }
+
+                            const int y = (min_section_y + s) * SECTION_HEIGHT + local_y;
+                            unsigned int color = block_color.color;
+                            if (block_color.tinted || blockstate->GetTintType() == TintType::Water)
+                            {
+#if PROTOCOL_VERSION < 552
+                                const Biome* biome = assets_manager.GetBiome(chunk->GetBiome(local_x, local_z));
+#else
+                                const Biome* biome = assets_manager.GetBiome(chunk->GetBiome(local_x, y, local_z));
+#endif
+                                if (biome != nullptr)
+                                {
+                                    switch (blockstate->GetTintType())
+                                    {
+                                    case TintType::Grass:
+                                        color = MultiplyColors(color, biome->GetColorMultiplier(y, true));
+                                        break;
+                                    case TintType::Leaves:
+                                        color = MultiplyColors(color, biome->GetColorMultiplier(y, false));
+                                        break;
+                                    case TintType::Water:
+                                        color = MultiplyColors(color, biome->GetWaterColorMultiplier());
+                                        break;
+                                    default:
+                                        break;
+                                    }
+                                }
+                            }
+
+                            // Keep going through the water to blend it with the bottom
+                            if (blockstate->GetTintType() == TintType::Water)
+                            {
+                                if (water_depth == 0)
+                                {
+                                    water_color = color;
+                                    column.height = y;
+                                }
+                                water_depth += 1;
+                                continue;
+                            }
+
+                            found = true;
+                            if (water_depth == 0)
+                            {
+                                column.color = color | 0xFF000000;
+                                column.height = y;
+                            }
+                            else
+                            {
+                                column.color = BlendColors(water_color, color, std::min(0.9f, 0.5f + 0.04f * water_depth));
+                            }
+                        }
+                    }
+
+                    // Only water until the bottom of the world
+                    if (!found && water_depth > 0)
+                    {
+                        column.color = water_color | 0xFF000000;
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> columns_guard(mutex_columns);
+            chunk_columns[key] = columns;
+            return columns;
+        }
+
+        const MapRenderer::BlockColor MapRenderer::GetBlockColor(const Blockstate* blockstate)
+        {
+            {
+                std::shared_lock<std::shared_mutex> colors_lock(mutex_colors);
+                auto it = block_colors.find(blockstate);
+                if (it != block_colors.end())
+                {
+                    return it->second;
+                }
+            }
+
+            const BlockColor color = ComputeBlockColor(blockstate);
+            std::unique_lock<std::shared_mutex> colors_lock(mutex_colors);
+            block_colors[blockstate] = color;
+            return color;
+        }
+
+        const MapRenderer::BlockColor MapRenderer::ComputeBlockColor(const Blockstate* blockstate) const
+        {
+            BlockColor output{ 0, false };
+
+            const Atlas* atlas = AssetsManager::getInstance().GetAtlas();
+            if (atlas == nullptr || blockstate == nullptr)
+            {
+                return output;
+            }
+
+            // Use the face seen from above, or any face for
+            // the blocks without one (flowers, rails...)
+            const std::vector<FaceDescriptor>& faces = blockstate->GetModel(0).GetFaces();
+            const FaceDescriptor* face = nullptr;
+            for (const auto& f : faces)
+            {
+                if (f.orientation == Orientation::Top)
+                {
+                    face = &f;
+                    break;
+                }
+            }
+            if (face == nullptr && !faces.empty())
+            {
+                face = &faces[0];
+            }
+            if (face == nullptr || face->texture_names.empty())
+            {
+                return output;
+            }
+
+            // Average of the texture, weighted by the pixels alpha.
+            // Animated textures are vertical strips, only the first
+            // frame is used
+            const TextureData& texture = atlas->GetData(face->texture_names[0]);
+            const int texture_width = texture.size.first;
+            const int texture_height = std::min(texture.size.first, texture.size.second);
+            unsigned long long sum[3] = { 0, 0, 0 };
+            unsigned long long sum_alpha = 0;
+            for (int row = 0; row < texture_height; ++row)
+            {
+                for (int col = 0; col < texture_width; ++col)
+                {
+                    const unsigned char* pixel = atlas->Get(texture.position.second + row, texture.position.first + col);
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        sum[i] += pixel[i] * pixel[3];
+                    }
+                    sum_alpha += pixel[3];
+                }
+            }
+            if (sum_alpha == 0)
+            {
+                return output;
+            }
+
+            output.color = 0xFF000000;
+            for (int i = 0; i < 3; ++i)
+            {
+                output.color |= static_cast<unsigned int>(sum[i] / sum_alpha) << (8 * i);
+            }
+            output.tinted = !face->use_tintindexes.empty() && face->use_tintindexes[0];
+
+            return output;
+        }
+    } // Renderer
+} // Botcraft
\ No newline at end of file
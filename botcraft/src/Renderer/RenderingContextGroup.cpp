@@ -0,0 +1,223 @@
+#include "botcraft/Renderer/RenderingContextGroup.hpp"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+#include "botcraft/Renderer/Atlas.hpp"
+#include "botcraft/Renderer/Shader.hpp"
+
+#include "botcraft/Game/AssetsManager.hpp"
+
+#include "botcraft/Utilities/Logger.hpp"
+
+namespace
+{
+    /// @brief GLFW is initialized once for all the groups, and most of
+    /// its functions are not thread safe while each window is managed
+    /// by its own rendering thread
+    std::mutex glfw_mutex;
+    /// @brief Windows of all the groups, GLFW is terminated with the last one
+    size_t num_glfw_windows = 0;
+}
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        RenderingContextGroup::RenderingContextGroup()
+        {
+            imgui_used = false;
+            atlas_texture = 0;
+        }
+
+        RenderingContextGroup::~RenderingContextGroup()
+        {
+
+        }
+
+        const size_t RenderingContextGroup::GetNumWindows() const
+        {
+            std::lock_guard<std::mutex> lock(glfw_mutex);
+            return windows.size();
+        }
+
+        GLFWwindow* RenderingContextGroup::AddWindow(const int width, const int height, const bool headless, bool& use_imgui)
+        {
+            std::lock_guard<std::mutex> lock(glfw_mutex);
+
+            if (num_glfw_windows == 0 && !glfwInit())
+            {
+                LOG_ERROR("Failed to initialize GLFW");
+                return nullptr;
+            }
+
+            glfwDefaultWindowHints();
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+            glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+            if (headless)
+            {
+                glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            }
+
+            // Any window of the group can be used to share the objects,
+            // they stay alive as long as one context of the group exists
+            GLFWwindow* window = glfwCreateWindow(width, height, "RenderingManager", NULL, windows.empty() ? NULL : windows.front());
+            if (window == NULL)
+            {
+                LOG_ERROR("Failed to create GLFW window");
+                if (num_glfw_windows == 0)
+                {
+                    glfwTerminate();
+                }
+                return nullptr;
+            }
+            glfwMakeContextCurrent(window);
+
+            // glad: load all OpenGL function pointers
+            // ---------------------------------------
+            if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+            {
+                LOG_ERROR("Failed to initialize GLAD");
+                glfwDestroyWindow(window);
+                if (num_glfw_windows == 0)
+                {
+                    glfwTerminate();
+                }
+                return nullptr;
+            }
+
+            if (windows.empty() && !InitSharedGL())
+            {
+                glfwDestroyWindow(window);
+                if (num_glfw_windows == 0)
+                {
+                    glfwTerminate();
+                }
+                return nullptr;
+            }
+
+            windows.push_back(window);
+            num_glfw_windows += 1;
+
+            use_imgui = !imgui_used;
+            imgui_used = true;
+
+            return window;
+        }
+
+        void RenderingContextGroup::RemoveWindow(GLFWwindow* window, const bool used_imgui)
+        {
+            std::lock_guard<std::mutex> lock(glfw_mutex);
+
+            auto it = std::find(windows.begin(), windows.end(), window);
+            if (it == windows.end())
+            {
+                return;
+            }
+            windows.erase(it);
+
+            if (used_imgui)
+            {
+                imgui_used = false;
+            }
+
+            // Last context of the group, the shared objects would be deleted with
+            // it anyway, but the Shader destructors must run with a current context
+            if (windows.empty())
+            {
+                ClearSharedGL();
+            }
+
+            glfwDestroyWindow(window);
+            num_glfw_windows -= 1;
+            if (num_glfw_windows == 0)
+            {
+                glfwTerminate();
+            }
+        }
+
+        void RenderingContextGroup::PollEvents()
+        {
+            std::lock_guard<std::mutex> lock(glfw_mutex);
+            glfwPollEvents();
+        }
+
+        const unsigned int RenderingContextGroup::GetAtlasTexture() const
+        {
+            return atlas_texture;
+        }
+
+        Shader& RenderingContextGroup::GetShader()
+        {
+            return *shader;
+        }
+
+        Shader& RenderingContextGroup::GetPackedShader()
+        {
+            return *packed_shader;
+        }
+
+        const bool RenderingContextGroup::InitSharedGL()
+        {
+            const Atlas* atlas = AssetsManager::getInstance().GetAtlas();
+            if (atlas == nullptr)
+            {
+                LOG_ERROR("Can't create atlas texture, assets are not loaded");
+                return false;
+            }
+
+            shader = std::unique_ptr<Shader>(new Shader);
+            packed_shader = std::unique_ptr<Shader>(new Shader("", "", true));
+
+            //Set an uniform buffer for view matrix
+            unsigned int uniform_view_block_index = glGetUniformBlockIndex(shader->Program(), "MatriceView");
+            glUniformBlockBinding(shader->Program(), uniform_view_block_index, 0);
+            uniform_view_block_index = glGetUniformBlockIndex(packed_shader->Program(), "MatriceView");
+            glUniformBlockBinding(packed_shader->Program(), uniform_view_block_index, 0);
+
+            //Atlas is on texture unit 0, face templates on unit 1
+            packed_shader->Use();
+            packed_shader->SetInt("atlas_texture", 0);
+            packed_shader->SetInt("face_templates", 1);
+            glUseProgram(0);
+
+            //Create a texture
+            glGenTextures(1, &atlas_texture);
+            glBindTexture(GL_TEXTURE_2D, atlas_texture);
+
+            //Options
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+            float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas->GetWidth(), atlas->GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas->Get());
+            glGenerateMipmap(GL_TEXTURE_2D);
+
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            // Make sure the objects are complete before
+            // the other contexts of the group use them
+            glFinish();
+
+            return true;
+        }
+
+        void RenderingContextGroup::ClearSharedGL()
+        {
+            glDeleteTextures(1, &atlas_texture);
+            atlas_texture = 0;
+            shader.reset();
+            packed_shader.reset();
+        }
+    } // Renderer
+} // Botcraft
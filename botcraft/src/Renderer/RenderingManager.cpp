@@ -7,6 +7,9 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <unordered_set>
+#include <array>
+#include <algorithm>
+#include <limits>
 
 #ifdef USE_IMGUI
 #include <imgui.h>
@@ -16,13 +19,16 @@ static bool imgui_demo = false;
 #endif
 
 #include "botcraft/Renderer/Atlas.hpp"
+#include "botcraft/Renderer/RenderingContextGroup.hpp"
 #include "botcraft/Renderer/Shader.hpp"
-#include "botcraft/Renderer/ImageSaver.hpp"
+#include "botcraft/Renderer/ScreenshotWriter.hpp"
 #include "botcraft/Renderer/WorldRenderer.hpp"
 #include "botcraft/Renderer/Camera.hpp"
 #include "botcraft/Renderer/Chunk.hpp"
 #include "botcraft/Renderer/TransparentChunk.hpp"
 
+#include "botcraft/AI/BehaviourProfiler.hpp"
+
 #include "botcraft/Game/AssetsManager.hpp"
 #include "botcraft/Game/World/World.hpp"
 #include "botcraft/Game/World/Block.hpp"
@@ -34,8 +40,13 @@ static bool imgui_demo = false;
 #include "botcraft/Game/Inventory/InventoryManager.hpp"
 #include "botcraft/Game/Inventory/Window.hpp"
 
+#include "botcraft/Network/NetworkManager.hpp"
+
+#include "protocolCraft/MessageFactory.hpp"
+
 #include "botcraft/Utilities/Logger.hpp"
 #include "botcraft/Utilities/SleepUtilities.hpp"
+#include "botcraft/Utilities/Tracing.hpp"
 
 const std::vector<float> color_day({ 0.6f, 0.85f, 0.9f });
 const std::vector<float> color_night({0.1f, 0.1f, 0.1f});
@@ -47,14 +58,22 @@ namespace Botcraft
         RenderingManager::RenderingManager(std::shared_ptr<World> world_, std::shared_ptr<InventoryManager> inventory_manager_,
             std::shared_ptr<EntityManager> entity_manager_,
             const unsigned int &window_width, const unsigned int &window_height,
-            const unsigned int section_height_, const bool headless)
+            const unsigned int section_height_, const bool headless,
+            std::shared_ptr<RenderingContextGroup> context_group_)
         {
             world = world_;
             inventory_manager = inventory_manager_;
             entity_manager = entity_manager_;
+            network_manager = nullptr;
+            context_group = context_group_ ? context_group_ : std::make_shared<RenderingContextGroup>();
+            window = nullptr;
+            imgui_enabled = false;
 #if USE_IMGUI
             inventory_open = false;
             last_time_inventory_changed = 0;
+            frame_times.fill(0.0f);
+            frame_times_index = 0;
+            last_packet_rates_time = std::chrono::steady_clock::now();
 #endif
 
             mouse_last_x = window_width / 2.0f;
@@ -72,14 +91,29 @@ namespace Botcraft
             KeyboardCallback = [](std::array<bool, (int)KEY_CODE::NUMBER_OF_KEYS>, float) {};
 
             world_renderer = std::make_unique<WorldRenderer>(section_height_);
+            section_height = section_height_;
 
             take_screenshot = false;
+            screenshot_writer = std::make_unique<ScreenshotWriter>();
 
             day_time = 0.0f;
 
+            mesh_queue_should_be_sorted = false;
+            mesh_queue_camera_yaw = 0.0f;
+            mesh_queue_camera_pitch = 0.0f;
+
+            render_on_demand = false;
+            redraw_requested = true;
+            max_fps = 60;
+
             running = true;
             rendering_thread = std::thread(&RenderingManager::Run, this, headless);
             thread_updating_renderable = std::thread(&RenderingManager::WaitForRenderingUpdate, this);
+            const unsigned int num_meshing_threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+            for (unsigned int i = 0; i < num_meshing_threads; ++i)
+            {
+                meshing_threads.push_back(std::thread(&RenderingManager::MeshChunks, this));
+            }
 
         }
 
@@ -95,6 +129,13 @@ namespace Botcraft
             {
                 thread_updating_renderable.join();
             }
+            for (size_t i = 0; i < meshing_threads.size(); ++i)
+            {
+                if (meshing_threads[i].joinable())
+                {
+                    meshing_threads[i].join();
+                }
+            }
 
             if (rendering_thread.joinable())
             {
@@ -111,67 +152,82 @@ namespace Botcraft
                 return;
             }
 
-            my_shader->Use();
+            context_group->GetShader().Use();
             float real_fps = 1.0f;
+            std::chrono::steady_clock::time_point last_render_time;
 
             while (!glfwWindowShouldClose(window))
             {
                 double currentFrame = glfwGetTime();
                 auto start = std::chrono::steady_clock::now();
 
-                //Max 60 FPS
-                auto end = start + std::chrono::microseconds(1000000 / 60);
+                const unsigned int current_max_fps = max_fps;
+                auto end = current_max_fps == 0 ? start : start + std::chrono::microseconds(1000000 / current_max_fps);
 
                 deltaTime = currentFrame - lastFrameTime;
                 lastFrameTime = currentFrame;
 
                 InternalProcessInput(window);
 
-#ifdef USE_IMGUI
-                ImGui_ImplOpenGL3_NewFrame();
-                ImGui_ImplGlfw_NewFrame();
-                ImGui::NewFrame();
-
-                if (imgui_demo)
+                // Nothing changed, only poll the inputs
+                if (render_on_demand && !redraw_requested.exchange(false) && !take_screenshot && !has_proj_changed &&
+                    start - last_render_time < std::chrono::seconds(1))
                 {
-                    ImGui::ShowDemoWindow(&imgui_demo);
+                    context_group->PollEvents();
+                    screenshot_writer->Update();
+                    SleepUntil(current_max_fps == 0 ? start + std::chrono::milliseconds(1) : end);
+                    continue;
                 }
+                last_render_time = start;
 
+#ifdef USE_IMGUI
+                if (imgui_enabled)
                 {
-                    ImGui::SetNextWindowPos(ImVec2(0, 0));
-                    ImGui::SetNextWindowSize(ImVec2(290, 70));
-                    ImGui::Begin("Position");
-                    ImGui::Text("%f, %f, %f", world_renderer->GetCamera()->GetPosition().x, world_renderer->GetCamera()->GetPosition().y - 1.62f, world_renderer->GetCamera()->GetPosition().z);
-                    ImGui::Text("Yaw: %f  ||  ", world_renderer->GetCamera()->GetYaw());
-                    ImGui::SameLine();
-                    ImGui::Text("Pitch: %f", world_renderer->GetCamera()->GetPitch());
-                    ImGui::End();
-                }
-                {
-                    ImGui::SetNextWindowPos(ImVec2(0, 75));
-                    ImGui::SetNextWindowSize(ImVec2(290, 70));
-                    ImGui::Begin("Targeted cube");
-                    Position raycasted_pos;
-                    Position raycasted_normal;
-                    const Blockstate* raycasted_blockstate;
+                    ImGui_ImplOpenGL3_NewFrame();
+                    ImGui_ImplGlfw_NewFrame();
+                    ImGui::NewFrame();
+
+                    if (imgui_demo)
                     {
-                        std::lock_guard<std::mutex> world_guard(world->GetMutex());
-                        raycasted_blockstate =
-                            world->Raycast(Vector3<double>(world_renderer->GetCamera()->GetPosition().x, world_renderer->GetCamera()->GetPosition().y, world_renderer->GetCamera()->GetPosition().z),
-                            Vector3<double>(world_renderer->GetCamera()->GetFront().x, world_renderer->GetCamera()->GetFront().y, world_renderer->GetCamera()->GetFront().z),
-                            6.0f, raycasted_pos, raycasted_normal);
+                        ImGui::ShowDemoWindow(&imgui_demo);
                     }
-                    if (raycasted_blockstate)
+
                     {
-                        ImGui::Text("Watching block at %i, %i, %i", raycasted_pos.x, raycasted_pos.y, raycasted_pos.z);
-                        ImGui::Text((std::string("Block: ") + raycasted_blockstate->GetName()).c_str());
+                        ImGui::SetNextWindowPos(ImVec2(0, 0));
+                        ImGui::SetNextWindowSize(ImVec2(290, 70));
+                        ImGui::Begin("Position");
+                        ImGui::Text("%f, %f, %f", world_renderer->GetCamera()->GetPosition().x, world_renderer->GetCamera()->GetPosition().y - 1.62f, world_renderer->GetCamera()->GetPosition().z);
+                        ImGui::Text("Yaw: %f  ||  ", world_renderer->GetCamera()->GetYaw());
+                        ImGui::SameLine();
+                        ImGui::Text("Pitch: %f", world_renderer->GetCamera()->GetPitch());
+                        ImGui::End();
                     }
-                    else
                     {
-                        ImGui::Text("Watching block at");
-                        ImGui::Text("Block: ");
+                        ImGui::SetNextWindowPos(ImVec2(0, 75));
+                        ImGui::SetNextWindowSize(ImVec2(290, 70));
+                        ImGui::Begin("Targeted cube");
+                        Position raycasted_pos;
+                        Position raycasted_normal;
+                        const Blockstate* raycasted_blockstate;
+                        {
+                            std::lock_guard<std::mutex> world_guard(world->GetMutex());
+                            raycasted_blockstate =
+                                world->Raycast(Vector3<double>(world_renderer->GetCamera()->GetPosition().x, world_renderer->GetCamera()->GetPosition().y, world_renderer->GetCamera()->GetPosition().z),
+                                Vector3<double>(world_renderer->GetCamera()->GetFront().x, world_renderer->GetCamera()->GetFront().y, world_renderer->GetCamera()->GetFront().z),
+                                6.0f, raycasted_pos, raycasted_normal);
+                        }
+                        if (raycasted_blockstate)
+                        {
+                            ImGui::Text("Watching block at %i, %i, %i", raycasted_pos.x, raycasted_pos.y, raycasted_pos.z);
+                            ImGui::Text((std::string("Block: ") + raycasted_blockstate->GetName()).c_str());
+                        }
+                        else
+                        {
+                            ImGui::Text("Watching block at");
+                            ImGui::Text("Block: ");
+                        }
+                        ImGui::End();
                     }
-                    ImGui::End();
                 }
 #endif
                 const float current_day_time = day_time;
@@ -189,138 +245,182 @@ namespace Botcraft
                 if (has_proj_changed)
                 {
                     glm::mat4 projection = glm::perspective(glm::radians(45.0f), current_window_width / (float)current_window_height, 0.1f, 200.0f);
-                    my_shader->SetMat4("projection", projection);
                     world_renderer->SetCameraProjection(projection);
                     has_proj_changed = false;
                 }
                 
                 world_renderer->UpdateFaces();
 
-                my_shader->Use();
-
                 //Draw all faces
                 world_renderer->UseAtlasTextureGL();
 
 #ifdef USE_IMGUI
-                int num_chunks, num_rendered_chunks, num_entities, num_rendered_entities, num_faces, num_rendered_faces;
-                world_renderer->RenderFaces(&num_chunks, &num_rendered_chunks, &num_entities, &num_rendered_entities, &num_faces, &num_rendered_faces);
-                {
-                    ImGui::SetNextWindowPos(ImVec2(current_window_width, 0), 0, ImVec2(1.0f, 0.0f));
-                    ImGui::SetNextWindowSize(ImVec2(180, 170));
-                    ImGui::Begin("Rendering");
-                    ImGui::Text("Lim. FPS: %.1f (%.2fms)", 1.0 / deltaTime, deltaTime * 1000.0);
-                    ImGui::Text("Real FPS: %.1f (%.2fms)", 1.0 / real_fps, real_fps * 1000.0);
-                    ImGui::Text("Loaded sections: %i", num_chunks);
-                    ImGui::Text("Rendered sections: %i", num_rendered_chunks);
-                    ImGui::Text("Num entities: %i", num_entities);
-                    ImGui::Text("Rendered entities: %i", num_rendered_entities);
-                    ImGui::Text("Loaded faces: %i", num_faces);
-                    ImGui::Text("Rendered faces: %i", num_rendered_faces);
-                    ImGui::End();
+                int num_chunks, num_rendered_chunks, num_entities, num_rendered_entities, num_faces, num_rendered_faces, num_draw_calls;
+                world_renderer->RenderFaces(context_group->GetPackedShader(), context_group->GetShader(), &num_chunks, &num_rendered_chunks, &num_entities, &num_rendered_entities, &num_faces, &num_rendered_faces, &num_draw_calls);
+                if (imgui_enabled)
+                {
+                    {
+                        ImGui::SetNextWindowPos(ImVec2(current_window_width, 0), 0, ImVec2(1.0f, 0.0f));
+                        ImGui::SetNextWindowSize(ImVec2(180, 185));
+                        ImGui::Begin("Rendering");
+                        ImGui::Text("Lim. FPS: %.1f (%.2fms)", 1.0 / deltaTime, deltaTime * 1000.0);
+                        ImGui::Text("Real FPS: %.1f (%.2fms)", 1.0 / real_fps, real_fps * 1000.0);
+                        ImGui::Text("Loaded sections: %i", num_chunks);
+                        ImGui::Text("Rendered sections: %i", num_rendered_chunks);
+                        ImGui::Text("Num entities: %i", num_entities);
+                        ImGui::Text("Rendered entities: %i", num_rendered_entities);
+                        ImGui::Text("Loaded faces: %i", num_faces);
+                        ImGui::Text("Rendered faces: %i", num_rendered_faces);
+                        ImGui::Text("Draw calls: %i", num_draw_calls);
+                        ImGui::End();
+                    }
+                    DrawPerformanceOverlay(num_chunks, num_rendered_chunks);
                 }
 #else
-                world_renderer->RenderFaces();
+                world_renderer->RenderFaces(context_group->GetPackedShader(), context_group->GetShader());
 #endif
 
                 glBindVertexArray(0);
                 glBindTexture(GL_TEXTURE_2D, 0);
 
 #ifdef USE_IMGUI
-                // Draw the inventory if it's open
-                if (inventory_open)
+                if (imgui_enabled)
                 {
-                    ImGui::SetNextWindowPos(ImVec2(current_window_width, current_window_height), 0, ImVec2(1.0f, 1.0f));
-                    ImGui::SetNextWindowSize(ImVec2(300, 450));
-                    ImGui::Begin("Inventory");
-                    if (inventory_manager && inventory_manager->GetPlayerInventory())
+                    // Draw the inventory if it's open
+                    if (inventory_open)
                     {
-                        const std::map<short, ProtocolCraft::Slot>& slots = inventory_manager->GetPlayerInventory()->GetSlots();
-                        for (short i = 0; i <= Window::INVENTORY_OFFHAND_INDEX; ++i)
+                        ImGui::SetNextWindowPos(ImVec2(current_window_width, current_window_height), 0, ImVec2(1.0f, 1.0f));
+                        ImGui::SetNextWindowSize(ImVec2(300, 450));
+                        ImGui::Begin("Inventory");
+                        if (inventory_manager && inventory_manager->GetPlayerInventory())
                         {
-                            auto it = slots.find(i);
-                            if (it == slots.end())
-                            {
-                                continue;
-                            }
-                            if (i == Window::INVENTORY_CRAFTING_OUTPUT_INDEX)
-                            {
-                                ImGui::Text("Crafting output");
-                            }
-                            else if (i == Window::INVENTORY_CRAFTING_INPUT_START)
-                            {
-                                ImGui::Text("Crafting input");
-                            }
-                            else if (i == Window::INVENTORY_ARMOR_START)
-                            {
-                                ImGui::Text("Equiped Armor");
-                            }
-                            else if (i == Window::INVENTORY_STORAGE_START)
-                            {
-                                ImGui::Text("Inventory");
-                            }
-                            else if (i == Window::INVENTORY_HOTBAR_START)
+                            const std::vector<ProtocolCraft::Slot>& slots = inventory_manager->GetPlayerInventory()->GetSlots();
+                            for (short i = 0; i <= Window::INVENTORY_OFFHAND_INDEX && i < static_cast<short>(slots.size()); ++i)
                             {
-                                ImGui::Text("Hotbar");
-                            }
-                            else if (i == Window::INVENTORY_OFFHAND_INDEX)
-                            {
-                                ImGui::Text("Offhand");
-                            }
+                                if (i == Window::INVENTORY_CRAFTING_OUTPUT_INDEX)
+                                {
+                                    ImGui::Text("Crafting output");
+                                }
+                                else if (i == Window::INVENTORY_CRAFTING_INPUT_START)
+                                {
+                                    ImGui::Text("Crafting input");
+                                }
+                                else if (i == Window::INVENTORY_ARMOR_START)
+                                {
+                                    ImGui::Text("Equiped Armor");
+                                }
+                                else if (i == Window::INVENTORY_STORAGE_START)
+                                {
+                                    ImGui::Text("Inventory");
+                                }
+                                else if (i == Window::INVENTORY_HOTBAR_START)
+                                {
+                                    ImGui::Text("Hotbar");
+                                }
+                                else if (i == Window::INVENTORY_OFFHAND_INDEX)
+                                {
+                                    ImGui::Text("Offhand");
+                                }
+                                if (slots[i].IsEmptySlot())
+                                {
+                                    continue;
+                                }
 #if PROTOCOL_VERSION < 347
-                            std::string name = AssetsManager::getInstance().Items().at(it->second.GetBlockID()).at(it->second.GetItemDamage())->GetName();
+                                std::string name = AssetsManager::getInstance().GetItem(slots[i].GetBlockID(), slots[i].GetItemDamage())->GetName();
 #else
-                            std::string name = AssetsManager::getInstance().Items().at(it->second.GetItemID())->GetName();
+                                std::string name = AssetsManager::getInstance().GetItem(slots[i].GetItemID())->GetName();
 #endif
-                            if (name != "minecraft:air")
-                            {
-                                ImGui::Text(std::string("    (%i) " + name + " (x%i)").c_str(), i, it->second.GetItemCount());
+                                if (name != "minecraft:air")
+                                {
+                                    ImGui::Text(std::string("    (%i) " + name + " (x%i)").c_str(), i, slots[i].GetItemCount());
+                                }
                             }
                         }
+                        ImGui::End();
                     }
-                    ImGui::End();
-                }
 
+                    // Draw the behaviour profiler stats if any
+                    {
+                        const std::vector<NodeProfile> profiles = BehaviourProfiler::GetInstance().GetProfiles();
+                        if (!profiles.empty())
+                        {
+                            ImGui::SetNextWindowPos(ImVec2(0, current_window_height), 0, ImVec2(0.0f, 1.0f));
+                            ImGui::SetNextWindowSize(ImVec2(420, 200));
+                            ImGui::Begin("Behaviour profiler");
+                            ImGui::Columns(5);
+                            ImGui::Text("Node"); ImGui::NextColumn();
+                            ImGui::Text("Ticks"); ImGui::NextColumn();
+                            ImGui::Text("Success"); ImGui::NextColumn();
+                            ImGui::Text("Avg (ms)"); ImGui::NextColumn();
+                            ImGui::Text("Max (ms)"); ImGui::NextColumn();
+                            for (size_t i = 0; i < profiles.size(); ++i)
+                            {
+                                const NodeProfile& p = profiles[i];
+                                ImGui::Text("%s", p.name.c_str()); ImGui::NextColumn();
+                                ImGui::Text("%llu", p.num_ticks); ImGui::NextColumn();
+                                ImGui::Text("%.1f%%", p.num_ticks == 0 ? 0.0 : 100.0 * p.num_success / p.num_ticks); ImGui::NextColumn();
+                                ImGui::Text("%.2f", p.num_ticks == 0 ? 0.0 : p.total_ms / p.num_ticks); ImGui::NextColumn();
+                                ImGui::Text("%.2f", p.max_ms); ImGui::NextColumn();
+                            }
+                            ImGui::Columns(1);
+                            ImGui::End();
+                        }
+                    }
 
-                ImGui::Render();
+                    ImGui::Render();
 
-                // Render ImGui
-                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                    // Render ImGui
+                    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                }
 #endif
-                glfwSwapBuffers(window);
-                glfwPollEvents();
-
+                screenshot_writer->Update();
                 if (take_screenshot)
                 {
-                    std::vector<unsigned char> pixels(current_window_height * current_window_width * 3);
-                    glReadPixels(0, 0, current_window_width, current_window_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
-
-                    WriteImage(screenshot_path, current_window_height, current_window_width, 3, pixels.data(), true);
-                    take_screenshot = false;
+                    std::lock_guard<std::mutex> lock(mutex_screenshot);
+                    // If the previous captures are not read yet, try again next frame
+                    if (!screenshot_paths.empty() && screenshot_writer->Capture(screenshot_paths.front(), current_window_width, current_window_height))
+                    {
+                        screenshot_paths.pop_front();
+                    }
+                    take_screenshot = !screenshot_paths.empty();
                 }
 
+                glfwSwapBuffers(window);
+                context_group->PollEvents();
+
                 real_fps = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1e6;
+#ifdef USE_IMGUI
+                frame_times[frame_times_index] = real_fps * 1000.0f;
+                frame_times_index = (frame_times_index + 1) % frame_times.size();
+#endif
                 
                 //Wait to have 60 FPS
                 SleepUntil(end);
             }
 
+            screenshot_writer->ClearGL();
             world_renderer.reset();
-            my_shader.reset();
 
 #ifdef USE_IMGUI
-            // ImGui cleaning
-            ImGui_ImplOpenGL3_Shutdown();
-            ImGui_ImplGlfw_Shutdown();
-            ImGui::DestroyContext();
+            if (imgui_enabled)
+            {
+                // ImGui cleaning
+                ImGui_ImplOpenGL3_Shutdown();
+                ImGui_ImplGlfw_Shutdown();
+                ImGui::DestroyContext();
+            }
 #endif
 
-            glfwDestroyWindow(window);
-            glfwTerminate();
+            // Also deletes the shared objects if it's the last window of the group
+            context_group->RemoveWindow(window, imgui_enabled);
         }
 
         void RenderingManager::Close()
         {
-            glfwSetWindowShouldClose(window, true);
+            if (window != nullptr)
+            {
+                glfwSetWindowShouldClose(window, true);
+            }
             running = false;
         }
 
@@ -336,33 +436,19 @@ namespace Botcraft
 
         void RenderingManager::Screenshot(const std::string &path)
         {
-            screenshot_path = path;
+            std::lock_guard<std::mutex> lock(mutex_screenshot);
+            screenshot_paths.push_back(path);
             take_screenshot = true;
         }
 
         bool RenderingManager::Init(const bool headless)
         {
-            glfwInit();
-            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#ifdef __APPLE__
-            glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-
-            if (headless)
-            {
-                glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
-            }
-
-            window = glfwCreateWindow(current_window_width, current_window_height, "RenderingManager", NULL, NULL);
-            if (window == NULL)
+            // Also makes the window context current
+            window = context_group->AddWindow(current_window_width, current_window_height, headless, imgui_enabled);
+            if (window == nullptr)
             {
-                LOG_ERROR("Failed to create GLFW window");
-                glfwTerminate();
                 return false;
             }
-            glfwMakeContextCurrent(window);
             //set the user pointer of the window to this object to pass it to the callbacks
             glfwSetWindowUserPointer(window, this);
             glfwSetFramebufferSizeCallback(window, &RenderingManager::ResizeCallback);
@@ -370,43 +456,33 @@ namespace Botcraft
 
             glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-            // glad: load all OpenGL function pointers
-            // ---------------------------------------
-            if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-            {
-                LOG_ERROR("Failed to initialize GLAD");
-                return false;
-            }
-
 #ifdef USE_IMGUI
-            // imgui: setup context
-            // ---------------------------------------
-            IMGUI_CHECKVERSION();
-            ImGui::CreateContext();
-            ImGuiIO &io = ImGui::GetIO();
+            if (imgui_enabled)
+            {
+                // imgui: setup context
+                // ---------------------------------------
+                IMGUI_CHECKVERSION();
+                ImGui::CreateContext();
+                ImGuiIO &io = ImGui::GetIO();
 
-            io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+                io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
 
-            // Style
-            ImGui::StyleColorsDark();
+                // Style
+                ImGui::StyleColorsDark();
 
-            // Setup platform/renderer
-            ImGui_ImplGlfw_InitForOpenGL(window, true);
-            ImGui_ImplOpenGL3_Init("#version 330");
+                // Setup platform/renderer
+                ImGui_ImplGlfw_InitForOpenGL(window, true);
+                ImGui_ImplOpenGL3_Init("#version 330");
+            }
 #endif
 
-            my_shader = std::unique_ptr<Shader>(new Shader);
-
             glEnable(GL_DEPTH_TEST);
             //glEnable(GL_CULL_FACE); 
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-            //Set an uniform buffer for view matrix
-            unsigned int uniform_view_block_index = glGetUniformBlockIndex(my_shader->Program(), "MatriceView");
-            glUniformBlockBinding(my_shader->Program(), uniform_view_block_index, 0);
-
-            world_renderer->InitGL();
+            world_renderer->InitGL(context_group->GetAtlasTexture());
+            screenshot_writer->InitGL();
 
             return true;
         }
@@ -420,6 +496,11 @@ namespace Botcraft
             this_object->has_proj_changed = true;
         }
 
+        void RenderingManager::RequestRedraw()
+        {
+            redraw_requested = true;
+        }
+
         void RenderingManager::InternalMouseCallback(GLFWwindow *window, double xpos, double ypos)
         {
             RenderingManager *this_object = static_cast<RenderingManager*>(glfwGetWindowUserPointer(window));
@@ -437,6 +518,7 @@ namespace Botcraft
             this_object->mouse_last_x = xpos;
             this_object->mouse_last_y = ypos;
             this_object->MouseCallback(xoffset, yoffset);
+            this_object->RequestRedraw();
         }
 
         void RenderingManager::InternalProcessInput(GLFWwindow *window)
@@ -480,6 +562,14 @@ namespace Botcraft
                 isKeyPressed[(int)KEY_CODE::MOUSE_LEFT] = true;
             }
 
+            // Any input may change the view or the overlay
+            if (std::find(isKeyPressed.begin(), isKeyPressed.end(), true) != isKeyPressed.end() ||
+                glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS ||
+                glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS)
+            {
+                RequestRedraw();
+            }
+
 #ifdef USE_IMGUI
             if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS)
             {
@@ -502,10 +592,9 @@ namespace Botcraft
             }
 #endif
 
-            if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS)
+            if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS && !take_screenshot)
             {
-                screenshot_path = "screenshot.png";
-                take_screenshot = true;
+                Screenshot("screenshot.png");
             }
 
             KeyboardCallback(isKeyPressed, deltaTime);
@@ -522,7 +611,53 @@ namespace Botcraft
             std::lock_guard<std::mutex> guard_rendering(mutex_updating);
             for (int i = 0; i < chunk_pos.size(); ++i)
             {
-                chunks_to_udpate.insert(chunk_pos[i]);
+                AddToMeshQueue(chunk_pos[i], true);
+            }
+            condition_update.notify_all();
+        }
+
+        void RenderingManager::AddBlocksToUpdate(const std::vector<Position>& positions)
+        {
+            const int height = static_cast<int>(section_height);
+
+            std::lock_guard<std::mutex> guard_rendering(mutex_updating);
+            for (const auto& p : positions)
+            {
+                const Position chunk_coords = Botcraft::Chunk::BlockCoordsToChunkCoords(p);
+                // Floor division, to get the right section for negative y
+                const int section_y = (p.y >= 0 ? p.y : p.y - height + 1) / height;
+                const int local_x = p.x - CHUNK_WIDTH * chunk_coords.x;
+                const int local_y = p.y - height * section_y;
+                const int local_z = p.z - CHUNK_WIDTH * chunk_coords.z;
+
+                const Position section(chunk_coords.x, section_y, chunk_coords.z);
+                AddToMeshQueue(section, false);
+
+                // Faces of the neighbour blocks may be hidden or revealed
+                if (local_x == 0)
+                {
+                    AddToMeshQueue(section + Position(-1, 0, 0), false);
+                }
+                else if (local_x == CHUNK_WIDTH - 1)
+                {
+                    AddToMeshQueue(section + Position(1, 0, 0), false);
+                }
+                if (local_y == 0)
+                {
+                    AddToMeshQueue(section + Position(0, -1, 0), false);
+                }
+                else if (local_y == height - 1)
+                {
+                    AddToMeshQueue(section + Position(0, 1, 0), false);
+                }
+                if (local_z == 0)
+                {
+                    AddToMeshQueue(section + Position(0, 0, -1), false);
+                }
+                else if (local_z == CHUNK_WIDTH - 1)
+                {
+                    AddToMeshQueue(section + Position(0, 0, 1), false);
+                }
             }
             condition_update.notify_all();
         }
@@ -538,57 +673,245 @@ namespace Botcraft
         {
             if (world_renderer)
             {
-                world_renderer->SetPosOrientation(x_, y_, z_, yaw_, pitch_);
+                if (world_renderer->SetPosOrientation(x_, y_, z_, yaw_, pitch_))
+                {
+                    RequestRedraw();
+                }
+                if (world_renderer->GetTransparentFacesShouldBeSorted())
+                {
+                    // Wake up a meshing thread to sort them
+                    std::lock_guard<std::mutex> guard_rendering(mutex_updating);
+                    condition_update.notify_all();
+                }
+
+                // Chunks can only cross the LOD distance when the camera changes chunk
+                const Position camera_chunk(static_cast<int>(std::floor(x_ / CHUNK_WIDTH)), 0, static_cast<int>(std::floor(z_ / CHUNK_WIDTH)));
+                std::lock_guard<std::mutex> guard_rendering(mutex_updating);
+                if (!(camera_chunk == lod_camera_chunk))
+                {
+                    lod_camera_chunk = camera_chunk;
+                    AddOutdatedLodChunksToUpdate();
+                }
+
+                // Mesh priorities depend on the distance and the view frustum
+                if (!(camera_chunk == mesh_queue_camera_chunk) ||
+                    std::abs(yaw_ - mesh_queue_camera_yaw) > 30.0f ||
+                    std::abs(pitch_ - mesh_queue_camera_pitch) > 30.0f)
+                {
+                    mesh_queue_camera_chunk = camera_chunk;
+                    mesh_queue_camera_yaw = yaw_;
+                    mesh_queue_camera_pitch = pitch_;
+                    mesh_queue_should_be_sorted = true;
+                }
             }
         }
 
-        void RenderingManager::WaitForRenderingUpdate()
+        void RenderingManager::SetLodDistance(const float d)
         {
-            Logger::GetInstance().RegisterThread("RenderingDataUpdate");
-            while (running)
+            if (world_renderer)
             {
-                {
-                    std::unique_lock<std::mutex> lck(mutex_updating);
-                    condition_update.wait(lck);
-                }
+                world_renderer->SetLodDistance(d);
+                std::lock_guard<std::mutex> guard_rendering(mutex_updating);
+                AddOutdatedLodChunksToUpdate();
+            }
+        }
+
+        void RenderingManager::SetCaveCulling(const bool b)
+        {
+            if (world_renderer)
+            {
+                world_renderer->SetCaveCulling(b);
+                RequestRedraw();
+            }
+        }
+
+        void RenderingManager::SetRenderOnDemand(const bool b)
+        {
+            render_on_demand = b;
+            RequestRedraw();
+        }
+
+        void RenderingManager::SetMaxFPS(const unsigned int fps)
+        {
+            max_fps = fps;
+        }
+
+        void RenderingManager::SetNetworkManager(std::shared_ptr<NetworkManager> network_manager_)
+        {
+            std::lock_guard<std::mutex> lock(mutex_network_manager);
+            network_manager = network_manager_;
+        }
+
+        const size_t RenderingManager::GetGPUMemory() const
+        {
+            return world_renderer ? world_renderer->GetGPUMemory() : 0;
+        }
+
+#ifdef USE_IMGUI
+        void RenderingManager::DrawPerformanceOverlay(const int num_chunks, const int num_rendered_chunks)
+        {
+            ImGui::SetNextWindowPos(ImVec2(0, 150), ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowSize(ImVec2(290, 360), ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+            // Stats are only gathered when the window is expanded
+            if (!ImGui::Begin("Performance"))
+            {
+                ImGui::End();
+                return;
+            }
+
+            float max_frame_time = 0.0f;
+            float sum_frame_time = 0.0f;
+            for (size_t i = 0; i < frame_times.size(); ++i)
+            {
+                max_frame_time = std::max(max_frame_time, frame_times[i]);
+                sum_frame_time += frame_times[i];
+            }
+            const std::string frame_time_overlay = "avg " + std::to_string(static_cast<int>(sum_frame_time / frame_times.size())) + "ms, max " + std::to_string(static_cast<int>(max_frame_time)) + "ms";
+            ImGui::Text("Frame time (ms)");
+            ImGui::PlotHistogram("##frame_times", frame_times.data(), static_cast<int>(frame_times.size()), static_cast<int>(frame_times_index),
+                frame_time_overlay.c_str(), 0.0f, std::max(1000.0f / 30.0f, max_frame_time), ImVec2(270, 60));
+
+            size_t mesh_queue_depth = 0;
+            {
+                std::lock_guard<std::mutex> guard_rendering(mutex_updating);
+                mesh_queue_depth = chunks_to_udpate.size() + sections_to_update.size();
+            }
+            ImGui::Separator();
+            ImGui::Text("Visible sections: %i / %i", num_rendered_chunks, num_chunks);
+            ImGui::Text("Mesh queue: %zu", mesh_queue_depth);
+            ImGui::Text("GPU buffers: %.2f MB", world_renderer->GetGPUMemory() / (1024.0 * 1024.0));
+
+            std::shared_ptr<NetworkManager> current_network_manager;
+            {
+                std::lock_guard<std::mutex> lock(mutex_network_manager);
+                current_network_manager = network_manager;
+            }
+            if (current_network_manager)
+            {
+                const NetworkStats stats = current_network_manager->GetStats();
 
-                while (!chunks_to_udpate.empty())
+                const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                const double elapsed_s = std::chrono::duration<double>(now - last_packet_rates_time).count();
+                if (elapsed_s >= 1.0)
                 {
-                    Position pos;
-                    mutex_updating.lock();
-                    if (!chunks_to_udpate.empty())
+                    packet_rates.clear();
+                    for (const auto& p : stats.clientbound)
                     {
-                        auto posIterator = chunks_to_udpate.begin();
-                        pos = *posIterator;
-                        chunks_to_udpate.erase(posIterator);
+                        const unsigned long long previous_count = last_packet_counts[p.first];
+                        // Counts are reset if the network manager changed
+                        if (p.second.count <= previous_count)
+                        {
+                            continue;
+                        }
+                        auto name_it = packet_names.find(p.first);
+                        if (name_it == packet_names.end())
+                        {
+                            const std::shared_ptr<ProtocolCraft::Message> msg = ProtocolCraft::MessageFactory::CreateMessageClientbound(p.first, ProtocolCraft::ConnectionState::Play);
+                            name_it = packet_names.insert({ p.first, msg ? msg->GetName() : std::to_string(p.first) }).first;
+                        }
+                        packet_rates.push_back({ name_it->second, (p.second.count - previous_count) / elapsed_s });
                     }
-                    mutex_updating.unlock();
-
-                    std::shared_ptr<const Botcraft::Chunk> chunk;
-                    // Get the new values in the world
-                    world->GetMutex().lock();
-                    bool has_chunk_been_modified = world->HasChunkBeenModified(pos.x, pos.z);
-                    if (has_chunk_been_modified)
+                    std::sort(packet_rates.begin(), packet_rates.end(),
+                        [](const std::pair<std::string, double>& a, const std::pair<std::string, double>& b) { return a.second > b.second; });
+                    last_packet_counts.clear();
+                    for (const auto& p : stats.clientbound)
                     {
-                        chunk = world->GetChunkCopy(pos.x, pos.z);
-                        world->ResetChunkModificationState(pos.x, pos.z);
+                        last_packet_counts[p.first] = p.second.count;
                     }
-                    world->GetMutex().unlock();
+                    last_packet_rates_time = now;
+                }
 
-                    if (has_chunk_been_modified)
-                    {
-                        world_renderer->UpdateChunk(pos.x, pos.z, chunk);
-                    }
+                ImGui::Separator();
+                ImGui::Text("Packet queue: %zu (priority %zu)%s", stats.normal_queue_depth, stats.priority_queue_depth, stats.read_paused ? " paused" : "");
+                ImGui::Text("Max queue lag: %.1fms", stats.max_queue_lag_ms);
+                for (size_t i = 0; i < std::min(packet_rates.size(), static_cast<size_t>(8)); ++i)
+                {
+                    ImGui::Text("  %s: %.1f/s", packet_rates[i].first.c_str(), packet_rates[i].second);
+                }
+            }
 
-                    // If we left the game, we don't need to process 
-                    // the rest of the data, just discard them
-                    if (!running)
-                    {
-                        mutex_updating.lock();
-                        chunks_to_udpate.clear();
-                        mutex_updating.unlock();
-                        break;
-                    }
+            // Nodes with the most total time first, the full
+            // table is in the Behaviour profiler window
+            std::vector<NodeProfile> profiles = BehaviourProfiler::GetInstance().GetProfiles();
+            if (!profiles.empty())
+            {
+                std::sort(profiles.begin(), profiles.end(),
+                    [](const NodeProfile& a, const NodeProfile& b) { return a.total_ms > b.total_ms; });
+                ImGui::Separator();
+                ImGui::Text("Behaviour nodes (total / max ms)");
+                for (size_t i = 0; i < std::min(profiles.size(), static_cast<size_t>(5)); ++i)
+                {
+                    ImGui::Text("  %s: %.1f / %.2f", profiles[i].name.c_str(), profiles[i].total_ms, profiles[i].max_ms);
+                }
+            }
+
+            ImGui::End();
+        }
+#endif
+
+        void RenderingManager::AddOutdatedLodChunksToUpdate()
+        {
+            const std::vector<Position> outdated_chunks = world_renderer->GetChunksWithOutdatedLod();
+            if (outdated_chunks.empty())
+            {
+                return;
+            }
+            for (const auto& p : outdated_chunks)
+            {
+                AddToMeshQueue(p, true);
+            }
+            condition_update.notify_all();
+        }
+
+        void RenderingManager::AddToMeshQueue(const Position& pos, const bool full_chunk)
+        {
+            if (!(full_chunk ? chunks_to_udpate : sections_to_update).insert(pos).second)
+            {
+                return;
+            }
+            // The whole queue will get a new priority anyway
+            if (mesh_queue_should_be_sorted)
+            {
+                return;
+            }
+            mesh_queue.push_back({ world_renderer->GetChunkMeshPriority(pos.x, pos.z), pos, full_chunk });
+            std::push_heap(mesh_queue.begin(), mesh_queue.end());
+        }
+
+        void RenderingManager::SortMeshQueue()
+        {
+            std::vector<Position> columns;
+            columns.reserve(chunks_to_udpate.size() + sections_to_update.size());
+            columns.insert(columns.end(), chunks_to_udpate.begin(), chunks_to_udpate.end());
+            columns.insert(columns.end(), sections_to_update.begin(), sections_to_update.end());
+            const std::vector<float> priorities = world_renderer->GetChunksMeshPriority(columns);
+
+            mesh_queue.clear();
+            for (size_t i = 0; i < columns.size(); ++i)
+            {
+                mesh_queue.push_back({ priorities[i], columns[i], i < chunks_to_udpate.size() });
+            }
+            std::make_heap(mesh_queue.begin(), mesh_queue.end());
+            mesh_queue_should_be_sorted = false;
+        }
+
+        void RenderingManager::SetGreedyMeshing(const bool b)
+        {
+            if (world_renderer)
+            {
+                world_renderer->SetGreedyMeshing(b);
+            }
+        }
+
+        void RenderingManager::WaitForRenderingUpdate()
+        {
+            Logger::GetInstance().RegisterThread("RenderingDataUpdate");
+            while (running)
+            {
+                {
+                    std::unique_lock<std::mutex> lck(mutex_updating);
+                    condition_update.wait(lck);
                 }
 
                 while (!entities_to_update.empty())
@@ -603,6 +926,7 @@ namespace Botcraft
                     }
                     mutex_updating.unlock();
 
+                    TRACE_ZONE("UpdateEntity", "id", entity_id);
                     std::vector<Face> faces;
                     // Get the new values
                     entity_manager->GetMutex().lock();
@@ -623,6 +947,7 @@ namespace Botcraft
                     if (should_update)
                     {
                         world_renderer->UpdateEntity(entity_id, faces);
+                        RequestRedraw();
                     }
 
                     // If we left the game, we don't need to process 
@@ -638,6 +963,211 @@ namespace Botcraft
             }
         }
 
+        void RenderingManager::MeshChunks()
+        {
+            Logger::GetInstance().RegisterThread("RenderingChunkMeshing");
+            while (running)
+            {
+                Position pos;
+                // If false, only the rendering section
+                // pos.y of chunk (pos.x, pos.z) is updated
+                bool full_chunk = true;
+                // If true, the chunk is meshed again even if it wasn't modified
+                bool force_update = false;
+                {
+                    std::unique_lock<std::mutex> lck(mutex_updating);
+                    condition_update.wait(lck, [this]()
+                        {
+                            if (!running || world_renderer->GetTransparentFacesShouldBeSorted())
+                            {
+                                return true;
+                            }
+                            for (const auto& p : chunks_to_udpate)
+                            {
+                                if (chunks_being_meshed.find(p) == chunks_being_meshed.end())
+                                {
+                                    return true;
+                                }
+                            }
+                            for (const auto& p : sections_to_update)
+                            {
+                                if (chunks_being_meshed.find(Position(p.x, 0, p.z)) == chunks_being_meshed.end())
+                                {
+                                    return true;
+                                }
+                            }
+                            return false;
+                        });
+
+                    // If we left the game, we don't need to process
+                    // the rest of the data, just discard them
+                    if (!running)
+                    {
+                        chunks_to_udpate.clear();
+                        sections_to_update.clear();
+                        mesh_queue.clear();
+                        break;
+                    }
+
+                    // Sorting is quick and visible when the camera moves, do it first
+                    if (world_renderer->GetTransparentFacesShouldBeSorted())
+                    {
+                        lck.unlock();
+                        world_renderer->SortTransparentFaces();
+                        RequestRedraw();
+                        continue;
+                    }
+
+                    // Stale entries are only removed when popped, sort
+                    // again if they are most of the heap
+                    if (mesh_queue_should_be_sorted ||
+                        mesh_queue.size() > 2 * (chunks_to_udpate.size() + sections_to_update.size()) + 64)
+                    {
+                        SortMeshQueue();
+                    }
+
+                    // Start with the nearest visible chunk
+                    bool found = false;
+                    // Entries of chunks already being meshed, put back in the heap after
+                    std::vector<MeshTask> postponed;
+                    while (!mesh_queue.empty())
+                    {
+                        std::pop_heap(mesh_queue.begin(), mesh_queue.end());
+                        const MeshTask task = mesh_queue.back();
+                        mesh_queue.pop_back();
+
+                        const Position chunk_pos(task.pos.x, 0, task.pos.z);
+                        // Already done by a previous entry or a full chunk update
+                        if (task.full_chunk ? chunks_to_udpate.find(task.pos) == chunks_to_udpate.end() :
+                            sections_to_update.find(task.pos) == sections_to_update.end())
+                        {
+                            continue;
+                        }
+                        // Sections of a chunk waiting for a full update are done with it
+                        if (!task.full_chunk && chunks_to_udpate.find(chunk_pos) != chunks_to_udpate.end())
+                        {
+                            continue;
+                        }
+                        if (chunks_being_meshed.find(chunk_pos) != chunks_being_meshed.end())
+                        {
+                            postponed.push_back(task);
+                            continue;
+                        }
+                        pos = task.pos;
+                        full_chunk = task.full_chunk;
+                        found = true;
+                        break;
+                    }
+                    for (const auto& t : postponed)
+                    {
+                        mesh_queue.push_back(t);
+                        std::push_heap(mesh_queue.begin(), mesh_queue.end());
+                    }
+                    if (!found)
+                    {
+                        // Shouldn't happen, but rebuild the heap from the sets to be sure
+                        // we don't wait for entries that are not in it anymore
+                        mesh_queue_should_be_sorted = true;
+                        continue;
+                    }
+
+                    if (full_chunk)
+                    {
+                        chunks_to_udpate.erase(pos);
+                        for (auto it = sections_to_update.begin(); it != sections_to_update.end();)
+                        {
+                            if (it->x == pos.x && it->z == pos.z)
+                            {
+                                it = sections_to_update.erase(it);
+                            }
+                            else
+                            {
+                                ++it;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        sections_to_update.erase(pos);
+                    }
+                    chunks_being_meshed.insert(Position(pos.x, 0, pos.z));
+                }
+
+                TRACE_ZONE("MeshChunk", "x", pos.x, "z", pos.z);
+                const bool use_lod = world_renderer->ShouldUseLod(pos.x, pos.z);
+                if (!full_chunk && (use_lod || world_renderer->IsChunkLod(pos.x, pos.z)))
+                {
+                    // LOD meshes don't have sections, and one is quick to build anyway
+                    full_chunk = true;
+                    force_update = true;
+                }
+                else if (full_chunk)
+                {
+                    // The chunk moved past the LOD distance
+                    force_update = use_lod != world_renderer->IsChunkLod(pos.x, pos.z);
+                }
+
+                std::shared_ptr<const Botcraft::Chunk> chunk;
+                std::array<std::shared_ptr<const Botcraft::Chunk>, 4> neighbour_chunks;
+                // Get the new values in the world
+                world->GetMutex().lock();
+                // A section update always has to be done, the whole chunk
+                // modification state is left for the next full update
+                bool should_update = !full_chunk || force_update || world->HasChunkBeenModified(pos.x, pos.z);
+                if (should_update)
+                {
+                    chunk = world->GetChunkCopy(pos.x, pos.z);
+                    if (full_chunk)
+                    {
+                        world->ResetChunkModificationState(pos.x, pos.z);
+                    }
+                    // Neighbours are needed to know which border faces are visible
+                    if (chunk)
+                    {
+                        neighbour_chunks[0] = world->GetChunkCopy(pos.x, pos.z - 1);
+                        neighbour_chunks[1] = world->GetChunkCopy(pos.x - 1, pos.z);
+                        neighbour_chunks[2] = world->GetChunkCopy(pos.x + 1, pos.z);
+                        neighbour_chunks[3] = world->GetChunkCopy(pos.x, pos.z + 1);
+                    }
+                }
+                world->GetMutex().unlock();
+
+                // Chunk copies share their data with the world, so
+                // meshing doesn't need any lock
+                if (should_update && full_chunk)
+                {
+                    if (chunk == nullptr)
+                    {
+                        world_renderer->SetChunkMesh(pos.x, pos.z, nullptr);
+                    }
+                    else
+                    {
+                        const ChunkMesh mesh = use_lod ?
+                            world_renderer->MeshChunkLod(pos.x, pos.z, chunk, neighbour_chunks) :
+                            world_renderer->MeshChunk(pos.x, pos.z, chunk, neighbour_chunks);
+                        world_renderer->SetChunkMesh(pos.x, pos.z, &mesh);
+                    }
+                }
+                // If the chunk is not loaded, it will get a full update anyway
+                else if (should_update && chunk != nullptr)
+                {
+                    const ChunkMesh mesh = world_renderer->MeshSection(pos.x, pos.y, pos.z, chunk, neighbour_chunks);
+                    world_renderer->SetSectionMesh(pos.x, pos.y, pos.z, &mesh);
+                }
+                if (should_update)
+                {
+                    RequestRedraw();
+                }
+
+                {
+                    std::lock_guard<std::mutex> guard_rendering(mutex_updating);
+                    chunks_being_meshed.erase(Position(pos.x, 0, pos.z));
+                }
+                // This chunk may have been modified again while we were meshing it
+                condition_update.notify_all();
+            }
+        }
+
         void RenderingManager::Handle(ProtocolCraft::Message& msg)
         {
 
@@ -645,17 +1175,34 @@ namespace Botcraft
 
         void RenderingManager::Handle(ProtocolCraft::ClientboundBlockUpdatePacket& msg)
         {
-            Position chunk_coords = Botcraft::Chunk::BlockCoordsToChunkCoords(msg.GetPos());
-            AddChunkToUpdate(chunk_coords.x, chunk_coords.z);
+            AddBlocksToUpdate({ msg.GetPos() });
         }
 
         void RenderingManager::Handle(ProtocolCraft::ClientboundSectionBlocksUpdatePacket& msg)
         {
-#if PROTOCOL_VERSION < 737
-            AddChunkToUpdate(msg.GetChunkX(), msg.GetChunkZ());
+            std::vector<Position> positions;
+#if PROTOCOL_VERSION < 739
+            positions.reserve(msg.GetRecordCount());
+            for (int i = 0; i < msg.GetRecordCount(); ++i)
+            {
+                positions.push_back(Position(
+                    CHUNK_WIDTH * msg.GetChunkX() + ((msg.GetRecords()[i].GetHorizontalPosition() >> 4) & 0x0F),
+                    msg.GetRecords()[i].GetYCoordinate(),
+                    CHUNK_WIDTH * msg.GetChunkZ() + (msg.GetRecords()[i].GetHorizontalPosition() & 0x0F)
+                ));
+            }
 #else
-            AddChunkToUpdate(msg.GetSectionPos() >> 42, msg.GetSectionPos() << 22 >> 42);
+            const int chunk_x = CHUNK_WIDTH * (msg.GetSectionPos() >> 42); // 22 bits
+            const int chunk_z = CHUNK_WIDTH * (msg.GetSectionPos() << 22 >> 42); // 22 bits
+            const int chunk_y = SECTION_HEIGHT * (msg.GetSectionPos() << 44 >> 44); // 20 bits
+
+            positions.reserve(msg.GetPositions().size());
+            for (const short p : msg.GetPositions())
+            {
+                positions.push_back(Position(chunk_x + ((p >> 8) & 0xF), chunk_y + (p & 0xF), chunk_z + ((p >> 4) & 0xF)));
+            }
 #endif
+            AddBlocksToUpdate(positions);
         }
 
         void RenderingManager::Handle(ProtocolCraft::ClientboundForgetLevelChunkPacket& msg)
@@ -741,11 +1288,13 @@ namespace Botcraft
         void RenderingManager::Handle(ProtocolCraft::ClientboundSetTimePacket& msg)
         {
             day_time = ((msg.GetDayTime() + 6000) % 24000) / 24000.0f;
+            RequestRedraw();
         }
 
         void RenderingManager::Handle(ProtocolCraft::ClientboundRespawnPacket& msg)
         {
             world_renderer->ClearFaces();
+            RequestRedraw();
         }
     } // Renderer
 } // Botcraft
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "botcraft/Renderer/ScreenshotWriter.hpp"
+#include "botcraft/Renderer/ImageSaver.hpp"
+
+#include "botcraft/Utilities/Logger.hpp"
+
+#include <cstring>
+
+namespace Botcraft
+{
+    namespace Renderer
+    {
+        ScreenshotWriter::ScreenshotWriter()
+        {
+            pbos = { 0, 0 };
+            next_pbo = 0;
+
+            running = true;
+            writing_thread = std::thread(&ScreenshotWriter::WriteImages, this);
+        }
+
+        ScreenshotWriter::~ScreenshotWriter()
+        {
+            {
+                std::lock_guard<std::mutex> lock(images_mutex);
+                running = false;
+            }
+            images_condition.notify_all();
+            if (writing_thread.joinable())
+            {
+                writing_thread.join();
+            }
+        }
+
+        void ScreenshotWriter::InitGL()
+        {
+            glGenBuffers(static_cast<GLsizei>(pbos.size()), pbos.data());
+        }
+
+        void ScreenshotWriter::ClearGL()
+        {
+            Update(true);
+            glDeleteBuffers(static_cast<GLsizei>(pbos.size()), pbos.data());
+            pbos = { 0, 0 };
+        }
+
+        const bool ScreenshotWriter::Capture(const std::string& path, const int width, const int height)
+        {
+            PendingRead& read = pending_reads[next_pbo];
+            if (read.fence != nullptr)
+            {
+                return false;
+            }
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[next_pbo]);
+            // Reallocated each time, so the driver doesn't wait for a previous mapping and the size can change
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 3, nullptr, GL_STREAM_READ);
+            glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            read.path = path;
+            read.width = width;
+            read.height = height;
+            read.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+            next_pbo = (next_pbo + 1) % pbos.size();
+            return true;
+        }
+
+        void ScreenshotWriter::Update(const bool wait)
+        {
+            // Oldest copy first, so the images are written in capture order
+            for (size_t k = 0; k < pbos.size(); ++k)
+            {
+                const size_t i = (next_pbo + k) % pbos.size();
+                PendingRead& read = pending_reads[i];
+                if (read.fence == nullptr)
+                {
+                    continue;
+                }
+
+                const GLenum status = glClientWaitSync(read.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000 : 0);
+                // Newer copies can't be done either
+                if (status == GL_TIMEOUT_EXPIRED)
+                {
+                    break;
+                }
+                glDeleteSync(read.fence);
+                read.fence = nullptr;
+
+                Image image;
+                image.path = read.path;
+                image.width = read.width;
+                image.height = read.height;
+                image.pixels.resize(static_cast<size_t>(read.width) * read.height * 3);
+
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+                const void* data = status == GL_WAIT_FAILED ? nullptr :
+                    glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(image.pixels.size()), GL_MAP_READ_BIT);
+                if (data != nullptr)
+                {
+                    std::memcpy(image.pixels.data(), data, image.pixels.size());
+                    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                }
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+                if (data == nullptr)
+                {
+                    LOG_ERROR("Can't read screenshot data for " << image.path);
+                    continue;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(images_mutex);
+                    images_to_write.push_back(std::move(image));
+                }
+                images_condition.notify_all();
+            }
+        }
+
+        void ScreenshotWriter::WriteImages()
+        {
+            Logger::GetInstance().RegisterThread("ScreenshotWriter");
+            while (true)
+            {
+                Image image;
+                {
+                    std::unique_lock<std::mutex> lock(images_mutex);
+                    images_condition.wait(lock, [this]() { return !running || !images_to_write.empty(); });
+                    // Images already read are written before stopping
+                    if (images_to_write.empty())
+                    {
+                        return;
+                    }
+                    image = std::move(images_to_write.front());
+                    images_to_write.pop_front();
+                }
+                WriteImage(image.path, image.height, image.width, 3, image.pixels.data(), true);
+            }
+        }
+    } // Renderer
+} // Botcraft
@@ -7,7 +7,7 @@ namespace Botcraft
 {
     namespace Renderer
     {
-        Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath)
+        Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath, const bool packed_faces)
         {
             // 1. retrieve the vertex/fragment source code from filePath
             std::string vertexCode;
@@ -32,7 +32,7 @@ namespace Botcraft
             }
             else
             {
-                vertexCode = default_vertex_shader;
+                vertexCode = packed_faces ? default_packed_vertex_shader : default_vertex_shader;
             }
 
             if (!fragmentPath.empty())
@@ -152,6 +152,12 @@ namespace Botcraft
             glUniform3f(loc, value[0], value[1], value[2]);
         }
 
+        void Shader::SetIVec3(const std::string &name, const glm::ivec3 &value) const
+        {
+            unsigned int loc = glGetUniformLocation(program, name.c_str());
+            glUniform3i(loc, value[0], value[1], value[2]);
+        }
+
         void Shader::SetVec2(const std::string &name, const glm::vec2 &value) const
         {
             unsigned int loc = glGetUniformLocation(program, name.c_str());
@@ -196,15 +202,21 @@ namespace Botcraft
             "layout (location = 7) in uint texture_data;\n"
             "layout (location = 8) in uvec2 texture_multiplier;\n"
             "\n"
+            "//Per window values, in a buffer as the programs can be shared by several windows\n"
             "layout (std140) uniform MatriceView\n"
             "{\n"
             "\tmat4 view;\n"
+            "\tmat4 projection;\n"
+            "\t//Any position close to the camera, in half blocks\n"
+            "\tivec3 camera_origin;\n"
             "};\n"
             "\n"
-            "uniform mat4 projection;\n"
-            "\n"
             "out vec2 AtlasCoord;\n"
             "out vec2 AtlasCoord_overlay;\n"
+            "out vec2 TileCoord;\n"
+            "flat out uint Tiled;\n"
+            "flat out vec4 TextureCoords;\n"
+            "flat out vec4 TextureCoords_overlay;\n"
             "flat out uint BackFaceDisplay;\n"
             "flat out uint UseOverlay;\n"
             "flat out vec4 TextureMultiplier;\n"
@@ -232,6 +244,85 @@ namespace Botcraft
             "\tAtlasCoord = vec2(texture_coords[2 * int(vertex_id % 2)], texture_coords[1 + 2 * int(vertex_id > 1)]);\n"
             "\tAtlasCoord_overlay = vec2(texture_coords_overlay[2 * int(vertex_id % 2)], texture_coords_overlay[1 + 2 * int(vertex_id > 1)]);\n"
             "\n"
+            "\t//Merged faces repeat their texture, in tile units\n"
+            "\tuvec2 repeat = uvec2((texture_data >> 6) & uint(0xFF), (texture_data >> 14) & uint(0xFF)) + uint(1);\n"
+            "\tTiled = uint(repeat != uvec2(1));\n"
+            "\tTileCoord = vec2(float(vertex_id % 2) * float(repeat.x), float(vertex_id > 1) * float(repeat.y));\n"
+            "\tTextureCoords = texture_coords;\n"
+            "\tTextureCoords_overlay = texture_coords_overlay;\n"
+            "\n"
+            "\tBackFaceDisplay = uint((texture_data >> 2) & uint(0x01));\n"
+            "\tUseOverlay = uint((texture_data >> 5) & uint(0x01));\n"
+            "\tTextureMultiplier = vec4(float(texture_multiplier[0] & uint(0xFF)), float((texture_multiplier[0] >> 8) & uint(0xFF)), float((texture_multiplier[0] >> 16) & uint(0xFF)), float((texture_multiplier[0] >> 24) & uint(0xFF))) / 255.0f;\n"
+            "\tTextureMultiplier_overlay = vec4(float(texture_multiplier[1] & uint(0xFF)), float((texture_multiplier[1] >> 8) & uint(0xFF)), float((texture_multiplier[1] >> 16) & uint(0xFF)), float((texture_multiplier[1] >> 24) & uint(0xFF))) / 255.0f;\n"
+            "}";
+
+        const std::string Shader::default_packed_vertex_shader =
+            "#version 330 core\n"
+            "\n"
+            "layout (location = 0) in vec3 aPos;\n"
+            "//Face center in half blocks, only the 16 lowest bits\n"
+            "layout (location = 1) in uvec3 face_position;\n"
+            "layout (location = 2) in uint template_index;\n"
+            "layout (location = 3) in uvec2 texture_multiplier;\n"
+            "\n"
+            "//Per window values, in a buffer as the programs can be shared by several windows\n"
+            "layout (std140) uniform MatriceView\n"
+            "{\n"
+            "\tmat4 view;\n"
+            "\tmat4 projection;\n"
+            "\t//Any position close to the camera, in half blocks\n"
+            "\tivec3 camera_origin;\n"
+            "};\n"
+            "\n"
+            "//Model matrix rows, texture coords, overlay texture coords and texture data of each face template\n"
+            "uniform samplerBuffer face_templates;\n"
+            "\n"
+            "out vec2 AtlasCoord;\n"
+            "out vec2 AtlasCoord_overlay;\n"
+            "out vec2 TileCoord;\n"
+            "flat out uint Tiled;\n"
+            "flat out vec4 TextureCoords;\n"
+            "flat out vec4 TextureCoords_overlay;\n"
+            "flat out uint BackFaceDisplay;\n"
+            "flat out uint UseOverlay;\n"
+            "flat out vec4 TextureMultiplier;\n"
+            "flat out vec4 TextureMultiplier_overlay;\n"
+            "\n"
+            "void main()\n"
+            "{\n"
+            "\tint base = 6 * int(template_index);\n"
+            "\tmat4 aModel = transpose(mat4(texelFetch(face_templates, base), texelFetch(face_templates, base + 1), texelFetch(face_templates, base + 2), vec4(0.0, 0.0, 0.0, 1.0)));\n"
+            "\tvec4 texture_coords = texelFetch(face_templates, base + 3);\n"
+            "\tvec4 texture_coords_overlay = texelFetch(face_templates, base + 4);\n"
+            "\tuint texture_data = uint(texelFetch(face_templates, base + 5).x);\n"
+            "\n"
+            "\t//Get the full position back, the faces are always less than 2^15 half blocks away from the camera\n"
+            "\tivec3 delta = (ivec3(face_position) - camera_origin) & 0xFFFF;\n"
+            "\tdelta -= ivec3(greaterThanEqual(delta, ivec3(0x8000))) * 0x10000;\n"
+            "\taModel[3].xyz += 0.5 * vec3(camera_origin + delta);\n"
+            "\tgl_Position = projection * view * (aModel * vec4(aPos, 1.0));\n"
+            "\n"
+            "\tint vertex_id = gl_VertexID;\n"
+            "\n"
+            "\tint rotation = int(texture_data >> 3) & 0x03;\n"
+            "\n"
+            "\tint rotated_indices[4] = int[4](1, 3, 0, 2);\n"
+            "\tfor(int i = 0; i < rotation; ++i)\n"
+            "\t{\n"
+            "\t\tvertex_id = rotated_indices[vertex_id];\n"
+            "\t}\n"
+            "\n"
+            "\tAtlasCoord = vec2(texture_coords[2 * int(vertex_id % 2)], texture_coords[1 + 2 * int(vertex_id > 1)]);\n"
+            "\tAtlasCoord_overlay = vec2(texture_coords_overlay[2 * int(vertex_id % 2)], texture_coords_overlay[1 + 2 * int(vertex_id > 1)]);\n"
+            "\n"
+            "\t//Merged faces repeat their texture, in tile units\n"
+            "\tuvec2 repeat = uvec2((texture_data >> 6) & uint(0xFF), (texture_data >> 14) & uint(0xFF)) + uint(1);\n"
+            "\tTiled = uint(repeat != uvec2(1));\n"
+            "\tTileCoord = vec2(float(vertex_id % 2) * float(repeat.x), float(vertex_id > 1) * float(repeat.y));\n"
+            "\tTextureCoords = texture_coords;\n"
+            "\tTextureCoords_overlay = texture_coords_overlay;\n"
+            "\n"
             "\tBackFaceDisplay = uint((texture_data >> 2) & uint(0x01));\n"
             "\tUseOverlay = uint((texture_data >> 5) & uint(0x01));\n"
             "\tTextureMultiplier = vec4(float(texture_multiplier[0] & uint(0xFF)), float((texture_multiplier[0] >> 8) & uint(0xFF)), float((texture_multiplier[0] >> 16) & uint(0xFF)), float((texture_multiplier[0] >> 24) & uint(0xFF))) / 255.0f;\n"
@@ -243,6 +334,10 @@ namespace Botcraft
             "\n"
             "in vec2 AtlasCoord;\n"
             "in vec2 AtlasCoord_overlay;\n"
+            "in vec2 TileCoord;\n"
+            "flat in uint Tiled;\n"
+            "flat in vec4 TextureCoords;\n"
+            "flat in vec4 TextureCoords_overlay;\n"
             "flat in uint BackFaceDisplay;\n"
             "flat in uint UseOverlay;\n"
             "flat in vec4 TextureMultiplier;\n"
@@ -252,6 +347,15 @@ namespace Botcraft
             "\n"
             "out vec4 FragColor;\n"
             "\n"
+            "//Sample a texture repeated over a merged face. Gradients are computed\n"
+            "//from the continuous coordinates so the mipmap level doesn't jump at the seams\n"
+            "vec4 SampleTiled(vec4 coords, vec2 tile_dx, vec2 tile_dy)\n"
+            "{\n"
+            "\tvec2 scale = vec2(coords[2] - coords[0], coords[3] - coords[1]);\n"
+            "\tvec2 tile = fract(TileCoord);\n"
+            "\treturn textureGrad(atlas_texture, vec2(coords[0], coords[1]) + tile * scale, tile_dx * scale, tile_dy * scale);\n"
+            "}\n"
+            "\n"
             "void main()\n"
             "{\n"
             "\tif(!bool(BackFaceDisplay) && !gl_FrontFacing)\n"
@@ -259,14 +363,19 @@ namespace Botcraft
             "\t\tdiscard;\n"
             "\t}\n"
             "\n"
+            "\tvec2 tile_dx = dFdx(TileCoord);\n"
+            "\tvec2 tile_dy = dFdy(TileCoord);\n"
+            "\tvec4 base_sample = bool(Tiled) ? SampleTiled(TextureCoords, tile_dx, tile_dy) : texture(atlas_texture, AtlasCoord);\n"
+            "\n"
             "if(!bool(UseOverlay))\n"
             "{\n"
-            "\tFragColor = TextureMultiplier * texture(atlas_texture, AtlasCoord);\n"
+            "\tFragColor = TextureMultiplier * base_sample;\n"
             "}\n"
             "else\n"
             "{\n"
-            "\tvec4 base_color = TextureMultiplier * texture(atlas_texture, AtlasCoord);\n"
-            "\tvec4 overlay_color = TextureMultiplier_overlay * texture(atlas_texture, AtlasCoord_overlay);\n"
+            "\tvec4 overlay_sample = bool(Tiled) ? SampleTiled(TextureCoords_overlay, tile_dx, tile_dy) : texture(atlas_texture, AtlasCoord_overlay);\n"
+            "\tvec4 base_color = TextureMultiplier * base_sample;\n"
+            "\tvec4 overlay_color = TextureMultiplier_overlay * overlay_sample;\n"
             "\tfloat alpha = overlay_color[3] + base_color[3] * (1.0f - overlay_color[3]);\n"
             "\tFragColor = vec4((vec3(overlay_color) * overlay_color[3] + (1.0f - overlay_color[3]) * vec3(base_color) * base_color[3]) / alpha, alpha);\n"
             "}\n"
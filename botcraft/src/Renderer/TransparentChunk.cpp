@@ -1,6 +1,3 @@
-#include <glm/vec4.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
 #include <glad/glad.h>
 
 #include "botcraft/Renderer/TransparentChunk.hpp"
@@ -11,20 +8,18 @@ namespace Botcraft
 {
     namespace Renderer
     {
-        const float Distance(const Face &f, const glm::vec3 &pos)
+        const float Distance(const std::array<float, 3>& center, const glm::vec3 &pos)
         {
-            const glm::vec3 center = glm::make_mat4(f.GetMatrix().data()) * glm::vec4(0.0f, -1.0f, 0.0f, 1.0f);
-
-            const float delta_x = pos.x - center.x;
-            const float delta_y = pos.y - center.y;
-            const float delta_z = pos.z - center.z;
+            const float delta_x = pos.x - center[0];
+            const float delta_y = pos.y - center[1];
+            const float delta_z = pos.z - center[2];
 
             return delta_x * delta_x + delta_y * delta_y + delta_z * delta_z;
         }
 
         TransparentChunk::TransparentChunk()
         {
-            display_buffer_status = BufferStatus::UpToDate;
+            faces_changed = false;
         }
 
         TransparentChunk::~TransparentChunk()
@@ -32,6 +27,21 @@ namespace Botcraft
 
         }
 
+        void TransparentChunk::AddFace(const Face& f, const unsigned int template_index, const std::array<unsigned int, 2>& texture_multipliers,
+            const float offset_x, const float offset_y, const float offset_z)
+        {
+            Chunk::AddFace(f, template_index, texture_multipliers, offset_x, offset_y, offset_z);
+            std::lock_guard<std::mutex> lock_faces(mutex_faces);
+            faces_changed = true;
+        }
+
+        void TransparentChunk::ClearFaces()
+        {
+            Chunk::ClearFaces();
+            std::lock_guard<std::mutex> lock_faces(mutex_faces);
+            faces_changed = true;
+        }
+
         void TransparentChunk::Update()
         {
             std::lock_guard<std::mutex> lock_faces(mutex_faces);
@@ -40,23 +50,17 @@ namespace Botcraft
             case BufferStatus::Created:
             {
                 GenerateOpenGLBuffer();
-                display_faces_positions = std::vector<Face>(faces.begin(), faces.end());
-                face_number = display_faces_positions.size();
-                glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-                glBufferData(GL_ARRAY_BUFFER, sizeof(Face) * face_number, display_faces_positions.data(), GL_DYNAMIC_DRAW);
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                const std::vector<PackedFace> faces_data = GetPackedFaces();
+                face_number = faces_data.size();
+                UploadFaces(faces_data);
                 buffer_status = BufferStatus::UpToDate;
-                display_buffer_status = BufferStatus::Updated;
                 break;
             }
             case BufferStatus::Updated:
             {
-                display_faces_positions = std::vector<Face>(faces.begin(), faces.end());
-                face_number = display_faces_positions.size();
-                display_buffer_status = BufferStatus::Updated;
-                glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-                glBufferData(GL_ARRAY_BUFFER, sizeof(Face) * face_number, display_faces_positions.data(), GL_DYNAMIC_DRAW);
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                const std::vector<PackedFace> faces_data = GetPackedFaces();
+                face_number = faces_data.size();
+                UploadFaces(faces_data);
                 if (face_number == 0)
                 {
                     DeleteOpenGLBuffer();
@@ -75,27 +79,77 @@ namespace Botcraft
             }
         }
 
-        void TransparentChunk::SetDisplayStatus(const BufferStatus s)
-        {
-            display_buffer_status = s;
-        }
-
         void TransparentChunk::Sort(const glm::vec3 &cam_pos)
         {
-            if (display_buffer_status == BufferStatus::UpToDate)
+            std::lock_guard<std::mutex> lock_faces(mutex_faces);
+            if (faces.size() < 2)
             {
+                faces_changed = false;
                 return;
             }
 
-            std::lock_guard<std::mutex> lock_faces(mutex_faces);
-            std::sort(display_faces_positions.begin(), display_faces_positions.end(), [this, cam_pos](const Face &f1, const Face &f2){return Distance(f1, cam_pos) > Distance(f2, cam_pos); });
+            std::vector<float> distances(faces.size());
+            for (size_t i = 0; i < faces.size(); ++i)
+            {
+                distances[i] = Distance(faces[i].center, cam_pos);
+            }
 
+            bool full_sort = faces_changed;
+            bool order_changed = false;
+            if (!full_sort)
+            {
+                // Insertion sort starting from the previous order, almost
+                // linear as it barely changes when the camera moves by one block.
+                // Give up if there are too many moves (teleportation for example)
+                const size_t max_moves = 8 * faces.size();
+                size_t num_moves = 0;
+                for (size_t i = 1; i < faces.size() && !full_sort; ++i)
+                {
+                    if (distances[i - 1] >= distances[i])
+                    {
+                        continue;
+                    }
+                    const ChunkFace face = faces[i];
+                    const float distance = distances[i];
+                    size_t j = i;
+                    while (j > 0 && distances[j - 1] < distance)
+                    {
+                        faces[j] = faces[j - 1];
+                        distances[j] = distances[j - 1];
+                        j -= 1;
+                    }
+                    faces[j] = face;
+                    distances[j] = distance;
+                    order_changed = true;
+
+                    num_moves += i - j;
+                    full_sort = num_moves > max_moves;
+                }
+            }
 
-            glBindBuffer(GL_ARRAY_BUFFER, data_VBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Face) * display_faces_positions.size(), display_faces_positions.data());
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            if (full_sort)
+            {
+                std::vector<size_t> order(faces.size());
+                for (size_t i = 0; i < order.size(); ++i)
+                {
+                    order[i] = i;
+                }
+                std::sort(order.begin(), order.end(), [&distances](const size_t a, const size_t b) { return distances[a] > distances[b]; });
 
-            display_buffer_status = BufferStatus::UpToDate;
+                std::deque<ChunkFace> sorted_faces;
+                for (const size_t i : order)
+                {
+                    sorted_faces.push_back(faces[i]);
+                }
+                faces.swap(sorted_faces);
+                order_changed = true;
+            }
+
+            faces_changed = false;
+            if (order_changed && buffer_status == BufferStatus::UpToDate)
+            {
+                buffer_status = BufferStatus::Updated;
+            }
         }
     } // Renderer
 } // Botcraft
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include "botcraft/Renderer/Camera.hpp"
 #include "botcraft/Renderer/Chunk.hpp"
 #include "botcraft/Renderer/Entity.hpp"
+#include "botcraft/Renderer/FaceBufferArena.hpp"
+#include "botcraft/Renderer/FaceTemplates.hpp"
+#include "botcraft/Renderer/Shader.hpp"
 #include "botcraft/Renderer/TransparentChunk.hpp"
 #include "botcraft/Renderer/WorldRenderer.hpp"
 
@@ -10,33 +13,248 @@
 #include "botcraft/Game/World/Block.hpp"
 #include "botcraft/Game/World/Blockstate.hpp"
 #include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/Section.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <tuple>
 #include <unordered_set>
 
 namespace Botcraft
 {
     namespace Renderer
     {
+        // Initial number of faces of the opaque faces buffer, it grows if needed
+        static constexpr unsigned int initial_face_arena_capacity = 1 << 18;
+        // Initial number of faces of the entities buffer
+        static constexpr unsigned int initial_entity_arena_capacity = 1 << 14;
+
+        // Layout (std140) of the MatriceView uniform block: view and
+        // projection matrices, then camera origin as an ivec3
+        static constexpr size_t view_block_projection_offset = sizeof(glm::mat4);
+        static constexpr size_t view_block_camera_origin_offset = 2 * sizeof(glm::mat4);
+        static constexpr size_t view_block_size = 2 * sizeof(glm::mat4) + 4 * sizeof(int);
+
+        // Max number of blocks along each side of a merged face,
+        // limited by the bits available to store the texture repeat
+        static constexpr int max_merged_face_size = 256;
+
+        // Get the axis orthogonal to a face if it's an opaque face
+        // covering a full block side, -1 otherwise
+        static int GetFullBlockFaceNormalAxis(const Face& face)
+        {
+            if (face.GetTransparencyData() != Transparency::Opaque ||
+                face.GetTextureRotation() != 0)
+            {
+                return -1;
+            }
+
+            const std::array<float, 16>& m = face.GetMatrix();
+            std::array<float, 3> min_corner;
+            std::array<float, 3> max_corner;
+            min_corner.fill(std::numeric_limits<float>::max());
+            max_corner.fill(std::numeric_limits<float>::lowest());
+            for (const float x : { -1.0f, 1.0f })
+            {
+                for (const float z : { -1.0f, 1.0f })
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        const float v = m[i] * x - m[4 + i] + m[8 + i] * z + m[12 + i];
+                        min_corner[i] = std::min(min_corner[i], v);
+                        max_corner[i] = std::max(max_corner[i], v);
+                    }
+                }
+            }
+
+            int normal_axis = -1;
+            for (int i = 0; i < 3; ++i)
+            {
+                const float extent = max_corner[i] - min_corner[i];
+                const float center = 0.5f * (max_corner[i] + min_corner[i]);
+                if (extent < 1e-3f && std::abs(std::abs(center) - 0.5f) < 1e-3f && normal_axis == -1)
+                {
+                    normal_axis = i;
+                }
+                else if (std::abs(extent - 1.0f) > 1e-3f || std::abs(center) > 1e-3f)
+                {
+                    return -1;
+                }
+            }
+            return normal_axis;
+        }
+
+        // Check if an axis aligned box is at least partially inside the frustum
+        static bool IsBoxInFrustum(const std::array<glm::vec4, 6>& planes, const glm::vec3& min_corner, const glm::vec3& max_corner)
+        {
+            for (int i = 0; i < 6; ++i)
+            {
+                const glm::vec4 p_vertex(planes[i].x > 0.0f ? max_corner.x : min_corner.x,
+                    planes[i].y > 0.0f ? max_corner.y : min_corner.y,
+                    planes[i].z > 0.0f ? max_corner.z : min_corner.z, 1.0f);
+                if (glm::dot(planes[i], p_vertex) < 0.0f)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Get which faces of a rendering section are connected through non opaque blocks,
+        // as in WorldRenderer::section_visibility. opaque has one flag per block of the
+        // section, indexed by (y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x
+        static unsigned long long ComputeSectionVisibility(const unsigned char* opaque, const int height)
+        {
+            const int layer_size = CHUNK_WIDTH * CHUNK_WIDTH;
+            const int size = layer_size * height;
+            if (std::find(opaque, opaque + size, 1) == opaque + size)
+            {
+                return (1ULL << 36) - 1;
+            }
+
+            unsigned long long visibility = 0;
+            std::vector<unsigned char> visited(opaque, opaque + size);
+            std::vector<int> to_visit;
+            const auto visit = [&](const int i)
+            {
+                if (!visited[i])
+                {
+                    visited[i] = 1;
+                    to_visit.push_back(i);
+                }
+            };
+
+            // Flood fill each group of connected non opaque blocks
+            // and record the section faces it touches
+            for (int start = 0; start < size; ++start)
+            {
+                if (visited[start])
+                {
+                    continue;
+                }
+                unsigned int faces = 0;
+                visit(start);
+                while (!to_visit.empty())
+                {
+                    const int i = to_visit.back();
+                    to_visit.pop_back();
+                    const int x = i % CHUNK_WIDTH;
+                    const int z = (i / CHUNK_WIDTH) % CHUNK_WIDTH;
+                    const int y = i / layer_size;
+                    faces |= (y == 0) << 0 | (z == 0) << 1 | (x == 0) << 2 |
+                        (x == CHUNK_WIDTH - 1) << 3 | (z == CHUNK_WIDTH - 1) << 4 | (y == height - 1) << 5;
+
+                    if (y > 0) { visit(i - layer_size); }
+                    if (z > 0) { visit(i - CHUNK_WIDTH); }
+                    if (x > 0) { visit(i - 1); }
+                    if (x < CHUNK_WIDTH - 1) { visit(i + 1); }
+                    if (z < CHUNK_WIDTH - 1) { visit(i + CHUNK_WIDTH); }
+                    if (y < height - 1) { visit(i + layer_size); }
+                }
+                for (int a = 0; a < 6; ++a)
+                {
+                    for (int b = 0; b < 6; ++b)
+                    {
+                        if ((faces >> a) & (faces >> b) & 1)
+                        {
+                            visibility |= 1ULL << (6 * a + b);
+                        }
+                    }
+                }
+            }
+            return visibility;
+        }
+
+        // Get a copy of a full block face stretched over size blocks
+        static Face GetMergedFace(const Face& face, const Position& size)
+        {
+            Face merged_face(face);
+            std::array<float, 16>& m = merged_face.GetMatrix();
+
+            // Find which world axes the face local x and z are mapped to
+            std::array<int, 2> local_axes = { 0, 0 };
+            for (int i = 0; i < 2; ++i)
+            {
+                const int column = 8 * i;
+                for (int j = 1; j < 3; ++j)
+                {
+                    if (std::abs(m[column + j]) > std::abs(m[column + local_axes[i]]))
+                    {
+                        local_axes[i] = j;
+                    }
+                }
+            }
+
+            // Scale along the world axes, full block faces are centered
+            // in their plane so the translation is not modified
+            for (int column = 0; column < 4; ++column)
+            {
+                for (int row = 0; row < 3; ++row)
+                {
+                    m[4 * column + row] *= size[row];
+                }
+            }
+            merged_face.SetTextureRepeat(size[local_axes[0]], size[local_axes[1]]);
+
+            return merged_face;
+        }
+
+        // Y of the highest non air block of a column, chunk min y - 1 if there is none
+        static const int GetColumnTopY(const Botcraft::Chunk* chunk, const int x, const int z)
+        {
+            const int min_section_y = chunk->GetMinY() / SECTION_HEIGHT;
+            for (int s = chunk->GetHeight() / SECTION_HEIGHT - 1; s >= 0; --s)
+            {
+                const Section* section = chunk->GetSection(s);
+                if (section == nullptr || section->GetNumNonAirBlocks() == 0)
+                {
+                    continue;
+                }
+                for (int y = SECTION_HEIGHT - 1; y >= 0; --y)
+                {
+                    const Block* block = section->GetBlock(y * CHUNK_WIDTH * CHUNK_WIDTH + z * CHUNK_WIDTH + x);
+                    if (block != nullptr && !block->HasFlag(BlockstateFlag::Air))
+                    {
+                        return (min_section_y + s) * SECTION_HEIGHT + y;
+                    }
+                }
+            }
+            return chunk->GetMinY() - 1;
+        }
+
         WorldRenderer::WorldRenderer(const unsigned int section_height_)
         {
             section_height = section_height_;
 
+            face_arena = std::make_unique<FaceBufferArena>(initial_face_arena_capacity, true);
+            face_templates = std::make_unique<FaceTemplates>();
+            // Entity faces move every frame, there would be
+            // too many templates, they keep their full matrix
+            entity_arena = std::make_unique<FaceBufferArena>(initial_entity_arena_capacity, false);
             chunks = std::unordered_map<Position, std::shared_ptr<Chunk> >();
             transparent_chunks = std::unordered_map<Position, std::shared_ptr<TransparentChunk> >();
 
             blocks_faces_should_be_updated = true;
+            greedy_meshing = true;
+            lod_distance = 0.0f;
+            cave_culling = true;
+            transparent_faces_should_be_sorted = false;
+            render_order_should_be_updated = true;
 
             entities = std::unordered_map<int, std::shared_ptr<Entity> >();
             entities_faces_should_be_updated = true;
 
             camera = std::make_shared<Camera>();
+
+            atlas_texture = 0;
         }
 
         WorldRenderer::~WorldRenderer()
         {
-            glDeleteTextures(1, &atlas_texture);
             camera.reset();
         }
 
@@ -45,33 +263,20 @@ namespace Botcraft
             return camera;
         }
 
-        void WorldRenderer::InitGL()
+        void WorldRenderer::InitGL(const unsigned int atlas_texture_)
         {
             glGenBuffers(1, &view_uniform_buffer);
             glBindBuffer(GL_UNIFORM_BUFFER, view_uniform_buffer);
-            glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), NULL, GL_STATIC_DRAW);
+            glBufferData(GL_UNIFORM_BUFFER, view_block_size, NULL, GL_STATIC_DRAW);
             glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-            glBindBufferRange(GL_UNIFORM_BUFFER, 0, view_uniform_buffer, 0, sizeof(glm::mat4));
-
-            //Create a texture
-            glGenTextures(1, &atlas_texture);
-            glBindTexture(GL_TEXTURE_2D, atlas_texture);
-
-            //Options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-            float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-            const Atlas* atlas = AssetsManager::getInstance().GetAtlas();
+            glBindBufferRange(GL_UNIFORM_BUFFER, 0, view_uniform_buffer, 0, view_block_size);
 
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas->GetWidth(), atlas->GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas->Get());
-            glGenerateMipmap(GL_TEXTURE_2D);
+            face_arena->InitGL();
+            face_templates->InitGL();
+            entity_arena->InitGL();
 
-            glBindTexture(GL_TEXTURE_2D, 0);
+            atlas_texture = atlas_texture_;
         }
 
         void WorldRenderer::UpdateViewMatrix()
@@ -80,15 +285,6 @@ namespace Botcraft
             {
                 m_mutex_camera.lock();
                 glm::mat4 view_matrix = camera->GetViewMatrix();
-                if (camera->GetHasChangedPosition())
-                {
-                    transparent_chunks_mutex.lock();
-                    for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); ++it)
-                    {
-                        it->second->SetDisplayStatus(BufferStatus::Updated);
-                    }
-                    transparent_chunks_mutex.unlock();
-                }
                 camera->ResetHasChangedPosition();
                 camera->ResetHasChangedOrientation();
                 m_mutex_camera.unlock();
@@ -100,12 +296,18 @@ namespace Botcraft
 
         void WorldRenderer::SetCameraProjection(const glm::mat4& proj)
         {
-            std::lock_guard<std::mutex> lock(m_mutex_camera);
-            camera->SetProjection(proj);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex_camera);
+                camera->SetProjection(proj);
+            }
+            glBindBuffer(GL_UNIFORM_BUFFER, view_uniform_buffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, view_block_projection_offset, sizeof(glm::mat4), glm::value_ptr(proj));
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
         }
 
         void WorldRenderer::UpdateFaces()
         {
+            face_templates->UpdateGL();
             if (blocks_faces_should_be_updated)
             {
                 blocks_faces_should_be_updated = false;
@@ -113,10 +315,11 @@ namespace Botcraft
                     std::lock_guard<std::mutex> lock(chunks_mutex);
                     for (auto it = chunks.begin(); it != chunks.end();)
                     {
-                        it->second->Update();
+                        it->second->Update(*face_arena);
                         if (it->second->GetNumFace() == 0)
                         {
                             it = chunks.erase(it);
+                            render_order_should_be_updated = true;
                         }
                         else
                         {
@@ -132,6 +335,7 @@ namespace Botcraft
                         if (it->second->GetNumFace() == 0)
                         {
                             it = transparent_chunks.erase(it);
+                            render_order_should_be_updated = true;
                         }
                         else
                         {
@@ -146,7 +350,7 @@ namespace Botcraft
                 std::lock_guard<std::mutex> lock(entities_mutex);
                 for (auto it = entities.begin(); it != entities.end();)
                 {
-                    it->second->Update();
+                    it->second->Update(*entity_arena);
                     if (it->second->GetNumFace() == 0)
                     {
                         it = entities.erase(it);
@@ -159,38 +363,48 @@ namespace Botcraft
             }
         }
 
-        void WorldRenderer::UpdateChunk(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk)
+        void WorldRenderer::UpdateChunk(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+            const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks)
         {
-            // Remove any previous version of this chunk
+            if (chunk == nullptr)
             {
-                std::lock_guard<std::mutex> lock(chunks_mutex);
-
-                for (auto it = chunks.begin(); it != chunks.end(); ++it)
-                {
-                    if (it->first.x == x_ && it->first.z == z_)
-                    {
-                        it->second->ClearFaces();
-                    }
-                }
+                SetChunkMesh(x_, z_, nullptr);
+                return;
             }
-            {
-                std::lock_guard<std::mutex> lock(transparent_chunks_mutex);
 
-                for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); ++it)
-                {
-                    if (it->first.x == x_ && it->first.z == z_)
-                    {
-                        it->second->ClearFaces();
-                    }
-                }
+            const ChunkMesh mesh = MeshChunk(x_, z_, chunk, neighbour_chunks);
+            SetChunkMesh(x_, z_, &mesh);
+        }
+
+        const ChunkMesh WorldRenderer::MeshChunk(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+            const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks) const
+        {
+            if (chunk == nullptr)
+            {
+                return ChunkMesh();
             }
 
+            return MeshBlocks(x_, z_, chunk, neighbour_chunks, chunk->GetMinY(), chunk->GetMinY() + chunk->GetHeight());
+        }
+
+        const ChunkMesh WorldRenderer::MeshSection(const int x_, const int y_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+            const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks) const
+        {
             if (chunk == nullptr)
             {
-                blocks_faces_should_be_updated = true;
-                return;
+                return ChunkMesh();
             }
 
+            const int min_y = std::max(chunk->GetMinY(), y_ * static_cast<int>(section_height));
+            const int max_y = std::min(chunk->GetMinY() + chunk->GetHeight(), (y_ + 1) * static_cast<int>(section_height));
+            return MeshBlocks(x_, z_, chunk, neighbour_chunks, min_y, max_y);
+        }
+
+        const ChunkMesh WorldRenderer::MeshBlocks(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+            const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks, const int min_y, const int max_y) const
+        {
+            ChunkMesh mesh;
+
             auto& AssetsManager_ = AssetsManager::getInstance();
 
             // For each block in the chunk, check its neighbours
@@ -199,10 +413,12 @@ namespace Botcraft
                             Position(-1, 0, 0), Position(1, 0, 0), Position(0, 0, 1), Position(0, 1, 0) });
 
             std::vector<const Blockstate*> neighbour_blockstates(6);
-            std::vector<unsigned char> neighbour_model_ids(6);
+
+            // Opaque blocks of the meshed range, to compute which sections can be seen through
+            std::vector<unsigned char> opaque(CHUNK_WIDTH * CHUNK_WIDTH * std::max(0, max_y - min_y), 0);
 
             Position pos;
-            for (int y = chunk->GetMinY(); y < chunk->GetHeight() + chunk->GetMinY(); ++y)
+            for (int y = min_y; y < max_y; ++y)
             {
                 pos.y = y;
                 for (int z = 0; z < CHUNK_WIDTH; ++z)
@@ -212,10 +428,15 @@ namespace Botcraft
                     {
                         pos.x = x;
 
-                        // If this block is air, just skip it
                         const Block* this_block = chunk->GetBlock(pos);
+                        if (this_block != nullptr && !this_block->GetBlockstate()->IsTransparent())
+                        {
+                            opaque[((y - min_y) * CHUNK_WIDTH + z) * CHUNK_WIDTH + x] = 1;
+                        }
+
+                        // If this block is air, just skip it
                         if (this_block == nullptr ||
-                            this_block->GetBlockstate()->IsAir())
+                            this_block->HasFlag(BlockstateFlag::Air))
                         {
                             continue;
                         }
@@ -223,16 +444,24 @@ namespace Botcraft
                         // Else check its neighbours to find which face to draw
                         for (int i = 0; i < 6; ++i)
                         {
-                            const Block* neighbour_block = chunk->GetBlock(pos + neighbour_positions[i]);
+                            Position neighbour_pos = pos + neighbour_positions[i];
+                            const Botcraft::Chunk* neighbour_chunk = chunk.get();
+                            // Blocks on the x/z borders are in the neighbour chunk
+                            if (neighbour_pos.x < 0 || neighbour_pos.x > CHUNK_WIDTH - 1 ||
+                                neighbour_pos.z < 0 || neighbour_pos.z > CHUNK_WIDTH - 1)
+                            {
+                                neighbour_chunk = neighbour_chunks[i - 1].get();
+                                neighbour_pos.x = (neighbour_pos.x + CHUNK_WIDTH) % CHUNK_WIDTH;
+                                neighbour_pos.z = (neighbour_pos.z + CHUNK_WIDTH) % CHUNK_WIDTH;
+                            }
+                            const Block* neighbour_block = neighbour_chunk == nullptr ? nullptr : neighbour_chunk->GetBlock(neighbour_pos);
                             if (neighbour_block == nullptr)
                             {
                                 neighbour_blockstates[i] = nullptr;
-                                neighbour_model_ids[i] = 0;
                             }
                             else
                             {
                                 neighbour_blockstates[i] = neighbour_block->GetBlockstate();
-                                neighbour_model_ids[i] = neighbour_block->GetModelId();
                             }
                         }
 
@@ -260,7 +489,7 @@ namespace Botcraft
                         }
 
                         //Add all faces of the current state
-                        const std::vector<FaceDescriptor>& current_faces = this_block->GetBlockstate()->GetModel(this_block->GetModelId()).GetFaces();
+                        const std::vector<FaceDescriptor>& current_faces = this_block->GetBlockstate()->GetModel(this_block->GetModelId(pos)).GetFaces();
 #if PROTOCOL_VERSION < 552
                         const Biome* current_biome = AssetsManager_.GetBiome(chunk->GetBiome(x, z));
 #else
@@ -278,180 +507,673 @@ namespace Botcraft
                                     neighbour_blockstates[(int)current_faces[i].cullface_direction]->GetName() != this_block->GetBlockstate()->GetName())
                                 )
                             {
-                                AddFace(pos.x + CHUNK_WIDTH * x_, pos.y, pos.z + CHUNK_WIDTH * z_,
-                                    current_faces[i].face, current_faces[i].texture_names,
-                                    GetColorModifier(pos.y, current_biome, this_block->GetBlockstate(),
-                                        current_faces[i].use_tintindexes));
+                                ChunkMesh::MeshFace mesh_face;
+                                mesh_face.face = &current_faces[i].face;
+                                mesh_face.texture_multipliers = GetColorModifier(pos.y, current_biome,
+                                    this_block->GetBlockstate(), current_faces[i].use_tintindexes);
+                                mesh_face.pos = Position(pos.x + CHUNK_WIDTH * x_, pos.y, pos.z + CHUNK_WIDTH * z_);
+                                mesh.faces.push_back(mesh_face);
                             }
                         }
                     }
                 }
             }
-            blocks_faces_should_be_updated = true;
-        }
-
-        void WorldRenderer::UpdateEntity(const int id, const std::vector<Face>& faces)
-        {
-            std::lock_guard<std::mutex> lock(entities_mutex);
-
-            auto it = entities.find(id);
 
-            if (it == entities.end() && faces.size() != 0)
-            {
-                entities[id] = std::make_shared<Entity>(faces);
-                entities_faces_should_be_updated = true;
-            }
-            else if (it != entities.end() && faces.size() == 0)
+            const int height = static_cast<int>(section_height);
+            for (int section_y = static_cast<int>(std::floor(min_y / static_cast<double>(height))); section_y * height < max_y; ++section_y)
             {
-                it->second->ClearFaces();
-                entities_faces_should_be_updated = true;
+                const int start_y = std::max(min_y, section_y * height);
+                const int end_y = std::min(max_y, (section_y + 1) * height);
+                mesh.visibility.push_back({ section_y,
+                    ComputeSectionVisibility(opaque.data() + (start_y - min_y) * CHUNK_WIDTH * CHUNK_WIDTH, end_y - start_y) });
             }
-            else if (it != entities.end())
+
+            if (greedy_meshing)
             {
-                it->second->UpdateFaces(faces);
-                entities_faces_should_be_updated = true;
+                MergeFaces(mesh);
             }
-        }
 
-        void WorldRenderer::UseAtlasTextureGL()
-        {
-            glBindTexture(GL_TEXTURE_2D, atlas_texture);
+            return mesh;
         }
 
-        void WorldRenderer::ClearFaces()
+        const ChunkMesh WorldRenderer::MeshChunkLod(const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+            const std::array<std::shared_ptr<const Botcraft::Chunk>, 4>& neighbour_chunks) const
         {
-            // We simply remove all the faces from all the chunks
-            // The chunks will be deleted on the next frame
+            ChunkMesh mesh;
+            mesh.lod = true;
+            if (chunk == nullptr)
             {
-                std::lock_guard<std::mutex> lock(chunks_mutex);
-                for (auto it = chunks.begin(); it != chunks.end(); it++)
-                {
-                    it->second->ClearFaces();
-                }
+                return mesh;
             }
+
+            // Height of each column, with a one block border
+            // for the neighbours, (z + 1) * heights_width + x + 1
+            constexpr int heights_width = CHUNK_WIDTH + 2;
+            std::vector<int> heights(heights_width * heights_width);
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
             {
-                std::lock_guard<std::mutex> lock(transparent_chunks_mutex);
-                for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); it++)
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
                 {
-                    it->second->ClearFaces();
+                    heights[(z + 1) * heights_width + x + 1] = GetColumnTopY(chunk.get(), x, z);
                 }
             }
+            // Sides facing an unloaded chunk are not added
+            for (int i = 0; i < CHUNK_WIDTH; ++i)
             {
-                std::lock_guard<std::mutex> lock(entities_mutex);
-                for (auto it = entities.begin(); it != entities.end(); it++)
+                heights[i + 1] = neighbour_chunks[0] == nullptr ?
+                    heights[heights_width + i + 1] : GetColumnTopY(neighbour_chunks[0].get(), i, CHUNK_WIDTH - 1);
+                heights[(i + 1) * heights_width] = neighbour_chunks[1] == nullptr ?
+                    heights[(i + 1) * heights_width + 1] : GetColumnTopY(neighbour_chunks[1].get(), CHUNK_WIDTH - 1, i);
+                heights[(i + 1) * heights_width + heights_width - 1] = neighbour_chunks[2] == nullptr ?
+                    heights[(i + 1) * heights_width + heights_width - 2] : GetColumnTopY(neighbour_chunks[2].get(), 0, i);
+                heights[(heights_width - 1) * heights_width + i + 1] = neighbour_chunks[3] == nullptr ?
+                    heights[(heights_width - 2) * heights_width + i + 1] : GetColumnTopY(neighbour_chunks[3].get(), i, 0);
+            }
+
+            // North, West, East, South
+            const std::array<Position, 4> side_offsets = { Position(0, 0, -1), Position(-1, 0, 0), Position(1, 0, 0), Position(0, 0, 1) };
+            const std::array<Orientation, 4> side_orientations = { Orientation::North, Orientation::West, Orientation::East, Orientation::South };
+
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
+            {
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
                 {
-                    it->second->ClearFaces();
+                    const int height = heights[(z + 1) * heights_width + x + 1];
+                    if (height < chunk->GetMinY())
+                    {
+                        continue;
+                    }
+                    AppendBlockFaces(mesh, x_, z_, chunk, Position(x, height, z), Orientation::Top);
+
+                    // Fill the height differences with the column side faces
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        const int neighbour_height = heights[(z + 1 + side_offsets[i].z) * heights_width + x + 1 + side_offsets[i].x];
+                        for (int y = std::max(neighbour_height + 1, chunk->GetMinY()); y <= height; ++y)
+                        {
+                            AppendBlockFaces(mesh, x_, z_, chunk, Position(x, y, z), side_orientations[i]);
+                        }
+                    }
                 }
             }
-            blocks_faces_should_be_updated = true;
-            entities_faces_should_be_updated = true;
+
+            if (greedy_meshing)
+            {
+                MergeFaces(mesh);
+            }
+
+            return mesh;
         }
 
-        void WorldRenderer::SetPosOrientation(const double x_, const double y_, const double z_, const float yaw_, const float pitch_)
+        void WorldRenderer::AppendBlockFaces(ChunkMesh& mesh, const int x_, const int z_, const std::shared_ptr<const Botcraft::Chunk> chunk,
+            const Position& pos, const Orientation orientation) const
         {
-            if (camera)
+            const Block* block = chunk->GetBlock(pos);
+            if (block == nullptr || block->HasFlag(BlockstateFlag::Air))
             {
-                std::lock_guard<std::mutex> lock(m_mutex_camera);
-                camera->SetPosition((float)x_, (float)y_, (float)z_);
-                camera->SetRotation(pitch_, yaw_);
+                return;
+            }
+
+            const std::vector<FaceDescriptor>& faces = block->GetBlockstate()->GetModel(block->GetModelId(pos)).GetFaces();
+#if PROTOCOL_VERSION < 552
+            const Biome* biome = AssetsManager::getInstance().GetBiome(chunk->GetBiome(pos.x, pos.z));
+#else
+            const Biome* biome = AssetsManager::getInstance().GetBiome(chunk->GetBiome(pos.x, pos.y, pos.z));
+#endif
+            for (const auto& f : faces)
+            {
+                if (f.orientation != orientation)
+                {
+                    continue;
+                }
+                ChunkMesh::MeshFace mesh_face;
+                mesh_face.face = &f.face;
+                mesh_face.texture_multipliers = GetColorModifier(pos.y, biome, block->GetBlockstate(), f.use_tintindexes);
+                mesh_face.pos = Position(pos.x + CHUNK_WIDTH * x_, pos.y, pos.z + CHUNK_WIDTH * z_);
+                mesh.faces.push_back(mesh_face);
             }
         }
 
-        void WorldRenderer::RenderFaces(int* num_chunks_, int* num_rendered_chunks_,
-            int* num_entities_, int* num_rendered_entities_,
-            int* num_faces_, int* num_rendered_faces_)
+        void WorldRenderer::SetGreedyMeshing(const bool b)
         {
-            const std::array<glm::vec4, 6>& frustum_planes = camera->GetFrustumPlanes();
+            greedy_meshing = b;
+        }
 
-            // Get a list of all loaded chunks
-            std::unordered_set<Position> all_loaded_chunks;
-            all_loaded_chunks.reserve(chunks.size() + transparent_chunks.size());
-            int num_faces = 0;
+        void WorldRenderer::MergeFaces(ChunkMesh& mesh) const
+        {
+            std::unordered_map<const Face*, int> normal_axes;
+            // Candidate faces sharing the same model face, tint and plane
+            // in the same rendering section
+            std::map<std::tuple<const Face*, unsigned int, unsigned int, int, int>, std::vector<size_t> > planes;
 
-            chunks_mutex.lock();
-            for (auto it = chunks.begin(); it != chunks.end(); ++it)
-            {
-                all_loaded_chunks.insert(it->first);
-                num_faces += it->second->GetNumFace();
-            }
-            chunks_mutex.unlock();
-            transparent_chunks_mutex.lock();
-            for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); ++it)
+            std::vector<ChunkMesh::MeshFace> merged_faces;
+            merged_faces.reserve(mesh.faces.size());
+
+            for (size_t i = 0; i < mesh.faces.size(); ++i)
             {
-                all_loaded_chunks.insert(it->first);
-                num_faces += it->second->GetNumFace();
+                const ChunkMesh::MeshFace& f = mesh.faces[i];
+                auto it = normal_axes.find(f.face);
+                if (it == normal_axes.end())
+                {
+                    it = normal_axes.insert({ f.face, GetFullBlockFaceNormalAxis(*f.face) }).first;
+                }
+                if (it->second == -1)
+                {
+                    merged_faces.push_back(f);
+                    continue;
+                }
+                const int section = static_cast<int>(floor(f.pos.y / static_cast<double>(section_height)));
+                planes[{ f.face, f.texture_multipliers[0], f.texture_multipliers[1], f.pos[it->second], section }].push_back(i);
             }
-            transparent_chunks_mutex.unlock();
-            const int num_chunks = all_loaded_chunks.size();
 
-            // Apply frustum culling to render only the visible ones
-            std::vector<Position> chunks_to_render;
-            chunks_to_render.reserve(all_loaded_chunks.size());
-            std::unordered_map<Position, bool> inside_frustum;
-            // Frustum culling algorithm from http://old.cescg.org/CESCG-2002/DSykoraJJelinek/
-            for (auto it = all_loaded_chunks.begin(); it != all_loaded_chunks.end(); ++it)
+            for (const auto& p : planes)
             {
-                FrustumResult result = FrustumResult::Inside;
+                const std::vector<size_t>& indices = p.second;
+                const int normal_axis = normal_axes.at(std::get<0>(p.first));
+                const int axis_u = normal_axis == 0 ? 1 : 0;
+                const int axis_v = normal_axis == 2 ? 1 : 2;
+
+                int min_u = std::numeric_limits<int>::max();
+                int min_v = std::numeric_limits<int>::max();
+                int max_u = std::numeric_limits<int>::lowest();
+                int max_v = std::numeric_limits<int>::lowest();
+                for (const size_t i : indices)
+                {
+                    min_u = std::min(min_u, mesh.faces[i].pos[axis_u]);
+                    min_v = std::min(min_v, mesh.faces[i].pos[axis_v]);
+                    max_u = std::max(max_u, mesh.faces[i].pos[axis_u]);
+                    max_v = std::max(max_v, mesh.faces[i].pos[axis_v]);
+                }
 
-                const float min_x = CHUNK_WIDTH * (*it).x;
-                const float max_x = CHUNK_WIDTH * ((*it).x + 1);
-                const float min_y = (int)section_height * (*it).y;
-                const float max_y = (int)section_height * ((*it).y + 1);
-                const float min_z = CHUNK_WIDTH * (*it).z;
-                const float max_z = CHUNK_WIDTH * ((*it).z + 1);
+                const int width = max_u - min_u + 1;
+                const int height = max_v - min_v + 1;
+                std::vector<bool> grid(width * height, false);
+                for (const size_t i : indices)
+                {
+                    grid[(mesh.faces[i].pos[axis_v] - min_v) * width + mesh.faces[i].pos[axis_u] - min_u] = true;
+                }
 
-                for (int i = 0; i < 6; ++i)
+                // Grow each rectangle along u first, then along v
+                // while the whole row is available
+                const ChunkMesh::MeshFace& reference = mesh.faces[indices[0]];
+                for (int v = 0; v < height; ++v)
                 {
-                    const bool sign_x = frustum_planes[i].x > 0.0f;
-                    const bool sign_y = frustum_planes[i].y > 0.0f;
-                    const bool sign_z = frustum_planes[i].z > 0.0f;
+                    for (int u = 0; u < width; ++u)
+                    {
+                        if (!grid[v * width + u])
+                        {
+                            continue;
+                        }
 
-                    const glm::vec4 p_vertex = glm::vec4(sign_x ? max_x : min_x, sign_y ? max_y : min_y, sign_z ? max_z : min_z, 1.0f);
+                        int size_u = 1;
+                        while (u + size_u < width && size_u < max_merged_face_size && grid[v * width + u + size_u])
+                        {
+                            size_u += 1;
+                        }
 
-                    if (glm::dot(frustum_planes[i], p_vertex) < 0.0f)
-                    {
-                        result = FrustumResult::Outside;
-                        break;
-                    }
+                        int size_v = 1;
+                        while (v + size_v < height && size_v < max_merged_face_size)
+                        {
+                            bool full_row = true;
+                            for (int k = 0; k < size_u; ++k)
+                            {
+                                if (!grid[(v + size_v) * width + u + k])
+                                {
+                                    full_row = false;
+                                    break;
+                                }
+                            }
+                            if (!full_row)
+                            {
+                                break;
+                            }
+                            size_v += 1;
+                        }
 
-                    const glm::vec4 n_vertex = glm::vec4(sign_x ? min_x : max_x, sign_y ? min_y : max_y, sign_z ? min_z : max_z, 1.0f);
+                        for (int j = 0; j < size_v; ++j)
+                        {
+                            for (int k = 0; k < size_u; ++k)
+                            {
+                                grid[(v + j) * width + u + k] = false;
+                            }
+                        }
 
-                    if (glm::dot(frustum_planes[i], n_vertex) < 0.0f)
-                    {
-                        result = FrustumResult::Intersect;
+                        ChunkMesh::MeshFace merged_face = reference;
+                        merged_face.pos[axis_u] = min_u + u;
+                        merged_face.pos[axis_v] = min_v + v;
+                        merged_face.size[axis_u] = size_u;
+                        merged_face.size[axis_v] = size_v;
+                        merged_faces.push_back(merged_face);
                     }
                 }
-
-                inside_frustum[*it] = result != FrustumResult::Outside;
-                if (result != FrustumResult::Outside)
-                {
-                    chunks_to_render.push_back(*it);
-                }
             }
 
-            // Sort the chunks from far to near the camera (necessary for transparent chunks to render in the right order)
+            mesh.faces = std::move(merged_faces);
+        }
+
+        void WorldRenderer::SetChunkMesh(const int x_, const int z_, const ChunkMesh* mesh)
+        {
             m_mutex_camera.lock();
-            std::sort(chunks_to_render.begin(), chunks_to_render.end(), [this](const Position& p1, const Position& p2) {return this->DistanceToCamera(p1) > this->DistanceToCamera(p2); });
+            const glm::vec3 cam_pos = camera->GetPosition();
             m_mutex_camera.unlock();
 
-            // Render all non partially transparent faces
-            const int num_rendered_chunks = chunks_to_render.size();
-            int num_rendered_faces = 0;
-            chunks_mutex.lock();
-            for (int i = 0; i < num_rendered_chunks; ++i)
             {
-                auto found_it = chunks.find(chunks_to_render[i]);
-                if (found_it != chunks.end())
+                std::scoped_lock lock(chunks_mutex, transparent_chunks_mutex);
+
+                // Remove any previous version of this chunk
+                for (auto it = chunks.begin(); it != chunks.end(); ++it)
                 {
-                    found_it->second->Render();
-                    num_rendered_faces += found_it->second->GetNumFace();
+                    if (it->first.x == x_ && it->first.z == z_)
+                    {
+                        it->second->ClearFaces();
+                    }
+                }
+                for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); ++it)
+                {
+                    if (it->first.x == x_ && it->first.z == z_)
+                    {
+                        it->second->ClearFaces();
+                    }
+                }
+                for (auto it = section_visibility.begin(); it != section_visibility.end();)
+                {
+                    if (it->first.x == x_ && it->first.z == z_)
+                    {
+                        it = section_visibility.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+
+                if (mesh != nullptr)
+                {
+                    for (const auto& f : mesh->faces)
+                    {
+                        AddFace(f);
+                    }
+                    for (const auto& v : mesh->visibility)
+                    {
+                        section_visibility[Position(x_, v.first, z_)] = v.second;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock_lod(lod_chunks_mutex);
+                if (mesh != nullptr && mesh->lod)
+                {
+                    lod_chunks.insert(Position(x_, 0, z_));
+                }
+                else
+                {
+                    lod_chunks.erase(Position(x_, 0, z_));
+                }
+
+                for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); ++it)
+                {
+                    if (it->first.x == x_ && it->first.z == z_)
+                    {
+                        it->second->Sort(cam_pos);
+                    }
+                }
+            }
+            blocks_faces_should_be_updated = true;
+        }
+
+        void WorldRenderer::SetSectionMesh(const int x_, const int y_, const int z_, const ChunkMesh* mesh)
+        {
+            m_mutex_camera.lock();
+            const glm::vec3 cam_pos = camera->GetPosition();
+            m_mutex_camera.unlock();
+
+            {
+                std::scoped_lock lock(chunks_mutex, transparent_chunks_mutex);
+
+                const Position section_position(x_, y_, z_);
+                auto it = chunks.find(section_position);
+                if (it != chunks.end())
+                {
+                    it->second->ClearFaces();
+                }
+                auto it_transparent = transparent_chunks.find(section_position);
+                if (it_transparent != transparent_chunks.end())
+                {
+                    it_transparent->second->ClearFaces();
+                }
+
+                section_visibility.erase(section_position);
+                if (mesh != nullptr)
+                {
+                    for (const auto& f : mesh->faces)
+                    {
+                        AddFace(f);
+                    }
+                    for (const auto& v : mesh->visibility)
+                    {
+                        if (v.first == y_)
+                        {
+                            section_visibility[section_position] = v.second;
+                        }
+                    }
+                }
+
+                it_transparent = transparent_chunks.find(section_position);
+                if (it_transparent != transparent_chunks.end())
+                {
+                    it_transparent->second->Sort(cam_pos);
+                }
+            }
+            blocks_faces_should_be_updated = true;
+        }
+
+        void WorldRenderer::SortTransparentFaces()
+        {
+            // Only one thread sorts for each camera move
+            if (!transparent_faces_should_be_sorted.exchange(false))
+            {
+                return;
+            }
+
+            m_mutex_camera.lock();
+            const glm::vec3 cam_pos = camera->GetPosition();
+            m_mutex_camera.unlock();
+
+            std::vector<std::shared_ptr<TransparentChunk> > to_sort;
+            transparent_chunks_mutex.lock();
+            to_sort.reserve(transparent_chunks.size());
+            for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); ++it)
+            {
+                to_sort.push_back(it->second);
+            }
+            transparent_chunks_mutex.unlock();
+
+            // Each chunk is locked while it's sorted, so
+            // rendering can go on with the other ones
+            for (const auto& c : to_sort)
+            {
+                c->Sort(cam_pos);
+            }
+            blocks_faces_should_be_updated = true;
+        }
+
+        void WorldRenderer::SetCaveCulling(const bool b)
+        {
+            cave_culling = b;
+        }
+
+        void WorldRenderer::SetLodDistance(const float d)
+        {
+            lod_distance = d;
+        }
+
+        const bool WorldRenderer::ShouldUseLod(const int x_, const int z_)
+        {
+            const float d = lod_distance;
+            return d > 0.0f && GetChunkDistanceToCamera(x_, z_) > d;
+        }
+
+        const bool WorldRenderer::IsChunkLod(const int x_, const int z_)
+        {
+            std::lock_guard<std::mutex> lock(lod_chunks_mutex);
+            return lod_chunks.find(Position(x_, 0, z_)) != lod_chunks.end();
+        }
+
+        const std::vector<Position> WorldRenderer::GetChunksWithOutdatedLod()
+        {
+            std::unordered_set<Position> columns;
+            {
+                std::scoped_lock lock(chunks_mutex, transparent_chunks_mutex);
+                for (const auto& p : chunks)
+                {
+                    columns.insert(Position(p.first.x, 0, p.first.z));
+                }
+                for (const auto& p : transparent_chunks)
+                {
+                    columns.insert(Position(p.first.x, 0, p.first.z));
+                }
+            }
+
+            std::vector<Position> output;
+            for (const auto& p : columns)
+            {
+                if (ShouldUseLod(p.x, p.z) != IsChunkLod(p.x, p.z))
+                {
+                    output.push_back(p);
+                }
+            }
+            return output;
+        }
+
+        const bool WorldRenderer::GetTransparentFacesShouldBeSorted() const
+        {
+            return transparent_faces_should_be_sorted;
+        }
+
+        const float WorldRenderer::GetChunkDistanceToCamera(const int x_, const int z_)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_camera);
+            const glm::vec3& camera_pos = camera->GetPosition();
+            const float dx = CHUNK_WIDTH * (x_ + 0.5f) - camera_pos.x;
+            const float dz = CHUNK_WIDTH * (z_ + 0.5f) - camera_pos.z;
+            return std::sqrt(dx * dx + dz * dz);
+        }
+
+        const float WorldRenderer::GetChunkMeshPriority(const int x_, const int z_)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_camera);
+            return MeshPriority(x_, z_);
+        }
+
+        const std::vector<float> WorldRenderer::GetChunksMeshPriority(const std::vector<Position>& chunks)
+        {
+            std::vector<float> priorities(chunks.size());
+            std::lock_guard<std::mutex> lock(m_mutex_camera);
+            for (size_t i = 0; i < chunks.size(); ++i)
+            {
+                priorities[i] = MeshPriority(chunks[i].x, chunks[i].z);
+            }
+            return priorities;
+        }
+
+        void WorldRenderer::UpdateEntity(const int id, const std::vector<Face>& faces)
+        {
+            std::lock_guard<std::mutex> lock(entities_mutex);
+
+            auto it = entities.find(id);
+
+            if (it == entities.end() && faces.size() != 0)
+            {
+                entities[id] = std::make_shared<Entity>(faces);
+                entities_faces_should_be_updated = true;
+            }
+            else if (it != entities.end() && faces.size() == 0)
+            {
+                it->second->ClearFaces();
+                entities_faces_should_be_updated = true;
+            }
+            else if (it != entities.end())
+            {
+                it->second->UpdateFaces(faces);
+                entities_faces_should_be_updated = true;
+            }
+        }
+
+        void WorldRenderer::UseAtlasTextureGL()
+        {
+            glBindTexture(GL_TEXTURE_2D, atlas_texture);
+        }
+
+        void WorldRenderer::ClearFaces()
+        {
+            // We simply remove all the faces from all the chunks
+            // The chunks will be deleted on the next frame
+            {
+                std::lock_guard<std::mutex> lock(chunks_mutex);
+                for (auto it = chunks.begin(); it != chunks.end(); it++)
+                {
+                    it->second->ClearFaces();
+                }
+                section_visibility.clear();
+            }
+            {
+                std::lock_guard<std::mutex> lock(transparent_chunks_mutex);
+                for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); it++)
+                {
+                    it->second->ClearFaces();
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(lod_chunks_mutex);
+                lod_chunks.clear();
+            }
+            {
+                std::lock_guard<std::mutex> lock(entities_mutex);
+                for (auto it = entities.begin(); it != entities.end(); it++)
+                {
+                    it->second->ClearFaces();
+                }
+            }
+            blocks_faces_should_be_updated = true;
+            entities_faces_should_be_updated = true;
+        }
+
+        const bool WorldRenderer::SetPosOrientation(const double x_, const double y_, const double z_, const float yaw_, const float pitch_)
+        {
+            if (camera)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex_camera);
+                if (camera->GetPosition() == glm::vec3((float)x_, (float)y_, (float)z_) &&
+                    camera->GetYaw() == yaw_ && camera->GetPitch() == pitch_)
+                {
+                    return false;
+                }
+                camera->SetPosition((float)x_, (float)y_, (float)z_);
+                camera->SetRotation(pitch_, yaw_);
+
+                // Transparent faces order only needs to be
+                // updated when the camera moves to another block
+                const Position block(static_cast<int>(std::floor(x_)), static_cast<int>(std::floor(y_)), static_cast<int>(std::floor(z_)));
+                if (!(block == camera_block))
+                {
+                    camera_block = block;
+                    transparent_faces_should_be_sorted = true;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void WorldRenderer::RenderFaces(Shader& packed_faces_shader, Shader& faces_shader, int* num_chunks_, int* num_rendered_chunks_,
+            int* num_entities_, int* num_rendered_entities_,
+            int* num_faces_, int* num_rendered_faces_, int* num_draw_calls_)
+        {
+            const std::array<glm::vec4, 6>& frustum_planes = camera->GetFrustumPlanes();
+
+            int num_faces = 0;
+            {
+                std::scoped_lock lock(chunks_mutex, transparent_chunks_mutex);
+                UpdateRenderOrder();
+
+                // Update the bounding boxes, vertically limited to the
+                // faces of the section as most of them are partially empty
+                for (auto& b : section_bounds)
+                {
+                    b.resize(render_order.size());
+                }
+                section_visible.resize(render_order.size());
+                for (size_t i = 0; i < render_order.size(); ++i)
+                {
+                    const RenderSection& section = render_order[i];
+                    float min_y = std::numeric_limits<float>::max();
+                    float max_y = std::numeric_limits<float>::lowest();
+                    if (section.chunk)
+                    {
+                        num_faces += section.chunk->GetNumFace();
+                        const std::pair<float, float> bounds = section.chunk->GetVerticalBounds();
+                        min_y = std::min(min_y, bounds.first);
+                        max_y = std::max(max_y, bounds.second);
+                    }
+                    if (section.transparent_chunk)
+                    {
+                        num_faces += section.transparent_chunk->GetNumFace();
+                        const std::pair<float, float> bounds = section.transparent_chunk->GetVerticalBounds();
+                        min_y = std::min(min_y, bounds.first);
+                        max_y = std::max(max_y, bounds.second);
+                    }
+                    // Sections without faces are never visible
+                    section_visible[i] = min_y <= max_y;
+                    section_bounds[0][i] = static_cast<float>(CHUNK_WIDTH * section.pos.x);
+                    section_bounds[1][i] = static_cast<float>(CHUNK_WIDTH * (section.pos.x + 1));
+                    section_bounds[2][i] = section_visible[i] ? min_y : 0.0f;
+                    section_bounds[3][i] = section_visible[i] ? max_y : 0.0f;
+                    section_bounds[4][i] = static_cast<float>(CHUNK_WIDTH * section.pos.z);
+                    section_bounds[5][i] = static_cast<float>(CHUNK_WIDTH * (section.pos.z + 1));
+                }
+            }
+            const int num_chunks = render_order.size();
+
+            // Apply frustum culling to render only the visible ones.
+            // Frustum culling algorithm from http://old.cescg.org/CESCG-2002/DSykoraJJelinek/
+            // A box is outside if its vertex the furthest along the plane normal is behind it.
+            // The tests are done one plane at a time for all the sections, without branches, so
+            // the compiler can vectorize them
+            for (int i = 0; i < 6; ++i)
+            {
+                const glm::vec4& plane = frustum_planes[i];
+                const float* p_x = section_bounds[plane.x > 0.0f ? 1 : 0].data();
+                const float* p_y = section_bounds[plane.y > 0.0f ? 3 : 2].data();
+                const float* p_z = section_bounds[plane.z > 0.0f ? 5 : 4].data();
+                unsigned char* visible = section_visible.data();
+                for (size_t j = 0; j < section_visible.size(); ++j)
+                {
+                    visible[j] &= static_cast<unsigned char>(plane.x * p_x[j] + plane.y * p_y[j] + plane.z * p_z[j] + plane.w >= 0.0f);
+                }
+            }
+
+            if (cave_culling)
+            {
+                m_mutex_camera.lock();
+                const glm::vec3 camera_pos = camera->GetPosition();
+                m_mutex_camera.unlock();
+                std::lock_guard<std::mutex> lock(chunks_mutex);
+                CullHiddenSections(frustum_planes, camera_pos);
+            }
+
+            // Render all non partially transparent faces
+            int num_rendered_chunks = 0;
+            int num_rendered_faces = 0;
+            arena_ranges.clear();
+            chunks_mutex.lock();
+            for (size_t i = 0; i < render_order.size(); ++i)
+            {
+                if (!section_visible[i])
+                {
+                    continue;
+                }
+                num_rendered_chunks += 1;
+                if (render_order[i].chunk)
+                {
+                    arena_ranges.push_back(render_order[i].chunk->GetArenaRange());
+                    num_rendered_faces += render_order[i].chunk->GetNumFace();
                 }
             }
             chunks_mutex.unlock();
+            // Packed faces positions are relative to the camera one
+            const glm::ivec3 camera_origin(2 * render_order_camera_block.x, 2 * render_order_camera_block.y, 2 * render_order_camera_block.z);
+            glBindBuffer(GL_UNIFORM_BUFFER, view_uniform_buffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, view_block_camera_origin_offset, sizeof(glm::ivec3), glm::value_ptr(camera_origin));
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            packed_faces_shader.Use();
+            face_templates->BindGL(1);
+
+            // Opaque faces don't need to be sorted, they're all in
+            // the same buffer so neighbour ranges are drawn at once
+            int num_draw_calls = face_arena->Render(arena_ranges);
 
             // Render entities, with approximate frustum culling
-            const std::vector<Position> neighbouring_positions({ Position(0, 0, 0), Position(0, -1, 0), Position(0, 0, -1),
-                            Position(-1, 0, 0), Position(1, 0, 0), Position(0, 0, 1), Position(0, 1, 0) });
+            // on their section and the neighbour ones. They share
+            // one buffer, so neighbour ranges are drawn at once
+            entity_ranges.clear();
             entities_mutex.lock();
             const int num_entities = entities.size();
             int num_rendered_entities = 0;
@@ -466,33 +1188,30 @@ namespace Botcraft
                     static_cast<int>(floor(approx_pos.z / static_cast<double>(CHUNK_WIDTH)))
                 );
 
-                for (int i = 0; i < neighbouring_positions.size(); ++i)
+                const glm::vec3 min_corner(CHUNK_WIDTH * (chunk_position.x - 1), static_cast<int>(section_height) * (chunk_position.y - 1), CHUNK_WIDTH * (chunk_position.z - 1));
+                const glm::vec3 max_corner(CHUNK_WIDTH * (chunk_position.x + 2), static_cast<int>(section_height) * (chunk_position.y + 2), CHUNK_WIDTH * (chunk_position.z + 2));
+                if (IsBoxInFrustum(frustum_planes, min_corner, max_corner))
                 {
-                    if (inside_frustum[chunk_position + neighbouring_positions[i]])
-                    {
-                        e.second->Render();
-                        num_rendered_entities += 1;
-                        num_rendered_faces += e.second->GetNumFace();
-                        break;
-                    }
+                    entity_ranges.push_back(e.second->GetArenaRange());
+                    num_rendered_entities += 1;
+                    num_rendered_faces += e.second->GetNumFace();
                 }
             }
             entities_mutex.unlock();
+            faces_shader.Use();
+            num_draw_calls += entity_arena->Render(entity_ranges);
+            packed_faces_shader.Use();
 
-            m_mutex_camera.lock();
-            const glm::vec3 cam_pos = camera->GetPosition();
-            m_mutex_camera.unlock();
-
-            // Render all partially transparent faces
+            // Render all partially transparent faces from far to near,
+            // they are sorted by SortTransparentFaces
             transparent_chunks_mutex.lock();
-            for (int i = 0; i < num_rendered_chunks; ++i)
+            for (size_t i = 0; i < render_order.size(); ++i)
             {
-                auto found_it = transparent_chunks.find(chunks_to_render[i]);
-                if (found_it != transparent_chunks.end())
+                if (section_visible[i] && render_order[i].transparent_chunk)
                 {
-                    found_it->second->Sort(cam_pos);
-                    found_it->second->Render();
-                    num_rendered_faces += found_it->second->GetNumFace();
+                    render_order[i].transparent_chunk->Render();
+                    num_draw_calls += 1;
+                    num_rendered_faces += render_order[i].transparent_chunk->GetNumFace();
                 }
             }
             transparent_chunks_mutex.unlock();
@@ -521,113 +1240,328 @@ namespace Botcraft
             {
                 *num_rendered_entities_ = num_rendered_entities;
             }
+            if (num_draw_calls_)
+            {
+                *num_draw_calls_ = num_draw_calls;
+            }
         }
 
-        void WorldRenderer::AddFace(const int x_, const int y_, const int z_, const Face& face_, const std::vector<std::string>& texture_identifiers_, const std::vector<unsigned int>& texture_multipliers_)
+        const size_t WorldRenderer::GetGPUMemory()
         {
-            std::array<unsigned int, 2> texture_multipliers = { 0xFFFFFFFF, 0xFFFFFFFF };
-            for (int i = 0; i < std::min(2, static_cast<int>(texture_multipliers_.size())); ++i)
+            size_t memory = face_arena->GetGPUMemory() + entity_arena->GetGPUMemory() + face_templates->GetGPUMemory();
+            // Opaque sections are in face_arena, only transparent ones have their own buffer
+            std::lock_guard<std::mutex> lock_transparent(transparent_chunks_mutex);
+            for (const auto& c : transparent_chunks)
             {
-                texture_multipliers[i] = texture_multipliers_[i];
+                memory += c.second->GetGPUMemory();
             }
+            return memory;
+        }
 
+        void WorldRenderer::AddFace(const ChunkMesh::MeshFace& face_)
+        {
             const Position chunk_position(
-                static_cast<int>(floor(x_ / static_cast<double>(CHUNK_WIDTH))), 
-                static_cast<int>(floor(y_ / static_cast<double>(section_height))), 
-                static_cast<int>(floor(z_ / static_cast<double>(CHUNK_WIDTH)))
+                static_cast<int>(floor(face_.pos.x / static_cast<double>(CHUNK_WIDTH))),
+                static_cast<int>(floor(face_.pos.y / static_cast<double>(section_height))),
+                static_cast<int>(floor(face_.pos.z / static_cast<double>(CHUNK_WIDTH)))
             );
 
-            if (face_.GetTransparencyData() == Transparency::Partial)
+            const Face* face = face_.face;
+            Face merged_face;
+            if (!(face_.size == Position(1, 1, 1)))
             {
-                std::lock_guard<std::mutex> lock(transparent_chunks_mutex);
-                auto chunk_it = transparent_chunks.find(chunk_position);
-                if (chunk_it == transparent_chunks.end())
+                merged_face = GetMergedFace(*face_.face, face_.size);
+                face = &merged_face;
+            }
+
+            //Add half the size because the origin of the face is at the center
+            //but the coordinates start from the block corner
+            const float offset_x = face_.pos.x + 0.5f * face_.size.x;
+            const float offset_y = face_.pos.y + 0.5f * face_.size.y;
+            const float offset_z = face_.pos.z + 0.5f * face_.size.z;
+            const unsigned int template_index = face_templates->GetIndex(*face);
+            if (face->GetTransparencyData() == Transparency::Partial)
+            {
+                std::shared_ptr<TransparentChunk>& transparent_chunk = transparent_chunks[chunk_position];
+                if (transparent_chunk == nullptr)
                 {
-                    transparent_chunks[chunk_position] = std::make_shared<TransparentChunk>();
+                    transparent_chunk = std::make_shared<TransparentChunk>();
+                    render_order_should_be_updated = true;
                 }
-                //Add 0.5 because the origin of the block is at the center
-                //but the coordinates start from the block corner
-                transparent_chunks[chunk_position]->AddFace(face_, texture_multipliers, x_ + 0.5f, y_ + 0.5f, z_ + 0.5f);
+                transparent_chunk->AddFace(*face, template_index, face_.texture_multipliers, offset_x, offset_y, offset_z);
             }
             else
             {
-                std::lock_guard<std::mutex> lock(chunks_mutex);
-                auto chunk_it = chunks.find(chunk_position);
-                if (chunk_it == chunks.end())
+                std::shared_ptr<Chunk>& chunk = chunks[chunk_position];
+                if (chunk == nullptr)
                 {
-                    chunks[chunk_position] = std::make_shared<Chunk>();
+                    chunk = std::make_shared<Chunk>();
+                    render_order_should_be_updated = true;
                 }
-                chunks[chunk_position]->AddFace(face_, texture_multipliers, x_ + 0.5f, y_ + 0.5f, z_ + 0.5f);
+                chunk->AddFace(*face, template_index, face_.texture_multipliers, offset_x, offset_y, offset_z);
             }
         }
 
-        const std::vector<unsigned int> WorldRenderer::GetColorModifier(const int y, const Biome* biome, const Blockstate* blockstate, const std::vector<bool>& use_tintindex) const
+        const std::array<unsigned int, 2> WorldRenderer::GetColorModifier(const int y, const Biome* biome, const Blockstate* blockstate, const std::vector<bool>& use_tintindex) const
         {
-            std::vector<unsigned int> texture_modifier(use_tintindex.size(), 0xFFFFFFFF);
-            for (int i = 0; i < use_tintindex.size(); ++i)
+            std::array<unsigned int, 2> texture_modifier = { 0xFFFFFFFF, 0xFFFFFFFF };
+            // The tint is the same for all the indices using it
+            unsigned int tint = 0xFFFFFFFF;
+            // If false, the tint is also applied to the indices with use_tintindex false
+            bool only_tintindex = true;
+            switch (blockstate->GetTintType())
             {
-                switch (blockstate->GetTintType())
+            case TintType::None:
+                return texture_modifier;
+            case TintType::Grass:
+                if (biome)
                 {
-                case TintType::None:
-                    break;
-                case TintType::Grass:
-                    if (use_tintindex[i])
-                    {
-                        if (biome)
-                        {
-                            texture_modifier[i] = biome->GetColorMultiplier(y, true);
-                        }
-                    }
-                    break;
-                case TintType::Leaves:
-                    if (use_tintindex[i])
-                    {
-                        if (biome)
-                        {
-                            texture_modifier[i] = biome->GetColorMultiplier(y, false);
-                        }
-                    }
-                    break;
-                    //Something like black when signal strength is 0 and red when it's 15
-                case TintType::Redstone:
+                    tint = biome->GetColorMultiplier(y, true);
+                }
+                break;
+            case TintType::Leaves:
+                if (biome)
+                {
+                    tint = biome->GetColorMultiplier(y, false);
+                }
+                break;
+                //Something like black when signal strength is 0 and red when it's 15
+            case TintType::Redstone:
+                only_tintindex = false;
 #if PROTOCOL_VERSION == 340 // 1.12.2
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * blockstate->GetMetadata());
+                tint = 0xFF000000 | (25 + 15 * blockstate->GetMetadata());
 #elif PROTOCOL_VERSION == 393 // 1.13
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 1752) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 1752) / 9) % 16));
 #elif PROTOCOL_VERSION == 401 || PROTOCOL_VERSION == 404 // 1.13.1 && 1.13.2
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 1753) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 1753) / 9) % 16));
 #elif PROTOCOL_VERSION == 477 || PROTOCOL_VERSION == 480 || PROTOCOL_VERSION == 485 || PROTOCOL_VERSION == 490 || PROTOCOL_VERSION == 498 // 1.14.X
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2056) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2056) / 9) % 16));
 #elif PROTOCOL_VERSION == 573 || PROTOCOL_VERSION == 575 || PROTOCOL_VERSION == 578 // 1.15.X
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2056) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2056) / 9) % 16));
 #elif PROTOCOL_VERSION == 735 || PROTOCOL_VERSION == 736 || PROTOCOL_VERSION == 751 || PROTOCOL_VERSION == 753  || PROTOCOL_VERSION == 754 // 1.16.X
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2058) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2058) / 9) % 16));
 #elif PROTOCOL_VERSION == 755 || PROTOCOL_VERSION == 756 // 1.17.X
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2114) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2114) / 9) % 16));
 #elif PROTOCOL_VERSION == 757 || PROTOCOL_VERSION == 758 // 1.18.X
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2114) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2114) / 9) % 16));
 #elif PROTOCOL_VERSION == 759 // 1.19
-                    texture_modifier[i] = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2312) / 9) % 16));
+                tint = 0xFF000000 | (25 + 15 * (((blockstate->GetId() - 2312) / 9) % 16));
 #else
         #error "Protocol version not implemented"
 #endif
-                    break;
-                case TintType::Water:
-                    if (biome)
+                break;
+            case TintType::Water:
+                only_tintindex = false;
+                if (biome)
+                {
+                    tint = biome->GetWaterColorMultiplier();
+                }
+                break;
+            default:
+                break;
+            }
+
+            for (int i = 0; i < std::min(2, static_cast<int>(use_tintindex.size())); ++i)
+            {
+                if (!only_tintindex || use_tintindex[i])
+                {
+                    texture_modifier[i] = tint;
+                }
+            }
+            return texture_modifier;
+        }
+
+        void WorldRenderer::UpdateRenderOrder()
+        {
+            m_mutex_camera.lock();
+            const glm::vec3& camera_pos = camera->GetPosition();
+            const Position current_camera_block(static_cast<int>(std::floor(camera_pos.x)), static_cast<int>(std::floor(camera_pos.y)), static_cast<int>(std::floor(camera_pos.z)));
+            m_mutex_camera.unlock();
+
+            const bool sections_changed = render_order_should_be_updated;
+            if (!sections_changed && current_camera_block == render_order_camera_block)
+            {
+                return;
+            }
+            render_order_should_be_updated = false;
+            render_order_camera_block = current_camera_block;
+
+            if (sections_changed)
+            {
+                std::unordered_map<Position, RenderSection> loaded_sections;
+                loaded_sections.reserve(chunks.size() + transparent_chunks.size());
+                for (auto it = chunks.begin(); it != chunks.end(); ++it)
+                {
+                    RenderSection& section = loaded_sections[it->first];
+                    section.pos = it->first;
+                    section.chunk = it->second;
+                }
+                for (auto it = transparent_chunks.begin(); it != transparent_chunks.end(); ++it)
+                {
+                    RenderSection& section = loaded_sections[it->first];
+                    section.pos = it->first;
+                    section.transparent_chunk = it->second;
+                }
+
+                // Keep the previous order of the sections still
+                // loaded, and add the new ones at the end
+                std::vector<RenderSection> new_order;
+                new_order.reserve(loaded_sections.size());
+                for (size_t i = 0; i < render_order.size(); ++i)
+                {
+                    auto it = loaded_sections.find(render_order[i].pos);
+                    if (it != loaded_sections.end())
                     {
-                        texture_modifier[i] = biome->GetWaterColorMultiplier();
+                        new_order.push_back(std::move(it->second));
+                        loaded_sections.erase(it);
                     }
-                    break;
-                default:
-                    break;
                 }
+                for (auto& p : loaded_sections)
+                {
+                    new_order.push_back(std::move(p.second));
+                }
+                render_order = std::move(new_order);
+            }
+
+            std::vector<float> distances(render_order.size());
+            m_mutex_camera.lock();
+            for (size_t i = 0; i < render_order.size(); ++i)
+            {
+                distances[i] = DistanceToCamera(render_order[i].pos);
+            }
+            m_mutex_camera.unlock();
+
+            // Insertion sort, from far to near. The previous
+            // order is almost sorted already
+            for (size_t i = 1; i < render_order.size(); ++i)
+            {
+                RenderSection section = std::move(render_order[i]);
+                const float distance = distances[i];
+                size_t j = i;
+                while (j > 0 && distances[j - 1] < distance)
+                {
+                    render_order[j] = std::move(render_order[j - 1]);
+                    distances[j] = distances[j - 1];
+                    j -= 1;
+                }
+                render_order[j] = std::move(section);
+                distances[j] = distance;
             }
-            return texture_modifier;
         }
 
         const float WorldRenderer::DistanceToCamera(const Position& chunk) const
         {
             return camera->GetDistance(CHUNK_WIDTH * (chunk.x + 0.5f), section_height * (chunk.y + 0.5f), CHUNK_WIDTH * (chunk.z + 0.5f));
         }
+
+        void WorldRenderer::CullHiddenSections(const std::array<glm::vec4, 6>& frustum_planes, const glm::vec3& camera_pos)
+        {
+            if (render_order.empty())
+            {
+                return;
+            }
+
+            // The walk is limited to the box around all the rendered sections
+            Position min_pos = render_order[0].pos;
+            Position max_pos = render_order[0].pos;
+            for (const auto& s : render_order)
+            {
+                min_pos = Position(std::min(min_pos.x, s.pos.x), std::min(min_pos.y, s.pos.y), std::min(min_pos.z, s.pos.z));
+                max_pos = Position(std::max(max_pos.x, s.pos.x), std::max(max_pos.y, s.pos.y), std::max(max_pos.z, s.pos.z));
+            }
+            const Position camera_section(
+                static_cast<int>(std::floor(camera_pos.x / CHUNK_WIDTH)),
+                static_cast<int>(std::floor(camera_pos.y / section_height)),
+                static_cast<int>(std::floor(camera_pos.z / CHUNK_WIDTH))
+            );
+            // Outside of the world (above the build limit for example), everything can be seen
+            if (camera_section.x < min_pos.x || camera_section.x > max_pos.x ||
+                camera_section.y < min_pos.y || camera_section.y > max_pos.y ||
+                camera_section.z < min_pos.z || camera_section.z > max_pos.z)
+            {
+                return;
+            }
+
+            const Position dims = max_pos - min_pos + Position(1, 1, 1);
+            const auto index = [&](const Position& p)
+            {
+                return ((p.y - min_pos.y) * dims.z + p.z - min_pos.z) * dims.x + p.x - min_pos.x;
+            };
+            section_reached.assign(static_cast<size_t>(dims.x) * dims.y * dims.z, 0);
+
+            // Same order as the faces in section_visibility, the opposite of i is 5 - i
+            const std::array<Position, 6> directions = { Position(0, -1, 0), Position(0, 0, -1),
+                Position(-1, 0, 0), Position(1, 0, 0), Position(0, 0, 1), Position(0, 1, 0) };
+            struct Step
+            {
+                Position pos;
+                // Face the section was entered from, -1 for the camera one
+                int entry_face;
+                // Directions already taken to reach this section, they are never taken back
+                unsigned char directions;
+            };
+            std::vector<Step> to_visit;
+            to_visit.push_back({ camera_section, -1, 0 });
+            section_reached[index(camera_section)] = 1;
+
+            // Breadth first, so each section is reached by the shortest path
+            for (size_t i = 0; i < to_visit.size(); ++i)
+            {
+                const Step step = to_visit[i];
+                auto it = section_visibility.find(step.pos);
+                const unsigned long long visibility = it == section_visibility.end() ? (1ULL << 36) - 1 : it->second;
+                for (int d = 0; d < 6; ++d)
+                {
+                    if (step.directions & (1 << (5 - d)))
+                    {
+                        continue;
+                    }
+                    if (step.entry_face != -1 && !((visibility >> (6 * step.entry_face + d)) & 1))
+                    {
+                        continue;
+                    }
+                    const Position next = step.pos + directions[d];
+                    if (next.x < min_pos.x || next.x > max_pos.x ||
+                        next.y < min_pos.y || next.y > max_pos.y ||
+                        next.z < min_pos.z || next.z > max_pos.z ||
+                        section_reached[index(next)])
+                    {
+                        continue;
+                    }
+                    const glm::vec3 min_corner(CHUNK_WIDTH * next.x, static_cast<int>(section_height) * next.y, CHUNK_WIDTH * next.z);
+                    const glm::vec3 max_corner(CHUNK_WIDTH * (next.x + 1), static_cast<int>(section_height) * (next.y + 1), CHUNK_WIDTH * (next.z + 1));
+                    if (!IsBoxInFrustum(frustum_planes, min_corner, max_corner))
+                    {
+                        continue;
+                    }
+                    section_reached[index(next)] = 1;
+                    to_visit.push_back({ next, 5 - d, static_cast<unsigned char>(step.directions | (1 << d)) });
+                }
+            }
+
+            for (size_t i = 0; i < render_order.size(); ++i)
+            {
+                section_visible[i] &= section_reached[index(render_order[i].pos)];
+            }
+        }
+
+        const float WorldRenderer::MeshPriority(const int x_, const int z_) const
+        {
+            const glm::vec3& camera_pos = camera->GetPosition();
+            const float dx = CHUNK_WIDTH * (x_ + 0.5f) - camera_pos.x;
+            const float dz = CHUNK_WIDTH * (z_ + 0.5f) - camera_pos.z;
+            const float distance = std::sqrt(dx * dx + dz * dz);
+
+            // The column height is not known here, take everything
+            // the camera can see above and below it
+            const glm::vec3 min_corner(CHUNK_WIDTH * x_, camera_pos.y - 256.0f, CHUNK_WIDTH * z_);
+            const glm::vec3 max_corner(CHUNK_WIDTH * (x_ + 1), camera_pos.y + 256.0f, CHUNK_WIDTH * (z_ + 1));
+            if (IsBoxInFrustum(camera->GetFrustumPlanes(), min_corner, max_corner))
+            {
+                return distance;
+            }
+            // Chunks behind the camera still come before the far visible ones
+            return 4.0f * distance + CHUNK_WIDTH;
+        }
     } // Renderer
 } // Botcraft
\ No newline at end of file
@@ -14,6 +14,11 @@ namespace Botcraft
         }
         main_handler = handler;
 
+        ring = std::vector<std::shared_ptr<ProtocolCraft::Message> >(ring_size);
+        ring_head = 0;
+        ring_tail = 0;
+        consumer_sleeping = false;
+
         processing = true;
         processing_thread = std::thread(&AsyncHandler::DequeueMsg, this);
     }
@@ -21,7 +26,10 @@ namespace Botcraft
     AsyncHandler::~AsyncHandler()
     {
         processing = false;
-        processing_condition_variable.notify_all();
+        {
+            std::lock_guard<std::mutex> lck(sleep_mutex);
+            sleep_condition_variable.notify_all();
+        }
 
         if (processing_thread.joinable())
         {
@@ -31,9 +39,37 @@ namespace Botcraft
 
     void AsyncHandler::Handle(ProtocolCraft::Message& msg)
     {
-        std::unique_lock<std::mutex> lck(processing_mutex);
-        msg_to_process.push(msg.Clone());
-        processing_condition_variable.notify_all();
+        // Messages coming from the NetworkManager are always
+        // owned by a shared_ptr, we can just keep a reference
+        // on it. The NetworkManager message pool won't reuse an
+        // instance as long as we hold it
+        std::shared_ptr<ProtocolCraft::Message> shared_msg = msg.weak_from_this().lock();
+        if (shared_msg == nullptr)
+        {
+            shared_msg = msg.Clone();
+        }
+
+        {
+            std::lock_guard<std::mutex> lck(producer_mutex);
+            const size_t tail = ring_tail.load(std::memory_order_relaxed);
+            // Ring is full, wait for the processing thread to catch up
+            while (tail - ring_head.load(std::memory_order_acquire) >= ring_size)
+            {
+                if (!processing)
+                {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            ring[tail & (ring_size - 1)] = std::move(shared_msg);
+            ring_tail.store(tail + 1, std::memory_order_seq_cst);
+        }
+
+        if (consumer_sleeping.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard<std::mutex> lck(sleep_mutex);
+            sleep_condition_variable.notify_one();
+        }
     }
 
     void AsyncHandler::DequeueMsg()
@@ -41,26 +77,26 @@ namespace Botcraft
         Logger::GetInstance().RegisterThread("AsyncHandlerMsgProcessing");
         while (processing)
         {
-            // Wait for the signal that there is
-            // some chunk data
+            size_t head = ring_head.load(std::memory_order_relaxed);
+            size_t tail = ring_tail.load(std::memory_order_acquire);
+
+            if (head == tail)
             {
-                std::unique_lock<std::mutex> lck(processing_mutex);
-                processing_condition_variable.wait(lck);
+                std::unique_lock<std::mutex> lck(sleep_mutex);
+                consumer_sleeping.store(true, std::memory_order_seq_cst);
+                sleep_condition_variable.wait(lck, [&]() { return !processing || ring_tail.load(std::memory_order_seq_cst) != head; });
+                consumer_sleeping.store(false, std::memory_order_relaxed);
+                continue;
             }
-            while (!msg_to_process.empty())
-            {
-                std::shared_ptr<ProtocolCraft::Message> msg;
-                // Get the data from the queue
-                {
-                    std::lock_guard<std::mutex> process_guard(processing_mutex);
-                    msg = std::move(msg_to_process.front());
-                    msg_to_process.pop();
-                }
 
+            // Process all the available messages in one batch
+            // before giving the slots back to the producer
+            for (; head != tail; ++head)
+            {
+                std::shared_ptr<ProtocolCraft::Message> msg = std::move(ring[head & (ring_size - 1)]);
                 msg->Dispatch(main_handler);
             }
+            ring_head.store(head, std::memory_order_release);
         }
     }
-
-
-}
\ No newline at end of file
+}
@@ -0,0 +1,174 @@
+#if defined(__APPLE__) && !defined(_XOPEN_SOURCE)
+// ucontext functions are only visible with _XOPEN_SOURCE on macOS
+#define _XOPEN_SOURCE 600
+#endif
+
+#include "botcraft/Utilities/Fiber.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cstdint>
+#include <ucontext.h>
+#endif
+
+namespace Botcraft
+{
+#ifdef _WIN32
+    struct Fiber::Impl
+    {
+        LPVOID fiber = nullptr;
+        LPVOID caller = nullptr;
+
+        static VOID WINAPI Entry(LPVOID param)
+        {
+            Fiber* self = static_cast<Fiber*>(param);
+            self->Run();
+            // Returning from a fiber procedure would exit the thread
+            SwitchToFiber(self->impl->caller);
+        }
+    };
+#else
+    struct Fiber::Impl
+    {
+        ucontext_t context;
+        ucontext_t caller;
+        std::unique_ptr<char[]> stack;
+
+        // makecontext only forwards int arguments, the pointer is split in two
+        static void Entry(unsigned int high, unsigned int low)
+        {
+            const std::uintptr_t address = (static_cast<std::uintptr_t>(high) << 16 << 16) | static_cast<std::uintptr_t>(low);
+            Fiber* self = reinterpret_cast<Fiber*>(address);
+            self->Run();
+            // Returning switches to uc_link, the caller context
+        }
+    };
+#endif
+
+    Fiber::Fiber(const std::function<void()>& func_, const size_t stack_size)
+    {
+        func = func_;
+        impl = std::make_unique<Impl>();
+        finished = false;
+        running = false;
+
+#ifdef _WIN32
+        impl->fiber = CreateFiber(stack_size, &Impl::Entry, this);
+        if (impl->fiber == nullptr)
+        {
+            LOG_ERROR("Error creating fiber (" << GetLastError() << ")");
+            finished = true;
+        }
+#else
+        impl->stack = std::make_unique<char[]>(stack_size);
+        if (getcontext(&impl->context) != 0)
+        {
+            LOG_ERROR("Error creating fiber context");
+            finished = true;
+            return;
+        }
+        impl->context.uc_stack.ss_sp = impl->stack.get();
+        impl->context.uc_stack.ss_size = stack_size;
+        impl->context.uc_link = &impl->caller;
+
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(this);
+        makecontext(&impl->context, reinterpret_cast<void(*)()>(&Impl::Entry), 2,
+            static_cast<unsigned int>(address >> 16 >> 16), static_cast<unsigned int>(address & 0xFFFFFFFF));
+#endif
+    }
+
+    Fiber::~Fiber()
+    {
+        if (running)
+        {
+            LOG_ERROR("Deleting a fiber from inside itself");
+        }
+        else if (!finished)
+        {
+            LOG_WARNING("Deleting an unfinished fiber, objects on its stack are not destroyed");
+        }
+#ifdef _WIN32
+        if (impl->fiber != nullptr)
+        {
+            DeleteFiber(impl->fiber);
+        }
+#endif
+    }
+
+    void Fiber::Resume()
+    {
+        if (finished || running)
+        {
+            return;
+        }
+
+        running = true;
+#ifdef _WIN32
+        // Only a fiber can switch to another fiber
+        if (!IsThreadAFiber())
+        {
+            ConvertThreadToFiber(nullptr);
+        }
+        impl->caller = GetCurrentFiber();
+        SwitchToFiber(impl->fiber);
+#else
+        swapcontext(&impl->caller, &impl->context);
+#endif
+        running = false;
+    }
+
+    void Fiber::Suspend()
+    {
+        if (!running)
+        {
+            LOG_ERROR("Suspending a fiber from outside of it");
+            return;
+        }
+
+#ifdef _WIN32
+        SwitchToFiber(impl->caller);
+#else
+        swapcontext(&impl->context, &impl->caller);
+#endif
+    }
+
+    void Fiber::Cancel()
+    {
+        if (running)
+        {
+            LOG_ERROR("Cancelling a fiber from inside itself");
+            return;
+        }
+        finished = true;
+    }
+
+    const bool Fiber::IsFinished() const
+    {
+        return finished;
+    }
+
+    const bool Fiber::IsRunning() const
+    {
+        return running;
+    }
+
+    void Fiber::Run()
+    {
+        try
+        {
+            func();
+        }
+        // An exception can't go through the fiber entry point
+        catch (std::exception& e)
+        {
+            LOG_ERROR("Exception caught in fiber: " << e.what());
+        }
+        catch (...)
+        {
+            LOG_ERROR("Unknown exception caught in fiber");
+        }
+        finished = true;
+    }
+} // Botcraft
@@ -1,33 +1,50 @@
 #include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/LogRingBuffer.hpp"
 
-#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 
 namespace Botcraft
 {
     Logger::Logger()
     {
         filename = "";
-        file_buffer = "";
         log_level = LogLevel::Info;
-        last_time_logged = std::chrono::steady_clock::now();
         log_func = [this](const std::string& s)
         {
             std::cout << s;
             std::cout.flush();
         };
+        thread_names_version = 0;
+
+        // Must be a power of two
+        queue = std::make_unique<LogRingBuffer>(8192);
+        writer_sleeping = false;
+        running = true;
+        writer_thread = std::thread(&Logger::Run, this);
     }
 
     Logger::~Logger()
     {
+        running = false;
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            writer_condition.notify_one();
+        }
+        if (writer_thread.joinable())
+        {
+            writer_thread.join();
+        }
+
+        // Write everything that was logged after the writer thread stopped
+        Drain();
+
         std::lock_guard<std::mutex> lock(mutex);
-        if (filename != "")
+        if (file.is_open())
         {
-            std::ofstream outfile(filename, std::ios::out | std::ios::app);
-            outfile << file_buffer;
+            file.close();
         }
-        file_buffer = "";
     }
 
     Logger& Logger::GetInstance()
@@ -36,30 +53,74 @@ namespace Botcraft
         return test;
     }
 
+    const char* Logger::GetLevelString(const LogLevel l)
+    {
+        switch (l)
+        {
+        case LogLevel::Trace:
+            return "[TRACE]";
+        case LogLevel::Debug:
+            return "[DEBUG]";
+        case LogLevel::Info:
+            return "[INFO]";
+        case LogLevel::Warning:
+            return "[WARNING]";
+        case LogLevel::Error:
+            return "[ERROR]";
+        case LogLevel::Fatal:
+            return "[FATAL]";
+        default:
+            return "[]";
+        }
+    }
+
     void Logger::Log(const std::string& s)
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        log_func(s);
+        Log(std::string(s));
+    }
 
-        file_buffer += s;
-        auto now = std::chrono::steady_clock::now();
-        // Only write to file every 5 seconds
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time_logged).count() > 5000)
+    void Logger::Log(std::string&& s)
+    {
+        while (!queue->TryPush(s))
         {
-            if (filename != "")
+            // Writer thread stopped, write the message directly
+            if (!running)
             {
-                std::ofstream outfile(filename, std::ios::out | std::ios::app);
-                outfile << file_buffer;
+                std::lock_guard<std::mutex> lock(mutex);
+                log_func(s);
+                if (file.is_open())
+                {
+                    file << s;
+                    file.flush();
+                }
+                return;
             }
-            file_buffer = "";
-            last_time_logged = now;
+            // Queue is full, let the writer thread make some room
+            std::this_thread::yield();
+        }
+
+        // Pairs with the fence in Run, either we see the writer
+        // thread sleeping or it sees our message before sleeping
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writer_sleeping.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            writer_condition.notify_one();
         }
     }
 
     void Logger::SetFilename(const std::string& s)
     {
         std::lock_guard<std::mutex> lock(mutex);
+        if (file.is_open())
+        {
+            file.close();
+        }
         filename = s;
+        if (filename != "")
+        {
+            file.open(filename, std::ios::out | std::ios::app);
+        }
     }
 
     void Logger::SetLogLevel(const LogLevel l)
@@ -69,7 +130,7 @@ namespace Botcraft
 
     LogLevel Logger::GetLogLevel() const
     {
-        return log_level;
+        return log_level.load(std::memory_order_relaxed);
     }
 
     void Logger::SetLogFunc(const std::function<void(const std::string&)>& f)
@@ -98,10 +159,62 @@ namespace Botcraft
         return s;
     }
 
+    const std::string& Logger::GetCachedDate() const
+    {
+        thread_local std::time_t cached_time = 0;
+        thread_local std::string cached_seconds;
+        thread_local std::string date;
+
+        auto now = std::chrono::system_clock::now();
+        const int ms = static_cast<int>((std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000).count());
+
+        std::time_t t = std::chrono::system_clock::to_time_t(now);
+        if (t != cached_time || cached_seconds.empty())
+        {
+            std::tm tm;
+#ifdef _WIN32
+            localtime_s(&tm, &t);
+#else
+            localtime_r(&t, &tm);
+#endif
+            std::stringstream s;
+            s << '[' << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << '.';
+            cached_seconds = s.str();
+            cached_time = t;
+        }
+
+        date = cached_seconds;
+        date += static_cast<char>('0' + ms / 100);
+        date += static_cast<char>('0' + (ms / 10) % 10);
+        date += static_cast<char>('0' + ms % 10);
+        date += ']';
+
+        return date;
+    }
+
+    const std::string& Logger::GetCurrentThreadPrefix()
+    {
+        thread_local size_t cached_version = std::numeric_limits<size_t>::max();
+        thread_local std::string prefix;
+
+        const size_t version = thread_names_version.load(std::memory_order_acquire);
+        if (version != cached_version)
+        {
+            const std::thread::id id = std::this_thread::get_id();
+            std::ostringstream s;
+            s << GetThreadName(id) << '(' << id << ')';
+            prefix = s.str();
+            cached_version = version;
+        }
+
+        return prefix;
+    }
+
     void Logger::RegisterThread(const std::string& name)
     {
         std::lock_guard<std::mutex> lock(thread_mutex);
         thread_names[std::this_thread::get_id()] = name;
+        thread_names_version += 1;
 
         thread_local struct ThreadExiter
         {
@@ -116,17 +229,77 @@ namespace Botcraft
     {
         std::lock_guard<std::mutex> lock(thread_mutex);
         thread_names[id] = name;
+        thread_names_version += 1;
     }
 
     std::string Logger::GetThreadName(const std::thread::id id)
     {
         std::lock_guard<std::mutex> lock(thread_mutex);
-        return thread_names[id];
+        auto it = thread_names.find(id);
+        if (it == thread_names.end())
+        {
+            return "";
+        }
+        return it->second;
     }
 
     void Logger::UnregisterThread(const std::thread::id id)
     {
         std::lock_guard<std::mutex> lock(thread_mutex);
-        thread_names.erase(id);
+        if (thread_names.erase(id) > 0)
+        {
+            thread_names_version += 1;
+        }
+    }
+
+    void Logger::Run()
+    {
+        while (running)
+        {
+            if (Drain())
+            {
+                continue;
+            }
+
+            // Nothing left to write, make sure it's on disk before sleeping
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (file.is_open())
+                {
+                    file.flush();
+                }
+            }
+
+            std::unique_lock<std::mutex> lock(writer_mutex);
+            writer_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (queue->Empty() && running)
+            {
+                // Timeout is only a safety net, producers wake us up
+                writer_condition.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            writer_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool Logger::Drain()
+    {
+        std::string s;
+        if (!queue->TryPop(s))
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        do
+        {
+            log_func(s);
+            if (file.is_open())
+            {
+                file << s;
+            }
+        } while (queue->TryPop(s));
+
+        return true;
     }
 }
@@ -0,0 +1,295 @@
+#include "botcraft/Utilities/NBTStreamReader.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+#ifdef USE_COMPRESSION
+#include <zlib.h>
+#endif
+
+#include "protocolCraft/BinaryReadWrite.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+    // Same limit as vanilla
+    static const int max_nbt_depth = 512;
+    static const size_t buffer_size = 64 * 1024;
+
+    NBTStreamReader::NBTStreamReader(std::istream& stream_) : stream(stream_)
+    {
+        input_buffer = std::vector<unsigned char>(buffer_size);
+        output_buffer = std::vector<unsigned char>(buffer_size);
+        output_position = 0;
+        output_size = 0;
+
+        // Read the first chunk to check for the gzip magic number
+        stream.read(reinterpret_cast<char*>(input_buffer.data()), input_buffer.size());
+        const size_t read_size = static_cast<size_t>(stream.gcount());
+        compressed = read_size >= 2 && input_buffer[0] == 0x1F && input_buffer[1] == 0x8B;
+
+        if (!compressed)
+        {
+            std::swap(input_buffer, output_buffer);
+            output_size = read_size;
+            return;
+        }
+
+#ifdef USE_COMPRESSION
+        inflate_stream = std::make_unique<z_stream_s>();
+        std::memset(inflate_stream.get(), 0, sizeof(z_stream_s));
+        // + 16 to expect a gzip header
+        if (inflateInit2(inflate_stream.get(), 16 + MAX_WBITS) != Z_OK)
+        {
+            throw(std::runtime_error("Error initializing gzip decompression"));
+        }
+        inflate_stream->next_in = input_buffer.data();
+        inflate_stream->avail_in = static_cast<unsigned int>(read_size);
+        inflate_finished = false;
+#endif
+    }
+
+    NBTStreamReader::~NBTStreamReader()
+    {
+#ifdef USE_COMPRESSION
+        if (inflate_stream != nullptr)
+        {
+            inflateEnd(inflate_stream.get());
+        }
+#endif
+    }
+
+    void NBTStreamReader::Read(NBTStreamHandler& handler)
+    {
+#ifndef USE_COMPRESSION
+        if (compressed)
+        {
+            throw(std::runtime_error("Trying to read compressed NBT but botcraft was compiled without compression support"));
+        }
+#endif
+
+        const TagType type = static_cast<TagType>(ReadValue<char>());
+        // Empty NBT
+        if (type == TagType::End)
+        {
+            return;
+        }
+
+        if (type != TagType::Compound)
+        {
+            throw(std::runtime_error("Error reading NBT, not starting with compound"));
+        }
+
+        const std::string name = ReadNBTString();
+        ReadPayload(type, name, handler, 0);
+    }
+
+    void NBTStreamReader::ReadFile(const std::string& path, NBTStreamHandler& handler)
+    {
+        std::ifstream file(path, std::ios_base::binary);
+        if (!file.is_open())
+        {
+            throw(std::runtime_error("Can't open NBT file " + path));
+        }
+
+        NBTStreamReader reader(file);
+        reader.Read(handler);
+    }
+
+    void NBTStreamReader::ReadPayload(const TagType type, const std::string& name, NBTStreamHandler& handler, const int depth)
+    {
+        if (depth > max_nbt_depth)
+        {
+            throw(std::runtime_error("Error reading NBT, max depth exceeded"));
+        }
+
+        switch (type)
+        {
+        case TagType::End:
+            break;
+        case TagType::Byte:
+            handler.OnByte(name, ReadValue<char>());
+            break;
+        case TagType::Short:
+            handler.OnShort(name, ReadValue<short>());
+            break;
+        case TagType::Int:
+            handler.OnInt(name, ReadValue<int>());
+            break;
+        case TagType::Long:
+            handler.OnLong(name, ReadValue<long long int>());
+            break;
+        case TagType::Float:
+            handler.OnFloat(name, ReadValue<float>());
+            break;
+        case TagType::Double:
+            handler.OnDouble(name, ReadValue<double>());
+            break;
+        case TagType::ByteArray:
+        {
+            const int size = ReadValue<int>();
+            if (size < 0)
+            {
+                throw(std::runtime_error("Error reading NBT, negative array size"));
+            }
+            std::vector<char> values(size);
+            for (int i = 0; i < size; ++i)
+            {
+                values[i] = ReadValue<char>();
+            }
+            handler.OnByteArray(name, values);
+            break;
+        }
+        case TagType::IntArray:
+        {
+            const int size = ReadValue<int>();
+            if (size < 0)
+            {
+                throw(std::runtime_error("Error reading NBT, negative array size"));
+            }
+            std::vector<int> values(size);
+            for (int i = 0; i < size; ++i)
+            {
+                values[i] = ReadValue<int>();
+            }
+            handler.OnIntArray(name, values);
+            break;
+        }
+        case TagType::LongArray:
+        {
+            const int size = ReadValue<int>();
+            if (size < 0)
+            {
+                throw(std::runtime_error("Error reading NBT, negative array size"));
+            }
+            std::vector<long long int> values(size);
+            for (int i = 0; i < size; ++i)
+            {
+                values[i] = ReadValue<long long int>();
+            }
+            handler.OnLongArray(name, values);
+            break;
+        }
+        case TagType::String:
+            handler.OnString(name, ReadNBTString());
+            break;
+        case TagType::List:
+        {
+            const TagType elements_type = static_cast<TagType>(ReadValue<char>());
+            const int size = ReadValue<int>();
+            if (size < 0 || (elements_type == TagType::End && size > 0))
+            {
+                throw(std::runtime_error("Error reading NBT, invalid list"));
+            }
+            handler.OnListStart(name, elements_type, size);
+            for (int i = 0; i < size; ++i)
+            {
+                ReadPayload(elements_type, "", handler, depth + 1);
+            }
+            handler.OnListEnd();
+            break;
+        }
+        case TagType::Compound:
+        {
+            handler.OnCompoundStart(name);
+            while (true)
+            {
+                const TagType child_type = static_cast<TagType>(ReadValue<char>());
+                if (child_type == TagType::End)
+                {
+                    break;
+                }
+                const std::string child_name = ReadNBTString();
+                ReadPayload(child_type, child_name, handler, depth + 1);
+            }
+            handler.OnCompoundEnd();
+            break;
+        }
+        default:
+            throw(std::runtime_error("Error reading NBT, unknown tag type"));
+        }
+    }
+
+    template<typename T>
+    T NBTStreamReader::ReadValue()
+    {
+        unsigned char data[sizeof(T)];
+        ReadBytes(data, sizeof(T));
+        ReadIterator iter = data;
+        size_t length = sizeof(T);
+        // Takes care of endianness
+        return ReadData<T>(iter, length);
+    }
+
+    std::string NBTStreamReader::ReadNBTString()
+    {
+        const unsigned short size = ReadValue<unsigned short>();
+        std::string output(size, '\0');
+        ReadBytes(reinterpret_cast<unsigned char*>(&output[0]), size);
+        return output;
+    }
+
+    void NBTStreamReader::ReadBytes(unsigned char* out, const size_t size)
+    {
+        size_t written = 0;
+        while (written < size)
+        {
+            if (output_position == output_size && !FillBuffer())
+            {
+                throw(std::runtime_error("Unexpected end of NBT data"));
+            }
+            const size_t copy_size = std::min(size - written, output_size - output_position);
+            std::memcpy(out + written, output_buffer.data() + output_position, copy_size);
+            written += copy_size;
+            output_position += copy_size;
+        }
+    }
+
+    bool NBTStreamReader::FillBuffer()
+    {
+        output_position = 0;
+        output_size = 0;
+
+        if (!compressed)
+        {
+            stream.read(reinterpret_cast<char*>(output_buffer.data()), output_buffer.size());
+            output_size = static_cast<size_t>(stream.gcount());
+            return output_size > 0;
+        }
+
+#ifdef USE_COMPRESSION
+        inflate_stream->next_out = output_buffer.data();
+        inflate_stream->avail_out = static_cast<unsigned int>(output_buffer.size());
+
+        while (!inflate_finished && inflate_stream->avail_out > 0)
+        {
+            if (inflate_stream->avail_in == 0)
+            {
+                stream.read(reinterpret_cast<char*>(input_buffer.data()), input_buffer.size());
+                const size_t read_size = static_cast<size_t>(stream.gcount());
+                if (read_size == 0)
+                {
+                    break;
+                }
+                inflate_stream->next_in = input_buffer.data();
+                inflate_stream->avail_in = static_cast<unsigned int>(read_size);
+            }
+
+            const int res = inflate(inflate_stream.get(), Z_NO_FLUSH);
+            if (res == Z_STREAM_END)
+            {
+                inflate_finished = true;
+            }
+            else if (res != Z_OK && res != Z_BUF_ERROR)
+            {
+                throw(std::runtime_error("Gzip decompression failed: " + std::string(inflate_stream->msg ? inflate_stream->msg : std::to_string(res))));
+            }
+        }
+
+        output_size = output_buffer.size() - inflate_stream->avail_out;
+#endif
+        return output_size > 0;
+    }
+} // Botcraft
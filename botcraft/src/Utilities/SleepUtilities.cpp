@@ -1,5 +1,7 @@
 #include "botcraft/Utilities/SleepUtilities.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <thread>
 
 #if _WIN32 && BETTER_SLEEP
@@ -7,10 +9,31 @@
 #include <timeapi.h>
 #endif
 
+#if __linux__
+#include <cerrno>
+#include <time.h>
+#endif
+
 namespace Botcraft
 {
-    void SleepUntil(const std::chrono::steady_clock::time_point& end)
+    static std::atomic<long long int> sleep_spin_threshold_us(0);
+
+    /// @brief Sleep until end with the best precision available on the platform
+    static void SleepUntilSystem(const std::chrono::steady_clock::time_point& end)
     {
+#if __linux__
+        // steady_clock is CLOCK_MONOTONIC on Linux. Sleeping until an absolute
+        // time doesn't accumulate the delay between computing the remaining
+        // duration and actually going to sleep
+        const long long int ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()).count();
+        timespec deadline;
+        deadline.tv_sec = static_cast<time_t>(ns / 1000000000LL);
+        deadline.tv_nsec = static_cast<long>(ns % 1000000000LL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+        {
+
+        }
+#else
 #if _WIN32 && BETTER_SLEEP
         timeBeginPeriod(1);
 #endif
@@ -20,5 +43,43 @@ namespace Botcraft
 #if _WIN32 && BETTER_SLEEP
         timeEndPeriod(1);
 #endif
+#endif
+    }
+
+    void SleepUntil(const std::chrono::steady_clock::time_point& end)
+    {
+        const std::chrono::microseconds spin_threshold(sleep_spin_threshold_us.load(std::memory_order_relaxed));
+
+        if (spin_threshold.count() > 0)
+        {
+            const std::chrono::steady_clock::time_point sleep_end = end - spin_threshold;
+            if (std::chrono::steady_clock::now() < sleep_end)
+            {
+                SleepUntilSystem(sleep_end);
+            }
+            while (std::chrono::steady_clock::now() < end)
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            SleepUntilSystem(end);
+        }
+    }
+
+    void SleepUntil(const VirtualClock::time_point& end)
+    {
+        SleepUntil(VirtualClock::ToSteady(end));
+    }
+
+    void SetSleepSpinThreshold(const std::chrono::microseconds& threshold)
+    {
+        sleep_spin_threshold_us = std::max(0LL, static_cast<long long int>(threshold.count()));
+    }
+
+    std::chrono::microseconds GetSleepSpinThreshold()
+    {
+        return std::chrono::microseconds(sleep_spin_threshold_us.load(std::memory_order_relaxed));
     }
 }
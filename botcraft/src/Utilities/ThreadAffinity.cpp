@@ -0,0 +1,216 @@
+#include "botcraft/Utilities/ThreadAffinity.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if _WIN32
+#include <Windows.h>
+#elif __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Botcraft
+{
+    /// @brief Parse a Linux cpu list, e.g. "0-3,8,10-11"
+    static std::vector<int> ParseCpuList(const std::string& list)
+    {
+        std::vector<int> output;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ','))
+        {
+            if (range.empty() || range == "\n")
+            {
+                continue;
+            }
+            const size_t dash = range.find('-');
+            try
+            {
+                const int first = std::stoi(range.substr(0, dash));
+                const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int i = first; i <= last; ++i)
+                {
+                    output.push_back(i);
+                }
+            }
+            catch (const std::exception&)
+            {
+                continue;
+            }
+        }
+        return output;
+    }
+
+    static std::vector<int> GetAllCpus()
+    {
+        std::vector<int> output;
+#if __linux__
+        // Only the cpus this process is allowed to run on
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+            {
+                if (CPU_ISSET(i, &set))
+                {
+                    output.push_back(i);
+                }
+            }
+        }
+#endif
+        if (output.empty())
+        {
+            for (unsigned int i = 0; i < std::max(1u, std::thread::hardware_concurrency()); ++i)
+            {
+                output.push_back(static_cast<int>(i));
+            }
+        }
+        return output;
+    }
+
+    std::vector<std::vector<int> > GetNumaNodesCpus()
+    {
+        const std::vector<int> all_cpus = GetAllCpus();
+        std::vector<std::vector<int> > output;
+#if __linux__
+        std::ifstream online_file("/sys/devices/system/node/online");
+        std::string online;
+        if (online_file && std::getline(online_file, online))
+        {
+            for (const int node : ParseCpuList(online))
+            {
+                std::ifstream cpulist_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                std::string cpulist;
+                if (!cpulist_file || !std::getline(cpulist_file, cpulist))
+                {
+                    continue;
+                }
+                std::vector<int> node_cpus;
+                for (const int cpu : ParseCpuList(cpulist))
+                {
+                    if (std::find(all_cpus.begin(), all_cpus.end(), cpu) != all_cpus.end())
+                    {
+                        node_cpus.push_back(cpu);
+                    }
+                }
+                // Memory only nodes, or nodes outside of this process cpuset
+                if (!node_cpus.empty())
+                {
+                    output.push_back(node_cpus);
+                }
+            }
+        }
+#endif
+        if (output.empty())
+        {
+            output.push_back(all_cpus);
+        }
+        return output;
+    }
+
+    bool SetCurrentThreadAffinity(const std::vector<int>& cpus)
+    {
+        if (cpus.empty())
+        {
+            return false;
+        }
+#if _WIN32
+        DWORD_PTR mask = 0;
+        for (const int cpu : cpus)
+        {
+            // Processor groups are not supported, only the first 64 cpus can be used
+            if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+            {
+                mask |= static_cast<DWORD_PTR>(1) << cpu;
+            }
+        }
+        return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int cpu : cpus)
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &set);
+            }
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+
+    thread_local int AffinityGroups::current_group = -1;
+
+    AffinityGroups::AffinityGroups()
+    {
+
+    }
+
+    AffinityGroups& AffinityGroups::GetInstance()
+    {
+        static AffinityGroups instance;
+        return instance;
+    }
+
+    void AffinityGroups::SetGroups(const std::vector<std::vector<int> >& cpus_)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cpus = cpus_;
+    }
+
+    const size_t AffinityGroups::GetNumGroups() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cpus.size();
+    }
+
+    const std::vector<int> AffinityGroups::GetCpus(const int group) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (group < 0 || group >= static_cast<int>(cpus.size()))
+        {
+            return {};
+        }
+        return cpus[group];
+    }
+
+    void AffinityGroups::JoinGroup(const int group)
+    {
+        const std::vector<int> group_cpus = GetCpus(group);
+        if (group_cpus.empty())
+        {
+            return;
+        }
+        if (!SetCurrentThreadAffinity(group_cpus))
+        {
+            LOG_WARNING("Can't set the affinity of a thread of group " << group);
+        }
+        current_group = group;
+    }
+
+    const int AffinityGroups::GetCurrentGroup()
+    {
+        return current_group;
+    }
+
+
+    AffinityGroupScope::AffinityGroupScope(const int group)
+    {
+        previous_group = AffinityGroups::current_group;
+        AffinityGroups::current_group = group;
+    }
+
+    AffinityGroupScope::~AffinityGroupScope()
+    {
+        AffinityGroups::current_group = previous_group;
+    }
+} // Botcraft
@@ -0,0 +1,99 @@
+#include <algorithm>
+
+#include "botcraft/Utilities/TimerWheel.hpp"
+
+namespace Botcraft
+{
+    TimerWheel::TimerWheel(const std::chrono::milliseconds& tick_duration_, const size_t num_slots_) :
+        tick_duration(std::max(tick_duration_, std::chrono::milliseconds(1))),
+        origin(VirtualClock::now())
+    {
+        slots = std::vector<std::list<Timer> >(std::max(num_slots_, static_cast<size_t>(1)));
+        current_tick = 0;
+        next_id = 1;
+    }
+
+    TimerWheel::TimerId TimerWheel::Schedule(const VirtualClock::time_point& deadline, std::function<void()>&& callback)
+    {
+        std::lock_guard<std::mutex> lock(wheel_mutex);
+        // A deadline in the past fires at the next Advance
+        const long long int deadline_tick = std::max(GetTick(deadline), current_tick + 1);
+        const size_t slot = static_cast<size_t>(deadline_tick % static_cast<long long int>(slots.size()));
+        const TimerId id = next_id++;
+        slots[slot].push_back(Timer{ id, deadline_tick, std::move(callback) });
+        timers[id] = { slot, std::prev(slots[slot].end()) };
+        return id;
+    }
+
+    TimerWheel::TimerId TimerWheel::ScheduleIn(const int delay_ms, std::function<void()>&& callback)
+    {
+        return Schedule(VirtualClock::now() + std::chrono::milliseconds(delay_ms), std::move(callback));
+    }
+
+    bool TimerWheel::Cancel(const TimerId id)
+    {
+        std::lock_guard<std::mutex> lock(wheel_mutex);
+        auto it = timers.find(id);
+        if (it == timers.end())
+        {
+            return false;
+        }
+        slots[it->second.first].erase(it->second.second);
+        timers.erase(it);
+        return true;
+    }
+
+    size_t TimerWheel::Advance(const VirtualClock::time_point& now)
+    {
+        std::vector<std::function<void()> > fired;
+        {
+            std::lock_guard<std::mutex> lock(wheel_mutex);
+            const long long int now_tick = std::chrono::duration_cast<std::chrono::nanoseconds>(now - origin).count() / std::chrono::duration_cast<std::chrono::nanoseconds>(tick_duration).count();
+            if (now_tick <= current_tick)
+            {
+                return 0;
+            }
+
+            // No need to look at a slot twice if more than a full turn elapsed
+            const long long int first_tick = std::max(current_tick + 1, now_tick - static_cast<long long int>(slots.size()) + 1);
+            for (long long int tick = first_tick; tick <= now_tick; ++tick)
+            {
+                std::list<Timer>& slot = slots[static_cast<size_t>(tick % static_cast<long long int>(slots.size()))];
+                for (auto it = slot.begin(); it != slot.end();)
+                {
+                    // Timers more than one turn ahead stay in the slot
+                    if (it->deadline_tick <= now_tick)
+                    {
+                        fired.push_back(std::move(it->callback));
+                        timers.erase(it->id);
+                        it = slot.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+            current_tick = now_tick;
+        }
+
+        for (size_t i = 0; i < fired.size(); ++i)
+        {
+            fired[i]();
+        }
+        return fired.size();
+    }
+
+    size_t TimerWheel::GetNumTimers() const
+    {
+        std::lock_guard<std::mutex> lock(wheel_mutex);
+        return timers.size();
+    }
+
+    long long int TimerWheel::GetTick(const VirtualClock::time_point& t) const
+    {
+        const long long int elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(t - origin).count();
+        const long long int tick = std::chrono::duration_cast<std::chrono::nanoseconds>(tick_duration).count();
+        return elapsed <= 0 ? 0 : (elapsed + tick - 1) / tick;
+    }
+} // Botcraft
@@ -0,0 +1,273 @@
+#include "botcraft/Utilities/Tracing.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+namespace Botcraft
+{
+#if USE_TRACING
+    struct TraceEvent
+    {
+        const char* name;
+        const char* arg_names[2];
+        long long args[2];
+        int num_args;
+        const void* id;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+        char phase;
+    };
+
+    struct TraceThreadBuffer
+    {
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        size_t num_dropped = 0;
+        std::thread::id thread_id;
+        /// @brief Logger name when the buffer was created, used if the thread is unregistered when the trace is written
+        std::string thread_name;
+    };
+
+    namespace
+    {
+        thread_local std::shared_ptr<TraceThreadBuffer> thread_buffer;
+
+        void WriteJSONString(std::ostream& os, const char* s)
+        {
+            os << '"';
+            for (; *s != '\0'; ++s)
+            {
+                if (*s == '"' || *s == '\\')
+                {
+                    os << '\\';
+                }
+                os << *s;
+            }
+            os << '"';
+        }
+
+        double ToMicroseconds(const std::chrono::steady_clock::duration d)
+        {
+            return std::chrono::duration<double, std::micro>(d).count();
+        }
+    }
+#endif
+
+    Tracer::Tracer()
+    {
+        running = false;
+    }
+
+    Tracer& Tracer::GetInstance()
+    {
+        static Tracer instance;
+        return instance;
+    }
+
+    void Tracer::Start()
+    {
+#if USE_TRACING
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        for (const auto& b : buffers)
+        {
+            std::lock_guard<std::mutex> buffer_lock(b->mutex);
+            b->events.clear();
+            b->num_dropped = 0;
+        }
+        origin = std::chrono::steady_clock::now();
+        running = true;
+#else
+        LOG_WARNING("Botcraft has been compiled without BOTCRAFT_TRACING, no zone will be recorded");
+#endif
+    }
+
+    bool Tracer::Stop(const std::string& path)
+    {
+#if USE_TRACING
+        running = false;
+
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Can't open trace file " << path);
+            return false;
+        }
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        bool first = true;
+        size_t num_dropped = 0;
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            TraceThreadBuffer& b = *buffers[i];
+            std::lock_guard<std::mutex> buffer_lock(b.mutex);
+            num_dropped += b.num_dropped;
+
+            std::string thread_name = Logger::GetInstance().GetThreadName(b.thread_id);
+            if (thread_name.empty())
+            {
+                thread_name = b.thread_name.empty() ? "Thread " + std::to_string(i) : b.thread_name;
+            }
+            file << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+            WriteJSONString(file, thread_name.c_str());
+            file << "}}";
+            first = false;
+
+            for (const TraceEvent& e : b.events)
+            {
+                file << ",\n{\"ph\":\"" << e.phase << "\",\"name\":";
+                WriteJSONString(file, e.name);
+                file << ",\"cat\":\"botcraft\",\"pid\":1,\"tid\":" << i << ",\"ts\":" << ToMicroseconds(e.start - origin);
+                if (e.phase == 'X')
+                {
+                    file << ",\"dur\":" << ToMicroseconds(e.end - e.start);
+                }
+                else
+                {
+                    file << ",\"id\":\"" << e.id << "\"";
+                }
+                if (e.num_args > 0)
+                {
+                    file << ",\"args\":{";
+                    for (int j = 0; j < e.num_args; ++j)
+                    {
+                        file << (j == 0 ? "" : ",");
+                        WriteJSONString(file, e.arg_names[j]);
+                        file << ":" << e.args[j];
+                    }
+                    file << "}";
+                }
+                file << "}";
+            }
+            b.events.clear();
+            b.num_dropped = 0;
+        }
+        file << "\n]}\n";
+
+        // Buffers only referenced here belong to threads that don't exist anymore
+        for (auto it = buffers.begin(); it != buffers.end();)
+        {
+            it = it->use_count() == 1 ? buffers.erase(it) : it + 1;
+        }
+
+        if (num_dropped > 0)
+        {
+            LOG_WARNING(num_dropped << " trace events dropped, more than " << max_events_per_thread << " events on a thread");
+        }
+        return file.good();
+#else
+        LOG_WARNING("Botcraft has been compiled without BOTCRAFT_TRACING, no trace written to " << path);
+        return false;
+#endif
+    }
+
+    const bool Tracer::IsRunning() const
+    {
+        return running;
+    }
+
+    const char* Tracer::Intern(const std::string& s)
+    {
+        std::lock_guard<std::mutex> lock(interned_mutex);
+        return interned.insert(s).first->c_str();
+    }
+
+#if USE_TRACING
+    void Tracer::Record(const char phase, const char* name, const std::chrono::steady_clock::time_point& start,
+        const std::chrono::steady_clock::time_point& end, const void* id,
+        const int num_args, const char* const* arg_names, const long long* args)
+    {
+        if (!thread_buffer)
+        {
+            thread_buffer = std::make_shared<TraceThreadBuffer>();
+            thread_buffer->thread_id = std::this_thread::get_id();
+            thread_buffer->thread_name = Logger::GetInstance().GetThreadName(thread_buffer->thread_id);
+            std::lock_guard<std::mutex> lock(buffers_mutex);
+            buffers.push_back(thread_buffer);
+        }
+
+        TraceEvent e;
+        e.phase = phase;
+        e.name = name;
+        e.start = start;
+        e.end = end;
+        e.id = id;
+        e.num_args = num_args;
+        for (int i = 0; i < num_args; ++i)
+        {
+            e.arg_names[i] = arg_names[i];
+            e.args[i] = args[i];
+        }
+
+        std::lock_guard<std::mutex> lock(thread_buffer->mutex);
+        if (thread_buffer->events.size() >= max_events_per_thread)
+        {
+            thread_buffer->num_dropped += 1;
+            return;
+        }
+        thread_buffer->events.push_back(e);
+    }
+
+
+    TraceZone::TraceZone(const char* name_)
+    {
+        name = name_;
+        num_args = 0;
+        active = Tracer::GetInstance().IsRunning();
+        if (active)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    TraceZone::TraceZone(const char* name_, const char* arg_name_0, const long long arg_0) : TraceZone(name_)
+    {
+        arg_names[0] = arg_name_0;
+        args[0] = arg_0;
+        num_args = 1;
+    }
+
+    TraceZone::TraceZone(const char* name_, const char* arg_name_0, const long long arg_0, const char* arg_name_1, const long long arg_1) : TraceZone(name_)
+    {
+        arg_names[0] = arg_name_0;
+        args[0] = arg_0;
+        arg_names[1] = arg_name_1;
+        args[1] = arg_1;
+        num_args = 2;
+    }
+
+    TraceZone::~TraceZone()
+    {
+        // Zones started before Stop are dropped
+        if (active && Tracer::GetInstance().IsRunning())
+        {
+            Tracer::GetInstance().Record('X', name, start, std::chrono::steady_clock::now(), nullptr, num_args, arg_names, args);
+        }
+    }
+
+
+    TraceAsyncZone::TraceAsyncZone(const char* name_, const void* id_)
+    {
+        name = name_;
+        id = id_;
+        active = Tracer::GetInstance().IsRunning();
+        if (active)
+        {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            Tracer::GetInstance().Record('b', name, now, now, id);
+        }
+    }
+
+    TraceAsyncZone::~TraceAsyncZone()
+    {
+        if (active && Tracer::GetInstance().IsRunning())
+        {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            Tracer::GetInstance().Record('e', name, now, now, id);
+        }
+    }
+#endif
+} // Botcraft
@@ -0,0 +1,72 @@
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+#include "botcraft/Utilities/VirtualClock.hpp"
+
+namespace Botcraft
+{
+    namespace
+    {
+        /// @brief Affine mapping between real and virtual time, set at each speed change
+        struct ClockState
+        {
+            std::chrono::steady_clock::time_point real_origin;
+            VirtualClock::time_point virtual_origin;
+            double speed;
+        };
+
+        // States are never deleted, so now() can read them without locking.
+        // nullptr means the virtual clock is the real one
+        std::atomic<const ClockState*> clock_state{ nullptr };
+        std::mutex clock_state_mutex;
+    }
+
+    VirtualClock::time_point VirtualClock::now() noexcept
+    {
+        const std::chrono::steady_clock::time_point real_now = std::chrono::steady_clock::now();
+        const ClockState* state = clock_state.load(std::memory_order_acquire);
+        if (state == nullptr)
+        {
+            return time_point(real_now.time_since_epoch());
+        }
+        return state->virtual_origin + std::chrono::duration_cast<duration>((real_now - state->real_origin) * state->speed);
+    }
+
+    void VirtualClock::SetSpeed(const double speed)
+    {
+        if (!(speed > 0.0))
+        {
+            throw std::invalid_argument("VirtualClock speed must be positive");
+        }
+
+        std::lock_guard<std::mutex> lock(clock_state_mutex);
+        const ClockState* previous = clock_state.load(std::memory_order_acquire);
+        if (previous == nullptr && speed == 1.0)
+        {
+            return;
+        }
+        ClockState* state = new ClockState();
+        state->real_origin = std::chrono::steady_clock::now();
+        state->virtual_origin = previous == nullptr ? time_point(state->real_origin.time_since_epoch()) :
+            previous->virtual_origin + std::chrono::duration_cast<duration>((state->real_origin - previous->real_origin) * previous->speed);
+        state->speed = speed;
+        clock_state.store(state, std::memory_order_release);
+    }
+
+    double VirtualClock::GetSpeed()
+    {
+        const ClockState* state = clock_state.load(std::memory_order_acquire);
+        return state == nullptr ? 1.0 : state->speed;
+    }
+
+    std::chrono::steady_clock::time_point VirtualClock::ToSteady(const time_point& t)
+    {
+        const ClockState* state = clock_state.load(std::memory_order_acquire);
+        if (state == nullptr)
+        {
+            return std::chrono::steady_clock::time_point(t.time_since_epoch());
+        }
+        return state->real_origin + std::chrono::duration_cast<std::chrono::steady_clock::duration>((t - state->virtual_origin) / state->speed);
+    }
+} // Botcraft
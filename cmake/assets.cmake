@@ -1,17 +1,99 @@
-# Check if the minecraft assets folder already exists for the current version
-# If not, download the client and extract the assets
-if(NOT EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft")
+# Downloaded client assets are stored in a cache shared by all the build folders,
+# indexed by the sha1 of the client jar, so each version is only downloaded once
+if(DEFINED ENV{BOTCRAFT_ASSETS_CACHE})
+    set(BOTCRAFT_ASSETS_CACHE_DIR "$ENV{BOTCRAFT_ASSETS_CACHE}" CACHE PATH "Folder where the minecraft assets of each version are extracted, can be shared between source trees")
+else()
+    set(BOTCRAFT_ASSETS_CACHE_DIR "${CMAKE_CURRENT_SOURCE_DIR}/Assets/.cache" CACHE PATH "Folder where the minecraft assets of each version are extracted, can be shared between source trees")
+endif()
+option(BOTCRAFT_LINK_ASSETS "Symlink the minecraft assets in the output folder instead of copying them" OFF)
+
+# Minecraft assets already in the source tree (manually added or extracted by a previous version of this script)
+if(EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft")
+    set(MINECRAFT_ASSETS_DIR "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft")
+else()
     list(GET ClientURLs "${game_version_index}" VERSION_CLIENTURL)
-    message(STATUS "Downloading assets for version " ${GAME_VERSION} " from " ${VERSION_CLIENTURL} "...")
-    file(DOWNLOAD "${VERSION_CLIENTURL}" "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/client.jar")
-    message(STATUS "Extracting assets...")
-    file(MAKE_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/temp/")
-    execute_process(COMMAND "cmake" "-E" "tar" "xfz" "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/client.jar" WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/temp/")
-    file(COPY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/temp/assets/minecraft/" DESTINATION "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/")
-    message(STATUS "Removing temp folder")
-    file(REMOVE_RECURSE "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/temp")
+    string(REGEX MATCH "objects/([0-9a-f]+)/" client_sha1_match "${VERSION_CLIENTURL}")
+    set(CLIENT_SHA1 "${CMAKE_MATCH_1}")
+    set(MINECRAFT_ASSETS_DIR "${BOTCRAFT_ASSETS_CACHE_DIR}/${CLIENT_SHA1}/minecraft")
+
+    # If not, download the client and extract only the files used by botcraft.
+    # Textures are only extracted for GUI builds, so a cache first filled by
+    # a build without GUI is extracted again when they are needed
+    set(extract_assets OFF)
+    if(NOT EXISTS "${MINECRAFT_ASSETS_DIR}")
+        set(extract_assets ON)
+    elseif(BOTCRAFT_USE_OPENGL_GUI AND NOT EXISTS "${MINECRAFT_ASSETS_DIR}/textures/block" AND NOT EXISTS "${MINECRAFT_ASSETS_DIR}/textures/blocks")
+        set(extract_assets ON)
+    endif()
+
+    if(extract_assets)
+        set(temp_assets_dir "${BOTCRAFT_ASSETS_CACHE_DIR}/${CLIENT_SHA1}.tmp")
+        file(REMOVE_RECURSE "${temp_assets_dir}")
+        file(MAKE_DIRECTORY "${temp_assets_dir}")
+
+        message(STATUS "Downloading assets for version " ${GAME_VERSION} " from " ${VERSION_CLIENTURL} "...")
+        file(DOWNLOAD "${VERSION_CLIENTURL}" "${temp_assets_dir}/client.jar" EXPECTED_HASH SHA1=${CLIENT_SHA1} STATUS download_status)
+        list(GET download_status 0 download_status_code)
+        if(NOT download_status_code EQUAL 0)
+            list(GET download_status 1 download_status_message)
+            file(REMOVE_RECURSE "${temp_assets_dir}")
+            message(FATAL_ERROR "Error downloading assets for version " ${GAME_VERSION} ": " ${download_status_message})
+        endif()
+
+        message(STATUS "Extracting assets...")
+        set(needed_folders
+            assets/minecraft/blockstates
+            assets/minecraft/models/block
+        )
+        if(BOTCRAFT_USE_OPENGL_GUI)
+            # Before 1.13 the block textures folder is "blocks"
+            list(APPEND needed_folders
+                assets/minecraft/textures/block
+                assets/minecraft/textures/blocks
+                assets/minecraft/textures/entity
+            )
+        endif()
+        # Extraction fails if a folder is not in the archive
+        execute_process(COMMAND "${CMAKE_COMMAND}" "-E" "tar" "tf" "${temp_assets_dir}/client.jar" OUTPUT_VARIABLE client_content)
+        set(extracted_folders "")
+        foreach(folder IN LISTS needed_folders)
+            string(FIND "${client_content}" "${folder}/" folder_position)
+            if(NOT folder_position EQUAL -1)
+                list(APPEND extracted_folders "${folder}")
+            endif()
+        endforeach()
+        execute_process(COMMAND "${CMAKE_COMMAND}" "-E" "tar" "xf" "${temp_assets_dir}/client.jar" ${extracted_folders} WORKING_DIRECTORY "${temp_assets_dir}" RESULT_VARIABLE extract_result)
+        if(NOT extract_result EQUAL 0 OR NOT EXISTS "${temp_assets_dir}/assets/minecraft/blockstates")
+            file(REMOVE_RECURSE "${temp_assets_dir}")
+            message(FATAL_ERROR "Error extracting assets for version " ${GAME_VERSION})
+        endif()
+
+        # Rename at the end so an interrupted extraction is never used
+        file(REMOVE_RECURSE "${MINECRAFT_ASSETS_DIR}")
+        file(MAKE_DIRECTORY "${BOTCRAFT_ASSETS_CACHE_DIR}/${CLIENT_SHA1}")
+        file(RENAME "${temp_assets_dir}/assets/minecraft" "${MINECRAFT_ASSETS_DIR}")
+        message(STATUS "Removing temp folder")
+        file(REMOVE_RECURSE "${temp_assets_dir}")
+    endif()
 endif()
 
+# Copy (or link) a folder of minecraft assets to the output assets folder
+function(botcraft_install_minecraft_assets source destination)
+    if(EXISTS "${destination}")
+        return()
+    endif()
+    get_filename_component(destination_parent "${destination}" DIRECTORY)
+    if(BOTCRAFT_LINK_ASSETS AND NOT CMAKE_VERSION VERSION_LESS 3.14)
+        file(MAKE_DIRECTORY "${destination_parent}")
+        file(CREATE_LINK "${source}" "${destination}" RESULT link_result SYMBOLIC)
+        if(link_result EQUAL 0)
+            return()
+        endif()
+        message(STATUS "Can't create a link to ${source} (${link_result}), copying it instead")
+    endif()
+    file(COPY "${source}" DESTINATION "${destination_parent}")
+endfunction()
+
 # If assets folder doesn't exist, create it and copy all relevant files (custom and minecraft) to it
 if(NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}")
     message(STATUS "Asset folder not found, creating it...")
@@ -40,30 +122,30 @@ endif()
 # Blockstates
 if(NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/blockstates")
     message(STATUS "Copying minecraft blockstates...")
-    file(COPY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/blockstates" DESTINATION "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/")
+    botcraft_install_minecraft_assets("${MINECRAFT_ASSETS_DIR}/blockstates" "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/blockstates")
 endif()
 
 # Block models
 if(NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/models/block")
     message(STATUS "Copying minecraft block models...")
-    file(COPY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/models/block" DESTINATION "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/models")
+    botcraft_install_minecraft_assets("${MINECRAFT_ASSETS_DIR}/models/block" "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/models/block")
 endif()
 
 # Textures
 if(BOTCRAFT_USE_OPENGL_GUI)
     # Blocks
-    if(EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/textures/blocks" AND NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/blocks")
+    if(EXISTS "${MINECRAFT_ASSETS_DIR}/textures/blocks" AND NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/blocks")
         message(STATUS "Copying minecraft block textures...")
-        file(COPY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/textures/blocks" DESTINATION "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures")
-    elseif(EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/textures/block" AND NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/block")
+        botcraft_install_minecraft_assets("${MINECRAFT_ASSETS_DIR}/textures/blocks" "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/blocks")
+    elseif(EXISTS "${MINECRAFT_ASSETS_DIR}/textures/block" AND NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/block")
         message(STATUS "Copying minecraft block textures...")
-        file(COPY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/textures/block" DESTINATION "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures")
+        botcraft_install_minecraft_assets("${MINECRAFT_ASSETS_DIR}/textures/block" "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/block")
     endif()
     
     # Entities
-    if(EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/textures/entity" AND NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/entity")
+    if(EXISTS "${MINECRAFT_ASSETS_DIR}/textures/entity" AND NOT EXISTS "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/entity")
         message(STATUS "Copying minecraft entity textures...")
-        file(COPY "${CMAKE_CURRENT_SOURCE_DIR}/Assets/${GAME_VERSION}/minecraft/textures/entity" DESTINATION "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures")
+        botcraft_install_minecraft_assets("${MINECRAFT_ASSETS_DIR}/textures/entity" "${BOTCRAFT_OUTPUT_DIR}/bin/Assets/${GAME_VERSION}/minecraft/textures/entity")
     endif()
 
 endif()
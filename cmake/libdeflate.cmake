@@ -0,0 +1,24 @@
+#Add libdeflate library
+
+# libdeflate >= 1.15 provides a CMake config file
+find_package(libdeflate CONFIG QUIET)
+
+if(TARGET libdeflate::libdeflate_static AND NOT TARGET libdeflate::libdeflate_shared)
+    add_library(libdeflate INTERFACE)
+    target_link_libraries(libdeflate INTERFACE libdeflate::libdeflate_static)
+elseif(TARGET libdeflate::libdeflate_shared)
+    add_library(libdeflate INTERFACE)
+    target_link_libraries(libdeflate INTERFACE libdeflate::libdeflate_shared)
+else()
+    # Older versions, look for the header and the library directly
+    find_path(LIBDEFLATE_INCLUDE_DIR libdeflate.h)
+    find_library(LIBDEFLATE_LIBRARY NAMES deflate libdeflate)
+
+    if(NOT LIBDEFLATE_INCLUDE_DIR OR NOT LIBDEFLATE_LIBRARY)
+        message(FATAL_ERROR "BOTCRAFT_USE_LIBDEFLATE is set but libdeflate can't be found. Install it or set LIBDEFLATE_INCLUDE_DIR and LIBDEFLATE_LIBRARY")
+    endif()
+
+    add_library(libdeflate INTERFACE)
+    target_include_directories(libdeflate INTERFACE "${LIBDEFLATE_INCLUDE_DIR}")
+    target_link_libraries(libdeflate INTERFACE "${LIBDEFLATE_LIBRARY}")
+endif()
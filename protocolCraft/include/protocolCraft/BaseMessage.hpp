@@ -15,6 +15,13 @@ namespace ProtocolCraft
         {
             return std::shared_ptr<TDerived>(new TDerived(static_cast<const TDerived&>(*this)));
         }
+        // Default implementation, assigning a new instance frees the
+        // buffers. Messages with containers override it to clear them
+        // in place and read into them so their capacity is kept
+        virtual void Reset() override
+        {
+            static_cast<TDerived&>(*this) = TDerived();
+        }
     protected:
         virtual void DispatchImpl(Handler* handler) override;
     };
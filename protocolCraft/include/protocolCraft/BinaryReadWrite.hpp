@@ -6,10 +6,24 @@
 #include <cstring>
 #include <algorithm>
 #include <stdexcept>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#define PROTOCOLCRAFT_BSWAP16(x) _byteswap_ushort(x)
+#define PROTOCOLCRAFT_BSWAP32(x) _byteswap_ulong(x)
+#define PROTOCOLCRAFT_BSWAP64(x) _byteswap_uint64(x)
+#else
+#define PROTOCOLCRAFT_BSWAP16(x) __builtin_bswap16(x)
+#define PROTOCOLCRAFT_BSWAP32(x) __builtin_bswap32(x)
+#define PROTOCOLCRAFT_BSWAP64(x) __builtin_bswap64(x)
+#endif
 
 namespace ProtocolCraft
 {
-    using ReadIterator = std::vector<unsigned char>::const_iterator;
+    // Raw pointer so data can be read from any contiguous buffer,
+    // not only from a std::vector
+    using ReadIterator = const unsigned char*;
     using WriteContainer = std::vector<unsigned char>;
 
     using Angle = unsigned char;
@@ -33,17 +47,57 @@ namespace ProtocolCraft
     void WriteRawString(const std::string &s, WriteContainer &container);
 
     std::vector<unsigned char> ReadByteArray(ReadIterator &iter, size_t &length, const size_t &desired_length);
+    // Same as above, but read into output, reusing its capacity
+    // so a reused message doesn't allocate for each packet
+    void ReadByteArray(ReadIterator &iter, size_t &length, const size_t &desired_length, std::vector<unsigned char> &output);
     void WriteByteArray(const std::vector<unsigned char> &my_array, WriteContainer &container);
 
+    // Reverse the order of N bytes from in to out
+    template <size_t N>
+    inline void SwapBytes(const unsigned char* in, unsigned char* out)
+    {
+        std::reverse_copy(in, in + N, out);
+    }
+
+    template <>
+    inline void SwapBytes<1>(const unsigned char* in, unsigned char* out)
+    {
+        out[0] = in[0];
+    }
+
+    template <>
+    inline void SwapBytes<2>(const unsigned char* in, unsigned char* out)
+    {
+        uint16_t v;
+        memcpy(&v, in, 2);
+        v = PROTOCOLCRAFT_BSWAP16(v);
+        memcpy(out, &v, 2);
+    }
+
+    template <>
+    inline void SwapBytes<4>(const unsigned char* in, unsigned char* out)
+    {
+        uint32_t v;
+        memcpy(&v, in, 4);
+        v = PROTOCOLCRAFT_BSWAP32(v);
+        memcpy(out, &v, 4);
+    }
+
+    template <>
+    inline void SwapBytes<8>(const unsigned char* in, unsigned char* out)
+    {
+        uint64_t v;
+        memcpy(&v, in, 8);
+        v = PROTOCOLCRAFT_BSWAP64(v);
+        memcpy(out, &v, 8);
+    }
+
     template <typename T>
     T ChangeEndianness(const T& in)
     {
-        T in_cpy = in;
-        std::vector<char> p(sizeof(T));
-        memcpy(&p[0], &in_cpy, sizeof(T));
-        std::reverse(p.begin(), p.end());
-        memcpy(&in_cpy, &p[0], sizeof(T));
-        return in_cpy;
+        T output;
+        SwapBytes<sizeof(T)>(reinterpret_cast<const unsigned char*>(&in), reinterpret_cast<unsigned char*>(&output));
+        return output;
     }
 
     template<typename T>
@@ -56,7 +110,7 @@ namespace ProtocolCraft
         else
         {
             T output;
-            memcpy(&output, &(*iter), sizeof(T));
+            memcpy(&output, iter, sizeof(T));
             length -= sizeof(T);
             iter += sizeof(T);
 
@@ -97,7 +151,8 @@ namespace ProtocolCraft
     template<typename T>
     void WriteData(const T& value, WriteContainer& container)
     {
-        std::vector<unsigned char> output(sizeof(T));
+        const size_t start = container.size();
+        container.resize(start + sizeof(T));
 
         // Don't need to change endianess of char!
         if (sizeof(T) > 1)
@@ -110,16 +165,13 @@ namespace ProtocolCraft
             if (*(char*)&num == 1)
             {
                 // Little endian
-                T big_endian_var = ChangeEndianness(value);
-                memcpy(output.data(), &big_endian_var, sizeof(T));
-                container.insert(container.end(), output.begin(), output.end());
+                SwapBytes<sizeof(T)>(reinterpret_cast<const unsigned char*>(&value), container.data() + start);
                 return;
             }
         }
 
         // Big endian or sizeof(T) == 1
-        memcpy(output.data(), &value, sizeof(T));
-        container.insert(container.end(), output.begin(), output.end());
+        memcpy(container.data() + start, &value, sizeof(T));
     }
 
     template<>
@@ -137,8 +189,10 @@ namespace ProtocolCraft
     void WriteData(const UUID& value, WriteContainer& container);
 
 
+    // Read size values into output, reusing its capacity
+    // so a reused message doesn't allocate for each packet
     template<typename T>
-    std::vector<T> ReadArrayData(ReadIterator &iter, size_t &length, const size_t size)
+    void ReadArrayData(ReadIterator &iter, size_t &length, const size_t size, std::vector<T> &output)
     {
         if (length < size * sizeof(T))
         {
@@ -146,8 +200,8 @@ namespace ProtocolCraft
         }
         else
         {
-            std::vector<T> output(size);
-            memcpy(output.data(), &(*iter), size * sizeof(T));
+            output.resize(size);
+            memcpy(output.data(), iter, size * sizeof(T));
             length -= size * sizeof(T);
             iter += size * sizeof(T);
 
@@ -167,14 +221,22 @@ namespace ProtocolCraft
                     }
                 }
             }
-            return output;
         }
     }
 
+    template<typename T>
+    std::vector<T> ReadArrayData(ReadIterator &iter, size_t &length, const size_t size)
+    {
+        std::vector<T> output;
+        ReadArrayData(iter, length, size, output);
+        return output;
+    }
+
     template<typename T>
     void WriteArrayData(const std::vector<T> &values, WriteContainer &container)
     {
-        std::vector<unsigned char> bytes(sizeof(T));
+        const size_t start = container.size();
+        container.resize(start + values.size() * sizeof(T));
 
         // The compiler should(?) optimize that
         // This check doesn't work if int and char
@@ -182,23 +244,20 @@ namespace ProtocolCraft
         // the only thing that souldn't work in this case
         const int num = 1;
 
-        for (int i = 0; i < values.size(); ++i)
+        if (sizeof(T) > 1 && *(char*)&num == 1)
         {
-            if (sizeof(T) > 1)
+            // Little endian
+            for (size_t i = 0; i < values.size(); ++i)
             {
-                if (*(char*)&num == 1)
-                {
-                    // Little endian
-                    T big_endian_var = ChangeEndianness(values[i]);
-                    memcpy(bytes.data(), &big_endian_var, sizeof(T));
-                    container.insert(container.end(), bytes.begin(), bytes.end());
-                    continue;
-                }
+                SwapBytes<sizeof(T)>(reinterpret_cast<const unsigned char*>(&values[i]), container.data() + start + i * sizeof(T));
             }
+            return;
+        }
 
-            // Big endian or sizeof(T) == 1
-            memcpy(bytes.data(), &values[i], sizeof(T));
-            container.insert(container.end(), bytes.begin(), bytes.end());
+        // Big endian or sizeof(T) == 1
+        if (!values.empty())
+        {
+            memcpy(container.data() + start, values.data(), values.size() * sizeof(T));
         }
     }
 } // Botcraft
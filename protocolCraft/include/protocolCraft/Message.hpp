@@ -9,7 +9,7 @@ namespace ProtocolCraft
 {
     class Handler;
 
-    class Message : public NetworkType
+    class Message : public NetworkType, public std::enable_shared_from_this<Message>
     {
     public:
         virtual ~Message()
@@ -34,6 +34,10 @@ namespace ProtocolCraft
 
         virtual const std::shared_ptr<Message> Clone() const = 0;
 
+        // Set the message back to its default state, so
+        // the same instance can be reused to read another packet
+        virtual void Reset() = 0;
+
     protected:
         virtual void DispatchImpl(Handler *handler) = 0;
     };
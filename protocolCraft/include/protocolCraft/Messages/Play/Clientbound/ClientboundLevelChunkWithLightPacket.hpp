@@ -31,6 +31,14 @@ namespace ProtocolCraft
         virtual ~ClientboundLevelChunkWithLightPacket() override
         {
 
+        }
+
+        // All the fields are overwritten by ReadImpl, keep
+        // them as they are so a pooled instance reuses its
+        // buffers instead of allocating new ones for each packet
+        virtual void Reset() override
+        {
+
         }
         
         void SetX(const int x_)
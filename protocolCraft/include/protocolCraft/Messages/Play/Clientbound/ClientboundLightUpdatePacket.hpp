@@ -42,6 +42,14 @@ namespace ProtocolCraft
 
         }
 
+        // All the fields are overwritten by ReadImpl, keep
+        // them as they are so a pooled instance reuses its
+        // buffers instead of allocating new ones for each packet
+        virtual void Reset() override
+        {
+
+        }
+
         void SetX(const int x_)
         {
             x = x_;
@@ -212,25 +220,25 @@ namespace ProtocolCraft
             empty_block_Y_mask = ReadData<VarInt>(iter, length);
 #else
             const int sky_Y_mask_size = ReadData<VarInt>(iter, length);
-            sky_Y_mask = std::vector<unsigned long long int>(sky_Y_mask_size);
+            sky_Y_mask.resize(sky_Y_mask_size);
             for (int i = 0; i < sky_Y_mask_size; ++i)
             {
                 sky_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
             }
             const int block_Y_mask_size = ReadData<VarInt>(iter, length);
-            block_Y_mask = std::vector<unsigned long long int>(block_Y_mask_size);
+            block_Y_mask.resize(block_Y_mask_size);
             for (int i = 0; i < block_Y_mask_size; ++i)
             {
                 block_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
             }
             const int empty_sky_Y_mask_size = ReadData<VarInt>(iter, length);
-            empty_sky_Y_mask = std::vector<unsigned long long int>(empty_sky_Y_mask_size);
+            empty_sky_Y_mask.resize(empty_sky_Y_mask_size);
             for (int i = 0; i < empty_sky_Y_mask_size; ++i)
             {
                 empty_sky_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
             }
             const int empty_block_Y_mask_size = ReadData<VarInt>(iter, length);
-            empty_block_Y_mask = std::vector<unsigned long long int>(empty_block_Y_mask_size);
+            empty_block_Y_mask.resize(empty_block_Y_mask_size);
             for (int i = 0; i < empty_block_Y_mask_size; ++i)
             {
                 empty_block_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
@@ -259,19 +267,19 @@ namespace ProtocolCraft
             }
 #else
             const int sky_updates_size = ReadData<VarInt>(iter, length);
-            sky_updates = std::vector<std::vector<char> >(sky_updates_size);
+            sky_updates.resize(sky_updates_size);
             for (int i = 0; i < sky_updates_size; ++i)
             {
                 const int array_length = ReadData<VarInt>(iter, length); // Should be 2048
-                sky_updates[i] = ReadArrayData<char>(iter, length, 2048);
+                ReadArrayData<char>(iter, length, 2048, sky_updates[i]);
             }
 
             const int block_updates_size = ReadData<VarInt>(iter, length);
-            block_updates = std::vector<std::vector<char> >(block_updates_size);
+            block_updates.resize(block_updates_size);
             for (int i = 0; i < block_updates_size; ++i)
             {
                 const int array_length = ReadData<VarInt>(iter, length); // Should be 2048
-                block_updates[i] = ReadArrayData<char>(iter, length, 2048);
+                ReadArrayData<char>(iter, length, 2048, block_updates[i]);
             }
 #endif
 #else
@@ -46,6 +46,23 @@ namespace ProtocolCraft
 
         }
 
+        // Clear the containers in place so a pooled
+        // instance keeps their capacity for the next packet
+        virtual void Reset() override
+        {
+#if PROTOCOL_VERSION < 739
+            chunk_x = 0;
+            chunk_z = 0;
+            record_count = 0;
+            records.clear();
+#else
+            section_pos = 0;
+            suppress_light_updates = false;
+            positions.clear();
+            states.clear();
+#endif
+        }
+
 #if PROTOCOL_VERSION < 739
         void SetChunkX(const int chunk_x_)
         {
@@ -138,7 +155,7 @@ namespace ProtocolCraft
             chunk_z = ReadData<int>(iter, length);
             record_count = ReadData<VarInt>(iter, length);
 
-            records = std::vector<Record>(record_count);
+            records.resize(record_count);
 
             for (int i = 0; i < record_count; ++i)
             {
@@ -148,8 +165,8 @@ namespace ProtocolCraft
             section_pos = ReadData<long long int>(iter, length);
             suppress_light_updates = ReadData<bool>(iter, length);
             int data_size = ReadData<VarInt>(iter, length);
-            positions = std::vector<short>(data_size);
-            states = std::vector<int>(data_size);
+            positions.resize(data_size);
+            states.resize(data_size);
             for (int i = 0; i < data_size; ++i)
             {
                 long long int data = ReadData<VarLong>(iter, length);
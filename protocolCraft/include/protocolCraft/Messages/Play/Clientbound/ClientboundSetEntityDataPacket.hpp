@@ -42,6 +42,14 @@ namespace ProtocolCraft
 
         }
 
+        // All the fields are overwritten by ReadImpl, keep
+        // them as they are so a pooled instance reuses its
+        // buffers instead of allocating new ones for each packet
+        virtual void Reset() override
+        {
+
+        }
+
         void SetId_(const int id__)
         {
             id_ = id__;
@@ -68,7 +76,7 @@ namespace ProtocolCraft
         virtual void ReadImpl(ReadIterator& iter, size_t& length) override
         {
             id_ = ReadData<VarInt>(iter, length);
-            packed_items = ReadByteArray(iter, length, length);
+            ReadByteArray(iter, length, length, packed_items);
         }
 
         virtual void WriteImpl(WriteContainer& container) const override
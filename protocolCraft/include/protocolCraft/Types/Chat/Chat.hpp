@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <memory>
 
 #include "protocolCraft/NetworkType.hpp"
 
@@ -17,12 +18,17 @@ namespace ProtocolCraft
         void SetRawText(const std::string& s)
         {
             raw_text = s;
+            text.reset();
+            json.reset();
         }
 
-        const std::string& GetText() const
-        {
-            return text;
-        }
+        /// @brief Get the plain text of this component. Extracted
+        /// from the raw JSON on first call, without building a DOM
+        const std::string& GetText() const;
+
+        /// @brief Get the parsed JSON of this component, parsed on first call.
+        /// Discarded value (is_discarded() is true) if the JSON is malformed
+        const nlohmann::json& GetJson() const;
 
         const std::string& GetRawText() const
         {
@@ -33,8 +39,8 @@ namespace ProtocolCraft
         virtual void ReadImpl(ReadIterator &iter, size_t &length) override
         {
             raw_text = ReadData<std::string>(iter, length);
-            
-            text = ParseChat(nlohmann::json::parse(raw_text));
+            text.reset();
+            json.reset();
         }
 
         virtual void WriteImpl(WriteContainer &container) const override
@@ -42,8 +48,6 @@ namespace ProtocolCraft
             WriteData<std::string>(raw_text, container);
         }
 
-        const std::string ParseChat(const nlohmann::json& raw_json);
-
         virtual const nlohmann::json SerializeImpl() const override
         {
             nlohmann::json output;
@@ -54,7 +58,10 @@ namespace ProtocolCraft
         }
 
     private:
-        std::string text;
         std::string raw_text;
+        // Lazily computed from raw_text, set atomically as
+        // the same message can be read from multiple threads
+        mutable std::shared_ptr<const std::string> text;
+        mutable std::shared_ptr<const nlohmann::json> json;
     };
 }
\ No newline at end of file
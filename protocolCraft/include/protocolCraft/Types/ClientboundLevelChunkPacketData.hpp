@@ -52,10 +52,11 @@ namespace ProtocolCraft
             heightmaps.Read(iter, length);
 
             const int buffer_size = ReadData<VarInt>(iter, length);
-            buffer = ReadByteArray(iter, length, buffer_size);
+            // Read in place to keep the capacity of a reused instance
+            ReadByteArray(iter, length, buffer_size, buffer);
 
             const int num_block_entities_data = ReadData<VarInt>(iter, length);
-            block_entities_data = std::vector<BlockEntityInfo>(num_block_entities_data);
+            block_entities_data.resize(num_block_entities_data);
             for (int i = 0; i < num_block_entities_data; ++i)
             {
                 block_entities_data[i].Read(iter, length);
@@ -88,46 +88,48 @@ namespace ProtocolCraft
         virtual void ReadImpl(ReadIterator &iter, size_t &length) override
         {
             trust_edges = ReadData<bool>(iter, length);
-            
+
+            // Vectors are resized and not recreated to keep
+            // the capacity of a reused instance
             const int sky_Y_mask_size = ReadData<VarInt>(iter, length);
-            sky_Y_mask = std::vector<unsigned long long int>(sky_Y_mask_size);
+            sky_Y_mask.resize(sky_Y_mask_size);
             for (int i = 0; i < sky_Y_mask_size; ++i)
             {
                 sky_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
             }
             const int block_Y_mask_size = ReadData<VarInt>(iter, length);
-            block_Y_mask = std::vector<unsigned long long int>(block_Y_mask_size);
+            block_Y_mask.resize(block_Y_mask_size);
             for (int i = 0; i < block_Y_mask_size; ++i)
             {
                 block_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
             }
             const int empty_sky_Y_mask_size = ReadData<VarInt>(iter, length);
-            empty_sky_Y_mask = std::vector<unsigned long long int>(empty_sky_Y_mask_size);
+            empty_sky_Y_mask.resize(empty_sky_Y_mask_size);
             for (int i = 0; i < empty_sky_Y_mask_size; ++i)
             {
                 empty_sky_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
             }
             const int empty_block_Y_mask_size = ReadData<VarInt>(iter, length);
-            empty_block_Y_mask = std::vector<unsigned long long int>(empty_block_Y_mask_size);
+            empty_block_Y_mask.resize(empty_block_Y_mask_size);
             for (int i = 0; i < empty_block_Y_mask_size; ++i)
             {
                 empty_block_Y_mask[i] = ReadData<unsigned long long int>(iter, length);
             }
 
             const int sky_updates_size = ReadData<VarInt>(iter, length);
-            sky_updates = std::vector<std::vector<char> >(sky_updates_size);
+            sky_updates.resize(sky_updates_size);
             for (int i = 0; i < sky_updates_size; ++i)
             {
                 const int array_length = ReadData<VarInt>(iter, length); // Should be 2048
-                sky_updates[i] = ReadArrayData<char>(iter, length, 2048);
+                ReadArrayData<char>(iter, length, 2048, sky_updates[i]);
             }
 
             const int block_updates_size = ReadData<VarInt>(iter, length);
-            block_updates = std::vector<std::vector<char> >(block_updates_size);
+            block_updates.resize(block_updates_size);
             for (int i = 0; i < block_updates_size; ++i)
             {
                 const int array_length = ReadData<VarInt>(iter, length); // Should be 2048
-                block_updates[i] = ReadArrayData<char>(iter, length, 2048);
+                ReadArrayData<char>(iter, length, 2048, block_updates[i]);
             }
         }
 
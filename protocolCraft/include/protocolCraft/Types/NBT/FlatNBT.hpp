@@ -0,0 +1,166 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "protocolCraft/BinaryReadWrite.hpp"
+#include "protocolCraft/Types/NBT/Tag.hpp"
+
+namespace ProtocolCraft
+{
+    class FlatNBT;
+
+    /// @brief A lightweight handle on a tag stored in a FlatNBT.
+    /// Only valid as long as the FlatNBT is alive and not modified.
+    /// Getters throw if called on a tag of the wrong type.
+    class FlatTag
+    {
+    public:
+        class const_iterator
+        {
+        public:
+            const_iterator(const FlatNBT* nbt_, const size_t index_);
+
+            const FlatTag operator*() const;
+            const_iterator& operator++();
+            const bool operator!=(const const_iterator& other) const;
+
+        private:
+            const FlatNBT* nbt;
+            size_t index;
+        };
+
+        /// @brief Create an invalid tag
+        FlatTag();
+        FlatTag(const FlatNBT* nbt_, const size_t index_);
+
+        /// @brief False for tags returned by failed lookups
+        const bool IsValid() const;
+        const TagType GetType() const;
+
+        /// @brief Get the name of the tag, empty for list elements
+        const std::string GetName() const;
+        /// @brief Compare the name of the tag without any allocation
+        const bool NameEquals(const std::string& s) const;
+
+        /// @brief Number of children for compounds and lists,
+        /// number of elements for arrays, number of bytes for strings
+        const size_t Size() const;
+
+        /// @brief Get a child of a compound by name
+        /// @param name Name of the child
+        /// @return The child, an invalid tag if not found or not a compound
+        const FlatTag GetChild(const std::string& name) const;
+
+        /// @brief Get the i-th child of a compound or list
+        /// @param i Index of the child
+        /// @return The child, an invalid tag if out of bounds
+        const FlatTag GetElement(const size_t i) const;
+
+        /// @brief Type of the elements of a list
+        const TagType GetElementsType() const;
+
+        /// @brief Iterate over the children of compounds and lists
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        const char GetByte() const;
+        const short GetShort() const;
+        const int GetInt() const;
+        const long long int GetLong() const;
+        const float GetFloat() const;
+        const double GetDouble() const;
+        /// @brief Get the value of any integer tag (Byte, Short, Int or Long)
+        const long long int GetIntegral() const;
+        const std::string GetString() const;
+        const std::vector<char> GetByteArray() const;
+        const std::vector<int> GetIntArray() const;
+        const std::vector<long long int> GetLongArray() const;
+
+        /// @brief Create a standalone Tag tree from this tag. Allocates
+        /// one Tag per node, prefer the getters when possible
+        /// @return A Tag with the same content
+        std::shared_ptr<Tag> ToTag() const;
+
+    private:
+        /// @brief Get a pointer to the payload of this tag in the raw data, throws if type is not t
+        const unsigned char* GetPayload(const TagType t) const;
+
+    private:
+        const FlatNBT* nbt;
+        size_t index;
+    };
+
+    /// @brief NBT data parsed in a single arena: a copy of the raw
+    /// bytes and a flat array of all the tags in depth first order.
+    /// Each tag stores offsets in the raw bytes for its name and payload,
+    /// and the index after its last descendant, so children are
+    /// always in a contiguous range after their parent.
+    /// The array is only built on first access, most NBT we receive
+    /// is never looked at.
+    class FlatNBT
+    {
+    public:
+        FlatNBT();
+        FlatNBT(const FlatNBT& other);
+        FlatNBT& operator=(const FlatNBT& other);
+
+        /// @brief Read a full NBT (root type, name and payload). Data is
+        /// only checked and copied, tags are indexed on first GetRoot
+        /// @param iterator Start of the data
+        /// @param length Remaining length of the data
+        void Read(ReadIterator& iterator, size_t& length);
+        /// @brief Move iterator after a full NBT, checking it but without storing anything
+        /// @param iterator Start of the data
+        /// @param length Remaining length of the data
+        static void Skip(ReadIterator& iterator, size_t& length);
+        void Clear();
+
+        /// @brief False if the data was only a TAG_End
+        const bool HasData() const;
+        /// @brief Get the root compound, invalid if no data
+        const FlatTag GetRoot() const;
+        const std::string GetRootName() const;
+
+        /// @brief Get the raw bytes read, including root type and name
+        const std::vector<unsigned char>& GetRawData() const;
+
+        /// @brief Get an estimation of the memory used by this NBT, in bytes
+        const size_t GetMemoryUsage() const;
+
+    private:
+        friend class FlatTag;
+
+        struct Node
+        {
+            TagType type;
+            // Only used for lists
+            TagType elements_type;
+            unsigned short name_size;
+            unsigned int name_offset;
+            unsigned int payload_offset;
+            // Children, elements or string bytes
+            unsigned int size;
+            // Index after the last descendant of this node
+            unsigned int subtree_end;
+        };
+
+        /// @brief Check the payload of a tag and move iterator after it, without storing anything
+        static void SkipPayload(const TagType type, ReadIterator& iterator, size_t& length, const int depth);
+
+        /// @brief Build nodes from raw_data if not already done
+        void Index() const;
+
+        /// @brief Read the payload of nodes[node_index], adding all its descendants to nodes
+        void ReadPayload(const size_t node_index, ReadIterator& iterator, size_t& length) const;
+
+    private:
+        std::vector<unsigned char> raw_data;
+
+        mutable std::vector<Node> nodes;
+        mutable bool indexed;
+        mutable std::mutex index_mutex;
+    };
+} // ProtocolCraft
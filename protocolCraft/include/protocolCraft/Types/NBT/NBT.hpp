@@ -1,7 +1,10 @@
 #pragma once
 
+#include <mutex>
+
 #include "protocolCraft/NetworkType.hpp"
 #include "protocolCraft/Types/NBT/TagCompound.hpp"
+#include "protocolCraft/Types/NBT/FlatNBT.hpp"
 
 namespace ProtocolCraft
 {
@@ -10,12 +13,31 @@ namespace ProtocolCraft
     public:
         NBT();
         NBT(const NBT& nbt);
+        NBT& operator=(const NBT& nbt);
         virtual ~NBT() override;
 
+        /// @brief Get the root as a Tag tree. The tree is only
+        /// built on first call, prefer GetFlatRoot when possible
         const TagCompound& GetRoot() const;
         const std::shared_ptr<Tag> GetTag(const std::string &s) const;
         const bool HasData() const;
 
+        /// @brief Get the root tag, without building a Tag tree
+        /// @return The root compound, only valid while this NBT is alive and unchanged
+        const FlatTag GetFlatRoot() const;
+
+        /// @brief Get a child of the root tag, without building a Tag tree
+        /// @param s Name of the child
+        /// @return The child, invalid if not found. Only valid while this NBT is alive and unchanged
+        const FlatTag GetFlatTag(const std::string& s) const;
+
+        /// @brief Get an estimation of the memory used by this NBT, in bytes.
+        /// The Tag tree built by GetRoot is not counted
+        const size_t GetMemoryUsage() const;
+
+        /// @brief Get the NBT in its network form, including root type and name
+        const std::vector<unsigned char>& GetRawData() const;
+
         // TODO: add methods to deal with files // compression?
 
         virtual void ReadImpl(ReadIterator &iterator, size_t &length) override;
@@ -24,8 +46,12 @@ namespace ProtocolCraft
 
 
     private:
-        TagCompound root_tag;
-        std::string root_name;
-        bool has_data;
+        /// @brief All the data is read in this single arena
+        FlatNBT flat_nbt;
+
+        /// @brief Tag tree built from flat_nbt on first call to GetRoot/GetTag
+        mutable TagCompound root_tag;
+        mutable bool root_tag_built;
+        mutable std::mutex root_tag_mutex;
     };
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "protocolCraft/NetworkType.hpp"
 #include "protocolCraft/Types/NBT/NBT.hpp"
 
@@ -102,13 +104,19 @@ namespace ProtocolCraft
                 present = false;
                 item_id = -1;
 #endif
-                nbt = NBT();
+                nbt = nullptr;
             }
         }
 
         void SetNBT(const NBT& nbt_)
         {
-            nbt = nbt_;
+            nbt = nbt_.HasData() ? std::make_shared<const NBT>(nbt_) : nullptr;
+        }
+
+        /// @brief Set the NBT without copying it, it can be shared with other slots
+        void SetNBT(const std::shared_ptr<const NBT>& nbt_)
+        {
+            nbt = nbt_ != nullptr && nbt_->HasData() ? nbt_ : nullptr;
         }
 
 #if PROTOCOL_VERSION < 350
@@ -144,6 +152,14 @@ namespace ProtocolCraft
         }
 
         const NBT& GetNBT() const
+        {
+            static const NBT empty_nbt;
+            return nbt == nullptr ? empty_nbt : *nbt;
+        }
+
+        /// @brief Get the NBT data, shared by all the copies of this slot
+        /// @return The NBT, nullptr if there is none
+        const std::shared_ptr<const NBT>& GetSharedNBT() const
         {
             return nbt;
         }
@@ -178,7 +194,16 @@ namespace ProtocolCraft
             item_id = ReadData<VarInt>(iter, length);
             item_count = ReadData<char>(iter, length);
 #endif
-            nbt.Read(iter, length);
+            // Most items don't have any NBT, only a TAG_End
+            if (length > 0 && *iter == static_cast<unsigned char>(TagType::End))
+            {
+                ReadData<char>(iter, length);
+                nbt = nullptr;
+                return;
+            }
+            std::shared_ptr<NBT> read_nbt = std::make_shared<NBT>();
+            read_nbt->Read(iter, length);
+            nbt = read_nbt;
         }
 
         virtual void WriteImpl(WriteContainer& container) const override
@@ -207,7 +232,14 @@ namespace ProtocolCraft
             WriteData<VarInt>(item_id, container);
             WriteData<char>(item_count, container);
 #endif
-            nbt.Write(container);
+            if (nbt == nullptr)
+            {
+                WriteData<char>(static_cast<char>(TagType::End), container);
+            }
+            else
+            {
+                nbt->Write(container);
+            }
         }
 
         virtual const nlohmann::json SerializeImpl() const override
@@ -238,9 +270,9 @@ namespace ProtocolCraft
 #endif
             {
                 output["item_count"] = item_count;
-                if (nbt.HasData())
+                if (nbt != nullptr)
                 {
-                    output["nbt"] = nbt.Serialize();
+                    output["nbt"] = nbt->Serialize();
                 }
             }
             return output;
@@ -257,6 +289,8 @@ namespace ProtocolCraft
         short item_id;
 #endif
         char item_count;
-        NBT nbt;
+        // Slots are copied a lot, and NBT is never modified once read,
+        // so copies share it. nullptr if there is no NBT
+        std::shared_ptr<const NBT> nbt;
     };
 } // ProtocolCraft
\ No newline at end of file
@@ -27,6 +27,13 @@ namespace ProtocolCraft
     }
 
     std::vector<unsigned char> ReadByteArray(ReadIterator &iter, size_t &length, const size_t &desired_length)
+    {
+        std::vector<unsigned char> output;
+        ReadByteArray(iter, length, desired_length, output);
+        return output;
+    }
+
+    void ReadByteArray(ReadIterator &iter, size_t &length, const size_t &desired_length, std::vector<unsigned char> &output)
     {
         if (length < desired_length)
         {
@@ -34,13 +41,11 @@ namespace ProtocolCraft
         }
         else
         {
-            std::vector<unsigned char> output(desired_length);
-            std::copy(iter, iter + desired_length, output.begin());
+            // assign doesn't reallocate if the capacity is already big enough
+            output.assign(iter, iter + desired_length);
 
             iter += desired_length;
             length -= desired_length;
-
-            return output;
         }
     }
 
@@ -72,6 +77,42 @@ namespace ProtocolCraft
     template<>
     VarInt ReadData(ReadIterator& iter, size_t& length)
     {
+        // Fast path, we know we have enough data for any VarInt
+        // so we don't need to check the length for each byte
+        if (length >= 5)
+        {
+            const unsigned char* data = iter;
+            unsigned int result = data[0] & 0x7F;
+            size_t num_read = 1;
+            if (data[0] & 0x80)
+            {
+                result |= static_cast<unsigned int>(data[1] & 0x7F) << 7;
+                num_read = 2;
+                if (data[1] & 0x80)
+                {
+                    result |= static_cast<unsigned int>(data[2] & 0x7F) << 14;
+                    num_read = 3;
+                    if (data[2] & 0x80)
+                    {
+                        result |= static_cast<unsigned int>(data[3] & 0x7F) << 21;
+                        num_read = 4;
+                        if (data[3] & 0x80)
+                        {
+                            if (data[4] & 0x80)
+                            {
+                                throw(std::runtime_error("VarInt is too big in ReadData<VarInt>"));
+                            }
+                            result |= static_cast<unsigned int>(data[4]) << 28;
+                            num_read = 5;
+                        }
+                    }
+                }
+            }
+            iter += num_read;
+            length -= num_read;
+            return static_cast<int>(result);
+        }
+
         int numRead = 0;
         int result = 0;
 
@@ -169,6 +210,8 @@ namespace ProtocolCraft
     void WriteData(const VarInt &value, WriteContainer& container)
     {
         unsigned int val = value;
+        unsigned char bytes[5];
+        int num_bytes = 0;
         do {
             unsigned char temp = (unsigned char)(val & 127);//0b01111111
             val >>= 7;
@@ -176,14 +219,17 @@ namespace ProtocolCraft
             {
                 temp |= 128;//0b10000000
             }
-            container.push_back(temp);
+            bytes[num_bytes++] = temp;
         } while (val != 0);
+        container.insert(container.end(), bytes, bytes + num_bytes);
     }
 
     template<>
     void WriteData(const VarLong& value, WriteContainer& container)
     {
         unsigned long long int val = value;
+        unsigned char bytes[10];
+        int num_bytes = 0;
         do {
             unsigned char temp = (unsigned char)(val & 127);//0b01111111
             val >>= 7;
@@ -191,8 +237,9 @@ namespace ProtocolCraft
             {
                 temp |= 128;//0b10000000
             }
-            container.push_back(temp);
+            bytes[num_bytes++] = temp;
         } while (val != 0);
+        container.insert(container.end(), bytes, bytes + num_bytes);
     }
 
     template<>
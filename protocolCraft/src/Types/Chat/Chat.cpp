@@ -1,82 +1,490 @@
 #include <nlohmann/json.hpp>
 
+#include <stdexcept>
+
 #include "protocolCraft/Types/Chat/Chat.hpp"
 
-namespace ProtocolCraft
+namespace
 {
-    const std::string Chat::ParseChat(const nlohmann::json& raw_json)
+    /// @brief Minimal JSON scanner extracting the plain text of a chat
+    /// component directly from its string representation
+    class ChatTextExtractor
     {
-        if (raw_json.is_object())
+    public:
+        ChatTextExtractor(const std::string& raw_) : raw(raw_), pos(0)
         {
-            std::string output = "";
 
-            if (raw_json.contains("text"))
+        }
+
+        std::string Extract()
+        {
+            std::string output;
+            SkipWhitespaces();
+            Value(&output);
+            SkipWhitespaces();
+            if (pos != raw.size())
             {
-                // It should always be text but just in case
-                if (raw_json["text"].is_string())
+                throw std::runtime_error("Unexpected data after chat JSON");
+            }
+            return output;
+        }
+
+    private:
+        /// @brief Read a value, and append its text to output if not nullptr
+        void Value(std::string* output)
+        {
+            if (pos >= raw.size())
+            {
+                throw std::runtime_error("Unexpected end of chat JSON");
+            }
+            switch (raw[pos])
+            {
+            case '{':
+                Object(output);
+                break;
+            case '[':
+                Array(output);
+                break;
+            case '"':
+                if (output != nullptr)
+                {
+                    String(*output);
+                }
+                else
                 {
-                    output += raw_json["text"].get<std::string>();
+                    SkipString();
                 }
+                break;
+            case 't':
+                Literal("true", output);
+                break;
+            case 'f':
+                Literal("false", output);
+                break;
+            case 'n':
+                Literal("null", nullptr);
+                break;
+            default:
+                Number(output);
+                break;
             }
-            // TODO: deal with other translate types for completeness
-            else if (raw_json.contains("translate") && raw_json["translate"].is_string() && raw_json["translate"].get<std::string>() == "chat.type.text")
+        }
+
+        void Object(std::string* output)
+        {
+            // Fields can come in any order, but text (or translation)
+            // always goes before extra
+            bool has_text = false;
+            std::string text;
+            bool is_chat_translation = false;
+            bool has_with = false;
+            std::string with;
+            std::string extra;
+
+            ++pos;
+            SkipWhitespaces();
+            if (Peek() == '}')
             {
-                // It *should* be <%s> %s, so we only need with[1]
-                if (raw_json.contains("with") && raw_json["with"].is_array() && raw_json["with"].size() > 1)
+                ++pos;
+                return;
+            }
+            while (true)
+            {
+                SkipWhitespaces();
+                std::string key;
+                String(key);
+                SkipWhitespaces();
+                Expect(':');
+                SkipWhitespaces();
+
+                if (output == nullptr)
+                {
+                    Value(nullptr);
+                }
+                else if (key == "text")
+                {
+                    has_text = true;
+                    text.clear();
+                    if (Peek() == '"')
+                    {
+                        String(text);
+                    }
+                    else
+                    {
+                        Value(nullptr);
+                    }
+                }
+                else if (key == "translate")
+                {
+                    std::string translate;
+                    if (Peek() == '"')
+                    {
+                        String(translate);
+                    }
+                    else
+                    {
+                        Value(nullptr);
+                    }
+                    is_chat_translation = translate == "chat.type.text";
+                }
+                else if (key == "with" && Peek() == '[')
                 {
-                    output += ParseChat(raw_json["with"][1]);
+                    // It *should* be <%s> %s, so we only need with[1]
+                    with.clear();
+                    has_with = ArrayElement(1, with);
                 }
+                else if (key == "extra" && Peek() == '[')
+                {
+                    extra.clear();
+                    Array(&extra);
+                }
+                else
+                {
+                    Value(nullptr);
+                }
+
+                SkipWhitespaces();
+                if (Peek() == ',')
+                {
+                    ++pos;
+                    continue;
+                }
+                Expect('}');
+                break;
             }
-            else
+
+            if (output == nullptr)
             {
-                // TODO: deal with other type of content (NBT, scoreboard, selector, keybind)
+                return;
             }
+            if (has_text)
+            {
+                *output += text;
+            }
+            else if (is_chat_translation && has_with)
+            {
+                *output += with;
+            }
+            *output += extra;
+        }
 
-            // Add extra
-            if (raw_json.contains("extra") && raw_json["extra"].is_array())
+        void Array(std::string* output)
+        {
+            ++pos;
+            SkipWhitespaces();
+            if (Peek() == ']')
+            {
+                ++pos;
+                return;
+            }
+            while (true)
             {
-                output += ParseChat(raw_json["extra"]);
+                SkipWhitespaces();
+                Value(output);
+                SkipWhitespaces();
+                if (Peek() == ',')
+                {
+                    ++pos;
+                    continue;
+                }
+                Expect(']');
+                break;
             }
+        }
 
-            return output;
+        /// @brief Read an array, only keeping the text of one element
+        /// @return True if the array has this element
+        bool ArrayElement(const size_t index, std::string& output)
+        {
+            bool found = false;
+            size_t i = 0;
+            ++pos;
+            SkipWhitespaces();
+            if (Peek() == ']')
+            {
+                ++pos;
+                return false;
+            }
+            while (true)
+            {
+                SkipWhitespaces();
+                found |= i == index;
+                Value(i == index ? &output : nullptr);
+                i += 1;
+                SkipWhitespaces();
+                if (Peek() == ',')
+                {
+                    ++pos;
+                    continue;
+                }
+                Expect(']');
+                break;
+            }
+            return found;
         }
 
-        if (raw_json.is_null())
+        void String(std::string& output)
         {
-            return "";
+            Expect('"');
+            while (true)
+            {
+                const char c = Next();
+                if (c == '"')
+                {
+                    return;
+                }
+                if (c != '\\')
+                {
+                    output.push_back(c);
+                    continue;
+                }
+                const char escaped = Next();
+                switch (escaped)
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    output.push_back(escaped);
+                    break;
+                case 'b':
+                    output.push_back('\b');
+                    break;
+                case 'f':
+                    output.push_back('\f');
+                    break;
+                case 'n':
+                    output.push_back('\n');
+                    break;
+                case 'r':
+                    output.push_back('\r');
+                    break;
+                case 't':
+                    output.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    unsigned int codepoint = Hex4();
+                    // Surrogate pair
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+                    {
+                        Expect('\\');
+                        Expect('u');
+                        const unsigned int low = Hex4();
+                        if (low < 0xDC00 || low > 0xDFFF)
+                        {
+                            throw std::runtime_error("Invalid surrogate pair in chat JSON");
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUTF8(codepoint, output);
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Invalid escape sequence in chat JSON");
+                }
+            }
         }
 
-        if (raw_json.is_string())
+        void SkipString()
         {
-            return raw_json.get<std::string>();
+            Expect('"');
+            while (true)
+            {
+                const char c = Next();
+                if (c == '"')
+                {
+                    return;
+                }
+                if (c == '\\')
+                {
+                    Next();
+                }
+            }
         }
 
-        if (raw_json.is_boolean())
+        void Literal(const char* literal, std::string* output)
         {
-            return raw_json.get<bool>() ? "true" : "false";
+            const std::string expected(literal);
+            if (raw.compare(pos, expected.size(), expected) != 0)
+            {
+                throw std::runtime_error("Invalid literal in chat JSON");
+            }
+            pos += expected.size();
+            if (output != nullptr)
+            {
+                *output += expected;
+            }
         }
 
-        if (raw_json.is_number_integer())
+        void Number(std::string* output)
         {
-            return raw_json.is_number_unsigned() ? std::to_string(raw_json.get<unsigned long long int>()) : std::to_string(raw_json.get<long long int>());
+            const size_t start = pos;
+            bool is_float = false;
+            while (pos < raw.size())
+            {
+                const char c = raw[pos];
+                if (c == '.' || c == 'e' || c == 'E')
+                {
+                    is_float = true;
+                }
+                else if (!((c >= '0' && c <= '9') || c == '-' || c == '+'))
+                {
+                    break;
+                }
+                ++pos;
+            }
+            if (pos == start)
+            {
+                throw std::runtime_error("Unexpected character in chat JSON");
+            }
+            if (output == nullptr)
+            {
+                return;
+            }
+            // Same formatting as the one used with nlohmann::json values
+            const std::string number = raw.substr(start, pos - start);
+            if (!is_float)
+            {
+                try
+                {
+                    *output += number[0] == '-' ? std::to_string(std::stoll(number)) : std::to_string(std::stoull(number));
+                    return;
+                }
+                catch (const std::out_of_range&)
+                {
+                    // Too big for an integer, nlohmann uses a double
+                }
+            }
+            *output += std::to_string(std::stod(number));
         }
 
-        if (raw_json.is_number_float())
+        unsigned int Hex4()
         {
-            return std::to_string(raw_json.get<double>());
+            unsigned int value = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                const char c = Next();
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                {
+                    value |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f')
+                {
+                    value |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F')
+                {
+                    value |= c - 'A' + 10;
+                }
+                else
+                {
+                    throw std::runtime_error("Invalid unicode escape in chat JSON");
+                }
+            }
+            return value;
         }
 
-        if (raw_json.is_array())
+        static void AppendUTF8(const unsigned int codepoint, std::string& output)
         {
-            std::string output = "";
+            if (codepoint < 0x80)
+            {
+                output.push_back(static_cast<char>(codepoint));
+            }
+            else if (codepoint < 0x800)
+            {
+                output.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+                output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            }
+            else if (codepoint < 0x10000)
+            {
+                output.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+                output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            }
+            else
+            {
+                output.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            }
+        }
 
-            for (const auto& s : raw_json)
+        void SkipWhitespaces()
+        {
+            while (pos < raw.size() && (raw[pos] == ' ' || raw[pos] == '\t' || raw[pos] == '\n' || raw[pos] == '\r'))
             {
-                output += ParseChat(s);
+                ++pos;
+            }
+        }
+
+        char Peek() const
+        {
+            return pos < raw.size() ? raw[pos] : '\0';
+        }
+
+        char Next()
+        {
+            if (pos >= raw.size())
+            {
+                throw std::runtime_error("Unexpected end of chat JSON");
+            }
+            return raw[pos++];
+        }
+
+        void Expect(const char c)
+        {
+            if (Next() != c)
+            {
+                throw std::runtime_error(std::string("Expected '") + c + "' in chat JSON");
+            }
+        }
+
+    private:
+        const std::string& raw;
+        size_t pos;
+    };
+}
+
+namespace ProtocolCraft
+{
+    const std::string& Chat::GetText() const
+    {
+        std::shared_ptr<const std::string> current = std::atomic_load(&text);
+        if (current == nullptr)
+        {
+            std::shared_ptr<const std::string> extracted;
+            try
+            {
+                extracted = std::make_shared<const std::string>(ChatTextExtractor(raw_text).Extract());
+            }
+            catch (const std::exception&)
+            {
+                // Malformed JSON, no text to extract
+                extracted = std::make_shared<const std::string>();
+            }
+            // If another thread was faster, keep its value so
+            // the reference it returned stays valid
+            if (std::atomic_compare_exchange_strong(&text, &current, extracted))
+            {
+                current = extracted;
             }
-            return output;
         }
+        return *current;
+    }
 
-        return "";
+    const nlohmann::json& Chat::GetJson() const
+    {
+        std::shared_ptr<const nlohmann::json> current = std::atomic_load(&json);
+        if (current == nullptr)
+        {
+            std::shared_ptr<const nlohmann::json> parsed = std::make_shared<const nlohmann::json>(nlohmann::json::parse(raw_text, nullptr, false));
+            if (std::atomic_compare_exchange_strong(&json, &current, parsed))
+            {
+                current = parsed;
+            }
+        }
+        return *current;
     }
 }
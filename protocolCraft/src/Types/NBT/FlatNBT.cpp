@@ -0,0 +1,565 @@
+#include "protocolCraft/Types/NBT/FlatNBT.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace ProtocolCraft
+{
+    // Same limit as vanilla
+    static const int max_nbt_depth = 512;
+
+    static void SkipData(ReadIterator& iterator, size_t& length, const size_t size)
+    {
+        if (length < size)
+        {
+            throw(std::runtime_error("Wrong input size reading NBT"));
+        }
+        iterator += size;
+        length -= size;
+    }
+
+    FlatTag::const_iterator::const_iterator(const FlatNBT* nbt_, const size_t index_)
+    {
+        nbt = nbt_;
+        index = index_;
+    }
+
+    const FlatTag FlatTag::const_iterator::operator*() const
+    {
+        return FlatTag(nbt, index);
+    }
+
+    FlatTag::const_iterator& FlatTag::const_iterator::operator++()
+    {
+        index = nbt->nodes[index].subtree_end;
+        return *this;
+    }
+
+    const bool FlatTag::const_iterator::operator!=(const const_iterator& other) const
+    {
+        return index != other.index || nbt != other.nbt;
+    }
+
+
+    FlatTag::FlatTag()
+    {
+        nbt = nullptr;
+        index = 0;
+    }
+
+    FlatTag::FlatTag(const FlatNBT* nbt_, const size_t index_)
+    {
+        nbt = nbt_;
+        index = index_;
+    }
+
+    const bool FlatTag::IsValid() const
+    {
+        return nbt != nullptr && index < nbt->nodes.size();
+    }
+
+    const TagType FlatTag::GetType() const
+    {
+        return IsValid() ? nbt->nodes[index].type : TagType::End;
+    }
+
+    const std::string FlatTag::GetName() const
+    {
+        if (!IsValid())
+        {
+            return "";
+        }
+        const FlatNBT::Node& node = nbt->nodes[index];
+        return std::string(reinterpret_cast<const char*>(nbt->raw_data.data() + node.name_offset), node.name_size);
+    }
+
+    const bool FlatTag::NameEquals(const std::string& s) const
+    {
+        if (!IsValid())
+        {
+            return false;
+        }
+        const FlatNBT::Node& node = nbt->nodes[index];
+        return node.name_size == s.size() &&
+            std::memcmp(nbt->raw_data.data() + node.name_offset, s.data(), s.size()) == 0;
+    }
+
+    const size_t FlatTag::Size() const
+    {
+        return IsValid() ? nbt->nodes[index].size : 0;
+    }
+
+    const FlatTag FlatTag::GetChild(const std::string& name) const
+    {
+        if (GetType() != TagType::Compound)
+        {
+            return FlatTag();
+        }
+
+        for (const_iterator it = begin(); it != end(); ++it)
+        {
+            const FlatTag child = *it;
+            if (child.NameEquals(name))
+            {
+                return child;
+            }
+        }
+
+        return FlatTag();
+    }
+
+    const FlatTag FlatTag::GetElement(const size_t i) const
+    {
+        const TagType type = GetType();
+        if ((type != TagType::Compound && type != TagType::List) || i >= Size())
+        {
+            return FlatTag();
+        }
+
+        const FlatNBT::Node& node = nbt->nodes[index];
+        // Elements without children are stored one after the
+        // other, no need to walk through the list
+        if (type == TagType::List && node.elements_type != TagType::List && node.elements_type != TagType::Compound)
+        {
+            return FlatTag(nbt, index + 1 + i);
+        }
+
+        size_t child_index = index + 1;
+        for (size_t j = 0; j < i; ++j)
+        {
+            child_index = nbt->nodes[child_index].subtree_end;
+        }
+        return FlatTag(nbt, child_index);
+    }
+
+    const TagType FlatTag::GetElementsType() const
+    {
+        return GetType() == TagType::List ? nbt->nodes[index].elements_type : TagType::End;
+    }
+
+    FlatTag::const_iterator FlatTag::begin() const
+    {
+        const TagType type = GetType();
+        if (type != TagType::Compound && type != TagType::List)
+        {
+            return end();
+        }
+        return const_iterator(nbt, index + 1);
+    }
+
+    FlatTag::const_iterator FlatTag::end() const
+    {
+        if (!IsValid())
+        {
+            return const_iterator(nbt, index);
+        }
+        return const_iterator(nbt, nbt->nodes[index].subtree_end);
+    }
+
+    const char FlatTag::GetByte() const
+    {
+        ReadIterator iter = GetPayload(TagType::Byte);
+        size_t length = sizeof(char);
+        return ReadData<char>(iter, length);
+    }
+
+    const short FlatTag::GetShort() const
+    {
+        ReadIterator iter = GetPayload(TagType::Short);
+        size_t length = sizeof(short);
+        return ReadData<short>(iter, length);
+    }
+
+    const int FlatTag::GetInt() const
+    {
+        ReadIterator iter = GetPayload(TagType::Int);
+        size_t length = sizeof(int);
+        return ReadData<int>(iter, length);
+    }
+
+    const long long int FlatTag::GetLong() const
+    {
+        ReadIterator iter = GetPayload(TagType::Long);
+        size_t length = sizeof(long long int);
+        return ReadData<long long int>(iter, length);
+    }
+
+    const float FlatTag::GetFloat() const
+    {
+        ReadIterator iter = GetPayload(TagType::Float);
+        size_t length = sizeof(float);
+        return ReadData<float>(iter, length);
+    }
+
+    const double FlatTag::GetDouble() const
+    {
+        ReadIterator iter = GetPayload(TagType::Double);
+        size_t length = sizeof(double);
+        return ReadData<double>(iter, length);
+    }
+
+    const long long int FlatTag::GetIntegral() const
+    {
+        switch (GetType())
+        {
+        case TagType::Byte:
+            return GetByte();
+        case TagType::Short:
+            return GetShort();
+        case TagType::Int:
+            return GetInt();
+        case TagType::Long:
+            return GetLong();
+        default:
+            throw(std::runtime_error("Trying to get an integer value from a non integer NBT tag"));
+        }
+    }
+
+    const std::string FlatTag::GetString() const
+    {
+        // Skip the size
+        const unsigned char* data = GetPayload(TagType::String) + sizeof(unsigned short);
+        return std::string(reinterpret_cast<const char*>(data), nbt->nodes[index].size);
+    }
+
+    const std::vector<char> FlatTag::GetByteArray() const
+    {
+        ReadIterator iter = GetPayload(TagType::ByteArray) + sizeof(int);
+        size_t length = nbt->nodes[index].size * sizeof(char);
+        return ReadArrayData<char>(iter, length, nbt->nodes[index].size);
+    }
+
+    const std::vector<int> FlatTag::GetIntArray() const
+    {
+        ReadIterator iter = GetPayload(TagType::IntArray) + sizeof(int);
+        size_t length = nbt->nodes[index].size * sizeof(int);
+        return ReadArrayData<int>(iter, length, nbt->nodes[index].size);
+    }
+
+    const std::vector<long long int> FlatTag::GetLongArray() const
+    {
+        ReadIterator iter = GetPayload(TagType::LongArray) + sizeof(int);
+        size_t length = nbt->nodes[index].size * sizeof(long long int);
+        return ReadArrayData<long long int>(iter, length, nbt->nodes[index].size);
+    }
+
+    std::shared_ptr<Tag> FlatTag::ToTag() const
+    {
+        if (!IsValid())
+        {
+            return nullptr;
+        }
+
+        const FlatNBT::Node& node = nbt->nodes[index];
+        std::shared_ptr<Tag> output = Tag::CreateTag(node.type);
+        ReadIterator iter = nbt->raw_data.data() + node.payload_offset;
+        size_t length = nbt->raw_data.size() - node.payload_offset;
+        output->Read(iter, length);
+
+        return output;
+    }
+
+    const unsigned char* FlatTag::GetPayload(const TagType t) const
+    {
+        if (GetType() != t)
+        {
+            throw(std::runtime_error("Trying to get a " + Tag::TagTypeToString(t) + " value from a " + Tag::TagTypeToString(GetType()) + " NBT tag"));
+        }
+        return nbt->raw_data.data() + nbt->nodes[index].payload_offset;
+    }
+
+
+    FlatNBT::FlatNBT()
+    {
+        indexed = true;
+    }
+
+    FlatNBT::FlatNBT(const FlatNBT& other)
+    {
+        std::lock_guard<std::mutex> lock(other.index_mutex);
+        raw_data = other.raw_data;
+        nodes = other.nodes;
+        indexed = other.indexed;
+    }
+
+    FlatNBT& FlatNBT::operator=(const FlatNBT& other)
+    {
+        if (this != &other)
+        {
+            std::lock(index_mutex, other.index_mutex);
+            std::lock_guard<std::mutex> lock(index_mutex, std::adopt_lock);
+            std::lock_guard<std::mutex> other_lock(other.index_mutex, std::adopt_lock);
+            raw_data = other.raw_data;
+            nodes = other.nodes;
+            indexed = other.indexed;
+        }
+        return *this;
+    }
+
+    void FlatNBT::Read(ReadIterator& iterator, size_t& length)
+    {
+        Clear();
+
+        const unsigned char* start = iterator;
+        Skip(iterator, length);
+        raw_data.assign(start, iterator);
+        // Nothing to index if there was only a TAG_End
+        indexed = raw_data.size() == 1;
+    }
+
+    void FlatNBT::Skip(ReadIterator& iterator, size_t& length)
+    {
+        // Read type
+        const TagType type = (TagType)ReadData<char>(iterator, length);
+
+        // No data to read
+        if (type == TagType::End)
+        {
+            return;
+        }
+
+        if (type != TagType::Compound)
+        {
+            throw(std::runtime_error("Error reading NBT, not starting with compound"));
+        }
+
+        // Root name
+        const unsigned short name_size = ReadData<unsigned short>(iterator, length);
+        SkipData(iterator, length, name_size);
+
+        SkipPayload(TagType::Compound, iterator, length, 0);
+    }
+
+    void FlatNBT::Clear()
+    {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        raw_data.clear();
+        nodes.clear();
+        indexed = true;
+    }
+
+    const bool FlatNBT::HasData() const
+    {
+        // Only TAG_End if no data
+        return raw_data.size() > 1;
+    }
+
+    const FlatTag FlatNBT::GetRoot() const
+    {
+        if (!HasData())
+        {
+            return FlatTag();
+        }
+        Index();
+        return FlatTag(this, 0);
+    }
+
+    const std::string FlatNBT::GetRootName() const
+    {
+        if (!HasData())
+        {
+            return "";
+        }
+        // Skip type, name size is just after
+        ReadIterator iter = raw_data.data() + sizeof(char);
+        size_t length = raw_data.size() - sizeof(char);
+        const unsigned short name_size = ReadData<unsigned short>(iter, length);
+        return ReadRawString(iter, length, name_size);
+    }
+
+    const std::vector<unsigned char>& FlatNBT::GetRawData() const
+    {
+        return raw_data;
+    }
+
+    const size_t FlatNBT::GetMemoryUsage() const
+    {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        return sizeof(FlatNBT) + raw_data.capacity() + nodes.capacity() * sizeof(Node);
+    }
+
+    void FlatNBT::SkipPayload(const TagType type, ReadIterator& iterator, size_t& length, const int depth)
+    {
+        if (depth > max_nbt_depth)
+        {
+            throw(std::runtime_error("Error reading NBT, max depth exceeded"));
+        }
+
+        switch (type)
+        {
+        case TagType::End:
+            break;
+        case TagType::Byte:
+            SkipData(iterator, length, sizeof(char));
+            break;
+        case TagType::Short:
+            SkipData(iterator, length, sizeof(short));
+            break;
+        case TagType::Int:
+            SkipData(iterator, length, sizeof(int));
+            break;
+        case TagType::Long:
+            SkipData(iterator, length, sizeof(long long int));
+            break;
+        case TagType::Float:
+            SkipData(iterator, length, sizeof(float));
+            break;
+        case TagType::Double:
+            SkipData(iterator, length, sizeof(double));
+            break;
+        case TagType::ByteArray:
+        case TagType::IntArray:
+        case TagType::LongArray:
+        {
+            const int array_size = ReadData<int>(iterator, length);
+            if (array_size < 0)
+            {
+                throw(std::runtime_error("Error reading NBT, negative array size"));
+            }
+            const size_t element_size = type == TagType::ByteArray ? sizeof(char) : (type == TagType::IntArray ? sizeof(int) : sizeof(long long int));
+            SkipData(iterator, length, array_size * element_size);
+            break;
+        }
+        case TagType::String:
+        {
+            const unsigned short string_size = ReadData<unsigned short>(iterator, length);
+            SkipData(iterator, length, string_size);
+            break;
+        }
+        case TagType::List:
+        {
+            const TagType elements_type = (TagType)ReadData<char>(iterator, length);
+            const int list_size = ReadData<int>(iterator, length);
+            if (list_size < 0 || (elements_type == TagType::End && list_size > 0))
+            {
+                throw(std::runtime_error("Error reading NBT, invalid list"));
+            }
+            for (int i = 0; i < list_size; ++i)
+            {
+                SkipPayload(elements_type, iterator, length, depth + 1);
+            }
+            break;
+        }
+        case TagType::Compound:
+        {
+            while (true)
+            {
+                const TagType child_type = (TagType)ReadData<char>(iterator, length);
+                if (child_type == TagType::End)
+                {
+                    break;
+                }
+                const unsigned short name_size = ReadData<unsigned short>(iterator, length);
+                SkipData(iterator, length, name_size);
+                SkipPayload(child_type, iterator, length, depth + 1);
+            }
+            break;
+        }
+        default:
+            throw(std::runtime_error("Error reading NBT, unknown tag type"));
+        }
+    }
+
+    void FlatNBT::Index() const
+    {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        if (indexed)
+        {
+            return;
+        }
+
+        // Data has already been checked in Read, can't fail
+        ReadIterator iterator = raw_data.data() + sizeof(char);
+        size_t length = raw_data.size() - sizeof(char);
+
+        Node root;
+        root.type = TagType::Compound;
+        root.elements_type = TagType::End;
+        root.name_size = ReadData<unsigned short>(iterator, length);
+        root.name_offset = static_cast<unsigned int>(iterator - raw_data.data());
+        SkipData(iterator, length, root.name_size);
+        nodes.push_back(root);
+
+        ReadPayload(0, iterator, length);
+
+        indexed = true;
+    }
+
+    void FlatNBT::ReadPayload(const size_t node_index, ReadIterator& iterator, size_t& length) const
+    {
+        const unsigned char* start = raw_data.data();
+        nodes[node_index].payload_offset = static_cast<unsigned int>(iterator - start);
+        nodes[node_index].size = 0;
+
+        // nodes can be reallocated when adding children, so
+        // always access it through node_index
+        switch (nodes[node_index].type)
+        {
+        case TagType::ByteArray:
+        case TagType::IntArray:
+        case TagType::LongArray:
+        {
+            const int array_size = ReadData<int>(iterator, length);
+            const TagType type = nodes[node_index].type;
+            const size_t element_size = type == TagType::ByteArray ? sizeof(char) : (type == TagType::IntArray ? sizeof(int) : sizeof(long long int));
+            SkipData(iterator, length, array_size * element_size);
+            nodes[node_index].size = array_size;
+            break;
+        }
+        case TagType::String:
+        {
+            const unsigned short string_size = ReadData<unsigned short>(iterator, length);
+            SkipData(iterator, length, string_size);
+            nodes[node_index].size = string_size;
+            break;
+        }
+        case TagType::List:
+        {
+            const TagType elements_type = (TagType)ReadData<char>(iterator, length);
+            const int list_size = ReadData<int>(iterator, length);
+            nodes[node_index].elements_type = elements_type;
+            nodes[node_index].size = list_size;
+
+            for (int i = 0; i < list_size; ++i)
+            {
+                Node element;
+                element.type = elements_type;
+                element.elements_type = TagType::End;
+                element.name_size = 0;
+                element.name_offset = 0;
+                nodes.push_back(element);
+                ReadPayload(nodes.size() - 1, iterator, length);
+            }
+            break;
+        }
+        case TagType::Compound:
+        {
+            while (true)
+            {
+                const TagType type = (TagType)ReadData<char>(iterator, length);
+                if (type == TagType::End)
+                {
+                    break;
+                }
+
+                Node child;
+                child.type = type;
+                child.elements_type = TagType::End;
+                child.name_size = ReadData<unsigned short>(iterator, length);
+                child.name_offset = static_cast<unsigned int>(iterator - start);
+                SkipData(iterator, length, child.name_size);
+                nodes.push_back(child);
+                ReadPayload(nodes.size() - 1, iterator, length);
+                nodes[node_index].size += 1;
+            }
+            break;
+        }
+        default:
+            // Fixed size types
+            SkipPayload(nodes[node_index].type, iterator, length, 0);
+            break;
+        }
+
+        nodes[node_index].subtree_end = static_cast<unsigned int>(nodes.size());
+    }
+} // ProtocolCraft
@@ -4,14 +4,25 @@ namespace ProtocolCraft
 {
     NBT::NBT()
     {
-        has_data = false;
+        root_tag_built = false;
     }
 
     NBT::NBT(const NBT& nbt)
     {
-        root_tag = nbt.root_tag;
-        root_name = nbt.root_name;
-        has_data = nbt.has_data;
+        flat_nbt = nbt.flat_nbt;
+        root_tag_built = false;
+    }
+
+    NBT& NBT::operator=(const NBT& nbt)
+    {
+        if (this != &nbt)
+        {
+            std::lock_guard<std::mutex> lock(root_tag_mutex);
+            flat_nbt = nbt.flat_nbt;
+            root_tag = TagCompound();
+            root_tag_built = false;
+        }
+        return *this;
     }
 
     NBT::~NBT()
@@ -21,44 +32,36 @@ namespace ProtocolCraft
 
     const TagCompound& NBT::GetRoot() const
     {
+        std::lock_guard<std::mutex> lock(root_tag_mutex);
+        if (!root_tag_built)
+        {
+            std::map<std::string, std::shared_ptr<Tag> > values;
+            const FlatTag root = flat_nbt.GetRoot();
+            for (FlatTag::const_iterator it = root.begin(); it != root.end(); ++it)
+            {
+                values[(*it).GetName()] = (*it).ToTag();
+            }
+            root_tag.SetValues(values);
+            root_tag_built = true;
+        }
         return root_tag;
     }
 
     void NBT::ReadImpl(ReadIterator &iterator, size_t &length)
     {
-        // Read type
-        const TagType type = (TagType)ReadData<char>(iterator, length);
-
-        // No data to read
-        if (type == TagType::End)
-        {
-            has_data = false;
-            return;
-        }
-
-        if (type != TagType::Compound)
-        {
-            throw(std::runtime_error("Error reading NBT, not starting with compound"));
-        }
-
-        // Read name size
-        const unsigned short name_size = ReadData<unsigned short>(iterator, length);
-
-        // Read name
-        root_name = ReadRawString(iterator, length, name_size);
-
-        root_tag.Read(iterator, length);
-        has_data = true;
+        std::lock_guard<std::mutex> lock(root_tag_mutex);
+        root_tag = TagCompound();
+        root_tag_built = false;
+        flat_nbt.Read(iterator, length);
     }
 
     void NBT::WriteImpl(WriteContainer &container) const
     {
-        if (has_data)
+        if (flat_nbt.HasData())
         {
-            WriteData<char>((char)TagType::Compound, container);
-            WriteData<unsigned short>(root_name.size(), container);
-            WriteRawString(root_name, container);
-            root_tag.Write(container);
+            // Raw data already contains type and root name
+            const std::vector<unsigned char>& raw_data = flat_nbt.GetRawData();
+            container.insert(container.end(), raw_data.begin(), raw_data.end());
         }
         else
         {
@@ -71,15 +74,15 @@ namespace ProtocolCraft
         nlohmann::json output;
 
         output["type"] = "NBT";
-        output["name"] = root_name;
-        output["content"] = root_tag.Serialize();
+        output["name"] = flat_nbt.GetRootName();
+        output["content"] = GetRoot().Serialize();
 
         return output;
     }
 
     const std::shared_ptr<Tag> NBT::GetTag(const std::string &s) const
     {
-        const std::map<std::string, std::shared_ptr<Tag> > &tags = root_tag.GetValues();
+        const std::map<std::string, std::shared_ptr<Tag> > &tags = GetRoot().GetValues();
 
         auto it = tags.find(s);
 
@@ -93,6 +96,26 @@ namespace ProtocolCraft
         
     const bool NBT::HasData() const
     {
-        return has_data;
+        return flat_nbt.HasData();
+    }
+
+    const FlatTag NBT::GetFlatRoot() const
+    {
+        return flat_nbt.GetRoot();
+    }
+
+    const FlatTag NBT::GetFlatTag(const std::string& s) const
+    {
+        return flat_nbt.GetRoot().GetChild(s);
+    }
+
+    const std::vector<unsigned char>& NBT::GetRawData() const
+    {
+        return flat_nbt.GetRawData();
+    }
+
+    const size_t NBT::GetMemoryUsage() const
+    {
+        return sizeof(NBT) - sizeof(FlatNBT) + flat_nbt.GetMemoryUsage();
     }
-}
\ No newline at end of file
+}